@@ -8,43 +8,8 @@
 #include <fstream>
 #include <sstream>
 
-static void create_xy_table(const k4a_calibration_t *calibration, k4a_image_t xy_table)
-{
-    k4a_float2_t *table_data = (k4a_float2_t *)(void *)k4a_image_get_buffer(xy_table);
-
-    int width = calibration->depth_camera_calibration.resolution_width;
-    int height = calibration->depth_camera_calibration.resolution_height;
-
-    k4a_float2_t p;
-    k4a_float3_t ray;
-    int valid;
-
-    for (int y = 0, idx = 0; y < height; y++)
-    {
-        p.xy.y = (float)y;
-        for (int x = 0; x < width; x++, idx++)
-        {
-            p.xy.x = (float)x;
-
-            k4a_calibration_2d_to_3d(
-                calibration, &p, 1.f, K4A_CALIBRATION_TYPE_DEPTH, K4A_CALIBRATION_TYPE_DEPTH, &ray, &valid);
-
-            if (valid)
-            {
-                table_data[idx].xy.x = ray.xyz.x;
-                table_data[idx].xy.y = ray.xyz.y;
-            }
-            else
-            {
-                table_data[idx].xy.x = nanf("");
-                table_data[idx].xy.y = nanf("");
-            }
-        }
-    }
-}
-
 static void generate_point_cloud(const k4a_image_t depth_image,
-                                 const k4a_image_t xy_table,
+                                 const k4a_xy_table_t *xy_table,
                                  k4a_image_t point_cloud,
                                  int *point_count)
 {
@@ -52,16 +17,15 @@ static void generate_point_cloud(const k4a_image_t depth_image,
     int height = k4a_image_get_height_pixels(depth_image);
 
     uint16_t *depth_data = (uint16_t *)(void *)k4a_image_get_buffer(depth_image);
-    k4a_float2_t *xy_table_data = (k4a_float2_t *)(void *)k4a_image_get_buffer(xy_table);
     k4a_float3_t *point_cloud_data = (k4a_float3_t *)(void *)k4a_image_get_buffer(point_cloud);
 
     *point_count = 0;
     for (int i = 0; i < width * height; i++)
     {
-        if (depth_data[i] != 0 && !isnan(xy_table_data[i].xy.x) && !isnan(xy_table_data[i].xy.y))
+        if (depth_data[i] != 0 && !isnan(xy_table->x_table[i]))
         {
-            point_cloud_data[i].xyz.x = xy_table_data[i].xy.x * (float)depth_data[i];
-            point_cloud_data[i].xyz.y = xy_table_data[i].xy.y * (float)depth_data[i];
+            point_cloud_data[i].xyz.x = xy_table->x_table[i] * (float)depth_data[i];
+            point_cloud_data[i].xyz.y = xy_table->y_table[i] * (float)depth_data[i];
             point_cloud_data[i].xyz.z = (float)depth_data[i];
             (*point_count)++;
         }
@@ -119,7 +83,8 @@ int main(int argc, char **argv)
     uint32_t device_count = 0;
     k4a_device_configuration_t config = K4A_DEVICE_CONFIG_INIT_DISABLE_ALL;
     k4a_image_t depth_image = NULL;
-    k4a_image_t xy_table = NULL;
+    k4a_transformation_t transformation = NULL;
+    k4a_xy_table_t xy_table;
     k4a_image_t point_cloud = NULL;
     int point_count = 0;
 
@@ -157,13 +122,14 @@ int main(int argc, char **argv)
         goto Exit;
     }
 
-    k4a_image_create(K4A_IMAGE_FORMAT_CUSTOM,
-                     calibration.depth_camera_calibration.resolution_width,
-                     calibration.depth_camera_calibration.resolution_height,
-                     calibration.depth_camera_calibration.resolution_width * (int)sizeof(k4a_float2_t),
-                     &xy_table);
-
-    create_xy_table(&calibration, xy_table);
+    // The transformation computes the unprojection of every depth pixel once, point clouds only scale it by depth
+    transformation = k4a_transformation_create(&calibration);
+    if (transformation == NULL ||
+        K4A_RESULT_SUCCEEDED != k4a_transformation_get_xy_table(transformation, K4A_CALIBRATION_TYPE_DEPTH, &xy_table))
+    {
+        printf("Failed to get the xy table\n");
+        goto Exit;
+    }
 
     k4a_image_create(K4A_IMAGE_FORMAT_CUSTOM,
                      calibration.depth_camera_calibration.resolution_width,
@@ -198,17 +164,20 @@ int main(int argc, char **argv)
         goto Exit;
     }
 
-    generate_point_cloud(depth_image, xy_table, point_cloud, &point_count);
+    generate_point_cloud(depth_image, &xy_table, point_cloud, &point_count);
 
     write_point_cloud(file_name.c_str(), point_cloud, point_count);
 
     k4a_image_release(depth_image);
     k4a_capture_release(capture);
-    k4a_image_release(xy_table);
     k4a_image_release(point_cloud);
 
     returnCode = 0;
 Exit:
+    if (transformation != NULL)
+    {
+        k4a_transformation_destroy(transformation);
+    }
     if (device != NULL)
     {
         k4a_device_close(device);
@@ -48,6 +48,42 @@ extern "C" {
  */
 K4A_EXPORT uint32_t k4a_device_get_installed_count(void);
 
+/** Lists the connected devices with their serial numbers
+ *
+ * \param devices
+ * Array of \p max_devices entries to receive the devices. May be NULL if \p max_devices is 0.
+ *
+ * \param max_devices
+ * Number of entries \p devices can hold.
+ *
+ * \param device_count
+ * Receives the number of devices connected, which may be larger than \p max_devices.
+ *
+ * \returns ::K4A_RESULT_SUCCEEDED if the devices were listed, ::K4A_RESULT_FAILED otherwise.
+ *
+ * \relates k4a_device_t
+ *
+ * \remarks
+ * The first min(\p device_count, \p max_devices) entries of \p devices are written. Each entry's index can be passed to
+ * k4a_device_open().
+ *
+ * \remarks
+ * Serial numbers are read from the USB descriptors without opening the device, and are remembered for as long as the
+ * device stays connected. The serial number of a device already in use by another process is empty unless this process
+ * read it earlier.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_device_enumerate(k4a_installed_device_t *devices,
+                                             uint32_t max_devices,
+                                             uint32_t *device_count);
+
 /** Sets and clears the callback function to receive debug messages from the Azure Kinect device.
  *
  * \param message_cb
@@ -122,6 +158,10 @@ K4A_EXPORT k4a_result_t k4a_set_debug_message_handler(k4a_logging_message_cb_t *
  * Not all memory allocation by the SDK is performed by this allocate function. Small allocations or allocations
  * from special pools may come from other sources.
  *
+ * \remarks
+ * Set the allocator before opening devices. An allocation already in progress on another thread may still use the
+ * previous \p allocate function, and at most 16 different allocators may be set over the life of the process.
+ *
  * \xmlonly
  * <requirements>
  *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
@@ -132,24 +172,25 @@ K4A_EXPORT k4a_result_t k4a_set_debug_message_handler(k4a_logging_message_cb_t *
  */
 K4A_EXPORT k4a_result_t k4a_set_allocator(k4a_memory_allocate_cb_t allocate, k4a_memory_destroy_cb_t free);
 
-/** Open an Azure Kinect device.
- *
- * \param index
- * The index of the device to open, starting with 0. Optionally pass in #K4A_DEVICE_DEFAULT.
+/** Enables pooling of freed buffers in the default SDK allocator.
  *
- * \param device_handle
- * Output parameter which on success will return a handle to the device.
+ * \param max_retained_bytes
+ * The most memory, in bytes, the default allocator may keep for reuse after buffers are freed. 0 disables pooling.
  *
- * \relates k4a_device_t
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the limit was set.
  *
- * \return ::K4A_RESULT_SUCCEEDED if the device was opened successfully.
+ * \remarks
+ * SDK buffers come in a few fixed sizes for a given configuration. With pooling enabled the default allocator rounds
+ * each request up to a size class, at most 1/8th larger, and reuses freed buffers of the same class. After warm up
+ * streaming no longer calls malloc for frame buffers.
  *
  * \remarks
- * If successful, k4a_device_open() will return a device handle in the device_handle parameter.
- * This handle grants exclusive access to the device and may be used in the other Azure Kinect API calls.
+ * Lowering the limit frees retained buffers immediately. Pooling can also be enabled by setting the
+ * K4A_ALLOCATOR_POOL_BYTES environment variable to the limit in bytes.
  *
  * \remarks
- * When done with the device, close the handle with k4a_device_close()
+ * This only affects the default allocator. Allocators set with k4a_set_allocator() are called directly.
  *
  * \xmlonly
  * <requirements>
@@ -159,19 +200,29 @@ K4A_EXPORT k4a_result_t k4a_set_allocator(k4a_memory_allocate_cb_t allocate, k4a
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT k4a_result_t k4a_device_open(uint32_t index, k4a_device_t *device_handle);
+K4A_EXPORT k4a_result_t k4a_set_default_allocator_pool_size(size_t max_retained_bytes);
 
-/** Closes an Azure Kinect device.
+/** Backs large color and depth buffers and transformation tables of the default SDK allocator with huge pages.
  *
- * \param device_handle
- * Handle obtained by k4a_device_open().
+ * \param min_bytes
+ * The smallest allocation, in bytes, mapped with huge pages. 0 disables huge pages.
  *
- * \relates k4a_device_t
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the threshold was set.
  *
- * \remarks Once closed, the handle is no longer valid.
+ * \remarks
+ * Large frames and the xy tables of a transformation are read sequentially every frame. Mapping them with 2MB pages
+ * instead of 4KB ones cuts the TLB misses of streaming several devices at high resolutions.
  *
- * \remarks Before closing the handle to the device, ensure that all \ref k4a_capture_t captures have been released with
- * k4a_capture_release().
+ * \remarks
+ * On Linux explicit huge pages reserved in /proc/sys/vm/nr_hugepages are used when available, otherwise the buffer is
+ * aligned to 2MB and advised as a transparent huge page. On Windows large pages require the SeLockMemoryPrivilege.
+ * When no huge pages can be mapped the default allocator is used. Huge pages can also be enabled by setting the
+ * K4A_ALLOCATOR_HUGE_PAGE_BYTES environment variable to the threshold in bytes.
+ *
+ * \remarks
+ * Buffers backed by huge pages are not pooled by k4a_set_default_allocator_pool_size(). Allocators set with
+ * k4a_set_allocator() are called directly. Tables already built keep their memory.
  *
  * \xmlonly
  * <requirements>
@@ -181,57 +232,30 @@ K4A_EXPORT k4a_result_t k4a_device_open(uint32_t index, k4a_device_t *device_han
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT void k4a_device_close(k4a_device_t device_handle);
+K4A_EXPORT k4a_result_t k4a_set_default_allocator_huge_page_threshold(size_t min_bytes);
 
-/** Reads a sensor capture.
- *
- * \param device_handle
- * Handle obtained by k4a_device_open().
+/** Gets live memory statistics for a source of SDK allocations.
  *
- * \param capture_handle
- * If successful this contains a handle to a capture object. Caller must call k4a_capture_release() when its done using
- * this capture.
+ * \param source
+ * The allocation source to query.
  *
- * \param timeout_in_ms
- * Specifies the time in milliseconds the function should block waiting for the capture. If set to 0, the function will
- * return without blocking. Passing a value of #K4A_WAIT_INFINITE will block indefinitely until data is available, the
- * device is disconnected, or another error occurs.
+ * \param stats
+ * Location to write the statistics to.
  *
  * \returns
- * ::K4A_WAIT_RESULT_SUCCEEDED if a capture is returned. If a capture is not available before the timeout elapses, the
- * function will return ::K4A_WAIT_RESULT_TIMEOUT. All other failures will return ::K4A_WAIT_RESULT_FAILED.
- *
- * \relates k4a_device_t
+ * ::K4A_RESULT_SUCCEEDED if \p stats was written. ::K4A_RESULT_FAILED if \p source or \p stats are invalid.
  *
  * \remarks
- * Gets the next capture in the streamed sequence of captures from the camera. If a new capture is not currently
- * available, this function will block until the timeout is reached. The SDK will buffer at least two captures worth
- * of data before dropping the oldest capture. Callers needing to capture all data need to ensure they read the data as
- * fast as the data is being produced on average.
- *
- * \remarks
- * Upon successfully reading a capture this function will return success and populate \p capture.
- * If a capture is not available in the configured \p timeout_in_ms, then the API will return ::K4A_WAIT_RESULT_TIMEOUT.
- *
- * \remarks
- * If the call is successful and a capture is returned, callers must call k4a_capture_release() to return the allocated
- * memory.
- *
- * \remarks
- * This function needs to be called while the device is in a running state;
- * after k4a_device_start_cameras() is called and before k4a_device_stop_cameras() is called.
+ * Statistics cover every device in the process and every allocator set with k4a_set_allocator(). Buffers the SDK keeps
+ * in its internal pools for reuse count as allocated.
  *
  * \remarks
- * This function returns an error when an internal problem is encountered; such as loss of the USB connection, inability
- * to allocate enough memory, and other unexpected issues. Any error returned by this function signals the end of
- * streaming data, and caller should stop the stream using k4a_device_stop_cameras().
+ * A steadily growing \p allocated_bytes for ::K4A_ALLOCATION_SOURCE_DEPTH or ::K4A_ALLOCATION_SOURCE_COLOR usually
+ * means the application is holding on to captures or images faster than it releases them.
  *
  * \remarks
- * If this function is waiting for data (non-zero timeout) when k4a_device_stop_cameras() or k4a_device_close() is
- * called on another thread, this function will return an error.
- *
- * \returns ::K4A_WAIT_RESULT_SUCCEEDED if a capture is returned. If a capture is not available before the timeout
- * elapses, the function will return ::K4A_WAIT_RESULT_TIMEOUT. All other failures will return ::K4A_WAIT_RESULT_FAILED.
+ * The allocation rate is averaged over the time since the last call for \p source that updated it, and is only
+ * updated once at least a second has passed. The first call starts the measurement and reports a rate of 0.
  *
  * \xmlonly
  * <requirements>
@@ -240,57 +264,51 @@ K4A_EXPORT void k4a_device_close(k4a_device_t device_handle);
  *   <requirement name="DLL">k4a.dll</requirement>
  * </requirements>
  * \endxmlonly
- *
  */
-K4A_EXPORT k4a_wait_result_t k4a_device_get_capture(k4a_device_t device_handle,
-                                                    k4a_capture_t *capture_handle,
-                                                    int32_t timeout_in_ms);
+K4A_EXPORT k4a_result_t k4a_get_allocator_stats(k4a_allocation_source_t source, k4a_allocator_stats_t *stats);
 
-/** Reads an IMU sample.
- *
- * \param device_handle
- * Handle obtained by k4a_device_open().
+/** Sets the CPU affinity and priority of a class of SDK threads.
  *
- * \param imu_sample
- * Pointer to the location for the API to write the IMU sample.
+ * \param thread
+ * The SDK thread the policy applies to.
  *
- * \param timeout_in_ms
- * Specifies the time in milliseconds the function should block waiting for the sample. If set to 0, the function will
- * return without blocking. Passing a value of #K4A_WAIT_INFINITE will block indefinitely until data is available, the
- * device is disconnected, or another error occurs.
+ * \param policy
+ * The policy to apply. A zeroed policy restores the default scheduling.
  *
  * \returns
- * ::K4A_WAIT_RESULT_SUCCEEDED if a sample is returned. If a sample is not available before the timeout elapses, the
- * function will return ::K4A_WAIT_RESULT_TIMEOUT. All other failures will return ::K4A_WAIT_RESULT_FAILED.
- *
- * \relates k4a_device_t
+ * ::K4A_RESULT_SUCCEEDED if the policy was stored. ::K4A_RESULT_FAILED if \p thread or \p policy are invalid.
  *
  * \remarks
- * Gets the next sample in the streamed sequence of IMU samples from the device. If a new sample is not currently
- * available, this function will block until the timeout is reached. The API will buffer at least two camera capture
- * intervals worth of samples before dropping the oldest sample. Callers needing to capture all data need to ensure they
- * read the data as fast as the data is being produced on average.
+ * The policy applies to every device in the process and is picked up when a thread starts, so it should be set before
+ * calling k4a_device_start_cameras(), k4a_device_start_imu() or k4a_record_create(). Threads that are already running
+ * keep their current scheduling.
  *
  * \remarks
- * Upon successfully reading a sample this function will return success and populate \p imu_sample.
- * If a sample is not available in the configured \p timeout_in_ms, then the API will return ::K4A_WAIT_RESULT_TIMEOUT.
+ * Failure to apply a policy, for example due to missing privileges for ::K4A_THREAD_PRIORITY_REALTIME, is logged as a
+ * warning and the thread continues with its default scheduling.
  *
- * \remarks
- * This function needs to be called while the device is in a running state;
- * after k4a_device_start_imu() is called and before k4a_device_stop_imu() is called.
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_set_thread_policy(k4a_sdk_thread_t thread, const k4a_thread_policy_t *policy);
+
+/** Gets the CPU affinity and priority configured for a class of SDK threads.
  *
- * \remarks
- * This function returns an error when an internal problem is encountered; such as loss of the USB connection, inability
- * to allocate enough memory, and other unexpected issues. Any error returned by this function signals the end of
- * streaming data, and caller should stop the stream using k4a_device_stop_imu().
+ * \param thread
+ * The SDK thread to query.
  *
- * \remarks
- * If this function is waiting for data (non-zero timeout) when k4a_device_stop_imu() or k4a_device_close() is
- * called on another thread, this function will return an error.
+ * \param policy
+ * Location to write the policy to.
  *
- * \remarks
- * The memory the IMU sample is written to is allocated and owned by the caller, so there is no need to call an Azure
- * Kinect API to free or release the sample.
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if \p policy was written. ::K4A_RESULT_FAILED otherwise.
+ *
+ * \see k4a_set_thread_policy()
  *
  * \xmlonly
  * <requirements>
@@ -300,25 +318,29 @@ K4A_EXPORT k4a_wait_result_t k4a_device_get_capture(k4a_device_t device_handle,
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT k4a_wait_result_t k4a_device_get_imu_sample(k4a_device_t device_handle,
-                                                       k4a_imu_sample_t *imu_sample,
-                                                       int32_t timeout_in_ms);
+K4A_EXPORT k4a_result_t k4a_get_thread_policy(k4a_sdk_thread_t thread, k4a_thread_policy_t *policy);
 
-/** Create an empty capture object.
+/** Configures the thread pool the SDK runs its parallel work on.
  *
- * \param capture_handle
- * Pointer to a location to store the handle.
+ * \param options
+ * The options of the pool. A zeroed ::k4a_thread_pool_options_t restores the default of one thread per CPU.
  *
- * \relates k4a_capture_t
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the options were applied. ::K4A_RESULT_FAILED if \p options is NULL or its thread_count is
+ * out of range.
  *
  * \remarks
- * Call this function to create a \ref k4a_capture_t handle for a new capture. Release it with k4a_capture_release().
+ * Work the SDK splits across threads, such as the bands of a CPU depth to color transformation with a
+ * k4a_transformation_set_cpu_thread_count() greater than 1, runs on one process wide pool rather than on threads of
+ * its own. The pool starts its threads the first time it is used. Idle threads take waiting tasks from busy ones.
  *
- * The new capture is created with a reference count of 1.
+ * \remarks
+ * Changing the options waits for the tasks already submitted to finish and stops the pool's threads. The next task
+ * starts them with the new options. The threads use the ::K4A_SDK_THREAD_POOL policy set with k4a_set_thread_policy().
  *
- * \returns
- * Returns #K4A_RESULT_SUCCEEDED on success. Errors are indicated with #K4A_RESULT_FAILED and error specific data can be
- * found in the log.
+ * \remarks
+ * With an executor, the tasks are passed to it instead and the pool starts no threads. The executor may run a task on
+ * any thread, including the submitting one, but must run every task since SDK calls wait for them to finish.
  *
  * \xmlonly
  * <requirements>
@@ -328,17 +350,17 @@ K4A_EXPORT k4a_wait_result_t k4a_device_get_imu_sample(k4a_device_t device_handl
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT k4a_result_t k4a_capture_create(k4a_capture_t *capture_handle);
+K4A_EXPORT k4a_result_t k4a_set_thread_pool_options(const k4a_thread_pool_options_t *options);
 
-/** Release a capture.
+/** Gets the options of the SDK thread pool.
  *
- * \param capture_handle
- * Capture to release.
+ * \param options
+ * Location to write the options to.
  *
- * \relates k4a_capture_t
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if \p options was written. ::K4A_RESULT_FAILED otherwise.
  *
- * \remarks
- * Call this function when finished using the capture.
+ * \see k4a_set_thread_pool_options()
  *
  * \xmlonly
  * <requirements>
@@ -348,18 +370,25 @@ K4A_EXPORT k4a_result_t k4a_capture_create(k4a_capture_t *capture_handle);
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT void k4a_capture_release(k4a_capture_t capture_handle);
+K4A_EXPORT k4a_result_t k4a_get_thread_pool_options(k4a_thread_pool_options_t *options);
 
-/** Add a reference to a capture.
+/** Shares USB event handling between all devices opened afterwards.
  *
- * \param capture_handle
- * Capture to add a reference to.
+ * \param thread_count
+ * Number of shared USB event threads, up to 16. 0 restores the default of one event thread per stream.
  *
- * \relates k4a_capture_t
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the mode was set. ::K4A_RESULT_FAILED if \p thread_count is out of range.
  *
  * \remarks
- * Call this function to add an additional reference to a capture. This reference must be removed with
- * k4a_capture_release().
+ * By default each depth and IMU stream has its own libusb context and event thread. With \p thread_count greater than
+ * 0 the streams of every device opened afterwards are spread over \p thread_count shared libusb contexts, each
+ * serviced by a single thread. On hosts with many devices this keeps thread wakeups proportional to \p thread_count
+ * rather than to the number of streams.
+ *
+ * \remarks
+ * Devices that are already open keep the event handling they were opened with. Shared event threads use the
+ * ::K4A_SDK_THREAD_DEPTH_USB policy set with k4a_set_thread_policy().
  *
  * \xmlonly
  * <requirements>
@@ -369,18 +398,22 @@ K4A_EXPORT void k4a_capture_release(k4a_capture_t capture_handle);
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT void k4a_capture_reference(k4a_capture_t capture_handle);
+K4A_EXPORT k4a_result_t k4a_set_usb_event_thread_count(uint32_t thread_count);
 
-/** Get the color image associated with the given capture.
+/** Starts loading the depth engine in the background.
  *
- * \param capture_handle
- * Capture handle containing the image.
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the depth engine is loading or loaded. ::K4A_RESULT_FAILED if the background thread could
+ * not be created.
  *
- * \relates k4a_capture_t
+ * \remarks
+ * The depth engine is a large plugin library that is otherwise loaded by the first k4a_device_open(). Calling this
+ * function at application start moves the load off the path of opening the first device. The function does not wait
+ * for the load to finish, a k4a_device_open() made while it is loading waits for it instead.
  *
  * \remarks
- * Call this function to access the color image part of this capture. Release the \ref k4a_image_t with
- * k4a_image_release();
+ * The depth engine is loaded once per process and shared by every device. Calling this function again has no effect.
+ * A depth engine that fails to load is reported by k4a_device_start_cameras().
  *
  * \xmlonly
  * <requirements>
@@ -390,18 +423,22 @@ K4A_EXPORT void k4a_capture_reference(k4a_capture_t capture_handle);
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT k4a_image_t k4a_capture_get_color_image(k4a_capture_t capture_handle);
+K4A_EXPORT k4a_result_t k4a_preload_depth_engine(void);
 
-/** Get the depth image associated with the given capture.
+/** Starts recording a trace of the SDK's capture pipeline.
  *
- * \param capture_handle
- * Capture handle containing the image.
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if tracing was started.
  *
- * \relates k4a_capture_t
+ * \remarks
+ * While tracing, each stage a frame passes through records timed events: the USB transfer, the depth engine, the color
+ * decode, capture synchronization and k4a_device_get_capture(). Events carry the frame's system timestamp in
+ * nanoseconds, so the stages of one frame can be followed across threads. Events of a previous trace that was not saved
+ * are discarded.
  *
  * \remarks
- * Call this function to access the depth image part of this capture. Release the \ref k4a_image_t with
- * k4a_image_release();
+ * Each thread records into its own fixed size buffer. Events recorded after a thread's buffer is full are dropped, and
+ * the number dropped is written to the trace.
  *
  * \xmlonly
  * <requirements>
@@ -411,18 +448,20 @@ K4A_EXPORT k4a_image_t k4a_capture_get_color_image(k4a_capture_t capture_handle)
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT k4a_image_t k4a_capture_get_depth_image(k4a_capture_t capture_handle);
+K4A_EXPORT k4a_result_t k4a_tracing_start(void);
 
-/** Get the IR image associated with the given capture.
+/** Stops recording a trace of the SDK's capture pipeline and saves it.
  *
- * \param capture_handle
- * Capture handle containing the image.
+ * \param path
+ * File the trace is written to, NULL to discard the trace.
  *
- * \relates k4a_capture_t
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if tracing was stopped and the trace was written. ::K4A_RESULT_FAILED if the file could not
+ * be written.
  *
  * \remarks
- * Call this function to access the IR image part of this capture. Release the \ref k4a_image_t with
- * k4a_image_release();
+ * The trace is written in the Chrome trace event JSON format, which can be opened with chrome://tracing or the Perfetto
+ * UI.
  *
  * \xmlonly
  * <requirements>
@@ -432,33 +471,30 @@ K4A_EXPORT k4a_image_t k4a_capture_get_depth_image(k4a_capture_t capture_handle)
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT k4a_image_t k4a_capture_get_ir_image(k4a_capture_t capture_handle);
+K4A_EXPORT k4a_result_t k4a_tracing_stop(const char *path);
 
-/** Set or add a color image to the associated capture.
+/** Open an Azure Kinect device.
  *
- * \param capture_handle
- * Capture handle to hold the image.
+ * \param index
+ * The index of the device to open, starting with 0. Optionally pass in #K4A_DEVICE_DEFAULT.
  *
- * \param image_handle
- * Image handle containing the image.
+ * \param device_handle
+ * Output parameter which on success will return a handle to the device.
  *
- * \relates k4a_capture_t
+ * \relates k4a_device_t
  *
- * \remarks
- * When a \ref k4a_image_t is added to a \ref k4a_capture_t, the \ref k4a_capture_t will automatically add a reference
- * to the \ref k4a_image_t.
+ * \return ::K4A_RESULT_SUCCEEDED if the device was opened successfully.
  *
  * \remarks
- * If there is already a color image contained in the capture, the existing image will be dereferenced and replaced with
- * the new image.
+ * If successful, k4a_device_open() will return a device handle in the device_handle parameter.
+ * This handle grants exclusive access to the device and may be used in the other Azure Kinect API calls.
  *
  * \remarks
- * To remove a color image to the capture without adding a new image, this function can be called with a NULL
- * image_handle.
+ * If the K4A_CALIBRATION_CACHE environment variable names an existing directory, the device calibration is saved there
+ * and later opens of the same device, with the same firmware, load it instead of reading it from the device.
  *
  * \remarks
- * Any \ref k4a_image_t contained in this \ref k4a_capture_t will automatically be dereferenced when all references to
- * the \ref k4a_capture_t are released with k4a_capture_release().
+ * When done with the device, close the handle with k4a_device_close()
  *
  * \xmlonly
  * <requirements>
@@ -468,33 +504,30 @@ K4A_EXPORT k4a_image_t k4a_capture_get_ir_image(k4a_capture_t capture_handle);
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT void k4a_capture_set_color_image(k4a_capture_t capture_handle, k4a_image_t image_handle);
+K4A_EXPORT k4a_result_t k4a_device_open(uint32_t index, k4a_device_t *device_handle);
 
-/** Set or add a depth image to the associated capture.
+/** Open the Azure Kinect device with the given serial number.
  *
- * \param capture_handle
- * Capture handle to hold the image.
+ * \param serial_number
+ * NULL terminated serial number of the device to open, as returned by k4a_device_get_serialnum().
  *
- * \param image_handle
- * Image handle containing the image.
+ * \param device_handle
+ * Output parameter which on success will return a handle to the device.
  *
- * \relates k4a_capture_t
+ * \relates k4a_device_t
  *
- * \remarks
- * When a \ref k4a_image_t is added to a \ref k4a_capture_t, the \ref k4a_capture_t will automatically add a reference
- * to the \ref k4a_image_t.
+ * \return ::K4A_RESULT_SUCCEEDED if the device was opened successfully.
  *
  * \remarks
- * If there is already an image depth image contained in the capture, the existing image will be dereferenced and
- * replaced with the new image.
+ * The serial number is looked up with k4a_device_enumerate(), so only the matching device is opened. Devices whose
+ * serial number could not be read are opened one at a time when no listed device matches.
  *
  * \remarks
- * To remove a depth image to the capture without adding a new image, this function can be called with a NULL
- * image_handle.
+ * If successful, k4a_device_open_by_serial() will return a device handle in the device_handle parameter.
+ * This handle grants exclusive access to the device and may be used in the other Azure Kinect API calls.
  *
  * \remarks
- * Any \ref k4a_image_t contained in this \ref k4a_capture_t will automatically be dereferenced when all references to
- * the \ref k4a_capture_t are released with k4a_capture_release().
+ * When done with the device, close the handle with k4a_device_close()
  *
  * \xmlonly
  * <requirements>
@@ -504,32 +537,19 @@ K4A_EXPORT void k4a_capture_set_color_image(k4a_capture_t capture_handle, k4a_im
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT void k4a_capture_set_depth_image(k4a_capture_t capture_handle, k4a_image_t image_handle);
+K4A_EXPORT k4a_result_t k4a_device_open_by_serial(const char *serial_number, k4a_device_t *device_handle);
 
-/** Set or add an IR image to the associated capture.
+/** Closes an Azure Kinect device.
  *
- * \param capture_handle
- * Capture handle to hold the image.
+ * \param device_handle
+ * Handle obtained by k4a_device_open().
  *
- * \param image_handle
- * Image handle containing the image.
+ * \relates k4a_device_t
  *
- * \relates k4a_capture_t
- *
- * \remarks
- * When a \ref k4a_image_t is added to a \ref k4a_capture_t, the \ref k4a_capture_t will automatically add a reference
- * to the \ref k4a_image_t.
- *
- * \remarks
- * If there is already an IR image contained in the capture, the existing image will be dereferenced and replaced with
- * the new image.
- *
- * \remarks
- * To remove a IR image to the capture without adding a new image, this function can be called with a NULL image_handle.
+ * \remarks Once closed, the handle is no longer valid.
  *
- * \remarks
- * Any \ref k4a_image_t contained in this \ref k4a_capture_t will automatically be dereferenced when all references to
- * the \ref k4a_capture_t are released with k4a_capture_release().
+ * \remarks Before closing the handle to the device, ensure that all \ref k4a_capture_t captures have been released with
+ * k4a_capture_release().
  *
  * \xmlonly
  * <requirements>
@@ -539,38 +559,57 @@ K4A_EXPORT void k4a_capture_set_depth_image(k4a_capture_t capture_handle, k4a_im
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT void k4a_capture_set_ir_image(k4a_capture_t capture_handle, k4a_image_t image_handle);
+K4A_EXPORT void k4a_device_close(k4a_device_t device_handle);
 
-/** Set the temperature associated with the capture.
+/** Reads a sensor capture.
+ *
+ * \param device_handle
+ * Handle obtained by k4a_device_open().
  *
  * \param capture_handle
- * Capture handle to set the temperature on.
+ * If successful this contains a handle to a capture object. Caller must call k4a_capture_release() when its done using
+ * this capture.
  *
- * \param temperature_c
- * Temperature in Celsius to store.
+ * \param timeout_in_ms
+ * Specifies the time in milliseconds the function should block waiting for the capture. If set to 0, the function will
+ * return without blocking. Passing a value of #K4A_WAIT_INFINITE will block indefinitely until data is available, the
+ * device is disconnected, or another error occurs.
  *
- * \relates k4a_capture_t
+ * \returns
+ * ::K4A_WAIT_RESULT_SUCCEEDED if a capture is returned. If a capture is not available before the timeout elapses, the
+ * function will return ::K4A_WAIT_RESULT_TIMEOUT. All other failures will return ::K4A_WAIT_RESULT_FAILED.
  *
- * \xmlonly
- * <requirements>
- *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
- *   <requirement name="Library">k4a.lib</requirement>
- *   <requirement name="DLL">k4a.dll</requirement>
- * </requirements>
- * \endxmlonly
- */
-K4A_EXPORT void k4a_capture_set_temperature_c(k4a_capture_t capture_handle, float temperature_c);
-
-/** Get the temperature associated with the capture.
+ * \relates k4a_device_t
  *
- * \param capture_handle
- * Capture handle to retrieve the temperature from.
+ * \remarks
+ * Gets the next capture in the streamed sequence of captures from the camera. If a new capture is not currently
+ * available, this function will block until the timeout is reached. The SDK will buffer at least two captures worth
+ * of data before dropping the oldest capture. Callers needing to capture all data need to ensure they read the data as
+ * fast as the data is being produced on average.
  *
- * \return
- * This function returns the temperature of the device at the time of the capture in Celsius. If
- * the temperature is unavailable, the function will return NAN.
+ * \remarks
+ * Upon successfully reading a capture this function will return success and populate \p capture.
+ * If a capture is not available in the configured \p timeout_in_ms, then the API will return ::K4A_WAIT_RESULT_TIMEOUT.
  *
- * \relates k4a_capture_t
+ * \remarks
+ * If the call is successful and a capture is returned, callers must call k4a_capture_release() to return the allocated
+ * memory.
+ *
+ * \remarks
+ * This function needs to be called while the device is in a running state;
+ * after k4a_device_start_cameras() is called and before k4a_device_stop_cameras() is called.
+ *
+ * \remarks
+ * This function returns an error when an internal problem is encountered; such as loss of the USB connection, inability
+ * to allocate enough memory, and other unexpected issues. Any error returned by this function signals the end of
+ * streaming data, and caller should stop the stream using k4a_device_stop_cameras().
+ *
+ * \remarks
+ * If this function is waiting for data (non-zero timeout) when k4a_device_stop_cameras() or k4a_device_close() is
+ * called on another thread, this function will return an error.
+ *
+ * \returns ::K4A_WAIT_RESULT_SUCCEEDED if a capture is returned. If a capture is not available before the timeout
+ * elapses, the function will return ::K4A_WAIT_RESULT_TIMEOUT. All other failures will return ::K4A_WAIT_RESULT_FAILED.
  *
  * \xmlonly
  * <requirements>
@@ -579,50 +618,57 @@ K4A_EXPORT void k4a_capture_set_temperature_c(k4a_capture_t capture_handle, floa
  *   <requirement name="DLL">k4a.dll</requirement>
  * </requirements>
  * \endxmlonly
+ *
  */
-K4A_EXPORT float k4a_capture_get_temperature_c(k4a_capture_t capture_handle);
+K4A_EXPORT k4a_wait_result_t k4a_device_get_capture(k4a_device_t device_handle,
+                                                    k4a_capture_t *capture_handle,
+                                                    int32_t timeout_in_ms);
 
-/** Create an image.
+/** Reads an IMU sample.
  *
- * \param format
- * The format of the image that will be stored in this image container.
+ * \param device_handle
+ * Handle obtained by k4a_device_open().
  *
- * \param width_pixels
- * Width in pixels.
+ * \param imu_sample
+ * Pointer to the location for the API to write the IMU sample.
  *
- * \param height_pixels
- * Height in pixels.
+ * \param timeout_in_ms
+ * Specifies the time in milliseconds the function should block waiting for the sample. If set to 0, the function will
+ * return without blocking. Passing a value of #K4A_WAIT_INFINITE will block indefinitely until data is available, the
+ * device is disconnected, or another error occurs.
  *
- * \param stride_bytes
- * The number of bytes per horizontal line of the image.
- * If set to 0, the stride will be set to the minimum size given the \p format and \p width_pixels.
+ * \returns
+ * ::K4A_WAIT_RESULT_SUCCEEDED if a sample is returned. If a sample is not available before the timeout elapses, the
+ * function will return ::K4A_WAIT_RESULT_TIMEOUT. All other failures will return ::K4A_WAIT_RESULT_FAILED.
  *
- * \param image_handle
- * Pointer to store image handle in.
+ * \relates k4a_device_t
  *
  * \remarks
- * This function is used to create images of formats that have consistent stride. The function is not suitable for
- * compressed formats that may not be represented by the same number of bytes per line.
+ * Gets the next sample in the streamed sequence of IMU samples from the device. If a new sample is not currently
+ * available, this function will block until the timeout is reached. The API will buffer at least two camera capture
+ * intervals worth of samples before dropping the oldest sample. Callers needing to capture all data need to ensure they
+ * read the data as fast as the data is being produced on average.
  *
  * \remarks
- * For most image formats, the function will allocate an image buffer of size \p height_pixels * \p stride_bytes.
- * Buffers #K4A_IMAGE_FORMAT_COLOR_NV12 format will allocate an additional \p height_pixels / 2 set of lines (each of \p
- * stride_bytes). This function cannot be used to allocate #K4A_IMAGE_FORMAT_COLOR_MJPG buffers.
+ * Upon successfully reading a sample this function will return success and populate \p imu_sample.
+ * If a sample is not available in the configured \p timeout_in_ms, then the API will return ::K4A_WAIT_RESULT_TIMEOUT.
  *
  * \remarks
- * To create an image object without the API allocating memory, or to represent an image that has a non-deterministic
- * stride, use k4a_image_create_from_buffer().
+ * This function needs to be called while the device is in a running state;
+ * after k4a_device_start_imu() is called and before k4a_device_stop_imu() is called.
  *
  * \remarks
- * The \ref k4a_image_t is created with a reference count of 1.
+ * This function returns an error when an internal problem is encountered; such as loss of the USB connection, inability
+ * to allocate enough memory, and other unexpected issues. Any error returned by this function signals the end of
+ * streaming data, and caller should stop the stream using k4a_device_stop_imu().
  *
  * \remarks
- * When finished using the created image, release it with k4a_image_release.
- *
- * \returns
- * Returns #K4A_RESULT_SUCCEEDED on success. Errors are indicated with #K4A_RESULT_FAILED.
+ * If this function is waiting for data (non-zero timeout) when k4a_device_stop_imu() or k4a_device_close() is
+ * called on another thread, this function will return an error.
  *
- * \relates k4a_image_t
+ * \remarks
+ * The memory the IMU sample is written to is allocated and owned by the caller, so there is no need to call an Azure
+ * Kinect API to free or release the sample.
  *
  * \xmlonly
  * <requirements>
@@ -632,59 +678,48 @@ K4A_EXPORT float k4a_capture_get_temperature_c(k4a_capture_t capture_handle);
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT k4a_result_t k4a_image_create(k4a_image_format_t format,
-                                         int width_pixels,
-                                         int height_pixels,
-                                         int stride_bytes,
-                                         k4a_image_t *image_handle);
+K4A_EXPORT k4a_wait_result_t k4a_device_get_imu_sample(k4a_device_t device_handle,
+                                                       k4a_imu_sample_t *imu_sample,
+                                                       int32_t timeout_in_ms);
 
-/** Create an image from a pre-allocated buffer.
- *
- * \param format
- * The format of the image that will be stored in this image container.
- *
- * \param width_pixels
- * Width in pixels.
+/** Reads all of the IMU samples currently available, up to a maximum count.
  *
- * \param height_pixels
- * Height in pixels.
+ * \param device_handle
+ * Handle obtained by k4a_device_open().
  *
- * \param stride_bytes
- * The number of bytes per horizontal line of the image.
+ * \param imu_samples
+ * Pointer to an array of \p max_samples samples to receive the IMU data.
  *
- * \param buffer
- * Pointer to a pre-allocated image buffer.
+ * \param max_samples
+ * Number of samples \p imu_samples can hold.
  *
- * \param buffer_size
- * Size in bytes of the pre-allocated image buffer.
+ * \param sample_count
+ * Location to write the number of samples returned in \p imu_samples.
  *
- * \param buffer_release_cb
- * Callback to the buffer free function, called when all references to the buffer have been released. This parameter is
- * optional.
+ * \param timeout_in_ms
+ * Specifies the time in milliseconds the function should block waiting for the first sample. If set to 0, the function
+ * will return without blocking. Passing a value of #K4A_WAIT_INFINITE will block indefinitely until data is available,
+ * the device is disconnected, or another error occurs.
  *
- * \param buffer_release_cb_context
- * Context for the buffer free function. This value will be called as a parameter to \p buffer_release_cb when
- * the callback is invoked.
+ * \returns
+ * ::K4A_WAIT_RESULT_SUCCEEDED if at least one sample is returned. If no sample is available before the timeout
+ * elapses, the function will return ::K4A_WAIT_RESULT_TIMEOUT. All other failures will return
+ * ::K4A_WAIT_RESULT_FAILED.
  *
- * \param image_handle
- * Pointer to store image handle in.
+ * \relates k4a_device_t
  *
  * \remarks
- * This function creates a \ref k4a_image_t from a pre-allocated buffer. When all references to this object reach zero
- * the provided \p buffer_release_cb callback function is called so that the memory can be released. If this function
- * fails, the API will not use the memory provided in \p buffer, and the API will not call \p buffer_release_cb.
+ * This function behaves like k4a_device_get_imu_sample() except that once the first sample is available, every sample
+ * already buffered is returned in the same call, oldest first, up to \p max_samples. It only waits for the first
+ * sample. Callers that drain the IMU stream after every capture should use this function instead of calling
+ * k4a_device_get_imu_sample() in a loop.
  *
  * \remarks
- * The \ref k4a_image_t is created with a reference count of 1.
+ * \p sample_count is set to 0 when ::K4A_WAIT_RESULT_TIMEOUT or ::K4A_WAIT_RESULT_FAILED is returned.
  *
  * \remarks
- * Release the reference on this function with k4a_image_release().
- *
- * \returns
- * Returns #K4A_RESULT_SUCCEEDED on success. Errors are indicated with #K4A_RESULT_FAILED and error specific data can be
- * found in the log.
- *
- * \relates k4a_image_t
+ * This function needs to be called while the device is in a running state;
+ * after k4a_device_start_imu() is called and before k4a_device_stop_imu() is called.
  *
  * \xmlonly
  * <requirements>
@@ -694,30 +729,39 @@ K4A_EXPORT k4a_result_t k4a_image_create(k4a_image_format_t format,
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT k4a_result_t k4a_image_create_from_buffer(k4a_image_format_t format,
-                                                     int width_pixels,
-                                                     int height_pixels,
-                                                     int stride_bytes,
-                                                     uint8_t *buffer,
-                                                     size_t buffer_size,
-                                                     k4a_memory_destroy_cb_t *buffer_release_cb,
-                                                     void *buffer_release_cb_context,
-                                                     k4a_image_t *image_handle);
+K4A_EXPORT k4a_wait_result_t k4a_device_get_imu_samples(k4a_device_t device_handle,
+                                                        k4a_imu_sample_t *imu_samples,
+                                                        size_t max_samples,
+                                                        size_t *sample_count,
+                                                        int32_t timeout_in_ms);
 
-/** Get the image buffer.
+/** Reads the most recent IMU sample, skipping the older samples that are buffered.
  *
- * \param image_handle
- * Handle of the image for which the get operation is performed on.
+ * \param device_handle
+ * Handle obtained by k4a_device_open().
  *
- * \remarks
- * Use this buffer to access the raw image data.
+ * \param imu_sample
+ * Pointer to the location for the API to write the IMU sample.
+ *
+ * \param timeout_in_ms
+ * Specifies the time in milliseconds the function should block waiting for a sample when none is buffered. If set to
+ * 0, the function will return without blocking. Passing a value of #K4A_WAIT_INFINITE will block indefinitely until
+ * data is available, the device is disconnected, or another error occurs.
  *
  * \returns
- * The function will return NULL if there is an error, and will normally return a pointer to the image buffer.
- * Since all \ref k4a_image_t instances are created with an image buffer, this function should only return NULL if the
- * \p image_handle is invalid.
+ * ::K4A_WAIT_RESULT_SUCCEEDED if a sample is returned. If a sample is not available before the timeout elapses, the
+ * function will return ::K4A_WAIT_RESULT_TIMEOUT. All other failures will return ::K4A_WAIT_RESULT_FAILED.
  *
- * \relates k4a_image_t
+ * \relates k4a_device_t
+ *
+ * \remarks
+ * This function behaves like k4a_device_get_imu_sample() except that the newest buffered sample is returned, and every
+ * sample buffered before it is discarded. Callers that only need the current motion state get it without draining the
+ * buffer first.
+ *
+ * \remarks
+ * This function needs to be called while the device is in a running state;
+ * after k4a_device_start_imu() is called and before k4a_device_stop_imu() is called.
  *
  * \xmlonly
  * <requirements>
@@ -727,22 +771,39 @@ K4A_EXPORT k4a_result_t k4a_image_create_from_buffer(k4a_image_format_t format,
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT uint8_t *k4a_image_get_buffer(k4a_image_t image_handle);
+K4A_EXPORT k4a_wait_result_t k4a_device_get_latest_imu_sample(k4a_device_t device_handle,
+                                                              k4a_imu_sample_t *imu_sample,
+                                                              int32_t timeout_in_ms);
 
-/** Get the image buffer size.
+/** Get an operating system object that is signaled while k4a_device_get_capture() has a capture to return.
  *
- * \param image_handle
- * Handle of the image for which the get operation is performed on.
+ * \param device_handle
+ * Handle obtained by k4a_device_open().
  *
- * \remarks
- * Use this function to know what the size of the image buffer is returned by k4a_image_get_buffer().
+ * \param wait_handle
+ * Location to write the handle to. On Windows it is an event HANDLE, on Linux an eventfd file descriptor that polls
+ * as readable. The handle is owned by the device and stays valid until k4a_device_close().
  *
  * \returns
- * The function will return 0 if there is an error, and will normally return the image size.
- * Since all \ref k4a_image_t instances are created with an image buffer, this function should only return 0 if the
- * \p image_handle is invalid.
+ * ::K4A_RESULT_SUCCEEDED if the handle was written. ::K4A_RESULT_FAILED if the operating system object could not be
+ * created.
  *
- * \relates k4a_image_t
+ * \relates k4a_device_t
+ *
+ * \remarks
+ * One thread can wait on the handles of many devices with WaitForMultipleObjects(), poll() or epoll, then call
+ * k4a_device_get_capture() with a timeout of 0 on the devices that are signaled. The handle stays signaled until the
+ * queue of captures is empty, so it behaves like a level triggered file descriptor. Another thread reading captures
+ * at the same time can make a wake up spurious, in which case k4a_device_get_capture() returns
+ * ::K4A_WAIT_RESULT_TIMEOUT.
+ *
+ * \remarks
+ * The handle is also signaled while the cameras are stopped, k4a_device_get_capture() then returns
+ * ::K4A_WAIT_RESULT_FAILED and the handle should be removed from the wait. It is not signaled by captures delivered
+ * through k4a_device_set_capture_callback().
+ *
+ * \remarks
+ * The handle must not be closed, read from or written to by the caller.
  *
  * \xmlonly
  * <requirements>
@@ -752,21 +813,26 @@ K4A_EXPORT uint8_t *k4a_image_get_buffer(k4a_image_t image_handle);
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT size_t k4a_image_get_size(k4a_image_t image_handle);
+K4A_EXPORT k4a_result_t k4a_device_get_capture_wait_handle(k4a_device_t device_handle, k4a_wait_handle_t *wait_handle);
 
-/** Get the format of the image.
+/** Get an operating system object that is signaled while k4a_device_get_imu_sample() has a sample to return.
  *
- * \param image_handle
- * Handle of the image for which the get operation is performed on.
+ * \param device_handle
+ * Handle obtained by k4a_device_open().
  *
- * \remarks
- * Use this function to determine the format of the image buffer.
+ * \param wait_handle
+ * Location to write the handle to. The handle is owned by the device and stays valid until k4a_device_close().
  *
  * \returns
- * This function is not expected to fail, all \ref k4a_image_t's are created with a known format. If the
- * \p image_handle is invalid, the function will return ::K4A_IMAGE_FORMAT_CUSTOM.
+ * ::K4A_RESULT_SUCCEEDED if the handle was written. ::K4A_RESULT_FAILED if the operating system object could not be
+ * created.
  *
- * \relates k4a_image_t
+ * \relates k4a_device_t
+ *
+ * \remarks
+ * This function behaves like k4a_device_get_capture_wait_handle() for the IMU samples read with
+ * k4a_device_get_imu_sample(), k4a_device_get_imu_samples() and k4a_device_get_latest_imu_sample(). The handle is
+ * signaled while the IMU is stopped and is not signaled by samples delivered through k4a_device_set_imu_callback().
  *
  * \xmlonly
  * <requirements>
@@ -776,18 +842,34 @@ K4A_EXPORT size_t k4a_image_get_size(k4a_image_t image_handle);
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT k4a_image_format_t k4a_image_get_format(k4a_image_t image_handle);
+K4A_EXPORT k4a_result_t k4a_device_get_imu_wait_handle(k4a_device_t device_handle, k4a_wait_handle_t *wait_handle);
 
-/** Get the image width in pixels.
+/** Deliver captures from the device to a callback instead of k4a_device_get_capture().
  *
- * \param image_handle
- * Handle of the image for which the get operation is performed on.
+ * \param device_handle
+ * Handle obtained by k4a_device_open().
+ *
+ * \param callback
+ * Function called with each capture, NULL to return to reading captures with k4a_device_get_capture().
+ *
+ * \param context
+ * Context passed to every call to \p callback.
  *
  * \returns
- * This function is not expected to fail, all \ref k4a_image_t's are created with a known width. If the \p
- * image_handle is invalid, the function will return 0.
+ * ::K4A_RESULT_SUCCEEDED if the callback was set or cleared. ::K4A_RESULT_FAILED if the cameras are running.
  *
- * \relates k4a_image_t
+ * \relates k4a_device_t
+ *
+ * \remarks
+ * Captures are handed to \p callback as soon as they are synchronized, without passing through the queue that
+ * k4a_device_get_capture() reads from. k4a_device_get_capture() does not return any captures while a callback is set.
+ *
+ * \remarks
+ * \p callback runs on an SDK thread, one capture at a time and in order. It should return quickly, as no further
+ * captures are processed while it runs and captures arriving in the meantime may be dropped. The capture is only
+ * valid for the duration of the call, use k4a_capture_reference() to keep it. \p callback must not call
+ * k4a_device_stop_cameras() or k4a_device_close(). After k4a_device_stop_cameras() returns, \p callback is not called
+ * again.
  *
  * \xmlonly
  * <requirements>
@@ -797,18 +879,35 @@ K4A_EXPORT k4a_image_format_t k4a_image_get_format(k4a_image_t image_handle);
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT int k4a_image_get_width_pixels(k4a_image_t image_handle);
+K4A_EXPORT k4a_result_t k4a_device_set_capture_callback(k4a_device_t device_handle,
+                                                        k4a_capture_ready_cb_t *callback,
+                                                        void *context);
 
-/** Get the image height in pixels.
+/** Deliver IMU samples from the device to a callback instead of k4a_device_get_imu_sample().
  *
- * \param image_handle
- * Handle of the image for which the get operation is performed on.
+ * \param device_handle
+ * Handle obtained by k4a_device_open().
+ *
+ * \param callback
+ * Function called with each IMU sample, NULL to return to reading samples with k4a_device_get_imu_sample().
+ *
+ * \param context
+ * Context passed to every call to \p callback.
  *
  * \returns
- * This function is not expected to fail, all \ref k4a_image_t's are created with a known height. If the \p
- * image_handle is invalid, the function will return 0.
+ * ::K4A_RESULT_SUCCEEDED if the callback was set or cleared. ::K4A_RESULT_FAILED if the IMU is running.
  *
- * \relates k4a_image_t
+ * \relates k4a_device_t
+ *
+ * \remarks
+ * Samples are handed to \p callback as they are decoded, without passing through the IMU queue.
+ * k4a_device_get_imu_sample() and k4a_device_get_imu_samples() do not return any samples while a callback is set.
+ *
+ * \remarks
+ * \p callback runs on the IMU streaming thread, one sample at a time and in order. It should return quickly, as
+ * further USB transfers are not processed while it runs. The sample is only valid for the duration of the call.
+ * \p callback must not call k4a_device_stop_imu() or k4a_device_close(). After k4a_device_stop_imu() returns,
+ * \p callback is not called again.
  *
  * \xmlonly
  * <requirements>
@@ -818,18 +917,28 @@ K4A_EXPORT int k4a_image_get_width_pixels(k4a_image_t image_handle);
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT int k4a_image_get_height_pixels(k4a_image_t image_handle);
+K4A_EXPORT k4a_result_t k4a_device_set_imu_callback(k4a_device_t device_handle,
+                                                    k4a_imu_sample_ready_cb_t *callback,
+                                                    void *context);
 
-/** Get the image stride in bytes.
+/** Enable or disable the preintegration of the IMU motion in the SDK.
  *
- * \param image_handle
- * Handle of the image for which the get operation is performed on.
+ * \param device_handle
+ * Handle obtained by k4a_device_open().
+ *
+ * \param enabled
+ * true to integrate the IMU samples as they arrive, false to stop and free the motion history.
  *
  * \returns
- * This function is not expected to fail, all \ref k4a_image_t's are created with a known stride. If the
- * \p image_handle is invalid, or the image's format does not have a stride, the function will return 0.
+ * ::K4A_RESULT_SUCCEEDED if the preintegration was enabled or disabled. ::K4A_RESULT_FAILED if the IMU is running.
  *
- * \relates k4a_image_t
+ * \relates k4a_device_t
+ *
+ * \remarks
+ * While enabled, the calibrated samples are integrated once each on the IMU streaming thread, before they are queued
+ * or passed to the IMU callback. k4a_device_get_imu_preintegration() then returns the motion between any two device
+ * timestamps of the last 2 seconds, for instance between two depth frames, without the application reading and
+ * integrating the samples itself.
  *
  * \xmlonly
  * <requirements>
@@ -839,26 +948,37 @@ K4A_EXPORT int k4a_image_get_height_pixels(k4a_image_t image_handle);
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT int k4a_image_get_stride_bytes(k4a_image_t image_handle);
+K4A_EXPORT k4a_result_t k4a_device_set_imu_preintegration(k4a_device_t device_handle, bool enabled);
 
-/** Get the image's device timestamp in microseconds.
+/** Get the motion of the IMU between two device timestamps.
  *
- * \param image_handle
- * Handle of the image for which the get operation is performed on.
+ * \param device_handle
+ * Handle obtained by k4a_device_open().
  *
- * \remarks
- * Returns the device timestamp of the image. Timestamps are recorded by the device and represent the mid-point of
- * exposure. They may be used for relative comparison, but their absolute value has no defined meaning.
+ * \param start_timestamp_usec
+ * Device timestamp the motion starts at, in microseconds. It must be within the last 2 seconds of IMU samples.
+ *
+ * \param end_timestamp_usec
+ * Device timestamp the motion ends at, in microseconds. It must not be before \p start_timestamp_usec.
+ *
+ * \param preintegration
+ * Location to write the motion to.
+ *
+ * \param timeout_in_ms
+ * Specifies the time in milliseconds to wait for an IMU sample at or after \p end_timestamp_usec. 0 returns
+ * immediately and ::K4A_WAIT_INFINITE waits until the sample arrives or the IMU stops.
  *
  * \returns
- * If the \p image_handle is invalid or if no timestamp was set for the image,
- * this function will return 0. It is also possible for 0 to be a valid timestamp originating from the beginning
- * of a recording or the start of streaming.
+ * ::K4A_WAIT_RESULT_SUCCEEDED if the motion was written to \p preintegration. ::K4A_WAIT_RESULT_TIMEOUT if no IMU
+ * sample reached \p end_timestamp_usec in time. ::K4A_WAIT_RESULT_FAILED if preintegration was not enabled with
+ * k4a_device_set_imu_preintegration(), the IMU stopped or \p start_timestamp_usec is older than the motion history.
  *
- * \deprecated
- * Deprecated starting in 1.2.0. Please use k4a_image_get_device_timestamp_usec().
+ * \relates k4a_device_t
  *
- * \relates k4a_image_t
+ * \remarks
+ * The motion is interpolated at both timestamps, so they need not fall on IMU samples. Pass the device timestamps of
+ * two captures to get the motion between them. See \ref k4a_imu_preintegration_t for the coordinate system and the
+ * handling of gravity.
  *
  * \xmlonly
  * <requirements>
@@ -868,23 +988,27 @@ K4A_EXPORT int k4a_image_get_stride_bytes(k4a_image_t image_handle);
  * </requirements>
  * \endxmlonly
  */
-K4A_DEPRECATED_EXPORT uint64_t k4a_image_get_timestamp_usec(k4a_image_t image_handle);
+K4A_EXPORT k4a_wait_result_t k4a_device_get_imu_preintegration(k4a_device_t device_handle,
+                                                               uint64_t start_timestamp_usec,
+                                                               uint64_t end_timestamp_usec,
+                                                               k4a_imu_preintegration_t *preintegration,
+                                                               int32_t timeout_in_ms);
 
-/** Get the image's device timestamp in microseconds.
+/** Create an empty capture object.
  *
- * \param image_handle
- * Handle of the image for which the get operation is performed on.
+ * \param capture_handle
+ * Pointer to a location to store the handle.
+ *
+ * \relates k4a_capture_t
  *
  * \remarks
- * Returns the device timestamp of the image, as captured by the hardware. Timestamps are recorded by the device and
- * represent the mid-point of exposure. They may be used for relative comparison, but their absolute value has no
- * defined meaning.
+ * Call this function to create a \ref k4a_capture_t handle for a new capture. Release it with k4a_capture_release().
  *
- * \returns
- * If the \p image_handle is invalid or if no timestamp was set for the image, this function will return 0. It is also
- * possible for 0 to be a valid timestamp originating from the beginning of a recording or the start of streaming.
+ * The new capture is created with a reference count of 1.
  *
- * \relates k4a_image_t
+ * \returns
+ * Returns #K4A_RESULT_SUCCEEDED on success. Errors are indicated with #K4A_RESULT_FAILED and error specific data can be
+ * found in the log.
  *
  * \xmlonly
  * <requirements>
@@ -894,32 +1018,38 @@ K4A_DEPRECATED_EXPORT uint64_t k4a_image_get_timestamp_usec(k4a_image_t image_ha
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT uint64_t k4a_image_get_device_timestamp_usec(k4a_image_t image_handle);
+K4A_EXPORT k4a_result_t k4a_capture_create(k4a_capture_t *capture_handle);
 
-/** Get the image's system timestamp in nanoseconds.
+/** Release a capture.
  *
- * \param image_handle
- * Handle of the image for which the get operation is performed on.
+ * \param capture_handle
+ * Capture to release.
  *
- * \remarks
- * Returns the system timestamp of the image. Timestamps are recorded by the host. They may be used for relative
- * comparision, as they are relative to the corresponding system clock. The absolute value is a monotonic count from
- * an arbitrary point in the past.
+ * \relates k4a_capture_t
  *
  * \remarks
- * The system timestamp is captured at the moment host PC finishes receiving the image.
+ * Call this function when finished using the capture.
  *
- * \remarks
- * On Linux the system timestamp is read from clock_gettime(CLOCK_MONOTONIC), which measures realtime and is not
- * impacted by adjustments to the system clock. It starts from an arbitrary point in the past. On Windows the system
- * timestamp is read from QueryPerformanceCounter(), it also measures realtime and is not impacted by adjustments to the
- * system clock. It also starts from an arbitrary point in the past.
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT void k4a_capture_release(k4a_capture_t capture_handle);
+
+/** Add a reference to a capture.
  *
- * \returns
- * If the \p image_handle is invalid or if no timestamp was set for the image, this function will return 0. It is also
- * possible for 0 to be a valid timestamp originating from the beginning of a recording or the start of streaming.
+ * \param capture_handle
+ * Capture to add a reference to.
  *
- * \relates k4a_image_t
+ * \relates k4a_capture_t
+ *
+ * \remarks
+ * Call this function to add an additional reference to a capture. This reference must be removed with
+ * k4a_capture_release().
  *
  * \xmlonly
  * <requirements>
@@ -929,21 +1059,18 @@ K4A_EXPORT uint64_t k4a_image_get_device_timestamp_usec(k4a_image_t image_handle
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT uint64_t k4a_image_get_system_timestamp_nsec(k4a_image_t image_handle);
+K4A_EXPORT void k4a_capture_reference(k4a_capture_t capture_handle);
 
-/** Get the image exposure in microseconds.
- *
- * \param image_handle
- * Handle of the image for which the get operation is performed on.
+/** Get the color image associated with the given capture.
  *
- * \remarks
- * Returns an exposure time in microseconds. This is only supported on color image formats.
+ * \param capture_handle
+ * Capture handle containing the image.
  *
- * \returns
- * If the \p image_handle is invalid, or no exposure was set on the image, the function will return 0. Otherwise,
- * it will return the image exposure time in microseconds.
+ * \relates k4a_capture_t
  *
- * \relates k4a_image_t
+ * \remarks
+ * Call this function to access the color image part of this capture. Release the \ref k4a_image_t with
+ * k4a_image_release();
  *
  * \xmlonly
  * <requirements>
@@ -953,21 +1080,18 @@ K4A_EXPORT uint64_t k4a_image_get_system_timestamp_nsec(k4a_image_t image_handle
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT uint64_t k4a_image_get_exposure_usec(k4a_image_t image_handle);
+K4A_EXPORT k4a_image_t k4a_capture_get_color_image(k4a_capture_t capture_handle);
 
-/** Get the image white balance.
- *
- * \param image_handle
- * Handle of the image for which the get operation is performed on.
+/** Get the depth image associated with the given capture.
  *
- * \remarks
- * Returns the image's white balance. This function is only valid for color captures, and not for depth or IR captures.
+ * \param capture_handle
+ * Capture handle containing the image.
  *
- * \returns
- * Returns the image white balance in Kelvin. If \p image_handle is invalid, or the white balance was not set or
- * not applicable to the image, the function will return 0.
+ * \relates k4a_capture_t
  *
- * \relates k4a_image_t
+ * \remarks
+ * Call this function to access the depth image part of this capture. Release the \ref k4a_image_t with
+ * k4a_image_release();
  *
  * \xmlonly
  * <requirements>
@@ -977,20 +1101,18 @@ K4A_EXPORT uint64_t k4a_image_get_exposure_usec(k4a_image_t image_handle);
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT uint32_t k4a_image_get_white_balance(k4a_image_t image_handle);
+K4A_EXPORT k4a_image_t k4a_capture_get_depth_image(k4a_capture_t capture_handle);
 
-/** Get the image ISO speed.
- *
- * \param image_handle
- * Handle of the image for which the get operation is performed on.
+/** Get the IR image associated with the given capture.
  *
- * \remarks
- * This function is only valid for color captures, and not for depth  or IR captures.
+ * \param capture_handle
+ * Capture handle containing the image.
  *
- * \returns
- * Returns the ISO speed of the image. 0 indicates the ISO speed was not available or an error occurred.
+ * \relates k4a_capture_t
  *
- * \relates k4a_image_t
+ * \remarks
+ * Call this function to access the IR image part of this capture. Release the \ref k4a_image_t with
+ * k4a_image_release();
  *
  * \xmlonly
  * <requirements>
@@ -1000,24 +1122,26 @@ K4A_EXPORT uint32_t k4a_image_get_white_balance(k4a_image_t image_handle);
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT uint32_t k4a_image_get_iso_speed(k4a_image_t image_handle);
+K4A_EXPORT k4a_image_t k4a_capture_get_ir_image(k4a_capture_t capture_handle);
 
-/** Set the device time stamp, in microseconds, of the image.
+/** Get the IMU samples attached to the given capture.
  *
- * \param image_handle
- * Handle of the image to set the timestamp on.
+ * \param capture_handle
+ * Capture handle containing the samples.
  *
- * \param timestamp_usec
- * Device timestamp of the image in microseconds.
+ * \returns
+ * An image holding the samples, or NULL if the capture has no IMU samples attached.
  *
- * \remarks
- * Use this function in conjunction with k4a_image_create() or k4a_image_create_from_buffer() to construct a
- * \ref k4a_image_t.
+ * \relates k4a_capture_t
  *
  * \remarks
- * The device timestamp represents the mid-point of exposure of the image, as captured by the hardware.
+ * Captures of a device started with k4a_device_start_options_t::attach_imu_samples hold the IMU samples taken since
+ * the previous capture, up to the device timestamp of the capture. The image is a ::K4A_IMAGE_FORMAT_CUSTOM image with
+ * a width of the number of samples, a height of 1, and a buffer holding an array of \ref k4a_imu_sample_t. Its device
+ * timestamp is the one the samples were attached up to.
  *
- * \relates k4a_image_t
+ * \remarks
+ * Release the \ref k4a_image_t with k4a_image_release().
  *
  * \xmlonly
  * <requirements>
@@ -1027,27 +1151,33 @@ K4A_EXPORT uint32_t k4a_image_get_iso_speed(k4a_image_t image_handle);
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT void k4a_image_set_device_timestamp_usec(k4a_image_t image_handle, uint64_t timestamp_usec);
+K4A_EXPORT k4a_image_t k4a_capture_get_imu_samples_image(k4a_capture_t capture_handle);
 
-/** Set the device time stamp, in microseconds, of the image.
+/** Set or add a color image to the associated capture.
+ *
+ * \param capture_handle
+ * Capture handle to hold the image.
  *
  * \param image_handle
- * Handle of the image to set the timestamp on.
+ * Image handle containing the image.
  *
- * \param timestamp_usec
- * Device timestamp of the image in microseconds.
+ * \relates k4a_capture_t
  *
  * \remarks
- * Use this function in conjunction with k4a_image_create() or k4a_image_create_from_buffer() to construct a
- * \ref k4a_image_t.
+ * When a \ref k4a_image_t is added to a \ref k4a_capture_t, the \ref k4a_capture_t will automatically add a reference
+ * to the \ref k4a_image_t.
  *
  * \remarks
- * The device timestamp represents the mid-point of exposure of the image, as captured by the hardware.
+ * If there is already a color image contained in the capture, the existing image will be dereferenced and replaced with
+ * the new image.
  *
- * \relates k4a_image_t
+ * \remarks
+ * To remove a color image to the capture without adding a new image, this function can be called with a NULL
+ * image_handle.
  *
- * \deprecated
- * Deprecated starting in 1.2.0. Please use k4a_image_set_device_timestamp_usec().
+ * \remarks
+ * Any \ref k4a_image_t contained in this \ref k4a_capture_t will automatically be dereferenced when all references to
+ * the \ref k4a_capture_t are released with k4a_capture_release().
  *
  * \xmlonly
  * <requirements>
@@ -1057,25 +1187,33 @@ K4A_EXPORT void k4a_image_set_device_timestamp_usec(k4a_image_t image_handle, ui
  * </requirements>
  * \endxmlonly
  */
-K4A_DEPRECATED_EXPORT void k4a_image_set_timestamp_usec(k4a_image_t image_handle, uint64_t timestamp_usec);
+K4A_EXPORT void k4a_capture_set_color_image(k4a_capture_t capture_handle, k4a_image_t image_handle);
 
-/** Set the system time stamp, in nanoseconds, of the image.
+/** Set or add a depth image to the associated capture.
+ *
+ * \param capture_handle
+ * Capture handle to hold the image.
  *
  * \param image_handle
- * Handle of the image to set the timestamp on.
+ * Image handle containing the image.
  *
- * \param timestamp_nsec
- * Timestamp of the image in nanoseconds.
+ * \relates k4a_capture_t
  *
  * \remarks
- * Use this function in conjunction with k4a_image_create() or k4a_image_create_from_buffer() to construct a
- * \ref k4a_image_t.
+ * When a \ref k4a_image_t is added to a \ref k4a_capture_t, the \ref k4a_capture_t will automatically add a reference
+ * to the \ref k4a_image_t.
  *
  * \remarks
- * The system timestamp is a high performance and increasing clock (from boot). The timestamp represents the time
- * immediately after the image buffer was read by the host PC.
+ * If there is already an image depth image contained in the capture, the existing image will be dereferenced and
+ * replaced with the new image.
  *
- * \relates k4a_image_t
+ * \remarks
+ * To remove a depth image to the capture without adding a new image, this function can be called with a NULL
+ * image_handle.
+ *
+ * \remarks
+ * Any \ref k4a_image_t contained in this \ref k4a_capture_t will automatically be dereferenced when all references to
+ * the \ref k4a_capture_t are released with k4a_capture_release().
  *
  * \xmlonly
  * <requirements>
@@ -1085,22 +1223,32 @@ K4A_DEPRECATED_EXPORT void k4a_image_set_timestamp_usec(k4a_image_t image_handle
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT void k4a_image_set_system_timestamp_nsec(k4a_image_t image_handle, uint64_t timestamp_nsec);
+K4A_EXPORT void k4a_capture_set_depth_image(k4a_capture_t capture_handle, k4a_image_t image_handle);
 
-/** Set the exposure time, in microseconds, of the image.
+/** Set or add an IR image to the associated capture.
+ *
+ * \param capture_handle
+ * Capture handle to hold the image.
  *
  * \param image_handle
- * Handle of the image to set the exposure time on.
+ * Image handle containing the image.
  *
- * \param exposure_usec
- * Exposure time of the image in microseconds.
+ * \relates k4a_capture_t
  *
  * \remarks
- * Use this function in conjunction with k4a_image_create() or k4a_image_create_from_buffer() to construct a
- * \ref k4a_image_t. An exposure time of 0 is considered invalid. Only color image formats are expected to have a valid
- * exposure time.
+ * When a \ref k4a_image_t is added to a \ref k4a_capture_t, the \ref k4a_capture_t will automatically add a reference
+ * to the \ref k4a_image_t.
  *
- * \relates k4a_image_t
+ * \remarks
+ * If there is already an IR image contained in the capture, the existing image will be dereferenced and replaced with
+ * the new image.
+ *
+ * \remarks
+ * To remove a IR image to the capture without adding a new image, this function can be called with a NULL image_handle.
+ *
+ * \remarks
+ * Any \ref k4a_image_t contained in this \ref k4a_capture_t will automatically be dereferenced when all references to
+ * the \ref k4a_capture_t are released with k4a_capture_release().
  *
  * \xmlonly
  * <requirements>
@@ -1110,25 +1258,29 @@ K4A_EXPORT void k4a_image_set_system_timestamp_nsec(k4a_image_t image_handle, ui
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT void k4a_image_set_exposure_usec(k4a_image_t image_handle, uint64_t exposure_usec);
+K4A_EXPORT void k4a_capture_set_ir_image(k4a_capture_t capture_handle, k4a_image_t image_handle);
 
-/** Set the exposure time, in microseconds, of the image.
+/** Set or add an image of IMU samples to the associated capture.
+ *
+ * \param capture_handle
+ * Capture handle to hold the image.
  *
  * \param image_handle
- * Handle of the image to set the exposure time on.
+ * Image handle containing an array of \ref k4a_imu_sample_t, see k4a_capture_get_imu_samples_image().
  *
- * \param exposure_usec
- * Exposure time of the image in microseconds.
+ * \relates k4a_capture_t
  *
  * \remarks
- * Use this function in conjunction with k4a_image_create() or k4a_image_create_from_buffer() to construct a
- * \ref k4a_image_t. An exposure time of 0 is considered invalid. Only color image formats are expected to have a valid
- * exposure time.
+ * When a \ref k4a_image_t is added to a \ref k4a_capture_t, the \ref k4a_capture_t will automatically add a reference
+ * to the \ref k4a_image_t.
  *
- * \deprecated
- * Deprecated starting in 1.2.0. Please use k4a_image_set_exposure_usec().
+ * \remarks
+ * If there is already an image of IMU samples contained in the capture, the existing image will be dereferenced and
+ * replaced with the new image.
  *
- * \relates k4a_image_t
+ * \remarks
+ * To remove the IMU samples from the capture without adding a new image, this function can be called with a NULL
+ * image_handle.
  *
  * \xmlonly
  * <requirements>
@@ -1138,22 +1290,17 @@ K4A_EXPORT void k4a_image_set_exposure_usec(k4a_image_t image_handle, uint64_t e
  * </requirements>
  * \endxmlonly
  */
-K4A_DEPRECATED_EXPORT void k4a_image_set_exposure_time_usec(k4a_image_t image_handle, uint64_t exposure_usec);
+K4A_EXPORT void k4a_capture_set_imu_samples_image(k4a_capture_t capture_handle, k4a_image_t image_handle);
 
-/** Set the white balance of the image.
- *
- * \param image_handle
- * Handle of the image to set the white balance on.
+/** Set the temperature associated with the capture.
  *
- * \param white_balance
- * White balance of the image in degrees Kelvin.
+ * \param capture_handle
+ * Capture handle to set the temperature on.
  *
- * \remarks
- * Use this function in conjunction with k4a_image_create() or k4a_image_create_from_buffer() to construct a
- * \ref k4a_image_t. A white balance of 0 is considered invalid. White balance is only meaningful for color images,
- * and not expected on depth or IR images.
+ * \param temperature_c
+ * Temperature in Celsius to store.
  *
- * \relates k4a_image_t
+ * \relates k4a_capture_t
  *
  * \xmlonly
  * <requirements>
@@ -1163,21 +1310,18 @@ K4A_DEPRECATED_EXPORT void k4a_image_set_exposure_time_usec(k4a_image_t image_ha
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT void k4a_image_set_white_balance(k4a_image_t image_handle, uint32_t white_balance);
+K4A_EXPORT void k4a_capture_set_temperature_c(k4a_capture_t capture_handle, float temperature_c);
 
-/** Set the ISO speed of the image.
- *
- * \param image_handle
- * Handle of the image to set the ISO speed on.
+/** Get the temperature associated with the capture.
  *
- * \param iso_speed
- * ISO speed of the image.
+ * \param capture_handle
+ * Capture handle to retrieve the temperature from.
  *
- * \remarks
- * Use this function in conjunction with k4a_image_create() or k4a_image_create_from_buffer() to construct a
- * \ref k4a_image_t. An ISO speed of 0 is considered invalid. Only color images are expected to have a valid ISO speed.
+ * \return
+ * This function returns the temperature of the device at the time of the capture in Celsius. If
+ * the temperature is unavailable, the function will return NAN.
  *
- * \relates k4a_image_t
+ * \relates k4a_capture_t
  *
  * \xmlonly
  * <requirements>
@@ -1187,18 +1331,30 @@ K4A_EXPORT void k4a_image_set_white_balance(k4a_image_t image_handle, uint32_t w
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT void k4a_image_set_iso_speed(k4a_image_t image_handle, uint32_t iso_speed);
+K4A_EXPORT float k4a_capture_get_temperature_c(k4a_capture_t capture_handle);
 
-/** Add a reference to the k4a_image_t.
+/** Get the buffers and layouts of the capture's color, depth and IR images in one call.
  *
- * \param image_handle
- * Handle of the image for which the get operation is performed on.
+ * \param capture_handle
+ * Capture handle to retrieve the images from.
  *
- * \remarks
- * References manage the lifetime of the object. When the references reach zero the object is destroyed. A caller must
- * not access the object after its reference is released.
+ * \param version
+ * Layout of \p view the application was built with, pass #K4A_VIEW_VERSION.
  *
- * \relates k4a_image_t
+ * \param view
+ * Location to write the views to. A missing image has a NULL buffer.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if \p view was filled in. ::K4A_RESULT_FAILED if \p capture_handle is invalid, \p view is
+ * NULL or \p version is not supported by this SDK.
+ *
+ * \relates k4a_capture_t
+ *
+ * \remarks
+ * The handles are validated once, replacing the k4a_capture_get_*_image(), k4a_image_get_buffer(),
+ * k4a_image_get_stride_bytes() and k4a_image_release() calls otherwise made for each image of each frame. No
+ * references are taken, the view is valid while the application holds \p capture_handle and does not replace its
+ * images. k4a/k4a_unchecked.h has inline accessors for the pixels of a view.
  *
  * \xmlonly
  * <requirements>
@@ -1208,16 +1364,50 @@ K4A_EXPORT void k4a_image_set_iso_speed(k4a_image_t image_handle, uint32_t iso_s
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT void k4a_image_reference(k4a_image_t image_handle);
+K4A_EXPORT k4a_result_t k4a_capture_get_view(k4a_capture_t capture_handle, uint32_t version, k4a_capture_view_t *view);
 
-/** Remove a reference from the k4a_image_t.
+/** Create an image.
+ *
+ * \param format
+ * The format of the image that will be stored in this image container.
+ *
+ * \param width_pixels
+ * Width in pixels.
+ *
+ * \param height_pixels
+ * Height in pixels.
+ *
+ * \param stride_bytes
+ * The number of bytes per horizontal line of the image.
+ * If set to 0, the stride will be set to the minimum size given the \p format and \p width_pixels.
  *
  * \param image_handle
- * Handle of the image for which the get operation is performed on.
+ * Pointer to store image handle in.
  *
  * \remarks
- * References manage the lifetime of the object. When the references reach zero the object is destroyed. A caller must
- * not access the object after its reference is released.
+ * This function is used to create images of formats that have consistent stride. The function is not suitable for
+ * compressed formats that may not be represented by the same number of bytes per line.
+ *
+ * \remarks
+ * For most image formats, the function will allocate an image buffer of size \p height_pixels * \p stride_bytes.
+ * Buffers #K4A_IMAGE_FORMAT_COLOR_NV12 format will allocate an additional \p height_pixels / 2 set of lines (each of \p
+ * stride_bytes). This function cannot be used to allocate #K4A_IMAGE_FORMAT_COLOR_MJPG buffers.
+ *
+ * \remarks
+ * To create an image object without the API allocating memory, or to represent an image that has a non-deterministic
+ * stride, use k4a_image_create_from_buffer().
+ *
+ * \remarks
+ * The image buffer is aligned to #K4A_IMAGE_BUFFER_ALIGNMENT bytes.
+ *
+ * \remarks
+ * The \ref k4a_image_t is created with a reference count of 1.
+ *
+ * \remarks
+ * When finished using the created image, release it with k4a_image_release.
+ *
+ * \returns
+ * Returns #K4A_RESULT_SUCCEEDED on success. Errors are indicated with #K4A_RESULT_FAILED.
  *
  * \relates k4a_image_t
  *
@@ -1229,27 +1419,43 @@ K4A_EXPORT void k4a_image_reference(k4a_image_t image_handle);
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT void k4a_image_release(k4a_image_t image_handle);
+K4A_EXPORT k4a_result_t k4a_image_create(k4a_image_format_t format,
+                                         int width_pixels,
+                                         int height_pixels,
+                                         int stride_bytes,
+                                         k4a_image_t *image_handle);
 
-/** Starts color and depth camera capture.
+/** Create an image with an aligned buffer.
  *
- * \param device_handle
- * Handle obtained by k4a_device_open().
+ * \param format
+ * The format of the image that will be stored in this image container.
  *
- * \param config
- * The configuration we want to run the device in. This can be initialized with ::K4A_DEVICE_CONFIG_INIT_DISABLE_ALL.
+ * \param width_pixels
+ * Width in pixels.
  *
- * \returns
- * ::K4A_RESULT_SUCCEEDED is returned on success.
+ * \param height_pixels
+ * Height in pixels.
  *
- * \relates k4a_device_t
+ * \param stride_bytes
+ * The number of bytes per horizontal line of the image.
+ * If set to 0, the stride will be set to the minimum size given the \p format and \p width_pixels, rounded up to a
+ * multiple of \p alignment.
  *
- * \remarks
- * Individual sensors configured to run will now start to stream captured data.
+ * \param alignment
+ * Alignment of the image buffer in bytes. Must be a power of 2 no larger than 65536.
+ *
+ * \param image_handle
+ * Pointer to store image handle in.
  *
  * \remarks
- * It is not valid to call k4a_device_start_cameras() a second time on the same \ref k4a_device_t until
- * k4a_device_stop_cameras() has been called.
+ * This function behaves like k4a_image_create() and additionally aligns the start of the image buffer, for example to
+ * 4096 bytes for unbuffered file I/O or pinned memory uploads. When \p stride_bytes is 0 every line is aligned as
+ * well. Pass an explicit \p stride_bytes to keep lines packed.
+ *
+ * \returns
+ * Returns #K4A_RESULT_SUCCEEDED on success. Errors are indicated with #K4A_RESULT_FAILED.
+ *
+ * \relates k4a_image_t
  *
  * \xmlonly
  * <requirements>
@@ -1259,22 +1465,60 @@ K4A_EXPORT void k4a_image_release(k4a_image_t image_handle);
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT k4a_result_t k4a_device_start_cameras(k4a_device_t device_handle, const k4a_device_configuration_t *config);
+K4A_EXPORT k4a_result_t k4a_image_create_aligned(k4a_image_format_t format,
+                                                 int width_pixels,
+                                                 int height_pixels,
+                                                 int stride_bytes,
+                                                 size_t alignment,
+                                                 k4a_image_t *image_handle);
 
-/** Stops the color and depth camera capture.
+/** Create an image from a pre-allocated buffer.
  *
- * \param device_handle
- * Handle obtained by k4a_device_open().
+ * \param format
+ * The format of the image that will be stored in this image container.
  *
- * \relates k4a_device_t
+ * \param width_pixels
+ * Width in pixels.
+ *
+ * \param height_pixels
+ * Height in pixels.
+ *
+ * \param stride_bytes
+ * The number of bytes per horizontal line of the image.
+ *
+ * \param buffer
+ * Pointer to a pre-allocated image buffer.
+ *
+ * \param buffer_size
+ * Size in bytes of the pre-allocated image buffer.
+ *
+ * \param buffer_release_cb
+ * Callback to the buffer free function, called when all references to the buffer have been released. This parameter is
+ * optional.
+ *
+ * \param buffer_release_cb_context
+ * Context for the buffer free function. This value will be called as a parameter to \p buffer_release_cb when
+ * the callback is invoked.
+ *
+ * \param image_handle
+ * Pointer to store image handle in.
  *
  * \remarks
- * The streaming of individual sensors stops as a result of this call. Once called, k4a_device_start_cameras() may
- * be called again to resume sensor streaming.
+ * This function creates a \ref k4a_image_t from a pre-allocated buffer. When all references to this object reach zero
+ * the provided \p buffer_release_cb callback function is called so that the memory can be released. If this function
+ * fails, the API will not use the memory provided in \p buffer, and the API will not call \p buffer_release_cb.
  *
  * \remarks
- * This function may be called while another thread is blocking in k4a_device_get_capture().
- * Calling this function while another thread is in that function will result in that function returning a failure.
+ * The \ref k4a_image_t is created with a reference count of 1.
+ *
+ * \remarks
+ * Release the reference on this function with k4a_image_release().
+ *
+ * \returns
+ * Returns #K4A_RESULT_SUCCEEDED on success. Errors are indicated with #K4A_RESULT_FAILED and error specific data can be
+ * found in the log.
+ *
+ * \relates k4a_image_t
  *
  * \xmlonly
  * <requirements>
@@ -1284,26 +1528,56 @@ K4A_EXPORT k4a_result_t k4a_device_start_cameras(k4a_device_t device_handle, con
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT void k4a_device_stop_cameras(k4a_device_t device_handle);
+K4A_EXPORT k4a_result_t k4a_image_create_from_buffer(k4a_image_format_t format,
+                                                     int width_pixels,
+                                                     int height_pixels,
+                                                     int stride_bytes,
+                                                     uint8_t *buffer,
+                                                     size_t buffer_size,
+                                                     k4a_memory_destroy_cb_t *buffer_release_cb,
+                                                     void *buffer_release_cb_context,
+                                                     k4a_image_t *image_handle);
 
-/** Starts the IMU sample stream.
+/** Create an image of a rectangle of another image that shares its buffer.
  *
- * \param device_handle
- * Handle obtained by k4a_device_open().
+ * \param parent_handle
+ * Handle of the image to create the view of.
  *
- * \returns
- * ::K4A_RESULT_SUCCEEDED is returned on success. ::K4A_RESULT_FAILED if the sensor is already running or a failure is
- * encountered
+ * \param x
+ * Column of the top left pixel of the view in \p parent_handle.
  *
- * \relates k4a_device_t
+ * \param y
+ * Row of the top left pixel of the view in \p parent_handle.
+ *
+ * \param width_pixels
+ * Width of the view in pixels.
+ *
+ * \param height_pixels
+ * Height of the view in pixels.
+ *
+ * \param image_handle
+ * Pointer to store the view's image handle in.
  *
  * \remarks
- * Call this API to start streaming IMU data. It is not valid to call this function a second time on the same
- * \ref k4a_device_t until k4a_device_stop_imu() has been called.
+ * No pixels are copied. The view points into the buffer of \p parent_handle, has its stride, format, timestamps and
+ * metadata, and holds a reference on it until the view is released. Writes through either image are visible in both.
  *
  * \remarks
- * This function is dependent on the state of the cameras. The color or depth camera must be started before the IMU.
- * ::K4A_RESULT_FAILED will be returned if one of the cameras is not running.
+ * The rectangle must lie within \p parent_handle. Views of #K4A_IMAGE_FORMAT_COLOR_YUY2 images need an even \p x and
+ * \p width_pixels. Views of #K4A_IMAGE_FORMAT_COLOR_NV12 images are #K4A_IMAGE_FORMAT_CUSTOM8 images of the Y plane.
+ * #K4A_IMAGE_FORMAT_COLOR_MJPG and custom images have no constant pixel size and can't be viewed.
+ *
+ * \remarks
+ * Views can be passed to the k4a_transformation functions, which handle their stride.
+ *
+ * \remarks
+ * Release the reference on this function with k4a_image_release().
+ *
+ * \returns
+ * Returns #K4A_RESULT_SUCCEEDED on success. Errors are indicated with #K4A_RESULT_FAILED and error specific data can be
+ * found in the log.
+ *
+ * \relates k4a_image_t
  *
  * \xmlonly
  * <requirements>
@@ -1313,22 +1587,27 @@ K4A_EXPORT void k4a_device_stop_cameras(k4a_device_t device_handle);
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT k4a_result_t k4a_device_start_imu(k4a_device_t device_handle);
+K4A_EXPORT k4a_result_t k4a_image_create_view(k4a_image_t parent_handle,
+                                              int x,
+                                              int y,
+                                              int width_pixels,
+                                              int height_pixels,
+                                              k4a_image_t *image_handle);
 
-/** Stops the IMU capture.
- *
- * \param device_handle
- * Handle obtained by k4a_device_open().
+/** Get the image buffer.
  *
- * \relates k4a_device_t
+ * \param image_handle
+ * Handle of the image for which the get operation is performed on.
  *
  * \remarks
- * The streaming of the IMU stops as a result of this call. Once called, k4a_device_start_imu() may
- * be called again to resume sensor streaming, so long as the cameras are running.
+ * Use this buffer to access the raw image data.
  *
- * \remarks
- * This function may be called while another thread is blocking in k4a_device_get_imu_sample().
- * Calling this function while another thread is in that function will result in that function returning a failure.
+ * \returns
+ * The function will return NULL if there is an error, and will normally return a pointer to the image buffer.
+ * Since all \ref k4a_image_t instances are created with an image buffer, this function should only return NULL if the
+ * \p image_handle is invalid.
+ *
+ * \relates k4a_image_t
  *
  * \xmlonly
  * <requirements>
@@ -1338,37 +1617,22 @@ K4A_EXPORT k4a_result_t k4a_device_start_imu(k4a_device_t device_handle);
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT void k4a_device_stop_imu(k4a_device_t device_handle);
+K4A_EXPORT uint8_t *k4a_image_get_buffer(k4a_image_t image_handle);
 
-/** Get the Azure Kinect device serial number.
- *
- * \param device_handle
- * Handle obtained by k4a_device_open().
+/** Get the image buffer size.
  *
- * \param serial_number
- * Location to write the serial number to. If the function returns ::K4A_BUFFER_RESULT_SUCCEEDED, this will be a NULL
- * terminated string of ASCII characters. If this input is NULL \p serial_number_size will still be updated to return
- * the size of the buffer needed to store the string.
+ * \param image_handle
+ * Handle of the image for which the get operation is performed on.
  *
- * \param serial_number_size
- * On input, the size of the \p serial_number buffer if that pointer is not NULL. On output, this value is set to the
- * actual number of bytes in the serial number (including the null terminator).
+ * \remarks
+ * Use this function to know what the size of the image buffer is returned by k4a_image_get_buffer().
  *
  * \returns
- * A return of ::K4A_BUFFER_RESULT_SUCCEEDED means that the \p serial_number has been filled in. If the buffer is too
- * small the function returns ::K4A_BUFFER_RESULT_TOO_SMALL and the size of the serial number is
- * returned in the \p serial_number_size parameter. All other failures return ::K4A_BUFFER_RESULT_FAILED.
- *
- * \relates k4a_device_t
- *
- * \remarks
- * Queries the device for its serial number. If the caller needs to know the size of the serial number to allocate
- * memory, the function should be called once with a NULL \p serial_number to get the needed size in the \p
- * serial_number_size output, and then again with the allocated buffer.
+ * The function will return 0 if there is an error, and will normally return the image size.
+ * Since all \ref k4a_image_t instances are created with an image buffer, this function should only return 0 if the
+ * \p image_handle is invalid.
  *
- * \remarks
- * Only a complete serial number will be returned. If the caller's buffer is too small, the function will return
- * ::K4A_BUFFER_RESULT_TOO_SMALL without returning any data in \p serial_number.
+ * \relates k4a_image_t
  *
  * \xmlonly
  * <requirements>
@@ -1378,22 +1642,21 @@ K4A_EXPORT void k4a_device_stop_imu(k4a_device_t device_handle);
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT k4a_buffer_result_t k4a_device_get_serialnum(k4a_device_t device_handle,
-                                                        char *serial_number,
-                                                        size_t *serial_number_size);
+K4A_EXPORT size_t k4a_image_get_size(k4a_image_t image_handle);
 
-/** Get the version numbers of the device's subsystems.
+/** Get the format of the image.
  *
- * \param device_handle
- * Handle obtained by k4a_device_open().
+ * \param image_handle
+ * Handle of the image for which the get operation is performed on.
  *
- * \param version
- * Location to write the version info to.
+ * \remarks
+ * Use this function to determine the format of the image buffer.
  *
- * \returns A return of ::K4A_RESULT_SUCCEEDED means that the version structure has been filled in.
- * All other failures return ::K4A_RESULT_FAILED.
+ * \returns
+ * This function is not expected to fail, all \ref k4a_image_t's are created with a known format. If the
+ * \p image_handle is invalid, the function will return ::K4A_IMAGE_FORMAT_CUSTOM.
  *
- * \relates k4a_device_t
+ * \relates k4a_image_t
  *
  * \xmlonly
  * <requirements>
@@ -1403,39 +1666,39 @@ K4A_EXPORT k4a_buffer_result_t k4a_device_get_serialnum(k4a_device_t device_hand
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT k4a_result_t k4a_device_get_version(k4a_device_t device_handle, k4a_hardware_version_t *version);
+K4A_EXPORT k4a_image_format_t k4a_image_get_format(k4a_image_t image_handle);
 
-/** Get the Azure Kinect color sensor control capabilities.
- *
- * \param device_handle
- * Handle obtained by k4a_device_open().
- *
- * \param command
- * Color sensor control command.
- *
- * \param supports_auto
- * Location to store whether the color sensor's control support auto mode or not.
- * true if it supports auto mode, otherwise false.
+/** Get the image width in pixels.
  *
- * \param min_value
- * Location to store the color sensor's control minimum value of /p command.
+ * \param image_handle
+ * Handle of the image for which the get operation is performed on.
  *
- * \param max_value
- * Location to store the color sensor's control maximum value of /p command.
+ * \returns
+ * This function is not expected to fail, all \ref k4a_image_t's are created with a known width. If the \p
+ * image_handle is invalid, the function will return 0.
  *
- * \param step_value
- * Location to store the color sensor's control step value of /p command.
+ * \relates k4a_image_t
  *
- * \param default_value
- * Location to store the color sensor's control default value of /p command.
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT int k4a_image_get_width_pixels(k4a_image_t image_handle);
+
+/** Get the image height in pixels.
  *
- * \param default_mode
- * Location to store the color sensor's control default mode of /p command.
+ * \param image_handle
+ * Handle of the image for which the get operation is performed on.
  *
  * \returns
- * ::K4A_RESULT_SUCCEEDED if the value was successfully returned, ::K4A_RESULT_FAILED if an error occurred
+ * This function is not expected to fail, all \ref k4a_image_t's are created with a known height. If the \p
+ * image_handle is invalid, the function will return 0.
  *
- * \relates k4a_device_t
+ * \relates k4a_image_t
  *
  * \xmlonly
  * <requirements>
@@ -1445,48 +1708,47 @@ K4A_EXPORT k4a_result_t k4a_device_get_version(k4a_device_t device_handle, k4a_h
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT k4a_result_t k4a_device_get_color_control_capabilities(k4a_device_t device_handle,
-                                                                  k4a_color_control_command_t command,
-                                                                  bool *supports_auto,
-                                                                  int32_t *min_value,
-                                                                  int32_t *max_value,
-                                                                  int32_t *step_value,
-                                                                  int32_t *default_value,
-                                                                  k4a_color_control_mode_t *default_mode);
+K4A_EXPORT int k4a_image_get_height_pixels(k4a_image_t image_handle);
 
-/** Get the Azure Kinect color sensor control
- * value.
+/** Get the image stride in bytes.
  *
- * \param device_handle
- * Handle obtained by k4a_device_open().
+ * \param image_handle
+ * Handle of the image for which the get operation is performed on.
  *
- * \param command
- * Color sensor control command.
+ * \returns
+ * This function is not expected to fail, all \ref k4a_image_t's are created with a known stride. If the
+ * \p image_handle is invalid, or the image's format does not have a stride, the function will return 0.
  *
- * \param mode
- * Location to store the color sensor's control mode. This mode represents whether the command is in automatic or
- * manual mode.
+ * \relates k4a_image_t
  *
- * \param value
- * Location to store the color sensor's control value. This value is always written, but is only valid when the \p
- * mode returned is ::K4A_COLOR_CONTROL_MODE_MANUAL for the current \p command.
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT int k4a_image_get_stride_bytes(k4a_image_t image_handle);
+
+/** Get the image's device timestamp in microseconds.
  *
- * \returns
- * ::K4A_RESULT_SUCCEEDED if the value was successfully returned, ::K4A_RESULT_FAILED if an error occurred
+ * \param image_handle
+ * Handle of the image for which the get operation is performed on.
  *
  * \remarks
- * Each control command may be set to manual or automatic. See the definition of \ref k4a_color_control_command_t on
- * how to interpret the \p value for each command.
+ * Returns the device timestamp of the image. Timestamps are recorded by the device and represent the mid-point of
+ * exposure. They may be used for relative comparison, but their absolute value has no defined meaning.
  *
- * \remarks
- * Some control commands are only supported in manual mode. When a command is in automatic mode, the \p value for
- * that command is not valid.
+ * \returns
+ * If the \p image_handle is invalid or if no timestamp was set for the image,
+ * this function will return 0. It is also possible for 0 to be a valid timestamp originating from the beginning
+ * of a recording or the start of streaming.
  *
- * \remarks
- * Control values set on a device are reset only when the device is power cycled. The device will retain the
- * settings even if the \ref k4a_device_t is closed or the application is restarted.
+ * \deprecated
+ * Deprecated starting in 1.2.0. Please use k4a_image_get_device_timestamp_usec().
  *
- * \relates k4a_device_t
+ * \relates k4a_image_t
  *
  * \xmlonly
  * <requirements>
@@ -1496,42 +1758,23 @@ K4A_EXPORT k4a_result_t k4a_device_get_color_control_capabilities(k4a_device_t d
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT k4a_result_t k4a_device_get_color_control(k4a_device_t device_handle,
-                                                     k4a_color_control_command_t command,
-                                                     k4a_color_control_mode_t *mode,
-                                                     int32_t *value);
+K4A_DEPRECATED_EXPORT uint64_t k4a_image_get_timestamp_usec(k4a_image_t image_handle);
 
-/** Set the Azure Kinect color sensor control value.
- *
- * \param device_handle
- * Handle obtained by k4a_device_open().
- *
- * \param command
- * Color sensor control command.
- *
- * \param mode
- * Color sensor control mode to set. This mode represents whether the command is in automatic or manual mode.
- *
- * \param value
- * Value to set the color sensor's control to. The value is only valid if \p mode
- * is set to ::K4A_COLOR_CONTROL_MODE_MANUAL, and is otherwise ignored.
- *
- * \returns
- * ::K4A_RESULT_SUCCEEDED if the value was successfully set, ::K4A_RESULT_FAILED if an error occurred
+/** Get the image's device timestamp in microseconds.
  *
- * \remarks
- * Each control command may be set to manual or automatic. See the definition of \ref k4a_color_control_command_t on how
- * to interpret the \p value for each command.
+ * \param image_handle
+ * Handle of the image for which the get operation is performed on.
  *
  * \remarks
- * Some control commands are only supported in manual mode. When a command is in automatic mode, the \p value for that
- * command is not valid.
+ * Returns the device timestamp of the image, as captured by the hardware. Timestamps are recorded by the device and
+ * represent the mid-point of exposure. They may be used for relative comparison, but their absolute value has no
+ * defined meaning.
  *
- * \remarks
- * Control values set on a device are reset only when the device is power cycled. The device will retain the settings
- * even if the \ref k4a_device_t is closed or the application is restarted.
+ * \returns
+ * If the \p image_handle is invalid or if no timestamp was set for the image, this function will return 0. It is also
+ * possible for 0 to be a valid timestamp originating from the beginning of a recording or the start of streaming.
  *
- * \relates k4a_device_t
+ * \relates k4a_image_t
  *
  * \xmlonly
  * <requirements>
@@ -1541,31 +1784,3436 @@ K4A_EXPORT k4a_result_t k4a_device_get_color_control(k4a_device_t device_handle,
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT k4a_result_t k4a_device_set_color_control(k4a_device_t device_handle,
-                                                     k4a_color_control_command_t command,
-                                                     k4a_color_control_mode_t mode,
-                                                     int32_t value);
+K4A_EXPORT uint64_t k4a_image_get_device_timestamp_usec(k4a_image_t image_handle);
 
-/** Get the raw calibration blob for the entire Azure Kinect device.
+/** Get the image's system timestamp in nanoseconds.
+ *
+ * \param image_handle
+ * Handle of the image for which the get operation is performed on.
+ *
+ * \remarks
+ * Returns the system timestamp of the image. Timestamps are recorded by the host. They may be used for relative
+ * comparision, as they are relative to the corresponding system clock. The absolute value is a monotonic count from
+ * an arbitrary point in the past.
+ *
+ * \remarks
+ * The system timestamp is captured at the moment host PC finishes receiving the image.
+ *
+ * \remarks
+ * On Linux the system timestamp is read from clock_gettime(CLOCK_MONOTONIC), which measures realtime and is not
+ * impacted by adjustments to the system clock. It starts from an arbitrary point in the past. On Windows the system
+ * timestamp is read from QueryPerformanceCounter(), it also measures realtime and is not impacted by adjustments to the
+ * system clock. It also starts from an arbitrary point in the past.
+ *
+ * \returns
+ * If the \p image_handle is invalid or if no timestamp was set for the image, this function will return 0. It is also
+ * possible for 0 to be a valid timestamp originating from the beginning of a recording or the start of streaming.
+ *
+ * \relates k4a_image_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT uint64_t k4a_image_get_system_timestamp_nsec(k4a_image_t image_handle);
+
+/** Get the host time at which the image passed a stage of the SDK's streaming pipeline, in nanoseconds.
+ *
+ * \param image_handle
+ * Handle of the image for which the get operation is performed on.
+ *
+ * \param stage
+ * The stage of the pipeline.
+ *
+ * \remarks
+ * The timestamps are read from the same clock as k4a_image_get_system_timestamp_nsec(), which is also the time of
+ * ::K4A_IMAGE_STAGE_USB_ARRIVAL. The differences between stages show where the latency of an image comes from.
+ *
+ * \returns
+ * The time the image passed \p stage, or 0 if the image didn't pass it. Images read from recordings or created by the
+ * application only have the timestamps set on them.
+ *
+ * \relates k4a_image_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT uint64_t k4a_image_get_stage_timestamp_nsec(k4a_image_t image_handle, k4a_image_stage_t stage);
+
+/** Get the image exposure in microseconds.
+ *
+ * \param image_handle
+ * Handle of the image for which the get operation is performed on.
+ *
+ * \remarks
+ * Returns an exposure time in microseconds. This is only supported on color image formats.
+ *
+ * \returns
+ * If the \p image_handle is invalid, or no exposure was set on the image, the function will return 0. Otherwise,
+ * it will return the image exposure time in microseconds.
+ *
+ * \relates k4a_image_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT uint64_t k4a_image_get_exposure_usec(k4a_image_t image_handle);
+
+/** Get the image white balance.
+ *
+ * \param image_handle
+ * Handle of the image for which the get operation is performed on.
+ *
+ * \remarks
+ * Returns the image's white balance. This function is only valid for color captures, and not for depth or IR captures.
+ *
+ * \returns
+ * Returns the image white balance in Kelvin. If \p image_handle is invalid, or the white balance was not set or
+ * not applicable to the image, the function will return 0.
+ *
+ * \relates k4a_image_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT uint32_t k4a_image_get_white_balance(k4a_image_t image_handle);
+
+/** Get the image ISO speed.
+ *
+ * \param image_handle
+ * Handle of the image for which the get operation is performed on.
+ *
+ * \remarks
+ * This function is only valid for color captures, and not for depth  or IR captures.
+ *
+ * \returns
+ * Returns the ISO speed of the image. 0 indicates the ISO speed was not available or an error occurred.
+ *
+ * \relates k4a_image_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT uint32_t k4a_image_get_iso_speed(k4a_image_t image_handle);
+
+/** Get all of the image's metadata in one call.
+ *
+ * \param image_handle
+ * Handle of the image for which the get operation is performed on.
+ *
+ * \param info
+ * Location to write the image's format, dimensions, size, timestamps, exposure, white balance and ISO speed.
+ *
+ * \remarks
+ * The fields hold the same values as the individual k4a_image_get_* functions, which is cheaper when a caller needs
+ * several of them for every frame.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if \p info was filled in. ::K4A_RESULT_FAILED if \p image_handle is invalid or \p info is
+ * NULL.
+ *
+ * \relates k4a_image_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_image_get_info(k4a_image_t image_handle, k4a_image_info_t *info);
+
+/** Get the image's buffer and layout in one call.
+ *
+ * \param image_handle
+ * Handle of the image for which the get operation is performed on.
+ *
+ * \param version
+ * Layout of \p view the application was built with, pass #K4A_VIEW_VERSION.
+ *
+ * \param view
+ * Location to write the image's buffer, size, format, dimensions, stride and timestamps.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if \p view was filled in. ::K4A_RESULT_FAILED if \p image_handle is invalid, \p view is NULL
+ * or \p version is not supported by this SDK.
+ *
+ * \relates k4a_image_t
+ *
+ * \remarks
+ * The view is valid while the application holds a reference to the image. k4a/k4a_unchecked.h has inline accessors
+ * for its pixels, which do not validate any handle.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_image_get_view(k4a_image_t image_handle, uint32_t version, k4a_image_view_t *view);
+
+/** Set the device time stamp, in microseconds, of the image.
+ *
+ * \param image_handle
+ * Handle of the image to set the timestamp on.
+ *
+ * \param timestamp_usec
+ * Device timestamp of the image in microseconds.
+ *
+ * \remarks
+ * Use this function in conjunction with k4a_image_create() or k4a_image_create_from_buffer() to construct a
+ * \ref k4a_image_t.
+ *
+ * \remarks
+ * The device timestamp represents the mid-point of exposure of the image, as captured by the hardware.
+ *
+ * \relates k4a_image_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT void k4a_image_set_device_timestamp_usec(k4a_image_t image_handle, uint64_t timestamp_usec);
+
+/** Set the device time stamp, in microseconds, of the image.
+ *
+ * \param image_handle
+ * Handle of the image to set the timestamp on.
+ *
+ * \param timestamp_usec
+ * Device timestamp of the image in microseconds.
+ *
+ * \remarks
+ * Use this function in conjunction with k4a_image_create() or k4a_image_create_from_buffer() to construct a
+ * \ref k4a_image_t.
+ *
+ * \remarks
+ * The device timestamp represents the mid-point of exposure of the image, as captured by the hardware.
+ *
+ * \relates k4a_image_t
+ *
+ * \deprecated
+ * Deprecated starting in 1.2.0. Please use k4a_image_set_device_timestamp_usec().
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_DEPRECATED_EXPORT void k4a_image_set_timestamp_usec(k4a_image_t image_handle, uint64_t timestamp_usec);
+
+/** Set the system time stamp, in nanoseconds, of the image.
+ *
+ * \param image_handle
+ * Handle of the image to set the timestamp on.
+ *
+ * \param timestamp_nsec
+ * Timestamp of the image in nanoseconds.
+ *
+ * \remarks
+ * Use this function in conjunction with k4a_image_create() or k4a_image_create_from_buffer() to construct a
+ * \ref k4a_image_t.
+ *
+ * \remarks
+ * The system timestamp is a high performance and increasing clock (from boot). The timestamp represents the time
+ * immediately after the image buffer was read by the host PC.
+ *
+ * \relates k4a_image_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT void k4a_image_set_system_timestamp_nsec(k4a_image_t image_handle, uint64_t timestamp_nsec);
+
+/** Set the exposure time, in microseconds, of the image.
+ *
+ * \param image_handle
+ * Handle of the image to set the exposure time on.
+ *
+ * \param exposure_usec
+ * Exposure time of the image in microseconds.
+ *
+ * \remarks
+ * Use this function in conjunction with k4a_image_create() or k4a_image_create_from_buffer() to construct a
+ * \ref k4a_image_t. An exposure time of 0 is considered invalid. Only color image formats are expected to have a valid
+ * exposure time.
+ *
+ * \relates k4a_image_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT void k4a_image_set_exposure_usec(k4a_image_t image_handle, uint64_t exposure_usec);
+
+/** Set the exposure time, in microseconds, of the image.
+ *
+ * \param image_handle
+ * Handle of the image to set the exposure time on.
+ *
+ * \param exposure_usec
+ * Exposure time of the image in microseconds.
+ *
+ * \remarks
+ * Use this function in conjunction with k4a_image_create() or k4a_image_create_from_buffer() to construct a
+ * \ref k4a_image_t. An exposure time of 0 is considered invalid. Only color image formats are expected to have a valid
+ * exposure time.
+ *
+ * \deprecated
+ * Deprecated starting in 1.2.0. Please use k4a_image_set_exposure_usec().
+ *
+ * \relates k4a_image_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_DEPRECATED_EXPORT void k4a_image_set_exposure_time_usec(k4a_image_t image_handle, uint64_t exposure_usec);
+
+/** Set the white balance of the image.
+ *
+ * \param image_handle
+ * Handle of the image to set the white balance on.
+ *
+ * \param white_balance
+ * White balance of the image in degrees Kelvin.
+ *
+ * \remarks
+ * Use this function in conjunction with k4a_image_create() or k4a_image_create_from_buffer() to construct a
+ * \ref k4a_image_t. A white balance of 0 is considered invalid. White balance is only meaningful for color images,
+ * and not expected on depth or IR images.
+ *
+ * \relates k4a_image_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT void k4a_image_set_white_balance(k4a_image_t image_handle, uint32_t white_balance);
+
+/** Set the ISO speed of the image.
+ *
+ * \param image_handle
+ * Handle of the image to set the ISO speed on.
+ *
+ * \param iso_speed
+ * ISO speed of the image.
+ *
+ * \remarks
+ * Use this function in conjunction with k4a_image_create() or k4a_image_create_from_buffer() to construct a
+ * \ref k4a_image_t. An ISO speed of 0 is considered invalid. Only color images are expected to have a valid ISO speed.
+ *
+ * \relates k4a_image_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT void k4a_image_set_iso_speed(k4a_image_t image_handle, uint32_t iso_speed);
+
+/** Add a reference to the k4a_image_t.
+ *
+ * \param image_handle
+ * Handle of the image for which the get operation is performed on.
+ *
+ * \remarks
+ * References manage the lifetime of the object. When the references reach zero the object is destroyed. A caller must
+ * not access the object after its reference is released.
+ *
+ * \relates k4a_image_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT void k4a_image_reference(k4a_image_t image_handle);
+
+/** Remove a reference from the k4a_image_t.
+ *
+ * \param image_handle
+ * Handle of the image for which the get operation is performed on.
+ *
+ * \remarks
+ * References manage the lifetime of the object. When the references reach zero the object is destroyed. A caller must
+ * not access the object after its reference is released.
+ *
+ * \relates k4a_image_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT void k4a_image_release(k4a_image_t image_handle);
+
+/** Convert a color image to BGRA32.
+ *
+ * \param source_image_handle
+ * Handle of a ::K4A_IMAGE_FORMAT_COLOR_NV12, ::K4A_IMAGE_FORMAT_COLOR_YUY2 or ::K4A_IMAGE_FORMAT_COLOR_BGRA32 image.
+ *
+ * \param bgra_image_handle
+ * Handle of a ::K4A_IMAGE_FORMAT_COLOR_BGRA32 image of the same width and height to write the pixels to.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the image was converted. ::K4A_RESULT_FAILED if the formats or sizes of the images are
+ * not supported.
+ *
+ * \remarks
+ * Streaming ::K4A_IMAGE_FORMAT_COLOR_NV12 or ::K4A_IMAGE_FORMAT_COLOR_YUY2 and converting only the images that are
+ * needed in BGRA32 avoids the MJPG decode the SDK performs for ::K4A_IMAGE_FORMAT_COLOR_BGRA32 streams. The
+ * conversion uses the SIMD code paths of the CPU. Renderers can instead upload the NV12 luminance and interleaved
+ * chroma planes as two textures and convert in a shader.
+ *
+ * \remarks
+ * The timestamps, exposure, white balance and ISO speed of the source image are copied to \p bgra_image_handle.
+ * \p bgra_image_handle can be reused for every image of a stream.
+ *
+ * \relates k4a_image_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_image_convert_to_bgra32(k4a_image_t source_image_handle, k4a_image_t bgra_image_handle);
+
+/** Convert a BGRA32 image to NV12 or YUY2.
+ *
+ * \param bgra_image_handle
+ * Handle of a ::K4A_IMAGE_FORMAT_COLOR_BGRA32 image.
+ *
+ * \param output_image_handle
+ * Handle of a ::K4A_IMAGE_FORMAT_COLOR_NV12 or ::K4A_IMAGE_FORMAT_COLOR_YUY2 image of the same width and height to
+ * write the pixels to.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the image was converted. ::K4A_RESULT_FAILED if the formats or sizes of the images are
+ * not supported.
+ *
+ * \remarks
+ * The limited range BT.601 coefficients of the color camera are used, so that k4a_image_convert_to_bgra32() restores
+ * the image up to the chroma subsampling. The metadata of \p bgra_image_handle is copied to \p output_image_handle.
+ *
+ * \relates k4a_image_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_image_convert_from_bgra32(k4a_image_t bgra_image_handle, k4a_image_t output_image_handle);
+
+/** Convert a color image to grayscale.
+ *
+ * \param color_image_handle
+ * Handle of a ::K4A_IMAGE_FORMAT_COLOR_NV12, ::K4A_IMAGE_FORMAT_COLOR_YUY2 or ::K4A_IMAGE_FORMAT_COLOR_BGRA32 image.
+ *
+ * \param custom8_image_handle
+ * Handle of a ::K4A_IMAGE_FORMAT_CUSTOM8 image of the same width and height to write the luminance to.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the image was converted. ::K4A_RESULT_FAILED if the formats or sizes of the images are
+ * not supported.
+ *
+ * \remarks
+ * Every format gives the limited range BT.601 luminance, the luminance plane of NV12 and YUY2 images is copied. The
+ * metadata of \p color_image_handle is copied to \p custom8_image_handle.
+ *
+ * \relates k4a_image_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_image_convert_to_grayscale(k4a_image_t color_image_handle,
+                                                       k4a_image_t custom8_image_handle);
+
+/** Convert a 16 bit image to floats.
+ *
+ * \param source_image_handle
+ * Handle of a ::K4A_IMAGE_FORMAT_DEPTH16, ::K4A_IMAGE_FORMAT_IR16 or ::K4A_IMAGE_FORMAT_CUSTOM16 image.
+ *
+ * \param scale
+ * Factor each pixel is multiplied by. 0.001 converts depth in millimeters to meters.
+ *
+ * \param float_image_handle
+ * Handle of a ::K4A_IMAGE_FORMAT_CUSTOM image of the same width and height, with a stride of at least 4 bytes per
+ * pixel, to write the floats to.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the image was converted. ::K4A_RESULT_FAILED if the formats or sizes of the images are
+ * not supported.
+ *
+ * \remarks
+ * The conversion uses the widest SIMD instructions of the CPU, selected when the process first converts an image.
+ * The metadata of \p source_image_handle is copied to \p float_image_handle.
+ *
+ * \relates k4a_image_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_image_convert_to_float(k4a_image_t source_image_handle,
+                                                   float scale,
+                                                   k4a_image_t float_image_handle);
+
+/** Normalize a range of a 16 bit image to 8 bits.
+ *
+ * \param source_image_handle
+ * Handle of a ::K4A_IMAGE_FORMAT_DEPTH16, ::K4A_IMAGE_FORMAT_IR16 or ::K4A_IMAGE_FORMAT_CUSTOM16 image.
+ *
+ * \param min_value
+ * Value written as 0. Smaller values are clamped to it.
+ *
+ * \param max_value
+ * Value written as 255, which must be greater than \p min_value. Larger values are clamped to it.
+ *
+ * \param custom8_image_handle
+ * Handle of a ::K4A_IMAGE_FORMAT_CUSTOM8 image of the same width and height to write the pixels to.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the image was converted. ::K4A_RESULT_FAILED if the formats or sizes of the images or the
+ * range are not supported.
+ *
+ * \remarks
+ * Values are scaled linearly and rounded. The conversion uses the widest SIMD instructions of the CPU. The metadata of
+ * \p source_image_handle is copied to \p custom8_image_handle.
+ *
+ * \relates k4a_image_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_image_convert_to_custom8(k4a_image_t source_image_handle,
+                                                     uint16_t min_value,
+                                                     uint16_t max_value,
+                                                     k4a_image_t custom8_image_handle);
+
+/** Color a range of a 16 bit image for display.
+ *
+ * \param source_image_handle
+ * Handle of a ::K4A_IMAGE_FORMAT_DEPTH16, ::K4A_IMAGE_FORMAT_IR16 or ::K4A_IMAGE_FORMAT_CUSTOM16 image.
+ *
+ * \param min_value
+ * Value at the start of the colormap. Smaller values are clamped to it.
+ *
+ * \param max_value
+ * Value at the end of the colormap, which must be greater than \p min_value. Larger values are clamped to it.
+ *
+ * \param colormap
+ * Colors to map the range to.
+ *
+ * \param bgra_image_handle
+ * Handle of a ::K4A_IMAGE_FORMAT_COLOR_BGRA32 image of the same width and height to write the colors to.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the image was converted. ::K4A_RESULT_FAILED if the formats or sizes of the images, the
+ * range or the colormap are not supported.
+ *
+ * \remarks
+ * ::K4A_COLORMAP_GREYSCALE suits infrared images and ::K4A_COLORMAP_BLUE_TO_RED depth images, whose invalid 0 pixels
+ * it leaves black. The metadata of \p source_image_handle is copied to \p bgra_image_handle.
+ *
+ * \relates k4a_image_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_image_colorize(k4a_image_t source_image_handle,
+                                           uint16_t min_value,
+                                           uint16_t max_value,
+                                           k4a_colormap_t colormap,
+                                           k4a_image_t bgra_image_handle);
+
+/** Starts color and depth camera capture.
+ *
+ * \param device_handle
+ * Handle obtained by k4a_device_open().
+ *
+ * \param config
+ * The configuration we want to run the device in. This can be initialized with ::K4A_DEVICE_CONFIG_INIT_DISABLE_ALL.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED is returned on success.
+ *
+ * \relates k4a_device_t
+ *
+ * \remarks
+ * Individual sensors configured to run will now start to stream captured data.
+ *
+ * \remarks
+ * It is not valid to call k4a_device_start_cameras() a second time on the same \ref k4a_device_t until
+ * k4a_device_stop_cameras() has been called.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_device_start_cameras(k4a_device_t device_handle, const k4a_device_configuration_t *config);
+
+/** Stops the color and depth camera capture.
+ *
+ * \param device_handle
+ * Handle obtained by k4a_device_open().
+ *
+ * \relates k4a_device_t
+ *
+ * \remarks
+ * The streaming of individual sensors stops as a result of this call. Once called, k4a_device_start_cameras() may
+ * be called again to resume sensor streaming.
+ *
+ * \remarks
+ * This function may be called while another thread is blocking in k4a_device_get_capture().
+ * Calling this function while another thread is in that function will result in that function returning a failure.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT void k4a_device_stop_cameras(k4a_device_t device_handle);
+
+/** Switches the running depth camera to another depth mode or frame rate.
+ *
+ * \param device_handle
+ * Handle obtained by k4a_device_open().
+ *
+ * \param depth_mode
+ * Depth mode to stream with, ::K4A_DEPTH_MODE_OFF is not accepted.
+ *
+ * \param camera_fps
+ * Frame rate to stream with. It must be the running frame rate when the color camera is running.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the depth camera streams with the new settings. ::K4A_RESULT_FAILED if the cameras are not
+ * running with the depth camera on, if the settings are not supported or the switch failed. A failed switch stops the
+ * cameras.
+ *
+ * \relates k4a_device_t
+ *
+ * \remarks
+ * Only the depth stream is restarted. The color camera, the device timestamps and the captures queued so far are
+ * kept, and the other settings of the k4a_device_configuration_t passed to k4a_device_start_cameras() still apply.
+ * Captures read after this call returns may still hold depth images of the previous depth mode, check the image size.
+ *
+ * \remarks
+ * The depth engine thread is reused, and so is the depth engine when only the frame rate changes, which avoids the
+ * cost of creating it again. Switching the depth mode creates a new depth engine.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_device_set_depth_mode(k4a_device_t device_handle,
+                                                  k4a_depth_mode_t depth_mode,
+                                                  k4a_fps_t camera_fps);
+
+/** Starts the IMU sample stream.
+ *
+ * \param device_handle
+ * Handle obtained by k4a_device_open().
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED is returned on success. ::K4A_RESULT_FAILED if the sensor is already running or a failure is
+ * encountered
+ *
+ * \relates k4a_device_t
+ *
+ * \remarks
+ * Call this API to start streaming IMU data. It is not valid to call this function a second time on the same
+ * \ref k4a_device_t until k4a_device_stop_imu() has been called.
+ *
+ * \remarks
+ * This function is dependent on the state of the cameras. The color or depth camera must be started before the IMU.
+ * ::K4A_RESULT_FAILED will be returned if one of the cameras is not running.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_device_start_imu(k4a_device_t device_handle);
+
+/** Stops the IMU capture.
+ *
+ * \param device_handle
+ * Handle obtained by k4a_device_open().
+ *
+ * \relates k4a_device_t
+ *
+ * \remarks
+ * The streaming of the IMU stops as a result of this call. Once called, k4a_device_start_imu() may
+ * be called again to resume sensor streaming, so long as the cameras are running.
+ *
+ * \remarks
+ * This function may be called while another thread is blocking in k4a_device_get_imu_sample().
+ * Calling this function while another thread is in that function will result in that function returning a failure.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT void k4a_device_stop_imu(k4a_device_t device_handle);
+
+/** Get the Azure Kinect device serial number.
+ *
+ * \param device_handle
+ * Handle obtained by k4a_device_open().
+ *
+ * \param serial_number
+ * Location to write the serial number to. If the function returns ::K4A_BUFFER_RESULT_SUCCEEDED, this will be a NULL
+ * terminated string of ASCII characters. If this input is NULL \p serial_number_size will still be updated to return
+ * the size of the buffer needed to store the string.
+ *
+ * \param serial_number_size
+ * On input, the size of the \p serial_number buffer if that pointer is not NULL. On output, this value is set to the
+ * actual number of bytes in the serial number (including the null terminator).
+ *
+ * \returns
+ * A return of ::K4A_BUFFER_RESULT_SUCCEEDED means that the \p serial_number has been filled in. If the buffer is too
+ * small the function returns ::K4A_BUFFER_RESULT_TOO_SMALL and the size of the serial number is
+ * returned in the \p serial_number_size parameter. All other failures return ::K4A_BUFFER_RESULT_FAILED.
+ *
+ * \relates k4a_device_t
+ *
+ * \remarks
+ * Queries the device for its serial number. If the caller needs to know the size of the serial number to allocate
+ * memory, the function should be called once with a NULL \p serial_number to get the needed size in the \p
+ * serial_number_size output, and then again with the allocated buffer.
+ *
+ * \remarks
+ * Only a complete serial number will be returned. If the caller's buffer is too small, the function will return
+ * ::K4A_BUFFER_RESULT_TOO_SMALL without returning any data in \p serial_number.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_buffer_result_t k4a_device_get_serialnum(k4a_device_t device_handle,
+                                                        char *serial_number,
+                                                        size_t *serial_number_size);
+
+/** Get the version numbers of the device's subsystems.
+ *
+ * \param device_handle
+ * Handle obtained by k4a_device_open().
+ *
+ * \param version
+ * Location to write the version info to.
+ *
+ * \returns A return of ::K4A_RESULT_SUCCEEDED means that the version structure has been filled in.
+ * All other failures return ::K4A_RESULT_FAILED.
+ *
+ * \relates k4a_device_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_device_get_version(k4a_device_t device_handle, k4a_hardware_version_t *version);
+
+/** Get the Azure Kinect color sensor control capabilities.
+ *
+ * \param device_handle
+ * Handle obtained by k4a_device_open().
+ *
+ * \param command
+ * Color sensor control command.
+ *
+ * \param supports_auto
+ * Location to store whether the color sensor's control support auto mode or not.
+ * true if it supports auto mode, otherwise false.
+ *
+ * \param min_value
+ * Location to store the color sensor's control minimum value of /p command.
+ *
+ * \param max_value
+ * Location to store the color sensor's control maximum value of /p command.
+ *
+ * \param step_value
+ * Location to store the color sensor's control step value of /p command.
+ *
+ * \param default_value
+ * Location to store the color sensor's control default value of /p command.
+ *
+ * \param default_mode
+ * Location to store the color sensor's control default mode of /p command.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the value was successfully returned, ::K4A_RESULT_FAILED if an error occurred
+ *
+ * \relates k4a_device_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_device_get_color_control_capabilities(k4a_device_t device_handle,
+                                                                  k4a_color_control_command_t command,
+                                                                  bool *supports_auto,
+                                                                  int32_t *min_value,
+                                                                  int32_t *max_value,
+                                                                  int32_t *step_value,
+                                                                  int32_t *default_value,
+                                                                  k4a_color_control_mode_t *default_mode);
+
+/** Get the Azure Kinect color sensor control
+ * value.
+ *
+ * \param device_handle
+ * Handle obtained by k4a_device_open().
+ *
+ * \param command
+ * Color sensor control command.
+ *
+ * \param mode
+ * Location to store the color sensor's control mode. This mode represents whether the command is in automatic or
+ * manual mode.
+ *
+ * \param value
+ * Location to store the color sensor's control value. This value is always written, but is only valid when the \p
+ * mode returned is ::K4A_COLOR_CONTROL_MODE_MANUAL for the current \p command.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the value was successfully returned, ::K4A_RESULT_FAILED if an error occurred
+ *
+ * \remarks
+ * Each control command may be set to manual or automatic. See the definition of \ref k4a_color_control_command_t on
+ * how to interpret the \p value for each command.
+ *
+ * \remarks
+ * Some control commands are only supported in manual mode. When a command is in automatic mode, the \p value for
+ * that command is not valid.
+ *
+ * \remarks
+ * Control values set on a device are reset only when the device is power cycled. The device will retain the
+ * settings even if the \ref k4a_device_t is closed or the application is restarted.
+ *
+ * \remarks
+ * The value is returned from a copy kept by the SDK, updated by k4a_device_set_color_control() and
+ * k4a_device_refresh_color_control(), so no request is sent to the device. Values of commands in automatic mode are
+ * re-read from the device when the copy is older than 100 milliseconds. Use k4a_device_refresh_color_control() to see
+ * changes made by another process.
+ *
+ * \relates k4a_device_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_device_get_color_control(k4a_device_t device_handle,
+                                                     k4a_color_control_command_t command,
+                                                     k4a_color_control_mode_t *mode,
+                                                     int32_t *value);
+
+/** Read the Azure Kinect color sensor control value from the device.
+ *
+ * \param device_handle
+ * Handle obtained by k4a_device_open().
+ *
+ * \param command
+ * Color sensor control command.
+ *
+ * \param mode
+ * Location to store the color sensor's control mode. This mode represents whether the command is in automatic or
+ * manual mode.
+ *
+ * \param value
+ * Location to store the color sensor's control value. This value is always written, but is only valid when the \p
+ * mode returned is ::K4A_COLOR_CONTROL_MODE_MANUAL for the current \p command.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the value was successfully returned, ::K4A_RESULT_FAILED if an error occurred
+ *
+ * \remarks
+ * Unlike k4a_device_get_color_control(), this function always queries the device. The value read is returned by later
+ * calls to k4a_device_get_color_control().
+ *
+ * \relates k4a_device_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_device_refresh_color_control(k4a_device_t device_handle,
+                                                         k4a_color_control_command_t command,
+                                                         k4a_color_control_mode_t *mode,
+                                                         int32_t *value);
+
+/** Set the Azure Kinect color sensor control value.
+ *
+ * \param device_handle
+ * Handle obtained by k4a_device_open().
+ *
+ * \param command
+ * Color sensor control command.
+ *
+ * \param mode
+ * Color sensor control mode to set. This mode represents whether the command is in automatic or manual mode.
+ *
+ * \param value
+ * Value to set the color sensor's control to. The value is only valid if \p mode
+ * is set to ::K4A_COLOR_CONTROL_MODE_MANUAL, and is otherwise ignored.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the value was successfully set, ::K4A_RESULT_FAILED if an error occurred
+ *
+ * \remarks
+ * Each control command may be set to manual or automatic. See the definition of \ref k4a_color_control_command_t on how
+ * to interpret the \p value for each command.
+ *
+ * \remarks
+ * Some control commands are only supported in manual mode. When a command is in automatic mode, the \p value for that
+ * command is not valid.
+ *
+ * \remarks
+ * Control values set on a device are reset only when the device is power cycled. The device will retain the settings
+ * even if the \ref k4a_device_t is closed or the application is restarted.
+ *
+ * \relates k4a_device_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_device_set_color_control(k4a_device_t device_handle,
+                                                     k4a_color_control_command_t command,
+                                                     k4a_color_control_mode_t mode,
+                                                     int32_t value);
+
+/** Get the raw calibration blob for the entire Azure Kinect device.
+ *
+ * \param device_handle
+ * Handle obtained by k4a_device_open().
+ *
+ * \param data
+ * Location to write the calibration data to. This field may optionally be set to NULL for the caller to query for
+ * the needed data size.
+ *
+ * \param data_size
+ * On passing \p data_size into the function this variable represents the available size of the \p data
+ * buffer. On return this variable is updated with the amount of data actually written to the buffer, or the size
+ * required to store the calibration buffer if \p data is NULL.
+ *
+ * \returns
+ * ::K4A_BUFFER_RESULT_SUCCEEDED if \p data was successfully written. If \p data_size points to a buffer size that is
+ * too small to hold the output or \p data is NULL, ::K4A_BUFFER_RESULT_TOO_SMALL is returned and \p data_size is
+ * updated to contain the minimum buffer size needed to capture the calibration data.
+ *
+ * \relates k4a_device_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_buffer_result_t k4a_device_get_raw_calibration(k4a_device_t device_handle,
+                                                              uint8_t *data,
+                                                              size_t *data_size);
+
+/** Get the depth calibration blob of the depth sensor.
+ *
+ * \param device_handle
+ * Handle obtained by k4a_device_open().
+ *
+ * \param data
+ * Location to write the calibration data to. This field may optionally be set to NULL for the caller to query for
+ * the needed data size.
+ *
+ * \param data_size
+ * On passing \p data_size into the function this variable represents the available size of the \p data
+ * buffer. On return this variable is updated with the amount of data actually written to the buffer, or the size
+ * required to store the calibration buffer if \p data is NULL.
+ *
+ * \returns
+ * ::K4A_BUFFER_RESULT_SUCCEEDED if \p data was successfully written. If \p data_size points to a buffer size that is
+ * too small to hold the output or \p data is NULL, ::K4A_BUFFER_RESULT_TOO_SMALL is returned and \p data_size is
+ * updated to contain the minimum buffer size needed to capture the calibration data. ::K4A_BUFFER_RESULT_FAILED is
+ * returned if the depth camera has not been started yet.
+ *
+ * \remarks
+ * This is the calibration the depth engine is initialized with, which turns the raw depth payloads delivered with
+ * k4a_device_start_options_t::raw_depth_payload into depth and IR images. It is read from the depth sensor the first
+ * time the depth camera starts, and is not the JSON calibration of k4a_device_get_raw_calibration().
+ *
+ * \relates k4a_device_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_buffer_result_t k4a_device_get_raw_depth_calibration(k4a_device_t device_handle,
+                                                                    uint8_t *data,
+                                                                    size_t *data_size);
+
+/** Get the camera calibration for the entire Azure Kinect device.
+ *
+ * \param device_handle
+ * Handle obtained by k4a_device_open().
+ *
+ * \param depth_mode
+ * Mode in which depth camera is operated.
+ *
+ * \param color_resolution
+ * Resolution in which color camera is operated.
+ *
+ * \param calibration
+ * Location to write the calibration
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if \p calibration was successfully written. ::K4A_RESULT_FAILED otherwise.
+ *
+ * \remarks
+ * The \p calibration represents the data needed to transform between the camera views and may be
+ * different for each operating \p depth_mode and \p color_resolution the device is configured to operate in.
+ *
+ * \remarks
+ * The \p calibration output is used as input to all calibration and transformation functions.
+ *
+ * \see k4a_calibration_2d_to_2d()
+ * \see k4a_calibration_2d_to_3d()
+ * \see k4a_calibration_3d_to_2d()
+ * \see k4a_calibration_3d_to_3d()
+ *
+ * \relates k4a_device_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_device_get_calibration(k4a_device_t device_handle,
+                                                   const k4a_depth_mode_t depth_mode,
+                                                   const k4a_color_resolution_t color_resolution,
+                                                   k4a_calibration_t *calibration);
+
+/** Get the device jack status for the synchronization in and synchronization out connectors.
+ *
+ * \param device_handle
+ * Handle obtained by k4a_device_open().
+ *
+ * \param sync_in_jack_connected
+ * Upon successful return this value will be set to true if a cable is connected to this sync in jack.
+ *
+ * \param sync_out_jack_connected
+ * Upon successful return this value will be set to true if a cable is connected to this sync out jack.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the connector status was successfully read.
+ *
+ * \relates k4a_device_t
+ *
+ * \remarks
+ * If \p sync_out_jack_connected is true then \ref k4a_device_configuration_t wired_sync_mode mode can be set to \ref
+ * K4A_WIRED_SYNC_MODE_STANDALONE or \ref K4A_WIRED_SYNC_MODE_MASTER. If \p sync_in_jack_connected is true then \ref
+ * k4a_device_configuration_t wired_sync_mode mode can be set to \ref K4A_WIRED_SYNC_MODE_STANDALONE or \ref
+ * K4A_WIRED_SYNC_MODE_SUBORDINATE.
+ *
+ * \see k4a_device_start_cameras()
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_device_get_sync_jack(k4a_device_t device_handle,
+                                                 bool *sync_in_jack_connected,
+                                                 bool *sync_out_jack_connected);
+
+/** Set the limits on the USB transfers used to stream depth data.
+ *
+ * \param device_handle
+ * Handle obtained by k4a_device_open().
+ *
+ * \param options
+ * Limits to apply. Fields set to 0 use the SDK defaults.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the limits were applied. ::K4A_RESULT_FAILED if a limit is out of range or the cameras
+ * are running.
+ *
+ * \relates k4a_device_t
+ *
+ * \remarks
+ * The limits take effect the next time k4a_device_start_cameras() is called. Fewer transfers than requested may be
+ * submitted if the host cannot accept them; use k4a_device_get_usb_streaming_transfer_count() to read the number
+ * actually in use.
+ *
+ * \see k4a_usb_streaming_options_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_device_set_usb_streaming_options(k4a_device_t device_handle,
+                                                             const k4a_usb_streaming_options_t *options);
+
+/** Set the streaming options used by the next k4a_device_start_cameras() calls.
+ *
+ * \param device_handle
+ * Handle obtained by k4a_device_open().
+ *
+ * \param options
+ * Options to apply, initialized with ::K4A_DEVICE_START_OPTIONS_INIT.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the options were stored. ::K4A_RESULT_FAILED if the struct_size of \p options is not one
+ * this SDK knows of or the cameras are running.
+ *
+ * \relates k4a_device_t
+ *
+ * \remarks
+ * The options are checked against the ::k4a_device_configuration_t they are used with by k4a_device_start_cameras(),
+ * which fails if they can't be combined. They stay in effect for every later start until they are set again. A
+ * device is opened with the options of ::K4A_DEVICE_START_OPTIONS_INIT.
+ *
+ * \see k4a_device_start_options_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_device_set_start_options(k4a_device_t device_handle,
+                                                     const k4a_device_start_options_t *options);
+
+/** Get the streaming options used by the next k4a_device_start_cameras() calls.
+ *
+ * \param device_handle
+ * Handle obtained by k4a_device_open().
+ *
+ * \param options
+ * Location to write the options to. Its struct_size must be set, only the fields it covers are written.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the options were written. ::K4A_RESULT_FAILED if the struct_size of \p options is not one
+ * this SDK knows of.
+ *
+ * \relates k4a_device_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_device_get_start_options(k4a_device_t device_handle, k4a_device_start_options_t *options);
+
+/** Set the allocator used for the buffers of one device.
+ *
+ * \param device_handle
+ * Handle obtained by k4a_device_open().
+ *
+ * \param allocate
+ * The callback function to allocate memory, called with the \ref k4a_allocation_source_t the memory is for.
+ *
+ * \param free
+ * The callback function to free memory allocated by \p allocate.
+ *
+ * \param allocator_context
+ * Context passed to every call to \p allocate.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the allocator was set or cleared. ::K4A_RESULT_FAILED if only one of \p allocate and
+ * \p free is NULL, or the cameras or IMU are running.
+ *
+ * \relates k4a_device_t
+ *
+ * \remarks
+ * The allocator is used for the depth, IR, color and raw USB buffers of this device from the next time
+ * k4a_device_start_cameras() or k4a_device_start_imu() is called, in place of the allocator set with
+ * k4a_set_allocator(). Other devices are not affected. Calling with both \p allocate and \p free as NULL returns the
+ * device to the process allocator.
+ *
+ * \remarks
+ * Buffers are released with the \p free function that was set when they were allocated, which may be after the
+ * device is closed.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_device_set_allocator(k4a_device_t device_handle,
+                                                 k4a_memory_allocate_source_cb_t *allocate,
+                                                 k4a_memory_destroy_cb_t *free,
+                                                 void *allocator_context);
+
+/** Create a ring of buffers over memory provided by the application.
+ *
+ * \param buffer
+ * Start of \p slot_count slots of \p slot_size bytes, such as a shared memory segment mapped by the application. It
+ * must stay valid until every image written into the ring is released, which may be after the ring is destroyed.
+ *
+ * \param slot_size
+ * Size of every slot in bytes, larger than ::K4A_BUFFER_RING_SLOT_OVERHEAD. Slots start at multiples of this size from
+ * \p buffer, a multiple of ::K4A_IMAGE_BUFFER_ALIGNMENT keeps the images they hold aligned.
+ *
+ * \param slot_count
+ * Number of slots.
+ *
+ * \param ring_handle
+ * Location to write the handle to.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the ring was created. ::K4A_RESULT_FAILED if an argument is invalid.
+ *
+ * \relates k4a_buffer_ring_t
+ *
+ * \remarks
+ * Images are written into the slots of the ring by devices it is set on with k4a_device_set_buffer_ring(), and by
+ * the application with k4a_buffer_ring_create_image(). Releasing an image returns its slot, slots are handed out
+ * again in the order they were returned. k4a_buffer_ring_get_slot() tells which slot an image is in, so the slot index
+ * or the offset of the image can be passed to another process sharing the memory instead of copying the image.
+ *
+ * \remarks
+ * Destroy the ring with k4a_buffer_ring_destroy().
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_buffer_ring_create(uint8_t *buffer,
+                                               size_t slot_size,
+                                               uint32_t slot_count,
+                                               k4a_buffer_ring_t *ring_handle);
+
+/** Destroy a buffer ring.
+ *
+ * \param ring_handle
+ * Handle obtained by k4a_buffer_ring_create().
+ *
+ * \relates k4a_buffer_ring_t
+ *
+ * \remarks
+ * Devices the ring is set on and images in its slots keep using it, its memory is no longer referenced once they are
+ * closed and released.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT void k4a_buffer_ring_destroy(k4a_buffer_ring_t ring_handle);
+
+/** Find the slot of a buffer ring an image is in.
+ *
+ * \param ring_handle
+ * Handle obtained by k4a_buffer_ring_create().
+ *
+ * \param image_handle
+ * Image to look up, such as one of the images of a capture.
+ *
+ * \param slot_index
+ * Optional, location to write the index of the slot to.
+ *
+ * \param buffer_offset
+ * Optional, location to write the offset of the buffer of the image from the start of the ring to.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the image is in the ring. ::K4A_RESULT_FAILED if it isn't or a handle is invalid.
+ *
+ * \relates k4a_buffer_ring_t
+ *
+ * \remarks
+ * The depth and IR images of one capture share a slot.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_buffer_ring_get_slot(k4a_buffer_ring_t ring_handle,
+                                                 k4a_image_t image_handle,
+                                                 uint32_t *slot_index,
+                                                 size_t *buffer_offset);
+
+/** Create an image in a free slot of a buffer ring.
+ *
+ * \param ring_handle
+ * Handle obtained by k4a_buffer_ring_create().
+ *
+ * \param format
+ * The format of the image that will be stored in this image container.
+ *
+ * \param width_pixels
+ * Width in pixels.
+ *
+ * \param height_pixels
+ * Height in pixels.
+ *
+ * \param stride_bytes
+ * The number of bytes per horizontal line of the image.
+ *
+ * \param image_handle
+ * Location to write the handle to.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the image was created. ::K4A_RESULT_FAILED if \p height_pixels * \p stride_bytes is larger
+ * than a slot or every slot is in use.
+ *
+ * \relates k4a_buffer_ring_t
+ *
+ * \remarks
+ * The image starts at the start of the slot. Pass it as the output of the k4a_transformation functions to write their
+ * results into the ring. Releasing the image returns the slot.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_buffer_ring_create_image(k4a_buffer_ring_t ring_handle,
+                                                     k4a_image_format_t format,
+                                                     int width_pixels,
+                                                     int height_pixels,
+                                                     int stride_bytes,
+                                                     k4a_image_t *image_handle);
+
+/** Set the buffer ring the images of one stream of a device are written into.
+ *
+ * \param device_handle
+ * Handle obtained by k4a_device_open().
+ *
+ * \param source
+ * The stream, ::K4A_ALLOCATION_SOURCE_DEPTH for the depth and IR images, ::K4A_ALLOCATION_SOURCE_COLOR for the color
+ * images, or one of the other sources except ::K4A_ALLOCATION_SOURCE_USER.
+ *
+ * \param ring_handle
+ * Handle obtained by k4a_buffer_ring_create(), or NULL to allocate the stream from the device allocator again.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the ring was set or cleared. ::K4A_RESULT_FAILED if \p source is invalid, or the cameras or
+ * IMU are running.
+ *
+ * \relates k4a_device_t
+ *
+ * \remarks
+ * The ring is used from the next time k4a_device_start_cameras() or k4a_device_start_imu() is called, in place of the
+ * allocator set with k4a_device_set_allocator() for that stream. The depth engine writes its output, and the color
+ * camera its frames, straight into the slots. Releasing the images of a capture returns their slot. The device keeps
+ * the ring alive until another ring is set or the device is closed.
+ *
+ * \remarks
+ * Slots must be larger than the images of the stream by ::K4A_BUFFER_RING_SLOT_OVERHEAD bytes. The SDK keeps a few
+ * slots of the stream for its own buffer pools while the cameras run, starting fails if the ring doesn't have them
+ * free. While the application holds every other slot, new images of the stream are dropped.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_device_set_buffer_ring(k4a_device_t device_handle,
+                                                   k4a_allocation_source_t source,
+                                                   k4a_buffer_ring_t ring_handle);
+
+/** Select the GPU the depth engine of a device runs on.
+ *
+ * \param device_handle
+ * Handle obtained by k4a_device_open().
+ *
+ * \param gpu_index
+ * Index of the GPU, from 0. ::K4A_DEPTH_ENGINE_GPU_DEFAULT lets the depth engine choose, which is the default.
+ * ::K4A_DEPTH_ENGINE_GPU_ROUND_ROBIN assigns the next GPU in turn, across all devices using it, each time the cameras
+ * start.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the GPU was selected. ::K4A_RESULT_FAILED if the depth camera is running, or the depth
+ * engine can't select \p gpu_index.
+ *
+ * \relates k4a_device_t
+ *
+ * \remarks
+ * The GPU is used from the next time k4a_device_start_cameras() is called. Hosts with several devices can spread the
+ * depth processing over their GPUs instead of running every depth engine on the GPU the depth engine chooses.
+ *
+ * \remarks
+ * Selecting a GPU requires a depth engine that supports it. Otherwise only ::K4A_DEPTH_ENGINE_GPU_DEFAULT can be set,
+ * and ::K4A_DEPTH_ENGINE_GPU_ROUND_ROBIN falls back to it.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_device_set_depth_engine_gpu(k4a_device_t device_handle, int32_t gpu_index);
+
+/** Keep the depth engine of a device alive while its cameras are stopped.
+ *
+ * \param device_handle
+ * Handle obtained by k4a_device_open().
+ *
+ * \param keep_alive
+ * True to keep the depth engine alive when k4a_device_stop_cameras() is called. False, the default, destroys it on
+ * stop, along with a depth engine kept alive so far.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the setting was applied. ::K4A_RESULT_FAILED if \p device_handle is invalid.
+ *
+ * \relates k4a_device_t
+ *
+ * \remarks
+ * Creating the depth engine compiles its shaders and uploads the calibration to the GPU, which makes up most of the
+ * time k4a_device_start_cameras() takes. With \p keep_alive set, the next start reuses the depth engine when the
+ * depth_mode and the depth_image_only start option are unchanged. Otherwise, or after the depth engine GPU or
+ * allocator changed, a new depth engine is created. The depth engine keeps holding GPU memory while the cameras are
+ * stopped.
+ *
+ * \remarks
+ * Depth engines that support it keep compiled shaders in the directory named by the K4A_DEPTH_ENGINE_CACHE_DIR
+ * environment variable, which speeds up the first start of each process.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_device_set_depth_engine_keep_alive(k4a_device_t device_handle, bool keep_alive);
+
+/** Set the filters applied to the depth images of a device.
+ *
+ * \param device_handle
+ * Handle obtained by k4a_device_open().
+ *
+ * \param config
+ * Filters to apply, see \ref k4a_depth_filter_configuration_t. NULL disables filtering, which is the default.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the filters were set. ::K4A_RESULT_FAILED if the depth camera is running, or a parameter
+ * of an enabled filter is out of range.
+ *
+ * \relates k4a_device_t
+ *
+ * \remarks
+ * The filters are used from the next time k4a_device_start_cameras() is called. They run on the depth engine thread
+ * and add to the time each depth image takes to be published. The IR image is left unchanged.
+ *
+ * \remarks
+ * The flying pixel filter invalidates the pixels on depth edges that lie between the two surfaces. The edge
+ * preserving filter smooths surfaces without blurring their edges. The temporal filter reduces the noise of static
+ * scenes and, with hole_fill_frames, fills pixels that drop out for a few frames with their previous depth. Its
+ * history starts over each time the cameras start.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_device_set_depth_filter(k4a_device_t device_handle,
+                                                    const k4a_depth_filter_configuration_t *config);
+
+/** Set the region and scale of the BGRA32 color images of a device.
+ *
+ * \param device_handle
+ * Handle obtained by k4a_device_open().
+ *
+ * \param config
+ * Crop and scale of the images, see \ref k4a_color_decode_configuration_t. NULL selects the full image at full
+ * resolution, which is the default.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the configuration was set. ::K4A_RESULT_FAILED if the color camera is running, the
+ * configuration is invalid, or decoding scaled images is not supported on this platform.
+ *
+ * \relates k4a_device_t
+ *
+ * \remarks
+ * The configuration is used from the next time k4a_device_start_cameras() is called with a color_format of
+ * ::K4A_IMAGE_FORMAT_COLOR_BGRA32, the other formats are not decoded by the SDK and are left unchanged. The crop must
+ * fit in the color_resolution the cameras are started with, or the start fails.
+ *
+ * \remarks
+ * The MJPG frames of the camera are decoded directly to the reduced resolution, which takes a fraction of the time of
+ * a full decode. Calibration and transformation functions expect full resolution color images, so scaled or cropped
+ * images are meant for previews and processing that does not map them to the depth camera.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_device_set_color_decode(k4a_device_t device_handle,
+                                                    const k4a_color_decode_configuration_t *config);
+
+/** Get the load on the GPU the depth engine of a device runs on.
+ *
+ * \param device_handle
+ * Handle obtained by k4a_device_open().
+ *
+ * \param statistics
+ * Location to write the statistics to.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the statistics were written. ::K4A_RESULT_FAILED if \p statistics is NULL.
+ *
+ * \relates k4a_device_t
+ *
+ * \remarks
+ * The statistics are for the GPU the depth engine is running on, or ran on most recently, and include the frames of
+ * every device using the same GPU.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_device_get_depth_engine_gpu_statistics(k4a_device_t device_handle,
+                                                                   k4a_depth_engine_gpu_statistics_t *statistics);
+
+/** Get the streaming counters, frame drop counters and latencies of a device.
+ *
+ * \param device_handle
+ * Handle obtained by k4a_device_open().
+ *
+ * \param statistics
+ * Location to write the statistics to.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the statistics were written. ::K4A_RESULT_FAILED if \p statistics is NULL.
+ *
+ * \relates k4a_device_t
+ *
+ * \remarks
+ * The counters cover the time since k4a_device_open(). Compute times are measured per frame from the moment the depth
+ * engine was handed the raw frame until its output was ready, with a 1 millisecond resolution.
+ *
+ * \remarks
+ * A frame is an overrun when its compute time exceeds the frame period of the depth mode, multiplied by the number of
+ * frames in flight when the depth engine overlaps frames. Overruns are usually followed by drops in the depth engine
+ * input queue or in the capture queue.
+ *
+ * \remarks
+ * Counters only increase, so rates such as the synchronized capture rate are the difference between two calls divided
+ * by the time between them. The capture latency histogram has fixed buckets and can be exported as a cumulative
+ * histogram by summing the buckets in order.
+ *
+ * \remarks
+ * The open and start times are from the last k4a_device_open() and k4a_device_start_cameras() calls and are not
+ * accumulated. first_capture_time_usec is the time to first frame of the last start.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_device_get_statistics(k4a_device_t device_handle, k4a_device_statistics_t *statistics);
+
+/** Get the model of the device clock in the clock of the image system timestamps.
+ *
+ * \param device_handle
+ * Handle obtained by k4a_device_open().
+ *
+ * \param clock_model
+ * Location to write the clock model to.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the model was written. ::K4A_RESULT_FAILED if \p clock_model is NULL or no capture has
+ * arrived since the cameras were started.
+ *
+ * \relates k4a_device_t
+ *
+ * \remarks
+ * The model is fitted to the device and system timestamps of the captures. System timestamps are taken when the USB
+ * transfer of an image completes, so they are delayed by a varying amount. The model keeps the least delayed capture of
+ * each second of device time and fits a line, which gives the offset and the drift between the clocks, through the
+ * last minute of them. The depth captures are used, or the color captures when the depth camera is off.
+ *
+ * \remarks
+ * The model restarts with k4a_device_start_cameras(), since starting the cameras resets the device timestamps.
+ *
+ * \see k4a_device_convert_device_timestamp()
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_device_get_clock_model(k4a_device_t device_handle, k4a_device_clock_model_t *clock_model);
+
+/** Convert a device timestamp to the clock of the image system timestamps.
+ *
+ * \param device_handle
+ * Handle obtained by k4a_device_open().
+ *
+ * \param device_timestamp_usec
+ * Device timestamp of an image or IMU sample of the device, in microseconds.
+ *
+ * \param system_timestamp_nsec
+ * Location to write the system timestamp to, in nanoseconds.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the timestamp was converted. ::K4A_RESULT_FAILED if \p system_timestamp_nsec is NULL or
+ * no capture has arrived since the cameras were started.
+ *
+ * \relates k4a_device_t
+ *
+ * \remarks
+ * The device timestamp is mapped with the model of k4a_device_get_clock_model(), which removes the USB delay of the
+ * system timestamps of the images. Unlike k4a_image_get_system_timestamp_nsec(), the result can be compared between
+ * the images and IMU samples of several devices on the same host. To compare with other hosts, add the offset of the
+ * host clock to the network clock, such as the one reported by a PTP daemon.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_device_convert_device_timestamp(k4a_device_t device_handle,
+                                                            uint64_t device_timestamp_usec,
+                                                            uint64_t *system_timestamp_nsec);
+
+/** Open several Azure Kinect devices as a group.
+ *
+ * \param device_indices
+ * Indices of the devices to open, or NULL to open the devices 0 to \p device_count - 1.
+ *
+ * \param device_count
+ * Number of devices to open.
+ *
+ * \param group_handle
+ * Output parameter which on success will return a handle to the group.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if every device was opened. Otherwise the devices that were opened are closed again.
+ *
+ * \relates k4a_device_group_t
+ *
+ * \remarks
+ * If a device has only its sync out jack connected, it is the wired synchronization master and becomes device 0 of
+ * the group. The other devices keep the order of \p device_indices. Use k4a_device_group_get_device() to read the
+ * calibration, set the color controls or read the IMU of each device.
+ *
+ * \remarks
+ * Call k4a_device_group_close() to close the devices and free the group.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_device_group_open(const uint32_t *device_indices,
+                                              uint32_t device_count,
+                                              k4a_device_group_t *group_handle);
+
+/** Stop and close the devices of a group and free the group.
+ *
+ * \param group_handle
+ * Handle obtained by k4a_device_group_open().
+ *
+ * \relates k4a_device_group_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT void k4a_device_group_close(k4a_device_group_t group_handle);
+
+/** Get the number of devices in a group.
+ *
+ * \param group_handle
+ * Handle obtained by k4a_device_group_open().
+ *
+ * \returns
+ * The number of devices, or 0 if \p group_handle is invalid.
+ *
+ * \relates k4a_device_group_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT uint32_t k4a_device_group_get_device_count(k4a_device_group_t group_handle);
+
+/** Get a device of a group.
+ *
+ * \param group_handle
+ * Handle obtained by k4a_device_group_open().
+ *
+ * \param index
+ * Index of the device in the group, from 0 to k4a_device_group_get_device_count() - 1.
+ *
+ * \returns
+ * The device handle, or NULL if \p index is out of range.
+ *
+ * \relates k4a_device_group_t
+ *
+ * \remarks
+ * The handle is owned by the group and stays valid until k4a_device_group_close(). Do not close it, and do not start,
+ * stop or change the capture callback of its cameras while it is in the group.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_device_t k4a_device_group_get_device(k4a_device_group_t group_handle, uint32_t index);
+
+/** Start the cameras of every device of a group.
+ *
+ * \param group_handle
+ * Handle obtained by k4a_device_group_open().
+ *
+ * \param configs
+ * One configuration per device, in group order.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if every camera was started. Otherwise the cameras that were started are stopped again.
+ *
+ * \relates k4a_device_group_t
+ *
+ * \remarks
+ * Every device must use the same camera_fps. At most one device is ::K4A_WIRED_SYNC_MODE_MASTER, and if there is one,
+ * the others are ::K4A_WIRED_SYNC_MODE_SUBORDINATE. The subordinates are started first so they are waiting for the
+ * sync signal when the master starts.
+ *
+ * \remarks
+ * The captures of the devices are read together with k4a_device_group_get_capture(). k4a_device_get_capture() does not
+ * return captures of a device while its group is running.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_device_group_start_cameras(k4a_device_group_t group_handle,
+                                                       const k4a_device_configuration_t *configs);
+
+/** Stop the cameras of every device of a group.
+ *
+ * \param group_handle
+ * Handle obtained by k4a_device_group_open().
+ *
+ * \relates k4a_device_group_t
+ *
+ * \remarks
+ * The master is stopped first, then the other devices. Captures waiting for a match are released and a thread blocked
+ * in k4a_device_group_get_capture() returns ::K4A_WAIT_RESULT_FAILED.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT void k4a_device_group_stop_cameras(k4a_device_group_t group_handle);
+
+/** Read the captures of every device of a group taken at the same time.
+ *
+ * \param group_handle
+ * Handle obtained by k4a_device_group_open().
+ *
+ * \param capture_handles
+ * Location to write one capture per device to, in group order. The array must hold
+ * k4a_device_group_get_device_count() captures. Each capture must be released with k4a_capture_release().
+ *
+ * \param timeout_in_ms
+ * Time to wait for matching captures, 0 to not wait or ::K4A_WAIT_INFINITE.
+ *
+ * \returns
+ * ::K4A_WAIT_RESULT_SUCCEEDED if a capture of every device was written, ::K4A_WAIT_RESULT_TIMEOUT if none matched in
+ * time, and ::K4A_WAIT_RESULT_FAILED if the group is not running.
+ *
+ * \relates k4a_device_group_t
+ *
+ * \remarks
+ * The captures are matched by the device timestamps of their depth images, or of their color images when the depth
+ * camera is off. Each timestamp is converted to system time with k4a_device_convert_device_timestamp(), and
+ * depth_delay_off_color_usec and subordinate_delay_off_master_usec are subtracted, so the captures of one sync pulse
+ * have the same time. Captures are matched when they are within half a frame period of each other.
+ *
+ * \remarks
+ * A capture without a match is dropped, as are captures that arrive while a device already has several waiting
+ * because the group captures are not read fast enough. See k4a_device_group_get_statistics().
+ *
+ * \remarks
+ * Matching takes no lock on the threads delivering the captures of the devices. Only one thread may read the group
+ * captures at a time.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_wait_result_t k4a_device_group_get_capture(k4a_device_group_t group_handle,
+                                                          k4a_capture_t *capture_handles,
+                                                          int32_t timeout_in_ms);
+
+/** Get the matching counters of a group.
+ *
+ * \param group_handle
+ * Handle obtained by k4a_device_group_open().
+ *
+ * \param statistics
+ * Location to write the counters to.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the counters were written. ::K4A_RESULT_FAILED if \p statistics is NULL.
+ *
+ * \relates k4a_device_group_t
+ *
+ * \remarks
+ * The streaming counters of each device are read with k4a_device_get_statistics().
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_device_group_get_statistics(k4a_device_group_t group_handle,
+                                                        k4a_device_group_statistics_t *statistics);
+
+/** Get the number of USB transfers the depth stream submitted.
+ *
+ * \param device_handle
+ * Handle obtained by k4a_device_open().
+ *
+ * \param transfer_count
+ * Location to write the number of outstanding transfers the current, or most recent, depth stream submitted.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if \p transfer_count was written. ::K4A_RESULT_FAILED otherwise.
+ *
+ * \relates k4a_device_t
+ *
+ * \remarks
+ * A value below the configured k4a_usb_streaming_options_t max_transfer_count indicates the host ran out of resources
+ * for outstanding transfers, for example when several devices share one USB controller.
+ *
+ * \see k4a_device_set_usb_streaming_options()
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_device_get_usb_streaming_transfer_count(k4a_device_t device_handle,
+                                                                    uint32_t *transfer_count);
+
+/** Get the camera calibration for a device from a raw calibration blob.
+ *
+ * \param raw_calibration
+ * Raw calibration blob obtained from a device or recording. The raw calibration must be NULL terminated.
+ *
+ * \param raw_calibration_size
+ * The size, in bytes, of raw_calibration including the NULL termination.
+ *
+ * \param depth_mode
+ * Mode in which depth camera is operated.
+ *
+ * \param color_resolution
+ * Resolution in which color camera is operated.
+ *
+ * \param calibration
+ * Location to write the calibration.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if \p calibration was successfully written. ::K4A_RESULT_FAILED otherwise.
+ *
+ * \remarks
+ * The \p calibration represents the data needed to transform between the camera views and is
+ * different for each operating \p depth_mode and \p color_resolution the device is configured to operate in.
+ *
+ * \remarks
+ * The \p calibration output is used as input to all transformation functions.
+ *
+ * \see k4a_calibration_2d_to_2d()
+ * \see k4a_calibration_2d_to_3d()
+ * \see k4a_calibration_3d_to_2d()
+ * \see k4a_calibration_3d_to_3d()
+ *
+ * \relates k4a_device_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_calibration_get_from_raw(char *raw_calibration,
+                                                     size_t raw_calibration_size,
+                                                     const k4a_depth_mode_t depth_mode,
+                                                     const k4a_color_resolution_t color_resolution,
+                                                     k4a_calibration_t *calibration);
+
+/** Transform a 3D point of a source coordinate system into a 3D point of the target coordinate system
+ *
+ * \param calibration
+ * Location to read the camera calibration data.
+ *
+ * \param source_point3d_mm
+ * The 3D coordinates in millimeters representing a point in \p source_camera.
+ *
+ * \param source_camera
+ * The current camera.
+ *
+ * \param target_camera
+ * The target camera.
+ *
+ * \param target_point3d_mm
+ * Pointer to the output where the new 3D coordinates of the input point in the coordinate space of \p target_camera is
+ * stored in millimeters.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if \p target_point3d_mm was successfully written. ::K4A_RESULT_FAILED if \p calibration
+ * contained invalid transformation parameters.
+ *
+ * \remarks
+ * This function is used to transform 3D points between depth and color camera coordinate systems. The function uses the
+ * extrinsic camera calibration. It computes the output via multiplication with a precomputed matrix encoding a 3D
+ * rotation and a 3D translation. If \p source_camera and \p target_camera are the same, then \p target_point3d_mm will
+ * be identical to \p source_point3d_mm.
+ *
+ * \relates k4a_calibration_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_calibration_3d_to_3d(const k4a_calibration_t *calibration,
+                                                 const k4a_float3_t *source_point3d_mm,
+                                                 const k4a_calibration_type_t source_camera,
+                                                 const k4a_calibration_type_t target_camera,
+                                                 k4a_float3_t *target_point3d_mm);
+
+/** Transform a 2D pixel coordinate with an associated depth value of the source camera into a 3D point of the target
+ * coordinate system.
+ *
+ * \param calibration
+ * Location to read the camera calibration obtained by k4a_device_get_calibration().
+ *
+ * \param source_point2d
+ * The 2D pixel in \p source_camera coordinates.
+ *
+ * \param source_depth_mm
+ * The depth of \p source_point2d in millimeters. One way to derive the depth value in the color camera geometry is to
+ * use the function k4a_transformation_depth_image_to_color_camera().
+ *
+ * \param source_camera
+ * The current camera.
+ *
+ * \param target_camera
+ * The target camera.
+ *
+ * \param target_point3d_mm
+ * Pointer to the output where the 3D coordinates of the input pixel in the coordinate system of \p target_camera is
+ * stored in millimeters.
+ *
+ * \param valid
+ * The output parameter returns a value of 1 if the \p source_point2d is a valid coordinate, and will return 0 if
+ * the coordinate is not valid in the calibration model.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if \p target_point3d_mm was successfully written. ::K4A_RESULT_FAILED if \p calibration
+ * contained invalid transformation parameters. If the function returns ::K4A_RESULT_SUCCEEDED, but \p valid is 0,
+ * the transformation was computed, but the results in \p target_point3d_mm are outside of the range of valid
+ * calibration and should be ignored.
+ *
+ * \remarks
+ * This function applies the intrinsic calibration of \p source_camera to compute the 3D ray from the focal point of the
+ * camera through pixel \p source_point2d. The 3D point on this ray is then found using \p source_depth_mm. If \p
+ * target_camera is different from \p source_camera, the 3D point is transformed to \p target_camera using
+ * k4a_calibration_3d_to_3d(). In practice, \p source_camera and \p target_camera will often be identical. In this
+ * case, no 3D to 3D transformation is applied.
+ *
+ * \remarks
+ * If \p source_point2d is not considered as valid pixel coordinate
+ * according to the intrinsic camera model, \p valid is set to 0. If it is valid, \p valid will be set to 1. The user
+ * should not use the value of \p target_point3d_mm if \p valid was set to 0.
+ *
+ * \relates k4a_calibration_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_calibration_2d_to_3d(const k4a_calibration_t *calibration,
+                                                 const k4a_float2_t *source_point2d,
+                                                 const float source_depth_mm,
+                                                 const k4a_calibration_type_t source_camera,
+                                                 const k4a_calibration_type_t target_camera,
+                                                 k4a_float3_t *target_point3d_mm,
+                                                 int *valid);
+
+/** Transform a 3D point of a source coordinate system into a 2D pixel coordinate of the target camera.
+ *
+ * \param calibration
+ * Location to read the camera calibration obtained by k4a_device_get_calibration().
+ *
+ * \param source_point3d_mm
+ * The 3D coordinates in millimeters representing a point in \p source_camera
+ *
+ * \param source_camera
+ * The current camera.
+ *
+ * \param target_camera
+ * The target camera.
+ *
+ * \param target_point2d
+ * Pointer to the output where the 2D pixel in \p target_camera coordinates is stored.
+ *
+ * \param valid
+ * The output parameter returns a value of 1 if the \p source_point3d_mm is a valid coordinate in the \p target_camera
+ * coordinate system, and will return 0 if the coordinate is not valid in the calibration model.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if \p target_point2d was successfully written. ::K4A_RESULT_FAILED if \p calibration
+ * contained invalid transformation parameters. If the function returns ::K4A_RESULT_SUCCEEDED, but \p valid is 0,
+ * the transformation was computed, but the results in \p target_point2d are outside of the range of valid calibration
+ * and should be ignored.
+ *
+ * \remarks
+ * If \p target_camera is different from \p source_camera, \p source_point3d_mm is transformed to \p target_camera using
+ * k4a_calibration_3d_to_3d(). In practice, \p source_camera and \p target_camera will often be identical. In this
+ * case, no 3D to 3D transformation is applied. The 3D point in the coordinate system of \p target_camera is then
+ * projected onto the image plane using the intrinsic calibration of \p target_camera.
+ *
+ * \remarks
+ * If \p source_point3d_mm does not map to a valid 2D coordinate in the \p target_camera coordinate system, \p valid is
+ * set to 0. If it is valid, \p valid will be set to 1. The user should not use the value of \p target_point2d if \p
+ * valid was set to 0.
+ *
+ * \relates k4a_calibration_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_calibration_3d_to_2d(const k4a_calibration_t *calibration,
+                                                 const k4a_float3_t *source_point3d_mm,
+                                                 const k4a_calibration_type_t source_camera,
+                                                 const k4a_calibration_type_t target_camera,
+                                                 k4a_float2_t *target_point2d,
+                                                 int *valid);
+
+/** Transform a 2D pixel coordinate with an associated depth value of the source camera into a 2D pixel coordinate of
+ * the target camera.
+ *
+ * \param calibration
+ * Location to read the camera calibration obtained by k4a_device_get_calibration().
+ *
+ * \param source_point2d
+ * The 2D pixel in \p source_camera coordinates.
+ *
+ * \param source_depth_mm
+ * The depth of \p source_point2d in millimeters. One way to derive the depth value in the color camera geometry is to
+ * use the function k4a_transformation_depth_image_to_color_camera().
+ *
+ * \param source_camera
+ * The current camera.
+ *
+ * \param target_camera
+ * The target camera.
+ *
+ * \param target_point2d
+ * The 2D pixel in \p target_camera coordinates.
+ *
+ * \param valid
+ * The output parameter returns a value of 1 if the \p source_point2d is a valid coordinate in the \p target_camera
+ * coordinate system, and will return 0 if the coordinate is not valid in the calibration model.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if \p target_point2d was successfully written. ::K4A_RESULT_FAILED if \p calibration
+ * contained invalid transformation parameters. If the function returns ::K4A_RESULT_SUCCEEDED, but \p valid is 0,
+ * the transformation was computed, but the results in \p target_point2d are outside of the range of valid calibration
+ * and should be ignored.
+ *
+ * \remarks
+ * This function maps a pixel between the coordinate systems of the depth and color cameras. It is equivalent to calling
+ * k4a_calibration_2d_to_3d() to compute the 3D point corresponding to \p source_point2d and then using
+ * k4a_calibration_3d_to_2d() to map the 3D point into the coordinate system of the \p target_camera.
+ *
+ * \remarks
+ * If \p source_camera and \p target_camera are identical, the function immediately sets \p target_point2d to \p
+ * source_point2d and returns without computing any transformations.
+ *
+ * \remarks
+ * If \p source_point2d does not map to a valid 2D coordinate in the \p target_camera coordinate system, \p valid is set
+ * to 0. If it is valid, \p valid will be set to 1. The user should not use the value of \p target_point2d if \p valid
+ * was set to 0.
+ *
+ * \relates k4a_calibration_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_calibration_2d_to_2d(const k4a_calibration_t *calibration,
+                                                 const k4a_float2_t *source_point2d,
+                                                 const float source_depth_mm,
+                                                 const k4a_calibration_type_t source_camera,
+                                                 const k4a_calibration_type_t target_camera,
+                                                 k4a_float2_t *target_point2d,
+                                                 int *valid);
+
+/** Transform a 2D pixel coordinate from color camera into a 2D pixel coordinate of
+ * the depth camera.
+ *
+ * \param calibration
+ * Location to read the camera calibration obtained by k4a_device_get_calibration().
+ *
+ * \param source_point2d
+ * The 2D pixel in \p color camera coordinates.
+ *
+ * \param depth_image
+ * Handle to input depth image.
+ *
+ * \param target_point2d
+ * The 2D pixel in \p depth camera coordinates.
+ *
+ * \param valid
+ * The output parameter returns a value of 1 if the \p source_point2d is a valid coordinate in the \p target_camera
+ * coordinate system, and will return 0 if the coordinate is not valid in the calibration model.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if \p target_point2d was successfully written. ::K4A_RESULT_FAILED if \p calibration
+ * contained invalid transformation parameters. If the function returns ::K4A_RESULT_SUCCEEDED, but \p valid is 0,
+ * the transformation was computed, but the results in \p target_point2d are outside of the range of valid calibration
+ * and should be ignored.
+ *
+ * \remarks
+ * This function represents an alternative to k4a_calibration_2d_to_2d() if the number of pixels that need to be
+ * transformed is small. This function searches along an epipolar line in the depth image to find the corresponding
+ * depth pixel. If a larger number of pixels need to be transformed, it might be computationally cheaper to call
+ * k4a_transformation_depth_image_to_color_camera() to get correspondence depth values for these color pixels, then call
+ * the function k4a_calibration_2d_to_2d().
+ *
+ * \remarks
+ * If \p source_point2d does not map to a valid 2D coordinate in the \p target_camera coordinate system, \p valid is set
+ * to 0. If it is valid, \p valid will be set to 1. The user should not use the value of \p target_point2d if \p valid
+ * was set to 0.
+ *
+ * \relates k4a_calibration_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_calibration_color_2d_to_depth_2d(const k4a_calibration_t *calibration,
+                                                             const k4a_float2_t *source_point2d,
+                                                             const k4a_image_t depth_image,
+                                                             k4a_float2_t *target_point2d,
+                                                             int *valid);
+
+/** Transform an array of 2D pixel coordinates with associated depth values of the source camera into 3D points of the
+ * target coordinate system.
+ *
+ * \param calibration
+ * Location to read the camera calibration obtained by k4a_device_get_calibration().
+ *
+ * \param source_point2d
+ * The \p point_count 2D pixels in \p source_camera coordinates.
+ *
+ * \param source_depth_mm
+ * The \p point_count depth values of \p source_point2d in millimeters.
+ *
+ * \param point_count
+ * The number of points to transform.
+ *
+ * \param source_camera
+ * The current camera.
+ *
+ * \param target_camera
+ * The target camera.
+ *
+ * \param target_point3d_mm
+ * Pointer to the \p point_count outputs where the 3D coordinates of the input pixels in the coordinate system of \p
+ * target_camera are stored.
+ *
+ * \param valid
+ * Pointer to \p point_count outputs, each set to 1 if the matching \p source_point2d is a valid coordinate and 0 if it
+ * is not valid in the calibration model.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if \p target_point3d_mm was successfully written. ::K4A_RESULT_FAILED if \p calibration
+ * contained invalid transformation parameters.
+ *
+ * \remarks
+ * Each point gives the same result as k4a_calibration_2d_to_3d(). The calibration is only validated once and several
+ * points are computed at a time with SIMD instructions where the CPU supports them, so this is much faster than calling
+ * k4a_calibration_2d_to_3d() for each of many points.
+ *
+ * \relates k4a_calibration_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_calibration_2d_to_3d_batch(const k4a_calibration_t *calibration,
+                                                       const k4a_float2_t *source_point2d,
+                                                       const float *source_depth_mm,
+                                                       size_t point_count,
+                                                       const k4a_calibration_type_t source_camera,
+                                                       const k4a_calibration_type_t target_camera,
+                                                       k4a_float3_t *target_point3d_mm,
+                                                       int *valid);
+
+/** Transform an array of 3D points of a source coordinate system into 2D pixel coordinates of the target camera.
+ *
+ * \param calibration
+ * Location to read the camera calibration obtained by k4a_device_get_calibration().
+ *
+ * \param source_point3d_mm
+ * The \p point_count 3D coordinates in millimeters representing points in \p source_camera.
+ *
+ * \param point_count
+ * The number of points to transform.
+ *
+ * \param source_camera
+ * The current camera.
+ *
+ * \param target_camera
+ * The target camera.
+ *
+ * \param target_point2d
+ * Pointer to the \p point_count outputs where the 2D pixels in \p target_camera coordinates are stored.
+ *
+ * \param valid
+ * Pointer to \p point_count outputs, each set to 1 if the matching \p source_point3d_mm is a valid coordinate in the
+ * \p target_camera coordinate system and 0 if it is not valid in the calibration model.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if \p target_point2d was successfully written. ::K4A_RESULT_FAILED if \p calibration
+ * contained invalid transformation parameters.
+ *
+ * \remarks
+ * Each point gives the same result as k4a_calibration_3d_to_2d(), see k4a_calibration_2d_to_3d_batch().
+ *
+ * \relates k4a_calibration_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_calibration_3d_to_2d_batch(const k4a_calibration_t *calibration,
+                                                       const k4a_float3_t *source_point3d_mm,
+                                                       size_t point_count,
+                                                       const k4a_calibration_type_t source_camera,
+                                                       const k4a_calibration_type_t target_camera,
+                                                       k4a_float2_t *target_point2d,
+                                                       int *valid);
+
+/** Transform an array of 2D pixel coordinates with associated depth values of the source camera into 2D pixel
+ * coordinates of the target camera.
+ *
+ * \param calibration
+ * Location to read the camera calibration obtained by k4a_device_get_calibration().
+ *
+ * \param source_point2d
+ * The \p point_count 2D pixels in \p source_camera coordinates.
+ *
+ * \param source_depth_mm
+ * The \p point_count depth values of \p source_point2d in millimeters.
+ *
+ * \param point_count
+ * The number of points to transform.
+ *
+ * \param source_camera
+ * The current camera.
+ *
+ * \param target_camera
+ * The target camera.
+ *
+ * \param target_point2d
+ * Pointer to the \p point_count outputs where the 2D pixels in \p target_camera coordinates are stored.
+ *
+ * \param valid
+ * Pointer to \p point_count outputs, each set to 1 if the matching \p source_point2d is a valid coordinate in the \p
+ * target_camera coordinate system and 0 if it is not valid in the calibration model.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if \p target_point2d was successfully written. ::K4A_RESULT_FAILED if \p calibration
+ * contained invalid transformation parameters.
+ *
+ * \remarks
+ * Each point gives the same result as k4a_calibration_2d_to_2d(), see k4a_calibration_2d_to_3d_batch().
+ *
+ * \relates k4a_calibration_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_calibration_2d_to_2d_batch(const k4a_calibration_t *calibration,
+                                                       const k4a_float2_t *source_point2d,
+                                                       const float *source_depth_mm,
+                                                       size_t point_count,
+                                                       const k4a_calibration_type_t source_camera,
+                                                       const k4a_calibration_type_t target_camera,
+                                                       k4a_float2_t *target_point2d,
+                                                       int *valid);
+
+/** Transform an array of 2D pixel coordinates from color camera into 2D pixel coordinates of the depth camera.
+ *
+ * \param calibration
+ * Location to read the camera calibration obtained by k4a_device_get_calibration().
+ *
+ * \param source_point2d
+ * The \p point_count 2D pixels in \p color camera coordinates.
+ *
+ * \param point_count
+ * The number of points to transform.
+ *
+ * \param depth_image
+ * Handle to input depth image.
+ *
+ * \param target_point2d
+ * Pointer to the \p point_count outputs where the 2D pixels in \p depth camera coordinates are stored.
+ *
+ * \param valid
+ * Pointer to \p point_count outputs, each set to 1 if the matching \p source_point2d is a valid coordinate in the
+ * depth camera coordinate system and 0 if it is not valid in the calibration model.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if \p target_point2d was successfully written. ::K4A_RESULT_FAILED if \p calibration
+ * contained invalid transformation parameters.
+ *
+ * \remarks
+ * Each point gives the same result as k4a_calibration_color_2d_to_depth_2d(). The ends of every epipolar line are
+ * computed like k4a_calibration_2d_to_3d_batch(), the search along each line is still done a point at a time.
+ *
+ * \relates k4a_calibration_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_calibration_color_2d_to_depth_2d_batch(const k4a_calibration_t *calibration,
+                                                                   const k4a_float2_t *source_point2d,
+                                                                   size_t point_count,
+                                                                   const k4a_image_t depth_image,
+                                                                   k4a_float2_t *target_point2d,
+                                                                   int *valid);
+
+/** Get handle to transformation handle.
+ *
+ * \param calibration
+ * A calibration structure obtained by k4a_device_get_calibration().
+ *
+ * \returns
+ * A transformation handle. A NULL is returned if creation fails.
+ *
+ * \remarks
+ * The transformation handle is used to transform images from the coordinate system of one camera into the other. Each
+ * transformation handle requires some pre-computed resources to be allocated, which are retained until the handle is
+ * destroyed. They are built by the first function that needs them, or ahead of time by k4a_transformation_warm_up().
+ *
+ * \remarks
+ * The pre-computed unprojection tables are shared by every handle of the same camera calibration in the process, so
+ * only the first of them builds the tables. If the K4A_TRANSFORMATION_XY_TABLES_CACHE environment variable names an
+ * existing directory, the tables are also saved there and loaded by later processes instead of being built again.
+ *
+ * \remarks
+ * The transformation handle must be destroyed with k4a_transformation_destroy() when it is no longer to be used.
+ *
+ * \relates k4a_calibration_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_transformation_t k4a_transformation_create(const k4a_calibration_t *calibration);
+
+/** Get handle to transformation handle with its resources allocated by an application allocator.
+ *
+ * \param calibration
+ * A calibration structure obtained by k4a_device_get_calibration().
+ *
+ * \param allocate
+ * The callback function to allocate memory, called with #K4A_ALLOCATION_SOURCE_USER.
+ *
+ * \param free
+ * The callback function to free memory allocated by \p allocate.
+ *
+ * \param allocator_context
+ * Context passed to every call to \p allocate.
+ *
+ * \returns
+ * A transformation handle. A NULL is returned if creation fails or only one of \p allocate and \p free is NULL.
+ *
+ * \remarks
+ * Behaves like k4a_transformation_create(). The pre-computed tables the handle retains are allocated with \p allocate
+ * and not shared with other handles, for example from memory local to the NUMA node of the thread that calls the
+ * transformation functions. Passing NULL callbacks is the same as calling k4a_transformation_create().
+ *
+ * \relates k4a_calibration_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_transformation_t k4a_transformation_create_with_allocator(const k4a_calibration_t *calibration,
+                                                                         k4a_memory_allocate_source_cb_t *allocate,
+                                                                         k4a_memory_destroy_cb_t *free,
+                                                                         void *allocator_context);
+
+/** Destroy transformation handle.
+ *
+ * \param transformation_handle
+ * Transformation handle to destroy.
+ *
+ * \remarks
+ * Transformations queued with the asynchronous transformation functions complete, and their callbacks are called,
+ * before this function returns.
+ *
+ * \remarks
+ * When called from a k4a_transformation_complete_cb_t callback of \p transformation_handle, this function returns
+ * immediately and the handle is released on the SDK thread once the callback and the transformations still queued
+ * have completed. The handle must not be used after this function is called.
+ *
+ * \relates k4a_transformation_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT void k4a_transformation_destroy(k4a_transformation_t transformation_handle);
+
+/** Builds the pre-computed resources of a transformation handle ahead of its first transformation.
+ *
+ * \param transformation_handle
+ * Transformation handle.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the resources were built, ::K4A_RESULT_FAILED otherwise.
+ *
+ * \remarks
+ * The unprojection tables of each camera and the GPU transform engine are otherwise built by the first function that
+ * needs them, so a handle only used for the point clouds of the depth camera never builds the tables of the color
+ * camera. Calling this function moves that cost out of the first frame. It builds the tables of each camera that is
+ * on in the calibration, and the transform engine when the handle transforms on the GPU with both cameras on.
+ *
+ * \relates k4a_transformation_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_transformation_warm_up(k4a_transformation_t transformation_handle);
+
+/** Sets the number of threads the CPU implementation of the depth to color transformations uses.
+ *
+ * \param transformation_handle
+ * Transformation handle.
+ *
+ * \param thread_count
+ * Number of threads each depth image is split across, from 1 to 64. The default is 1.
+ *
+ * \remarks
+ * Applies to k4a_transformation_depth_image_to_color_camera() and
+ * k4a_transformation_depth_image_to_color_camera_custom() when they run on the CPU. That is the case when the
+ * K4A_TRANSFORMATION_DISABLE_GPU environment variable is set to 1 before the handle is created. The depth image is
+ * split into bands of rows that are transformed in parallel, then combined so the result matches a single thread
+ * exactly.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the thread count was set, ::K4A_RESULT_FAILED if \p thread_count is out of range.
+ *
+ * \relates k4a_transformation_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_transformation_set_cpu_thread_count(k4a_transformation_t transformation_handle,
+                                                                uint32_t thread_count);
+
+/** Selects how the CPU implementation of the depth to color transformations renders the depth image.
+ *
+ * \param transformation_handle
+ * Transformation handle.
+ *
+ * \param mode
+ * ::K4A_TRANSFORMATION_DEPTH_TO_COLOR_MODE_QUADS, the default, fills the surface between neighboring depth pixels.
+ * ::K4A_TRANSFORMATION_DEPTH_TO_COLOR_MODE_SPLAT and ::K4A_TRANSFORMATION_DEPTH_TO_COLOR_MODE_SPLAT_2X2 only write the
+ * color pixel nearest to each depth pixel, or the 2x2 color pixels around it, keeping the closest depth.
+ *
+ * \remarks
+ * Applies to k4a_transformation_depth_image_to_color_camera(), k4a_transformation_depth_image_to_color_camera_custom()
+ * and their region of interest variants when they run on the CPU. The transform engine and the OpenCL backend always
+ * fill the quads.
+ *
+ * \remarks
+ * Splatting costs a fraction of filling the quads, for consumers such as neural networks that tolerate holes. Where
+ * the color camera has a higher resolution than the depth camera, the color pixels between the splats stay 0. The
+ * custom image is not interpolated, each splat takes the custom value of its depth pixel.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the mode was selected, ::K4A_RESULT_FAILED if \p mode is unknown.
+ *
+ * \relates k4a_transformation_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_transformation_set_depth_to_color_mode(k4a_transformation_t transformation_handle,
+                                                                   k4a_transformation_depth_to_color_mode_t mode);
+
+/** Selects integer arithmetic for the color blend of the CPU color to depth transformations.
+ *
+ * \param transformation_handle
+ * Transformation handle.
+ *
+ * \param enable
+ * true to blend with fixed point weights, false for the default float blend.
+ *
+ * \remarks
+ * Applies to k4a_transformation_color_image_to_depth_camera() and k4a_transformation_color_image_to_depth_camera_roi()
+ * when they run on the CPU. The position of each depth pixel in the color image is rounded to 1/256 of a color pixel
+ * and the 4 color pixels around it are blended with integer multiplies, NEON on ARM64 and SSE on x86. Every channel
+ * is within 1 of the float blend, and the results are identical on every CPU.
+ *
+ * \remarks
+ * Meant for CPUs whose float throughput limits the blend, such as small ARM cores. The projection of the depth pixels
+ * into the color camera stays in float.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the blend was selected, ::K4A_RESULT_FAILED if \p transformation_handle is invalid.
+ *
+ * \relates k4a_transformation_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_transformation_set_fixed_point_bilinear(k4a_transformation_t transformation_handle,
+                                                                    bool enable);
+
+/** Gets the unprojection tables of the depth or color camera that the transformation built.
+ *
+ * \param transformation_handle
+ * Transformation handle.
+ *
+ * \param camera
+ * ::K4A_CALIBRATION_TYPE_DEPTH or ::K4A_CALIBRATION_TYPE_COLOR.
+ *
+ * \param xy_table
+ * Location to write the tables to. See ::k4a_xy_table_t for how a pixel and its depth map to a 3D point.
+ *
+ * \remarks
+ * The tables are built by k4a_transformation_create() with the iterative unprojection of
+ * k4a_calibration_2d_to_3d(), so applications computing point clouds with their own kernels need not call it
+ * for every pixel. They are read only and valid until \p transformation_handle is destroyed.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if \p xy_table was written, ::K4A_RESULT_FAILED if \p camera is not the depth or color
+ * camera or is off in the calibration of the transformation.
+ *
+ * \relates k4a_transformation_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_transformation_get_xy_table(k4a_transformation_t transformation_handle,
+                                                        k4a_calibration_type_t camera,
+                                                        k4a_xy_table_t *xy_table);
+
+/** Precomputes the depth camera rays used by the CPU implementation of the transformations between depth and color.
+ *
+ * \param transformation_handle
+ * Transformation handle.
+ *
+ * \param enable
+ * true to build the precomputed rays, false to release them. They are disabled by default.
+ *
+ * \remarks
+ * Applies to k4a_transformation_depth_image_to_color_camera(), k4a_transformation_depth_image_to_color_camera_custom()
+ * and k4a_transformation_color_image_to_depth_camera() when they run on the CPU. The unit ray of every depth pixel is
+ * rotated into the color camera once, so each frame only scales the rays by depth before the color camera projection.
+ * The tables take 12 bytes per depth pixel. The rounding differs slightly from the default path, which can move
+ * projected pixels by a fraction of a pixel.
+ *
+ * \remarks
+ * Transformations must not be in progress on \p transformation_handle while this function is called.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the rays were built or released, ::K4A_RESULT_FAILED if the handle has no depth and color
+ * calibration or the tables could not be allocated.
+ *
+ * \relates k4a_transformation_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_transformation_set_precomputed_rays(k4a_transformation_t transformation_handle,
+                                                                bool enable);
+
+/** Selects the implementation the transformations of a handle run on.
+ *
+ * \param transformation_handle
+ * Transformation handle.
+ *
+ * \param backend
+ * ::K4A_TRANSFORMATION_BACKEND_DEFAULT for the behavior of k4a_transformation_create(),
+ * ::K4A_TRANSFORMATION_BACKEND_CPU to always transform on the CPU, or ::K4A_TRANSFORMATION_BACKEND_OPENCL to transform
+ * with OpenCL compute kernels on the first GPU of the system.
+ *
+ * \remarks
+ * Applies to k4a_transformation_depth_image_to_color_camera(), k4a_transformation_depth_image_to_color_camera_custom(),
+ * k4a_transformation_color_image_to_depth_camera() and k4a_transformation_depth_image_to_point_cloud(). The region of
+ * interest variants and the other point cloud functions always run on the CPU.
+ *
+ * \remarks
+ * The OpenCL backend is available on builds configured with K4A_ENABLE_OPENCL and hosts with an OpenCL GPU driver, for
+ * instance those where the transform engine is not. It is set up by the first call selecting it, which compiles the
+ * kernels and uploads the calibration tables. Its results match the CPU implementation up to the rounding of the GPU,
+ * and where several depth pixels land on the same color pixel at the same depth, the smaller custom value is kept.
+ *
+ * \remarks
+ * Transformations must not be in progress on \p transformation_handle while this function is called.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the backend was selected, ::K4A_RESULT_FAILED if \p backend is unknown or the OpenCL
+ * backend is not available.
+ *
+ * \relates k4a_transformation_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_transformation_set_backend(k4a_transformation_t transformation_handle,
+                                                       k4a_transformation_backend_t backend);
+
+/** Keeps the results of the OpenCL transformation backend in GPU memory.
+ *
+ * \param transformation_handle
+ * Transformation handle.
+ *
+ * \param enable
+ * true to leave the results on the GPU, false to copy them to the output images. They are copied by default.
+ *
+ * \remarks
+ * While enabled, the transformations selected with k4a_transformation_set_backend() still take their output images and
+ * check them, but do not write them. The results are retrieved with k4a_transformation_get_gpu_output() instead, which
+ * saves the copy back to the host for consumers that process them on the GPU.
+ *
+ * \remarks
+ * Selecting another backend with k4a_transformation_set_backend() disables the GPU outputs.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the setting was changed, ::K4A_RESULT_FAILED if \p enable is true and the OpenCL backend is
+ * not selected.
+ *
+ * \relates k4a_transformation_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_transformation_set_gpu_output(k4a_transformation_t transformation_handle, bool enable);
+
+/** Gets the GPU buffer holding a result of the OpenCL transformation backend.
+ *
+ * \param transformation_handle
+ * Transformation handle.
+ *
+ * \param output
+ * Result to return.
+ *
+ * \param gpu_buffer
+ * Location to write the cl_mem of the result to.
+ *
+ * \remarks
+ * The buffer holds the result of the last transformation that produced \p output, laid out like the output image of
+ * that transformation without padding, and is complete when the transformation returns. The cl_context it belongs to
+ * is available from clGetMemObjectInfo() with CL_MEM_CONTEXT.
+ *
+ * \remarks
+ * Unless it is a target set with k4a_transformation_set_gpu_output_target(), the buffer is owned by
+ * \p transformation_handle. It is reused or replaced by the next transformation producing
+ * \p output and released by k4a_transformation_destroy(), so callers that keep it longer should retain it with
+ * clRetainMemObject().
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if \p gpu_buffer was written, ::K4A_RESULT_FAILED if the OpenCL backend was never selected or
+ * has not produced \p output yet.
+ *
+ * \relates k4a_transformation_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_transformation_get_gpu_output(k4a_transformation_t transformation_handle,
+                                                          k4a_transformation_gpu_output_t output,
+                                                          void **gpu_buffer);
+
+/** Sets the OpenCL context the OpenCL transformation backend runs in.
+ *
+ * \param transformation_handle
+ * Transformation handle.
+ *
+ * \param gpu_context
+ * cl_context to create the command queue, the programs and the buffers of the backend in, or NULL to create a context
+ * on the first GPU of the system.
+ *
+ * \param gpu_device
+ * cl_device_id of \p gpu_context to run on, NULL if \p gpu_context is NULL.
+ *
+ * \remarks
+ * Sharing the context of the application lets the results be used without copies between contexts. A context created
+ * with the cl_khr_gl_sharing properties of an OpenGL context also allows OpenGL buffers as output targets, see
+ * k4a_transformation_set_gpu_output_target().
+ *
+ * \remarks
+ * The context must be set before the OpenCL backend is first selected with k4a_transformation_set_backend(), which
+ * retains it until k4a_transformation_destroy().
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the context was set, ::K4A_RESULT_FAILED if only one of \p gpu_context and \p gpu_device
+ * is NULL or the OpenCL backend was already selected.
+ *
+ * \relates k4a_transformation_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_transformation_set_gpu_context(k4a_transformation_t transformation_handle,
+                                                           void *gpu_context,
+                                                           void *gpu_device);
+
+/** Writes a result of the OpenCL transformation backend to a GPU resource owned by the caller.
+ *
+ * \param transformation_handle
+ * Transformation handle.
+ *
+ * \param output
+ * Result to write to \p target.
+ *
+ * \param target_type
+ * Kind of \p target.
+ *
+ * \param target
+ * cl_mem for ::K4A_TRANSFORMATION_GPU_TARGET_OPENCL_BUFFER, or an OpenGL buffer name cast with (void *)(uintptr_t) for
+ * ::K4A_TRANSFORMATION_GPU_TARGET_OPENGL_BUFFER. Ignored for ::K4A_TRANSFORMATION_GPU_TARGET_NONE, which returns
+ * \p output to a buffer allocated by the transformation.
+ *
+ * \remarks
+ * The transformations producing \p output write it to \p target directly, laid out like their output image without
+ * padding, and fail if \p target is too small. Combined with k4a_transformation_set_gpu_output() this removes the
+ * device to host and host to device copies between the transformation and a renderer or another GPU stage.
+ * k4a_transformation_get_gpu_output() returns the cl_mem of \p target.
+ *
+ * \remarks
+ * OpenCL buffers must belong to the context of the backend. OpenGL buffers need a context set with
+ * k4a_transformation_set_gpu_context() that shares objects with the current OpenGL context. OpenGL must be done with
+ * the buffer (glFinish()) before a transformation starts, and the transformation has completed its OpenCL work on the
+ * buffer when it returns.
+ *
+ * \remarks
+ * The target is retained until it is replaced, or until k4a_transformation_destroy(). Transformations must not be in
+ * progress on \p transformation_handle while this function is called.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the target was set, ::K4A_RESULT_FAILED if the OpenCL backend was never selected or
+ * \p target cannot be used by it.
+ *
+ * \relates k4a_transformation_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_transformation_set_gpu_output_target(k4a_transformation_t transformation_handle,
+                                                                 k4a_transformation_gpu_output_t output,
+                                                                 k4a_transformation_gpu_target_t target_type,
+                                                                 void *target);
+
+/** Transforms the depth map into the geometry of the color camera.
+ *
+ * \param transformation_handle
+ * Transformation handle.
+ *
+ * \param depth_image
+ * Handle to input depth image.
+ *
+ * \param transformed_depth_image
+ * Handle to output transformed depth image.
+ *
+ * \remarks
+ * This produces a depth image for which each pixel matches the corresponding pixel coordinates of the color camera.
+ *
+ * \remarks
+ * \p depth_image and \p transformed_depth_image must be of format ::K4A_IMAGE_FORMAT_DEPTH16.
+ *
+ * \remarks
+ * \p transformed_depth_image must have a width and height matching the width and height of the color camera in the mode
+ * specified by the \ref k4a_calibration_t used to create the \p transformation_handle with k4a_transformation_create().
+ *
+ * \remarks
+ * The contents \p transformed_depth_image will be filled with the depth values derived from \p depth_image in the color
+ * camera's coordinate space.
+ *
+ * \remarks
+ * \p transformed_depth_image should be created by the caller using k4a_image_create() or
+ * k4a_image_create_from_buffer().
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if \p transformed_depth_image was successfully written and ::K4A_RESULT_FAILED otherwise.
+ *
+ * \relates k4a_transformation_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_transformation_depth_image_to_color_camera(k4a_transformation_t transformation_handle,
+                                                                       const k4a_image_t depth_image,
+                                                                       k4a_image_t transformed_depth_image);
+
+/** Transforms depth map and a custom image into the geometry of the color camera.
+ *
+ * \param transformation_handle
+ * Transformation handle.
+ *
+ * \param depth_image
+ * Handle to input depth image.
+ *
+ * \param custom_image
+ * Handle to input custom image.
+ *
+ * \param transformed_depth_image
+ * Handle to output transformed depth image.
+ *
+ * \param transformed_custom_image
+ * Handle to output transformed custom image.
+ *
+ * \param interpolation_type
+ * Parameter that controls how pixels in \p custom_image should be interpolated when transformed to color camera space.
+ * K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR if linear interpolation should be used.
+ * K4A_TRANSFORMATION_INTERPOLATION_TYPE_NEAREST if nearest neighbor interpolation should be used.
+ *
+ * \param invalid_custom_value
+ * Defines the custom image pixel value that should be written to \p transformed_custom_image in case the corresponding
+ * depth pixel can not be transformed into the color camera space.
+ *
+ * \remarks
+ * This produces a depth image and a corresponding custom image for which each pixel matches the corresponding
+ * pixel coordinates of the color camera.
+ *
+ * \remarks
+ * \p depth_image and \p transformed_depth_image must be of format ::K4A_IMAGE_FORMAT_DEPTH16.
+ *
+ * \remarks
+ * \p custom_image and \p transformed_custom_image must be of format ::K4A_IMAGE_FORMAT_CUSTOM8 or
+ * ::K4A_IMAGE_FORMAT_CUSTOM16.
+ *
+ * \remarks
+ * \p transformed_depth_image and \p transformed_custom_image must have a width and height matching the width and
+ * height of the color camera in the mode specified by the \ref k4a_calibration_t used to create the
+ * \p transformation_handle with k4a_transformation_create().
+ *
+ * \remarks
+ * \p custom_image must have a width and height matching the width and height of \p depth_image.
+ *
+ * \remarks
+ * The contents \p transformed_depth_image will be filled with the depth values derived from \p depth_image in the color
+ * camera's coordinate space.
+ *
+ * \remarks
+ * The contents \p transformed_custom_image will be filled with the values derived from \p custom_image in the color
+ * camera's coordinate space.
+ *
+ * \remarks
+ * \p transformed_depth_image and \p transformed_custom_image should be created by the caller using k4a_image_create()
+ * or k4a_image_create_from_buffer().
+ *
+ * \remarks
+ * Using ::K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR for \p interpolation_type could create new values to \p
+ * transformed_custom_image which do no exist in \p custom_image. Using ::K4A_TRANSFORMATION_INTERPOLATION_TYPE_NEAREST
+ * will prevent this from happenning but will result in a less smooth image.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if \p transformed_depth_image and \p transformed_custom_image were successfully written and
+ * ::K4A_RESULT_FAILED otherwise.
+ *
+ * \relates k4a_transformation_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t
+k4a_transformation_depth_image_to_color_camera_custom(k4a_transformation_t transformation_handle,
+                                                      const k4a_image_t depth_image,
+                                                      const k4a_image_t custom_image,
+                                                      k4a_image_t transformed_depth_image,
+                                                      k4a_image_t transformed_custom_image,
+                                                      k4a_transformation_interpolation_type_t interpolation_type,
+                                                      uint32_t invalid_custom_value);
+
+/** Transforms depth map and several custom images into the geometry of the color camera in one pass.
+ *
+ * \param transformation_handle
+ * Transformation handle.
+ *
+ * \param depth_image
+ * Handle to input depth image.
+ *
+ * \param custom_images
+ * Array of \p custom_image_count handles to input custom images.
+ *
+ * \param custom_image_count
+ * Number of custom images, from 1 to 8.
+ *
+ * \param transformed_depth_image
+ * Handle to output transformed depth image.
+ *
+ * \param transformed_custom_images
+ * Array of \p custom_image_count handles to output transformed custom images, one for each entry of \p custom_images.
+ *
+ * \param interpolation_type
+ * Parameter that controls how pixels in \p custom_images should be interpolated when transformed to color camera space.
+ *
+ * \param invalid_custom_value
+ * Defines the custom image pixel value that should be written to \p transformed_custom_images in case the
+ * corresponding depth pixel can not be transformed into the color camera space.
+ *
+ * \remarks
+ * Produces the same images as calling k4a_transformation_depth_image_to_color_camera_custom() once for each custom
+ * image, with the same requirements on every image. All of \p custom_images must share one format, width and height,
+ * as must all of \p transformed_custom_images.
+ *
+ * \remarks
+ * When the transformation runs on the CPU the depth image is projected and rasterized once and every custom image is
+ * interpolated in that pass, instead of repeating the projection for each of them. The other backends transform the
+ * custom images one at a time.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if \p transformed_depth_image and all of \p transformed_custom_images were successfully
+ * written and ::K4A_RESULT_FAILED otherwise.
+ *
+ * \relates k4a_transformation_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t
+k4a_transformation_depth_image_to_color_camera_custom_planes(k4a_transformation_t transformation_handle,
+                                                             const k4a_image_t depth_image,
+                                                             const k4a_image_t *custom_images,
+                                                             uint32_t custom_image_count,
+                                                             k4a_image_t transformed_depth_image,
+                                                             k4a_image_t *transformed_custom_images,
+                                                             k4a_transformation_interpolation_type_t interpolation_type,
+                                                             uint32_t invalid_custom_value);
+
+/** Transforms the depth map into a region of the geometry of the color camera.
+ *
+ * \param transformation_handle
+ * Transformation handle.
+ *
+ * \param depth_image
+ * Handle to input depth image.
+ *
+ * \param roi
+ * Region of the color camera image to produce.
+ *
+ * \param transformed_depth_image
+ * Handle to output transformed depth image, the size of \p roi.
+ *
+ * \remarks
+ * Produces the \p roi region of the image k4a_transformation_depth_image_to_color_camera() would, rendering only the
+ * parts of the depth image that land inside it. Every depth pixel is still projected, since where it lands depends on
+ * its depth.
+ *
+ * \remarks
+ * \p transformed_depth_image must be of format ::K4A_IMAGE_FORMAT_DEPTH16, with a width and height matching \p roi
+ * and a stride in bytes of 2 times the width of \p roi. \p roi must lie inside the color camera image.
+ *
+ * \remarks
+ * Always runs on the CPU, with the thread count and precomputed rays of \p transformation_handle.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if \p transformed_depth_image was successfully written and ::K4A_RESULT_FAILED otherwise.
+ *
+ * \relates k4a_transformation_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_transformation_depth_image_to_color_camera_roi(k4a_transformation_t transformation_handle,
+                                                                           const k4a_image_t depth_image,
+                                                                           const k4a_rect_t *roi,
+                                                                           k4a_image_t transformed_depth_image);
+
+/** Transforms a color image into the geometry of the depth camera.
+ *
+ * \param transformation_handle
+ * Transformation handle.
+ *
+ * \param depth_image
+ * Handle to input depth image.
+ *
+ * \param color_image
+ * Handle to input color image.
+ *
+ * \param transformed_color_image
+ * Handle to output transformed color image.
+ *
+ * \remarks
+ * This produces a color image for which each pixel matches the corresponding pixel coordinates of the depth camera.
+ *
+ * \remarks
+ * \p depth_image and \p color_image need to represent the same moment in time. The depth data will be applied to the
+ * color image to properly warp the color data to the perspective of the depth camera.
+ *
+ * \remarks
+ * \p depth_image must be of type ::K4A_IMAGE_FORMAT_DEPTH16. \p color_image must be of format
+ * ::K4A_IMAGE_FORMAT_COLOR_BGRA32.
+ *
+ * \remarks
+ * \p transformed_color_image image must be of format ::K4A_IMAGE_FORMAT_COLOR_BGRA32. \p transformed_color_image must
+ * have the width and height of the depth camera in the mode specified by the \ref k4a_calibration_t used to create
+ * the \p transformation_handle with k4a_transformation_create().
+ *
+ * \remarks
+ * \p transformed_color_image should be created by the caller using k4a_image_create() or
+ * k4a_image_create_from_buffer().
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if \p transformed_color_image was successfully written and ::K4A_RESULT_FAILED otherwise.
+ *
+ * \relates k4a_transformation_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_transformation_color_image_to_depth_camera(k4a_transformation_t transformation_handle,
+                                                                       const k4a_image_t depth_image,
+                                                                       const k4a_image_t color_image,
+                                                                       k4a_image_t transformed_color_image);
+
+/** Transforms a color image into a region of the geometry of the depth camera.
+ *
+ * \param transformation_handle
+ * Transformation handle.
+ *
+ * \param depth_image
+ * Handle to input depth image.
+ *
+ * \param color_image
+ * Handle to input color image.
+ *
+ * \param roi
+ * Region of the depth image to produce the color of.
+ *
+ * \param transformed_color_image
+ * Handle to output transformed color image, the size of \p roi.
+ *
+ * \remarks
+ * Produces the \p roi region of the image k4a_transformation_color_image_to_depth_camera() would, only transforming
+ * the depth pixels inside it.
+ *
+ * \remarks
+ * \p transformed_color_image must be of format ::K4A_IMAGE_FORMAT_COLOR_BGRA32, with a width and height matching
+ * \p roi and a stride in bytes of 4 times the width of \p roi. \p roi must lie inside the depth image.
+ *
+ * \remarks
+ * Always runs on the CPU, with the precomputed rays of \p transformation_handle.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if \p transformed_color_image was successfully written and ::K4A_RESULT_FAILED otherwise.
+ *
+ * \relates k4a_transformation_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_transformation_color_image_to_depth_camera_roi(k4a_transformation_t transformation_handle,
+                                                                           const k4a_image_t depth_image,
+                                                                           const k4a_image_t color_image,
+                                                                           const k4a_rect_t *roi,
+                                                                           k4a_image_t transformed_color_image);
+
+/** Transforms the depth image into a single image with voxels representing
+ * X, Y and Z-coordinates in millimeters of corresponding 3D points.
+ *
+ * \param transformation_handle
+ * Transformation handle.
+ *
+ * \param depth_image
+ * Handle to input depth image.
+ *
+ * \param camera
+ * Geometry in which depth map was computed.
+ *
+ * \param xyz_image
+ * Handle to output xyz image.
+ *
+ * \remarks
+ * \p depth_image must be of format ::K4A_IMAGE_FORMAT_DEPTH16.
  *
- * \param device_handle
- * Handle obtained by k4a_device_open().
+ * \remarks
+ * The \p camera parameter tells the function what the perspective of the \p depth_image is. If the \p depth_image was
+ * captured directly from the depth camera, the value should be ::K4A_CALIBRATION_TYPE_DEPTH. If the \p depth_image is
+ * the result of a transformation into the color camera's coordinate space using
+ * k4a_transformation_depth_image_to_color_camera(), the value should be ::K4A_CALIBRATION_TYPE_COLOR.
  *
- * \param data
- * Location to write the calibration data to. This field may optionally be set to NULL for the caller to query for
- * the needed data size.
+ * \remarks
+ * The format of \p xyz_image must be ::K4A_IMAGE_FORMAT_CUSTOM. The width and height of \p xyz_image must match the
+ * width and height of \p depth_image. \p xyz_image must have a stride in bytes of at least 6 times its width in pixels.
  *
- * \param data_size
- * On passing \p data_size into the function this variable represents the available size of the \p data
- * buffer. On return this variable is updated with the amount of data actually written to the buffer, or the size
- * required to store the calibration buffer if \p data is NULL.
+ * \remarks
+ * Each pixel of the \p xyz_image consists of three int16_t values, totaling 6 bytes. The three int16_t values are the
+ * X, Y, and Z values of the point.
+ *
+ * \remarks
+ * \p xyz_image should be created by the caller using k4a_image_create() or k4a_image_create_from_buffer().
  *
  * \returns
- * ::K4A_BUFFER_RESULT_SUCCEEDED if \p data was successfully written. If \p data_size points to a buffer size that is
- * too small to hold the output or \p data is NULL, ::K4A_BUFFER_RESULT_TOO_SMALL is returned and \p data_size is
- * updated to contain the minimum buffer size needed to capture the calibration data.
+ * ::K4A_RESULT_SUCCEEDED if \p xyz_image was successfully written and ::K4A_RESULT_FAILED otherwise.
  *
- * \relates k4a_device_t
+ * \relates k4a_transformation_t
  *
  * \xmlonly
  * <requirements>
@@ -1575,40 +5223,40 @@ K4A_EXPORT k4a_result_t k4a_device_set_color_control(k4a_device_t device_handle,
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT k4a_buffer_result_t k4a_device_get_raw_calibration(k4a_device_t device_handle,
-                                                              uint8_t *data,
-                                                              size_t *data_size);
+K4A_EXPORT k4a_result_t k4a_transformation_depth_image_to_point_cloud(k4a_transformation_t transformation_handle,
+                                                                      const k4a_image_t depth_image,
+                                                                      const k4a_calibration_type_t camera,
+                                                                      k4a_image_t xyz_image);
 
-/** Get the camera calibration for the entire Azure Kinect device.
+/** Transforms a region of the depth image into a point cloud.
  *
- * \param device_handle
- * Handle obtained by k4a_device_open().
+ * \param transformation_handle
+ * Transformation handle.
  *
- * \param depth_mode
- * Mode in which depth camera is operated.
+ * \param depth_image
+ * Handle to input depth image.
  *
- * \param color_resolution
- * Resolution in which color camera is operated.
+ * \param camera
+ * Geometry in which depth map was computed.
  *
- * \param calibration
- * Location to write the calibration
+ * \param roi
+ * Region of \p depth_image to transform.
  *
- * \returns
- * ::K4A_RESULT_SUCCEEDED if \p calibration was successfully written. ::K4A_RESULT_FAILED otherwise.
+ * \param xyz_image
+ * Handle to output xyz image, the size of \p roi.
  *
  * \remarks
- * The \p calibration represents the data needed to transform between the camera views and may be
- * different for each operating \p depth_mode and \p color_resolution the device is configured to operate in.
+ * Produces the \p roi region of the point cloud k4a_transformation_depth_image_to_point_cloud() would, only
+ * transforming the depth pixels inside it.
  *
  * \remarks
- * The \p calibration output is used as input to all calibration and transformation functions.
+ * The format of \p xyz_image must be ::K4A_IMAGE_FORMAT_CUSTOM, with a width and height matching \p roi and a stride
+ * in bytes of 6 times the width of \p roi. \p roi must lie inside \p depth_image.
  *
- * \see k4a_calibration_2d_to_2d()
- * \see k4a_calibration_2d_to_3d()
- * \see k4a_calibration_3d_to_2d()
- * \see k4a_calibration_3d_to_3d()
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if \p xyz_image was successfully written and ::K4A_RESULT_FAILED otherwise.
  *
- * \relates k4a_device_t
+ * \relates k4a_transformation_t
  *
  * \xmlonly
  * <requirements>
@@ -1618,34 +5266,42 @@ K4A_EXPORT k4a_buffer_result_t k4a_device_get_raw_calibration(k4a_device_t devic
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT k4a_result_t k4a_device_get_calibration(k4a_device_t device_handle,
-                                                   const k4a_depth_mode_t depth_mode,
-                                                   const k4a_color_resolution_t color_resolution,
-                                                   k4a_calibration_t *calibration);
+K4A_EXPORT k4a_result_t k4a_transformation_depth_image_to_point_cloud_roi(k4a_transformation_t transformation_handle,
+                                                                         const k4a_image_t depth_image,
+                                                                         const k4a_calibration_type_t camera,
+                                                                         const k4a_rect_t *roi,
+                                                                         k4a_image_t xyz_image);
 
-/** Get the device jack status for the synchronization in and synchronization out connectors.
+/** Transforms the depth image into a point cloud of a given format.
  *
- * \param device_handle
- * Handle obtained by k4a_device_open().
+ * \param transformation_handle
+ * Transformation handle.
  *
- * \param sync_in_jack_connected
- * Upon successful return this value will be set to true if a cable is connected to this sync in jack.
+ * \param depth_image
+ * Handle to input depth image.
  *
- * \param sync_out_jack_connected
- * Upon successful return this value will be set to true if a cable is connected to this sync out jack.
+ * \param camera
+ * Geometry in which depth map was computed.
  *
- * \returns
- * ::K4A_RESULT_SUCCEEDED if the connector status was successfully read.
+ * \param format
+ * Layout of each point written to \p xyz_image.
  *
- * \relates k4a_device_t
+ * \param xyz_image
+ * Handle to output xyz image.
  *
  * \remarks
- * If \p sync_out_jack_connected is true then \ref k4a_device_configuration_t wired_sync_mode mode can be set to \ref
- * K4A_WIRED_SYNC_MODE_STANDALONE or \ref K4A_WIRED_SYNC_MODE_MASTER. If \p sync_in_jack_connected is true then \ref
- * k4a_device_configuration_t wired_sync_mode mode can be set to \ref K4A_WIRED_SYNC_MODE_STANDALONE or \ref
- * K4A_WIRED_SYNC_MODE_SUBORDINATE.
+ * Behaves like k4a_transformation_depth_image_to_point_cloud(), which writes ::K4A_POINT_CLOUD_FORMAT_INT16_XYZ. The
+ * float formats are not rounded to whole millimeters. The spacing of half precision values is 1 millimeter up to 2048
+ * millimeters and doubles with each power of 2 beyond, reaching 8 millimeters at 8192.
  *
- * \see k4a_device_start_cameras()
+ * \remarks
+ * The format of \p xyz_image must be ::K4A_IMAGE_FORMAT_CUSTOM. The width and height of \p xyz_image must match the
+ * width and height of \p depth_image, with a stride in bytes of the point size of \p format times its width in pixels.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if \p xyz_image was successfully written and ::K4A_RESULT_FAILED otherwise.
+ *
+ * \relates k4a_transformation_t
  *
  * \xmlonly
  * <requirements>
@@ -1655,43 +5311,48 @@ K4A_EXPORT k4a_result_t k4a_device_get_calibration(k4a_device_t device_handle,
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT k4a_result_t k4a_device_get_sync_jack(k4a_device_t device_handle,
-                                                 bool *sync_in_jack_connected,
-                                                 bool *sync_out_jack_connected);
+K4A_EXPORT k4a_result_t
+k4a_transformation_depth_image_to_formatted_point_cloud(k4a_transformation_t transformation_handle,
+                                                        const k4a_image_t depth_image,
+                                                        const k4a_calibration_type_t camera,
+                                                        k4a_point_cloud_format_t format,
+                                                        k4a_image_t xyz_image);
 
-/** Get the camera calibration for a device from a raw calibration blob.
+/** Transforms the depth image into a point cloud holding only the pixels with depth.
  *
- * \param raw_calibration
- * Raw calibration blob obtained from a device or recording. The raw calibration must be NULL terminated.
+ * \param transformation_handle
+ * Transformation handle.
  *
- * \param raw_calibration_size
- * The size, in bytes, of raw_calibration including the NULL termination.
+ * \param depth_image
+ * Handle to input depth image.
  *
- * \param depth_mode
- * Mode in which depth camera is operated.
+ * \param camera
+ * Geometry in which depth map was computed.
  *
- * \param color_resolution
- * Resolution in which color camera is operated.
+ * \param xyz_image
+ * Handle to output xyz image.
  *
- * \param calibration
- * Location to write the calibration.
+ * \param pixel_indices
+ * Optional buffer receiving, for each point written, the index y * width + x of its pixel in \p depth_image. May be
+ * NULL, otherwise it must hold as many elements as \p depth_image has pixels.
  *
- * \returns
- * ::K4A_RESULT_SUCCEEDED if \p calibration was successfully written. ::K4A_RESULT_FAILED otherwise.
+ * \param point_count
+ * Receives the number of points written.
  *
  * \remarks
- * The \p calibration represents the data needed to transform between the camera views and is
- * different for each operating \p depth_mode and \p color_resolution the device is configured to operate in.
+ * Behaves like k4a_transformation_depth_image_to_point_cloud(), except that pixels without depth are skipped and the
+ * remaining points are packed in pixel order at the start of \p xyz_image. The contents of \p xyz_image after the first
+ * \p point_count points are undefined.
  *
  * \remarks
- * The \p calibration output is used as input to all transformation functions.
+ * The format of \p xyz_image must be ::K4A_IMAGE_FORMAT_CUSTOM. The width and height of \p xyz_image must match the
+ * width and height of \p depth_image, with a stride in bytes of 6 times its width in pixels, so that it can hold a
+ * point for every pixel.
  *
- * \see k4a_calibration_2d_to_2d()
- * \see k4a_calibration_2d_to_3d()
- * \see k4a_calibration_3d_to_2d()
- * \see k4a_calibration_3d_to_3d()
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if \p xyz_image was successfully written and ::K4A_RESULT_FAILED otherwise.
  *
- * \relates k4a_device_t
+ * \relates k4a_transformation_t
  *
  * \xmlonly
  * <requirements>
@@ -1701,41 +5362,61 @@ K4A_EXPORT k4a_result_t k4a_device_get_sync_jack(k4a_device_t device_handle,
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT k4a_result_t k4a_calibration_get_from_raw(char *raw_calibration,
-                                                     size_t raw_calibration_size,
-                                                     const k4a_depth_mode_t depth_mode,
-                                                     const k4a_color_resolution_t color_resolution,
-                                                     k4a_calibration_t *calibration);
+K4A_EXPORT k4a_result_t k4a_transformation_depth_image_to_valid_point_cloud(k4a_transformation_t transformation_handle,
+                                                                            const k4a_image_t depth_image,
+                                                                            const k4a_calibration_type_t camera,
+                                                                            k4a_image_t xyz_image,
+                                                                            uint32_t *pixel_indices,
+                                                                            size_t *point_count);
 
-/** Transform a 3D point of a source coordinate system into a 3D point of the target coordinate system
+/** Transforms the depth image into a point cloud in the color camera, with the color of each point.
  *
- * \param calibration
- * Location to read the camera calibration data.
+ * \param transformation_handle
+ * Transformation handle.
  *
- * \param source_point3d_mm
- * The 3D coordinates in millimeters representing a point in \p source_camera.
+ * \param depth_image
+ * Handle to input depth image.
  *
- * \param source_camera
- * The current camera.
+ * \param color_image
+ * Handle to input color image.
  *
- * \param target_camera
- * The target camera.
+ * \param valid_points_only
+ * true to write only the points with depth, packed at the start of \p xyz_image and \p bgra_image. false to write a
+ * point for every color camera pixel, with X, Y and Z of 0 where there is no depth.
  *
- * \param target_point3d_mm
- * Pointer to the output where the new 3D coordinates of the input point in the coordinate space of \p target_camera is
- * stored in millimeters.
+ * \param xyz_image
+ * Handle to output xyz image.
  *
- * \returns
- * ::K4A_RESULT_SUCCEEDED if \p target_point3d_mm was successfully written. ::K4A_RESULT_FAILED if \p calibration
- * contained invalid transformation parameters.
+ * \param bgra_image
+ * Handle to output color image, holding the color of the point at the same index in \p xyz_image.
+ *
+ * \param point_count
+ * Receives the number of points written.
  *
  * \remarks
- * This function is used to transform 3D points between depth and color camera coordinate systems. The function uses the
- * extrinsic camera calibration. It computes the output via multiplication with a precomputed matrix encoding a 3D
- * rotation and a 3D translation. If \p source_camera and \p target_camera are the same, then \p target_point3d_mm will
- * be identical to \p source_point3d_mm.
+ * The result matches k4a_transformation_depth_image_to_color_camera() followed by
+ * k4a_transformation_depth_image_to_point_cloud() with ::K4A_CALIBRATION_TYPE_COLOR, without the transformed depth
+ * image and with a single pass that writes both the points and their colors.
  *
- * \relates k4a_calibration_t
+ * \remarks
+ * \p depth_image must be of format ::K4A_IMAGE_FORMAT_DEPTH16. \p color_image and \p bgra_image must be of format
+ * ::K4A_IMAGE_FORMAT_COLOR_BGRA32, with the width and height of the color camera and a stride in bytes of 4 times the
+ * width in pixels.
+ *
+ * \remarks
+ * The format of \p xyz_image must be ::K4A_IMAGE_FORMAT_CUSTOM. The width and height of \p xyz_image must match the
+ * color camera, with a stride in bytes of 6 times its width in pixels. Each pixel consists of the three int16_t X, Y
+ * and Z values of the point in millimeters.
+ *
+ * \remarks
+ * With \p valid_points_only the contents of \p xyz_image and \p bgra_image after the first \p point_count points are
+ * undefined.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if \p xyz_image and \p bgra_image were successfully written and ::K4A_RESULT_FAILED
+ * otherwise.
+ *
+ * \relates k4a_transformation_t
  *
  * \xmlonly
  * <requirements>
@@ -1745,58 +5426,68 @@ K4A_EXPORT k4a_result_t k4a_calibration_get_from_raw(char *raw_calibration,
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT k4a_result_t k4a_calibration_3d_to_3d(const k4a_calibration_t *calibration,
-                                                 const k4a_float3_t *source_point3d_mm,
-                                                 const k4a_calibration_type_t source_camera,
-                                                 const k4a_calibration_type_t target_camera,
-                                                 k4a_float3_t *target_point3d_mm);
+K4A_EXPORT k4a_result_t
+k4a_transformation_depth_image_to_colored_point_cloud(k4a_transformation_t transformation_handle,
+                                                      const k4a_image_t depth_image,
+                                                      const k4a_image_t color_image,
+                                                      bool valid_points_only,
+                                                      k4a_image_t xyz_image,
+                                                      k4a_image_t bgra_image,
+                                                      size_t *point_count);
 
-/** Transform a 2D pixel coordinate with an associated depth value of the source camera into a 3D point of the target
- * coordinate system.
+/** Fuses the depth images of several devices into one point cloud of a common frame.
  *
- * \param calibration
- * Location to read the camera calibration obtained by k4a_device_get_calibration().
+ * \param inputs
+ * Depth image, optional color image, transformation handle and pose of each device.
  *
- * \param source_point2d
- * The 2D pixel in \p source_camera coordinates.
+ * \param input_count
+ * Number of entries of \p inputs.
  *
- * \param source_depth_mm
- * The depth of \p source_point2d in millimeters. One way to derive the depth value in the color camera geometry is to
- * use the function k4a_transformation_depth_image_to_color_camera().
+ * \param format
+ * ::K4A_POINT_CLOUD_FORMAT_FLOAT32_XYZ or ::K4A_POINT_CLOUD_FORMAT_FLOAT32_XYZW, the layout of each point of
+ * \p xyz_image.
  *
- * \param source_camera
- * The current camera.
+ * \param valid_points_only
+ * true to write only the points with depth, packed at the start of \p xyz_image and \p bgra_image. false to write a
+ * point for every depth pixel, with X, Y and Z of 0 where there is no depth.
  *
- * \param target_camera
- * The target camera.
+ * \param xyz_image
+ * Handle to output xyz image.
  *
- * \param target_point3d_mm
- * Pointer to the output where the 3D coordinates of the input pixel in the coordinate system of \p target_camera is
- * stored in millimeters.
+ * \param bgra_image
+ * Handle to output color image, holding the color of the point at the same index in \p xyz_image, or NULL for
+ * uncolored points.
  *
- * \param valid
- * The output parameter returns a value of 1 if the \p source_point2d is a valid coordinate, and will return 0 if
- * the coordinate is not valid in the calibration model.
+ * \param point_count
+ * Receives the number of points written.
  *
- * \returns
- * ::K4A_RESULT_SUCCEEDED if \p target_point3d_mm was successfully written. ::K4A_RESULT_FAILED if \p calibration
- * contained invalid transformation parameters. If the function returns ::K4A_RESULT_SUCCEEDED, but \p valid is 0,
- * the transformation was computed, but the results in \p target_point3d_mm are outside of the range of valid
- * calibration and should be ignored.
+ * \remarks
+ * The points of each device are those k4a_transformation_depth_image_to_formatted_point_cloud() computes with
+ * ::K4A_CALIBRATION_TYPE_DEPTH, moved into the common frame by the depth_to_common transform of the device. The
+ * images are read once, every device being split into the number of bands set with
+ * k4a_transformation_set_cpu_thread_count() on its handle and all bands running on the SDK thread pool.
  *
  * \remarks
- * This function applies the intrinsic calibration of \p source_camera to compute the 3D ray from the focal point of the
- * camera through pixel \p source_point2d. The 3D point on this ray is then found using \p source_depth_mm. If \p
- * target_camera is different from \p source_camera, the 3D point is transformed to \p target_camera using
- * k4a_calibration_3d_to_3d(). In practice, \p source_camera and \p target_camera will often be identical. In this
- * case, no 3D to 3D transformation is applied.
+ * The depth image of each device must be of format ::K4A_IMAGE_FORMAT_DEPTH16 with the resolution of the depth camera
+ * of its handle. With \p bgra_image, every device needs a ::K4A_IMAGE_FORMAT_COLOR_BGRA32 color image of the same
+ * resolution, such as k4a_transformation_color_image_to_depth_camera() writes, and \p bgra_image must be a
+ * ::K4A_IMAGE_FORMAT_COLOR_BGRA32 image of one row as wide as \p xyz_image.
  *
  * \remarks
- * If \p source_point2d is not considered as valid pixel coordinate
- * according to the intrinsic camera model, \p valid is set to 0. If it is valid, \p valid will be set to 1. The user
- * should not use the value of \p target_point3d_mm if \p valid was set to 0.
+ * The format of \p xyz_image must be ::K4A_IMAGE_FORMAT_CUSTOM. It is one row whose width is the total number of
+ * depth pixels of all devices, with a stride in bytes of the width times 12 for ::K4A_POINT_CLOUD_FORMAT_FLOAT32_XYZ or
+ * 16 for ::K4A_POINT_CLOUD_FORMAT_FLOAT32_XYZW. The points of the devices follow each other in the order of
+ * \p inputs, in pixel order.
  *
- * \relates k4a_calibration_t
+ * \remarks
+ * With \p valid_points_only the contents of \p xyz_image and \p bgra_image after the first \p point_count points are
+ * undefined.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if \p xyz_image, and \p bgra_image when given, were successfully written and
+ * ::K4A_RESULT_FAILED otherwise.
+ *
+ * \relates k4a_transformation_t
  *
  * \xmlonly
  * <requirements>
@@ -1806,53 +5497,40 @@ K4A_EXPORT k4a_result_t k4a_calibration_3d_to_3d(const k4a_calibration_t *calibr
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT k4a_result_t k4a_calibration_2d_to_3d(const k4a_calibration_t *calibration,
-                                                 const k4a_float2_t *source_point2d,
-                                                 const float source_depth_mm,
-                                                 const k4a_calibration_type_t source_camera,
-                                                 const k4a_calibration_type_t target_camera,
-                                                 k4a_float3_t *target_point3d_mm,
-                                                 int *valid);
+K4A_EXPORT k4a_result_t k4a_transformation_fuse_point_clouds(const k4a_point_cloud_fusion_input_t *inputs,
+                                                             uint32_t input_count,
+                                                             k4a_point_cloud_format_t format,
+                                                             bool valid_points_only,
+                                                             k4a_image_t xyz_image,
+                                                             k4a_image_t bgra_image,
+                                                             size_t *point_count);
 
-/** Transform a 3D point of a source coordinate system into a 2D pixel coordinate of the target camera.
- *
- * \param calibration
- * Location to read the camera calibration obtained by k4a_device_get_calibration().
- *
- * \param source_point3d_mm
- * The 3D coordinates in millimeters representing a point in \p source_camera
- *
- * \param source_camera
- * The current camera.
- *
- * \param target_camera
- * The target camera.
- *
- * \param target_point2d
- * Pointer to the output where the 2D pixel in \p target_camera coordinates is stored.
+/** Estimates the surface normal of every point of a point cloud.
  *
- * \param valid
- * The output parameter returns a value of 1 if the \p source_point3d_mm is a valid coordinate in the \p target_camera
- * coordinate system, and will return 0 if the coordinate is not valid in the calibration model.
+ * \param xyz_image
+ * Handle to input xyz image, as k4a_transformation_depth_image_to_point_cloud() writes it.
  *
- * \returns
- * ::K4A_RESULT_SUCCEEDED if \p target_point2d was successfully written. ::K4A_RESULT_FAILED if \p calibration
- * contained invalid transformation parameters. If the function returns ::K4A_RESULT_SUCCEEDED, but \p valid is 0,
- * the transformation was computed, but the results in \p target_point2d are outside of the range of valid calibration
- * and should be ignored.
+ * \param normal_image
+ * Handle to output normal image.
  *
  * \remarks
- * If \p target_camera is different from \p source_camera, \p source_point3d_mm is transformed to \p target_camera using
- * k4a_calibration_3d_to_3d(). In practice, \p source_camera and \p target_camera will often be identical. In this
- * case, no 3D to 3D transformation is applied. The 3D point in the coordinate system of \p target_camera is then
- * projected onto the image plane using the intrinsic calibration of \p target_camera.
+ * The point cloud is organized like the image it was computed from, so the normal of a point is the cross product of
+ * the differences between its left and right and between its top and bottom neighbors. Each normal is of unit length
+ * and faces the camera.
  *
  * \remarks
- * If \p source_point3d_mm does not map to a valid 2D coordinate in the \p target_camera coordinate system, \p valid is
- * set to 0. If it is valid, \p valid will be set to 1. The user should not use the value of \p target_point2d if \p
- * valid was set to 0.
+ * Points on the border of the image, points without depth and points with a neighbor that is without depth or across a
+ * depth edge get a normal of X, Y and Z 0.
  *
- * \relates k4a_calibration_t
+ * \remarks
+ * The format of \p normal_image must be ::K4A_IMAGE_FORMAT_CUSTOM, with the width and height of \p xyz_image and a
+ * stride in bytes of 12 times its width in pixels. Each pixel consists of the three float X, Y and Z components of the
+ * normal.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if \p normal_image was successfully written and ::K4A_RESULT_FAILED otherwise.
+ *
+ * \relates k4a_transformation_t
  *
  * \xmlonly
  * <requirements>
@@ -1862,60 +5540,46 @@ K4A_EXPORT k4a_result_t k4a_calibration_2d_to_3d(const k4a_calibration_t *calibr
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT k4a_result_t k4a_calibration_3d_to_2d(const k4a_calibration_t *calibration,
-                                                 const k4a_float3_t *source_point3d_mm,
-                                                 const k4a_calibration_type_t source_camera,
-                                                 const k4a_calibration_type_t target_camera,
-                                                 k4a_float2_t *target_point2d,
-                                                 int *valid);
+K4A_EXPORT k4a_result_t k4a_transformation_point_cloud_to_normals(const k4a_image_t xyz_image,
+                                                                  k4a_image_t normal_image);
 
-/** Transform a 2D pixel coordinate with an associated depth value of the source camera into a 2D pixel coordinate of
- * the target camera.
- *
- * \param calibration
- * Location to read the camera calibration obtained by k4a_device_get_calibration().
- *
- * \param source_point2d
- * The 2D pixel in \p source_camera coordinates.
+/** Downsamples a point cloud to one point per cube of a voxel grid.
  *
- * \param source_depth_mm
- * The depth of \p source_point2d in millimeters. One way to derive the depth value in the color camera geometry is to
- * use the function k4a_transformation_depth_image_to_color_camera().
+ * \param xyz_image
+ * Handle to input xyz image, as k4a_transformation_depth_image_to_point_cloud() writes it.
  *
- * \param source_camera
- * The current camera.
+ * \param normal_image
+ * Handle to input normal image, as k4a_transformation_point_cloud_to_normals() writes it for \p xyz_image, or NULL.
  *
- * \param target_camera
- * The target camera.
+ * \param voxel_size
+ * Edge length of the cubes of the grid in millimeters.
  *
- * \param target_point2d
- * The 2D pixel in \p target_camera coordinates.
+ * \param downsampled_xyz_image
+ * Handle to output xyz image.
  *
- * \param valid
- * The output parameter returns a value of 1 if the \p source_point2d is a valid coordinate in the \p target_camera
- * coordinate system, and will return 0 if the coordinate is not valid in the calibration model.
+ * \param downsampled_normal_image
+ * Handle to output normal image, or NULL without normals.
  *
- * \returns
- * ::K4A_RESULT_SUCCEEDED if \p target_point2d was successfully written. ::K4A_RESULT_FAILED if \p calibration
- * contained invalid transformation parameters. If the function returns ::K4A_RESULT_SUCCEEDED, but \p valid is 0,
- * the transformation was computed, but the results in \p target_point2d are outside of the range of valid calibration
- * and should be ignored.
+ * \param point_count
+ * Receives the number of points written.
  *
  * \remarks
- * This function maps a pixel between the coordinate systems of the depth and color cameras. It is equivalent to calling
- * k4a_calibration_2d_to_3d() to compute the 3D point corresponding to \p source_point2d and then using
- * k4a_calibration_3d_to_2d() to map the 3D point into the coordinate system of the \p target_camera.
+ * Every cube of the grid with points becomes the centroid of its points, and with normals the normalized sum of their
+ * normals. The grid is hashed, only the cubes with points take memory. The points are written in the order of the
+ * first pixel in each cube. Pixels without depth are skipped.
  *
  * \remarks
- * If \p source_camera and \p target_camera are identical, the function immediately sets \p target_point2d to \p
- * source_point2d and returns without computing any transformations.
+ * The format of \p downsampled_xyz_image and \p downsampled_normal_image must be ::K4A_IMAGE_FORMAT_CUSTOM. They are
+ * one row whose width is the number of pixels of \p xyz_image, with a stride in bytes of 12 times the width. Each
+ * pixel consists of three float values. Their contents after the first \p point_count points are undefined.
  *
  * \remarks
- * If \p source_point2d does not map to a valid 2D coordinate in the \p target_camera coordinate system, \p valid is set
- * to 0. If it is valid, \p valid will be set to 1. The user should not use the value of \p target_point2d if \p valid
- * was set to 0.
+ * \p normal_image and \p downsampled_normal_image are both given or both NULL.
  *
- * \relates k4a_calibration_t
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the downsampled images were successfully written and ::K4A_RESULT_FAILED otherwise.
+ *
+ * \relates k4a_transformation_t
  *
  * \xmlonly
  * <requirements>
@@ -1925,52 +5589,43 @@ K4A_EXPORT k4a_result_t k4a_calibration_3d_to_2d(const k4a_calibration_t *calibr
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT k4a_result_t k4a_calibration_2d_to_2d(const k4a_calibration_t *calibration,
-                                                 const k4a_float2_t *source_point2d,
-                                                 const float source_depth_mm,
-                                                 const k4a_calibration_type_t source_camera,
-                                                 const k4a_calibration_type_t target_camera,
-                                                 k4a_float2_t *target_point2d,
-                                                 int *valid);
+K4A_EXPORT k4a_result_t k4a_transformation_point_cloud_voxel_downsample(const k4a_image_t xyz_image,
+                                                                        const k4a_image_t normal_image,
+                                                                        float voxel_size,
+                                                                        k4a_image_t downsampled_xyz_image,
+                                                                        k4a_image_t downsampled_normal_image,
+                                                                        size_t *point_count);
 
-/** Transform a 2D pixel coordinate from color camera into a 2D pixel coordinate of
- * the depth camera.
+/** Creates a map that undistorts the images of a camera into a pinhole image.
  *
- * \param calibration
- * Location to read the camera calibration obtained by k4a_device_get_calibration().
- *
- * \param source_point2d
- * The 2D pixel in \p color camera coordinates.
+ * \param transformation_handle
+ * Transformation handle.
  *
- * \param depth_image
- * Handle to input depth image.
+ * \param camera
+ * Camera whose images the map undistorts.
  *
- * \param target_point2d
- * The 2D pixel in \p depth camera coordinates.
+ * \param pinhole
+ * Intrinsics and resolution of the undistorted image, or NULL for the intrinsics and resolution of \p camera with the
+ * lens distortion removed.
  *
- * \param valid
- * The output parameter returns a value of 1 if the \p source_point2d is a valid coordinate in the \p target_camera
- * coordinate system, and will return 0 if the coordinate is not valid in the calibration model.
+ * \param interpolation_type
+ * ::K4A_TRANSFORMATION_INTERPOLATION_TYPE_NEAREST to copy the nearest distorted pixel or
+ * ::K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR to blend the 4 distorted pixels around each undistorted pixel.
  *
- * \returns
- * ::K4A_RESULT_SUCCEEDED if \p target_point2d was successfully written. ::K4A_RESULT_FAILED if \p calibration
- * contained invalid transformation parameters. If the function returns ::K4A_RESULT_SUCCEEDED, but \p valid is 0,
- * the transformation was computed, but the results in \p target_point2d are outside of the range of valid calibration
- * and should be ignored.
+ * \param undistort_map_handle
+ * Output parameter which on success will return a handle to the map.
  *
  * \remarks
- * This function represents an alternative to k4a_calibration_2d_to_2d() if the number of pixels that need to be
- * transformed is small. This function searches along an epipolar line in the depth image to find the corresponding
- * depth pixel. If a larger number of pixels need to be transformed, it might be computationally cheaper to call
- * k4a_transformation_depth_image_to_color_camera() to get correspondence depth values for these color pixels, then call
- * the function k4a_calibration_2d_to_2d().
+ * The lens model is evaluated for every pixel of the undistorted image once, when the map is created, and
+ * k4a_transformation_undistort() only resamples the images.
  *
  * \remarks
- * If \p source_point2d does not map to a valid 2D coordinate in the \p target_camera coordinate system, \p valid is set
- * to 0. If it is valid, \p valid will be set to 1. The user should not use the value of \p target_point2d if \p valid
- * was set to 0.
+ * The map must be destroyed with k4a_undistort_map_destroy() when it is no longer to be used.
  *
- * \relates k4a_calibration_t
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the map was created and ::K4A_RESULT_FAILED otherwise.
+ *
+ * \relates k4a_undistort_map_t
  *
  * \xmlonly
  * <requirements>
@@ -1980,29 +5635,42 @@ K4A_EXPORT k4a_result_t k4a_calibration_2d_to_2d(const k4a_calibration_t *calibr
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT k4a_result_t k4a_calibration_color_2d_to_depth_2d(const k4a_calibration_t *calibration,
-                                                             const k4a_float2_t *source_point2d,
-                                                             const k4a_image_t depth_image,
-                                                             k4a_float2_t *target_point2d,
-                                                             int *valid);
+K4A_EXPORT k4a_result_t
+k4a_transformation_create_undistort_map(k4a_transformation_t transformation_handle,
+                                        const k4a_calibration_type_t camera,
+                                        const k4a_pinhole_t *pinhole,
+                                        k4a_transformation_interpolation_type_t interpolation_type,
+                                        k4a_undistort_map_t *undistort_map_handle);
 
-/** Get handle to transformation handle.
+/** Destroys an undistortion map.
  *
- * \param calibration
- * A calibration structure obtained by k4a_device_get_calibration().
+ * \param undistort_map_handle
+ * Undistortion map handle to destroy.
  *
- * \returns
- * A transformation handle. A NULL is returned if creation fails.
+ * \relates k4a_undistort_map_t
  *
- * \remarks
- * The transformation handle is used to transform images from the coordinate system of one camera into the other. Each
- * transformation handle requires some pre-computed resources to be allocated, which are retained until the handle is
- * destroyed.
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT void k4a_undistort_map_destroy(k4a_undistort_map_t undistort_map_handle);
+
+/** Gets the intrinsics and resolution of the images an undistortion map produces.
  *
- * \remarks
- * The transformation handle must be destroyed with k4a_transformation_destroy() when it is no longer to be used.
+ * \param undistort_map_handle
+ * Undistortion map handle.
  *
- * \relates k4a_calibration_t
+ * \param pinhole
+ * Receives the intrinsics and resolution of the undistorted images.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if \p pinhole was written and ::K4A_RESULT_FAILED otherwise.
+ *
+ * \relates k4a_undistort_map_t
  *
  * \xmlonly
  * <requirements>
@@ -2012,14 +5680,35 @@ K4A_EXPORT k4a_result_t k4a_calibration_color_2d_to_depth_2d(const k4a_calibrati
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT k4a_transformation_t k4a_transformation_create(const k4a_calibration_t *calibration);
+K4A_EXPORT k4a_result_t k4a_undistort_map_get_pinhole(k4a_undistort_map_t undistort_map_handle,
+                                                      k4a_pinhole_t *pinhole);
 
-/** Destroy transformation handle.
+/** Undistorts an image with an undistortion map.
  *
- * \param transformation_handle
- * Transformation handle to destroy.
+ * \param undistort_map_handle
+ * Undistortion map handle.
  *
- * \relates k4a_transformation_t
+ * \param image
+ * Handle to the input image of the camera the map was created for.
+ *
+ * \param undistorted_image
+ * Handle to the output undistorted image.
+ *
+ * \remarks
+ * \p image must be of format ::K4A_IMAGE_FORMAT_DEPTH16, ::K4A_IMAGE_FORMAT_IR16 or ::K4A_IMAGE_FORMAT_COLOR_BGRA32
+ * with the resolution of the camera. \p undistorted_image must be of the same format with the resolution of the
+ * pinhole of the map. Both must have a stride in bytes of the width in pixels times the pixel size.
+ *
+ * \remarks
+ * Pixels of \p undistorted_image without a corresponding pixel in \p image are set to 0. With
+ * ::K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR, undistorted depth next to missing depth or a depth discontinuity is
+ * also 0, so the edges of objects are not blended with the background. Pixels of a ::K4A_IMAGE_FORMAT_COLOR_BGRA32
+ * image that have a corresponding pixel but are (0,0,0,0) are set to (1,0,0,0).
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if \p undistorted_image was successfully written and ::K4A_RESULT_FAILED otherwise.
+ *
+ * \relates k4a_undistort_map_t
  *
  * \xmlonly
  * <requirements>
@@ -2029,9 +5718,11 @@ K4A_EXPORT k4a_transformation_t k4a_transformation_create(const k4a_calibration_
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT void k4a_transformation_destroy(k4a_transformation_t transformation_handle);
+K4A_EXPORT k4a_result_t k4a_transformation_undistort(k4a_undistort_map_t undistort_map_handle,
+                                                     const k4a_image_t image,
+                                                     k4a_image_t undistorted_image);
 
-/** Transforms the depth map into the geometry of the color camera.
+/** Asynchronously transforms the depth map into the geometry of the color camera.
  *
  * \param transformation_handle
  * Transformation handle.
@@ -2042,26 +5733,24 @@ K4A_EXPORT void k4a_transformation_destroy(k4a_transformation_t transformation_h
  * \param transformed_depth_image
  * Handle to output transformed depth image.
  *
- * \remarks
- * This produces a depth image for which each pixel matches the corresponding pixel coordinates of the color camera.
- *
- * \remarks
- * \p depth_image and \p transformed_depth_image must be of format ::K4A_IMAGE_FORMAT_DEPTH16.
+ * \param callback
+ * Called with the result of the transformation once it completes.
  *
- * \remarks
- * \p transformed_depth_image must have a width and height matching the width and height of the color camera in the mode
- * specified by the \ref k4a_calibration_t used to create the \p transformation_handle with k4a_transformation_create().
+ * \param callback_context
+ * Context passed to \p callback.
  *
  * \remarks
- * The contents \p transformed_depth_image will be filled with the depth values derived from \p depth_image in the color
- * camera's coordinate space.
+ * The transformation is queued to a thread owned by \p transformation_handle and this function returns without
+ * waiting for it, so the caller can prepare the next frame in the meantime. The SDK holds a reference to each image
+ * until \p callback returns. The caller must not modify the images until then.
  *
  * \remarks
- * \p transformed_depth_image should be created by the caller using k4a_image_create() or
- * k4a_image_create_from_buffer().
+ * Behaves like k4a_transformation_depth_image_to_color_camera(), with its result passed to \p callback.
+ * k4a_transformation_destroy() waits for the transformations queued on the handle.
  *
  * \returns
- * ::K4A_RESULT_SUCCEEDED if \p transformed_depth_image was successfully written and ::K4A_RESULT_FAILED otherwise.
+ * ::K4A_RESULT_SUCCEEDED if the transformation was queued, in which case \p callback is called exactly once, and
+ * ::K4A_RESULT_FAILED otherwise.
  *
  * \relates k4a_transformation_t
  *
@@ -2073,11 +5762,14 @@ K4A_EXPORT void k4a_transformation_destroy(k4a_transformation_t transformation_h
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT k4a_result_t k4a_transformation_depth_image_to_color_camera(k4a_transformation_t transformation_handle,
-                                                                       const k4a_image_t depth_image,
-                                                                       k4a_image_t transformed_depth_image);
+K4A_EXPORT k4a_result_t
+k4a_transformation_depth_image_to_color_camera_async(k4a_transformation_t transformation_handle,
+                                                     const k4a_image_t depth_image,
+                                                     k4a_image_t transformed_depth_image,
+                                                     k4a_transformation_complete_cb_t *callback,
+                                                     void *callback_context);
 
-/** Transforms depth map and a custom image into the geometry of the color camera.
+/** Asynchronously transforms depth map and a custom image into the geometry of the color camera.
  *
  * \param transformation_handle
  * Transformation handle.
@@ -2096,51 +5788,28 @@ K4A_EXPORT k4a_result_t k4a_transformation_depth_image_to_color_camera(k4a_trans
  *
  * \param interpolation_type
  * Parameter that controls how pixels in \p custom_image should be interpolated when transformed to color camera space.
- * K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR if linear interpolation should be used.
- * K4A_TRANSFORMATION_INTERPOLATION_TYPE_NEAREST if nearest neighbor interpolation should be used.
  *
  * \param invalid_custom_value
  * Defines the custom image pixel value that should be written to \p transformed_custom_image in case the corresponding
  * depth pixel can not be transformed into the color camera space.
  *
- * \remarks
- * This produces a depth image and a corresponding custom image for which each pixel matches the corresponding
- * pixel coordinates of the color camera.
- *
- * \remarks
- * \p depth_image and \p transformed_depth_image must be of format ::K4A_IMAGE_FORMAT_DEPTH16.
- *
- * \remarks
- * \p custom_image and \p transformed_custom_image must be of format ::K4A_IMAGE_FORMAT_CUSTOM8 or
- * ::K4A_IMAGE_FORMAT_CUSTOM16.
- *
- * \remarks
- * \p transformed_depth_image and \p transformed_custom_image must have a width and height matching the width and
- * height of the color camera in the mode specified by the \ref k4a_calibration_t used to create the
- * \p transformation_handle with k4a_transformation_create().
- *
- * \remarks
- * \p custom_image must have a width and height matching the width and height of \p depth_image.
- *
- * \remarks
- * The contents \p transformed_depth_image will be filled with the depth values derived from \p depth_image in the color
- * camera's coordinate space.
+ * \param callback
+ * Called with the result of the transformation once it completes.
  *
- * \remarks
- * The contents \p transformed_custom_image will be filled with the values derived from \p custom_image in the color
- * camera's coordinate space.
+ * \param callback_context
+ * Context passed to \p callback.
  *
  * \remarks
- * \p transformed_depth_image and \p transformed_custom_image should be created by the caller using k4a_image_create()
- * or k4a_image_create_from_buffer().
+ * The transformation is queued to a thread owned by \p transformation_handle and this function returns without
+ * waiting for it, so the caller can prepare the next frame in the meantime. The SDK holds a reference to each image
+ * until \p callback returns. The caller must not modify the images until then.
  *
  * \remarks
- * Using ::K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR for \p interpolation_type could create new values to \p
- * transformed_custom_image which do no exist in \p custom_image. Using ::K4A_TRANSFORMATION_INTERPOLATION_TYPE_NEAREST
- * will prevent this from happenning but will result in a less smooth image.
+ * Behaves like k4a_transformation_depth_image_to_color_camera_custom(), with its result passed to \p callback.
+ * k4a_transformation_destroy() waits for the transformations queued on the handle.
  *
  * \returns
- * ::K4A_RESULT_SUCCEEDED if \p transformed_depth_image and \p transformed_custom_image were successfully written and
+ * ::K4A_RESULT_SUCCEEDED if the transformation was queued, in which case \p callback is called exactly once, and
  * ::K4A_RESULT_FAILED otherwise.
  *
  * \relates k4a_transformation_t
@@ -2154,15 +5823,17 @@ K4A_EXPORT k4a_result_t k4a_transformation_depth_image_to_color_camera(k4a_trans
  * \endxmlonly
  */
 K4A_EXPORT k4a_result_t
-k4a_transformation_depth_image_to_color_camera_custom(k4a_transformation_t transformation_handle,
-                                                      const k4a_image_t depth_image,
-                                                      const k4a_image_t custom_image,
-                                                      k4a_image_t transformed_depth_image,
-                                                      k4a_image_t transformed_custom_image,
-                                                      k4a_transformation_interpolation_type_t interpolation_type,
-                                                      uint32_t invalid_custom_value);
+k4a_transformation_depth_image_to_color_camera_custom_async(k4a_transformation_t transformation_handle,
+                                                            const k4a_image_t depth_image,
+                                                            const k4a_image_t custom_image,
+                                                            k4a_image_t transformed_depth_image,
+                                                            k4a_image_t transformed_custom_image,
+                                                            k4a_transformation_interpolation_type_t interpolation_type,
+                                                            uint32_t invalid_custom_value,
+                                                            k4a_transformation_complete_cb_t *callback,
+                                                            void *callback_context);
 
-/** Transforms a color image into the geometry of the depth camera.
+/** Asynchronously transforms a color image into the geometry of the depth camera.
  *
  * \param transformation_handle
  * Transformation handle.
@@ -2176,28 +5847,24 @@ k4a_transformation_depth_image_to_color_camera_custom(k4a_transformation_t trans
  * \param transformed_color_image
  * Handle to output transformed color image.
  *
- * \remarks
- * This produces a color image for which each pixel matches the corresponding pixel coordinates of the depth camera.
- *
- * \remarks
- * \p depth_image and \p color_image need to represent the same moment in time. The depth data will be applied to the
- * color image to properly warp the color data to the perspective of the depth camera.
+ * \param callback
+ * Called with the result of the transformation once it completes.
  *
- * \remarks
- * \p depth_image must be of type ::K4A_IMAGE_FORMAT_DEPTH16. \p color_image must be of format
- * ::K4A_IMAGE_FORMAT_COLOR_BGRA32.
+ * \param callback_context
+ * Context passed to \p callback.
  *
  * \remarks
- * \p transformed_color_image image must be of format ::K4A_IMAGE_FORMAT_COLOR_BGRA32. \p transformed_color_image must
- * have the width and height of the depth camera in the mode specified by the \ref k4a_calibration_t used to create
- * the \p transformation_handle with k4a_transformation_create().
+ * The transformation is queued to a thread owned by \p transformation_handle and this function returns without
+ * waiting for it, so the caller can prepare the next frame in the meantime. The SDK holds a reference to each image
+ * until \p callback returns. The caller must not modify the images until then.
  *
  * \remarks
- * \p transformed_color_image should be created by the caller using k4a_image_create() or
- * k4a_image_create_from_buffer().
+ * Behaves like k4a_transformation_color_image_to_depth_camera(), with its result passed to \p callback.
+ * k4a_transformation_destroy() waits for the transformations queued on the handle.
  *
  * \returns
- * ::K4A_RESULT_SUCCEEDED if \p transformed_color_image was successfully written and ::K4A_RESULT_FAILED otherwise.
+ * ::K4A_RESULT_SUCCEEDED if the transformation was queued, in which case \p callback is called exactly once, and
+ * ::K4A_RESULT_FAILED otherwise.
  *
  * \relates k4a_transformation_t
  *
@@ -2209,13 +5876,15 @@ k4a_transformation_depth_image_to_color_camera_custom(k4a_transformation_t trans
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT k4a_result_t k4a_transformation_color_image_to_depth_camera(k4a_transformation_t transformation_handle,
-                                                                       const k4a_image_t depth_image,
-                                                                       const k4a_image_t color_image,
-                                                                       k4a_image_t transformed_color_image);
+K4A_EXPORT k4a_result_t
+k4a_transformation_color_image_to_depth_camera_async(k4a_transformation_t transformation_handle,
+                                                     const k4a_image_t depth_image,
+                                                     const k4a_image_t color_image,
+                                                     k4a_image_t transformed_color_image,
+                                                     k4a_transformation_complete_cb_t *callback,
+                                                     void *callback_context);
 
-/** Transforms the depth image into a single image with voxels representing
- * X, Y and Z-coordinates in millimeters of corresponding 3D points.
+/** Asynchronously transforms the depth image into 3 planar images representing X, Y and Z-coordinates.
  *
  * \param transformation_handle
  * Transformation handle.
@@ -2229,28 +5898,24 @@ K4A_EXPORT k4a_result_t k4a_transformation_color_image_to_depth_camera(k4a_trans
  * \param xyz_image
  * Handle to output xyz image.
  *
- * \remarks
- * \p depth_image must be of format ::K4A_IMAGE_FORMAT_DEPTH16.
- *
- * \remarks
- * The \p camera parameter tells the function what the perspective of the \p depth_image is. If the \p depth_image was
- * captured directly from the depth camera, the value should be ::K4A_CALIBRATION_TYPE_DEPTH. If the \p depth_image is
- * the result of a transformation into the color camera's coordinate space using
- * k4a_transformation_depth_image_to_color_camera(), the value should be ::K4A_CALIBRATION_TYPE_COLOR.
+ * \param callback
+ * Called with the result of the transformation once it completes.
  *
- * \remarks
- * The format of \p xyz_image must be ::K4A_IMAGE_FORMAT_CUSTOM. The width and height of \p xyz_image must match the
- * width and height of \p depth_image. \p xyz_image must have a stride in bytes of at least 6 times its width in pixels.
+ * \param callback_context
+ * Context passed to \p callback.
  *
  * \remarks
- * Each pixel of the \p xyz_image consists of three int16_t values, totaling 6 bytes. The three int16_t values are the
- * X, Y, and Z values of the point.
+ * The transformation is queued to a thread owned by \p transformation_handle and this function returns without
+ * waiting for it, so the caller can prepare the next frame in the meantime. The SDK holds a reference to each image
+ * until \p callback returns. The caller must not modify the images until then.
  *
  * \remarks
- * \p xyz_image should be created by the caller using k4a_image_create() or k4a_image_create_from_buffer().
+ * Behaves like k4a_transformation_depth_image_to_point_cloud(), with its result passed to \p callback.
+ * k4a_transformation_destroy() waits for the transformations queued on the handle.
  *
  * \returns
- * ::K4A_RESULT_SUCCEEDED if \p xyz_image was successfully written and ::K4A_RESULT_FAILED otherwise.
+ * ::K4A_RESULT_SUCCEEDED if the transformation was queued, in which case \p callback is called exactly once, and
+ * ::K4A_RESULT_FAILED otherwise.
  *
  * \relates k4a_transformation_t
  *
@@ -2262,10 +5927,13 @@ K4A_EXPORT k4a_result_t k4a_transformation_color_image_to_depth_camera(k4a_trans
  * </requirements>
  * \endxmlonly
  */
-K4A_EXPORT k4a_result_t k4a_transformation_depth_image_to_point_cloud(k4a_transformation_t transformation_handle,
-                                                                      const k4a_image_t depth_image,
-                                                                      const k4a_calibration_type_t camera,
-                                                                      k4a_image_t xyz_image);
+K4A_EXPORT k4a_result_t
+k4a_transformation_depth_image_to_point_cloud_async(k4a_transformation_t transformation_handle,
+                                                    const k4a_image_t depth_image,
+                                                    const k4a_calibration_type_t camera,
+                                                    k4a_image_t xyz_image,
+                                                    k4a_transformation_complete_cb_t *callback,
+                                                    void *callback_context);
 
 /**
  * @}
@@ -227,6 +227,24 @@ public:
         return image(handle);
     }
 
+    /** Create a blank image with an aligned buffer
+     * Throws error on failure
+     *
+     * \sa k4a_image_create_aligned
+     */
+    static image
+    create_aligned(k4a_image_format_t format, int width_pixels, int height_pixels, int stride_bytes, size_t alignment)
+    {
+        k4a_image_t handle = nullptr;
+        k4a_result_t result =
+            k4a_image_create_aligned(format, width_pixels, height_pixels, stride_bytes, alignment, &handle);
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to create aligned image!");
+        }
+        return image(handle);
+    }
+
     /** Create an image from a pre-allocated buffer
      * Throws error on failure
      *
@@ -258,6 +276,22 @@ public:
         return image(handle);
     }
 
+    /** Create a view of a rectangle of this image that shares its buffer
+     * Throws error on failure
+     *
+     * \sa k4a_image_create_view
+     */
+    image create_view(int x, int y, int width_pixels, int height_pixels) const
+    {
+        k4a_image_t handle = nullptr;
+        k4a_result_t result = k4a_image_create_view(m_handle, x, y, width_pixels, height_pixels, &handle);
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to create image view!");
+        }
+        return image(handle);
+    }
+
     /** Get the image buffer
      *
      * \sa k4a_image_get_buffer
@@ -339,6 +373,15 @@ public:
         return std::chrono::nanoseconds(k4a_image_get_system_timestamp_nsec(m_handle));
     }
 
+    /** Get the host time at which the image passed a stage of the streaming pipeline in nanoseconds
+     *
+     * \sa k4a_image_get_stage_timestamp_nsec
+     */
+    std::chrono::nanoseconds get_stage_timestamp(k4a_image_stage_t stage) const noexcept
+    {
+        return std::chrono::nanoseconds(k4a_image_get_stage_timestamp_nsec(m_handle, stage));
+    }
+
     /** Get the image exposure time in microseconds
      *
      * \sa k4a_image_get_exposure_usec
@@ -366,6 +409,40 @@ public:
         return k4a_image_get_iso_speed(m_handle);
     }
 
+    /** Get all of the image's metadata in one call
+     *
+     * Throws error on failure
+     *
+     * \sa k4a_image_get_info
+     */
+    k4a_image_info_t get_info() const
+    {
+        k4a_image_info_t info;
+        k4a_result_t result = k4a_image_get_info(m_handle, &info);
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to get image info!");
+        }
+        return info;
+    }
+
+    /** Get the image's buffer and layout in one call
+     *
+     * Throws error on failure
+     *
+     * \sa k4a_image_get_view
+     */
+    k4a_image_view_t get_view() const
+    {
+        k4a_image_view_t view;
+        k4a_result_t result = k4a_image_get_view(m_handle, K4A_VIEW_VERSION, &view);
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to get image view!");
+        }
+        return view;
+    }
+
     /** Set the image's timestamp in microseconds
      *
      * \sa k4a_image_set_device_timestamp_usec
@@ -402,10 +479,179 @@ public:
         k4a_image_set_iso_speed(m_handle, iso_speed);
     }
 
+    /** Convert this NV12, YUY2 or BGRA32 color image to bgra_image, a BGRA32 image of the same size
+     * Throws error on failure
+     *
+     * \sa k4a_image_convert_to_bgra32
+     */
+    void convert_to_bgra32(image &bgra_image) const
+    {
+        k4a_result_t result = k4a_image_convert_to_bgra32(m_handle, bgra_image.handle());
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to convert image to BGRA32!");
+        }
+    }
+
+    /** Convert this BGRA32 image to output_image, an NV12 or YUY2 image of the same size
+     * Throws error on failure
+     *
+     * \sa k4a_image_convert_from_bgra32
+     */
+    void convert_from_bgra32(image &output_image) const
+    {
+        k4a_result_t result = k4a_image_convert_from_bgra32(m_handle, output_image.handle());
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to convert image from BGRA32!");
+        }
+    }
+
+    /** Write the luminance of this NV12, YUY2 or BGRA32 image to custom8_image, a CUSTOM8 image of the same size
+     * Throws error on failure
+     *
+     * \sa k4a_image_convert_to_grayscale
+     */
+    void convert_to_grayscale(image &custom8_image) const
+    {
+        k4a_result_t result = k4a_image_convert_to_grayscale(m_handle, custom8_image.handle());
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to convert image to grayscale!");
+        }
+    }
+
+    /** Convert this 16 bit image to float_image, a CUSTOM image of floats of the same size
+     * Throws error on failure
+     *
+     * \sa k4a_image_convert_to_float
+     */
+    void convert_to_float(float scale, image &float_image) const
+    {
+        k4a_result_t result = k4a_image_convert_to_float(m_handle, scale, float_image.handle());
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to convert image to float!");
+        }
+    }
+
+    /** Normalize a range of this 16 bit image to custom8_image, a CUSTOM8 image of the same size
+     * Throws error on failure
+     *
+     * \sa k4a_image_convert_to_custom8
+     */
+    void convert_to_custom8(uint16_t min_value, uint16_t max_value, image &custom8_image) const
+    {
+        k4a_result_t result = k4a_image_convert_to_custom8(m_handle, min_value, max_value, custom8_image.handle());
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to convert image to CUSTOM8!");
+        }
+    }
+
+    /** Color a range of this 16 bit image into bgra_image, a BGRA32 image of the same size
+     * Throws error on failure
+     *
+     * \sa k4a_image_colorize
+     */
+    void colorize(uint16_t min_value, uint16_t max_value, k4a_colormap_t colormap, image &bgra_image) const
+    {
+        k4a_result_t result = k4a_image_colorize(m_handle, min_value, max_value, colormap, bgra_image.handle());
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to colorize image!");
+        }
+    }
+
 private:
     k4a_image_t m_handle;
 };
 
+/** \class image_pool k4a.hpp <k4a/k4a.hpp>
+ * Recycles images of the same format and size
+ *
+ * Holds images that the application has finished with so that later calls to acquire() can hand them out again
+ * instead of allocating a new image. A pool is not thread safe.
+ *
+ * \sa image::create
+ */
+class image_pool
+{
+public:
+    /** Creates a pool that holds at most \p max_images images for reuse
+     */
+    explicit image_pool(size_t max_images = 4) : m_max_images(max_images)
+    {
+        m_images.reserve(max_images);
+    }
+
+    image_pool(image_pool &&) = default;
+    image_pool &operator=(image_pool &&) = default;
+    image_pool(const image_pool &) = delete;
+    image_pool &operator=(const image_pool &) = delete;
+
+    /** Returns an image of the given format and size, reusing a recycled image if one matches
+     * Throws error on failure
+     *
+     * The contents, timestamps and metadata of a reused image are those it had when it was recycled.
+     *
+     * \sa image::create
+     */
+    image acquire(k4a_image_format_t format, int width_pixels, int height_pixels, int stride_bytes)
+    {
+        for (auto it = m_images.begin(); it != m_images.end(); ++it)
+        {
+            if (it->get_format() == format && it->get_width_pixels() == width_pixels &&
+                it->get_height_pixels() == height_pixels && it->get_stride_bytes() == stride_bytes)
+            {
+                image reused = std::move(*it);
+                m_images.erase(it);
+                return reused;
+            }
+        }
+
+        return image::create(format, width_pixels, height_pixels, stride_bytes);
+    }
+
+    /** Returns an image to the pool so a later acquire() can reuse it
+     *
+     * The caller must not hold other copies of \p img, since they would share the buffer with the next user.
+     * If the pool is full the oldest recycled image is released instead.
+     */
+    void recycle(image &&img)
+    {
+        if (!img || m_max_images == 0)
+        {
+            img.reset();
+            return;
+        }
+
+        if (m_images.size() >= m_max_images)
+        {
+            m_images.erase(m_images.begin());
+        }
+        m_images.push_back(std::move(img));
+    }
+
+    /** Releases every image held by the pool
+     */
+    void clear() noexcept
+    {
+        m_images.clear();
+    }
+
+    /** Returns the number of images held for reuse
+     */
+    size_t size() const noexcept
+    {
+        return m_images.size();
+    }
+
+private:
+    size_t m_max_images;
+    std::vector<image> m_images;
+};
+
 /** \class capture k4a.hpp <k4a/k4a.hpp>
  * Wrapper for \ref k4a_capture_t
  *
@@ -572,6 +818,15 @@ public:
         return image(k4a_capture_get_ir_image(m_handle));
     }
 
+    /** Get the image of IMU samples attached to the capture
+     *
+     * \sa k4a_capture_get_imu_samples_image
+     */
+    image get_imu_samples_image() const noexcept
+    {
+        return image(k4a_capture_get_imu_samples_image(m_handle));
+    }
+
     /** Set / add a color image to the capture
      *
      * \sa k4a_capture_set_color_image
@@ -599,6 +854,15 @@ public:
         k4a_capture_set_ir_image(m_handle, ir_image.handle());
     }
 
+    /** Set / add an image of IMU samples to the capture
+     *
+     * \sa k4a_capture_set_imu_samples_image
+     */
+    void set_imu_samples_image(const image &imu_samples_image) noexcept
+    {
+        k4a_capture_set_imu_samples_image(m_handle, imu_samples_image.handle());
+    }
+
     /** Set the temperature associated with the capture in Celsius.
      *
      * \sa k4a_capture_set_temperature_c
@@ -617,8 +881,25 @@ public:
         return k4a_capture_get_temperature_c(m_handle);
     }
 
+    /** Get the buffers and layouts of the color, depth and IR images in one call
+     *
+     * Throws error on failure
+     *
+     * \sa k4a_capture_get_view
+     */
+    k4a_capture_view_t get_view() const
+    {
+        k4a_capture_view_t view;
+        k4a_result_t result = k4a_capture_get_view(m_handle, K4A_VIEW_VERSION, &view);
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to get capture view!");
+        }
+        return view;
+    }
+
     /** Create an empty capture object.
-     * Throws error on failure.
+     * Throws error on failure
      *
      * \sa k4a_capture_create
      */
@@ -645,7 +926,7 @@ private:
 struct calibration : public k4a_calibration_t
 {
     /** Transform a 3d point of a source coordinate system into a 3d point of the target coordinate system.
-     * Throws error on failure.
+     * Throws error on failure
      *
      * \sa k4a_calibration_3d_to_3d
      */
@@ -759,8 +1040,102 @@ struct calibration : public k4a_calibration_t
         return static_cast<bool>(valid);
     }
 
+    /** Transform point_count 2d pixel coordinates with associated depth values of the source camera into 3d points of
+     * the target coordinate system.
+     * Each entry of valid is set to 0 if its point is invalid in the target coordinate system (and therefore its
+     * target_point3d should not be used)
+     * Throws error if calibration contains invalid data.
+     *
+     * \sa k4a_calibration_2d_to_3d_batch
+     */
+    void convert_2d_to_3d_batch(const k4a_float2_t *source_point2d,
+                                const float *source_depth,
+                                size_t point_count,
+                                k4a_calibration_type_t source_camera,
+                                k4a_calibration_type_t target_camera,
+                                k4a_float3_t *target_point3d,
+                                int *valid) const
+    {
+        k4a_result_t result = k4a_calibration_2d_to_3d_batch(
+            this, source_point2d, source_depth, point_count, source_camera, target_camera, target_point3d, valid);
+
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Calibration contained invalid transformation parameters!");
+        }
+    }
+
+    /** Transform point_count 3d points of a source coordinate system into 2d pixel coordinates of the target camera.
+     * Each entry of valid is set to 0 if its point is invalid in the target coordinate system (and therefore its
+     * target_point2d should not be used)
+     * Throws error if calibration contains invalid data.
+     *
+     * \sa k4a_calibration_3d_to_2d_batch
+     */
+    void convert_3d_to_2d_batch(const k4a_float3_t *source_point3d,
+                                size_t point_count,
+                                k4a_calibration_type_t source_camera,
+                                k4a_calibration_type_t target_camera,
+                                k4a_float2_t *target_point2d,
+                                int *valid) const
+    {
+        k4a_result_t result = k4a_calibration_3d_to_2d_batch(
+            this, source_point3d, point_count, source_camera, target_camera, target_point2d, valid);
+
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Calibration contained invalid transformation parameters!");
+        }
+    }
+
+    /** Transform point_count 2d pixel coordinates with associated depth values of the source camera into 2d pixel
+     * coordinates of the target camera
+     * Each entry of valid is set to 0 if its point is invalid in the target coordinate system (and therefore its
+     * target_point2d should not be used)
+     * Throws error if calibration contains invalid data.
+     *
+     * \sa k4a_calibration_2d_to_2d_batch
+     */
+    void convert_2d_to_2d_batch(const k4a_float2_t *source_point2d,
+                                const float *source_depth,
+                                size_t point_count,
+                                k4a_calibration_type_t source_camera,
+                                k4a_calibration_type_t target_camera,
+                                k4a_float2_t *target_point2d,
+                                int *valid) const
+    {
+        k4a_result_t result = k4a_calibration_2d_to_2d_batch(
+            this, source_point2d, source_depth, point_count, source_camera, target_camera, target_point2d, valid);
+
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Calibration contained invalid transformation parameters!");
+        }
+    }
+
+    /** Transform point_count 2D pixel coordinates from color camera into 2D pixel coordinates of the depth camera.
+     * Each entry of valid is set to 0 if its point is invalid in the target coordinate system (and therefore its
+     * target_point2d should not be used) Throws error if calibration contains invalid data.
+     *
+     * \sa k4a_calibration_color_2d_to_depth_2d_batch
+     */
+    void convert_color_2d_to_depth_2d_batch(const k4a_float2_t *source_point2d,
+                                            size_t point_count,
+                                            const image &depth_image,
+                                            k4a_float2_t *target_point2d,
+                                            int *valid) const
+    {
+        k4a_result_t result = k4a_calibration_color_2d_to_depth_2d_batch(
+            this, source_point2d, point_count, depth_image.handle(), target_point2d, valid);
+
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Calibration contained invalid transformation parameters!");
+        }
+    }
+
     /** Get the camera calibration for a device from a raw calibration blob.
-     * Throws error on failure.
+     * Throws error on failure
      *
      * \sa k4a_calibration_get_from_raw
      */
@@ -784,7 +1159,7 @@ struct calibration : public k4a_calibration_t
     }
 
     /** Get the camera calibration for a device from a raw calibration blob.
-     * Throws error on failure.
+     * Throws error on failure
      *
      * \sa k4a_calibration_get_from_raw
      */
@@ -800,7 +1175,7 @@ struct calibration : public k4a_calibration_t
     }
 
     /** Get the camera calibration for a device from a raw calibration blob.
-     * Throws error on failure.
+     * Throws error on failure
      *
      * \sa k4a_calibration_get_from_raw
      */
@@ -815,88 +1190,361 @@ struct calibration : public k4a_calibration_t
     }
 };
 
-/** \class transformation k4a.hpp <k4a/k4a.hpp>
- * Wrapper for \ref k4a_transformation_t
+/** \class undistort_map k4a.hpp <k4a/k4a.hpp>
+ * Wrapper for \ref k4a_undistort_map_t
  *
- * Wraps a handle for a transformation.
+ * Wraps a handle for an undistortion map. Created with transformation::create_undistort_map().
  */
-class transformation
+class undistort_map
 {
 public:
-    /** Creates a transformation associated with calibration
-     *
-     * \sa k4a_transformation_create
-     */
-    transformation(const k4a_calibration_t &calibration) noexcept :
-        m_handle(k4a_transformation_create(&calibration)),
-        m_color_resolution({ calibration.color_camera_calibration.resolution_width,
-                             calibration.color_camera_calibration.resolution_height }),
-        m_depth_resolution({ calibration.depth_camera_calibration.resolution_width,
-                             calibration.depth_camera_calibration.resolution_height })
-    {
-    }
-
-    /** Creates a transformation from a k4a_transformation_t
+    /** Creates an undistort_map from a k4a_undistort_map_t
      * Takes ownership of the handle, i.e. you should not call
-     * k4a_transformation_destroy on the handle after giving
-     * it to the transformation; the transformation will take care of that.
+     * k4a_undistort_map_destroy on the handle after giving
+     * it to the undistort_map; the undistort_map will take care of that.
      */
-    transformation(k4a_transformation_t handle = nullptr) noexcept : m_handle(handle) {}
+    undistort_map(k4a_undistort_map_t handle = nullptr) noexcept : m_handle(handle) {}
 
-    /** Moves another tranformation into a new transformation
+    /** Moves another undistort_map into a new undistort_map
      */
-    transformation(transformation &&other) noexcept :
-        m_handle(other.m_handle),
-        m_color_resolution(other.m_color_resolution),
-        m_depth_resolution(other.m_depth_resolution)
+    undistort_map(undistort_map &&other) noexcept : m_handle(other.m_handle)
     {
         other.m_handle = nullptr;
     }
 
-    transformation(const transformation &) = delete;
+    undistort_map(const undistort_map &) = delete;
 
-    ~transformation()
+    ~undistort_map()
     {
         destroy();
     }
 
-    /** Moves another image into this image; other is set to invalid
+    /** Moves another undistort_map into this undistort_map; other is set to invalid
      */
-    transformation &operator=(transformation &&other) noexcept
+    undistort_map &operator=(undistort_map &&other) noexcept
     {
         if (this != &other)
         {
             destroy();
             m_handle = other.m_handle;
-            m_color_resolution = other.m_color_resolution;
-            m_depth_resolution = other.m_depth_resolution;
             other.m_handle = nullptr;
         }
 
         return *this;
     }
 
-    /** Invalidates this transformation
+    /** Invalidates this undistort_map
      */
-    transformation &operator=(std::nullptr_t) noexcept
+    undistort_map &operator=(std::nullptr_t) noexcept
     {
         destroy();
         return *this;
     }
 
-    transformation &operator=(const transformation &) = delete;
+    undistort_map &operator=(const undistort_map &) = delete;
 
-    /** Invalidates this transformation
+    /** Returns true if the undistort_map is valid, false otherwise
+     */
+    explicit operator bool() const noexcept
+    {
+        return m_handle != nullptr;
+    }
+
+    /** Invalidates this undistort_map
      */
     void destroy() noexcept
     {
         if (m_handle != nullptr)
         {
-            k4a_transformation_destroy(m_handle);
+            k4a_undistort_map_destroy(m_handle);
             m_handle = nullptr;
         }
     }
 
+    /** Gets the intrinsics and resolution of the undistorted images
+     * Throws error on failure
+     *
+     * \sa k4a_undistort_map_get_pinhole
+     */
+    k4a_pinhole_t get_pinhole() const
+    {
+        k4a_pinhole_t pinhole;
+        k4a_result_t result = k4a_undistort_map_get_pinhole(m_handle, &pinhole);
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to get the undistort map pinhole!");
+        }
+        return pinhole;
+    }
+
+    /** Undistorts an image
+     * Throws error on failure
+     *
+     * \sa k4a_transformation_undistort
+     * Undistorts the image in to the existing caller provided \p undistorted_image.
+     */
+    void undistort(const image &distorted_image, image *undistorted_image) const
+    {
+        k4a_result_t result = k4a_transformation_undistort(m_handle,
+                                                           distorted_image.handle(),
+                                                           undistorted_image->handle());
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to undistort image!");
+        }
+    }
+
+    /** Undistorts an image
+     * Throws error on failure
+     *
+     * \sa k4a_transformation_undistort
+     */
+    image undistort(const image &distorted_image) const
+    {
+        k4a_pinhole_t pinhole = get_pinhole();
+        k4a_image_format_t format = distorted_image.get_format();
+        int32_t pixel_size = format == K4A_IMAGE_FORMAT_COLOR_BGRA32 ? 4 * static_cast<int32_t>(sizeof(uint8_t)) :
+                                                                       static_cast<int32_t>(sizeof(uint16_t));
+        image undistorted_image = image::create(format,
+                                                pinhole.width,
+                                                pinhole.height,
+                                                pinhole.width * pixel_size);
+        undistort(distorted_image, &undistorted_image);
+        return undistorted_image;
+    }
+
+private:
+    k4a_undistort_map_t m_handle;
+};
+
+/** \class buffer_ring k4a.hpp <k4a/k4a.hpp>
+ * Wrapper for \ref k4a_buffer_ring_t
+ *
+ * Wraps a handle for a ring of buffers provided by the application. Created with buffer_ring::create().
+ */
+class buffer_ring
+{
+public:
+    /** Creates a buffer_ring from a k4a_buffer_ring_t
+     * Takes ownership of the handle, i.e. you should not call
+     * k4a_buffer_ring_destroy on the handle after giving
+     * it to the buffer_ring; the buffer_ring will take care of that.
+     */
+    buffer_ring(k4a_buffer_ring_t handle = nullptr) noexcept : m_handle(handle) {}
+
+    /** Moves another buffer_ring into a new buffer_ring
+     */
+    buffer_ring(buffer_ring &&other) noexcept : m_handle(other.m_handle)
+    {
+        other.m_handle = nullptr;
+    }
+
+    buffer_ring(const buffer_ring &) = delete;
+
+    ~buffer_ring()
+    {
+        destroy();
+    }
+
+    /** Moves another buffer_ring into this buffer_ring; other is set to invalid
+     */
+    buffer_ring &operator=(buffer_ring &&other) noexcept
+    {
+        if (this != &other)
+        {
+            destroy();
+            m_handle = other.m_handle;
+            other.m_handle = nullptr;
+        }
+
+        return *this;
+    }
+
+    buffer_ring &operator=(const buffer_ring &) = delete;
+
+    /** Returns true if the buffer_ring is valid, false otherwise
+     */
+    explicit operator bool() const noexcept
+    {
+        return m_handle != nullptr;
+    }
+
+    /** Returns the underlying k4a_buffer_ring_t handle
+     */
+    k4a_buffer_ring_t handle() const noexcept
+    {
+        return m_handle;
+    }
+
+    /** Invalidates this buffer_ring
+     */
+    void destroy() noexcept
+    {
+        if (m_handle != nullptr)
+        {
+            k4a_buffer_ring_destroy(m_handle);
+            m_handle = nullptr;
+        }
+    }
+
+    /** Creates a buffer ring over memory provided by the application
+     * Throws error on failure
+     *
+     * \sa k4a_buffer_ring_create
+     */
+    static buffer_ring create(uint8_t *buffer, size_t slot_size, uint32_t slot_count)
+    {
+        k4a_buffer_ring_t handle = nullptr;
+        k4a_result_t result = k4a_buffer_ring_create(buffer, slot_size, slot_count, &handle);
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to create buffer ring!");
+        }
+        return buffer_ring(handle);
+    }
+
+    /** Finds the slot an image is in. Returns false if the image isn't in the ring.
+     *
+     * \sa k4a_buffer_ring_get_slot
+     */
+    bool get_slot(const image &img, uint32_t *slot_index, size_t *buffer_offset = nullptr) const noexcept
+    {
+        return K4A_RESULT_SUCCEEDED == k4a_buffer_ring_get_slot(m_handle, img.handle(), slot_index, buffer_offset);
+    }
+
+    /** Creates an image in a free slot of the ring
+     * Throws error on failure
+     *
+     * \sa k4a_buffer_ring_create_image
+     */
+    image create_image(k4a_image_format_t format, int width_pixels, int height_pixels, int stride_bytes) const
+    {
+        k4a_image_t handle = nullptr;
+        k4a_result_t result =
+            k4a_buffer_ring_create_image(m_handle, format, width_pixels, height_pixels, stride_bytes, &handle);
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to create image in buffer ring!");
+        }
+        return image(handle);
+    }
+
+private:
+    k4a_buffer_ring_t m_handle;
+};
+
+/** \class transformation k4a.hpp <k4a/k4a.hpp>
+ * Wrapper for \ref k4a_transformation_t
+ *
+ * Wraps a handle for a transformation.
+ */
+class transformation
+{
+public:
+    /** Creates a transformation associated with calibration
+     *
+     * \sa k4a_transformation_create
+     */
+    transformation(const k4a_calibration_t &calibration) noexcept :
+        m_handle(k4a_transformation_create(&calibration)),
+        m_color_resolution({ calibration.color_camera_calibration.resolution_width,
+                             calibration.color_camera_calibration.resolution_height }),
+        m_depth_resolution({ calibration.depth_camera_calibration.resolution_width,
+                             calibration.depth_camera_calibration.resolution_height })
+    {
+    }
+
+    /** Creates a transformation associated with calibration whose resources come from an application allocator
+     *
+     * \sa k4a_transformation_create_with_allocator
+     */
+    transformation(const k4a_calibration_t &calibration,
+                   k4a_memory_allocate_source_cb_t *allocate,
+                   k4a_memory_destroy_cb_t *free,
+                   void *allocator_context) noexcept :
+        m_handle(k4a_transformation_create_with_allocator(&calibration, allocate, free, allocator_context)),
+        m_color_resolution({ calibration.color_camera_calibration.resolution_width,
+                             calibration.color_camera_calibration.resolution_height }),
+        m_depth_resolution({ calibration.depth_camera_calibration.resolution_width,
+                             calibration.depth_camera_calibration.resolution_height })
+    {
+    }
+
+    /** Creates a transformation from a k4a_transformation_t
+     * Takes ownership of the handle, i.e. you should not call
+     * k4a_transformation_destroy on the handle after giving
+     * it to the transformation; the transformation will take care of that.
+     */
+    transformation(k4a_transformation_t handle = nullptr) noexcept : m_handle(handle) {}
+
+    /** Moves another tranformation into a new transformation
+     */
+    transformation(transformation &&other) noexcept :
+        m_handle(other.m_handle),
+        m_color_resolution(other.m_color_resolution),
+        m_depth_resolution(other.m_depth_resolution)
+    {
+        other.m_handle = nullptr;
+    }
+
+    transformation(const transformation &) = delete;
+
+    ~transformation()
+    {
+        destroy();
+    }
+
+    /** Moves another image into this image; other is set to invalid
+     */
+    transformation &operator=(transformation &&other) noexcept
+    {
+        if (this != &other)
+        {
+            destroy();
+            m_handle = other.m_handle;
+            m_color_resolution = other.m_color_resolution;
+            m_depth_resolution = other.m_depth_resolution;
+            other.m_handle = nullptr;
+        }
+
+        return *this;
+    }
+
+    /** Invalidates this transformation
+     */
+    transformation &operator=(std::nullptr_t) noexcept
+    {
+        destroy();
+        return *this;
+    }
+
+    transformation &operator=(const transformation &) = delete;
+
+    /** Invalidates this transformation
+     */
+    void destroy() noexcept
+    {
+        if (m_handle != nullptr)
+        {
+            k4a_transformation_destroy(m_handle);
+            m_handle = nullptr;
+        }
+    }
+
+    /** Builds the pre-computed resources of this transformation ahead of its first transformation
+     * Throws error on failure
+     *
+     * \sa k4a_transformation_warm_up
+     */
+    void warm_up() const
+    {
+        k4a_result_t result = k4a_transformation_warm_up(m_handle);
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to warm up the transformation!");
+        }
+    }
+
     /** Transforms the depth map into the geometry of the color camera.
      * Throws error on failure
      *
@@ -931,6 +1579,58 @@ public:
         return transformed_depth_image;
     }
 
+    /** Transforms the depth map into the geometry of the color camera.
+     * Throws error on failure
+     *
+     * \sa k4a_transformation_depth_image_to_color_camera
+     * Transforms the output in to an image from \p pool.
+     */
+    image depth_image_to_color_camera(const image &depth_image, image_pool &pool) const
+    {
+        image transformed_depth_image = pool.acquire(K4A_IMAGE_FORMAT_DEPTH16,
+                                                     m_color_resolution.width,
+                                                     m_color_resolution.height,
+                                                     m_color_resolution.width * static_cast<int32_t>(sizeof(uint16_t)));
+        depth_image_to_color_camera(depth_image, &transformed_depth_image);
+        return transformed_depth_image;
+    }
+
+    /** Transforms the depth map into a region of the geometry of the color camera.
+     * Throws error on failure
+     *
+     * \sa k4a_transformation_depth_image_to_color_camera_roi
+     * Transforms the output in to the existing caller provided \p transformed_depth_image, the size of \p roi.
+     */
+    void depth_image_to_color_camera(const image &depth_image,
+                                     const k4a_rect_t &roi,
+                                     image *transformed_depth_image) const
+    {
+        k4a_result_t result = k4a_transformation_depth_image_to_color_camera_roi(m_handle,
+                                                                                 depth_image.handle(),
+                                                                                 &roi,
+                                                                                 transformed_depth_image->handle());
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to convert depth map to color camera geometry!");
+        }
+    }
+
+    /** Transforms the depth map into a region of the geometry of the color camera.
+     * Throws error on failure
+     *
+     * \sa k4a_transformation_depth_image_to_color_camera_roi
+     * Creates a new image the size of \p roi with the output.
+     */
+    image depth_image_to_color_camera(const image &depth_image, const k4a_rect_t &roi) const
+    {
+        image transformed_depth_image = image::create(K4A_IMAGE_FORMAT_DEPTH16,
+                                                      roi.width,
+                                                      roi.height,
+                                                      roi.width * static_cast<int32_t>(sizeof(uint16_t)));
+        depth_image_to_color_camera(depth_image, roi, &transformed_depth_image);
+        return transformed_depth_image;
+    }
+
     /** Transforms depth map and a custom image into the geometry of the color camera.
      * Throws error on failure
      *
@@ -999,6 +1699,48 @@ public:
         return { std::move(transformed_depth_image), std::move(transformed_custom_image) };
     }
 
+    /** Transforms depth map and several custom images into the geometry of the color camera in one pass.
+     * Throws error on failure
+     *
+     * \sa k4a_transformation_depth_image_to_color_camera_custom_planes
+     * Transforms the output in to the existing caller provided \p transformed_depth_image \p transformed_custom_images,
+     * which must hold one image for each of \p custom_images.
+     */
+    void depth_image_to_color_camera_custom_planes(const image &depth_image,
+                                                   const std::vector<image> &custom_images,
+                                                   image *transformed_depth_image,
+                                                   std::vector<image> *transformed_custom_images,
+                                                   k4a_transformation_interpolation_type_t interpolation_type,
+                                                   uint32_t invalid_custom_value) const
+    {
+        if (custom_images.size() != transformed_custom_images->size())
+        {
+            throw error("Expected one transformed custom image for each custom image!");
+        }
+
+        std::vector<k4a_image_t> custom_handles;
+        std::vector<k4a_image_t> transformed_custom_handles;
+        for (size_t i = 0; i < custom_images.size(); i++)
+        {
+            custom_handles.push_back(custom_images[i].handle());
+            transformed_custom_handles.push_back((*transformed_custom_images)[i].handle());
+        }
+
+        k4a_result_t result =
+            k4a_transformation_depth_image_to_color_camera_custom_planes(m_handle,
+                                                                         depth_image.handle(),
+                                                                         custom_handles.data(),
+                                                                         static_cast<uint32_t>(custom_handles.size()),
+                                                                         transformed_depth_image->handle(),
+                                                                         transformed_custom_handles.data(),
+                                                                         interpolation_type,
+                                                                         invalid_custom_value);
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to convert depth map and custom images to color camera geometry!");
+        }
+    }
+
     /** Transforms the color image into the geometry of the depth camera.
      * Throws error on failure
      *
@@ -1036,11 +1778,66 @@ public:
         return transformed_color_image;
     }
 
-    /** Transforms the depth image into 3 planar images representing X, Y and Z-coordinates of corresponding 3d points.
-     * Throws error on failure.
+    /** Transforms the color image into the geometry of the depth camera.
+     * Throws error on failure
      *
-     * \sa k4a_transformation_depth_image_to_point_cloud
-     * Transforms the output in to the existing caller provided \p xyz_image.
+     * \sa k4a_transformation_color_image_to_depth_camera
+     * Transforms the output in to an image from \p pool.
+     */
+    image color_image_to_depth_camera(const image &depth_image, const image &color_image, image_pool &pool) const
+    {
+        image transformed_color_image = pool.acquire(K4A_IMAGE_FORMAT_COLOR_BGRA32,
+                                                     m_depth_resolution.width,
+                                                     m_depth_resolution.height,
+                                                     m_depth_resolution.width * 4 *
+                                                         static_cast<int32_t>(sizeof(uint8_t)));
+        color_image_to_depth_camera(depth_image, color_image, &transformed_color_image);
+        return transformed_color_image;
+    }
+
+    /** Transforms the color image into a region of the geometry of the depth camera.
+     * Throws error on failure
+     *
+     * \sa k4a_transformation_color_image_to_depth_camera_roi
+     * Transforms the output in to the existing caller provided \p transformed_color_image, the size of \p roi.
+     */
+    void color_image_to_depth_camera(const image &depth_image,
+                                     const image &color_image,
+                                     const k4a_rect_t &roi,
+                                     image *transformed_color_image) const
+    {
+        k4a_result_t result = k4a_transformation_color_image_to_depth_camera_roi(m_handle,
+                                                                                 depth_image.handle(),
+                                                                                 color_image.handle(),
+                                                                                 &roi,
+                                                                                 transformed_color_image->handle());
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to convert color image to depth camera geometry!");
+        }
+    }
+
+    /** Transforms the color image into a region of the geometry of the depth camera.
+     * Throws error on failure
+     *
+     * \sa k4a_transformation_color_image_to_depth_camera_roi
+     * Creates a new image the size of \p roi with the output.
+     */
+    image color_image_to_depth_camera(const image &depth_image, const image &color_image, const k4a_rect_t &roi) const
+    {
+        image transformed_color_image = image::create(K4A_IMAGE_FORMAT_COLOR_BGRA32,
+                                                      roi.width,
+                                                      roi.height,
+                                                      roi.width * 4 * static_cast<int32_t>(sizeof(uint8_t)));
+        color_image_to_depth_camera(depth_image, color_image, roi, &transformed_color_image);
+        return transformed_color_image;
+    }
+
+    /** Transforms the depth image into 3 planar images representing X, Y and Z-coordinates of corresponding 3d points.
+     * Throws error on failure
+     *
+     * \sa k4a_transformation_depth_image_to_point_cloud
+     * Transforms the output in to the existing caller provided \p xyz_image.
      */
     void depth_image_to_point_cloud(const image &depth_image, k4a_calibration_type_t camera, image *xyz_image) const
     {
@@ -1053,7 +1850,7 @@ public:
     }
 
     /** Transforms the depth image into 3 planar images representing X, Y and Z-coordinates of corresponding 3d points.
-     * Throws error on failure.
+     * Throws error on failure
      *
      * \sa k4a_transformation_depth_image_to_point_cloud
      * Creates a new image with the output.
@@ -1068,6 +1865,236 @@ public:
         return xyz_image;
     }
 
+    /** Transforms the depth image into 3 planar images representing X, Y and Z-coordinates of corresponding 3d points.
+     * Throws error on failure
+     *
+     * \sa k4a_transformation_depth_image_to_point_cloud
+     * Transforms the output in to an image from \p pool.
+     */
+    image depth_image_to_point_cloud(const image &depth_image, k4a_calibration_type_t camera, image_pool &pool) const
+    {
+        image xyz_image = pool.acquire(K4A_IMAGE_FORMAT_CUSTOM,
+                                       depth_image.get_width_pixels(),
+                                       depth_image.get_height_pixels(),
+                                       depth_image.get_width_pixels() * 3 * static_cast<int32_t>(sizeof(int16_t)));
+        depth_image_to_point_cloud(depth_image, camera, &xyz_image);
+        return xyz_image;
+    }
+
+    /** Transforms a region of the depth image into a point cloud.
+     * Throws error on failure
+     *
+     * \sa k4a_transformation_depth_image_to_point_cloud_roi
+     * Transforms the output in to the existing caller provided \p xyz_image, the size of \p roi.
+     */
+    void depth_image_to_point_cloud(const image &depth_image,
+                                    k4a_calibration_type_t camera,
+                                    const k4a_rect_t &roi,
+                                    image *xyz_image) const
+    {
+        k4a_result_t result = k4a_transformation_depth_image_to_point_cloud_roi(m_handle,
+                                                                                depth_image.handle(),
+                                                                                camera,
+                                                                                &roi,
+                                                                                xyz_image->handle());
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to transform depth image to point cloud!");
+        }
+    }
+
+    /** Transforms a region of the depth image into a point cloud.
+     * Throws error on failure
+     *
+     * \sa k4a_transformation_depth_image_to_point_cloud_roi
+     * Creates a new image the size of \p roi with the output.
+     */
+    image
+    depth_image_to_point_cloud(const image &depth_image, k4a_calibration_type_t camera, const k4a_rect_t &roi) const
+    {
+        image xyz_image = image::create(K4A_IMAGE_FORMAT_CUSTOM,
+                                        roi.width,
+                                        roi.height,
+                                        roi.width * 3 * static_cast<int32_t>(sizeof(int16_t)));
+        depth_image_to_point_cloud(depth_image, camera, roi, &xyz_image);
+        return xyz_image;
+    }
+
+    /** Transforms the depth image into a point cloud of the given format.
+     * Throws error on failure
+     *
+     * \sa k4a_transformation_depth_image_to_formatted_point_cloud
+     * Transforms the output in to the existing caller provided \p xyz_image.
+     */
+    void depth_image_to_point_cloud(const image &depth_image,
+                                    k4a_calibration_type_t camera,
+                                    k4a_point_cloud_format_t format,
+                                    image *xyz_image) const
+    {
+        k4a_result_t result = k4a_transformation_depth_image_to_formatted_point_cloud(
+            m_handle, depth_image.handle(), camera, format, xyz_image->handle());
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to transform depth image to point cloud!");
+        }
+    }
+
+    /** Transforms the depth image into a point cloud holding only the pixels with depth.
+     * Throws error on failure
+     *
+     * \sa k4a_transformation_depth_image_to_valid_point_cloud
+     * Transforms the output in to the existing caller provided \p xyz_image, and returns the number of points written.
+     */
+    size_t depth_image_to_valid_point_cloud(const image &depth_image,
+                                            k4a_calibration_type_t camera,
+                                            image *xyz_image,
+                                            uint32_t *pixel_indices = nullptr) const
+    {
+        size_t point_count = 0;
+        k4a_result_t result = k4a_transformation_depth_image_to_valid_point_cloud(
+            m_handle, depth_image.handle(), camera, xyz_image->handle(), pixel_indices, &point_count);
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to transform depth image to valid point cloud!");
+        }
+        return point_count;
+    }
+
+    /** Transforms the depth image into a point cloud in the color camera, with the color of each point.
+     * Throws error on failure
+     *
+     * \sa k4a_transformation_depth_image_to_colored_point_cloud
+     * Transforms the output in to the existing caller provided \p xyz_image and \p bgra_image, and returns the number
+     * of points written.
+     */
+    size_t depth_image_to_colored_point_cloud(const image &depth_image,
+                                              const image &color_image,
+                                              bool valid_points_only,
+                                              image *xyz_image,
+                                              image *bgra_image) const
+    {
+        size_t point_count = 0;
+        k4a_result_t result = k4a_transformation_depth_image_to_colored_point_cloud(m_handle,
+                                                                                    depth_image.handle(),
+                                                                                    color_image.handle(),
+                                                                                    valid_points_only,
+                                                                                    xyz_image->handle(),
+                                                                                    bgra_image->handle(),
+                                                                                    &point_count);
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to transform depth image to colored point cloud!");
+        }
+        return point_count;
+    }
+
+    /** Fuses the depth images of several devices into one point cloud of a common frame.
+     * Throws error on failure
+     *
+     * \sa k4a_transformation_fuse_point_clouds
+     * Writes the output in to the existing caller provided \p xyz_image and, unless it is nullptr, \p bgra_image, and
+     * returns the number of points written.
+     */
+    static size_t fuse_point_clouds(const std::vector<k4a_point_cloud_fusion_input_t> &inputs,
+                                    k4a_point_cloud_format_t format,
+                                    bool valid_points_only,
+                                    image *xyz_image,
+                                    image *bgra_image = nullptr)
+    {
+        size_t point_count = 0;
+        k4a_result_t result = k4a_transformation_fuse_point_clouds(inputs.data(),
+                                                                   static_cast<uint32_t>(inputs.size()),
+                                                                   format,
+                                                                   valid_points_only,
+                                                                   xyz_image->handle(),
+                                                                   bgra_image != nullptr ? bgra_image->handle() :
+                                                                                           nullptr,
+                                                                   &point_count);
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to fuse point clouds!");
+        }
+        return point_count;
+    }
+
+    /** Estimates the surface normal of every point of a point cloud.
+     * Throws error on failure
+     *
+     * \sa k4a_transformation_point_cloud_to_normals
+     * Writes the output in to the existing caller provided \p normal_image.
+     */
+    static void point_cloud_to_normals(const image &xyz_image, image *normal_image)
+    {
+        k4a_result_t result = k4a_transformation_point_cloud_to_normals(xyz_image.handle(), normal_image->handle());
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to estimate point cloud normals!");
+        }
+    }
+
+    /** Downsamples a point cloud to one point per cube of a voxel grid.
+     * Throws error on failure
+     *
+     * \sa k4a_transformation_point_cloud_voxel_downsample
+     * Writes the output in to the existing caller provided \p downsampled_xyz_image and, unless they are nullptr,
+     * averages \p normal_image in to \p downsampled_normal_image. Returns the number of points written.
+     */
+    static size_t point_cloud_voxel_downsample(const image &xyz_image,
+                                               float voxel_size,
+                                               image *downsampled_xyz_image,
+                                               const image *normal_image = nullptr,
+                                               image *downsampled_normal_image = nullptr)
+    {
+        size_t point_count = 0;
+        k4a_result_t result = k4a_transformation_point_cloud_voxel_downsample(
+            xyz_image.handle(),
+            normal_image != nullptr ? normal_image->handle() : nullptr,
+            voxel_size,
+            downsampled_xyz_image->handle(),
+            downsampled_normal_image != nullptr ? downsampled_normal_image->handle() : nullptr,
+            &point_count);
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to downsample point cloud!");
+        }
+        return point_count;
+    }
+
+    /** Gets the unprojection tables of the depth or color camera, valid while this transformation exists
+     * Throws error on failure
+     *
+     * \sa k4a_transformation_get_xy_table
+     */
+    k4a_xy_table_t get_xy_table(k4a_calibration_type_t camera) const
+    {
+        k4a_xy_table_t xy_table;
+        k4a_result_t result = k4a_transformation_get_xy_table(m_handle, camera, &xy_table);
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to get the xy table!");
+        }
+        return xy_table;
+    }
+
+    /** Creates a map that undistorts the images of camera into the pinhole image
+     * Throws error on failure
+     *
+     * \sa k4a_transformation_create_undistort_map
+     */
+    undistort_map create_undistort_map(k4a_calibration_type_t camera,
+                                       const k4a_pinhole_t *pinhole,
+                                       k4a_transformation_interpolation_type_t interpolation_type) const
+    {
+        k4a_undistort_map_t handle = nullptr;
+        k4a_result_t result =
+            k4a_transformation_create_undistort_map(m_handle, camera, pinhole, interpolation_type, &handle);
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to create undistort map!");
+        }
+        return undistort_map(handle);
+    }
+
 private:
     k4a_transformation_t m_handle;
     struct resolution
@@ -1161,7 +2188,7 @@ public:
     }
 
     /** Reads a sensor capture into cap.  Returns true if a capture was read, false if the read timed out.
-     * Throws error on failure.
+     * Throws error on failure
      *
      * \sa k4a_device_get_capture
      */
@@ -1194,7 +2221,7 @@ public:
     }
 
     /** Reads an IMU sample.  Returns true if a sample was read, false if the read timed out.
-     * Throws error on failure.
+     * Throws error on failure
      *
      * \sa k4a_device_get_imu_sample
      */
@@ -1208,130 +2235,515 @@ public:
         }
         else if (result == K4A_WAIT_RESULT_TIMEOUT)
         {
-            return false;
+            return false;
+        }
+
+        return true;
+    }
+
+    /** Reads an IMU sample.  Returns true if a sample was read, false if the read timed out.
+     * Throws error on failure. This API assumes an infinate timeout.
+     *
+     * \sa k4a_device_get_imu_sample
+     */
+    bool get_imu_sample(k4a_imu_sample_t *imu_sample) const
+    {
+        return get_imu_sample(imu_sample, std::chrono::milliseconds(K4A_WAIT_INFINITE));
+    }
+
+    /** Reads the IMU samples that are available, up to max_samples. Returns the number of samples read, 0 if the read
+     * timed out. Throws error on failure.
+     *
+     * \sa k4a_device_get_imu_samples
+     */
+    size_t get_imu_samples(k4a_imu_sample_t *imu_samples, size_t max_samples, std::chrono::milliseconds timeout) const
+    {
+        size_t sample_count = 0;
+        int32_t timeout_ms = internal::clamp_cast<int32_t>(timeout.count());
+        k4a_wait_result_t result =
+            k4a_device_get_imu_samples(m_handle, imu_samples, max_samples, &sample_count, timeout_ms);
+        if (result == K4A_WAIT_RESULT_FAILED)
+        {
+            throw error("Failed to get IMU samples from device!");
+        }
+        else if (result == K4A_WAIT_RESULT_TIMEOUT)
+        {
+            return 0;
+        }
+
+        return sample_count;
+    }
+
+    /** Reads the most recent IMU sample, skipping older buffered samples. Returns true if a sample was read, false if
+     * the read timed out. Throws error on failure
+     *
+     * \sa k4a_device_get_latest_imu_sample
+     */
+    bool get_latest_imu_sample(k4a_imu_sample_t *imu_sample, std::chrono::milliseconds timeout) const
+    {
+        int32_t timeout_ms = internal::clamp_cast<int32_t>(timeout.count());
+        k4a_wait_result_t result = k4a_device_get_latest_imu_sample(m_handle, imu_sample, timeout_ms);
+        if (result == K4A_WAIT_RESULT_FAILED)
+        {
+            throw error("Failed to get IMU sample from device!");
+        }
+        else if (result == K4A_WAIT_RESULT_TIMEOUT)
+        {
+            return false;
+        }
+
+        return true;
+    }
+
+    /** Get the operating system object that is signaled while get_capture() has a capture to return
+     * Throws error on failure
+     *
+     * \sa k4a_device_get_capture_wait_handle
+     */
+    k4a_wait_handle_t get_capture_wait_handle() const
+    {
+        k4a_wait_handle_t wait_handle = K4A_WAIT_HANDLE_INVALID;
+        k4a_result_t result = k4a_device_get_capture_wait_handle(m_handle, &wait_handle);
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to get capture wait handle!");
+        }
+        return wait_handle;
+    }
+
+    /** Get the operating system object that is signaled while get_imu_sample() has a sample to return
+     * Throws error on failure
+     *
+     * \sa k4a_device_get_imu_wait_handle
+     */
+    k4a_wait_handle_t get_imu_wait_handle() const
+    {
+        k4a_wait_handle_t wait_handle = K4A_WAIT_HANDLE_INVALID;
+        k4a_result_t result = k4a_device_get_imu_wait_handle(m_handle, &wait_handle);
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to get IMU wait handle!");
+        }
+        return wait_handle;
+    }
+
+    /** Deliver captures to a callback instead of get_capture()
+     * Throws error on failure
+     *
+     * \sa k4a_device_set_capture_callback
+     */
+    void set_capture_callback(k4a_capture_ready_cb_t *callback, void *context)
+    {
+        k4a_result_t result = k4a_device_set_capture_callback(m_handle, callback, context);
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to set capture callback!");
+        }
+    }
+
+    /** Deliver IMU samples to a callback instead of get_imu_sample()
+     * Throws error on failure
+     *
+     * \sa k4a_device_set_imu_callback
+     */
+    void set_imu_callback(k4a_imu_sample_ready_cb_t *callback, void *context)
+    {
+        k4a_result_t result = k4a_device_set_imu_callback(m_handle, callback, context);
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to set IMU callback!");
+        }
+    }
+
+    /** Enables or disables the preintegration of the IMU motion
+     * Throws error on failure
+     *
+     * \sa k4a_device_set_imu_preintegration
+     */
+    void set_imu_preintegration(bool enabled)
+    {
+        k4a_result_t result = k4a_device_set_imu_preintegration(m_handle, enabled);
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to set IMU preintegration!");
+        }
+    }
+
+    /** Reads the IMU motion between two device timestamps. Returns true if the motion was read, false if the read
+     * timed out. Throws error on failure.
+     *
+     * \sa k4a_device_get_imu_preintegration
+     */
+    bool get_imu_preintegration(std::chrono::microseconds start_timestamp,
+                                std::chrono::microseconds end_timestamp,
+                                k4a_imu_preintegration_t *preintegration,
+                                std::chrono::milliseconds timeout) const
+    {
+        int32_t timeout_ms = internal::clamp_cast<int32_t>(timeout.count());
+        k4a_wait_result_t result = k4a_device_get_imu_preintegration(m_handle,
+                                                                     static_cast<uint64_t>(start_timestamp.count()),
+                                                                     static_cast<uint64_t>(end_timestamp.count()),
+                                                                     preintegration,
+                                                                     timeout_ms);
+        if (result == K4A_WAIT_RESULT_FAILED)
+        {
+            throw error("Failed to get IMU preintegration from device!");
+        }
+        else if (result == K4A_WAIT_RESULT_TIMEOUT)
+        {
+            return false;
+        }
+
+        return true;
+    }
+
+    /** Starts the K4A device's cameras
+     * Throws error on failure
+     *
+     * \sa k4a_device_start_cameras
+     */
+    void start_cameras(const k4a_device_configuration_t *configuration) const
+    {
+        k4a_result_t result = k4a_device_start_cameras(m_handle, configuration);
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to start cameras!");
+        }
+    }
+
+    /** Stops the K4A device's cameras
+     *
+     * \sa k4a_device_stop_cameras
+     */
+    void stop_cameras() const noexcept
+    {
+        k4a_device_stop_cameras(m_handle);
+    }
+
+    /** Switches the running depth camera to another depth mode or frame rate
+     * Throws error on failure
+     *
+     * \sa k4a_device_set_depth_mode
+     */
+    void set_depth_mode(k4a_depth_mode_t depth_mode, k4a_fps_t camera_fps) const
+    {
+        k4a_result_t result = k4a_device_set_depth_mode(m_handle, depth_mode, camera_fps);
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to set the depth mode!");
+        }
+    }
+
+    /** Starts the K4A IMU
+     * Throws error on failure
+     *
+     * \sa k4a_device_start_imu
+     */
+    void start_imu() const
+    {
+        k4a_result_t result = k4a_device_start_imu(m_handle);
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to start IMU!");
+        }
+    }
+
+    /** Stops the K4A IMU
+     *
+     * \sa k4a_device_stop_imu
+     */
+    void stop_imu() const noexcept
+    {
+        k4a_device_stop_imu(m_handle);
+    }
+
+    /** Get the K4A device serial number
+     * Throws error on failure
+     *
+     * \sa k4a_device_get_serialnum
+     */
+    std::string get_serialnum() const
+    {
+        std::string serialnum;
+        size_t buffer = 0;
+        k4a_buffer_result_t result = k4a_device_get_serialnum(m_handle, &serialnum[0], &buffer);
+
+        if (result == K4A_BUFFER_RESULT_TOO_SMALL && buffer > 1)
+        {
+            serialnum.resize(buffer);
+            result = k4a_device_get_serialnum(m_handle, &serialnum[0], &buffer);
+            if (result == K4A_BUFFER_RESULT_SUCCEEDED && serialnum[buffer - 1] == 0)
+            {
+                // std::string expects there to not be as null terminator at the end of its data but
+                // k4a_device_get_serialnum adds a null terminator, so we drop the last character of the string after we
+                // get the result back.
+                serialnum.resize(buffer - 1);
+            }
+        }
+
+        if (result != K4A_BUFFER_RESULT_SUCCEEDED)
+        {
+            throw error("Failed to read device serial number!");
+        }
+
+        return serialnum;
+    }
+
+    /** Get the K4A color sensor control value
+     * Throws error on failure
+     *
+     * \sa k4a_device_get_color_control
+     */
+    void get_color_control(k4a_color_control_command_t command, k4a_color_control_mode_t *mode, int32_t *value) const
+    {
+        k4a_result_t result = k4a_device_get_color_control(m_handle, command, mode, value);
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to read color control!");
+        }
+    }
+
+    /** Read the K4A color sensor control value from the device
+     * Throws error on failure
+     *
+     * \sa k4a_device_refresh_color_control
+     */
+    void refresh_color_control(k4a_color_control_command_t command, k4a_color_control_mode_t *mode, int32_t *value)
+    {
+        k4a_result_t result = k4a_device_refresh_color_control(m_handle, command, mode, value);
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to read color control!");
+        }
+    }
+
+    /** Set the K4A color sensor control value
+     * Throws error on failure
+     *
+     * \sa k4a_device_set_color_control
+     */
+    void set_color_control(k4a_color_control_command_t command, k4a_color_control_mode_t mode, int32_t value)
+    {
+        k4a_result_t result = k4a_device_set_color_control(m_handle, command, mode, value);
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to set color control!");
+        }
+    }
+
+    /** Set the limits on the USB transfers used to stream depth data
+     * Throws error on failure
+     *
+     * \sa k4a_device_set_usb_streaming_options
+     */
+    void set_usb_streaming_options(const k4a_usb_streaming_options_t &options)
+    {
+        k4a_result_t result = k4a_device_set_usb_streaming_options(m_handle, &options);
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to set USB streaming options!");
+        }
+    }
+
+    /** Set the streaming options used by the next start_cameras() calls
+     * Throws error on failure
+     *
+     * \sa k4a_device_set_start_options
+     */
+    void set_start_options(const k4a_device_start_options_t &options)
+    {
+        k4a_result_t result = k4a_device_set_start_options(m_handle, &options);
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to set start options!");
+        }
+    }
+
+    /** Get the streaming options used by the next start_cameras() calls
+     * Throws error on failure
+     *
+     * \sa k4a_device_get_start_options
+     */
+    k4a_device_start_options_t get_start_options() const
+    {
+        k4a_device_start_options_t options = K4A_DEVICE_START_OPTIONS_INIT;
+        k4a_result_t result = k4a_device_get_start_options(m_handle, &options);
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to get start options!");
+        }
+        return options;
+    }
+
+    /** Set the allocator used for the buffers of this device
+     * Throws error on failure
+     *
+     * \sa k4a_device_set_allocator
+     */
+    void
+    set_allocator(k4a_memory_allocate_source_cb_t *allocate, k4a_memory_destroy_cb_t *free, void *allocator_context)
+    {
+        k4a_result_t result = k4a_device_set_allocator(m_handle, allocate, free, allocator_context);
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to set device allocator!");
+        }
+    }
+
+    /** Set the buffer ring the images of one stream of this device are written into, nullptr to clear it
+     * Throws error on failure
+     *
+     * \sa k4a_device_set_buffer_ring
+     */
+    void set_buffer_ring(k4a_allocation_source_t source, const buffer_ring *ring)
+    {
+        k4a_result_t result = k4a_device_set_buffer_ring(m_handle, source, ring ? ring->handle() : nullptr);
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to set device buffer ring!");
         }
-
-        return true;
     }
 
-    /** Reads an IMU sample.  Returns true if a sample was read, false if the read timed out.
-     * Throws error on failure. This API assumes an infinate timeout.
+    /** Select the GPU the depth engine of this device runs on
+     * Throws error on failure
      *
-     * \sa k4a_device_get_imu_sample
+     * \sa k4a_device_set_depth_engine_gpu
      */
-    bool get_imu_sample(k4a_imu_sample_t *imu_sample) const
+    void set_depth_engine_gpu(int32_t gpu_index)
     {
-        return get_imu_sample(imu_sample, std::chrono::milliseconds(K4A_WAIT_INFINITE));
+        k4a_result_t result = k4a_device_set_depth_engine_gpu(m_handle, gpu_index);
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to set depth engine GPU!");
+        }
     }
 
-    /** Starts the K4A device's cameras
-     * Throws error on failure.
+    /** Keep the depth engine of this device alive while its cameras are stopped
+     * Throws error on failure
      *
-     * \sa k4a_device_start_cameras
+     * \sa k4a_device_set_depth_engine_keep_alive
      */
-    void start_cameras(const k4a_device_configuration_t *configuration) const
+    void set_depth_engine_keep_alive(bool keep_alive)
     {
-        k4a_result_t result = k4a_device_start_cameras(m_handle, configuration);
+        k4a_result_t result = k4a_device_set_depth_engine_keep_alive(m_handle, keep_alive);
         if (K4A_RESULT_SUCCEEDED != result)
         {
-            throw error("Failed to start cameras!");
+            throw error("Failed to set depth engine keep alive!");
         }
     }
 
-    /** Stops the K4A device's cameras
+    /** Set the filters applied to the depth images of this device, NULL disables them
+     * Throws error on failure
      *
-     * \sa k4a_device_stop_cameras
+     * \sa k4a_device_set_depth_filter
      */
-    void stop_cameras() const noexcept
+    void set_depth_filter(const k4a_depth_filter_configuration_t *config)
     {
-        k4a_device_stop_cameras(m_handle);
+        k4a_result_t result = k4a_device_set_depth_filter(m_handle, config);
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to set depth filter!");
+        }
     }
 
-    /** Starts the K4A IMU
+    /** Set the region and scale of the BGRA32 color images of this device, NULL selects the full resolution
      * Throws error on failure
      *
-     * \sa k4a_device_start_imu
+     * \sa k4a_device_set_color_decode
      */
-    void start_imu() const
+    void set_color_decode(const k4a_color_decode_configuration_t *config)
     {
-        k4a_result_t result = k4a_device_start_imu(m_handle);
+        k4a_result_t result = k4a_device_set_color_decode(m_handle, config);
         if (K4A_RESULT_SUCCEEDED != result)
         {
-            throw error("Failed to start IMU!");
+            throw error("Failed to set color decode!");
         }
     }
 
-    /** Stops the K4A IMU
+    /** Get the load on the GPU the depth engine of this device runs on
+     * Throws error on failure
      *
-     * \sa k4a_device_stop_imu
+     * \sa k4a_device_get_depth_engine_gpu_statistics
      */
-    void stop_imu() const noexcept
+    k4a_depth_engine_gpu_statistics_t get_depth_engine_gpu_statistics() const
     {
-        k4a_device_stop_imu(m_handle);
+        k4a_depth_engine_gpu_statistics_t statistics;
+        k4a_result_t result = k4a_device_get_depth_engine_gpu_statistics(m_handle, &statistics);
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to read depth engine GPU statistics!");
+        }
+        return statistics;
     }
 
-    /** Get the K4A device serial number
-     * Throws error on failure.
+    /** Get the depth engine timing and the frame drop counters of this device
+     * Throws error on failure
      *
-     * \sa k4a_device_get_serialnum
+     * \sa k4a_device_get_statistics
      */
-    std::string get_serialnum() const
+    k4a_device_statistics_t get_statistics() const
     {
-        std::string serialnum;
-        size_t buffer = 0;
-        k4a_buffer_result_t result = k4a_device_get_serialnum(m_handle, &serialnum[0], &buffer);
-
-        if (result == K4A_BUFFER_RESULT_TOO_SMALL && buffer > 1)
+        k4a_device_statistics_t statistics;
+        k4a_result_t result = k4a_device_get_statistics(m_handle, &statistics);
+        if (K4A_RESULT_SUCCEEDED != result)
         {
-            serialnum.resize(buffer);
-            result = k4a_device_get_serialnum(m_handle, &serialnum[0], &buffer);
-            if (result == K4A_BUFFER_RESULT_SUCCEEDED && serialnum[buffer - 1] == 0)
-            {
-                // std::string expects there to not be as null terminator at the end of its data but
-                // k4a_device_get_serialnum adds a null terminator, so we drop the last character of the string after we
-                // get the result back.
-                serialnum.resize(buffer - 1);
-            }
+            throw error("Failed to read device statistics!");
         }
+        return statistics;
+    }
 
-        if (result != K4A_BUFFER_RESULT_SUCCEEDED)
+    /** Get the model of the device clock in the clock of the image system timestamps
+     * Throws error on failure
+     *
+     * \sa k4a_device_get_clock_model
+     */
+    k4a_device_clock_model_t get_clock_model() const
+    {
+        k4a_device_clock_model_t clock_model;
+        k4a_result_t result = k4a_device_get_clock_model(m_handle, &clock_model);
+        if (K4A_RESULT_SUCCEEDED != result)
         {
-            throw error("Failed to read device serial number!");
+            throw error("Failed to read device clock model!");
         }
-
-        return serialnum;
+        return clock_model;
     }
 
-    /** Get the K4A color sensor control value
-     * Throws error on failure.
+    /** Convert a device timestamp to the clock of the image system timestamps
+     * Throws error on failure
      *
-     * \sa k4a_device_get_color_control
+     * \sa k4a_device_convert_device_timestamp
      */
-    void get_color_control(k4a_color_control_command_t command, k4a_color_control_mode_t *mode, int32_t *value) const
+    std::chrono::nanoseconds convert_device_timestamp(std::chrono::microseconds device_timestamp) const
     {
-        k4a_result_t result = k4a_device_get_color_control(m_handle, command, mode, value);
+        uint64_t system_timestamp_nsec = 0;
+        k4a_result_t result = k4a_device_convert_device_timestamp(m_handle,
+                                                                  static_cast<uint64_t>(device_timestamp.count()),
+                                                                  &system_timestamp_nsec);
         if (K4A_RESULT_SUCCEEDED != result)
         {
-            throw error("Failed to read color control!");
+            throw error("Failed to convert device timestamp!");
         }
+        return std::chrono::nanoseconds(system_timestamp_nsec);
     }
 
-    /** Set the K4A color sensor control value
-     * Throws error on failure.
+    /** Get the number of USB transfers the depth stream submitted
+     * Throws error on failure
      *
-     * \sa k4a_device_set_color_control
+     * \sa k4a_device_get_usb_streaming_transfer_count
      */
-    void set_color_control(k4a_color_control_command_t command, k4a_color_control_mode_t mode, int32_t value)
+    uint32_t get_usb_streaming_transfer_count() const
     {
-        k4a_result_t result = k4a_device_set_color_control(m_handle, command, mode, value);
+        uint32_t transfer_count = 0;
+        k4a_result_t result = k4a_device_get_usb_streaming_transfer_count(m_handle, &transfer_count);
         if (K4A_RESULT_SUCCEEDED != result)
         {
-            throw error("Failed to set color control!");
+            throw error("Failed to read USB streaming transfer count!");
         }
+        return transfer_count;
     }
 
     /** Get the raw calibration blob for the entire K4A device.
-     * Throws error on failure.
+     * Throws error on failure
      *
      * \sa k4a_device_get_raw_calibration
      */
@@ -1355,8 +2767,33 @@ public:
         return calibration;
     }
 
+    /** Get the depth calibration the depth engine turns raw depth payloads into depth and IR images with.
+     * Throws error on failure
+     *
+     * \sa k4a_device_get_raw_depth_calibration
+     */
+    std::vector<uint8_t> get_raw_depth_calibration() const
+    {
+        std::vector<uint8_t> calibration;
+        size_t buffer = 0;
+        k4a_buffer_result_t result = k4a_device_get_raw_depth_calibration(m_handle, nullptr, &buffer);
+
+        if (result == K4A_BUFFER_RESULT_TOO_SMALL && buffer > 0)
+        {
+            calibration.resize(buffer);
+            result = k4a_device_get_raw_depth_calibration(m_handle, &calibration[0], &buffer);
+        }
+
+        if (result != K4A_BUFFER_RESULT_SUCCEEDED)
+        {
+            throw error("Failed to read raw depth calibration!");
+        }
+
+        return calibration;
+    }
+
     /** Get the camera calibration for the entire K4A device, which is used for all transformation functions.
-     * Throws error on failure.
+     * Throws error on failure
      *
      * \sa k4a_device_get_calibration
      */
@@ -1373,7 +2810,7 @@ public:
     }
 
     /** Get the device jack status for the synchronization in connector
-     * Throws error on failure.
+     * Throws error on failure
      *
      * \sa k4a_device_get_sync_jack
      */
@@ -1390,7 +2827,7 @@ public:
     }
 
     /** Get the device jack status for the synchronization out connector
-     * Throws error on failure.
+     * Throws error on failure
      *
      * \sa k4a_device_get_sync_jack
      */
@@ -1407,7 +2844,7 @@ public:
     }
 
     /** Get the version numbers of the K4A subsystems' firmware
-     * Throws error on failure.
+     * Throws error on failure
      *
      * \sa k4a_device_get_version
      */
@@ -1424,7 +2861,7 @@ public:
     }
 
     /** Open a k4a device.
-     * Throws error on failure.
+     * Throws error on failure
      *
      * \sa k4a_device_open
      */
@@ -1440,6 +2877,23 @@ public:
         return device(handle);
     }
 
+    /** Open the k4a device with the given serial number.
+     * Throws error on failure
+     *
+     * \sa k4a_device_open_by_serial
+     */
+    static device open_by_serial(const std::string &serial_number)
+    {
+        k4a_device_t handle = nullptr;
+        k4a_result_t result = k4a_device_open_by_serial(serial_number.c_str(), &handle);
+
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to open device!");
+        }
+        return device(handle);
+    }
+
     /** Gets the number of connected devices
      *
      * \sa k4a_device_get_installed_count
@@ -1449,10 +2903,236 @@ public:
         return k4a_device_get_installed_count();
     }
 
+    /** Lists the connected devices with their serial numbers
+     * Throws error on failure
+     *
+     * \sa k4a_device_enumerate
+     */
+    static std::vector<k4a_installed_device_t> enumerate()
+    {
+        std::vector<k4a_installed_device_t> devices;
+        uint32_t device_count = 0;
+        k4a_result_t result = k4a_device_enumerate(nullptr, 0, &device_count);
+
+        // Retry if a device was plugged in between the calls
+        while (K4A_RESULT_SUCCEEDED == result && device_count > devices.size())
+        {
+            devices.resize(device_count);
+            result = k4a_device_enumerate(devices.data(), static_cast<uint32_t>(devices.size()), &device_count);
+        }
+
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to enumerate devices!");
+        }
+        devices.resize(device_count);
+        return devices;
+    }
+
 private:
     k4a_device_t m_handle;
 };
 
+/** \class device_group k4a.hpp <k4a/k4a.hpp>
+ * Wrapper for \ref k4a_device_group_t
+ *
+ * Wraps a handle for a group of devices whose captures are read together.
+ */
+class device_group
+{
+public:
+    /** Creates a device group from a k4a_device_group_t
+     * Takes ownership of the handle, i.e. you should not call
+     * k4a_device_group_close on the handle after giving it to the
+     * device group; the device group will take care of that.
+     */
+    device_group(k4a_device_group_t handle = nullptr) noexcept : m_handle(handle) {}
+
+    /** Moves another device group into a new device group
+     */
+    device_group(device_group &&group) noexcept : m_handle(group.m_handle)
+    {
+        group.m_handle = nullptr;
+    }
+
+    device_group(const device_group &) = delete;
+
+    ~device_group()
+    {
+        close();
+    }
+
+    device_group &operator=(const device_group &) = delete;
+
+    /** Moves another device group into this device group; other is set to invalid
+     */
+    device_group &operator=(device_group &&group) noexcept
+    {
+        if (this != &group)
+        {
+            close();
+            m_handle = group.m_handle;
+            group.m_handle = nullptr;
+        }
+        return *this;
+    }
+
+    /** Returns true if the device group is valid, false otherwise
+     */
+    explicit operator bool() const noexcept
+    {
+        return is_valid();
+    }
+
+    /** Returns true if the device group is valid, false otherwise
+     */
+    bool is_valid() const noexcept
+    {
+        return m_handle != nullptr;
+    }
+
+    /** Returns the underlying k4a_device_group_t handle
+     */
+    k4a_device_group_t handle() const noexcept
+    {
+        return m_handle;
+    }
+
+    /** Closes the devices of the group
+     *
+     * \sa k4a_device_group_close
+     */
+    void close() noexcept
+    {
+        if (m_handle != nullptr)
+        {
+            k4a_device_group_close(m_handle);
+            m_handle = nullptr;
+        }
+    }
+
+    /** Returns the number of devices in the group
+     *
+     * \sa k4a_device_group_get_device_count
+     */
+    uint32_t get_device_count() const noexcept
+    {
+        return k4a_device_group_get_device_count(m_handle);
+    }
+
+    /** Returns the handle of a device of the group
+     *
+     * The handle is owned by the group, so it must not be given to a k4a::device.
+     *
+     * \sa k4a_device_group_get_device
+     */
+    k4a_device_t get_device(uint32_t index) const noexcept
+    {
+        return k4a_device_group_get_device(m_handle, index);
+    }
+
+    /** Starts the cameras of the devices, with one configuration per device
+     * Throws error on failure
+     *
+     * \sa k4a_device_group_start_cameras
+     */
+    void start_cameras(const std::vector<k4a_device_configuration_t> &configs)
+    {
+        if (configs.size() != get_device_count())
+        {
+            throw error("Device group needs one configuration per device!");
+        }
+        k4a_result_t result = k4a_device_group_start_cameras(m_handle, configs.data());
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to start device group cameras!");
+        }
+    }
+
+    /** Stops the cameras of the devices
+     *
+     * \sa k4a_device_group_stop_cameras
+     */
+    void stop_cameras() noexcept
+    {
+        k4a_device_group_stop_cameras(m_handle);
+    }
+
+    /** Reads one capture per device taken at the same time into caps.  Returns true if the captures were read, false
+     * if the read timed out.
+     * Throws error on failure
+     *
+     * \sa k4a_device_group_get_capture
+     */
+    bool get_capture(std::vector<capture> *caps, std::chrono::milliseconds timeout) const
+    {
+        std::vector<k4a_capture_t> capture_handles(get_device_count());
+        int32_t timeout_ms = internal::clamp_cast<int32_t>(timeout.count());
+        k4a_wait_result_t result = k4a_device_group_get_capture(m_handle, capture_handles.data(), timeout_ms);
+        if (result == K4A_WAIT_RESULT_FAILED)
+        {
+            throw error("Failed to get capture from device group!");
+        }
+        else if (result == K4A_WAIT_RESULT_TIMEOUT)
+        {
+            return false;
+        }
+
+        caps->clear();
+        for (k4a_capture_t capture_handle : capture_handles)
+        {
+            caps->emplace_back(capture_handle);
+        }
+        return true;
+    }
+
+    /** Get the matching counters of the group
+     * Throws error on failure
+     *
+     * \sa k4a_device_group_get_statistics
+     */
+    k4a_device_group_statistics_t get_statistics() const
+    {
+        k4a_device_group_statistics_t statistics;
+        k4a_result_t result = k4a_device_group_get_statistics(m_handle, &statistics);
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to read device group statistics!");
+        }
+        return statistics;
+    }
+
+    /** Opens a group of devices, or the devices 0 to device_count - 1 when device_indices is empty
+     * Throws error on failure
+     *
+     * \sa k4a_device_group_open
+     */
+    static device_group open(const std::vector<uint32_t> &device_indices, uint32_t device_count = 0)
+    {
+        k4a_device_group_t handle = nullptr;
+        k4a_result_t result = K4A_RESULT_FAILED;
+        if (device_indices.empty())
+        {
+            result = k4a_device_group_open(nullptr, device_count, &handle);
+        }
+        else
+        {
+            result = k4a_device_group_open(device_indices.data(),
+                                           static_cast<uint32_t>(device_indices.size()),
+                                           &handle);
+        }
+
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to open device group!");
+        }
+        return device_group(handle);
+    }
+
+private:
+    k4a_device_group_t m_handle;
+};
+
 /**
  * @}
  */
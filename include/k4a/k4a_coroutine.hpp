@@ -0,0 +1,212 @@
+/** \file k4a_coroutine.hpp
+ * Copyright (c) Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License.
+ * Kinect For Azure SDK - C++20 coroutine wrapper.
+ */
+
+#ifndef K4A_COROUTINE_HPP
+#define K4A_COROUTINE_HPP
+
+#include <k4a/k4a.hpp>
+
+#if !defined(__cpp_impl_coroutine)
+#error "k4a_coroutine.hpp requires a compiler with C++20 coroutine support"
+#endif
+
+#include <coroutine>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <utility>
+
+namespace k4a
+{
+
+/**
+ * \addtogroup cppsdk
+ *
+ * @{
+ */
+
+/** Resumes a suspended coroutine, for example by posting it to an executor
+ *
+ * When no resumer is given, coroutines are resumed on the SDK thread that completed the operation.
+ */
+using coroutine_resumer = std::function<void(std::coroutine_handle<>)>;
+
+/** \class capture_stream k4a_coroutine.hpp <k4a/k4a_coroutine.hpp>
+ * Delivers the captures of a device to a coroutine
+ *
+ * The stream installs a capture callback with device::set_capture_callback(), so co_await on next_capture() suspends
+ * the coroutine until the SDK signals the next capture instead of blocking a thread on device::get_capture(). Many
+ * streams can therefore be served by a small executor.
+ *
+ * Create the stream before device::start_cameras(), and destroy or close() it after device::stop_cameras(), since the
+ * SDK only changes the capture callback while the cameras are stopped.
+ *
+ * When the coroutine falls behind, the stream holds the newest captures and drops the oldest. Only one coroutine may
+ * wait on a stream at a time.
+ *
+ * \sa k4a_device_set_capture_callback
+ */
+class capture_stream
+{
+public:
+    /** Awaitable returned by next_capture()
+     */
+    class awaiter
+    {
+    public:
+        explicit awaiter(capture_stream *stream) noexcept : m_stream(stream) {}
+
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle) noexcept
+        {
+            std::lock_guard<std::mutex> lock(m_stream->m_lock);
+            if (!m_stream->m_captures.empty() || m_stream->m_closed)
+            {
+                return false;
+            }
+            m_stream->m_waiter = handle;
+            return true;
+        }
+
+        /** Returns the next capture, or an invalid capture once the stream is closed
+         */
+        capture await_resume() noexcept
+        {
+            std::lock_guard<std::mutex> lock(m_stream->m_lock);
+            if (m_stream->m_captures.empty())
+            {
+                return capture();
+            }
+            capture cap = std::move(m_stream->m_captures.front());
+            m_stream->m_captures.pop_front();
+            return cap;
+        }
+
+    private:
+        capture_stream *m_stream;
+    };
+
+    /** Starts delivering the captures of \p dev to the stream
+     * Throws error if the cameras of \p dev are running
+     *
+     * \p resumer resumes the waiting coroutine when a capture arrives. \p max_queued is the number of captures held
+     * before the oldest is dropped.
+     */
+    explicit capture_stream(device &dev, coroutine_resumer resumer = nullptr, size_t max_queued = 2) :
+        m_device(dev.handle()),
+        m_resumer(std::move(resumer)),
+        m_max_queued(max_queued == 0 ? 1 : max_queued)
+    {
+        dev.set_capture_callback(&capture_stream::on_capture, this);
+    }
+
+    // The stream is the context of the native callback, so it cannot move
+    capture_stream(const capture_stream &) = delete;
+    capture_stream &operator=(const capture_stream &) = delete;
+
+    ~capture_stream()
+    {
+        close();
+    }
+
+    /** Waits for the next capture
+     *
+     * co_await on the result gives the next capture, or an invalid capture once the stream is closed.
+     */
+    awaiter next_capture() noexcept
+    {
+        return awaiter(this);
+    }
+
+    /** Ends the stream and returns the device to device::get_capture()
+     *
+     * A coroutine waiting on the stream resumes with an invalid capture. Call this after device::stop_cameras().
+     */
+    void close() noexcept
+    {
+        std::coroutine_handle<> waiter;
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            if (m_closed)
+            {
+                return;
+            }
+            m_closed = true;
+            waiter = std::exchange(m_waiter, nullptr);
+        }
+
+        // Fails harmlessly if the device has already been closed
+        (void)k4a_device_set_capture_callback(m_device, nullptr, nullptr);
+
+        if (waiter)
+        {
+            resume(waiter);
+        }
+    }
+
+private:
+    static void on_capture(k4a_capture_t capture_handle, void *context)
+    {
+        capture_stream *stream = static_cast<capture_stream *>(context);
+
+        // The handle is only valid for the duration of the callback
+        k4a_capture_reference(capture_handle);
+        capture cap(capture_handle);
+
+        std::coroutine_handle<> waiter;
+        {
+            std::lock_guard<std::mutex> lock(stream->m_lock);
+            if (stream->m_closed)
+            {
+                return;
+            }
+            if (stream->m_captures.size() >= stream->m_max_queued)
+            {
+                stream->m_captures.pop_front();
+            }
+            stream->m_captures.push_back(std::move(cap));
+            waiter = std::exchange(stream->m_waiter, nullptr);
+        }
+
+        if (waiter)
+        {
+            stream->resume(waiter);
+        }
+    }
+
+    void resume(std::coroutine_handle<> handle)
+    {
+        if (m_resumer)
+        {
+            m_resumer(handle);
+        }
+        else
+        {
+            handle.resume();
+        }
+    }
+
+    k4a_device_t m_device;
+    coroutine_resumer m_resumer;
+    size_t m_max_queued;
+
+    std::mutex m_lock;
+    std::deque<capture> m_captures;
+    std::coroutine_handle<> m_waiter;
+    bool m_closed = false;
+};
+
+/**
+ * @}
+ */
+
+} // namespace k4a
+
+#endif
@@ -0,0 +1,74 @@
+/** \file k4a_unchecked.h
+ * Copyright (c) Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License.
+ * Kinect For Azure SDK - Inline accessors for image and capture views.
+ */
+
+#ifndef K4A_UNCHECKED_H
+#define K4A_UNCHECKED_H
+
+#include <k4a/k4a.h>
+
+#include <assert.h>
+
+/**
+ * \defgroup unchecked Unchecked accessors
+ *
+ * Inline accessors for the pixels of a k4a_image_view_t, for loops that run for every pixel or every frame.
+ *
+ * A view is filled in by a single call to k4a_image_get_view() or k4a_capture_get_view(), which validates the handles.
+ * The functions here read the view directly, without validating any handle or crossing into the SDK library. They do
+ * not check the image format, and coordinates are only checked with K4A_UNCHECKED_ASSERT(), which is assert() unless
+ * defined before this header is included. Release builds defining NDEBUG have no checks at all.
+ *
+ * Code that does not need this should keep to the k4a_image_get_*() functions, which validate every call.
+ *
+ * @{
+ */
+
+#ifndef K4A_UNCHECKED_ASSERT
+/** Checks the arguments of the accessors, define it before including this header to replace assert(). */
+#define K4A_UNCHECKED_ASSERT(condition) assert(condition)
+#endif
+
+/** Returns true if the view refers to an image, false for a missing image of a capture. */
+static inline bool k4a_image_view_is_valid(const k4a_image_view_t *view)
+{
+    return view->buffer != NULL;
+}
+
+/** Returns the first byte of row \p y of the image. */
+static inline uint8_t *k4a_image_view_row(const k4a_image_view_t *view, int y)
+{
+    K4A_UNCHECKED_ASSERT(view->buffer != NULL && view->stride_bytes > 0);
+    K4A_UNCHECKED_ASSERT(y >= 0 && y < view->height_pixels);
+    return view->buffer + (size_t)y * (size_t)view->stride_bytes;
+}
+
+/** Returns row \p y of a K4A_IMAGE_FORMAT_DEPTH16, K4A_IMAGE_FORMAT_IR16 or K4A_IMAGE_FORMAT_CUSTOM16 image. */
+static inline uint16_t *k4a_image_view_row_u16(const k4a_image_view_t *view, int y)
+{
+    return (uint16_t *)(void *)k4a_image_view_row(view, y);
+}
+
+/** Returns the pixel at \p x, \p y of a K4A_IMAGE_FORMAT_DEPTH16, K4A_IMAGE_FORMAT_IR16 or K4A_IMAGE_FORMAT_CUSTOM16
+ * image. */
+static inline uint16_t k4a_image_view_pixel_u16(const k4a_image_view_t *view, int x, int y)
+{
+    K4A_UNCHECKED_ASSERT(x >= 0 && x < view->width_pixels);
+    return k4a_image_view_row_u16(view, y)[x];
+}
+
+/** Returns the blue, green, red and alpha bytes of the pixel at \p x, \p y of a K4A_IMAGE_FORMAT_COLOR_BGRA32
+ * image. */
+static inline uint8_t *k4a_image_view_pixel_bgra32(const k4a_image_view_t *view, int x, int y)
+{
+    K4A_UNCHECKED_ASSERT(x >= 0 && x < view->width_pixels);
+    return k4a_image_view_row(view, y) + (size_t)x * 4;
+}
+
+/**
+ * @}
+ */
+
+#endif /* K4A_UNCHECKED_H */
@@ -194,6 +194,75 @@ K4A_DECLARE_HANDLE(k4a_image_t);
  */
 K4A_DECLARE_HANDLE(k4a_transformation_t);
 
+/**
+ * \class k4a_undistort_map_t
+ * Handle to an Azure Kinect undistortion map.
+ *
+ * \remarks
+ * Handles are created with k4a_transformation_create_undistort_map() and closed with k4a_undistort_map_destroy().
+ *
+ * \remarks
+ * An undistortion map holds the distorted image coordinates of every pixel of a pinhole image, so images of one camera
+ * can be undistorted repeatedly without evaluating the lens model per frame. The map holds its own copy of the camera
+ * calibration and remains valid after the transformation handle it was created with is destroyed.
+ *
+ * \remarks
+ * Invalid handles are set to 0.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_DECLARE_HANDLE(k4a_undistort_map_t);
+
+/**
+ * \class k4a_device_group_t
+ * Handle to a group of Azure Kinect devices streaming together.
+ *
+ * \remarks
+ * Handles are created with k4a_device_group_open() and closed with k4a_device_group_close().
+ *
+ * \remarks
+ * A group opens several devices, starts and stops their cameras in the order wired synchronization requires, and
+ * matches their captures by time so k4a_device_group_get_capture() returns one capture of each device taken at the
+ * same moment.
+ *
+ * \remarks
+ * Invalid handles are set to 0.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_DECLARE_HANDLE(k4a_device_group_t);
+
+/**
+ * \class k4a_buffer_ring_t
+ * Handle to a ring of buffers provided by the application.
+ *
+ * \remarks
+ * Handles are created with k4a_buffer_ring_create() and closed with k4a_buffer_ring_destroy().
+ *
+ * \remarks
+ * A buffer ring divides memory owned by the application, such as a shared memory segment, into slots of one size.
+ * Devices write the images of a stream straight into the slots with k4a_device_set_buffer_ring(), and releasing an
+ * image returns its slot to the ring.
+ *
+ * \remarks
+ * Invalid handles are set to 0.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_DECLARE_HANDLE(k4a_buffer_ring_t);
+
 /**
  *
  * @}
@@ -462,6 +531,134 @@ typedef enum
     K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR,      /**< Linear interpolation */
 } k4a_transformation_interpolation_type_t;
 
+/** Point cloud format.
+ *
+ * \remarks
+ * Layout of each point written by k4a_transformation_depth_image_to_formatted_point_cloud. X, Y and Z are in
+ * millimeters, and are 0 for pixels without depth.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef enum
+{
+    K4A_POINT_CLOUD_FORMAT_INT16_XYZ = 0, /**< Three int16_t values, 6 bytes, the default format */
+    K4A_POINT_CLOUD_FORMAT_FLOAT32_XYZ,   /**< Three float values, 12 bytes */
+    K4A_POINT_CLOUD_FORMAT_FLOAT32_XYZW,  /**< Three float values and a padding float of 0, 16 bytes */
+    K4A_POINT_CLOUD_FORMAT_FLOAT16_XYZ,   /**< Three IEEE half precision values, 6 bytes */
+    K4A_POINT_CLOUD_FORMAT_FLOAT16_XYZW,  /**< Three IEEE half precision values and a padding value of 0, 8 bytes */
+} k4a_point_cloud_format_t;
+
+/** Transformation backend.
+ *
+ * \remarks
+ * Implementation the transformations of a k4a_transformation_t run on, selected with k4a_transformation_set_backend.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef enum
+{
+    K4A_TRANSFORMATION_BACKEND_DEFAULT = 0, /**< The transform engine when the GPU is enabled, otherwise the CPU */
+    K4A_TRANSFORMATION_BACKEND_CPU,         /**< The CPU implementation */
+    K4A_TRANSFORMATION_BACKEND_OPENCL,      /**< OpenCL compute, see k4a_transformation_set_gpu_context */
+} k4a_transformation_backend_t;
+
+/** Depth to color transformation mode.
+ *
+ * \remarks
+ * How the CPU implementation of the depth to color transformations renders the depth image in the color camera,
+ * selected with k4a_transformation_set_depth_to_color_mode.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef enum
+{
+    K4A_TRANSFORMATION_DEPTH_TO_COLOR_MODE_QUADS = 0, /**< Fills the quads between neighboring depth pixels */
+    K4A_TRANSFORMATION_DEPTH_TO_COLOR_MODE_SPLAT,     /**< Each depth pixel writes the color pixel nearest to it */
+    K4A_TRANSFORMATION_DEPTH_TO_COLOR_MODE_SPLAT_2X2, /**< Each depth pixel writes the 2x2 color pixels around it */
+} k4a_transformation_depth_to_color_mode_t;
+
+/** Image pipeline stage.
+ *
+ * \remarks
+ * Stage of the SDK's streaming pipeline an image passed through, see k4a_image_get_stage_timestamp_nsec.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef enum
+{
+    K4A_IMAGE_STAGE_USB_ARRIVAL = 0,   /**< The host finished receiving the image, its system timestamp */
+    K4A_IMAGE_STAGE_DEPTH_ENGINE_DONE, /**< The depth engine produced the image, depth and IR images only */
+    K4A_IMAGE_STAGE_SYNC_DONE,         /**< The capture of the image was synchronized and queued for the user */
+    K4A_IMAGE_STAGE_USER_POP,          /**< The capture of the image was returned or passed to the capture callback */
+} k4a_image_stage_t;
+
+/** Colormap of k4a_image_colorize.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef enum
+{
+    K4A_COLORMAP_GREYSCALE = 0, /**< Black at the minimum of the range to white at the maximum */
+    K4A_COLORMAP_BLUE_TO_RED,   /**< Hue from blue at the minimum of the range to red at the maximum, 0 is black */
+} k4a_colormap_t;
+
+/** Transformation result kept in GPU memory.
+ *
+ * \remarks
+ * Output of the OpenCL transformation backend returned by k4a_transformation_get_gpu_output.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef enum
+{
+    K4A_TRANSFORMATION_GPU_OUTPUT_TRANSFORMED_DEPTH = 0, /**< Depth image in the geometry of the color camera */
+    K4A_TRANSFORMATION_GPU_OUTPUT_TRANSFORMED_CUSTOM,    /**< Custom image in the geometry of the color camera */
+    K4A_TRANSFORMATION_GPU_OUTPUT_TRANSFORMED_COLOR,     /**< Color image in the geometry of the depth camera */
+    K4A_TRANSFORMATION_GPU_OUTPUT_POINT_CLOUD,           /**< ::K4A_POINT_CLOUD_FORMAT_INT16_XYZ point cloud */
+} k4a_transformation_gpu_output_t;
+
+/** Kind of GPU resource a transformation result is written to.
+ *
+ * \remarks
+ * Type of the target passed to k4a_transformation_set_gpu_output_target.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef enum
+{
+    K4A_TRANSFORMATION_GPU_TARGET_NONE = 0,      /**< A buffer allocated by the transformation */
+    K4A_TRANSFORMATION_GPU_TARGET_OPENCL_BUFFER, /**< A cl_mem buffer of the OpenCL context of the transformation */
+    K4A_TRANSFORMATION_GPU_TARGET_OPENGL_BUFFER, /**< The name of an OpenGL buffer object, cast to a pointer */
+} k4a_transformation_gpu_target_t;
+
 /** Color and depth sensor frame rate.
  *
  * \remarks
@@ -645,6 +842,175 @@ typedef enum
                                      */
 } k4a_wired_sync_mode_t;
 
+/** What a streaming queue does with a capture that arrives while it is full.
+ *
+ * \see k4a_device_configuration_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef enum
+{
+    K4A_QUEUE_POLICY_DROP_OLDEST = 0, /**< Drop the oldest queued capture to make room for the new one. */
+    K4A_QUEUE_POLICY_DROP_NEWEST,     /**< Drop the new capture and keep the queued ones. */
+    K4A_QUEUE_POLICY_BLOCK,           /**< Wait for room, which holds up the stage producing the captures. */
+} k4a_queue_policy_t;
+
+/** Sources of SDK memory allocations.
+ *
+ * \see k4a_get_allocator_stats()
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef enum
+{
+    K4A_ALLOCATION_SOURCE_USER = 0,  /**< Application images and k4a_transformation_create_with_allocator() tables. */
+    K4A_ALLOCATION_SOURCE_DEPTH,     /**< Depth and IR images produced by the depth engine. */
+    K4A_ALLOCATION_SOURCE_COLOR,     /**< Color images. */
+    K4A_ALLOCATION_SOURCE_IMU,       /**< IMU samples. */
+    K4A_ALLOCATION_SOURCE_USB_DEPTH, /**< Raw depth USB transfers. */
+    K4A_ALLOCATION_SOURCE_USB_IMU,   /**< Raw IMU USB transfers. */
+    K4A_ALLOCATION_SOURCE_COUNT,     /**< Number of allocation sources. */
+} k4a_allocation_source_t;
+
+/** Memory statistics for one allocation source.
+ *
+ * \see k4a_get_allocator_stats()
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef struct _k4a_allocator_stats_t
+{
+    uint32_t buffer_count;           /**< Buffers currently allocated and not yet freed. */
+    uint64_t allocated_bytes;        /**< Bytes currently allocated, excluding SDK bookkeeping. */
+    uint64_t peak_allocated_bytes;   /**< Highest value of allocated_bytes since the process started. */
+    uint64_t total_allocation_count; /**< Allocations made since the process started. */
+    float allocations_per_second;    /**< Allocation rate over the most recent measurement window of about 1 second. */
+} k4a_allocator_stats_t;
+
+/** Threads created by the SDK whose scheduling can be configured.
+ *
+ * \see k4a_set_thread_policy()
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef enum
+{
+    K4A_SDK_THREAD_DEPTH_USB = 0,    /**< Services the USB transfers of the depth stream. */
+    K4A_SDK_THREAD_IMU_USB,          /**< Services the USB transfers of the IMU stream. */
+    K4A_SDK_THREAD_DEPTH_ENGINE,     /**< Converts raw depth frames into depth and IR images. */
+    K4A_SDK_THREAD_TRANSFORM_ENGINE, /**< Runs GPU accelerated transformations. */
+    K4A_SDK_THREAD_COLOR_READER,     /**< Delivers color frames. Only supported on Linux, where the thread is owned by
+                                        libuvc and the policy is applied when the first frame of a stream arrives. */
+    K4A_SDK_THREAD_RECORD_WRITER,    /**< Writes recordings to disk in k4arecord. */
+    K4A_SDK_THREAD_TRANSFORMATION,   /**< Runs the asynchronous transformations of a k4a_transformation_t. */
+    K4A_SDK_THREAD_POOL,             /**< Workers of the shared SDK thread pool, see k4a_set_thread_pool_options(). */
+    K4A_SDK_THREAD_COUNT,            /**< Number of configurable threads. */
+} k4a_sdk_thread_t;
+
+/** Scheduling priority for an SDK thread.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef enum
+{
+    K4A_THREAD_PRIORITY_DEFAULT = 0,  /**< Leave the priority the thread was created with. */
+    K4A_THREAD_PRIORITY_ABOVE_NORMAL, /**< Raised priority within the normal scheduling class. */
+    K4A_THREAD_PRIORITY_HIGHEST,      /**< Highest priority within the normal scheduling class. */
+    K4A_THREAD_PRIORITY_REALTIME, /**< Real-time class. SCHED_FIFO on Linux, which requires CAP_SYS_NICE, and
+                                     THREAD_PRIORITY_TIME_CRITICAL on Windows. */
+} k4a_thread_priority_t;
+
+/** Scheduling policy applied to an SDK thread when it starts.
+ *
+ * \see k4a_set_thread_policy()
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef struct _k4a_thread_policy_t
+{
+    /** CPUs the thread may run on, bit N selects CPU N. 0 leaves the affinity the thread was created with. */
+    uint64_t cpu_affinity_mask;
+
+    k4a_thread_priority_t priority; /**< Scheduling priority of the thread. */
+} k4a_thread_policy_t;
+
+/** Task of the SDK thread pool.
+ *
+ * \param task_context
+ * Context the task was submitted with.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef void(k4a_thread_pool_task_t)(void *task_context);
+
+/** External executor the SDK thread pool hands its tasks to.
+ *
+ * \param task
+ * Task to call exactly once, on a thread other than the one submitting it.
+ *
+ * \param task_context
+ * Context to pass to \p task.
+ *
+ * \param executor_context
+ * The executor_context of the ::k4a_thread_pool_options_t the executor was set with.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef void(k4a_thread_pool_executor_t)(k4a_thread_pool_task_t *task, void *task_context, void *executor_context);
+
+/** Options of the SDK thread pool.
+ *
+ * \see k4a_set_thread_pool_options()
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef struct _k4a_thread_pool_options_t
+{
+    /** Worker threads of the pool, up to 256. 0 starts one per CPU. */
+    uint32_t thread_count;
+
+    /** Executor to run the tasks on instead of the pool's threads. NULL uses the pool's threads. */
+    k4a_thread_pool_executor_t *executor;
+
+    void *executor_context; /**< Passed to every call of executor. */
+} k4a_thread_pool_options_t;
+
 /** Calibration types.
  *
  * Specifies a type of calibration.
@@ -891,31 +1257,151 @@ typedef void(k4a_memory_destroy_cb_t)(void *buffer, void *context);
  */
 typedef uint8_t *(k4a_memory_allocate_cb_t)(int size, void **context);
 
-/**
+/** Callback function for a memory allocation made on behalf of one device or transformation.
  *
- * @}
+ * \param size
+ * Minimum size in bytes needed for the buffer.
  *
- * \defgroup Structures Structures
- * \ingroup csdk
+ * \param source
+ * The part of the SDK the memory is allocated for.
  *
- * Structures used in the API.
+ * \param allocator_context
+ * The context provided with the callback to k4a_device_set_allocator() or k4a_transformation_set_allocator().
+ *
+ * \param context
+ * Output parameter for a context that will be provided in the subsequent call to the \ref k4a_memory_destroy_cb_t
+ * callback.
+ *
+ * \return
+ * A pointer to the newly allocated memory.
+ *
+ * \remarks
+ * A callback of this type is provided when an application defined allocator is used for a single device or
+ * transformation, for example to allocate from memory local to the NUMA node that consumes the data.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
  *
- * @{
  */
+typedef uint8_t *(k4a_memory_allocate_source_cb_t)(int size,
+                                                   k4a_allocation_source_t source,
+                                                   void *allocator_context,
+                                                   void **context);
 
-/** Configuration parameters for an Azure Kinect device.
+/** Callback function for a capture delivered by the device.
+ *
+ * \param capture_handle
+ * The capture that is ready. The capture is only valid until the callback returns, call k4a_capture_reference() to
+ * keep it beyond that and k4a_capture_release() when done with it.
+ *
+ * \param context
+ * The context supplied with the callback to k4a_device_set_capture_callback().
  *
  * \remarks
- * Used by k4a_device_start_cameras() to specify the configuration of the data capture.
+ * The callback is called on an SDK thread, one capture at a time and in the order the captures would have been
+ * returned by k4a_device_get_capture(). No further captures are processed while it runs, so it should return quickly.
  *
  * \xmlonly
  * <requirements>
  *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
  * </requirements>
  * \endxmlonly
+ *
  */
-typedef struct _k4a_device_configuration_t
-{
+typedef void(k4a_capture_ready_cb_t)(k4a_capture_t capture_handle, void *context);
+
+/** Callback function for an IMU sample delivered by the device.
+ *
+ * \param imu_sample
+ * The sample that is ready, only valid until the callback returns.
+ *
+ * \param context
+ * The context supplied with the callback to k4a_device_set_imu_callback().
+ *
+ * \remarks
+ * The callback is called on an SDK thread, one sample at a time and in the order the samples were received. No further
+ * IMU data is processed while it runs, so it should return quickly.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ *
+ */
+struct _k4a_imu_sample_t; // Defined with k4a_imu_sample_t below
+typedef void(k4a_imu_sample_ready_cb_t)(const struct _k4a_imu_sample_t *imu_sample, void *context);
+
+/** Operating system object that is signaled while a device stream has data to read.
+ *
+ * \remarks
+ * On Windows this is an event HANDLE that can be passed to WaitForSingleObject() or WaitForMultipleObjects(). On
+ * other platforms it is a file descriptor that polls as readable with poll(), select() or epoll. The handle is owned
+ * by the SDK, it must not be closed, read from or written to by the caller.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+#ifdef _WIN32
+typedef void *k4a_wait_handle_t;
+#else
+typedef int k4a_wait_handle_t;
+#endif
+
+/** Callback function for a completed asynchronous transformation.
+ *
+ * \param result
+ * The result the synchronous version of the transformation would have returned.
+ *
+ * \param context
+ * The context supplied with the callback to the asynchronous transformation function.
+ *
+ * \remarks
+ * The callback is called on an SDK thread owned by the transformation handle, one transformation at a time and in the
+ * order they were queued. The SDK releases its references to the images after the callback returns. Destroying the
+ * transformation handle from the callback defers its release until the transformations still queued have completed,
+ * see k4a_transformation_destroy().
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ *
+ */
+typedef void(k4a_transformation_complete_cb_t)(k4a_result_t result, void *context);
+
+/**
+ *
+ * @}
+ *
+ * \defgroup Structures Structures
+ * \ingroup csdk
+ *
+ * Structures used in the API.
+ *
+ * @{
+ */
+
+/** Configuration parameters for an Azure Kinect device.
+ *
+ * \remarks
+ * Used by k4a_device_start_cameras() to specify the configuration of the data capture.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef struct _k4a_device_configuration_t
+{
     /** Image format to capture with the color camera.
      *
      * The color camera does not natively produce BGRA32 images.
@@ -985,6 +1471,128 @@ typedef struct _k4a_device_configuration_t
     bool disable_streaming_indicator;
 } k4a_device_configuration_t;
 
+/** Streaming options of an Azure Kinect device that are not part of k4a_device_configuration_t.
+ *
+ * \remarks
+ * Set with k4a_device_set_start_options() and used by the following calls to k4a_device_start_cameras(). Initialize
+ * the structure with ::K4A_DEVICE_START_OPTIONS_INIT before changing its fields.
+ *
+ * \remarks
+ * Fields are only ever appended to this structure. struct_size tells the SDK which fields the caller knows of, the
+ * fields past it keep their defaults.
+ *
+ * \see k4a_device_set_start_options()
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef struct _k4a_device_start_options_t
+{
+    /** Size of the structure in bytes, set to sizeof(k4a_device_start_options_t) by ::K4A_DEVICE_START_OPTIONS_INIT. */
+    uint32_t struct_size;
+
+    /**
+     * Only produce depth images, captures will not contain an IR image.
+     *
+     * \details
+     * Skipping the IR image halves the memory used by each depth frame. With a depth engine that supports it the IR
+     * image is not read back from the GPU either.
+     *
+     * \details
+     * Requires a depth_mode that produces depth images, so it can't be combined with ::K4A_DEPTH_MODE_PASSIVE_IR. */
+    bool depth_image_only;
+
+    /**
+     * Number of raw depth frames buffered for the depth engine, 0 for the default of 2.
+     *
+     * \details
+     * A deeper queue rides out depth engine stalls, such as a GPU that is busy with other work, at the cost of memory
+     * and latency. */
+    uint32_t depth_engine_queue_depth;
+
+    /**
+     * What happens to a raw depth frame that arrives while the depth engine queue is full.
+     *
+     * \details
+     * ::K4A_QUEUE_POLICY_BLOCK holds up the USB transfers of the depth camera until the depth engine catches up, which
+     * also holds up every device sharing their USB event thread. */
+    k4a_queue_policy_t depth_engine_queue_policy;
+
+    /**
+     * Number of captures buffered for k4a_device_get_capture(), 0 for the default of 7.
+     *
+     * \details
+     * Captures delivered to a k4a_device_set_capture_callback() callback are not queued. */
+    uint32_t capture_queue_depth;
+
+    /**
+     * What happens to a capture that is ready while the capture queue is full.
+     *
+     * \details
+     * ::K4A_QUEUE_POLICY_BLOCK holds up the depth engine and the color camera until the application reads a capture, so
+     * frames are then dropped by the stages before it. */
+    k4a_queue_policy_t capture_queue_policy;
+
+    /**
+     * Deliver the raw depth payloads of the sensor instead of running the depth engine.
+     *
+     * \details
+     * The depth image of each capture is a ::K4A_IMAGE_FORMAT_CUSTOM image holding the payload as read from USB, and
+     * captures don't contain an IR image. The payload is turned into depth and IR images later, by recording it and
+     * playing the recording back, which needs the depth calibration of k4a_device_get_raw_depth_calibration().
+     *
+     * \details
+     * The device timestamp of the payload is only known to the depth engine, the image is given an estimate from its
+     * system timestamp. Requires a depth_mode other than ::K4A_DEPTH_MODE_OFF, and can't be combined with
+     * depth_image_only. */
+    bool raw_depth_payload;
+
+    /**
+     * Attach the IMU samples taken since the previous capture to each capture.
+     *
+     * \details
+     * Each capture is given the calibrated samples with an accelerometer timestamp up to its own device timestamp,
+     * which is the one of its depth or IR image or, without either, of its color image. Read them with
+     * k4a_capture_get_imu_samples_image(). The IMU must be started with k4a_device_start_imu() for samples to arrive.
+     *
+     * \details
+     * The samples are still delivered to k4a_device_get_imu_sample() or the IMU callback as well. */
+    bool attach_imu_samples;
+
+    /**
+     * Deliver only one of every depth_delivery_divisor depth frames, 0 or 1 to deliver every frame.
+     *
+     * \details
+     * Frames that are not delivered are dropped as they arrive from USB, before the depth engine processes them, so a
+     * lower depth rate than camera_fps saves GPU time. The first frame of the stream is delivered. With
+     * k4a_device_configuration_t::synchronized_images_only, color images are only delivered together with a depth
+     * frame. */
+    uint32_t depth_delivery_divisor;
+
+    /**
+     * Keep only the most recent capture for k4a_device_get_capture().
+     *
+     * \details
+     * The capture queue holds a single capture, which a new capture replaces. A consumer that falls behind gets the
+     * newest capture on its next read instead of the backlog. This is the same as a capture_queue_depth of 1 with
+     * ::K4A_QUEUE_POLICY_DROP_OLDEST, which capture_queue_depth and capture_queue_policy must then be left at or set
+     * to. */
+    bool latest_capture_only;
+
+    /**
+     * Pre-allocate and pre-fault the streaming buffers and warm up the depth engine before the cameras start.
+     *
+     * \details
+     * The pooled USB transfer buffers, depth engine output buffers and color image buffers are written to so the
+     * operating system commits their pages, the pool of capture objects is filled and a blank raw frame is run through
+     * the depth engine. The first frames are then delivered with steady state latency instead of paying for page
+     * faults and first use costs, at the price of a longer k4a_device_start_cameras(). */
+    bool prefault_buffers;
+} k4a_device_start_options_t;
+
 /** Extrinsic calibration data.
  *
  * \remarks
@@ -1130,6 +1738,33 @@ typedef struct _k4a_version_t
     uint32_t iteration; /**< Reserved. */
 } k4a_version_t;
 
+/** Size of the serial number buffer of \ref k4a_installed_device_t, including the NULL terminator.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+#define K4A_DEVICE_SERIAL_NUMBER_MAX_LENGTH (26)
+
+/** A device connected to the PC, returned by k4a_device_enumerate().
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef struct _k4a_installed_device_t
+{
+    uint32_t index; /**< Index to pass to k4a_device_open(). */
+
+    /** NULL terminated serial number, empty if the device is in use by another process and its serial number was not
+     * read before. */
+    char serial_number[K4A_DEVICE_SERIAL_NUMBER_MAX_LENGTH];
+} k4a_installed_device_t;
+
 /** Structure to define hardware version.
  *
  * \xmlonly
@@ -1149,6 +1784,115 @@ typedef struct _k4a_hardware_version_t
     k4a_firmware_signature_t firmware_signature; /**< Signature type of the firmware. */
 } k4a_hardware_version_t;
 
+/** Limits on the USB transfers used to stream depth data.
+ *
+ * \remarks
+ * Each transfer carries one complete depth frame, so its size is set by the depth mode. These limits control how many
+ * frames can be in flight between the device and the host, trading host memory against tolerance to scheduling
+ * delays on a busy USB controller.
+ *
+ * \see k4a_device_set_usb_streaming_options()
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef struct _k4a_usb_streaming_options_t
+{
+    /** Upper limit on the number of outstanding transfers, up to 32. 0 uses the SDK default of 8. */
+    uint32_t max_transfer_count;
+
+    /** Upper limit, in bytes, on the memory used by outstanding transfers. 0 uses the SDK default, which may be
+     * overridden with the K4A_MAX_LIBUSB_POOL environment variable. */
+    size_t max_transfer_pool_size;
+} k4a_usb_streaming_options_t;
+
+/** Rectangle of pixels in an image.
+ *
+ * \remarks
+ * Covers columns [x, x + width) of rows [y, y + height).
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef struct _k4a_rect_t
+{
+    int32_t x;      /**< Left column */
+    int32_t y;      /**< Top row */
+    int32_t width;  /**< Width in pixels */
+    int32_t height; /**< Height in pixels */
+} k4a_rect_t;
+
+/** Intrinsics of an ideal pinhole camera without lens distortion.
+ *
+ * \remarks
+ * A point (x, y, z) of the camera is at pixel (fx * x / z + px, fy * y / z + py) of the width by height image.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef struct _k4a_pinhole_t
+{
+    float px;       /**< Principal point x in pixels */
+    float py;       /**< Principal point y in pixels */
+    float fx;       /**< Focal length x in pixels */
+    float fy;       /**< Focal length y in pixels */
+    int32_t width;  /**< Width of the image in pixels */
+    int32_t height; /**< Height of the image in pixels */
+} k4a_pinhole_t;
+
+/** Unprojection tables of a camera, one entry per pixel.
+ *
+ * \remarks
+ * The pixel at column u and row v with depth d in millimeters is the point (d * x_table[i], d * y_table[i], d) of the
+ * camera, with i = v * width + u. x_table holds NAN, and y_table 0, for pixels that do not unproject to a valid ray.
+ *
+ * \remarks
+ * The tables are owned by the k4a_transformation_t they were read from and are valid until it is destroyed. They must
+ * not be written to. x_table is aligned to 16 bytes.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef struct _k4a_xy_table_t
+{
+    const float *x_table; /**< X coordinate of each pixel's ray at a depth of 1 */
+    const float *y_table; /**< Y coordinate of each pixel's ray at a depth of 1 */
+    int32_t width;        /**< Width of the camera image in pixels */
+    int32_t height;       /**< Height of the camera image in pixels */
+} k4a_xy_table_t;
+
+/** One device of a fused point cloud.
+ *
+ * \remarks
+ * A point p of the depth camera of the device is the point rotation * p + translation of the common frame, with
+ * rotation and translation from \p depth_to_common.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef struct _k4a_point_cloud_fusion_input_t
+{
+    k4a_transformation_t transformation_handle;   /**< Transformation of the calibration of the device */
+    k4a_image_t depth_image;                      /**< Depth image of the device */
+    k4a_image_t color_image;                      /**< Color in the depth camera geometry, or NULL without color */
+    k4a_calibration_extrinsics_t depth_to_common; /**< Depth camera to the common frame, in millimeters */
+} k4a_point_cloud_fusion_input_t;
+
 /** Two dimensional floating point vector.
  *
  * \xmlonly
@@ -1205,6 +1949,312 @@ typedef struct _k4a_imu_sample_t
     uint64_t gyro_timestamp_usec; /**< Timestamp of the gyroscope in microseconds */
 } k4a_imu_sample_t;
 
+/** Motion of the IMU between two device timestamps, integrated from its samples.
+ *
+ * \remarks
+ * The motion is integrated in the accelerometer coordinate system, with the gyroscope rotation rates turned into it by
+ * the calibration. The delta values are expressed in the coordinate system of the IMU at start_timestamp_usec.
+ *
+ * \remarks
+ * Gravity is not removed from the accelerometer samples and the velocity at the start is not known to the SDK. With g
+ * the gravity and v the velocity at the start, both in the start coordinate system, and dt the duration, the device
+ * moved by v * dt + delta_position + g * dt * dt / 2 and its velocity changed by delta_velocity + g * dt.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef struct _k4a_imu_preintegration_t
+{
+    uint64_t start_timestamp_usec; /**< Device timestamp the motion starts at, in microseconds. */
+    uint64_t end_timestamp_usec;   /**< Device timestamp the motion ends at, in microseconds. */
+    float delta_rotation[4];       /**< Unit quaternion w, x, y, z from the IMU at the end to the IMU at the start. */
+    k4a_float3_t delta_velocity;   /**< Integrated acceleration in meters per second. */
+    k4a_float3_t delta_position;   /**< Doubly integrated acceleration in meters. */
+    uint32_t sample_count;         /**< Number of samples after the start and up to the end. */
+} k4a_imu_preintegration_t;
+
+/** Image metadata returned by k4a_image_get_info().
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef struct _k4a_image_info_t
+{
+    k4a_image_format_t format;      /**< Format of the image. */
+    int width_pixels;               /**< Width of the image in pixels. */
+    int height_pixels;              /**< Height of the image in pixels. */
+    int stride_bytes;               /**< Stride of the image in bytes, 0 for compressed formats. */
+    size_t size;                    /**< Size of the image buffer in bytes. */
+    uint64_t device_timestamp_usec; /**< Device timestamp in microseconds. */
+    uint64_t system_timestamp_nsec; /**< System timestamp in nanoseconds. */
+    uint64_t exposure_usec;         /**< Exposure time in microseconds, 0 if not available. */
+    uint32_t white_balance;         /**< White balance in Kelvin, color images only, 0 if not available. */
+    uint32_t iso_speed;             /**< ISO speed, color images only, 0 if not available. */
+} k4a_image_info_t;
+
+/** Layout version of k4a_image_view_t and k4a_capture_view_t in this header.
+ *
+ * \remarks
+ * Passed to k4a_image_get_view() and k4a_capture_get_view(). Later versions only append fields, so an application
+ * built against this header keeps working with newer SDK binaries.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+#define K4A_VIEW_VERSION (1)
+
+/** Image buffer and layout returned by k4a_image_get_view() for per pixel loops.
+ *
+ * \remarks
+ * The fields are a copy taken when the view was filled in, they are only valid while the application holds a
+ * reference to the image. A view of a missing image has a NULL buffer and every other field set to 0.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef struct _k4a_image_view_t
+{
+    uint8_t *buffer;                /**< First byte of the image, NULL if there is no image. */
+    size_t size;                    /**< Size of the image buffer in bytes. */
+    k4a_image_format_t format;      /**< Format of the image. */
+    int width_pixels;               /**< Width of the image in pixels. */
+    int height_pixels;              /**< Height of the image in pixels. */
+    int stride_bytes;               /**< Stride of the image in bytes, 0 for compressed formats. */
+    uint64_t device_timestamp_usec; /**< Device timestamp in microseconds. */
+    uint64_t system_timestamp_nsec; /**< System timestamp in nanoseconds. */
+} k4a_image_view_t;
+
+/** Views of the images of a capture returned by k4a_capture_get_view().
+ *
+ * \remarks
+ * The images are not referenced by the view, it is only valid while the application holds a reference to the capture
+ * and does not replace its images.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef struct _k4a_capture_view_t
+{
+    k4a_image_view_t color; /**< The color image. */
+    k4a_image_view_t depth; /**< The depth image. */
+    k4a_image_view_t ir;    /**< The IR image. */
+    float temperature_c;    /**< Temperature of the device in Celsius, NAN if not available. */
+} k4a_capture_view_t;
+
+/** Depth engine GPU statistics returned by k4a_device_get_depth_engine_gpu_statistics().
+ *
+ * \remarks
+ * The counters cover every device whose depth engine runs on the same GPU.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef struct _k4a_depth_engine_gpu_statistics_t
+{
+    int32_t gpu_index;                /**< GPU index, ::K4A_DEPTH_ENGINE_GPU_DEFAULT when the depth engine chose it. */
+    uint32_t depth_engine_count;      /**< Number of depth engines currently running on the GPU. */
+    uint32_t frames_in_flight;        /**< Frames currently being processed or waiting for the GPU. */
+    uint64_t frames_processed;        /**< Frames processed on the GPU since the process started. */
+    uint32_t average_compute_time_ms; /**< Average time to process a frame in milliseconds. */
+    uint32_t max_compute_time_ms;     /**< Longest time to process a frame in milliseconds. */
+} k4a_depth_engine_gpu_statistics_t;
+
+/** Depth post-processing filters passed to k4a_device_set_depth_filter().
+ *
+ * \remarks
+ * The enabled filters run in the order of this structure on each depth image, after the depth engine and before the
+ * capture is published. Depth differences are in millimeters, invalid pixels have a depth of 0.
+ *
+ * \remarks
+ * Use ::K4A_DEPTH_FILTER_CONFIG_INIT_DISABLE_ALL to initialize the parameters to typical values.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef struct _k4a_depth_filter_configuration_t
+{
+    bool flying_pixel_filter;           /**< Invalidate pixels far from both of their neighbors on a row or column. */
+    uint16_t flying_pixel_threshold_mm; /**< Difference beyond which a neighbor is on another surface. */
+    bool edge_preserving_filter;        /**< Average each valid pixel with its 3x3 neighbors on the same surface. */
+    uint16_t edge_threshold_mm;         /**< Neighbors differing from the pixel by more are left out of the average. */
+    bool temporal_filter;               /**< Blend each pixel with its depth in the previous frames. */
+    float temporal_alpha;               /**< Weight of the new depth in the blend, greater than 0 and at most 1. */
+    uint16_t temporal_threshold_mm;     /**< Larger changes restart the blend at the new depth. */
+    uint16_t hole_fill_frames; /**< Frames an invalid pixel keeps its blended depth for, temporal filter only. */
+} k4a_depth_filter_configuration_t;
+
+/** Region and resolution of the BGRA32 images decoded from MJPG color frames.
+ *
+ * \remarks
+ * Passed to k4a_device_set_color_decode() and k4a_playback_set_color_decode(). The crop is in pixels of the full
+ * resolution image, a width or height of 0 selects the full image. The output image covers the crop, divided on each
+ * axis by scale_denominator and rounded up.
+ *
+ * \remarks
+ * Scaling is part of the JPEG decode, so decoding at a reduced scale is several times faster than decoding the full
+ * image. Use ::K4A_COLOR_DECODE_CONFIG_INIT_FULL_RESOLUTION to initialize the configuration.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef struct _k4a_color_decode_configuration_t
+{
+    uint32_t scale_denominator; /**< Output scale of 1/scale_denominator, which is 1, 2, 4 or 8. */
+    k4a_rect_t crop;            /**< Region to output, x and y are multiples of scale_denominator. Empty for all. */
+} k4a_color_decode_configuration_t;
+
+/** Number of buckets in k4a_device_statistics_t capture_latency_histogram.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+#define K4A_DEVICE_STATISTICS_LATENCY_BUCKETS (16)
+
+/** Device streaming statistics returned by k4a_device_get_statistics().
+ *
+ * \remarks
+ * Counters accumulate from k4a_device_open(). Compute times are measured with a resolution of 1 millisecond.
+ *
+ * \remarks
+ * Capture latency is measured from the earliest system timestamp of a capture's images, taken when the host received
+ * the image, until the capture is returned by k4a_device_get_capture() or passed to the capture callback.
+ * capture_latency_histogram[0] counts captures delivered in less than 1 millisecond, capture_latency_histogram[i]
+ * those delivered in [2^(i-1), 2^i) milliseconds and the last bucket everything slower.
+ *
+ * \remarks
+ * The open and start times break down the last k4a_device_open() and k4a_device_start_cameras() calls. Some of their
+ * phases run in parallel, so the phases can add up to more than the total.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef struct _k4a_device_statistics_t
+{
+    uint64_t depth_engine_frame_count;             /**< Depth frames processed by the depth engine. */
+    uint32_t depth_engine_min_compute_time_ms;     /**< Shortest depth engine processing time. */
+    uint32_t depth_engine_average_compute_time_ms; /**< Average depth engine processing time. */
+    uint32_t depth_engine_p99_compute_time_ms;     /**< 99th percentile of the depth engine processing time. */
+    uint32_t depth_engine_max_compute_time_ms;     /**< Longest depth engine processing time. */
+    uint32_t depth_engine_overrun_count;           /**< Depth frames that took longer than the frame period. */
+    uint32_t depth_engine_dropped_count;           /**< Raw depth frames dropped as the depth engine fell behind. */
+    uint32_t capturesync_dropped_count;            /**< Captures dropped while synchronizing depth and color. */
+    uint32_t capture_queue_dropped_count;          /**< Captures the application did not read in time. */
+    uint32_t usb_timeout_count;                    /**< Depth USB transfers that timed out. */
+    uint32_t usb_transfer_count;                   /**< Depth USB transfers the current or last stream submitted. */
+    uint32_t usb_pool_size;                        /**< Buffers pre-allocated for the current or last depth stream. */
+    uint32_t usb_pool_recycled_count;              /**< Depth USB transfers resubmitted with a pooled buffer. */
+    uint32_t usb_pool_exhausted_count;             /**< Depth USB transfers that allocated as the pool was empty. */
+    uint64_t depth_capture_count;                  /**< Depth captures received from the depth engine. */
+    uint64_t color_capture_count;                  /**< Color captures received from the color camera. */
+    uint64_t synchronized_capture_count;           /**< Captures published with both a color and a depth image. */
+    uint64_t delivered_capture_count;              /**< Captures delivered to the application. */
+    uint32_t capture_latency_min_usec;             /**< Shortest capture latency. */
+    uint32_t capture_latency_average_usec;         /**< Average capture latency. */
+    uint32_t capture_latency_max_usec;             /**< Longest capture latency. */
+    uint64_t imu_sample_count;                     /**< IMU samples received. */
+    uint32_t imu_dropped_count;                    /**< IMU samples overwritten before the application read them. */
+
+    /** Capture latencies, see remarks. */
+    uint32_t capture_latency_histogram[K4A_DEVICE_STATISTICS_LATENCY_BUCKETS];
+
+    uint32_t open_time_usec;                   /**< Time k4a_device_open() took. */
+    uint32_t open_depth_mcu_time_usec;         /**< Time until the depth MCU was ready for commands. */
+    uint32_t open_calibration_time_usec;       /**< Time downloading the calibration. */
+    uint32_t open_color_time_usec;             /**< Time opening the color MCU and the color camera. */
+    uint32_t open_depth_engine_load_time_usec; /**< Time loading the depth engine plugin. */
+    uint32_t open_imu_time_usec;               /**< Time setting up the IMU. */
+    uint32_t start_time_usec;                  /**< Time k4a_device_start_cameras() took. */
+    uint32_t start_depth_time_usec;            /**< Time starting the depth engine and the depth stream. */
+    uint32_t start_color_time_usec;            /**< Time starting the color camera. */
+    uint32_t first_capture_time_usec;          /**< Time from the start of the cameras to the first capture, or 0. */
+} k4a_device_statistics_t;
+
+/** Model of the device clock in the clock of the image system timestamps.
+ *
+ * \remarks
+ * A device timestamp t maps to the system timestamp reference_system_timestamp_nsec + (t -
+ * reference_device_timestamp_usec) * 1000 * (1 + drift_ppm / 1000000). The same mapping is applied by
+ * k4a_device_convert_device_timestamp().
+ *
+ * \see k4a_device_get_clock_model()
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef struct _k4a_device_clock_model_t
+{
+    uint64_t reference_device_timestamp_usec; /**< Device timestamp the model is anchored at. */
+    uint64_t reference_system_timestamp_nsec; /**< System timestamp of the reference device timestamp. */
+
+    /** How much faster the system clock runs than the device clock, in parts per million. 0 until the model spans two
+     * windows. */
+    double drift_ppm;
+
+    /** Root mean square distance of the windows from the model, in microseconds. */
+    double residual_usec;
+
+    uint32_t window_count; /**< Windows of device time the model is fitted to. */
+    uint64_t sample_count; /**< Samples added since the model started. */
+} k4a_device_clock_model_t;
+
+/** Matching counters of a device group.
+ *
+ * \remarks
+ * The counters cover the time since k4a_device_group_open() and only increase.
+ *
+ * \see k4a_device_group_get_statistics()
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef struct _k4a_device_group_statistics_t
+{
+    uint64_t group_capture_count; /**< Group captures returned by k4a_device_group_get_capture(). */
+
+    /** Captures dropped because the other devices had no capture at the same time, such as when one of them dropped
+     * a frame. */
+    uint64_t unmatched_drop_count;
+
+    /** Captures dropped because the group captures were not read fast enough. */
+    uint64_t overflow_drop_count;
+} k4a_device_group_statistics_t;
+
 /**
  *
  * @}
@@ -1239,6 +2289,69 @@ typedef struct _k4a_imu_sample_t
  */
 #define K4A_WAIT_INFINITE (-1)
 
+/** Value of a k4a_wait_handle_t that does not refer to an operating system object.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+#ifdef _WIN32
+#define K4A_WAIT_HANDLE_INVALID ((k4a_wait_handle_t)0)
+#else
+#define K4A_WAIT_HANDLE_INVALID ((k4a_wait_handle_t)-1)
+#endif
+
+/** Lets the depth engine choose the GPU, passed to k4a_device_set_depth_engine_gpu().
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+#define K4A_DEPTH_ENGINE_GPU_DEFAULT (-1)
+
+/** Assigns the next GPU in turn each time the cameras start, passed to k4a_device_set_depth_engine_gpu().
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+#define K4A_DEPTH_ENGINE_GPU_ROUND_ROBIN (-2)
+
+/** Alignment in bytes of image buffers allocated by the SDK.
+ *
+ * \remarks
+ * Applies to images created with k4a_image_create() and to the depth, IR and color buffers produced by the SDK,
+ * including when an allocator is set with k4a_set_allocator(). Depth, IR and BGRA images produced by the SDK also
+ * have a stride that is a multiple of this value. Use k4a_image_create_aligned() for larger alignments.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+#define K4A_IMAGE_BUFFER_ALIGNMENT (64)
+
+/** Bytes of a k4a_buffer_ring_t slot used by the SDK in front of the images a device writes into it.
+ *
+ * \remarks
+ * Slots of a ring set with k4a_device_set_buffer_ring() must be larger than the largest image of the stream by this
+ * many bytes. The image buffer starts at the same offset, at most this many bytes, in every slot.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+#define K4A_BUFFER_RING_SLOT_OVERHEAD (96)
+
 /** Initial configuration setting for disabling all sensors.
  *
  * \remarks
@@ -1260,6 +2373,55 @@ static const k4a_device_configuration_t K4A_DEVICE_CONFIG_INIT_DISABLE_ALL = { K
                                                                                0,
                                                                                false };
 
+/** Initial start options, with every option at its default.
+ *
+ * \remarks
+ * Use this setting to initialize a \ref k4a_device_start_options_t, which sets its struct_size, before changing the
+ * options to use.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+static const k4a_device_start_options_t K4A_DEVICE_START_OPTIONS_INIT = { sizeof(k4a_device_start_options_t),
+                                                                         false,
+                                                                         0,
+                                                                         K4A_QUEUE_POLICY_DROP_OLDEST,
+                                                                         0,
+                                                                         K4A_QUEUE_POLICY_DROP_OLDEST,
+                                                                         false,
+                                                                         false,
+                                                                         0,
+                                                                         false,
+                                                                         false };
+
+/** Initial depth filter configuration with every filter disabled.
+ *
+ * \remarks
+ * Use this setting to initialize a \ref k4a_depth_filter_configuration_t, then enable the filters to use. The
+ * parameters are set to values suited to the depth modes of the device.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+static const k4a_depth_filter_configuration_t K4A_DEPTH_FILTER_CONFIG_INIT_DISABLE_ALL = { false, 100, false, 30,
+                                                                                          false, 0.4f, 100, 2 };
+
+/** Initial color decode configuration, which outputs the full image at full resolution.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+static const k4a_color_decode_configuration_t K4A_COLOR_DECODE_CONFIG_INIT_FULL_RESOLUTION = { 1, { 0, 0, 0, 0 } };
+
 /**
  * @}
  */
@@ -10,6 +10,7 @@
 #include <k4a/k4atypes.h>
 
 #include <stddef.h>
+#include <stdbool.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -25,12 +26,12 @@ extern "C" {
  */
 typedef enum
 {
-    ALLOCATION_SOURCE_USER = 0,  /**< Memory was allocated by the user */
-    ALLOCATION_SOURCE_DEPTH,     /**< Memory was allocated by the depth reader */
-    ALLOCATION_SOURCE_COLOR,     /**< Memory was allocated by the Color reader */
-    ALLOCATION_SOURCE_IMU,       /**< Memory was allocated by the IMU reader */
-    ALLOCATION_SOURCE_USB_DEPTH, /**< Memory was allocated by the USB reader */
-    ALLOCATION_SOURCE_USB_IMU,   /**< Memory was allocated by the USB reader */
+    ALLOCATION_SOURCE_USER = K4A_ALLOCATION_SOURCE_USER,           /**< Memory was allocated by the user */
+    ALLOCATION_SOURCE_DEPTH = K4A_ALLOCATION_SOURCE_DEPTH,         /**< Memory was allocated by the depth reader */
+    ALLOCATION_SOURCE_COLOR = K4A_ALLOCATION_SOURCE_COLOR,         /**< Memory was allocated by the Color reader */
+    ALLOCATION_SOURCE_IMU = K4A_ALLOCATION_SOURCE_IMU,             /**< Memory was allocated by the IMU reader */
+    ALLOCATION_SOURCE_USB_DEPTH = K4A_ALLOCATION_SOURCE_USB_DEPTH, /**< Memory was allocated by the USB reader */
+    ALLOCATION_SOURCE_USB_IMU = K4A_ALLOCATION_SOURCE_USB_IMU,     /**< Memory was allocated by the USB reader */
 } allocation_source_t;
 
 /** Initializes the globals used by the allocator
@@ -69,6 +70,10 @@ void allocator_deinitialize(void);
  * Not all memory allocation by the SDK is performed by this allocate function. Small allocations or allocations
  * from special pools may come from other sources.
  *
+ * \remarks
+ * Set the allocator before opening devices. An allocation already in progress on another thread may still use the
+ * previous \p allocate function, and at most 16 different allocators may be set over the life of the process.
+ *
  * \xmlonly
  * <requirements>
  *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
@@ -79,6 +84,66 @@ void allocator_deinitialize(void);
  */
 k4a_result_t allocator_set_allocator(k4a_memory_allocate_cb_t allocate, k4a_memory_destroy_cb_t free);
 
+/** Sets how much freed memory the default allocator may keep for reuse
+ *
+ * \param max_retained_bytes
+ * Most bytes kept in the size class pool of the default allocator. 0 disables pooling and frees retained buffers.
+ *
+ * \return ::K4A_RESULT_SUCCEEDED
+ *
+ * \remarks
+ * Pooling can also be enabled with the K4A_ALLOCATOR_POOL_BYTES environment variable. It only affects the default
+ * allocator, not callbacks set with \ref allocator_set_allocator.
+ */
+k4a_result_t allocator_set_default_pool_size(size_t max_retained_bytes);
+
+/** Size class pool allocate function used by the default allocator, matches k4a_memory_allocate_cb_t
+ *
+ * \remarks
+ * Requests are rounded up to one of 8 size classes per power of 2 and served from buffers freed earlier when
+ * available. Small requests and requests while pooling is disabled go directly to malloc.
+ */
+uint8_t *allocator_size_class_alloc(int size, void **context);
+
+/** Size class pool free function used by the default allocator, matches k4a_memory_destroy_cb_t
+ */
+void allocator_size_class_free(void *buffer, void *context);
+
+/** Sets the most bytes the size class pool retains, trimming retained buffers above the new limit
+ */
+void allocator_size_class_set_max_retained_bytes(size_t max_retained_bytes);
+
+/** Gets the bytes currently retained by the size class pool
+ */
+size_t allocator_size_class_get_retained_bytes(void);
+
+/** Sets the smallest default allocator request backed by huge pages
+ *
+ * \param min_bytes
+ * Color and depth buffers and transformation tables of at least this many bytes are mapped with huge pages. 0 disables
+ * huge pages.
+ *
+ * \return ::K4A_RESULT_SUCCEEDED
+ *
+ * \remarks
+ * Huge pages can also be enabled with the K4A_ALLOCATOR_HUGE_PAGE_BYTES environment variable. They only affect the
+ * default allocator, not callbacks set with \ref allocator_set_allocator, and buffers they back are not pooled.
+ */
+k4a_result_t allocator_set_huge_page_threshold(size_t min_bytes);
+
+/** Huge page allocate function, matches k4a_memory_allocate_cb_t
+ *
+ * \remarks
+ * Returns NULL when \p size is below the threshold set with \ref allocator_set_huge_page_threshold or huge pages
+ * could not be mapped, the caller then allocates elsewhere. On Linux explicit huge pages are tried first, then a 2MB
+ * aligned mapping advised with MADV_HUGEPAGE. On Windows large pages need the SeLockMemoryPrivilege.
+ */
+uint8_t *allocator_huge_page_alloc(int size, void **context);
+
+/** Huge page free function, matches k4a_memory_destroy_cb_t
+ */
+void allocator_huge_page_free(void *buffer, void *context);
+
 /** Allocates memory from the allocator
  *
  * \param source
@@ -91,16 +156,249 @@ k4a_result_t allocator_set_allocator(k4a_memory_allocate_cb_t allocate, k4a_memo
  */
 uint8_t *allocator_alloc(allocation_source_t source, size_t alloc_size);
 
+/** Alignment of buffers returned by \ref allocator_alloc */
+#define ALLOCATOR_DEFAULT_ALIGNMENT K4A_IMAGE_BUFFER_ALIGNMENT
+
+/** Largest alignment \ref allocator_alloc_aligned accepts */
+#define ALLOCATOR_MAX_ALIGNMENT 65536
+
+/** Allocates memory from the allocator with the start of the buffer aligned
+ *
+ * \param source
+ * the source of code allocating the memory
+ *
+ * \param alloc_size
+ * size of the memory to allocate
+ *
+ * \param alignment
+ * required alignment of the returned buffer in bytes. Must be a power of 2 no larger than ALLOCATOR_MAX_ALIGNMENT.
+ *
+ * \remarks
+ * The allocate callback is asked for up to \p alignment - 1 extra bytes to align the buffer, whatever alignment the
+ * callback itself provides. Free the buffer with \ref allocator_free.
+ */
+uint8_t *allocator_alloc_aligned(allocation_source_t source, size_t alloc_size, size_t alignment);
+
+/** Writes to every page of a buffer so the operating system commits it before it is first used
+ *
+ * \param buffer
+ * buffer to touch, its contents are overwritten
+ *
+ * \param size
+ * size of the buffer in bytes
+ */
+void allocator_prefault(uint8_t *buffer, size_t size);
+
+/** Allocator callbacks used in place of the process allocator by one device or transformation
+ *
+ * \remarks
+ * A NULL allocate callback uses the allocator set with \ref allocator_set_allocator. Modules keep their own copy, so
+ * the hook may only be changed while the module is not allocating.
+ *
+ * \remarks
+ * A source with a buffer ring allocates from its slots instead of the callbacks. The owner of the hook holds a
+ * reference on the rings, see \ref allocator_ring_add_ref.
+ */
+typedef struct _allocator_hook_t
+{
+    k4a_memory_allocate_source_cb_t *allocate;
+    k4a_memory_destroy_cb_t *free;
+    void *context;                                   // Passed to allocate as allocator_context
+    k4a_buffer_ring_t rings[K4A_ALLOCATION_SOURCE_COUNT]; // Optional, indexed by the allocation source
+} allocator_hook_t;
+
+/** Returns true if the hook replaces the process allocator for allocations of source
+ */
+static inline bool allocator_hook_is_set(const allocator_hook_t *hook, allocation_source_t source)
+{
+    return hook != NULL && (hook->allocate != NULL || hook->rings[source] != NULL);
+}
+
+/** Allocates aligned memory from an allocator hook
+ *
+ * \param hook
+ * callbacks to allocate with, NULL or a hook without callbacks for the process allocator
+ *
+ * \remarks
+ * Behaves like \ref allocator_alloc_aligned. Free the buffer with \ref allocator_free.
+ */
+uint8_t *allocator_alloc_hooked(const allocator_hook_t *hook,
+                                allocation_source_t source,
+                                size_t alloc_size,
+                                size_t alignment);
+
 /** Returns a buffer to the allocator
  *
  * \param buffer
  * Buffer to free
  *
  * \remarks
- * This should only be called with a buffer allocated by allocator_alloc()
+ * This should only be called with a buffer allocated by allocator_alloc() or allocator_alloc_aligned()
  */
 void allocator_free(void *buffer);
 
+/** Gets the memory statistics of an allocation source
+ *
+ * \param source
+ * the source to get statistics for
+ *
+ * \param stats
+ * location to write the statistics to
+ *
+ * \return ::K4A_RESULT_SUCCEEDED if \p stats was written, otherwise ::K4A_RESULT_FAILED
+ *
+ * \remarks
+ * Statistics are process wide and cover every device. Buffers retained by pools count as allocated.
+ */
+k4a_result_t allocator_get_stats(allocation_source_t source, k4a_allocator_stats_t *stats);
+
+/** Pool of fixed size buffers allocated with \ref allocator_alloc_hooked.
+ *
+ * \remarks
+ * Buffers handed out by the pool hold a reference on it, so buffers referenced by images may outlive the owner
+ * closing the pool with \ref allocator_pool_close.
+ */
+typedef struct _allocator_pool_t allocator_pool_t;
+
+/** Creates a pool and pre-allocates its buffers
+ *
+ * \param hook
+ * optional, allocator callbacks the pool allocates with. The pool keeps a copy.
+ *
+ * \param source
+ * the source of code allocating the memory
+ *
+ * \param buffer_size
+ * size of every buffer in the pool
+ *
+ * \param capacity
+ * number of buffers to pre-allocate, also the most the pool keeps idle
+ *
+ * \return NULL if failed, otherwise the pool. The caller owns one reference, released with \ref allocator_pool_close
+ */
+allocator_pool_t *allocator_pool_create(const allocator_hook_t *hook,
+                                        allocation_source_t source,
+                                        size_t buffer_size,
+                                        uint32_t capacity);
+
+/** Takes a buffer from the pool
+ *
+ * \param pool
+ * pool to take the buffer from
+ *
+ * \param recycled
+ * optional, set to false when the pool was empty and the buffer was freshly allocated
+ *
+ * \return NULL if the allocation failed. The buffer must be returned with \ref allocator_pool_free
+ */
+uint8_t *allocator_pool_alloc(allocator_pool_t *pool, bool *recycled);
+
+/** Returns a buffer to its pool
+ *
+ * \param buffer
+ * buffer from \ref allocator_pool_alloc
+ *
+ * \param pool
+ * pool the buffer came from
+ *
+ * \remarks
+ * Matches image_destroy_cb_t so it can be used to release images wrapping pool buffers. The buffer is freed instead of
+ * kept when the pool is closed or already holds capacity idle buffers.
+ */
+void allocator_pool_free(void *buffer, void *pool);
+
+/** Gets the size of the buffers in a pool
+ */
+size_t allocator_pool_get_buffer_size(allocator_pool_t *pool);
+
+/** Touches every page of the idle buffers of a pool so the first frames using them do not page fault
+ *
+ * \remarks
+ * Buffers handed out later, by a pool that has run out of idle buffers, are not pre-faulted.
+ */
+void allocator_pool_prefault(allocator_pool_t *pool);
+
+/** Closes a pool, freeing idle buffers and releasing the reference taken by \ref allocator_pool_create
+ */
+void allocator_pool_close(allocator_pool_t *pool);
+
+/** Creates a buffer ring over memory owned by the caller
+ *
+ * \param buffer
+ * start of slot_count slots of slot_size bytes, which must stay valid until every slot is returned
+ *
+ * \param slot_size
+ * size of every slot, larger than K4A_BUFFER_RING_SLOT_OVERHEAD
+ *
+ * \param slot_count
+ * number of slots
+ *
+ * \param ring
+ * location to write the ring to. The caller owns one reference, released with \ref allocator_ring_release
+ *
+ * \return ::K4A_RESULT_SUCCEEDED if the ring was created, otherwise ::K4A_RESULT_FAILED
+ */
+k4a_result_t allocator_ring_create(uint8_t *buffer, size_t slot_size, uint32_t slot_count, k4a_buffer_ring_t *ring);
+
+/** Takes a reference on a buffer ring
+ *
+ * \return ::K4A_RESULT_FAILED if \p ring is invalid
+ */
+k4a_result_t allocator_ring_add_ref(k4a_buffer_ring_t ring);
+
+/** Releases a reference on a buffer ring, the ring is destroyed with its last reference
+ *
+ * \remarks
+ * Every slot in use holds a reference, so the ring outlives the handle owner until the slots are returned.
+ */
+void allocator_ring_release(k4a_buffer_ring_t ring);
+
+/** Takes a slot of a buffer ring, matches k4a_memory_allocate_source_cb_t
+ *
+ * \param ring
+ * the buffer ring, passed as the allocator context
+ *
+ * \return NULL if \p size is larger than a slot or every slot is in use, otherwise the start of the slot. Return it
+ * with \ref allocator_ring_free, \p buffer_release_cb_context is set to the ring.
+ */
+uint8_t *allocator_ring_allocate(int size,
+                                 k4a_allocation_source_t source,
+                                 void *ring,
+                                 void **buffer_release_cb_context);
+
+/** Returns a slot taken with \ref allocator_ring_allocate, matches k4a_memory_destroy_cb_t
+ */
+void allocator_ring_free(void *buffer, void *ring);
+
+/** Finds the slot a buffer is in
+ *
+ * \param buffer
+ * buffer of an image, or any address in the ring
+ *
+ * \param slot_index
+ * optional, location to write the index of the slot to
+ *
+ * \param buffer_offset
+ * optional, location to write the offset of \p buffer from the start of the ring to
+ *
+ * \return ::K4A_RESULT_SUCCEEDED if \p buffer is in the ring, otherwise ::K4A_RESULT_FAILED
+ */
+k4a_result_t allocator_ring_get_slot(k4a_buffer_ring_t ring,
+                                     const uint8_t *buffer,
+                                     uint32_t *slot_index,
+                                     size_t *buffer_offset);
+
+/** Creates an image over the start of a free slot of a buffer ring, releasing the image returns the slot
+ *
+ * \return ::K4A_RESULT_FAILED if the image doesn't fit in a slot or every slot is in use
+ */
+k4a_result_t allocator_ring_create_image(k4a_buffer_ring_t ring,
+                                         k4a_image_format_t format,
+                                         int width_pixels,
+                                         int height_pixels,
+                                         int stride_bytes,
+                                         k4a_image_t *image);
+
 /** Verifies there are no outstanding allocations
  *
  * \remarks
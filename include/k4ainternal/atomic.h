@@ -0,0 +1,66 @@
+/** \file atomic.h
+ * Copyright (c) Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License.
+ * Kinect For Azure SDK.
+ */
+
+#ifndef K4A_ATOMIC_H
+#define K4A_ATOMIC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Sequentially consistent atomic operations on 32 bit integers, 64 bit integers and pointers.
+ *
+ * \remarks
+ * k4a_atomic_cas() compares *p with expected and, if equal, replaces it with desired. It evaluates to true when the
+ * swap happened. expected must be an lvalue.
+ *
+ * \remarks
+ * The 64 bit variants are k4a_atomic_load64(), k4a_atomic_add64() and k4a_atomic_cas64(). Pointers use
+ * k4a_atomic_load_ptr(), k4a_atomic_store_ptr(), k4a_atomic_exchange_ptr() and k4a_atomic_cas_ptr().
+ */
+#ifdef _WIN32
+#include <windows.h>
+#define k4a_atomic_load(p) ((uint32_t)InterlockedCompareExchange((volatile LONG *)(p), 0, 0))
+#define k4a_atomic_store(p, v) ((void)InterlockedExchange((volatile LONG *)(p), (LONG)(v)))
+#define k4a_atomic_add(p, v) ((void)InterlockedExchangeAdd((volatile LONG *)(p), (LONG)(v)))
+#define k4a_atomic_exchange(p, v) ((uint32_t)InterlockedExchange((volatile LONG *)(p), (LONG)(v)))
+#define k4a_atomic_cas(p, expected, desired)                                                                           \
+    ((uint32_t)InterlockedCompareExchange((volatile LONG *)(p), (LONG)(desired), (LONG)(expected)) ==                 \
+     (uint32_t)(expected))
+#define k4a_atomic_load64(p) ((uint64_t)InterlockedCompareExchange64((volatile LONG64 *)(p), 0, 0))
+#define k4a_atomic_add64(p, v) ((void)InterlockedExchangeAdd64((volatile LONG64 *)(p), (LONG64)(v)))
+#define k4a_atomic_cas64(p, expected, desired)                                                                         \
+    ((uint64_t)InterlockedCompareExchange64((volatile LONG64 *)(p), (LONG64)(desired), (LONG64)(expected)) ==         \
+     (uint64_t)(expected))
+#define k4a_atomic_load_ptr(p) InterlockedCompareExchangePointer((PVOID volatile *)(p), NULL, NULL)
+#define k4a_atomic_store_ptr(p, v) ((void)InterlockedExchangePointer((PVOID volatile *)(p), (PVOID)(v)))
+#define k4a_atomic_exchange_ptr(p, v) InterlockedExchangePointer((PVOID volatile *)(p), (PVOID)(v))
+#define k4a_atomic_cas_ptr(p, expected, desired)                                                                       \
+    (InterlockedCompareExchangePointer((PVOID volatile *)(p), (PVOID)(desired), (PVOID)(expected)) == (PVOID)(expected))
+#else
+#define k4a_atomic_load(p) __atomic_load_n((p), __ATOMIC_SEQ_CST)
+#define k4a_atomic_store(p, v) __atomic_store_n((p), (v), __ATOMIC_SEQ_CST)
+#define k4a_atomic_add(p, v) ((void)__atomic_add_fetch((p), (v), __ATOMIC_SEQ_CST))
+#define k4a_atomic_exchange(p, v) __atomic_exchange_n((p), (v), __ATOMIC_SEQ_CST)
+#define k4a_atomic_cas(p, expected, desired)                                                                           \
+    __atomic_compare_exchange_n((p), &(expected), (desired), false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)
+#define k4a_atomic_load64(p) k4a_atomic_load(p)
+#define k4a_atomic_add64(p, v) k4a_atomic_add((p), (v))
+#define k4a_atomic_cas64(p, expected, desired) k4a_atomic_cas((p), (expected), (desired))
+#define k4a_atomic_load_ptr(p) __atomic_load_n((p), __ATOMIC_SEQ_CST)
+#define k4a_atomic_store_ptr(p, v) __atomic_store_n((p), (v), __ATOMIC_SEQ_CST)
+#define k4a_atomic_exchange_ptr(p, v) __atomic_exchange_n((p), (v), __ATOMIC_SEQ_CST)
+#define k4a_atomic_cas_ptr(p, expected, desired) k4a_atomic_cas((p), (expected), (desired))
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* K4A_ATOMIC_H */
@@ -27,6 +27,12 @@ extern "C" {
  */
 k4a_result_t capture_create(k4a_capture_t *capture_handle);
 
+/** Fills the pool of released captures so capture_create() does not allocate while streaming starts
+ *
+ * The pool is drained when the last allocator session ends.
+ */
+void capture_pool_prefill(void);
+
 /** Increase the ref count on \ref k4a_capture_t blob
  *
  * \param capture_handle
@@ -48,14 +54,72 @@ void capture_dec_ref(k4a_capture_t capture_handle);
 k4a_image_t capture_get_color_image(k4a_capture_t capture_handle);
 k4a_image_t capture_get_depth_image(k4a_capture_t capture_handle);
 k4a_image_t capture_get_imu_image(k4a_capture_t capture_handle);
+k4a_image_t capture_get_imu_samples_image(k4a_capture_t capture_handle);
 k4a_image_t capture_get_ir_image(k4a_capture_t capture_handle);
+/** Read the device timestamp of the color image held by a \ref k4a_capture_t without taking a reference on it
+ *
+ * \param capture_handle
+ * The k4a_capture_t blob
+ *
+ * \param timestamp_usec
+ * Receives the image's device timestamp in microseconds
+ *
+ * Returns K4A_RESULT_FAILED if the capture has no color image.
+ */
+k4a_result_t capture_peek_color_image_timestamp(k4a_capture_t capture_handle, uint64_t *timestamp_usec);
+
+/** Read the device timestamp of the IR image held by a \ref k4a_capture_t without taking a reference on it
+ *
+ * \param capture_handle
+ * The k4a_capture_t blob
+ *
+ * \param timestamp_usec
+ * Receives the image's device timestamp in microseconds
+ *
+ * Returns K4A_RESULT_FAILED if the capture has no IR image.
+ */
+k4a_result_t capture_peek_ir_image_timestamp(k4a_capture_t capture_handle, uint64_t *timestamp_usec);
+
+/** Read the device timestamp of the depth image held by a \ref k4a_capture_t without taking a reference on it
+ *
+ * \param capture_handle
+ * The k4a_capture_t blob
+ *
+ * \param timestamp_usec
+ * Receives the image's device timestamp in microseconds
+ *
+ * Returns K4A_RESULT_FAILED if the capture has no depth image.
+ */
+k4a_result_t capture_peek_depth_image_timestamp(k4a_capture_t capture_handle, uint64_t *timestamp_usec);
+
+/** Records the current host time as the time the images of a \ref k4a_capture_t passed a pipeline stage
+ *
+ * \param capture_handle
+ * The k4a_capture_t blob
+ *
+ * \param stage
+ * The stage the images passed, see k4a_image_get_stage_timestamp_nsec()
+ */
+void capture_set_stage_timestamp(k4a_capture_t capture_handle, k4a_image_stage_t stage);
+
 void capture_set_color_image(k4a_capture_t capture_handle, k4a_image_t image_handle);
 void capture_set_depth_image(k4a_capture_t capture_handle, k4a_image_t image_handle);
 void capture_set_imu_image(k4a_capture_t capture_handle, k4a_image_t image_handle);
+void capture_set_imu_samples_image(k4a_capture_t capture_handle, k4a_image_t image_handle);
 void capture_set_ir_image(k4a_capture_t capture_handle, k4a_image_t image_handle);
 void capture_set_temperature_c(k4a_capture_t capture_handle, float temperature_c);
 float capture_get_temperature_c(k4a_capture_t capture_handle);
 
+/** Fill in views of the color, depth and IR images of a \ref k4a_capture_t without taking references on them
+ *
+ * \param capture_handle
+ * The k4a_capture_t blob
+ *
+ * \param view
+ * Receives the views, missing images have a NULL buffer
+ */
+k4a_result_t capture_get_view(k4a_capture_t capture_handle, k4a_capture_view_t *view);
+
 #ifdef __cplusplus
 }
 #endif
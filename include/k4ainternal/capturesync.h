@@ -55,10 +55,15 @@ void capturesync_destroy(capturesync_t capturesync_handle);
  * \param config
  * The device configuration provided by the caller
  *
+ * \param options
+ * The start options of the device
+ *
  * \remarks
  * Enables the capturesync to enable its queues and begin synchronizing depth and color frames
  */
-k4a_result_t capturesync_start(capturesync_t capturesync_handle, const k4a_device_configuration_t *config);
+k4a_result_t capturesync_start(capturesync_t capturesync_handle,
+                               const k4a_device_configuration_t *config,
+                               const k4a_device_start_options_t *options);
 
 /** Prepares the capturesync object to stop synchronizing color and depth captures
  *
@@ -85,6 +90,16 @@ k4a_wait_result_t capturesync_get_capture(capturesync_t capturesync_handle,
                                           k4a_capture_t *capture_handle,
                                           int32_t timeout_in_ms);
 
+/** Gets an operating system object that is signaled while capturesync_get_capture() has a capture to return.
+ *
+ * \param capturesync_handle
+ * The capturesync handle from capturesync_create()
+ *
+ * \param wait_handle
+ * The location to write the handle to, valid until capturesync_destroy()
+ */
+k4a_result_t capturesync_get_wait_handle(capturesync_t capturesync_handle, k4a_wait_handle_t *wait_handle);
+
 /** Capturesync module asynchronously accepts new captures from color and depth modules through this API.
  *
  * \param capturesync_handle
@@ -108,6 +123,122 @@ void capturesync_add_capture(capturesync_t capturesync_handle,
                              k4a_capture_t capture_raw,
                              bool color_capture);
 
+/** Add calibrated IMU samples to attach to the next captures published
+ *
+ * \param capturesync_handle
+ * The capturesync handle from capturesync_create()
+ *
+ * \param samples
+ * Samples in order of their accelerometer timestamps
+ *
+ * \param sample_count
+ * Number of samples
+ *
+ * \remarks
+ * Samples are ignored unless capturesync was started with attach_imu_samples set. Each published capture is given the
+ * samples added since the previous one, up to its own device timestamp, see capture_get_imu_samples_image(). Samples
+ * that are not attached in time are dropped oldest first.
+ */
+void capturesync_add_imu_samples(capturesync_t capturesync_handle,
+                                 const k4a_imu_sample_t *samples,
+                                 size_t sample_count);
+
+/** Set how many captures of each stream are considered when pairing color and depth
+ *
+ * \param capturesync_handle
+ * The capturesync handle from capturesync_create()
+ *
+ * \param color_window
+ * Number of color captures, from 1 to 4
+ *
+ * \param depth_window
+ * Number of depth captures, from 1 to 4
+ *
+ * \remarks
+ * A pair is only published when neither capture has a later candidate in its window that is closer to the other one,
+ * after allowing for depth_delay_off_color_usec. A window of 1 pairs the oldest captures that fall within the sync
+ * window. The default is 2 for both streams and can be set with the K4A_CAPTURESYNC_WINDOW environment variable. The
+ * window can't be changed while capturesync is started.
+ */
+k4a_result_t capturesync_set_window(capturesync_t capturesync_handle, uint32_t color_window, uint32_t depth_window);
+
+/** Deliver synchronized captures to a callback instead of the queue read by capturesync_get_capture()
+ *
+ * \param capturesync_handle
+ * The capturesync handle from capturesync_create()
+ *
+ * \param callback
+ * Function called with each synchronized capture, NULL to return to queueing captures
+ *
+ * \param context
+ * Passed to every call to callback
+ *
+ * \remarks
+ * The callback runs on the thread that called capturesync_add_capture(), one capture at a time and in order. The
+ * capture is only valid for the duration of the call, the callback takes a ref with capture_inc_ref() to keep it.
+ * The callback must not call capturesync_stop(). The callback can't be changed while capturesync is started.
+ */
+k4a_result_t capturesync_set_callback(capturesync_t capturesync_handle, k4a_capture_ready_cb_t *callback, void *context);
+
+/** Count the captures that did not reach the application since capturesync_create()
+ *
+ * \param capturesync_handle
+ * The capturesync handle from capturesync_create()
+ *
+ * \param sync_dropped_count
+ * Location to write the number of captures capturesync discarded: depth captures received before the timestamps
+ * stabilized, and captures that could not be paired while synchronized_images_only is set
+ *
+ * \param queue_dropped_count
+ * Location to write the number of synchronized captures dropped because capturesync_get_capture() did not read them in
+ * time
+ */
+k4a_result_t capturesync_get_dropped_counts(capturesync_t capturesync_handle,
+                                            uint32_t *sync_dropped_count,
+                                            uint32_t *queue_dropped_count);
+
+/** Fill in the capture counters, drop counters and capture latencies of \p statistics
+ *
+ * \param capturesync_handle
+ * The capturesync handle from capturesync_create()
+ *
+ * \param statistics
+ * Statistics to fill in, fields that capturesync doesn't track are left untouched
+ *
+ * \remarks
+ * Latency is recorded when capturesync_get_capture() returns a capture, or a capture is passed to the callback set with
+ * capturesync_set_callback(), and covers the time since the host received the capture's oldest image.
+ */
+k4a_result_t capturesync_get_statistics(capturesync_t capturesync_handle, k4a_device_statistics_t *statistics);
+
+#define CAPTURESYNC_LATENCY_BUCKETS 16
+
+/** Distribution of the time capturesync_add_capture() takes to process each arriving capture.
+ *
+ * count[0] holds arrivals that took less than 1us, count[i] those that took [2^(i-1), 2^i) us and the last bucket
+ * everything from 2^(CAPTURESYNC_LATENCY_BUCKETS - 2) us up.
+ */
+typedef struct _capturesync_latency_histogram_t
+{
+    uint32_t count[CAPTURESYNC_LATENCY_BUCKETS];
+    uint64_t max_usec; // Slowest arrival seen
+} capturesync_latency_histogram_t;
+
+/** Read the arrival latency histogram collected since capturesync_create()
+ *
+ * \param capturesync_handle
+ * The capturesync handle from capturesync_create()
+ *
+ * \param histogram
+ * Location to write the histogram to
+ *
+ * \remarks
+ * Buckets are updated independently while captures arrive, so they are only consistent with each other while
+ * streaming is stopped.
+ */
+k4a_result_t capturesync_get_latency_histogram(capturesync_t capturesync_handle,
+                                               capturesync_latency_histogram_t *histogram);
+
 #ifdef __cplusplus
 }
 #endif
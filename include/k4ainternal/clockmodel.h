@@ -0,0 +1,123 @@
+/** \file clockmodel.h
+ * Copyright (c) Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License.
+ * Kinect For Azure SDK.
+ *
+ * Model of the device clock in the clock of the image system timestamps
+ */
+
+#ifndef CLOCKMODEL_H
+#define CLOCKMODEL_H
+
+#include <k4a/k4atypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Handle to the clockmodel module
+ *
+ * Handles are created with clockmodel_create() and closed with clockmodel_destroy().
+ * Invalid handles are set to 0.
+ */
+K4A_DECLARE_HANDLE(clockmodel_t);
+
+/** Creates a clock model without samples
+ *
+ * \param clockmodel_handle
+ * pointer to a handle location to store the handle. This is only written on K4A_RESULT_SUCCEEDED;
+ *
+ * To cleanup this resource call clockmodel_destroy().
+ *
+ * \ref K4A_RESULT_SUCCEEDED is returned on success
+ */
+k4a_result_t clockmodel_create(clockmodel_t *clockmodel_handle);
+
+/** Destroys a clock model
+ *
+ * \param clockmodel_handle
+ * The clock model handle to destroy
+ */
+void clockmodel_destroy(clockmodel_t clockmodel_handle);
+
+/** Drops the samples of the model, for when the device timestamps restart
+ *
+ * \param clockmodel_handle
+ * The clock model handle from clockmodel_create()
+ */
+void clockmodel_reset(clockmodel_t clockmodel_handle);
+
+/** Adds a pair of timestamps of the same image to the model
+ *
+ * \param clockmodel_handle
+ * The clock model handle from clockmodel_create()
+ *
+ * \param device_timestamp_usec
+ * The device timestamp of the image
+ *
+ * \param system_timestamp_nsec
+ * The system timestamp of the image, taken when its USB transfer completed
+ *
+ * \remarks
+ * The system timestamps are delayed by USB and scheduling jitter, but never early. The model keeps the sample with the
+ * least delay of each window of device time, and fits a line through the recent windows. A device timestamp that goes
+ * back in time starts a new model. Samples with a system timestamp of 0 are ignored.
+ */
+void clockmodel_add_sample(clockmodel_t clockmodel_handle,
+                           uint64_t device_timestamp_usec,
+                           uint64_t system_timestamp_nsec);
+
+/** Gets the current fit of the model
+ *
+ * \param clockmodel_handle
+ * The clock model handle from clockmodel_create()
+ *
+ * \param model
+ * Location to write the fit to
+ *
+ * \ref K4A_RESULT_FAILED is returned if the model has no samples yet
+ */
+k4a_result_t clockmodel_get(clockmodel_t clockmodel_handle, k4a_device_clock_model_t *model);
+
+/** Converts a device timestamp to the clock of the system timestamps
+ *
+ * \param clockmodel_handle
+ * The clock model handle from clockmodel_create()
+ *
+ * \param device_timestamp_usec
+ * The device timestamp to convert
+ *
+ * \param system_timestamp_nsec
+ * Location to write the system timestamp to
+ *
+ * \ref K4A_RESULT_FAILED is returned if the model has no samples yet
+ */
+k4a_result_t clockmodel_convert(clockmodel_t clockmodel_handle,
+                                uint64_t device_timestamp_usec,
+                                uint64_t *system_timestamp_nsec);
+
+/** Converts a system timestamp to the clock of the device timestamps
+ *
+ * \param clockmodel_handle
+ * The clock model handle from clockmodel_create()
+ *
+ * \param system_timestamp_nsec
+ * The system timestamp to convert
+ *
+ * \param device_timestamp_usec
+ * Location to write the device timestamp to
+ *
+ * \remarks
+ * The inverse of clockmodel_convert(), for images the device timestamp of which is only known to the depth engine.
+ *
+ * \ref K4A_RESULT_FAILED is returned if the model has no samples yet
+ */
+k4a_result_t clockmodel_convert_system(clockmodel_t clockmodel_handle,
+                                       uint64_t system_timestamp_nsec,
+                                       uint64_t *device_timestamp_usec);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CLOCKMODEL_H */
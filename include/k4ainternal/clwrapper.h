@@ -0,0 +1,75 @@
+/** \file CLWRAPPER.h
+ * Copyright (c) Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License.
+ * Kinect For Azure SDK.
+ */
+
+#ifndef CLWRAPPER_H
+#define CLWRAPPER_H
+
+#include <k4a/k4atypes.h>
+#include <k4ainternal/handle.h>
+#include <k4ainternal/transformation.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Handle to the OpenCL transformation backend.
+ *
+ * Handles are created with \ref clwrapper_create and closed
+ * with \ref clwrapper_destroy.
+ * Invalid handles are set to 0.
+ */
+K4A_DECLARE_HANDLE(clwrapper_t);
+
+// Sets up the OpenCL backend on device of the cl_context context, or on the first GPU device of the system if context
+// is NULL. ray_tables are the depth camera rays in color camera coordinates, NULL if the calibration has no color
+// camera. They are uploaded before returning, the xy tables are uploaded on first use and must outlive the handle.
+// Returns NULL if the SDK was built without K4A_ENABLE_OPENCL or no OpenCL GPU is available.
+clwrapper_t clwrapper_create(const k4a_calibration_t *calibration,
+                             const k4a_transformation_ray_tables_t *ray_tables,
+                             const k4a_transformation_xy_tables_t *depth_camera_xy_tables,
+                             const k4a_transformation_xy_tables_t *color_camera_xy_tables,
+                             void *context,
+                             void *device);
+void clwrapper_destroy(clwrapper_t clwrapper_handle);
+
+// The functions below take images that were already validated for the calibration. Each output is kept in GPU memory
+// until the next call producing it, see clwrapper_get_output(), and is also copied to the host pointer if not NULL.
+
+// custom_format is K4A_IMAGE_FORMAT_CUSTOM8, K4A_IMAGE_FORMAT_CUSTOM16 or any other format for no custom image
+k4a_result_t clwrapper_depth_to_color(clwrapper_t clwrapper_handle,
+                                      const uint16_t *depth_image,
+                                      const uint8_t *custom_image,
+                                      k4a_image_format_t custom_format,
+                                      k4a_transformation_interpolation_type_t interpolation_type,
+                                      uint32_t invalid_custom_value,
+                                      uint16_t *transformed_depth_image,
+                                      uint8_t *transformed_custom_image);
+
+k4a_result_t clwrapper_color_to_depth(clwrapper_t clwrapper_handle,
+                                      const uint16_t *depth_image,
+                                      const uint8_t *color_image,
+                                      uint8_t *transformed_color_image);
+
+// depth_image is in the geometry of camera, the point cloud is in K4A_POINT_CLOUD_FORMAT_INT16_XYZ
+k4a_result_t clwrapper_depth_to_point_cloud(clwrapper_t clwrapper_handle,
+                                            k4a_calibration_type_t camera,
+                                            const uint16_t *depth_image,
+                                            int16_t *xyz_image);
+
+// Returns the cl_mem holding the last result of output, fails if it has not been produced yet
+k4a_result_t clwrapper_get_output(clwrapper_t clwrapper_handle, k4a_transformation_gpu_output_t output, void **buffer);
+
+// Writes output to the cl_mem or OpenGL buffer target, which is retained until it is replaced or the handle destroyed
+k4a_result_t clwrapper_set_output_target(clwrapper_t clwrapper_handle,
+                                         k4a_transformation_gpu_output_t output,
+                                         k4a_transformation_gpu_target_t target_type,
+                                         void *target);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CLWRAPPER_H */
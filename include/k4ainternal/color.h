@@ -94,10 +94,15 @@ void color_destroy(color_t color_handle);
  * \param config
  * The configuration settings for the color camera being started
  *
+ * \param options
+ * The start options of the device
+ *
  * \return ::K4A_RESULT_SUCCESS if successful. ::K4A_RESULT_FAILED if an error occurs. If this API's fails then there is
  * not need to call /ref color_stop
  */
-k4a_result_t color_start(color_t color_handle, const k4a_device_configuration_t *config);
+k4a_result_t color_start(color_t color_handle,
+                         const k4a_device_configuration_t *config,
+                         const k4a_device_start_options_t *options);
 
 /** Stops the color camera when it is currently streaming
  *
@@ -108,6 +113,31 @@ k4a_result_t color_start(color_t color_handle, const k4a_device_configuration_t
  */
 void color_stop(color_t color_handle);
 
+/** Sets the allocator of the color buffers
+ *
+ * \param color_handle
+ * Handle to the color device
+ *
+ * \param hook
+ * Allocator callbacks, NULL for the process allocator
+ *
+ * \return ::K4A_RESULT_SUCCEEDED if the allocator was set, ::K4A_RESULT_FAILED if the camera is streaming
+ */
+k4a_result_t color_set_allocator(color_t color_handle, const allocator_hook_t *hook);
+
+/** Sets the crop and scale of the BGRA32 images decoded from MJPG frames
+ *
+ * \param color_handle
+ * Handle to the color device
+ *
+ * \param config
+ * Decode configuration, NULL for the full image at full resolution
+ *
+ * \return ::K4A_RESULT_SUCCEEDED if the configuration was set, ::K4A_RESULT_FAILED if the camera is streaming or the
+ * configuration is invalid
+ */
+k4a_result_t color_set_decode(color_t color_handle, const k4a_color_decode_configuration_t *config);
+
 /** Returns the system tick count saved by the color camera when it was started.
  *
  * \param color_handle
@@ -179,6 +209,32 @@ k4a_result_t color_get_control(const color_t color_handle,
                                k4a_color_control_mode_t *mode,
                                int32_t *value);
 
+/** Reads the value of the given color camera's control command setting from the device.
+ *
+ * \param color_handle
+ * Handle to the color camera
+ *
+ * \param command
+ * The targeted color control command to read the the value for.
+ *
+ * \param mode
+ * The mode of the command in question.
+ *
+ * \param value
+ * A pointer to the location to write to fetched value to.
+ *
+ * \return ::K4A_RESULT_FAILED if the value could not be read. ::K4A_RESULT_SUCCEEDED if successful. Details of the
+ * error can be read from the debug output
+ *
+ * \remarks
+ * color_get_control() returns the value last set or read, re-reading auto mode values periodically. This function
+ * always queries the device and updates the value color_get_control() returns.
+ */
+k4a_result_t color_refresh_control(const color_t color_handle,
+                                   const k4a_color_control_command_t command,
+                                   k4a_color_control_mode_t *mode,
+                                   int32_t *value);
+
 /** Sets the value of the given color camera's control command setting.
  *
  * \param color_handle
@@ -175,6 +175,8 @@ void colormcu_imu_stop_streaming(colormcu_t colormcu_handle);
 k4a_result_t colormcu_imu_register_stream_cb(colormcu_t colormcu_handle,
                                              usb_cmd_stream_cb_t *capture_ready_cb,
                                              void *context);
+// Allocator of the buffers used by the next IMU stream, see usb_cmd_stream_set_allocator()
+k4a_result_t colormcu_imu_set_allocator(colormcu_t colormcu_handle, const allocator_hook_t *hook);
 k4a_result_t colormcu_imu_get_calibration(colormcu_t colormcu_handle,
                                           void *memory); // RGB_CAMERA_USB_COMMAND_READ_IMU_CALIDATA
 
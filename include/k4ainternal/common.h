@@ -144,6 +144,52 @@ inline static bool k4a_convert_depth_mode_to_width_height(k4a_depth_mode_t mode,
     return true;
 }
 
+// Resolves the crop of a color decode configuration for width x height images and the size of the scaled output.
+// Returns false if the configuration is invalid for that resolution.
+inline static bool k4a_color_decode_get_output(const k4a_color_decode_configuration_t *config,
+                                               uint32_t width,
+                                               uint32_t height,
+                                               k4a_rect_t *crop_out,
+                                               uint32_t *output_width,
+                                               uint32_t *output_height)
+{
+    uint32_t scale = config->scale_denominator;
+    if (scale != 1 && scale != 2 && scale != 4 && scale != 8)
+    {
+        return false;
+    }
+
+    k4a_rect_t crop = config->crop;
+    if (crop.width == 0 || crop.height == 0)
+    {
+        crop.x = 0;
+        crop.y = 0;
+        crop.width = (int32_t)width;
+        crop.height = (int32_t)height;
+    }
+
+    if (crop.x < 0 || crop.y < 0 || crop.width <= 0 || crop.height <= 0 || crop.x % (int32_t)scale != 0 ||
+        crop.y % (int32_t)scale != 0 || (int64_t)crop.x + crop.width > (int64_t)width ||
+        (int64_t)crop.y + crop.height > (int64_t)height)
+    {
+        return false;
+    }
+
+    if (crop_out != NULL)
+        *crop_out = crop;
+    if (output_width != NULL)
+        *output_width = ((uint32_t)crop.width + scale - 1) / scale;
+    if (output_height != NULL)
+        *output_height = ((uint32_t)crop.height + scale - 1) / scale;
+    return true;
+}
+
+// True if the configuration decodes the full image at full resolution
+inline static bool k4a_color_decode_is_full_resolution(const k4a_color_decode_configuration_t *config)
+{
+    return config->scale_denominator == 1 && (config->crop.width == 0 || config->crop.height == 0);
+}
+
 inline static bool k4a_is_version_greater_or_equal(k4a_version_t *fw_version_l, k4a_version_t *fw_version_r)
 {
     typedef enum
@@ -8,12 +8,20 @@
 
 #pragma once
 
+#include <k4a/k4atypes.h>
 #include <k4ainternal/k4aplugin.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// Loads the plugin if it isn't loaded yet, so the load can be moved off the critical path. True if it is loaded.
+bool deloader_load(void);
+
+// Starts deloader_load() on a background thread and returns without waiting for it. Later calls while it is loading,
+// or once it is loaded, do nothing.
+k4a_result_t deloader_load_async(void);
+
 k4a_depth_engine_result_code_t deloader_depth_engine_create_and_initialize(k4a_depth_engine_context_t **context,
                                                                            size_t cal_block_size_in_bytes,
                                                                            void *cal_block,
@@ -23,6 +31,20 @@ k4a_depth_engine_result_code_t deloader_depth_engine_create_and_initialize(k4a_d
                                                                            k4a_processing_complete_cb_t *callback,
                                                                            void *callback_context);
 
+k4a_depth_engine_result_code_t
+deloader_depth_engine_create_and_initialize_on_gpu(k4a_depth_engine_context_t **context,
+                                                   size_t cal_block_size_in_bytes,
+                                                   void *cal_block,
+                                                   k4a_depth_engine_mode_t mode,
+                                                   k4a_depth_engine_input_type_t input_format,
+                                                   void *camera_calibration,
+                                                   k4a_processing_complete_cb_t *callback,
+                                                   void *callback_context,
+                                                   uint32_t gpu_index);
+
+// Number of GPUs deloader_depth_engine_create_and_initialize_on_gpu() can select, 0 if the plugin can't select one
+uint32_t deloader_depth_engine_get_gpu_count(void);
+
 k4a_depth_engine_result_code_t
 deloader_depth_engine_process_frame(k4a_depth_engine_context_t *context,
                                     void *input_frame,
@@ -35,6 +57,26 @@ deloader_depth_engine_process_frame(k4a_depth_engine_context_t *context,
 
 size_t deloader_depth_engine_get_output_frame_size(k4a_depth_engine_context_t *context);
 
+// Output frame size for output_type, 0 if the plugin can't output it
+size_t deloader_depth_engine_get_output_frame_size_for_type(k4a_depth_engine_context_t *context,
+                                                            k4a_depth_engine_output_type_t output_type);
+
+// True if the loaded plugin implements deloader_depth_engine_submit_frame() and deloader_depth_engine_complete_frame()
+bool deloader_depth_engine_supports_submit(void);
+
+k4a_depth_engine_result_code_t deloader_depth_engine_submit_frame(k4a_depth_engine_context_t *context,
+                                                                  void *input_frame,
+                                                                  size_t input_frame_size,
+                                                                  k4a_depth_engine_output_type_t output_type,
+                                                                  void *output_frame,
+                                                                  size_t output_frame_size,
+                                                                  void *frame_context);
+
+k4a_depth_engine_result_code_t
+deloader_depth_engine_complete_frame(k4a_depth_engine_context_t *context,
+                                     void **frame_context,
+                                     k4a_depth_engine_output_frame_info_t *output_frame_info);
+
 void deloader_depth_engine_destroy(k4a_depth_engine_context_t **context);
 
 k4a_depth_engine_result_code_t deloader_transform_engine_create_and_initialize(k4a_transform_engine_context_t **context,
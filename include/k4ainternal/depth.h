@@ -126,12 +126,37 @@ k4a_result_t depth_get_device_version(depth_t depth_handle, k4a_hardware_version
  * \param config [IN]
  * The configuration of the depth sensor the user wants the sensor to run in.
  *
+ * \param options [IN]
+ * The start options of the device.
+ *
  * \return ::K4A_RESULT_SUCCEEDED if the depth sensor was successfully started. ::K4A_RESULT_FAILED if an error was
  * encountered.
  *
  * call /ref depth_stop when the sensor no longer needs to stream.
  */
-k4a_result_t depth_start(depth_t depth_handle, const k4a_device_configuration_t *config);
+k4a_result_t depth_start(depth_t depth_handle,
+                         const k4a_device_configuration_t *config,
+                         const k4a_device_start_options_t *options);
+
+/** Restarts the depth sensor streaming in a new depth mode or frame rate
+ *
+ * \param depth_handle [IN]
+ * The depth device handle.
+ *
+ * \param config [IN]
+ * The configuration of the depth sensor to stream with from now on.
+ *
+ * \param options [IN]
+ * The start options of the device.
+ *
+ * \return ::K4A_RESULT_SUCCEEDED if the depth sensor streams with the new configuration. ::K4A_RESULT_FAILED if the
+ * sensor was not streaming or an error was encountered, the sensor is stopped in that case.
+ *
+ * The depth engine thread is kept across the restart, and so is the depth engine if the depth mode is unchanged.
+ */
+k4a_result_t depth_reconfigure(depth_t depth_handle,
+                               const k4a_device_configuration_t *config,
+                               const k4a_device_start_options_t *options);
 
 /** Stops the depth sensor when it has been streaming
  *
@@ -143,6 +168,89 @@ k4a_result_t depth_start(depth_t depth_handle, const k4a_device_configuration_t
  */
 void depth_stop(depth_t depth_handle);
 
+/** Sets the allocator of the depth buffers
+ *
+ * \param depth_handle [IN]
+ * Handle to the depth device
+ *
+ * \param hook [IN]
+ * Allocator callbacks used for the USB transfers and the depth engine output, NULL for the process allocator
+ *
+ * \return ::K4A_RESULT_SUCCEEDED if the allocator was set, ::K4A_RESULT_FAILED if the sensor is running
+ */
+k4a_result_t depth_set_allocator(depth_t depth_handle, const allocator_hook_t *hook);
+
+/** Selects the GPU the depth engine runs on
+ *
+ * \param depth_handle [IN]
+ * Handle to the depth device
+ *
+ * \param gpu_index [IN]
+ * GPU index, ::K4A_DEPTH_ENGINE_GPU_DEFAULT or ::K4A_DEPTH_ENGINE_GPU_ROUND_ROBIN
+ *
+ * \return ::K4A_RESULT_SUCCEEDED if the GPU was set, ::K4A_RESULT_FAILED if the sensor is running or the depth engine
+ * can't use the GPU
+ */
+k4a_result_t depth_set_depth_engine_gpu(depth_t depth_handle, int32_t gpu_index);
+
+/** Sets the filters applied to the depth images
+ *
+ * \param depth_handle [IN]
+ * Handle to the depth device
+ *
+ * \param config [IN]
+ * Filters used from the next start, NULL to disable them
+ *
+ * \return ::K4A_RESULT_SUCCEEDED if the filters were set, ::K4A_RESULT_FAILED if the sensor is running or config is
+ * out of range
+ */
+k4a_result_t depth_set_depth_filter(depth_t depth_handle, const k4a_depth_filter_configuration_t *config);
+
+/** Keeps the depth engine alive while the sensor is stopped
+ *
+ * \param depth_handle [IN]
+ * Handle to the depth device
+ *
+ * \param keep_alive [IN]
+ * True to reuse the depth engine when the sensor restarts with the same depth mode
+ */
+k4a_result_t depth_set_depth_engine_keep_alive(depth_t depth_handle, bool keep_alive);
+
+/** Gets the statistics of the GPU the depth engine runs on
+ *
+ * \param depth_handle [IN]
+ * Handle to the depth device
+ *
+ * \param statistics [OUT]
+ * Location to write the statistics to
+ */
+k4a_result_t depth_get_depth_engine_gpu_statistics(depth_t depth_handle, k4a_depth_engine_gpu_statistics_t *statistics);
+
+/** Gets the depth engine timing, the depth stream drop counter and the USB transfer and buffer pool counters
+ *
+ * \param depth_handle [IN]
+ * Handle to the depth device
+ *
+ * \param statistics [OUT]
+ * Location to write the depth_engine_* and usb_* fields to, other fields are left unchanged
+ */
+k4a_result_t depth_get_statistics(depth_t depth_handle, k4a_device_statistics_t *statistics);
+
+/** Gets the calibration blob the depth engine is started with
+ *
+ * \param depth_handle [IN]
+ * Handle to the depth device
+ *
+ * \param data [OUT]
+ * Location to write the calibration to, NULL to query its size
+ *
+ * \param data_size [IN OUT]
+ * Size of data, set to the size of the calibration
+ *
+ * The calibration is read from the sensor by the first depth_start(), K4A_BUFFER_RESULT_FAILED is returned before.
+ */
+k4a_buffer_result_t depth_get_raw_calibration(depth_t depth_handle, uint8_t *data, size_t *data_size);
+
 #ifdef __cplusplus
 }
 #endif
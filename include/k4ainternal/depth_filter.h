@@ -0,0 +1,78 @@
+/** \file depth_filter.h
+ * Copyright (c) Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License.
+ * Kinect For Azure SDK.
+ */
+
+#ifndef DEPTH_FILTER_H
+#define DEPTH_FILTER_H
+
+#include <k4a/k4atypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Post-processing of the depth images of one stream, see \ref k4a_depth_filter_configuration_t.
+ *
+ * \remarks
+ * The filter keeps the temporal history of the stream, so it processes the images of a stream in order from one
+ * thread.
+ */
+typedef struct _depth_filter_t depth_filter_t;
+
+/** Checks the parameters of the filters enabled in config
+ *
+ * \return true if config can be passed to \ref depth_filter_create
+ */
+bool depth_filter_configuration_is_valid(const k4a_depth_filter_configuration_t *config);
+
+/** Checks if config enables any filter
+ *
+ * \return false if \ref depth_filter_process would leave images unchanged
+ */
+bool depth_filter_configuration_is_enabled(const k4a_depth_filter_configuration_t *config);
+
+/** Creates a filter for depth images of width x height pixels
+ *
+ * \param config
+ * filters to apply, the filter keeps a copy
+ *
+ * \param width
+ * width in pixels of the images, also their stride
+ *
+ * \param height
+ * height in pixels of the images
+ *
+ * \return NULL if failed, otherwise the filter to destroy with \ref depth_filter_destroy
+ */
+depth_filter_t *depth_filter_create(const k4a_depth_filter_configuration_t *config, uint32_t width, uint32_t height);
+
+void depth_filter_destroy(depth_filter_t *filter);
+
+/** Forgets the temporal history, the next image is filtered as the first one of a stream */
+void depth_filter_reset(depth_filter_t *filter);
+
+/** Filters a DEPTH16 image in place
+ *
+ * \param filter
+ * filter created for the size of the image
+ *
+ * \param depth
+ * image to filter, width x height pixels without padding
+ *
+ * \param width
+ * width in pixels of the image
+ *
+ * \param height
+ * height in pixels of the image
+ *
+ * \return ::K4A_RESULT_FAILED if the image size is not the one the filter was created for, the image is left unchanged
+ */
+k4a_result_t depth_filter_process(depth_filter_t *filter, uint16_t *depth, uint32_t width, uint32_t height);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DEPTH_FILTER_H */
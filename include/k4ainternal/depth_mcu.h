@@ -103,6 +103,33 @@ k4a_result_t depthmcu_depth_start_streaming(depthmcu_t depthmcu_handle,
 
 void depthmcu_depth_stop_streaming(depthmcu_t depthmcu_handle, bool quiet);
 
+/** Limit the USB transfers used by the next depth stream, 0 for the defaults. See \ref
+ * usb_cmd_stream_set_transfer_limits
+ */
+k4a_result_t depthmcu_depth_set_transfer_limits(depthmcu_t depthmcu_handle,
+                                                uint32_t max_transfer_count,
+                                                size_t max_transfer_pool_size);
+
+/** Set the allocator of the buffers used by the next depth stream. See \ref usb_cmd_stream_set_allocator
+ */
+k4a_result_t depthmcu_depth_set_allocator(depthmcu_t depthmcu_handle, const allocator_hook_t *hook);
+
+/** Pre-fault the buffers of the next depth stream. See \ref usb_cmd_stream_set_prefault
+ */
+k4a_result_t depthmcu_depth_set_prefault(depthmcu_t depthmcu_handle, bool prefault);
+
+/** Get the size of the raw frames of the capture mode set last with \ref depthmcu_depth_set_capture_mode.
+ */
+k4a_result_t depthmcu_depth_get_frame_size(depthmcu_t depthmcu_handle, size_t *frame_size);
+
+/** Get the number of USB transfers the current (or last) depth stream submitted.
+ */
+k4a_result_t depthmcu_depth_get_transfer_count(depthmcu_t depthmcu_handle, uint32_t *transfer_count);
+
+/** Get the buffer pool and transfer counters of the depth stream. See \ref usb_cmd_get_stream_pool_stats
+ */
+k4a_result_t depthmcu_depth_get_pool_stats(depthmcu_t depthmcu_handle, usb_cmd_stream_pool_stats_t *stats);
+
 k4a_result_t depthmcu_depth_set_capture_mode(depthmcu_t depthmcu_handle, k4a_depth_mode_t depth_mode);
 k4a_result_t depthmcu_depth_get_capture_mode(depthmcu_t depthmcu_handle, k4a_depth_mode_t *depth_mode);
 
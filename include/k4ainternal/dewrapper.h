@@ -49,11 +49,32 @@ dewrapper_t dewrapper_create(k4a_calibration_camera_t *calibration,
                              dewrapper_streaming_capture_cb_t *capture_ready,
                              void *capture_ready_context);
 void dewrapper_destroy(dewrapper_t dewrapper_handle);
+// When the plugin implements depth_engine_submit_frame(), up to 2 frames are overlapped in the depth engine. The
+// K4A_DEPTH_ENGINE_FRAMES_IN_FLIGHT environment variable sets this from 1 to K4A_PLUGIN_MAX_FRAMES_IN_FLIGHT.
 k4a_result_t dewrapper_start(dewrapper_t dewrapper_handle,
                              const k4a_device_configuration_t *config,
+                             const k4a_device_start_options_t *options,
                              uint8_t *calibration_memory,
                              size_t calibration_memory_size);
 void dewrapper_stop(dewrapper_t dewrapper_handle);
+// Allocator of the depth engine output buffers, used from the next dewrapper_start(). Fails while started.
+k4a_result_t dewrapper_set_allocator(dewrapper_t dewrapper_handle, const allocator_hook_t *hook);
+// GPU index, K4A_DEPTH_ENGINE_GPU_DEFAULT or K4A_DEPTH_ENGINE_GPU_ROUND_ROBIN, used from the next dewrapper_start().
+// Fails while started or if the depth engine can't use the GPU.
+k4a_result_t dewrapper_set_gpu(dewrapper_t dewrapper_handle, int32_t gpu_index);
+// Depth filters, NULL to disable them, used from the next dewrapper_start(). Fails while started or if config is out
+// of range.
+k4a_result_t dewrapper_set_depth_filter(dewrapper_t dewrapper_handle, const k4a_depth_filter_configuration_t *config);
+// Keep the depth engine thread and its depth engine alive across dewrapper_stop(), so the next dewrapper_start() with
+// the same depth mode skips creating the depth engine. Disabling it destroys a depth engine kept alive.
+void dewrapper_set_keep_alive(dewrapper_t dewrapper_handle, bool keep_alive);
+// Pre-fault the output buffers and run a zeroed raw frame of raw_frame_size bytes through the depth engine before the
+// next dewrapper_start() returns, 0 to start without warming up
+void dewrapper_set_warm_up(dewrapper_t dewrapper_handle, size_t raw_frame_size);
+// Statistics of the GPU the depth engine runs on, or ran on last
+k4a_result_t dewrapper_get_gpu_statistics(dewrapper_t dewrapper_handle, k4a_depth_engine_gpu_statistics_t *statistics);
+// Fills the depth_engine_* fields of statistics with this device's frames since dewrapper_create()
+k4a_result_t dewrapper_get_statistics(dewrapper_t dewrapper_handle, k4a_device_statistics_t *statistics);
 void dewrapper_post_capture(k4a_result_t cb_result, k4a_capture_t capture_raw, void *context);
 
 #ifdef __cplusplus
@@ -65,6 +65,39 @@ typedef struct _firmware_package_info_t
     k4a_firmware_signature_t certificate_type;
 } firmware_package_info_t;
 
+typedef enum
+{
+    FIRMWARE_UPDATE_STAGE_CONNECTING = 0, /**< Opening the device and reading its current versions */
+    FIRMWARE_UPDATE_STAGE_DOWNLOADING,    /**< Sending the package to the device */
+    FIRMWARE_UPDATE_STAGE_UPDATING,       /**< The device is flashing the package, status holds its progress */
+    FIRMWARE_UPDATE_STAGE_RESETTING,      /**< Resetting the device and waiting for it to re-enumerate */
+    FIRMWARE_UPDATE_STAGE_COMPLETE        /**< The update has finished, result holds its outcome */
+} firmware_update_stage_t;
+
+/** State of one device updated by \ref firmware_update_devices */
+typedef struct _firmware_update_device_t
+{
+    char *serial_number; /**< Set by the caller, the device to update */
+
+    firmware_update_stage_t stage;
+    k4a_result_t result; /**< K4A_RESULT_SUCCEEDED once every component was updated or skipped and the device reset */
+
+    bool current_version_valid;
+    k4a_hardware_version_t current_version; /**< Versions before the update */
+
+    bool status_valid;
+    firmware_status_summary_t status; /**< Last status read while updating */
+
+    bool updated_version_valid;
+    k4a_hardware_version_t updated_version; /**< Versions after the reset */
+} firmware_update_device_t;
+
+/** Called by \ref firmware_update_devices when a device changes stage or reports a new status.
+ *
+ * Calls are serialized across devices and must not block for long, the updates of the other devices wait for them.
+ */
+typedef void(firmware_update_progress_cb_t)(const firmware_update_device_t *device, void *context);
+
 k4a_result_t firmware_create(char *device_serial_number, bool resetting_device, firmware_t *firmware_handle);
 void firmware_destroy(firmware_t firmware_handle);
 
@@ -78,6 +111,32 @@ k4a_result_t firmware_get_device_version(firmware_t firmware_handle, k4a_hardwar
 
 k4a_result_t parse_firmware_package(firmware_package_info_t *package_info);
 
+/** Update several devices concurrently with one parsed package.
+ *
+ * \param package_info [IN]
+ * package loaded by the caller and checked with \ref parse_firmware_package. Its buffer is shared by all devices.
+ *
+ * \param devices [IN OUT]
+ * devices to update, each with serial_number set. The other fields are written as the updates progress.
+ *
+ * \param device_count [IN]
+ * number of entries in \p devices
+ *
+ * \param progress_cb [IN]
+ * optional callback reporting the progress of each device
+ *
+ * \param progress_context [IN]
+ * argument of \p progress_cb
+ *
+ * Each device is connected, downloaded, polled until its update finishes and reset on its own thread. Returns
+ * K4A_RESULT_SUCCEEDED once every device has completed and all of their results succeeded.
+ */
+k4a_result_t firmware_update_devices(const firmware_package_info_t *package_info,
+                                     firmware_update_device_t *devices,
+                                     uint32_t device_count,
+                                     firmware_update_progress_cb_t *progress_cb,
+                                     void *progress_context);
+
 // If successful, the user must free the serial number
 k4a_result_t firmware_get_serial_number(colormcu_t colormcu, depthmcu_t depthmcu, char **serial_number);
 
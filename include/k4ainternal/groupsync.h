@@ -0,0 +1,130 @@
+/** \file groupsync.h
+ * Copyright (c) Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License.
+ * Kinect For Azure SDK.
+ *
+ * Match the captures of several devices by time
+ */
+
+#ifndef GROUPSYNC_H
+#define GROUPSYNC_H
+
+#include <k4a/k4atypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Captures each device can have waiting for a match before its oldest are dropped */
+#define GROUPSYNC_MAX_PENDING_CAPTURES 8
+
+/** Handle to the groupsync module
+ *
+ * Handles are created with groupsync_create() and closed with groupsync_destroy().
+ * Invalid handles are set to 0.
+ */
+K4A_DECLARE_HANDLE(groupsync_t);
+
+/** Creates a groupsync instance
+ *
+ * \param device_count
+ * Number of devices whose captures are matched
+ *
+ * \param groupsync_handle
+ * pointer to a handle location to store the handle. This is only written on K4A_RESULT_SUCCEEDED;
+ *
+ * To cleanup this resource call groupsync_destroy().
+ *
+ * \ref K4A_RESULT_SUCCEEDED is returned on success
+ */
+k4a_result_t groupsync_create(uint32_t device_count, groupsync_t *groupsync_handle);
+
+/** Destroys a groupsync instance
+ *
+ * \param groupsync_handle
+ * The groupsync handle to destroy
+ *
+ * Captures still waiting for a match are released.
+ */
+void groupsync_destroy(groupsync_t groupsync_handle);
+
+/** Starts matching captures
+ *
+ * \param groupsync_handle
+ * The groupsync handle from groupsync_create()
+ *
+ * \param tolerance_usec
+ * Largest difference between the timestamps of captures that are matched, usually half the frame period
+ */
+k4a_result_t groupsync_start(groupsync_t groupsync_handle, uint32_t tolerance_usec);
+
+/** Stops matching captures
+ *
+ * \param groupsync_handle
+ * The groupsync handle from groupsync_create()
+ *
+ * \remarks
+ * Releases the captures waiting for a match and unblocks groupsync_get_captures(). Call this only once no more
+ * captures are added.
+ */
+void groupsync_stop(groupsync_t groupsync_handle);
+
+/** Adds the capture of one device
+ *
+ * \param groupsync_handle
+ * The groupsync handle from groupsync_create()
+ *
+ * \param device_index
+ * Index of the device the capture is from
+ *
+ * \param capture_handle
+ * The capture. groupsync takes its own reference.
+ *
+ * \param timestamp_usec
+ * Time of the capture, in a clock shared by every device of the group
+ *
+ * \remarks
+ * Each device must be added from one thread at a time. Adding never blocks: the captures of each device wait in a
+ * lock-free queue, and a capture is dropped when its device has GROUPSYNC_MAX_PENDING_CAPTURES waiting.
+ */
+void groupsync_add_capture(groupsync_t groupsync_handle,
+                           uint32_t device_index,
+                           k4a_capture_t capture_handle,
+                           int64_t timestamp_usec);
+
+/** Waits for the captures of every device taken at the same time
+ *
+ * \param groupsync_handle
+ * The groupsync handle from groupsync_create()
+ *
+ * \param capture_handles
+ * Location to write one capture per device to, in device order. The caller owns the references.
+ *
+ * \param timeout_in_ms
+ * Time to wait, 0 to not wait or K4A_WAIT_INFINITE
+ *
+ * \remarks
+ * Captures older than the newest waiting capture of another device by more than the tolerance have no match and are
+ * dropped. Only one thread may wait at a time.
+ *
+ * \ref K4A_WAIT_RESULT_FAILED is returned if groupsync is not started
+ */
+k4a_wait_result_t groupsync_get_captures(groupsync_t groupsync_handle,
+                                         k4a_capture_t *capture_handles,
+                                         int32_t timeout_in_ms);
+
+/** Gets the matching counters
+ *
+ * \param groupsync_handle
+ * The groupsync handle from groupsync_create()
+ *
+ * \param statistics
+ * Location to write the counters to
+ */
+k4a_result_t groupsync_get_statistics(groupsync_t groupsync_handle, k4a_device_group_statistics_t *statistics);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GROUPSYNC_H */
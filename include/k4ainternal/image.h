@@ -48,12 +48,39 @@ k4a_result_t image_create(k4a_image_format_t format,
                           allocation_source_t source,
                           k4a_image_t *image);
 
+/** Create a handle to an image object with an aligned buffer.
+ *
+ * \param alignment [IN]
+ * alignment of the image buffer in bytes, a power of 2 no larger than ALLOCATOR_MAX_ALIGNMENT
+ *
+ * Behaves like \ref image_create, which aligns buffers to ALLOCATOR_DEFAULT_ALIGNMENT. When stride_bytes is 0 the
+ * minimum stride is rounded up to a multiple of alignment so that every row is aligned.
+ */
+k4a_result_t image_create_aligned(k4a_image_format_t format,
+                                  int width_pixels,
+                                  int height_pixels,
+                                  int stride_bytes,
+                                  size_t alignment,
+                                  allocation_source_t source,
+                                  k4a_image_t *image);
+
 /** Create a handle to an image object.
  * internal function to allocate an image object and memory blob of 'size'. Used for USB layer where we need counted
  * objects and don't know anything about the image. Also wrapped by IMU but never exposed.
  */
 k4a_result_t image_create_empty_internal(allocation_source_t source, size_t size, k4a_image_t *image);
 
+/** Create a handle to an image object around a buffer the caller manages.
+ * internal counterpart to \ref image_create_empty_internal for callers that recycle their own buffers, such as the USB
+ * streaming buffer pool. buffer_destroy_cb is called with buffer_destroy_cb_context when the last reference to the
+ * image is released. If this function fails the caller still owns the buffer.
+ */
+k4a_result_t image_create_empty_from_buffer_internal(uint8_t *buffer,
+                                                     size_t buffer_size,
+                                                     image_destroy_cb_t *buffer_destroy_cb,
+                                                     void *buffer_destroy_cb_context,
+                                                     k4a_image_t *image);
+
 /** Create a handle to an image object.
  * \param format [IN]
  * format of the image being created.
@@ -97,6 +124,39 @@ k4a_result_t image_create_from_buffer(k4a_image_format_t format,
                                       void *buffer_destroy_cb_context,
                                       k4a_image_t *image_handle);
 
+/** Create an image of a rectangle of another image, sharing its buffer.
+ *
+ * \param parent_handle [IN]
+ * image the view is of, which the view keeps a reference to
+ *
+ * \param x [IN]
+ * \param y [IN]
+ * top left pixel of the view in the parent
+ *
+ * \param width_pixels [IN]
+ * \param height_pixels [IN]
+ * size of the view, which must fit in the parent
+ *
+ * \param image_handle [OUT]
+ * location to write the view to
+ *
+ * The view has the parent's stride, format and metadata. Views of NV12 images are K4A_IMAGE_FORMAT_CUSTOM8 images of
+ * the Y plane. Formats without a constant pixel size, MJPG and custom, can't be viewed.
+ */
+k4a_result_t image_create_view(k4a_image_t parent_handle,
+                               int x,
+                               int y,
+                               int width_pixels,
+                               int height_pixels,
+                               k4a_image_t *image_handle);
+
+/** Bytes per pixel of the first plane for formats with a constant stride, 0 otherwise
+ *
+ * \param format [IN]
+ * format of the image
+ */
+int image_get_bytes_per_pixel(k4a_image_format_t format);
+
 /** Removes one reference on image_t, free's when it hits zero
  *
  * \param image_handle [IN]
@@ -123,13 +183,117 @@ uint64_t image_get_system_timestamp_nsec(k4a_image_t image_handle);
 uint64_t image_get_exposure_usec(k4a_image_t image_handle);
 uint32_t image_get_white_balance(k4a_image_t image_handle);
 uint32_t image_get_iso_speed(k4a_image_t image_handle);
+k4a_result_t image_get_info(k4a_image_t image_handle, k4a_image_info_t *info);
+k4a_result_t image_get_view(k4a_image_t image_handle, k4a_image_view_t *view);
 void image_set_device_timestamp_usec(k4a_image_t image_handle, uint64_t timestamp_usec);
 void image_set_system_timestamp_nsec(k4a_image_t image_handle, uint64_t timestamp_nsec);
 k4a_result_t image_apply_system_timestamp(k4a_image_t image_handle);
+uint64_t image_get_stage_timestamp_nsec(k4a_image_t image_handle, k4a_image_stage_t stage);
+void image_set_stage_timestamp_nsec(k4a_image_t image_handle, k4a_image_stage_t stage, uint64_t timestamp_nsec);
+
+/** Reads the host clock of system and stage timestamps
+ *
+ * \return the time in nanoseconds, 0 if the clock could not be read
+ */
+uint64_t image_get_system_time_nsec(void);
 void image_set_exposure_usec(k4a_image_t image_handle, uint64_t exposure_usec);
 void image_set_white_balance(k4a_image_t image_handle, uint32_t white_balance);
 void image_set_iso_speed(k4a_image_t image_handle, uint32_t iso_speed);
 
+/** Converts an NV12, YUY2 or BGRA32 color image to a BGRA32 image of the same size
+ *
+ * \param source_image [IN]
+ * Image to convert
+ *
+ * \param bgra_image [IN]
+ * BGRA32 image written with the converted pixels and the metadata of the source
+ *
+ * \return ::K4A_RESULT_SUCCEEDED if the image was converted
+ */
+k4a_result_t image_convert_to_bgra32(k4a_image_t source_image, k4a_image_t bgra_image);
+
+/** Converts a BGRA32 image to an NV12 or YUY2 image of the same size
+ *
+ * \param bgra_image [IN]
+ * Image to convert
+ *
+ * \param output_image [IN]
+ * NV12 or YUY2 image written with the converted pixels and the metadata of the source
+ *
+ * \return ::K4A_RESULT_SUCCEEDED if the image was converted
+ */
+k4a_result_t image_convert_from_bgra32(k4a_image_t bgra_image, k4a_image_t output_image);
+
+/** Writes the luminance of an NV12, YUY2 or BGRA32 color image to a CUSTOM8 image of the same size
+ *
+ * \param color_image [IN]
+ * Image to convert
+ *
+ * \param custom8_image [IN]
+ * CUSTOM8 image written with the luminance and the metadata of the source
+ *
+ * \return ::K4A_RESULT_SUCCEEDED if the image was converted
+ */
+k4a_result_t image_convert_to_grayscale(k4a_image_t color_image, k4a_image_t custom8_image);
+
+/** Converts a DEPTH16, IR16 or CUSTOM16 image to a CUSTOM image of floats of the same size
+ *
+ * \param source_image [IN]
+ * Image to convert
+ *
+ * \param scale [IN]
+ * Factor each pixel is multiplied by, 0.001 converts depth in millimeters to meters
+ *
+ * \param float_image [IN]
+ * CUSTOM image with rows of at least 4 bytes per pixel, written with the converted pixels and the metadata of the
+ * source
+ *
+ * \return ::K4A_RESULT_SUCCEEDED if the image was converted
+ */
+k4a_result_t image_convert_to_float(k4a_image_t source_image, float scale, k4a_image_t float_image);
+
+/** Normalizes a range of a DEPTH16, IR16 or CUSTOM16 image to a CUSTOM8 image of the same size
+ *
+ * \param source_image [IN]
+ * Image to convert
+ *
+ * \param min_value [IN]
+ * \param max_value [IN]
+ * Values written as 0 and 255, values outside the range are clamped to it
+ *
+ * \param custom8_image [IN]
+ * CUSTOM8 image written with the converted pixels and the metadata of the source
+ *
+ * \return ::K4A_RESULT_SUCCEEDED if the image was converted
+ */
+k4a_result_t image_convert_to_custom8(k4a_image_t source_image,
+                                      uint16_t min_value,
+                                      uint16_t max_value,
+                                      k4a_image_t custom8_image);
+
+/** Colors a range of a DEPTH16, IR16 or CUSTOM16 image into a BGRA32 image of the same size
+ *
+ * \param source_image [IN]
+ * Image to convert
+ *
+ * \param min_value [IN]
+ * \param max_value [IN]
+ * Values at the ends of the colormap, values outside the range are clamped to it
+ *
+ * \param colormap [IN]
+ * Colors to map the range to
+ *
+ * \param bgra_image [IN]
+ * BGRA32 image written with the colors and the metadata of the source
+ *
+ * \return ::K4A_RESULT_SUCCEEDED if the image was converted
+ */
+k4a_result_t image_colorize(k4a_image_t source_image,
+                            uint16_t min_value,
+                            uint16_t max_value,
+                            k4a_colormap_t colormap,
+                            k4a_image_t bgra_image);
+
 #ifdef __cplusplus
 }
 #endif
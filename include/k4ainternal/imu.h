@@ -58,6 +58,60 @@ void imu_destroy(imu_t imu_handle);
 
 k4a_wait_result_t imu_get_sample(imu_t imu_handle, k4a_imu_sample_t *imu_sample, int32_t timeout_in_ms);
 
+/** Reads up to max_samples IMU samples, waiting up to timeout_in_ms for the first one
+ *
+ * \param imu_handle [IN]
+ * The IMU device handle.
+ *
+ * \param imu_samples [OUT]
+ * Array of max_samples samples to write to.
+ *
+ * \param max_samples [IN]
+ * The number of samples imu_samples can hold.
+ *
+ * \param sample_count [OUT]
+ * The number of samples written to imu_samples.
+ *
+ * \param timeout_in_ms [IN]
+ * Time to wait for the first sample, samples after the first are only returned if they are already queued.
+ *
+ * \return ::K4A_WAIT_RESULT_SUCCEEDED if at least one sample was read, ::K4A_WAIT_RESULT_TIMEOUT if no sample arrived in
+ * time and ::K4A_WAIT_RESULT_FAILED on error.
+ */
+k4a_wait_result_t imu_get_samples(imu_t imu_handle,
+                                  k4a_imu_sample_t *imu_samples,
+                                  size_t max_samples,
+                                  size_t *sample_count,
+                                  int32_t timeout_in_ms);
+
+/** Reads the newest IMU sample, dropping the older queued ones, waiting up to timeout_in_ms if none is queued
+ *
+ * \param imu_handle [IN]
+ * The IMU device handle.
+ *
+ * \param imu_sample [OUT]
+ * Location to write the sample to.
+ *
+ * \param timeout_in_ms [IN]
+ * Time to wait for a sample when none is queued.
+ *
+ * \return ::K4A_WAIT_RESULT_SUCCEEDED if a sample was read, ::K4A_WAIT_RESULT_TIMEOUT if no sample arrived in time and
+ * ::K4A_WAIT_RESULT_FAILED on error.
+ */
+k4a_wait_result_t imu_get_latest_sample(imu_t imu_handle, k4a_imu_sample_t *imu_sample, int32_t timeout_in_ms);
+
+/** Gets an operating system object that is signaled while IMU samples are queued
+ *
+ * \param imu_handle [IN]
+ * The IMU device handle.
+ *
+ * \param wait_handle [OUT]
+ * Location to write the handle to, valid until imu_destroy().
+ *
+ * \return ::K4A_RESULT_SUCCEEDED if the handle was written, ::K4A_RESULT_FAILED otherwise.
+ */
+k4a_result_t imu_get_wait_handle(imu_t imu_handle, k4a_wait_handle_t *wait_handle);
+
 /** Starts the IMU sensor streaming
  *
  * \param imu_handle [IN]
@@ -83,6 +137,92 @@ k4a_result_t imu_start(imu_t imu_handle, tickcounter_ms_t color_camera_start_tic
  */
 void imu_stop(imu_t imu_handle);
 
+/** Deliver IMU samples to a callback instead of the queue read by imu_get_sample()
+ *
+ * \param imu_handle [IN]
+ * The IMU device handle.
+ *
+ * \param callback [IN]
+ * Function called with each sample on the IMU streaming thread, NULL to return to queueing samples.
+ *
+ * \param context [IN]
+ * Passed to every call to callback.
+ *
+ * \return ::K4A_RESULT_SUCCEEDED if the callback was set. ::K4A_RESULT_FAILED if the IMU is running.
+ */
+k4a_result_t imu_set_callback(imu_t imu_handle, k4a_imu_sample_ready_cb_t *callback, void *context);
+
+/** Function called with each batch of calibrated IMU samples, see imu_set_sample_listener() */
+typedef void(imu_sample_listener_t)(const k4a_imu_sample_t *samples, size_t sample_count, void *context);
+
+/** Pass the calibrated IMU samples to another module as well as to the queue or callback
+ *
+ * \param imu_handle [IN]
+ * The IMU device handle.
+ *
+ * \param listener [IN]
+ * Function called on the IMU streaming thread with the samples of each packet, before they are delivered. NULL to
+ * remove the listener.
+ *
+ * \param context [IN]
+ * Passed to every call to listener.
+ *
+ * \return ::K4A_RESULT_SUCCEEDED if the listener was set. ::K4A_RESULT_FAILED if the IMU is running.
+ */
+k4a_result_t imu_set_sample_listener(imu_t imu_handle, imu_sample_listener_t *listener, void *context);
+
+/** Enable or disable the preintegration of the calibrated IMU samples, see imu_get_preintegration()
+ *
+ * \param imu_handle [IN]
+ * The IMU device handle.
+ *
+ * \param enabled [IN]
+ * true to integrate the samples as they arrive, false to stop and free the history.
+ *
+ * \return ::K4A_RESULT_SUCCEEDED if the preintegration was changed. ::K4A_RESULT_FAILED if the IMU is running or the
+ * history could not be allocated.
+ */
+k4a_result_t imu_set_preintegration(imu_t imu_handle, bool enabled);
+
+/** Get the motion of the IMU between two device timestamps
+ *
+ * \param imu_handle [IN]
+ * The IMU device handle.
+ *
+ * \param start_timestamp_usec [IN]
+ * Device timestamp the motion starts at, within the last 2 seconds of samples.
+ *
+ * \param end_timestamp_usec [IN]
+ * Device timestamp the motion ends at, not before start_timestamp_usec.
+ *
+ * \param preintegration [OUT]
+ * Written with the motion on success.
+ *
+ * \param timeout_in_ms [IN]
+ * Time to wait for a sample at or after end_timestamp_usec.
+ *
+ * \return ::K4A_WAIT_RESULT_SUCCEEDED if the motion was written. ::K4A_WAIT_RESULT_TIMEOUT if no sample reached
+ * end_timestamp_usec in time. ::K4A_WAIT_RESULT_FAILED if preintegration is disabled, the IMU stopped or
+ * start_timestamp_usec is no longer in the history.
+ */
+k4a_wait_result_t imu_get_preintegration(imu_t imu_handle,
+                                         uint64_t start_timestamp_usec,
+                                         uint64_t end_timestamp_usec,
+                                         k4a_imu_preintegration_t *preintegration,
+                                         int32_t timeout_in_ms);
+
+/** Fill in the IMU sample counters of the device statistics
+ *
+ * \param imu_handle [IN]
+ * The IMU device handle.
+ *
+ * \param statistics [OUT]
+ * Statistics to fill in, only imu_sample_count and imu_dropped_count are written.
+ *
+ * \return ::K4A_RESULT_SUCCEEDED if the counters were written.
+ */
+k4a_result_t imu_get_statistics(imu_t imu_handle, k4a_device_statistics_t *statistics);
+
 /** Get the gyro extrinsic calibration data
  *
  * \param imu_handle [IN]
@@ -0,0 +1,86 @@
+/** \file imu_preintegration.h
+ * Copyright (c) Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License.
+ * Kinect For Azure SDK.
+ */
+
+#ifndef IMU_PREINTEGRATION_H
+#define IMU_PREINTEGRATION_H
+
+#include <k4a/k4atypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Preintegration of the calibrated IMU samples of one stream, see \ref k4a_imu_preintegration_t.
+ *
+ * \remarks
+ * Samples are added in order from the IMU streaming thread. The motion is integrated once per sample into a history of
+ * cumulative states, so the motion between any two timestamps of the history is found without integrating again.
+ * Queries may come from any thread.
+ */
+typedef struct _imu_preintegration_t imu_preintegration_t;
+
+/** Creates the preintegration of an IMU stream
+ *
+ * \param gyro_extrinsics
+ * extrinsics of the gyroscope, its rotation rates are turned into the coordinate system of the accelerometer
+ *
+ * \param accel_extrinsics
+ * extrinsics of the accelerometer, the coordinate system the motion is integrated in
+ *
+ * \param history_depth
+ * number of samples kept, queries can start at most this many samples before the newest sample
+ *
+ * \return NULL if failed, otherwise the preintegration to destroy with \ref imu_preintegration_destroy
+ */
+imu_preintegration_t *imu_preintegration_create(const k4a_calibration_extrinsics_t *gyro_extrinsics,
+                                                const k4a_calibration_extrinsics_t *accel_extrinsics,
+                                                uint32_t history_depth);
+
+void imu_preintegration_destroy(imu_preintegration_t *preintegration);
+
+/** Forgets the history and resumes the queries, the next sample starts a new stream */
+void imu_preintegration_reset(imu_preintegration_t *preintegration);
+
+/** Wakes queries waiting for samples and fails the next ones until \ref imu_preintegration_reset is called */
+void imu_preintegration_stop(imu_preintegration_t *preintegration);
+
+/** Integrates calibrated samples, in order of timestamp
+ *
+ * \remarks
+ * A sample with a timestamp before the previous one starts a new stream, as if \ref imu_preintegration_reset was
+ * called.
+ */
+void imu_preintegration_add_samples(imu_preintegration_t *preintegration,
+                                    const k4a_imu_sample_t *samples,
+                                    size_t sample_count);
+
+/** Gets the motion between two device timestamps
+ *
+ * \param start_timestamp_usec
+ * timestamp the motion starts from, within the history
+ *
+ * \param end_timestamp_usec
+ * timestamp the motion ends at, not before start_timestamp_usec
+ *
+ * \param preintegration_out
+ * written with the motion if K4A_WAIT_RESULT_SUCCEEDED is returned
+ *
+ * \param timeout_in_ms
+ * time to wait for a sample after end_timestamp_usec, K4A_WAIT_INFINITE to wait until the stream stops
+ *
+ * \return K4A_WAIT_RESULT_FAILED if start_timestamp_usec is no longer in the history or the stream stopped
+ */
+k4a_wait_result_t imu_preintegration_get(imu_preintegration_t *preintegration,
+                                         uint64_t start_timestamp_usec,
+                                         uint64_t end_timestamp_usec,
+                                         k4a_imu_preintegration_t *preintegration_out,
+                                         int32_t timeout_in_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IMU_PREINTEGRATION_H */
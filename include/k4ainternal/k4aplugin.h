@@ -34,6 +34,11 @@ extern "C" {
  */
 #define K4A_PLUGIN_VERSION 2 /**< Azure Kinect plugin version */
 
+/**
+ * Number of frames a plugin with \ref k4a_de_submit_frame_fn_t must be able to hold in flight
+ */
+#define K4A_PLUGIN_MAX_FRAMES_IN_FLIGHT 3
+
 /**
  * Expected name of plugin's dynamic library
  *
@@ -85,6 +90,8 @@ typedef enum
     K4A_DEPTH_ENGINE_OUTPUT_TYPE_Z_DEPTH = 0,  /**< Output z depth */
     K4A_DEPTH_ENGINE_OUTPUT_TYPE_RADIAL_DEPTH, /**< Output radial depth */
     K4A_DEPTH_ENGINE_OUTPUT_TYPE_PCM,          /**< Output passive ir */
+    K4A_DEPTH_ENGINE_OUTPUT_TYPE_Z_DEPTH_ONLY, /**< Output z depth without the ir image, see
+                                                    \ref k4a_de_get_output_frame_size_for_type_fn_t */
 } k4a_depth_engine_output_type_t;
 
 /** Depth Engine supported input formats
@@ -310,6 +317,63 @@ typedef k4a_depth_engine_result_code_t(__stdcall *k4a_de_create_and_initialize_f
     k4a_processing_complete_cb_t *callback,
     void *callback_context);
 
+/** Function for creating and initializing the depth engine on a given GPU.
+ *
+ * \param context
+ * An opaque pointer to be passed around to the rest of the depth engine calls.
+ *
+ * \param cal_block_size_in_bytes
+ * Size of the depth calibration blob being passed in, in bytes
+ *
+ * \param cal_block
+ * The depth calibration blob
+ *
+ * \param mode
+ * The \ref k4a_depth_engine_mode_t to initialize the depth engine
+ *
+ * \param input_format
+ * The \ref k4a_depth_engine_input_type_t being passed in
+ *
+ * \param camera_calibration
+ * The depth camera calibration blob
+ *
+ * \param callback
+ * Callback to call when processing is complete
+ *
+ * \param callback_context
+ * An optional context to be passed back to the callback
+ *
+ * \param gpu_index
+ * The GPU to process frames on, less than the count returned by \ref k4a_de_get_gpu_count_fn_t
+ *
+ * \returns
+ * K4A_DEPTH_ENGINE_RESULT_SUCCEEDED on success, or the proper failure code on
+ * failure
+ *
+ * \remarks
+ * Optional. A plugin that provides this must also provide \ref k4a_de_get_gpu_count_fn_t.
+ */
+typedef k4a_depth_engine_result_code_t(__stdcall *k4a_de_create_and_initialize_on_gpu_fn_t)(
+    k4a_depth_engine_context_t **context,
+    size_t cal_block_size_in_bytes,
+    void *cal_block,
+    k4a_depth_engine_mode_t mode,
+    k4a_depth_engine_input_type_t input_format,
+    void *camera_calibration,
+    k4a_processing_complete_cb_t *callback,
+    void *callback_context,
+    uint32_t gpu_index);
+
+/** Get the number of GPUs the depth engine can run on.
+ *
+ * \returns
+ * The number of GPUs, which are numbered from 0 for \ref k4a_de_create_and_initialize_on_gpu_fn_t
+ *
+ * \remarks
+ * Optional, see \ref k4a_de_create_and_initialize_on_gpu_fn_t.
+ */
+typedef uint32_t(__stdcall *k4a_de_get_gpu_count_fn_t)(void);
+
 /** Function to process depth frame.
  *
  * \param context
@@ -339,6 +403,11 @@ typedef k4a_depth_engine_result_code_t(__stdcall *k4a_de_create_and_initialize_f
  * \returns
  * K4A_DEPTH_ENGINE_RESULT_SUCCEEDED on success, or the proper failure code on
  * failure
+ *
+ * \remarks
+ * The SDK does not copy frames on either side of this call. input_frame is the buffer the USB transfer completed into
+ * and output_frame is taken from a pool of output_frame_size buffers. Both are recycled once the images referencing
+ * them are released, so the plugin must not keep either pointer after it returns.
  */
 typedef k4a_depth_engine_result_code_t(__stdcall *k4a_de_process_frame_fn_t)(
     k4a_depth_engine_context_t *context,
@@ -360,6 +429,102 @@ typedef k4a_depth_engine_result_code_t(__stdcall *k4a_de_process_frame_fn_t)(
  */
 typedef size_t(__stdcall *k4a_de_get_output_frame_size_fn_t)(k4a_depth_engine_context_t *context);
 
+/** Get the size of the output frame in bytes for a given output type.
+ *
+ * \param context
+ * context created by \ref k4a_de_create_and_initialize_fn_t
+ *
+ * \param output_type
+ * The type of frame the depth engine would output
+ *
+ * \returns
+ * The size of the output frame in bytes, or 0 if the depth engine can't output the type
+ *
+ * \remarks
+ * Optional. Without it only the types every depth engine supports are used, with the frame size returned by \ref
+ * k4a_de_get_output_frame_size_fn_t. A depth engine that returns a size for ::K4A_DEPTH_ENGINE_OUTPUT_TYPE_Z_DEPTH_ONLY
+ * writes only the depth image to the output frame and skips reading the ir image back.
+ */
+typedef size_t(__stdcall *k4a_de_get_output_frame_size_for_type_fn_t)(k4a_depth_engine_context_t *context,
+                                                                      k4a_depth_engine_output_type_t output_type);
+
+/** Set the directory the depth engine keeps compiled shaders in.
+ *
+ * \param directory
+ * Path of the directory, which may not exist yet
+ *
+ * \returns
+ * True if the depth engine will load and store compiled shaders in the directory
+ *
+ * \remarks
+ * Optional. Called once after the plugin is registered, before any depth engine is created, when the
+ * K4A_DEPTH_ENGINE_CACHE_DIR environment variable is set. Shaders compiled by an earlier process are reused instead of
+ * being compiled again when a depth engine is created.
+ */
+typedef bool(__stdcall *k4a_de_set_cache_directory_fn_t)(const char *directory);
+
+/** Function to queue a depth frame for processing without waiting for it to complete.
+ *
+ * \param context
+ * context created by \ref k4a_de_create_and_initialize_fn_t
+ *
+ * \param input_frame
+ * Input frame buffer containing depth raw captured data
+ *
+ * \param input_frame_size
+ * Size of the input_frame buffer in bytes
+ *
+ * \param output_type
+ * The type of frame the depth engine should output
+ *
+ * \param output_frame
+ * The buffer of the output frame
+ *
+ * \param output_frame_size in bytes
+ * The size of the output_frame buffer
+ *
+ * \param frame_context
+ * Opaque value returned by \ref k4a_de_complete_frame_fn_t for this frame
+ *
+ * \returns
+ * K4A_DEPTH_ENGINE_RESULT_SUCCEEDED if the frame was queued, or the proper failure code on failure
+ *
+ * \remarks
+ * Optional. A plugin that provides this must also provide \ref k4a_de_complete_frame_fn_t, and must accept at least
+ * K4A_PLUGIN_MAX_FRAMES_IN_FLIGHT frames that have been submitted but not completed, so the upload, compute and
+ * readback of consecutive frames can overlap. input_frame and output_frame remain valid until the frame completes.
+ */
+typedef k4a_depth_engine_result_code_t(__stdcall *k4a_de_submit_frame_fn_t)(k4a_depth_engine_context_t *context,
+                                                                            void *input_frame,
+                                                                            size_t input_frame_size,
+                                                                            k4a_depth_engine_output_type_t output_type,
+                                                                            void *output_frame,
+                                                                            size_t output_frame_size,
+                                                                            void *frame_context);
+
+/** Function to wait for the oldest submitted depth frame to complete.
+ *
+ * \param context
+ * context created by \ref k4a_de_create_and_initialize_fn_t
+ *
+ * \param frame_context
+ * Set to the frame_context the completed frame was submitted with
+ *
+ * \param output_frame_info
+ * The depth frame output information
+ *
+ * \returns
+ * The result of processing the frame, as \ref k4a_de_process_frame_fn_t would have returned it
+ *
+ * \remarks
+ * Optional, see \ref k4a_de_submit_frame_fn_t. Frames complete in the order they were submitted. frame_context is set
+ * even when processing failed, so the caller can release the frame's buffers.
+ */
+typedef k4a_depth_engine_result_code_t(__stdcall *k4a_de_complete_frame_fn_t)(
+    k4a_depth_engine_context_t *context,
+    void **frame_context,
+    k4a_depth_engine_output_frame_info_t *output_frame_info);
+
 /** Destroys the depth engine context.
  *
  * \param context
@@ -475,6 +640,10 @@ typedef void(__stdcall *k4a_te_destroy_fn_t)(k4a_transform_engine_context_t **co
  * k4a_plugin_t. The plugin must properly fill out all fields of the plugin for
  * the Azure Kinect SDK to accept the plugin.
  *
+ * \remarks
+ * The fields marked optional are zero when k4a_register_plugin is called and may be left NULL. They are appended to the
+ * end of the structure so plugins built against an earlier header keep working with the same K4A_PLUGIN_VERSION.
+ *
  * \xmlonly
  * <requirements>
  *   <requirement name="Header">k4aplugin.h (include k4a/k4aplugin.h)</requirement>
@@ -502,6 +671,21 @@ typedef struct _k4a_plugin_t
                                                                                  transform_engine_get_output_frame_size
                                                                                  function */
     k4a_te_destroy_fn_t transform_engine_destroy; /**< Function pointer to a transform_engine_destroy function */
+    k4a_de_submit_frame_fn_t depth_engine_submit_frame;     /**< Optional function pointer to a
+                                                               depth_engine_submit_frame function */
+    k4a_de_complete_frame_fn_t depth_engine_complete_frame; /**< Optional function pointer to a
+                                                               depth_engine_complete_frame function */
+    k4a_de_create_and_initialize_on_gpu_fn_t depth_engine_create_and_initialize_on_gpu; /**< Optional function pointer
+                                                                                           to a depth engine create and
+                                                                                           initialize on GPU function */
+    k4a_de_get_gpu_count_fn_t depth_engine_get_gpu_count; /**< Optional function pointer to a
+                                                             depth_engine_get_gpu_count function */
+    k4a_de_get_output_frame_size_for_type_fn_t depth_engine_get_output_frame_size_for_type; /**< Optional function
+                                                                                               pointer to a depth engine
+                                                                                               get output frame size for
+                                                                                               type function */
+    k4a_de_set_cache_directory_fn_t depth_engine_set_cache_directory; /**< Optional function pointer to a
+                                                                         depth_engine_set_cache_directory function */
 } k4a_plugin_t;
 
 /** Function signature for \ref K4A_PLUGIN_EXPORTED_FUNCTION.
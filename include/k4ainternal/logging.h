@@ -13,6 +13,7 @@
 // System dependencies
 #include <string.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -59,6 +60,28 @@ k4a_result_t logger_register_message_callback(k4a_logging_message_cb_t *message_
 
 void logger_log(k4a_log_level_t level, const char *file, const int line, const char *format, ...);
 
+/** The most verbose level accepted by the registered callback or the environment logger, -1 if neither accepts
+ * messages. Read with logger_is_enabled().
+ *
+ * \remarks
+ * This is K4A_LOG_LEVEL_TRACE until the logger is initialized, so the first message initializes it through
+ * logger_log().
+ */
+extern volatile int32_t g_logger_max_level;
+
+/** true if a message of the given level could be logged. This is a single relaxed load, so the LOG_* macros call it
+ * before evaluating their arguments or formatting the message.
+ */
+FORCEINLINE bool logger_is_enabled(k4a_log_level_t level)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (int32_t)level <= __atomic_load_n(&g_logger_max_level, __ATOMIC_RELAXED);
+#else
+    // Aligned volatile 32 bit loads are atomic with MSVC
+    return (int32_t)level <= g_logger_max_level;
+#endif
+}
+
 FORCEINLINE k4a_result_t
 TraceError(k4a_result_t result, const char *szCall, const char *szFile, int line, const char *szFunction)
 {
@@ -203,19 +226,16 @@ FORCEINLINE void TraceInvalidHandle(int result,
         TraceInvalidHandle(1, __FILE__, __LINE__, __func__, #_type_, #_handle_, _handle_);                             \
     }
 
-// Logs a message
-#define LOG_TRACE(message, ...)                                                                                        \
-    logger_log(K4A_LOG_LEVEL_TRACE, __FILE__, __LINE__, "%s(). " message, __func__, __VA_ARGS__)
-#define LOG_INFO(message, ...)                                                                                         \
-    logger_log(K4A_LOG_LEVEL_INFO, __FILE__, __LINE__, "%s(). " message, __func__, __VA_ARGS__)
-#define LOG_WARNING(message, ...)                                                                                      \
-    logger_log(K4A_LOG_LEVEL_WARNING, __FILE__, __LINE__, "%s(). " message, __func__, __VA_ARGS__)
-#define LOG_ERROR(message, ...)                                                                                        \
-    logger_log(K4A_LOG_LEVEL_ERROR, __FILE__, __LINE__, "%s(). " message, __func__, __VA_ARGS__)
-#define LOG_CRITICAL(message, ...)                                                                                     \
-    logger_log(K4A_LOG_LEVEL_CRITICAL, __FILE__, __LINE__, "%s(). " message, __func__, __VA_ARGS__)
-#define LOG_HANDLE(message, ...)                                                                                       \
-    logger_log(K4A_LOG_LEVEL_TRACE, __FILE__, __LINE__, "%s(). " message, __func__, __VA_ARGS__)
+// Logs a message. The level is checked before logger_log() is called, so disabled messages cost a load and a branch.
+#define LOG_MESSAGE(level, message, ...)                                                                               \
+    (logger_is_enabled(level) ? logger_log(level, __FILE__, __LINE__, "%s(). " message, __func__, __VA_ARGS__)      \
+                              : (void)0)
+#define LOG_TRACE(message, ...) LOG_MESSAGE(K4A_LOG_LEVEL_TRACE, message, __VA_ARGS__)
+#define LOG_INFO(message, ...) LOG_MESSAGE(K4A_LOG_LEVEL_INFO, message, __VA_ARGS__)
+#define LOG_WARNING(message, ...) LOG_MESSAGE(K4A_LOG_LEVEL_WARNING, message, __VA_ARGS__)
+#define LOG_ERROR(message, ...) LOG_MESSAGE(K4A_LOG_LEVEL_ERROR, message, __VA_ARGS__)
+#define LOG_CRITICAL(message, ...) LOG_MESSAGE(K4A_LOG_LEVEL_CRITICAL, message, __VA_ARGS__)
+#define LOG_HANDLE(message, ...) LOG_MESSAGE(K4A_LOG_LEVEL_TRACE, message, __VA_ARGS__)
 
 #ifdef __cplusplus
 }
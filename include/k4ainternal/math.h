@@ -7,6 +7,8 @@
 #ifndef K4AMATH_H
 #define K4AMATH_H
 
+#include <stddef.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -54,6 +56,22 @@ void math_quadratic_transform_3(const float A[3 * 3],
                                 const float b[3],
                                 float out[3]);
 
+/** out = A*v + b for count vectors v, stored as separate arrays of their x, y and z components and transformed in
+ * place. Gives the same results as math_affine_transform_3() on each vector.
+ */
+void math_affine_transform_3_soa(const float A[3 * 3], const float b[3], float *x, float *y, float *z, size_t count);
+
+/** out = A*v + B*v^2 + b for count vectors v, stored as separate arrays of their x, y and z components and transformed
+ * in place. Gives the same results as math_quadratic_transform_3() on each vector.
+ */
+void math_quadratic_transform_3_soa(const float A[3 * 3],
+                                    const float B[3 * 3],
+                                    const float b[3],
+                                    float *x,
+                                    float *y,
+                                    float *z,
+                                    size_t count);
+
 #ifdef __cplusplus
 }
 #endif
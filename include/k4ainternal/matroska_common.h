@@ -10,9 +10,14 @@
 #include <k4arecord/types.h>
 #include <k4ainternal/handle.h>
 #include <list>
+#include <condition_variable>
+#include <deque>
 #include <fstream>
 #include <memory>
+#include <mutex>
+#include <string>
 #include <thread>
+#include <vector>
 
 #if defined(__clang__)
 
@@ -90,10 +95,32 @@ constexpr uint64_t operator"" _s(unsigned long long x)
 #define CUE_ENTRY_GAP_NS 1_s
 #endif
 
+// Default read-ahead count of a playback, see k4a_playback_set_read_ahead()
 #ifndef CLUSTER_READ_AHEAD_COUNT
 #define CLUSTER_READ_AHEAD_COUNT 2
 #endif
 
+#define MAX_CLUSTER_READ_AHEAD_COUNT 32
+
+// Bytes of a forward-only recording kept for reading again, see CallbackIOCallback. The history grows to keep the bytes
+// of the elements seeked over, up to the maximum size.
+#define CALLBACK_IO_HISTORY_SIZE (1024 * 1024)
+#define CALLBACK_IO_MAX_HISTORY_SIZE (256 * 1024 * 1024)
+
+// Color images a playback converts ahead of the captures read, see k4a_playback_set_decode_ahead()
+#define MAX_COLOR_DECODE_AHEAD_COUNT 16
+
+// Threads converting the color images of a playback ahead, at most one per image
+#define COLOR_DECODER_THREAD_COUNT 3
+
+// Depth payloads of a raw depth recording converted ahead of the captures read, and the threads converting them. Each
+// thread runs a depth engine of its own.
+#define DEPTH_DECODE_AHEAD_COUNT 4
+#define DEPTH_DECODER_THREAD_COUNT 2
+
+// Appended to the path of a recording to name its index sidecar, see write_recording_index()
+#define RECORDING_INDEX_EXTENSION ".k4aidx"
+
 static_assert(MAX_CLUSTER_LENGTH_NS < INT16_MAX * MATROSKA_TIMESCALE_NS, "Cluster length must fit in a 16 bit int");
 static_assert(CLUSTER_WRITE_DELAY_NS >= MAX_CLUSTER_LENGTH_NS * 2, "Cluster write delay is shorter than 2 clusters");
 
@@ -131,6 +158,58 @@ constexpr uint16_t swap_bytes_16(uint16_t input)
 #endif
 }
 
+// Byte swaps count 16-bit ints from source to destination with SSSE3 or NEON shuffles when they are available. The
+// buffers may be the same to swap in place, but must not otherwise overlap.
+void swap_bytes_16_copy(uint16_t *destination, const uint16_t *source, size_t count);
+
+// FOURCC codes of the 16-bit grayscale tracks, ffmpeg supports all but KRVL
+#define K4A_FOURCC_GRAY16_BIG_ENDIAN 0x67363162    // b16g, used by default
+#define K4A_FOURCC_GRAY16_LITTLE_ENDIAN 0x10003159 // Y1[0][16], stored without swapping
+#define K4A_FOURCC_GRAY16_RVL 0x4C56524B           // KRVL, lossless compression described below
+
+// FOURCC of depth tracks recorded with k4a_device_start_options_t::raw_depth_payload, each frame holds a depth sensor
+// payload as read from USB. Playback runs the depth engine on them with the depth calibration attachment of the
+// recording, tagged K4A_DEPTH_CALIBRATION_FILE.
+#define K4A_FOURCC_DEPTH_RAW 0x57415244 // DRAW
+
+// KRVL images start with a header of 32-bit little-endian ints: the pixel count, the band count, then the encoded size
+// of each band. The bands follow the header, each is an independent RVL stream of the next count / band count pixels.
+// RVL (A. D. Wilson, "Fast Lossless Depth Image Compression", 2017) codes runs of zero and non-zero pixels, and the
+// zigzag coded deltas between the non-zero pixels, with a variable length code of 4-bit nibbles.
+#define K4A_RVL_BAND_COUNT 4 // Bands are encoded in parallel by the writer thread
+
+// Size of the buffer rvl_encode() needs to be able to encode count pixels
+constexpr size_t rvl_encode_bound(size_t count)
+{
+    return count * 4 + 4;
+}
+
+// Encodes count pixels as an RVL stream into destination, which holds at least rvl_encode_bound(count) bytes, and
+// returns the size of the stream.
+size_t rvl_encode(const uint16_t *source, size_t count, uint8_t *destination);
+
+// Decodes an RVL stream of size bytes to count pixels, returns false if it isn't a valid stream of count pixels.
+bool rvl_decode(const uint8_t *source, size_t size, uint16_t *destination, size_t count);
+
+// First pixel of a band of a KRVL image, band_count is the end of the last band
+constexpr size_t rvl_band_start(size_t pixel_count, size_t band_count, size_t band)
+{
+    return pixel_count * band / band_count;
+}
+
+inline void write_uint32_le(uint8_t *destination, uint32_t value)
+{
+    destination[0] = (uint8_t)value;
+    destination[1] = (uint8_t)(value >> 8);
+    destination[2] = (uint8_t)(value >> 16);
+    destination[3] = (uint8_t)(value >> 24);
+}
+
+inline uint32_t read_uint32_le(const uint8_t *source)
+{
+    return (uint32_t)source[0] | (uint32_t)source[1] << 8 | (uint32_t)source[2] << 16 | (uint32_t)source[3] << 24;
+}
+
 namespace k4arecord
 {
 /**
@@ -149,11 +228,206 @@ public:
     void close() override;
     void setOwnerThread();
 
+    // Reserves the disk space of the first size bytes of the file without changing its size, so the file system can
+    // allocate the file in large extents ahead of the writes. The space past the end of the file is released when it
+    // is closed. Returns false if the file system can't reserve disk space, or the handler doesn't write a file.
+    virtual bool reserve(uint64_t size);
+
+protected:
+    // For handlers that don't use the stream
+    LargeFileIOCallback() : m_owner(std::this_thread::get_id()) {}
+
+    std::thread::id m_owner;
+    uint64_t m_reserved = 0; // Size of the file disk space is reserved for
+
 private:
+    void release_reservation();
+
     std::fstream m_stream;
-    std::thread::id m_owner;
+    std::string m_path; // Set for files opened for writing, the disk space is reserved through a handle of its own
+#ifdef _WIN32
+    void *m_reserve_file = nullptr; // HANDLE
+#else
+    int m_reserve_fd = -1;
+#endif
+};
+
+/**
+ * EBML IO handler that creates a file and writes it without going through the page cache (O_DIRECT on Linux,
+ * FILE_FLAG_NO_BUFFERING on Windows).
+ *
+ * Writes are appended to a ring of aligned buffers. Each full buffer is written to disk in a single large write by a
+ * pool of background threads, so several writes are in flight while the next buffer fills and a slow write only
+ * blocks the caller once every buffer is waiting for the disk. Reads and writes before the buffered end of the file,
+ * such as the header updates of a recording, use aligned read-modify-writes. Constructing one throws
+ * std::ios_base::failure if the file system doesn't support unbuffered IO.
+ */
+class UnbufferedFileIOCallback : public LargeFileIOCallback
+{
+public:
+    explicit UnbufferedFileIOCallback(const char *path);
+    ~UnbufferedFileIOCallback() override;
+
+    uint32 read(void *buffer, size_t size) override;
+    void setFilePointer(int64 offset, libebml::seek_mode mode = libebml::seek_beginning) override;
+    size_t write(const void *buffer, size_t size) override;
+    uint64 getFilePointer() override;
+    void close() override;
+    bool reserve(uint64_t size) override;
+
+    // Number of full buffers queued or being written to disk, callable from any thread
+    size_t getWritesInFlight();
+
+private:
+    void append(const uint8_t *data, size_t size);
+    void submit_active_buffer();
+    void wait_for_flush();
+    void access_disk(uint64_t offset, uint8_t *data, size_t size, bool write);
+    void flusher_thread();
+    void write_at(uint64_t offset, const uint8_t *data, size_t size);
+    void read_at(uint64_t offset, uint8_t *data, size_t size);
+    void release();
+
+#ifdef _WIN32
+    void *m_file = nullptr; // HANDLE
+#else
+    int m_fd = -1;
+#endif
+    std::vector<uint8_t *> m_buffers;
+    size_t m_active = 0;         // Index of the buffer being filled
+    uint64_t m_buffer_start = 0; // File offset of the active buffer, everything before it is on disk or being written
+    size_t m_buffer_fill = 0;
+    uint64_t m_position = 0;
+
+    std::vector<std::thread> m_flushers;
+    std::mutex m_lock; // Locks m_flush_queue, m_buffer_busy, m_writes_in_flight, m_error and m_stopping
+    std::condition_variable m_notify;
+    std::deque<std::pair<size_t, uint64_t>> m_flush_queue; // Full buffers and their file offsets
+    std::vector<bool> m_buffer_busy;                       // Buffers in m_flush_queue or being written
+    size_t m_writes_in_flight = 0;
+    bool m_stopping = false;
+    std::string m_error; // First failure of the flusher threads
+};
+
+// A whole file mapped copy-on-write, so writes to the memory never reach the file. Unmapped when the last reference to
+// it is released.
+typedef struct _mapped_file_t
+{
+    uint8_t *data = nullptr;
+    uint64_t size = 0;
+
+    ~_mapped_file_t();
+} mapped_file_t;
+
+/**
+ * EBML IO handler that reads a file through a memory mapping of the whole file, so reads are copies from the page
+ * cache instead of system calls. The mapping can be shared with the images that point into it, and outlives the
+ * handler until they are released. Constructing one throws std::ios_base::failure if the file can't be mapped.
+ */
+class MappedFileIOCallback : public LargeFileIOCallback
+{
+public:
+    explicit MappedFileIOCallback(const char *path);
+    // Another handler of an already mapped file, with a file pointer of its own
+    explicit MappedFileIOCallback(const std::shared_ptr<mapped_file_t> &mapping);
+    ~MappedFileIOCallback() override = default;
+
+    uint32 read(void *buffer, size_t size) override;
+    void setFilePointer(int64 offset, libebml::seek_mode mode = libebml::seek_beginning) override;
+    size_t write(const void *buffer, size_t size) override;
+    uint64 getFilePointer() override;
+    void close() override;
+
+    // The mapped file, nullptr once closed
+    std::shared_ptr<mapped_file_t> getMapping() const;
+
+private:
+    std::shared_ptr<mapped_file_t> m_mapping;
+    uint64_t m_position = 0;
+};
+
+// The I/O callbacks a recording is read through, see k4a_playback_open_callbacks(). Their close callback is called once
+// the last handler reading through them is destroyed.
+typedef struct _io_callback_source_t
+{
+    k4a_playback_io_callbacks_t callbacks;
+
+    ~_io_callback_source_t();
+} io_callback_source_t;
+
+/**
+ * EBML IO handler that reads a recording through the I/O callbacks of the application. Each handler has a file pointer
+ * of its own. For forward-only sources the most recently read bytes are kept, so the short backward seeks of parsing,
+ * such as reading an element header again, are served without the source. Seeking back further throws
+ * std::ios_base::failure, and forward seeks read and drop the bytes skipped.
+ */
+class CallbackIOCallback : public LargeFileIOCallback
+{
+public:
+    explicit CallbackIOCallback(const std::shared_ptr<io_callback_source_t> &source);
+    ~CallbackIOCallback() override = default;
+
+    uint32 read(void *buffer, size_t size) override;
+    void setFilePointer(int64 offset, libebml::seek_mode mode = libebml::seek_beginning) override;
+    size_t write(const void *buffer, size_t size) override;
+    uint64 getFilePointer() override;
+    void close() override;
+
+    // Passes on that size bytes at offset are about to be read, if the source takes read hints
+    void readHint(uint64_t offset, uint64_t size);
+
+private:
+    size_t readSource(uint64_t offset, uint8_t *buffer, size_t size);
+    size_t readForward(uint8_t *buffer, size_t size);
+    bool skipForward(uint64_t size);
+
+    std::shared_ptr<io_callback_source_t> m_source;
+    uint64_t m_position = 0;
+
+    // Forward-only sources: the offset of the next byte of the source, and a ring of the bytes before it
+    uint64_t m_source_position = 0;
+    std::vector<uint8_t> m_history;
 };
 
+/**
+ * EBML IO handler that writes a recording through the I/O callbacks of the application, in order. Writes are held in
+ * memory until commit() is called, and can be seeked over and rewritten until then, so the header of a recording can be
+ * finished before it is passed on. After a commit, the handler can only seek to its end.
+ */
+class StreamWriteIOCallback : public LargeFileIOCallback
+{
+public:
+    explicit StreamWriteIOCallback(const k4a_record_io_callbacks_t &callbacks);
+    ~StreamWriteIOCallback() override;
+
+    uint32 read(void *buffer, size_t size) override;
+    void setFilePointer(int64 offset, libebml::seek_mode mode = libebml::seek_beginning) override;
+    size_t write(const void *buffer, size_t size) override;
+    uint64 getFilePointer() override;
+    void close() override;
+
+    // Passes the held writes on to the callbacks, writes are then passed on as they are made
+    void commit();
+
+private:
+    void writeCallback(const uint8_t *buffer, size_t size);
+
+    k4a_record_io_callbacks_t m_callbacks;
+    bool m_closed = false;
+
+    uint64_t m_position = 0;
+    bool m_committed = false;
+    std::vector<uint8_t> m_pending; // Bytes written before commit()
+};
+
+// How the 16 bit grayscale images of a track are stored, the SDK always reads and writes them little-endian
+typedef enum
+{
+    GRAY16_ENCODING_NONE = 0,   // Stored as-is, little-endian or not grayscale
+    GRAY16_ENCODING_BIG_ENDIAN, // b16g
+    GRAY16_ENCODING_RVL,        // KRVL
+} gray16_encoding_t;
+
 // Struct matches https://docs.microsoft.com/en-us/windows/desktop/wmdm/-bitmapinfoheader
 struct BITMAPINFOHEADER
 {
@@ -170,6 +444,30 @@ struct BITMAPINFOHEADER
     uint32_t biClrImportant = 0;
 };
 
+// Cluster of a recording index sidecar
+typedef struct _recording_index_cluster_t
+{
+    uint64_t timestamp_ns; // Timestamp of the cluster, as stored in its timecode
+    uint64_t file_offset;  // Relative to the segment
+    uint64_t cluster_size; // Including the cluster header
+} recording_index_cluster_t;
+
+// Writes the clusters of a recording to a sidecar file next to it, so opening the recording doesn't need to search the
+// file for them. The index is tied to the size of the recording, which must be closed.
+k4a_result_t write_recording_index(const char *recording_path,
+                                   uint64_t timecode_scale,
+                                   const std::vector<recording_index_cluster_t> &clusters);
+
+// Reads the index sidecar of a recording. Fails without logging an error if there is none, or if it was written for a
+// different version of the recording.
+k4a_result_t read_recording_index(const char *recording_path,
+                                  uint64_t timecode_scale,
+                                  std::vector<recording_index_cluster_t> *clusters);
+
+// Path of a segment of a recording split by k4a_record_set_segment_limits(). The first segment is at path, the index
+// of the following ones is added before the file extension.
+std::string get_segment_path(const char *path, uint32_t segment_index);
+
 #pragma pack(push, 1)
 // Used to serialize imu samples to disk. The struct padding and size must be exact.
 struct matroska_imu_sample_t
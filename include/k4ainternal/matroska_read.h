@@ -9,6 +9,7 @@
 #define RECORD_READ_H
 
 #include <k4ainternal/matroska_common.h>
+#include <k4ainternal/k4aplugin.h>
 #include <functional>
 #include <mutex>
 #include <future>
@@ -33,6 +34,13 @@ typedef struct _cluster_info_t
     bool next_known = false;
     struct _cluster_info_t *next = NULL;
     struct _cluster_info_t *previous = NULL;
+
+    bool loading = false; // Being read from disk, wait for context->cluster_loaded instead of reading it again.
+
+    // Keeps the cluster loaded while it is in context->recent_clusters, see k4a_playback_set_cluster_cache_size()
+    std::shared_ptr<libmatroska::KaxCluster> recent_cluster;
+    std::list<struct _cluster_info_t *>::iterator recent_entry;
+    uint64_t recent_size = 0; // The size counted against the cache size
 } cluster_info_t;
 
 // The cluster cache is a sparse linked-list index that may contain gaps until real data has been read from disk.
@@ -48,13 +56,19 @@ typedef struct _loaded_cluster_t
     cluster_info_t *cluster_info = NULL;
     std::shared_ptr<libmatroska::KaxCluster> cluster;
 
-#if CLUSTER_READ_AHEAD_COUNT
-    // Pointers to previous and next clusters to keep them preloaded in memory.
-    future_cluster_t previous_clusters[CLUSTER_READ_AHEAD_COUNT];
-    future_cluster_t next_clusters[CLUSTER_READ_AHEAD_COUNT];
-#endif
+    // Pointers to previous and next clusters to keep them preloaded in memory, closest first. Up to the read-ahead
+    // count of the playback clusters are kept in each direction, only the direction of playback starts new reads.
+    std::vector<future_cluster_t> previous_clusters;
+    std::vector<future_cluster_t> next_clusters;
 } loaded_cluster_t;
 
+// A file handle of its own for reading clusters concurrently with the other read-ahead tasks
+typedef struct _cluster_reader_t
+{
+    std::unique_ptr<IOCallback> ebml_file;
+    std::unique_ptr<libebml::EbmlStream> stream;
+} cluster_reader_t;
+
 typedef struct _block_info_t
 {
     struct _track_reader_t *reader = NULL;
@@ -68,6 +82,66 @@ typedef struct _block_info_t
     int sub_index = -1;             // Index of the current buffer within the block.
 } block_info_t;
 
+// Idle allocations of the blocks stepped through by a playback, shared with the blocks so they can outlive the playback
+// handle. Each allocation holds a block_info_t and its shared_ptr control block, see new_block_info().
+typedef struct _block_info_pool_t
+{
+    std::mutex lock;
+    size_t allocation_size = 0; // Set by the first allocation, all the allocations of block_info_t have the same size
+    std::vector<void *> free_allocations;
+
+    ~_block_info_pool_t();
+} block_info_pool_t;
+
+void *block_pool_allocate(block_info_pool_t *pool, size_t size);
+void block_pool_free(block_info_pool_t *pool, void *allocation, size_t size);
+
+// Allocator for std::allocate_shared() taking its memory from a block_info_pool_t
+template<typename T> struct block_info_allocator_t
+{
+    typedef T value_type;
+    std::shared_ptr<block_info_pool_t> pool;
+
+    block_info_allocator_t(std::shared_ptr<block_info_pool_t> block_pool) : pool(std::move(block_pool)) {}
+    template<typename U> block_info_allocator_t(const block_info_allocator_t<U> &other) : pool(other.pool) {}
+
+    T *allocate(size_t n)
+    {
+        return static_cast<T *>(block_pool_allocate(pool.get(), n * sizeof(T)));
+    }
+    void deallocate(T *allocation, size_t n)
+    {
+        block_pool_free(pool.get(), allocation, n * sizeof(T));
+    }
+
+    template<typename U> bool operator==(const block_info_allocator_t<U> &other) const
+    {
+        return pool == other.pool;
+    }
+    template<typename U> bool operator!=(const block_info_allocator_t<U> &other) const
+    {
+        return pool != other.pool;
+    }
+};
+
+struct _pooled_buffer_t;
+
+// Idle buffers of the images read from a track, shared with the images so they can outlive the playback handle
+typedef struct _image_buffer_pool_t
+{
+    std::mutex lock;
+    std::vector<struct _pooled_buffer_t *> free_buffers; // Kept with their data so reusing one allocates nothing
+
+    ~_image_buffer_pool_t();
+} image_buffer_pool_t;
+
+// Buffer of an image, returned to its pool when the image is released
+typedef struct _pooled_buffer_t
+{
+    std::vector<uint8_t> data;
+    std::shared_ptr<image_buffer_pool_t> pool;
+} pooled_buffer_t;
+
 typedef struct _track_reader_t
 {
     std::string track_name;
@@ -88,36 +162,115 @@ typedef struct _track_reader_t
     uint32_t height = 0;
     uint32_t stride = 0;
     k4a_image_format_t format = K4A_IMAGE_FORMAT_CUSTOM;
+    gray16_encoding_t gray16_encoding = GRAY16_ENCODING_NONE; // Decoded back to little-endian when read
+    bool raw_depth_payload = false; // Frames are raw depth payloads, converted to depth and IR images when read
+
+    // Set for IMU tracks written with k4a_record_set_imu_packing(). Each block then holds the samples back to back in a
+    // single frame, and sub_index is the index of the sample within it.
+    bool imu_packed = false;
+
+    bool enabled = true; // Cleared by k4a_playback_set_track_filter(), the blocks of the track are then not read
+
+    std::shared_ptr<image_buffer_pool_t> buffer_pool; // Recycles the image buffers, created by the first read
 } track_reader_t;
 
+// Location of a block in the block index of its track
+typedef struct _block_index_entry_t
+{
+    cluster_info_t *cluster_info;
+    int index; // Index of the block element within the cluster
+    uint64_t sync_timestamp_ns;
+} block_index_entry_t;
+
+// A capture of the capture index, made of a block of each of the color, depth and IR tracks. The blocks are indexes in
+// the block index of their track, -1 if the capture has no image of the track.
+typedef struct _capture_index_entry_t
+{
+    int64_t blocks[3];
+} capture_index_entry_t;
+
+// Conversion of a color image by the decode-ahead threads, before get_capture() reaches its block
+typedef struct _color_decode_job_t
+{
+    std::shared_ptr<block_info_t> block;
+    k4a_image_t image = NULL; // Released with the job unless get_capture() takes it
+    k4a_result_t result = K4A_RESULT_FAILED;
+    bool done = false;
+
+    ~_color_decode_job_t();
+} color_decode_job_t;
+
+// Conversion of a raw depth payload by the depth engine of a depth decoder thread
+typedef struct _depth_decode_job_t
+{
+    std::shared_ptr<block_info_t> block;
+
+    // Released with the job unless get_capture() takes them
+    k4a_image_t depth_image = NULL; // NULL in passive IR mode
+    k4a_image_t ir_image = NULL;
+    float temperature_c = 0;
+    k4a_result_t result = K4A_RESULT_FAILED;
+    bool done = false;
+
+    ~_depth_decode_job_t();
+} depth_decode_job_t;
+
+struct _playback_reader_pool_t;
+
 typedef struct _k4a_playback_context_t
 {
     const char *file_path;
     std::unique_ptr<IOCallback> ebml_file;
     std::mutex io_lock; // Locks access to ebml_file
+    std::shared_ptr<mapped_file_t> file_mapping; // Set if ebml_file is mapped, images of raw tracks point into it
+    std::shared_ptr<io_callback_source_t> io_source; // Set if ebml_file reads through the application callbacks
+    bool forward_only = false; // The recording can only be read in order, see k4a_playback_io_callbacks_t
     bool file_closing;
 
+    uint32_t read_ahead_count;    // Clusters preloaded in the direction of playback
+    bool read_forward = true;     // Direction of playback, see load_cluster()
+    std::shared_ptr<block_info_pool_t> block_pool; // See new_block_info()
+    // Threads the read-ahead clusters are loaded on for the playbacks of a playback group, instead of a thread per
+    // cluster. pool_reads_pending counts the loads of this playback queued or running on the pool, under its lock.
+    std::shared_ptr<_playback_reader_pool_t> reader_pool;
+    size_t pool_reads_pending = 0;
+    std::mutex cluster_load_lock; // Locks cluster_info_t::loading, idle_cluster_readers, recent_clusters and the stats
+    std::condition_variable cluster_loaded;
+    std::vector<std::unique_ptr<cluster_reader_t>> idle_cluster_readers;
+
+    uint64_t cluster_cache_size; // Bytes of the recently used clusters kept loaded, 0 keeps none
+    uint64_t recent_clusters_size;
+    std::list<cluster_info_t *> recent_clusters; // The clusters kept loaded, most recently used first
+
     uint64_t timecode_scale;
     k4a_record_configuration_t record_config;
     k4a_image_format_t color_format_conversion;
+    k4a_color_decode_configuration_t color_decode; // Crop and scale of BGRA32 color images
 
     std::unique_ptr<libebml::EbmlStream> stream;
-    std::unique_ptr<libmatroska::KaxSegment> segment;
+    // The parsed header of the recording, not modified after parse_mkv(). Shared with the clones of the playback.
+    std::shared_ptr<libmatroska::KaxSegment> segment;
 
-    std::unique_ptr<libmatroska::KaxInfo> segment_info;
-    std::unique_ptr<libmatroska::KaxTracks> tracks;
-    std::unique_ptr<libmatroska::KaxCues> cues;
-    std::unique_ptr<libmatroska::KaxAttachments> attachments;
-    std::unique_ptr<libmatroska::KaxTags> tags;
+    std::shared_ptr<libmatroska::KaxInfo> segment_info;
+    std::shared_ptr<libmatroska::KaxTracks> tracks;
+    std::shared_ptr<libmatroska::KaxCues> cues;
+    std::shared_ptr<libmatroska::KaxAttachments> attachments;
+    std::shared_ptr<libmatroska::KaxTags> tags;
 
     libmatroska::KaxAttached *calibration_attachment;
     std::unique_ptr<k4a_calibration_t> device_calibration;
+    libmatroska::KaxAttached *depth_calibration_attachment = nullptr; // Depth engine calibration of raw depth payloads
+    k4a_calibration_camera_t depth_engine_camera_calibration; // Unbinned depth camera, set by the depth decoders
 
     uint64_t sync_period_ns;
     uint64_t seek_timestamp_ns;
     std::shared_ptr<loaded_cluster_t> seek_cluster;
 
     cluster_cache_t cluster_cache;
+    // Set once the cluster cache is populated and the first cluster is loaded. Playbacks opened with
+    // K4A_PLAYBACK_OPEN_HEADER_ONLY do this on their first read or seek, see load_playback_clusters().
+    bool clusters_loaded = false;
+    bool cluster_cache_indexed = false; // Populated from the index sidecar of the recording, see read_recording_index()
     std::recursive_mutex cache_lock; // Locks modification of cluster_cache
 
     track_reader_t *color_track = nullptr;
@@ -126,6 +279,33 @@ typedef struct _k4a_playback_context_t
     track_reader_t *imu_track = nullptr;
 
     std::map<std::string, track_reader_t> track_map;
+    std::vector<uint64_t> skipped_track_numbers; // The disabled tracks, their blocks are left out of the clusters read
+
+    // Blocks of the color, depth and IR tracks in file order, and the captures they are grouped in. Built from the
+    // whole recording the first time a capture is read by index, and dropped when the track filter changes.
+    bool capture_index_built = false;
+    std::vector<block_index_entry_t> block_index[3];
+    std::vector<capture_index_entry_t> capture_index;
+
+    // Decode-ahead of the color images, see k4a_playback_set_decode_ahead()
+    uint32_t decode_ahead_count = 0;
+    std::deque<std::shared_ptr<color_decode_job_t>> decode_ahead_jobs; // The color blocks after the current one
+    std::deque<std::shared_ptr<color_decode_job_t>> color_decode_queue; // Jobs no decoder thread has taken yet
+    std::mutex color_decode_lock; // Locks color_decode_queue, color_decoders_stopping, and the done flag of the jobs
+    std::unique_ptr<std::condition_variable> color_decode_notify;
+    std::unique_ptr<std::condition_variable> color_decode_done;
+    std::vector<std::thread> color_decoders;
+    bool color_decoders_stopping = false;
+
+    // Depth engine conversion of raw depth payloads, started by the first depth image read. Each decoder thread runs a
+    // depth engine of its own, so the payloads after the current one are converted in parallel.
+    std::deque<std::shared_ptr<depth_decode_job_t>> depth_decode_jobs;  // The depth blocks from the current one on
+    std::deque<std::shared_ptr<depth_decode_job_t>> depth_decode_queue; // Jobs no decoder thread has taken yet
+    std::mutex depth_decode_lock; // Locks depth_decode_queue, depth_decoders_stopping, and the done flag of the jobs
+    std::unique_ptr<std::condition_variable> depth_decode_notify;
+    std::unique_ptr<std::condition_variable> depth_decode_done;
+    std::vector<std::thread> depth_decoders;
+    bool depth_decoders_stopping = false;
 
     uint64_t segment_info_offset;
     uint64_t first_cluster_offset;
@@ -137,7 +317,7 @@ typedef struct _k4a_playback_context_t
     uint64_t last_file_timestamp_ns; // Relative to start of file.
 
     // Stats
-    uint64_t seek_count, load_count, cache_hits;
+    uint64_t seek_count, load_count, cache_hits, cache_misses, evict_count;
 } k4a_playback_context_t;
 
 K4A_DECLARE_CONTEXT(k4a_playback_t, k4a_playback_context_t);
@@ -150,16 +330,70 @@ typedef struct _k4a_playback_data_block_context_t
 
 K4A_DECLARE_CONTEXT(k4a_playback_data_block_t, k4a_playback_data_block_context_t);
 
+// Segment file of a recording opened with k4a_playback_segments_open()
+typedef struct _playback_segment_t
+{
+    std::string path;
+    k4a_playback_t playback = NULL;     // Reads the captures, opened when the segment is first used
+    k4a_playback_t imu_playback = NULL; // Clone of playback with its own read position for the IMU samples
+    bool pinned = false;                // Returned by k4a_playback_segments_get_playback(), kept open until closed
+    bool length_known = false;
+    uint64_t length_usec = 0; // End of the segment on the timeline shared by the segments
+} playback_segment_t;
+
+typedef struct _k4a_playback_segments_context_t
+{
+    std::vector<playback_segment_t> segments;
+    size_t capture_segment = 0; // Segments the captures and the IMU samples are read from
+    size_t imu_segment = 0;
+    uint64_t start_offset_usec = 0; // Start offset of the timeline, see k4a_record_configuration_t
+    bool color_conversion_set = false;
+    k4a_image_format_t color_conversion = K4A_IMAGE_FORMAT_COLOR_MJPG;
+} k4a_playback_segments_context_t;
+
+K4A_DECLARE_CONTEXT(k4a_playback_segments_t, k4a_playback_segments_context_t);
+
+// Reader threads shared by the playbacks of a playback group. The read-ahead loads of all the recordings of the group
+// are queued in the order they are requested and run on the pool threads, see read_ahead_cluster().
+typedef struct _playback_reader_pool_t
+{
+    std::mutex lock; // Locks tasks, stopping and k4a_playback_context_t::pool_reads_pending of the playbacks
+    std::deque<std::pair<k4a_playback_context_t *, std::function<void()>>> tasks;
+    bool stopping = false;
+    std::unique_ptr<std::condition_variable> notify;
+    std::unique_ptr<std::condition_variable> task_done;
+    std::vector<std::thread> readers;
+
+    ~_playback_reader_pool_t();
+} playback_reader_pool_t;
+
+// A group of recordings of synchronized devices played back together
+typedef struct _k4a_playback_group_context_t
+{
+    std::shared_ptr<playback_reader_pool_t> reader_pool;
+    std::vector<k4a_playback_t> playbacks; // The master recording first
+    std::vector<k4a_record_configuration_t> configs;
+    std::vector<k4a_capture_t> next_captures; // The next capture of each recording, NULL once it has been returned
+    std::vector<bool> ended;                  // Set once the next capture of a recording is past its end
+    uint64_t match_window_usec = 0;           // Half a frame period, captures closer than this are matched
+} k4a_playback_group_context_t;
+
+K4A_DECLARE_CONTEXT(k4a_playback_group_t, k4a_playback_group_context_t);
+
 std::unique_ptr<EbmlElement> next_child(k4a_playback_context_t *context, EbmlElement *parent);
 k4a_result_t skip_element(k4a_playback_context_t *context, EbmlElement *element);
 
 void match_ebml_id(k4a_playback_context_t *context, EbmlId &id, uint64_t offset);
 bool seek_info_ready(k4a_playback_context_t *context);
 k4a_result_t parse_mkv(k4a_playback_context_t *context);
+k4a_result_t parse_clusters(k4a_playback_context_t *context);
 k4a_result_t populate_cluster_cache(k4a_playback_context_t *context);
+k4a_result_t write_cluster_cache_index(k4a_playback_context_t *context);
+k4a_result_t copy_cluster_cache(k4a_playback_context_t *context, k4a_playback_context_t *source);
 k4a_result_t parse_recording_config(k4a_playback_context_t *context);
 k4a_result_t read_bitmap_info_header(track_reader_t *track);
 void reset_seek_pointers(k4a_playback_context_t *context, uint64_t seek_timestamp_ns);
+k4a_result_t set_track_enabled(k4a_playback_context_t *context, track_reader_t *track_reader, bool enabled);
 
 k4a_result_t parse_tracks(k4a_playback_context_t *context);
 track_reader_t *find_track(k4a_playback_context_t *context, const char *name, const char *tag_name);
@@ -177,32 +411,87 @@ void populate_cluster_info(k4a_playback_context_t *context,
 cluster_info_t *find_cluster(k4a_playback_context_t *context, uint64_t timestamp_ns);
 cluster_info_t *next_cluster(k4a_playback_context_t *context, cluster_info_t *current, bool next);
 std::shared_ptr<libmatroska::KaxCluster> load_cluster_internal(k4a_playback_context_t *context,
-                                                               cluster_info_t *cluster_info);
+                                                               cluster_info_t *cluster_info,
+                                                               bool read_ahead);
+void evict_recent_clusters(k4a_playback_context_t *context, uint64_t cache_size);
 std::shared_ptr<loaded_cluster_t> load_cluster(k4a_playback_context_t *context, cluster_info_t *cluster_info);
 std::shared_ptr<loaded_cluster_t> load_next_cluster(k4a_playback_context_t *context,
                                                     loaded_cluster_t *current_cluster,
                                                     bool next);
+std::unique_ptr<cluster_reader_t> open_cluster_reader(k4a_playback_context_t *context);
 
 uint64_t estimate_block_timestamp_ns(std::shared_ptr<block_info_t> &block);
 std::shared_ptr<block_info_t> find_block(k4a_playback_context_t *context,
                                          track_reader_t *reader,
                                          uint64_t timestamp_ns);
 std::shared_ptr<block_info_t> next_block(k4a_playback_context_t *context, block_info_t *current, bool next);
+std::shared_ptr<block_info_t> new_block_info(k4a_playback_context_t *context, const block_info_t &source);
 
 k4a_result_t convert_block_to_image(k4a_playback_context_t *context,
                                     block_info_t *in_block,
                                     k4a_image_t *image_out,
                                     k4a_image_format_t target_format);
+// Runs depth_engine on the raw depth payload of job->block, writing the depth and IR images through output, a buffer
+// of the output frame size of the depth engine
+void convert_raw_depth_block(k4a_playback_context_t *context,
+                             k4a_depth_engine_context_t *depth_engine,
+                             std::vector<uint8_t> &output,
+                             depth_decode_job_t *job);
 k4a_result_t new_capture(k4a_playback_context_t *context, block_info_t *block, k4a_capture_t *capture_handle);
+
+// Playback group reader threads, implemented in reader_pool.cpp
+std::shared_ptr<playback_reader_pool_t> create_reader_pool(uint32_t thread_count);
+bool queue_pool_read(k4a_playback_context_t *context, std::function<void()> task);
+void wait_for_pool_reads(k4a_playback_context_t *context);
+
+// Color decode-ahead, implemented in color_decoder.cpp
+k4a_result_t start_color_decoder_threads(k4a_playback_context_t *context, size_t thread_count);
+void stop_color_decoder_threads(k4a_playback_context_t *context);
+void decode_ahead_color_images(k4a_playback_context_t *context);
+bool take_decoded_color_image(k4a_playback_context_t *context,
+                              block_info_t *block,
+                              k4a_image_t *image_out,
+                              k4a_result_t *result_out);
+void reset_color_decode_ahead(k4a_playback_context_t *context);
+
+// Raw depth payload conversion, implemented in depth_decoder.cpp
+k4a_result_t start_depth_decoder_threads(k4a_playback_context_t *context);
+void stop_depth_decoder_threads(k4a_playback_context_t *context);
+void decode_ahead_depth_images(k4a_playback_context_t *context);
+std::shared_ptr<depth_decode_job_t> take_decoded_depth_images(k4a_playback_context_t *context, block_info_t *block);
+void reset_depth_decode_ahead(k4a_playback_context_t *context);
 k4a_stream_result_t get_capture(k4a_playback_context_t *context, k4a_capture_t *capture_handle, bool next);
+k4a_result_t build_capture_index(k4a_playback_context_t *context);
+k4a_stream_result_t get_capture_at_index(k4a_playback_context_t *context,
+                                         uint64_t index,
+                                         k4a_capture_t *capture_handle);
 k4a_stream_result_t get_imu_sample(k4a_playback_context_t *context, k4a_imu_sample_t *imu_sample, bool next);
+k4a_result_t get_imu_samples(k4a_playback_context_t *context,
+                             uint64_t start_timestamp_usec,
+                             uint64_t end_timestamp_usec,
+                             k4a_imu_sample_t *samples,
+                             size_t max_sample_count,
+                             size_t *sample_count);
+k4a_result_t get_track_timestamps(k4a_playback_context_t *context,
+                                  track_reader_t *track_reader,
+                                  uint64_t start_timestamp_usec,
+                                  uint64_t end_timestamp_usec,
+                                  uint64_t *timestamps_usec,
+                                  size_t max_timestamp_count,
+                                  size_t *timestamp_count);
+// Trimming, implemented in recording_trim.cpp
+k4a_result_t write_trimmed_recording(k4a_playback_context_t *context,
+                                     const char *path,
+                                     uint64_t start_timestamp_usec,
+                                     uint64_t end_timestamp_usec);
 k4a_stream_result_t get_data_block(k4a_playback_context_t *context,
                                    track_reader_t *track_reader,
                                    k4a_playback_data_block_t *data_block_handle,
                                    bool next);
 
-// Template helper functions
-template<typename T> T *read_element(k4a_playback_context_t *context, EbmlElement *element)
+// Template helper functions, they read from context->stream unless given the stream of a cluster reader
+template<typename T>
+T *read_element(k4a_playback_context_t *context, EbmlElement *element, libebml::EbmlStream *stream = nullptr)
 {
     try
     {
@@ -210,7 +499,7 @@ template<typename T> T *read_element(k4a_playback_context_t *context, EbmlElemen
         EbmlElement *dummy = nullptr;
 
         T *typed_element = static_cast<T *>(element);
-        typed_element->Read(*context->stream, T::ClassInfos.Context, upper_level, dummy, true);
+        typed_element->Read(stream ? *stream : *context->stream, T::ClassInfos.Context, upper_level, dummy, true);
         return typed_element;
     }
     catch (std::ios_base::failure &e)
@@ -230,10 +519,13 @@ template<typename T> T *read_element(k4a_playback_context_t *context, EbmlElemen
  *
  * Example usage: find_next<KaxSegment>(context, true);
  */
-template<typename T> std::unique_ptr<T> find_next(k4a_playback_context_t *context, bool search = false)
+template<typename T>
+std::unique_ptr<T>
+find_next(k4a_playback_context_t *context, bool search = false, libebml::EbmlStream *stream = nullptr)
 {
     try
     {
+        libebml::EbmlStream &input = stream ? *stream : *context->stream;
         EbmlElement *element = nullptr;
         do
         {
@@ -246,13 +538,13 @@ template<typename T> std::unique_ptr<T> find_next(k4a_playback_context_t *contex
                     delete element;
                     return nullptr;
                 }
-                element->SkipData(*context->stream, element->Generic().Context);
+                element->SkipData(input, element->Generic().Context);
                 delete element;
                 element = nullptr;
             }
             if (!element)
             {
-                element = context->stream->FindNextID(T::ClassInfos, UINT64_MAX);
+                element = input.FindNextID(T::ClassInfos, UINT64_MAX);
             }
             if (!search)
             {
@@ -288,7 +580,7 @@ template<typename T> std::unique_ptr<T> find_next(k4a_playback_context_t *contex
 }
 
 template<typename T>
-k4a_result_t read_offset(k4a_playback_context_t *context, std::unique_ptr<T> &element_out, uint64_t offset)
+k4a_result_t read_offset(k4a_playback_context_t *context, std::shared_ptr<T> &element_out, uint64_t offset)
 {
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, offset == 0);
@@ -10,13 +10,17 @@
 
 #include <k4ainternal/matroska_common.h>
 #include <set>
+#include <atomic>
 #include <condition_variable>
+#include <deque>
 #include <mutex>
 #include <unordered_map>
 
 namespace k4arecord
 {
 
+struct _track_stage_t;
+
 typedef struct _track_header_t
 {
     libmatroska::KaxTrackEntry *track;
@@ -30,20 +34,50 @@ typedef struct _track_header_t
      * See k4a_record_subtitle_settings_t::high_freq_data in types.h for more information on timestamp behavior.
      */
     bool high_freq_data = false;
+
+    // The data of 16 bit grayscale tracks is queued in native byte order and encoded by write_cluster().
+    gray16_encoding_t gray16_encoding = GRAY16_ENCODING_NONE;
+
+    // Blocks written to the track without taking the pending_cluster_lock, see write_track_data()
+    std::shared_ptr<struct _track_stage_t> stage;
 } track_header_t;
 
+// A color image transcoded by the color encoder threads, shared by the queue of the encoders and the track_data_t of
+// the image until write_cluster() takes its output.
+typedef struct _color_encode_job_t
+{
+    k4a_image_t image = NULL;                  // Reference on the source image, released once it is encoded
+    libmatroska::DataBuffer *output = nullptr; // Encoded image, NULL if it couldn't be encoded
+    bool done = false;
+
+    ~_color_encode_job_t();
+} color_encode_job_t;
+
+struct _record_writer_pool_t;
+
 typedef struct _track_data_t
 {
     track_header_t *track;
     libmatroska::DataBuffer *buffer;
+    std::shared_ptr<color_encode_job_t> color_job; // Replaces the buffer in write_cluster() if set
+    uint64_t size_bytes;                           // Size counted in k4a_record_context_t::pending_bytes
 } track_data_t;
 
+// Blocks of one track waiting to be moved into the pending clusters. Producers only contend on the lock of the track
+// they write, the writer takes the blocks of every track with stage_pending_track_data() before it picks a cluster.
+typedef struct _track_stage_t
+{
+    std::mutex lock; // Locks data
+    std::vector<std::pair<uint64_t, track_data_t>> data;
+} track_stage_t;
+
 typedef struct _cluster_t
 {
     // Clusters contain timestamps in the range: time_start_ns <= timestamp_ns < time_end_ns
     uint64_t time_start_ns;
     uint64_t time_end_ns;
     std::vector<std::pair<uint64_t, track_data_t>> data;
+    uint64_t size_bytes = 0; // Size of the queued data, counted in k4a_record_context_t::pending_bytes
 } cluster_t;
 
 typedef struct _k4a_record_context_t
@@ -51,6 +85,10 @@ typedef struct _k4a_record_context_t
     const char *file_path;
     std::unique_ptr<IOCallback> ebml_file;
 
+    // Set for recordings written through k4a_record_create_callbacks(). They are written strictly in order, and nothing
+    // is written back into the header after k4a_record_write_header().
+    bool streaming = false;
+
     uint64_t timecode_scale;
     uint32_t camera_fps;
 
@@ -87,22 +125,116 @@ typedef struct _k4a_record_context_t
     track_header_t *depth_track = nullptr;
     track_header_t *ir_track = nullptr;
     track_header_t *imu_track = nullptr;
+
+    // IMU samples waiting to be written as one block, set by k4a_record_set_imu_packing(). 0 writes each sample as its
+    // own frame.
+    uint64_t imu_packing_ns = 0;
+    std::vector<matroska_imu_sample_t> imu_pack;
+    std::mutex imu_pack_lock; // Locks imu_pack
+
+    // Storage of the depth and IR tracks, applied to their tracks by k4a_record_set_depth_codec() and
+    // k4a_record_set_gray16_little_endian()
+    k4a_record_depth_codec_t depth_codec = K4A_RECORD_DEPTH_CODEC_RAW;
+    bool gray16_little_endian = false;
+
+    // Device the depth calibration of a raw depth payload recording is read from by k4a_record_write_header(), the
+    // cameras have started by then
+    k4a_device_t raw_depth_device = NULL;
+
+    // The start options of the device the recording is created for have k4a_device_start_options_t::raw_depth_payload
+    bool raw_depth_payload = false;
+
+    // Transcoding of the color track, set by k4a_record_set_color_codec(). Jobs are queued by write_track_data() and
+    // taken by the encoder threads, or by write_cluster() if no encoder has started them by the time it needs them.
+    k4a_record_color_codec_t color_codec = K4A_RECORD_COLOR_CODEC_NATIVE;
+    uint32_t color_quality = 0;
+    libmatroska::KaxTag *color_mode_tag = nullptr;
+    std::deque<std::shared_ptr<color_encode_job_t>> color_encode_queue;
+    std::mutex color_encode_lock; // Locks color_encode_queue, color_encoders_stopping, and the done flag of the jobs
+    std::unique_ptr<std::condition_variable> color_encode_notify;
+    std::unique_ptr<std::condition_variable> color_encode_done;
+    std::vector<std::thread> color_encoders;
+    bool color_encoders_stopping = false;
+
     std::unordered_map<std::string, track_header_t> tracks;
 
+    // Write queue options, set by k4a_record_set_write_options()
+    uint64_t cluster_length_ns = MAX_CLUSTER_LENGTH_NS;
+    uint64_t cluster_write_delay_ns = CLUSTER_WRITE_DELAY_NS;
+    uint64_t max_pending_bytes = 0;
+    k4a_record_overflow_policy_t overflow_policy = K4A_RECORD_OVERFLOW_BLOCK;
+    uint64_t block_timeout_ns = 0;
+
     std::list<cluster_t *> pending_clusters;
-    std::mutex pending_cluster_lock; // Locks last_written_timestamp, most_recent_timestamp, and pending_clusters
+    std::mutex pending_cluster_lock; // Locks last_written_timestamp, most_recent_timestamp, pending_clusters,
+                                     // pending_bytes, pending_overflow, and dropped_sample_count
+    uint64_t pending_bytes = 0;
+    bool pending_overflow = false; // Set when data doesn't fit in max_pending_bytes, the writer then writes early
+    uint64_t dropped_sample_count = 0;
+    // Copy of last_written_timestamp read by producers without the lock, to turn away data that is already too old
+    std::atomic<uint64_t> written_timestamp_hint{ 0 };
+    libmatroska::KaxTag *dropped_samples_tag = nullptr; // K4A_DROPPED_SAMPLE_COUNT, added by a flush after a drop
+    // Notified when the writer thread frees space in the write queue, created with the writer thread.
+    std::unique_ptr<std::condition_variable> pending_space_notify;
 
     bool writer_stopping;
-    std::thread writer_thread;
+    std::thread writer_thread; // Not started for recordings written by the writer_pool of a recording group
+    std::shared_ptr<_record_writer_pool_t> writer_pool;
     // std::condition_variable constructor may throw, so wrap this in a pointer.
     std::unique_ptr<std::condition_variable> writer_notify;
     std::mutex writer_lock;
 
+    // Clusters written so far, saved to the index sidecar of the recording by k4a_record_close() if K4A_RECORDING_INDEX
+    // is set
+    bool write_recording_index = false;
+    std::vector<recording_index_cluster_t> index_clusters;
+
+    // Segment files, set by k4a_record_set_segment_limits(). write_cluster() moves on to the next segment at the first
+    // cluster past either limit, 0 disables a limit. file_path points to segment_path once the first segment is done.
+    uint64_t max_segment_ns = 0;
+    uint64_t max_segment_bytes = 0;
+    std::string base_path; // Path of the first segment, the paths of the others are derived from it
+    std::string segment_path;
+    uint32_t segment_index = 0;
+    uint64_t segment_start_ns = 0;          // Timestamp of the first cluster of the current segment
+    uint64_t segment_last_timestamp_ns = 0; // Timestamp of the last data written to the current segment
+    bool segment_empty = true;
+    libmatroska::KaxTag *segment_index_tag = nullptr; // K4A_SEGMENT_INDEX
+
+    // Disk layout, set by k4a_record_set_preallocation(). write_cluster() keeps the disk space of the file reserved
+    // one to two preallocation_bytes extents past its end, and write_file_metadata() writes the Cues into cues_void
+    // while they fit.
+    uint64_t preallocation_bytes = 0;
+    uint32_t cues_reserve_bytes = 0;
+    std::unique_ptr<libebml::EbmlVoid> cues_void;
+
     bool header_written, first_cluster_written;
 } k4a_record_context_t;
 
 K4A_DECLARE_CONTEXT(k4a_record_t, k4a_record_context_t);
 
+// Writer threads shared by the recordings of a recording group. The pool is held by the group handle and by its
+// recordings, so recordings can outlive the handle. Each pool thread writes one cluster of a recording at a time,
+// taking the recordings in turn, under the writer_lock of the recording.
+typedef struct _record_writer_pool_t
+{
+    std::mutex lock; // Locks recordings, next_recording, and stopping
+    std::vector<k4a_record_context_t *> recordings;
+    size_t next_recording = 0;
+    bool stopping = false;
+    std::unique_ptr<std::condition_variable> notify;
+    std::vector<std::thread> writers;
+
+    ~_record_writer_pool_t();
+} record_writer_pool_t;
+
+typedef struct _k4a_record_group_context_t
+{
+    std::shared_ptr<record_writer_pool_t> writer_pool;
+} k4a_record_group_context_t;
+
+K4A_DECLARE_CONTEXT(k4a_record_group_t, k4a_record_group_context_t);
+
 enum TagTargetType
 {
     TAG_TARGET_TYPE_NONE = 0,
@@ -130,16 +262,58 @@ void set_track_info_video(track_header_t *track, uint64_t width, uint64_t height
 k4a_result_t write_track_data(k4a_record_context_t *context,
                               track_header_t *track,
                               uint64_t timestamp_ns,
-                              libmatroska::DataBuffer *buffer);
+                              libmatroska::DataBuffer *buffer,
+                              std::shared_ptr<color_encode_job_t> color_job = nullptr);
+
+k4a_result_t write_track_data_blocks(k4a_record_context_t *context,
+                                     track_header_t *track,
+                                     const uint64_t *timestamps_ns,
+                                     libmatroska::DataBuffer *const *buffers,
+                                     size_t count,
+                                     size_t *queued_count);
+
+// Drops sample_count samples of data_size bytes in total if they don't fit in the write queue, returns true if dropped.
+bool drop_if_write_queue_full(k4a_record_context_t *context, uint64_t data_size, uint32_t sample_count);
 
 cluster_t *get_cluster_for_timestamp(k4a_record_context_t *context, uint64_t timestamp_ns);
 
+// Moves the blocks staged on the tracks into the pending clusters.
+// Lock(context->pending_cluster_lock) should be active when calling this function.
+void stage_pending_track_data(k4a_record_context_t *context);
+
+// Opens the file a recording is written to, unbuffered if K4A_RECORD_UNBUFFERED_IO is set. Throws
+// std::ios_base::failure if the file can't be created.
+std::unique_ptr<IOCallback> create_file_writer(const char *path);
+
+// Writes the recording header to context->ebml_file, from the EBML header to the tags.
+k4a_result_t write_file_header(k4a_record_context_t *context);
+
+// Writes the segment info, Cues, tags and seek head of the recording file and the size of its segment, then moves the
+// write position back to where it was. The duration of the segment info ends at last_timestamp_ns.
+k4a_result_t write_file_metadata(k4a_record_context_t *context, uint64_t last_timestamp_ns);
+
 k4a_result_t write_cluster(k4a_record_context_t *context, cluster_t *cluster, uint64_t *time_end_ns = NULL);
 
+// Writes the oldest pending cluster if it has waited for the write delay, written is set if a cluster was written.
+k4a_result_t write_pending_cluster(k4a_record_context_t *context, bool *written);
+
 k4a_result_t start_matroska_writer_thread(k4a_record_context_t *context);
 
 void stop_matroska_writer_thread(k4a_record_context_t *context);
 
+// Segment files, implemented in segment_rotation.cpp
+bool segment_limit_reached(k4a_record_context_t *context, uint64_t cluster_start_ns);
+k4a_result_t start_next_segment(k4a_record_context_t *context);
+
+// Writer threads of recording groups, implemented in writer_pool.cpp
+std::shared_ptr<record_writer_pool_t> create_writer_pool(uint32_t thread_count);
+
+// Color transcoding, implemented in color_encoder.cpp
+k4a_result_t start_color_encoder_threads(k4a_record_context_t *context);
+void stop_color_encoder_threads(k4a_record_context_t *context);
+void queue_color_encode_job(k4a_record_context_t *context, const std::shared_ptr<color_encode_job_t> &job);
+void wait_color_encode_job(k4a_record_context_t *context, const std::shared_ptr<color_encode_job_t> &job);
+
 libmatroska::KaxTag *add_tag(k4a_record_context_t *context,
                              const char *name,
                              const char *value,
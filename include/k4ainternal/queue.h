@@ -59,6 +59,42 @@ K4A_DECLARE_HANDLE(queue_t);
  */
 k4a_result_t queue_create(uint32_t queue_depth, const char *queue_name, queue_t *queue_handle);
 
+/** Open a handle to a lock free queue.
+ *
+ * \param queue_depth [IN]
+ *  The max number of elements the queue can hold. This value is capped at 10,000.
+ *
+ * \param queue_name [IN]
+ *  The name of the queue, used by the logger to generate error messages.
+ *
+ * \param queue_handle [OUT]
+ *  A pointer to write the opened queue handle to
+ *
+ * \return K4A_RESULT_SUCCEEDED if the device was opened, otherwise K4A_RESULT_FAILED
+ *
+ * The returned handle is used with the same functions as a handle from \ref queue_create and keeps the same drop
+ * oldest behavior. \ref queue_push and \ref queue_push_w_dropped must only be called by one thread at a time, pops
+ * may come from any thread. Neither takes the queue lock unless \ref queue_pop has to block waiting for data.
+ */
+k4a_result_t queue_create_lockfree(uint32_t queue_depth, const char *queue_name, queue_t *queue_handle);
+
+/** Changes the queue depth and what a push into a full queue does.
+ *
+ * \param queue_handle [in]
+ *  A queue handle
+ *
+ * \param queue_depth [IN]
+ *  The max number of elements the queue can hold. This value is capped at 10,000.
+ *
+ * \param policy [IN]
+ *  ::K4A_QUEUE_POLICY_DROP_OLDEST, the behavior of a new queue, drops the oldest capture.
+ *  ::K4A_QUEUE_POLICY_DROP_NEWEST drops the capture being pushed. ::K4A_QUEUE_POLICY_BLOCK makes the push wait for a
+ *  pop, or for the queue to be disabled, which drops the capture.
+ *
+ * \return K4A_RESULT_SUCCEEDED if the queue was changed, K4A_RESULT_FAILED if it is enabled or out of memory
+ */
+k4a_result_t queue_configure(queue_t queue_handle, uint32_t queue_depth, k4a_queue_policy_t policy);
+
 /** Destroys the handle to the queue device.
  *
  * \param queue_handle [in]
@@ -98,6 +134,15 @@ void queue_push(queue_t queue_handle, k4a_capture_t capture_handle);
  */
 void queue_push_w_dropped(queue_t queue_handle, k4a_capture_t capture_handle, k4a_capture_t *dropped_handle);
 
+/** Gets the number of captures dropped to make room for newer ones since the queue was created
+ *
+ * \param queue_handle [in]
+ *  A queue handle
+ *
+ * Captures returned through dropped_handle by \ref queue_push_w_dropped are not counted.
+ */
+uint32_t queue_get_dropped_count(queue_t queue_handle);
+
 /** Removes a \ref k4a_capture_t object from the queue.
  *
  * \param queue_handle [in]
@@ -141,6 +186,178 @@ void queue_disable(queue_t queue_handle);
  */
 void queue_stop(queue_t queue_handle);
 
+/** Gets an operating system object that is signaled while the queue holds captures
+ *
+ * \param queue_handle [in]
+ *  A queue handle
+ *
+ * \param wait_handle [out]
+ *  Location to write the handle to. It is owned by the queue and valid until \ref queue_destroy.
+ *
+ * The object is created by the first call, queues that are never asked for one do not pay for signaling it. It is
+ * also signaled while the queue is disabled, so a waiter finds out from \ref queue_pop failing.
+ *
+ * \return K4A_RESULT_SUCCEEDED if the handle was written, K4A_RESULT_FAILED if the object could not be created
+ */
+k4a_result_t queue_get_wait_handle(queue_t queue_handle, k4a_wait_handle_t *wait_handle);
+
+/** Handle to a queue of fixed size elements.
+ *
+ * Elements are copied in and out of storage allocated when the queue is created, so pushing and popping does not
+ * allocate. This is used for small high rate samples where a \ref k4a_capture_t per element would be expensive.
+ *
+ * Handles are created with \ref sample_queue_create and closed
+ * with \ref sample_queue_destroy.
+ * Invalid handles are set to 0.
+ */
+K4A_DECLARE_HANDLE(sample_queue_t);
+
+/** Open a handle to a sample queue.
+ *
+ * \param element_size [IN]
+ *  The size in bytes of each element.
+ *
+ * \param queue_depth [IN]
+ *  The max number of elements the queue can hold. This value is capped at 100,000.
+ *
+ * \param queue_name [IN]
+ *  The name of the queue, used by the logger to generate error messages.
+ *
+ * \param queue_handle [OUT]
+ *  A pointer to write the opened queue handle to
+ *
+ * \return K4A_RESULT_SUCCEEDED if the queue was opened, otherwise K4A_RESULT_FAILED
+ */
+k4a_result_t sample_queue_create(size_t element_size,
+                                 uint32_t queue_depth,
+                                 const char *queue_name,
+                                 sample_queue_t *queue_handle);
+
+/** Destroys the handle to the sample queue.
+ *
+ * \param queue_handle [in]
+ *  The handle to destroy
+ */
+void sample_queue_destroy(sample_queue_t queue_handle);
+
+/** Copies an element into the queue.
+ *
+ * \param queue_handle [in]
+ *  A queue handle
+ *
+ * \param element [in]
+ *  Pointer to element_size bytes to copy into the queue
+ *
+ * When the queue is full the oldest element is dropped in favor of the one being added with this call.
+ */
+void sample_queue_push(sample_queue_t queue_handle, const void *element);
+
+/** Copies the oldest elements out of the queue.
+ *
+ * \param queue_handle [in]
+ *  A queue handle
+ *
+ * \param wait_in_ms [in]
+ *  If the queue is empty, then this wait will be considered. 0 means do not wait at all. A timeout of
+ *  K4A_WAIT_INFINITE will wait indefinitely.
+ *
+ * \param elements [out]
+ *  Location to copy up to max_elements elements to
+ *
+ * \param max_elements [in]
+ *  The number of elements \p elements can hold
+ *
+ * \param element_count [out]
+ *  The number of elements copied to \p elements
+ *
+ * Everything queued, up to max_elements, is returned under a single lock acquisition.
+ *
+ * returns \ref K4A_WAIT_RESULT_SUCCEEDED if at least one element was returned, \ref K4A_WAIT_RESULT_TIMEOUT if no data
+ * was available in the period specified, \ref K4A_WAIT_RESULT_FAILED if the queue was stopped/destroyed while waiting.
+ */
+k4a_wait_result_t sample_queue_pop(sample_queue_t queue_handle,
+                                   int32_t wait_in_ms,
+                                   void *elements,
+                                   size_t max_elements,
+                                   size_t *element_count);
+
+/** Copies the newest element out of the queue and removes every element.
+ *
+ * \param queue_handle [in]
+ *  A queue handle
+ *
+ * \param wait_in_ms [in]
+ *  If the queue is empty, then this wait will be considered. 0 means do not wait at all. A timeout of
+ *  K4A_WAIT_INFINITE will wait indefinitely.
+ *
+ * \param element [out]
+ *  Location to copy the newest element to
+ *
+ * The older elements are skipped, they are not counted as dropped.
+ *
+ * returns \ref K4A_WAIT_RESULT_SUCCEEDED if an element was returned, \ref K4A_WAIT_RESULT_TIMEOUT if no data was
+ * available in the period specified, \ref K4A_WAIT_RESULT_FAILED if the queue was stopped/destroyed while waiting.
+ */
+k4a_wait_result_t sample_queue_pop_latest(sample_queue_t queue_handle, int32_t wait_in_ms, void *element);
+
+/** Gets the number of elements dropped to make room for newer ones since the queue was created
+ *
+ * \param queue_handle [in]
+ *  A queue handle
+ */
+uint32_t sample_queue_get_dropped_count(sample_queue_t queue_handle);
+
+/** Enables the sample queue for accepting data
+ *
+ * \param queue_handle [in]
+ *  A queue handle
+ */
+void sample_queue_enable(sample_queue_t queue_handle);
+
+/** Disable the sample queue for accepting data, elements remaining in the queue are dropped
+ *
+ * \param queue_handle [in]
+ *  A queue handle
+ */
+void sample_queue_disable(sample_queue_t queue_handle);
+
+/** Notify the sample queue that it needs to stop, waking any blocked consumers
+ *
+ * \param queue_handle [in]
+ *  A queue handle
+ */
+void sample_queue_stop(sample_queue_t queue_handle);
+
+/** Gets an operating system object that is signaled while the sample queue holds elements
+ *
+ * \param queue_handle [in]
+ *  A queue handle
+ *
+ * \param wait_handle [out]
+ *  Location to write the handle to. It is owned by the queue and valid until \ref sample_queue_destroy.
+ *
+ * Behaves like \ref queue_get_wait_handle.
+ *
+ * \return K4A_RESULT_SUCCEEDED if the handle was written, K4A_RESULT_FAILED if the object could not be created
+ */
+k4a_result_t sample_queue_get_wait_handle(sample_queue_t queue_handle, k4a_wait_handle_t *wait_handle);
+
+/** Creates a manual reset event, an eventfd outside of Windows, for the queues' wait handles
+ *
+ * \param wait_handle [out]
+ *  Location to write the event to, K4A_WAIT_HANDLE_INVALID on failure
+ */
+k4a_result_t queue_wait_event_create(k4a_wait_handle_t *wait_handle);
+
+/** Closes an event created by \ref queue_wait_event_create */
+void queue_wait_event_destroy(k4a_wait_handle_t wait_handle);
+
+/** Signals the event, it stays signaled until \ref queue_wait_event_reset */
+void queue_wait_event_set(k4a_wait_handle_t wait_handle);
+
+/** Clears the event */
+void queue_wait_event_reset(k4a_wait_handle_t wait_handle);
+
 #ifdef __cplusplus
 }
 #endif
@@ -24,6 +24,12 @@ extern "C" {
  */
 K4A_DECLARE_HANDLE(tewrapper_t);
 
+/** Handle to a frame submitted with \ref tewrapper_submit_frame.
+ *
+ * Handles are released by \ref tewrapper_complete_frame.
+ */
+K4A_DECLARE_HANDLE(tewrapper_request_t);
+
 tewrapper_t tewrapper_create(k4a_transform_engine_calibration_t *transform_engine_calibration);
 void tewrapper_destroy(tewrapper_t tewrapper_handle);
 k4a_result_t tewrapper_process_frame(tewrapper_t tewrapper_handle,
@@ -39,6 +45,25 @@ k4a_result_t tewrapper_process_frame(tewrapper_t tewrapper_handle,
                                      k4a_transform_engine_interpolation_t interpolation,
                                      uint32_t invalid_value);
 
+// Queues a frame for the transform engine thread and returns without waiting for it. Frames are processed in
+// submission order; the buffers must stay valid until tewrapper_complete_frame() returns.
+k4a_result_t tewrapper_submit_frame(tewrapper_t tewrapper_handle,
+                                    k4a_transform_engine_type_t type,
+                                    const void *depth_image_data,
+                                    size_t depth_image_size,
+                                    const void *image2_data,
+                                    size_t image2_size,
+                                    void *transformed_image_data,
+                                    size_t transformed_image_size,
+                                    void *transformed_image2_data,
+                                    size_t transformed_image2_size,
+                                    k4a_transform_engine_interpolation_t interpolation,
+                                    uint32_t invalid_value,
+                                    tewrapper_request_t *request_handle);
+
+// Waits for a frame from tewrapper_submit_frame() to be processed, releases request_handle and returns its result
+k4a_result_t tewrapper_complete_frame(tewrapper_t tewrapper_handle, tewrapper_request_t request_handle);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,53 @@
+/** \file threadpolicy.h
+ * Copyright (c) Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License.
+ * Kinect For Azure SDK.
+ */
+
+#ifndef THREADPOLICY_H
+#define THREADPOLICY_H
+
+#include <k4a/k4atypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Store the scheduling policy for a class of SDK threads.
+ *
+ * \param thread [IN]
+ * class of thread the policy applies to
+ *
+ * \param policy [IN]
+ * policy to store, applied by \ref threadpolicy_apply the next time a thread of that class starts
+ */
+k4a_result_t threadpolicy_set(k4a_sdk_thread_t thread, const k4a_thread_policy_t *policy);
+
+/** Read the scheduling policy stored for a class of SDK threads.
+ */
+k4a_result_t threadpolicy_get(k4a_sdk_thread_t thread, k4a_thread_policy_t *policy);
+
+/** Apply the stored policy for a class of SDK threads to the calling thread.
+ *
+ * Called by SDK threads as they start. Failures are logged and otherwise ignored so a thread always runs, even if it
+ * could not be placed as configured.
+ */
+void threadpolicy_apply(k4a_sdk_thread_t thread);
+
+/** Apply a policy to the calling thread. Implemented per platform.
+ *
+ * \param name [IN]
+ * name of the thread used for logging
+ *
+ * \param policy [IN]
+ * policy to apply
+ *
+ * \return K4A_RESULT_SUCCEEDED if every part of the policy was applied
+ */
+k4a_result_t threadpolicy_apply_to_current_thread(const char *name, const k4a_thread_policy_t *policy);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* THREADPOLICY_H */
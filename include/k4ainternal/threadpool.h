@@ -0,0 +1,67 @@
+/** \file threadpool.h
+ * Copyright (c) Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License.
+ * Kinect For Azure SDK.
+ */
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <k4a/k4atypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Maximum number of worker threads of the pool */
+#define THREADPOOL_MAX_THREAD_COUNT 256
+
+/** Function called for every index of \ref threadpool_parallel_for */
+typedef void(threadpool_for_fn_t)(void *context, uint32_t index);
+
+/** Store the options of the process wide pool.
+ *
+ * \param options [IN]
+ * options to use the next time the pool starts
+ *
+ * Waits for the submitted tasks to finish and stops the running worker threads, the next task starts them again.
+ */
+k4a_result_t threadpool_set_options(const k4a_thread_pool_options_t *options);
+
+/** Read the options of the process wide pool.
+ */
+k4a_result_t threadpool_get_options(k4a_thread_pool_options_t *options);
+
+/** Run a task on the pool.
+ *
+ * \param task [IN]
+ * function to call once
+ *
+ * \param task_context [IN]
+ * argument of \p task
+ *
+ * The task runs on the calling thread before this returns if the pool has no threads or its queues are full.
+ */
+void threadpool_submit(k4a_thread_pool_task_t *task, void *task_context);
+
+/** Call a function for every index in [0, count), spread across the pool and the calling thread.
+ *
+ * \param fn [IN]
+ * function to call for each index
+ *
+ * \param context [IN]
+ * first argument of \p fn
+ *
+ * \param count [IN]
+ * number of indices
+ *
+ * Returns once every call has returned. While waiting, the calling thread runs queued tasks of the pool so that
+ * nested calls from pool threads make progress.
+ */
+void threadpool_parallel_for(threadpool_for_fn_t *fn, void *context, uint32_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* THREADPOOL_H */
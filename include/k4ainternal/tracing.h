@@ -0,0 +1,91 @@
+/** \file tracing.h
+ * Copyright (c) Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License.
+ * Kinect For Azure SDK.
+ */
+
+#ifndef TRACING_H
+#define TRACING_H
+
+#include <k4a/k4atypes.h>
+
+// System dependencies
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef FORCEINLINE
+#ifdef _MSC_VER
+#define FORCEINLINE inline __forceinline
+#else
+#define FORCEINLINE inline __attribute__((always_inline))
+#endif
+#endif
+
+/** Phases of a trace event, with the values of the Chrome trace event format
+ */
+typedef enum
+{
+    TRACE_PHASE_BEGIN = 'B',
+    TRACE_PHASE_END = 'E',
+    TRACE_PHASE_INSTANT = 'i',
+} trace_phase_t;
+
+/** Non zero while a trace is being recorded. Read with tracing_is_enabled().
+ */
+extern volatile int32_t g_tracing_enabled;
+
+/** true if trace events are being recorded. This is a single relaxed load, so the TRACE_* macros cost a load and a
+ * branch while tracing is off.
+ */
+FORCEINLINE bool tracing_is_enabled(void)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __atomic_load_n(&g_tracing_enabled, __ATOMIC_RELAXED) != 0;
+#else
+    // Aligned volatile 32 bit loads are atomic with MSVC
+    return g_tracing_enabled != 0;
+#endif
+}
+
+/** Records an event in the calling thread's trace buffer.
+ *
+ * \param phase [IN]
+ * begin or end of a span on this thread, or an instant event
+ *
+ * \param name [IN]
+ * name of the stage, which must be a string literal or otherwise outlive the trace
+ *
+ * \param frame [IN]
+ * identifies the frame the event belongs to, 0 if there isn't one. Stages use the system timestamp of the frame's
+ * image in nanoseconds, which the depth and color paths carry from the USB transfer to the capture.
+ *
+ * \remarks
+ * Each thread records into its own buffer without locks. When the buffer is full later events are counted and dropped.
+ */
+void tracing_record(trace_phase_t phase, const char *name, uint64_t frame);
+
+/** Starts recording trace events, discarding those of a previous trace.
+ */
+k4a_result_t tracing_start(void);
+
+/** Stops recording trace events and writes the recorded trace to path in the Chrome trace event JSON format, which
+ * chrome://tracing and the Perfetto UI load. Nothing is written if path is NULL.
+ */
+k4a_result_t tracing_stop(const char *path);
+
+#define TRACE_SPAN_BEGIN(name, frame)                                                                                  \
+    (tracing_is_enabled() ? tracing_record(TRACE_PHASE_BEGIN, (name), (uint64_t)(frame)) : (void)0)
+#define TRACE_SPAN_END(name, frame)                                                                                    \
+    (tracing_is_enabled() ? tracing_record(TRACE_PHASE_END, (name), (uint64_t)(frame)) : (void)0)
+#define TRACE_INSTANT(name, frame)                                                                                     \
+    (tracing_is_enabled() ? tracing_record(TRACE_PHASE_INSTANT, (name), (uint64_t)(frame)) : (void)0)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRACING_H */
@@ -8,6 +8,7 @@
 #define K4ATRANSFORMATION_H
 
 #include <k4a/k4atypes.h>
+#include <k4ainternal/allocator.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -36,6 +37,18 @@ typedef struct _k4a_transformation_xy_tables_t
     int height;     // height of x and y tables
 } k4a_transformation_xy_tables_t;
 
+// Depth camera xy table rays rotated into the color camera, so a depth pixel is at
+// depth * (x, y, z) + translation in color camera coordinates
+typedef struct _k4a_transformation_ray_tables_t
+{
+    float *x_table;       // table used to compute color camera X coordinate, NAN where the xy tables are invalid
+    float *y_table;       // table used to compute color camera Y coordinate
+    float *z_table;       // table used to compute color camera Z coordinate
+    float translation[3]; // depth to color camera translation
+    int width;            // width of the tables
+    int height;           // height of the tables
+} k4a_transformation_ray_tables_t;
+
 typedef struct _k4a_transformation_pinhole_t
 {
     float px;
@@ -98,10 +111,143 @@ k4a_result_t transformation_color_2d_to_depth_2d(const k4a_calibration_t *calibr
                                                  float target_point2d[2],
                                                  int *valid);
 
+// transformation_color_2d_to_depth_2d() evaluating every pixel of the epipolar line instead of searching it coarse to
+// fine, to check and benchmark the search against
+k4a_result_t transformation_color_2d_to_depth_2d_exhaustive(const k4a_calibration_t *calibration,
+                                                            const float source_point2d[2],
+                                                            const k4a_image_t depth_image,
+                                                            float target_point2d[2],
+                                                            int *valid);
+
+// Array versions of the above for point_count points, stored as consecutive float[2] and float[3] coordinates. The
+// calibration is validated once for all the points
+k4a_result_t transformation_2d_to_3d_batch(const k4a_calibration_t *calibration,
+                                           const float *source_point2d,
+                                           const float *source_depth,
+                                           size_t point_count,
+                                           const k4a_calibration_type_t source_camera,
+                                           const k4a_calibration_type_t target_camera,
+                                           float *target_point3d,
+                                           int *valid);
+
+k4a_result_t transformation_3d_to_2d_batch(const k4a_calibration_t *calibration,
+                                           const float *source_point3d,
+                                           size_t point_count,
+                                           const k4a_calibration_type_t source_camera,
+                                           const k4a_calibration_type_t target_camera,
+                                           float *target_point2d,
+                                           int *valid);
+
+k4a_result_t transformation_2d_to_2d_batch(const k4a_calibration_t *calibration,
+                                           const float *source_point2d,
+                                           const float *source_depth,
+                                           size_t point_count,
+                                           const k4a_calibration_type_t source_camera,
+                                           const k4a_calibration_type_t target_camera,
+                                           float *target_point2d,
+                                           int *valid);
+
+k4a_result_t transformation_color_2d_to_depth_2d_batch(const k4a_calibration_t *calibration,
+                                                       const float *source_point2d,
+                                                       size_t point_count,
+                                                       const k4a_image_t depth_image,
+                                                       float *target_point2d,
+                                                       int *valid);
+
 k4a_transformation_t transformation_create(const k4a_calibration_t *calibration, bool gpu_optimization);
 
+// Like transformation_create(), with the xy tables allocated from hook. NULL or a hook without callbacks allocates
+// them as transformation_create() does. The hook is kept until the handle is destroyed, the tables are only built when
+// first needed.
+k4a_transformation_t transformation_create_with_allocator(const k4a_calibration_t *calibration,
+                                                          bool gpu_optimization,
+                                                          const allocator_hook_t *hook);
+
+// Waits for the work queued with transformation_run_async() before releasing the handle. Called from queued work, it
+// returns right away and the transformation thread releases the handle once the queue is empty.
 void transformation_destroy(k4a_transformation_t transformation_handle);
 
+// Builds the xy tables of the cameras that are on and starts the transform engine of a GPU handle, which are otherwise
+// set up by the first call that needs them
+k4a_result_t transformation_warm_up(k4a_transformation_t transformation_handle);
+
+// Upper limit to the number of threads the CPU depth to color transformation uses
+#define K4A_TRANSFORMATION_MAX_THREAD_COUNT 64
+
+// Upper limit to the number of custom planes one depth to color transformation carries
+#define K4A_TRANSFORMATION_MAX_CUSTOM_PLANES 8
+
+// Number of threads the CPU implementation of depth to color splits each image across, 1 unless set
+k4a_result_t transformation_set_cpu_thread_count(k4a_transformation_t transformation_handle, uint32_t thread_count);
+
+// How the CPU implementation of depth to color renders the depth image, K4A_TRANSFORMATION_DEPTH_TO_COLOR_MODE_QUADS
+// unless set
+k4a_result_t transformation_set_depth_to_color_mode(k4a_transformation_t transformation_handle,
+                                                    k4a_transformation_depth_to_color_mode_t mode);
+
+// The CPU implementation of color to depth blends the color pixels with 8 bit fixed point weights in integer arithmetic
+// instead of float, within 1 of the float result in every channel and identical on every CPU. Off unless set.
+k4a_result_t transformation_set_fixed_point_bilinear(k4a_transformation_t transformation_handle, bool enable);
+
+// The CPU implementation of depth to color renders the quads of the depth image in square blocks whose footprint in
+// the transformed images is about cache_bytes, so they stay in cache while rendered. 0, the default, renders them row
+// after row. Only the custom pixels of equally close quads may change between block sizes. Applies to the process.
+void transformation_set_depth_to_color_block_cache_size(uint32_t cache_bytes);
+
+// Instruction sets the CPU kernels were built for that this CPU supports, from index 0, the one every build uses, to
+// the widest, which is used by default. Names are those transformation_get_instruction_type() reports.
+uint32_t transformation_get_instruction_set_count(void);
+const char *transformation_get_instruction_set_name(uint32_t index);
+
+// Limits the CPU kernels of the process to the instruction set at index and narrower ones, so benchmarks can compare
+// the kernels of each instruction set
+k4a_result_t transformation_set_instruction_set_limit(uint32_t index);
+
+// Points xy_table at the unprojection tables of the depth or color camera the handle built, which stay valid and
+// unchanged until the handle is destroyed
+k4a_result_t transformation_get_xy_table(k4a_transformation_t transformation_handle,
+                                        k4a_calibration_type_t camera,
+                                        k4a_xy_table_t *xy_table);
+
+// Precomputes the depth camera rays in color camera coordinates so the CPU transformations between depth and color do
+// not unproject and rotate each pixel per frame. Transformations must not be in progress on the handle.
+k4a_result_t transformation_set_precomputed_rays(k4a_transformation_t transformation_handle, bool enable);
+
+// Selects the implementation of the depth to color, color to depth and whole image INT16 point cloud transformations.
+// The OpenCL backend is set up by the first call selecting it, which fails if no OpenCL GPU is available.
+k4a_result_t transformation_set_backend(k4a_transformation_t transformation_handle,
+                                        k4a_transformation_backend_t backend);
+
+// Keeps the results of the OpenCL backend in GPU memory without copying them to the output images, which must still
+// be provided. Only allowed while the OpenCL backend is selected, selecting another backend disables it.
+k4a_result_t transformation_set_gpu_output(k4a_transformation_t transformation_handle, bool enable);
+
+// Returns the cl_mem holding the last result of output computed with the OpenCL backend
+k4a_result_t transformation_get_gpu_output(k4a_transformation_t transformation_handle,
+                                           k4a_transformation_gpu_output_t output,
+                                           void **gpu_buffer);
+
+// Uses the cl_context and cl_device_id of the caller for the OpenCL backend instead of creating one, both NULL for the
+// first GPU of the system. Must be called before the OpenCL backend is first selected.
+k4a_result_t transformation_set_gpu_context(k4a_transformation_t transformation_handle,
+                                            void *gpu_context,
+                                            void *gpu_device);
+
+// Writes output to a cl_mem or OpenGL buffer of the caller, see k4a_transformation_set_gpu_output_target()
+k4a_result_t transformation_set_gpu_output_target(k4a_transformation_t transformation_handle,
+                                                  k4a_transformation_gpu_output_t output,
+                                                  k4a_transformation_gpu_target_t target_type,
+                                                  void *target);
+
+typedef void(transformation_async_fn_t)(void *context);
+
+// Queues fn to be called with context on the transformation thread of transformation_handle, which is started on the
+// first call. Queued functions run one at a time in the order they were queued.
+k4a_result_t transformation_run_async(k4a_transformation_t transformation_handle,
+                                      transformation_async_fn_t *fn,
+                                      void *context);
+
+// roi is the region of the color image the transformed images hold, NULL for the whole image
 k4a_buffer_result_t transformation_depth_image_to_color_camera_validate_parameters(
     const k4a_calibration_t *calibration,
     const k4a_transformation_xy_tables_t *xy_tables_depth_camera,
@@ -112,21 +258,27 @@ k4a_buffer_result_t transformation_depth_image_to_color_camera_validate_paramete
     uint8_t *transformed_depth_image_data,
     k4a_transformation_image_descriptor_t *transformed_depth_image_descriptor,
     uint8_t *transformed_custom_image_data,
-    k4a_transformation_image_descriptor_t *transformed_custom_image_descriptor);
+    k4a_transformation_image_descriptor_t *transformed_custom_image_descriptor,
+    const k4a_rect_t *roi);
 
 k4a_buffer_result_t transformation_depth_image_to_color_camera_internal(
     const k4a_calibration_t *calibration,
     const k4a_transformation_xy_tables_t *xy_tables_depth_camera,
+    const k4a_transformation_ray_tables_t *ray_tables_depth_camera,
     const uint8_t *depth_image_data,
     const k4a_transformation_image_descriptor_t *depth_image_descriptor,
-    const uint8_t *custom_image_data,
+    const uint8_t *const *custom_images_data,
     const k4a_transformation_image_descriptor_t *custom_image_descriptor,
     uint8_t *transformed_depth_image_data,
     k4a_transformation_image_descriptor_t *transformed_depth_image_descriptor,
-    uint8_t *transformed_custom_image_data,
+    uint8_t *const *transformed_custom_images_data,
     k4a_transformation_image_descriptor_t *transformed_custom_image_descriptor,
+    uint32_t custom_image_count,
     k4a_transformation_interpolation_type_t interpolation_type,
-    uint32_t invalid_custom_value);
+    uint32_t invalid_custom_value,
+    k4a_transformation_depth_to_color_mode_t mode,
+    uint32_t thread_count,
+    const k4a_rect_t *roi);
 
 k4a_result_t transformation_depth_image_to_color_camera_custom(
     k4a_transformation_t transformation_handle,
@@ -141,6 +293,33 @@ k4a_result_t transformation_depth_image_to_color_camera_custom(
     k4a_transformation_interpolation_type_t interpolation_type,
     uint32_t invalid_custom_value);
 
+// Transforms depth and custom_image_count custom planes sharing one descriptor to the color camera. The CPU
+// implementation maps every plane in the same rasterization pass, the other backends transform one plane at a time.
+k4a_result_t transformation_depth_image_to_color_camera_custom_planes(
+    k4a_transformation_t transformation_handle,
+    const uint8_t *depth_image_data,
+    const k4a_transformation_image_descriptor_t *depth_image_descriptor,
+    const uint8_t *const *custom_images_data,
+    const k4a_transformation_image_descriptor_t *custom_image_descriptor,
+    uint32_t custom_image_count,
+    uint8_t *transformed_depth_image_data,
+    k4a_transformation_image_descriptor_t *transformed_depth_image_descriptor,
+    uint8_t *const *transformed_custom_images_data,
+    k4a_transformation_image_descriptor_t *transformed_custom_image_descriptor,
+    k4a_transformation_interpolation_type_t interpolation_type,
+    uint32_t invalid_custom_value);
+
+// Transforms depth to the color camera like transformation_depth_image_to_color_camera_custom() without a custom
+// image, only rendering the roi region of the color image into the roi sized transformed image. Always runs on the CPU.
+k4a_result_t transformation_depth_image_to_color_camera_roi(
+    k4a_transformation_t transformation_handle,
+    const uint8_t *depth_image_data,
+    const k4a_transformation_image_descriptor_t *depth_image_descriptor,
+    const k4a_rect_t *roi,
+    uint8_t *transformed_depth_image_data,
+    k4a_transformation_image_descriptor_t *transformed_depth_image_descriptor);
+
+// roi is the region of the depth image the transformed color image holds, NULL for the whole image
 k4a_buffer_result_t transformation_color_image_to_depth_camera_validate_parameters(
     const k4a_calibration_t *calibration,
     const k4a_transformation_xy_tables_t *xy_tables_depth_camera,
@@ -149,17 +328,21 @@ k4a_buffer_result_t transformation_color_image_to_depth_camera_validate_paramete
     const uint8_t *color_image_data,
     const k4a_transformation_image_descriptor_t *color_image_descriptor,
     uint8_t *transformed_color_image_data,
-    k4a_transformation_image_descriptor_t *transformed_color_image_descriptor);
+    k4a_transformation_image_descriptor_t *transformed_color_image_descriptor,
+    const k4a_rect_t *roi);
 
 k4a_buffer_result_t transformation_color_image_to_depth_camera_internal(
     const k4a_calibration_t *calibration,
     const k4a_transformation_xy_tables_t *xy_tables_depth_camera,
+    const k4a_transformation_ray_tables_t *ray_tables_depth_camera,
     const uint8_t *depth_image_data,
     const k4a_transformation_image_descriptor_t *depth_image_descriptor,
     const uint8_t *color_image_data,
     const k4a_transformation_image_descriptor_t *color_image_descriptor,
     uint8_t *transformed_color_image_data,
-    k4a_transformation_image_descriptor_t *transformed_color_image_descriptor);
+    k4a_transformation_image_descriptor_t *transformed_color_image_descriptor,
+    bool fixed_point,
+    const k4a_rect_t *roi);
 
 k4a_result_t
 transformation_color_image_to_depth_camera(k4a_transformation_t transformation_handle,
@@ -170,10 +353,25 @@ transformation_color_image_to_depth_camera(k4a_transformation_t transformation_h
                                            uint8_t *transformed_color_image_data,
                                            k4a_transformation_image_descriptor_t *transformed_color_image_descriptor);
 
+// Only transforms the color of the roi region of the depth image, into the roi sized transformed color image. Always
+// runs on the CPU.
+k4a_result_t transformation_color_image_to_depth_camera_roi(
+    k4a_transformation_t transformation_handle,
+    const uint8_t *depth_image_data,
+    const k4a_transformation_image_descriptor_t *depth_image_descriptor,
+    const uint8_t *color_image_data,
+    const k4a_transformation_image_descriptor_t *color_image_descriptor,
+    const k4a_rect_t *roi,
+    uint8_t *transformed_color_image_data,
+    k4a_transformation_image_descriptor_t *transformed_color_image_descriptor);
+
+// roi is the region of the depth image the xyz image holds, NULL for the whole image
 k4a_buffer_result_t
-transformation_depth_image_to_point_cloud_internal(k4a_transformation_xy_tables_t *xy_tables,
+transformation_depth_image_to_point_cloud_internal(const k4a_transformation_xy_tables_t *xy_tables,
                                                    const uint8_t *depth_image_data,
                                                    const k4a_transformation_image_descriptor_t *depth_image_descriptor,
+                                                   k4a_point_cloud_format_t format,
+                                                   const k4a_rect_t *roi,
                                                    uint8_t *xyz_image_data,
                                                    k4a_transformation_image_descriptor_t *xyz_image_descriptor);
 
@@ -185,6 +383,184 @@ transformation_depth_image_to_point_cloud(k4a_transformation_t transformation_ha
                                           uint8_t *xyz_image_data,
                                           k4a_transformation_image_descriptor_t *xyz_image_descriptor);
 
+k4a_result_t
+transformation_depth_image_to_formatted_point_cloud(k4a_transformation_t transformation_handle,
+                                                    const uint8_t *depth_image_data,
+                                                    const k4a_transformation_image_descriptor_t *depth_image_descriptor,
+                                                    const k4a_calibration_type_t camera,
+                                                    k4a_point_cloud_format_t format,
+                                                    const k4a_rect_t *roi,
+                                                    uint8_t *xyz_image_data,
+                                                    k4a_transformation_image_descriptor_t *xyz_image_descriptor);
+
+// Converts depth to xyz a row at a time and packs the points with depth to the front of the xyz image. point_count is
+// their number and pixel_indices, when not NULL, receives the depth pixel index of each of them.
+k4a_buffer_result_t transformation_depth_image_to_valid_point_cloud_internal(
+    const k4a_transformation_xy_tables_t *xy_tables,
+    const uint8_t *depth_image_data,
+    const k4a_transformation_image_descriptor_t *depth_image_descriptor,
+    uint8_t *xyz_image_data,
+    k4a_transformation_image_descriptor_t *xyz_image_descriptor,
+    uint32_t *pixel_indices,
+    size_t *point_count);
+
+k4a_result_t
+transformation_depth_image_to_valid_point_cloud(k4a_transformation_t transformation_handle,
+                                                const uint8_t *depth_image_data,
+                                                const k4a_transformation_image_descriptor_t *depth_image_descriptor,
+                                                const k4a_calibration_type_t camera,
+                                                uint8_t *xyz_image_data,
+                                                k4a_transformation_image_descriptor_t *xyz_image_descriptor,
+                                                uint32_t *pixel_indices,
+                                                size_t *point_count);
+
+// Converts depth in the color camera geometry to color camera xyz and copies the color of each pixel alongside, a row
+// at a time. With valid_points_only the pixels with depth are packed to the front of the xyz and bgra images and
+// point_count is their number, otherwise it is the number of pixels.
+k4a_buffer_result_t transformation_depth_image_to_colored_point_cloud_internal(
+    const k4a_transformation_xy_tables_t *xy_tables_color_camera,
+    const uint8_t *depth_image_data,
+    const k4a_transformation_image_descriptor_t *depth_image_descriptor,
+    const uint8_t *color_image_data,
+    const k4a_transformation_image_descriptor_t *color_image_descriptor,
+    bool valid_points_only,
+    uint8_t *xyz_image_data,
+    k4a_transformation_image_descriptor_t *xyz_image_descriptor,
+    uint8_t *bgra_image_data,
+    k4a_transformation_image_descriptor_t *bgra_image_descriptor,
+    size_t *point_count);
+
+// Transforms depth into the color camera and then into the colored point cloud, without a separate pass over the
+// transformed depth
+k4a_result_t transformation_depth_image_to_colored_point_cloud(
+    k4a_transformation_t transformation_handle,
+    const uint8_t *depth_image_data,
+    const k4a_transformation_image_descriptor_t *depth_image_descriptor,
+    const uint8_t *color_image_data,
+    const k4a_transformation_image_descriptor_t *color_image_descriptor,
+    bool valid_points_only,
+    uint8_t *xyz_image_data,
+    k4a_transformation_image_descriptor_t *xyz_image_descriptor,
+    uint8_t *bgra_image_data,
+    k4a_transformation_image_descriptor_t *bgra_image_descriptor,
+    size_t *point_count);
+
+// One device of a fused point cloud. xy_tables and band_count are filled in by transformation_fuse_point_clouds().
+typedef struct _k4a_transformation_fusion_source_t
+{
+    k4a_transformation_t transformation_handle;
+    const uint8_t *depth_image_data;
+    const k4a_transformation_image_descriptor_t *depth_image_descriptor;
+    const uint8_t *color_image_data; // BGRA32 in the depth camera geometry, NULL without color
+    const k4a_transformation_image_descriptor_t *color_image_descriptor;
+    k4a_calibration_extrinsics_t depth_to_common; // Depth camera to the common frame, in millimeters
+    const k4a_transformation_xy_tables_t *xy_tables;
+    uint32_t band_count; // Row bands the source is split into
+} k4a_transformation_fusion_source_t;
+
+// Converts the depth of every source to float points of the common frame in one pass, the bands of all sources
+// spread across the SDK thread pool. The points of the sources follow each other in source order in a single row xyz
+// image, with their colors at the same index of bgra_image_data when it is not NULL. With valid_points_only only the
+// pixels with depth are kept, packed to the front, and point_count is their number.
+k4a_buffer_result_t
+transformation_fuse_point_clouds_internal(const k4a_transformation_fusion_source_t *sources,
+                                          uint32_t source_count,
+                                          k4a_point_cloud_format_t format,
+                                          bool valid_points_only,
+                                          uint8_t *xyz_image_data,
+                                          k4a_transformation_image_descriptor_t *xyz_image_descriptor,
+                                          uint8_t *bgra_image_data,
+                                          k4a_transformation_image_descriptor_t *bgra_image_descriptor,
+                                          size_t *point_count);
+
+k4a_result_t transformation_fuse_point_clouds(k4a_transformation_fusion_source_t *sources,
+                                              uint32_t source_count,
+                                              k4a_point_cloud_format_t format,
+                                              bool valid_points_only,
+                                              uint8_t *xyz_image_data,
+                                              k4a_transformation_image_descriptor_t *xyz_image_descriptor,
+                                              uint8_t *bgra_image_data,
+                                              k4a_transformation_image_descriptor_t *bgra_image_descriptor,
+                                              size_t *point_count);
+
+// Writes the unit normal of every pixel of an int16 xyz image from the cross product of the differences between its
+// left and right and its top and bottom neighbors, facing the camera. Pixels on the border, without depth or with a
+// neighbor across a depth edge get a normal of 0.
+k4a_buffer_result_t
+transformation_point_cloud_to_normals_internal(const uint8_t *xyz_image_data,
+                                               const k4a_transformation_image_descriptor_t *xyz_image_descriptor,
+                                               uint8_t *normal_image_data,
+                                               k4a_transformation_image_descriptor_t *normal_image_descriptor);
+
+k4a_result_t transformation_point_cloud_to_normals(const uint8_t *xyz_image_data,
+                                                   const k4a_transformation_image_descriptor_t *xyz_image_descriptor,
+                                                   uint8_t *normal_image_data,
+                                                   k4a_transformation_image_descriptor_t *normal_image_descriptor);
+
+// Replaces the points of an int16 xyz image with z != 0 by the float centroid of each voxel of a grid with voxel_size
+// millimeter cubes, found through a hash table. The voxels are written in the order of their first pixel to a single
+// row image, with the normalized sum of their normals when the normal images are not NULL. point_count is the number
+// of voxels.
+k4a_buffer_result_t transformation_point_cloud_voxel_downsample_internal(
+    const uint8_t *xyz_image_data,
+    const k4a_transformation_image_descriptor_t *xyz_image_descriptor,
+    const uint8_t *normal_image_data,
+    const k4a_transformation_image_descriptor_t *normal_image_descriptor,
+    float voxel_size,
+    uint8_t *downsampled_xyz_image_data,
+    k4a_transformation_image_descriptor_t *downsampled_xyz_image_descriptor,
+    uint8_t *downsampled_normal_image_data,
+    k4a_transformation_image_descriptor_t *downsampled_normal_image_descriptor,
+    size_t *point_count);
+
+k4a_result_t transformation_point_cloud_voxel_downsample(
+    const uint8_t *xyz_image_data,
+    const k4a_transformation_image_descriptor_t *xyz_image_descriptor,
+    const uint8_t *normal_image_data,
+    const k4a_transformation_image_descriptor_t *normal_image_descriptor,
+    float voxel_size,
+    uint8_t *downsampled_xyz_image_data,
+    k4a_transformation_image_descriptor_t *downsampled_xyz_image_descriptor,
+    uint8_t *downsampled_normal_image_data,
+    k4a_transformation_image_descriptor_t *downsampled_normal_image_descriptor,
+    size_t *point_count);
+
+// Pixel mapping from an undistorted pinhole image to a distorted camera image
+typedef struct _k4a_transformation_undistort_lut_t k4a_transformation_undistort_lut_t;
+
+// Projects the ray of every pinhole pixel into the distorted image once. Returns NULL on failure.
+k4a_transformation_undistort_lut_t *
+transformation_undistort_lut_create(const k4a_calibration_camera_t *camera_calibration,
+                                    const k4a_transformation_pinhole_t *pinhole,
+                                    k4a_transformation_interpolation_type_t interpolation_type);
+
+void transformation_undistort_lut_destroy(k4a_transformation_undistort_lut_t *lut);
+
+// Resamples a DEPTH16, IR16 or BGRA32 image of the camera into the pinhole image of the same format
+k4a_result_t transformation_undistort_internal(const k4a_transformation_undistort_lut_t *lut,
+                                               const uint8_t *image_data,
+                                               const k4a_transformation_image_descriptor_t *image_descriptor,
+                                               uint8_t *undistorted_image_data,
+                                               k4a_transformation_image_descriptor_t *undistorted_image_descriptor);
+
+// Undistort map handles, pinhole NULL keeps the camera intrinsics and resolution
+k4a_result_t transformation_undistort_map_create(k4a_transformation_t transformation_handle,
+                                                 k4a_calibration_type_t camera,
+                                                 const k4a_transformation_pinhole_t *pinhole,
+                                                 k4a_transformation_interpolation_type_t interpolation_type,
+                                                 k4a_undistort_map_t *undistort_map_handle);
+
+void transformation_undistort_map_destroy(k4a_undistort_map_t undistort_map_handle);
+
+k4a_result_t transformation_undistort_map_get_pinhole(k4a_undistort_map_t undistort_map_handle,
+                                                      k4a_transformation_pinhole_t *pinhole);
+
+k4a_result_t transformation_undistort(k4a_undistort_map_t undistort_map_handle,
+                                      const uint8_t *image_data,
+                                      const k4a_transformation_image_descriptor_t *image_descriptor,
+                                      uint8_t *undistorted_image_data,
+                                      k4a_transformation_image_descriptor_t *undistorted_image_descriptor);
+
 // Mode specific calibration
 k4a_result_t
 transformation_get_mode_specific_depth_camera_calibration(const k4a_calibration_camera_t *raw_camera_calibration,
@@ -214,6 +590,21 @@ k4a_result_t transformation_project(const k4a_calibration_camera_t *camera_calib
                                     float point2d[2],
                                     int *valid);
 
+// Array versions of transformation_unproject() and transformation_project(), computing 4 points at a time with SIMD
+// where available
+k4a_result_t transformation_unproject_batch(const k4a_calibration_camera_t *camera_calibration,
+                                            const float *point2d,
+                                            const float *depth,
+                                            size_t point_count,
+                                            float *point3d,
+                                            int *valid);
+
+k4a_result_t transformation_project_batch(const k4a_calibration_camera_t *camera_calibration,
+                                          const float *point3d,
+                                          size_t point_count,
+                                          float *point2d,
+                                          int *valid);
+
 // Extrinsic transformations
 k4a_result_t transformation_get_extrinsic_transformation(const k4a_calibration_extrinsics_t *source_camera_calibration,
                                                          const k4a_calibration_extrinsics_t *target_camera_calibration,
@@ -54,6 +54,17 @@ K4A_DECLARE_HANDLE(usbcmd_t);
  */
 typedef void(usb_cmd_stream_cb_t)(k4a_result_t result, k4a_image_t image_handle, void *context);
 
+/** Counters describing how the streaming buffer pool and transfers have been used since the handle was created.
+ */
+typedef struct _usb_cmd_stream_pool_stats_t
+{
+    uint32_t transfer_count;  // Transfers submitted when the current (or last) stream started
+    uint32_t pool_size;       // Number of buffers pre-allocated for the current (or last) stream
+    uint32_t recycled_count;  // Transfers resubmitted with a buffer taken from the pool
+    uint32_t exhausted_count; // Transfers that found the pool empty and fell back to a fresh allocation
+    uint32_t timeout_count;   // Transfers that timed out and were resubmitted without data
+} usb_cmd_stream_pool_stats_t;
+
 //************ Declarations (Statics and globals) ***************
 
 //******************* Function Prototypes ***********************
@@ -138,11 +149,107 @@ k4a_result_t usb_cmd_stream_register_cb(usbcmd_t usbcmd, usb_cmd_stream_cb_t *fr
 
 k4a_result_t usb_cmd_stream_start(usbcmd_t usb_handle, size_t payload_size);
 
+/** Limit the outstanding transfers used by the stream.
+ *
+ * \param usb_handle [IN]
+ *    Handle to the usbcmd_t device the stream runs on
+ *
+ * \param max_transfer_count [IN]
+ *    Upper limit on the number of outstanding transfers, 0 for the default
+ *
+ * \param max_transfer_pool_size [IN]
+ *    Upper limit in bytes on the memory used by outstanding transfers, 0 for the default
+ *
+ * \return K4A_RESULT_SUCCEEDED if the limits were set, K4A_RESULT_FAILED if they are out of range or the stream is
+ * running
+ *
+ * The limits take effect the next time \ref usb_cmd_stream_start is called. The number of transfers actually
+ * submitted is reported by \ref usb_cmd_get_stream_pool_stats.
+ */
+k4a_result_t usb_cmd_stream_set_transfer_limits(usbcmd_t usb_handle,
+                                                uint32_t max_transfer_count,
+                                                size_t max_transfer_pool_size);
+
+/** Set the allocator used for the stream buffers.
+ *
+ * \param usb_handle [IN]
+ *    Handle to the usbcmd_t device the stream runs on
+ *
+ * \param hook [IN]
+ *    Allocator callbacks, copied. NULL or a hook without callbacks uses the process allocator.
+ *
+ * \return K4A_RESULT_SUCCEEDED if the allocator was set, K4A_RESULT_FAILED if the stream is running
+ *
+ * The allocator is used from the next time \ref usb_cmd_stream_start is called.
+ */
+k4a_result_t usb_cmd_stream_set_allocator(usbcmd_t usb_handle, const allocator_hook_t *hook);
+
+/** Pre-fault the stream buffers when the stream starts.
+ *
+ * \param usb_handle [IN]
+ *    Handle to the usbcmd_t device the stream runs on
+ *
+ * \param prefault [IN]
+ *    True to touch every pooled stream buffer before the first transfer is submitted
+ *
+ * \return K4A_RESULT_SUCCEEDED if the option was set, K4A_RESULT_FAILED if the stream is running
+ *
+ * Takes effect the next time \ref usb_cmd_stream_start is called.
+ */
+k4a_result_t usb_cmd_stream_set_prefault(usbcmd_t usb_handle, bool prefault);
+
 k4a_result_t usb_cmd_stream_stop(usbcmd_t usb_handle);
 
+/** Get the streaming buffer pool counters.
+ *
+ * \param usb_handle [IN]
+ *    Handle to the usbcmd_t device the stream is running on
+ *
+ * \param stats [OUT]
+ *    Location to write the counters to
+ *
+ * \return K4A_RESULT_SUCCEEDED if the counters were written, otherwise K4A_RESULT_FAILED
+ *
+ * A growing exhausted_count means images are being held downstream for longer than the pool can cover, and the stream
+ * is falling back to the allocator on the completion path.
+ */
+k4a_result_t usb_cmd_get_stream_pool_stats(usbcmd_t usb_handle, usb_cmd_stream_pool_stats_t *stats);
+
+/** Share libusb contexts and their event threads between all usbcmd_t instances created afterwards.
+ *
+ * \param thread_count [IN]
+ *    Number of shared contexts, each serviced by one event thread. Instances are spread across them by load. 0 restores
+ *    the default of one context and one event thread per stream.
+ *
+ * \return K4A_RESULT_SUCCEEDED if the mode was set, K4A_RESULT_FAILED if thread_count is out of range
+ *
+ * Instances already created keep the context they were created with.
+ */
+k4a_result_t usb_cmd_set_shared_event_threads(uint32_t thread_count);
+
 // Get the number of connected devices
 k4a_result_t usb_cmd_get_device_count(uint32_t *p_device_count);
 
+/** List the depth devices connected, in the order usb_cmd_create() indexes them, with their serial numbers
+ *
+ * \param devices [OUT]
+ *    Array of max_devices entries to write the devices to, may be NULL if max_devices is 0
+ *
+ * \param max_devices [IN]
+ *    Number of entries devices can hold
+ *
+ * \param device_count [OUT]
+ *    Number of devices connected, which may be more than max_devices
+ *
+ * \return K4A_RESULT_SUCCEEDED if the devices were listed, K4A_RESULT_FAILED if libusb could not list them
+ *
+ * Serial numbers are read from the USB string descriptors and kept by USB port, so each device is only opened the first
+ * time it is seen. A device opened by usb_cmd_create() has its serial number kept as well.
+ */
+k4a_result_t usb_cmd_get_installed_devices(k4a_installed_device_t *devices,
+                                           uint32_t max_devices,
+                                           uint32_t *device_count);
+
 const guid_t *usb_cmd_get_container_id(usbcmd_t usbcmd_handle);
 
 #ifdef __cplusplus
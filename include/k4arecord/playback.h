@@ -31,6 +31,18 @@ extern "C" {
  * If successful, this contains a pointer to the recording handle. Caller must call k4a_playback_close() when
  * finished with the recording.
  *
+ * \remarks
+ * Setting the K4A_PLAYBACK_MAPPED_IO environment variable to 1 reads the file through a memory mapping instead of file
+ * reads. Images of uncompressed tracks that need no conversion then point into the mapped file rather than holding a
+ * copy of their data, and keep it mapped until they are released. Writing to such an image changes only its memory,
+ * never the file. Files that can't be mapped are read as usual.
+ *
+ * \remarks
+ * If an index sidecar, a file named after the recording with the .k4aidx extension appended, was written for this
+ * version of the recording, the recording's clusters are found from it without searching the file. Setting the
+ * K4A_RECORDING_INDEX environment variable to 1 writes the sidecar when a recording missing its Cues index, such as
+ * one that wasn't closed, had to be searched. Sidecars that don't match the recording are ignored.
+ *
  * \headerfile playback.h <k4arecord/playback.h>
  *
  * \returns ::K4A_RESULT_SUCCEEDED is returned on success
@@ -47,6 +59,169 @@ extern "C" {
  */
 K4ARECORD_EXPORT k4a_result_t k4a_playback_open(const char *path, k4a_playback_t *playback_handle);
 
+/** Opens an existing recording file for reading, with options.
+ *
+ * \param path
+ * Filesystem path of the existing recording.
+ *
+ * \param flags
+ * A combination of ::k4a_playback_open_flags_t values. ::K4A_PLAYBACK_OPEN_DEFAULT opens the recording the same way as
+ * k4a_playback_open().
+ *
+ * \param playback_handle
+ * If successful, this contains a pointer to the recording handle. Caller must call k4a_playback_close() when
+ * finished with the recording.
+ *
+ * \headerfile playback.h <k4arecord/playback.h>
+ *
+ * \returns ::K4A_RESULT_SUCCEEDED is returned on success, or ::K4A_RESULT_FAILED if the recording can't be read or
+ * \p flags contains an unknown flag.
+ *
+ * \relates k4a_playback_t
+ *
+ * \remarks
+ * With ::K4A_PLAYBACK_OPEN_HEADER_ONLY, only the header of the recording is read when it is opened: the tracks,
+ * attachments, tags and Cues. The calibration, record configuration, tracks, tags and attachments can be read right
+ * away. The clusters of the recording are indexed, and its last cluster read to find its length, by the first function
+ * that reads data, seeks, returns the length of the recording or clones the playback. An error in the clusters of the
+ * recording is then returned by that function instead of by k4a_playback_open_ex(). This makes reading the metadata of
+ * many recordings much faster, especially recordings without Cues, whose clusters are found by searching the file.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_result_t k4a_playback_open_ex(const char *path, uint32_t flags, k4a_playback_t *playback_handle);
+
+/** Opens a recording read through I/O callbacks of the application, such as a recording streamed from object storage.
+ *
+ * \param callbacks
+ * The callbacks to read the recording through, see k4a_playback_io_callbacks_t. They are copied, and used until the
+ * close callback is called.
+ *
+ * \param playback_handle
+ * If successful, this contains a pointer to the recording handle. Caller must call k4a_playback_close() when
+ * finished with the recording.
+ *
+ * \remarks
+ * Unless k4a_playback_io_callbacks_t::forward_only is set, the recording is read the same way as a file opened with
+ * k4a_playback_open(), with its clusters read ahead concurrently. A read hint is given before each cluster is read, so
+ * a remote source can fetch it with a single range read.
+ *
+ * \remarks
+ * Forward-only recordings, such as ones read from a pipe, are parsed without seeking to their end. Their Cues, and the
+ * other elements after the first cluster, aren't read, and the recording length is taken from the duration in the
+ * recording's segment info, 0 if there is none. Playback then has to move forward through the recording: data the
+ * playback has moved past can be read again only while its cluster is still loaded, see
+ * k4a_playback_set_cluster_cache_size(). Seeking backward past it fails. The clusters aren't read ahead, and the
+ * playback can't be cloned.
+ *
+ * \remarks
+ * The close callback is called once the playback is closed, or before this function returns if it fails.
+ *
+ * \headerfile playback.h <k4arecord/playback.h>
+ *
+ * \returns ::K4A_RESULT_SUCCEEDED is returned on success
+ *
+ * \relates k4a_playback_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_result_t k4a_playback_open_callbacks(const k4a_playback_io_callbacks_t *callbacks,
+                                                          k4a_playback_t *playback_handle);
+
+/** Opens a recording streamed over TCP, such as the recording of a remote device written by
+ * k4a_record_create_network().
+ *
+ * \param host
+ * The host name or address of the machine streaming the recording.
+ *
+ * \param port
+ * The TCP port the recording is streamed on.
+ *
+ * \param playback_handle
+ * If successful, this contains a pointer to the recording handle. Caller must call k4a_playback_close() when
+ * finished with the recording.
+ *
+ * \remarks
+ * The recording is read the same way as one opened with k4a_playback_open_callbacks() with
+ * k4a_playback_io_callbacks_t::forward_only set. k4a_playback_get_next_capture() and
+ * k4a_playback_get_next_imu_sample() wait for the data to arrive, and return ::K4A_STREAM_RESULT_EOF once the server
+ * closes the recording. The calibration of the remote device is read with k4a_playback_get_calibration().
+ *
+ * \remarks
+ * Reading slower than the recording is streamed fills the write queue of the server, which then drops data according
+ * to its overflow policy.
+ *
+ * \headerfile playback.h <k4arecord/playback.h>
+ *
+ * \returns ::K4A_RESULT_SUCCEEDED is returned on success
+ *
+ * \relates k4a_playback_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_result_t k4a_playback_open_network(const char *host,
+                                                        uint16_t port,
+                                                        k4a_playback_t *playback_handle);
+
+/** Opens another handle to the recording of an open playback, sharing what was already read of the file.
+ *
+ * \param playback_handle
+ * Handle obtained by k4a_playback_open() or k4a_playback_clone().
+ *
+ * \param clone_handle
+ * If successful, this contains a pointer to the new recording handle. Caller must call k4a_playback_close() when
+ * finished with it.
+ *
+ * \remarks
+ * The clone shares the parsed header, tracks, tags and attachments of the recording with \p playback_handle, and starts
+ * with the clusters \p playback_handle has already found, so it doesn't parse or search the file again. It reads the
+ * file through its own file handle and has its own seek position, starting at the beginning of the recording, so each
+ * handle can be read from a different thread at the same time. Each handle must still only be used by one thread at a
+ * time.
+ *
+ * \remarks
+ * The clone gets the color conversion, color decode configuration, track filter, read-ahead count and cluster cache
+ * size of \p playback_handle at the time of the call, which can then be changed on each handle independently. The
+ * clone's cluster cache starts empty. Decode-ahead is not enabled on the clone, see k4a_playback_set_decode_ahead().
+ *
+ * \remarks
+ * \p playback_handle must not be used by another thread during the call. Shared data is released once the last of the
+ * handles is closed. Recordings opened with forward-only I/O callbacks can't be cloned.
+ *
+ * \headerfile playback.h <k4arecord/playback.h>
+ *
+ * \returns ::K4A_RESULT_SUCCEEDED is returned on success
+ *
+ * \relates k4a_playback_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_result_t k4a_playback_clone(k4a_playback_t playback_handle, k4a_playback_t *clone_handle);
+
 /** Get the raw calibration blob for the Azure Kinect device used during recording.
  *
  * \param playback_handle
@@ -134,6 +309,30 @@ K4ARECORD_EXPORT k4a_result_t k4a_playback_get_calibration(k4a_playback_t playba
 K4ARECORD_EXPORT k4a_result_t k4a_playback_get_record_configuration(k4a_playback_t playback_handle,
                                                                     k4a_record_configuration_t *config);
 
+/** Checks whether the depth track of the recording holds raw depth payloads.
+ *
+ * \param playback_handle
+ * Handle obtained by k4a_playback_open().
+ *
+ * \returns true if the recording was made with k4a_device_start_options_t::raw_depth_payload.
+ *
+ * \remarks
+ * The payloads are converted to depth and IR images by the depth engine when the captures are read, so the
+ * depth_track_enabled and ir_track_enabled fields of k4a_playback_get_record_configuration() describe the converted
+ * images.
+ *
+ * \relates k4a_playback_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT bool k4a_playback_has_raw_depth_payload(k4a_playback_t playback_handle);
+
 /** Checks whether a track with the given track name exists in the playback file.
  *
  * \param playback_handle
@@ -406,6 +605,202 @@ K4ARECORD_EXPORT k4a_buffer_result_t k4a_playback_get_tag(k4a_playback_t playbac
 K4ARECORD_EXPORT k4a_result_t k4a_playback_set_color_conversion(k4a_playback_t playback_handle,
                                                                 k4a_image_format_t target_format);
 
+/** Set the crop and scale of the color images converted to ::K4A_IMAGE_FORMAT_COLOR_BGRA32.
+ *
+ * \param playback_handle
+ * Handle obtained by k4a_playback_open().
+ *
+ * \param config
+ * Crop and scale of the images, see \ref k4a_color_decode_configuration_t. NULL selects the full image at full
+ * resolution, which is the default.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the configuration was set. ::K4A_RESULT_FAILED if the recording has no color track or the
+ * crop does not fit in its color images.
+ *
+ * \remarks
+ * The configuration applies to the color images of the captures returned once k4a_playback_set_color_conversion() has
+ * selected ::K4A_IMAGE_FORMAT_COLOR_BGRA32, or of recordings stored in that format. Other formats are not affected.
+ *
+ * \remarks
+ * MJPG images are decoded directly to the reduced resolution, which takes a fraction of the time of decoding the full
+ * image and resizing it. Images of the other formats are converted and then box filtered to the output size.
+ *
+ * \relates k4a_playback_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_result_t k4a_playback_set_color_decode(k4a_playback_t playback_handle,
+                                                            const k4a_color_decode_configuration_t *config);
+
+/** Set the number of clusters preloaded on each side of the current playback position.
+ *
+ * \param playback_handle
+ * Handle obtained by k4a_playback_open().
+ *
+ * \param cluster_count
+ * Number of clusters to preload before and after the one being read, from 0 to 32. The default is 2.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the count was set. ::K4A_RESULT_FAILED if \p cluster_count is larger than 32, or isn't 0
+ * for a recording read through forward-only I/O callbacks, see k4a_playback_open_callbacks().
+ *
+ * \remarks
+ * Each preloaded cluster is read by a task of its own with a separate handle to the file, so up to \p cluster_count
+ * reads are in flight as playback moves through the recording. Raising the count lets sequential playback keep up with
+ * storage that has a high latency per request, such as network shares, at the cost of keeping more clusters in memory.
+ * 0 reads each cluster only when playback reaches it.
+ *
+ * \remarks
+ * Reads ahead follow the direction of playback, so k4a_playback_get_previous_capture() is preloaded like
+ * k4a_playback_get_next_capture(). After a seek, \p cluster_count clusters are preloaded in the direction playback last
+ * moved in, and a single cluster in the other direction. Seeking exactly to the end of the recording reads ahead
+ * backward, and seeking exactly to its beginning reads ahead forward.
+ *
+ * \remarks
+ * The count applies to the clusters loaded after this call, the clusters already preloaded are kept.
+ *
+ * \relates k4a_playback_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_result_t k4a_playback_set_read_ahead(k4a_playback_t playback_handle, uint32_t cluster_count);
+
+/** Set the memory budget of the recently used clusters kept loaded.
+ *
+ * \param playback_handle
+ * Handle obtained by k4a_playback_open().
+ *
+ * \param cache_size
+ * Size in bytes of the clusters kept loaded after playback moves away from them. The default, 0, keeps only the
+ * clusters around the playback position preloaded by read-ahead.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the size was set.
+ *
+ * \remarks
+ * The clusters playback reads are kept in memory, up to \p cache_size bytes of them, and the least recently used ones
+ * are dropped first. Moving back and forth over the recent part of a recording, such as reading previous and next
+ * captures in turn, then doesn't read the same clusters from the file again. Clusters are counted by their size in
+ * the file. Lowering the size drops the clusters that no longer fit right away.
+ *
+ * \relates k4a_playback_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_result_t k4a_playback_set_cluster_cache_size(k4a_playback_t playback_handle, uint64_t cache_size);
+
+/** Get the counters of the cluster cache of the playback.
+ *
+ * \param playback_handle
+ * Handle obtained by k4a_playback_open().
+ *
+ * \param stats
+ * Location to write the counters to. They count from k4a_playback_open().
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if \p stats was written.
+ *
+ * \relates k4a_playback_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_result_t k4a_playback_get_cluster_cache_stats(k4a_playback_t playback_handle,
+                                                                   k4a_playback_cluster_cache_stats_t *stats);
+
+/** Set the number of color images converted in the background ahead of the captures read.
+ *
+ * \param playback_handle
+ * Handle obtained by k4a_playback_open().
+ *
+ * \param capture_count
+ * Number of captures after the last one read whose color image is converted ahead, from 0 to 16. The default, 0,
+ * converts each color image when its capture is read.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the count was set. ::K4A_RESULT_FAILED if the recording has no color track, or if
+ * \p capture_count is larger than 16.
+ *
+ * \remarks
+ * The color images are decoded or converted to the format selected by k4a_playback_set_color_conversion() and
+ * k4a_playback_set_color_decode() by a pool of threads while the caller processes the previous captures, so
+ * k4a_playback_get_next_capture() returns without waiting for the conversion if the pool keeps up. Images are converted
+ * ahead when reading forward only, seeking or changing the conversion drops the images already converted.
+ *
+ * \relates k4a_playback_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_result_t k4a_playback_set_decode_ahead(k4a_playback_t playback_handle, uint32_t capture_count);
+
+/** Enable or disable the reading of a track.
+ *
+ * \param playback_handle
+ * Handle obtained by k4a_playback_open().
+ *
+ * \param track_name
+ * NULL-terminated string containing the name of the track: "COLOR", "DEPTH", "IR", "IMU", or the name of a custom
+ * track.
+ *
+ * \param enabled
+ * false to stop reading the track, true to read it again. All the tracks are enabled when the recording is opened.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the track was enabled or disabled. ::K4A_RESULT_FAILED if the track cannot be found.
+ *
+ * \remarks
+ * The blocks of a disabled track are left out of the clusters read from the recording. The color, depth and IR images
+ * are stored as simple blocks, whose data is skipped on disk instead of being read and discarded, so playing back
+ * only the depth track of a recording reads a fraction of the file. Captures don't include the images of disabled
+ * tracks, and reading the samples or data blocks of a disabled track returns ::K4A_STREAM_RESULT_EOF.
+ *
+ * \remarks
+ * Enabling or disabling a track seeks to the start of the recording, as the clusters already loaded are dropped.
+ *
+ * \relates k4a_playback_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_result_t k4a_playback_set_track_filter(k4a_playback_t playback_handle,
+                                                            const char *track_name,
+                                                            bool enabled);
+
 /** Reads an attachment file from a recording.
  *
  * \param playback_handle
@@ -601,12 +996,168 @@ K4ARECORD_EXPORT k4a_stream_result_t k4a_playback_get_next_imu_sample(k4a_playba
 K4ARECORD_EXPORT k4a_stream_result_t k4a_playback_get_previous_imu_sample(k4a_playback_t playback_handle,
                                                                           k4a_imu_sample_t *imu_sample);
 
-/** Read the next data block for a particular track.
+/** Read the IMU samples of a time range of the recording into an array.
  *
  * \param playback_handle
  * Handle obtained by k4a_playback_open().
  *
- * \param track_name
+ * \param start_timestamp_usec
+ * The first accelerometer device timestamp to read, in microseconds.
+ *
+ * \param end_timestamp_usec
+ * The accelerometer device timestamp to stop at, in microseconds. Samples at or after this timestamp aren't read.
+ *
+ * \param samples
+ * The location to write the IMU samples, in recording order. This may be NULL if \p max_sample_count is 0.
+ *
+ * \param max_sample_count
+ * The number of samples \p samples has room for.
+ *
+ * \param sample_count
+ * The location to write the number of samples read.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the samples were read, ::K4A_RESULT_FAILED on a read error.
+ *
+ * \relates k4a_playback_t
+ *
+ * \remarks
+ * The samples are decoded a whole block at a time, which is much faster than reading them one by one with
+ * k4a_playback_get_next_imu_sample() when extracting the IMU data of a recording. Fewer than \p max_sample_count
+ * samples are read once \p end_timestamp_usec or the end of the recording is reached. If \p sample_count equals
+ * \p max_sample_count, the rest of the range is read by calling again with a start timestamp after the accelerometer
+ * timestamp of the last sample read.
+ *
+ * \remarks
+ * The timestamps are device timestamps, like the ones of the returned samples, not offsets from the start of the
+ * recording. Reading samples by time range doesn't change the position of k4a_playback_get_next_imu_sample() and
+ * k4a_playback_get_previous_imu_sample(). If the recording has no IMU track, or it is disabled by
+ * k4a_playback_set_track_filter(), no samples are read.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_result_t k4a_playback_get_imu_samples(k4a_playback_t playback_handle,
+                                                           uint64_t start_timestamp_usec,
+                                                           uint64_t end_timestamp_usec,
+                                                           k4a_imu_sample_t *samples,
+                                                           size_t max_sample_count,
+                                                           size_t *sample_count);
+
+/** List the device timestamps of the blocks of a track within a time range of the recording.
+ *
+ * \param playback_handle
+ * Handle obtained by k4a_playback_open().
+ *
+ * \param track_name
+ * The name of the track to list the block timestamps of, either a built-in track such as "COLOR", "DEPTH" or "IR", or
+ * a custom track.
+ *
+ * \param start_timestamp_usec
+ * The first device timestamp to list, in microseconds.
+ *
+ * \param end_timestamp_usec
+ * The device timestamp to stop at, in microseconds. Blocks at or after this timestamp aren't listed.
+ *
+ * \param timestamps_usec
+ * The location to write the timestamps, in recording order. This may be NULL if \p max_timestamp_count is 0.
+ *
+ * \param max_timestamp_count
+ * The number of timestamps \p timestamps_usec has room for.
+ *
+ * \param timestamp_count
+ * The location to write the number of timestamps listed.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the timestamps were listed, ::K4A_RESULT_FAILED if the track doesn't exist or on a read
+ * error.
+ *
+ * \relates k4a_playback_t
+ *
+ * \remarks
+ * Only the cluster and block headers are read, the data of the blocks is seeked past. Listing the timestamps of the
+ * images of a recording this way is much faster than reading its captures with k4a_playback_get_next_capture(). The
+ * timestamps are the device timestamps k4a_image_get_device_timestamp_usec() returns for the images of the track. For
+ * the IMU track, the timestamp of a block is the one of its first sample.
+ *
+ * \remarks
+ * Fewer than \p max_timestamp_count timestamps are listed once \p end_timestamp_usec or the end of the recording is
+ * reached. If \p timestamp_count equals \p max_timestamp_count, the rest of the range is listed by calling again with
+ * a start timestamp after the last timestamp listed. Listing timestamps doesn't change the playback position. If the
+ * track is disabled by k4a_playback_set_track_filter(), no timestamps are listed.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_result_t k4a_playback_get_track_timestamps(k4a_playback_t playback_handle,
+                                                               const char *track_name,
+                                                               uint64_t start_timestamp_usec,
+                                                               uint64_t end_timestamp_usec,
+                                                               uint64_t *timestamps_usec,
+                                                               size_t max_timestamp_count,
+                                                               size_t *timestamp_count);
+
+/** Write the part of a recording between two timestamps to a new recording file.
+ *
+ * \param playback_handle
+ * Handle obtained by k4a_playback_open().
+ *
+ * \param path
+ * Filesystem path of the trimmed recording. It can't be the path of the recording being read.
+ *
+ * \param start_timestamp_usec
+ * The first device timestamp to keep, in microseconds.
+ *
+ * \param end_timestamp_usec
+ * The device timestamp to stop at, in microseconds. Blocks at or after this timestamp aren't written.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the trimmed recording was written, ::K4A_RESULT_FAILED if the range holds no data, on a
+ * read or write error, or if the recording is read through k4a_playback_open_callbacks() with a forward-only source.
+ * On failure, no file is left at \p path.
+ *
+ * \relates k4a_playback_t
+ *
+ * \remarks
+ * The blocks of every track, custom tracks included, are copied without being decoded. Only the headers of the clusters
+ * at the ends of the range are rewritten, so trimming is limited by the speed of the disk rather than of the codecs.
+ * The tracks, attachments and tags of the recording are copied as they are, and the Cues are written again for the
+ * trimmed recording. The track filter set by k4a_playback_set_track_filter() doesn't apply.
+ *
+ * \remarks
+ * The trimmed recording starts at timestamp 0, like any recording, and its K4A_START_OFFSET_NS tag is moved forward by
+ * the trimmed time. The device timestamps of its images and IMU samples are the same as in the source recording.
+ * Trimming doesn't change the playback position.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_result_t k4a_playback_trim(k4a_playback_t playback_handle,
+                                               const char *path,
+                                               uint64_t start_timestamp_usec,
+                                               uint64_t end_timestamp_usec);
+
+/** Read the next data block for a particular track.
+ *
+ * \param playback_handle
+ * Handle obtained by k4a_playback_open().
+ *
+ * \param track_name
  * The name of the track to read the next data block from.
  *
  * \param data_block_handle
@@ -836,6 +1387,71 @@ K4ARECORD_EXPORT k4a_result_t k4a_playback_seek_timestamp(k4a_playback_t playbac
                                                           int64_t offset_usec,
                                                           k4a_playback_seek_origin_t origin);
 
+/** Get the number of captures in the recording.
+ *
+ * \param playback_handle
+ * Handle obtained by k4a_playback_open().
+ *
+ * \returns
+ * The number of captures k4a_playback_get_next_capture() returns when reading the recording from the start, or 0 if
+ * the recording can't be read.
+ *
+ * \remarks
+ * The first call reads every cluster of the recording to build an index of its captures, the index is then kept until
+ * the recording is closed or k4a_playback_set_track_filter() changes the tracks read. Disabled tracks aren't part of
+ * the captures counted.
+ *
+ * \relates k4a_playback_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT uint64_t k4a_playback_get_capture_count(k4a_playback_t playback_handle);
+
+/** Read the capture at an index of the recording.
+ *
+ * \param playback_handle
+ * Handle obtained by k4a_playback_open().
+ *
+ * \param capture_index
+ * Index of the capture, from 0 to the count returned by k4a_playback_get_capture_count().
+ *
+ * \param capture_handle
+ * If successful this contains a handle to a capture object. Caller must call k4a_capture_release() when its done using
+ * this capture.
+ *
+ * \returns
+ * ::K4A_STREAM_RESULT_SUCCEEDED if a capture is returned, or ::K4A_STREAM_RESULT_EOF if \p capture_index is past the
+ * last capture. ::K4A_STREAM_RESULT_FAILED is returned if there is an error reading the recording.
+ *
+ * \remarks
+ * The capture is the same as the one k4a_playback_get_next_capture() returns after reading \p capture_index captures
+ * from the start of the recording. Using the capture index built by k4a_playback_get_capture_count(), which is built
+ * by the first call if needed, reading a capture loads only the cluster holding it.
+ *
+ * \remarks
+ * Playback continues from the capture read: k4a_playback_get_next_capture() and k4a_playback_get_previous_capture()
+ * return the captures after and before it.
+ *
+ * \relates k4a_playback_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_stream_result_t k4a_playback_get_capture_at_index(k4a_playback_t playback_handle,
+                                                                       uint64_t capture_index,
+                                                                       k4a_capture_t *capture_handle);
+
 /** Returns the length of the recording in microseconds.
  *
  * \param playback_handle
@@ -906,6 +1522,478 @@ K4ARECORD_DEPRECATED_EXPORT uint64_t k4a_playback_get_last_timestamp_usec(k4a_pl
  */
 K4ARECORD_EXPORT void k4a_playback_close(k4a_playback_t playback_handle);
 
+/** Opens the segment files of a recording split by k4a_record_set_segment_limits() for playback as one recording.
+ *
+ * \param path
+ * Filesystem path of the first segment, the path given to k4a_record_create().
+ *
+ * \param segments_handle
+ * If successful, this contains a pointer to the segments handle. Caller must call k4a_playback_segments_close() when
+ * finished reading the recording.
+ *
+ * \headerfile playback.h <k4arecord/playback.h>
+ *
+ * \relates k4a_playback_segments_t
+ *
+ * \returns ::K4A_RESULT_SUCCEEDED is returned on success
+ *
+ * \remarks
+ * The segments following the first one are found by their file names, up to the first missing segment. Only the first
+ * segment is opened by this function, the others are opened when they are read or seeked into, and closed once the
+ * captures and IMU samples read have moved on to another segment. A recording that wasn't split is opened as a single
+ * segment.
+ *
+ * \remarks
+ * The segments share one timeline, so the timestamps of the captures and IMU samples continue from one segment to the
+ * next. A capture whose images were written on both sides of a segment boundary is read as two captures, each holding
+ * the images of one segment.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_result_t k4a_playback_segments_open(const char *path, k4a_playback_segments_t *segments_handle);
+
+/** Gets the number of segments of a recording.
+ *
+ * \param segments_handle
+ * Handle obtained by k4a_playback_segments_open().
+ *
+ * \returns
+ * The number of segment files found when the recording was opened.
+ *
+ * \relates k4a_playback_segments_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT size_t k4a_playback_segments_get_count(k4a_playback_segments_t segments_handle);
+
+/** Gets the playback handle of a segment of a recording.
+ *
+ * \param segments_handle
+ * Handle obtained by k4a_playback_segments_open().
+ *
+ * \param index
+ * The index of the segment, less than k4a_playback_segments_get_count().
+ *
+ * \param playback_handle
+ * If successful, this contains the playback handle of the segment. It is owned by \p segments_handle and stays
+ * valid until k4a_playback_segments_close() is called, the caller must not close it.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the segment was opened, ::K4A_RESULT_FAILED otherwise.
+ *
+ * \relates k4a_playback_segments_t
+ *
+ * \remarks
+ * The calibration, record configuration, tags and attachments of a recording are the same in each segment, they are
+ * read from the playback of segment 0. A segment opened by this function stays open until the recording is closed.
+ * Reading captures or seeking through this handle changes the position of the segment playback only, use the
+ * k4a_playback_segments functions to read the recording as a whole.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_result_t k4a_playback_segments_get_playback(k4a_playback_segments_t segments_handle,
+                                                                 size_t index,
+                                                                 k4a_playback_t *playback_handle);
+
+/** Sets the image format color captures of the recording are converted to.
+ *
+ * \param segments_handle
+ * Handle obtained by k4a_playback_segments_open().
+ *
+ * \param target_format
+ * The target image format, see k4a_playback_set_color_conversion().
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the format is supported, ::K4A_RESULT_FAILED otherwise.
+ *
+ * \relates k4a_playback_segments_t
+ *
+ * \remarks
+ * The conversion applies to the open segments and to the segments opened later.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_result_t k4a_playback_segments_set_color_conversion(k4a_playback_segments_t segments_handle,
+                                                                         k4a_image_format_t target_format);
+
+/** Reads the next capture of a recording split into segments.
+ *
+ * \param segments_handle
+ * Handle obtained by k4a_playback_segments_open().
+ *
+ * \param capture_handle
+ * If successful this contains a handle to a capture object. The caller must call k4a_capture_release() when its done
+ * using this capture.
+ *
+ * \returns
+ * ::K4A_STREAM_RESULT_SUCCEEDED if a capture is returned, or ::K4A_STREAM_RESULT_EOF if the end of the last segment
+ * has been reached. ::K4A_STREAM_RESULT_FAILED is returned on a read error or if a segment can't be opened.
+ *
+ * \relates k4a_playback_segments_t
+ *
+ * \remarks
+ * At the end of a segment, reading goes on from the start of the next one, see k4a_playback_get_next_capture().
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_stream_result_t k4a_playback_segments_get_next_capture(k4a_playback_segments_t segments_handle,
+                                                                            k4a_capture_t *capture_handle);
+
+/** Reads the previous capture of a recording split into segments.
+ *
+ * \param segments_handle
+ * Handle obtained by k4a_playback_segments_open().
+ *
+ * \param capture_handle
+ * If successful this contains a handle to a capture object. The caller must call k4a_capture_release() when its done
+ * using this capture.
+ *
+ * \returns
+ * ::K4A_STREAM_RESULT_SUCCEEDED if a capture is returned, or ::K4A_STREAM_RESULT_EOF if the start of the first
+ * segment has been reached. ::K4A_STREAM_RESULT_FAILED is returned on a read error or if a segment can't be opened.
+ *
+ * \relates k4a_playback_segments_t
+ *
+ * \remarks
+ * At the start of a segment, reading goes on from the end of the previous one, see
+ * k4a_playback_get_previous_capture().
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_stream_result_t k4a_playback_segments_get_previous_capture(k4a_playback_segments_t segments_handle,
+                                                                                k4a_capture_t *capture_handle);
+
+/** Reads the next IMU sample of a recording split into segments.
+ *
+ * \param segments_handle
+ * Handle obtained by k4a_playback_segments_open().
+ *
+ * \param imu_sample
+ * The location to write the IMU sample.
+ *
+ * \returns
+ * ::K4A_STREAM_RESULT_SUCCEEDED if a sample is returned, or ::K4A_STREAM_RESULT_EOF if the end of the last segment
+ * has been reached. ::K4A_STREAM_RESULT_FAILED is returned on a read error or if a segment can't be opened.
+ *
+ * \relates k4a_playback_segments_t
+ *
+ * \remarks
+ * The IMU samples are read independently of the captures, see k4a_playback_get_next_imu_sample().
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_stream_result_t k4a_playback_segments_get_next_imu_sample(k4a_playback_segments_t segments_handle,
+                                                                               k4a_imu_sample_t *imu_sample);
+
+/** Reads the previous IMU sample of a recording split into segments.
+ *
+ * \param segments_handle
+ * Handle obtained by k4a_playback_segments_open().
+ *
+ * \param imu_sample
+ * The location to write the IMU sample.
+ *
+ * \returns
+ * ::K4A_STREAM_RESULT_SUCCEEDED if a sample is returned, or ::K4A_STREAM_RESULT_EOF if the start of the first
+ * segment has been reached. ::K4A_STREAM_RESULT_FAILED is returned on a read error or if a segment can't be opened.
+ *
+ * \relates k4a_playback_segments_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_stream_result_t
+k4a_playback_segments_get_previous_imu_sample(k4a_playback_segments_t segments_handle, k4a_imu_sample_t *imu_sample);
+
+/** Seeks to a timestamp of a recording split into segments.
+ *
+ * \param segments_handle
+ * Handle obtained by k4a_playback_segments_open().
+ *
+ * \param offset_usec
+ * The timestamp offset to seek to, relative to \p origin, see k4a_playback_seek_timestamp().
+ *
+ * \param origin
+ * Specifies if the seek operation should be done relative to the beginning of the first segment, the end of the last
+ * segment, or to the device timestamps of the recording.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the seek operation was successful, or ::K4A_RESULT_FAILED if an error occured.
+ *
+ * \relates k4a_playback_segments_t
+ *
+ * \remarks
+ * The segment holding the timestamp is found with a binary search over the lengths of the segments, opening the
+ * segments whose length isn't known yet. The read positions of the captures and of the IMU samples are both moved to
+ * the timestamp.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_result_t k4a_playback_segments_seek_timestamp(k4a_playback_segments_t segments_handle,
+                                                                   int64_t offset_usec,
+                                                                   k4a_playback_seek_origin_t origin);
+
+/** Returns the length of a recording split into segments in microseconds.
+ *
+ * \param segments_handle
+ * Handle obtained by k4a_playback_segments_open().
+ *
+ * \returns
+ * The end timestamp of the last segment, relative to the start of the first one, see
+ * k4a_playback_get_recording_length_usec(). 0 is returned if the last segment can't be opened.
+ *
+ * \relates k4a_playback_segments_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT uint64_t k4a_playback_segments_get_recording_length_usec(k4a_playback_segments_t segments_handle);
+
+/** Closes a recording split into segments and the playback handles of its segments.
+ *
+ * \param segments_handle
+ * Handle obtained by k4a_playback_segments_open().
+ *
+ * \relates k4a_playback_segments_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT void k4a_playback_segments_close(k4a_playback_segments_t segments_handle);
+
+/** Opens the recordings of a group of synchronized devices for playback together.
+ *
+ * \param paths
+ * The file paths of the recordings. The recording of the master device must be first, the subordinate recordings
+ * follow in any order.
+ *
+ * \param path_count
+ * The number of paths in \p paths.
+ *
+ * \param reader_thread_count
+ * The number of threads reading ahead in the recordings of the group, or 0 for one thread per recording.
+ *
+ * \param group_handle
+ * If successful, this contains a pointer to the group handle. Caller must call k4a_playback_group_close() when
+ * finished with the recordings.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED is returned on success, or ::K4A_RESULT_FAILED if a recording can't be opened.
+ *
+ * \relates k4a_playback_group_t
+ *
+ * \remarks
+ * Instead of each recording starting read-ahead threads of its own, the clusters of all the recordings are read by
+ * the threads of the group, in the order they are needed. A group of many recordings then keeps a bounded number of
+ * reads in flight. The recordings are opened without reading their clusters up front, see
+ * ::K4A_PLAYBACK_OPEN_HEADER_ONLY.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_result_t k4a_playback_group_open(const char *const *paths,
+                                                      size_t path_count,
+                                                      uint32_t reader_thread_count,
+                                                      k4a_playback_group_t *group_handle);
+
+/** Gets the number of recordings of a group.
+ *
+ * \param group_handle
+ * Handle obtained by k4a_playback_group_open().
+ *
+ * \returns
+ * The number of recordings the group was opened with.
+ *
+ * \relates k4a_playback_group_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT size_t k4a_playback_group_get_count(k4a_playback_group_t group_handle);
+
+/** Gets the playback handle of a recording of a group.
+ *
+ * \param group_handle
+ * Handle obtained by k4a_playback_group_open().
+ *
+ * \param index
+ * The index of the recording in the paths passed to k4a_playback_group_open(), less than
+ * k4a_playback_group_get_count().
+ *
+ * \returns
+ * The playback handle of the recording, or NULL if \p index is out of range. It is owned by \p group_handle and stays
+ * valid until k4a_playback_group_close() is called, the caller must not close it.
+ *
+ * \relates k4a_playback_group_t
+ *
+ * \remarks
+ * The handle can be used to read the configuration, calibration, tags and IMU samples of the recording. Reading
+ * captures or seeking with it moves the read position of the group.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_playback_t k4a_playback_group_get_playback(k4a_playback_group_t group_handle, size_t index);
+
+/** Reads the next captures of the recordings of a group, matched by the time they were taken.
+ *
+ * \param group_handle
+ * Handle obtained by k4a_playback_group_open().
+ *
+ * \param capture_handles
+ * An array of k4a_playback_group_get_count() capture handles, one per recording in group order. If successful, each
+ * handle is a capture taken within half a frame period of the others, or NULL if the recording has no capture
+ * matching them. The caller must call k4a_capture_release() on the non-NULL handles when done with them.
+ *
+ * \returns
+ * ::K4A_STREAM_RESULT_SUCCEEDED if captures are returned, or ::K4A_STREAM_RESULT_EOF if the end of every recording
+ * has been reached. ::K4A_STREAM_RESULT_FAILED is returned on a read error.
+ *
+ * \relates k4a_playback_group_t
+ *
+ * \remarks
+ * The captures are compared on the master's timeline: the device timestamp of the depth image, less the
+ * depth_delay_off_color_usec and the subordinate_delay_off_master_usec of its recording. The earliest capture not yet
+ * returned and the captures close enough to it are returned together.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_stream_result_t k4a_playback_group_get_next_captures(k4a_playback_group_t group_handle,
+                                                                          k4a_capture_t *capture_handles);
+
+/** Seeks the recordings of a group to a time of the master recording.
+ *
+ * \param group_handle
+ * Handle obtained by k4a_playback_group_open().
+ *
+ * \param offset_usec
+ * The timestamp offset to seek to, relative to \p origin, see k4a_playback_seek_timestamp().
+ *
+ * \param origin
+ * Specifies if the seek operation should be done relative to the beginning or end of the master recording, or to its
+ * device timestamps.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the seek operation was successful, or ::K4A_RESULT_FAILED if an error occured.
+ *
+ * \relates k4a_playback_group_t
+ *
+ * \remarks
+ * Each subordinate recording is seeked to the same time, offset by its subordinate_delay_off_master_usec.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_result_t k4a_playback_group_seek_timestamp(k4a_playback_group_t group_handle,
+                                                                int64_t offset_usec,
+                                                                k4a_playback_seek_origin_t origin);
+
+/** Closes the recordings of a group and stops its reader threads.
+ *
+ * \param group_handle
+ * Handle obtained by k4a_playback_group_open().
+ *
+ * \relates k4a_playback_group_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT void k4a_playback_group_close(k4a_playback_group_t group_handle);
+
 /**
  * @}
  */
@@ -252,6 +252,15 @@ public:
         return config;
     }
 
+    /** Checks whether the depth track of the recording holds raw depth payloads
+     *
+     * \sa k4a_playback_has_raw_depth_payload
+     */
+    bool has_raw_depth_payload() const noexcept
+    {
+        return k4a_playback_has_raw_depth_payload(m_handle);
+    }
+
     /** Get the next capture in the recording.
      * Returns true if a capture was available, false if there are none left.
      * Throws error on failure.
@@ -276,6 +285,39 @@ public:
         throw error("Failed to get next capture!");
     }
 
+    /** Get the capture at an index of the recording.
+     * Returns true if a capture was available, false if the index is past the last capture.
+     * Throws error on failure.
+     *
+     * \sa k4a_playback_get_capture_at_index
+     */
+    bool get_capture_at_index(uint64_t capture_index, capture *cap)
+    {
+        k4a_capture_t capture_handle;
+        k4a_stream_result_t result = k4a_playback_get_capture_at_index(m_handle, capture_index, &capture_handle);
+
+        if (K4A_STREAM_RESULT_SUCCEEDED == result)
+        {
+            *cap = capture(capture_handle);
+            return true;
+        }
+        else if (K4A_STREAM_RESULT_EOF == result)
+        {
+            return false;
+        }
+
+        throw error("Failed to get capture at index!");
+    }
+
+    /** Get the number of captures in the recording
+     *
+     * \sa k4a_playback_get_capture_count
+     */
+    uint64_t get_capture_count() const noexcept
+    {
+        return k4a_playback_get_capture_count(m_handle);
+    }
+
     /** Get the previous capture in the recording.
      * Returns true if a capture was available, false if there are none left.
      * Throws error on failure.
@@ -378,6 +420,81 @@ public:
         throw error("Failed to get previous IMU sample!");
     }
 
+    /** Reads the IMU samples of a time range of the recording.
+     * Returns the number of samples written to samples, fewer than max_sample_count once the end of the range is
+     * reached.
+     * Throws error on failure.
+     *
+     * \sa k4a_playback_get_imu_samples
+     */
+    size_t get_imu_samples(std::chrono::microseconds start_timestamp,
+                           std::chrono::microseconds end_timestamp,
+                           k4a_imu_sample_t *samples,
+                           size_t max_sample_count)
+    {
+        size_t sample_count = 0;
+        k4a_result_t result = k4a_playback_get_imu_samples(m_handle,
+                                                           static_cast<uint64_t>(start_timestamp.count()),
+                                                           static_cast<uint64_t>(end_timestamp.count()),
+                                                           samples,
+                                                           max_sample_count,
+                                                           &sample_count);
+
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to get IMU samples!");
+        }
+        return sample_count;
+    }
+
+    /** Lists the device timestamps of the blocks of a track in [start_timestamp, end_timestamp) into an array, without
+     * reading the block data. Returns the number of timestamps listed, which is less than max_timestamp_count once the
+     * end of the range is reached.
+     * Throws error on failure.
+     *
+     * \sa k4a_playback_get_track_timestamps
+     */
+    size_t get_track_timestamps(const char *track_name,
+                                std::chrono::microseconds start_timestamp,
+                                std::chrono::microseconds end_timestamp,
+                                uint64_t *timestamps_usec,
+                                size_t max_timestamp_count)
+    {
+        size_t timestamp_count = 0;
+        k4a_result_t result = k4a_playback_get_track_timestamps(m_handle,
+                                                                track_name,
+                                                                static_cast<uint64_t>(start_timestamp.count()),
+                                                                static_cast<uint64_t>(end_timestamp.count()),
+                                                                timestamps_usec,
+                                                                max_timestamp_count,
+                                                                &timestamp_count);
+
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to get track timestamps!");
+        }
+        return timestamp_count;
+    }
+
+    /** Writes the part of the recording in [start_timestamp, end_timestamp) to a new recording, copying the blocks
+     * without decoding them.
+     * Throws error on failure.
+     *
+     * \sa k4a_playback_trim
+     */
+    void trim(const char *path, std::chrono::microseconds start_timestamp, std::chrono::microseconds end_timestamp)
+    {
+        k4a_result_t result = k4a_playback_trim(m_handle,
+                                                path,
+                                                static_cast<uint64_t>(start_timestamp.count()),
+                                                static_cast<uint64_t>(end_timestamp.count()));
+
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to trim recording!");
+        }
+    }
+
     /** Seeks to a specific time point in the recording
      * Throws error on failure.
      *
@@ -419,6 +536,100 @@ public:
         }
     }
 
+    /** Set the crop and scale of the color images converted to K4A_IMAGE_FORMAT_COLOR_BGRA32, NULL selects the full
+     * image at full resolution.
+     *
+     * Throws error on failure.
+     *
+     * \sa k4a_playback_set_color_decode
+     */
+    void set_color_decode(const k4a_color_decode_configuration_t *config)
+    {
+        k4a_result_t result = k4a_playback_set_color_decode(m_handle, config);
+
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to set color decode!");
+        }
+    }
+
+    /** Set the number of clusters preloaded on each side of the current playback position.
+     * Throws error on failure.
+     *
+     * \sa k4a_playback_set_read_ahead
+     */
+    void set_read_ahead(uint32_t cluster_count)
+    {
+        k4a_result_t result = k4a_playback_set_read_ahead(m_handle, cluster_count);
+
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to set read-ahead!");
+        }
+    }
+
+    /** Set the memory budget of the recently used clusters kept loaded.
+     * Throws error on failure.
+     *
+     * \sa k4a_playback_set_cluster_cache_size
+     */
+    void set_cluster_cache_size(uint64_t cache_size)
+    {
+        k4a_result_t result = k4a_playback_set_cluster_cache_size(m_handle, cache_size);
+
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to set cluster cache size!");
+        }
+    }
+
+    /** Get the counters of the cluster cache of the playback.
+     * Throws error on failure.
+     *
+     * \sa k4a_playback_get_cluster_cache_stats
+     */
+    k4a_playback_cluster_cache_stats_t get_cluster_cache_stats() const
+    {
+        k4a_playback_cluster_cache_stats_t stats;
+        k4a_result_t result = k4a_playback_get_cluster_cache_stats(m_handle, &stats);
+
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to get cluster cache stats!");
+        }
+        return stats;
+    }
+
+    /** Set the number of color images converted in the background ahead of the captures read.
+     * Throws error on failure.
+     *
+     * \sa k4a_playback_set_decode_ahead
+     */
+    void set_decode_ahead(uint32_t capture_count)
+    {
+        k4a_result_t result = k4a_playback_set_decode_ahead(m_handle, capture_count);
+
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to set decode-ahead!");
+        }
+    }
+
+    /** Enable or disable the reading of a track.
+     * Throws error on failure.
+     *
+     * \sa k4a_playback_set_track_filter
+     */
+    void set_track_filter(const char *track_name, bool enabled)
+    {
+        k4a_result_t result = k4a_playback_set_track_filter(m_handle, track_name, enabled);
+
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to set track filter!");
+        }
+    }
+
     /** Get the next data block in the recording.
      * Returns true if a block was available, false if there are none left.
      * Throws error on failure.
@@ -490,6 +701,24 @@ public:
         return false;
     }
 
+    /** Opens another playback of the same recording, sharing what was already read of the file.
+     * Throws error on failure.
+     *
+     * \sa k4a_playback_clone
+     */
+    playback clone() const
+    {
+        k4a_playback_t handle = nullptr;
+        k4a_result_t result = k4a_playback_clone(m_handle, &handle);
+
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to clone playback!");
+        }
+
+        return playback(handle);
+    }
+
     /** Opens a K4A recording for playback.
      * Throws error on failure.
      *
@@ -508,6 +737,60 @@ public:
         return playback(handle);
     }
 
+    /** Opens a K4A recording for playback with k4a_playback_open_flags_t flags.
+     * Throws error on failure.
+     *
+     * \sa k4a_playback_open_ex
+     */
+    static playback open_ex(const char *path, uint32_t flags)
+    {
+        k4a_playback_t handle = nullptr;
+        k4a_result_t result = k4a_playback_open_ex(path, flags, &handle);
+
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to open recording!");
+        }
+
+        return playback(handle);
+    }
+
+    /** Opens a K4A recording read through I/O callbacks for playback.
+     * Throws error on failure.
+     *
+     * \sa k4a_playback_open_callbacks
+     */
+    static playback open_callbacks(const k4a_playback_io_callbacks_t &callbacks)
+    {
+        k4a_playback_t handle = nullptr;
+        k4a_result_t result = k4a_playback_open_callbacks(&callbacks, &handle);
+
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to open recording!");
+        }
+
+        return playback(handle);
+    }
+
+    /** Opens a K4A recording streamed over TCP for playback.
+     * Throws error on failure.
+     *
+     * \sa k4a_playback_open_network
+     */
+    static playback open_network(const char *host, uint16_t port)
+    {
+        k4a_playback_t handle = nullptr;
+        k4a_result_t result = k4a_playback_open_network(host, port, &handle);
+
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to open recording!");
+        }
+
+        return playback(handle);
+    }
+
 private:
     k4a_playback_t m_handle;
 };
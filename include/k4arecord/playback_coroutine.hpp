@@ -0,0 +1,193 @@
+/** \file playback_coroutine.hpp
+ * Copyright (c) Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License.
+ * Kinect For Azure SDK - C++20 coroutine wrapper.
+ */
+
+#ifndef K4A_PLAYBACK_COROUTINE_HPP
+#define K4A_PLAYBACK_COROUTINE_HPP
+
+#include <k4a/k4a_coroutine.hpp>
+#include <k4arecord/playback.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace k4a
+{
+
+/** \class playback_reader playback_coroutine.hpp <k4arecord/playback_coroutine.hpp>
+ * Reads captures from recordings for coroutines
+ *
+ * A recording has nothing to wait for other than the read and decode itself, so co_await on next_capture() queues the
+ * read to a small pool of reader threads and suspends the coroutine until it completes. The reader threads are shared
+ * by every recording read through the reader, so many recordings can be read by a few threads while the coroutines
+ * run on the application's executor.
+ *
+ * Each playback must only be read by one coroutine at a time. The reader must outlive the reads queued to it.
+ *
+ * \sa k4a_playback_get_next_capture
+ */
+class playback_reader
+{
+public:
+    /** Awaitable returned by next_capture()
+     */
+    class awaiter
+    {
+    public:
+        awaiter(playback_reader *reader, playback *pb) noexcept : m_reader(reader), m_playback(pb) {}
+
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            m_handle = handle;
+            m_reader->enqueue(this);
+        }
+
+        /** Returns the next capture, or an invalid capture at the end of the recording
+         * Throws error if the read failed
+         */
+        capture await_resume()
+        {
+            if (m_error)
+            {
+                std::rethrow_exception(m_error);
+            }
+            return std::move(m_capture);
+        }
+
+    private:
+        friend class playback_reader;
+
+        playback_reader *m_reader;
+        playback *m_playback;
+        std::coroutine_handle<> m_handle;
+        capture m_capture;
+        std::exception_ptr m_error;
+    };
+
+    /** Starts \p thread_count reader threads
+     *
+     * \p resumer resumes each coroutine once its read has completed.
+     */
+    explicit playback_reader(size_t thread_count = 1, coroutine_resumer resumer = nullptr) :
+        m_resumer(std::move(resumer))
+    {
+        for (size_t i = 0; i < (thread_count == 0 ? 1 : thread_count); i++)
+        {
+            m_threads.emplace_back([this]() { run(); });
+        }
+    }
+
+    playback_reader(const playback_reader &) = delete;
+    playback_reader &operator=(const playback_reader &) = delete;
+
+    /** Stops the reader threads
+     *
+     * Reads that have not started resume with an error.
+     */
+    ~playback_reader()
+    {
+        std::deque<awaiter *> pending;
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_stop = true;
+            pending.swap(m_pending);
+        }
+        m_condition.notify_all();
+
+        for (std::thread &thread : m_threads)
+        {
+            thread.join();
+        }
+
+        for (awaiter *request : pending)
+        {
+            request->m_error = std::make_exception_ptr(error("Playback reader was destroyed!"));
+            resume(request->m_handle);
+        }
+    }
+
+    /** Reads the next capture of \p pb on a reader thread
+     *
+     * co_await on the result gives the next capture, or an invalid capture at the end of the recording.
+     */
+    awaiter next_capture(playback &pb) noexcept
+    {
+        return awaiter(this, &pb);
+    }
+
+private:
+    void enqueue(awaiter *request)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_pending.push_back(request);
+        }
+        m_condition.notify_one();
+    }
+
+    void run()
+    {
+        while (true)
+        {
+            awaiter *request = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(m_lock);
+                m_condition.wait(lock, [this]() { return m_stop || !m_pending.empty(); });
+                if (m_stop)
+                {
+                    return;
+                }
+                request = m_pending.front();
+                m_pending.pop_front();
+            }
+
+            try
+            {
+                if (!request->m_playback->get_next_capture(&request->m_capture))
+                {
+                    request->m_capture.reset();
+                }
+            }
+            catch (...)
+            {
+                request->m_error = std::current_exception();
+            }
+
+            resume(request->m_handle);
+        }
+    }
+
+    void resume(std::coroutine_handle<> handle)
+    {
+        if (m_resumer)
+        {
+            m_resumer(handle);
+        }
+        else
+        {
+            handle.resume();
+        }
+    }
+
+    coroutine_resumer m_resumer;
+
+    std::mutex m_lock;
+    std::condition_variable m_condition;
+    std::deque<awaiter *> m_pending;
+    bool m_stop = false;
+    std::vector<std::thread> m_threads;
+};
+
+} // namespace k4a
+
+#endif
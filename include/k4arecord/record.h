@@ -49,6 +49,21 @@ extern "C" {
  * Subsequent calls to k4a_record_write_capture() will need to have images in the resolution and format defined
  * in \p device_config.
  *
+ * \remarks
+ * The depth track holds raw depth payloads if k4a_device_start_options_t::raw_depth_payload is set in the start
+ * options of \p device when this function is called.
+ *
+ * \remarks
+ * Setting the K4A_RECORD_UNBUFFERED_IO environment variable to 1 writes the file without going through the
+ * operating system's file cache, in large aligned writes of which several are kept in flight. This keeps long
+ * recordings from evicting other memory from the cache, and absorbs short disk latency spikes. File systems that
+ * don't support unbuffered IO are written through the cache as usual.
+ *
+ * \remarks
+ * Setting the K4A_RECORDING_INDEX environment variable to 1 also writes an index sidecar of the recording's clusters
+ * when it is closed, named after the recording with the .k4aidx extension appended. k4a_playback_open() then finds the
+ * clusters without searching the recording.
+ *
  * \headerfile record.h <k4arecord/record.h>
  *
  * \returns ::K4A_RESULT_SUCCEEDED is returned on success
@@ -68,6 +83,100 @@ K4ARECORD_EXPORT k4a_result_t k4a_record_create(const char *path,
                                                 const k4a_device_configuration_t device_config,
                                                 k4a_record_t *recording_handle);
 
+/** Opens a new recording written through I/O callbacks of the application, such as a recording streamed over a
+ * network.
+ *
+ * \param callbacks
+ * The callbacks to write the recording through, see k4a_record_io_callbacks_t. They are copied, and used until the
+ * close callback is called.
+ *
+ * \param device
+ * The Azure Kinect device that is being recorded, see k4a_record_create(). May be NULL.
+ *
+ * \param device_config
+ * The configuration the Azure Kinect device was started with.
+ *
+ * \param recording_handle
+ * If successful, this contains a pointer to the new recording handle. Caller must call k4a_record_close()
+ * when finished with recording.
+ *
+ * \remarks
+ * The recording is written strictly in order, so it can be read while it is being written by a playback opened with
+ * k4a_playback_open_callbacks() and k4a_playback_io_callbacks_t::forward_only set. The segment info is written with
+ * the header, and has no duration. Nothing is written back into the header once it has been written: the recording has
+ * no Cues or seek head, and the tags aren't updated after the header, so K4A_DROPPED_SAMPLE_COUNT isn't recorded.
+ * K4A_RECORD_UNBUFFERED_IO and K4A_RECORDING_INDEX are ignored.
+ *
+ * \remarks
+ * Data is written a cluster at a time, see k4a_record_write_options_t::cluster_length_usec. The write callback is
+ * called by the writer thread of the recording, so when it can't keep up the write queue fills and new data is
+ * handled by the overflow policy of the recording, see k4a_record_set_write_options().
+ *
+ * \remarks
+ * The close callback is called once the recording is closed, or before this function returns if it fails.
+ *
+ * \headerfile record.h <k4arecord/record.h>
+ *
+ * \returns ::K4A_RESULT_SUCCEEDED is returned on success
+ *
+ * \relates k4a_record_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">record.h (include k4arecord/record.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_result_t k4a_record_create_callbacks(const k4a_record_io_callbacks_t *callbacks,
+                                                          k4a_device_t device,
+                                                          const k4a_device_configuration_t device_config,
+                                                          k4a_record_t *recording_handle);
+
+/** Opens a new recording streamed over TCP to a client.
+ *
+ * \param port
+ * The TCP port to wait for the client on.
+ *
+ * \param device
+ * The Azure Kinect device that is being recorded, see k4a_record_create(). May be NULL.
+ *
+ * \param device_config
+ * The configuration the Azure Kinect device was started with.
+ *
+ * \param recording_handle
+ * If successful, this contains a pointer to the new recording handle. Caller must call k4a_record_close()
+ * when finished with recording.
+ *
+ * \remarks
+ * Blocks until a client connects to \p port, such as k4a_playback_open_network() on another machine, then writes the
+ * recording to it the same way as k4a_record_create_callbacks(). The calibration of \p device is sent as the
+ * recording's attachment, and the IMU track and codecs are set up as for any recording before the header is written.
+ *
+ * \remarks
+ * Once the client stops reading, writes fail and the recording data is dropped or blocked by its overflow policy.
+ *
+ * \headerfile record.h <k4arecord/record.h>
+ *
+ * \returns ::K4A_RESULT_SUCCEEDED is returned once a client has connected, or ::K4A_RESULT_FAILED if the port can't
+ * be listened on.
+ *
+ * \relates k4a_record_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">record.h (include k4arecord/record.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_result_t k4a_record_create_network(uint16_t port,
+                                                        k4a_device_t device,
+                                                        const k4a_device_configuration_t device_config,
+                                                        k4a_record_t *recording_handle);
+
 /** Adds a tag to the recording.
  *
  * \param recording_handle
@@ -129,6 +238,271 @@ K4ARECORD_EXPORT k4a_result_t k4a_record_add_tag(k4a_record_t recording_handle,
  */
 K4ARECORD_EXPORT k4a_result_t k4a_record_add_imu_track(k4a_record_t recording_handle);
 
+/** Packs the IMU samples of a recording into blocks of several samples.
+ *
+ * \param recording_handle
+ * The handle of a new recording, obtained by k4a_record_create().
+ *
+ * \param pack_duration_usec
+ * The time span of the samples stored in each block, or 0 to store one sample per block, which is the default.
+ *
+ * \headerfile record.h <k4arecord/record.h>
+ *
+ * \relates k4a_record_t
+ *
+ * \returns ::K4A_RESULT_SUCCEEDED is returned on success
+ *
+ * \remarks
+ * The packing needs to be set after k4a_record_add_imu_track() and before the recording header is written. The pack
+ * duration must be shorter than the write delay of the recording.
+ *
+ * \remarks
+ * The IMU runs at about 1.6 kHz, and each sample stored on its own adds a block entry of around 10 bytes to its 40
+ * bytes of data. Packed blocks hold the samples back to back, timestamped by their first sample, and are stored when
+ * the next sample falls outside the pack duration or the recording is flushed. Versions of the SDK older than this
+ * function can't play back the IMU track of packed recordings.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">record.h (include k4arecord/record.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_result_t k4a_record_set_imu_packing(k4a_record_t recording_handle, uint32_t pack_duration_usec);
+
+/** Sets the byte order of the depth and IR tracks.
+ *
+ * \param recording_handle
+ * The handle of a new recording, obtained by k4a_record_create().
+ *
+ * \param little_endian
+ * If true, the 16-bit images are stored little-endian as they are in memory. If false, which is the default, they are
+ * byte swapped to big-endian.
+ *
+ * \headerfile record.h <k4arecord/record.h>
+ *
+ * \relates k4a_record_t
+ *
+ * \returns ::K4A_RESULT_SUCCEEDED is returned on success
+ *
+ * \remarks
+ * The byte order needs to be set before the recording header is written.
+ *
+ * \remarks
+ * Little-endian tracks are written and played back without byte swapping each pixel. Their FOURCC is "Y1[0][16]"
+ * instead of "b16g", which ffmpeg also supports, but versions of the SDK older than this function can't play them back.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">record.h (include k4arecord/record.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_result_t k4a_record_set_gray16_little_endian(k4a_record_t recording_handle, bool little_endian);
+
+/** Sets the codec of the depth and IR tracks.
+ *
+ * \param recording_handle
+ * The handle of a new recording, obtained by k4a_record_create().
+ *
+ * \param codec
+ * The codec the depth and IR images are stored with, ::K4A_RECORD_DEPTH_CODEC_RAW by default.
+ *
+ * \headerfile record.h <k4arecord/record.h>
+ *
+ * \relates k4a_record_t
+ *
+ * \returns ::K4A_RESULT_SUCCEEDED is returned on success
+ *
+ * \remarks
+ * The codec needs to be set before the recording header is written.
+ *
+ * \remarks
+ * ::K4A_RECORD_DEPTH_CODEC_RVL compresses the images losslessly, typically to a third of their size or less. The
+ * images are compressed on the recording's writer threads, and decompressed when they are played back. Such tracks
+ * can only be played back by this and later versions of the SDK, k4a_record_set_gray16_little_endian() has no effect
+ * on them.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">record.h (include k4arecord/record.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_result_t k4a_record_set_depth_codec(k4a_record_t recording_handle, k4a_record_depth_codec_t codec);
+
+/** Sets the codec of the color track.
+ *
+ * \param recording_handle
+ * The handle of a new recording, obtained by k4a_record_create().
+ *
+ * \param codec
+ * The codec the color images are stored with, ::K4A_RECORD_COLOR_CODEC_NATIVE by default.
+ *
+ * \param quality
+ * The JPEG quality of ::K4A_RECORD_COLOR_CODEC_MJPG, from 1 to 100. Ignored by ::K4A_RECORD_COLOR_CODEC_NATIVE.
+ *
+ * \headerfile record.h <k4arecord/record.h>
+ *
+ * \relates k4a_record_t
+ *
+ * \returns ::K4A_RESULT_SUCCEEDED is returned on success
+ *
+ * \remarks
+ * The codec needs to be set before the recording header is written, and the recording needs a color track.
+ *
+ * \remarks
+ * ::K4A_RECORD_COLOR_CODEC_MJPG transcodes ::K4A_IMAGE_FORMAT_COLOR_BGRA32, ::K4A_IMAGE_FORMAT_COLOR_NV12 and
+ * ::K4A_IMAGE_FORMAT_COLOR_YUY2 images to MJPG on background threads of the recording, typically storing them in a
+ * tenth of their size. The color track is then played back as ::K4A_IMAGE_FORMAT_COLOR_MJPG, which
+ * k4a_playback_set_color_conversion() can convert back to the other formats. It can't be used when the recording's
+ * color format is already ::K4A_IMAGE_FORMAT_COLOR_MJPG.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">record.h (include k4arecord/record.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_result_t k4a_record_set_color_codec(k4a_record_t recording_handle,
+                                                         k4a_record_color_codec_t codec,
+                                                         uint32_t quality);
+
+/** Sets the options of the write queue of the recording.
+ *
+ * \param recording_handle
+ * The handle of a new recording, obtained by k4a_record_create().
+ *
+ * \param options
+ * The options of the write queue, ::K4A_RECORD_WRITE_OPTIONS_INIT_DEFAULT by default.
+ *
+ * \headerfile record.h <k4arecord/record.h>
+ *
+ * \relates k4a_record_t
+ *
+ * \returns ::K4A_RESULT_SUCCEEDED is returned on success, or ::K4A_RESULT_FAILED if the options are out of range.
+ *
+ * \remarks
+ * The options need to be set before the recording header is written.
+ *
+ * \remarks
+ * With a limit on the pending bytes, the functions writing data to the recording return ::K4A_RESULT_FAILED for the
+ * data that is dropped because the write queue is full. Dropped samples are counted in the K4A_DROPPED_SAMPLE_COUNT
+ * tag of the recording, written when the recording is flushed.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">record.h (include k4arecord/record.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_result_t k4a_record_set_write_options(k4a_record_t recording_handle,
+                                                           const k4a_record_write_options_t *options);
+
+/** Splits the recording into segment files of a maximum duration or size.
+ *
+ * \param recording_handle
+ * The handle of a new recording, obtained by k4a_record_create().
+ *
+ * \param max_segment_usec
+ * The duration after which the recording moves on to a new segment file, in microseconds. 0 doesn't limit the
+ * duration of the segments.
+ *
+ * \param max_segment_bytes
+ * The file size after which the recording moves on to a new segment file, in bytes. 0 doesn't limit the size of the
+ * segments.
+ *
+ * \headerfile record.h <k4arecord/record.h>
+ *
+ * \relates k4a_record_t
+ *
+ * \returns ::K4A_RESULT_SUCCEEDED is returned on success, or ::K4A_RESULT_FAILED if the recording is written through
+ * I/O callbacks or the header has already been written.
+ *
+ * \remarks
+ * The first segment is written to the path given to k4a_record_create(). The following segments are written next to
+ * it, with the index of the segment added to the file name: "recording.mkv" is followed by "recording_0001.mkv",
+ * "recording_0002.mkv" and so on. A recording moves on to a new segment at the first cluster past either limit, so
+ * segments are about a cluster longer or larger than the limits.
+ *
+ * \remarks
+ * Each segment is a complete recording with the tracks, attachments and tags of the recording, and its own Cues. The
+ * segments share the timeline of the first segment: a segment starts at the timestamp the previous segment ended, and
+ * the device timestamps of the data are unchanged. The index of a segment is stored in its K4A_SEGMENT_INDEX tag. Use
+ * k4a_playback_segments_open() to play the segments back as one recording.
+ *
+ * \remarks
+ * The segment limits need to be set before the recording header is written.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">record.h (include k4arecord/record.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_result_t k4a_record_set_segment_limits(k4a_record_t recording_handle,
+                                                            uint64_t max_segment_usec,
+                                                            uint64_t max_segment_bytes);
+
+/** Lays the recording out on disk in large extents, and reserves space for the Cues at the front of the file.
+ *
+ * \param recording_handle
+ * The handle of a new recording, obtained by k4a_record_create().
+ *
+ * \param preallocation_bytes
+ * The size of the extents disk space is reserved in as the recording grows, in bytes. 0 doesn't reserve disk space.
+ *
+ * \param cues_reserve_bytes
+ * The space reserved for the Cues of the recording after its header, in bytes. 0 writes the Cues after the clusters.
+ *
+ * \headerfile record.h <k4arecord/record.h>
+ *
+ * \relates k4a_record_t
+ *
+ * \returns ::K4A_RESULT_SUCCEEDED is returned on success, or ::K4A_RESULT_FAILED if the recording is written through
+ * I/O callbacks or the header has already been written.
+ *
+ * \remarks
+ * The recording reserves the disk space of the file one to two extents past its end as clusters are written, so the
+ * file system can allocate the file in large contiguous extents even while other files are being written, and later
+ * playback reads it sequentially. The space is reserved without changing the size of the file (fallocate() with
+ * FALLOC_FL_KEEP_SIZE on Linux, the allocation size of the file on Windows), and what isn't used is released when the
+ * recording is closed. If the file system can't reserve disk space, a warning is logged and the recording is written
+ * without it.
+ *
+ * \remarks
+ * The Cues are written into the reserved space for as long as they fit, so k4a_record_flush() and
+ * k4a_record_close() only update the front of the file, and players reading the file in order find the Cues before the
+ * clusters. A Cue entry is written about every second and takes about 30 bytes, so 128KB holds the Cues of more than an
+ * hour of recording. Once the Cues no longer fit, they are written after the clusters.
+ *
+ * \remarks
+ * The options need to be set before the recording header is written.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">record.h (include k4arecord/record.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_result_t k4a_record_set_preallocation(k4a_record_t recording_handle,
+                                                           uint64_t preallocation_bytes,
+                                                           uint32_t cues_reserve_bytes);
+
 /** Adds an attachment to the recording.
  *
  * \param recording_handle
@@ -326,6 +700,10 @@ K4ARECORD_EXPORT k4a_result_t k4a_record_write_header(k4a_record_t recording_han
  * k4a_record_write_capture() will write all images in the capture to the corresponding tracks in the recording file.
  * If any of the images fail to write, other images will still be written before a failure is returned.
  *
+ * \remarks
+ * The images are not copied, the recording holds a reference on them until they have been written to disk. Their
+ * buffers must not be modified after this call, the capture and the images may still be released right away.
+ *
  * \xmlonly
  * <requirements>
  *   <requirement name="Header">record.h (include k4arecord/record.h)</requirement>
@@ -410,6 +788,58 @@ K4ARECORD_EXPORT k4a_result_t k4a_record_write_custom_track_data(const k4a_recor
                                                                  uint8_t *custom_data,
                                                                  size_t custom_data_size);
 
+/** Writes several blocks of data for a custom track to file.
+ *
+ * \param recording_handle
+ * The handle of a new recording, obtained by k4a_record_create().
+ *
+ * \param track_name
+ * The name of the custom track that the data is going to be written to.
+ *
+ * \param blocks
+ * The blocks of custom track data, in increasing order of timestamp.
+ *
+ * \param block_count
+ * The number of blocks in \p blocks.
+ *
+ * \param buffer_release_cb
+ * If NULL, the buffers of the blocks are copied and stay owned by the caller. Otherwise the recording takes ownership
+ * of the buffers without copying them, and calls \p buffer_release_cb once for each of them when it no longer needs it.
+ *
+ * \param buffer_release_cb_context
+ * The context passed to \p buffer_release_cb.
+ *
+ * \headerfile record.h <k4arecord/record.h>
+ *
+ * \relates k4a_record_t
+ *
+ * \returns ::K4A_RESULT_SUCCEEDED if every block was queued for writing, or ::K4A_RESULT_FAILED if an error occurred.
+ *
+ * \remarks
+ * The blocks are written like k4a_record_write_custom_track_data() would write them one by one, but the write queue is
+ * locked once for all of them. If a block can't be written, the blocks before it are still written and the ones after
+ * it are not.
+ *
+ * \remarks
+ * When \p buffer_release_cb is set, it is called for the buffer of every block whatever the result, including the
+ * blocks that weren't written. It may be called before this function returns, or later from the writer thread of the
+ * recording, and must not call back into the recording.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">record.h (include k4arecord/record.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_result_t k4a_record_write_custom_track_blocks(const k4a_record_t recording_handle,
+                                                                   const char *track_name,
+                                                                   const k4a_record_custom_track_block_t *blocks,
+                                                                   size_t block_count,
+                                                                   k4a_memory_destroy_cb_t *buffer_release_cb,
+                                                                   void *buffer_release_cb_context);
+
 /** Flushes all pending recording data to disk.
  *
  * \param recording_handle
@@ -440,6 +870,36 @@ K4ARECORD_EXPORT k4a_result_t k4a_record_write_custom_track_data(const k4a_recor
  */
 K4ARECORD_EXPORT k4a_result_t k4a_record_flush(k4a_record_t recording_handle);
 
+/** Gets the state of the write queue of a recording.
+ *
+ * \param recording_handle
+ * Handle obtained by k4a_record_create().
+ *
+ * \param status
+ * Location to write the state of the write queue.
+ *
+ * \headerfile record.h <k4arecord/record.h>
+ *
+ * \relates k4a_record_t
+ *
+ * \returns ::K4A_RESULT_SUCCEEDED is returned on success
+ *
+ * \remarks
+ * Recordings write data on a background thread, so the functions writing captures return before the data is on disk.
+ * This function can be called from any thread to monitor how far behind the disk is, for example to lower the
+ * recorded frame rate before the write queue uses too much memory.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">record.h (include k4arecord/record.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_result_t k4a_record_get_write_queue_status(k4a_record_t recording_handle,
+                                                                k4a_record_write_queue_status_t *status);
+
 /** Closes a recording handle.
  *
  * \param recording_handle
@@ -462,6 +922,87 @@ K4ARECORD_EXPORT k4a_result_t k4a_record_flush(k4a_record_t recording_handle);
  */
 K4ARECORD_EXPORT void k4a_record_close(k4a_record_t recording_handle);
 
+/** Creates a group of recordings sharing their writer threads.
+ *
+ * \param writer_thread_count
+ * Number of threads writing the recordings of the group to disk, from 1 to 64.
+ *
+ * \param group_handle
+ * If successful, this contains a pointer to the group handle. Caller must call k4a_record_group_destroy() when
+ * finished with the group.
+ *
+ * \headerfile record.h <k4arecord/record.h>
+ *
+ * \relates k4a_record_group_t
+ *
+ * \returns ::K4A_RESULT_SUCCEEDED is returned on success
+ *
+ * \remarks
+ * Each recording is written by a writer thread of its own, a group of recordings made at the same time, such as the
+ * recordings of several synchronized devices, can share fewer threads instead. The threads write one cluster of a
+ * recording at a time, taking the recordings of the group in turn.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">record.h (include k4arecord/record.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_result_t k4a_record_group_create(uint32_t writer_thread_count, k4a_record_group_t *group_handle);
+
+/** Adds a recording to a group of recordings sharing their writer threads.
+ *
+ * \param group_handle
+ * Handle obtained by k4a_record_group_create().
+ *
+ * \param recording_handle
+ * The handle of a new recording, obtained by k4a_record_create().
+ *
+ * \headerfile record.h <k4arecord/record.h>
+ *
+ * \relates k4a_record_group_t
+ *
+ * \returns ::K4A_RESULT_SUCCEEDED is returned on success
+ *
+ * \remarks
+ * Recordings need to be added before their header is written, and can only be in one group.
+ *
+ * \remarks
+ * The recordings of a group keep its writer threads running until they are closed, the group handle can be destroyed
+ * before them.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">record.h (include k4arecord/record.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_result_t k4a_record_group_add_recording(k4a_record_group_t group_handle,
+                                                             k4a_record_t recording_handle);
+
+/** Destroys a recording group handle.
+ *
+ * \param group_handle
+ * Handle obtained by k4a_record_group_create().
+ *
+ * \headerfile record.h <k4arecord/record.h>
+ *
+ * \relates k4a_record_group_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">record.h (include k4arecord/record.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT void k4a_record_group_destroy(k4a_record_group_t group_handle);
+
 /**
  * @}
  */
@@ -74,6 +74,15 @@ public:
         return m_handle != nullptr;
     }
 
+    /** Returns the underlying k4a_record_t handle
+     *
+     * Note that this handle is owned by the k4a::record and should not be closed
+     */
+    k4a_record_t handle() const noexcept
+    {
+        return m_handle;
+    }
+
     /** Closes a K4A recording.
      *
      * \sa k4a_record_close
@@ -104,6 +113,23 @@ public:
         }
     }
 
+    /** Gets the state of the write queue of the recording
+     * Throws error on failure
+     *
+     * \sa k4a_record_get_write_queue_status
+     */
+    k4a_record_write_queue_status_t get_write_queue_status() const
+    {
+        k4a_record_write_queue_status_t status;
+        k4a_result_t result = k4a_record_get_write_queue_status(m_handle, &status);
+
+        if (K4A_FAILED(result))
+        {
+            throw error("Failed to get write queue status!");
+        }
+        return status;
+    }
+
     /** Adds a tag to the recording
      * Throws error on failure
      *
@@ -134,6 +160,112 @@ public:
         }
     }
 
+    /** Packs the IMU samples into blocks of several samples
+     *
+     * \sa k4a_record_set_imu_packing
+     */
+    void set_imu_packing(std::chrono::microseconds pack_duration)
+    {
+        k4a_result_t result = k4a_record_set_imu_packing(m_handle, static_cast<uint32_t>(pack_duration.count()));
+
+        if (K4A_FAILED(result))
+        {
+            throw error("Failed to set imu packing!");
+        }
+    }
+
+    /** Sets the byte order of the depth and IR tracks
+     * Throws error on failure
+     *
+     * \sa k4a_record_set_gray16_little_endian
+     */
+    void set_gray16_little_endian(bool little_endian)
+    {
+        k4a_result_t result = k4a_record_set_gray16_little_endian(m_handle, little_endian);
+
+        if (K4A_FAILED(result))
+        {
+            throw error("Failed to set gray16 byte order!");
+        }
+    }
+
+    /** Sets the codec of the depth and IR tracks
+     * Throws error on failure
+     *
+     * \sa k4a_record_set_depth_codec
+     */
+    void set_depth_codec(k4a_record_depth_codec_t codec)
+    {
+        k4a_result_t result = k4a_record_set_depth_codec(m_handle, codec);
+
+        if (K4A_FAILED(result))
+        {
+            throw error("Failed to set depth codec!");
+        }
+    }
+
+    /** Sets the codec of the color track
+     * Throws error on failure
+     *
+     * \sa k4a_record_set_color_codec
+     */
+    void set_color_codec(k4a_record_color_codec_t codec, uint32_t quality)
+    {
+        k4a_result_t result = k4a_record_set_color_codec(m_handle, codec, quality);
+
+        if (K4A_FAILED(result))
+        {
+            throw error("Failed to set color codec!");
+        }
+    }
+
+    /** Sets the options of the write queue of the recording
+     * Throws error on failure
+     *
+     * \sa k4a_record_set_write_options
+     */
+    void set_write_options(const k4a_record_write_options_t &options)
+    {
+        k4a_result_t result = k4a_record_set_write_options(m_handle, &options);
+
+        if (K4A_FAILED(result))
+        {
+            throw error("Failed to set write options!");
+        }
+    }
+
+    /** Splits the recording into segment files of a maximum duration or size, 0 doesn't limit either
+     * Throws error on failure
+     *
+     * \sa k4a_record_set_segment_limits
+     */
+    void set_segment_limits(std::chrono::microseconds max_segment_length, uint64_t max_segment_bytes)
+    {
+        k4a_result_t result = k4a_record_set_segment_limits(m_handle,
+                                                            static_cast<uint64_t>(max_segment_length.count()),
+                                                            max_segment_bytes);
+
+        if (K4A_FAILED(result))
+        {
+            throw error("Failed to set segment limits!");
+        }
+    }
+
+    /** Reserves disk space for the recording in large extents, and space for its Cues at the front of the file
+     * Throws error on failure
+     *
+     * \sa k4a_record_set_preallocation
+     */
+    void set_preallocation(uint64_t preallocation_bytes, uint32_t cues_reserve_bytes)
+    {
+        k4a_result_t result = k4a_record_set_preallocation(m_handle, preallocation_bytes, cues_reserve_bytes);
+
+        if (K4A_FAILED(result))
+        {
+            throw error("Failed to set preallocation!");
+        }
+    }
+
     /** Adds an attachment to the recording
      * Throws error on failure
      *
@@ -265,6 +397,30 @@ public:
         }
     }
 
+    /** Writes several blocks of data for a custom track to file
+     * Throws error on failure
+     *
+     * \sa k4a_record_write_custom_track_blocks
+     */
+    void write_custom_track_blocks(const char *track_name,
+                                   const k4a_record_custom_track_block_t *blocks,
+                                   size_t block_count,
+                                   k4a_memory_destroy_cb_t *buffer_release_cb = nullptr,
+                                   void *buffer_release_cb_context = nullptr)
+    {
+        k4a_result_t result = k4a_record_write_custom_track_blocks(m_handle,
+                                                                   track_name,
+                                                                   blocks,
+                                                                   block_count,
+                                                                   buffer_release_cb,
+                                                                   buffer_release_cb_context);
+
+        if (K4A_FAILED(result))
+        {
+            throw error("Failed to write custom track blocks!");
+        }
+    }
+
     /** Opens a new recording file for writing
      * Throws error on failure
      *
@@ -283,10 +439,153 @@ public:
         return record(handle);
     }
 
+    /** Opens a new recording written through I/O callbacks
+     * Throws error on failure
+     *
+     * \sa k4a_record_create_callbacks
+     */
+    static record create_callbacks(const k4a_record_io_callbacks_t &callbacks,
+                                   const device &device,
+                                   const k4a_device_configuration_t &device_configuration)
+    {
+        k4a_record_t handle = nullptr;
+        k4a_result_t result = k4a_record_create_callbacks(&callbacks, device.handle(), device_configuration, &handle);
+
+        if (K4A_FAILED(result))
+        {
+            throw error("Failed to create recorder!");
+        }
+
+        return record(handle);
+    }
+
+    /** Waits for a client on \p port and opens a new recording streamed to it
+     * Throws error on failure
+     *
+     * \sa k4a_record_create_network
+     */
+    static record
+    create_network(uint16_t port, const device &device, const k4a_device_configuration_t &device_configuration)
+    {
+        k4a_record_t handle = nullptr;
+        k4a_result_t result = k4a_record_create_network(port, device.handle(), device_configuration, &handle);
+
+        if (K4A_FAILED(result))
+        {
+            throw error("Failed to create recorder!");
+        }
+
+        return record(handle);
+    }
+
 private:
     k4a_record_t m_handle;
 };
 
+/** \class record_group record.hpp
+ * Wrapper for \ref k4a_record_group_t
+ *
+ * Wraps a handle for a group of recordings sharing their writer threads
+ *
+ * \sa k4a_record_group_t
+ */
+class record_group
+{
+public:
+    /** Creates a k4a::record_group from a k4a_record_group_t
+     * Takes ownership of the handle, i.e. you should not call
+     * k4a_record_group_destroy on the handle after giving it to the
+     * k4a::record_group; the k4a::record_group will take care of that.
+     */
+    record_group(k4a_record_group_t handle = nullptr) noexcept : m_handle(handle) {}
+
+    /** Moves another k4a::record_group into a new k4a::record_group
+     */
+    record_group(record_group &&other) noexcept : m_handle(other.m_handle)
+    {
+        other.m_handle = nullptr;
+    }
+
+    record_group(const record_group &) = delete;
+
+    ~record_group()
+    {
+        destroy();
+    }
+
+    record_group &operator=(const record_group &) = delete;
+
+    /** Moves another k4a::record_group into this k4a::record_group; other is set to invalid
+     */
+    record_group &operator=(record_group &&other) noexcept
+    {
+        if (this != &other)
+        {
+            destroy();
+            m_handle = other.m_handle;
+            other.m_handle = nullptr;
+        }
+
+        return *this;
+    }
+
+    /** Returns true if the k4a::record_group is valid, false otherwise
+     */
+    explicit operator bool() const noexcept
+    {
+        return m_handle != nullptr;
+    }
+
+    /** Destroys the group, its recordings keep the writer threads until they are closed
+     *
+     * \sa k4a_record_group_destroy
+     */
+    void destroy() noexcept
+    {
+        if (m_handle != nullptr)
+        {
+            k4a_record_group_destroy(m_handle);
+            m_handle = nullptr;
+        }
+    }
+
+    /** Adds a recording to the group
+     * Throws error on failure
+     *
+     * \sa k4a_record_group_add_recording
+     */
+    void add_recording(const record &recording)
+    {
+        k4a_result_t result = k4a_record_group_add_recording(m_handle, recording.handle());
+
+        if (K4A_FAILED(result))
+        {
+            throw error("Failed to add recording to group!");
+        }
+    }
+
+    /** Creates a group of recordings sharing writer_thread_count writer threads
+     * Throws error on failure
+     *
+     * \sa k4a_record_group_create
+     */
+    static record_group create(uint32_t writer_thread_count)
+    {
+        k4a_record_group_t handle = nullptr;
+        k4a_result_t result = k4a_record_group_create(writer_thread_count, &handle);
+
+        if (K4A_FAILED(result))
+        {
+            throw error("Failed to create recording group!");
+        }
+
+        return record_group(handle);
+    }
+
+private:
+    k4a_record_group_t m_handle;
+};
+
 } // namespace k4a
 
 #endif
@@ -33,6 +33,21 @@ extern "C" {
  */
 K4A_DECLARE_HANDLE(k4a_record_t);
 
+/** \class k4a_record_group_t types.h <k4arecord/types.h>
+ * Handle to a group of k4a recordings sharing their writer threads.
+ *
+ * \remarks
+ * Handles are created with k4a_record_group_create(), and destroyed with k4a_record_group_destroy().
+ * Invalid handles are set to 0.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">types.h (include k4arecord/types.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_DECLARE_HANDLE(k4a_record_group_t);
+
 /** \class k4a_playback_t types.h <k4arecord/types.h>
  * Handle to a k4a recording opened for playback.
  *
@@ -48,6 +63,37 @@ K4A_DECLARE_HANDLE(k4a_record_t);
  */
 K4A_DECLARE_HANDLE(k4a_playback_t);
 
+/** \class k4a_playback_segments_t types.h <k4arecord/types.h>
+ * Handle to the segment files of a recording split by k4a_record_set_segment_limits(), opened for playback as one
+ * recording.
+ *
+ * \remarks
+ * Handles are created with k4a_playback_segments_open(), and closed with k4a_playback_segments_close().
+ * Invalid handles are set to 0.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">types.h (include k4arecord/types.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_DECLARE_HANDLE(k4a_playback_segments_t);
+
+/** \class k4a_playback_group_t types.h <k4arecord/types.h>
+ * Handle to the recordings of a group of synchronized devices, opened for playback together.
+ *
+ * \remarks
+ * Handles are created with k4a_playback_group_open(), and closed with k4a_playback_group_close().
+ * Invalid handles are set to 0.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">types.h (include k4arecord/types.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_DECLARE_HANDLE(k4a_playback_group_t);
+
 /** \class k4a_playback_data_block_t types.h <k4arecord/types.h>
  * Handle to a block of data read from a k4a_playback_t custom track.
  *
@@ -147,6 +193,64 @@ typedef enum
     K4A_PLAYBACK_SEEK_DEVICE_TIME /**< Seek to an absolute device timestamp. */
 } k4a_playback_seek_origin_t;
 
+/** Flags of k4a_playback_open_ex().
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">types.h (include k4arecord/types.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef enum
+{
+    K4A_PLAYBACK_OPEN_DEFAULT = 0,          /**< Open the recording the same way as k4a_playback_open(). */
+    K4A_PLAYBACK_OPEN_HEADER_ONLY = 1 << 0, /**< Only read the header, the clusters are indexed on first use. */
+} k4a_playback_open_flags_t;
+
+/** Codecs of the depth and IR tracks of a recording.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">types.h (include k4arecord/types.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef enum
+{
+    K4A_RECORD_DEPTH_CODEC_RAW = 0, /**< Uncompressed 16-bit grayscale, the default. */
+    K4A_RECORD_DEPTH_CODEC_RVL,     /**< Lossless RVL compression, only supported by the Azure Kinect SDK. */
+} k4a_record_depth_codec_t;
+
+/** Codecs of the color track of a recording.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">types.h (include k4arecord/types.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef enum
+{
+    K4A_RECORD_COLOR_CODEC_NATIVE = 0, /**< The color format of the device configuration, the default. */
+    K4A_RECORD_COLOR_CODEC_MJPG,       /**< Uncompressed color transcoded to MJPG while recording. */
+} k4a_record_color_codec_t;
+
+/** Behavior of a recording when its write queue reaches k4a_record_write_options_t::max_pending_bytes.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">types.h (include k4arecord/types.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef enum
+{
+    K4A_RECORD_OVERFLOW_BLOCK = 0,    /**< Wait for room in the queue up to the block timeout, then drop the data. */
+    K4A_RECORD_OVERFLOW_DROP,         /**< Drop the data immediately. */
+    K4A_RECORD_OVERFLOW_DROP_CAPTURE, /**< Drop whole captures, never only some of their images. */
+    K4A_RECORD_OVERFLOW_DROP_COLOR,   /**< Drop color images first, queued ones make room for the other data. */
+} k4a_record_overflow_policy_t;
+
 /**
  * @}
  *
@@ -250,6 +354,195 @@ typedef struct _k4a_record_subtitle_settings_t
     bool high_freq_data;
 } k4a_record_subtitle_settings_t;
 
+/** Structure containing the state of the write queue of a recording.
+ *
+ * \see k4a_record_get_write_queue_status()
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">types.h (include k4arecord/types.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef struct _k4a_record_write_queue_status_t
+{
+    /** Time between the end of the data already written and the newest data passed to the recording, in
+     * microseconds. Data is held for the write delay before it is written, 2 seconds by default, a value that keeps
+     * growing past that means the disk can't keep up with the recording. */
+    uint64_t queued_usec;
+
+    /** Number of clusters of data waiting in memory to be written. */
+    uint32_t queued_cluster_count;
+
+    /** Number of large writes in flight to the disk when the recording is written with unbuffered IO, see
+     * k4a_record_create(). Always 0 with buffered IO. */
+    uint32_t writes_in_flight;
+
+    /** Size of the data waiting in memory to be written, in bytes. */
+    uint64_t queued_bytes;
+
+    /** Number of images, IMU samples, and custom track blocks dropped because the write queue was full, see
+     * k4a_record_write_options_t::max_pending_bytes. */
+    uint64_t dropped_sample_count;
+} k4a_record_write_queue_status_t;
+
+/** Structure containing the options of the write queue of a recording.
+ *
+ * \see k4a_record_set_write_options()
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">types.h (include k4arecord/types.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef struct _k4a_record_write_options_t
+{
+    /** Length of the Matroska clusters the data is grouped in, in microseconds, from 1000 to 32000. Longer clusters
+     * mean fewer index entries and larger writes. */
+    uint32_t cluster_length_usec;
+
+    /** How long data is held in memory before it is written, in microseconds. It must be at least 2 cluster lengths.
+     * Data passed to the recording later than this after newer data can no longer be written. Shorter delays hold
+     * less memory and lose less data if the process crashes. */
+    uint32_t write_delay_usec;
+
+    /** Limit on the bytes held in the write queue, 0 for no limit. When the limit is reached, the oldest data is
+     * written without waiting for the write delay, and new data is handled by the overflow policy. */
+    uint64_t max_pending_bytes;
+
+    /** What happens to new data while the write queue is at max_pending_bytes. */
+    k4a_record_overflow_policy_t overflow_policy;
+
+    /** How long ::K4A_RECORD_OVERFLOW_BLOCK waits for room in the write queue, in microseconds, 0 for the write
+     * delay. */
+    uint32_t block_timeout_usec;
+} k4a_record_write_options_t;
+
+/** Default write options of recordings.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">types.h (include k4arecord/types.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+static const k4a_record_write_options_t K4A_RECORD_WRITE_OPTIONS_INIT_DEFAULT = { 32000,
+                                                                                  2000000,
+                                                                                  0,
+                                                                                  K4A_RECORD_OVERFLOW_BLOCK,
+                                                                                  0 };
+
+/** Structure containing the counters of the cluster cache of a playback.
+ *
+ * \see k4a_playback_get_cluster_cache_stats()
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">types.h (include k4arecord/types.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef struct _k4a_playback_cluster_cache_stats_t
+{
+    /** Number of times playback reached a cluster that was already in memory, either kept by the cache or preloaded by
+     * read-ahead. */
+    uint64_t hit_count;
+
+    /** Number of times playback reached a cluster that had to be read from the file first. */
+    uint64_t miss_count;
+
+    /** Number of clusters read from the file, including the ones preloaded by read-ahead. */
+    uint64_t load_count;
+
+    /** Number of clusters dropped from the cache, to stay within its size or because the track filter changed. */
+    uint64_t evict_count;
+
+    /** Size of the clusters held by the cache, in bytes. */
+    uint64_t cached_bytes;
+} k4a_playback_cluster_cache_stats_t;
+
+/** Structure containing the callbacks a playback reads a recording through, for recordings that aren't local files.
+ *
+ * \see k4a_playback_open_callbacks()
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">types.h (include k4arecord/types.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef struct _k4a_playback_io_callbacks_t
+{
+    /** Passed back to each of the callbacks. */
+    void *context;
+
+    /** Reads up to size bytes of the recording at offset into buffer. Returns the number of bytes read, which may be
+     * fewer than size, 0 at the end of the recording, or -1 on error. Unless forward_only is set, it may be called from
+     * several threads at once. */
+    int64_t (*read)(void *context, uint64_t offset, void *buffer, size_t size);
+
+    /** Returns the size of the recording in bytes, or 0 if it isn't known. May be NULL. */
+    uint64_t (*get_size)(void *context);
+
+    /** Hints that the size bytes of the recording at offset are about to be read, so they can be fetched with a single
+     * request, such as an HTTP range read. May be NULL. Not called if forward_only is set. */
+    void (*read_hint)(void *context, uint64_t offset, uint64_t size);
+
+    /** Called once the playback no longer reads the recording, no callback is called after it. May be NULL. */
+    void (*close)(void *context);
+
+    /** True if the recording can only be read in order, such as from a pipe or a socket. read is then always called
+     * with the offset following the previous read. */
+    bool forward_only;
+} k4a_playback_io_callbacks_t;
+
+/** Structure containing the callbacks a recording is written through, for recordings that are streamed instead of
+ * written to a local file.
+ *
+ * \see k4a_record_create_callbacks()
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">types.h (include k4arecord/types.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef struct _k4a_record_io_callbacks_t
+{
+    /** Passed back to each of the callbacks. */
+    void *context;
+
+    /** Writes the size bytes of the recording in buffer, following the bytes of the previous write. Returns the number
+     * of bytes written, which must be size, or -1 on error. Called from the writer thread of the recording, so a write
+     * that blocks holds back the write queue, see k4a_record_write_options_t. */
+    int64_t (*write)(void *context, const void *buffer, size_t size);
+
+    /** Called once the recording no longer writes through the callbacks, no callback is called after it. May be
+     * NULL. */
+    void (*close)(void *context);
+} k4a_record_io_callbacks_t;
+
+/** Structure containing a block of custom track data, see k4a_record_write_custom_track_blocks().
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">types.h (include k4arecord/types.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef struct _k4a_record_custom_track_block_t
+{
+    /** The timestamp of the block in microseconds, in the same time domain as the device timestamps. */
+    uint64_t device_timestamp_usec;
+
+    /** The data of the block. */
+    uint8_t *buffer;
+
+    /** The size of buffer in bytes. */
+    size_t buffer_size;
+} k4a_record_custom_track_block_t;
+
 /**
  * @}
  */
@@ -5,10 +5,13 @@
 #include <k4ainternal/allocator.h>
 
 // Dependent libraries
+#include <k4ainternal/atomic.h>
 #include <k4ainternal/capture.h>
 #include <k4ainternal/global.h>
 #include <k4ainternal/rwlock.h>
 #include <azure_c_shared_utility/refcount.h>
+#include <azure_c_shared_utility/threadapi.h>
+#include <azure_c_shared_utility/tickcounter.h>
 
 // System dependencies
 #include <stdlib.h>
@@ -22,37 +25,67 @@ typedef enum
     IMAGE_TYPE_COLOR = 0,
     IMAGE_TYPE_DEPTH,
     IMAGE_TYPE_IR,
+    IMAGE_TYPE_IMU_SAMPLES,
     IMAGE_TYPE_COUNT,
 } image_type_index_t;
 
+#define ALLOCATOR_RATE_WINDOW_MS 1000  // Minimum window the allocation rate is measured over
+#define ALLOCATOR_MAX_INSTALLED 16     // Allocator entries, entries that are no longer current are reused
+#define ALLOCATOR_PREFAULT_STRIDE 4096 // Smallest page size of the supported platforms
+
+// Live memory statistics of one allocation source
+typedef struct _allocator_source_stats_t
+{
+    // Updated with atomics on every allocation and free
+    volatile uint32_t buffer_count;
+    volatile uint64_t allocated_bytes;
+    volatile uint64_t peak_allocated_bytes;
+    volatile uint64_t total_allocation_count;
+
+    // Allocation rate, measured between calls to allocator_get_stats() at least ALLOCATOR_RATE_WINDOW_MS apart. Access
+    // may only occur while holding stats_lock.
+    uint64_t rate_window_allocation_count;
+    tickcounter_ms_t rate_window_start_ms;
+    float allocations_per_second;
+} allocator_source_stats_t;
+
+// An allocate and free function pair
+typedef struct _allocator_callbacks_t
+{
+    k4a_memory_allocate_cb_t *alloc;
+    k4a_memory_destroy_cb_t *free;
+    volatile uint32_t readers; // Calls to allocator_read_current() that may be reading the pair
+} allocator_callbacks_t;
+
 // Global properties of the allocator
 typedef struct
 {
+    // Serializes allocator_set_allocator()
     k4a_rwlock_t lock;
 
-    // Access to these function pointers may only occur
-    // while holding lock
-    k4a_memory_allocate_cb_t *alloc;
-    k4a_memory_destroy_cb_t *free;
+    // Allocators installed so far, entry 0 is the default allocator. Entries are written while holding lock, and only
+    // once they are not current and have no readers, so allocator_alloc() reads the current entry without the lock.
+    allocator_callbacks_t installed[ALLOCATOR_MAX_INSTALLED];
+    uint32_t installed_count;
+    volatile uint32_t current;
+
+    // Serializes the allocation rate window in allocator_get_stats()
+    k4a_rwlock_t stats_lock;
+    allocator_source_stats_t stats[K4A_ALLOCATION_SOURCE_COUNT];
+    TICK_COUNTER_HANDLE tick;
 } allocator_global_t;
 
-// This allocator implementation is used by default
+// This allocator implementation is used by default. It is malloc unless pooling was enabled with
+// allocator_set_default_pool_size(). Large color and depth buffers may be mapped with huge pages instead.
 static uint8_t *default_alloc(int size, void **context)
 {
-    *context = NULL;
-    if (size < 0)
-    {
-        return NULL;
-    }
-    return (uint8_t *)malloc((size_t)size);
+    return allocator_size_class_alloc(size, context);
 }
 
 // This is the free function for the default allocator
 static void default_free(void *buffer, void *context)
 {
-    (void)context;
-    assert(context == NULL);
-    free(buffer);
+    allocator_size_class_free(buffer, context);
 }
 
 // This is a one time initialization of the global state for the allocator
@@ -60,11 +93,18 @@ static void allocator_global_init(allocator_global_t *g_allocator)
 {
     rwlock_init(&g_allocator->lock);
 
-    g_allocator->alloc = default_alloc;
-    g_allocator->free = default_free;
+    memset(g_allocator->installed, 0, sizeof(g_allocator->installed));
+    g_allocator->installed[0].alloc = default_alloc;
+    g_allocator->installed[0].free = default_free;
+    g_allocator->installed_count = 1;
+    g_allocator->current = 0;
+
+    rwlock_init(&g_allocator->stats_lock);
+    memset(g_allocator->stats, 0, sizeof(g_allocator->stats));
+    g_allocator->tick = tickcounter_create();
 }
 
-// The allocation context is pre-pended to memory returned by the allocator
+// The allocation context is pre-pended to memory returned by the allocator, immediately before the aligned buffer
 // This state is used to track the freeing of the allocation
 typedef struct _allocation_context_t
 {
@@ -73,17 +113,49 @@ typedef struct _allocation_context_t
         struct _context
         {
             allocation_source_t source;
+            uint32_t offset; // Bytes from the start of the allocation to the buffer returned to the caller
             k4a_memory_destroy_cb_t *free;
             void *free_context;
+            size_t size; // Size requested by the caller of allocator_alloc
         } context;
 
-        // Keep 16 byte alignment so that allocations may be used with SSE
+        // Keep the header size a multiple of 16 bytes
         char alignment[32];
     } u;
 } allocation_context_t;
 
 K4A_DECLARE_GLOBAL(allocator_global_t, allocator_global_init);
 
+static void allocator_stats_add(allocator_global_t *g_allocator, allocation_source_t source, size_t size)
+{
+    allocator_source_stats_t *stats = &g_allocator->stats[source];
+
+    k4a_atomic_add(&stats->buffer_count, 1);
+    k4a_atomic_add64(&stats->total_allocation_count, 1);
+
+    // The peak needs the value allocated_bytes was raised to, not just the sum
+    uint64_t allocated;
+    do
+    {
+        allocated = k4a_atomic_load64(&stats->allocated_bytes);
+    } while (!k4a_atomic_cas64(&stats->allocated_bytes, allocated, allocated + size));
+    allocated += size;
+
+    uint64_t peak = k4a_atomic_load64(&stats->peak_allocated_bytes);
+    while (allocated > peak && !k4a_atomic_cas64(&stats->peak_allocated_bytes, peak, allocated))
+    {
+        peak = k4a_atomic_load64(&stats->peak_allocated_bytes);
+    }
+}
+
+static void allocator_stats_remove(allocator_global_t *g_allocator, allocation_source_t source, size_t size)
+{
+    allocator_source_stats_t *stats = &g_allocator->stats[source];
+
+    k4a_atomic_add(&stats->buffer_count, -1);
+    k4a_atomic_add64(&stats->allocated_bytes, 0 - (uint64_t)size);
+}
+
 //
 // Simple counts of memory allocations for the purpose of detecting leaks of the K4A SDK's larger memory objects.
 //
@@ -117,6 +189,66 @@ typedef struct _capture_context_t
 
 K4A_DECLARE_CONTEXT(k4a_capture_t, capture_context_t);
 
+// Released capture handles are kept here for reuse so that steady state streaming does not allocate them. Each slot is
+// claimed with a single atomic exchange, so unlike a linked free list there is no ABA hazard on the pop path.
+#define CAPTURE_POOL_SIZE 32
+typedef PUB_HANDLE_TYPE(k4a_capture_t) capture_wrapper_t;
+static capture_wrapper_t *volatile g_capture_pool[CAPTURE_POOL_SIZE];
+
+static capture_context_t *capture_pool_acquire(k4a_capture_t *capture_handle)
+{
+    for (int i = 0; i < CAPTURE_POOL_SIZE; i++)
+    {
+        if (k4a_atomic_load_ptr(&g_capture_pool[i]) == NULL)
+        {
+            continue;
+        }
+
+        capture_wrapper_t *wrapper = (capture_wrapper_t *)k4a_atomic_exchange_ptr(&g_capture_pool[i], NULL);
+        if (wrapper != NULL)
+        {
+            memset(&wrapper->context, 0, sizeof(wrapper->context));
+            wrapper->handleType = PRIV_HANDLE_TYPE(k4a_capture_t);
+            *capture_handle = (k4a_capture_t)wrapper;
+            return &wrapper->context;
+        }
+    }
+    return NULL;
+}
+
+// Returns false if the pool is full and the caller must destroy the handle
+static bool capture_pool_release(k4a_capture_t capture_handle)
+{
+    capture_wrapper_t *wrapper = (capture_wrapper_t *)capture_handle;
+
+    // Stale copies of the handle must fail validation while it sits in the pool
+    wrapper->handleType = NULL;
+    for (int i = 0; i < CAPTURE_POOL_SIZE; i++)
+    {
+        capture_wrapper_t *expected = NULL;
+        if (k4a_atomic_load_ptr(&g_capture_pool[i]) == NULL &&
+            k4a_atomic_cas_ptr(&g_capture_pool[i], expected, wrapper))
+        {
+            return true;
+        }
+    }
+
+    wrapper->handleType = PRIV_HANDLE_TYPE(k4a_capture_t);
+    return false;
+}
+
+static void capture_pool_drain(void)
+{
+    for (int i = 0; i < CAPTURE_POOL_SIZE; i++)
+    {
+        capture_wrapper_t *wrapper = (capture_wrapper_t *)k4a_atomic_exchange_ptr(&g_capture_pool[i], NULL);
+        if (wrapper != NULL)
+        {
+            DESTROY(wrapper);
+        }
+    }
+}
+
 void allocator_initialize(void)
 {
     INC_REF_VAR(g_allocator_sessions);
@@ -124,7 +256,37 @@ void allocator_initialize(void)
 
 void allocator_deinitialize(void)
 {
-    DEC_REF_VAR(g_allocator_sessions);
+    if (DEC_REF_VAR(g_allocator_sessions) == 0)
+    {
+        // Don't hold on to pooled captures once the last session has ended
+        capture_pool_drain();
+    }
+}
+
+// Copies the current allocator without taking the lock, an entry isn't rewritten while it has readers
+static uint32_t allocator_read_current(allocator_global_t *g_allocator, allocator_callbacks_t *callbacks)
+{
+    while (true)
+    {
+        uint32_t current = k4a_atomic_load(&g_allocator->current);
+        allocator_callbacks_t *entry = &g_allocator->installed[current];
+        bool read = false;
+
+        k4a_atomic_add(&entry->readers, 1);
+        if (k4a_atomic_load(&g_allocator->current) == current)
+        {
+            // Still current after becoming a reader, so allocator_set_allocator() can't be rewriting the entry
+            callbacks->alloc = entry->alloc;
+            callbacks->free = entry->free;
+            read = true;
+        }
+        k4a_atomic_add(&entry->readers, (uint32_t)-1);
+
+        if (read)
+        {
+            return current;
+        }
+    }
 }
 
 k4a_result_t allocator_set_allocator(k4a_memory_allocate_cb_t allocate, k4a_memory_destroy_cb_t free)
@@ -133,24 +295,79 @@ k4a_result_t allocator_set_allocator(k4a_memory_allocate_cb_t allocate, k4a_memo
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, allocate != NULL && free == NULL);
 
     allocator_global_t *g_allocator = allocator_global_t_get();
+    k4a_memory_allocate_cb_t *alloc_cb = allocate ? allocate : default_alloc;
+    k4a_memory_destroy_cb_t *free_cb = free ? free : default_free;
+    k4a_result_t result = K4A_RESULT_SUCCEEDED;
+
     rwlock_acquire_write(&g_allocator->lock);
 
-    g_allocator->alloc = allocate ? allocate : default_alloc;
-    g_allocator->free = free ? free : default_free;
+    uint32_t index = 0;
+    while (index < g_allocator->installed_count &&
+           (g_allocator->installed[index].alloc != alloc_cb || g_allocator->installed[index].free != free_cb))
+    {
+        index++;
+    }
+
+    if (index == g_allocator->installed_count && index < ALLOCATOR_MAX_INSTALLED)
+    {
+        g_allocator->installed[index].alloc = alloc_cb;
+        g_allocator->installed[index].free = free_cb;
+        g_allocator->installed_count++;
+    }
+    else if (index == g_allocator->installed_count)
+    {
+        // Reuse an entry that isn't current. Allocations already made keep their free function in their own header, so
+        // only an allocator_read_current() still reading the entry stops it from being rewritten. Readers that start
+        // now see that the entry isn't current and retry, so the ones left finish right away.
+        uint32_t current = k4a_atomic_load(&g_allocator->current);
+        index = current == 1 ? 2 : 1;
+        while (k4a_atomic_load(&g_allocator->installed[index].readers) != 0)
+        {
+            ThreadAPI_Sleep(0);
+        }
+        g_allocator->installed[index].alloc = alloc_cb;
+        g_allocator->installed[index].free = free_cb;
+    }
+
+    // Publish the allocator. An allocation already in progress on another thread completes with the previous one.
+    k4a_atomic_store(&g_allocator->current, index);
 
     rwlock_release_write(&g_allocator->lock);
 
+    return result;
+}
+
+k4a_result_t allocator_set_default_pool_size(size_t max_retained_bytes)
+{
+    allocator_size_class_set_max_retained_bytes(max_retained_bytes);
     return K4A_RESULT_SUCCEEDED;
 }
 
 uint8_t *allocator_alloc(allocation_source_t source, size_t alloc_size)
+{
+    return allocator_alloc_aligned(source, alloc_size, ALLOCATOR_DEFAULT_ALIGNMENT);
+}
+
+uint8_t *allocator_alloc_aligned(allocation_source_t source, size_t alloc_size, size_t alignment)
+{
+    return allocator_alloc_hooked(NULL, source, alloc_size, alignment);
+}
+
+uint8_t *allocator_alloc_hooked(const allocator_hook_t *hook,
+                                allocation_source_t source,
+                                size_t alloc_size,
+                                size_t alignment)
 {
     allocator_global_t *g_allocator = allocator_global_t_get();
 
     RETURN_VALUE_IF_ARG(NULL, source < ALLOCATION_SOURCE_USER || source > ALLOCATION_SOURCE_USB_IMU);
     RETURN_VALUE_IF_ARG(NULL, alloc_size == 0);
+    RETURN_VALUE_IF_ARG(NULL, alignment == 0 || (alignment & (alignment - 1)) != 0);
+    RETURN_VALUE_IF_ARG(NULL, alignment > ALLOCATOR_MAX_ALIGNMENT);
 
-    size_t required_bytes = alloc_size + sizeof(allocation_context_t);
+    // The allocate callback makes no alignment promise, so reserve enough to align any address it returns
+    RETURN_VALUE_IF_ARG(NULL, alloc_size > INT32_MAX);
+    size_t required_bytes = alloc_size + sizeof(allocation_context_t) + alignment - 1;
     RETURN_VALUE_IF_ARG(NULL, required_bytes > INT32_MAX);
 
     volatile long *ref = NULL;
@@ -180,43 +397,80 @@ uint8_t *allocator_alloc(allocation_source_t source, size_t alloc_size)
     }
 
     INC_REF_VAR(*ref);
+    allocator_stats_add(g_allocator, source, alloc_size);
 
-    rwlock_acquire_read(&g_allocator->lock);
+    void *user_context = NULL;
+    void *full_buffer;
+    k4a_memory_destroy_cb_t *free_cb;
 
-    void *user_context;
+    if (hook != NULL && hook->rings[source] != NULL)
+    {
+        // The buffer ring holds the allocation header too, so the buffer is at the same offset in every slot
+        full_buffer = allocator_ring_allocate(
+            (int)required_bytes, (k4a_allocation_source_t)source, hook->rings[source], &user_context);
+        free_cb = allocator_ring_free;
+    }
+    else if (hook != NULL && hook->allocate != NULL)
+    {
+        full_buffer = hook->allocate(
+            (int)required_bytes, (k4a_allocation_source_t)source, hook->context, &user_context);
+        free_cb = hook->free;
+    }
+    else
+    {
+        allocator_callbacks_t callbacks;
+        uint32_t current = allocator_read_current(g_allocator, &callbacks);
+        full_buffer = NULL;
+        free_cb = NULL;
+
+        // Large frame buffers of the default allocator may be backed by huge pages, they are touched sequentially
+        // every frame and spread over many base pages
+        if (current == 0 && (source == ALLOCATION_SOURCE_COLOR || source == ALLOCATION_SOURCE_DEPTH))
+        {
+            full_buffer = allocator_huge_page_alloc((int)required_bytes, &user_context);
+            free_cb = allocator_huge_page_free;
+        }
 
-    void *full_buffer = g_allocator->alloc((int)required_bytes, &user_context);
+        if (full_buffer == NULL)
+        {
+            full_buffer = callbacks.alloc((int)required_bytes, &user_context);
+            free_cb = callbacks.free;
+        }
+    }
 
     // Store information about the allocation that we will need during free.
     allocation_context_t allocation_context;
 
     allocation_context.u.context.source = source;
-    allocation_context.u.context.free = g_allocator->free;
+    allocation_context.u.context.free = free_cb;
     allocation_context.u.context.free_context = user_context;
-
-    rwlock_release_read(&g_allocator->lock);
+    allocation_context.u.context.size = alloc_size;
 
     if (full_buffer == NULL)
     {
         LOG_ERROR("User allocation function for %d bytes failed", required_bytes);
+        DEC_REF_VAR(*ref);
+        allocator_stats_remove(g_allocator, source, alloc_size);
         return NULL;
     }
 
-    // Memcpy the context information to the header of the full buffer.
-    // Don't cast the buffer directly since there is no alignment constraint
-    memcpy(full_buffer, &allocation_context, sizeof(allocation_context));
+    // Provide the caller with the first aligned address after room for the allocation context header.
+    uintptr_t start = (uintptr_t)full_buffer + sizeof(allocation_context_t);
+    uint8_t *buffer = (uint8_t *)((start + alignment - 1) & ~(uintptr_t)(alignment - 1));
+    allocation_context.u.context.offset = (uint32_t)(buffer - (uint8_t *)full_buffer);
 
-    // Provide the caller with the buffer after the allocation context header.
-    uint8_t *buffer = (uint8_t *)full_buffer + sizeof(allocation_context_t);
+    // Memcpy the context information to the header just before the buffer.
+    // Don't cast the buffer directly since the header is only aligned when alignment is a multiple of 16
+    memcpy(buffer - sizeof(allocation_context_t), &allocation_context, sizeof(allocation_context));
 
     return buffer;
 }
 
 void allocator_free(void *buffer)
 {
-    void *full_buffer = (uint8_t *)buffer - sizeof(allocation_context_t);
     allocation_context_t allocation_context;
-    memcpy(&allocation_context, full_buffer, sizeof(allocation_context));
+    memcpy(&allocation_context, (uint8_t *)buffer - sizeof(allocation_context_t), sizeof(allocation_context));
+    void *full_buffer = (uint8_t *)buffer - allocation_context.u.context.offset;
 
     allocation_source_t source = allocation_context.u.context.source;
 
@@ -251,11 +505,72 @@ void allocator_free(void *buffer)
     }
 
     DEC_REF_VAR(*ref);
+    allocator_stats_remove(allocator_global_t_get(), source, allocation_context.u.context.size);
 
     allocation_context.u.context.free(full_buffer, allocation_context.u.context.free_context);
     full_buffer = NULL;
 }
 
+void allocator_prefault(uint8_t *buffer, size_t size)
+{
+    RETURN_VALUE_IF_ARG(VOID_VALUE, buffer == NULL);
+
+    // A read would only map the shared zero page, every page is written to commit it
+    volatile uint8_t *page = buffer;
+    for (size_t offset = 0; offset < size; offset += ALLOCATOR_PREFAULT_STRIDE)
+    {
+        page[offset] = 0;
+    }
+    if (size != 0)
+    {
+        page[size - 1] = 0;
+    }
+}
+
+k4a_result_t allocator_get_stats(allocation_source_t source, k4a_allocator_stats_t *stats)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, source < ALLOCATION_SOURCE_USER || source > ALLOCATION_SOURCE_USB_IMU);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, stats == NULL);
+
+    allocator_global_t *g_allocator = allocator_global_t_get();
+    allocator_source_stats_t *source_stats = &g_allocator->stats[source];
+    tickcounter_ms_t now = 0;
+    bool have_time = g_allocator->tick != NULL && tickcounter_get_current_ms(g_allocator->tick, &now) == 0;
+
+    // The counters are read individually, so they are only consistent with each other while the source is idle
+    uint64_t total_allocation_count = k4a_atomic_load64(&source_stats->total_allocation_count);
+    stats->buffer_count = k4a_atomic_load(&source_stats->buffer_count);
+    stats->allocated_bytes = k4a_atomic_load64(&source_stats->allocated_bytes);
+    stats->peak_allocated_bytes = k4a_atomic_load64(&source_stats->peak_allocated_bytes);
+    stats->total_allocation_count = total_allocation_count;
+
+    rwlock_acquire_write(&g_allocator->stats_lock);
+
+    if (have_time)
+    {
+        tickcounter_ms_t elapsed_ms = now - source_stats->rate_window_start_ms;
+        if (source_stats->rate_window_start_ms == 0)
+        {
+            // First query starts the first window
+            source_stats->rate_window_start_ms = now;
+            source_stats->rate_window_allocation_count = total_allocation_count;
+        }
+        else if (elapsed_ms >= ALLOCATOR_RATE_WINDOW_MS)
+        {
+            uint64_t allocations = total_allocation_count - source_stats->rate_window_allocation_count;
+            source_stats->allocations_per_second = (float)allocations * 1000.0f / (float)elapsed_ms;
+            source_stats->rate_window_start_ms = now;
+            source_stats->rate_window_allocation_count = total_allocation_count;
+        }
+    }
+
+    stats->allocations_per_second = source_stats->allocations_per_second;
+
+    rwlock_release_write(&g_allocator->stats_lock);
+
+    return K4A_RESULT_SUCCEEDED;
+}
+
 long allocator_test_for_leaks(void)
 {
     if (g_allocator_sessions != 0)
@@ -300,7 +615,7 @@ void capture_dec_ref(k4a_capture_t capture_handle)
 
     if (new_count == 0)
     {
-        rwlock_acquire_write(&capture->lock);
+        // This was the last reference, so no other thread can be using the capture and the lock is not needed
         for (int x = 0; x < IMAGE_TYPE_COUNT; x++)
         {
             if (capture->image[x])
@@ -308,9 +623,11 @@ void capture_dec_ref(k4a_capture_t capture_handle)
                 image_dec_ref(capture->image[x]);
             }
         }
-        rwlock_release_write(&capture->lock);
         rwlock_deinit(&capture->lock);
-        k4a_capture_t_destroy(capture_handle);
+        if (!capture_pool_release(capture_handle))
+        {
+            k4a_capture_t_destroy(capture_handle);
+        }
     }
 }
 
@@ -322,11 +639,32 @@ void capture_inc_ref(k4a_capture_t capture_handle)
     INC_REF_VAR(capture->ref_count);
 }
 
+void capture_pool_prefill(void)
+{
+    // Captures released while the pool has room are kept, so creating a full pool's worth and releasing them fills it
+    k4a_capture_t captures[CAPTURE_POOL_SIZE] = { 0 };
+    for (int i = 0; i < CAPTURE_POOL_SIZE; i++)
+    {
+        if (K4A_FAILED(capture_create(&captures[i])))
+        {
+            break;
+        }
+    }
+    for (int i = 0; i < CAPTURE_POOL_SIZE && captures[i] != NULL; i++)
+    {
+        capture_dec_ref(captures[i]);
+    }
+}
+
 k4a_result_t capture_create(k4a_capture_t *capture_handle)
 {
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, capture_handle == NULL);
 
-    capture_context_t *capture = k4a_capture_t_create(capture_handle);
+    capture_context_t *capture = capture_pool_acquire(capture_handle);
+    if (capture == NULL)
+    {
+        capture = k4a_capture_t_create(capture_handle);
+    }
     k4a_result_t result = K4A_RESULT_FROM_BOOL(capture != NULL);
 
     if (K4A_SUCCEEDED(result))
@@ -386,6 +724,74 @@ k4a_image_t capture_get_ir_image(k4a_capture_t capture_handle)
     return *image;
 }
 
+k4a_image_t capture_get_imu_samples_image(k4a_capture_t capture_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(NULL, k4a_capture_t, capture_handle);
+
+    capture_context_t *capture = k4a_capture_t_get_context(capture_handle);
+
+    rwlock_acquire_read(&capture->lock);
+    k4a_image_t *image = &capture->image[IMAGE_TYPE_IMU_SAMPLES];
+    if (*image)
+    {
+        image_inc_ref(*image);
+    }
+    rwlock_release_read(&capture->lock);
+    return *image;
+}
+
+static k4a_result_t capture_peek_image_timestamp(k4a_capture_t capture_handle, int image_type, uint64_t *timestamp_usec)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_capture_t, capture_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, timestamp_usec == NULL);
+
+    capture_context_t *capture = k4a_capture_t_get_context(capture_handle);
+
+    // The read lock keeps the image alive while we read it, so no reference needs to be taken
+    rwlock_acquire_read(&capture->lock);
+    k4a_image_t image = capture->image[image_type];
+    if (image)
+    {
+        *timestamp_usec = image_get_device_timestamp_usec(image);
+    }
+    rwlock_release_read(&capture->lock);
+
+    return K4A_RESULT_FROM_BOOL(image != NULL);
+}
+
+k4a_result_t capture_peek_color_image_timestamp(k4a_capture_t capture_handle, uint64_t *timestamp_usec)
+{
+    return capture_peek_image_timestamp(capture_handle, IMAGE_TYPE_COLOR, timestamp_usec);
+}
+
+k4a_result_t capture_peek_ir_image_timestamp(k4a_capture_t capture_handle, uint64_t *timestamp_usec)
+{
+    return capture_peek_image_timestamp(capture_handle, IMAGE_TYPE_IR, timestamp_usec);
+}
+
+k4a_result_t capture_peek_depth_image_timestamp(k4a_capture_t capture_handle, uint64_t *timestamp_usec)
+{
+    return capture_peek_image_timestamp(capture_handle, IMAGE_TYPE_DEPTH, timestamp_usec);
+}
+
+void capture_set_stage_timestamp(k4a_capture_t capture_handle, k4a_image_stage_t stage)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, k4a_capture_t, capture_handle);
+
+    capture_context_t *capture = k4a_capture_t_get_context(capture_handle);
+    uint64_t time_nsec = image_get_system_time_nsec();
+
+    rwlock_acquire_read(&capture->lock);
+    for (int x = 0; x < IMAGE_TYPE_COUNT; x++)
+    {
+        if (capture->image[x])
+        {
+            image_set_stage_timestamp_nsec(capture->image[x], stage, time_nsec);
+        }
+    }
+    rwlock_release_read(&capture->lock);
+}
+
 k4a_image_t capture_get_imu_image(k4a_capture_t capture_handle)
 {
     // We just reuse the ir image location as this is never exposed to the user or combined with ir/color/depth.
@@ -453,6 +859,24 @@ void capture_set_imu_image(k4a_capture_t capture_handle, k4a_image_t image_handl
     // We just reuse the ir image location as this is never exposed to the user.
     capture_set_ir_image(capture_handle, image_handle);
 }
+void capture_set_imu_samples_image(k4a_capture_t capture_handle, k4a_image_t image_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, k4a_capture_t, capture_handle);
+
+    capture_context_t *capture = k4a_capture_t_get_context(capture_handle);
+    rwlock_acquire_write(&capture->lock);
+    k4a_image_t *image = &capture->image[IMAGE_TYPE_IMU_SAMPLES];
+    if (*image)
+    {
+        image_dec_ref(*image); // drop the image that was here
+    }
+    *image = image_handle;
+    if (image_handle != NULL)
+    {
+        image_inc_ref(*image);
+    }
+    rwlock_release_write(&capture->lock);
+}
 
 void capture_set_temperature_c(k4a_capture_t capture_handle, float temperature_c)
 {
@@ -470,3 +894,27 @@ float capture_get_temperature_c(k4a_capture_t capture_handle)
     capture_context_t *capture = k4a_capture_t_get_context(capture_handle);
     return capture->temperature_c;
 }
+
+static void capture_fill_image_view(k4a_image_t image, k4a_image_view_t *view)
+{
+    if (image == NULL || K4A_FAILED(image_get_view(image, view)))
+    {
+        memset(view, 0, sizeof(*view));
+    }
+}
+
+k4a_result_t capture_get_view(k4a_capture_t capture_handle, k4a_capture_view_t *view)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_capture_t, capture_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, view == NULL);
+
+    capture_context_t *capture = k4a_capture_t_get_context(capture_handle);
+
+    rwlock_acquire_read(&capture->lock);
+    capture_fill_image_view(capture->image[IMAGE_TYPE_COLOR], &view->color);
+    capture_fill_image_view(capture->image[IMAGE_TYPE_DEPTH], &view->depth);
+    capture_fill_image_view(capture->image[IMAGE_TYPE_IR], &view->ir);
+    view->temperature_c = capture->temperature_c;
+    rwlock_release_read(&capture->lock);
+    return K4A_RESULT_SUCCEEDED;
+}
@@ -0,0 +1,140 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// This library
+#include <k4ainternal/allocator.h>
+
+// Dependent libraries
+#include <k4ainternal/atomic.h>
+#include <k4ainternal/common.h>
+#include <k4ainternal/global.h>
+#include <k4ainternal/logging.h>
+#include <azure_c_shared_utility/envvariable.h>
+
+// System dependencies
+#include <stdlib.h>
+#include <stdint.h>
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+// Transparent huge pages are 2MB on x86_64 and on arm64 with 4KB base pages
+#define HUGE_PAGE_SIZE ((size_t)2 * 1024 * 1024)
+
+typedef struct
+{
+    // Smallest request backed by huge pages, 0 disables them. Requests are limited to INT32_MAX so 32 bits suffice.
+    volatile uint32_t min_bytes;
+
+    // Set once mapping large pages failed, so the failure is only logged once
+    volatile uint32_t unavailable_logged;
+} huge_page_global_t;
+
+static void huge_page_global_init(huge_page_global_t *g_huge_page)
+{
+    // Huge pages can be enabled without code changes
+    const char *env_min_bytes = environment_get_variable("K4A_ALLOCATOR_HUGE_PAGE_BYTES");
+    if (env_min_bytes != NULL && env_min_bytes[0] != '\0')
+    {
+        unsigned long long min_bytes = strtoull(env_min_bytes, NULL, 10);
+        g_huge_page->min_bytes = min_bytes > UINT32_MAX ? UINT32_MAX : (uint32_t)min_bytes;
+    }
+}
+
+K4A_DECLARE_GLOBAL(huge_page_global_t, huge_page_global_init);
+
+static void huge_page_log_unavailable(huge_page_global_t *g_huge_page)
+{
+    if (k4a_atomic_exchange(&g_huge_page->unavailable_logged, 1) == 0)
+    {
+        LOG_WARNING("Huge pages are not available, large buffers fall back to the default allocator", 0);
+    }
+}
+
+uint8_t *allocator_huge_page_alloc(int size, void **context)
+{
+    *context = NULL;
+    huge_page_global_t *g_huge_page = huge_page_global_t_get();
+    uint32_t min_bytes = k4a_atomic_load(&g_huge_page->min_bytes);
+    if (size <= 0 || min_bytes == 0 || (uint32_t)size < min_bytes)
+    {
+        return NULL;
+    }
+
+    size_t length = ((size_t)size + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+    uint8_t *buffer = NULL;
+
+#ifdef _WIN32
+    // Large pages need the SeLockMemoryPrivilege, without it the allocation fails and the caller falls back
+    size_t large_page_size = GetLargePageMinimum();
+    if (large_page_size != 0)
+    {
+        length = ((size_t)size + large_page_size - 1) & ~(large_page_size - 1);
+        buffer = (uint8_t *)VirtualAlloc(NULL, length, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+    }
+#elif defined(__linux__)
+#ifdef MAP_HUGETLB
+    // Explicit huge pages come from the pool reserved in /proc/sys/vm/nr_hugepages, the mapping fails if it is empty
+    void *mapping = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (mapping != MAP_FAILED)
+    {
+        buffer = (uint8_t *)mapping;
+    }
+#endif
+#ifdef MADV_HUGEPAGE
+    if (buffer == NULL)
+    {
+        // Map one extra huge page and trim both ends so every 2MB of the buffer can be a transparent huge page
+        size_t padded_length = length + HUGE_PAGE_SIZE;
+        uint8_t *padded = (uint8_t *)mmap(
+            NULL, padded_length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (padded != (uint8_t *)MAP_FAILED)
+        {
+            buffer = (uint8_t *)(((uintptr_t)padded + HUGE_PAGE_SIZE - 1) & ~(uintptr_t)(HUGE_PAGE_SIZE - 1));
+            size_t head = (size_t)(buffer - padded);
+            if (head != 0)
+            {
+                (void)munmap(padded, head);
+            }
+            (void)munmap(buffer + length, HUGE_PAGE_SIZE - head);
+
+            // Advisory only, the buffer is still usable with base pages when THP is disabled
+            (void)madvise(buffer, length, MADV_HUGEPAGE);
+        }
+    }
+#endif
+#endif
+
+    if (buffer == NULL)
+    {
+        huge_page_log_unavailable(g_huge_page);
+        return NULL;
+    }
+
+    // The free callback needs the mapped length
+    *context = (void *)(uintptr_t)length;
+    return buffer;
+}
+
+void allocator_huge_page_free(void *buffer, void *context)
+{
+#ifdef _WIN32
+    (void)context;
+    (void)VirtualFree(buffer, 0, MEM_RELEASE);
+#elif defined(__linux__)
+    (void)munmap(buffer, (size_t)(uintptr_t)context);
+#else
+    // allocator_huge_page_alloc() never returns a buffer on other platforms
+    (void)buffer;
+    (void)context;
+#endif
+}
+
+k4a_result_t allocator_set_huge_page_threshold(size_t min_bytes)
+{
+    huge_page_global_t *g_huge_page = huge_page_global_t_get();
+    k4a_atomic_store(&g_huge_page->min_bytes, min_bytes > UINT32_MAX ? UINT32_MAX : (uint32_t)min_bytes);
+    return K4A_RESULT_SUCCEEDED;
+}
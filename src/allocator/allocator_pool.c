@@ -0,0 +1,184 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// This library
+#include <k4ainternal/allocator.h>
+
+// Dependent libraries
+#include <k4ainternal/common.h>
+#include <k4ainternal/logging.h>
+#include <azure_c_shared_utility/lock.h>
+#include <azure_c_shared_utility/refcount.h>
+
+// System dependencies
+#include <stdlib.h>
+#include <assert.h>
+
+struct _allocator_pool_t
+{
+    allocation_source_t source;
+    allocator_hook_t hook;
+    LOCK_HANDLE lock;
+    volatile long ref_count; // One for the owner plus one for every buffer handed out
+    bool closed;
+    size_t buffer_size;
+    uint32_t capacity;
+    uint32_t free_count;
+    uint8_t **free_list;
+};
+
+static void allocator_pool_dec_ref(allocator_pool_t *pool)
+{
+    if (DEC_REF_VAR(pool->ref_count) == 0)
+    {
+        assert(pool->free_count == 0);
+        Lock_Deinit(pool->lock);
+        free(pool->free_list);
+        free(pool);
+    }
+}
+
+allocator_pool_t *allocator_pool_create(const allocator_hook_t *hook,
+                                        allocation_source_t source,
+                                        size_t buffer_size,
+                                        uint32_t capacity)
+{
+    RETURN_VALUE_IF_ARG(NULL, buffer_size == 0);
+
+    allocator_pool_t *pool = (allocator_pool_t *)calloc(1, sizeof(allocator_pool_t));
+    k4a_result_t result = K4A_RESULT_FROM_BOOL(pool != NULL);
+
+    if (K4A_SUCCEEDED(result))
+    {
+        pool->source = source;
+        if (hook)
+        {
+            pool->hook = *hook;
+        }
+        pool->ref_count = 1;
+        pool->buffer_size = buffer_size;
+        pool->capacity = capacity;
+        pool->lock = Lock_Init();
+        pool->free_list = (uint8_t **)calloc(capacity ? capacity : 1, sizeof(uint8_t *));
+        result = K4A_RESULT_FROM_BOOL(pool->lock != NULL && pool->free_list != NULL);
+    }
+
+    for (uint32_t i = 0; K4A_SUCCEEDED(result) && i < capacity; i++)
+    {
+        uint8_t *buffer = allocator_alloc_hooked(&pool->hook, source, buffer_size, ALLOCATOR_DEFAULT_ALIGNMENT);
+        result = K4A_RESULT_FROM_BOOL(buffer != NULL);
+        if (K4A_SUCCEEDED(result))
+        {
+            pool->free_list[pool->free_count++] = buffer;
+        }
+    }
+
+    if (K4A_FAILED(result) && pool != NULL)
+    {
+        for (uint32_t i = 0; i < pool->free_count; i++)
+        {
+            allocator_free(pool->free_list[i]);
+        }
+        pool->free_count = 0;
+        if (pool->lock)
+        {
+            Lock_Deinit(pool->lock);
+        }
+        free(pool->free_list);
+        free(pool);
+        pool = NULL;
+    }
+
+    return pool;
+}
+
+uint8_t *allocator_pool_alloc(allocator_pool_t *pool, bool *recycled)
+{
+    RETURN_VALUE_IF_ARG(NULL, pool == NULL);
+
+    uint8_t *buffer = NULL;
+
+    Lock(pool->lock);
+    if (pool->free_count > 0)
+    {
+        buffer = pool->free_list[--pool->free_count];
+    }
+    Unlock(pool->lock);
+
+    if (recycled)
+    {
+        *recycled = buffer != NULL;
+    }
+
+    if (buffer == NULL)
+    {
+        // The pool will adopt this buffer when it is returned, if there is space
+        buffer = allocator_alloc_hooked(&pool->hook, pool->source, pool->buffer_size, ALLOCATOR_DEFAULT_ALIGNMENT);
+    }
+
+    if (buffer != NULL)
+    {
+        INC_REF_VAR(pool->ref_count);
+    }
+
+    return buffer;
+}
+
+void allocator_pool_free(void *buffer, void *context)
+{
+    RETURN_VALUE_IF_ARG(VOID_VALUE, buffer == NULL);
+    RETURN_VALUE_IF_ARG(VOID_VALUE, context == NULL);
+
+    allocator_pool_t *pool = (allocator_pool_t *)context;
+    bool recycled = false;
+
+    Lock(pool->lock);
+    if (!pool->closed && pool->free_count < pool->capacity)
+    {
+        pool->free_list[pool->free_count++] = (uint8_t *)buffer;
+        recycled = true;
+    }
+    Unlock(pool->lock);
+
+    if (!recycled)
+    {
+        allocator_free(buffer);
+    }
+
+    allocator_pool_dec_ref(pool);
+}
+
+size_t allocator_pool_get_buffer_size(allocator_pool_t *pool)
+{
+    RETURN_VALUE_IF_ARG(0, pool == NULL);
+    return pool->buffer_size;
+}
+
+void allocator_pool_prefault(allocator_pool_t *pool)
+{
+    RETURN_VALUE_IF_ARG(VOID_VALUE, pool == NULL);
+
+    Lock(pool->lock);
+    for (uint32_t i = 0; i < pool->free_count; i++)
+    {
+        allocator_prefault(pool->free_list[i], pool->buffer_size);
+    }
+    Unlock(pool->lock);
+}
+
+void allocator_pool_close(allocator_pool_t *pool)
+{
+    RETURN_VALUE_IF_ARG(VOID_VALUE, pool == NULL);
+
+    Lock(pool->lock);
+    pool->closed = true;
+    for (uint32_t i = 0; i < pool->free_count; i++)
+    {
+        allocator_free(pool->free_list[i]);
+        pool->free_list[i] = NULL;
+    }
+    pool->free_count = 0;
+    Unlock(pool->lock);
+
+    allocator_pool_dec_ref(pool);
+}
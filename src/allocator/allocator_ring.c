@@ -0,0 +1,222 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// This library
+#include <k4ainternal/allocator.h>
+
+// Dependent libraries
+#include <k4ainternal/common.h>
+#include <k4ainternal/handle.h>
+#include <k4ainternal/image.h>
+#include <k4ainternal/logging.h>
+#include <azure_c_shared_utility/lock.h>
+#include <azure_c_shared_utility/refcount.h>
+
+// System dependencies
+#include <stdlib.h>
+#include <assert.h>
+
+typedef struct _buffer_ring_context_t
+{
+    uint8_t *buffer;
+    size_t slot_size;
+    uint32_t slot_count;
+    LOCK_HANDLE lock;
+    volatile long ref_count; // One for the handle, one per slot in use and one per device the ring is set on
+    uint32_t free_count;
+    uint32_t *free_slots; // Taken from the front so slots are reused in the order they were returned
+    uint32_t free_first;
+} buffer_ring_context_t;
+
+K4A_DECLARE_CONTEXT(k4a_buffer_ring_t, buffer_ring_context_t);
+
+k4a_result_t allocator_ring_create(uint8_t *buffer, size_t slot_size, uint32_t slot_count, k4a_buffer_ring_t *ring)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, ring == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, buffer == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, slot_size <= K4A_BUFFER_RING_SLOT_OVERHEAD || slot_size > INT32_MAX);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, slot_count == 0);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, slot_size > SIZE_MAX / slot_count);
+
+    buffer_ring_context_t *context = k4a_buffer_ring_t_create(ring);
+    k4a_result_t result = K4A_RESULT_FROM_BOOL(context != NULL);
+
+    if (K4A_SUCCEEDED(result))
+    {
+        context->buffer = buffer;
+        context->slot_size = slot_size;
+        context->slot_count = slot_count;
+        context->ref_count = 1;
+        context->lock = Lock_Init();
+        context->free_slots = (uint32_t *)calloc(slot_count, sizeof(uint32_t));
+        result = K4A_RESULT_FROM_BOOL(context->lock != NULL && context->free_slots != NULL);
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        for (uint32_t i = 0; i < slot_count; i++)
+        {
+            context->free_slots[i] = i;
+        }
+        context->free_count = slot_count;
+    }
+    else if (context != NULL)
+    {
+        if (context->lock)
+        {
+            Lock_Deinit(context->lock);
+        }
+        free(context->free_slots);
+        k4a_buffer_ring_t_destroy(*ring);
+        *ring = NULL;
+    }
+
+    return result;
+}
+
+k4a_result_t allocator_ring_add_ref(k4a_buffer_ring_t ring)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_buffer_ring_t, ring);
+    buffer_ring_context_t *context = k4a_buffer_ring_t_get_context(ring);
+    INC_REF_VAR(context->ref_count);
+    return K4A_RESULT_SUCCEEDED;
+}
+
+void allocator_ring_release(k4a_buffer_ring_t ring)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, k4a_buffer_ring_t, ring);
+    buffer_ring_context_t *context = k4a_buffer_ring_t_get_context(ring);
+
+    if (DEC_REF_VAR(context->ref_count) == 0)
+    {
+        assert(context->free_count == context->slot_count);
+        Lock_Deinit(context->lock);
+        free(context->free_slots);
+        k4a_buffer_ring_t_destroy(ring);
+    }
+}
+
+// Takes the slot returned the longest time ago, NULL if every slot is in use or the size doesn't fit in a slot
+static uint8_t *allocator_ring_take_slot(buffer_ring_context_t *context, size_t size)
+{
+    if (size > context->slot_size)
+    {
+        LOG_ERROR("A buffer of %llu bytes doesn't fit in the %llu byte slots of the buffer ring",
+                  (unsigned long long)size,
+                  (unsigned long long)context->slot_size);
+        return NULL;
+    }
+
+    uint8_t *slot = NULL;
+    Lock(context->lock);
+    if (context->free_count > 0)
+    {
+        uint32_t index = context->free_slots[context->free_first];
+        context->free_first = (context->free_first + 1) % context->slot_count;
+        context->free_count--;
+        slot = context->buffer + (size_t)index * context->slot_size;
+    }
+    Unlock(context->lock);
+
+    if (slot == NULL)
+    {
+        LOG_WARNING("Every slot of the buffer ring is in use, release images to return their slots", 0);
+    }
+    else
+    {
+        INC_REF_VAR(context->ref_count);
+    }
+    return slot;
+}
+
+uint8_t *allocator_ring_allocate(int size,
+                                 k4a_allocation_source_t source,
+                                 void *ring,
+                                 void **buffer_release_cb_context)
+{
+    (void)source;
+    RETURN_VALUE_IF_ARG(NULL, size <= 0);
+    RETURN_VALUE_IF_ARG(NULL, buffer_release_cb_context == NULL);
+    RETURN_VALUE_IF_HANDLE_INVALID(NULL, k4a_buffer_ring_t, (k4a_buffer_ring_t)ring);
+    buffer_ring_context_t *context = k4a_buffer_ring_t_get_context((k4a_buffer_ring_t)ring);
+
+    *buffer_release_cb_context = ring;
+    return allocator_ring_take_slot(context, (size_t)size);
+}
+
+void allocator_ring_free(void *buffer, void *ring)
+{
+    RETURN_VALUE_IF_ARG(VOID_VALUE, buffer == NULL);
+    RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, k4a_buffer_ring_t, (k4a_buffer_ring_t)ring);
+    buffer_ring_context_t *context = k4a_buffer_ring_t_get_context((k4a_buffer_ring_t)ring);
+
+    // Slots are returned with the address they were taken at, the start of the slot
+    size_t offset = (size_t)((uint8_t *)buffer - context->buffer);
+    RETURN_VALUE_IF_ARG(VOID_VALUE, (uint8_t *)buffer < context->buffer || offset % context->slot_size != 0);
+    RETURN_VALUE_IF_ARG(VOID_VALUE, offset / context->slot_size >= context->slot_count);
+
+    Lock(context->lock);
+    assert(context->free_count < context->slot_count);
+    uint32_t last = (context->free_first + context->free_count) % context->slot_count;
+    context->free_slots[last] = (uint32_t)(offset / context->slot_size);
+    context->free_count++;
+    Unlock(context->lock);
+
+    allocator_ring_release((k4a_buffer_ring_t)ring);
+}
+
+k4a_result_t allocator_ring_get_slot(k4a_buffer_ring_t ring,
+                                     const uint8_t *buffer,
+                                     uint32_t *slot_index,
+                                     size_t *buffer_offset)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_buffer_ring_t, ring);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, buffer == NULL);
+    buffer_ring_context_t *context = k4a_buffer_ring_t_get_context(ring);
+
+    if (buffer < context->buffer || (size_t)(buffer - context->buffer) >= context->slot_size * context->slot_count)
+    {
+        // Not an error to log, the image may come from the process allocator
+        return K4A_RESULT_FAILED;
+    }
+
+    size_t offset = (size_t)(buffer - context->buffer);
+    if (slot_index)
+    {
+        *slot_index = (uint32_t)(offset / context->slot_size);
+    }
+    if (buffer_offset)
+    {
+        *buffer_offset = offset;
+    }
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t allocator_ring_create_image(k4a_buffer_ring_t ring,
+                                         k4a_image_format_t format,
+                                         int width_pixels,
+                                         int height_pixels,
+                                         int stride_bytes,
+                                         k4a_image_t *image)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_buffer_ring_t, ring);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, image == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, width_pixels <= 0 || height_pixels <= 0 || stride_bytes <= 0);
+    buffer_ring_context_t *context = k4a_buffer_ring_t_get_context(ring);
+
+    // Images are written at the start of a slot, there is no allocation header to make room for
+    size_t size = (size_t)height_pixels * (size_t)stride_bytes;
+    uint8_t *slot = allocator_ring_take_slot(context, size);
+    if (slot == NULL)
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    k4a_result_t result = TRACE_CALL(image_create_from_buffer(
+        format, width_pixels, height_pixels, stride_bytes, slot, size, allocator_ring_free, ring, image));
+    if (K4A_FAILED(result))
+    {
+        allocator_ring_free(slot, ring);
+    }
+    return result;
+}
@@ -0,0 +1,211 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// This library
+#include <k4ainternal/allocator.h>
+
+// Dependent libraries
+#include <k4ainternal/atomic.h>
+#include <k4ainternal/common.h>
+#include <k4ainternal/global.h>
+#include <k4ainternal/logging.h>
+#include <k4ainternal/rwlock.h>
+#include <azure_c_shared_utility/envvariable.h>
+
+// System dependencies
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+
+// Allocations up to this size are not worth pooling and always come from malloc
+#define SIZE_CLASS_MIN_SHIFT 12
+// Each power of 2 is split into this many classes, so a class wastes at most 1/8th of a buffer
+#define SIZE_CLASS_STEPS_SHIFT 3
+#define SIZE_CLASS_STEPS (1 << SIZE_CLASS_STEPS_SHIFT)
+// allocator_alloc() sizes are limited to INT32_MAX
+#define SIZE_CLASS_MAX_SHIFT 31
+#define SIZE_CLASS_COUNT ((SIZE_CLASS_MAX_SHIFT - SIZE_CLASS_MIN_SHIFT) * SIZE_CLASS_STEPS)
+
+// A retained buffer stores the link to the next one in its own memory
+typedef struct _size_class_buffer_t
+{
+    struct _size_class_buffer_t *next;
+} size_class_buffer_t;
+
+typedef struct _size_class_t
+{
+    size_t buffer_size;
+    size_class_buffer_t *free_list;
+    uint32_t free_count;
+} size_class_t;
+
+typedef struct
+{
+    k4a_rwlock_t lock;
+
+    // max_retained_bytes != 0, written while holding lock and read without it on every allocation
+    volatile uint32_t enabled;
+
+    // Access to the following may only occur while holding lock
+    size_t max_retained_bytes; // 0 disables pooling
+    size_t retained_bytes;
+    size_class_t classes[SIZE_CLASS_COUNT];
+} size_class_pool_global_t;
+
+static void size_class_pool_global_init(size_class_pool_global_t *g_pool)
+{
+    rwlock_init(&g_pool->lock);
+
+    for (uint32_t i = 0; i < SIZE_CLASS_COUNT; i++)
+    {
+        uint32_t shift = SIZE_CLASS_MIN_SHIFT + i / SIZE_CLASS_STEPS;
+        size_t step = (size_t)1 << (shift - SIZE_CLASS_STEPS_SHIFT);
+        g_pool->classes[i].buffer_size = ((size_t)1 << shift) + step * (i % SIZE_CLASS_STEPS + 1);
+    }
+
+    // Pooling can be enabled without code changes
+    const char *env_pool_bytes = environment_get_variable("K4A_ALLOCATOR_POOL_BYTES");
+    if (env_pool_bytes != NULL && env_pool_bytes[0] != '\0')
+    {
+        g_pool->max_retained_bytes = (size_t)strtoull(env_pool_bytes, NULL, 10);
+    }
+    g_pool->enabled = g_pool->max_retained_bytes != 0;
+}
+
+K4A_DECLARE_GLOBAL(size_class_pool_global_t, size_class_pool_global_init);
+
+// Returns the class index for size, or -1 if the size is not pooled
+static int size_class_index(size_t size)
+{
+    if (size <= ((size_t)1 << SIZE_CLASS_MIN_SHIFT) || size > ((size_t)1 << SIZE_CLASS_MAX_SHIFT))
+    {
+        return -1;
+    }
+
+    uint32_t shift = SIZE_CLASS_MIN_SHIFT;
+    while (size > ((size_t)1 << (shift + 1)))
+    {
+        shift++;
+    }
+
+    // size is in (2^shift, 2^(shift + 1)], round up to the next step
+    size_t step = (size_t)1 << (shift - SIZE_CLASS_STEPS_SHIFT);
+    size_t steps = (size - ((size_t)1 << shift) + step - 1) / step;
+    assert(steps >= 1 && steps <= SIZE_CLASS_STEPS);
+
+    return (int)((shift - SIZE_CLASS_MIN_SHIFT) * SIZE_CLASS_STEPS + (steps - 1));
+}
+
+// Frees retained buffers until retained_bytes is no more than limit. The caller holds the lock.
+static void size_class_pool_trim_locked(size_class_pool_global_t *g_pool, size_t limit)
+{
+    // Release the largest buffers first
+    for (int i = SIZE_CLASS_COUNT - 1; i >= 0 && g_pool->retained_bytes > limit; i--)
+    {
+        size_class_t *size_class = &g_pool->classes[i];
+        while (size_class->free_list != NULL && g_pool->retained_bytes > limit)
+        {
+            size_class_buffer_t *buffer = size_class->free_list;
+            size_class->free_list = buffer->next;
+            size_class->free_count--;
+            g_pool->retained_bytes -= size_class->buffer_size;
+            free(buffer);
+        }
+    }
+}
+
+uint8_t *allocator_size_class_alloc(int size, void **context)
+{
+    *context = NULL;
+    if (size < 0)
+    {
+        return NULL;
+    }
+
+    size_class_pool_global_t *g_pool = size_class_pool_global_t_get();
+    int index = size_class_index((size_t)size);
+    uint8_t *buffer = NULL;
+
+    if (index < 0 || k4a_atomic_load(&g_pool->enabled) == 0)
+    {
+        return (uint8_t *)malloc((size_t)size);
+    }
+
+    size_class_t *size_class = &g_pool->classes[index];
+
+    rwlock_acquire_write(&g_pool->lock);
+    if (size_class->free_list != NULL)
+    {
+        buffer = (uint8_t *)size_class->free_list;
+        size_class->free_list = size_class->free_list->next;
+        size_class->free_count--;
+        g_pool->retained_bytes -= size_class->buffer_size;
+    }
+    rwlock_release_write(&g_pool->lock);
+
+    if (buffer == NULL)
+    {
+        buffer = (uint8_t *)malloc(size_class->buffer_size);
+    }
+
+    if (buffer != NULL)
+    {
+        // The free callback needs the class to return the buffer to
+        *context = size_class;
+    }
+    return buffer;
+}
+
+void allocator_size_class_free(void *buffer, void *context)
+{
+    size_class_t *size_class = (size_class_t *)context;
+    if (size_class == NULL)
+    {
+        // Not pooled
+        free(buffer);
+        return;
+    }
+
+    size_class_pool_global_t *g_pool = size_class_pool_global_t_get();
+    bool retained = false;
+
+    rwlock_acquire_write(&g_pool->lock);
+    if (g_pool->retained_bytes + size_class->buffer_size <= g_pool->max_retained_bytes)
+    {
+        size_class_buffer_t *entry = (size_class_buffer_t *)buffer;
+        entry->next = size_class->free_list;
+        size_class->free_list = entry;
+        size_class->free_count++;
+        g_pool->retained_bytes += size_class->buffer_size;
+        retained = true;
+    }
+    rwlock_release_write(&g_pool->lock);
+
+    if (!retained)
+    {
+        free(buffer);
+    }
+}
+
+void allocator_size_class_set_max_retained_bytes(size_t max_retained_bytes)
+{
+    size_class_pool_global_t *g_pool = size_class_pool_global_t_get();
+
+    rwlock_acquire_write(&g_pool->lock);
+    g_pool->max_retained_bytes = max_retained_bytes;
+    k4a_atomic_store(&g_pool->enabled, max_retained_bytes != 0);
+    size_class_pool_trim_locked(g_pool, max_retained_bytes);
+    rwlock_release_write(&g_pool->lock);
+}
+
+size_t allocator_size_class_get_retained_bytes(void)
+{
+    size_class_pool_global_t *g_pool = size_class_pool_global_t_get();
+
+    rwlock_acquire_read(&g_pool->lock);
+    size_t retained_bytes = g_pool->retained_bytes;
+    rwlock_release_read(&g_pool->lock);
+
+    return retained_bytes;
+}
@@ -6,10 +6,13 @@
 
 // Dependent libraries
 #include <k4ainternal/common.h>
+#include <k4ainternal/logging.h>
+#include <azure_c_shared_utility/envvariable.h>
 #include <cJSON.h>
 #include <locale.h> //cJSON.h need this set correctly.
 
 // System dependencies
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
@@ -46,6 +49,31 @@ typedef struct _calibration_context_t
 
 K4A_DECLARE_CONTEXT(calibration_t, calibration_context_t);
 
+// Files of the disk cache start with this header followed by the raw JSON and then the parsed depth, color, gyro and
+// accel calibrations. Bump the version when the parsing changes.
+#define CALIBRATION_CACHE_MAGIC 0x4C41434B // "KCAL"
+#define CALIBRATION_CACHE_VERSION 1
+#define CALIBRATION_CACHE_MAX_JSON_SIZE (READ_RETRY_BASE_ALLOCATION + MAX_READ_RETRIES * READ_RETRY_ALLOC_INCREASE)
+
+// A cache file is only used by the device and firmware it was read from. The struct is zero initialized before it is
+// filled so it can be compared bytewise.
+typedef struct _calibration_cache_key_t
+{
+    char serial_number[MAX_SERIAL_NUMBER_LENGTH];
+    depthmcu_firmware_versions_t firmware_versions;
+    uint32_t camera_calibration_size;
+    uint32_t imu_calibration_size;
+} calibration_cache_key_t;
+
+typedef struct _calibration_cache_header_t
+{
+    uint32_t magic;
+    uint32_t version;
+    calibration_cache_key_t key;
+    uint64_t json_size;
+    uint64_t checksum; // Of the JSON and the parsed calibrations
+} calibration_cache_header_t;
+
 static k4a_result_t fill_array_of_floats(cJSON *json, float *data, unsigned int length)
 {
     k4a_result_t result;
@@ -584,10 +612,179 @@ static k4a_result_t read_extrinsic_calibration(calibration_context_t *calibratio
     return result;
 }
 
+// Calibrations are persisted in the directory set with K4A_CALIBRATION_CACHE, returns false if it is not set
+static bool calibration_get_cache_path(const calibration_cache_key_t *key, char *path, size_t path_size)
+{
+    const char *directory = environment_get_variable("K4A_CALIBRATION_CACHE");
+    if (directory == NULL || directory[0] == '\0')
+    {
+        return false;
+    }
+
+    int length = snprintf(path, path_size, "%s/k4a_calibration_%s.bin", directory, key->serial_number);
+    return length > 0 && (size_t)length < path_size;
+}
+
+// Reads the serial number and firmware versions the cache is keyed on, which are a couple of short MCU commands
+// compared to the calibration download. Returns false when the cache is disabled.
+static bool calibration_get_cache_key(depthmcu_t depthmcu, calibration_cache_key_t *key)
+{
+    const char *directory = environment_get_variable("K4A_CALIBRATION_CACHE");
+    if (directory == NULL || directory[0] == '\0')
+    {
+        return false;
+    }
+
+    memset(key, 0, sizeof(calibration_cache_key_t));
+    key->camera_calibration_size = (uint32_t)sizeof(k4a_calibration_camera_t);
+    key->imu_calibration_size = (uint32_t)sizeof(k4a_calibration_imu_t);
+
+    size_t serial_number_size = sizeof(key->serial_number);
+    if (depthmcu_get_serialnum(depthmcu, key->serial_number, &serial_number_size) != K4A_BUFFER_RESULT_SUCCEEDED ||
+        K4A_FAILED(depthmcu_get_version(depthmcu, &key->firmware_versions)))
+    {
+        LOG_WARNING("Not using the calibration cache, failed to read the device serial number or firmware version.", 0);
+        return false;
+    }
+
+    // The serial number names the cache file, so only accept the digits it is made of
+    for (size_t i = 0; key->serial_number[i] != '\0'; i++)
+    {
+        if (key->serial_number[i] < '0' || key->serial_number[i] > '9')
+        {
+            LOG_WARNING("Not using the calibration cache, unexpected device serial number.", 0);
+            return false;
+        }
+    }
+    return key->serial_number[0] != '\0';
+}
+
+static uint64_t calibration_get_cache_checksum(const calibration_context_t *calibration)
+{
+    const struct
+    {
+        const void *data;
+        size_t size;
+    } fields[] = { { calibration->json, calibration->json_size },
+                   { &calibration->depth_calibration, sizeof(k4a_calibration_camera_t) },
+                   { &calibration->color_calibration, sizeof(k4a_calibration_camera_t) },
+                   { &calibration->gyro_calibration, sizeof(k4a_calibration_imu_t) },
+                   { &calibration->accel_calibration, sizeof(k4a_calibration_imu_t) } };
+
+    // 64 bit FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t field = 0; field < COUNTOF(fields); field++)
+    {
+        const uint8_t *bytes = (const uint8_t *)fields[field].data;
+        for (size_t i = 0; i < fields[field].size; i++)
+        {
+            hash = (hash ^ bytes[i]) * 1099511628211ULL;
+        }
+    }
+    return hash;
+}
+
+static bool calibration_load_cache(calibration_context_t *calibration, const calibration_cache_key_t *key)
+{
+    char path[1024];
+    if (!calibration_get_cache_path(key, path, sizeof(path)))
+    {
+        return false;
+    }
+
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    calibration_cache_header_t header;
+    bool loaded = fread(&header, sizeof(header), 1, file) == 1 && header.magic == CALIBRATION_CACHE_MAGIC &&
+                  header.version == CALIBRATION_CACHE_VERSION &&
+                  memcmp(&header.key, key, sizeof(calibration_cache_key_t)) == 0 && header.json_size > 0 &&
+                  header.json_size <= CALIBRATION_CACHE_MAX_JSON_SIZE;
+
+    char *json = NULL;
+    if (loaded)
+    {
+        json = malloc((size_t)header.json_size);
+        loaded = json != NULL && fread(json, 1, (size_t)header.json_size, file) == header.json_size &&
+                 json[header.json_size - 1] == '\0' &&
+                 fread(&calibration->depth_calibration, sizeof(k4a_calibration_camera_t), 1, file) == 1 &&
+                 fread(&calibration->color_calibration, sizeof(k4a_calibration_camera_t), 1, file) == 1 &&
+                 fread(&calibration->gyro_calibration, sizeof(k4a_calibration_imu_t), 1, file) == 1 &&
+                 fread(&calibration->accel_calibration, sizeof(k4a_calibration_imu_t), 1, file) == 1 &&
+                 fgetc(file) == EOF;
+    }
+    fclose(file);
+
+    if (loaded)
+    {
+        calibration->json = json;
+        calibration->json_size = (size_t)header.json_size;
+        loaded = calibration_get_cache_checksum(calibration) == header.checksum;
+        if (!loaded)
+        {
+            calibration->json = NULL;
+            calibration->json_size = 0;
+        }
+    }
+
+    if (!loaded)
+    {
+        free(json);
+        LOG_WARNING("Ignoring the calibration cache file %s, it does not match the device.", path);
+    }
+    return loaded;
+}
+
+// Writes a temporary file renamed into place once complete, so concurrent processes never load a partial file
+static void calibration_save_cache(const calibration_context_t *calibration, const calibration_cache_key_t *key)
+{
+    char path[1024];
+    char temporary_path[1040];
+    if (!calibration_get_cache_path(key, path, sizeof(path)))
+    {
+        return;
+    }
+    snprintf(temporary_path, sizeof(temporary_path), "%s.tmp", path);
+
+    FILE *file = fopen(temporary_path, "wb");
+    if (file == NULL)
+    {
+        LOG_WARNING("Failed to create the calibration cache file %s.", temporary_path);
+        return;
+    }
+
+    calibration_cache_header_t header;
+    memset(&header, 0, sizeof(header));
+    header.magic = CALIBRATION_CACHE_MAGIC;
+    header.version = CALIBRATION_CACHE_VERSION;
+    header.key = *key;
+    header.json_size = calibration->json_size;
+    header.checksum = calibration_get_cache_checksum(calibration);
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                   fwrite(calibration->json, 1, calibration->json_size, file) == calibration->json_size &&
+                   fwrite(&calibration->depth_calibration, sizeof(k4a_calibration_camera_t), 1, file) == 1 &&
+                   fwrite(&calibration->color_calibration, sizeof(k4a_calibration_camera_t), 1, file) == 1 &&
+                   fwrite(&calibration->gyro_calibration, sizeof(k4a_calibration_imu_t), 1, file) == 1 &&
+                   fwrite(&calibration->accel_calibration, sizeof(k4a_calibration_imu_t), 1, file) == 1;
+    written = fclose(file) == 0 && written;
+
+    // Renaming fails on Windows if another process saved the same calibration first, which is just as good
+    if (!written || rename(temporary_path, path) != 0)
+    {
+        remove(temporary_path);
+    }
+}
+
 k4a_result_t calibration_create(depthmcu_t depthmcu, calibration_t *calibration_handle)
 {
     calibration_context_t *calibration;
     k4a_result_t result;
+    calibration_cache_key_t cache_key;
+    bool use_cache = false;
+    bool loaded_from_cache = false;
 
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, depthmcu == NULL);
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, calibration_handle == NULL);
@@ -599,10 +796,16 @@ k4a_result_t calibration_create(depthmcu_t depthmcu, calibration_t *calibration_
     {
         calibration->depthmcu = depthmcu;
 
+        use_cache = calibration_get_cache_key(depthmcu, &cache_key);
+        loaded_from_cache = use_cache && calibration_load_cache(calibration, &cache_key);
+    }
+
+    if (K4A_SUCCEEDED(result) && !loaded_from_cache)
+    {
         result = read_extrinsic_calibration(calibration);
     }
 
-    if (K4A_SUCCEEDED(result))
+    if (K4A_SUCCEEDED(result) && !loaded_from_cache)
     {
         result = calibration_create_from_raw(calibration->json,
                                              calibration->json_size,
@@ -612,6 +815,11 @@ k4a_result_t calibration_create(depthmcu_t depthmcu, calibration_t *calibration_
                                              &calibration->accel_calibration);
     }
 
+    if (K4A_SUCCEEDED(result) && use_cache && !loaded_from_cache)
+    {
+        calibration_save_cache(calibration, &cache_key);
+    }
+
     if (K4A_FAILED(result) && *calibration_handle != NULL)
     {
         calibration_destroy(*calibration_handle);
@@ -5,10 +5,13 @@
 #include <k4ainternal/capturesync.h>
 
 // Dependent libraries
+#include <k4ainternal/capture.h>
 #include <k4ainternal/handle.h>
 #include <k4ainternal/queue.h>
 #include <k4ainternal/logging.h>
 #include <k4ainternal/common.h>
+#include <k4ainternal/atomic.h>
+#include <k4ainternal/tracing.h>
 
 #include <azure_c_shared_utility/lock.h>
 #include <azure_c_shared_utility/envvariable.h>
@@ -16,17 +19,43 @@
 // System dependencies
 #include <stdlib.h>
 #include <stdbool.h>
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#define CAPTURESYNC_DEFAULT_WINDOW 2 // Candidates per stream considered for best-match pairing
+#define CAPTURESYNC_MAX_WINDOW 4
+#define CAPTURESYNC_CAPTURE_QUEUE_DEPTH (QUEUE_DEFAULT_SIZE / 2) // Used unless configured
+#define CAPTURESYNC_IMU_SAMPLE_DEPTH (K4A_IMU_SAMPLE_RATE / 2) // IMU samples waiting for a capture, half a second
 
 typedef k4a_image_t(pfn_get_typed_image_t)(k4a_capture_t capture);
+typedef k4a_result_t(pfn_peek_typed_timestamp_t)(k4a_capture_t capture, uint64_t *timestamp_usec);
+
+typedef struct _pending_capture_t
+{
+    k4a_capture_t capture;
+    uint64_t ts;
+} pending_capture_t;
+
 typedef struct _image_t
 {
-    pfn_get_typed_image_t *get_typed_image; // Accessor function to access the typed image
-    bool color_capture;                     // type of the image and capture this struct represents; color / depth & ir
-    queue_t queue;                          // The queue this data is stored in.
+    pfn_get_typed_image_t *get_typed_image;           // Accessor function to access the typed image
+    pfn_peek_typed_timestamp_t *peek_typed_timestamp; // Accessor function to read the typed image's timestamp
+    bool color_capture; // type of the image and capture this struct represents; color / depth & ir
+    queue_t queue;      // The queue this data is stored in.
 
     k4a_capture_t capture; // Oldest capture received from the sensor
     k4a_image_t image;     // The image stored in the capture
     uint64_t ts;           // The Timestamp of the image
+
+    // The next captures after capture in time order, looked at to find the best match for the other stream. window
+    // counts capture itself, so up to window - 1 captures wait here before the rest go to queue.
+    uint32_t window;
+    uint32_t pending_count;
+    pending_capture_t pending[CAPTURESYNC_MAX_WINDOW - 1];
 } frame_info_t;
 
 typedef struct _capturesync_context_t
@@ -49,6 +78,45 @@ typedef struct _capturesync_context_t
     volatile bool running;              // We have received start and should be processing data when true.
     LOCK_HANDLE lock;
 
+    // Taken before lock is released by an arrival that has captures to publish, so sync_queue sees captures in the
+    // order they were matched while the next arrival already runs the matching under lock.
+    LOCK_HANDLE publish_lock;
+
+    // Called with each synchronized capture in place of pushing it to sync_queue, only changed while stopped
+    k4a_capture_ready_cb_t *callback;
+    void *callback_context;
+
+    // Policy of sync_queue for the current or last start
+    k4a_queue_policy_t capture_queue_policy;
+
+    // Ring of IMU samples not yet attached to a capture, only filled while attach_imu_samples is set. imu_lock is
+    // taken on its own so the IMU streaming thread never waits on the matching.
+    volatile bool attach_imu_samples;
+    LOCK_HANDLE imu_lock;
+    k4a_imu_sample_t *imu_samples; // CAPTURESYNC_IMU_SAMPLE_DEPTH samples, allocated on the first start that needs them
+    uint32_t imu_first;
+    uint32_t imu_count;
+
+    volatile uint32_t latency_buckets[CAPTURESYNC_LATENCY_BUCKETS]; // See capturesync_latency_histogram_t
+    volatile uint64_t latency_max_usec;
+
+    // Captures discarded without being published since capturesync_create()
+    volatile uint32_t dropped_count;
+
+    // Counters since capturesync_create(), see capturesync_get_statistics()
+    volatile uint64_t depth_capture_count;
+    volatile uint64_t color_capture_count;
+    volatile uint64_t synchronized_capture_count;
+    volatile uint64_t delivered_capture_count;
+    volatile uint64_t total_delivery_latency_usec;
+    volatile uint32_t min_delivery_latency_usec;
+    volatile uint32_t max_delivery_latency_usec;
+    volatile uint32_t delivery_latency_buckets[K4A_DEVICE_STATISTICS_LATENCY_BUCKETS];
+
+    // Time to the first delivery since the last capturesync_start(), 0 until it happens
+    uint64_t start_time_usec;
+    volatile uint32_t first_capture_time_usec;
+
 } capturesync_context_t;
 
 K4A_DECLARE_CONTEXT(capturesync_t, capturesync_context_t);
@@ -59,6 +127,412 @@ K4A_DECLARE_CONTEXT(capturesync_t, capturesync_context_t);
 #define DEPTH_CAPTURE (false)
 #define COLOR_CAPTURE (true)
 
+#define CAPTURESYNC_OUTBOX_SIZE 16
+
+typedef enum
+{
+    CAPTURESYNC_LOG_ARRIVING = 0,
+    CAPTURESYNC_LOG_DEPTH_STABLE,
+    CAPTURESYNC_LOG_DROP,
+    CAPTURESYNC_LOG_RELEASE_EARLY,
+    CAPTURESYNC_LOG_LINK,
+} capturesync_log_type_t;
+
+typedef struct _capturesync_log_t
+{
+    capturesync_log_type_t type;
+    bool color_capture;
+    uint64_t ts;
+    uint64_t color_ts;
+    uint64_t depth_ts;
+    int dropped;
+} capturesync_log_t;
+
+/* Work decided on while holding sync->lock that is carried out after it is released. Captures are published in order
+ * before captures and images are released, so a capture that is both published and released stays valid until it is
+ * in sync_queue. */
+typedef struct _capturesync_outbox_t
+{
+    k4a_capture_t publish[CAPTURESYNC_OUTBOX_SIZE];
+    uint32_t publish_count;
+    k4a_capture_t release_captures[CAPTURESYNC_OUTBOX_SIZE];
+    uint32_t release_capture_count;
+    k4a_image_t release_images[CAPTURESYNC_OUTBOX_SIZE];
+    uint32_t release_image_count;
+    capturesync_log_t logs[CAPTURESYNC_OUTBOX_SIZE];
+    uint32_t log_count;
+} capturesync_outbox_t;
+
+static uint64_t capturesync_get_time_usec(void);
+static void capturesync_record_delivery(capturesync_context_t *sync, k4a_capture_t capture);
+static void capturesync_attach_imu_samples(capturesync_context_t *sync, k4a_capture_t capture);
+
+static void capturesync_outbox_publish_all(capturesync_context_t *sync, capturesync_outbox_t *outbox)
+{
+    for (uint32_t i = 0; i < outbox->publish_count; i++)
+    {
+        if (sync->attach_imu_samples)
+        {
+            // publish_lock is held, so the samples are handed out in the order the captures are published
+            capturesync_attach_imu_samples(sync, outbox->publish[i]);
+        }
+        capture_set_stage_timestamp(outbox->publish[i], K4A_IMAGE_STAGE_SYNC_DONE);
+        if (sync->callback != NULL)
+        {
+            // publish_lock is held, so callbacks are serialized and in the same order as sync_queue would be
+            capturesync_record_delivery(sync, outbox->publish[i]);
+            capture_set_stage_timestamp(outbox->publish[i], K4A_IMAGE_STAGE_USER_POP);
+            sync->callback(outbox->publish[i], sync->callback_context);
+        }
+        else
+        {
+            queue_push(sync->sync_queue, outbox->publish[i]);
+        }
+    }
+    outbox->publish_count = 0;
+}
+
+static void capturesync_outbox_release_all(capturesync_outbox_t *outbox)
+{
+    for (uint32_t i = 0; i < outbox->release_capture_count; i++)
+    {
+        capture_dec_ref(outbox->release_captures[i]);
+    }
+    outbox->release_capture_count = 0;
+
+    for (uint32_t i = 0; i < outbox->release_image_count; i++)
+    {
+        image_dec_ref(outbox->release_images[i]);
+    }
+    outbox->release_image_count = 0;
+}
+
+static void capturesync_outbox_log_all(capturesync_outbox_t *outbox)
+{
+    for (uint32_t i = 0; i < outbox->log_count; i++)
+    {
+        capturesync_log_t *log = &outbox->logs[i];
+        switch (log->type)
+        {
+        case CAPTURESYNC_LOG_ARRIVING:
+            LOG_INFO("capturesync_ts, Arriving capture, TS:%10lld, %s, Color TS:%10lld, Depth TS:%10lld",
+                     log->ts,
+                     log->color_capture ? "Color " : "Depth ",
+                     log->color_ts,
+                     log->depth_ts);
+            break;
+        case CAPTURESYNC_LOG_DEPTH_STABLE:
+            LOG_INFO("Dropped %d depth captures waiting for time stamps to stabilize", log->dropped);
+            break;
+        case CAPTURESYNC_LOG_DROP:
+            LOG_INFO("capturesync_drop, Dropping sample TS:%10lld type:%s",
+                     log->ts,
+                     log->color_capture ? "Color" : "Depth");
+            break;
+        case CAPTURESYNC_LOG_RELEASE_EARLY:
+            LOG_ERROR("capturesync_drop, releasing capture early due to full queue TS:%10lld type:%s",
+                      log->ts,
+                      log->color_capture ? "Color" : "Depth");
+            break;
+        case CAPTURESYNC_LOG_LINK:
+            LOG_INFO("capturesync_link,TS_Color, %10lld, TS_Depth, %10lld,", log->color_ts, log->depth_ts);
+            break;
+        }
+    }
+    outbox->log_count = 0;
+}
+
+/* Called with sync->lock held when one of the outbox arrays is full. This is rare, so the work is simply done under
+ * the lock; publish_lock is still taken so captures published by an earlier arrival go first. */
+static void capturesync_outbox_flush_locked(capturesync_context_t *sync, capturesync_outbox_t *outbox)
+{
+    Lock(sync->publish_lock);
+    capturesync_outbox_publish_all(sync, outbox);
+    Unlock(sync->publish_lock);
+    capturesync_outbox_release_all(outbox);
+    capturesync_outbox_log_all(outbox);
+}
+
+static void capturesync_outbox_publish(capturesync_context_t *sync, capturesync_outbox_t *outbox, k4a_capture_t capture)
+{
+    if (outbox->publish_count == CAPTURESYNC_OUTBOX_SIZE)
+    {
+        capturesync_outbox_flush_locked(sync, outbox);
+    }
+    outbox->publish[outbox->publish_count++] = capture;
+}
+
+static void capturesync_outbox_release(capturesync_context_t *sync,
+                                       capturesync_outbox_t *outbox,
+                                       k4a_capture_t capture,
+                                       k4a_image_t image)
+{
+    if (outbox->release_capture_count == CAPTURESYNC_OUTBOX_SIZE ||
+        outbox->release_image_count == CAPTURESYNC_OUTBOX_SIZE)
+    {
+        capturesync_outbox_flush_locked(sync, outbox);
+    }
+    if (capture)
+    {
+        outbox->release_captures[outbox->release_capture_count++] = capture;
+    }
+    if (image)
+    {
+        outbox->release_images[outbox->release_image_count++] = image;
+    }
+}
+
+static capturesync_log_t *
+capturesync_outbox_log(capturesync_context_t *sync, capturesync_outbox_t *outbox, capturesync_log_type_t type)
+{
+    if (outbox->log_count == CAPTURESYNC_OUTBOX_SIZE)
+    {
+        capturesync_outbox_flush_locked(sync, outbox);
+    }
+    capturesync_log_t *log = &outbox->logs[outbox->log_count++];
+    memset(log, 0, sizeof(*log));
+    log->type = type;
+    return log;
+}
+
+static uint64_t capturesync_get_time_usec(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER qpc = { 0 }, freq = { 0 };
+    QueryPerformanceCounter(&qpc);
+    QueryPerformanceFrequency(&freq);
+    return (uint64_t)(qpc.QuadPart / freq.QuadPart * 1000000 + qpc.QuadPart % freq.QuadPart * 1000000 / freq.QuadPart);
+#else
+    struct timespec ts_time = { 0 };
+    clock_gettime(CLOCK_MONOTONIC, &ts_time);
+    return (uint64_t)ts_time.tv_sec * 1000000 + (uint64_t)ts_time.tv_nsec / 1000;
+#endif
+}
+
+/* Moves the IMU samples up to the device timestamp of capture into an image on the capture. The capture is timed by its
+ * depth or IR image, or its color image when it has neither. */
+static void capturesync_attach_imu_samples(capturesync_context_t *sync, k4a_capture_t capture)
+{
+    uint64_t ts = 0;
+    if (K4A_FAILED(sync->depth_ir.peek_typed_timestamp(capture, &ts)) &&
+        K4A_FAILED(capture_peek_color_image_timestamp(capture, &ts)))
+    {
+        return;
+    }
+
+    k4a_image_t image = NULL;
+    Lock(sync->imu_lock);
+    uint32_t count = 0;
+    while (count < sync->imu_count &&
+           sync->imu_samples[(sync->imu_first + count) % CAPTURESYNC_IMU_SAMPLE_DEPTH].acc_timestamp_usec <= ts)
+    {
+        count++;
+    }
+
+    if (count > 0)
+    {
+        int stride_bytes = (int)(count * sizeof(k4a_imu_sample_t));
+        if (K4A_SUCCEEDED(
+                image_create(K4A_IMAGE_FORMAT_CUSTOM, (int)count, 1, stride_bytes, ALLOCATION_SOURCE_IMU, &image)))
+        {
+            k4a_imu_sample_t *samples = (k4a_imu_sample_t *)image_get_buffer(image);
+            uint32_t first_run = CAPTURESYNC_IMU_SAMPLE_DEPTH - sync->imu_first;
+            if (first_run > count)
+            {
+                first_run = count;
+            }
+            memcpy(samples, &sync->imu_samples[sync->imu_first], first_run * sizeof(k4a_imu_sample_t));
+            memcpy(samples + first_run, sync->imu_samples, (count - first_run) * sizeof(k4a_imu_sample_t));
+        }
+
+        // Samples that could not be attached are dropped rather than attached to a later capture
+        sync->imu_first = (sync->imu_first + count) % CAPTURESYNC_IMU_SAMPLE_DEPTH;
+        sync->imu_count -= count;
+    }
+    Unlock(sync->imu_lock);
+
+    if (image != NULL)
+    {
+        image_set_device_timestamp_usec(image, ts);
+        capture_set_imu_samples_image(capture, image);
+        image_dec_ref(image);
+    }
+}
+
+void capturesync_add_imu_samples(capturesync_t capturesync_handle,
+                                 const k4a_imu_sample_t *samples,
+                                 size_t sample_count)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, capturesync_t, capturesync_handle);
+    RETURN_VALUE_IF_ARG(VOID_VALUE, samples == NULL && sample_count > 0);
+    capturesync_context_t *sync = capturesync_t_get_context(capturesync_handle);
+
+    if (!sync->attach_imu_samples || !sync->running)
+    {
+        return;
+    }
+
+    Lock(sync->imu_lock);
+    for (size_t i = 0; i < sample_count; i++)
+    {
+        if (sync->imu_count > 0)
+        {
+            uint32_t last = (sync->imu_first + sync->imu_count - 1) % CAPTURESYNC_IMU_SAMPLE_DEPTH;
+            if (samples[i].acc_timestamp_usec < sync->imu_samples[last].acc_timestamp_usec)
+            {
+                // The device timestamps were reset, the samples before would hold back every capture after
+                sync->imu_first = 0;
+                sync->imu_count = 0;
+            }
+        }
+
+        if (sync->imu_count == CAPTURESYNC_IMU_SAMPLE_DEPTH)
+        {
+            sync->imu_first = (sync->imu_first + 1) % CAPTURESYNC_IMU_SAMPLE_DEPTH;
+            sync->imu_count--;
+        }
+        sync->imu_samples[(sync->imu_first + sync->imu_count) % CAPTURESYNC_IMU_SAMPLE_DEPTH] = samples[i];
+        sync->imu_count++;
+    }
+    Unlock(sync->imu_lock);
+}
+
+static void capturesync_record_latency(capturesync_context_t *sync, uint64_t latency_usec)
+{
+    uint32_t bucket = 0;
+    while (bucket < CAPTURESYNC_LATENCY_BUCKETS - 1 && latency_usec >= ((uint64_t)1 << bucket))
+    {
+        bucket++;
+    }
+    k4a_atomic_add(&sync->latency_buckets[bucket], 1);
+
+    uint64_t max_usec = k4a_atomic_load64(&sync->latency_max_usec);
+    while (latency_usec > max_usec && !k4a_atomic_cas64(&sync->latency_max_usec, max_usec, latency_usec))
+    {
+        max_usec = k4a_atomic_load64(&sync->latency_max_usec);
+    }
+}
+
+// Latency of a capture from the time the host received its oldest image, in the clock of the image system timestamps
+static void capturesync_record_delivery(capturesync_context_t *sync, k4a_capture_t capture)
+{
+    k4a_image_t images[] = { capture_get_ir_image(capture), capture_get_color_image(capture) };
+    uint64_t system_timestamp_usec = 0;
+    for (size_t i = 0; i < COUNTOF(images); i++)
+    {
+        if (images[i] != NULL)
+        {
+            uint64_t timestamp_usec = image_get_system_timestamp_nsec(images[i]) / 1000;
+            if (timestamp_usec != 0 && (system_timestamp_usec == 0 || timestamp_usec < system_timestamp_usec))
+            {
+                system_timestamp_usec = timestamp_usec;
+            }
+            image_dec_ref(images[i]);
+        }
+    }
+
+    k4a_atomic_add64(&sync->delivered_capture_count, 1);
+    uint64_t now_usec = capturesync_get_time_usec();
+    if (k4a_atomic_load(&sync->first_capture_time_usec) == 0)
+    {
+        // 0 means no capture yet, so a first capture in the same microsecond as the start reports 1
+        uint64_t first_usec = now_usec > sync->start_time_usec ? now_usec - sync->start_time_usec : 1;
+        uint32_t expected = 0;
+        (void)k4a_atomic_cas(
+            &sync->first_capture_time_usec, expected, first_usec > UINT32_MAX ? UINT32_MAX : (uint32_t)first_usec);
+    }
+
+    if (system_timestamp_usec == 0)
+    {
+        // Captures created by the application for testing may not carry a system timestamp
+        return;
+    }
+
+    uint64_t latency_usec = now_usec > system_timestamp_usec ? now_usec - system_timestamp_usec : 0;
+    uint32_t latency = latency_usec > UINT32_MAX ? UINT32_MAX : (uint32_t)latency_usec;
+
+    uint32_t bucket = 0;
+    while (bucket < K4A_DEVICE_STATISTICS_LATENCY_BUCKETS - 1 && latency / 1000 >= ((uint32_t)1 << bucket))
+    {
+        bucket++;
+    }
+    k4a_atomic_add(&sync->delivery_latency_buckets[bucket], 1);
+    k4a_atomic_add64(&sync->total_delivery_latency_usec, latency);
+
+    uint32_t current = k4a_atomic_load(&sync->max_delivery_latency_usec);
+    while (latency > current && !k4a_atomic_cas(&sync->max_delivery_latency_usec, current, latency))
+    {
+        current = k4a_atomic_load(&sync->max_delivery_latency_usec);
+    }
+    current = k4a_atomic_load(&sync->min_delivery_latency_usec);
+    while (latency < current && !k4a_atomic_cas(&sync->min_delivery_latency_usec, current, latency))
+    {
+        current = k4a_atomic_load(&sync->min_delivery_latency_usec);
+    }
+}
+
+// Distance of a color and depth pair from the programmed depth_delay_off_color_usec, 0 is a perfect match
+static uint64_t capturesync_match_error(capturesync_context_t *sync, uint64_t color_ts, uint64_t depth_ts)
+{
+    int64_t error = (int64_t)depth_ts - (int64_t)color_ts - sync->depth_delay_off_color_usec;
+    return (uint64_t)(error < 0 ? -error : error);
+}
+
+// True if the pair falls within the sync window used by capturesync_add_capture()
+static bool capturesync_in_window(capturesync_context_t *sync, uint64_t color_ts, uint64_t depth_ts)
+{
+    if (sync->depth_delay_off_color_usec < 0)
+    {
+        uint64_t begin_sync_window = TS_SUBTRACT(depth_ts, sync->fps_1_quarter_period);
+        begin_sync_window = (uint64_t)TS_SUBTRACT((int64_t)begin_sync_window, sync->depth_delay_off_color_usec);
+        return color_ts >= begin_sync_window && color_ts <= begin_sync_window + sync->fps_period;
+    }
+
+    uint64_t begin_sync_window = TS_SUBTRACT(color_ts, sync->fps_1_quarter_period);
+    begin_sync_window = (uint64_t)TS_ADD((int64_t)begin_sync_window, sync->depth_delay_off_color_usec);
+    return depth_ts >= begin_sync_window && depth_ts <= begin_sync_window + sync->fps_period;
+}
+
+// Append capture, which the caller has a reference on, to the candidates following frame_info->capture
+static void frame_info_append_pending(frame_info_t *frame_info, k4a_capture_t capture)
+{
+    pending_capture_t *pending = &frame_info->pending[frame_info->pending_count++];
+    pending->capture = capture;
+    pending->ts = 0;
+    (void)frame_info->peek_typed_timestamp(capture, &pending->ts);
+}
+
+// Move the oldest pending candidate into the empty frame_info->capture slot
+static k4a_wait_result_t frame_info_promote_pending(frame_info_t *frame_info)
+{
+    frame_info->capture = frame_info->pending[0].capture;
+    frame_info->ts = frame_info->pending[0].ts;
+    frame_info->pending_count--;
+    memmove(&frame_info->pending[0], &frame_info->pending[1], frame_info->pending_count * sizeof(pending_capture_t));
+
+    frame_info->image = frame_info->get_typed_image(frame_info->capture);
+    if (frame_info->image == NULL)
+    {
+        (void)K4A_RESULT_FROM_BOOL(frame_info->image == NULL);
+        return K4A_WAIT_RESULT_FAILED;
+    }
+    return K4A_WAIT_RESULT_SUCCEEDED;
+}
+
+// Refill the pending candidates from the queue, stopping when it is empty
+static void frame_info_fill_pending(frame_info_t *frame_info)
+{
+    while (frame_info->capture != NULL && frame_info->pending_count + 1 < frame_info->window)
+    {
+        k4a_capture_t capture = NULL;
+        if (queue_pop(frame_info->queue, 0, &capture) != K4A_WAIT_RESULT_SUCCEEDED)
+        {
+            break;
+        }
+        frame_info_append_pending(frame_info, capture);
+    }
+}
+
 /**
  * This function is responsible for updating the information in either capturesync_context_t->depth_ir or in
  * capturesync_context_t->color. capturesync_context_t holds the capture, image, and ts for the sample we are currenly
@@ -67,8 +541,11 @@ K4A_DECLARE_CONTEXT(capturesync_t, capturesync_context_t);
  * This function is called when we want to refresh the data  depth_ir or color of frame_info_t. We do this by releasing
  * holds onthe memory we currently reference, and then poping a new value off the queue.
  */
-static void
-drop_sample(capturesync_context_t *sync, k4a_wait_result_t *wresult, bool color_capture, bool drop_into_queue)
+static void drop_sample(capturesync_context_t *sync,
+                        capturesync_outbox_t *outbox,
+                        k4a_wait_result_t *wresult,
+                        bool color_capture,
+                        bool drop_into_queue)
 {
 
     frame_info_t *frame_info = &sync->depth_ir;
@@ -81,25 +558,36 @@ drop_sample(capturesync_context_t *sync, k4a_wait_result_t *wresult, bool color_
     if (drop_into_queue)
     {
         // Log the capture being dropped on the floor
-        LOG_INFO("capturesync_drop, Dropping sample TS:%10lld type:%s",
-                 frame_info->ts,
-                 color_capture ? "Color" : "Depth");
+        capturesync_log_t *log = capturesync_outbox_log(sync, outbox, CAPTURESYNC_LOG_DROP);
+        log->ts = frame_info->ts;
+        log->color_capture = color_capture;
 
         // If drop_into_queue is provided, then that caller wants the capture to placed into the provided queue, if no
         // drop_into_queue is provided, then it is dropped on the floor
         if (!sync->synchronized_images_only)
         {
-            queue_push(sync->sync_queue, frame_info->capture);
+            capturesync_outbox_publish(sync, outbox, frame_info->capture);
+        }
+        else
+        {
+            k4a_atomic_add(&sync->dropped_count, 1);
         }
     }
 
-    capture_dec_ref(frame_info->capture);
+    capturesync_outbox_release(sync, outbox, frame_info->capture, frame_info->image);
     frame_info->capture = NULL;
-
-    image_dec_ref(frame_info->image);
     frame_info->image = NULL;
 
-    if (*wresult != K4A_WAIT_RESULT_FAILED)
+    if (*wresult != K4A_WAIT_RESULT_FAILED && frame_info->pending_count != 0)
+    {
+        // The next candidate is already at hand, top the candidates back up from the queue behind it
+        *wresult = frame_info_promote_pending(frame_info);
+        if (*wresult == K4A_WAIT_RESULT_SUCCEEDED)
+        {
+            frame_info_fill_pending(frame_info);
+        }
+    }
+    else if (*wresult != K4A_WAIT_RESULT_FAILED)
     {
         *wresult = queue_pop(frame_info->queue, 0, &frame_info->capture);
         if (*wresult == K4A_WAIT_RESULT_SUCCEEDED)
@@ -115,40 +603,47 @@ drop_sample(capturesync_context_t *sync, k4a_wait_result_t *wresult, bool color_
         if (*wresult == K4A_WAIT_RESULT_SUCCEEDED)
         {
             frame_info->ts = image_get_device_timestamp_usec(frame_info->image);
+            frame_info_fill_pending(frame_info);
         }
     }
 
     if (*wresult != K4A_WAIT_RESULT_SUCCEEDED)
     {
-        if (frame_info->capture)
-        {
-            capture_dec_ref(frame_info->capture);
-        }
-        if (frame_info->image)
-        {
-            image_dec_ref(frame_info->image);
-        }
+        capturesync_outbox_release(sync, outbox, frame_info->capture, frame_info->image);
         frame_info->capture = NULL;
         frame_info->image = NULL;
         frame_info->ts = 0;
     }
 }
 
-static void replace_sample(capturesync_context_t *sync, k4a_capture_t capture_new, frame_info_t *frame_info)
+static void replace_sample(capturesync_context_t *sync,
+                           capturesync_outbox_t *outbox,
+                           k4a_capture_t capture_new,
+                           frame_info_t *frame_info)
 {
     // Log the capture being dropped
-    LOG_ERROR("capturesync_drop, releasing capture early due to full queue TS:%10lld type:%s",
-              frame_info->ts,
-              frame_info->color_capture ? "Color" : "Depth");
+    capturesync_log_t *log = capturesync_outbox_log(sync, outbox, CAPTURESYNC_LOG_RELEASE_EARLY);
+    log->ts = frame_info->ts;
+    log->color_capture = frame_info->color_capture;
 
     if (!sync->synchronized_images_only)
     {
-        queue_push(sync->sync_queue, frame_info->capture);
+        capturesync_outbox_publish(sync, outbox, frame_info->capture);
     }
-    capture_dec_ref(frame_info->capture);
-    image_dec_ref(frame_info->image);
+    else
+    {
+        k4a_atomic_add(&sync->dropped_count, 1);
+    }
+    capturesync_outbox_release(sync, outbox, frame_info->capture, frame_info->image);
 
-    if (frame_info->capture)
+    if (frame_info->capture && frame_info->pending_count != 0)
+    {
+        // capture_new is the oldest capture from the queue, so it goes behind the pending candidates
+        frame_info->capture = NULL;
+        (void)frame_info_promote_pending(frame_info);
+        frame_info_append_pending(frame_info, capture_new);
+    }
+    else if (frame_info->capture)
     {
         frame_info->capture = capture_new;
         frame_info->image = frame_info->get_typed_image(capture_new);
@@ -164,15 +659,14 @@ static void replace_sample(capturesync_context_t *sync, k4a_capture_t capture_ne
 
 /* Callers of this function still ned to call capture_dec_ref on depth and color captures when they are done using the
  * captures */
-static k4a_capture_t merge_captures(k4a_capture_t depth, k4a_capture_t color)
+static k4a_capture_t merge_captures(frame_info_t *depth, frame_info_t *color)
 {
     // We merge color into depth because its slightly more efficient to link 1 color image than it is for a depth and IR
-    // images.
-    k4a_image_t image = capture_get_color_image(color);
-    (void)K4A_RESULT_FROM_BOOL(image != NULL);
-    capture_set_color_image(depth, image);
-    image_dec_ref(image);
-    return depth;
+    // images. The depth capture is adopted as the synchronized capture, so no new capture is created. We already hold a
+    // reference to the color image, so it is linked directly rather than fetched from the color capture again.
+    (void)K4A_RESULT_FROM_BOOL(color->image != NULL);
+    capture_set_color_image(depth->capture, color->image);
+    return depth->capture;
 }
 
 void capturesync_add_capture(capturesync_t capturesync_handle,
@@ -185,6 +679,13 @@ void capturesync_add_capture(capturesync_t capturesync_handle,
     k4a_result_t result;
     bool locked = false;
     uint64_t ts_raw_capture = 0;
+    uint64_t start_usec = capturesync_get_time_usec();
+    capturesync_outbox_t outbox;
+
+    outbox.publish_count = 0;
+    outbox.release_capture_count = 0;
+    outbox.release_image_count = 0;
+    outbox.log_count = 0;
 
     result = K4A_RESULT_FROM_BOOL(capturesync_handle != NULL);
     if (K4A_SUCCEEDED(result))
@@ -213,24 +714,21 @@ void capturesync_add_capture(capturesync_t capturesync_handle,
         result = K4A_RESULT_FROM_BOOL(capture_raw != NULL);
     }
 
+    if (K4A_SUCCEEDED(result))
+    {
+        k4a_atomic_add64(color_capture ? &sync->color_capture_count : &sync->depth_capture_count, 1);
+    }
+
     // Read the timestamp of the raw sample
     if (K4A_SUCCEEDED(result))
     {
-        k4a_image_t image = NULL;
         if (color_capture)
         {
-            image = capture_get_color_image(capture_raw);
+            result = capture_peek_color_image_timestamp(capture_raw, &ts_raw_capture);
         }
         else
         {
-            image = capture_get_ir_image(capture_raw);
-        }
-        result = K4A_RESULT_FROM_BOOL(image != NULL);
-        if (K4A_SUCCEEDED(result))
-        {
-            ts_raw_capture = image_get_device_timestamp_usec(image);
-            image_dec_ref(image);
-            image = NULL;
+            result = capture_peek_ir_image_timestamp(capture_raw, &ts_raw_capture);
         }
     }
 
@@ -245,17 +743,17 @@ void capturesync_add_capture(capturesync_t capturesync_handle,
     {
         if (sync->enable_ts_logging)
         {
-            LOG_INFO("capturesync_ts, Arriving capture, TS:%10lld, %s, Color TS:%10lld, Depth TS:%10lld",
-                     ts_raw_capture,
-                     color_capture ? "Color " : "Depth ",
-                     sync->color.ts,
-                     sync->depth_ir.ts);
+            capturesync_log_t *log = capturesync_outbox_log(sync, &outbox, CAPTURESYNC_LOG_ARRIVING);
+            log->ts = ts_raw_capture;
+            log->color_capture = color_capture;
+            log->color_ts = sync->color.ts;
+            log->depth_ts = sync->depth_ir.ts;
         }
 
         if (sync->sync_captures == false || sync->disable_sync == true)
         {
             // we are not synchronizing samples, just copy to the queue
-            queue_push(sync->sync_queue, capture_raw);
+            capturesync_outbox_publish(sync, &outbox, capture_raw);
             result = K4A_RESULT_FAILED; // Not an error, just a graceful exit
         }
         else if (!color_capture && sync->waiting_for_clean_depth_ts)
@@ -265,6 +763,7 @@ void capturesync_add_capture(capturesync_t capturesync_handle,
             if (ts_raw_capture / sync->fps_period > 10)
             {
                 sync->depth_captures_dropped++;
+                k4a_atomic_add(&sync->dropped_count, 1);
                 result = K4A_RESULT_FAILED; // Not an error, just a graceful exit
             }
             else
@@ -273,8 +772,8 @@ void capturesync_add_capture(capturesync_t capturesync_handle,
                 sync->waiting_for_clean_depth_ts = false;
                 if (sync->depth_captures_dropped)
                 {
-                    LOG_INFO("Dropped %d depth captures waiting for time stamps to stabilize",
-                             sync->depth_captures_dropped);
+                    capturesync_log_t *log = capturesync_outbox_log(sync, &outbox, CAPTURESYNC_LOG_DEPTH_STABLE);
+                    log->dropped = sync->depth_captures_dropped;
                 }
             }
         }
@@ -292,11 +791,18 @@ void capturesync_add_capture(capturesync_t capturesync_handle,
         {
             assert(frame_info->image == 0); // Both capture and image should be NULL
             frame_info->image = frame_info->get_typed_image(capture_raw);
-            frame_info->ts = image_get_device_timestamp_usec(frame_info->image);
+            frame_info->ts = ts_raw_capture;
             frame_info->capture = capture_raw;
             capture_inc_ref(capture_raw);
             capture_raw = NULL;
         }
+        else if (frame_info->pending_count + 1 < frame_info->window)
+        {
+            // Keep it as a candidate for best-match pairing
+            capture_inc_ref(capture_raw);
+            frame_info_append_pending(frame_info, capture_raw);
+            capture_raw = NULL;
+        }
         else
         {
             // Store the capture in our internal queue
@@ -306,7 +812,7 @@ void capturesync_add_capture(capturesync_t capturesync_handle,
             {
                 // If the internal queue is full, then we publish the oldest frame as we can no longer store it.
                 // The user will interpret this a capture that is either depth or color, but not both
-                replace_sample(sync, dropped_sample, frame_info);
+                replace_sample(sync, &outbox, dropped_sample, frame_info);
             }
         }
 
@@ -326,13 +832,13 @@ void capturesync_add_capture(capturesync_t capturesync_handle,
                 if (sync->color.ts > end_sync_window)
                 {
                     // Drop depth_cap because color is beyond 1 period away
-                    drop_sample(sync, &wresult, DEPTH_CAPTURE, true);
+                    drop_sample(sync, &outbox, &wresult, DEPTH_CAPTURE, true);
                     continue;
                 }
                 else if (sync->color.ts < begin_sync_window)
                 {
                     // Drop color sample because it happened before this frame window
-                    drop_sample(sync, &wresult, COLOR_CAPTURE, true);
+                    drop_sample(sync, &outbox, &wresult, COLOR_CAPTURE, true);
                     continue;
                 }
             }
@@ -350,32 +856,56 @@ void capturesync_add_capture(capturesync_t capturesync_handle,
                 if (sync->depth_ir.ts > end_sync_window)
                 {
                     // Drop color_cap because depth is beyond 1 period away
-                    drop_sample(sync, &wresult, COLOR_CAPTURE, true);
+                    drop_sample(sync, &outbox, &wresult, COLOR_CAPTURE, true);
                     continue;
                 }
                 else if (sync->depth_ir.ts < begin_sync_window)
                 {
                     // Drop depth sample because it happened before this frame window
-                    drop_sample(sync, &wresult, DEPTH_CAPTURE, true);
+                    drop_sample(sync, &outbox, &wresult, DEPTH_CAPTURE, true);
                     continue;
                 }
             }
 
+            // Both are within the sync window, but a candidate that arrived after either of them may also be within it
+            // and be a closer match. Timestamps only increase, so once the next candidate is worse no later one can
+            // be better, and a pair is published as soon as neither side has a better candidate waiting.
+            uint64_t match_error = capturesync_match_error(sync, sync->color.ts, sync->depth_ir.ts);
+            if (sync->color.pending_count != 0 &&
+                capturesync_in_window(sync, sync->color.pending[0].ts, sync->depth_ir.ts) &&
+                capturesync_match_error(sync, sync->color.pending[0].ts, sync->depth_ir.ts) < match_error)
+            {
+                drop_sample(sync, &outbox, &wresult, COLOR_CAPTURE, true);
+                continue;
+            }
+            if (sync->depth_ir.pending_count != 0 &&
+                capturesync_in_window(sync, sync->color.ts, sync->depth_ir.pending[0].ts) &&
+                capturesync_match_error(sync, sync->color.ts, sync->depth_ir.pending[0].ts) < match_error)
+            {
+                drop_sample(sync, &outbox, &wresult, DEPTH_CAPTURE, true);
+                continue;
+            }
+
             if (sync->color.capture != NULL && sync->depth_ir.capture != NULL)
             {
                 if (sync->enable_ts_logging)
                 {
-                    LOG_INFO("capturesync_link,TS_Color, %10lld, TS_Depth, %10lld,", sync->color.ts, sync->depth_ir.ts);
+                    capturesync_log_t *log = capturesync_outbox_log(sync, &outbox, CAPTURESYNC_LOG_LINK);
+                    log->color_ts = sync->color.ts;
+                    log->depth_ts = sync->depth_ir.ts;
                 }
 
-                k4a_capture_t merged = merge_captures(sync->depth_ir.capture, sync->color.capture);
-                queue_push(sync->sync_queue, merged);
+                TRACE_INSTANT("capturesync match",
+                              tracing_is_enabled() ? image_get_system_timestamp_nsec(sync->depth_ir.image) : 0);
+                k4a_capture_t merged = merge_captures(&sync->depth_ir, &sync->color);
+                k4a_atomic_add64(&sync->synchronized_capture_count, 1);
+                capturesync_outbox_publish(sync, &outbox, merged);
                 merged = NULL; // No need to call capture_dec_ref() here.
 
-                // Use drop symantic to get another sample from the queue if present. Synchronized sample is
-                // already in output queue and has its own ref
-                drop_sample(sync, &wresult, COLOR_CAPTURE, false);
-                drop_sample(sync, &wresult, DEPTH_CAPTURE, false);
+                // Use drop symantic to get another sample from the queue if present. The synchronized sample is
+                // published before the outbox releases the depth capture's ref, and gets its own ref from the queue
+                drop_sample(sync, &outbox, &wresult, COLOR_CAPTURE, false);
+                drop_sample(sync, &outbox, &wresult, DEPTH_CAPTURE, false);
                 continue;
             }
 
@@ -389,8 +919,22 @@ void capturesync_add_capture(capturesync_t capturesync_handle,
 
     if (locked)
     {
+        // Hand over to publish_lock so the next arrival can start matching while we publish, but cannot publish
+        // ahead of us
+        Lock(sync->publish_lock);
         Unlock(sync->lock);
         locked = false;
+
+        capturesync_outbox_publish_all(sync, &outbox);
+        Unlock(sync->publish_lock);
+    }
+
+    capturesync_outbox_release_all(&outbox);
+    capturesync_outbox_log_all(&outbox);
+
+    if (sync != NULL)
+    {
+        capturesync_record_latency(sync, capturesync_get_time_usec() - start_usec);
     }
 }
 
@@ -403,10 +947,16 @@ k4a_result_t capturesync_create(capturesync_t *capturesync_handle)
 
     sync->color.color_capture = true;
     sync->color.get_typed_image = capture_get_color_image;
+    sync->color.peek_typed_timestamp = capture_peek_color_image_timestamp;
+    sync->color.window = CAPTURESYNC_DEFAULT_WINDOW;
 
     // In this module we can either use depth or color, we are only after the timestamp which is the same on both.
     sync->depth_ir.color_capture = false;
     sync->depth_ir.get_typed_image = capture_get_ir_image;
+    sync->depth_ir.peek_typed_timestamp = capture_peek_ir_image_timestamp;
+    sync->depth_ir.window = CAPTURESYNC_DEFAULT_WINDOW;
+
+    sync->min_delivery_latency_usec = UINT32_MAX;
 
     if (K4A_SUCCEEDED(result))
     {
@@ -416,17 +966,29 @@ k4a_result_t capturesync_create(capturesync_t *capturesync_handle)
 
     if (K4A_SUCCEEDED(result))
     {
-        result = TRACE_CALL(queue_create(QUEUE_DEFAULT_SIZE, "Queue_depth", &sync->depth_ir.queue));
+        sync->publish_lock = Lock_Init();
+        result = K4A_RESULT_FROM_BOOL(sync->publish_lock != NULL);
     }
 
     if (K4A_SUCCEEDED(result))
     {
-        result = TRACE_CALL(queue_create(QUEUE_DEFAULT_SIZE, "Queue_color", &sync->color.queue));
+        sync->imu_lock = Lock_Init();
+        result = K4A_RESULT_FROM_BOOL(sync->imu_lock != NULL);
     }
 
     if (K4A_SUCCEEDED(result))
     {
-        result = TRACE_CALL(queue_create(QUEUE_DEFAULT_SIZE / 2, "Queue_capture", &sync->sync_queue));
+        result = TRACE_CALL(queue_create_lockfree(QUEUE_DEFAULT_SIZE, "Queue_depth", &sync->depth_ir.queue));
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        result = TRACE_CALL(queue_create_lockfree(QUEUE_DEFAULT_SIZE, "Queue_color", &sync->color.queue));
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        result = TRACE_CALL(queue_create_lockfree(CAPTURESYNC_CAPTURE_QUEUE_DEPTH, "Queue_capture", &sync->sync_queue));
     }
 
     if (K4A_SUCCEEDED(result))
@@ -442,6 +1004,23 @@ k4a_result_t capturesync_create(capturesync_t *capturesync_handle)
         sync->disable_sync = true;
     }
 
+    const char *sync_window = environment_get_variable("K4A_CAPTURESYNC_WINDOW");
+    if (sync_window != NULL && sync_window[0] != '\0')
+    {
+        uint32_t window = (uint32_t)strtoul(sync_window, NULL, 10);
+        if (window >= 1 && window <= CAPTURESYNC_MAX_WINDOW)
+        {
+            sync->color.window = window;
+            sync->depth_ir.window = window;
+        }
+        else
+        {
+            LOG_WARNING("Ignoring K4A_CAPTURESYNC_WINDOW=%s, the window must be 1 to %d",
+                        sync_window,
+                        CAPTURESYNC_MAX_WINDOW);
+        }
+    }
+
     const char *enable_ts_logging = environment_get_variable("K4A_ENABLE_TS_LOGGING");
     if (enable_ts_logging != NULL && enable_ts_logging[0] != '\0' && enable_ts_logging[0] != '0')
     {
@@ -478,15 +1057,31 @@ void capturesync_destroy(capturesync_t capturesync_handle)
     }
 
     Lock_Deinit(sync->lock);
+    if (sync->publish_lock)
+    {
+        Lock_Deinit(sync->publish_lock);
+    }
+    if (sync->imu_lock)
+    {
+        Lock_Deinit(sync->imu_lock);
+    }
+    free(sync->imu_samples);
     capturesync_t_destroy(capturesync_handle);
 }
 
-k4a_result_t capturesync_start(capturesync_t capturesync_handle, const k4a_device_configuration_t *config)
+k4a_result_t capturesync_start(capturesync_t capturesync_handle,
+                               const k4a_device_configuration_t *config,
+                               const k4a_device_start_options_t *options)
 {
     RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, capturesync_t, capturesync_handle);
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, config == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, options == NULL);
     capturesync_context_t *sync = capturesync_t_get_context(capturesync_handle);
 
+    // A repeated start from k4a_device_set_depth_mode() runs while the color and depth callbacks read these, so they
+    // are changed under the lock the callbacks match captures with
+    Lock(sync->lock);
+
     // Reset frames to drop
     sync->waiting_for_clean_depth_ts = true;
     sync->synchronized_images_only = config->synchronized_images_only;
@@ -503,14 +1098,65 @@ k4a_result_t capturesync_start(capturesync_t capturesync_handle, const k4a_devic
         sync->sync_captures = false;
     }
 
-    queue_enable(sync->color.queue);
-    queue_enable(sync->depth_ir.queue);
-    queue_enable(sync->sync_queue);
+    Unlock(sync->lock);
+
+    uint32_t capture_queue_depth = options->capture_queue_depth;
+    if (options->latest_capture_only)
+    {
+        // A full queue of one drops the queued capture for the new one
+        capture_queue_depth = 1;
+    }
+    else if (capture_queue_depth == 0)
+    {
+        capture_queue_depth = CAPTURESYNC_CAPTURE_QUEUE_DEPTH;
+    }
+    k4a_result_t result = K4A_RESULT_SUCCEEDED;
+    if (!sync->running)
+    {
+        // The queue can only be resized while disabled, a repeated start keeps the running configuration
+        sync->capture_queue_policy = options->capture_queue_policy;
+        result = TRACE_CALL(queue_configure(sync->sync_queue, capture_queue_depth, options->capture_queue_policy));
 
-    // Not taking the lock as we don't need to synchronize this on start
-    sync->running = true;
+        sync->start_time_usec = capturesync_get_time_usec();
+        k4a_atomic_store(&sync->first_capture_time_usec, 0);
 
-    return K4A_RESULT_SUCCEEDED;
+        // Depth captures without an IR image are matched by their depth image
+        bool depth_without_ir = options->depth_image_only || options->raw_depth_payload;
+        sync->depth_ir.get_typed_image = depth_without_ir ? capture_get_depth_image : capture_get_ir_image;
+        sync->depth_ir.peek_typed_timestamp = depth_without_ir ? capture_peek_depth_image_timestamp :
+                                                                 capture_peek_ir_image_timestamp;
+
+        if (options->attach_imu_samples && sync->imu_samples == NULL)
+        {
+            sync->imu_samples = (k4a_imu_sample_t *)malloc(CAPTURESYNC_IMU_SAMPLE_DEPTH * sizeof(k4a_imu_sample_t));
+            if (sync->imu_samples == NULL)
+            {
+                LOG_ERROR("Failed to allocate the IMU samples to attach to captures", 0);
+                result = K4A_RESULT_FAILED;
+            }
+        }
+
+        // Samples from before this start would be attached to the first capture
+        Lock(sync->imu_lock);
+        sync->imu_first = 0;
+        sync->imu_count = 0;
+        Unlock(sync->imu_lock);
+        sync->attach_imu_samples = K4A_SUCCEEDED(result) && options->attach_imu_samples;
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        queue_enable(sync->color.queue);
+        queue_enable(sync->depth_ir.queue);
+        queue_enable(sync->sync_queue);
+
+        // A repeated start runs alongside the callbacks, which check running under the lock
+        Lock(sync->lock);
+        sync->running = true;
+        Unlock(sync->lock);
+    }
+
+    return result;
 }
 
 void capturesync_stop(capturesync_t capturesync_handle)
@@ -521,6 +1167,16 @@ void capturesync_stop(capturesync_t capturesync_handle)
     Lock(sync->lock);
     sync->running = false;
 
+    if (sync->sync_queue && sync->capture_queue_policy == K4A_QUEUE_POLICY_BLOCK)
+    {
+        // An arrival may be publishing into a full sync_queue, disabling it releases the push
+        queue_disable(sync->sync_queue);
+    }
+
+    // Let an arrival that is still publishing finish before the queues are disabled
+    Lock(sync->publish_lock);
+    Unlock(sync->publish_lock);
+
     if (sync->color.queue)
     {
         queue_disable(sync->color.queue);
@@ -559,6 +1215,18 @@ void capturesync_stop(capturesync_t capturesync_handle)
         image_dec_ref(sync->depth_ir.image);
         sync->depth_ir.image = NULL;
     }
+
+    for (uint32_t i = 0; i < sync->color.pending_count; i++)
+    {
+        capture_dec_ref(sync->color.pending[i].capture);
+    }
+    sync->color.pending_count = 0;
+
+    for (uint32_t i = 0; i < sync->depth_ir.pending_count; i++)
+    {
+        capture_dec_ref(sync->depth_ir.pending[i].capture);
+    }
+    sync->depth_ir.pending_count = 0;
     Unlock(sync->lock);
 }
 
@@ -575,7 +1243,129 @@ k4a_wait_result_t capturesync_get_capture(capturesync_t capturesync_handle,
     k4a_wait_result_t wresult = queue_pop(sync->sync_queue, timeout_in_ms, &capture_handle);
     if (wresult == K4A_WAIT_RESULT_SUCCEEDED)
     {
+        capturesync_record_delivery(sync, capture_handle);
         *capture = capture_handle;
     }
     return wresult;
 }
+
+k4a_result_t capturesync_get_wait_handle(capturesync_t capturesync_handle, k4a_wait_handle_t *wait_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, capturesync_t, capturesync_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, wait_handle == NULL);
+    capturesync_context_t *sync = capturesync_t_get_context(capturesync_handle);
+
+    return TRACE_CALL(queue_get_wait_handle(sync->sync_queue, wait_handle));
+}
+
+k4a_result_t capturesync_get_dropped_counts(capturesync_t capturesync_handle,
+                                            uint32_t *sync_dropped_count,
+                                            uint32_t *queue_dropped_count)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, capturesync_t, capturesync_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, sync_dropped_count == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, queue_dropped_count == NULL);
+    capturesync_context_t *sync = capturesync_t_get_context(capturesync_handle);
+
+    *sync_dropped_count = k4a_atomic_load(&sync->dropped_count);
+    *queue_dropped_count = queue_get_dropped_count(sync->sync_queue);
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t capturesync_get_statistics(capturesync_t capturesync_handle, k4a_device_statistics_t *statistics)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, capturesync_t, capturesync_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, statistics == NULL);
+    capturesync_context_t *sync = capturesync_t_get_context(capturesync_handle);
+
+    statistics->capturesync_dropped_count = k4a_atomic_load(&sync->dropped_count);
+    statistics->capture_queue_dropped_count = queue_get_dropped_count(sync->sync_queue);
+    statistics->depth_capture_count = k4a_atomic_load64(&sync->depth_capture_count);
+    statistics->color_capture_count = k4a_atomic_load64(&sync->color_capture_count);
+    statistics->synchronized_capture_count = k4a_atomic_load64(&sync->synchronized_capture_count);
+    statistics->delivered_capture_count = k4a_atomic_load64(&sync->delivered_capture_count);
+    statistics->first_capture_time_usec = k4a_atomic_load(&sync->first_capture_time_usec);
+
+    // Deliveries without a system timestamp are counted but carry no latency
+    uint64_t latency_count = 0;
+    for (int i = 0; i < K4A_DEVICE_STATISTICS_LATENCY_BUCKETS; i++)
+    {
+        statistics->capture_latency_histogram[i] = k4a_atomic_load(&sync->delivery_latency_buckets[i]);
+        latency_count += statistics->capture_latency_histogram[i];
+    }
+    if (latency_count != 0)
+    {
+        statistics->capture_latency_min_usec = k4a_atomic_load(&sync->min_delivery_latency_usec);
+        statistics->capture_latency_average_usec =
+            (uint32_t)(k4a_atomic_load64(&sync->total_delivery_latency_usec) / latency_count);
+        statistics->capture_latency_max_usec = k4a_atomic_load(&sync->max_delivery_latency_usec);
+    }
+    else
+    {
+        statistics->capture_latency_min_usec = 0;
+        statistics->capture_latency_average_usec = 0;
+        statistics->capture_latency_max_usec = 0;
+    }
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t capturesync_get_latency_histogram(capturesync_t capturesync_handle,
+                                               capturesync_latency_histogram_t *histogram)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, capturesync_t, capturesync_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, histogram == NULL);
+    capturesync_context_t *sync = capturesync_t_get_context(capturesync_handle);
+
+    for (int i = 0; i < CAPTURESYNC_LATENCY_BUCKETS; i++)
+    {
+        histogram->count[i] = k4a_atomic_load(&sync->latency_buckets[i]);
+    }
+    histogram->max_usec = k4a_atomic_load64(&sync->latency_max_usec);
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t capturesync_set_window(capturesync_t capturesync_handle, uint32_t color_window, uint32_t depth_window)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, capturesync_t, capturesync_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, color_window < 1 || color_window > CAPTURESYNC_MAX_WINDOW);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, depth_window < 1 || depth_window > CAPTURESYNC_MAX_WINDOW);
+    capturesync_context_t *sync = capturesync_t_get_context(capturesync_handle);
+    k4a_result_t result = K4A_RESULT_SUCCEEDED;
+
+    Lock(sync->lock);
+    if (sync->running)
+    {
+        LOG_ERROR("The capture sync window can't be changed while streaming", 0);
+        result = K4A_RESULT_FAILED;
+    }
+    else
+    {
+        sync->color.window = color_window;
+        sync->depth_ir.window = depth_window;
+    }
+    Unlock(sync->lock);
+
+    return result;
+}
+
+k4a_result_t capturesync_set_callback(capturesync_t capturesync_handle, k4a_capture_ready_cb_t *callback, void *context)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, capturesync_t, capturesync_handle);
+    capturesync_context_t *sync = capturesync_t_get_context(capturesync_handle);
+    k4a_result_t result = K4A_RESULT_SUCCEEDED;
+
+    Lock(sync->lock);
+    if (sync->running)
+    {
+        LOG_ERROR("The capture callback can't be changed while streaming", 0);
+        result = K4A_RESULT_FAILED;
+    }
+    else
+    {
+        sync->callback = callback;
+        sync->callback_context = callback == NULL ? NULL : context;
+    }
+    Unlock(sync->lock);
+
+    return result;
+}
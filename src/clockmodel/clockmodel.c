@@ -0,0 +1,300 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// This library
+#include <k4ainternal/clockmodel.h>
+
+// Dependent libraries
+#include <k4ainternal/handle.h>
+#include <k4ainternal/logging.h>
+#include <k4ainternal/common.h>
+
+#include <azure_c_shared_utility/lock.h>
+
+// System dependencies
+#include <math.h>
+#include <stdbool.h>
+#include <string.h>
+
+// Each window of device time contributes its least delayed sample to the fit. A window spans many frames, so one of
+// them has most likely seen no scheduling delay.
+#define CLOCKMODEL_WINDOW_USEC 1000000
+
+// Windows the line is fitted to. Crystal drift changes slowly with temperature, so a minute of history averages out
+// the remaining jitter while following the drift.
+#define CLOCKMODEL_WINDOW_COUNT 60
+
+typedef struct _clockmodel_point_t
+{
+    uint64_t device_timestamp_usec;
+    int64_t offset_nsec; // System timestamp minus device timestamp
+} clockmodel_point_t;
+
+typedef struct _clockmodel_context_t
+{
+    LOCK_HANDLE lock;
+
+    // Least delayed sample of each completed window, oldest first from window_first
+    clockmodel_point_t windows[CLOCKMODEL_WINDOW_COUNT];
+    uint32_t window_first;
+    uint32_t window_count;
+
+    // The window samples are being added to
+    bool window_open;
+    uint64_t window_start_usec;
+    clockmodel_point_t window_min;
+
+    uint64_t last_device_timestamp_usec;
+    uint64_t sample_count;
+
+    // Fit of the windows: offset = reference_offset_nsec + slope * (device timestamp - reference)
+    uint64_t reference_device_timestamp_usec;
+    double reference_offset_nsec;
+    double slope_nsec_per_usec;
+    double residual_usec;
+} clockmodel_context_t;
+
+K4A_DECLARE_CONTEXT(clockmodel_t, clockmodel_context_t);
+
+k4a_result_t clockmodel_create(clockmodel_t *clockmodel_handle)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, clockmodel_handle == NULL);
+
+    clockmodel_context_t *clockmodel = clockmodel_t_create(clockmodel_handle);
+    k4a_result_t result = K4A_RESULT_FROM_BOOL(clockmodel != NULL);
+
+    if (K4A_SUCCEEDED(result))
+    {
+        clockmodel->lock = Lock_Init();
+        result = K4A_RESULT_FROM_BOOL(clockmodel->lock != NULL);
+    }
+
+    if (K4A_FAILED(result))
+    {
+        clockmodel_destroy(*clockmodel_handle);
+        *clockmodel_handle = NULL;
+    }
+
+    return result;
+}
+
+void clockmodel_destroy(clockmodel_t clockmodel_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, clockmodel_t, clockmodel_handle);
+    clockmodel_context_t *clockmodel = clockmodel_t_get_context(clockmodel_handle);
+
+    if (clockmodel->lock)
+    {
+        Lock_Deinit(clockmodel->lock);
+    }
+    clockmodel_t_destroy(clockmodel_handle);
+}
+
+static void clockmodel_reset_locked(clockmodel_context_t *clockmodel)
+{
+    clockmodel->window_first = 0;
+    clockmodel->window_count = 0;
+    clockmodel->window_open = false;
+    clockmodel->last_device_timestamp_usec = 0;
+    clockmodel->sample_count = 0;
+}
+
+void clockmodel_reset(clockmodel_t clockmodel_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, clockmodel_t, clockmodel_handle);
+    clockmodel_context_t *clockmodel = clockmodel_t_get_context(clockmodel_handle);
+
+    Lock(clockmodel->lock);
+    clockmodel_reset_locked(clockmodel);
+    Unlock(clockmodel->lock);
+}
+
+// Fits a line through the completed windows and the open one, by least squares relative to the open window so the
+// model is most accurate for the newest timestamps.
+static void clockmodel_fit_locked(clockmodel_context_t *clockmodel)
+{
+    const clockmodel_point_t *reference = &clockmodel->window_min;
+    uint32_t count = clockmodel->window_count + 1;
+
+    double sum_x = 0;
+    double sum_y = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const clockmodel_point_t *point =
+            i < clockmodel->window_count ?
+                &clockmodel->windows[(clockmodel->window_first + i) % CLOCKMODEL_WINDOW_COUNT] :
+                reference;
+        sum_x += (double)point->device_timestamp_usec - (double)reference->device_timestamp_usec;
+        sum_y += (double)(point->offset_nsec - reference->offset_nsec);
+    }
+    double mean_x = sum_x / count;
+    double mean_y = sum_y / count;
+
+    double sum_xx = 0;
+    double sum_xy = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const clockmodel_point_t *point =
+            i < clockmodel->window_count ?
+                &clockmodel->windows[(clockmodel->window_first + i) % CLOCKMODEL_WINDOW_COUNT] :
+                reference;
+        double x = (double)point->device_timestamp_usec - (double)reference->device_timestamp_usec - mean_x;
+        double y = (double)(point->offset_nsec - reference->offset_nsec) - mean_y;
+        sum_xx += x * x;
+        sum_xy += x * y;
+    }
+
+    // A single window, or windows too close together, only give the offset
+    double slope = sum_xx > 0 ? sum_xy / sum_xx : 0;
+    double intercept = mean_y - slope * mean_x;
+
+    double sum_squares = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const clockmodel_point_t *point =
+            i < clockmodel->window_count ?
+                &clockmodel->windows[(clockmodel->window_first + i) % CLOCKMODEL_WINDOW_COUNT] :
+                reference;
+        double x = (double)point->device_timestamp_usec - (double)reference->device_timestamp_usec;
+        double error = (double)(point->offset_nsec - reference->offset_nsec) - (intercept + slope * x);
+        sum_squares += error * error;
+    }
+
+    clockmodel->reference_device_timestamp_usec = reference->device_timestamp_usec;
+    clockmodel->reference_offset_nsec = (double)reference->offset_nsec + intercept;
+    clockmodel->slope_nsec_per_usec = slope;
+    clockmodel->residual_usec = sqrt(sum_squares / count) / 1000;
+}
+
+void clockmodel_add_sample(clockmodel_t clockmodel_handle,
+                           uint64_t device_timestamp_usec,
+                           uint64_t system_timestamp_nsec)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, clockmodel_t, clockmodel_handle);
+    clockmodel_context_t *clockmodel = clockmodel_t_get_context(clockmodel_handle);
+
+    if (system_timestamp_nsec == 0 || system_timestamp_nsec > INT64_MAX || device_timestamp_usec > INT64_MAX / 1000)
+    {
+        return;
+    }
+
+    clockmodel_point_t sample = { device_timestamp_usec,
+                                  (int64_t)system_timestamp_nsec - (int64_t)(device_timestamp_usec * 1000) };
+
+    Lock(clockmodel->lock);
+
+    if (clockmodel->sample_count > 0 && device_timestamp_usec < clockmodel->last_device_timestamp_usec)
+    {
+        // The device clock restarted, such as after the cameras were restarted
+        LOG_INFO("Device timestamp went back from %llu to %llu usec, restarting the clock model",
+                 (unsigned long long)clockmodel->last_device_timestamp_usec,
+                 (unsigned long long)device_timestamp_usec);
+        clockmodel_reset_locked(clockmodel);
+    }
+    clockmodel->last_device_timestamp_usec = device_timestamp_usec;
+    clockmodel->sample_count++;
+
+    if (clockmodel->window_open && device_timestamp_usec - clockmodel->window_start_usec >= CLOCKMODEL_WINDOW_USEC)
+    {
+        // Close the window, dropping the oldest once the history is full
+        if (clockmodel->window_count == CLOCKMODEL_WINDOW_COUNT)
+        {
+            clockmodel->window_first = (clockmodel->window_first + 1) % CLOCKMODEL_WINDOW_COUNT;
+            clockmodel->window_count--;
+        }
+        uint32_t index = (clockmodel->window_first + clockmodel->window_count) % CLOCKMODEL_WINDOW_COUNT;
+        clockmodel->windows[index] = clockmodel->window_min;
+        clockmodel->window_count++;
+        clockmodel->window_open = false;
+    }
+
+    if (!clockmodel->window_open)
+    {
+        clockmodel->window_open = true;
+        clockmodel->window_start_usec = device_timestamp_usec;
+        clockmodel->window_min = sample;
+    }
+    else if (sample.offset_nsec < clockmodel->window_min.offset_nsec)
+    {
+        clockmodel->window_min = sample;
+    }
+
+    clockmodel_fit_locked(clockmodel);
+
+    Unlock(clockmodel->lock);
+}
+
+k4a_result_t clockmodel_get(clockmodel_t clockmodel_handle, k4a_device_clock_model_t *model)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, clockmodel_t, clockmodel_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, model == NULL);
+    clockmodel_context_t *clockmodel = clockmodel_t_get_context(clockmodel_handle);
+
+    Lock(clockmodel->lock);
+    k4a_result_t result = K4A_RESULT_FROM_BOOL(clockmodel->sample_count > 0);
+    if (K4A_SUCCEEDED(result))
+    {
+        memset(model, 0, sizeof(*model));
+        model->reference_device_timestamp_usec = clockmodel->reference_device_timestamp_usec;
+        double reference_system_nsec = (double)clockmodel->reference_device_timestamp_usec * 1000 +
+                                       clockmodel->reference_offset_nsec;
+        model->reference_system_timestamp_nsec = reference_system_nsec > 0 ? (uint64_t)reference_system_nsec : 0;
+        // The offset grows by slope nanoseconds per microsecond of device time
+        model->drift_ppm = clockmodel->slope_nsec_per_usec * 1000;
+        model->residual_usec = clockmodel->residual_usec;
+        model->window_count = clockmodel->window_count + (clockmodel->window_open ? 1 : 0);
+        model->sample_count = clockmodel->sample_count;
+    }
+    Unlock(clockmodel->lock);
+
+    return result;
+}
+
+k4a_result_t clockmodel_convert(clockmodel_t clockmodel_handle,
+                                uint64_t device_timestamp_usec,
+                                uint64_t *system_timestamp_nsec)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, clockmodel_t, clockmodel_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, system_timestamp_nsec == NULL);
+    clockmodel_context_t *clockmodel = clockmodel_t_get_context(clockmodel_handle);
+
+    Lock(clockmodel->lock);
+    k4a_result_t result = K4A_RESULT_FROM_BOOL(clockmodel->sample_count > 0);
+    if (K4A_SUCCEEDED(result))
+    {
+        double elapsed_usec = (double)device_timestamp_usec - (double)clockmodel->reference_device_timestamp_usec;
+        double offset_nsec = clockmodel->reference_offset_nsec + clockmodel->slope_nsec_per_usec * elapsed_usec;
+
+        // Keep the integer part exact, doubles only hold microsecond timestamps to the nanosecond for a few months
+        int64_t system_nsec = (int64_t)(device_timestamp_usec * 1000) + (int64_t)llround(offset_nsec);
+        *system_timestamp_nsec = system_nsec > 0 ? (uint64_t)system_nsec : 0;
+    }
+    Unlock(clockmodel->lock);
+
+    return result;
+}
+
+k4a_result_t clockmodel_convert_system(clockmodel_t clockmodel_handle,
+                                       uint64_t system_timestamp_nsec,
+                                       uint64_t *device_timestamp_usec)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, clockmodel_t, clockmodel_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, device_timestamp_usec == NULL);
+    clockmodel_context_t *clockmodel = clockmodel_t_get_context(clockmodel_handle);
+
+    Lock(clockmodel->lock);
+    k4a_result_t result = K4A_RESULT_FROM_BOOL(clockmodel->sample_count > 0);
+    if (K4A_SUCCEEDED(result))
+    {
+        // The system time of the reference, the system clock then runs 1000 + slope nanoseconds per device microsecond
+        int64_t reference_system_nsec = (int64_t)(clockmodel->reference_device_timestamp_usec * 1000) +
+                                        (int64_t)llround(clockmodel->reference_offset_nsec);
+        double elapsed_nsec = (double)((int64_t)system_timestamp_nsec - reference_system_nsec);
+        int64_t device_usec = (int64_t)clockmodel->reference_device_timestamp_usec +
+                              (int64_t)llround(elapsed_nsec / (1000.0 + clockmodel->slope_nsec_per_usec));
+        *device_timestamp_usec = device_usec > 0 ? (uint64_t)device_usec : 0;
+    }
+    Unlock(clockmodel->lock);
+
+    return result;
+}
@@ -0,0 +1,95 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// OpenCL transformation backend of builds without K4A_ENABLE_OPENCL, every call fails
+#include <k4ainternal/clwrapper.h>
+
+// Dependent libraries
+#include <k4ainternal/logging.h>
+
+clwrapper_t clwrapper_create(const k4a_calibration_t *calibration,
+                             const k4a_transformation_ray_tables_t *ray_tables,
+                             const k4a_transformation_xy_tables_t *depth_camera_xy_tables,
+                             const k4a_transformation_xy_tables_t *color_camera_xy_tables,
+                             void *context,
+                             void *device)
+{
+    (void)calibration;
+    (void)ray_tables;
+    (void)depth_camera_xy_tables;
+    (void)color_camera_xy_tables;
+    (void)context;
+    (void)device;
+
+    LOG_ERROR("The OpenCL transformation backend is not available, the SDK was built without K4A_ENABLE_OPENCL.", 0);
+    return NULL;
+}
+
+void clwrapper_destroy(clwrapper_t clwrapper_handle)
+{
+    (void)clwrapper_handle;
+}
+
+k4a_result_t clwrapper_depth_to_color(clwrapper_t clwrapper_handle,
+                                      const uint16_t *depth_image,
+                                      const uint8_t *custom_image,
+                                      k4a_image_format_t custom_format,
+                                      k4a_transformation_interpolation_type_t interpolation_type,
+                                      uint32_t invalid_custom_value,
+                                      uint16_t *transformed_depth_image,
+                                      uint8_t *transformed_custom_image)
+{
+    (void)clwrapper_handle;
+    (void)depth_image;
+    (void)custom_image;
+    (void)custom_format;
+    (void)interpolation_type;
+    (void)invalid_custom_value;
+    (void)transformed_depth_image;
+    (void)transformed_custom_image;
+    return K4A_RESULT_FAILED;
+}
+
+k4a_result_t clwrapper_color_to_depth(clwrapper_t clwrapper_handle,
+                                      const uint16_t *depth_image,
+                                      const uint8_t *color_image,
+                                      uint8_t *transformed_color_image)
+{
+    (void)clwrapper_handle;
+    (void)depth_image;
+    (void)color_image;
+    (void)transformed_color_image;
+    return K4A_RESULT_FAILED;
+}
+
+k4a_result_t clwrapper_depth_to_point_cloud(clwrapper_t clwrapper_handle,
+                                            k4a_calibration_type_t camera,
+                                            const uint16_t *depth_image,
+                                            int16_t *xyz_image)
+{
+    (void)clwrapper_handle;
+    (void)camera;
+    (void)depth_image;
+    (void)xyz_image;
+    return K4A_RESULT_FAILED;
+}
+
+k4a_result_t clwrapper_get_output(clwrapper_t clwrapper_handle, k4a_transformation_gpu_output_t output, void **buffer)
+{
+    (void)clwrapper_handle;
+    (void)output;
+    (void)buffer;
+    return K4A_RESULT_FAILED;
+}
+
+k4a_result_t clwrapper_set_output_target(clwrapper_t clwrapper_handle,
+                                         k4a_transformation_gpu_output_t output,
+                                         k4a_transformation_gpu_target_t target_type,
+                                         void *target)
+{
+    (void)clwrapper_handle;
+    (void)output;
+    (void)target_type;
+    (void)target;
+    return K4A_RESULT_FAILED;
+}
@@ -0,0 +1,1285 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// This library is the OpenCL transformation backend
+#include <k4ainternal/clwrapper.h>
+
+// Dependent libraries
+#include <k4ainternal/logging.h>
+#include <azure_c_shared_utility/lock.h>
+
+// External dependencies
+#define CL_TARGET_OPENCL_VERSION 120
+#include <CL/cl.h>
+#include <CL/cl_gl.h>
+
+// System dependencies
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+// Kernels ported from the CPU implementation in rgbz.c, with the same operations in the same order. Correspondences are
+// float4 (u, v, depth, valid). Depth to color renders every quad into packed (depth << 16 | custom) values so the
+// closest surface wins through atomic_min regardless of the order quads are rendered in.
+static const char g_clwrapper_program_source[] =
+    "#pragma OPENCL FP_CONTRACT OFF\n"
+    "\n"
+    "#define CUSTOM_FORMAT_NONE 0\n"
+    "#define CUSTOM_FORMAT_8 1\n"
+    "#define CUSTOM_FORMAT_16 2\n"
+    "#define PACKED_EMPTY 0xFFFFFFFFu\n"
+    "\n"
+    "// transformation_project() of intrinsic_transformation.c, returns (u, v, valid). in holds cx, cy, fx, fy, k1 to\n"
+    "// k6, codx, cody, p1, p2, the metric radius and the tangential scale.\n"
+    "float3 project(__constant const float *in, float3 p)\n"
+    "{\n"
+    "    if (p.z <= 0.f)\n"
+    "        return (float3)(0.f, 0.f, 0.f);\n"
+    "    float xp = p.x / p.z - in[10];\n"
+    "    float yp = p.y / p.z - in[11];\n"
+    "    float xp2 = xp * xp;\n"
+    "    float yp2 = yp * yp;\n"
+    "    float xyp = xp * yp;\n"
+    "    float rs = xp2 + yp2;\n"
+    "    if (rs > in[14] * in[14])\n"
+    "        return (float3)(0.f, 0.f, 0.f);\n"
+    "    float rss = rs * rs;\n"
+    "    float rsc = rss * rs;\n"
+    "    float a = 1.f + in[4] * rs + in[5] * rss + in[6] * rsc;\n"
+    "    float b = 1.f + in[7] * rs + in[8] * rss + in[9] * rsc;\n"
+    "    float bi = b != 0.f ? 1.f / b : 1.f;\n"
+    "    float d = a * bi;\n"
+    "    float xp_d = xp * d;\n"
+    "    float yp_d = yp * d;\n"
+    "    xp_d += (rs + 2.f * xp2) * in[13] + in[15] * xyp * in[12];\n"
+    "    yp_d += (rs + 2.f * yp2) * in[12] + in[15] * xyp * in[13];\n"
+    "    return (float3)((xp_d + in[10]) * in[2] + in[0], (yp_d + in[11]) * in[3] + in[1], 1.f);\n"
+    "}\n"
+    "\n"
+    "__kernel void compute_correspondences(__global const ushort *depth,\n"
+    "                                      __global const float *rays,\n"
+    "                                      int pixel_count,\n"
+    "                                      float tx,\n"
+    "                                      float ty,\n"
+    "                                      float tz,\n"
+    "                                      __constant const float *intrinsics,\n"
+    "                                      __global float4 *correspondences)\n"
+    "{\n"
+    "    int i = get_global_id(0);\n"
+    "    if (i >= pixel_count)\n"
+    "        return;\n"
+    "    float x = rays[i];\n"
+    "    if (depth[i] == 0 || isnan(x))\n"
+    "    {\n"
+    "        correspondences[i] = (float4)(0.f, 0.f, 0.f, 0.f);\n"
+    "        return;\n"
+    "    }\n"
+    "    float z = (float)depth[i];\n"
+    "    float3 p = (float3)(x * z + tx, rays[pixel_count + i] * z + ty, rays[2 * pixel_count + i] * z + tz);\n"
+    "    float3 uv = project(intrinsics, p);\n"
+    "    correspondences[i] = (float4)(uv.x, uv.y, p.z, uv.z);\n"
+    "}\n"
+    "\n"
+    "uint read_custom(__global const uchar *custom, int custom_format, int i)\n"
+    "{\n"
+    "    if (custom_format == CUSTOM_FORMAT_8)\n"
+    "        return custom[i];\n"
+    "    if (custom_format == CUSTOM_FORMAT_16)\n"
+    "        return ((__global const ushort *)custom)[i];\n"
+    "    return 0;\n"
+    "}\n"
+    "\n"
+    "float4 interpolate_correspondences(float4 a, float4 b)\n"
+    "{\n"
+    "    return (float4)((a.x + b.x) * 0.5f, (a.y + b.y) * 0.5f, (a.z + b.z) * 0.5f, a.w * b.w);\n"
+    "}\n"
+    "\n"
+    "uint interpolate_custom(uint c1, uint c2, uint nearest, int linear)\n"
+    "{\n"
+    "    return linear ? (c1 + c2) / 2 : nearest;\n"
+    "}\n"
+    "\n"
+    "// transformation_check_valid_correspondences(), v and c are top left, top right, bottom right, bottom left\n"
+    "bool check_valid_correspondences(float4 tl, float4 tr, float4 br, float4 bl, float4 *v, uint *c, int linear)\n"
+    "{\n"
+    "    v[0] = tl;\n"
+    "    v[1] = tr;\n"
+    "    v[2] = br;\n"
+    "    v[3] = bl;\n"
+    "    int num_invalid = 0;\n"
+    "    if (tl.w == 0.f)\n"
+    "    {\n"
+    "        num_invalid++;\n"
+    "        v[0] = interpolate_correspondences(tr, bl);\n"
+    "        c[0] = interpolate_custom(c[1], c[3], c[2], linear);\n"
+    "    }\n"
+    "    if (tr.w == 0.f)\n"
+    "    {\n"
+    "        num_invalid++;\n"
+    "        v[1] = br;\n"
+    "        v[2] = interpolate_correspondences(br, bl);\n"
+    "        c[1] = c[2];\n"
+    "        c[2] = interpolate_custom(c[2], c[3], c[3], linear);\n"
+    "    }\n"
+    "    if (br.w == 0.f)\n"
+    "    {\n"
+    "        num_invalid++;\n"
+    "        v[2] = interpolate_correspondences(tr, bl);\n"
+    "        c[2] = interpolate_custom(c[1], c[3], c[0], linear);\n"
+    "    }\n"
+    "    if (bl.w == 0.f)\n"
+    "    {\n"
+    "        num_invalid++;\n"
+    "        v[3] = br;\n"
+    "        v[2] = interpolate_correspondences(tr, br);\n"
+    "        c[3] = c[2];\n"
+    "        c[2] = interpolate_custom(c[1], c[2], c[1], linear);\n"
+    "    }\n"
+    "    bool valid = num_invalid < 2;\n"
+    "    float depth_min = min(min(v[0].z, v[1].z), min(v[2].z, v[3].z));\n"
+    "    float depth_max = max(max(v[0].z, v[1].z), max(v[2].z, v[3].z));\n"
+    "    if (depth_max - depth_min > 0.04693441759f * depth_min)\n"
+    "        valid = false;\n"
+    "    return valid;\n"
+    "}\n"
+    "\n"
+    "float area_function(float2 a, float2 b, float2 c)\n"
+    "{\n"
+    "    return (c.y - a.y) * (b.x - a.x) - (c.x - a.x) * (b.y - a.y);\n"
+    "}\n"
+    "\n"
+    "// transformation_point_inside_quad()\n"
+    "bool point_inside_quad(const float4 *v, const uint *c, float2 p, int linear, float *depth, float *custom)\n"
+    "{\n"
+    "    float area_intermediate = area_function(v[0].xy, v[2].xy, p);\n"
+    "    bool counter_clockwise = area_intermediate >= 0.f;\n"
+    "    float4 intermediate = counter_clockwise ? v[3] : v[1];\n"
+    "    uint custom_intermediate = counter_clockwise ? c[3] : c[1];\n"
+    "    float area_top_left = area_function(intermediate.xy, v[0].xy, p);\n"
+    "    float area_bottom_right = area_function(v[2].xy, intermediate.xy, p);\n"
+    "    if (!counter_clockwise)\n"
+    "    {\n"
+    "        area_top_left = -area_top_left;\n"
+    "        area_bottom_right = -area_bottom_right;\n"
+    "        area_intermediate = -area_intermediate;\n"
+    "    }\n"
+    "    if (area_top_left < 0.f || area_bottom_right <= 0.f)\n"
+    "        return false;\n"
+    "    float sum_weights = area_top_left + area_intermediate + area_bottom_right;\n"
+    "    if (sum_weights != 0.f)\n"
+    "        sum_weights = 1.f / sum_weights;\n"
+    "    *depth = (area_top_left * v[2].z + area_intermediate * intermediate.z + area_bottom_right * v[0].z) *\n"
+    "             sum_weights;\n"
+    "    if (linear)\n"
+    "        *custom = (area_top_left * (float)c[2] + area_intermediate * (float)custom_intermediate +\n"
+    "                   area_bottom_right * (float)c[0]) *\n"
+    "                  sum_weights;\n"
+    "    else if (area_top_left > area_intermediate)\n"
+    "        *custom = area_top_left > area_bottom_right ? (float)c[2] : (float)c[0];\n"
+    "    else\n"
+    "        *custom = area_intermediate > area_bottom_right ? (float)custom_intermediate : (float)c[0];\n"
+    "    return true;\n"
+    "}\n"
+    "\n"
+    "// One work item per quad, the quad with bottom right vertex (x + 1, y + 1) of the depth image\n"
+    "__kernel void depth_to_color_quads(__global const float4 *correspondences,\n"
+    "                                   __global const uchar *custom,\n"
+    "                                   int custom_format,\n"
+    "                                   int linear,\n"
+    "                                   int depth_width,\n"
+    "                                   int depth_height,\n"
+    "                                   int color_width,\n"
+    "                                   int color_height,\n"
+    "                                   __global volatile uint *packed)\n"
+    "{\n"
+    "    int x = get_global_id(0) + 1;\n"
+    "    int y = get_global_id(1) + 1;\n"
+    "    if (x >= depth_width || y >= depth_height)\n"
+    "        return;\n"
+    "    int top = (y - 1) * depth_width + x;\n"
+    "    int bottom = y * depth_width + x;\n"
+    "    float4 v[4];\n"
+    "    uint c[4];\n"
+    "    c[0] = read_custom(custom, custom_format, top - 1);\n"
+    "    c[1] = read_custom(custom, custom_format, top);\n"
+    "    c[2] = read_custom(custom, custom_format, bottom);\n"
+    "    c[3] = read_custom(custom, custom_format, bottom - 1);\n"
+    "    if (!check_valid_correspondences(correspondences[top - 1],\n"
+    "                                     correspondences[top],\n"
+    "                                     correspondences[bottom],\n"
+    "                                     correspondences[bottom - 1],\n"
+    "                                     v,\n"
+    "                                     c,\n"
+    "                                     linear))\n"
+    "        return;\n"
+    "    float x_min = min(min(v[0].x, v[1].x), min(v[2].x, v[3].x));\n"
+    "    float y_min = min(min(v[0].y, v[1].y), min(v[2].y, v[3].y));\n"
+    "    float x_max = max(max(v[0].x, v[1].x), max(v[2].x, v[3].x));\n"
+    "    float y_max = max(max(v[0].y, v[1].y), max(v[2].y, v[3].y));\n"
+    "    int left = max((int)ceil(x_min), 0);\n"
+    "    int right = min((int)ceil(x_max), color_width);\n"
+    "    int top_row = max((int)ceil(y_min), 0);\n"
+    "    int bottom_row = min((int)ceil(y_max), color_height);\n"
+    "    for (int row = top_row; row < bottom_row; row++)\n"
+    "    {\n"
+    "        for (int column = left; column < right; column++)\n"
+    "        {\n"
+    "            float depth = 0.f;\n"
+    "            float value = 0.f;\n"
+    "            if (!point_inside_quad(v, c, (float2)((float)column, (float)row), linear, &depth, &value))\n"
+    "                continue;\n"
+    "            uint d = (uint)(depth + 0.5f) & 0xFFFFu;\n"
+    "            if (d == 0)\n"
+    "                continue;\n"
+    "            uint packed_value = (d << 16) | ((uint)(value + 0.5f) & 0xFFFFu);\n"
+    "            atomic_min(&packed[row * color_width + column], packed_value);\n"
+    "        }\n"
+    "    }\n"
+    "}\n"
+    "\n"
+    "__kernel void depth_to_color_resolve(__global const uint *packed,\n"
+    "                                     int pixel_count,\n"
+    "                                     int custom_format,\n"
+    "                                     uint invalid_custom_value,\n"
+    "                                     __global ushort *transformed_depth,\n"
+    "                                     __global uchar *transformed_custom)\n"
+    "{\n"
+    "    int i = get_global_id(0);\n"
+    "    if (i >= pixel_count)\n"
+    "        return;\n"
+    "    uint value = packed[i];\n"
+    "    bool empty = value == PACKED_EMPTY;\n"
+    "    transformed_depth[i] = empty ? 0 : (ushort)(value >> 16);\n"
+    "    uint custom = empty ? invalid_custom_value : (value & 0xFFFFu);\n"
+    "    if (custom_format == CUSTOM_FORMAT_8)\n"
+    "        transformed_custom[i] = (uchar)custom;\n"
+    "    else if (custom_format == CUSTOM_FORMAT_16)\n"
+    "        ((__global ushort *)transformed_custom)[i] = (ushort)custom;\n"
+    "}\n"
+    "\n"
+    "// transformation_bilinear_interpolation() of one channel\n"
+    "uchar bilinear_interpolation(__global const uchar *image, int stride, float2 p)\n"
+    "{\n"
+    "    int x = (int)floor(p.x);\n"
+    "    int y = (int)floor(p.y);\n"
+    "    float fx = p.x - x;\n"
+    "    float fy = p.y - y;\n"
+    "    int idx = y * stride + 4 * x;\n"
+    "    float top = (1.f - fx) * (float)image[idx] + fx * (float)image[idx + 4];\n"
+    "    float bottom = (1.f - fx) * (float)image[idx + stride] + fx * (float)image[idx + stride + 4];\n"
+    "    return (uchar)((1.f - fy) * top + fy * bottom + 0.5f);\n"
+    "}\n"
+    "\n"
+    "__kernel void color_to_depth(__global const float4 *correspondences,\n"
+    "                             __global const uchar *color,\n"
+    "                             int color_width,\n"
+    "                             int color_height,\n"
+    "                             int pixel_count,\n"
+    "                             __global uchar4 *transformed_color)\n"
+    "{\n"
+    "    int i = get_global_id(0);\n"
+    "    if (i >= pixel_count)\n"
+    "        return;\n"
+    "    float4 c = correspondences[i];\n"
+    "    int x = (int)floor(c.x);\n"
+    "    int y = (int)floor(c.y);\n"
+    "    if (c.w == 0.f || x < 0 || y < 0 || x + 1 >= color_width || y + 1 >= color_height)\n"
+    "    {\n"
+    "        transformed_color[i] = (uchar4)(0, 0, 0, 0);\n"
+    "        return;\n"
+    "    }\n"
+    "    int stride = 4 * color_width;\n"
+    "    uchar4 bgra = (uchar4)(bilinear_interpolation(color, stride, c.xy),\n"
+    "                           bilinear_interpolation(color + 1, stride, c.xy),\n"
+    "                           bilinear_interpolation(color + 2, stride, c.xy),\n"
+    "                           bilinear_interpolation(color + 3, stride, c.xy));\n"
+    "    // (0,0,0,0) marks invalid pixels, valid black is (1,0,0,0)\n"
+    "    if (bgra.x == 0 && bgra.y == 0 && bgra.z == 0 && bgra.w == 0)\n"
+    "        bgra.x = 1;\n"
+    "    transformed_color[i] = bgra;\n"
+    "}\n"
+    "\n"
+    "// transformation_depth_to_xyz_c()\n"
+    "__kernel void depth_to_xyz(__global const ushort *depth,\n"
+    "                           __global const float *xy_tables,\n"
+    "                           int pixel_count,\n"
+    "                           __global short *xyz)\n"
+    "{\n"
+    "    int i = get_global_id(0);\n"
+    "    if (i >= pixel_count)\n"
+    "        return;\n"
+    "    float x = xy_tables[i];\n"
+    "    short3 point = (short3)(0, 0, 0);\n"
+    "    if (!isnan(x))\n"
+    "    {\n"
+    "        short z = (short)depth[i];\n"
+    "        point.x = (short)floor(x * (float)z + 0.5f);\n"
+    "        point.y = (short)floor(xy_tables[pixel_count + i] * (float)z + 0.5f);\n"
+    "        point.z = z;\n"
+    "    }\n"
+    "    vstore3(point, i, xyz);\n"
+    "}\n";
+
+typedef enum
+{
+    CLWRAPPER_KERNEL_COMPUTE_CORRESPONDENCES = 0,
+    CLWRAPPER_KERNEL_DEPTH_TO_COLOR_QUADS,
+    CLWRAPPER_KERNEL_DEPTH_TO_COLOR_RESOLVE,
+    CLWRAPPER_KERNEL_COLOR_TO_DEPTH,
+    CLWRAPPER_KERNEL_DEPTH_TO_XYZ,
+    CLWRAPPER_KERNEL_COUNT
+} clwrapper_kernel_t;
+
+static const char *g_clwrapper_kernel_names[CLWRAPPER_KERNEL_COUNT] = {
+    "compute_correspondences", "depth_to_color_quads", "depth_to_color_resolve", "color_to_depth", "depth_to_xyz"
+};
+
+// Values of the custom_format kernel argument
+#define CLWRAPPER_CUSTOM_FORMAT_NONE 0
+#define CLWRAPPER_CUSTOM_FORMAT_8 1
+#define CLWRAPPER_CUSTOM_FORMAT_16 2
+
+// Number of floats of the intrinsics kernel argument
+#define CLWRAPPER_INTRINSICS_COUNT 16
+
+typedef enum
+{
+    CLWRAPPER_BUFFER_RAYS = 0,
+    CLWRAPPER_BUFFER_INTRINSICS,
+    CLWRAPPER_BUFFER_DEPTH_XY_TABLES,
+    CLWRAPPER_BUFFER_COLOR_XY_TABLES,
+    CLWRAPPER_BUFFER_DEPTH,
+    CLWRAPPER_BUFFER_CUSTOM,
+    CLWRAPPER_BUFFER_COLOR,
+    CLWRAPPER_BUFFER_CORRESPONDENCES,
+    CLWRAPPER_BUFFER_PACKED,
+    CLWRAPPER_BUFFER_TRANSFORMED_DEPTH,
+    CLWRAPPER_BUFFER_TRANSFORMED_CUSTOM,
+    CLWRAPPER_BUFFER_TRANSFORMED_COLOR,
+    CLWRAPPER_BUFFER_XYZ,
+    CLWRAPPER_BUFFER_COUNT
+} clwrapper_buffer_type_t;
+
+// Device buffers are allocated on first use and grown when a larger one is needed, except output targets of the caller
+typedef struct _clwrapper_buffer_t
+{
+    cl_mem mem;
+    size_t size;
+    bool target;    // mem was set with clwrapper_set_output_target()
+    bool gl_object; // mem is shared with OpenGL, it is acquired while the transformations write it
+    bool acquired;
+} clwrapper_buffer_t;
+
+typedef struct _clwrapper_context_t
+{
+    const k4a_transformation_xy_tables_t *depth_camera_xy_tables;
+    const k4a_transformation_xy_tables_t *color_camera_xy_tables;
+    bool depth_xy_tables_uploaded;
+    bool color_xy_tables_uploaded;
+    bool enable_depth_color_transform; // Rays and color intrinsics were uploaded
+    float translation[3];
+    int depth_width;
+    int depth_height;
+    int color_width;
+    int color_height;
+
+    // Outputs that hold a result, for clwrapper_get_output()
+    bool transformed_depth_valid;
+    bool transformed_custom_valid;
+    bool transformed_color_valid;
+    bool xyz_valid;
+
+    // Serializes the calls sharing the buffers and the queue
+    LOCK_HANDLE lock;
+    cl_context context;
+    cl_command_queue queue;
+    cl_program program;
+    cl_kernel kernels[CLWRAPPER_KERNEL_COUNT];
+    clwrapper_buffer_t buffers[CLWRAPPER_BUFFER_COUNT];
+} clwrapper_context_t;
+
+K4A_DECLARE_CONTEXT(clwrapper_t, clwrapper_context_t);
+
+static k4a_result_t clwrapper_check(cl_int status, const char *function)
+{
+    if (status != CL_SUCCESS)
+    {
+        LOG_ERROR("%s failed with OpenCL error %d.", function, status);
+        return K4A_RESULT_FAILED;
+    }
+    return K4A_RESULT_SUCCEEDED;
+}
+
+// Output targets are only checked, and OpenGL ones acquired until clwrapper_release_gl_objects()
+static k4a_result_t clwrapper_ensure_buffer(clwrapper_context_t *clwrapper, clwrapper_buffer_type_t type, size_t size)
+{
+    clwrapper_buffer_t *buffer = &clwrapper->buffers[type];
+    if (buffer->target)
+    {
+        if (buffer->size < size)
+        {
+            LOG_ERROR("The GPU output target holds %zu bytes, the transformation output needs %zu.",
+                      buffer->size,
+                      size);
+            return K4A_RESULT_FAILED;
+        }
+        if (buffer->gl_object && !buffer->acquired)
+        {
+            if (K4A_FAILED(clwrapper_check(clEnqueueAcquireGLObjects(clwrapper->queue, 1, &buffer->mem, 0, NULL, NULL),
+                                           "clEnqueueAcquireGLObjects")))
+            {
+                return K4A_RESULT_FAILED;
+            }
+            buffer->acquired = true;
+        }
+        return K4A_RESULT_SUCCEEDED;
+    }
+
+    if (buffer->mem != NULL && buffer->size >= size)
+    {
+        return K4A_RESULT_SUCCEEDED;
+    }
+
+    if (buffer->mem != NULL)
+    {
+        clReleaseMemObject(buffer->mem);
+        buffer->mem = NULL;
+        buffer->size = 0;
+    }
+
+    cl_int status = CL_SUCCESS;
+    buffer->mem = clCreateBuffer(clwrapper->context, CL_MEM_READ_WRITE, size, NULL, &status);
+    if (K4A_FAILED(clwrapper_check(status, "clCreateBuffer")))
+    {
+        buffer->mem = NULL;
+        return K4A_RESULT_FAILED;
+    }
+    buffer->size = size;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+// Hands the OpenGL objects acquired by clwrapper_ensure_buffer() back to OpenGL, once the queue has completed
+static k4a_result_t clwrapper_release_gl_objects(clwrapper_context_t *clwrapper)
+{
+    k4a_result_t result = K4A_RESULT_SUCCEEDED;
+    bool released = false;
+    for (int i = 0; i < CLWRAPPER_BUFFER_COUNT; i++)
+    {
+        clwrapper_buffer_t *buffer = &clwrapper->buffers[i];
+        if (buffer->acquired)
+        {
+            if (K4A_FAILED(clwrapper_check(clEnqueueReleaseGLObjects(clwrapper->queue, 1, &buffer->mem, 0, NULL, NULL),
+                                           "clEnqueueReleaseGLObjects")))
+            {
+                result = K4A_RESULT_FAILED;
+            }
+            buffer->acquired = false;
+            released = true;
+        }
+    }
+
+    if (released && K4A_FAILED(clwrapper_check(clFinish(clwrapper->queue), "clFinish")))
+    {
+        result = K4A_RESULT_FAILED;
+    }
+    return result;
+}
+
+static k4a_result_t clwrapper_write_buffer(clwrapper_context_t *clwrapper,
+                                           clwrapper_buffer_type_t type,
+                                           size_t offset,
+                                           const void *data,
+                                           size_t size)
+{
+    cl_int status = clEnqueueWriteBuffer(
+        clwrapper->queue, clwrapper->buffers[type].mem, CL_TRUE, offset, size, data, 0, NULL, NULL);
+    return clwrapper_check(status, "clEnqueueWriteBuffer");
+}
+
+// Copies the result to the host, or only waits for it when data is NULL
+static k4a_result_t clwrapper_read_buffer(clwrapper_context_t *clwrapper,
+                                          clwrapper_buffer_type_t type,
+                                          void *data,
+                                          size_t size)
+{
+    if (data == NULL)
+    {
+        return clwrapper_check(clFinish(clwrapper->queue), "clFinish");
+    }
+    return clwrapper_check(
+        clEnqueueReadBuffer(clwrapper->queue, clwrapper->buffers[type].mem, CL_TRUE, 0, size, data, 0, NULL, NULL),
+        "clEnqueueReadBuffer");
+}
+
+static k4a_result_t clwrapper_run_kernel(clwrapper_context_t *clwrapper,
+                                         clwrapper_kernel_t kernel,
+                                         cl_uint dimensions,
+                                         size_t width,
+                                         size_t height)
+{
+    size_t global_size[2] = { width, height };
+    if (width == 0 || height == 0)
+    {
+        return K4A_RESULT_SUCCEEDED;
+    }
+    return clwrapper_check(clEnqueueNDRangeKernel(clwrapper->queue,
+                                                  clwrapper->kernels[kernel],
+                                                  dimensions,
+                                                  NULL,
+                                                  global_size,
+                                                  NULL,
+                                                  0,
+                                                  NULL,
+                                                  NULL),
+                           "clEnqueueNDRangeKernel");
+}
+
+// The parameters of transformation_project_point() in the order of the project() kernel function
+static k4a_result_t clwrapper_get_intrinsics(const k4a_calibration_camera_t *camera_calibration,
+                                             float intrinsics[CLWRAPPER_INTRINSICS_COUNT])
+{
+    if (K4A_FAILED(K4A_RESULT_FROM_BOOL(
+            (camera_calibration->intrinsics.type == K4A_CALIBRATION_LENS_DISTORTION_MODEL_RATIONAL_6KT ||
+             camera_calibration->intrinsics.type == K4A_CALIBRATION_LENS_DISTORTION_MODEL_BROWN_CONRADY) &&
+            camera_calibration->intrinsics.parameter_count >= 14)))
+    {
+        LOG_ERROR("Unexpected camera calibration model type %d.", camera_calibration->intrinsics.type);
+        return K4A_RESULT_FAILED;
+    }
+
+    const k4a_calibration_intrinsic_parameters_t *params = &camera_calibration->intrinsics.parameters;
+    intrinsics[0] = params->param.cx;
+    intrinsics[1] = params->param.cy;
+    intrinsics[2] = params->param.fx;
+    intrinsics[3] = params->param.fy;
+    intrinsics[4] = params->param.k1;
+    intrinsics[5] = params->param.k2;
+    intrinsics[6] = params->param.k3;
+    intrinsics[7] = params->param.k4;
+    intrinsics[8] = params->param.k5;
+    intrinsics[9] = params->param.k6;
+    intrinsics[10] = params->param.codx;
+    intrinsics[11] = params->param.cody;
+    intrinsics[12] = params->param.p1;
+    intrinsics[13] = params->param.p2;
+    intrinsics[14] = camera_calibration->metric_radius;
+    intrinsics[15] = camera_calibration->intrinsics.type == K4A_CALIBRATION_LENS_DISTORTION_MODEL_RATIONAL_6KT ? 1.f :
+                                                                                                                 2.f;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+// The first GPU of the first platform that has one
+static k4a_result_t clwrapper_find_device(cl_device_id *device)
+{
+    cl_uint platform_count = 0;
+    if (K4A_FAILED(clwrapper_check(clGetPlatformIDs(0, NULL, &platform_count), "clGetPlatformIDs")) ||
+        platform_count == 0)
+    {
+        LOG_ERROR("No OpenCL platform is installed.", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    cl_platform_id *platforms = (cl_platform_id *)malloc(platform_count * sizeof(cl_platform_id));
+    if (platforms == NULL)
+    {
+        LOG_ERROR("Failed to allocate the OpenCL platforms.", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    *device = NULL;
+    if (K4A_SUCCEEDED(clwrapper_check(clGetPlatformIDs(platform_count, platforms, NULL), "clGetPlatformIDs")))
+    {
+        for (cl_uint i = 0; i < platform_count && *device == NULL; i++)
+        {
+            if (clGetDeviceIDs(platforms[i], CL_DEVICE_TYPE_GPU, 1, device, NULL) != CL_SUCCESS)
+            {
+                *device = NULL;
+            }
+        }
+    }
+    free(platforms);
+
+    if (*device == NULL)
+    {
+        LOG_ERROR("No OpenCL GPU device is available.", 0);
+        return K4A_RESULT_FAILED;
+    }
+    return K4A_RESULT_SUCCEEDED;
+}
+
+// Runs on device of context when the caller provided one, otherwise in a new context on the first GPU
+static k4a_result_t clwrapper_create_device(clwrapper_context_t *clwrapper, cl_context context, cl_device_id device)
+{
+    cl_int status = CL_SUCCESS;
+    if (context != NULL)
+    {
+        if (K4A_FAILED(clwrapper_check(clRetainContext(context), "clRetainContext")))
+        {
+            return K4A_RESULT_FAILED;
+        }
+        clwrapper->context = context;
+    }
+    else
+    {
+        if (K4A_FAILED(TRACE_CALL(clwrapper_find_device(&device))))
+        {
+            return K4A_RESULT_FAILED;
+        }
+
+        clwrapper->context = clCreateContext(NULL, 1, &device, NULL, NULL, &status);
+        if (K4A_FAILED(clwrapper_check(status, "clCreateContext")))
+        {
+            clwrapper->context = NULL;
+            return K4A_RESULT_FAILED;
+        }
+    }
+
+    char device_name[256] = { 0 };
+    if (clGetDeviceInfo(device, CL_DEVICE_NAME, sizeof(device_name) - 1, device_name, NULL) == CL_SUCCESS)
+    {
+        LOG_INFO("OpenCL transformation backend running on \"%s\".", device_name);
+    }
+
+    clwrapper->queue = clCreateCommandQueue(clwrapper->context, device, 0, &status);
+    if (K4A_FAILED(clwrapper_check(status, "clCreateCommandQueue")))
+    {
+        clwrapper->queue = NULL;
+        return K4A_RESULT_FAILED;
+    }
+
+    const char *sources[] = { g_clwrapper_program_source };
+    clwrapper->program = clCreateProgramWithSource(clwrapper->context, 1, sources, NULL, &status);
+    if (K4A_FAILED(clwrapper_check(status, "clCreateProgramWithSource")))
+    {
+        clwrapper->program = NULL;
+        return K4A_RESULT_FAILED;
+    }
+
+    status = clBuildProgram(clwrapper->program, 1, &device, "-cl-std=CL1.2", NULL, NULL);
+    if (status != CL_SUCCESS)
+    {
+        char build_log[1024] = { 0 };
+        clGetProgramBuildInfo(
+            clwrapper->program, device, CL_PROGRAM_BUILD_LOG, sizeof(build_log) - 1, build_log, NULL);
+        LOG_ERROR("clBuildProgram failed with OpenCL error %d: %s", status, build_log);
+        return K4A_RESULT_FAILED;
+    }
+
+    for (int i = 0; i < CLWRAPPER_KERNEL_COUNT; i++)
+    {
+        clwrapper->kernels[i] = clCreateKernel(clwrapper->program, g_clwrapper_kernel_names[i], &status);
+        if (K4A_FAILED(clwrapper_check(status, "clCreateKernel")))
+        {
+            clwrapper->kernels[i] = NULL;
+            return K4A_RESULT_FAILED;
+        }
+    }
+    return K4A_RESULT_SUCCEEDED;
+}
+
+static k4a_result_t clwrapper_upload_rays(clwrapper_context_t *clwrapper,
+                                          const k4a_calibration_t *calibration,
+                                          const k4a_transformation_ray_tables_t *ray_tables)
+{
+    float intrinsics[CLWRAPPER_INTRINSICS_COUNT];
+    if (K4A_FAILED(TRACE_CALL(clwrapper_get_intrinsics(&calibration->color_camera_calibration, intrinsics))))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    size_t table_size = (size_t)ray_tables->width * (size_t)ray_tables->height * sizeof(float);
+    if (K4A_FAILED(TRACE_CALL(clwrapper_ensure_buffer(clwrapper, CLWRAPPER_BUFFER_RAYS, 3 * table_size))) ||
+        K4A_FAILED(TRACE_CALL(clwrapper_ensure_buffer(clwrapper, CLWRAPPER_BUFFER_INTRINSICS, sizeof(intrinsics)))) ||
+        K4A_FAILED(TRACE_CALL(
+            clwrapper_write_buffer(clwrapper, CLWRAPPER_BUFFER_RAYS, 0, ray_tables->x_table, table_size))) ||
+        K4A_FAILED(TRACE_CALL(
+            clwrapper_write_buffer(clwrapper, CLWRAPPER_BUFFER_RAYS, table_size, ray_tables->y_table, table_size))) ||
+        K4A_FAILED(TRACE_CALL(clwrapper_write_buffer(
+            clwrapper, CLWRAPPER_BUFFER_RAYS, 2 * table_size, ray_tables->z_table, table_size))) ||
+        K4A_FAILED(TRACE_CALL(
+            clwrapper_write_buffer(clwrapper, CLWRAPPER_BUFFER_INTRINSICS, 0, intrinsics, sizeof(intrinsics)))))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    memcpy(clwrapper->translation, ray_tables->translation, sizeof(clwrapper->translation));
+    clwrapper->enable_depth_color_transform = true;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+clwrapper_t clwrapper_create(const k4a_calibration_t *calibration,
+                             const k4a_transformation_ray_tables_t *ray_tables,
+                             const k4a_transformation_xy_tables_t *depth_camera_xy_tables,
+                             const k4a_transformation_xy_tables_t *color_camera_xy_tables,
+                             void *context,
+                             void *device)
+{
+    RETURN_VALUE_IF_ARG(NULL, calibration == NULL);
+    RETURN_VALUE_IF_ARG(NULL, depth_camera_xy_tables == NULL);
+    RETURN_VALUE_IF_ARG(NULL, color_camera_xy_tables == NULL);
+    RETURN_VALUE_IF_ARG(NULL, (context == NULL) != (device == NULL));
+
+    clwrapper_t clwrapper_handle = NULL;
+    clwrapper_context_t *clwrapper = clwrapper_t_create(&clwrapper_handle);
+    k4a_result_t result = K4A_RESULT_FROM_BOOL(clwrapper != NULL);
+
+    if (K4A_SUCCEEDED(result))
+    {
+        clwrapper->depth_camera_xy_tables = depth_camera_xy_tables;
+        clwrapper->color_camera_xy_tables = color_camera_xy_tables;
+        clwrapper->depth_width = calibration->depth_camera_calibration.resolution_width;
+        clwrapper->depth_height = calibration->depth_camera_calibration.resolution_height;
+        clwrapper->color_width = calibration->color_camera_calibration.resolution_width;
+        clwrapper->color_height = calibration->color_camera_calibration.resolution_height;
+
+        clwrapper->lock = Lock_Init();
+        result = K4A_RESULT_FROM_BOOL(clwrapper->lock != NULL);
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        result = TRACE_CALL(clwrapper_create_device(clwrapper, (cl_context)context, (cl_device_id)device));
+    }
+
+    if (K4A_SUCCEEDED(result) && ray_tables != NULL)
+    {
+        result = TRACE_CALL(clwrapper_upload_rays(clwrapper, calibration, ray_tables));
+    }
+
+    if (K4A_FAILED(result) && clwrapper_handle != NULL)
+    {
+        clwrapper_destroy(clwrapper_handle);
+        clwrapper_handle = NULL;
+    }
+    return clwrapper_handle;
+}
+
+void clwrapper_destroy(clwrapper_t clwrapper_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, clwrapper_t, clwrapper_handle);
+    clwrapper_context_t *clwrapper = clwrapper_t_get_context(clwrapper_handle);
+
+    if (clwrapper->queue)
+    {
+        clwrapper_release_gl_objects(clwrapper);
+        clFinish(clwrapper->queue);
+    }
+
+    for (int i = 0; i < CLWRAPPER_BUFFER_COUNT; i++)
+    {
+        if (clwrapper->buffers[i].mem)
+        {
+            clReleaseMemObject(clwrapper->buffers[i].mem);
+        }
+    }
+
+    for (int i = 0; i < CLWRAPPER_KERNEL_COUNT; i++)
+    {
+        if (clwrapper->kernels[i])
+        {
+            clReleaseKernel(clwrapper->kernels[i]);
+        }
+    }
+
+    if (clwrapper->program)
+    {
+        clReleaseProgram(clwrapper->program);
+    }
+
+    if (clwrapper->queue)
+    {
+        clReleaseCommandQueue(clwrapper->queue);
+    }
+
+    if (clwrapper->context)
+    {
+        clReleaseContext(clwrapper->context);
+    }
+
+    if (clwrapper->lock)
+    {
+        Lock_Deinit(clwrapper->lock);
+    }
+
+    clwrapper_t_destroy(clwrapper_handle);
+}
+
+// Uploads the depth image and computes the color camera correspondence of every depth pixel
+static k4a_result_t clwrapper_compute_correspondences(clwrapper_context_t *clwrapper, const uint16_t *depth_image)
+{
+    if (!clwrapper->enable_depth_color_transform)
+    {
+        LOG_ERROR("Expect both depth camera and color camera are running to transform between depth and color.", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    cl_int pixel_count = clwrapper->depth_width * clwrapper->depth_height;
+    size_t depth_size = (size_t)pixel_count * sizeof(uint16_t);
+    if (K4A_FAILED(TRACE_CALL(clwrapper_ensure_buffer(clwrapper, CLWRAPPER_BUFFER_DEPTH, depth_size))) ||
+        K4A_FAILED(TRACE_CALL(clwrapper_ensure_buffer(
+            clwrapper, CLWRAPPER_BUFFER_CORRESPONDENCES, (size_t)pixel_count * 4 * sizeof(float)))) ||
+        K4A_FAILED(TRACE_CALL(clwrapper_write_buffer(clwrapper, CLWRAPPER_BUFFER_DEPTH, 0, depth_image, depth_size))))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    cl_kernel kernel = clwrapper->kernels[CLWRAPPER_KERNEL_COMPUTE_CORRESPONDENCES];
+    cl_int status = CL_SUCCESS;
+    status |= clSetKernelArg(kernel, 0, sizeof(cl_mem), &clwrapper->buffers[CLWRAPPER_BUFFER_DEPTH].mem);
+    status |= clSetKernelArg(kernel, 1, sizeof(cl_mem), &clwrapper->buffers[CLWRAPPER_BUFFER_RAYS].mem);
+    status |= clSetKernelArg(kernel, 2, sizeof(cl_int), &pixel_count);
+    status |= clSetKernelArg(kernel, 3, sizeof(float), &clwrapper->translation[0]);
+    status |= clSetKernelArg(kernel, 4, sizeof(float), &clwrapper->translation[1]);
+    status |= clSetKernelArg(kernel, 5, sizeof(float), &clwrapper->translation[2]);
+    status |= clSetKernelArg(kernel, 6, sizeof(cl_mem), &clwrapper->buffers[CLWRAPPER_BUFFER_INTRINSICS].mem);
+    status |= clSetKernelArg(kernel, 7, sizeof(cl_mem), &clwrapper->buffers[CLWRAPPER_BUFFER_CORRESPONDENCES].mem);
+    if (K4A_FAILED(clwrapper_check(status, "clSetKernelArg")))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    return TRACE_CALL(
+        clwrapper_run_kernel(clwrapper, CLWRAPPER_KERNEL_COMPUTE_CORRESPONDENCES, 1, (size_t)pixel_count, 1));
+}
+
+static k4a_result_t clwrapper_depth_to_color_locked(clwrapper_context_t *clwrapper,
+                                                    const uint16_t *depth_image,
+                                                    const uint8_t *custom_image,
+                                                    k4a_image_format_t custom_format,
+                                                    k4a_transformation_interpolation_type_t interpolation_type,
+                                                    uint32_t invalid_custom_value,
+                                                    uint16_t *transformed_depth_image,
+                                                    uint8_t *transformed_custom_image)
+{
+    cl_int format = CLWRAPPER_CUSTOM_FORMAT_NONE;
+    size_t custom_pixel_size = sizeof(uint8_t);
+    if (custom_format == K4A_IMAGE_FORMAT_CUSTOM8)
+    {
+        format = CLWRAPPER_CUSTOM_FORMAT_8;
+    }
+    else if (custom_format == K4A_IMAGE_FORMAT_CUSTOM16)
+    {
+        format = CLWRAPPER_CUSTOM_FORMAT_16;
+        custom_pixel_size = sizeof(uint16_t);
+    }
+
+    cl_int linear = interpolation_type == K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR;
+    cl_int depth_width = clwrapper->depth_width;
+    cl_int depth_height = clwrapper->depth_height;
+    cl_int color_width = clwrapper->color_width;
+    cl_int color_height = clwrapper->color_height;
+    cl_int color_pixel_count = color_width * color_height;
+    size_t depth_pixels = (size_t)depth_width * (size_t)depth_height;
+    size_t color_pixels = (size_t)color_pixel_count;
+
+    // Kernels without a custom image still get a buffer bound, it is never read or written
+    if (K4A_FAILED(TRACE_CALL(clwrapper_compute_correspondences(clwrapper, depth_image))) ||
+        K4A_FAILED(TRACE_CALL(
+            clwrapper_ensure_buffer(clwrapper, CLWRAPPER_BUFFER_CUSTOM, depth_pixels * custom_pixel_size))) ||
+        K4A_FAILED(
+            TRACE_CALL(clwrapper_ensure_buffer(clwrapper, CLWRAPPER_BUFFER_PACKED, color_pixels * sizeof(uint32_t)))) ||
+        K4A_FAILED(TRACE_CALL(clwrapper_ensure_buffer(
+            clwrapper, CLWRAPPER_BUFFER_TRANSFORMED_DEPTH, color_pixels * sizeof(uint16_t)))) ||
+        K4A_FAILED(TRACE_CALL(clwrapper_ensure_buffer(
+            clwrapper, CLWRAPPER_BUFFER_TRANSFORMED_CUSTOM, color_pixels * custom_pixel_size))))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    if (format != CLWRAPPER_CUSTOM_FORMAT_NONE &&
+        K4A_FAILED(TRACE_CALL(clwrapper_write_buffer(
+            clwrapper, CLWRAPPER_BUFFER_CUSTOM, 0, custom_image, depth_pixels * custom_pixel_size))))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    cl_uint packed_empty = 0xFFFFFFFF;
+    if (K4A_FAILED(clwrapper_check(clEnqueueFillBuffer(clwrapper->queue,
+                                                       clwrapper->buffers[CLWRAPPER_BUFFER_PACKED].mem,
+                                                       &packed_empty,
+                                                       sizeof(packed_empty),
+                                                       0,
+                                                       color_pixels * sizeof(uint32_t),
+                                                       0,
+                                                       NULL,
+                                                       NULL),
+                                   "clEnqueueFillBuffer")))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    cl_kernel kernel = clwrapper->kernels[CLWRAPPER_KERNEL_DEPTH_TO_COLOR_QUADS];
+    cl_int status = CL_SUCCESS;
+    status |= clSetKernelArg(kernel, 0, sizeof(cl_mem), &clwrapper->buffers[CLWRAPPER_BUFFER_CORRESPONDENCES].mem);
+    status |= clSetKernelArg(kernel, 1, sizeof(cl_mem), &clwrapper->buffers[CLWRAPPER_BUFFER_CUSTOM].mem);
+    status |= clSetKernelArg(kernel, 2, sizeof(cl_int), &format);
+    status |= clSetKernelArg(kernel, 3, sizeof(cl_int), &linear);
+    status |= clSetKernelArg(kernel, 4, sizeof(cl_int), &depth_width);
+    status |= clSetKernelArg(kernel, 5, sizeof(cl_int), &depth_height);
+    status |= clSetKernelArg(kernel, 6, sizeof(cl_int), &color_width);
+    status |= clSetKernelArg(kernel, 7, sizeof(cl_int), &color_height);
+    status |= clSetKernelArg(kernel, 8, sizeof(cl_mem), &clwrapper->buffers[CLWRAPPER_BUFFER_PACKED].mem);
+
+    kernel = clwrapper->kernels[CLWRAPPER_KERNEL_DEPTH_TO_COLOR_RESOLVE];
+    status |= clSetKernelArg(kernel, 0, sizeof(cl_mem), &clwrapper->buffers[CLWRAPPER_BUFFER_PACKED].mem);
+    status |= clSetKernelArg(kernel, 1, sizeof(cl_int), &color_pixel_count);
+    status |= clSetKernelArg(kernel, 2, sizeof(cl_int), &format);
+    status |= clSetKernelArg(kernel, 3, sizeof(cl_uint), &invalid_custom_value);
+    status |= clSetKernelArg(kernel, 4, sizeof(cl_mem), &clwrapper->buffers[CLWRAPPER_BUFFER_TRANSFORMED_DEPTH].mem);
+    status |= clSetKernelArg(kernel, 5, sizeof(cl_mem), &clwrapper->buffers[CLWRAPPER_BUFFER_TRANSFORMED_CUSTOM].mem);
+    if (K4A_FAILED(clwrapper_check(status, "clSetKernelArg")))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    clwrapper->transformed_depth_valid = false;
+    clwrapper->transformed_custom_valid = false;
+    if (K4A_FAILED(TRACE_CALL(clwrapper_run_kernel(clwrapper,
+                                                   CLWRAPPER_KERNEL_DEPTH_TO_COLOR_QUADS,
+                                                   2,
+                                                   (size_t)(depth_width - 1),
+                                                   (size_t)(depth_height - 1)))) ||
+        K4A_FAILED(TRACE_CALL(
+            clwrapper_run_kernel(clwrapper, CLWRAPPER_KERNEL_DEPTH_TO_COLOR_RESOLVE, 1, color_pixels, 1))) ||
+        K4A_FAILED(TRACE_CALL(clwrapper_read_buffer(
+            clwrapper, CLWRAPPER_BUFFER_TRANSFORMED_DEPTH, transformed_depth_image, color_pixels * sizeof(uint16_t)))))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    if (format != CLWRAPPER_CUSTOM_FORMAT_NONE &&
+        K4A_FAILED(TRACE_CALL(clwrapper_read_buffer(clwrapper,
+                                                    CLWRAPPER_BUFFER_TRANSFORMED_CUSTOM,
+                                                    transformed_custom_image,
+                                                    color_pixels * custom_pixel_size))))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    clwrapper->transformed_depth_valid = true;
+    clwrapper->transformed_custom_valid = format != CLWRAPPER_CUSTOM_FORMAT_NONE;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t clwrapper_depth_to_color(clwrapper_t clwrapper_handle,
+                                      const uint16_t *depth_image,
+                                      const uint8_t *custom_image,
+                                      k4a_image_format_t custom_format,
+                                      k4a_transformation_interpolation_type_t interpolation_type,
+                                      uint32_t invalid_custom_value,
+                                      uint16_t *transformed_depth_image,
+                                      uint8_t *transformed_custom_image)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, clwrapper_t, clwrapper_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, depth_image == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED,
+                        custom_image == NULL &&
+                            (custom_format == K4A_IMAGE_FORMAT_CUSTOM8 || custom_format == K4A_IMAGE_FORMAT_CUSTOM16));
+    clwrapper_context_t *clwrapper = clwrapper_t_get_context(clwrapper_handle);
+
+    Lock(clwrapper->lock);
+    k4a_result_t result = TRACE_CALL(clwrapper_depth_to_color_locked(clwrapper,
+                                                                     depth_image,
+                                                                     custom_image,
+                                                                     custom_format,
+                                                                     interpolation_type,
+                                                                     invalid_custom_value,
+                                                                     transformed_depth_image,
+                                                                     transformed_custom_image));
+    k4a_result_t release_result = TRACE_CALL(clwrapper_release_gl_objects(clwrapper));
+    Unlock(clwrapper->lock);
+    return K4A_SUCCEEDED(result) ? release_result : result;
+}
+
+static k4a_result_t clwrapper_color_to_depth_locked(clwrapper_context_t *clwrapper,
+                                                    const uint16_t *depth_image,
+                                                    const uint8_t *color_image,
+                                                    uint8_t *transformed_color_image)
+{
+    cl_int color_width = clwrapper->color_width;
+    cl_int color_height = clwrapper->color_height;
+    cl_int pixel_count = clwrapper->depth_width * clwrapper->depth_height;
+    size_t color_size = (size_t)color_width * (size_t)color_height * 4 * sizeof(uint8_t);
+    size_t transformed_color_size = (size_t)pixel_count * 4 * sizeof(uint8_t);
+
+    if (K4A_FAILED(TRACE_CALL(clwrapper_compute_correspondences(clwrapper, depth_image))) ||
+        K4A_FAILED(TRACE_CALL(clwrapper_ensure_buffer(clwrapper, CLWRAPPER_BUFFER_COLOR, color_size))) ||
+        K4A_FAILED(TRACE_CALL(
+            clwrapper_ensure_buffer(clwrapper, CLWRAPPER_BUFFER_TRANSFORMED_COLOR, transformed_color_size))) ||
+        K4A_FAILED(TRACE_CALL(clwrapper_write_buffer(clwrapper, CLWRAPPER_BUFFER_COLOR, 0, color_image, color_size))))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    cl_kernel kernel = clwrapper->kernels[CLWRAPPER_KERNEL_COLOR_TO_DEPTH];
+    cl_int status = CL_SUCCESS;
+    status |= clSetKernelArg(kernel, 0, sizeof(cl_mem), &clwrapper->buffers[CLWRAPPER_BUFFER_CORRESPONDENCES].mem);
+    status |= clSetKernelArg(kernel, 1, sizeof(cl_mem), &clwrapper->buffers[CLWRAPPER_BUFFER_COLOR].mem);
+    status |= clSetKernelArg(kernel, 2, sizeof(cl_int), &color_width);
+    status |= clSetKernelArg(kernel, 3, sizeof(cl_int), &color_height);
+    status |= clSetKernelArg(kernel, 4, sizeof(cl_int), &pixel_count);
+    status |= clSetKernelArg(kernel, 5, sizeof(cl_mem), &clwrapper->buffers[CLWRAPPER_BUFFER_TRANSFORMED_COLOR].mem);
+    if (K4A_FAILED(clwrapper_check(status, "clSetKernelArg")))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    clwrapper->transformed_color_valid = false;
+    if (K4A_FAILED(
+            TRACE_CALL(clwrapper_run_kernel(clwrapper, CLWRAPPER_KERNEL_COLOR_TO_DEPTH, 1, (size_t)pixel_count, 1))) ||
+        K4A_FAILED(TRACE_CALL(clwrapper_read_buffer(
+            clwrapper, CLWRAPPER_BUFFER_TRANSFORMED_COLOR, transformed_color_image, transformed_color_size))))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    clwrapper->transformed_color_valid = true;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t clwrapper_color_to_depth(clwrapper_t clwrapper_handle,
+                                      const uint16_t *depth_image,
+                                      const uint8_t *color_image,
+                                      uint8_t *transformed_color_image)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, clwrapper_t, clwrapper_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, depth_image == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, color_image == NULL);
+    clwrapper_context_t *clwrapper = clwrapper_t_get_context(clwrapper_handle);
+
+    Lock(clwrapper->lock);
+    k4a_result_t result = TRACE_CALL(
+        clwrapper_color_to_depth_locked(clwrapper, depth_image, color_image, transformed_color_image));
+    k4a_result_t release_result = TRACE_CALL(clwrapper_release_gl_objects(clwrapper));
+    Unlock(clwrapper->lock);
+    return K4A_SUCCEEDED(result) ? release_result : result;
+}
+
+static k4a_result_t clwrapper_depth_to_point_cloud_locked(clwrapper_context_t *clwrapper,
+                                                          k4a_calibration_type_t camera,
+                                                          const uint16_t *depth_image,
+                                                          int16_t *xyz_image)
+{
+    const k4a_transformation_xy_tables_t *xy_tables = clwrapper->depth_camera_xy_tables;
+    clwrapper_buffer_type_t xy_tables_buffer = CLWRAPPER_BUFFER_DEPTH_XY_TABLES;
+    bool *uploaded = &clwrapper->depth_xy_tables_uploaded;
+    if (camera == K4A_CALIBRATION_TYPE_COLOR)
+    {
+        xy_tables = clwrapper->color_camera_xy_tables;
+        xy_tables_buffer = CLWRAPPER_BUFFER_COLOR_XY_TABLES;
+        uploaded = &clwrapper->color_xy_tables_uploaded;
+    }
+
+    cl_int pixel_count = xy_tables->width * xy_tables->height;
+    size_t table_size = (size_t)pixel_count * sizeof(float);
+    size_t depth_size = (size_t)pixel_count * sizeof(uint16_t);
+    size_t xyz_size = (size_t)pixel_count * 3 * sizeof(int16_t);
+
+    if (!*uploaded)
+    {
+        if (K4A_FAILED(TRACE_CALL(clwrapper_ensure_buffer(clwrapper, xy_tables_buffer, 2 * table_size))) ||
+            K4A_FAILED(
+                TRACE_CALL(clwrapper_write_buffer(clwrapper, xy_tables_buffer, 0, xy_tables->x_table, table_size))) ||
+            K4A_FAILED(TRACE_CALL(
+                clwrapper_write_buffer(clwrapper, xy_tables_buffer, table_size, xy_tables->y_table, table_size))))
+        {
+            return K4A_RESULT_FAILED;
+        }
+        *uploaded = true;
+    }
+
+    if (K4A_FAILED(TRACE_CALL(clwrapper_ensure_buffer(clwrapper, CLWRAPPER_BUFFER_DEPTH, depth_size))) ||
+        K4A_FAILED(TRACE_CALL(clwrapper_ensure_buffer(clwrapper, CLWRAPPER_BUFFER_XYZ, xyz_size))) ||
+        K4A_FAILED(TRACE_CALL(clwrapper_write_buffer(clwrapper, CLWRAPPER_BUFFER_DEPTH, 0, depth_image, depth_size))))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    cl_kernel kernel = clwrapper->kernels[CLWRAPPER_KERNEL_DEPTH_TO_XYZ];
+    cl_int status = CL_SUCCESS;
+    status |= clSetKernelArg(kernel, 0, sizeof(cl_mem), &clwrapper->buffers[CLWRAPPER_BUFFER_DEPTH].mem);
+    status |= clSetKernelArg(kernel, 1, sizeof(cl_mem), &clwrapper->buffers[xy_tables_buffer].mem);
+    status |= clSetKernelArg(kernel, 2, sizeof(cl_int), &pixel_count);
+    status |= clSetKernelArg(kernel, 3, sizeof(cl_mem), &clwrapper->buffers[CLWRAPPER_BUFFER_XYZ].mem);
+    if (K4A_FAILED(clwrapper_check(status, "clSetKernelArg")))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    clwrapper->xyz_valid = false;
+    if (K4A_FAILED(
+            TRACE_CALL(clwrapper_run_kernel(clwrapper, CLWRAPPER_KERNEL_DEPTH_TO_XYZ, 1, (size_t)pixel_count, 1))) ||
+        K4A_FAILED(TRACE_CALL(clwrapper_read_buffer(clwrapper, CLWRAPPER_BUFFER_XYZ, xyz_image, xyz_size))))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    clwrapper->xyz_valid = true;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t clwrapper_depth_to_point_cloud(clwrapper_t clwrapper_handle,
+                                            k4a_calibration_type_t camera,
+                                            const uint16_t *depth_image,
+                                            int16_t *xyz_image)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, clwrapper_t, clwrapper_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED,
+                        camera != K4A_CALIBRATION_TYPE_DEPTH && camera != K4A_CALIBRATION_TYPE_COLOR);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, depth_image == NULL);
+    clwrapper_context_t *clwrapper = clwrapper_t_get_context(clwrapper_handle);
+
+    Lock(clwrapper->lock);
+    k4a_result_t result = TRACE_CALL(clwrapper_depth_to_point_cloud_locked(clwrapper, camera, depth_image, xyz_image));
+    k4a_result_t release_result = TRACE_CALL(clwrapper_release_gl_objects(clwrapper));
+    Unlock(clwrapper->lock);
+    return K4A_SUCCEEDED(result) ? release_result : result;
+}
+
+// Buffer and valid flag of output, NULL if output is unknown
+static bool *clwrapper_get_output_buffer(clwrapper_context_t *clwrapper,
+                                         k4a_transformation_gpu_output_t output,
+                                         clwrapper_buffer_type_t *type)
+{
+    switch (output)
+    {
+    case K4A_TRANSFORMATION_GPU_OUTPUT_TRANSFORMED_DEPTH:
+        *type = CLWRAPPER_BUFFER_TRANSFORMED_DEPTH;
+        return &clwrapper->transformed_depth_valid;
+    case K4A_TRANSFORMATION_GPU_OUTPUT_TRANSFORMED_CUSTOM:
+        *type = CLWRAPPER_BUFFER_TRANSFORMED_CUSTOM;
+        return &clwrapper->transformed_custom_valid;
+    case K4A_TRANSFORMATION_GPU_OUTPUT_TRANSFORMED_COLOR:
+        *type = CLWRAPPER_BUFFER_TRANSFORMED_COLOR;
+        return &clwrapper->transformed_color_valid;
+    case K4A_TRANSFORMATION_GPU_OUTPUT_POINT_CLOUD:
+        *type = CLWRAPPER_BUFFER_XYZ;
+        return &clwrapper->xyz_valid;
+    default:
+        LOG_ERROR("Unexpected GPU output %d.", output);
+        return NULL;
+    }
+}
+
+k4a_result_t clwrapper_get_output(clwrapper_t clwrapper_handle, k4a_transformation_gpu_output_t output, void **buffer)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, clwrapper_t, clwrapper_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, buffer == NULL);
+    clwrapper_context_t *clwrapper = clwrapper_t_get_context(clwrapper_handle);
+
+    *buffer = NULL;
+    bool valid = false;
+    clwrapper_buffer_type_t type = CLWRAPPER_BUFFER_TRANSFORMED_DEPTH;
+
+    Lock(clwrapper->lock);
+    const bool *output_valid = clwrapper_get_output_buffer(clwrapper, output, &type);
+    if (output_valid != NULL && *output_valid)
+    {
+        valid = true;
+        *buffer = (void *)clwrapper->buffers[type].mem;
+    }
+    Unlock(clwrapper->lock);
+
+    if (!valid)
+    {
+        LOG_ERROR("The GPU output %d has not been produced by a transformation yet.", output);
+        return K4A_RESULT_FAILED;
+    }
+    return K4A_RESULT_SUCCEEDED;
+}
+
+// Wraps target in a cl_mem of the context, which holds a reference to it
+static cl_mem clwrapper_open_target(clwrapper_context_t *clwrapper,
+                                    k4a_transformation_gpu_target_t target_type,
+                                    void *target,
+                                    size_t *size)
+{
+    cl_int status = CL_SUCCESS;
+    cl_mem mem = NULL;
+    if (target_type == K4A_TRANSFORMATION_GPU_TARGET_OPENCL_BUFFER)
+    {
+        cl_context context = NULL;
+        mem = (cl_mem)target;
+        if (K4A_FAILED(clwrapper_check(clGetMemObjectInfo(mem, CL_MEM_CONTEXT, sizeof(context), &context, NULL),
+                                       "clGetMemObjectInfo")))
+        {
+            return NULL;
+        }
+        if (context != clwrapper->context)
+        {
+            LOG_ERROR("The GPU output target belongs to another OpenCL context than the transformation.", 0);
+            return NULL;
+        }
+        if (K4A_FAILED(clwrapper_check(clRetainMemObject(mem), "clRetainMemObject")))
+        {
+            return NULL;
+        }
+    }
+    else
+    {
+        mem = clCreateFromGLBuffer(clwrapper->context, CL_MEM_READ_WRITE, (cl_GLuint)(uintptr_t)target, &status);
+        if (K4A_FAILED(clwrapper_check(status, "clCreateFromGLBuffer")))
+        {
+            return NULL;
+        }
+    }
+
+    if (K4A_FAILED(clwrapper_check(clGetMemObjectInfo(mem, CL_MEM_SIZE, sizeof(*size), size, NULL),
+                                   "clGetMemObjectInfo")))
+    {
+        clReleaseMemObject(mem);
+        return NULL;
+    }
+    return mem;
+}
+
+k4a_result_t clwrapper_set_output_target(clwrapper_t clwrapper_handle,
+                                         k4a_transformation_gpu_output_t output,
+                                         k4a_transformation_gpu_target_t target_type,
+                                         void *target)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, clwrapper_t, clwrapper_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED,
+                        target_type != K4A_TRANSFORMATION_GPU_TARGET_NONE &&
+                            target_type != K4A_TRANSFORMATION_GPU_TARGET_OPENCL_BUFFER &&
+                            target_type != K4A_TRANSFORMATION_GPU_TARGET_OPENGL_BUFFER);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED,
+                        target_type == K4A_TRANSFORMATION_GPU_TARGET_OPENCL_BUFFER && target == NULL);
+    clwrapper_context_t *clwrapper = clwrapper_t_get_context(clwrapper_handle);
+
+    k4a_result_t result = K4A_RESULT_SUCCEEDED;
+    clwrapper_buffer_type_t type = CLWRAPPER_BUFFER_TRANSFORMED_DEPTH;
+
+    Lock(clwrapper->lock);
+    bool *output_valid = clwrapper_get_output_buffer(clwrapper, output, &type);
+    cl_mem mem = NULL;
+    size_t size = 0;
+    if (output_valid == NULL)
+    {
+        result = K4A_RESULT_FAILED;
+    }
+    else if (target_type != K4A_TRANSFORMATION_GPU_TARGET_NONE)
+    {
+        mem = clwrapper_open_target(clwrapper, target_type, target, &size);
+        result = K4A_RESULT_FROM_BOOL(mem != NULL);
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        // The previous buffer is released, a buffer of the transformation is allocated again on next use
+        clwrapper_buffer_t *buffer = &clwrapper->buffers[type];
+        if (buffer->mem != NULL)
+        {
+            clFinish(clwrapper->queue);
+            clReleaseMemObject(buffer->mem);
+        }
+        buffer->mem = mem;
+        buffer->size = size;
+        buffer->target = mem != NULL;
+        buffer->gl_object = target_type == K4A_TRANSFORMATION_GPU_TARGET_OPENGL_BUFFER;
+        buffer->acquired = false;
+        *output_valid = false;
+    }
+    Unlock(clwrapper->lock);
+    return result;
+}
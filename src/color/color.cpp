@@ -5,6 +5,7 @@
 #include <k4ainternal/color.h>
 
 // Dependent libraries
+#include <azure_c_shared_utility/lock.h>
 
 // System dependencies
 #include <stdlib.h>
@@ -26,8 +27,20 @@
 extern "C" {
 #endif
 
+// Auto mode values change on the device without a set, so their shadow is re-read once it is this old
+#define COLOR_CONTROL_AUTO_REFRESH_MS 100
+
 color_cb_stream_t color_capture_available;
 
+// Host side shadow of a control's current value
+typedef struct _color_control_value_t
+{
+    k4a_color_control_mode_t mode;
+    int32_t value;
+    tickcounter_ms_t read_tick;
+    bool valid;
+} color_control_value_t;
+
 typedef struct _color_context_t
 {
     TICK_COUNTER_HANDLE tick;
@@ -35,6 +48,8 @@ typedef struct _color_context_t
     void *capture_ready_cb_context;
     tickcounter_ms_t sensor_start_time_tick;
     std::array<color_control_cap_t, K4A_COLOR_CONTROL_POWERLINE_FREQUENCY + 1> control_cap = {};
+    LOCK_HANDLE control_lock; // Protects control_value
+    std::array<color_control_value_t, K4A_COLOR_CONTROL_POWERLINE_FREQUENCY + 1> control_value = {};
 #ifdef _WIN32
     Microsoft::WRL::ComPtr<CMFCameraReader> m_spCameraReader;
 #else
@@ -65,7 +80,11 @@ k4a_result_t color_create(TICK_COUNTER_HANDLE tick_handle,
         color->capture_ready_cb_context = capture_ready_context;
         color->sensor_start_time_tick = 0;
         color->tick = tick_handle;
+        result = K4A_RESULT_FROM_BOOL((color->control_lock = Lock_Init()) != NULL);
+    }
 
+    if (K4A_SUCCEEDED(result))
+    {
 #ifdef _WIN32
         (void)(serial_number);
         static_assert(sizeof(guid_t) == sizeof(GUID), "Windows GUID and this guid_t are not the same");
@@ -105,6 +124,10 @@ void color_destroy(color_t color_handle)
         color->m_spCameraReader->Shutdown();
         color->m_spCameraReader = nullptr;
     }
+    if (color->control_lock)
+    {
+        Lock_Deinit(color->control_lock);
+    }
     color_t_destroy(color_handle);
 }
 
@@ -125,10 +148,13 @@ void color_capture_available(k4a_result_t result, k4a_capture_t capture_handle,
     }
 }
 
-k4a_result_t color_start(color_t color_handle, const k4a_device_configuration_t *config)
+k4a_result_t color_start(color_t color_handle,
+                         const k4a_device_configuration_t *config,
+                         const k4a_device_start_options_t *options)
 {
     RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, color_t, color_handle);
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, config == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, options == NULL);
     k4a_result_t result = K4A_RESULT_SUCCEEDED;
     color_context_t *color = color_t_get_context(color_handle);
     uint32_t width = 0;
@@ -184,6 +210,11 @@ k4a_result_t color_start(color_t color_handle, const k4a_device_configuration_t
 
     result = K4A_RESULT_FROM_BOOL(tickcounter_get_current_ms(color->tick, &color->sensor_start_time_tick) == 0);
 
+    if (K4A_SUCCEEDED(result))
+    {
+        result = TRACE_CALL(color->m_spCameraReader->SetPrefaultBuffers(options->prefault_buffers));
+    }
+
     if (K4A_SUCCEEDED(result))
     {
         result = TRACE_CALL(color->m_spCameraReader->Start(width,
@@ -219,6 +250,22 @@ void color_stop(color_t color_handle)
     return;
 }
 
+k4a_result_t color_set_allocator(color_t color_handle, const allocator_hook_t *hook)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, color_t, color_handle);
+    color_context_t *color = color_t_get_context(color_handle);
+
+    return TRACE_CALL(color->m_spCameraReader->SetAllocator(hook));
+}
+
+k4a_result_t color_set_decode(color_t color_handle, const k4a_color_decode_configuration_t *config)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, color_t, color_handle);
+    color_context_t *color = color_t_get_context(color_handle);
+
+    return TRACE_CALL(color->m_spCameraReader->SetDecodeConfiguration(config));
+}
+
 tickcounter_ms_t color_get_sensor_start_time_tick(const color_t handle)
 {
     RETURN_VALUE_IF_HANDLE_INVALID(0, color_t, handle);
@@ -278,8 +325,60 @@ k4a_result_t color_get_control(const color_t handle,
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, mode == NULL);
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, value == NULL);
     color_context_t *color = color_t_get_context(handle);
+    tickcounter_ms_t now = 0;
+    bool cached = false;
+
+    if (tickcounter_get_current_ms(color->tick, &now) == 0)
+    {
+        Lock(color->control_lock);
+        const color_control_value_t &shadow = color->control_value[command];
+        if (shadow.valid &&
+            (shadow.mode == K4A_COLOR_CONTROL_MODE_MANUAL || now - shadow.read_tick < COLOR_CONTROL_AUTO_REFRESH_MS))
+        {
+            *mode = shadow.mode;
+            *value = shadow.value;
+            cached = true;
+        }
+        Unlock(color->control_lock);
+    }
+
+    if (cached)
+    {
+        return K4A_RESULT_SUCCEEDED;
+    }
+    return TRACE_CALL(color_refresh_control(handle, command, mode, value));
+}
+
+k4a_result_t color_refresh_control(const color_t handle,
+                                   const k4a_color_control_command_t command,
+                                   k4a_color_control_mode_t *mode,
+                                   int32_t *value)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, color_t, handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED,
+                        command < K4A_COLOR_CONTROL_EXPOSURE_TIME_ABSOLUTE ||
+                            command > K4A_COLOR_CONTROL_POWERLINE_FREQUENCY);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, mode == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, value == NULL);
+    color_context_t *color = color_t_get_context(handle);
+    tickcounter_ms_t now = 0;
+
+    k4a_result_t result = color->m_spCameraReader->GetCameraControl(command, mode, value);
 
-    return color->m_spCameraReader->GetCameraControl(command, mode, value);
+    if (K4A_SUCCEEDED(result))
+    {
+        result = K4A_RESULT_FROM_BOOL(tickcounter_get_current_ms(color->tick, &now) == 0);
+    }
+
+    Lock(color->control_lock);
+    color_control_value_t &shadow = color->control_value[command];
+    shadow.valid = K4A_SUCCEEDED(result);
+    shadow.mode = *mode;
+    shadow.value = *value;
+    shadow.read_tick = now;
+    Unlock(color->control_lock);
+
+    return result;
 }
 
 k4a_result_t color_set_control(const color_t handle,
@@ -295,7 +394,25 @@ k4a_result_t color_set_control(const color_t handle,
                         mode != K4A_COLOR_CONTROL_MODE_AUTO && mode != K4A_COLOR_CONTROL_MODE_MANUAL);
     color_context_t *color = color_t_get_context(handle);
 
-    return color->m_spCameraReader->SetCameraControl(command, mode, value);
+    k4a_result_t result = color->m_spCameraReader->SetCameraControl(command, mode, value);
+
+    // The device may round the value, and some controls affect others (powerline frequency limits the exposure), so
+    // drop every shadow value and read back the one that was set.
+    Lock(color->control_lock);
+    for (color_control_value_t &shadow : color->control_value)
+    {
+        shadow.valid = false;
+    }
+    Unlock(color->control_lock);
+
+    if (K4A_SUCCEEDED(result))
+    {
+        k4a_color_control_mode_t read_mode;
+        int32_t read_value;
+        (void)color_refresh_control(handle, command, &read_mode, &read_value);
+    }
+
+    return result;
 }
 
 #ifdef __cplusplus
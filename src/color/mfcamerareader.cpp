@@ -231,7 +231,7 @@ HRESULT CMFCameraReader::RuntimeClassInitialize(GUID *containerId)
         }
 
         // Create Source Reader
-        if (FAILED(hr = MFCreateAttributes(&spAttributes, 3)))
+        if (FAILED(hr = MFCreateAttributes(&spAttributes, 4)))
         {
             LOG_ERROR("Failed to create attribute bag in open camera: 0x%08x", hr);
             return hr;
@@ -249,6 +249,14 @@ HRESULT CMFCameraReader::RuntimeClassInitialize(GUID *containerId)
             return hr;
         }
 
+        // BGRA32 streams decode MJPG with the hardware MJPG decoder when the GPU driver provides one, the source reader
+        // uses the software decoder otherwise
+        if (FAILED(hr = spAttributes->SetUINT32(MF_READWRITE_ENABLE_HARDWARE_TRANSFORMS, 1)))
+        {
+            LOG_ERROR("Failed to enable hardware transforms: 0x%08x", hr);
+            return hr;
+        }
+
         if (FAILED(hr = spAttributes->SetUINT32(MF_XVP_DISABLE_FRC, 1)))
         {
             LOG_ERROR("Failed to disable frame rate control: 0x%08x", hr);
@@ -502,6 +510,40 @@ void CMFCameraReader::Shutdown()
     m_spKsControl.Reset();
 }
 
+k4a_result_t CMFCameraReader::SetAllocator(const allocator_hook_t *hook)
+{
+    auto lock = m_lock.LockExclusive();
+
+    if (m_started)
+    {
+        LOG_ERROR("The allocator can not be changed while streaming", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    m_allocator = hook ? *hook : allocator_hook_t{};
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t CMFCameraReader::SetPrefaultBuffers(bool prefault)
+{
+    // Media Foundation allocates the sample buffers itself and frames are wrapped or copied per frame, there is no pool
+    // to pre-fault
+    (void)prefault;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t CMFCameraReader::SetDecodeConfiguration(const k4a_color_decode_configuration_t *config)
+{
+    // Media Foundation decodes the MJPG frames of BGRA32 streams and has no scaled decode, so only the full image is
+    // supported
+    if (config != NULL && !k4a_color_decode_is_full_resolution(config))
+    {
+        LOG_ERROR("Cropped or scaled color decode is not supported by the Media Foundation color reader", 0);
+        return K4A_RESULT_FAILED;
+    }
+    return K4A_RESULT_SUCCEEDED;
+}
+
 void CMFCameraReader::Stop()
 {
     HRESULT hr = S_OK;
@@ -994,7 +1036,7 @@ k4a_result_t CMFCameraReader::CreateImageCopy(CFrameContext *pFrameContext, k4a_
     size_t size = pFrameContext->GetFrameSize();
 
     k4a_result_t result;
-    uint8_t *buffer = allocator_alloc(ALLOCATION_SOURCE_COLOR, size);
+    uint8_t *buffer = allocator_alloc_hooked(&m_allocator, ALLOCATION_SOURCE_COLOR, size, ALLOCATOR_DEFAULT_ALIGNMENT);
     result = K4A_RESULT_FROM_BOOL(buffer != NULL);
 
     if (K4A_SUCCEEDED(result))
@@ -1064,7 +1106,8 @@ STDMETHODIMP CMFCameraReader::OnReadSample(HRESULT hrStatus,
 
                 if (K4A_SUCCEEDED(result))
                 {
-                    if (m_use_mf_buffer)
+                    // Media Foundation owns its buffers, so copy when the application provided an allocator or ring
+                    if (m_use_mf_buffer && !allocator_hook_is_set(&m_allocator, ALLOCATION_SOURCE_COLOR))
                     {
                         result = CreateImage(pFrameContext, &image);
                         FrameContextRefd = true;
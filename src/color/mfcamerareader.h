@@ -94,6 +94,12 @@ public:
 
     void Shutdown();
 
+    k4a_result_t SetAllocator(const allocator_hook_t *hook);
+
+    k4a_result_t SetPrefaultBuffers(bool prefault);
+
+    k4a_result_t SetDecodeConfiguration(const k4a_color_decode_configuration_t *config);
+
     k4a_result_t GetCameraControlCapabilities(const k4a_color_control_command_t command,
                                               color_control_cap_t *capabilities);
 
@@ -157,6 +163,7 @@ private:
     bool m_started = false;
     bool m_flushing = false;
     bool m_use_mf_buffer = true;
+    allocator_hook_t m_allocator = {}; // Allocator of copied color buffers, no callbacks for the process allocator
     bool m_using_60hz_power = true;
     HANDLE m_hStreamFlushed = NULL;
 
@@ -0,0 +1,200 @@
+#include "mjpegdecoder.h"
+#include <k4ainternal/common.h>
+#include <k4ainternal/logging.h>
+#include <azure_c_shared_utility/envvariable.h>
+
+// STL
+#include <cstring>
+#include <vector>
+
+// external
+#include "turbojpeg.h"
+
+class TurboJPEGDecoder : public MJPEGDecoder
+{
+public:
+    TurboJPEGDecoder(uint32_t width, uint32_t height) :
+        m_width_pixels(width),
+        m_height_pixels(height),
+        m_scaled_width_pixels(width),
+        m_scaled_height_pixels(height),
+        m_output_width_pixels(width),
+        m_output_height_pixels(height)
+    {
+    }
+
+    virtual ~TurboJPEGDecoder()
+    {
+        if (m_decoder)
+        {
+            (void)tjDestroy(m_decoder);
+        }
+    }
+
+    k4a_result_t Start(const k4a_color_decode_configuration_t *config)
+    {
+        if (config != nullptr)
+        {
+            if (!k4a_color_decode_get_output(config,
+                                             m_width_pixels,
+                                             m_height_pixels,
+                                             &m_crop,
+                                             &m_output_width_pixels,
+                                             &m_output_height_pixels))
+            {
+                LOG_ERROR("Invalid color decode configuration for %u x %u frames", m_width_pixels, m_height_pixels);
+                return K4A_RESULT_FAILED;
+            }
+
+            // libjpeg-turbo decodes the whole frame at the scale the output size is a ceiling of
+            uint32_t scale = config->scale_denominator;
+            m_scale_denominator = scale;
+            m_scaled_width_pixels = (m_width_pixels + scale - 1) / scale;
+            m_scaled_height_pixels = (m_height_pixels + scale - 1) / scale;
+            if (m_output_width_pixels != m_scaled_width_pixels || m_output_height_pixels != m_scaled_height_pixels)
+            {
+                m_scaled_frame.resize((size_t)m_scaled_width_pixels * m_scaled_height_pixels * 4);
+            }
+        }
+
+        m_decoder = tjInitDecompress();
+        if (m_decoder == nullptr)
+        {
+            LOG_ERROR("MJPEG decoder initialization failed\n", 0);
+            return K4A_RESULT_FAILED;
+        }
+        return K4A_RESULT_SUCCEEDED;
+    }
+
+    const char *Name() const override
+    {
+        return "turbojpeg";
+    }
+
+    bool IsSoftware() const override
+    {
+        return true;
+    }
+
+    k4a_result_t DecodeToBGRA32(const uint8_t *in_buf, size_t in_size, uint8_t *out_buf, size_t out_size) override
+    {
+        RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, (size_t)m_output_width_pixels * m_output_height_pixels * 4 > out_size);
+
+        // Cropped frames are decoded to m_scaled_frame, the others straight to the output
+        bool cropped = !m_scaled_frame.empty();
+        int decompressStatus = tjDecompress2(m_decoder,
+                                             const_cast<uint8_t *>(in_buf),
+                                             (unsigned long)in_size,
+                                             cropped ? m_scaled_frame.data() : out_buf,
+                                             (int)m_scaled_width_pixels,
+                                             0, // pitch
+                                             (int)m_scaled_height_pixels,
+                                             TJPF_BGRA,
+                                             TJFLAG_FASTDCT | TJFLAG_FASTUPSAMPLE);
+
+        if (decompressStatus != 0)
+        {
+            // This can happen when the host PC is not reading data off the camera fast enough. We also have the option
+            // to move the use of libjpeg-turbo to a more recent version and use tjGetErrorCode() to get a better
+            // understanding of the status returned.
+            LOG_WARNING("MJPEG decode failed, dropping image: %d", decompressStatus);
+            return K4A_RESULT_FAILED;
+        }
+
+        if (cropped)
+        {
+            size_t row_size = (size_t)m_output_width_pixels * 4;
+            const uint8_t *row = m_scaled_frame.data() +
+                                 ((size_t)(m_crop.y / (int32_t)m_scale_denominator) * m_scaled_width_pixels +
+                                  (size_t)(m_crop.x / (int32_t)m_scale_denominator)) *
+                                     4;
+            for (uint32_t y = 0; y < m_output_height_pixels; y++)
+            {
+                memcpy(out_buf + y * row_size, row, row_size);
+                row += (size_t)m_scaled_width_pixels * 4;
+            }
+        }
+
+        return K4A_RESULT_SUCCEEDED;
+    }
+
+private:
+    uint32_t m_width_pixels;
+    uint32_t m_height_pixels;
+    uint32_t m_scale_denominator = 1;
+    uint32_t m_scaled_width_pixels; // Frame decoded at the output scale
+    uint32_t m_scaled_height_pixels;
+    k4a_rect_t m_crop = {};
+    uint32_t m_output_width_pixels;
+    uint32_t m_output_height_pixels;
+    std::vector<uint8_t> m_scaled_frame; // Whole scaled frame of cropped outputs
+    tjhandle m_decoder = nullptr;
+};
+
+std::unique_ptr<MJPEGDecoder>
+CreateTurboJPEGDecoder(uint32_t width, uint32_t height, const k4a_color_decode_configuration_t *config)
+{
+    std::unique_ptr<TurboJPEGDecoder> decoder(new TurboJPEGDecoder(width, height));
+    if (K4A_FAILED(decoder->Start(config)))
+    {
+        return nullptr;
+    }
+    return std::unique_ptr<MJPEGDecoder>(decoder.release());
+}
+
+std::unique_ptr<MJPEGDecoder>
+CreateMJPEGDecoder(uint32_t width, uint32_t height, const k4a_color_decode_configuration_t *config)
+{
+    if (config != nullptr && !k4a_color_decode_is_full_resolution(config))
+    {
+        std::unique_ptr<MJPEGDecoder> decoder = CreateTurboJPEGDecoder(width, height, config);
+        if (decoder)
+        {
+            LOG_INFO("Decoding %u x %u MJPG color frames at 1/%u scale with %s",
+                     width,
+                     height,
+                     config->scale_denominator,
+                     decoder->Name());
+        }
+        return decoder;
+    }
+
+    const char *backend = environment_get_variable("K4A_COLOR_MJPEG_DECODER");
+    if (backend == NULL || backend[0] == '\0')
+    {
+        backend = "auto";
+    }
+
+    std::unique_ptr<MJPEGDecoder> decoder;
+    if (strcmp(backend, "turbojpeg") == 0)
+    {
+        decoder = CreateTurboJPEGDecoder(width, height, nullptr);
+    }
+    else if (strcmp(backend, "v4l2") == 0)
+    {
+        decoder = CreateV4L2MJPEGDecoder(width, height);
+        if (!decoder)
+        {
+            LOG_ERROR("K4A_COLOR_MJPEG_DECODER=v4l2 but no V4L2 decoder can decode %u x %u MJPG frames", width, height);
+        }
+    }
+    else
+    {
+        if (strcmp(backend, "auto") != 0)
+        {
+            LOG_WARNING("Ignoring K4A_COLOR_MJPEG_DECODER=%s, it must be auto, v4l2 or turbojpeg", backend);
+        }
+
+        decoder = CreateV4L2MJPEGDecoder(width, height);
+        if (!decoder)
+        {
+            decoder = CreateTurboJPEGDecoder(width, height, nullptr);
+        }
+    }
+
+    if (decoder)
+    {
+        LOG_INFO("Decoding %u x %u MJPG color frames with %s", width, height, decoder->Name());
+    }
+    return decoder;
+}
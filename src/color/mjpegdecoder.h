@@ -0,0 +1,41 @@
+#ifndef MJPEGDECODER_H
+#define MJPEGDECODER_H
+// k4a
+#include <k4a/k4atypes.h>
+
+// STL
+#include <memory>
+
+// Decodes the MJPG frames of a color stream to BGRA32 for UVCCameraReader. One decoder is used by one stream, from the
+// libuvc callback thread.
+class MJPEGDecoder
+{
+public:
+    virtual ~MJPEGDecoder() {}
+
+    // Name of the backend, for logging
+    virtual const char *Name() const = 0;
+
+    // True if the frames are decoded by the CPU, such decoders are the fallback of the others
+    virtual bool IsSoftware() const = 0;
+
+    // Decodes one frame to a BGRA32 buffer of the output size the decoder was created for, with a stride of 4 bytes per
+    // pixel and at least output width * output height * 4 bytes
+    virtual k4a_result_t DecodeToBGRA32(const uint8_t *in_buf, size_t in_size, uint8_t *out_buf, size_t out_size) = 0;
+};
+
+// Backends, each returns a decoder ready for width x height frames, or nullptr if it can't be used on this host. The
+// output is the full frame unless a libjpeg-turbo decoder is given a decode configuration, which must be valid for
+// the resolution.
+std::unique_ptr<MJPEGDecoder>
+CreateTurboJPEGDecoder(uint32_t width, uint32_t height, const k4a_color_decode_configuration_t *config);
+std::unique_ptr<MJPEGDecoder> CreateV4L2MJPEGDecoder(uint32_t width, uint32_t height);
+
+// Started decoder for width x height frames cropped and scaled by config, or nullptr if none can be created. The
+// K4A_COLOR_MJPEG_DECODER environment variable selects the backend: "auto" (the default) uses the first hardware
+// decoder found and falls back to "turbojpeg", "v4l2" requires a V4L2 memory to memory decoder, "turbojpeg" always
+// decodes with libjpeg-turbo. Cropped or scaled frames are always decoded by libjpeg-turbo, which scales as it decodes.
+std::unique_ptr<MJPEGDecoder>
+CreateMJPEGDecoder(uint32_t width, uint32_t height, const k4a_color_decode_configuration_t *config);
+
+#endif // MJPEGDECODER_H
@@ -2,6 +2,9 @@
 #include "ksmetadata.h"
 #include <k4ainternal/common.h>
 #include <k4ainternal/capture.h>
+#include <k4ainternal/threadpolicy.h>
+#include <k4ainternal/tracing.h>
+#include <azure_c_shared_utility/envvariable.h>
 
 #define COLOR_CAMERA_VID 0x045e
 #define COLOR_CAMERA_PID 0x097d // K4A
@@ -13,6 +16,10 @@
 
 #define CONV_100USEC_TO_USEC (100)
 
+#define UVC_DEFAULT_DECODE_THREADS 2 // MJPEG decode workers of BGRA32 streams, 0 decodes on the libuvc thread
+#define UVC_MAX_DECODE_THREADS 8
+#define UVC_IMAGE_POOL_DEPTH 4 // Color images recycled while streaming, more are allocated when the user holds them
+
 // libUVC frame callback
 static void UVCFrameCallback(uvc_frame_t *frame, void *ptr)
 {
@@ -120,16 +127,6 @@ k4a_result_t UVCCameraReader::Start(const uint32_t width,
         m_output_image_format = imageFormat;
         m_input_image_format = K4A_IMAGE_FORMAT_COLOR_MJPG;
 
-        if (m_decoder == nullptr)
-        {
-            m_decoder = tjInitDecompress();
-            if (m_decoder == nullptr)
-            {
-                LOG_ERROR("MJPEG decoder initialization failed\n", 0);
-                return K4A_RESULT_FAILED;
-            }
-        }
-
         frameFormat = UVC_COLOR_FORMAT_MJPEG;
         break;
     default:
@@ -139,6 +136,21 @@ k4a_result_t UVCCameraReader::Start(const uint32_t width,
 
     m_width_pixels = width;
     m_height_pixels = height;
+    m_output_width_pixels = width;
+    m_output_height_pixels = height;
+
+    if (imageFormat == K4A_IMAGE_FORMAT_COLOR_BGRA32 &&
+        !k4a_color_decode_get_output(
+            &m_decode_config, width, height, NULL, &m_output_width_pixels, &m_output_height_pixels))
+    {
+        LOG_ERROR("The color decode crop does not fit in %u x %u images", width, height);
+        return K4A_RESULT_FAILED;
+    }
+
+    if (imageFormat == K4A_IMAGE_FORMAT_COLOR_BGRA32 && K4A_FAILED(StartDecodeWorkers(width, height)))
+    {
+        return K4A_RESULT_FAILED;
+    }
 
     // Set frame format
     uvc_error_t res =
@@ -152,21 +164,57 @@ k4a_result_t UVCCameraReader::Start(const uint32_t width,
                   (int)fps,
                   imageFormat,
                   uvc_strerror(res));
+        StopDecodeWorkers();
         return K4A_RESULT_FAILED;
     }
 
+    // Frames are copied out of the libuvc buffer, which is reused once the callback returns, into recycled buffers so
+    // streaming does not allocate and fault in a new color buffer per frame
+    size_t image_size = (size_t)width * height * 2;
+    if (imageFormat == K4A_IMAGE_FORMAT_COLOR_BGRA32)
+    {
+        image_size = (size_t)m_output_width_pixels * m_output_height_pixels * 4;
+    }
+    else if (imageFormat == K4A_IMAGE_FORMAT_COLOR_NV12)
+    {
+        image_size = (size_t)width * height * 3 / 2;
+    }
+    else if (imageFormat == K4A_IMAGE_FORMAT_COLOR_MJPG && ctrl.dwMaxVideoFrameSize != 0)
+    {
+        image_size = ctrl.dwMaxVideoFrameSize;
+    }
+
+    assert(m_image_pool == nullptr);
+    m_image_pool = allocator_pool_create(&m_allocator, ALLOCATION_SOURCE_COLOR, image_size, UVC_IMAGE_POOL_DEPTH);
+    if (m_image_pool == nullptr)
+    {
+        LOG_ERROR("Failed to allocate the color image buffers", 0);
+        StopDecodeWorkers();
+        return K4A_RESULT_FAILED;
+    }
+    if (m_prefault_buffers)
+    {
+        allocator_pool_prefault(m_image_pool);
+    }
+
     // Set callback
     m_pCallback = pCallback;
     m_pCallbackContext = pCallbackContext;
+    m_thread_policy_applied = false;
 
     res = uvc_start_streaming(m_pDeviceHandle, &ctrl, UVCFrameCallback, this, 0);
     if (res < 0)
     {
         LOG_ERROR("Failed to start streaming: %s", uvc_strerror(res));
+        StopDecodeWorkers();
+        allocator_pool_close(m_image_pool);
+        m_image_pool = nullptr;
 
         // Clear
         m_width_pixels = 0;
         m_height_pixels = 0;
+        m_output_width_pixels = 0;
+        m_output_height_pixels = 0;
         m_pCallback = nullptr;
         m_pCallbackContext = nullptr;
 
@@ -177,6 +225,56 @@ k4a_result_t UVCCameraReader::Start(const uint32_t width,
     return K4A_RESULT_SUCCEEDED;
 }
 
+k4a_result_t UVCCameraReader::SetAllocator(const allocator_hook_t *hook)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_streaming)
+    {
+        LOG_ERROR("The allocator can not be changed while streaming", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    m_allocator = hook ? *hook : allocator_hook_t{};
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t UVCCameraReader::SetPrefaultBuffers(bool prefault)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_streaming)
+    {
+        LOG_ERROR("Buffer pre-faulting can not be changed while streaming", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    m_prefault_buffers = prefault;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t UVCCameraReader::SetDecodeConfiguration(const k4a_color_decode_configuration_t *config)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_streaming)
+    {
+        LOG_ERROR("The color decode can not be changed while streaming", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    // The crop is checked against the resolution when the stream starts
+    if (config != NULL && !k4a_color_decode_get_output(config, INT32_MAX, INT32_MAX, NULL, NULL, NULL))
+    {
+        LOG_ERROR("Invalid color decode configuration, scale %u", config->scale_denominator);
+        return K4A_RESULT_FAILED;
+    }
+
+    m_decode_config = config ? *config : K4A_COLOR_DECODE_CONFIG_INIT_FULL_RESOLUTION;
+    m_decoder.reset();
+    return K4A_RESULT_SUCCEEDED;
+}
+
 void UVCCameraReader::Stop()
 {
     std::unique_lock<std::mutex> lock(m_mutex);
@@ -197,6 +295,11 @@ void UVCCameraReader::Stop()
         // Calling it with lock may cause deadlock.
         lock.unlock();
         uvc_stop_streaming(m_pDeviceHandle);
+        StopDecodeWorkers();
+
+        // Images still held by the user keep their buffers, the pool frees them when they are released
+        allocator_pool_close(m_image_pool);
+        m_image_pool = nullptr;
     }
 }
 
@@ -226,12 +329,10 @@ void UVCCameraReader::Shutdown()
         m_pContext = nullptr;
     }
 
-    if (m_decoder)
-    {
-        // Destroy MJPEG decoder
-        (void)tjDestroy(m_decoder);
-        m_decoder = nullptr;
-    }
+    // Destroy MJPEG decoder
+    m_decoder.reset();
+    m_decoder_width_pixels = 0;
+    m_decoder_height_pixels = 0;
 }
 
 k4a_result_t UVCCameraReader::GetCameraControlCapabilities(const k4a_color_control_command_t command,
@@ -1119,10 +1220,15 @@ void UVCCameraReader::Callback(uvc_frame_t *frame)
 {
     std::lock_guard<std::mutex> lock(m_mutex);
 
+    if (!m_thread_policy_applied)
+    {
+        // libuvc owns the thread delivering frames, so this is the first chance to apply the policy to it
+        threadpolicy_apply(K4A_SDK_THREAD_COLOR_READER);
+        m_thread_policy_applied = true;
+    }
+
     if (m_streaming && frame)
     {
-        void *context = nullptr;
-        k4a_image_t image = NULL;
         uint8_t *buffer = nullptr;
         size_t buffer_size = 0;
         int stride = 0;
@@ -1192,12 +1298,27 @@ void UVCCameraReader::Callback(uvc_frame_t *frame)
             return;
         }
 
+        color_frame_info_t info;
+        info.pts = framePTS;
+        uint64_t ts = (uint64_t)frame->capture_time_finished.tv_sec * 1000000000;
+        ts += (uint64_t)frame->capture_time_finished.tv_nsec;
+        info.system_timestamp_nsec = ts;
+        info.exposure_time = exposure_time;
+        info.iso_speed = iso_speed;
+        info.white_balance = white_balance;
+
         if (m_input_image_format == K4A_IMAGE_FORMAT_COLOR_MJPG &&
             m_output_image_format == K4A_IMAGE_FORMAT_COLOR_BGRA32)
         {
-            stride = (int)frame->width * 4;
-            buffer_size = (size_t)stride * frame->height;
+            stride = (int)m_output_width_pixels * 4;
+            buffer_size = (size_t)stride * m_output_height_pixels;
             decodeMJPEG = true;
+
+            if (!m_decode_workers.empty())
+            {
+                QueueDecode(frame, info);
+                return;
+            }
         }
         else
         {
@@ -1206,7 +1327,9 @@ void UVCCameraReader::Callback(uvc_frame_t *frame)
         }
 
         // Allocate K4A Color buffer
-        buffer = allocator_alloc(ALLOCATION_SOURCE_COLOR, buffer_size);
+        image_destroy_cb_t *buffer_destroy_cb = nullptr;
+        void *context = nullptr;
+        buffer = AllocateImageBuffer(buffer_size, &buffer_destroy_cb, &context);
         k4a_result_t result = K4A_RESULT_FROM_BOOL(buffer != NULL);
 
         if (K4A_SUCCEEDED(result))
@@ -1214,7 +1337,10 @@ void UVCCameraReader::Callback(uvc_frame_t *frame)
             if (decodeMJPEG)
             {
                 // Decode MJPG into BRGA32
-                result = DecodeMJPEGtoBGRA32((uint8_t *)frame->data, frame->data_bytes, buffer, buffer_size);
+                TRACE_SPAN_BEGIN("color decode", info.system_timestamp_nsec);
+                result = DecodeMJPEGtoBGRA32(
+                    m_decoder, (uint8_t *)frame->data, frame->data_bytes, buffer, buffer_size);
+                TRACE_SPAN_END("color decode", info.system_timestamp_nsec);
                 if (K4A_FAILED(result))
                 {
                     drop_image = true;
@@ -1227,92 +1353,286 @@ void UVCCameraReader::Callback(uvc_frame_t *frame)
             }
         }
 
-        if (K4A_SUCCEEDED(result))
+        PublishImage(result, buffer, buffer_size, buffer_destroy_cb, context, stride, info, drop_image);
+    }
+}
+
+uint8_t *UVCCameraReader::AllocateImageBuffer(size_t buffer_size,
+                                              image_destroy_cb_t **buffer_destroy_cb,
+                                              void **context)
+{
+    if (m_image_pool != nullptr && buffer_size <= allocator_pool_get_buffer_size(m_image_pool))
+    {
+        *buffer_destroy_cb = allocator_pool_free;
+        *context = m_image_pool;
+        return allocator_pool_alloc(m_image_pool, NULL);
+    }
+
+    // Larger than the frames the pool was sized for, which libuvc does not prevent for MJPG
+    *buffer_destroy_cb = uvc_camerareader_free_allocation;
+    *context = nullptr;
+    return allocator_alloc_hooked(&m_allocator, ALLOCATION_SOURCE_COLOR, buffer_size, ALLOCATOR_DEFAULT_ALIGNMENT);
+}
+
+// Takes over buffer, which is freed if result is a failure. Called with m_mutex held while streaming.
+void UVCCameraReader::PublishImage(k4a_result_t result,
+                                   uint8_t *buffer,
+                                   size_t buffer_size,
+                                   image_destroy_cb_t *buffer_destroy_cb,
+                                   void *context,
+                                   int stride,
+                                   const color_frame_info_t &info,
+                                   bool drop_image)
+{
+    k4a_image_t image = NULL;
+
+    if (K4A_SUCCEEDED(result))
+    {
+        // The buffer size may be larger than the height * stride for some formats
+        // so we must use image_create_from_buffer rather than image_create
+        result = TRACE_CALL(image_create_from_buffer(m_output_image_format,
+                                                     (int)m_output_width_pixels,
+                                                     (int)m_output_height_pixels,
+                                                     stride,
+                                                     buffer,
+                                                     buffer_size,
+                                                     buffer_destroy_cb,
+                                                     context,
+                                                     &image));
+    }
+    else
+    {
+        // cleanup if there was an error
+        if (buffer != NULL)
         {
-            // The buffer size may be larger than the height * stride for some formats
-            // so we must use image_create_from_buffer rather than image_create
-            result = TRACE_CALL(image_create_from_buffer(m_output_image_format,
-                                                         (int)m_width_pixels,
-                                                         (int)m_height_pixels,
-                                                         stride,
-                                                         buffer,
-                                                         buffer_size,
-                                                         uvc_camerareader_free_allocation,
-                                                         context,
-                                                         &image));
+            buffer_destroy_cb(buffer, context);
         }
-        else
+    }
+
+    k4a_capture_t capture = NULL;
+    if (K4A_SUCCEEDED(result))
+    {
+        result = TRACE_CALL(capture_create(&capture));
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        // Set metadata
+        image_set_system_timestamp_nsec(image, info.system_timestamp_nsec);
+        image_set_device_timestamp_usec(image, K4A_90K_HZ_TICK_TO_USEC(info.pts));
+        image_set_exposure_usec(image, info.exposure_time);
+        image_set_iso_speed(image, info.iso_speed);
+        image_set_white_balance(image, info.white_balance);
+
+        // Set image
+        capture_set_color_image(capture, image);
+    }
+
+    if (!drop_image)
+    {
+        // Calback to color
+        m_pCallback(result, capture, m_pCallbackContext);
+    }
+
+    if (image)
+    {
+        image_dec_ref(image);
+    }
+
+    if (capture)
+    {
+        // We guarantee that capture is valid for the duration of the callback function, if someone
+        // needs it to live longer, then they need to add a ref
+        capture_dec_ref(capture);
+    }
+}
+
+// Copies the MJPG frame for the decode workers, called on the libuvc thread with m_mutex held
+void UVCCameraReader::QueueDecode(uvc_frame_t *frame, const color_frame_info_t &info)
+{
+    std::lock_guard<std::mutex> lock(m_decode_mutex);
+
+    // Every worker busy with a frame waiting for each means the workers can't keep up, new frames are dropped rather
+    // than stalling the USB transfers
+    if (m_decode_jobs.size() >= m_decode_workers.size())
+    {
+        LOG_WARNING("MJPEG decode workers are behind, dropping color image", 0);
+        return;
+    }
+
+    decode_job_t job;
+    if (!m_decode_free_buffers.empty())
+    {
+        job.mjpeg = std::move(m_decode_free_buffers.back());
+        m_decode_free_buffers.pop_back();
+    }
+    job.mjpeg.assign((const uint8_t *)frame->data, (const uint8_t *)frame->data + frame->data_bytes);
+    job.info = info;
+    job.sequence = m_decode_next_sequence++;
+    m_decode_jobs.push_back(std::move(job));
+    m_decode_condition.notify_one();
+}
+
+void UVCCameraReader::DecodeThread(size_t worker_index)
+{
+    threadpolicy_apply(K4A_SDK_THREAD_COLOR_READER);
+    std::unique_ptr<MJPEGDecoder> &decoder = m_decode_workers[worker_index];
+
+    std::unique_lock<std::mutex> lock(m_decode_mutex);
+    while (true)
+    {
+        m_decode_condition.wait(lock, [this] { return m_decode_stop || !m_decode_jobs.empty(); });
+        if (m_decode_stop)
         {
-            // cleanup if there was an error
-            allocator_free(buffer);
+            break;
         }
 
-        k4a_capture_t capture = NULL;
+        decode_job_t job = std::move(m_decode_jobs.front());
+        m_decode_jobs.pop_front();
+        lock.unlock();
+
+        // Decode in parallel with the other workers, straight into the buffer of the image
+        int stride = (int)m_output_width_pixels * 4;
+        size_t buffer_size = (size_t)stride * m_output_height_pixels;
+        image_destroy_cb_t *buffer_destroy_cb = nullptr;
+        void *context = nullptr;
+        uint8_t *buffer = AllocateImageBuffer(buffer_size, &buffer_destroy_cb, &context);
+        k4a_result_t result = K4A_RESULT_FROM_BOOL(buffer != NULL);
+        bool drop_image = false;
         if (K4A_SUCCEEDED(result))
         {
-            result = TRACE_CALL(capture_create(&capture));
+            TRACE_SPAN_BEGIN("color decode", job.info.system_timestamp_nsec);
+            result = DecodeMJPEGtoBGRA32(decoder, job.mjpeg.data(), job.mjpeg.size(), buffer, buffer_size);
+            TRACE_SPAN_END("color decode", job.info.system_timestamp_nsec);
+            drop_image = K4A_FAILED(result);
         }
 
-        if (K4A_SUCCEEDED(result))
-        {
-            // Set metadata
-            uint64_t ts = (uint64_t)frame->capture_time_finished.tv_sec * 1000000000;
-            ts += (uint64_t)frame->capture_time_finished.tv_nsec;
-            image_set_system_timestamp_nsec(image, ts);
-            image_set_device_timestamp_usec(image, K4A_90K_HZ_TICK_TO_USEC(framePTS));
-            image_set_exposure_usec(image, exposure_time);
-            image_set_iso_speed(image, iso_speed);
-            image_set_white_balance(image, white_balance);
+        // Frames are published in the order they arrived, which is the order of their PTS
+        lock.lock();
+        m_decode_condition.wait(lock, [this, &job] {
+            return m_decode_stop || m_decode_next_delivery == job.sequence;
+        });
+        bool stopping = m_decode_stop;
+        m_decode_free_buffers.push_back(std::move(job.mjpeg));
+        lock.unlock();
 
-            // Set image
-            capture_set_color_image(capture, image);
+        {
+            std::lock_guard<std::mutex> stream_lock(m_mutex);
+            if (m_streaming && !stopping)
+            {
+                PublishImage(result, buffer, buffer_size, buffer_destroy_cb, context, stride, job.info, drop_image);
+                buffer = nullptr;
+            }
+        }
+        if (buffer)
+        {
+            buffer_destroy_cb(buffer, context);
         }
 
-        if (!drop_image)
+        lock.lock();
+        m_decode_next_delivery++;
+        m_decode_condition.notify_all();
+    }
+}
+
+// Creates the decode workers of a BGRA32 stream, K4A_COLOR_DECODE_THREADS of them
+k4a_result_t UVCCameraReader::StartDecodeWorkers(uint32_t width, uint32_t height)
+{
+    uint32_t thread_count = UVC_DEFAULT_DECODE_THREADS;
+    const char *env_threads = environment_get_variable("K4A_COLOR_DECODE_THREADS");
+    if (env_threads != NULL && env_threads[0] != '\0')
+    {
+        uint32_t threads = (uint32_t)strtoul(env_threads, NULL, 10);
+        if (threads <= UVC_MAX_DECODE_THREADS)
+        {
+            thread_count = threads;
+        }
+        else
         {
-            // Calback to color
-            m_pCallback(result, capture, m_pCallbackContext);
+            LOG_WARNING("Ignoring K4A_COLOR_DECODE_THREADS=%s, it must be 0 to %d",
+                        env_threads,
+                        UVC_MAX_DECODE_THREADS);
         }
+    }
 
-        if (image)
+    if (thread_count == 0)
+    {
+        // Frames are decoded on the libuvc thread
+        if (m_decoder == nullptr || m_decoder_width_pixels != width || m_decoder_height_pixels != height)
         {
-            image_dec_ref(image);
+            m_decoder = CreateMJPEGDecoder(width, height, &m_decode_config);
+            if (m_decoder == nullptr)
+            {
+                LOG_ERROR("MJPEG decoder initialization failed\n", 0);
+                return K4A_RESULT_FAILED;
+            }
+            m_decoder_width_pixels = width;
+            m_decoder_height_pixels = height;
         }
+        return K4A_RESULT_SUCCEEDED;
+    }
 
-        if (capture)
+    for (uint32_t i = 0; i < thread_count; i++)
+    {
+        std::unique_ptr<MJPEGDecoder> decoder = CreateMJPEGDecoder(width, height, &m_decode_config);
+        if (!decoder)
         {
-            // We guarantee that capture is valid for the duration of the callback function, if someone
-            // needs it to live longer, then they need to add a ref
-            capture_dec_ref(capture);
+            LOG_ERROR("MJPEG decoder initialization failed\n", 0);
+            m_decode_workers.clear();
+            return K4A_RESULT_FAILED;
         }
+        m_decode_workers.push_back(std::move(decoder));
     }
+
+    m_decode_stop = false;
+    m_decode_next_sequence = 0;
+    m_decode_next_delivery = 0;
+    for (size_t i = 0; i < m_decode_workers.size(); i++)
+    {
+        m_decode_threads.emplace_back(&UVCCameraReader::DecodeThread, this, i);
+    }
+    return K4A_RESULT_SUCCEEDED;
 }
 
-k4a_result_t
-UVCCameraReader::DecodeMJPEGtoBGRA32(uint8_t *in_buf, const size_t in_size, uint8_t *out_buf, const size_t out_size)
+// Stops the decode workers once libuvc delivers no more frames, frames not yet published are dropped
+void UVCCameraReader::StopDecodeWorkers()
 {
-    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, m_width_pixels * m_height_pixels * 4 > out_size);
-
-    int decompressStatus = tjDecompress2(m_decoder,
-                                         in_buf,
-                                         (unsigned long)in_size,
-                                         out_buf,
-                                         (int)m_width_pixels,
-                                         0, // pitch
-                                         (int)m_height_pixels,
-                                         TJPF_BGRA,
-                                         TJFLAG_FASTDCT | TJFLAG_FASTUPSAMPLE);
-
-    if (decompressStatus != 0)
-    {
-        // This can happen when the host PC is not reading data off the camera fast enough. We also have the option to
-        // move the use of libjpeg-turbo to a more recent version and use tjGetErrorCode() to get a better understanding
-        // of the status returned.
-        LOG_WARNING("MJPEG decode failed, dropping image: %d", decompressStatus);
-        return K4A_RESULT_FAILED;
+    {
+        std::lock_guard<std::mutex> lock(m_decode_mutex);
+        m_decode_stop = true;
+        m_decode_condition.notify_all();
     }
 
-    return K4A_RESULT_SUCCEEDED;
+    for (std::thread &thread : m_decode_threads)
+    {
+        thread.join();
+    }
+    m_decode_threads.clear();
+    m_decode_workers.clear();
+    m_decode_jobs.clear();
+}
+
+k4a_result_t UVCCameraReader::DecodeMJPEGtoBGRA32(std::unique_ptr<MJPEGDecoder> &decoder,
+                                                  const uint8_t *in_buf,
+                                                  const size_t in_size,
+                                                  uint8_t *out_buf,
+                                                  const size_t out_size)
+{
+    k4a_result_t result = decoder->DecodeToBGRA32(in_buf, in_size, out_buf, out_size);
+    if (K4A_FAILED(result) && !decoder->IsSoftware())
+    {
+        // A frame libjpeg-turbo decodes means the hardware decoder can't be relied on, the stream moves to
+        // libjpeg-turbo. Frames that are corrupt fail both and keep the hardware decoder.
+        std::unique_ptr<MJPEGDecoder> fallback =
+            CreateTurboJPEGDecoder(m_width_pixels, m_height_pixels, &m_decode_config);
+        if (fallback && K4A_SUCCEEDED(fallback->DecodeToBGRA32(in_buf, in_size, out_buf, out_size)))
+        {
+            LOG_WARNING("The %s MJPEG decoder failed, decoding with %s", decoder->Name(), fallback->Name());
+            decoder = std::move(fallback);
+            result = K4A_RESULT_SUCCEEDED;
+        }
+    }
+    return result;
 }
 
 // Returns exposure in 100us time base
@@ -5,13 +5,17 @@
 #include <k4ainternal/color.h>
 
 #include "color_priv.h"
+#include "mjpegdecoder.h"
 
 // STL
+#include <condition_variable>
+#include <deque>
 #include <mutex>
+#include <thread>
+#include <vector>
 
 // external
 #include <libuvc/libuvc.h>
-#include "turbojpeg.h"
 
 class UVCCameraReader
 {
@@ -32,6 +36,12 @@ public:
 
     void Shutdown();
 
+    k4a_result_t SetAllocator(const allocator_hook_t *hook);
+
+    k4a_result_t SetPrefaultBuffers(bool prefault);
+
+    k4a_result_t SetDecodeConfiguration(const k4a_color_decode_configuration_t *config);
+
     k4a_result_t GetCameraControlCapabilities(const k4a_color_control_command_t command,
                                               color_control_cap_t *capabilities);
 
@@ -51,7 +61,47 @@ private:
         return m_pContext && m_pDevice && m_pDeviceHandle;
     }
 
-    k4a_result_t DecodeMJPEGtoBGRA32(uint8_t *in_buf, const size_t in_size, uint8_t *out_buf, const size_t out_size);
+    // Metadata of a color frame, parsed on the libuvc thread
+    struct color_frame_info_t
+    {
+        uint64_t pts;
+        uint64_t system_timestamp_nsec;
+        uint64_t exposure_time;
+        uint32_t iso_speed;
+        uint32_t white_balance;
+    };
+
+    // MJPG frame waiting for a decode worker
+    struct decode_job_t
+    {
+        std::vector<uint8_t> mjpeg;
+        color_frame_info_t info;
+        uint64_t sequence; // Order the frame arrived in, it is published in this order
+    };
+
+    // Decodes with decoder, replaced by libjpeg-turbo if it is a hardware decoder that fails
+    k4a_result_t DecodeMJPEGtoBGRA32(std::unique_ptr<MJPEGDecoder> &decoder,
+                                     const uint8_t *in_buf,
+                                     const size_t in_size,
+                                     uint8_t *out_buf,
+                                     const size_t out_size);
+
+    // Buffer for an image, from m_image_pool when it fits. buffer_destroy_cb and context release it.
+    uint8_t *AllocateImageBuffer(size_t buffer_size, image_destroy_cb_t **buffer_destroy_cb, void **context);
+
+    void PublishImage(k4a_result_t result,
+                      uint8_t *buffer,
+                      size_t buffer_size,
+                      image_destroy_cb_t *buffer_destroy_cb,
+                      void *context,
+                      int stride,
+                      const color_frame_info_t &info,
+                      bool drop_image);
+
+    k4a_result_t StartDecodeWorkers(uint32_t width, uint32_t height);
+    void StopDecodeWorkers();
+    void QueueDecode(uvc_frame_t *frame, const color_frame_info_t &info);
+    void DecodeThread(size_t worker_index);
 
     int32_t MapK4aExposureToLinux(int32_t K4aExposure);
     int32_t MapLinuxExposureToK4a(int32_t LinuxExposure);
@@ -65,20 +115,48 @@ private:
     uvc_device_t *m_pDevice = nullptr;
     uvc_device_handle_t *m_pDeviceHandle = nullptr;
     bool m_streaming = false;
+    bool m_thread_policy_applied = false;
     bool m_using_60hz_power = true;
 
     // Image format cache
     uint32_t m_width_pixels;
     uint32_t m_height_pixels;
+    uint32_t m_output_width_pixels; // Size of the images, smaller than the frames when BGRA32 is cropped or scaled
+    uint32_t m_output_height_pixels;
     k4a_image_format_t m_input_image_format;
     k4a_image_format_t m_output_image_format;
 
+    // Allocator of the color buffers, no callbacks for the process allocator
+    allocator_hook_t m_allocator = {};
+
+    // Recycles the color image buffers while streaming, sized for the frames of the current format
+    allocator_pool_t *m_image_pool = nullptr;
+
+    // Touch the m_image_pool buffers when the stream starts
+    bool m_prefault_buffers = false;
+
     // K4A stream callback
     color_cb_stream_t *m_pCallback = nullptr;
     void *m_pCallbackContext = nullptr;
 
-    // MJPEG decoder
-    tjhandle m_decoder = nullptr;
+    // Crop and scale of BGRA32 streams
+    k4a_color_decode_configuration_t m_decode_config = K4A_COLOR_DECODE_CONFIG_INIT_FULL_RESOLUTION;
+
+    // MJPEG decoder of BGRA32 streams decoded on the libuvc thread, kept across streams of the same resolution
+    std::unique_ptr<MJPEGDecoder> m_decoder;
+    uint32_t m_decoder_width_pixels = 0;
+    uint32_t m_decoder_height_pixels = 0;
+
+    // MJPEG decode workers of BGRA32 streams, each with its own decoder. m_decode_mutex protects the rest.
+    std::vector<std::unique_ptr<MJPEGDecoder>> m_decode_workers;
+    std::vector<std::thread> m_decode_threads;
+    std::mutex m_decode_mutex;
+    std::condition_variable m_decode_condition;
+    std::deque<decode_job_t> m_decode_jobs;
+    std::vector<std::vector<uint8_t>> m_decode_free_buffers; // MJPG copies reused by the next jobs
+    uint64_t m_decode_next_sequence = 0;                     // Sequence of the next queued frame
+    uint64_t m_decode_next_delivery = 0;                     // Sequence of the next frame to publish
+    bool m_decode_stop = false;
 };
 
 #endif // UVC_CAMERAREADER_H
\ No newline at end of file
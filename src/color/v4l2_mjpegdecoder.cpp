@@ -0,0 +1,525 @@
+#include "mjpegdecoder.h"
+#include <k4ainternal/logging.h>
+
+// STL
+#include <cstdio>
+#include <cstring>
+
+// System dependencies
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <linux/videodev2.h>
+
+#define V4L2_MJPEG_MAX_DEVICES 64            // /dev/video0 to /dev/video63 are searched for a decoder
+#define V4L2_MJPEG_DECODE_TIMEOUT_MS 1000    // Longest wait for the decoder to finish a frame
+#define V4L2_MJPEG_INPUT_BYTES_PER_PIXEL 2   // Input buffer size, MJPG frames are smaller than YUY2 ones
+#define V4L2_MJPEG_FIXED_POINT_ONE (1 << 16) // YCbCr to RGB coefficients are in 1/65536
+
+// Capture formats the decoder may write, BGRA32 first as it needs no conversion
+static const uint32_t g_capture_formats[] = { V4L2_PIX_FMT_ABGR32,  V4L2_PIX_FMT_BGR32, V4L2_PIX_FMT_NV16,
+                                              V4L2_PIX_FMT_YUV422P, V4L2_PIX_FMT_NV12,  V4L2_PIX_FMT_YUV420 };
+
+static int v4l2_ioctl(int fd, unsigned long request, void *arg)
+{
+    int result;
+    do
+    {
+        result = ioctl(fd, request, arg);
+    } while (result == -1 && errno == EINTR);
+    return result;
+}
+
+static inline uint8_t clamp_byte(int value)
+{
+    return (uint8_t)(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+// JFIF full range YCbCr to BGRA32. Chroma is subsampled 2x horizontally, and 2x vertically if chroma_rows_shift is 1.
+// Interleaved chroma (NV12, NV16) has a chroma_step of 2 with cr = cb + 1.
+static void convert_ycbcr_to_bgra32(const uint8_t *y_plane,
+                                    uint32_t y_stride,
+                                    const uint8_t *cb_plane,
+                                    const uint8_t *cr_plane,
+                                    uint32_t chroma_stride,
+                                    uint32_t chroma_step,
+                                    uint32_t chroma_rows_shift,
+                                    uint32_t width,
+                                    uint32_t height,
+                                    uint8_t *out_buf)
+{
+    const int cr_to_r = (int)(1.402 * V4L2_MJPEG_FIXED_POINT_ONE + 0.5);
+    const int cb_to_g = (int)(0.344136 * V4L2_MJPEG_FIXED_POINT_ONE + 0.5);
+    const int cr_to_g = (int)(0.714136 * V4L2_MJPEG_FIXED_POINT_ONE + 0.5);
+    const int cb_to_b = (int)(1.772 * V4L2_MJPEG_FIXED_POINT_ONE + 0.5);
+    const int round = V4L2_MJPEG_FIXED_POINT_ONE / 2;
+
+    for (uint32_t y = 0; y < height; y++)
+    {
+        const uint8_t *luma = y_plane + (size_t)y * y_stride;
+        const uint8_t *cb = cb_plane + (size_t)(y >> chroma_rows_shift) * chroma_stride;
+        const uint8_t *cr = cr_plane + (size_t)(y >> chroma_rows_shift) * chroma_stride;
+        uint8_t *out = out_buf + (size_t)y * width * 4;
+        for (uint32_t x = 0; x < width; x++)
+        {
+            int l = luma[x] * V4L2_MJPEG_FIXED_POINT_ONE + round;
+            int u = cb[(x >> 1) * chroma_step] - 128;
+            int v = cr[(x >> 1) * chroma_step] - 128;
+            out[4 * x + 0] = clamp_byte((l + cb_to_b * u) >> 16);
+            out[4 * x + 1] = clamp_byte((l - cb_to_g * u - cr_to_g * v) >> 16);
+            out[4 * x + 2] = clamp_byte((l + cr_to_r * v) >> 16);
+            out[4 * x + 3] = 0xFF;
+        }
+    }
+}
+
+// Stateful V4L2 memory to memory decoder with MJPG or JPEG input. Decoders that only report their capture format
+// through a source change event are not supported, they are skipped for the libjpeg-turbo fallback.
+class V4L2MJPEGDecoder : public MJPEGDecoder
+{
+public:
+    V4L2MJPEGDecoder(uint32_t width, uint32_t height) : m_width_pixels(width), m_height_pixels(height) {}
+
+    virtual ~V4L2MJPEGDecoder()
+    {
+        if (m_streaming)
+        {
+            int type = (int)m_output_type;
+            (void)v4l2_ioctl(m_fd, VIDIOC_STREAMOFF, &type);
+            type = (int)m_capture_type;
+            (void)v4l2_ioctl(m_fd, VIDIOC_STREAMOFF, &type);
+        }
+        if (m_output.data != MAP_FAILED)
+        {
+            (void)munmap(m_output.data, m_output.size);
+        }
+        if (m_capture.data != MAP_FAILED)
+        {
+            (void)munmap(m_capture.data, m_capture.size);
+        }
+        if (m_fd >= 0)
+        {
+            (void)close(m_fd);
+        }
+    }
+
+    // Fails if the device at path is not a decoder for the frame size
+    k4a_result_t Open(const char *path)
+    {
+        m_fd = open(path, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+        if (m_fd < 0)
+        {
+            return K4A_RESULT_FAILED;
+        }
+
+        v4l2_capability capability = {};
+        if (v4l2_ioctl(m_fd, VIDIOC_QUERYCAP, &capability) != 0)
+        {
+            return K4A_RESULT_FAILED;
+        }
+        uint32_t caps = (capability.capabilities & V4L2_CAP_DEVICE_CAPS) ? capability.device_caps :
+                                                                           capability.capabilities;
+        if ((caps & V4L2_CAP_STREAMING) == 0)
+        {
+            return K4A_RESULT_FAILED;
+        }
+        if (caps & V4L2_CAP_VIDEO_M2M_MPLANE)
+        {
+            m_mplane = true;
+            m_output_type = V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE;
+            m_capture_type = V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE;
+        }
+        else if (caps & V4L2_CAP_VIDEO_M2M)
+        {
+            m_output_type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+            m_capture_type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        }
+        else
+        {
+            return K4A_RESULT_FAILED;
+        }
+
+        uint32_t input_format = 0;
+        if (SupportsFormat(m_output_type, V4L2_PIX_FMT_MJPEG))
+        {
+            input_format = V4L2_PIX_FMT_MJPEG;
+        }
+        else if (SupportsFormat(m_output_type, V4L2_PIX_FMT_JPEG))
+        {
+            input_format = V4L2_PIX_FMT_JPEG;
+        }
+        else
+        {
+            return K4A_RESULT_FAILED;
+        }
+
+        size_t input_size = (size_t)m_width_pixels * m_height_pixels * V4L2_MJPEG_INPUT_BYTES_PER_PIXEL;
+        if (K4A_FAILED(SetFormat(m_output_type, input_format, (uint32_t)input_size)))
+        {
+            return K4A_RESULT_FAILED;
+        }
+
+        for (uint32_t format : g_capture_formats)
+        {
+            if (SupportsFormat(m_capture_type, format) && K4A_SUCCEEDED(SetFormat(m_capture_type, format, 0)))
+            {
+                m_capture_format = format;
+                break;
+            }
+        }
+        if (m_capture_format == 0)
+        {
+            return K4A_RESULT_FAILED;
+        }
+
+        if (K4A_FAILED(MapBuffer(m_output_type, &m_output)) || K4A_FAILED(MapBuffer(m_capture_type, &m_capture)))
+        {
+            return K4A_RESULT_FAILED;
+        }
+        if (m_capture.size < CaptureSize() || K4A_FAILED(QueueBuffer(m_capture_type, 0)))
+        {
+            return K4A_RESULT_FAILED;
+        }
+
+        int type = (int)m_output_type;
+        if (v4l2_ioctl(m_fd, VIDIOC_STREAMON, &type) != 0)
+        {
+            return K4A_RESULT_FAILED;
+        }
+        m_streaming = true;
+        type = (int)m_capture_type;
+        if (v4l2_ioctl(m_fd, VIDIOC_STREAMON, &type) != 0)
+        {
+            return K4A_RESULT_FAILED;
+        }
+
+        LOG_INFO("Using V4L2 MJPEG decoder %s (%s)", path, (const char *)capability.card);
+        return K4A_RESULT_SUCCEEDED;
+    }
+
+    const char *Name() const override
+    {
+        return "v4l2";
+    }
+
+    bool IsSoftware() const override
+    {
+        return false;
+    }
+
+    k4a_result_t DecodeToBGRA32(const uint8_t *in_buf, size_t in_size, uint8_t *out_buf, size_t out_size) override
+    {
+        RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, (size_t)m_width_pixels * m_height_pixels * 4 > out_size);
+        RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, in_size > m_output.size);
+
+        if (m_failed)
+        {
+            // A frame that did not complete leaves buffers queued in the driver
+            return K4A_RESULT_FAILED;
+        }
+
+        memcpy(m_output.data, in_buf, in_size);
+        k4a_result_t result = QueueBuffer(m_output_type, (uint32_t)in_size);
+
+        bool error = false;
+        if (K4A_SUCCEEDED(result))
+        {
+            result = DequeueBuffer(m_capture_type, POLLIN, &error);
+        }
+        if (K4A_SUCCEEDED(result))
+        {
+            result = DequeueBuffer(m_output_type, POLLOUT, nullptr);
+        }
+        if (K4A_SUCCEEDED(result) && !error)
+        {
+            Convert(out_buf);
+        }
+        if (K4A_SUCCEEDED(result))
+        {
+            result = QueueBuffer(m_capture_type, 0);
+        }
+
+        if (K4A_FAILED(result))
+        {
+            LOG_ERROR("V4L2 MJPEG decoder failed: %s", strerror(errno));
+            m_failed = true;
+        }
+        else if (error)
+        {
+            LOG_WARNING("V4L2 MJPEG decode failed, dropping image", 0);
+            result = K4A_RESULT_FAILED;
+        }
+        return result;
+    }
+
+private:
+    struct mapped_buffer_t
+    {
+        void *data = MAP_FAILED;
+        size_t size = 0;
+    };
+
+    bool SupportsFormat(uint32_t type, uint32_t pixel_format)
+    {
+        v4l2_fmtdesc description = {};
+        description.type = type;
+        while (v4l2_ioctl(m_fd, VIDIOC_ENUM_FMT, &description) == 0)
+        {
+            if (description.pixelformat == pixel_format)
+            {
+                return true;
+            }
+            description.index++;
+        }
+        return false;
+    }
+
+    // Capture formats must keep the frame size, padded at most, and fit in 1 plane
+    k4a_result_t SetFormat(uint32_t type, uint32_t pixel_format, uint32_t size)
+    {
+        v4l2_format format = {};
+        format.type = type;
+        if (m_mplane)
+        {
+            format.fmt.pix_mp.width = m_width_pixels;
+            format.fmt.pix_mp.height = m_height_pixels;
+            format.fmt.pix_mp.pixelformat = pixel_format;
+            format.fmt.pix_mp.field = V4L2_FIELD_NONE;
+            format.fmt.pix_mp.num_planes = 1;
+            format.fmt.pix_mp.plane_fmt[0].sizeimage = size;
+        }
+        else
+        {
+            format.fmt.pix.width = m_width_pixels;
+            format.fmt.pix.height = m_height_pixels;
+            format.fmt.pix.pixelformat = pixel_format;
+            format.fmt.pix.field = V4L2_FIELD_NONE;
+            format.fmt.pix.sizeimage = size;
+        }
+        if (v4l2_ioctl(m_fd, VIDIOC_S_FMT, &format) != 0)
+        {
+            return K4A_RESULT_FAILED;
+        }
+
+        uint32_t width = m_mplane ? format.fmt.pix_mp.width : format.fmt.pix.width;
+        uint32_t height = m_mplane ? format.fmt.pix_mp.height : format.fmt.pix.height;
+        uint32_t set_format = m_mplane ? format.fmt.pix_mp.pixelformat : format.fmt.pix.pixelformat;
+        if (set_format != pixel_format || (m_mplane && format.fmt.pix_mp.num_planes != 1))
+        {
+            return K4A_RESULT_FAILED;
+        }
+        if (type == m_capture_type)
+        {
+            if (width < m_width_pixels || height < m_height_pixels)
+            {
+                return K4A_RESULT_FAILED;
+            }
+            m_capture_height = height;
+            m_capture_stride = m_mplane ? format.fmt.pix_mp.plane_fmt[0].bytesperline : format.fmt.pix.bytesperline;
+        }
+        return K4A_RESULT_SUCCEEDED;
+    }
+
+    // Allocates and maps the single buffer of a queue
+    k4a_result_t MapBuffer(uint32_t type, mapped_buffer_t *buffer)
+    {
+        v4l2_requestbuffers request = {};
+        request.count = 1;
+        request.type = type;
+        request.memory = V4L2_MEMORY_MMAP;
+        if (v4l2_ioctl(m_fd, VIDIOC_REQBUFS, &request) != 0 || request.count < 1)
+        {
+            return K4A_RESULT_FAILED;
+        }
+
+        v4l2_plane plane = {};
+        v4l2_buffer query = {};
+        query.type = type;
+        query.memory = V4L2_MEMORY_MMAP;
+        query.index = 0;
+        if (m_mplane)
+        {
+            query.m.planes = &plane;
+            query.length = 1;
+        }
+        if (v4l2_ioctl(m_fd, VIDIOC_QUERYBUF, &query) != 0)
+        {
+            return K4A_RESULT_FAILED;
+        }
+
+        buffer->size = m_mplane ? plane.length : query.length;
+        off_t offset = (off_t)(m_mplane ? plane.m.mem_offset : query.m.offset);
+        buffer->data = mmap(nullptr, buffer->size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, offset);
+        return K4A_RESULT_FROM_BOOL(buffer->data != MAP_FAILED);
+    }
+
+    k4a_result_t QueueBuffer(uint32_t type, uint32_t bytes_used)
+    {
+        v4l2_plane plane = {};
+        v4l2_buffer buffer = {};
+        buffer.type = type;
+        buffer.memory = V4L2_MEMORY_MMAP;
+        buffer.index = 0;
+        buffer.field = V4L2_FIELD_NONE;
+        if (m_mplane)
+        {
+            plane.bytesused = bytes_used;
+            plane.length = (uint32_t)(type == m_output_type ? m_output.size : m_capture.size);
+            buffer.m.planes = &plane;
+            buffer.length = 1;
+        }
+        else
+        {
+            buffer.bytesused = bytes_used;
+        }
+        return K4A_RESULT_FROM_BOOL(v4l2_ioctl(m_fd, VIDIOC_QBUF, &buffer) == 0);
+    }
+
+    // Waits for the buffer of a queue, error is set if the driver flagged the buffer
+    k4a_result_t DequeueBuffer(uint32_t type, short events, bool *error)
+    {
+        v4l2_plane plane = {};
+        v4l2_buffer buffer = {};
+        buffer.type = type;
+        buffer.memory = V4L2_MEMORY_MMAP;
+        if (m_mplane)
+        {
+            buffer.m.planes = &plane;
+            buffer.length = 1;
+        }
+
+        while (v4l2_ioctl(m_fd, VIDIOC_DQBUF, &buffer) != 0)
+        {
+            if (errno != EAGAIN)
+            {
+                return K4A_RESULT_FAILED;
+            }
+
+            pollfd fds = {};
+            fds.fd = m_fd;
+            fds.events = events;
+            int ready = poll(&fds, 1, V4L2_MJPEG_DECODE_TIMEOUT_MS);
+            if (ready == 0)
+            {
+                errno = ETIMEDOUT;
+                return K4A_RESULT_FAILED;
+            }
+            if (ready < 0 && errno != EINTR)
+            {
+                return K4A_RESULT_FAILED;
+            }
+        }
+
+        if (error)
+        {
+            *error = (buffer.flags & V4L2_BUF_FLAG_ERROR) != 0;
+        }
+        return K4A_RESULT_SUCCEEDED;
+    }
+
+    // Bytes of the capture buffer Convert() reads
+    size_t CaptureSize() const
+    {
+        size_t luma_size = (size_t)m_capture_stride * m_capture_height;
+        switch (m_capture_format)
+        {
+        case V4L2_PIX_FMT_NV16:
+        case V4L2_PIX_FMT_YUV422P:
+            return luma_size * 2;
+        case V4L2_PIX_FMT_NV12:
+        case V4L2_PIX_FMT_YUV420:
+            return luma_size * 3 / 2;
+        default:
+            return luma_size;
+        }
+    }
+
+    void Convert(uint8_t *out_buf)
+    {
+        const uint8_t *data = (const uint8_t *)m_capture.data;
+        uint32_t stride = m_capture_stride;
+        size_t luma_size = (size_t)stride * m_capture_height;
+
+        switch (m_capture_format)
+        {
+        case V4L2_PIX_FMT_ABGR32:
+        case V4L2_PIX_FMT_BGR32:
+            // B, G, R and A or X in memory, the alpha is set to opaque like libjpeg-turbo does
+            for (uint32_t y = 0; y < m_height_pixels; y++)
+            {
+                uint8_t *out = out_buf + (size_t)y * m_width_pixels * 4;
+                memcpy(out, data + (size_t)y * stride, (size_t)m_width_pixels * 4);
+                for (uint32_t x = 0; x < m_width_pixels; x++)
+                {
+                    out[4 * x + 3] = 0xFF;
+                }
+            }
+            break;
+        case V4L2_PIX_FMT_NV16:
+        case V4L2_PIX_FMT_NV12:
+        {
+            uint32_t chroma_rows_shift = m_capture_format == V4L2_PIX_FMT_NV12 ? 1 : 0;
+            const uint8_t *cb = data + luma_size;
+            convert_ycbcr_to_bgra32(
+                data, stride, cb, cb + 1, stride, 2, chroma_rows_shift, m_width_pixels, m_height_pixels, out_buf);
+        }
+        break;
+        case V4L2_PIX_FMT_YUV422P:
+        {
+            const uint8_t *cb = data + luma_size;
+            const uint8_t *cr = cb + (size_t)(stride / 2) * m_capture_height;
+            convert_ycbcr_to_bgra32(data, stride, cb, cr, stride / 2, 1, 0, m_width_pixels, m_height_pixels, out_buf);
+        }
+        break;
+        case V4L2_PIX_FMT_YUV420:
+        {
+            const uint8_t *cb = data + luma_size;
+            const uint8_t *cr = cb + (size_t)(stride / 2) * (m_capture_height / 2);
+            convert_ycbcr_to_bgra32(data, stride, cb, cr, stride / 2, 1, 1, m_width_pixels, m_height_pixels, out_buf);
+        }
+        break;
+        default:
+            break;
+        }
+    }
+
+    uint32_t m_width_pixels;
+    uint32_t m_height_pixels;
+
+    int m_fd = -1;
+    bool m_mplane = false;
+    uint32_t m_output_type = 0;
+    uint32_t m_capture_type = 0;
+    bool m_streaming = false;
+    bool m_failed = false; // The decoder is in an unknown state, every following frame fails
+
+    uint32_t m_capture_format = 0; // One of g_capture_formats
+    uint32_t m_capture_height = 0; // Height of the capture planes, may be padded
+    uint32_t m_capture_stride = 0; // Bytes per line of the first capture plane
+
+    mapped_buffer_t m_output;  // MJPG input
+    mapped_buffer_t m_capture; // Decoded frame
+};
+
+std::unique_ptr<MJPEGDecoder> CreateV4L2MJPEGDecoder(uint32_t width, uint32_t height)
+{
+    for (int i = 0; i < V4L2_MJPEG_MAX_DEVICES; i++)
+    {
+        char path[32];
+        snprintf(path, sizeof(path), "/dev/video%d", i);
+        if (access(path, R_OK | W_OK) != 0)
+        {
+            continue;
+        }
+
+        std::unique_ptr<V4L2MJPEGDecoder> decoder(new V4L2MJPEGDecoder(width, height));
+        if (K4A_SUCCEEDED(decoder->Open(path)))
+        {
+            return std::unique_ptr<MJPEGDecoder>(decoder.release());
+        }
+    }
+    return nullptr;
+}
@@ -182,6 +182,14 @@ k4a_result_t colormcu_imu_register_stream_cb(colormcu_t colormcu_handle,
     return TRACE_CALL(usb_cmd_stream_register_cb(colormcu->usb_cmd, frame_ready_cb, context));
 }
 
+k4a_result_t colormcu_imu_set_allocator(colormcu_t colormcu_handle, const allocator_hook_t *hook)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, colormcu_t, colormcu_handle);
+    colormcu_context_t *colormcu = colormcu_t_get_context(colormcu_handle);
+
+    return TRACE_CALL(usb_cmd_stream_set_allocator(colormcu->usb_cmd, hook));
+}
+
 /**
  *  Function to read the state of the synchronization jacks on the back of the device
  *
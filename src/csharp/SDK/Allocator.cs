@@ -33,6 +33,7 @@ namespace Microsoft.Azure.Kinect.Sensor
 
         // Native delegates
         private readonly NativeMethods.k4a_memory_allocate_cb_t allocateDelegate;
+        private readonly NativeMethods.k4a_memory_allocate_source_cb_t allocateSourceDelegate;
         private readonly NativeMethods.k4a_memory_destroy_cb_t freeDelegate;
 
         // Native allocator hook state
@@ -45,6 +46,7 @@ namespace Microsoft.Azure.Kinect.Sensor
         private Allocator()
         {
             this.allocateDelegate = new NativeMethods.k4a_memory_allocate_cb_t(this.AllocateFunction);
+            this.allocateSourceDelegate = new NativeMethods.k4a_memory_allocate_source_cb_t(this.AllocateSourceFunction);
             this.freeDelegate = new NativeMethods.k4a_memory_destroy_cb_t(this.FreeFunction);
 
             // Register for ProcessExit and DomainUnload to allow us to unhook the native layer before
@@ -63,10 +65,11 @@ namespace Microsoft.Azure.Kinect.Sensor
             // the SafeCopyNativeBuffers options causes the managed code to make a safe cache copy of the native buffer
             // in a managed byte[] array. This has a more significant performance impact, but generally is only needed for
             // media foundation (color image) or potentially custom buffers. When set to true, the Memory<T> objects are safe
-            // copies of the native buffers. When set to false, the Memory<T> objects are direct pointers to the native buffers
-            // and can therefore cause native memory corruption if a Memory<T> (or Span<T>) is used after the Image is disposed
-            // or garbage collected.
-            this.SafeCopyNativeBuffers = true;
+            // copies of the native buffers. When set to false, the Memory<T> objects wrap the native buffers without a copy.
+            // The wrapper keeps the native image alive while the Memory<T> is pinned and throws once the Image is disposed,
+            // but a Span<T> taken from it before the Image is disposed must not be used afterwards. Copying a full color
+            // frame per access costs more than callers expect, so the wrapper is the default.
+            this.SafeCopyNativeBuffers = false;
         }
 
         /// <summary>
@@ -111,10 +114,22 @@ namespace Microsoft.Azure.Kinect.Sensor
             }
         }
 
+        /// <summary>
+        /// Have the native library allocate the buffers of one device from the managed allocator.
+        /// </summary>
+        /// <param name="handle">Handle of a device whose cameras and IMU are not running.</param>
+        /// <remarks>
+        /// This only changes the given device, and is independent of <see cref="UseManagedAllocator"/>.
+        /// </remarks>
+        public void HookDevice(NativeMethods.k4a_device_t handle)
+        {
+            AzureKinectException.ThrowIfNotSuccess(() => NativeMethods.k4a_device_set_allocator(handle, this.allocateSourceDelegate, this.freeDelegate, IntPtr.Zero));
+        }
+
         /// <summary>
         /// Gets or sets a value indicating whether to make a safe copy of native buffers.
         /// </summary>
-        public bool SafeCopyNativeBuffers { get; set; } = true;
+        public bool SafeCopyNativeBuffers { get; set; } = false;
 
         /// <summary>
         /// Register the object for disposal when the CLR shuts down.
@@ -334,6 +349,12 @@ namespace Microsoft.Azure.Kinect.Sensor
             return allocationContext.BufferAddress;
         }
 
+        // This function is called by the native layer to allocate memory for a device hooked by HookDevice
+        private IntPtr AllocateSourceFunction(int size, int source, IntPtr allocatorContext, out IntPtr context)
+        {
+            return this.AllocateFunction(size, out context);
+        }
+
         // This function is called by the native layer to free memory
         private void FreeFunction(IntPtr buffer, IntPtr context)
         {
@@ -0,0 +1,160 @@
+﻿//------------------------------------------------------------------------------
+// <copyright file="AsyncSampleQueue.cs" company="Microsoft">
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+// </copyright>
+//------------------------------------------------------------------------------
+using System;
+using System.Collections.Generic;
+using System.Runtime.CompilerServices;
+using System.Threading;
+
+namespace Microsoft.Azure.Kinect.Sensor
+{
+    /// <summary>
+    /// A bounded queue that is filled by native callbacks and read with <c>await foreach</c>.
+    /// </summary>
+    /// <typeparam name="T">Type of the queued items.</typeparam>
+    /// <remarks>
+    /// When the queue is full the oldest item is dropped, and disposed if it is <see cref="IDisposable"/>,
+    /// so a slow reader never delays the native thread that posts the items. Readers wait with
+    /// <see cref="SemaphoreSlim.WaitAsync(CancellationToken)"/> and do not hold a thread while no item is available.
+    /// </remarks>
+    internal sealed class AsyncSampleQueue<T> : IDisposable
+        where T : class
+    {
+        private readonly Queue<T> items = new Queue<T>();
+        private readonly SemaphoreSlim available = new SemaphoreSlim(0);
+        private readonly int capacity;
+
+        // Set when no more items will be posted. Queued items can still be read.
+        private bool completed = false;
+
+        // Set when the reader has finished. Queued items have been disposed.
+        private bool closed = false;
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="AsyncSampleQueue{T}"/> class.
+        /// </summary>
+        /// <param name="capacity">Number of items held before the oldest is dropped.</param>
+        public AsyncSampleQueue(int capacity)
+        {
+            if (capacity < 1)
+            {
+                throw new ArgumentOutOfRangeException(nameof(capacity));
+            }
+
+            this.capacity = capacity;
+        }
+
+        /// <summary>
+        /// Adds an item to the queue.
+        /// </summary>
+        /// <param name="item">The item to add. The queue takes ownership of it.</param>
+        /// <returns><c>false</c> if the reader has finished and the queue no longer accepts items.</returns>
+        public bool Post(T item)
+        {
+            T dropped = null;
+
+            lock (this.items)
+            {
+                if (this.completed)
+                {
+                    (item as IDisposable)?.Dispose();
+                    return !this.closed;
+                }
+
+                // Only drop an item that is not already claimed by a waiting reader
+                if (this.items.Count >= this.capacity && this.available.Wait(0))
+                {
+                    dropped = this.items.Dequeue();
+                }
+
+                this.items.Enqueue(item);
+                _ = this.available.Release();
+            }
+
+            (dropped as IDisposable)?.Dispose();
+            return true;
+        }
+
+        /// <summary>
+        /// Marks the end of the stream. The reader finishes once it has read the queued items.
+        /// </summary>
+        public void Complete()
+        {
+            lock (this.items)
+            {
+                if (!this.completed)
+                {
+                    this.completed = true;
+                    _ = this.available.Release();
+                }
+            }
+        }
+
+        /// <summary>
+        /// Reads the items of the queue as they are posted.
+        /// </summary>
+        /// <param name="cancellationToken">Token to stop waiting for the next item.</param>
+        /// <returns>The items in the order they were posted.</returns>
+        /// <remarks>The queue is closed when the enumeration ends. Only one reader is supported.</remarks>
+        public async IAsyncEnumerable<T> ReadAllAsync([EnumeratorCancellation] CancellationToken cancellationToken = default)
+        {
+            try
+            {
+                while (true)
+                {
+                    await this.available.WaitAsync(cancellationToken).ConfigureAwait(false);
+
+                    T item = null;
+                    lock (this.items)
+                    {
+                        // An empty queue after a wake up means the stream was completed
+                        if (this.items.Count > 0)
+                        {
+                            item = this.items.Dequeue();
+                        }
+                    }
+
+                    if (item == null)
+                    {
+                        yield break;
+                    }
+
+                    yield return item;
+                }
+            }
+            finally
+            {
+                this.Dispose();
+            }
+        }
+
+        /// <inheritdoc/>
+        public void Dispose()
+        {
+            List<T> remaining;
+
+            lock (this.items)
+            {
+                if (this.closed)
+                {
+                    return;
+                }
+
+                this.completed = true;
+                this.closed = true;
+
+                remaining = new List<T>(this.items);
+                this.items.Clear();
+                this.available.Dispose();
+            }
+
+            foreach (T item in remaining)
+            {
+                (item as IDisposable)?.Dispose();
+            }
+        }
+    }
+}
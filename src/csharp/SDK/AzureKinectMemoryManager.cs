@@ -14,10 +14,16 @@ namespace Microsoft.Azure.Kinect.Sensor
     /// <summary>
     /// Manages the native memory allocated by the Azure Kinect SDK.
     /// </summary>
+    /// <remarks>
+    /// The manager holds its own reference to the native image. If the manager is disposed while
+    /// the memory is pinned, the reference is released when the last <see cref="MemoryHandle"/> is
+    /// disposed, so a pinned buffer is never freed underneath its user.
+    /// </remarks>
     internal class AzureKinectMemoryManager : MemoryManager<byte>
     {
         private Image image;
         private int pinCount = 0;
+        private bool disposeRequested = false;
 
         /// <summary>
         /// Initializes a new instance of the <see cref="AzureKinectMemoryManager"/> class.
@@ -36,7 +42,7 @@ namespace Microsoft.Azure.Kinect.Sensor
         {
             lock (this)
             {
-                if (this.image == null)
+                if (this.image == null || this.disposeRequested)
                 {
                     throw new ObjectDisposedException(nameof(AzureKinectMemoryManager));
                 }
@@ -50,7 +56,7 @@ namespace Microsoft.Azure.Kinect.Sensor
         {
             lock (this)
             {
-                if (this.image == null)
+                if (this.image == null || this.disposeRequested)
                 {
                     throw new ObjectDisposedException(nameof(AzureKinectMemoryManager));
                 }
@@ -63,7 +69,13 @@ namespace Microsoft.Azure.Kinect.Sensor
         /// <inheritdoc/>
         public override void Unpin()
         {
-            _ = Interlocked.Decrement(ref this.pinCount);
+            lock (this)
+            {
+                if (Interlocked.Decrement(ref this.pinCount) == 0 && this.disposeRequested)
+                {
+                    this.ReleaseImage();
+                }
+            }
         }
 
         /// <inheritdoc/>
@@ -73,18 +85,24 @@ namespace Microsoft.Azure.Kinect.Sensor
             {
                 lock (this)
                 {
-                    if (this.image != null)
-                    {
-                        this.image.Dispose();
-                        this.image = null;
-                    }
+                    this.disposeRequested = true;
 
-                    if (this.pinCount != 0)
+                    // Defer the release until the last MemoryHandle is disposed
+                    if (this.pinCount == 0)
                     {
-                        throw new AzureKinectException("Buffer disposed while pinned");
+                        this.ReleaseImage();
                     }
                 }
             }
         }
+
+        private void ReleaseImage()
+        {
+            if (this.image != null)
+            {
+                this.image.Dispose();
+                this.image = null;
+            }
+        }
     }
 }
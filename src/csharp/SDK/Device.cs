@@ -5,7 +5,10 @@
 // </copyright>
 //------------------------------------------------------------------------------
 using System;
+using System.Collections.Generic;
+using System.Runtime.InteropServices;
 using System.Text;
+using System.Threading;
 
 namespace Microsoft.Azure.Kinect.Sensor
 {
@@ -14,6 +17,16 @@ namespace Microsoft.Azure.Kinect.Sensor
     /// </summary>
     public class Device : IDisposable
     {
+        // Number of items each stream holds before the oldest is dropped. The IMU produces samples at about 1.6 kHz.
+        private const int CaptureStreamCapacity = 2;
+        private const int ImuStreamCapacity = 160;
+
+        // Queues filled by the native capture and IMU callbacks. These are guarded by streamLock rather
+        // than the Device since the callbacks run while StopCameras and StopImu hold the Device lock.
+        private readonly object streamLock = new object();
+        private readonly List<AsyncSampleQueue<Capture>> captureQueues = new List<AsyncSampleQueue<Capture>>();
+        private readonly List<AsyncSampleQueue<ImuSample>> imuQueues = new List<AsyncSampleQueue<ImuSample>>();
+
         // Cache these values so we don't need to re-marshal them for each
         // access since they are immutable.
         private string serialNum = null;
@@ -25,6 +38,10 @@ namespace Microsoft.Azure.Kinect.Sensor
         // To detect redundant calls to Dispose
         private bool disposedValue = false;
 
+        // The delegates are held while they are registered so they are not garbage collected.
+        private NativeMethods.k4a_capture_ready_cb_t captureReadyCallback = null;
+        private NativeMethods.k4a_imu_sample_ready_cb_t imuReadyCallback = null;
+
         private Device(NativeMethods.k4a_device_t handle)
         {
             // Hook the native allocator and register this object.
@@ -189,6 +206,37 @@ namespace Microsoft.Azure.Kinect.Sensor
             return new Device(handle);
         }
 
+        /// <summary>
+        /// Opens an Azure Kinect device and selects whether its images are allocated from managed memory.
+        /// </summary>
+        /// <param name="index">Index of the device to open if there are multiple connected.</param>
+        /// <param name="useManagedAllocator"><c>True</c> to have the native library allocate image buffers from
+        /// pooled managed arrays, so that <see cref="Image.Memory"/> refers to them without a copy.</param>
+        /// <returns>A Device object representing that device.</returns>
+        /// <remarks>
+        /// The allocator is set for this device only, other devices keep using the allocator of the process.
+        /// With <c>false</c> the device uses the allocator of the process as well. Color images captured through
+        /// Media Foundation on Windows are not allocated through the hook.
+        /// </remarks>
+        public static Device Open(int index, bool useManagedAllocator)
+        {
+            Device device = Open(index);
+            if (useManagedAllocator)
+            {
+                try
+                {
+                    Allocator.Singleton.HookDevice(device.handle);
+                }
+                catch (Exception)
+                {
+                    device.Dispose();
+                    throw;
+                }
+            }
+
+            return device;
+        }
+
         /// <summary>
         /// Gets the calibration of the device.
         /// </summary>
@@ -310,6 +358,50 @@ namespace Microsoft.Azure.Kinect.Sensor
             return this.GetCapture(TimeSpan.FromMilliseconds(-1));
         }
 
+        /// <summary>
+        /// Streams sensor captures as they are produced by the device.
+        /// </summary>
+        /// <param name="cancellationToken">Token to stop waiting for the next capture.</param>
+        /// <returns>An asynchronous sequence of captures, read with <c>await foreach</c>.</returns>
+        /// <remarks>
+        /// The captures are delivered by a native callback, so no thread is blocked while waiting for the next capture.
+        /// The first stream must be created before <see cref="StartCameras(DeviceConfiguration)"/>; more streams may
+        /// be added while the cameras run. While a stream exists, <see cref="GetCapture(TimeSpan)"/> does not return
+        /// any captures. The sequence ends once <see cref="StopCameras"/> is called and the queued captures have been read.
+        ///
+        /// Each stream holds the two most recent captures; older captures are dropped and disposed if the caller
+        /// does not keep up. The caller owns and must dispose each capture it reads.
+        /// </remarks>
+        public IAsyncEnumerable<Capture> StreamCapturesAsync(CancellationToken cancellationToken = default)
+        {
+            lock (this)
+            {
+                if (this.disposedValue)
+                {
+                    throw new ObjectDisposedException(nameof(Device));
+                }
+
+                lock (this.streamLock)
+                {
+                    if (this.captureReadyCallback == null)
+                    {
+                        NativeMethods.k4a_capture_ready_cb_t callback = new NativeMethods.k4a_capture_ready_cb_t(this.OnCaptureReady);
+                        if (NativeMethods.k4a_device_set_capture_callback(this.handle, callback, IntPtr.Zero) != NativeMethods.k4a_result_t.K4A_RESULT_SUCCEEDED)
+                        {
+                            throw new AzureKinectException("Capture streams must be created before the cameras are started");
+                        }
+
+                        this.captureReadyCallback = callback;
+                    }
+
+                    AsyncSampleQueue<Capture> queue = new AsyncSampleQueue<Capture>(CaptureStreamCapacity);
+                    this.captureQueues.Add(queue);
+
+                    return queue.ReadAllAsync(cancellationToken);
+                }
+            }
+        }
+
         /// <summary>
         /// Reads an IMU sample from the device.
         /// </summary>
@@ -358,6 +450,48 @@ namespace Microsoft.Azure.Kinect.Sensor
             return this.GetImuSample(TimeSpan.FromMilliseconds(-1));
         }
 
+        /// <summary>
+        /// Streams IMU samples as they are produced by the device.
+        /// </summary>
+        /// <param name="cancellationToken">Token to stop waiting for the next sample.</param>
+        /// <returns>An asynchronous sequence of IMU samples, read with <c>await foreach</c>.</returns>
+        /// <remarks>
+        /// The samples are delivered by a native callback, so no thread is blocked while waiting for the next sample.
+        /// The first stream must be created before <see cref="StartImu"/>. While a stream exists,
+        /// <see cref="GetImuSample(TimeSpan)"/> does not return any samples. The sequence ends once <see cref="StopImu"/> is called and the queued samples
+        /// have been read. Each stream holds the most recent samples of about a tenth of a second; older samples are
+        /// dropped if the caller does not keep up.
+        /// </remarks>
+        public IAsyncEnumerable<ImuSample> StreamImuSamplesAsync(CancellationToken cancellationToken = default)
+        {
+            lock (this)
+            {
+                if (this.disposedValue)
+                {
+                    throw new ObjectDisposedException(nameof(Device));
+                }
+
+                lock (this.streamLock)
+                {
+                    if (this.imuReadyCallback == null)
+                    {
+                        NativeMethods.k4a_imu_sample_ready_cb_t callback = new NativeMethods.k4a_imu_sample_ready_cb_t(this.OnImuSampleReady);
+                        if (NativeMethods.k4a_device_set_imu_callback(this.handle, callback, IntPtr.Zero) != NativeMethods.k4a_result_t.K4A_RESULT_SUCCEEDED)
+                        {
+                            throw new AzureKinectException("IMU streams must be created before the IMU is started");
+                        }
+
+                        this.imuReadyCallback = callback;
+                    }
+
+                    AsyncSampleQueue<ImuSample> queue = new AsyncSampleQueue<ImuSample>(ImuStreamCapacity);
+                    this.imuQueues.Add(queue);
+
+                    return queue.ReadAllAsync(cancellationToken);
+                }
+            }
+        }
+
         /// <summary>
         /// Get the Azure Kinect color sensor control value.
         /// </summary>
@@ -460,6 +594,9 @@ namespace Microsoft.Azure.Kinect.Sensor
 
                 this.CurrentDepthMode = DepthMode.Off;
                 this.CurrentColorResolution = ColorResolution.Off;
+
+                // The callback is not called again once the cameras have stopped
+                this.EndCaptureStreams();
             }
         }
 
@@ -492,6 +629,9 @@ namespace Microsoft.Azure.Kinect.Sensor
                 }
 
                 NativeMethods.k4a_device_stop_imu(this.handle);
+
+                // The callback is not called again once the IMU has stopped
+                this.EndImuStreams();
             }
         }
 
@@ -519,7 +659,95 @@ namespace Microsoft.Azure.Kinect.Sensor
                     this.handle = null;
 
                     this.disposedValue = true;
+
+                    // Closing the device stops the cameras and IMU, end any streams that are still being read
+                    lock (this.streamLock)
+                    {
+                        this.captureQueues.ForEach(queue => queue.Complete());
+                        this.captureQueues.Clear();
+                        this.imuQueues.ForEach(queue => queue.Complete());
+                        this.imuQueues.Clear();
+                        this.captureReadyCallback = null;
+                        this.imuReadyCallback = null;
+                    }
+                }
+            }
+        }
+
+        // Completes the capture streams and returns the device to reading captures with GetCapture.
+        // Called with the Device lock held after the cameras have stopped.
+        private void EndCaptureStreams()
+        {
+            lock (this.streamLock)
+            {
+                if (this.captureReadyCallback == null)
+                {
+                    return;
+                }
+
+                this.captureQueues.ForEach(queue => queue.Complete());
+                this.captureQueues.Clear();
+
+                AzureKinectException.ThrowIfNotSuccess(() => NativeMethods.k4a_device_set_capture_callback(this.handle, null, IntPtr.Zero));
+                this.captureReadyCallback = null;
+            }
+        }
+
+        // Completes the IMU streams and returns the device to reading samples with GetImuSample.
+        // Called with the Device lock held after the IMU has stopped.
+        private void EndImuStreams()
+        {
+            lock (this.streamLock)
+            {
+                if (this.imuReadyCallback == null)
+                {
+                    return;
                 }
+
+                this.imuQueues.ForEach(queue => queue.Complete());
+                this.imuQueues.Clear();
+
+                AzureKinectException.ThrowIfNotSuccess(() => NativeMethods.k4a_device_set_imu_callback(this.handle, null, IntPtr.Zero));
+                this.imuReadyCallback = null;
+            }
+        }
+
+        // Called on an SDK thread with each synchronized capture. The native capture is only valid for the
+        // duration of the call, so each stream gets its own reference.
+        private void OnCaptureReady(IntPtr captureHandle, IntPtr context)
+        {
+            try
+            {
+                lock (this.streamLock)
+                {
+                    // Streams whose reader has finished no longer accept captures
+                    _ = this.captureQueues.RemoveAll(queue => !queue.Post(new Capture(NativeMethods.k4a_capture_t.CreateReference(captureHandle))));
+                }
+            }
+            catch (Exception)
+            {
+                // Exceptions must not propagate into the native layer. This happens when the CLR is shutting
+                // down and new objects can no longer be registered for disposal.
+                System.Diagnostics.Debug.WriteLine("Unable to deliver capture to stream");
+            }
+        }
+
+        // Called on the IMU streaming thread with each sample.
+        private void OnImuSampleReady(IntPtr imuSample, IntPtr context)
+        {
+            try
+            {
+                NativeMethods.k4a_imu_sample_t sample = Marshal.PtrToStructure<NativeMethods.k4a_imu_sample_t>(imuSample);
+
+                lock (this.streamLock)
+                {
+                    _ = this.imuQueues.RemoveAll(queue => !queue.Post(sample.ToImuSample()));
+                }
+            }
+            catch (Exception)
+            {
+                // Exceptions must not propagate into the native layer
+                System.Diagnostics.Debug.WriteLine("Unable to deliver IMU sample to stream");
             }
         }
     }
@@ -148,9 +148,10 @@ namespace Microsoft.Azure.Kinect.Sensor
                     // to a managed array, ensuring memory-safe access to the contents of memory, at the expense of
                     // a memcpy each time we transition the buffer from native to managed, or from managed to native.
 
-                    // If we don't copy the native buffers, we can construct a MemoryManager<T> that wraps that native
-                    // buffer. This has no memcpy cost, but exposes the possibility of use after free bugs to consumers
-                    // of the library. This is therefore not enabled by default.
+                    // If we don't copy the native buffers, we construct a MemoryManager<T> that wraps that native
+                    // buffer. This has no memcpy cost and is the default. The wrapper holds its own reference to the
+                    // native image, so the buffer stays valid while the Memory<T> is pinned, and reading its Span after
+                    // the Image has been disposed throws an ObjectDisposedException.
                     if (Allocator.Singleton.SafeCopyNativeBuffers)
                     {
                         // Create a copy
@@ -162,9 +163,8 @@ namespace Microsoft.Azure.Kinect.Sensor
                     else
                     {
                         // Provide a Memory<T> object that wraps a native pointer
-                        // This is UNSAFE. Callers in safe code may access unowned native
-                        // memory if they use the Memory<T> or Span<T> after the Image has
-                        // been disposed.
+                        // A Span<T> taken from the Memory<T> must not be used after the
+                        // Image has been disposed, since it refers to the native memory directly.
                         this.nativeBufferWrapper = new AzureKinectMemoryManager(this);
 
                         return this.nativeBufferWrapper.Memory;
@@ -508,6 +508,52 @@ namespace Microsoft.Azure.Kinect.Sensor
             return new AzureKinectMemoryCast<byte, TPixel>(this.Memory.Slice(row * this.StrideBytes, activeLineBytes)).Memory;
         }
 
+        /// <summary>
+        /// Gets a read-only span over the pixels of the image.
+        /// </summary>
+        /// <typeparam name="TPixel">The type of the pixel.</typeparam>
+        /// <remarks>
+        /// The span refers to the image buffer without copying it when the buffer came from the managed
+        /// allocator or when <see cref="Memory"/> wraps the native buffer. The span must not be used after
+        /// the Image has been disposed. If the image pixels are not in contiguous memory, this method will
+        /// throw an exception.
+        /// </remarks>
+        /// <returns>The contiguous pixels of the image.</returns>
+        public ReadOnlySpan<TPixel> GetPixelSpan<TPixel>()
+            where TPixel : unmanaged
+        {
+            if (this.StrideBytes != Marshal.SizeOf(typeof(TPixel)) * this.WidthPixels)
+            {
+                throw new AzureKinectException("Pixels not aligned to stride of each line");
+            }
+
+            return MemoryMarshal.Cast<byte, TPixel>(this.Memory.Span);
+        }
+
+        /// <summary>
+        /// Gets a read-only span over one row of pixels of the image.
+        /// </summary>
+        /// <typeparam name="TPixel">The type of the pixel.</typeparam>
+        /// <param name="row">The row of pixels to get.</param>
+        /// <remarks>The span must not be used after the Image has been disposed.</remarks>
+        /// <returns>The contiguous pixels of the image row.</returns>
+        public ReadOnlySpan<TPixel> GetPixelSpan<TPixel>(int row)
+            where TPixel : unmanaged
+        {
+            if (row >= this.HeightPixels || row < 0)
+            {
+                throw new ArgumentOutOfRangeException(nameof(row));
+            }
+
+            int activeLineBytes = Marshal.SizeOf(typeof(TPixel)) * this.WidthPixels;
+            if (this.StrideBytes < activeLineBytes)
+            {
+                throw new AzureKinectException("The image stride is not large enough for pixels of this size");
+            }
+
+            return MemoryMarshal.Cast<byte, TPixel>(this.Memory.Span.Slice(row * this.StrideBytes, activeLineBytes));
+        }
+
         /// <summary>
         /// Gets a pixel value in the image.
         /// </summary>
@@ -22,12 +22,21 @@ namespace Microsoft.Azure.Kinect.Sensor
         [UnmanagedFunctionPointer(k4aCallingConvention)]
         public delegate IntPtr k4a_memory_allocate_cb_t(int size, out IntPtr context);
 
+        [UnmanagedFunctionPointer(k4aCallingConvention)]
+        public delegate IntPtr k4a_memory_allocate_source_cb_t(int size, int source, IntPtr allocator_context, out IntPtr context);
+
         [UnmanagedFunctionPointer(k4aCallingConvention)]
         public delegate void k4a_memory_destroy_cb_t(IntPtr buffer, IntPtr context);
 
         [UnmanagedFunctionPointer(k4aCallingConvention)]
         public delegate void k4a_logging_message_cb_t(IntPtr context, LogLevel level, [MarshalAs(UnmanagedType.LPStr)] string file, int line, [MarshalAs(UnmanagedType.LPStr)] string message);
 
+        [UnmanagedFunctionPointer(k4aCallingConvention)]
+        public delegate void k4a_capture_ready_cb_t(IntPtr capture_handle, IntPtr context);
+
+        [UnmanagedFunctionPointer(k4aCallingConvention)]
+        public delegate void k4a_imu_sample_ready_cb_t(IntPtr imu_sample, IntPtr context);
+
         [NativeReference]
         public enum k4a_buffer_result_t
         {
@@ -270,6 +279,28 @@ namespace Microsoft.Azure.Kinect.Sensor
             [Out] k4a_imu_sample_t imu_sample,
             int timeout_in_ms);
 
+        [DllImport("k4a", CallingConvention = k4aCallingConvention)]
+        [NativeReference]
+        public static extern k4a_result_t k4a_device_set_capture_callback(
+            k4a_device_t device_handle,
+            k4a_capture_ready_cb_t callback,
+            IntPtr context);
+
+        [DllImport("k4a", CallingConvention = k4aCallingConvention)]
+        [NativeReference]
+        public static extern k4a_result_t k4a_device_set_imu_callback(
+            k4a_device_t device_handle,
+            k4a_imu_sample_ready_cb_t callback,
+            IntPtr context);
+
+        [DllImport("k4a", CallingConvention = k4aCallingConvention)]
+        [NativeReference]
+        public static extern k4a_result_t k4a_device_set_allocator(
+            k4a_device_t device_handle,
+            k4a_memory_allocate_source_cb_t allocate,
+            k4a_memory_destroy_cb_t free,
+            IntPtr allocator_context);
+
         [DllImport("k4a", CallingConvention = k4aCallingConvention)]
         [NativeReference]
         public static extern k4a_result_t k4a_device_get_sync_jack(
@@ -465,6 +496,16 @@ namespace Microsoft.Azure.Kinect.Sensor
             {
             }
 
+            public static k4a_capture_t CreateReference(IntPtr handle)
+            {
+                k4a_capture_t reference = new k4a_capture_t();
+
+                k4a_capture_reference(handle);
+
+                reference.handle = handle;
+                return reference;
+            }
+
             public k4a_capture_t DuplicateReference()
             {
                 k4a_capture_t duplicate = new k4a_capture_t();
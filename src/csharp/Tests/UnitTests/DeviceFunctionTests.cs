@@ -670,6 +670,93 @@ void k4a_capture_release(k4a_capture_t capture_handle)
             }
         }
 
+        [Test]
+        public void DeviceStreamCaptures()
+        {
+            SetOpenCloseImplementation();
+
+            NativeK4a.SetImplementation(@"
+
+k4a_capture_ready_cb_t *capture_callback = NULL;
+int running = 0;
+
+k4a_result_t k4a_device_set_capture_callback(k4a_device_t device_handle, k4a_capture_ready_cb_t *callback, void *context)
+{
+    STUB_ASSERT(device_handle == (k4a_device_t)0x1234ABCD);
+
+    if (running)
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    capture_callback = callback;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t k4a_device_start_cameras(k4a_device_t device_handle, const k4a_device_configuration_t *config)
+{
+    STUB_ASSERT(device_handle == (k4a_device_t)0x1234ABCD);
+    STUB_ASSERT(capture_callback != NULL);
+
+    running = 1;
+
+    // Deliver one more capture than the stream holds
+    for (int i = 0; i < 3; i++)
+    {
+        capture_callback((k4a_capture_t)0x0C001234, NULL);
+    }
+
+    return K4A_RESULT_SUCCEEDED;
+}
+
+void k4a_device_stop_cameras(k4a_device_t device_handle)
+{
+    STUB_ASSERT(device_handle == (k4a_device_t)0x1234ABCD);
+    running = 0;
+}
+
+void k4a_capture_reference(k4a_capture_t capture_handle)
+{
+    STUB_ASSERT(capture_handle == (k4a_capture_t)0x0C001234);
+}
+
+void k4a_capture_release(k4a_capture_t capture_handle)
+{
+    STUB_ASSERT(capture_handle == (k4a_capture_t)0x0C001234);
+}
+");
+            {
+                CallCount count = NativeK4a.CountCalls();
+                using (Device device = Device.Open(0))
+                {
+                    var captures = device.StreamCapturesAsync().GetAsyncEnumerator();
+
+                    device.StartCameras(new DeviceConfiguration());
+
+                    // The oldest capture was dropped when the third arrived
+                    Assert.AreEqual(3, count.Calls("k4a_capture_reference"));
+                    Assert.AreEqual(1, count.Calls("k4a_capture_release"));
+
+                    device.StopCameras();
+
+                    // The queued captures are still read after the stream has ended
+                    for (int i = 0; i < 2; i++)
+                    {
+                        Assert.IsTrue(captures.MoveNextAsync().AsTask().Result);
+                        captures.Current.Dispose();
+                    }
+
+                    Assert.IsFalse(captures.MoveNextAsync().AsTask().Result);
+                    captures.DisposeAsync().AsTask().Wait();
+
+                    Assert.AreEqual(3, count.Calls("k4a_capture_release"));
+
+                    // The callback is cleared once the cameras have stopped
+                    Assert.AreEqual(2, count.Calls("k4a_device_set_capture_callback"));
+                }
+            }
+        }
+
         [Test]
         public void DeviceGetCaptureTimeout()
         {
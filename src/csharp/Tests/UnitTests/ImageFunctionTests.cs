@@ -203,5 +203,48 @@ k4a_result_t k4a_set_debug_message_handler(
         
             Assert.AreEqual(count.Calls("k4a_image_reference") + 1, count.Calls("k4a_image_release"), "References not zero");
         }
+
+        [Test]
+        public void ImagePixelSpanTest()
+        {
+            SetImageStubImplementation();
+
+            using (Image image = new Image(ImageFormat.Custom, 640, 480, 640 * 2))
+            {
+                System.ReadOnlySpan<short> pixels = image.GetPixelSpan<short>();
+
+                Assert.AreEqual(640 * 480, pixels.Length);
+                Assert.AreEqual(1, pixels[1]);
+
+                System.ReadOnlySpan<short> row = image.GetPixelSpan<short>(1);
+
+                Assert.AreEqual(640, row.Length);
+                Assert.AreEqual(641, row[1]);
+
+                Assert.Throws<ArgumentOutOfRangeException>(() => image.GetPixelSpan<short>(480));
+            }
+        }
+
+        [Test]
+        public void ImageMemoryPinnedAfterDispose()
+        {
+            SetImageStubImplementation();
+
+            CallCount count = NativeK4a.CountCalls();
+
+            Image image = new Image(ImageFormat.Custom, 640, 480, 640 * 2);
+            Memory<byte> memory = image.Memory;
+
+            System.Buffers.MemoryHandle pin = memory.Pin();
+            image.Dispose();
+
+            // The pinned buffer still holds a reference to the native image
+            Assert.AreEqual(count.Calls("k4a_image_reference"), count.Calls("k4a_image_release"));
+            Assert.Throws<ObjectDisposedException>(() => { System.Span<byte> span = memory.Span; });
+
+            pin.Dispose();
+
+            Assert.AreEqual(count.Calls("k4a_image_reference") + 1, count.Calls("k4a_image_release"), "References not zero");
+        }
     }
 }
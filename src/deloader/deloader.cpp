@@ -7,6 +7,11 @@
 #include <k4ainternal/global.h>
 #include <k4ainternal/logging.h>
 #include <k4ainternal/dynlib.h>
+#include <k4ainternal/atomic.h>
+#include <azure_c_shared_utility/envvariable.h>
+#include <azure_c_shared_utility/threadapi.h>
+
+#include <string.h>
 
 typedef struct
 {
@@ -19,6 +24,10 @@ typedef struct
 static void deloader_init_once(deloader_global_context_t *global);
 static void deloader_deinit(void);
 
+// Background load started by deloader_load_async(), joined when the binary unloads
+static THREAD_HANDLE g_load_thread = NULL;
+static volatile uint32_t g_load_thread_started = 0;
+
 // Creates a function called deloader_global_context_t_get() which returns the initialized
 // singleton global
 K4A_DECLARE_GLOBAL(deloader_global_context_t, deloader_init_once);
@@ -60,19 +69,23 @@ static bool verify_plugin(const k4a_plugin_t *plugin)
     RETURN_VALUE_IF_ARG(false, plugin->transform_engine_get_output_frame_size == NULL);
     RETURN_VALUE_IF_ARG(false, plugin->transform_engine_destroy == NULL);
 
+    // The asynchronous entry points are optional, but only as a pair
+    RETURN_VALUE_IF_ARG(false,
+                        (plugin->depth_engine_submit_frame == NULL) != (plugin->depth_engine_complete_frame == NULL));
+    RETURN_VALUE_IF_ARG(false,
+                        (plugin->depth_engine_create_and_initialize_on_gpu == NULL) !=
+                            (plugin->depth_engine_get_gpu_count == NULL));
+
     return true;
 }
 
-// Load Depth Engine
-static void deloader_init_once(deloader_global_context_t *global)
+// Load and verify the plugin called name, leaving global unloaded on failure
+static k4a_result_t deloader_load_plugin(deloader_global_context_t *global, const char *name)
 {
-    // All members are initialized to zero
-
-    k4a_result_t result = dynlib_create(K4A_PLUGIN_DYNAMIC_LIBRARY_NAME, K4A_PLUGIN_VERSION, &global->handle);
+    k4a_result_t result = dynlib_create(name, K4A_PLUGIN_VERSION, &global->handle);
     if (K4A_FAILED(result))
     {
-        LOG_ERROR("Failed to Load Depth Engine Plugin (%s). Depth functionality will not work",
-                  K4A_PLUGIN_DYNAMIC_LIBRARY_NAME);
+        LOG_ERROR("Failed to Load Depth Engine Plugin (%s). Depth functionality will not work", name);
         LOG_ERROR("Make sure the depth engine plugin is in your loaders path", 0);
     }
 
@@ -91,10 +104,92 @@ static void deloader_init_once(deloader_global_context_t *global)
         result = K4A_RESULT_FROM_BOOL(verify_plugin(&global->plugin));
     }
 
+    if (K4A_FAILED(result))
+    {
+        if (global->handle)
+        {
+            dynlib_destroy(global->handle);
+        }
+        memset(global, 0, sizeof(*global));
+    }
+
+    return result;
+}
+
+// Load Depth Engine
+static void deloader_init_once(deloader_global_context_t *global)
+{
+    // All members are initialized to zero
+
+    // An alternative implementation, like a CPU depth engine for machines without a usable GPU, can replace the
+    // default plugin or be tried when it fails to load
+    const char *name = environment_get_variable("K4A_DEPTH_ENGINE_PLUGIN");
+    if (name == NULL || name[0] == '\0')
+    {
+        name = K4A_PLUGIN_DYNAMIC_LIBRARY_NAME;
+    }
+
+    k4a_result_t result = deloader_load_plugin(global, name);
+
+    const char *fallback_name = environment_get_variable("K4A_DEPTH_ENGINE_FALLBACK_PLUGIN");
+    if (K4A_FAILED(result) && fallback_name != NULL && fallback_name[0] != '\0')
+    {
+        LOG_WARNING("Loading the fallback depth engine plugin (%s)", fallback_name);
+        result = deloader_load_plugin(global, fallback_name);
+    }
+
     if (K4A_SUCCEEDED(result))
     {
         global->loaded = true;
+
+        // Compiled shaders can outlive the process so the first depth engine of the next one starts faster
+        const char *cache_directory = environment_get_variable("K4A_DEPTH_ENGINE_CACHE_DIR");
+        if (cache_directory != NULL && cache_directory[0] != '\0')
+        {
+            if (global->plugin.depth_engine_set_cache_directory == NULL)
+            {
+                LOG_WARNING("Ignoring K4A_DEPTH_ENGINE_CACHE_DIR, the depth engine does not support a shader cache", 0);
+            }
+            else if (!global->plugin.depth_engine_set_cache_directory(cache_directory))
+            {
+                LOG_WARNING("Depth engine can not cache shaders in %s", cache_directory);
+            }
+        }
+    }
+}
+
+bool deloader_load(void)
+{
+    return is_plugin_loaded(deloader_global_context_t_get());
+}
+
+static int deloader_load_thread(void *param)
+{
+    (void)param;
+    (void)deloader_load();
+    return 0;
+}
+
+k4a_result_t deloader_load_async(void)
+{
+    uint32_t expected = 0;
+    if (!k4a_atomic_cas(&g_load_thread_started, expected, 1))
+    {
+        // Already loading or loaded, the load is shared by the whole process
+        return K4A_RESULT_SUCCEEDED;
+    }
+
+    THREAD_HANDLE thread = NULL;
+    k4a_result_t result = K4A_RESULT_FROM_BOOL(ThreadAPI_Create(&thread, deloader_load_thread, NULL) == THREADAPI_OK);
+    if (K4A_SUCCEEDED(result))
+    {
+        k4a_atomic_store_ptr(&g_load_thread, thread);
     }
+    else
+    {
+        k4a_atomic_store(&g_load_thread_started, 0);
+    }
+    return result;
 }
 
 k4a_depth_engine_result_code_t deloader_depth_engine_create_and_initialize(k4a_depth_engine_context_t **context,
@@ -124,6 +219,54 @@ k4a_depth_engine_result_code_t deloader_depth_engine_create_and_initialize(k4a_d
                                                              callback_context);
 }
 
+k4a_depth_engine_result_code_t
+deloader_depth_engine_create_and_initialize_on_gpu(k4a_depth_engine_context_t **context,
+                                                   size_t cal_block_size_in_bytes,
+                                                   void *cal_block,
+                                                   k4a_depth_engine_mode_t mode,
+                                                   k4a_depth_engine_input_type_t input_format,
+                                                   void *camera_calibration,
+                                                   k4a_processing_complete_cb_t *callback,
+                                                   void *callback_context,
+                                                   uint32_t gpu_index)
+{
+    deloader_global_context_t *global = deloader_global_context_t_get();
+
+    if (!is_plugin_loaded(global))
+    {
+        LOG_ERROR("Failed to load depth engine plugin", 0);
+        return K4A_DEPTH_ENGINE_RESULT_FATAL_ERROR_ENGINE_NOT_LOADED;
+    }
+
+    if (global->plugin.depth_engine_create_and_initialize_on_gpu == NULL)
+    {
+        LOG_ERROR("The depth engine plugin does not support selecting a GPU", 0);
+        return K4A_DEPTH_ENGINE_RESULT_FATAL_ERROR_INITIALIZE_ENGINE_FAILED;
+    }
+
+    return global->plugin.depth_engine_create_and_initialize_on_gpu(context,
+                                                                    cal_block_size_in_bytes,
+                                                                    cal_block,
+                                                                    mode,
+                                                                    input_format,
+                                                                    camera_calibration,
+                                                                    callback,
+                                                                    callback_context,
+                                                                    gpu_index);
+}
+
+uint32_t deloader_depth_engine_get_gpu_count(void)
+{
+    deloader_global_context_t *global = deloader_global_context_t_get();
+
+    if (!is_plugin_loaded(global) || global->plugin.depth_engine_get_gpu_count == NULL)
+    {
+        return 0;
+    }
+
+    return global->plugin.depth_engine_get_gpu_count();
+}
+
 k4a_depth_engine_result_code_t
 deloader_depth_engine_process_frame(k4a_depth_engine_context_t *context,
                                     void *input_frame,
@@ -151,6 +294,52 @@ deloader_depth_engine_process_frame(k4a_depth_engine_context_t *context,
                                                      input_frame_info);
 }
 
+bool deloader_depth_engine_supports_submit(void)
+{
+    deloader_global_context_t *global = deloader_global_context_t_get();
+
+    return is_plugin_loaded(global) && global->plugin.depth_engine_submit_frame != NULL;
+}
+
+k4a_depth_engine_result_code_t deloader_depth_engine_submit_frame(k4a_depth_engine_context_t *context,
+                                                                  void *input_frame,
+                                                                  size_t input_frame_size,
+                                                                  k4a_depth_engine_output_type_t output_type,
+                                                                  void *output_frame,
+                                                                  size_t output_frame_size,
+                                                                  void *frame_context)
+{
+    deloader_global_context_t *global = deloader_global_context_t_get();
+
+    if (!is_plugin_loaded(global) || global->plugin.depth_engine_submit_frame == NULL)
+    {
+        return K4A_DEPTH_ENGINE_RESULT_FATAL_ERROR_ENGINE_NOT_LOADED;
+    }
+
+    return global->plugin.depth_engine_submit_frame(context,
+                                                    input_frame,
+                                                    input_frame_size,
+                                                    output_type,
+                                                    output_frame,
+                                                    output_frame_size,
+                                                    frame_context);
+}
+
+k4a_depth_engine_result_code_t
+deloader_depth_engine_complete_frame(k4a_depth_engine_context_t *context,
+                                     void **frame_context,
+                                     k4a_depth_engine_output_frame_info_t *output_frame_info)
+{
+    deloader_global_context_t *global = deloader_global_context_t_get();
+
+    if (!is_plugin_loaded(global) || global->plugin.depth_engine_complete_frame == NULL)
+    {
+        return K4A_DEPTH_ENGINE_RESULT_FATAL_ERROR_ENGINE_NOT_LOADED;
+    }
+
+    return global->plugin.depth_engine_complete_frame(context, frame_context, output_frame_info);
+}
+
 size_t deloader_depth_engine_get_output_frame_size(k4a_depth_engine_context_t *context)
 {
     deloader_global_context_t *global = deloader_global_context_t_get();
@@ -163,6 +352,29 @@ size_t deloader_depth_engine_get_output_frame_size(k4a_depth_engine_context_t *c
     return global->plugin.depth_engine_get_output_frame_size(context);
 }
 
+size_t deloader_depth_engine_get_output_frame_size_for_type(k4a_depth_engine_context_t *context,
+                                                            k4a_depth_engine_output_type_t output_type)
+{
+    deloader_global_context_t *global = deloader_global_context_t_get();
+
+    if (!is_plugin_loaded(global))
+    {
+        return 0;
+    }
+
+    if (global->plugin.depth_engine_get_output_frame_size_for_type == NULL)
+    {
+        // Every depth engine outputs depth and ir with the default frame size
+        if (output_type != K4A_DEPTH_ENGINE_OUTPUT_TYPE_Z_DEPTH)
+        {
+            return 0;
+        }
+        return global->plugin.depth_engine_get_output_frame_size(context);
+    }
+
+    return global->plugin.depth_engine_get_output_frame_size_for_type(context, output_type);
+}
+
 void deloader_depth_engine_destroy(k4a_depth_engine_context_t **context)
 {
     deloader_global_context_t *global = deloader_global_context_t_get();
@@ -255,6 +467,13 @@ void deloader_transform_engine_destroy(k4a_transform_engine_context_t **context)
 
 void deloader_deinit(void)
 {
+    THREAD_HANDLE thread = (THREAD_HANDLE)k4a_atomic_exchange_ptr(&g_load_thread, NULL);
+    if (thread)
+    {
+        int thread_result;
+        (void)ThreadAPI_Join(thread, &thread_result);
+    }
+
     deloader_global_context_t *global = deloader_global_context_t_get();
 
     if (global->handle)
@@ -15,6 +15,7 @@
 
 // System dependencies
 #include <stdlib.h>
+#include <string.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -41,6 +42,7 @@ typedef struct _depth_context_t
     bool calibration_init;
 
     bool running;
+    bool keep_alive;
     k4a_hardware_version_t version;
     k4a_calibration_camera_t calibration;
 
@@ -361,10 +363,13 @@ k4a_result_t depth_get_device_version(depth_t depth_handle, k4a_hardware_version
     return result;
 }
 
-k4a_result_t depth_start(depth_t depth_handle, const k4a_device_configuration_t *config)
+k4a_result_t depth_start(depth_t depth_handle,
+                         const k4a_device_configuration_t *config,
+                         const k4a_device_start_options_t *options)
 {
     RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, depth_t, depth_handle);
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, config == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, options == NULL);
 
     depth_context_t *depth = depth_t_get_context(depth_handle);
     k4a_result_t result = K4A_RESULT_SUCCEEDED;
@@ -390,12 +395,28 @@ k4a_result_t depth_start(depth_t depth_handle, const k4a_device_configuration_t
         }
     }
 
+    if (K4A_SUCCEEDED(result))
+    {
+        // The warm up frame is the size of the raw frames of the mode just set
+        size_t warm_up_frame_size = 0;
+        if (options->prefault_buffers && !options->raw_depth_payload)
+        {
+            result = TRACE_CALL(depthmcu_depth_get_frame_size(depth->depthmcu, &warm_up_frame_size));
+        }
+        dewrapper_set_warm_up(depth->dewrapper, warm_up_frame_size);
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        result = TRACE_CALL(depthmcu_depth_set_prefault(depth->depthmcu, options->prefault_buffers));
+    }
+
     if (K4A_SUCCEEDED(result))
     {
         // Note: Depth Engine Start must be called after the mode is set in the sensor due to the sensor calibration
         // dependency on the mode of operation
-        result = TRACE_CALL(
-            dewrapper_start(depth->dewrapper, config, depth->calibration_memory, depth->calibration_memory_size));
+        result = TRACE_CALL(dewrapper_start(
+            depth->dewrapper, config, options, depth->calibration_memory, depth->calibration_memory_size));
     }
 
     if (K4A_SUCCEEDED(result))
@@ -416,6 +437,32 @@ k4a_result_t depth_start(depth_t depth_handle, const k4a_device_configuration_t
     return result;
 }
 
+k4a_result_t depth_reconfigure(depth_t depth_handle,
+                               const k4a_device_configuration_t *config,
+                               const k4a_device_start_options_t *options)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, depth_t, depth_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, config == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, options == NULL);
+    depth_context_t *depth = depth_t_get_context(depth_handle);
+
+    if (!depth->running)
+    {
+        LOG_ERROR("The depth sensor can only be reconfigured while it is streaming", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    // The depth engine thread parks on stop instead of exiting, so the start below resumes it and keeps its depth
+    // engine when the depth mode is unchanged. The calibration was read by the first start and is not read again.
+    dewrapper_set_keep_alive(depth->dewrapper, true);
+    depth_stop(depth_handle);
+    k4a_result_t result = TRACE_CALL(depth_start(depth_handle, config, options));
+
+    // A running thread is not affected, a thread parked by a failed start exits
+    dewrapper_set_keep_alive(depth->dewrapper, depth->keep_alive);
+    return result;
+}
+
 void depth_stop(depth_t depth_handle)
 {
     bool quiet = false;
@@ -439,6 +486,113 @@ void depth_stop_internal(depth_t depth_handle, bool quiet)
     depth->running = false;
 }
 
+k4a_result_t depth_set_allocator(depth_t depth_handle, const allocator_hook_t *hook)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, depth_t, depth_handle);
+    depth_context_t *depth = depth_t_get_context(depth_handle);
+
+    k4a_result_t result = K4A_RESULT_FROM_BOOL(depth->running == false);
+    if (K4A_SUCCEEDED(result))
+    {
+        result = TRACE_CALL(depthmcu_depth_set_allocator(depth->depthmcu, hook));
+    }
+    if (K4A_SUCCEEDED(result))
+    {
+        result = TRACE_CALL(dewrapper_set_allocator(depth->dewrapper, hook));
+    }
+    return result;
+}
+
+k4a_result_t depth_set_depth_engine_gpu(depth_t depth_handle, int32_t gpu_index)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, depth_t, depth_handle);
+    depth_context_t *depth = depth_t_get_context(depth_handle);
+
+    k4a_result_t result = K4A_RESULT_FROM_BOOL(depth->running == false);
+    if (K4A_SUCCEEDED(result))
+    {
+        result = TRACE_CALL(dewrapper_set_gpu(depth->dewrapper, gpu_index));
+    }
+    return result;
+}
+
+k4a_result_t depth_set_depth_filter(depth_t depth_handle, const k4a_depth_filter_configuration_t *config)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, depth_t, depth_handle);
+    depth_context_t *depth = depth_t_get_context(depth_handle);
+
+    k4a_result_t result = K4A_RESULT_FROM_BOOL(depth->running == false);
+    if (K4A_SUCCEEDED(result))
+    {
+        result = TRACE_CALL(dewrapper_set_depth_filter(depth->dewrapper, config));
+    }
+    return result;
+}
+
+k4a_result_t depth_set_depth_engine_keep_alive(depth_t depth_handle, bool keep_alive)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, depth_t, depth_handle);
+    depth_context_t *depth = depth_t_get_context(depth_handle);
+
+    depth->keep_alive = keep_alive;
+    dewrapper_set_keep_alive(depth->dewrapper, keep_alive);
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t depth_get_depth_engine_gpu_statistics(depth_t depth_handle, k4a_depth_engine_gpu_statistics_t *statistics)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, depth_t, depth_handle);
+    depth_context_t *depth = depth_t_get_context(depth_handle);
+
+    return TRACE_CALL(dewrapper_get_gpu_statistics(depth->dewrapper, statistics));
+}
+
+k4a_result_t depth_get_statistics(depth_t depth_handle, k4a_device_statistics_t *statistics)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, depth_t, depth_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, statistics == NULL);
+    depth_context_t *depth = depth_t_get_context(depth_handle);
+
+    usb_cmd_stream_pool_stats_t pool_stats = { 0 };
+    k4a_result_t result = TRACE_CALL(dewrapper_get_statistics(depth->dewrapper, statistics));
+    if (K4A_SUCCEEDED(result))
+    {
+        result = TRACE_CALL(depthmcu_depth_get_pool_stats(depth->depthmcu, &pool_stats));
+    }
+    if (K4A_SUCCEEDED(result))
+    {
+        statistics->usb_timeout_count = pool_stats.timeout_count;
+        statistics->usb_transfer_count = pool_stats.transfer_count;
+        statistics->usb_pool_size = pool_stats.pool_size;
+        statistics->usb_pool_recycled_count = pool_stats.recycled_count;
+        statistics->usb_pool_exhausted_count = pool_stats.exhausted_count;
+    }
+    return result;
+}
+
+k4a_buffer_result_t depth_get_raw_calibration(depth_t depth_handle, uint8_t *data, size_t *data_size)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_BUFFER_RESULT_FAILED, depth_t, depth_handle);
+    RETURN_VALUE_IF_ARG(K4A_BUFFER_RESULT_FAILED, data_size == NULL);
+    depth_context_t *depth = depth_t_get_context(depth_handle);
+
+    if (!depth->calibration_init)
+    {
+        LOG_ERROR("The depth calibration is read when the depth camera is first started.", 0);
+        return K4A_BUFFER_RESULT_FAILED;
+    }
+
+    if (data == NULL || *data_size < depth->calibration_memory_size)
+    {
+        *data_size = depth->calibration_memory_size;
+        return K4A_BUFFER_RESULT_TOO_SMALL;
+    }
+
+    memcpy(data, depth->calibration_memory, depth->calibration_memory_size);
+    *data_size = depth->calibration_memory_size;
+    return K4A_BUFFER_RESULT_SUCCEEDED;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -462,6 +462,67 @@ k4a_result_t depthmcu_reset_device(depthmcu_t depthmcu_handle)
     return TRACE_CALL(usb_cmd_write(depthmcu->usb_cmd, DEV_CMD_RESET, NULL, 0, NULL, 0));
 }
 
+k4a_result_t depthmcu_depth_set_transfer_limits(depthmcu_t depthmcu_handle,
+                                                uint32_t max_transfer_count,
+                                                size_t max_transfer_pool_size)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, depthmcu_t, depthmcu_handle);
+    depthmcu_context_t *depthmcu = depthmcu_t_get_context(depthmcu_handle);
+
+    return TRACE_CALL(
+        usb_cmd_stream_set_transfer_limits(depthmcu->usb_cmd, max_transfer_count, max_transfer_pool_size));
+}
+
+k4a_result_t depthmcu_depth_set_allocator(depthmcu_t depthmcu_handle, const allocator_hook_t *hook)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, depthmcu_t, depthmcu_handle);
+    depthmcu_context_t *depthmcu = depthmcu_t_get_context(depthmcu_handle);
+
+    return TRACE_CALL(usb_cmd_stream_set_allocator(depthmcu->usb_cmd, hook));
+}
+
+k4a_result_t depthmcu_depth_set_prefault(depthmcu_t depthmcu_handle, bool prefault)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, depthmcu_t, depthmcu_handle);
+    depthmcu_context_t *depthmcu = depthmcu_t_get_context(depthmcu_handle);
+
+    return TRACE_CALL(usb_cmd_stream_set_prefault(depthmcu->usb_cmd, prefault));
+}
+
+k4a_result_t depthmcu_depth_get_frame_size(depthmcu_t depthmcu_handle, size_t *frame_size)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, depthmcu_t, depthmcu_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, frame_size == NULL);
+    depthmcu_context_t *depthmcu = depthmcu_t_get_context(depthmcu_handle);
+
+    *frame_size = depthmcu->mode_size;
+    return K4A_RESULT_FROM_BOOL(depthmcu->mode_size != 0);
+}
+
+k4a_result_t depthmcu_depth_get_transfer_count(depthmcu_t depthmcu_handle, uint32_t *transfer_count)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, depthmcu_t, depthmcu_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, transfer_count == NULL);
+    depthmcu_context_t *depthmcu = depthmcu_t_get_context(depthmcu_handle);
+    usb_cmd_stream_pool_stats_t stats = { 0 };
+
+    k4a_result_t result = TRACE_CALL(usb_cmd_get_stream_pool_stats(depthmcu->usb_cmd, &stats));
+    if (K4A_SUCCEEDED(result))
+    {
+        *transfer_count = stats.transfer_count;
+    }
+    return result;
+}
+
+k4a_result_t depthmcu_depth_get_pool_stats(depthmcu_t depthmcu_handle, usb_cmd_stream_pool_stats_t *stats)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, depthmcu_t, depthmcu_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, stats == NULL);
+    depthmcu_context_t *depthmcu = depthmcu_t_get_context(depthmcu_handle);
+
+    return TRACE_CALL(usb_cmd_get_stream_pool_stats(depthmcu->usb_cmd, stats));
+}
+
 const guid_t *depthmcu_get_container_id(depthmcu_t depthmcu_handle)
 {
     RETURN_VALUE_IF_HANDLE_INVALID(NULL, depthmcu_t, depthmcu_handle);
@@ -0,0 +1,397 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// This library
+#include <k4ainternal/depth_filter.h>
+
+// Dependent libraries
+#include <k4ainternal/logging.h>
+
+// System dependencies
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdbool.h>
+
+#if defined(__amd64__) || defined(_M_AMD64) || defined(__i386__) || defined(_M_IX86)
+#define K4A_USING_SSE
+#include <emmintrin.h> // SSE2
+#include <smmintrin.h> // SSE4.1
+#endif
+
+#define DEPTH_FILTER_ALPHA_ONE 256 // temporal_alpha of 1 in the fixed point blend
+
+struct _depth_filter_t
+{
+    k4a_depth_filter_configuration_t config;
+    uint32_t width;
+    uint32_t height;
+    uint32_t alpha;     // temporal_alpha in 1/DEPTH_FILTER_ALPHA_ONE
+    uint16_t *scratch;  // Output of the flying pixel and edge preserving filters, swapped with the image
+    uint16_t *history;  // Blended depth of the temporal filter, 0 where the pixel has no valid depth
+    uint16_t *hole_age; // Frames each pixel of history has been filling a hole for
+};
+
+static inline uint16_t depth_filter_abs_diff(uint16_t a, uint16_t b)
+{
+    return (uint16_t)(a > b ? a - b : b - a);
+}
+
+// True if the neighbor is invalid or on another surface than depth
+static inline bool depth_filter_is_far(uint16_t depth, uint16_t neighbor, uint16_t threshold)
+{
+    return neighbor == 0 || depth_filter_abs_diff(depth, neighbor) > threshold;
+}
+
+// up and down are NULL on the first and last row
+static inline uint16_t depth_filter_flying_pixel(const uint16_t *up,
+                                                 const uint16_t *row,
+                                                 const uint16_t *down,
+                                                 uint32_t x,
+                                                 uint32_t width,
+                                                 uint16_t threshold)
+{
+    uint16_t depth = row[x];
+    bool flying = false;
+    if (x > 0 && x + 1 < width)
+    {
+        flying = depth_filter_is_far(depth, row[x - 1], threshold) && depth_filter_is_far(depth, row[x + 1], threshold);
+    }
+    if (up != NULL && down != NULL)
+    {
+        flying = flying ||
+                 (depth_filter_is_far(depth, up[x], threshold) && depth_filter_is_far(depth, down[x], threshold));
+    }
+    return flying ? 0 : depth;
+}
+
+static void depth_filter_flying_pixels(const depth_filter_t *filter, const uint16_t *in, uint16_t *out)
+{
+    uint32_t width = filter->width;
+    uint16_t threshold = filter->config.flying_pixel_threshold_mm;
+
+    for (uint32_t y = 0; y < filter->height; y++)
+    {
+        const uint16_t *row = in + (size_t)y * width;
+        const uint16_t *up = y > 0 ? row - width : NULL;
+        const uint16_t *down = y + 1 < filter->height ? row + width : NULL;
+        uint16_t *out_row = out + (size_t)y * width;
+        uint32_t x = 0;
+
+#if defined(K4A_USING_SSE)
+        if (up != NULL && down != NULL && width > 1)
+        {
+            out_row[0] = depth_filter_flying_pixel(up, row, down, 0, width, threshold);
+            x = 1;
+
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i ones = _mm_set1_epi16(-1);
+            const __m128i threshold_8 = _mm_set1_epi16((short)threshold);
+            for (; x + 8 < width; x += 8)
+            {
+                __m128i depth = _mm_loadu_si128((const __m128i *)(row + x));
+                __m128i far[4];
+                __m128i neighbors[4] = { _mm_loadu_si128((const __m128i *)(row + x - 1)),
+                                         _mm_loadu_si128((const __m128i *)(row + x + 1)),
+                                         _mm_loadu_si128((const __m128i *)(up + x)),
+                                         _mm_loadu_si128((const __m128i *)(down + x)) };
+                for (int i = 0; i < 4; i++)
+                {
+                    __m128i diff = _mm_or_si128(_mm_subs_epu16(depth, neighbors[i]),
+                                                _mm_subs_epu16(neighbors[i], depth));
+                    __m128i close = _mm_cmpeq_epi16(_mm_subs_epu16(diff, threshold_8), zero);
+                    far[i] = _mm_or_si128(_mm_cmpeq_epi16(neighbors[i], zero), _mm_andnot_si128(close, ones));
+                }
+                __m128i flying = _mm_or_si128(_mm_and_si128(far[0], far[1]), _mm_and_si128(far[2], far[3]));
+                _mm_storeu_si128((__m128i *)(out_row + x), _mm_andnot_si128(flying, depth));
+            }
+        }
+#endif
+        for (; x < width; x++)
+        {
+            out_row[x] = depth_filter_flying_pixel(up, row, down, x, width, threshold);
+        }
+    }
+}
+
+static inline uint16_t depth_filter_edge_preserving_pixel(const uint16_t *in,
+                                                          uint32_t x,
+                                                          uint32_t y,
+                                                          uint32_t width,
+                                                          uint32_t height,
+                                                          uint16_t threshold)
+{
+    uint16_t depth = in[(size_t)y * width + x];
+    if (depth == 0)
+    {
+        return 0;
+    }
+
+    uint32_t sum = 0;
+    uint32_t count = 0;
+    for (uint32_t ny = y > 0 ? y - 1 : 0; ny <= y + 1 && ny < height; ny++)
+    {
+        for (uint32_t nx = x > 0 ? x - 1 : 0; nx <= x + 1 && nx < width; nx++)
+        {
+            uint16_t neighbor = in[(size_t)ny * width + nx];
+            if (!depth_filter_is_far(depth, neighbor, threshold))
+            {
+                sum += neighbor;
+                count++;
+            }
+        }
+    }
+    return (uint16_t)(sum / count);
+}
+
+// Average of each valid pixel with the valid 3x3 neighbors within edge_threshold_mm of it
+static void depth_filter_edge_preserving(const depth_filter_t *filter, const uint16_t *in, uint16_t *out)
+{
+    uint32_t width = filter->width;
+    uint32_t height = filter->height;
+    uint16_t threshold = filter->config.edge_threshold_mm;
+
+    for (uint32_t y = 0; y < height; y++)
+    {
+        uint16_t *out_row = out + (size_t)y * width;
+        uint32_t x = 0;
+
+#if defined(K4A_USING_SSE)
+        if (y > 0 && y + 1 < height && width > 1)
+        {
+            out_row[0] = depth_filter_edge_preserving_pixel(in, 0, y, width, height, threshold);
+            x = 1;
+
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i threshold_8 = _mm_set1_epi16((short)threshold);
+            const __m128i one_32 = _mm_set1_epi32(1);
+            for (; x + 8 < width; x += 8)
+            {
+                const uint16_t *center = in + (size_t)y * width + x;
+                __m128i depth = _mm_loadu_si128((const __m128i *)center);
+                __m128i sum_low = zero;
+                __m128i sum_high = zero;
+                __m128i count = zero;
+                for (int dy = -1; dy <= 1; dy++)
+                {
+                    for (int dx = -1; dx <= 1; dx++)
+                    {
+                        __m128i neighbor = _mm_loadu_si128((const __m128i *)(center + dy * (ptrdiff_t)width + dx));
+                        __m128i diff = _mm_or_si128(_mm_subs_epu16(depth, neighbor), _mm_subs_epu16(neighbor, depth));
+                        __m128i close = _mm_andnot_si128(_mm_cmpeq_epi16(neighbor, zero),
+                                                         _mm_cmpeq_epi16(_mm_subs_epu16(diff, threshold_8), zero));
+                        neighbor = _mm_and_si128(neighbor, close);
+                        sum_low = _mm_add_epi32(sum_low, _mm_unpacklo_epi16(neighbor, zero));
+                        sum_high = _mm_add_epi32(sum_high, _mm_unpackhi_epi16(neighbor, zero));
+                        count = _mm_sub_epi16(count, close);
+                    }
+                }
+
+                // The sums are below 2^24 and the counts at most 9, so the truncated float quotient is the integer
+                // one. Invalid pixels count no neighbor and are masked below.
+                __m128i count_low = _mm_max_epi32(_mm_unpacklo_epi16(count, zero), one_32);
+                __m128i count_high = _mm_max_epi32(_mm_unpackhi_epi16(count, zero), one_32);
+                __m128i mean_low = _mm_cvttps_epi32(_mm_div_ps(_mm_cvtepi32_ps(sum_low), _mm_cvtepi32_ps(count_low)));
+                __m128i mean_high = _mm_cvttps_epi32(
+                    _mm_div_ps(_mm_cvtepi32_ps(sum_high), _mm_cvtepi32_ps(count_high)));
+                __m128i mean = _mm_packus_epi32(mean_low, mean_high);
+                _mm_storeu_si128((__m128i *)(out_row + x), _mm_andnot_si128(_mm_cmpeq_epi16(depth, zero), mean));
+            }
+        }
+#endif
+        for (; x < width; x++)
+        {
+            out_row[x] = depth_filter_edge_preserving_pixel(in, x, y, width, height, threshold);
+        }
+    }
+}
+
+// Blends depth into the history in place, and fills invalid pixels from it for up to hole_fill_frames frames
+static void depth_filter_temporal(depth_filter_t *filter, uint16_t *depth)
+{
+    size_t count = (size_t)filter->width * filter->height;
+    uint16_t threshold = filter->config.temporal_threshold_mm;
+    uint16_t hole_fill_frames = filter->config.hole_fill_frames;
+    uint32_t alpha = filter->alpha;
+    uint16_t *history = filter->history;
+    uint16_t *hole_age = filter->hole_age;
+    size_t i = 0;
+
+#if defined(K4A_USING_SSE)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi16(-1);
+    const __m128i threshold_8 = _mm_set1_epi16((short)threshold);
+    const __m128i hole_fill_frames_8 = _mm_set1_epi16((short)hole_fill_frames);
+    const __m128i alpha_4 = _mm_set1_epi32((int)alpha);
+    const __m128i history_weight_4 = _mm_set1_epi32((int)(DEPTH_FILTER_ALPHA_ONE - alpha));
+    const __m128i round_4 = _mm_set1_epi32(DEPTH_FILTER_ALPHA_ONE / 2);
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i current = _mm_loadu_si128((const __m128i *)(depth + i));
+        __m128i previous = _mm_loadu_si128((const __m128i *)(history + i));
+        __m128i age = _mm_loadu_si128((const __m128i *)(hole_age + i));
+
+        __m128i current_valid = _mm_andnot_si128(_mm_cmpeq_epi16(current, zero), ones);
+        __m128i previous_valid = _mm_andnot_si128(_mm_cmpeq_epi16(previous, zero), ones);
+        __m128i diff = _mm_or_si128(_mm_subs_epu16(current, previous), _mm_subs_epu16(previous, current));
+        __m128i close = _mm_cmpeq_epi16(_mm_subs_epu16(diff, threshold_8), zero);
+
+        __m128i blend_low = _mm_add_epi32(_mm_mullo_epi32(_mm_unpacklo_epi16(previous, zero), history_weight_4),
+                                          _mm_mullo_epi32(_mm_unpacklo_epi16(current, zero), alpha_4));
+        __m128i blend_high = _mm_add_epi32(_mm_mullo_epi32(_mm_unpackhi_epi16(previous, zero), history_weight_4),
+                                           _mm_mullo_epi32(_mm_unpackhi_epi16(current, zero), alpha_4));
+        blend_low = _mm_srli_epi32(_mm_add_epi32(blend_low, round_4), 8);
+        blend_high = _mm_srli_epi32(_mm_add_epi32(blend_high, round_4), 8);
+        __m128i blend = _mm_blendv_epi8(current,
+                                        _mm_packus_epi32(blend_low, blend_high),
+                                        _mm_and_si128(previous_valid, close));
+
+        __m128i age_left = _mm_andnot_si128(_mm_cmpeq_epi16(_mm_subs_epu16(hole_fill_frames_8, age), zero), ones);
+        __m128i hold = _mm_andnot_si128(current_valid, _mm_and_si128(previous_valid, age_left));
+
+        __m128i result = _mm_or_si128(_mm_and_si128(current_valid, blend), _mm_and_si128(hold, previous));
+        _mm_storeu_si128((__m128i *)(history + i), result);
+        _mm_storeu_si128((__m128i *)(hole_age + i), _mm_and_si128(hold, _mm_sub_epi16(age, ones)));
+        _mm_storeu_si128((__m128i *)(depth + i), result);
+    }
+#endif
+    for (; i < count; i++)
+    {
+        uint16_t current = depth[i];
+        uint16_t previous = history[i];
+        if (current != 0)
+        {
+            if (previous != 0 && depth_filter_abs_diff(current, previous) <= threshold)
+            {
+                current = (uint16_t)((previous * (DEPTH_FILTER_ALPHA_ONE - alpha) + current * alpha +
+                                      DEPTH_FILTER_ALPHA_ONE / 2) >>
+                                     8);
+            }
+            hole_age[i] = 0;
+        }
+        else if (previous != 0 && hole_age[i] < hole_fill_frames)
+        {
+            current = previous;
+            hole_age[i]++;
+        }
+        else
+        {
+            hole_age[i] = 0;
+        }
+        history[i] = current;
+        depth[i] = current;
+    }
+}
+
+bool depth_filter_configuration_is_valid(const k4a_depth_filter_configuration_t *config)
+{
+    if (config->temporal_filter && !(config->temporal_alpha > 0.0f && config->temporal_alpha <= 1.0f))
+    {
+        LOG_ERROR("The temporal filter alpha must be greater than 0 and at most 1, not %f", config->temporal_alpha);
+        return false;
+    }
+    return true;
+}
+
+bool depth_filter_configuration_is_enabled(const k4a_depth_filter_configuration_t *config)
+{
+    return config->flying_pixel_filter || config->edge_preserving_filter || config->temporal_filter;
+}
+
+depth_filter_t *depth_filter_create(const k4a_depth_filter_configuration_t *config, uint32_t width, uint32_t height)
+{
+    RETURN_VALUE_IF_ARG(NULL, config == NULL);
+    RETURN_VALUE_IF_ARG(NULL, width == 0 || height == 0);
+    RETURN_VALUE_IF_ARG(NULL, !depth_filter_configuration_is_valid(config));
+
+    depth_filter_t *filter = (depth_filter_t *)calloc(1, sizeof(depth_filter_t));
+    if (filter == NULL)
+    {
+        return NULL;
+    }
+
+    size_t size = (size_t)width * height * sizeof(uint16_t);
+    filter->config = *config;
+    filter->width = width;
+    filter->height = height;
+
+    bool allocated = true;
+    if (config->flying_pixel_filter || config->edge_preserving_filter)
+    {
+        filter->scratch = (uint16_t *)malloc(size);
+        allocated = filter->scratch != NULL;
+    }
+    if (allocated && config->temporal_filter)
+    {
+        uint32_t alpha = (uint32_t)(config->temporal_alpha * DEPTH_FILTER_ALPHA_ONE + 0.5f);
+        filter->alpha = alpha < 1 ? 1 : (alpha > DEPTH_FILTER_ALPHA_ONE ? DEPTH_FILTER_ALPHA_ONE : alpha);
+        filter->history = (uint16_t *)calloc(1, size);
+        filter->hole_age = (uint16_t *)calloc(1, size);
+        allocated = filter->history != NULL && filter->hole_age != NULL;
+    }
+
+    if (!allocated)
+    {
+        LOG_ERROR("Failed to allocate the depth filter buffers for %u x %u images", width, height);
+        depth_filter_destroy(filter);
+        filter = NULL;
+    }
+    return filter;
+}
+
+void depth_filter_destroy(depth_filter_t *filter)
+{
+    if (filter != NULL)
+    {
+        free(filter->scratch);
+        free(filter->history);
+        free(filter->hole_age);
+        free(filter);
+    }
+}
+
+void depth_filter_reset(depth_filter_t *filter)
+{
+    RETURN_VALUE_IF_ARG(VOID_VALUE, filter == NULL);
+
+    if (filter->history != NULL)
+    {
+        size_t size = (size_t)filter->width * filter->height * sizeof(uint16_t);
+        memset(filter->history, 0, size);
+        memset(filter->hole_age, 0, size);
+    }
+}
+
+k4a_result_t depth_filter_process(depth_filter_t *filter, uint16_t *depth, uint32_t width, uint32_t height)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, filter == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, depth == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, width != filter->width || height != filter->height);
+
+    // The spatial filters read the neighbors of each pixel, so they alternate between the image and scratch
+    uint16_t *current = depth;
+    uint16_t *other = filter->scratch;
+    if (filter->config.flying_pixel_filter)
+    {
+        depth_filter_flying_pixels(filter, current, other);
+        other = current;
+        current = filter->scratch;
+    }
+    if (filter->config.edge_preserving_filter)
+    {
+        depth_filter_edge_preserving(filter, current, other);
+        uint16_t *filtered = other;
+        other = current;
+        current = filtered;
+    }
+    if (current != depth)
+    {
+        memcpy(depth, current, (size_t)width * height * sizeof(uint16_t));
+    }
+
+    if (filter->config.temporal_filter)
+    {
+        depth_filter_temporal(filter, depth);
+    }
+    return K4A_RESULT_SUCCEEDED;
+}
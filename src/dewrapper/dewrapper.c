@@ -8,18 +8,29 @@
 #include <k4ainternal/queue.h>
 #include <k4ainternal/calibration.h>
 #include <k4ainternal/deloader.h>
+#include <k4ainternal/depth_filter.h>
+#include <k4ainternal/threadpolicy.h>
+#include <k4ainternal/tracing.h>
+#include <k4ainternal/atomic.h>
+#include <k4ainternal/common.h>
 #include <azure_c_shared_utility/threadapi.h>
 #include <azure_c_shared_utility/condition.h>
 #include <azure_c_shared_utility/tickcounter.h>
 #include <azure_c_shared_utility/lock.h>
 #include <azure_c_shared_utility/refcount.h>
+#include <azure_c_shared_utility/envvariable.h>
 
 // System dependencies
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include <assert.h>
 
 #define DEWRAPPER_QUEUE_DEPTH ((uint32_t)2) // We should not need to store more than 1
+#define DEWRAPPER_OUTPUT_POOL_DEPTH ((uint32_t)4) // Output buffers recycled between frames held by the application
+#define DEWRAPPER_DEFAULT_FRAMES_IN_FLIGHT ((uint32_t)2) // Used when the plugin can overlap frames
+#define DEWRAPPER_MAX_GPUS 16 // GPUs statistics are kept for
+#define DEWRAPPER_COMPUTE_TIME_BUCKETS 256 // 1ms per bucket, the last one counts everything longer
 
 typedef struct _dewrapper_context_t
 {
@@ -35,15 +46,47 @@ typedef struct _dewrapper_context_t
     volatile bool thread_started;
     volatile bool thread_stop;
     k4a_result_t thread_start_result;
+    bool keep_alive;             // Park the thread with its depth engine in dewrapper_stop() instead of exiting
+    volatile bool thread_parked; // Stopped, waiting for the next dewrapper_start() with the depth engine alive
+    volatile bool thread_exit;   // Tells a parked thread to destroy its depth engine and exit
+    volatile bool thread_exited; // Thread finished without parking and can be joined
 
     k4a_fps_t fps;
     k4a_depth_mode_t depth_mode;
+    bool depth_image_only;                      // Captures get no IR image
+    bool raw_depth_payload;                     // Captures get the raw payload, the depth engine isn't started
+    k4a_depth_engine_output_type_t output_type; // What the depth engine writes to the output buffers
+    uint32_t delivery_divisor;                  // Frames kept of each group of incoming frames, 0 or 1 for all
+    volatile uint32_t delivery_count;           // Frames received since dewrapper_start()
 
     TICK_COUNTER_HANDLE tick;
     dewrapper_streaming_capture_cb_t *capture_ready_cb;
     void *capture_ready_cb_context;
 
     k4a_depth_engine_context_t *depth_engine;
+    uint32_t frames_in_flight;     // Frames handed to the depth engine at once, 1 processes them one at a time
+    int32_t gpu_setting;           // GPU index, K4A_DEPTH_ENGINE_GPU_DEFAULT or K4A_DEPTH_ENGINE_GPU_ROUND_ROBIN
+    int32_t gpu_index;             // GPU of the current or last depth engine, K4A_DEPTH_ENGINE_GPU_DEFAULT if unknown
+    allocator_pool_t *output_pool; // Recycles depth engine output buffers while streaming
+    size_t output_buffer_size;     // Size of the output_pool buffers
+    allocator_hook_t allocator;    // Allocator of the output buffers, no callbacks for the process allocator
+    size_t warm_up_frame_size;     // Raw frame size run through the depth engine at start, 0 for no warm up
+
+    k4a_depth_filter_configuration_t depth_filter_config; // Filters of the next dewrapper_start()
+    bool depth_filter_enabled;                            // depth_filter_config enables a filter
+    depth_filter_t *depth_filter;                         // Filters of the current stream, NULL when disabled
+
+    k4a_depth_mode_t engine_depth_mode; // Mode depth_engine was created for
+    bool engine_depth_image_only;       // depth_image_only depth_engine was created for
+    volatile bool engine_stale;         // depth_engine can't be reused by the next start
+
+    // Compute times of this device's frames since dewrapper_create(), see dewrapper_get_statistics()
+    volatile uint32_t compute_time_buckets[DEWRAPPER_COMPUTE_TIME_BUCKETS];
+    volatile uint64_t frame_count;
+    volatile uint64_t total_compute_time_ms;
+    volatile uint32_t min_compute_time_ms;
+    volatile uint32_t max_compute_time_ms;
+    volatile uint32_t overrun_count;
 
 } dewrapper_context_t;
 
@@ -51,11 +94,76 @@ typedef struct _shared_image_context_t
 {
     // Overall shared buffer
     uint8_t *buffer;
+    allocator_pool_t *pool; // Pool the buffer is returned to
     volatile long ref;
 } shared_image_context_t;
 
+// A raw frame from the time it is handed to the depth engine until its images are published
+typedef struct _dewrapper_frame_t
+{
+    k4a_capture_t capture_raw;
+    k4a_image_t image_raw;
+    uint8_t *output; // Output buffer for the depth and IR images, NULL once owned by the images
+    tickcounter_ms_t start_time;
+} dewrapper_frame_t;
+
+typedef struct _dewrapper_gpu_statistics_t
+{
+    volatile uint32_t depth_engine_count;
+    volatile uint32_t frames_in_flight;
+    volatile uint64_t frames_processed;
+    volatile uint64_t total_compute_time_ms;
+    volatile uint32_t max_compute_time_ms;
+} dewrapper_gpu_statistics_t;
+
+// Shared by every device. Entry 0 is for depth engines on the GPU the plugin chose, entry i + 1 for GPU i.
+static dewrapper_gpu_statistics_t g_gpu_statistics[DEWRAPPER_MAX_GPUS + 1];
+static volatile uint32_t g_gpu_round_robin_next;
+
 K4A_DECLARE_CONTEXT(dewrapper_t, dewrapper_context_t);
 
+static dewrapper_gpu_statistics_t *dewrapper_gpu_statistics(dewrapper_context_t *dewrapper)
+{
+    assert(dewrapper->gpu_index >= K4A_DEPTH_ENGINE_GPU_DEFAULT && dewrapper->gpu_index < DEWRAPPER_MAX_GPUS);
+    return &g_gpu_statistics[dewrapper->gpu_index + 1];
+}
+
+static void dewrapper_atomic_max(volatile uint32_t *max, uint32_t value)
+{
+    uint32_t current = k4a_atomic_load(max);
+    while (value > current && !k4a_atomic_cas(max, current, value))
+    {
+        current = k4a_atomic_load(max);
+    }
+}
+
+// Resolves dewrapper->gpu_setting to the GPU the next depth engine is created on
+static int32_t dewrapper_select_gpu(dewrapper_context_t *dewrapper)
+{
+    if (dewrapper->gpu_setting != K4A_DEPTH_ENGINE_GPU_ROUND_ROBIN)
+    {
+        return dewrapper->gpu_setting;
+    }
+
+    uint32_t gpu_count = deloader_depth_engine_get_gpu_count();
+    if (gpu_count == 0)
+    {
+        LOG_WARNING("The depth engine can not select a GPU, using the GPU it chooses", 0);
+        return K4A_DEPTH_ENGINE_GPU_DEFAULT;
+    }
+    if (gpu_count > DEWRAPPER_MAX_GPUS)
+    {
+        gpu_count = DEWRAPPER_MAX_GPUS;
+    }
+
+    uint32_t next = k4a_atomic_load(&g_gpu_round_robin_next);
+    while (!k4a_atomic_cas(&g_gpu_round_robin_next, next, next + 1))
+    {
+        next = k4a_atomic_load(&g_gpu_round_robin_next);
+    }
+    return (int32_t)(next % gpu_count);
+}
+
 static k4a_depth_engine_mode_t get_de_mode_from_depth_mode(k4a_depth_mode_t mode)
 {
     k4a_depth_engine_mode_t de_mode;
@@ -116,11 +224,28 @@ static void free_shared_depth_image(void *buffer, void *context)
 
     if (count == 0)
     {
-        allocator_free(shared_context->buffer);
+        allocator_pool_free(shared_context->buffer, shared_context->pool);
         free(context);
     }
 }
 
+static void depth_engine_stop_helper(dewrapper_context_t *dewrapper)
+{
+    if (dewrapper->depth_engine != NULL)
+    {
+        deloader_depth_engine_destroy(&dewrapper->depth_engine);
+        dewrapper->depth_engine = NULL;
+        k4a_atomic_add(&dewrapper_gpu_statistics(dewrapper)->depth_engine_count, -1);
+    }
+
+    if (dewrapper->output_pool != NULL)
+    {
+        // Buffers still referenced by images are freed when the images are released
+        allocator_pool_close(dewrapper->output_pool);
+        dewrapper->output_pool = NULL;
+    }
+}
+
 static k4a_result_t depth_engine_start_helper(dewrapper_context_t *dewrapper,
                                               k4a_fps_t fps,
                                               k4a_depth_mode_t depth_mode,
@@ -130,26 +255,64 @@ static k4a_result_t depth_engine_start_helper(dewrapper_context_t *dewrapper,
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, fps < K4A_FRAMES_PER_SECOND_5 || fps > K4A_FRAMES_PER_SECOND_30);
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, depth_mode <= K4A_DEPTH_MODE_OFF || depth_mode > K4A_DEPTH_MODE_PASSIVE_IR);
     k4a_result_t result = K4A_RESULT_SUCCEEDED;
+    bool reuse = false;
 
-    assert(dewrapper->depth_engine == NULL);
     assert(dewrapper->calibration_memory != NULL);
 
     // Max comput time is the configured FPS
     *depth_engine_max_compute_time_ms = HZ_TO_PERIOD_MS(k4a_convert_fps_to_uint(fps));
     result = K4A_RESULT_FROM_BOOL(*depth_engine_max_compute_time_ms != 0);
 
-    if (K4A_SUCCEEDED(result))
+    if (K4A_SUCCEEDED(result) && dewrapper->depth_engine != NULL)
     {
-        k4a_depth_engine_result_code_t deresult =
-            deloader_depth_engine_create_and_initialize(&dewrapper->depth_engine,
-                                                        dewrapper->calibration_memory_size,
-                                                        dewrapper->calibration_memory,
-                                                        get_de_mode_from_depth_mode(depth_mode),
-                                                        get_input_format_from_depth_mode(depth_mode),
-                                                        dewrapper->calibration, // k4a_calibration_camera_t*
-                                                        NULL,                   // Callback
-                                                        NULL);                  // Callback Context
-        if (deresult != K4A_DEPTH_ENGINE_RESULT_SUCCEEDED)
+        // Left alive by the last stop, creating a new one compiles shaders and uploads the calibration again
+        reuse = dewrapper->engine_depth_mode == depth_mode &&
+                dewrapper->engine_depth_image_only == dewrapper->depth_image_only && !dewrapper->engine_stale;
+        if (reuse)
+        {
+            LOG_INFO("Reusing the depth engine from the last start", 0);
+        }
+        else
+        {
+            depth_engine_stop_helper(dewrapper);
+        }
+    }
+
+    if (K4A_SUCCEEDED(result) && !reuse)
+    {
+        k4a_depth_engine_result_code_t deresult;
+        int32_t gpu_index = dewrapper_select_gpu(dewrapper);
+        if (gpu_index == K4A_DEPTH_ENGINE_GPU_DEFAULT)
+        {
+            deresult = deloader_depth_engine_create_and_initialize(&dewrapper->depth_engine,
+                                                                   dewrapper->calibration_memory_size,
+                                                                   dewrapper->calibration_memory,
+                                                                   get_de_mode_from_depth_mode(depth_mode),
+                                                                   get_input_format_from_depth_mode(depth_mode),
+                                                                   dewrapper->calibration, // k4a_calibration_camera_t*
+                                                                   NULL,                   // Callback
+                                                                   NULL);                  // Callback Context
+        }
+        else
+        {
+            LOG_INFO("Starting the depth engine on GPU %d", gpu_index);
+            deresult = deloader_depth_engine_create_and_initialize_on_gpu(&dewrapper->depth_engine,
+                                                                          dewrapper->calibration_memory_size,
+                                                                          dewrapper->calibration_memory,
+                                                                          get_de_mode_from_depth_mode(depth_mode),
+                                                                          get_input_format_from_depth_mode(depth_mode),
+                                                                          dewrapper->calibration,
+                                                                          NULL,
+                                                                          NULL,
+                                                                          (uint32_t)gpu_index);
+        }
+
+        if (deresult == K4A_DEPTH_ENGINE_RESULT_SUCCEEDED)
+        {
+            dewrapper->gpu_index = gpu_index;
+            k4a_atomic_add(&dewrapper_gpu_statistics(dewrapper)->depth_engine_count, 1);
+        }
+        else
         {
             LOG_ERROR("Depth engine create and initialize failed with error code: %d.", deresult);
             if (deresult == K4A_DEPTH_ENGINE_RESULT_FATAL_ERROR_GPU_OPENGL_CONTEXT)
@@ -160,39 +323,380 @@ static k4a_result_t depth_engine_start_helper(dewrapper_context_t *dewrapper,
         result = K4A_RESULT_FROM_BOOL(deresult == K4A_DEPTH_ENGINE_RESULT_SUCCEEDED);
     }
 
-    if (K4A_SUCCEEDED(result))
+    if (K4A_SUCCEEDED(result) && !reuse)
     {
-        *depth_engine_output_buffer_size = deloader_depth_engine_get_output_frame_size(dewrapper->depth_engine);
+        dewrapper->output_type = K4A_DEPTH_ENGINE_OUTPUT_TYPE_Z_DEPTH;
+        *depth_engine_output_buffer_size = 0;
+        if (dewrapper->depth_image_only)
+        {
+            // Output buffers only need room for the depth image when the depth engine can leave the IR image out
+            *depth_engine_output_buffer_size =
+                deloader_depth_engine_get_output_frame_size_for_type(dewrapper->depth_engine,
+                                                                     K4A_DEPTH_ENGINE_OUTPUT_TYPE_Z_DEPTH_ONLY);
+            if (*depth_engine_output_buffer_size != 0)
+            {
+                dewrapper->output_type = K4A_DEPTH_ENGINE_OUTPUT_TYPE_Z_DEPTH_ONLY;
+            }
+            else
+            {
+                LOG_INFO("Depth engine can't skip the IR image, it is computed but not returned", 0);
+            }
+        }
+
+        if (*depth_engine_output_buffer_size == 0)
+        {
+            *depth_engine_output_buffer_size = deloader_depth_engine_get_output_frame_size(dewrapper->depth_engine);
+        }
         result = K4A_RESULT_FROM_BOOL(0 != *depth_engine_output_buffer_size);
     }
 
+    if (K4A_SUCCEEDED(result) && !reuse)
+    {
+        // The depth engine writes into recycled buffers so steady state streaming does not allocate per frame
+        uint32_t pool_depth = DEWRAPPER_OUTPUT_POOL_DEPTH;
+        if (deloader_depth_engine_supports_submit())
+        {
+            pool_depth += dewrapper->frames_in_flight - 1;
+        }
+
+        assert(dewrapper->output_pool == NULL);
+        dewrapper->output_pool = allocator_pool_create(&dewrapper->allocator,
+                                                       ALLOCATION_SOURCE_DEPTH,
+                                                       *depth_engine_output_buffer_size,
+                                                       pool_depth);
+        result = K4A_RESULT_FROM_BOOL(dewrapper->output_pool != NULL);
+    }
+
+    if (K4A_SUCCEEDED(result) && !reuse)
+    {
+        dewrapper->output_buffer_size = *depth_engine_output_buffer_size;
+        dewrapper->engine_depth_mode = depth_mode;
+        dewrapper->engine_depth_image_only = dewrapper->depth_image_only;
+        dewrapper->engine_stale = false;
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        *depth_engine_output_buffer_size = dewrapper->output_buffer_size;
+    }
+
     return result;
 }
 
-static void depth_engine_stop_helper(dewrapper_context_t *dewrapper)
+// Takes over the reference to capture_raw and gets the buffers the depth engine reads from and writes to
+// Frame id of a raw capture for tracing, the system timestamp the USB transfer gave its image
+static uint64_t dewrapper_trace_frame(k4a_capture_t capture_raw)
 {
-    if (dewrapper->depth_engine != NULL)
+    uint64_t frame = 0;
+    k4a_image_t image_raw = capture_get_ir_image(capture_raw);
+    if (image_raw)
     {
-        deloader_depth_engine_destroy(&dewrapper->depth_engine);
-        dewrapper->depth_engine = NULL;
+        frame = image_get_system_timestamp_nsec(image_raw);
+        image_dec_ref(image_raw);
     }
+    return frame;
 }
 
-static int depth_engine_thread(void *param)
+static k4a_result_t depth_engine_frame_prepare(dewrapper_context_t *dewrapper,
+                                               k4a_capture_t capture_raw,
+                                               dewrapper_frame_t *frame)
 {
-    dewrapper_context_t *dewrapper = (dewrapper_context_t *)param;
+    memset(frame, 0, sizeof(*frame));
+    frame->capture_raw = capture_raw;
+    k4a_atomic_add(&dewrapper_gpu_statistics(dewrapper)->frames_in_flight, 1);
+
+    frame->image_raw = capture_get_ir_image(capture_raw);
+    k4a_result_t result = K4A_RESULT_FROM_BOOL(frame->image_raw != NULL);
+
+    if (K4A_SUCCEEDED(result))
+    {
+        // Get 1 buffer for depth engine to write depth and IR images to. The raw input is read in place from the USB
+        // transfer buffer.
+        frame->output = allocator_pool_alloc(dewrapper->output_pool, NULL);
+        if (frame->output == NULL)
+        {
+            LOG_ERROR("Depth streaming callback failed to allocate output buffer", 0);
+            result = K4A_RESULT_FAILED;
+        }
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        tickcounter_get_current_ms(dewrapper->tick, &frame->start_time);
+    }
+    return result;
+}
+
+static void depth_engine_frame_release(dewrapper_context_t *dewrapper, dewrapper_frame_t *frame)
+{
+    if (frame->output)
+    {
+        allocator_pool_free(frame->output, dewrapper->output_pool);
+    }
+    if (frame->image_raw)
+    {
+        image_dec_ref(frame->image_raw);
+    }
+    if (frame->capture_raw)
+    {
+        capture_dec_ref(frame->capture_raw);
+    }
+    memset(frame, 0, sizeof(*frame));
+    k4a_atomic_add(&dewrapper_gpu_statistics(dewrapper)->frames_in_flight, -1);
+}
+
+/** Publishes the depth and IR images of a frame the depth engine finished with deresult, and releases the frame.
+ *
+ * Returns K4A_RESULT_FAILED if streaming can't continue, a dropped frame is not a failure.
+ */
+static k4a_result_t depth_engine_frame_finish(dewrapper_context_t *dewrapper,
+                                              dewrapper_frame_t *frame,
+                                              k4a_depth_engine_result_code_t deresult,
+                                              const k4a_depth_engine_output_frame_info_t *outputCaptureInfo,
+                                              int depth_engine_max_compute_time_ms,
+                                              bool *received_valid_image)
+{
+    k4a_result_t result = K4A_RESULT_SUCCEEDED;
+    k4a_capture_t capture = NULL;
+    shared_image_context_t *shared_image_context = NULL;
+    uint8_t *capture_byte_ptr = frame->output;
+    bool dropped = false;
+    tickcounter_ms_t stop_time = 0;
+
+    tickcounter_get_current_ms(dewrapper->tick, &stop_time);
+    if (deresult == K4A_DEPTH_ENGINE_RESULT_FATAL_ERROR_WAIT_PROCESSING_COMPLETE_FAILED ||
+        deresult == K4A_DEPTH_ENGINE_RESULT_FATAL_ERROR_GPU_TIMEOUT)
+    {
+        LOG_ERROR("Timeout during depth engine process frame.", 0);
+        LOG_ERROR("SDK should be restarted since it looks like GPU has encountered an unrecoverable error.", 0);
+        dewrapper->engine_stale = true;
+        dropped = true;
+        result = K4A_RESULT_FAILED;
+    }
+    else if (deresult != K4A_DEPTH_ENGINE_RESULT_SUCCEEDED)
+    {
+        LOG_ERROR("Depth engine process frame failed with error code: %d.", deresult);
+        dewrapper->engine_stale = true;
+        result = K4A_RESULT_FAILED;
+    }
+    else
+    {
+        uint32_t compute_time_ms = (uint32_t)(stop_time - frame->start_time);
+        dewrapper_gpu_statistics_t *statistics = dewrapper_gpu_statistics(dewrapper);
+        k4a_atomic_add64(&statistics->frames_processed, 1);
+        k4a_atomic_add64(&statistics->total_compute_time_ms, compute_time_ms);
+        dewrapper_atomic_max(&statistics->max_compute_time_ms, compute_time_ms);
+
+        // Only this thread updates the device's statistics, the atomics keep dewrapper_get_statistics() readers exact
+        k4a_atomic_add(&dewrapper->compute_time_buckets[compute_time_ms < DEWRAPPER_COMPUTE_TIME_BUCKETS
+                                                            ? compute_time_ms
+                                                            : DEWRAPPER_COMPUTE_TIME_BUCKETS - 1],
+                       1);
+        k4a_atomic_add64(&dewrapper->frame_count, 1);
+        k4a_atomic_add64(&dewrapper->total_compute_time_ms, compute_time_ms);
+        dewrapper_atomic_max(&dewrapper->max_compute_time_ms, compute_time_ms);
+        if (compute_time_ms < k4a_atomic_load(&dewrapper->min_compute_time_ms))
+        {
+            k4a_atomic_store(&dewrapper->min_compute_time_ms, compute_time_ms);
+        }
+
+        if (compute_time_ms > (unsigned)depth_engine_max_compute_time_ms)
+        {
+            k4a_atomic_add(&dewrapper->overrun_count, 1);
+            LOG_WARNING("Depth image processing is too slow at %lldms (this may be transient).",
+                        stop_time - frame->start_time);
+        }
+    }
+
+    if (K4A_SUCCEEDED(result) && *received_valid_image && outputCaptureInfo->center_of_exposure_in_ticks == 0)
+    {
+        // We drop samples with a timestamp of zero when starting up.
+        LOG_WARNING("Dropping depth image due to bad timestamp at startup", 0);
+        dropped = true;
+        result = K4A_RESULT_FAILED;
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        shared_image_context = (shared_image_context_t *)malloc(sizeof(shared_image_context_t));
+        result = K4A_RESULT_FROM_BOOL(shared_image_context != NULL);
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        shared_image_context->ref = 0;
+        shared_image_context->buffer = capture_byte_ptr;
+        shared_image_context->pool = dewrapper->output_pool;
+
+        result = TRACE_CALL(capture_create(&capture));
+    }
+
+    bool depth16_present = (dewrapper->depth_mode == K4A_DEPTH_MODE_NFOV_2X2BINNED ||
+                            dewrapper->depth_mode == K4A_DEPTH_MODE_NFOV_UNBINNED ||
+                            dewrapper->depth_mode == K4A_DEPTH_MODE_WFOV_2X2BINNED ||
+                            dewrapper->depth_mode == K4A_DEPTH_MODE_WFOV_UNBINNED);
+
+    if (K4A_SUCCEEDED(result) && depth16_present && dewrapper->depth_filter != NULL)
+    {
+        // A failure leaves the image unfiltered, it is still published
+        (void)TRACE_CALL(depth_filter_process(dewrapper->depth_filter,
+                                              (uint16_t *)capture_byte_ptr,
+                                              outputCaptureInfo->output_width,
+                                              outputCaptureInfo->output_height));
+    }
+
+    if (K4A_SUCCEEDED(result) & depth16_present)
+    {
+        k4a_image_t image;
+        int stride_bytes = (int)outputCaptureInfo->output_width * (int)sizeof(uint16_t);
+        result = TRACE_CALL(image_create_from_buffer(K4A_IMAGE_FORMAT_DEPTH16,
+                                                     outputCaptureInfo->output_width,
+                                                     outputCaptureInfo->output_height,
+                                                     stride_bytes,
+                                                     capture_byte_ptr,
+                                                     (size_t)stride_bytes * (size_t)outputCaptureInfo->output_height,
+                                                     free_shared_depth_image,
+                                                     shared_image_context,
+                                                     &image));
+        if (K4A_SUCCEEDED(result))
+        {
+            frame->output = NULL; // buffer is now owned by image;
+            INC_REF_VAR(shared_image_context->ref);
+            image_set_device_timestamp_usec(image,
+                                            K4A_90K_HZ_TICK_TO_USEC(outputCaptureInfo->center_of_exposure_in_ticks));
+            image_set_system_timestamp_nsec(image, image_get_system_timestamp_nsec(frame->image_raw));
+            capture_set_depth_image(capture, image);
+            image_dec_ref(image);
+        }
+    }
 
+    if (K4A_SUCCEEDED(result) && !dewrapper->depth_image_only)
+    {
+        k4a_image_t image;
+        int stride_bytes = (int)outputCaptureInfo->output_width * (int)sizeof(uint16_t);
+        uint8_t *image_buf = capture_byte_ptr;
+        if (depth16_present)
+        {
+            image_buf = image_buf + stride_bytes * outputCaptureInfo->output_height;
+        }
+
+        // Every depth mode width keeps the stride, and so the IR image following the depth image, aligned to
+        // K4A_IMAGE_BUFFER_ALIGNMENT within the output pool buffer
+        assert(stride_bytes % K4A_IMAGE_BUFFER_ALIGNMENT == 0);
+        assert(((uintptr_t)image_buf % K4A_IMAGE_BUFFER_ALIGNMENT) == 0);
+
+        result = TRACE_CALL(image_create_from_buffer(K4A_IMAGE_FORMAT_IR16,
+                                                     outputCaptureInfo->output_width,
+                                                     outputCaptureInfo->output_height,
+                                                     stride_bytes,
+                                                     image_buf,
+                                                     (size_t)stride_bytes * (size_t)outputCaptureInfo->output_height,
+                                                     free_shared_depth_image,
+                                                     shared_image_context,
+                                                     &image));
+        if (K4A_SUCCEEDED(result))
+        {
+            frame->output = NULL; // buffer is now owned by image;
+            INC_REF_VAR(shared_image_context->ref);
+            image_set_device_timestamp_usec(image,
+                                            K4A_90K_HZ_TICK_TO_USEC(outputCaptureInfo->center_of_exposure_in_ticks));
+            image_set_system_timestamp_nsec(image, image_get_system_timestamp_nsec(frame->image_raw));
+            capture_set_ir_image(capture, image);
+            image_dec_ref(image);
+        }
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        // set capture attributes
+        capture_set_temperature_c(capture, outputCaptureInfo->sensor_temp);
+        capture_set_stage_timestamp(capture, K4A_IMAGE_STAGE_DEPTH_ENGINE_DONE);
+
+        *received_valid_image = true;
+        dewrapper->capture_ready_cb(result, capture, dewrapper->capture_ready_cb_context);
+    }
+
+    if (shared_image_context && shared_image_context->ref == 0)
+    {
+        // It didn't get used due to a failure
+        free(shared_image_context);
+    }
+
+    if (capture)
+    {
+        capture_dec_ref(capture);
+    }
+
+    depth_engine_frame_release(dewrapper, frame);
+
+    if (dropped)
+    {
+        // It is not a fatal error when we drop a frame, so we reset 'result' so that we can continue to run.
+        result = K4A_RESULT_SUCCEEDED;
+    }
+    return result;
+}
+
+// Touches the output buffers and runs a zeroed raw frame through the depth engine, so the first frames of the stream
+// don't pay for page faults or for the depth engine setting up on first use. The result of the frame is ignored.
+static void depth_engine_warm_up(dewrapper_context_t *dewrapper, size_t depth_engine_output_buffer_size)
+{
+    allocator_pool_prefault(dewrapper->output_pool);
+
+    uint8_t *input = (uint8_t *)calloc(1, dewrapper->warm_up_frame_size);
+    uint8_t *output = allocator_pool_alloc(dewrapper->output_pool, NULL);
+    if (input != NULL && output != NULL)
+    {
+        k4a_depth_engine_output_frame_info_t output_info = { 0 };
+        TRACE_SPAN_BEGIN("depth engine warm up", 0);
+        k4a_depth_engine_result_code_t deresult = deloader_depth_engine_process_frame(dewrapper->depth_engine,
+                                                                                      input,
+                                                                                      dewrapper->warm_up_frame_size,
+                                                                                      dewrapper->output_type,
+                                                                                      output,
+                                                                                      depth_engine_output_buffer_size,
+                                                                                      &output_info,
+                                                                                      NULL);
+        TRACE_SPAN_END("depth engine warm up", 0);
+        LOG_INFO("Depth engine warm up frame completed with result %d", deresult);
+    }
+    else
+    {
+        LOG_WARNING("Failed to allocate the depth engine warm up frame", 0);
+    }
+
+    free(input);
+    if (output != NULL)
+    {
+        allocator_pool_free(output, dewrapper->output_pool);
+    }
+}
+
+// Streams from dewrapper_start() until dewrapper_stop(), leaving the depth engine for the next start
+static k4a_result_t depth_engine_stream(dewrapper_context_t *dewrapper)
+{
     k4a_result_t result = K4A_RESULT_SUCCEEDED;
     size_t depth_engine_output_buffer_size;
     int depth_engine_max_compute_time_ms;
     bool received_valid_image = false;
 
+    // Frames submitted to the depth engine and not completed yet, oldest at frames[first]
+    dewrapper_frame_t frames[K4A_PLUGIN_MAX_FRAMES_IN_FLIGHT] = { 0 };
+    uint32_t first = 0;
+    uint32_t in_flight = 0;
+
     result = TRACE_CALL(depth_engine_start_helper(dewrapper,
                                                   dewrapper->fps,
                                                   dewrapper->depth_mode,
                                                   &depth_engine_max_compute_time_ms,
                                                   &depth_engine_output_buffer_size));
 
+    if (K4A_SUCCEEDED(result) && dewrapper->warm_up_frame_size != 0)
+    {
+        // Done before dewrapper_start() returns, so the stream starts with the depth engine at steady state
+        depth_engine_warm_up(dewrapper, depth_engine_output_buffer_size);
+    }
+
     // The Start routine is blocked waiting for this thread to complete startup, so we signal it here and share our
     // startup status.
     Lock(dewrapper->lock);
@@ -203,215 +707,209 @@ static int depth_engine_thread(void *param)
 
     // NOTE: Failures after this point are reported to the user via the k4a_device_get_capture()
 
-    while (result != K4A_RESULT_FAILED && dewrapper->thread_stop == false)
+    uint32_t frames_in_flight = dewrapper->frames_in_flight;
+    if (K4A_SUCCEEDED(result) && frames_in_flight > 1)
     {
-        k4a_capture_t capture = NULL;
-        k4a_capture_t capture_raw = NULL;
-        k4a_image_t image_raw = NULL;
-        k4a_depth_engine_output_frame_info_t outputCaptureInfo = { 0 };
-        uint8_t *capture_byte_ptr = NULL;
-        bool cleanup_capture_byte_ptr = true;
-        shared_image_context_t *shared_image_context = NULL;
-        uint8_t *raw_image_buffer = NULL;
-        size_t raw_image_buffer_size = 0;
-        bool dropped = false;
-
-        k4a_wait_result_t wresult = queue_pop(dewrapper->queue, K4A_WAIT_INFINITE, &capture_raw);
-        if (wresult != K4A_WAIT_RESULT_SUCCEEDED)
+        if (deloader_depth_engine_supports_submit())
         {
-            result = K4A_RESULT_FAILED;
-        }
+            LOG_INFO("Depth engine processing up to %d frames at a time", frames_in_flight);
 
-        if (K4A_SUCCEEDED(result))
-        {
-            image_raw = capture_get_ir_image(capture_raw);
-            result = K4A_RESULT_FROM_BOOL(image_raw != NULL);
+            // A frame queued behind others in the depth engine is not late until its predecessors have had their time
+            depth_engine_max_compute_time_ms *= (int)frames_in_flight;
         }
-
-        if (K4A_SUCCEEDED(result))
+        else
         {
-            raw_image_buffer = image_get_buffer(image_raw);
-            raw_image_buffer_size = image_get_size(image_raw);
-
-            // Allocate 1 buffer for depth engine to write depth and IR images to
-            assert(depth_engine_output_buffer_size != 0);
-            capture_byte_ptr = allocator_alloc(ALLOCATION_SOURCE_DEPTH, depth_engine_output_buffer_size);
-            if (capture_byte_ptr == NULL)
-            {
-                LOG_ERROR("Depth streaming callback failed to allocate output buffer", 0);
-                result = K4A_RESULT_FAILED;
-            }
+            frames_in_flight = 1;
         }
+    }
 
-        if (K4A_SUCCEEDED(result))
+    while (result != K4A_RESULT_FAILED && dewrapper->thread_stop == false)
+    {
+        k4a_depth_engine_output_frame_info_t outputCaptureInfo = { 0 };
+        k4a_depth_engine_result_code_t deresult;
+
+        if (in_flight < frames_in_flight)
         {
-            tickcounter_ms_t start_time = 0;
-            tickcounter_ms_t stop_time = 0;
-
-            tickcounter_get_current_ms(dewrapper->tick, &start_time);
-            k4a_depth_engine_result_code_t deresult =
-                deloader_depth_engine_process_frame(dewrapper->depth_engine,
-                                                    raw_image_buffer,
-                                                    raw_image_buffer_size,
-                                                    K4A_DEPTH_ENGINE_OUTPUT_TYPE_Z_DEPTH,
-                                                    capture_byte_ptr,
-                                                    depth_engine_output_buffer_size,
-                                                    &outputCaptureInfo,
-                                                    NULL);
-            tickcounter_get_current_ms(dewrapper->tick, &stop_time);
-            if (deresult == K4A_DEPTH_ENGINE_RESULT_FATAL_ERROR_WAIT_PROCESSING_COMPLETE_FAILED ||
-                deresult == K4A_DEPTH_ENGINE_RESULT_FATAL_ERROR_GPU_TIMEOUT)
-            {
-                LOG_ERROR("Timeout during depth engine process frame.", 0);
-                LOG_ERROR("SDK should be restarted since it looks like GPU has encountered an unrecoverable error.", 0);
-                dropped = true;
-                result = K4A_RESULT_FAILED;
-            }
-            else if (deresult != K4A_DEPTH_ENGINE_RESULT_SUCCEEDED)
+            // Only block waiting for a raw frame when the depth engine has nothing to work on. Otherwise a frame that
+            // is already queued is submitted behind the ones in flight, so frames overlap once processing falls behind.
+            k4a_capture_t capture_raw = NULL;
+            k4a_wait_result_t wresult =
+                queue_pop(dewrapper->queue, in_flight == 0 ? K4A_WAIT_INFINITE : 0, &capture_raw);
+            if (wresult == K4A_WAIT_RESULT_FAILED)
             {
-                LOG_ERROR("Depth engine process frame failed with error code: %d.", deresult);
                 result = K4A_RESULT_FAILED;
+                break;
             }
-            else if ((stop_time - start_time) > (unsigned)depth_engine_max_compute_time_ms)
+
+            if (wresult == K4A_WAIT_RESULT_SUCCEEDED)
             {
-                LOG_WARNING("Depth image processing is too slow at %lldms (this may be transient).",
-                            stop_time - start_time);
+                dewrapper_frame_t *frame = &frames[(first + in_flight) % K4A_PLUGIN_MAX_FRAMES_IN_FLIGHT];
+                result = depth_engine_frame_prepare(dewrapper, capture_raw, frame);
+                uint64_t trace_frame = frame->image_raw ? image_get_system_timestamp_nsec(frame->image_raw) : 0;
+                TRACE_INSTANT("depth engine queue pop", trace_frame);
+                if (K4A_FAILED(result))
+                {
+                    depth_engine_frame_release(dewrapper, frame);
+                }
+                else if (frames_in_flight == 1)
+                {
+                    TRACE_SPAN_BEGIN("depth engine compute", trace_frame);
+                    deresult = deloader_depth_engine_process_frame(dewrapper->depth_engine,
+                                                                   image_get_buffer(frame->image_raw),
+                                                                   image_get_size(frame->image_raw),
+                                                                   dewrapper->output_type,
+                                                                   frame->output,
+                                                                   depth_engine_output_buffer_size,
+                                                                   &outputCaptureInfo,
+                                                                   NULL);
+                    TRACE_SPAN_END("depth engine compute", trace_frame);
+                    result = depth_engine_frame_finish(dewrapper,
+                                                       frame,
+                                                       deresult,
+                                                       &outputCaptureInfo,
+                                                       depth_engine_max_compute_time_ms,
+                                                       &received_valid_image);
+                }
+                else
+                {
+                    deresult = deloader_depth_engine_submit_frame(dewrapper->depth_engine,
+                                                                  image_get_buffer(frame->image_raw),
+                                                                  image_get_size(frame->image_raw),
+                                                                  dewrapper->output_type,
+                                                                  frame->output,
+                                                                  depth_engine_output_buffer_size,
+                                                                  frame);
+                    if (deresult == K4A_DEPTH_ENGINE_RESULT_SUCCEEDED)
+                    {
+                        // Frames in flight overlap, so they are traced as instants rather than nested spans
+                        TRACE_INSTANT("depth engine submit", trace_frame);
+                        in_flight++;
+                    }
+                    else
+                    {
+                        // Classifies the error the same way a synchronous failure would be
+                        result = depth_engine_frame_finish(dewrapper,
+                                                           frame,
+                                                           deresult,
+                                                           &outputCaptureInfo,
+                                                           depth_engine_max_compute_time_ms,
+                                                           &received_valid_image);
+                    }
+                }
+                continue;
             }
         }
 
-        if (K4A_SUCCEEDED(result) && received_valid_image && outputCaptureInfo.center_of_exposure_in_ticks == 0)
+        // Either the depth engine is full or there is no new raw frame yet, so wait for the oldest frame
+        void *frame_context = NULL;
+        deresult = deloader_depth_engine_complete_frame(dewrapper->depth_engine, &frame_context, &outputCaptureInfo);
+        dewrapper_frame_t *frame = &frames[first];
+        first = (first + 1) % K4A_PLUGIN_MAX_FRAMES_IN_FLIGHT;
+        in_flight--;
+
+        if (frame_context != frame)
         {
-            // We drop samples with a timestamp of zero when starting up.
-            LOG_WARNING("Dropping depth image due to bad timestamp at startup", 0);
-            dropped = true;
+            LOG_ERROR("Depth engine completed frames out of order", 0);
+            depth_engine_frame_release(dewrapper, frame);
             result = K4A_RESULT_FAILED;
         }
-
-        if (K4A_SUCCEEDED(result))
+        else
         {
-            shared_image_context = (shared_image_context_t *)malloc(sizeof(shared_image_context_t));
-            result = K4A_RESULT_FROM_BOOL(shared_image_context != NULL);
+            TRACE_INSTANT("depth engine complete",
+                          frame->image_raw ? image_get_system_timestamp_nsec(frame->image_raw) : 0);
+            result = depth_engine_frame_finish(dewrapper,
+                                               frame,
+                                               deresult,
+                                               &outputCaptureInfo,
+                                               depth_engine_max_compute_time_ms,
+                                               &received_valid_image);
         }
+    }
 
-        if (K4A_SUCCEEDED(result))
-        {
-            shared_image_context->ref = 0;
-            shared_image_context->buffer = capture_byte_ptr;
-
-            result = TRACE_CALL(capture_create(&capture));
-        }
+    // The depth engine may still be reading and writing frames in flight, wait for them before releasing their buffers
+    while (in_flight != 0)
+    {
+        void *frame_context = NULL;
+        k4a_depth_engine_output_frame_info_t outputCaptureInfo = { 0 };
+        (void)deloader_depth_engine_complete_frame(dewrapper->depth_engine, &frame_context, &outputCaptureInfo);
+        depth_engine_frame_release(dewrapper, &frames[first]);
+        first = (first + 1) % K4A_PLUGIN_MAX_FRAMES_IN_FLIGHT;
+        in_flight--;
+    }
 
-        bool depth16_present = (dewrapper->depth_mode == K4A_DEPTH_MODE_NFOV_2X2BINNED ||
-                                dewrapper->depth_mode == K4A_DEPTH_MODE_NFOV_UNBINNED ||
-                                dewrapper->depth_mode == K4A_DEPTH_MODE_WFOV_2X2BINNED ||
-                                dewrapper->depth_mode == K4A_DEPTH_MODE_WFOV_UNBINNED);
+    if (K4A_FAILED(result))
+    {
+        dewrapper->capture_ready_cb(result, NULL, dewrapper->capture_ready_cb_context);
+    }
 
-        if (K4A_SUCCEEDED(result) & depth16_present)
-        {
-            k4a_image_t image;
-            int stride_bytes = (int)outputCaptureInfo.output_width * (int)sizeof(uint16_t);
-            result = TRACE_CALL(image_create_from_buffer(K4A_IMAGE_FORMAT_DEPTH16,
-                                                         outputCaptureInfo.output_width,
-                                                         outputCaptureInfo.output_height,
-                                                         stride_bytes,
-                                                         capture_byte_ptr,
-                                                         (size_t)stride_bytes * (size_t)outputCaptureInfo.output_height,
-                                                         free_shared_depth_image,
-                                                         shared_image_context,
-                                                         &image));
-            if (K4A_SUCCEEDED(result))
-            {
-                cleanup_capture_byte_ptr = false; // buffer is now owned by image;
-                INC_REF_VAR(shared_image_context->ref);
-                image_set_device_timestamp_usec(image,
-                                                K4A_90K_HZ_TICK_TO_USEC(outputCaptureInfo.center_of_exposure_in_ticks));
-                image_set_system_timestamp_nsec(image, image_get_system_timestamp_nsec(image_raw));
-                capture_set_depth_image(capture, image);
-                image_dec_ref(image);
-            }
-        }
+    return result;
+}
 
-        if (K4A_SUCCEEDED(result))
+// Waits with the depth engine alive for the next dewrapper_start(). Returns false if the thread should exit instead.
+static bool depth_engine_park(dewrapper_context_t *dewrapper)
+{
+    Lock(dewrapper->lock);
+    bool resume = dewrapper->keep_alive && dewrapper->thread_stop && !dewrapper->thread_exit &&
+                  dewrapper->depth_engine != NULL && !dewrapper->engine_stale;
+    if (resume)
+    {
+        dewrapper->thread_parked = true;
+        Condition_Post(dewrapper->condition);
+        while (dewrapper->thread_stop && !dewrapper->thread_exit)
         {
-            k4a_image_t image;
-            int stride_bytes = (int)outputCaptureInfo.output_width * (int)sizeof(uint16_t);
-            uint8_t *image_buf = capture_byte_ptr;
-            if (depth16_present)
-            {
-                image_buf = image_buf + stride_bytes * outputCaptureInfo.output_height;
-            }
-
-            result = TRACE_CALL(image_create_from_buffer(K4A_IMAGE_FORMAT_IR16,
-                                                         outputCaptureInfo.output_width,
-                                                         outputCaptureInfo.output_height,
-                                                         stride_bytes,
-                                                         image_buf,
-                                                         (size_t)stride_bytes * (size_t)outputCaptureInfo.output_height,
-                                                         free_shared_depth_image,
-                                                         shared_image_context,
-                                                         &image));
-            if (K4A_SUCCEEDED(result))
-            {
-                cleanup_capture_byte_ptr = false; // buffer is now owned by image;
-                INC_REF_VAR(shared_image_context->ref);
-                image_set_device_timestamp_usec(image,
-                                                K4A_90K_HZ_TICK_TO_USEC(outputCaptureInfo.center_of_exposure_in_ticks));
-                image_set_system_timestamp_nsec(image, image_get_system_timestamp_nsec(image_raw));
-                capture_set_ir_image(capture, image);
-                image_dec_ref(image);
-            }
+            int infinite_timeout = 0;
+            (void)Condition_Wait(dewrapper->condition, dewrapper->lock, infinite_timeout);
         }
+        dewrapper->thread_parked = false;
+        resume = !dewrapper->thread_exit;
+    }
+    else
+    {
+        dewrapper->thread_exited = true;
+        Condition_Post(dewrapper->condition);
+    }
+    Unlock(dewrapper->lock);
+    return resume;
+}
 
-        if (K4A_SUCCEEDED(result))
-        {
-            // set capture attributes
-            capture_set_temperature_c(capture, outputCaptureInfo.sensor_temp);
+static int depth_engine_thread(void *param)
+{
+    dewrapper_context_t *dewrapper = (dewrapper_context_t *)param;
+    k4a_result_t result;
 
-            received_valid_image = true;
-            dewrapper->capture_ready_cb(result, capture, dewrapper->capture_ready_cb_context);
-        }
+    threadpolicy_apply(K4A_SDK_THREAD_DEPTH_ENGINE);
 
-        if (shared_image_context && shared_image_context->ref == 0)
-        {
-            // It didn't get used due to a failure
-            free(shared_image_context);
-        }
+    do
+    {
+        result = depth_engine_stream(dewrapper);
+    } while (depth_engine_park(dewrapper));
 
-        if (capture)
-        {
-            capture_dec_ref(capture);
-        }
-        if (capture_raw)
-        {
-            capture_dec_ref(capture_raw);
-        }
-        if (image_raw)
-        {
-            image_dec_ref(image_raw);
-            image_raw = NULL;
-        }
+    depth_engine_stop_helper(dewrapper);
 
-        if (capture_byte_ptr && cleanup_capture_byte_ptr)
-        {
-            allocator_free(capture_byte_ptr);
-        }
+    // This will always return failure, because stop is trigged by the queue being disabled
+    return (int)result;
+}
 
-        if (dropped)
-        {
-            // It is not a fatal error when we drop a frame, so we reset 'result' so that we can continue to run.
-            result = K4A_RESULT_SUCCEEDED;
-        }
+// Ends a thread parked by dewrapper_stop(), which destroys the depth engine it kept alive
+static void depth_engine_thread_exit(dewrapper_context_t *dewrapper)
+{
+    Lock(dewrapper->lock);
+    THREAD_HANDLE thread = dewrapper->thread_parked ? dewrapper->thread : NULL;
+    if (thread)
+    {
+        dewrapper->thread = NULL;
+        dewrapper->thread_exit = true;
+        Condition_Post(dewrapper->condition);
     }
+    Unlock(dewrapper->lock);
 
-    if (K4A_FAILED(result))
+    if (thread)
     {
-        dewrapper->capture_ready_cb(result, NULL, dewrapper->capture_ready_cb_context);
+        int thread_result;
+        THREADAPI_RESULT tresult = ThreadAPI_Join(thread, &thread_result);
+        (void)K4A_RESULT_FROM_BOOL(tresult == THREADAPI_OK);
+        dewrapper->thread_exit = false;
     }
-
-    depth_engine_stop_helper(dewrapper);
-
-    // This will always return failure, because stop is trigged by the queue being disabled
-    return (int)result;
 }
 
 dewrapper_t dewrapper_create(k4a_calibration_camera_t *calibration,
@@ -429,6 +927,27 @@ dewrapper_t dewrapper_create(k4a_calibration_camera_t *calibration,
     dewrapper->capture_ready_cb = capture_ready_cb;
     dewrapper->capture_ready_cb_context = capture_ready_context;
     dewrapper->thread_start_result = K4A_RESULT_FAILED;
+    dewrapper->frames_in_flight = DEWRAPPER_DEFAULT_FRAMES_IN_FLIGHT;
+    dewrapper->gpu_setting = K4A_DEPTH_ENGINE_GPU_DEFAULT;
+    dewrapper->gpu_index = K4A_DEPTH_ENGINE_GPU_DEFAULT;
+    dewrapper->min_compute_time_ms = UINT32_MAX;
+
+    const char *env_frames_in_flight = environment_get_variable("K4A_DEPTH_ENGINE_FRAMES_IN_FLIGHT");
+    if (env_frames_in_flight != NULL && env_frames_in_flight[0] != '\0')
+    {
+        uint32_t frames_in_flight = (uint32_t)strtoul(env_frames_in_flight, NULL, 10);
+        if (frames_in_flight >= 1 && frames_in_flight <= K4A_PLUGIN_MAX_FRAMES_IN_FLIGHT)
+        {
+            dewrapper->frames_in_flight = frames_in_flight;
+        }
+        else
+        {
+            LOG_WARNING("Ignoring K4A_DEPTH_ENGINE_FRAMES_IN_FLIGHT=%s, it must be 1 to %d",
+                        env_frames_in_flight,
+                        K4A_PLUGIN_MAX_FRAMES_IN_FLIGHT);
+        }
+    }
+
     dewrapper->tick = tickcounter_create();
     result = K4A_RESULT_FROM_BOOL(NULL != dewrapper->tick);
 
@@ -445,7 +964,7 @@ dewrapper_t dewrapper_create(k4a_calibration_camera_t *calibration,
 
     if (K4A_SUCCEEDED(result))
     {
-        result = TRACE_CALL(queue_create(DEWRAPPER_QUEUE_DEPTH, "dewrapper", &dewrapper->queue));
+        result = TRACE_CALL(queue_create_lockfree(DEWRAPPER_QUEUE_DEPTH, "dewrapper", &dewrapper->queue));
     }
 
     if (K4A_FAILED(result))
@@ -463,12 +982,15 @@ void dewrapper_destroy(dewrapper_t dewrapper_handle)
     dewrapper_context_t *dewrapper = dewrapper_t_get_context(dewrapper_handle);
 
     dewrapper_stop(dewrapper_handle);
+    depth_engine_thread_exit(dewrapper);
 
     if (dewrapper->queue)
     {
         queue_destroy(dewrapper->queue);
     }
 
+    depth_filter_destroy(dewrapper->depth_filter);
+
     if (dewrapper->tick)
     {
         tickcounter_destroy(dewrapper->tick);
@@ -486,14 +1008,93 @@ void dewrapper_destroy(dewrapper_t dewrapper_handle)
     dewrapper_t_destroy(dewrapper_handle);
 }
 
+// Releases the reference a raw payload image holds on the USB transfer image it wraps
+static void free_raw_depth_payload(void *buffer, void *context)
+{
+    (void)buffer;
+    image_dec_ref((k4a_image_t)context);
+}
+
+// Hands the raw payload of capture_raw to the capture callback as the depth image of a capture of its own. A payload
+// that can't be wrapped is dropped.
+static void dewrapper_post_raw_payload(dewrapper_context_t *dewrapper, k4a_capture_t capture_raw)
+{
+    k4a_capture_t capture = NULL;
+    k4a_image_t image = NULL;
+    uint32_t width = 0;
+    uint32_t height = 0;
+
+    k4a_image_t image_raw = capture_get_ir_image(capture_raw);
+    k4a_result_t result = K4A_RESULT_FROM_BOOL(image_raw != NULL && image_get_size(image_raw) > 0);
+
+    if (K4A_SUCCEEDED(result))
+    {
+        result = K4A_RESULT_FROM_BOOL(k4a_convert_depth_mode_to_width_height(dewrapper->depth_mode, &width, &height));
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        result = TRACE_CALL(capture_create(&capture));
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        // The payload is read in place from the USB transfer buffer, the image keeps the transfer image alive
+        result = TRACE_CALL(image_create_from_buffer(K4A_IMAGE_FORMAT_CUSTOM,
+                                                     (int)width,
+                                                     (int)height,
+                                                     0,
+                                                     image_get_buffer(image_raw),
+                                                     image_get_size(image_raw),
+                                                     free_raw_depth_payload,
+                                                     image_raw,
+                                                     &image));
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        image_set_system_timestamp_nsec(image, image_get_system_timestamp_nsec(image_raw));
+        image_raw = NULL; // reference is now owned by image
+
+        capture_set_depth_image(capture, image);
+        image_dec_ref(image);
+        dewrapper->capture_ready_cb(result, capture, dewrapper->capture_ready_cb_context);
+    }
+    else
+    {
+        LOG_WARNING("Dropping a raw depth payload that could not be wrapped", 0);
+    }
+
+    if (image_raw)
+    {
+        image_dec_ref(image_raw);
+    }
+    if (capture)
+    {
+        capture_dec_ref(capture);
+    }
+}
+
 void dewrapper_post_capture(k4a_result_t cb_result, k4a_capture_t capture_raw, void *context)
 {
     dewrapper_t dewrapper_handle = (dewrapper_t)context;
     dewrapper_context_t *dewrapper = dewrapper_t_get_context(dewrapper_handle);
     k4a_capture_t capture = NULL;
 
-    if (K4A_SUCCEEDED(cb_result))
+    if (K4A_SUCCEEDED(cb_result) && dewrapper->delivery_divisor > 1 &&
+        (dewrapper->delivery_count++ % dewrapper->delivery_divisor) != 0)
+    {
+        // Not delivered, drop it before the depth engine spends any time on it
+        return;
+    }
+
+    if (K4A_SUCCEEDED(cb_result) && dewrapper->raw_depth_payload)
+    {
+        dewrapper_post_raw_payload(dewrapper, capture_raw);
+    }
+    else if (K4A_SUCCEEDED(cb_result))
     {
+        TRACE_INSTANT("depth engine queue push", tracing_is_enabled() ? dewrapper_trace_frame(capture_raw) : 0);
         queue_push(dewrapper->queue, capture_raw);
     }
     else
@@ -504,8 +1105,171 @@ void dewrapper_post_capture(k4a_result_t cb_result, k4a_capture_t capture_raw, v
     }
 }
 
+// Started and not stopped, a thread parked by dewrapper_stop() is not streaming
+static bool dewrapper_is_streaming(dewrapper_context_t *dewrapper)
+{
+    return dewrapper->raw_depth_payload || (dewrapper->thread != NULL && !dewrapper->thread_parked);
+}
+
+k4a_result_t dewrapper_set_allocator(dewrapper_t dewrapper_handle, const allocator_hook_t *hook)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, dewrapper_t, dewrapper_handle);
+    dewrapper_context_t *dewrapper = dewrapper_t_get_context(dewrapper_handle);
+
+    k4a_result_t result = K4A_RESULT_FROM_BOOL(!dewrapper_is_streaming(dewrapper));
+    if (K4A_SUCCEEDED(result))
+    {
+        if (hook)
+        {
+            dewrapper->allocator = *hook;
+        }
+        else
+        {
+            memset(&dewrapper->allocator, 0, sizeof(dewrapper->allocator));
+        }
+
+        // A depth engine kept alive by the last stop has its output pool on the old allocator
+        dewrapper->engine_stale = true;
+    }
+    return result;
+}
+
+k4a_result_t dewrapper_set_gpu(dewrapper_t dewrapper_handle, int32_t gpu_index)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, dewrapper_t, dewrapper_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, gpu_index < K4A_DEPTH_ENGINE_GPU_ROUND_ROBIN);
+    dewrapper_context_t *dewrapper = dewrapper_t_get_context(dewrapper_handle);
+
+    k4a_result_t result = K4A_RESULT_FROM_BOOL(!dewrapper_is_streaming(dewrapper));
+    if (K4A_SUCCEEDED(result) && gpu_index >= 0)
+    {
+        uint32_t gpu_count = deloader_depth_engine_get_gpu_count();
+        if ((uint32_t)gpu_index >= gpu_count || gpu_index >= DEWRAPPER_MAX_GPUS)
+        {
+            LOG_ERROR("GPU %d can not be selected, the depth engine supports %d GPUs", gpu_index, gpu_count);
+            result = K4A_RESULT_FAILED;
+        }
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        dewrapper->gpu_setting = gpu_index;
+        if (gpu_index >= 0)
+        {
+            dewrapper->gpu_index = gpu_index;
+        }
+        dewrapper->engine_stale = true;
+    }
+    return result;
+}
+
+k4a_result_t dewrapper_set_depth_filter(dewrapper_t dewrapper_handle, const k4a_depth_filter_configuration_t *config)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, dewrapper_t, dewrapper_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, config != NULL && !depth_filter_configuration_is_valid(config));
+    dewrapper_context_t *dewrapper = dewrapper_t_get_context(dewrapper_handle);
+
+    k4a_result_t result = K4A_RESULT_FROM_BOOL(!dewrapper_is_streaming(dewrapper));
+    if (K4A_SUCCEEDED(result))
+    {
+        if (config)
+        {
+            dewrapper->depth_filter_config = *config;
+            dewrapper->depth_filter_enabled = depth_filter_configuration_is_enabled(config);
+        }
+        else
+        {
+            memset(&dewrapper->depth_filter_config, 0, sizeof(dewrapper->depth_filter_config));
+            dewrapper->depth_filter_enabled = false;
+        }
+    }
+    return result;
+}
+
+void dewrapper_set_warm_up(dewrapper_t dewrapper_handle, size_t raw_frame_size)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, dewrapper_t, dewrapper_handle);
+    dewrapper_context_t *dewrapper = dewrapper_t_get_context(dewrapper_handle);
+
+    Lock(dewrapper->lock);
+    dewrapper->warm_up_frame_size = raw_frame_size;
+    Unlock(dewrapper->lock);
+}
+
+void dewrapper_set_keep_alive(dewrapper_t dewrapper_handle, bool keep_alive)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, dewrapper_t, dewrapper_handle);
+    dewrapper_context_t *dewrapper = dewrapper_t_get_context(dewrapper_handle);
+
+    Lock(dewrapper->lock);
+    dewrapper->keep_alive = keep_alive;
+    Unlock(dewrapper->lock);
+
+    if (!keep_alive)
+    {
+        depth_engine_thread_exit(dewrapper);
+    }
+}
+
+k4a_result_t dewrapper_get_gpu_statistics(dewrapper_t dewrapper_handle, k4a_depth_engine_gpu_statistics_t *statistics)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, dewrapper_t, dewrapper_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, statistics == NULL);
+    dewrapper_context_t *dewrapper = dewrapper_t_get_context(dewrapper_handle);
+    dewrapper_gpu_statistics_t *gpu = dewrapper_gpu_statistics(dewrapper);
+
+    statistics->gpu_index = dewrapper->gpu_index;
+    statistics->depth_engine_count = k4a_atomic_load(&gpu->depth_engine_count);
+    statistics->frames_in_flight = k4a_atomic_load(&gpu->frames_in_flight);
+    statistics->frames_processed = k4a_atomic_load64(&gpu->frames_processed);
+    uint64_t total_compute_time_ms = k4a_atomic_load64(&gpu->total_compute_time_ms);
+    statistics->average_compute_time_ms =
+        statistics->frames_processed == 0 ? 0 : (uint32_t)(total_compute_time_ms / statistics->frames_processed);
+    statistics->max_compute_time_ms = k4a_atomic_load(&gpu->max_compute_time_ms);
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t dewrapper_get_statistics(dewrapper_t dewrapper_handle, k4a_device_statistics_t *statistics)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, dewrapper_t, dewrapper_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, statistics == NULL);
+    dewrapper_context_t *dewrapper = dewrapper_t_get_context(dewrapper_handle);
+
+    uint32_t buckets[DEWRAPPER_COMPUTE_TIME_BUCKETS];
+    uint64_t frame_count = 0;
+    for (uint32_t i = 0; i < DEWRAPPER_COMPUTE_TIME_BUCKETS; i++)
+    {
+        buckets[i] = k4a_atomic_load(&dewrapper->compute_time_buckets[i]);
+        frame_count += buckets[i];
+    }
+
+    // Smallest time that at least 99% of the frames took no longer than
+    uint32_t p99_ms = 0;
+    uint64_t below = 0;
+    while (p99_ms < DEWRAPPER_COMPUTE_TIME_BUCKETS - 1 && (below + buckets[p99_ms]) * 100 < frame_count * 99)
+    {
+        below += buckets[p99_ms];
+        p99_ms++;
+    }
+
+    // Frames keep completing while the buckets are read, the average uses totals that are read together instead
+    uint64_t total_compute_time_ms = k4a_atomic_load64(&dewrapper->total_compute_time_ms);
+    uint64_t total_frame_count = k4a_atomic_load64(&dewrapper->frame_count);
+    uint32_t min_ms = k4a_atomic_load(&dewrapper->min_compute_time_ms);
+    statistics->depth_engine_frame_count = frame_count;
+    statistics->depth_engine_min_compute_time_ms = frame_count == 0 ? 0 : min_ms;
+    statistics->depth_engine_average_compute_time_ms =
+        total_frame_count == 0 ? 0 : (uint32_t)(total_compute_time_ms / total_frame_count);
+    statistics->depth_engine_p99_compute_time_ms = frame_count == 0 ? 0 : p99_ms;
+    statistics->depth_engine_max_compute_time_ms = k4a_atomic_load(&dewrapper->max_compute_time_ms);
+    statistics->depth_engine_overrun_count = k4a_atomic_load(&dewrapper->overrun_count);
+    statistics->depth_engine_dropped_count = queue_get_dropped_count(dewrapper->queue);
+    return K4A_RESULT_SUCCEEDED;
+}
+
 k4a_result_t dewrapper_start(dewrapper_t dewrapper_handle,
                              const k4a_device_configuration_t *config,
+                             const k4a_device_start_options_t *options,
                              uint8_t *calibration_memory,
                              size_t calibration_memory_size)
 {
@@ -513,15 +1277,61 @@ k4a_result_t dewrapper_start(dewrapper_t dewrapper_handle,
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, calibration_memory_size == 0);
     RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, dewrapper_t, dewrapper_handle);
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, config == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, options == NULL);
     dewrapper_context_t *dewrapper = dewrapper_t_get_context(dewrapper_handle);
 
     dewrapper->calibration_memory = calibration_memory;
     dewrapper->calibration_memory_size = calibration_memory_size;
     dewrapper->thread_start_result = K4A_RESULT_FAILED;
 
-    k4a_result_t result = K4A_RESULT_FROM_BOOL(dewrapper->thread == NULL);
+    k4a_result_t result = K4A_RESULT_FROM_BOOL(!dewrapper_is_streaming(dewrapper));
+
+    if (K4A_SUCCEEDED(result))
+    {
+        uint32_t queue_depth = options->depth_engine_queue_depth;
+        if (queue_depth == 0)
+        {
+            queue_depth = DEWRAPPER_QUEUE_DEPTH;
+        }
+        result = TRACE_CALL(queue_configure(dewrapper->queue, queue_depth, options->depth_engine_queue_policy));
+    }
 
     if (K4A_SUCCEEDED(result))
+    {
+        // Each stream starts with a new filter, which also drops the temporal history of the last one
+        depth_filter_destroy(dewrapper->depth_filter);
+        dewrapper->depth_filter = NULL;
+
+        uint32_t width = 0;
+        uint32_t height = 0;
+        if (dewrapper->depth_filter_enabled && !options->raw_depth_payload &&
+            k4a_convert_depth_mode_to_width_height(config->depth_mode, &width, &height) &&
+            config->depth_mode != K4A_DEPTH_MODE_PASSIVE_IR)
+        {
+            dewrapper->depth_filter = depth_filter_create(&dewrapper->depth_filter_config, width, height);
+            if (dewrapper->depth_filter == NULL)
+            {
+                LOG_ERROR("Failed to create the depth filter", 0);
+                result = K4A_RESULT_FAILED;
+            }
+        }
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        dewrapper->delivery_divisor = options->depth_delivery_divisor;
+        dewrapper->delivery_count = 0;
+    }
+
+    if (K4A_SUCCEEDED(result) && options->raw_depth_payload)
+    {
+        // Raw payloads are handed on by dewrapper_post_capture(), a thread parked by the last stop stays parked
+        dewrapper->fps = config->camera_fps;
+        dewrapper->depth_mode = config->depth_mode;
+        dewrapper->depth_image_only = false;
+        dewrapper->raw_depth_payload = true;
+    }
+    else if (K4A_SUCCEEDED(result))
     {
         bool locked = false;
         queue_enable(dewrapper->queue);
@@ -529,17 +1339,33 @@ k4a_result_t dewrapper_start(dewrapper_t dewrapper_handle,
         // NOTE: do not copy config ptr, it may be freed after this call
         dewrapper->fps = config->camera_fps;
         dewrapper->depth_mode = config->depth_mode;
-        dewrapper->thread_stop = false;
+        dewrapper->depth_image_only = options->depth_image_only;
         dewrapper->thread_started = false;
 
-        THREADAPI_RESULT tresult = ThreadAPI_Create(&dewrapper->thread, depth_engine_thread, dewrapper);
-        result = K4A_RESULT_FROM_BOOL(tresult == THREADAPI_OK);
-
-        if (K4A_SUCCEEDED(result))
+        if (dewrapper->thread != NULL)
         {
+            // Wake the thread parked by the last stop, it reuses its depth engine if the mode is unchanged
             Lock(dewrapper->lock);
             locked = true;
-            if (!dewrapper->thread_started)
+            dewrapper->thread_stop = false;
+            Condition_Post(dewrapper->condition);
+        }
+        else
+        {
+            dewrapper->thread_stop = false;
+            dewrapper->thread_exited = false;
+            THREADAPI_RESULT tresult = ThreadAPI_Create(&dewrapper->thread, depth_engine_thread, dewrapper);
+            result = K4A_RESULT_FROM_BOOL(tresult == THREADAPI_OK);
+        }
+
+        if (K4A_SUCCEEDED(result))
+        {
+            if (!locked)
+            {
+                Lock(dewrapper->lock);
+                locked = true;
+            }
+            while (K4A_SUCCEEDED(result) && !dewrapper->thread_started)
             {
                 int infinite_timeout = 0;
                 COND_RESULT cond_result = Condition_Wait(dewrapper->condition, dewrapper->lock, infinite_timeout);
@@ -573,11 +1399,28 @@ void dewrapper_stop(dewrapper_t dewrapper_handle)
     dewrapper_context_t *dewrapper = dewrapper_t_get_context(dewrapper_handle);
 
     dewrapper->thread_stop = true;
+    dewrapper->raw_depth_payload = false;
     queue_disable(dewrapper->queue);
 
     Lock(dewrapper->lock);
     THREAD_HANDLE thread = dewrapper->thread;
-    dewrapper->thread = NULL;
+    if (thread && dewrapper->keep_alive)
+    {
+        // The thread either parks with its depth engine for the next start, or exits if the engine can't be reused
+        while (!dewrapper->thread_parked && !dewrapper->thread_exited)
+        {
+            int infinite_timeout = 0;
+            (void)Condition_Wait(dewrapper->condition, dewrapper->lock, infinite_timeout);
+        }
+        if (dewrapper->thread_parked)
+        {
+            thread = NULL;
+        }
+    }
+    if (thread)
+    {
+        dewrapper->thread = NULL;
+    }
     Unlock(dewrapper->lock);
 
     if (thread)
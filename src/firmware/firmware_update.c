@@ -0,0 +1,301 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// This library
+#include <k4ainternal/firmware.h>
+
+// Dependent libraries
+#include <azure_c_shared_utility/lock.h>
+#include <azure_c_shared_utility/threadapi.h>
+#include <azure_c_shared_utility/tickcounter.h>
+
+// System dependencies
+#include <stdlib.h>
+#include <string.h>
+
+#define FIRMWARE_UPDATE_TIMEOUT_MS (10 * 60 * 1000) // 10 Minutes should be way more than enough.
+#define FIRMWARE_UPDATE_POLL_MS 500                 // The status shouldn't be read more frequently than 2Hz
+#define FIRMWARE_UPDATE_CONNECT_RETRIES 20
+#define FIRMWARE_UPDATE_CONNECT_RETRY_MS 500
+#define FIRMWARE_UPDATE_RESET_MS 1000 // Time for a device to reset and de-enumerate before it is re-opened
+
+typedef struct _firmware_update_context_t
+{
+    const firmware_package_info_t *package_info;
+    firmware_update_progress_cb_t *progress_cb;
+    void *progress_context;
+
+    // Opening a device opens every other one in turn to find its serial number, only one thread enumerates at a time
+    LOCK_HANDLE connect_lock;
+
+    // Serializes progress_cb
+    LOCK_HANDLE progress_lock;
+} firmware_update_context_t;
+
+typedef struct _firmware_update_thread_t
+{
+    firmware_update_context_t *context;
+    firmware_update_device_t *device;
+    THREAD_HANDLE thread;
+} firmware_update_thread_t;
+
+static void firmware_update_report(firmware_update_context_t *context,
+                                   firmware_update_device_t *device,
+                                   firmware_update_stage_t stage)
+{
+    device->stage = stage;
+    if (context->progress_cb != NULL)
+    {
+        Lock(context->progress_lock);
+        context->progress_cb(device, context->progress_context);
+        Unlock(context->progress_lock);
+    }
+}
+
+static bool firmware_update_component_succeeded(const firmware_component_status_t *status)
+{
+    // If the version check failed, this component's update was skipped. This could because the new version is
+    // an unsafe downgrade or the versions are the same and no update is required.
+    return status->overall == FIRMWARE_OPERATION_SUCCEEDED ||
+           (status->overall != FIRMWARE_OPERATION_INPROGRESS && status->version_check == FIRMWARE_OPERATION_FAILED);
+}
+
+static bool firmware_update_components_done(const firmware_status_summary_t *status)
+{
+    return status->audio.overall > FIRMWARE_OPERATION_INPROGRESS &&
+           status->depth_config.overall > FIRMWARE_OPERATION_INPROGRESS &&
+           status->depth.overall > FIRMWARE_OPERATION_INPROGRESS &&
+           status->rgb.overall > FIRMWARE_OPERATION_INPROGRESS;
+}
+
+static k4a_result_t firmware_update_connect(firmware_update_context_t *context,
+                                            firmware_update_device_t *device,
+                                            firmware_t *firmware_handle)
+{
+    k4a_result_t result = K4A_RESULT_FAILED;
+
+    // Wait until the device is available...
+    for (int retry = 0; retry < FIRMWARE_UPDATE_CONNECT_RETRIES && K4A_FAILED(result); retry++)
+    {
+        if (retry > 0)
+        {
+            ThreadAPI_Sleep(FIRMWARE_UPDATE_CONNECT_RETRY_MS);
+        }
+
+        Lock(context->connect_lock);
+        result = firmware_create(device->serial_number, false, firmware_handle);
+        Unlock(context->connect_lock);
+    }
+
+    if (K4A_FAILED(result))
+    {
+        LOG_ERROR("Failed to connect to device S/N: %s", device->serial_number);
+    }
+    return result;
+}
+
+static k4a_result_t firmware_update_wait_complete(firmware_update_context_t *context,
+                                                  firmware_update_device_t *device,
+                                                  firmware_t firmware_handle)
+{
+    tickcounter_ms_t start_time_ms = 0;
+    tickcounter_ms_t now = 0;
+
+    TICK_COUNTER_HANDLE tick = tickcounter_create();
+    k4a_result_t result = K4A_RESULT_FROM_BOOL(tick != NULL);
+    if (K4A_SUCCEEDED(result))
+    {
+        result = K4A_RESULT_FROM_BOOL(tickcounter_get_current_ms(tick, &start_time_ms) == 0);
+    }
+
+    while (K4A_SUCCEEDED(result))
+    {
+        firmware_status_summary_t status;
+        result = TRACE_CALL(firmware_get_download_status(firmware_handle, &status));
+        if (K4A_FAILED(result))
+        {
+            break;
+        }
+
+        if (!device->status_valid || memcmp(&status, &device->status, sizeof(status)) != 0)
+        {
+            device->status = status;
+            device->status_valid = true;
+            firmware_update_report(context, device, FIRMWARE_UPDATE_STAGE_UPDATING);
+        }
+
+        if (firmware_update_components_done(&status))
+        {
+            break;
+        }
+
+        result = K4A_RESULT_FROM_BOOL(tickcounter_get_current_ms(tick, &now) == 0);
+        if (K4A_SUCCEEDED(result) && now - start_time_ms > FIRMWARE_UPDATE_TIMEOUT_MS)
+        {
+            LOG_ERROR("Timeout waiting for the update of device S/N: %s to complete.", device->serial_number);
+            result = K4A_RESULT_FAILED;
+        }
+
+        if (K4A_SUCCEEDED(result))
+        {
+            ThreadAPI_Sleep(FIRMWARE_UPDATE_POLL_MS);
+        }
+    }
+
+    if (tick != NULL)
+    {
+        tickcounter_destroy(tick);
+    }
+    return result;
+}
+
+static int firmware_update_thread(void *param)
+{
+    firmware_update_thread_t *update = (firmware_update_thread_t *)param;
+    firmware_update_context_t *context = update->context;
+    firmware_update_device_t *device = update->device;
+    firmware_t firmware_handle = NULL;
+
+    k4a_result_t result = firmware_update_connect(context, device, &firmware_handle);
+    if (K4A_SUCCEEDED(result))
+    {
+        result = TRACE_CALL(firmware_get_device_version(firmware_handle, &device->current_version));
+        device->current_version_valid = K4A_SUCCEEDED(result);
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        LOG_INFO("Sending firmware to device S/N: %s", device->serial_number);
+        firmware_update_report(context, device, FIRMWARE_UPDATE_STAGE_DOWNLOADING);
+
+        // The download only reads the buffer, so all devices share the caller's copy
+        result = TRACE_CALL(
+            firmware_download(firmware_handle, context->package_info->buffer, context->package_info->size));
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        result = firmware_update_wait_complete(context, device, firmware_handle);
+
+        // Always reset the device once the download was accepted.
+        firmware_update_report(context, device, FIRMWARE_UPDATE_STAGE_RESETTING);
+        k4a_result_t reset_result = TRACE_CALL(firmware_reset_device(firmware_handle));
+        firmware_destroy(firmware_handle);
+        firmware_handle = NULL;
+
+        if (K4A_SUCCEEDED(reset_result))
+        {
+            // Allow the device to reset and the system to de-enumerate it before re-opening it to ensure it is ready.
+            ThreadAPI_Sleep(FIRMWARE_UPDATE_RESET_MS);
+            reset_result = firmware_update_connect(context, device, &firmware_handle);
+        }
+        else
+        {
+            LOG_ERROR("Device S/N: %s failed to reset after an update.", device->serial_number);
+        }
+
+        if (K4A_SUCCEEDED(reset_result))
+        {
+            device->updated_version_valid = K4A_SUCCEEDED(
+                TRACE_CALL(firmware_get_device_version(firmware_handle, &device->updated_version)));
+        }
+
+        if (K4A_SUCCEEDED(result))
+        {
+            result = K4A_RESULT_FROM_BOOL(firmware_update_component_succeeded(&device->status.audio) &&
+                                          firmware_update_component_succeeded(&device->status.depth_config) &&
+                                          firmware_update_component_succeeded(&device->status.depth) &&
+                                          firmware_update_component_succeeded(&device->status.rgb));
+        }
+        if (K4A_SUCCEEDED(result))
+        {
+            result = reset_result;
+        }
+    }
+
+    if (firmware_handle != NULL)
+    {
+        firmware_destroy(firmware_handle);
+    }
+
+    device->result = result;
+    firmware_update_report(context, device, FIRMWARE_UPDATE_STAGE_COMPLETE);
+    return 0;
+}
+
+k4a_result_t firmware_update_devices(const firmware_package_info_t *package_info,
+                                     firmware_update_device_t *devices,
+                                     uint32_t device_count,
+                                     firmware_update_progress_cb_t *progress_cb,
+                                     void *progress_context)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, package_info == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, package_info->buffer == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, !package_info->package_valid);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, devices == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, device_count == 0);
+
+    for (uint32_t i = 0; i < device_count; i++)
+    {
+        RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, devices[i].serial_number == NULL);
+    }
+
+    firmware_update_context_t context = { 0 };
+    context.package_info = package_info;
+    context.progress_cb = progress_cb;
+    context.progress_context = progress_context;
+    context.connect_lock = Lock_Init();
+    context.progress_lock = Lock_Init();
+
+    firmware_update_thread_t *threads = (firmware_update_thread_t *)calloc(device_count, sizeof(*threads));
+    k4a_result_t result = K4A_RESULT_FROM_BOOL(threads != NULL && context.connect_lock != NULL &&
+                                               context.progress_lock != NULL);
+
+    for (uint32_t i = 0; i < device_count; i++)
+    {
+        firmware_update_device_t *device = &devices[i];
+        char *serial_number = device->serial_number;
+        memset(device, 0, sizeof(*device));
+        device->serial_number = serial_number;
+        device->stage = FIRMWARE_UPDATE_STAGE_CONNECTING;
+        device->result = K4A_RESULT_FAILED;
+    }
+
+    for (uint32_t i = 0; i < device_count && K4A_SUCCEEDED(result); i++)
+    {
+        threads[i].context = &context;
+        threads[i].device = &devices[i];
+        if (ThreadAPI_Create(&threads[i].thread, firmware_update_thread, &threads[i]) != THREADAPI_OK)
+        {
+            LOG_ERROR("Failed to start the update of device S/N: %s", devices[i].serial_number);
+            threads[i].thread = NULL;
+            result = K4A_RESULT_FAILED;
+        }
+    }
+
+    // Devices already being updated are always waited for, an interrupted update could leave them unusable
+    for (uint32_t i = 0; threads != NULL && i < device_count; i++)
+    {
+        if (threads[i].thread != NULL)
+        {
+            int thread_result;
+            (void)ThreadAPI_Join(threads[i].thread, &thread_result);
+        }
+        if (K4A_FAILED(devices[i].result))
+        {
+            result = K4A_RESULT_FAILED;
+        }
+    }
+
+    free(threads);
+    if (context.progress_lock != NULL)
+    {
+        Lock_Deinit(context.progress_lock);
+    }
+    if (context.connect_lock != NULL)
+    {
+        Lock_Deinit(context.connect_lock);
+    }
+
+    return result;
+}
@@ -0,0 +1,338 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// This library
+#include <k4ainternal/groupsync.h>
+
+// Dependent libraries
+#include <k4ainternal/atomic.h>
+#include <k4ainternal/capture.h>
+#include <k4ainternal/common.h>
+#include <k4ainternal/handle.h>
+#include <k4ainternal/logging.h>
+
+#include <azure_c_shared_utility/condition.h>
+#include <azure_c_shared_utility/lock.h>
+#include <azure_c_shared_utility/tickcounter.h>
+
+// System dependencies
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct _groupsync_entry_t
+{
+    k4a_capture_t capture;
+    int64_t timestamp_usec;
+} groupsync_entry_t;
+
+// Single producer, single consumer queue of the captures of one device. The device's thread only writes write_location
+// and the matcher only writes read_location, so neither side takes a lock.
+typedef struct _groupsync_queue_t
+{
+    groupsync_entry_t entries[GROUPSYNC_MAX_PENDING_CAPTURES];
+    volatile uint32_t read_location;
+    volatile uint32_t write_location;
+} groupsync_queue_t;
+
+typedef struct _groupsync_context_t
+{
+    uint32_t device_count;
+    groupsync_queue_t *queues;
+
+    uint32_t tolerance_usec;
+    volatile uint32_t running;
+
+    // The matcher holds lock while matching, producers only take it to post condition when get_blocked is set
+    LOCK_HANDLE lock;
+    COND_HANDLE condition;
+    volatile uint32_t get_blocked;
+    TICK_COUNTER_HANDLE tick;
+
+    volatile uint64_t group_capture_count;
+    volatile uint64_t unmatched_drop_count;
+    volatile uint64_t overflow_drop_count;
+} groupsync_context_t;
+
+K4A_DECLARE_CONTEXT(groupsync_t, groupsync_context_t);
+
+static uint32_t groupsync_queue_count(groupsync_queue_t *queue)
+{
+    return k4a_atomic_load(&queue->write_location) - k4a_atomic_load(&queue->read_location);
+}
+
+static groupsync_entry_t *groupsync_queue_front(groupsync_queue_t *queue)
+{
+    return &queue->entries[k4a_atomic_load(&queue->read_location) % GROUPSYNC_MAX_PENDING_CAPTURES];
+}
+
+static void groupsync_queue_pop(groupsync_queue_t *queue)
+{
+    k4a_atomic_store(&queue->read_location, queue->read_location + 1);
+}
+
+// Releases the captures waiting in the queues, called with lock held or once no more captures are added
+static void groupsync_drain_locked(groupsync_context_t *groupsync)
+{
+    for (uint32_t i = 0; i < groupsync->device_count; i++)
+    {
+        groupsync_queue_t *queue = &groupsync->queues[i];
+        while (groupsync_queue_count(queue) != 0)
+        {
+            capture_dec_ref(groupsync_queue_front(queue)->capture);
+            groupsync_queue_pop(queue);
+        }
+    }
+}
+
+k4a_result_t groupsync_create(uint32_t device_count, groupsync_t *groupsync_handle)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, device_count == 0);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, groupsync_handle == NULL);
+
+    groupsync_context_t *groupsync = groupsync_t_create(groupsync_handle);
+    k4a_result_t result = K4A_RESULT_FROM_BOOL(groupsync != NULL);
+
+    if (K4A_SUCCEEDED(result))
+    {
+        groupsync->device_count = device_count;
+        groupsync->queues = (groupsync_queue_t *)calloc(device_count, sizeof(groupsync_queue_t));
+        result = K4A_RESULT_FROM_BOOL(groupsync->queues != NULL);
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        groupsync->lock = Lock_Init();
+        result = K4A_RESULT_FROM_BOOL(groupsync->lock != NULL);
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        groupsync->condition = Condition_Init();
+        result = K4A_RESULT_FROM_BOOL(groupsync->condition != NULL);
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        groupsync->tick = tickcounter_create();
+        result = K4A_RESULT_FROM_BOOL(groupsync->tick != NULL);
+    }
+
+    if (K4A_FAILED(result))
+    {
+        groupsync_destroy(*groupsync_handle);
+        *groupsync_handle = NULL;
+    }
+
+    return result;
+}
+
+void groupsync_destroy(groupsync_t groupsync_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, groupsync_t, groupsync_handle);
+    groupsync_context_t *groupsync = groupsync_t_get_context(groupsync_handle);
+
+    if (groupsync->queues)
+    {
+        groupsync_drain_locked(groupsync);
+        free(groupsync->queues);
+    }
+    if (groupsync->tick)
+    {
+        tickcounter_destroy(groupsync->tick);
+    }
+    if (groupsync->condition)
+    {
+        Condition_Deinit(groupsync->condition);
+    }
+    if (groupsync->lock)
+    {
+        Lock_Deinit(groupsync->lock);
+    }
+    groupsync_t_destroy(groupsync_handle);
+}
+
+k4a_result_t groupsync_start(groupsync_t groupsync_handle, uint32_t tolerance_usec)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, groupsync_t, groupsync_handle);
+    groupsync_context_t *groupsync = groupsync_t_get_context(groupsync_handle);
+
+    Lock(groupsync->lock);
+    groupsync_drain_locked(groupsync);
+    groupsync->tolerance_usec = tolerance_usec;
+    k4a_atomic_store(&groupsync->running, 1);
+    Unlock(groupsync->lock);
+
+    return K4A_RESULT_SUCCEEDED;
+}
+
+void groupsync_stop(groupsync_t groupsync_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, groupsync_t, groupsync_handle);
+    groupsync_context_t *groupsync = groupsync_t_get_context(groupsync_handle);
+
+    Lock(groupsync->lock);
+    k4a_atomic_store(&groupsync->running, 0);
+    groupsync_drain_locked(groupsync);
+    Condition_Post(groupsync->condition);
+    Unlock(groupsync->lock);
+}
+
+void groupsync_add_capture(groupsync_t groupsync_handle,
+                           uint32_t device_index,
+                           k4a_capture_t capture_handle,
+                           int64_t timestamp_usec)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, groupsync_t, groupsync_handle);
+    groupsync_context_t *groupsync = groupsync_t_get_context(groupsync_handle);
+    RETURN_VALUE_IF_ARG(VOID_VALUE, device_index >= groupsync->device_count);
+    RETURN_VALUE_IF_ARG(VOID_VALUE, capture_handle == NULL);
+
+    if (k4a_atomic_load(&groupsync->running) == 0)
+    {
+        return;
+    }
+
+    groupsync_queue_t *queue = &groupsync->queues[device_index];
+    uint32_t write = queue->write_location;
+    if (write - k4a_atomic_load(&queue->read_location) >= GROUPSYNC_MAX_PENDING_CAPTURES)
+    {
+        // The matcher owns the oldest entries, so the new capture is the one dropped
+        k4a_atomic_add64(&groupsync->overflow_drop_count, 1);
+        return;
+    }
+
+    capture_inc_ref(capture_handle);
+    groupsync_entry_t *entry = &queue->entries[write % GROUPSYNC_MAX_PENDING_CAPTURES];
+    entry->capture = capture_handle;
+    entry->timestamp_usec = timestamp_usec;
+    k4a_atomic_store(&queue->write_location, write + 1);
+
+    if (k4a_atomic_load(&groupsync->get_blocked) != 0)
+    {
+        Lock(groupsync->lock);
+        Condition_Post(groupsync->condition);
+        Unlock(groupsync->lock);
+    }
+}
+
+// Pops one capture of each device if their fronts are within the tolerance of each other. Fronts that are older than
+// the newest front by more than the tolerance can't be matched anymore, as the captures of each device arrive in order.
+static bool groupsync_match_locked(groupsync_context_t *groupsync, k4a_capture_t *capture_handles)
+{
+    bool dropped = true;
+    while (dropped)
+    {
+        int64_t newest_usec = INT64_MIN;
+        for (uint32_t i = 0; i < groupsync->device_count; i++)
+        {
+            if (groupsync_queue_count(&groupsync->queues[i]) == 0)
+            {
+                return false;
+            }
+            int64_t timestamp_usec = groupsync_queue_front(&groupsync->queues[i])->timestamp_usec;
+            newest_usec = timestamp_usec > newest_usec ? timestamp_usec : newest_usec;
+        }
+
+        dropped = false;
+        for (uint32_t i = 0; i < groupsync->device_count; i++)
+        {
+            groupsync_entry_t *entry = groupsync_queue_front(&groupsync->queues[i]);
+            if (newest_usec - entry->timestamp_usec > (int64_t)groupsync->tolerance_usec)
+            {
+                capture_dec_ref(entry->capture);
+                groupsync_queue_pop(&groupsync->queues[i]);
+                k4a_atomic_add64(&groupsync->unmatched_drop_count, 1);
+                dropped = true;
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < groupsync->device_count; i++)
+    {
+        capture_handles[i] = groupsync_queue_front(&groupsync->queues[i])->capture;
+        groupsync_queue_pop(&groupsync->queues[i]);
+    }
+    k4a_atomic_add64(&groupsync->group_capture_count, 1);
+    return true;
+}
+
+k4a_wait_result_t groupsync_get_captures(groupsync_t groupsync_handle,
+                                         k4a_capture_t *capture_handles,
+                                         int32_t timeout_in_ms)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_WAIT_RESULT_FAILED, groupsync_t, groupsync_handle);
+    RETURN_VALUE_IF_ARG(K4A_WAIT_RESULT_FAILED, capture_handles == NULL);
+    groupsync_context_t *groupsync = groupsync_t_get_context(groupsync_handle);
+
+    tickcounter_ms_t start_ms = 0;
+    if (timeout_in_ms > 0 && tickcounter_get_current_ms(groupsync->tick, &start_ms) != 0)
+    {
+        return K4A_WAIT_RESULT_FAILED;
+    }
+
+    k4a_wait_result_t wresult = K4A_WAIT_RESULT_TIMEOUT;
+
+    // The producers only take the lock to post the condition when they see get_blocked set, which we do before
+    // matching, so a capture added after the last match always wakes us.
+    Lock(groupsync->lock);
+    k4a_atomic_add(&groupsync->get_blocked, 1);
+
+    while (k4a_atomic_load(&groupsync->running) != 0)
+    {
+        if (groupsync_match_locked(groupsync, capture_handles))
+        {
+            wresult = K4A_WAIT_RESULT_SUCCEEDED;
+            break;
+        }
+        if (timeout_in_ms == 0)
+        {
+            break;
+        }
+
+        // Captures of one device can wake us many times before the others arrive, so wait for what is left
+        int wait_in_ms = 0; // infinite to Condition_Wait
+        if (timeout_in_ms > 0)
+        {
+            tickcounter_ms_t now_ms = 0;
+            (void)tickcounter_get_current_ms(groupsync->tick, &now_ms);
+            if (now_ms - start_ms >= (tickcounter_ms_t)timeout_in_ms)
+            {
+                break;
+            }
+            wait_in_ms = (int)((tickcounter_ms_t)timeout_in_ms - (now_ms - start_ms));
+        }
+
+        COND_RESULT cond_result = Condition_Wait(groupsync->condition, groupsync->lock, wait_in_ms);
+        if (cond_result != COND_OK && cond_result != COND_TIMEOUT)
+        {
+            K4A_RESULT_FROM_BOOL(cond_result != COND_ERROR);
+            wresult = K4A_WAIT_RESULT_FAILED;
+            break;
+        }
+    }
+
+    if (k4a_atomic_load(&groupsync->running) == 0)
+    {
+        LOG_ERROR("Group captures were read while the group is stopped.", 0);
+        wresult = K4A_WAIT_RESULT_FAILED;
+    }
+
+    k4a_atomic_add(&groupsync->get_blocked, -1);
+    Unlock(groupsync->lock);
+
+    return wresult;
+}
+
+k4a_result_t groupsync_get_statistics(groupsync_t groupsync_handle, k4a_device_group_statistics_t *statistics)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, groupsync_t, groupsync_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, statistics == NULL);
+    groupsync_context_t *groupsync = groupsync_t_get_context(groupsync_handle);
+
+    memset(statistics, 0, sizeof(*statistics));
+    statistics->group_capture_count = k4a_atomic_load64(&groupsync->group_capture_count);
+    statistics->unmatched_drop_count = k4a_atomic_load64(&groupsync->unmatched_drop_count);
+    statistics->overflow_drop_count = k4a_atomic_load64(&groupsync->overflow_drop_count);
+
+    return K4A_RESULT_SUCCEEDED;
+}
@@ -6,7 +6,6 @@
 #include <k4ainternal/allocator.h>
 
 // Dependent libraries
-#include <azure_c_shared_utility/lock.h>
 #include <azure_c_shared_utility/refcount.h>
 
 // System dependencies
@@ -19,8 +18,7 @@
 
 typedef struct _image_context_t
 {
-    volatile long ref_count;
-    LOCK_HANDLE lock;
+    volatile long ref_count; // Only ever changed with INC_REF_VAR / DEC_REF_VAR, images carry no lock
 
     uint8_t *buffer;
     size_t buffer_size;
@@ -31,6 +29,7 @@ typedef struct _image_context_t
     int stride_bytes;            /** stride in bytes */
     uint64_t dev_timestamp_usec; /** device timestamp in microseconds */
     uint64_t sys_timestamp_nsec; /** system timestamp in nanoseconds */
+    uint64_t stage_timestamp_nsec[K4A_IMAGE_STAGE_USER_POP + 1]; /** pipeline stage times, USB arrival unused */
     uint64_t exposure_time_usec; /** image exposure duration */
     size_t size_allocated;       /** size of the raw memory allocation */
 
@@ -83,8 +82,6 @@ k4a_result_t image_create_from_buffer(k4a_image_format_t format,
         image->ref_count = 1;
         image->memory_free_cb = buffer_destroy_cb;
         image->memory_free_cb_context = buffer_destroy_cb_context;
-        image->lock = Lock_Init();
-        result = K4A_RESULT_FROM_BOOL(image->lock != NULL);
     }
 
     //
@@ -111,7 +108,8 @@ static void image_default_free_function(void *buffer, void *context)
     allocator_free(buffer);
 }
 
-static k4a_result_t image_create_empty_image(allocation_source_t source, size_t size, k4a_image_t *image_handle)
+static k4a_result_t
+image_create_empty_image(allocation_source_t source, size_t size, size_t alignment, k4a_image_t *image_handle)
 {
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, image_handle == NULL);
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, size == 0);
@@ -124,7 +122,7 @@ static k4a_result_t image_create_empty_image(allocation_source_t source, size_t
 
     if (K4A_SUCCEEDED(result))
     {
-        result = K4A_RESULT_FROM_BOOL((image->buffer = allocator_alloc(source, size)) != NULL);
+        result = K4A_RESULT_FROM_BOOL((image->buffer = allocator_alloc_aligned(source, size, alignment)) != NULL);
     }
 
     if (K4A_SUCCEEDED(result))
@@ -133,8 +131,6 @@ static k4a_result_t image_create_empty_image(allocation_source_t source, size_t
         image->buffer_size = size;
         image->memory_free_cb = image_default_free_function;
         image->memory_free_cb_context = NULL;
-        image->lock = Lock_Init();
-        result = K4A_RESULT_FROM_BOOL(image->lock != NULL);
     }
 
     if (K4A_FAILED(result))
@@ -152,15 +148,50 @@ k4a_result_t image_create_empty_internal(allocation_source_t source, size_t size
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, source == ALLOCATION_SOURCE_USER);
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, size == 0);
 
-    return image_create_empty_image(source, size, image_handle);
+    return image_create_empty_image(source, size, ALLOCATOR_DEFAULT_ALIGNMENT, image_handle);
 }
 
-k4a_result_t image_create(k4a_image_format_t format,
-                          int width_pixels,
-                          int height_pixels,
-                          int stride_bytes,
-                          allocation_source_t source,
-                          k4a_image_t *image_handle)
+k4a_result_t image_create_empty_from_buffer_internal(uint8_t *buffer,
+                                                     size_t buffer_size,
+                                                     image_destroy_cb_t *buffer_destroy_cb,
+                                                     void *buffer_destroy_cb_context,
+                                                     k4a_image_t *image_handle)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, image_handle == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, buffer == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, buffer_size == 0);
+
+    image_context_t *image = NULL;
+    k4a_result_t result;
+
+    result = K4A_RESULT_FROM_BOOL((image = k4a_image_t_create(image_handle)) != NULL);
+
+    if (K4A_SUCCEEDED(result))
+    {
+        image->ref_count = 1;
+        image->buffer = buffer;
+        image->buffer_size = buffer_size;
+        image->memory_free_cb = buffer_destroy_cb;
+        image->memory_free_cb_context = buffer_destroy_cb_context;
+    }
+
+    // Contract is that if we fail this function, buffer is still valid and that caller needs to free the memory.
+    if (K4A_FAILED(result) && *image_handle)
+    {
+        k4a_image_t_destroy(*image_handle);
+        *image_handle = NULL;
+    }
+
+    return result;
+}
+
+static k4a_result_t image_create_with_alignment(k4a_image_format_t format,
+                                                int width_pixels,
+                                                int height_pixels,
+                                                int stride_bytes,
+                                                size_t alignment,
+                                                allocation_source_t source,
+                                                k4a_image_t *image_handle)
 {
     // User is special and only allowed to be used by the user through a public API.
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, image_handle == NULL);
@@ -333,7 +364,7 @@ k4a_result_t image_create(k4a_image_format_t format,
 
     if (K4A_SUCCEEDED(result))
     {
-        result = TRACE_CALL(image_create_empty_image(source, size, image_handle));
+        result = TRACE_CALL(image_create_empty_image(source, size, alignment, image_handle));
     }
 
     if (K4A_SUCCEEDED(result))
@@ -358,6 +389,133 @@ k4a_result_t image_create(k4a_image_format_t format,
     return result;
 }
 
+k4a_result_t image_create(k4a_image_format_t format,
+                          int width_pixels,
+                          int height_pixels,
+                          int stride_bytes,
+                          allocation_source_t source,
+                          k4a_image_t *image_handle)
+{
+    return image_create_with_alignment(
+        format, width_pixels, height_pixels, stride_bytes, ALLOCATOR_DEFAULT_ALIGNMENT, source, image_handle);
+}
+
+int image_get_bytes_per_pixel(k4a_image_format_t format)
+{
+    switch (format)
+    {
+    case K4A_IMAGE_FORMAT_COLOR_NV12:
+    case K4A_IMAGE_FORMAT_CUSTOM8:
+        return 1;
+    case K4A_IMAGE_FORMAT_DEPTH16:
+    case K4A_IMAGE_FORMAT_IR16:
+    case K4A_IMAGE_FORMAT_CUSTOM16:
+    case K4A_IMAGE_FORMAT_COLOR_YUY2:
+        return 2;
+    case K4A_IMAGE_FORMAT_COLOR_BGRA32:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+k4a_result_t image_create_aligned(k4a_image_format_t format,
+                                  int width_pixels,
+                                  int height_pixels,
+                                  int stride_bytes,
+                                  size_t alignment,
+                                  allocation_source_t source,
+                                  k4a_image_t *image_handle)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, image_handle == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, alignment == 0 || (alignment & (alignment - 1)) != 0);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, alignment > ALLOCATOR_MAX_ALIGNMENT);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, !(width_pixels > 0 && width_pixels < 20000));
+
+    int bytes_per_pixel = image_get_bytes_per_pixel(format);
+    if (stride_bytes == 0 && bytes_per_pixel != 0)
+    {
+        // Pad the minimum stride so that every row starts aligned
+        size_t row_bytes = (size_t)width_pixels * (size_t)bytes_per_pixel;
+        stride_bytes = (int)((row_bytes + alignment - 1) & ~(alignment - 1));
+    }
+
+    return image_create_with_alignment(
+        format, width_pixels, height_pixels, stride_bytes, alignment, source, image_handle);
+}
+
+// Releases the reference a view holds on its parent
+static void image_view_release(void *buffer, void *context)
+{
+    (void)buffer;
+    image_dec_ref((k4a_image_t)context);
+}
+
+k4a_result_t image_create_view(k4a_image_t parent_handle,
+                               int x,
+                               int y,
+                               int width_pixels,
+                               int height_pixels,
+                               k4a_image_t *image_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_image_t, parent_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, image_handle == NULL);
+    image_context_t *parent = k4a_image_t_get_context(parent_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, x < 0 || y < 0 || width_pixels <= 0 || height_pixels <= 0);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED,
+                        width_pixels > parent->width_pixels - x || height_pixels > parent->height_pixels - y);
+
+    *image_handle = NULL;
+
+    // An NV12 view covers the Y plane only, the chroma plane can't follow the crop at a constant stride
+    k4a_image_format_t format = parent->format == K4A_IMAGE_FORMAT_COLOR_NV12 ? K4A_IMAGE_FORMAT_CUSTOM8 :
+                                                                                parent->format;
+    int bytes_per_pixel = image_get_bytes_per_pixel(parent->format);
+    if (bytes_per_pixel == 0)
+    {
+        LOG_ERROR("Views of format %d images are not supported, pixels have no constant size.", parent->format);
+        return K4A_RESULT_FAILED;
+    }
+    if (parent->format == K4A_IMAGE_FORMAT_COLOR_YUY2 && (x % 2 != 0 || width_pixels % 2 != 0))
+    {
+        LOG_ERROR("YUY2 views require an even x (%d) and width (%d), pixel pairs share their chroma.", x, width_pixels);
+        return K4A_RESULT_FAILED;
+    }
+
+    size_t offset = (size_t)y * (size_t)parent->stride_bytes + (size_t)x * (size_t)bytes_per_pixel;
+    size_t size = (size_t)(height_pixels - 1) * (size_t)parent->stride_bytes +
+                  (size_t)width_pixels * (size_t)bytes_per_pixel;
+    if (parent->buffer == NULL || offset + size > parent->buffer_size)
+    {
+        LOG_ERROR("Image buffer of %llu bytes is too small for the view.", (unsigned long long)parent->buffer_size);
+        return K4A_RESULT_FAILED;
+    }
+
+    // The view keeps the parent, and so its buffer, alive
+    image_inc_ref(parent_handle);
+    k4a_result_t result = TRACE_CALL(image_create_from_buffer(format,
+                                                              width_pixels,
+                                                              height_pixels,
+                                                              parent->stride_bytes,
+                                                              parent->buffer + offset,
+                                                              size,
+                                                              image_view_release,
+                                                              parent_handle,
+                                                              image_handle));
+    if (K4A_FAILED(result))
+    {
+        image_dec_ref(parent_handle);
+        return result;
+    }
+
+    image_context_t *image = k4a_image_t_get_context(*image_handle);
+    image->dev_timestamp_usec = parent->dev_timestamp_usec;
+    image->sys_timestamp_nsec = parent->sys_timestamp_nsec;
+    image->exposure_time_usec = parent->exposure_time_usec;
+    image->metadata = parent->metadata;
+    return result;
+}
+
 void image_dec_ref(k4a_image_t image_handle)
 {
     RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, k4a_image_t, image_handle);
@@ -371,7 +529,6 @@ void image_dec_ref(k4a_image_t image_handle)
         {
             image->memory_free_cb(image->buffer, image->memory_free_cb_context);
         }
-        Lock_Deinit(image->lock);
         k4a_image_t_destroy(image_handle);
     }
 }
@@ -471,6 +628,42 @@ uint32_t image_get_iso_speed(k4a_image_t image_handle)
     return image->metadata.color.iso_speed;
 }
 
+k4a_result_t image_get_info(k4a_image_t image_handle, k4a_image_info_t *info)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_image_t, image_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, info == NULL);
+    image_context_t *image = k4a_image_t_get_context(image_handle);
+
+    info->format = image->format;
+    info->width_pixels = image->width_pixels;
+    info->height_pixels = image->height_pixels;
+    info->stride_bytes = image->stride_bytes;
+    info->size = image->buffer_size;
+    info->device_timestamp_usec = image->dev_timestamp_usec;
+    info->system_timestamp_nsec = image->sys_timestamp_nsec;
+    info->exposure_usec = image->exposure_time_usec;
+    info->white_balance = image->metadata.color.white_balance;
+    info->iso_speed = image->metadata.color.iso_speed;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t image_get_view(k4a_image_t image_handle, k4a_image_view_t *view)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_image_t, image_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, view == NULL);
+    image_context_t *image = k4a_image_t_get_context(image_handle);
+
+    view->buffer = image->buffer;
+    view->size = image->buffer_size;
+    view->format = image->format;
+    view->width_pixels = image->width_pixels;
+    view->height_pixels = image->height_pixels;
+    view->stride_bytes = image->stride_bytes;
+    view->device_timestamp_usec = image->dev_timestamp_usec;
+    view->system_timestamp_nsec = image->sys_timestamp_nsec;
+    return K4A_RESULT_SUCCEEDED;
+}
+
 void image_set_device_timestamp_usec(k4a_image_t image_handle, uint64_t timestamp_usec)
 {
     RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, k4a_image_t, image_handle);
@@ -485,37 +678,69 @@ void image_set_system_timestamp_nsec(k4a_image_t image_handle, uint64_t timestam
     image->sys_timestamp_nsec = timestamp_nsec;
 }
 
-k4a_result_t image_apply_system_timestamp(k4a_image_t image_handle)
+uint64_t image_get_stage_timestamp_nsec(k4a_image_t image_handle, k4a_image_stage_t stage)
 {
-    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_image_t, image_handle);
+    RETURN_VALUE_IF_HANDLE_INVALID(0, k4a_image_t, image_handle);
+    RETURN_VALUE_IF_ARG(0, stage < K4A_IMAGE_STAGE_USB_ARRIVAL || stage > K4A_IMAGE_STAGE_USER_POP);
     image_context_t *image = k4a_image_t_get_context(image_handle);
-    k4a_result_t result;
+    if (stage == K4A_IMAGE_STAGE_USB_ARRIVAL)
+    {
+        return image->sys_timestamp_nsec;
+    }
+    return image->stage_timestamp_nsec[stage];
+}
 
-#ifdef _WIN32
-    LARGE_INTEGER qpc = { 0 }, freq = { 0 };
-    result = K4A_RESULT_FROM_BOOL(QueryPerformanceCounter(&qpc) != 0);
-    if (K4A_SUCCEEDED(result))
+void image_set_stage_timestamp_nsec(k4a_image_t image_handle, k4a_image_stage_t stage, uint64_t timestamp_nsec)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, k4a_image_t, image_handle);
+    RETURN_VALUE_IF_ARG(VOID_VALUE, stage < K4A_IMAGE_STAGE_USB_ARRIVAL || stage > K4A_IMAGE_STAGE_USER_POP);
+    image_context_t *image = k4a_image_t_get_context(image_handle);
+    if (stage == K4A_IMAGE_STAGE_USB_ARRIVAL)
+    {
+        image->sys_timestamp_nsec = timestamp_nsec;
+    }
+    else
     {
-        result = K4A_RESULT_FROM_BOOL(QueryPerformanceFrequency(&freq) != 0);
+        image->stage_timestamp_nsec[stage] = timestamp_nsec;
     }
+}
 
-    if (K4A_SUCCEEDED(result))
+uint64_t image_get_system_time_nsec(void)
+{
+    uint64_t time_nsec = 0;
+
+#ifdef _WIN32
+    LARGE_INTEGER qpc = { 0 }, freq = { 0 };
+    if (QueryPerformanceCounter(&qpc) != 0 && QueryPerformanceFrequency(&freq) != 0)
     {
         // Calculate seconds in such a way we minimize overflow.
         // Rollover happens, for a 1MHz Freq, when qpc.QuadPart > 0x003F FFFF FFFF FFFF; ~571 Years after boot.
-        image->sys_timestamp_nsec = qpc.QuadPart / freq.QuadPart * 1000000000;
-        image->sys_timestamp_nsec += qpc.QuadPart % freq.QuadPart * 1000000000 / freq.QuadPart;
+        time_nsec = qpc.QuadPart / freq.QuadPart * 1000000000;
+        time_nsec += qpc.QuadPart % freq.QuadPart * 1000000000 / freq.QuadPart;
     }
 #else
     struct timespec ts_time;
-    result = K4A_RESULT_FROM_BOOL(clock_gettime(CLOCK_MONOTONIC, &ts_time) == 0);
-    if (K4A_SUCCEEDED(result))
+    if (clock_gettime(CLOCK_MONOTONIC, &ts_time) == 0)
     {
         // Rollover happens about ~136 years after boot.
-        image->sys_timestamp_nsec = (uint64_t)ts_time.tv_sec * 1000000000 + (uint64_t)ts_time.tv_nsec;
+        time_nsec = (uint64_t)ts_time.tv_sec * 1000000000 + (uint64_t)ts_time.tv_nsec;
     }
 #endif
 
+    return time_nsec;
+}
+
+k4a_result_t image_apply_system_timestamp(k4a_image_t image_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_image_t, image_handle);
+    image_context_t *image = k4a_image_t_get_context(image_handle);
+
+    uint64_t time_nsec = image_get_system_time_nsec();
+    k4a_result_t result = K4A_RESULT_FROM_BOOL(time_nsec != 0);
+    if (K4A_SUCCEEDED(result))
+    {
+        image->sys_timestamp_nsec = time_nsec;
+    }
     return result;
 }
 
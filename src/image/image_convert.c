@@ -0,0 +1,779 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// This library
+#include <k4ainternal/image.h>
+
+// Dependent libraries
+#include <k4ainternal/common.h>
+#include <k4ainternal/global.h>
+#include <k4ainternal/logging.h>
+#include <libyuv/convert_argb.h>
+#include <libyuv/convert_from_argb.h>
+#include <libyuv/planar_functions.h>
+
+// System dependencies
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__amd64__) || defined(_M_AMD64) || defined(__i386__) || defined(_M_IX86)
+#define K4A_USING_SSE
+#include <emmintrin.h> // SSE2
+#include <immintrin.h> // AVX2, only used by functions built for it and selected at runtime
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define K4A_TARGET_AVX2
+#else
+#include <cpuid.h>
+#define K4A_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define K4A_USING_NEON
+#include <arm_neon.h>
+#endif
+
+#if defined(K4A_USING_SSE)
+typedef struct
+{
+    bool avx2;
+} image_convert_cpu_features_t;
+
+static void image_convert_cpuid(int leaf, int regs[4])
+{
+#if defined(_MSC_VER)
+    __cpuidex(regs, leaf, 0);
+#else
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+    __cpuid_count((unsigned int)leaf, 0, eax, ebx, ecx, edx);
+    regs[0] = (int)eax;
+    regs[1] = (int)ebx;
+    regs[2] = (int)ecx;
+    regs[3] = (int)edx;
+#endif
+}
+
+static void image_convert_cpu_features_init(image_convert_cpu_features_t *features)
+{
+    int regs[4] = { 0 };
+    features->avx2 = false;
+
+    image_convert_cpuid(0, regs);
+    if (regs[0] < 7)
+    {
+        return;
+    }
+
+    // AVX needs OSXSAVE and the OS to save the XMM and YMM registers
+    image_convert_cpuid(1, regs);
+    if ((regs[2] & (1 << 27)) == 0 || (regs[2] & (1 << 28)) == 0)
+    {
+        return;
+    }
+#if defined(_MSC_VER)
+    uint64_t xcr0 = _xgetbv(0);
+#else
+    unsigned int xcr0_eax = 0, xcr0_edx = 0;
+    __asm__ __volatile__("xgetbv" : "=a"(xcr0_eax), "=d"(xcr0_edx) : "c"(0));
+    uint64_t xcr0 = ((uint64_t)xcr0_edx << 32) | xcr0_eax;
+#endif
+    if ((xcr0 & 0x6) != 0x6)
+    {
+        return;
+    }
+
+    image_convert_cpuid(7, regs);
+    features->avx2 = (regs[1] & (1 << 5)) != 0;
+}
+
+K4A_DECLARE_GLOBAL(image_convert_cpu_features_t, image_convert_cpu_features_init);
+#endif
+
+// Range normalization of 16 bit pixels, out = (clamp(in, min, max) - min) * scale + 0.5, truncated
+typedef struct
+{
+    float min_value;
+    float max_value;
+    float scale;
+} image_convert_range_t;
+
+static void image_convert_row_u16_to_float_c(const uint16_t *source, float *output, int count, float scale)
+{
+    for (int i = 0; i < count; i++)
+    {
+        output[i] = (float)source[i] * scale;
+    }
+}
+
+static void image_convert_row_u16_to_u8_c(const uint16_t *source,
+                                          uint8_t *output,
+                                          int count,
+                                          const image_convert_range_t *range)
+{
+    for (int i = 0; i < count; i++)
+    {
+        float value = MIN(MAX((float)source[i], range->min_value), range->max_value);
+        output[i] = (uint8_t)((value - range->min_value) * range->scale + 0.5f);
+    }
+}
+
+static void image_convert_row_u8_to_bgra_c(const uint8_t *source, uint8_t *bgra, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        bgra[4 * i + 0] = source[i];
+        bgra[4 * i + 1] = source[i];
+        bgra[4 * i + 2] = source[i];
+        bgra[4 * i + 3] = 0xFF;
+    }
+}
+
+#if defined(K4A_USING_SSE)
+static K4A_TARGET_AVX2 int image_convert_row_u16_to_float_avx2(const uint16_t *source,
+                                                               float *output,
+                                                               int count,
+                                                               float scale)
+{
+    const __m256 scale_ps = _mm256_set1_ps(scale);
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i value = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(source + i)));
+        _mm256_storeu_ps(output + i, _mm256_mul_ps(_mm256_cvtepi32_ps(value), scale_ps));
+    }
+    return i;
+}
+
+static K4A_TARGET_AVX2 __m256i image_convert_u16_to_u8_avx2(__m128i source, const image_convert_range_t *range)
+{
+    __m256 value = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(source));
+    value = _mm256_min_ps(_mm256_max_ps(value, _mm256_set1_ps(range->min_value)), _mm256_set1_ps(range->max_value));
+    value = _mm256_mul_ps(_mm256_sub_ps(value, _mm256_set1_ps(range->min_value)), _mm256_set1_ps(range->scale));
+    return _mm256_cvttps_epi32(_mm256_add_ps(value, _mm256_set1_ps(0.5f)));
+}
+
+static K4A_TARGET_AVX2 int image_convert_row_u16_to_u8_avx2(const uint16_t *source,
+                                                            uint8_t *output,
+                                                            int count,
+                                                            const image_convert_range_t *range)
+{
+    int i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        __m256i low = image_convert_u16_to_u8_avx2(_mm_loadu_si128((const __m128i *)(source + i)), range);
+        __m256i high = image_convert_u16_to_u8_avx2(_mm_loadu_si128((const __m128i *)(source + i + 8)), range);
+
+        // The values are within [0, 255], pack the lanes back in order
+        __m128i low16 = _mm_packs_epi32(_mm256_castsi256_si128(low), _mm256_extracti128_si256(low, 1));
+        __m128i high16 = _mm_packs_epi32(_mm256_castsi256_si128(high), _mm256_extracti128_si256(high, 1));
+        _mm_storeu_si128((__m128i *)(output + i), _mm_packus_epi16(low16, high16));
+    }
+    return i;
+}
+
+static int image_convert_row_u16_to_float_sse(const uint16_t *source, float *output, int count, float scale)
+{
+    const __m128 scale_ps = _mm_set1_ps(scale);
+    const __m128i zero = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i value = _mm_loadu_si128((const __m128i *)(source + i));
+        __m128 low = _mm_cvtepi32_ps(_mm_unpacklo_epi16(value, zero));
+        __m128 high = _mm_cvtepi32_ps(_mm_unpackhi_epi16(value, zero));
+        _mm_storeu_ps(output + i, _mm_mul_ps(low, scale_ps));
+        _mm_storeu_ps(output + i + 4, _mm_mul_ps(high, scale_ps));
+    }
+    return i;
+}
+
+static __m128i image_convert_u16_to_u8_sse(__m128i source, const image_convert_range_t *range)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 min_ps = _mm_set1_ps(range->min_value);
+    const __m128 max_ps = _mm_set1_ps(range->max_value);
+    const __m128 scale_ps = _mm_set1_ps(range->scale);
+    const __m128 half_ps = _mm_set1_ps(0.5f);
+
+    __m128 low = _mm_cvtepi32_ps(_mm_unpacklo_epi16(source, zero));
+    __m128 high = _mm_cvtepi32_ps(_mm_unpackhi_epi16(source, zero));
+    low = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(_mm_min_ps(_mm_max_ps(low, min_ps), max_ps), min_ps), scale_ps), half_ps);
+    high = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(_mm_min_ps(_mm_max_ps(high, min_ps), max_ps), min_ps), scale_ps), half_ps);
+    return _mm_packs_epi32(_mm_cvttps_epi32(low), _mm_cvttps_epi32(high));
+}
+
+static int image_convert_row_u16_to_u8_sse(const uint16_t *source,
+                                           uint8_t *output,
+                                           int count,
+                                           const image_convert_range_t *range)
+{
+    int i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i low = image_convert_u16_to_u8_sse(_mm_loadu_si128((const __m128i *)(source + i)), range);
+        __m128i high = image_convert_u16_to_u8_sse(_mm_loadu_si128((const __m128i *)(source + i + 8)), range);
+        _mm_storeu_si128((__m128i *)(output + i), _mm_packus_epi16(low, high));
+    }
+    return i;
+}
+
+static int image_convert_row_u8_to_bgra_sse(const uint8_t *source, uint8_t *bgra, int count)
+{
+    const __m128i alpha = _mm_set1_epi32((int)0xFF000000);
+    int i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i value = _mm_loadu_si128((const __m128i *)(source + i));
+        __m128i low = _mm_unpacklo_epi8(value, value);
+        __m128i high = _mm_unpackhi_epi8(value, value);
+        _mm_storeu_si128((__m128i *)(bgra + 4 * i), _mm_or_si128(_mm_unpacklo_epi16(low, low), alpha));
+        _mm_storeu_si128((__m128i *)(bgra + 4 * i + 16), _mm_or_si128(_mm_unpackhi_epi16(low, low), alpha));
+        _mm_storeu_si128((__m128i *)(bgra + 4 * i + 32), _mm_or_si128(_mm_unpacklo_epi16(high, high), alpha));
+        _mm_storeu_si128((__m128i *)(bgra + 4 * i + 48), _mm_or_si128(_mm_unpackhi_epi16(high, high), alpha));
+    }
+    return i;
+}
+#elif defined(K4A_USING_NEON)
+static int image_convert_row_u16_to_float_neon(const uint16_t *source, float *output, int count, float scale)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        uint16x8_t value = vld1q_u16(source + i);
+        vst1q_f32(output + i, vmulq_n_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(value))), scale));
+        vst1q_f32(output + i + 4, vmulq_n_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(value))), scale));
+    }
+    return i;
+}
+
+static uint16x4_t image_convert_u16_to_u8_neon(uint16x4_t source, const image_convert_range_t *range)
+{
+    float32x4_t value = vcvtq_f32_u32(vmovl_u16(source));
+    value = vminq_f32(vmaxq_f32(value, vdupq_n_f32(range->min_value)), vdupq_n_f32(range->max_value));
+    value = vmulq_n_f32(vsubq_f32(value, vdupq_n_f32(range->min_value)), range->scale);
+
+    // The conversion from float rounds toward zero, like the cast in the scalar code
+    return vmovn_u32(vcvtq_u32_f32(vaddq_f32(value, vdupq_n_f32(0.5f))));
+}
+
+static int image_convert_row_u16_to_u8_neon(const uint16_t *source,
+                                            uint8_t *output,
+                                            int count,
+                                            const image_convert_range_t *range)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        uint16x8_t value = vld1q_u16(source + i);
+        uint16x4_t low = image_convert_u16_to_u8_neon(vget_low_u16(value), range);
+        uint16x4_t high = image_convert_u16_to_u8_neon(vget_high_u16(value), range);
+        vst1_u8(output + i, vqmovn_u16(vcombine_u16(low, high)));
+    }
+    return i;
+}
+
+static int image_convert_row_u8_to_bgra_neon(const uint8_t *source, uint8_t *bgra, int count)
+{
+    int i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        uint8x16x4_t pixels;
+        pixels.val[0] = vld1q_u8(source + i);
+        pixels.val[1] = pixels.val[0];
+        pixels.val[2] = pixels.val[0];
+        pixels.val[3] = vdupq_n_u8(0xFF);
+        vst4q_u8(bgra + 4 * i, pixels);
+    }
+    return i;
+}
+#endif
+
+// The row functions convert the pixels the widest supported kernel can, then finish the row in C
+static void image_convert_row_u16_to_float(const uint16_t *source, float *output, int count, float scale)
+{
+    int done = 0;
+#if defined(K4A_USING_SSE)
+    if (image_convert_cpu_features_t_get()->avx2)
+    {
+        done = image_convert_row_u16_to_float_avx2(source, output, count, scale);
+    }
+    else
+    {
+        done = image_convert_row_u16_to_float_sse(source, output, count, scale);
+    }
+#elif defined(K4A_USING_NEON)
+    done = image_convert_row_u16_to_float_neon(source, output, count, scale);
+#endif
+    image_convert_row_u16_to_float_c(source + done, output + done, count - done, scale);
+}
+
+static void image_convert_row_u16_to_u8(const uint16_t *source,
+                                        uint8_t *output,
+                                        int count,
+                                        const image_convert_range_t *range)
+{
+    int done = 0;
+#if defined(K4A_USING_SSE)
+    if (image_convert_cpu_features_t_get()->avx2)
+    {
+        done = image_convert_row_u16_to_u8_avx2(source, output, count, range);
+    }
+    else
+    {
+        done = image_convert_row_u16_to_u8_sse(source, output, count, range);
+    }
+#elif defined(K4A_USING_NEON)
+    done = image_convert_row_u16_to_u8_neon(source, output, count, range);
+#endif
+    image_convert_row_u16_to_u8_c(source + done, output + done, count - done, range);
+}
+
+static void image_convert_row_u8_to_bgra(const uint8_t *source, uint8_t *bgra, int count)
+{
+    int done = 0;
+#if defined(K4A_USING_SSE)
+    done = image_convert_row_u8_to_bgra_sse(source, bgra, count);
+#elif defined(K4A_USING_NEON)
+    done = image_convert_row_u8_to_bgra_neon(source, bgra, count);
+#endif
+    image_convert_row_u8_to_bgra_c(source + done, bgra + 4 * done, count - done);
+}
+
+static void image_convert_copy_metadata(k4a_image_t source_image, k4a_image_t output_image)
+{
+    image_set_device_timestamp_usec(output_image, image_get_device_timestamp_usec(source_image));
+    image_set_system_timestamp_nsec(output_image, image_get_system_timestamp_nsec(source_image));
+    for (int stage = K4A_IMAGE_STAGE_DEPTH_ENGINE_DONE; stage <= K4A_IMAGE_STAGE_USER_POP; stage++)
+    {
+        image_set_stage_timestamp_nsec(output_image,
+                                       (k4a_image_stage_t)stage,
+                                       image_get_stage_timestamp_nsec(source_image, (k4a_image_stage_t)stage));
+    }
+    image_set_exposure_usec(output_image, image_get_exposure_usec(source_image));
+    image_set_white_balance(output_image, image_get_white_balance(source_image));
+    image_set_iso_speed(output_image, image_get_iso_speed(source_image));
+}
+
+// Validates an output image of the source's size with rows of at least bytes_per_pixel * width
+static k4a_result_t image_convert_check_output(k4a_image_t source_image,
+                                               k4a_image_t output_image,
+                                               k4a_image_format_t output_format,
+                                               int bytes_per_pixel)
+{
+    // The image accessors validate the handles, they return a NULL buffer for invalid ones
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, image_get_buffer(source_image) == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, image_get_buffer(output_image) == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, image_get_format(output_image) != output_format);
+
+    int width = image_get_width_pixels(source_image);
+    int height = image_get_height_pixels(source_image);
+    if (image_get_width_pixels(output_image) != width || image_get_height_pixels(output_image) != height)
+    {
+        LOG_ERROR("The output image is %dx%d but the source image is %dx%d",
+                  image_get_width_pixels(output_image),
+                  image_get_height_pixels(output_image),
+                  width,
+                  height);
+        return K4A_RESULT_FAILED;
+    }
+
+    int stride = image_get_stride_bytes(output_image);
+    size_t size = (size_t)stride * (size_t)height;
+    if (output_format == K4A_IMAGE_FORMAT_COLOR_NV12)
+    {
+        size += (size_t)stride * (size_t)((height + 1) / 2);
+    }
+    if (stride < width * bytes_per_pixel || image_get_size(output_image) < size)
+    {
+        LOG_ERROR("The output image buffer is too small for %dx%d pixels", width, height);
+        return K4A_RESULT_FAILED;
+    }
+    return K4A_RESULT_SUCCEEDED;
+}
+
+// Validates a DEPTH16, IR16 or CUSTOM16 source image
+static k4a_result_t image_convert_check_u16_source(k4a_image_t source_image)
+{
+    k4a_image_format_t format = image_get_format(source_image);
+    if (format != K4A_IMAGE_FORMAT_DEPTH16 && format != K4A_IMAGE_FORMAT_IR16 && format != K4A_IMAGE_FORMAT_CUSTOM16)
+    {
+        LOG_ERROR("Images of format %d are not 16 bit single channel images", format);
+        return K4A_RESULT_FAILED;
+    }
+
+    int width = image_get_width_pixels(source_image);
+    int height = image_get_height_pixels(source_image);
+    int stride = image_get_stride_bytes(source_image);
+    if (stride < width * 2 || stride % 2 != 0 || image_get_size(source_image) < (size_t)stride * (size_t)height)
+    {
+        LOG_ERROR("The source image buffer is too small for %dx%d pixels", width, height);
+        return K4A_RESULT_FAILED;
+    }
+    return K4A_RESULT_SUCCEEDED;
+}
+
+static k4a_result_t image_convert_init_range(uint16_t min_value, uint16_t max_value, image_convert_range_t *range)
+{
+    if (min_value >= max_value)
+    {
+        LOG_ERROR("The range [%u, %u] is empty", min_value, max_value);
+        return K4A_RESULT_FAILED;
+    }
+    range->min_value = (float)min_value;
+    range->max_value = (float)max_value;
+    range->scale = 255.f / (float)(max_value - min_value);
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t image_convert_to_bgra32(k4a_image_t source_image, k4a_image_t bgra_image)
+{
+    // The image accessors validate the handles, they return a NULL buffer for invalid ones
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, image_get_buffer(source_image) == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, image_get_buffer(bgra_image) == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, image_get_format(bgra_image) != K4A_IMAGE_FORMAT_COLOR_BGRA32);
+
+    int width = image_get_width_pixels(source_image);
+    int height = image_get_height_pixels(source_image);
+    int source_stride = image_get_stride_bytes(source_image);
+    int bgra_stride = image_get_stride_bytes(bgra_image);
+    const uint8_t *source = image_get_buffer(source_image);
+    uint8_t *bgra = image_get_buffer(bgra_image);
+
+    if (image_get_width_pixels(bgra_image) != width || image_get_height_pixels(bgra_image) != height)
+    {
+        LOG_ERROR("The BGRA32 image is %dx%d but the source image is %dx%d",
+                  image_get_width_pixels(bgra_image),
+                  image_get_height_pixels(bgra_image),
+                  width,
+                  height);
+        return K4A_RESULT_FAILED;
+    }
+
+    if (bgra_stride < width * 4 || image_get_size(bgra_image) < (size_t)bgra_stride * (size_t)height)
+    {
+        LOG_ERROR("The BGRA32 image buffer is too small for %dx%d pixels", width, height);
+        return K4A_RESULT_FAILED;
+    }
+
+    k4a_image_format_t format = image_get_format(source_image);
+    size_t source_size = (size_t)source_stride * (size_t)height;
+    if (format == K4A_IMAGE_FORMAT_COLOR_NV12)
+    {
+        // The interleaved UV plane follows the luminance plane, at the same stride and half the lines
+        source_size += (size_t)source_stride * (size_t)((height + 1) / 2);
+    }
+    if (image_get_size(source_image) < source_size)
+    {
+        LOG_ERROR("The source image buffer is %zu bytes, %zu are needed", image_get_size(source_image), source_size);
+        return K4A_RESULT_FAILED;
+    }
+
+    // The endianness of libyuv's ARGB is opposite our BGRA format. They are the same byte order.
+    int status = -1;
+    switch (format)
+    {
+    case K4A_IMAGE_FORMAT_COLOR_NV12:
+        status = NV12ToARGB(source,
+                            source_stride,
+                            source + (size_t)source_stride * (size_t)height,
+                            source_stride,
+                            bgra,
+                            bgra_stride,
+                            width,
+                            height);
+        break;
+    case K4A_IMAGE_FORMAT_COLOR_YUY2:
+        status = YUY2ToARGB(source, source_stride, bgra, bgra_stride, width, height);
+        break;
+    case K4A_IMAGE_FORMAT_COLOR_BGRA32:
+        status = ARGBCopy(source, source_stride, bgra, bgra_stride, width, height);
+        break;
+    default:
+        LOG_ERROR("Images of format %d can not be converted to BGRA32", format);
+        return K4A_RESULT_FAILED;
+    }
+
+    if (status != 0)
+    {
+        LOG_ERROR("Failed to convert a %dx%d image of format %d to BGRA32", width, height, format);
+        return K4A_RESULT_FAILED;
+    }
+
+    image_convert_copy_metadata(source_image, bgra_image);
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t image_convert_from_bgra32(k4a_image_t bgra_image, k4a_image_t output_image)
+{
+    // The image accessors validate the handles, they return a NULL buffer for invalid ones
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, image_get_format(bgra_image) != K4A_IMAGE_FORMAT_COLOR_BGRA32);
+    k4a_image_format_t format = image_get_format(output_image);
+    if (format != K4A_IMAGE_FORMAT_COLOR_NV12 && format != K4A_IMAGE_FORMAT_COLOR_YUY2)
+    {
+        LOG_ERROR("BGRA32 images can not be converted to images of format %d", format);
+        return K4A_RESULT_FAILED;
+    }
+    if (K4A_FAILED(TRACE_CALL(image_convert_check_output(bgra_image,
+                                                         output_image,
+                                                         format,
+                                                         format == K4A_IMAGE_FORMAT_COLOR_NV12 ? 1 : 2))))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    int width = image_get_width_pixels(bgra_image);
+    int height = image_get_height_pixels(bgra_image);
+    int bgra_stride = image_get_stride_bytes(bgra_image);
+    int output_stride = image_get_stride_bytes(output_image);
+    const uint8_t *bgra = image_get_buffer(bgra_image);
+    uint8_t *output = image_get_buffer(output_image);
+    if (bgra_stride < width * 4 || image_get_size(bgra_image) < (size_t)bgra_stride * (size_t)height)
+    {
+        LOG_ERROR("The BGRA32 image buffer is too small for %dx%d pixels", width, height);
+        return K4A_RESULT_FAILED;
+    }
+
+    int status = -1;
+    if (format == K4A_IMAGE_FORMAT_COLOR_NV12)
+    {
+        status = ARGBToNV12(bgra,
+                            bgra_stride,
+                            output,
+                            output_stride,
+                            output + (size_t)output_stride * (size_t)height,
+                            output_stride,
+                            width,
+                            height);
+    }
+    else
+    {
+        status = ARGBToYUY2(bgra, bgra_stride, output, output_stride, width, height);
+    }
+
+    if (status != 0)
+    {
+        LOG_ERROR("Failed to convert a %dx%d BGRA32 image to format %d", width, height, format);
+        return K4A_RESULT_FAILED;
+    }
+
+    image_convert_copy_metadata(bgra_image, output_image);
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t image_convert_to_grayscale(k4a_image_t color_image, k4a_image_t custom8_image)
+{
+    if (K4A_FAILED(TRACE_CALL(image_convert_check_output(color_image, custom8_image, K4A_IMAGE_FORMAT_CUSTOM8, 1))))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    int width = image_get_width_pixels(color_image);
+    int height = image_get_height_pixels(color_image);
+    int color_stride = image_get_stride_bytes(color_image);
+    int custom8_stride = image_get_stride_bytes(custom8_image);
+    const uint8_t *color = image_get_buffer(color_image);
+    uint8_t *custom8 = image_get_buffer(custom8_image);
+    if (image_get_size(color_image) < (size_t)color_stride * (size_t)height)
+    {
+        LOG_ERROR("The source image buffer is too small for %dx%d pixels", width, height);
+        return K4A_RESULT_FAILED;
+    }
+
+    // Every format gives the limited range BT.601 luminance the camera's NV12 and YUY2 streams carry
+    int status = -1;
+    k4a_image_format_t format = image_get_format(color_image);
+    switch (format)
+    {
+    case K4A_IMAGE_FORMAT_COLOR_NV12:
+        CopyPlane(color, color_stride, custom8, custom8_stride, width, height);
+        status = 0;
+        break;
+    case K4A_IMAGE_FORMAT_COLOR_YUY2:
+        status = YUY2ToY(color, color_stride, custom8, custom8_stride, width, height);
+        break;
+    case K4A_IMAGE_FORMAT_COLOR_BGRA32:
+        status = ARGBToI400(color, color_stride, custom8, custom8_stride, width, height);
+        break;
+    default:
+        LOG_ERROR("Images of format %d can not be converted to grayscale", format);
+        return K4A_RESULT_FAILED;
+    }
+
+    if (status != 0)
+    {
+        LOG_ERROR("Failed to convert a %dx%d image of format %d to grayscale", width, height, format);
+        return K4A_RESULT_FAILED;
+    }
+
+    image_convert_copy_metadata(color_image, custom8_image);
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t image_convert_to_float(k4a_image_t source_image, float scale, k4a_image_t float_image)
+{
+    if (K4A_FAILED(TRACE_CALL(image_convert_check_output(source_image, float_image, K4A_IMAGE_FORMAT_CUSTOM, 4))) ||
+        K4A_FAILED(TRACE_CALL(image_convert_check_u16_source(source_image))))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    int width = image_get_width_pixels(source_image);
+    int height = image_get_height_pixels(source_image);
+    size_t source_stride = (size_t)image_get_stride_bytes(source_image);
+    size_t float_stride = (size_t)image_get_stride_bytes(float_image);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, float_stride % sizeof(float) != 0);
+    const uint8_t *source = image_get_buffer(source_image);
+    uint8_t *output = image_get_buffer(float_image);
+
+    for (int row = 0; row < height; row++)
+    {
+        image_convert_row_u16_to_float((const uint16_t *)(const void *)(source + row * source_stride),
+                                       (float *)(void *)(output + row * float_stride),
+                                       width,
+                                       scale);
+    }
+
+    image_convert_copy_metadata(source_image, float_image);
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t image_convert_to_custom8(k4a_image_t source_image,
+                                      uint16_t min_value,
+                                      uint16_t max_value,
+                                      k4a_image_t custom8_image)
+{
+    image_convert_range_t range;
+    if (K4A_FAILED(TRACE_CALL(image_convert_check_output(source_image, custom8_image, K4A_IMAGE_FORMAT_CUSTOM8, 1))) ||
+        K4A_FAILED(TRACE_CALL(image_convert_check_u16_source(source_image))) ||
+        K4A_FAILED(TRACE_CALL(image_convert_init_range(min_value, max_value, &range))))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    int width = image_get_width_pixels(source_image);
+    int height = image_get_height_pixels(source_image);
+    size_t source_stride = (size_t)image_get_stride_bytes(source_image);
+    size_t custom8_stride = (size_t)image_get_stride_bytes(custom8_image);
+    const uint8_t *source = image_get_buffer(source_image);
+    uint8_t *output = image_get_buffer(custom8_image);
+
+    for (int row = 0; row < height; row++)
+    {
+        image_convert_row_u16_to_u8((const uint16_t *)(const void *)(source + row * source_stride),
+                                    output + row * custom8_stride,
+                                    width,
+                                    &range);
+    }
+
+    image_convert_copy_metadata(source_image, custom8_image);
+    return K4A_RESULT_SUCCEEDED;
+}
+
+// Blue at hue 2/3 to red at hue 0, with full saturation and value
+static void image_convert_blue_to_red(float normalized, uint8_t bgra[4])
+{
+    // Six sectors of the hue circle, the ramp uses the four from blue back to red
+    float hue = (2.f / 3.f - normalized * (2.f / 3.f)) * 6.f;
+    int sector = (int)hue;
+    float fraction = hue - (float)sector;
+    float red = 0.f, green = 0.f, blue = 0.f;
+    switch (sector)
+    {
+    case 0:
+        red = 1.f;
+        green = fraction;
+        break;
+    case 1:
+        red = 1.f - fraction;
+        green = 1.f;
+        break;
+    case 2:
+        green = 1.f;
+        blue = fraction;
+        break;
+    case 3:
+        green = 1.f - fraction;
+        blue = 1.f;
+        break;
+    default:
+        red = fraction;
+        blue = 1.f;
+        break;
+    }
+    bgra[0] = (uint8_t)(blue * 255.f);
+    bgra[1] = (uint8_t)(green * 255.f);
+    bgra[2] = (uint8_t)(red * 255.f);
+    bgra[3] = 0xFF;
+}
+
+k4a_result_t image_colorize(k4a_image_t source_image,
+                            uint16_t min_value,
+                            uint16_t max_value,
+                            k4a_colormap_t colormap,
+                            k4a_image_t bgra_image)
+{
+    image_convert_range_t range;
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED,
+                        colormap != K4A_COLORMAP_GREYSCALE && colormap != K4A_COLORMAP_BLUE_TO_RED);
+    if (K4A_FAILED(
+            TRACE_CALL(image_convert_check_output(source_image, bgra_image, K4A_IMAGE_FORMAT_COLOR_BGRA32, 4))) ||
+        K4A_FAILED(TRACE_CALL(image_convert_check_u16_source(source_image))) ||
+        K4A_FAILED(TRACE_CALL(image_convert_init_range(min_value, max_value, &range))))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    int width = image_get_width_pixels(source_image);
+    int height = image_get_height_pixels(source_image);
+    size_t source_stride = (size_t)image_get_stride_bytes(source_image);
+    size_t bgra_stride = (size_t)image_get_stride_bytes(bgra_image);
+    const uint8_t *source = image_get_buffer(source_image);
+    uint8_t *bgra = image_get_buffer(bgra_image);
+
+    if (colormap == K4A_COLORMAP_GREYSCALE)
+    {
+        // Normalize a row to 8 bits, then expand it in place from the end of the output row
+        for (int row = 0; row < height; row++)
+        {
+            uint8_t *bgra_row = bgra + row * bgra_stride;
+            uint8_t *grey_row = bgra_row + 3 * (size_t)width;
+            image_convert_row_u16_to_u8((const uint16_t *)(const void *)(source + row * source_stride),
+                                        grey_row,
+                                        width,
+                                        &range);
+            image_convert_row_u8_to_bgra(grey_row, bgra_row, width);
+        }
+    }
+    else
+    {
+        // A table of every value in the range, the hue conversion is too slow to run for every pixel
+        size_t entries = (size_t)(max_value - min_value) + 1;
+        uint32_t *table = (uint32_t *)malloc(entries * sizeof(uint32_t));
+        if (table == NULL)
+        {
+            LOG_ERROR("Failed to allocate a colormap of %zu entries", entries);
+            return K4A_RESULT_FAILED;
+        }
+        for (size_t i = 0; i < entries; i++)
+        {
+            uint8_t color[4];
+            image_convert_blue_to_red((float)i / (float)(entries - 1), color);
+            memcpy(&table[i], color, sizeof(color));
+        }
+
+        const uint32_t black = 0xFF000000;
+        for (int row = 0; row < height; row++)
+        {
+            const uint16_t *source_row = (const uint16_t *)(const void *)(source + row * source_stride);
+            uint32_t *bgra_row = (uint32_t *)(void *)(bgra + row * bgra_stride);
+            for (int i = 0; i < width; i++)
+            {
+                uint16_t value = MIN(MAX(source_row[i], min_value), max_value);
+                bgra_row[i] = source_row[i] == 0 ? black : table[value - min_value];
+            }
+        }
+        free(table);
+    }
+
+    image_convert_copy_metadata(source_image, bgra_image);
+    return K4A_RESULT_SUCCEEDED;
+}
@@ -4,13 +4,16 @@
 //************************ Includes *****************************
 // This library
 #include <k4ainternal/imu.h>
+#include <k4ainternal/imu_preintegration.h>
 
 // Dependent libraries
 #include <k4ainternal/common.h>
 #include <k4ainternal/logging.h>
+#include <k4ainternal/atomic.h>
 #include <k4ainternal/math.h>
 #include <k4ainternal/queue.h>
 #include <k4ainternal/calibration.h>
+#include <azure_c_shared_utility/envvariable.h>
 
 // System dependencies
 #include <stdlib.h>
@@ -39,6 +42,18 @@ extern "C" {
 // IMU start.
 #define MAX_IMU_TIME_STAMP_MS 1500
 
+// Number of samples buffered for the application, K4A_IMU_QUEUE_DEPTH overrides it.
+#define IMU_QUEUE_DEPTH QUEUE_CALC_DEPTH(K4A_IMU_SAMPLE_RATE, QUEUE_DEFAULT_DEPTH_USEC)
+
+// Samples calibrated together, more than a packet holds so a packet is usually calibrated at once
+#define IMU_CALIBRATION_BATCH_SIZE 16
+
+// The temperature dependent bias and mixing matrices are refreshed when the temperature changes more than this
+#define IMU_CALIBRATION_TEMPERATURE_THRESHOLD 0.25f
+
+// Samples of motion history kept by the preintegration, so queries can start up to 2 seconds back
+#define IMU_PREINTEGRATION_DEPTH (K4A_IMU_SAMPLE_RATE * 2)
+
 //************************ Typedefs *****************************
 
 // parameters used to compute the calibrated IMU
@@ -54,9 +69,10 @@ typedef struct _imu_context_t
 {
     TICK_COUNTER_HANDLE tick;
     colormcu_t color_mcu;
-    queue_t queue;
+    sample_queue_t queue;
     uint32_t dropped_count;
     float temperature;
+    volatile uint64_t sample_count; // Samples delivered since imu_create(), see imu_get_statistics()
 
     k4a_calibration_imu_t gyro_calibration;
     k4a_calibration_imu_t accel_calibration;
@@ -64,6 +80,17 @@ typedef struct _imu_context_t
 
     bool running;
     bool wait_for_ts_reset;
+
+    // Called with each sample in place of pushing it to queue, only changed while stopped
+    k4a_imu_sample_ready_cb_t *callback;
+    void *callback_context;
+
+    // Integrates the calibrated samples when enabled with imu_set_preintegration(), only changed while stopped
+    imu_preintegration_t *preintegration;
+
+    // Called with each batch of calibrated samples before they are delivered, only changed while stopped
+    imu_sample_listener_t *listener;
+    void *listener_context;
 } imu_context_t;
 
 //************ Declarations (Statics and globals) ***************
@@ -71,6 +98,8 @@ K4A_DECLARE_CONTEXT(imu_t, imu_context_t);
 
 //******************* Function Prototypes ***********************
 usb_cmd_stream_cb_t imu_capture_ready;
+static void imu_refresh_calibration(imu_context_t *p_imu, float temperature);
+static void imu_deliver_samples(imu_context_t *p_imu, k4a_imu_sample_t *samples, size_t count);
 
 //*********************** Functions *****************************
 /**
@@ -104,7 +133,7 @@ void imu_capture_ready(k4a_result_t result, k4a_image_t image, void *p_context)
     {
         LOG_WARNING("A streaming IMU transfer failed", 0);
         // Stop the queue - this will notify users waiting for data.
-        queue_stop(p_imu->queue);
+        sample_queue_stop(p_imu->queue);
     }
 
     if (K4A_SUCCEEDED(result))
@@ -114,7 +143,7 @@ void imu_capture_ready(k4a_result_t result, k4a_image_t image, void *p_context)
 
     if (K4A_SUCCEEDED(result))
     {
-        // Take apart the capture packet data and create captures for each sample
+        // Take apart the capture packet data and queue each sample
         p_packet = image_get_buffer(image);
         capture_size = image_get_size(image);
 
@@ -162,6 +191,13 @@ void imu_capture_ready(k4a_result_t result, k4a_image_t image, void *p_context)
                         p_metadata->gyro.sample_count);
         }
 
+        // The samples of a packet share its temperature, the calibration is refreshed once for all of them
+        float temperature = ((float)(p_metadata->temperature.value) / IMU_TEMPERATURE_DIVISOR) +
+                            IMU_TEMPERATURE_CONSTANT;
+        imu_refresh_calibration(p_imu, temperature);
+
+        k4a_imu_sample_t samples[IMU_CALIBRATION_BATCH_SIZE];
+        size_t batch_count = 0;
         for (uint32_t i = 0; i < p_metadata->gyro.sample_count && i < p_metadata->accel.sample_count; i++)
         {
             result = K4A_RESULT_SUCCEEDED;
@@ -188,20 +224,10 @@ void imu_capture_ready(k4a_result_t result, k4a_image_t image, void *p_context)
                 }
             }
 
-            k4a_capture_t imu_capture = NULL;
-            k4a_image_t imu_image = NULL;
-
-            if (K4A_SUCCEEDED(result))
-            {
-                result = TRACE_CALL(
-                    image_create_empty_internal(ALLOCATION_SOURCE_IMU, sizeof(k4a_imu_sample_t), &imu_image));
-            }
-
             if (K4A_SUCCEEDED(result))
             {
                 k4a_imu_sample_t sample = { 0 };
-                sample.temperature = ((float)(p_metadata->temperature.value) / IMU_TEMPERATURE_DIVISOR) +
-                                     IMU_TEMPERATURE_CONSTANT;
+                sample.temperature = temperature;
                 sample.gyro_sample.xyz.x = (float)p_gyro_data[i].rx * p_metadata->gyro.sensitivity *
                                            IMU_RADIANS_PER_DEGREES / IMU_SCALE_NORMALIZATION;
                 sample.gyro_sample.xyz.y = (float)p_gyro_data[i].ry * p_metadata->gyro.sensitivity *
@@ -217,30 +243,18 @@ void imu_capture_ready(k4a_result_t result, k4a_image_t image, void *p_context)
                                           IMU_GRAVITATIONAL_CONSTANT / IMU_SCALE_NORMALIZATION;
                 sample.acc_timestamp_usec = K4A_90K_HZ_TICK_TO_USEC(p_accel_data[i].pts);
 
-                memcpy(image_get_buffer(imu_image), &sample, sizeof(k4a_imu_sample_t));
-            }
-
-            if (K4A_SUCCEEDED(result))
-            {
-                result = TRACE_CALL(capture_create(&imu_capture));
-            }
-
-            if (K4A_SUCCEEDED(result))
-            {
-                capture_set_imu_image(imu_capture, imu_image);
-                queue_push(p_imu->queue, imu_capture);
+                samples[batch_count++] = sample;
+                if (batch_count == IMU_CALIBRATION_BATCH_SIZE)
+                {
+                    imu_deliver_samples(p_imu, samples, batch_count);
+                    batch_count = 0;
+                }
             }
+        }
 
-            if (imu_image)
-            {
-                // remove local ref on image
-                image_dec_ref(imu_image);
-            }
-            if (imu_capture)
-            {
-                // remove local ref on capture
-                capture_dec_ref(imu_capture); // release our interest in the new capture
-            }
+        if (batch_count > 0)
+        {
+            imu_deliver_samples(p_imu, samples, batch_count);
         }
     }
 }
@@ -346,10 +360,23 @@ imu_create(TICK_COUNTER_HANDLE tick_handle, colormcu_t color_mcu, calibration_t
     p_imu->tick = tick_handle;
     p_imu->temperature = 0;
 
-    // Create allocator handle
+    // Samples are copied into storage allocated here, so streaming does not allocate per sample
+    uint32_t queue_depth = IMU_QUEUE_DEPTH;
+    const char *env_queue_depth = environment_get_variable("K4A_IMU_QUEUE_DEPTH");
+    if (env_queue_depth != NULL && env_queue_depth[0] != '\0')
+    {
+        long depth = strtol(env_queue_depth, NULL, 10);
+        if (depth > 0)
+        {
+            queue_depth = (uint32_t)depth;
+        }
+        else
+        {
+            LOG_WARNING("Ignoring K4A_IMU_QUEUE_DEPTH of \"%s\"", env_queue_depth);
+        }
+    }
 
-    result = TRACE_CALL(
-        queue_create(QUEUE_CALC_DEPTH(K4A_IMU_SAMPLE_RATE, QUEUE_DEFAULT_DEPTH_USEC), "Queue_imu", &p_imu->queue));
+    result = TRACE_CALL(sample_queue_create(sizeof(k4a_imu_sample_t), queue_depth, "Queue_imu", &p_imu->queue));
 
     if (K4A_SUCCEEDED(result))
     {
@@ -409,10 +436,13 @@ void imu_destroy(imu_t imu_handle)
     // implicit stop
     imu_stop(imu_handle);
 
+    imu_preintegration_destroy(imu->preintegration);
+    imu->preintegration = NULL;
+
     // Destroy queue
     if (imu->queue != NULL)
     {
-        queue_destroy(imu->queue);
+        sample_queue_destroy(imu->queue);
         imu->queue = NULL;
     }
 
@@ -420,27 +450,116 @@ void imu_destroy(imu_t imu_handle)
 }
 
 /**
- *  Function to adjust the sensor measurement according to calibration data
+ *  Function to refresh the bias and mixing matrices when the sensor temperature changed enough since their last refresh
  *
- *  @param p_imu_sample
- *   Pointer to this specific imu sample
+ *  @param p_imu
+ *   Pointer to the imu context, which includes the calibration information.
+ *
+ *  @param temperature
+ *   Value of sensor temperature
+ */
+static void imu_refresh_calibration(imu_context_t *p_imu, float temperature)
+{
+    if ((temperature > (p_imu->temperature + IMU_CALIBRATION_TEMPERATURE_THRESHOLD)) ||
+        (temperature < (p_imu->temperature - IMU_CALIBRATION_TEMPERATURE_THRESHOLD)))
+    {
+        imu_update_calibration_with_temperature(temperature, temperature, p_imu);
+        p_imu->temperature = temperature;
+    }
+}
+
+/**
+ *  Function to adjust the sensor measurements of several samples according to calibration data
  *
  *  @param p_imu
  *   Pointer to the imu context, which includes the calibration information.
  *
+ *  @param samples
+ *   Array of samples to calibrate in place
+ *
+ *  @param count
+ *   Number of samples, at most IMU_CALIBRATION_BATCH_SIZE
+ *
+ *  \remarks
+ *  Each axis of the samples is gathered into an array of its own, so the transforms process several samples at once.
  */
-static void imu_apply_intrinsic_calibration(k4a_imu_sample_t *p_imu_sample, const imu_context_t *p_imu)
+static void imu_apply_intrinsic_calibration(const imu_context_t *p_imu, k4a_imu_sample_t *samples, size_t count)
 {
-    math_affine_transform_3(p_imu->calibration_rectifier.mixing_matrix_gyro,
-                            p_imu_sample->gyro_sample.v,
-                            p_imu->calibration_rectifier.bias_gyro,
-                            p_imu_sample->gyro_sample.v);
-
-    math_quadratic_transform_3(p_imu->calibration_rectifier.mixing_matrix_accel,
-                               p_imu->accel_calibration.second_order_scaling,
-                               p_imu_sample->acc_sample.v,
-                               p_imu->calibration_rectifier.bias_accel,
-                               p_imu_sample->acc_sample.v);
+    float gyro[3][IMU_CALIBRATION_BATCH_SIZE];
+    float accel[3][IMU_CALIBRATION_BATCH_SIZE];
+
+    assert(count <= IMU_CALIBRATION_BATCH_SIZE);
+    for (size_t i = 0; i < count; i++)
+    {
+        for (int axis = 0; axis < 3; axis++)
+        {
+            gyro[axis][i] = samples[i].gyro_sample.v[axis];
+            accel[axis][i] = samples[i].acc_sample.v[axis];
+        }
+    }
+
+    math_affine_transform_3_soa(p_imu->calibration_rectifier.mixing_matrix_gyro,
+                                p_imu->calibration_rectifier.bias_gyro,
+                                gyro[0],
+                                gyro[1],
+                                gyro[2],
+                                count);
+
+    math_quadratic_transform_3_soa(p_imu->calibration_rectifier.mixing_matrix_accel,
+                                   p_imu->accel_calibration.second_order_scaling,
+                                   p_imu->calibration_rectifier.bias_accel,
+                                   accel[0],
+                                   accel[1],
+                                   accel[2],
+                                   count);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        for (int axis = 0; axis < 3; axis++)
+        {
+            samples[i].gyro_sample.v[axis] = gyro[axis][i];
+            samples[i].acc_sample.v[axis] = accel[axis][i];
+        }
+    }
+}
+
+/**
+ *  Function to calibrate samples of a packet and hand them to the callback or the sample queue
+ *
+ *  @param p_imu
+ *   Pointer to the imu context
+ *
+ *  @param samples
+ *   Array of uncalibrated samples
+ *
+ *  @param count
+ *   Number of samples, at most IMU_CALIBRATION_BATCH_SIZE
+ */
+static void imu_deliver_samples(imu_context_t *p_imu, k4a_imu_sample_t *samples, size_t count)
+{
+    imu_apply_intrinsic_calibration(p_imu, samples, count);
+
+    if (p_imu->preintegration != NULL)
+    {
+        imu_preintegration_add_samples(p_imu->preintegration, samples, count);
+    }
+    if (p_imu->listener != NULL)
+    {
+        p_imu->listener(samples, count, p_imu->listener_context);
+    }
+
+    k4a_atomic_add64(&p_imu->sample_count, count);
+    for (size_t i = 0; i < count; i++)
+    {
+        if (p_imu->callback != NULL)
+        {
+            p_imu->callback(&samples[i], p_imu->callback_context);
+        }
+        else
+        {
+            sample_queue_push(p_imu->queue, &samples[i]);
+        }
+    }
 }
 
 /**
@@ -466,59 +585,85 @@ k4a_wait_result_t imu_get_sample(imu_t imu_handle, k4a_imu_sample_t *imu_sample,
     RETURN_VALUE_IF_HANDLE_INVALID(K4A_WAIT_RESULT_FAILED, imu_t, imu_handle);
     RETURN_VALUE_IF_ARG(K4A_WAIT_RESULT_FAILED, (imu_sample == NULL));
 
-    k4a_wait_result_t wresult = K4A_WAIT_RESULT_SUCCEEDED;
+    size_t count = 0;
+    return imu_get_samples(imu_handle, imu_sample, 1, &count, timeout_in_ms);
+}
+
+/**
+ *  Function to get all of the samples currently available in the stream, up to max_samples.
+ *
+ *  @param imu_handle
+ *   Handle to this specific object
+ *
+ *  @param imu_samples
+ *   Array of max_samples where the samples will be written to
+ *
+ *  @param max_samples
+ *   Number of samples imu_samples can hold
+ *
+ *  @param sample_count
+ *   Pointer to where the number of samples written will be stored
+ *
+ *  @param timeout_in_ms
+ *   Number of mSecs to wait for the first sample, the remaining samples are only read if already available
+ *
+ *  @return
+ *   K4A_WAIT_RESULT_TIMEOUT     Operation timed out before any sample arrived
+ *   K4A_WAIT_RESULT_SUCCEEDED   Operation was successful and at least one sample was retrieved
+ *   K4A_WAIT_RESULT_FAILED      Operation failed due to invalid input or unknown reason
+ */
+k4a_wait_result_t imu_get_samples(imu_t imu_handle,
+                                  k4a_imu_sample_t *imu_samples,
+                                  size_t max_samples,
+                                  size_t *sample_count,
+                                  int32_t timeout_in_ms)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_WAIT_RESULT_FAILED, imu_t, imu_handle);
+    RETURN_VALUE_IF_ARG(K4A_WAIT_RESULT_FAILED, (imu_samples == NULL));
+    RETURN_VALUE_IF_ARG(K4A_WAIT_RESULT_FAILED, (max_samples == 0));
+    RETURN_VALUE_IF_ARG(K4A_WAIT_RESULT_FAILED, (sample_count == NULL));
+
     imu_context_t *p_imu = imu_t_get_context(imu_handle);
-    k4a_capture_t capture = NULL;
-    k4a_image_t image = NULL;
-    uint8_t *buffer = NULL;
 
-    wresult = queue_pop(p_imu->queue, timeout_in_ms, &capture);
+    // All queued samples, up to max_samples, are copied out in one go. They were calibrated as their packet arrived.
+    return sample_queue_pop(p_imu->queue, timeout_in_ms, imu_samples, max_samples, sample_count);
+}
 
-    if (wresult == K4A_WAIT_RESULT_SUCCEEDED)
-    {
-        k4a_result_t result = K4A_RESULT_FROM_BOOL((image = capture_get_imu_image(capture)) != NULL);
-        if (K4A_FAILED(result))
-        {
-            wresult = K4A_WAIT_RESULT_FAILED;
-        }
-    }
+/**
+ *  Function to get the newest sample available in the stream, skipping the older ones.
+ *
+ *  @param imu_handle
+ *   Handle to this specific object
+ *
+ *  @param imu_sample
+ *   Pointer to where the sample will be written to
+ *
+ *  @param timeout_in_ms
+ *   Number of mSecs to wait for a sample if none is available
+ *
+ *  @return
+ *   K4A_WAIT_RESULT_TIMEOUT     Operation timed out before any sample arrived
+ *   K4A_WAIT_RESULT_SUCCEEDED   Operation was successful and a sample was retrieved
+ *   K4A_WAIT_RESULT_FAILED      Operation failed due to invalid input or unknown reason
+ */
+k4a_wait_result_t imu_get_latest_sample(imu_t imu_handle, k4a_imu_sample_t *imu_sample, int32_t timeout_in_ms)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_WAIT_RESULT_FAILED, imu_t, imu_handle);
+    RETURN_VALUE_IF_ARG(K4A_WAIT_RESULT_FAILED, (imu_sample == NULL));
 
-    if (wresult == K4A_WAIT_RESULT_SUCCEEDED)
-    {
-        buffer = image_get_buffer(image);
-        k4a_result_t result = K4A_RESULT_FROM_BOOL(buffer != NULL);
-        if (K4A_FAILED(result))
-        {
-            wresult = K4A_WAIT_RESULT_FAILED;
-        }
-    }
+    imu_context_t *p_imu = imu_t_get_context(imu_handle);
 
-    if (wresult == K4A_WAIT_RESULT_SUCCEEDED)
-    {
-        assert(sizeof(k4a_imu_sample_t) <= image_get_size(image));
-        memcpy(imu_sample, buffer, sizeof(k4a_imu_sample_t));
+    return sample_queue_pop_latest(p_imu->queue, timeout_in_ms, imu_sample);
+}
 
-        // update the calibration when the temperature changes more than 0.25C
-        if ((imu_sample->temperature > (p_imu->temperature + 0.25f)) ||
-            (imu_sample->temperature < (p_imu->temperature - 0.25f)))
-        {
-            imu_update_calibration_with_temperature(imu_sample->temperature, imu_sample->temperature, p_imu);
-            p_imu->temperature = imu_sample->temperature;
-        }
-        // The application of intrinsic calibration is delayed until the IMU sample is queried.
-        imu_apply_intrinsic_calibration(imu_sample, p_imu);
-    }
+k4a_result_t imu_get_wait_handle(imu_t imu_handle, k4a_wait_handle_t *wait_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, imu_t, imu_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, (wait_handle == NULL));
 
-    if (image)
-    {
-        image_dec_ref(image);
-    }
-    if (capture)
-    {
-        capture_dec_ref(capture);
-    }
+    imu_context_t *p_imu = imu_t_get_context(imu_handle);
 
-    return wresult;
+    return TRACE_CALL(sample_queue_get_wait_handle(p_imu->queue, wait_handle));
 }
 
 /**
@@ -540,7 +685,11 @@ k4a_result_t imu_start(imu_t imu_handle, tickcounter_ms_t color_camera_start_tic
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, p_imu == NULL);
 
     p_imu->running = true;
-    queue_enable(p_imu->queue);
+    sample_queue_enable(p_imu->queue);
+    if (p_imu->preintegration != NULL)
+    {
+        imu_preintegration_reset(p_imu->preintegration);
+    }
 
     p_imu->wait_for_ts_reset = false;
     if (color_camera_start_tick != 0)
@@ -583,11 +732,190 @@ void imu_stop(imu_t imu_handle)
     if (p_imu->running)
     {
         colormcu_imu_stop_streaming(p_imu->color_mcu);
-        queue_disable(p_imu->queue);
+        sample_queue_disable(p_imu->queue);
+        if (p_imu->preintegration != NULL)
+        {
+            imu_preintegration_stop(p_imu->preintegration);
+        }
     }
     p_imu->running = false;
 }
 
+/**
+ *  Function to deliver IMU samples to a callback instead of the sample queue.
+ *
+ *  @param imu_handle
+ *   Handle to this specific object
+ *
+ *  @param callback
+ *   Function called with each sample, NULL to queue samples for imu_get_sample()
+ *
+ *  @param context
+ *   Passed to every call to callback
+ *
+ *  @return
+ *   K4A_RESULT_SUCCEEDED    Operation was successful
+ *   K4A_RESULT_FAILED       The IMU is running
+ */
+k4a_result_t imu_set_callback(imu_t imu_handle, k4a_imu_sample_ready_cb_t *callback, void *context)
+{
+    imu_context_t *p_imu = imu_t_get_context(imu_handle);
+
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, p_imu == NULL);
+
+    if (p_imu->running)
+    {
+        LOG_ERROR("The IMU callback can't be changed while streaming", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    p_imu->callback = callback;
+    p_imu->callback_context = callback == NULL ? NULL : context;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+/**
+ *  Function to pass the calibrated IMU samples to another module.
+ *
+ *  @param imu_handle
+ *   Handle to this specific object
+ *
+ *  @param listener
+ *   Function called with the samples of each packet before they are delivered, NULL to remove it
+ *
+ *  @param context
+ *   Passed to every call to listener
+ *
+ *  @return
+ *   K4A_RESULT_SUCCEEDED    Operation was successful
+ *   K4A_RESULT_FAILED       The IMU is running
+ */
+k4a_result_t imu_set_sample_listener(imu_t imu_handle, imu_sample_listener_t *listener, void *context)
+{
+    imu_context_t *p_imu = imu_t_get_context(imu_handle);
+
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, p_imu == NULL);
+
+    if (p_imu->running)
+    {
+        LOG_ERROR("The IMU sample listener can't be changed while streaming", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    p_imu->listener = listener;
+    p_imu->listener_context = listener == NULL ? NULL : context;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+/**
+ *  Function to enable or disable the preintegration of the IMU samples.
+ *
+ *  @param imu_handle
+ *   Handle to this specific object
+ *
+ *  @param enabled
+ *   true to integrate the samples as they arrive, false to free the history
+ *
+ *  @return
+ *   K4A_RESULT_SUCCEEDED    Operation was successful
+ *   K4A_RESULT_FAILED       The IMU is running or the history could not be allocated
+ */
+k4a_result_t imu_set_preintegration(imu_t imu_handle, bool enabled)
+{
+    imu_context_t *p_imu = imu_t_get_context(imu_handle);
+
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, p_imu == NULL);
+
+    if (p_imu->running)
+    {
+        LOG_ERROR("The IMU preintegration can't be changed while streaming", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    if (enabled && p_imu->preintegration == NULL)
+    {
+        p_imu->preintegration = imu_preintegration_create(&p_imu->gyro_calibration.depth_to_imu,
+                                                          &p_imu->accel_calibration.depth_to_imu,
+                                                          IMU_PREINTEGRATION_DEPTH);
+        if (p_imu->preintegration == NULL)
+        {
+            return K4A_RESULT_FAILED;
+        }
+    }
+    else if (!enabled)
+    {
+        imu_preintegration_destroy(p_imu->preintegration);
+        p_imu->preintegration = NULL;
+    }
+    return K4A_RESULT_SUCCEEDED;
+}
+
+/**
+ *  Function to get the motion of the IMU between two device timestamps.
+ *
+ *  @param imu_handle
+ *   Handle to this specific object
+ *
+ *  @param start_timestamp_usec
+ *   Device timestamp the motion starts at, within the last 2 seconds of samples
+ *
+ *  @param end_timestamp_usec
+ *   Device timestamp the motion ends at
+ *
+ *  @param preintegration
+ *   Pointer to where the motion will be written to
+ *
+ *  @param timeout_in_ms
+ *   Number of mSecs to wait for a sample at or after end_timestamp_usec
+ *
+ *  @return
+ *   K4A_WAIT_RESULT_TIMEOUT     Operation timed out
+ *   K4A_WAIT_RESULT_SUCCEEDED   Operation was successful
+ *   K4A_WAIT_RESULT_FAILED      Preintegration is disabled, the stream stopped or the start is out of the history
+ */
+k4a_wait_result_t imu_get_preintegration(imu_t imu_handle,
+                                         uint64_t start_timestamp_usec,
+                                         uint64_t end_timestamp_usec,
+                                         k4a_imu_preintegration_t *preintegration,
+                                         int32_t timeout_in_ms)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_WAIT_RESULT_FAILED, imu_t, imu_handle);
+    imu_context_t *p_imu = imu_t_get_context(imu_handle);
+
+    if (p_imu->preintegration == NULL)
+    {
+        LOG_ERROR("The IMU preintegration is not enabled", 0);
+        return K4A_WAIT_RESULT_FAILED;
+    }
+    return imu_preintegration_get(p_imu->preintegration,
+                                  start_timestamp_usec,
+                                  end_timestamp_usec,
+                                  preintegration,
+                                  timeout_in_ms);
+}
+
+/**
+ *  Function filling in the IMU sample counters of the device statistics.
+ *
+ *  @param imu_handle
+ *   Handle to this specific object
+ *
+ *  @param statistics
+ *   Statistics to fill in
+ *
+ */
+k4a_result_t imu_get_statistics(imu_t imu_handle, k4a_device_statistics_t *statistics)
+{
+    imu_context_t *p_imu = imu_t_get_context(imu_handle);
+
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, p_imu == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, statistics == NULL);
+
+    statistics->imu_sample_count = k4a_atomic_load64(&p_imu->sample_count);
+    statistics->imu_dropped_count = sample_queue_get_dropped_count(p_imu->queue);
+    return K4A_RESULT_SUCCEEDED;
+}
+
 /**
  *  Function returning a pointer to extrinsic calibration of gyro.
  *
@@ -0,0 +1,427 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// This library
+#include <k4ainternal/imu_preintegration.h>
+
+// Dependent libraries
+#include <k4ainternal/logging.h>
+#include <azure_c_shared_utility/condition.h>
+#include <azure_c_shared_utility/lock.h>
+#include <azure_c_shared_utility/tickcounter.h>
+
+// System dependencies
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Integrated motion from the first sample of the stream up to a sample. Doubles keep the cumulative velocity and
+// position precise over long streams, the motion between two states is their difference.
+typedef struct _imu_preintegration_state_t
+{
+    uint64_t timestamp_usec;
+    float gyro[3];      // Rotation rate integrated to reach this state, in the accelerometer coordinate system
+    float accel[3];     // Acceleration integrated to reach this state
+    double rotation[4]; // Unit quaternion w, x, y, z from the IMU at this state to the IMU at the first state
+    double velocity[3]; // Integral of the rotated acceleration, in the coordinate system of the first state
+    double position[3]; // Integral of velocity
+} imu_preintegration_state_t;
+
+struct _imu_preintegration_t
+{
+    float gyro_to_accel[3 * 3]; // Rotation from the gyroscope to the accelerometer coordinate system, row major
+
+    LOCK_HANDLE lock; // Locks the fields below
+    COND_HANDLE condition;
+    TICK_COUNTER_HANDLE tick;
+    imu_preintegration_state_t *states; // Ring of history_depth states, oldest at first
+    uint32_t history_depth;
+    uint32_t first;
+    uint32_t count;
+    uint32_t waiting; // Queries waiting for newer samples
+    bool stopped;
+};
+
+// v rotated by the unit quaternion q
+static void imu_preintegration_rotate(const double q[4], const double v[3], double out[3])
+{
+    // out = v + 2w (u x v) + 2 u x (u x v), with u the vector part of q
+    double t[3] = { 2 * (q[2] * v[2] - q[3] * v[1]), 2 * (q[3] * v[0] - q[1] * v[2]), 2 * (q[1] * v[1] - q[2] * v[0]) };
+    out[0] = v[0] + q[0] * t[0] + (q[2] * t[2] - q[3] * t[1]);
+    out[1] = v[1] + q[0] * t[1] + (q[3] * t[0] - q[1] * t[2]);
+    out[2] = v[2] + q[0] * t[2] + (q[1] * t[1] - q[2] * t[0]);
+}
+
+static void imu_preintegration_multiply(const double a[4], const double b[4], double out[4])
+{
+    double w = a[0] * b[0] - a[1] * b[1] - a[2] * b[2] - a[3] * b[3];
+    double x = a[0] * b[1] + a[1] * b[0] + a[2] * b[3] - a[3] * b[2];
+    double y = a[0] * b[2] - a[1] * b[3] + a[2] * b[0] + a[3] * b[1];
+    double z = a[0] * b[3] + a[1] * b[2] - a[2] * b[1] + a[3] * b[0];
+    double norm = sqrt(w * w + x * x + y * y + z * z);
+    out[0] = w / norm;
+    out[1] = x / norm;
+    out[2] = y / norm;
+    out[3] = z / norm;
+}
+
+// Rotation over dt at a constant rate, exp of the rotation vector gyro * dt
+static void imu_preintegration_exp(const float gyro[3], double dt, double out[4])
+{
+    double rate = sqrt((double)gyro[0] * gyro[0] + (double)gyro[1] * gyro[1] + (double)gyro[2] * gyro[2]);
+    double half_angle = 0.5 * rate * dt;
+    double scale = rate > 1e-12 ? sin(half_angle) / rate : 0.5 * dt;
+    out[0] = cos(half_angle);
+    out[1] = gyro[0] * scale;
+    out[2] = gyro[1] * scale;
+    out[3] = gyro[2] * scale;
+}
+
+// Integrates gyro and accel over dt seconds from state from, the timestamp and samples of to are left to the caller
+static void imu_preintegration_propagate(const imu_preintegration_state_t *from,
+                                         const float gyro[3],
+                                         const float accel[3],
+                                         double dt,
+                                         imu_preintegration_state_t *to)
+{
+    // The acceleration is rotated by the orientation halfway through dt, which keeps the error second order in dt
+    double half_step[4];
+    double half_rotation[4];
+    imu_preintegration_exp(gyro, 0.5 * dt, half_step);
+    imu_preintegration_multiply(from->rotation, half_step, half_rotation);
+
+    double accel_d[3] = { accel[0], accel[1], accel[2] };
+    double rotated[3];
+    imu_preintegration_rotate(half_rotation, accel_d, rotated);
+    for (int i = 0; i < 3; i++)
+    {
+        to->position[i] = from->position[i] + from->velocity[i] * dt + 0.5 * rotated[i] * dt * dt;
+        to->velocity[i] = from->velocity[i] + rotated[i] * dt;
+    }
+
+    double step[4];
+    imu_preintegration_exp(gyro, dt, step);
+    imu_preintegration_multiply(from->rotation, step, to->rotation);
+}
+
+static imu_preintegration_state_t *imu_preintegration_at(imu_preintegration_t *preintegration, uint32_t index)
+{
+    return &preintegration->states[(preintegration->first + index) % preintegration->history_depth];
+}
+
+// Index of the newest state at or before timestamp_usec, which must not be before the oldest state
+static uint32_t imu_preintegration_find(imu_preintegration_t *preintegration, uint64_t timestamp_usec)
+{
+    uint32_t low = 0;
+    uint32_t high = preintegration->count - 1;
+    while (low < high)
+    {
+        uint32_t middle = low + (high - low + 1) / 2;
+        if (imu_preintegration_at(preintegration, middle)->timestamp_usec <= timestamp_usec)
+        {
+            low = middle;
+        }
+        else
+        {
+            high = middle - 1;
+        }
+    }
+    return low;
+}
+
+// State at timestamp_usec, integrated from the state before it with the samples of the state after it
+static void imu_preintegration_state_at(imu_preintegration_t *preintegration,
+                                        uint64_t timestamp_usec,
+                                        uint32_t index,
+                                        imu_preintegration_state_t *state)
+{
+    const imu_preintegration_state_t *before = imu_preintegration_at(preintegration, index);
+    *state = *before;
+    if (before->timestamp_usec < timestamp_usec && index + 1 < preintegration->count)
+    {
+        const imu_preintegration_state_t *after = imu_preintegration_at(preintegration, index + 1);
+        double dt = (double)(timestamp_usec - before->timestamp_usec) / 1000000.0;
+        imu_preintegration_propagate(before, after->gyro, after->accel, dt, state);
+        state->timestamp_usec = timestamp_usec;
+    }
+}
+
+imu_preintegration_t *imu_preintegration_create(const k4a_calibration_extrinsics_t *gyro_extrinsics,
+                                                const k4a_calibration_extrinsics_t *accel_extrinsics,
+                                                uint32_t history_depth)
+{
+    RETURN_VALUE_IF_ARG(NULL, gyro_extrinsics == NULL);
+    RETURN_VALUE_IF_ARG(NULL, accel_extrinsics == NULL);
+    RETURN_VALUE_IF_ARG(NULL, history_depth < 2);
+
+    imu_preintegration_t *preintegration = (imu_preintegration_t *)calloc(1, sizeof(imu_preintegration_t));
+    if (preintegration == NULL)
+    {
+        return NULL;
+    }
+
+    // The extrinsics map depth to each sensor, so gyro_to_accel = R_accel * R_gyro^T
+    for (int row = 0; row < 3; row++)
+    {
+        for (int col = 0; col < 3; col++)
+        {
+            float sum = 0;
+            for (int k = 0; k < 3; k++)
+            {
+                sum += accel_extrinsics->rotation[row * 3 + k] * gyro_extrinsics->rotation[col * 3 + k];
+            }
+            preintegration->gyro_to_accel[row * 3 + col] = sum;
+        }
+    }
+
+    preintegration->history_depth = history_depth;
+    preintegration->states = (imu_preintegration_state_t *)malloc(history_depth * sizeof(imu_preintegration_state_t));
+    preintegration->lock = Lock_Init();
+    preintegration->condition = Condition_Init();
+    preintegration->tick = tickcounter_create();
+    if (preintegration->states == NULL || preintegration->lock == NULL || preintegration->condition == NULL ||
+        preintegration->tick == NULL)
+    {
+        LOG_ERROR("Failed to allocate the IMU preintegration of %u samples", history_depth);
+        imu_preintegration_destroy(preintegration);
+        preintegration = NULL;
+    }
+    return preintegration;
+}
+
+void imu_preintegration_destroy(imu_preintegration_t *preintegration)
+{
+    if (preintegration == NULL)
+    {
+        return;
+    }
+    if (preintegration->tick != NULL)
+    {
+        tickcounter_destroy(preintegration->tick);
+    }
+    if (preintegration->condition != NULL)
+    {
+        Condition_Deinit(preintegration->condition);
+    }
+    if (preintegration->lock != NULL)
+    {
+        Lock_Deinit(preintegration->lock);
+    }
+    free(preintegration->states);
+    free(preintegration);
+}
+
+void imu_preintegration_reset(imu_preintegration_t *preintegration)
+{
+    RETURN_VALUE_IF_ARG(VOID_VALUE, preintegration == NULL);
+
+    Lock(preintegration->lock);
+    preintegration->first = 0;
+    preintegration->count = 0;
+    preintegration->stopped = false;
+    Unlock(preintegration->lock);
+}
+
+void imu_preintegration_stop(imu_preintegration_t *preintegration)
+{
+    RETURN_VALUE_IF_ARG(VOID_VALUE, preintegration == NULL);
+
+    Lock(preintegration->lock);
+    preintegration->stopped = true;
+    if (preintegration->waiting > 0)
+    {
+        Condition_Post(preintegration->condition);
+    }
+    Unlock(preintegration->lock);
+}
+
+void imu_preintegration_add_samples(imu_preintegration_t *preintegration,
+                                    const k4a_imu_sample_t *samples,
+                                    size_t sample_count)
+{
+    RETURN_VALUE_IF_ARG(VOID_VALUE, preintegration == NULL);
+    RETURN_VALUE_IF_ARG(VOID_VALUE, samples == NULL && sample_count > 0);
+
+    Lock(preintegration->lock);
+    for (size_t i = 0; i < sample_count; i++)
+    {
+        const k4a_imu_sample_t *sample = &samples[i];
+        imu_preintegration_state_t state;
+        state.timestamp_usec = sample->acc_timestamp_usec;
+        for (int row = 0; row < 3; row++)
+        {
+            const float *rotation = &preintegration->gyro_to_accel[row * 3];
+            state.gyro[row] = rotation[0] * sample->gyro_sample.v[0] + rotation[1] * sample->gyro_sample.v[1] +
+                              rotation[2] * sample->gyro_sample.v[2];
+            state.accel[row] = sample->acc_sample.v[row];
+        }
+
+        if (preintegration->count > 0)
+        {
+            const imu_preintegration_state_t *last = imu_preintegration_at(preintegration, preintegration->count - 1);
+            if (state.timestamp_usec <= last->timestamp_usec)
+            {
+                if (state.timestamp_usec < last->timestamp_usec)
+                {
+                    // The device timestamps were reset, the motion before can't be related to the one after
+                    preintegration->first = 0;
+                    preintegration->count = 0;
+                }
+                else
+                {
+                    continue;
+                }
+            }
+        }
+
+        if (preintegration->count == 0)
+        {
+            memset(state.rotation, 0, sizeof(state.rotation) + sizeof(state.velocity) + sizeof(state.position));
+            state.rotation[0] = 1;
+        }
+        else
+        {
+            const imu_preintegration_state_t *last = imu_preintegration_at(preintegration, preintegration->count - 1);
+            double dt = (double)(state.timestamp_usec - last->timestamp_usec) / 1000000.0;
+            imu_preintegration_propagate(last, state.gyro, state.accel, dt, &state);
+        }
+
+        if (preintegration->count == preintegration->history_depth)
+        {
+            preintegration->first = (preintegration->first + 1) % preintegration->history_depth;
+            preintegration->count--;
+        }
+        *imu_preintegration_at(preintegration, preintegration->count) = state;
+        preintegration->count++;
+    }
+
+    if (preintegration->waiting > 0)
+    {
+        Condition_Post(preintegration->condition);
+    }
+    Unlock(preintegration->lock);
+}
+
+// True once the newest sample is at or after timestamp_usec. Lock(preintegration->lock) should be active.
+static bool imu_preintegration_has(imu_preintegration_t *preintegration, uint64_t timestamp_usec)
+{
+    return preintegration->count > 0 &&
+           imu_preintegration_at(preintegration, preintegration->count - 1)->timestamp_usec >= timestamp_usec;
+}
+
+k4a_wait_result_t imu_preintegration_get(imu_preintegration_t *preintegration,
+                                         uint64_t start_timestamp_usec,
+                                         uint64_t end_timestamp_usec,
+                                         k4a_imu_preintegration_t *preintegration_out,
+                                         int32_t timeout_in_ms)
+{
+    RETURN_VALUE_IF_ARG(K4A_WAIT_RESULT_FAILED, preintegration == NULL);
+    RETURN_VALUE_IF_ARG(K4A_WAIT_RESULT_FAILED, preintegration_out == NULL);
+    RETURN_VALUE_IF_ARG(K4A_WAIT_RESULT_FAILED, end_timestamp_usec < start_timestamp_usec);
+
+    k4a_wait_result_t wresult = K4A_WAIT_RESULT_SUCCEEDED;
+    tickcounter_ms_t start_ms = 0;
+    if (timeout_in_ms > 0 && tickcounter_get_current_ms(preintegration->tick, &start_ms) != 0)
+    {
+        return K4A_WAIT_RESULT_FAILED;
+    }
+
+    Lock(preintegration->lock);
+    preintegration->waiting++;
+    while (wresult == K4A_WAIT_RESULT_SUCCEEDED && !preintegration->stopped &&
+           !imu_preintegration_has(preintegration, end_timestamp_usec))
+    {
+        // Anything less than 0 is a wait forever condition in the lower level calls.
+        // K4A_WAIT_INFINITE (-1) is defined for the user for this purpose
+        size_t wait_in_ms = 0;
+        if (timeout_in_ms == 0)
+        {
+            wresult = K4A_WAIT_RESULT_TIMEOUT;
+            break;
+        }
+        else if (timeout_in_ms > 0)
+        {
+            // Samples arrive while waiting, the wait ends at the deadline whichever sample woke it
+            tickcounter_ms_t now_ms = 0;
+            if (tickcounter_get_current_ms(preintegration->tick, &now_ms) != 0)
+            {
+                wresult = K4A_WAIT_RESULT_FAILED;
+                break;
+            }
+            if (now_ms - start_ms >= (tickcounter_ms_t)timeout_in_ms)
+            {
+                wresult = K4A_WAIT_RESULT_TIMEOUT;
+                break;
+            }
+            wait_in_ms = (size_t)((tickcounter_ms_t)timeout_in_ms - (now_ms - start_ms));
+        }
+
+        COND_RESULT cond_result = Condition_Wait(preintegration->condition, preintegration->lock, wait_in_ms);
+        if (cond_result == COND_TIMEOUT)
+        {
+            wresult = imu_preintegration_has(preintegration, end_timestamp_usec) ? K4A_WAIT_RESULT_SUCCEEDED :
+                                                                                    K4A_WAIT_RESULT_TIMEOUT;
+        }
+        else if (cond_result != COND_OK)
+        {
+            wresult = K4A_WAIT_RESULT_FAILED;
+        }
+    }
+    preintegration->waiting--;
+
+    if (wresult == K4A_WAIT_RESULT_SUCCEEDED && preintegration->stopped)
+    {
+        wresult = K4A_WAIT_RESULT_FAILED;
+    }
+    if (wresult == K4A_WAIT_RESULT_SUCCEEDED &&
+        start_timestamp_usec < imu_preintegration_at(preintegration, 0)->timestamp_usec)
+    {
+        LOG_ERROR("The IMU preintegration start timestamp %llu is older than the %u samples of history",
+                  (unsigned long long)start_timestamp_usec,
+                  preintegration->history_depth);
+        wresult = K4A_WAIT_RESULT_FAILED;
+    }
+
+    if (wresult == K4A_WAIT_RESULT_SUCCEEDED)
+    {
+        uint32_t start_index = imu_preintegration_find(preintegration, start_timestamp_usec);
+        uint32_t end_index = imu_preintegration_find(preintegration, end_timestamp_usec);
+        imu_preintegration_state_t start;
+        imu_preintegration_state_t end;
+        imu_preintegration_state_at(preintegration, start_timestamp_usec, start_index, &start);
+        imu_preintegration_state_at(preintegration, end_timestamp_usec, end_index, &end);
+
+        // Relative to the start state: R = R_start^T R_end, v = R_start^T (v_end - v_start) and
+        // p = R_start^T (p_end - p_start - v_start * dt)
+        double inverse[4] = { start.rotation[0], -start.rotation[1], -start.rotation[2], -start.rotation[3] };
+        double rotation[4];
+        imu_preintegration_multiply(inverse, end.rotation, rotation);
+
+        double dt = (double)(end_timestamp_usec - start_timestamp_usec) / 1000000.0;
+        double velocity[3];
+        double position[3];
+        for (int i = 0; i < 3; i++)
+        {
+            velocity[i] = end.velocity[i] - start.velocity[i];
+            position[i] = end.position[i] - start.position[i] - start.velocity[i] * dt;
+        }
+        imu_preintegration_rotate(inverse, velocity, velocity);
+        imu_preintegration_rotate(inverse, position, position);
+
+        preintegration_out->start_timestamp_usec = start_timestamp_usec;
+        preintegration_out->end_timestamp_usec = end_timestamp_usec;
+        for (int i = 0; i < 4; i++)
+        {
+            preintegration_out->delta_rotation[i] = (float)rotation[i];
+        }
+        for (int i = 0; i < 3; i++)
+        {
+            preintegration_out->delta_velocity.v[i] = (float)velocity[i];
+            preintegration_out->delta_position.v[i] = (float)position[i];
+        }
+        preintegration_out->sample_count = end_index - start_index;
+    }
+    Unlock(preintegration->lock);
+
+    return wresult;
+}
@@ -15,6 +15,11 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <new>
 
 // External dependencies
 
@@ -50,6 +55,18 @@ static const char K4A_LOG_LEVEL[] = "K4A_LOG_LEVEL";
 static const char K4A_LOG_FILE_NAME[] = "k4a.log";
 static size_t K4A_LOG_FILE_50MB_MAX_SIZE = (1048576 * 50);
 
+// Messages for the environment logger are queued and written by a writer thread, so streaming threads never wait on
+// spdlog's file or stdout I/O. When the queue is full messages are dropped and counted rather than blocking.
+#define LOG_MESSAGE_MAX_SIZE (1024)
+#define LOG_QUEUE_SIZE (512) // Must be a power of 2
+#define LOG_QUEUE_WRITER_WAIT_MS (50)
+
+volatile int32_t g_logger_max_level = K4A_LOG_LEVEL_TRACE;
+
+// Copies of the callback and environment logger levels that logger_log() can check without the lock, -1 when off
+static std::atomic<int32_t> g_logger_user_level(-1);
+static std::atomic<int32_t> g_logger_env_level(-1);
+
 typedef struct
 {
     k4a_rwlock_t lock;
@@ -65,6 +82,34 @@ typedef struct
     k4a_log_level_t env_log_level;
 } logger_global_context_t;
 
+typedef struct
+{
+    std::atomic<size_t> sequence;
+    k4a_log_level_t level;
+    const char *file;
+    int line;
+    char message[LOG_MESSAGE_MAX_SIZE];
+} logger_queue_entry_t;
+
+// Bounded multi-producer queue (D. Vyukov's design), consumed only by the writer thread. Each entry's sequence tells
+// producers and the consumer whose turn it is to use the entry.
+typedef struct
+{
+    logger_queue_entry_t entries[LOG_QUEUE_SIZE];
+    std::atomic<size_t> enqueue_position;
+    size_t dequeue_position;
+    std::atomic<uint32_t> dropped_count;
+
+    std::mutex lock;
+    std::condition_variable wake;
+    bool stop;
+    THREAD_HANDLE writer_thread;
+} logger_queue_t;
+
+// Created with the first queued message, so processes that never log don't pay for the thread
+static std::once_flag g_logger_queue_once;
+static logger_queue_t *g_logger_queue = nullptr;
+
 static void logger_init_once(logger_global_context_t *global);
 static void logger_deinit();
 
@@ -85,6 +130,197 @@ public:
 };
 static logger_global_destroy destroy_loggger_on_binary_unload;
 
+// Called with the write lock held, or from logger_init_once()
+static void logger_update_max_level(logger_global_context_t *g_context)
+{
+    int32_t env_level = -1;
+    int32_t user_level = -1;
+    if (g_context->env_logger && g_context->env_log_level != K4A_LOG_LEVEL_OFF)
+    {
+        env_level = (int32_t)g_context->env_log_level;
+    }
+    if (g_context->user_callback && g_context->user_log_level != K4A_LOG_LEVEL_OFF)
+    {
+        user_level = (int32_t)g_context->user_log_level;
+    }
+    g_logger_env_level.store(env_level, std::memory_order_relaxed);
+    g_logger_user_level.store(user_level, std::memory_order_relaxed);
+
+    int32_t max_level = env_level > user_level ? env_level : user_level;
+
+#if defined(__GNUC__) || defined(__clang__)
+    __atomic_store_n(&g_logger_max_level, max_level, __ATOMIC_RELAXED);
+#else
+    g_logger_max_level = max_level;
+#endif
+}
+
+static void logger_write_to_env_logger(logger_global_context_t *g_context,
+                                       k4a_log_level_t level,
+                                       const char *file,
+                                       int line,
+                                       const char *message)
+{
+    switch (level)
+    {
+    case K4A_LOG_LEVEL_CRITICAL:
+        g_context->env_logger->critical("{0} ({1}): {2}", file, line, message);
+        break;
+    case K4A_LOG_LEVEL_ERROR:
+        g_context->env_logger->error("{0} ({1}): {2}", file, line, message);
+        break;
+    case K4A_LOG_LEVEL_WARNING:
+        g_context->env_logger->warn("{0} ({1}): {2}", file, line, message);
+        break;
+    case K4A_LOG_LEVEL_INFO:
+        g_context->env_logger->info("{0} ({1}): {2}", file, line, message);
+        break;
+    case K4A_LOG_LEVEL_TRACE:
+    default:
+        g_context->env_logger->trace("{0} ({1}): {2}", file, line, message);
+        break;
+    }
+}
+
+// Writes every queued message, returns false if the queue was empty
+static bool logger_queue_drain(logger_global_context_t *g_context, logger_queue_t *queue)
+{
+    bool wrote = false;
+    while (true)
+    {
+        logger_queue_entry_t *entry = &queue->entries[queue->dequeue_position & (LOG_QUEUE_SIZE - 1)];
+        if (entry->sequence.load(std::memory_order_acquire) != queue->dequeue_position + 1)
+        {
+            break;
+        }
+
+        logger_write_to_env_logger(g_context, entry->level, entry->file, entry->line, entry->message);
+        entry->sequence.store(queue->dequeue_position + LOG_QUEUE_SIZE, std::memory_order_release);
+        queue->dequeue_position++;
+        wrote = true;
+    }
+
+    uint32_t dropped_count = queue->dropped_count.exchange(0, std::memory_order_relaxed);
+    if (dropped_count != 0)
+    {
+        g_context->env_logger->warn("{0} log messages were dropped, the log queue was full.", dropped_count);
+    }
+    return wrote;
+}
+
+static int logger_queue_writer_thread(void *param)
+{
+    logger_queue_t *queue = (logger_queue_t *)param;
+    logger_global_context_t *g_context = logger_global_context_t_get();
+
+    std::unique_lock<std::mutex> lock(queue->lock);
+    while (!queue->stop)
+    {
+        lock.unlock();
+        bool wrote = logger_queue_drain(g_context, queue);
+        lock.lock();
+
+        // Producers only wake the writer for warnings and worse, everything else waits for the timeout
+        if (!wrote && !queue->stop)
+        {
+            queue->wake.wait_for(lock, std::chrono::milliseconds(LOG_QUEUE_WRITER_WAIT_MS));
+        }
+    }
+    lock.unlock();
+
+    logger_queue_drain(g_context, queue);
+    return 0;
+}
+
+static void logger_queue_create()
+{
+    logger_queue_t *queue = new (std::nothrow) logger_queue_t();
+    if (queue == nullptr)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < LOG_QUEUE_SIZE; i++)
+    {
+        queue->entries[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    if (ThreadAPI_Create(&queue->writer_thread, logger_queue_writer_thread, queue) != THREADAPI_OK)
+    {
+        delete queue;
+        return;
+    }
+    g_logger_queue = queue;
+}
+
+// Returns false if the message could not be queued because the writer thread isn't running
+static bool logger_queue_push(k4a_log_level_t level, const char *file, int line, const char *message)
+{
+    std::call_once(g_logger_queue_once, logger_queue_create);
+    logger_queue_t *queue = g_logger_queue;
+    if (queue == nullptr)
+    {
+        return false;
+    }
+
+    logger_queue_entry_t *entry;
+    size_t position = queue->enqueue_position.load(std::memory_order_relaxed);
+    while (true)
+    {
+        entry = &queue->entries[position & (LOG_QUEUE_SIZE - 1)];
+        size_t sequence = entry->sequence.load(std::memory_order_acquire);
+        if (sequence == position)
+        {
+            if (queue->enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if ((intptr_t)(sequence - position) < 0)
+        {
+            // Full, the writer hasn't consumed the entry from the previous lap yet
+            queue->dropped_count.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        else
+        {
+            position = queue->enqueue_position.load(std::memory_order_relaxed);
+        }
+    }
+
+    entry->level = level;
+    entry->file = file;
+    entry->line = line;
+    size_t message_size = strnlen(message, LOG_MESSAGE_MAX_SIZE - 1);
+    memcpy(entry->message, message, message_size);
+    entry->message[message_size] = '\0';
+    entry->sequence.store(position + 1, std::memory_order_release);
+
+    if (level <= K4A_LOG_LEVEL_WARNING)
+    {
+        queue->wake.notify_one();
+    }
+    return true;
+}
+
+static void logger_queue_destroy()
+{
+    logger_queue_t *queue = g_logger_queue;
+    if (queue == nullptr)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queue->lock);
+        queue->stop = true;
+    }
+    queue->wake.notify_one();
+    ThreadAPI_Join(queue->writer_thread, NULL);
+
+    // The queue isn't freed, a message logged while the binary unloads may still be pushed to it
+}
+
 k4a_result_t logger_register_message_callback(k4a_logging_message_cb_t *message_cb,
                                               void *message_cb_context,
                                               k4a_log_level_t min_level)
@@ -117,6 +353,8 @@ k4a_result_t logger_register_message_callback(k4a_logging_message_cb_t *message_
         result = K4A_RESULT_FAILED;
     }
 
+    logger_update_max_level(g_context);
+
     rwlock_release_write(&g_context->lock);
 
     return result;
@@ -249,16 +487,24 @@ static void logger_init_once(logger_global_context_t *global)
 
         global->env_logger->flush_on(spdlog::level::warn);
     }
+
+    logger_update_max_level(global);
 }
 
 void logger_deinit(void)
 {
     logger_global_context_t *g_context = logger_global_context_t_get();
 
+    // Stop queueing messages before the writer thread writes the last of them
     rwlock_acquire_write(&g_context->lock);
+    g_context->env_log_level = K4A_LOG_LEVEL_OFF;
+    logger_update_max_level(g_context);
+    rwlock_release_write(&g_context->lock);
 
-    g_context->env_logger = nullptr;
+    logger_queue_destroy();
 
+    rwlock_acquire_write(&g_context->lock);
+    g_context->env_logger = nullptr;
     rwlock_release_write(&g_context->lock);
 }
 
@@ -270,17 +516,13 @@ void logger_log(k4a_log_level_t level, const char * file, const int line, const
 {
     logger_global_context_t *g_context = logger_global_context_t_get();
 
-    rwlock_acquire_read(&g_context->lock);
-
-    // Quick exit if we are not logging the message
-    if ((level > g_context->env_log_level && level > g_context->user_log_level) ||
-        (!g_context->env_logger && !g_context->user_callback))
+    // Quick exit if we are not logging the message. Callers using the LOG_* macros already checked this.
+    if (!logger_is_enabled(level))
     {
-        rwlock_release_read(&g_context->lock);
         return;
     }
 
-    char buffer[1024];
+    char buffer[LOG_MESSAGE_MAX_SIZE];
     va_list args;
     va_start(args, format);
 #ifndef _WIN32
@@ -293,41 +535,31 @@ void logger_log(k4a_log_level_t level, const char * file, const int line, const
 #endif
     va_end(args);
 
-    if ((level <= g_context->user_log_level) && (g_context->user_log_level != K4A_LOG_LEVEL_OFF))
+    // The callback is called synchronously, its registration can't change while it is in use
+    if ((int32_t)level <= g_logger_user_level.load(std::memory_order_relaxed))
     {
-        if (g_context->user_callback)
+        rwlock_acquire_read(&g_context->lock);
+        if ((level <= g_context->user_log_level) && (g_context->user_log_level != K4A_LOG_LEVEL_OFF) &&
+            g_context->user_callback)
         {
             g_context->user_callback(g_context->user_callback_context, level, file, line, buffer);
         }
+        rwlock_release_read(&g_context->lock);
     }
 
-    if ((level <= g_context->env_log_level) && (g_context->env_log_level != K4A_LOG_LEVEL_OFF))
+    // The environment logger is set up once and only torn down by logger_deinit(), which turns its level off before
+    // stopping the writer thread, so queueing doesn't need the lock
+    if ((int32_t)level <= g_logger_env_level.load(std::memory_order_relaxed) &&
+        !logger_queue_push(level, file, line, buffer))
     {
-        if (g_context->env_logger)
+        // No writer thread, write on this thread instead. spdlog's _mt loggers are thread safe.
+        rwlock_acquire_read(&g_context->lock);
+        if (g_context->env_logger && g_context->env_log_level != K4A_LOG_LEVEL_OFF)
         {
-            switch (level)
-            {
-            case K4A_LOG_LEVEL_CRITICAL:
-                g_context->env_logger->critical("{0} ({1}): {2}", file, line, buffer);
-                break;
-            case K4A_LOG_LEVEL_ERROR:
-                g_context->env_logger->error("{0} ({1}): {2}", file, line, buffer);
-                break;
-            case K4A_LOG_LEVEL_WARNING:
-                g_context->env_logger->warn("{0} ({1}): {2}", file, line, buffer);
-                break;
-            case K4A_LOG_LEVEL_INFO:
-                g_context->env_logger->info("{0} ({1}): {2}", file, line, buffer);
-                break;
-            case K4A_LOG_LEVEL_TRACE:
-            default:
-                g_context->env_logger->trace("{0} ({1}): {2}", file, line, buffer);
-                break;
-            }
+            logger_write_to_env_logger(g_context, level, file, line, buffer);
         }
+        rwlock_release_read(&g_context->lock);
     }
-
-    rwlock_release_read(&g_context->lock);
 }
 
 bool logger_is_file_based()
@@ -5,6 +5,11 @@
 // This library
 #include <k4ainternal/math.h>
 
+#if defined(__amd64__) || defined(_M_AMD64) || defined(__i386__) || defined(_M_IX86)
+#define K4A_USING_SSE
+#include <emmintrin.h> // SSE2
+#endif
+
 void math_transpose_3x3(const float in[3 * 3], float out[3 * 3])
 {
     for (int i = 0; i < 3; ++i)
@@ -107,4 +112,73 @@ void math_quadratic_transform_3(const float A[3 * 3],
 
     // y = B*x2 + temp
     math_affine_transform_3(B, x2, temp, out);
-}
\ No newline at end of file
+}
+
+#if defined(K4A_USING_SSE)
+// Dot products of row with 4 vectors, in the same order of operations as math_dot_3()
+static inline __m128 math_dot_3_ps(const float row[3], __m128 x, __m128 y, __m128 z)
+{
+    __m128 out = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(row[0]), x), _mm_mul_ps(_mm_set1_ps(row[1]), y));
+    return _mm_add_ps(out, _mm_mul_ps(_mm_set1_ps(row[2]), z));
+}
+#endif
+
+void math_affine_transform_3_soa(const float A[3 * 3], const float b[3], float *x, float *y, float *z, size_t count)
+{
+    size_t i = 0;
+#if defined(K4A_USING_SSE)
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 vx = _mm_loadu_ps(x + i);
+        __m128 vy = _mm_loadu_ps(y + i);
+        __m128 vz = _mm_loadu_ps(z + i);
+        _mm_storeu_ps(x + i, _mm_add_ps(math_dot_3_ps(A, vx, vy, vz), _mm_set1_ps(b[0])));
+        _mm_storeu_ps(y + i, _mm_add_ps(math_dot_3_ps(A + 3, vx, vy, vz), _mm_set1_ps(b[1])));
+        _mm_storeu_ps(z + i, _mm_add_ps(math_dot_3_ps(A + 6, vx, vy, vz), _mm_set1_ps(b[2])));
+    }
+#endif
+    for (; i < count; i++)
+    {
+        float v[3] = { x[i], y[i], z[i] };
+        math_affine_transform_3(A, v, b, v);
+        x[i] = v[0];
+        y[i] = v[1];
+        z[i] = v[2];
+    }
+}
+
+void math_quadratic_transform_3_soa(const float A[3 * 3],
+                                    const float B[3 * 3],
+                                    const float b[3],
+                                    float *x,
+                                    float *y,
+                                    float *z,
+                                    size_t count)
+{
+    size_t i = 0;
+#if defined(K4A_USING_SSE)
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 vx = _mm_loadu_ps(x + i);
+        __m128 vy = _mm_loadu_ps(y + i);
+        __m128 vz = _mm_loadu_ps(z + i);
+        __m128 vx2 = _mm_mul_ps(vx, vx);
+        __m128 vy2 = _mm_mul_ps(vy, vy);
+        __m128 vz2 = _mm_mul_ps(vz, vz);
+        for (int row = 0; row < 3; row++)
+        {
+            __m128 temp = _mm_add_ps(math_dot_3_ps(A + 3 * row, vx, vy, vz), _mm_set1_ps(b[row]));
+            __m128 out = _mm_add_ps(math_dot_3_ps(B + 3 * row, vx2, vy2, vz2), temp);
+            _mm_storeu_ps((row == 0 ? x : row == 1 ? y : z) + i, out);
+        }
+    }
+#endif
+    for (; i < count; i++)
+    {
+        float v[3] = { x[i], y[i], z[i] };
+        math_quadratic_transform_3(A, B, v, b, v);
+        x[i] = v[0];
+        y[i] = v[1];
+        z[i] = v[2];
+    }
+}
@@ -3,4 +3,6 @@ from ._bindings.device import Device
 from ._bindings.capture import Capture
 from ._bindings.image import Image
 from ._bindings.calibration import Calibration
-from ._bindings.transformation import Transformation
\ No newline at end of file
+from ._bindings.transformation import Transformation
+from ._bindings.capture_stream import CaptureStream
+from ._bindings.playback import PlaybackBatchReader
\ No newline at end of file
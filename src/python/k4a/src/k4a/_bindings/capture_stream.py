@@ -0,0 +1,205 @@
+'''!
+@file capture_stream.py
+
+Defines a CaptureStream class that reads captures from a Device on a
+background thread so that they are ready when the application asks for them.
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+Licensed under the MIT License.
+Kinect For Azure SDK.
+'''
+
+import threading as _threading
+import collections as _collections
+
+from .k4atypes import EStatus, EWaitStatus
+
+from .device import Device
+from .capture import Capture
+
+
+class CaptureStream:
+    '''! A class that prefetches captures from a Device on a background thread.
+
+    Property Name | Type | R/W | Description
+    ------------- | ---- | --- | -----------------------------------------
+    running       | bool | R   | True while the background thread reads captures.
+    dropped_count | int  | R   | The number of captures dropped because the queue was full.
+
+    @remarks
+    - Device.get_capture() waits for the next capture on the calling thread,
+        and the images of the capture are wrapped in Python objects when they
+        are first read. A CaptureStream does both on a background thread and
+        queues the result, so an application can process one capture with
+        NumPy while the next one is being read.
+
+    @remarks
+    - The ctypes calls into the SDK release the GIL while they wait for a
+        capture, so the background thread does not hold up the application
+        while no capture is available.
+
+    @remarks
+    - When the queue holds @p queue_size captures, the oldest capture is
+        dropped to make room for the newest one, as the SDK does with its own
+        capture queue.
+
+    @remarks
+    - The cameras must be started with Device.start_cameras() before start()
+        is called. Stop the stream with stop() before calling
+        Device.stop_cameras() or Device.close().
+    '''
+
+    # Time the background thread waits for a capture before checking whether it
+    # was asked to stop.
+    _POLL_TIMEOUT_MS = 100
+
+    def __init__(self, device:Device, queue_size:int=2, prefetch_images:bool=True):
+        '''! Create a capture stream for a device.
+
+        @param device (Device): An open Device.
+
+        @param queue_size (int, optional): The number of captures to hold
+            before the oldest one is dropped. Default value is 2.
+
+        @param prefetch_images (bool, optional): If True, the color, depth and
+            IR images of each capture are read on the background thread.
+            Default value is True.
+        '''
+        self._device = device
+        self._queue_size = max(1, queue_size)
+        self._prefetch_images = prefetch_images
+        self._queue = _collections.deque()
+        self._condition = _threading.Condition()
+        self._thread = None
+        self._stop_requested = False
+        self._running = False
+        self._dropped_count = 0
+
+    # Allow syntax "with k4a.CaptureStream(device) as stream:"
+    def __enter__(self):
+        self.start()
+        return self
+
+    # Called automatically when exiting "with" block.
+    def __exit__(self, exc_type, exc_val, exc_tb):
+        self.stop()
+
+    def __del__(self):
+        self.stop()
+
+    def start(self)->EStatus:
+        '''! Starts reading captures on the background thread.
+
+        @returns EStatus.SUCCEEDED if successful, EStatus.FAILED otherwise.
+
+        @remarks
+        - It is not valid to call start() a second time until stop() has
+            been called.
+        '''
+        if self._thread is not None:
+            return EStatus.FAILED
+
+        with self._condition:
+            self._queue.clear()
+            self._stop_requested = False
+            self._running = True
+            self._dropped_count = 0
+
+        self._thread = _threading.Thread(target=self._read_captures, daemon=True)
+        self._thread.start()
+
+        return EStatus.SUCCEEDED
+
+    def stop(self):
+        '''! Stops the background thread and drops the queued captures.
+
+        @remarks
+        - This function may be called while another thread is blocking in
+            get_capture(). That call will return None.
+        '''
+        if self._thread is None:
+            return
+
+        with self._condition:
+            self._stop_requested = True
+            self._condition.notify_all()
+
+        self._thread.join()
+        self._thread = None
+
+        with self._condition:
+            self._queue.clear()
+
+    def get_capture(self, timeout_ms:int)->Capture:
+        '''! Gets the oldest prefetched capture.
+
+        @param timeout_ms (int): Specifies the time in milliseconds the
+            function should block waiting for a capture. If set to 0, the
+            function will return without blocking. Passing a negative number
+            will block indefinitely until a capture is available or the stream
+            ends.
+
+        @returns An instance of a Capture class. If a capture is not available
+            in the configured @p timeout_ms, then None is returned.
+
+        @remarks
+        - The stream ends when stop() is called or when Device.get_capture()
+            fails, for example because the device was disconnected or the
+            cameras were stopped. Once the queued captures have been read, this
+            function returns None without waiting.
+        '''
+        timeout = None if timeout_ms < 0 else timeout_ms / 1000.0
+
+        with self._condition:
+            self._condition.wait_for(
+                lambda: len(self._queue) > 0 or not self._running, timeout)
+
+            if len(self._queue) == 0:
+                return None
+
+            return self._queue.popleft()
+
+    def _read_captures(self):
+        while True:
+            with self._condition:
+                if self._stop_requested:
+                    break
+
+            (capture, status) = self._device._get_capture_and_status(
+                CaptureStream._POLL_TIMEOUT_MS)
+
+            if status == EWaitStatus.TIMEOUT:
+                continue
+
+            if status != EWaitStatus.SUCCEEDED:
+                break
+
+            if self._prefetch_images:
+                # Reading the properties builds the Image objects and their
+                # NumPy arrays here rather than on the application's thread.
+                capture.color
+                capture.depth
+                capture.ir
+
+            with self._condition:
+                if len(self._queue) >= self._queue_size:
+                    self._queue.popleft()
+                    self._dropped_count += 1
+                self._queue.append(capture)
+                self._condition.notify_all()
+
+        with self._condition:
+            self._running = False
+            self._condition.notify_all()
+
+    # Define properties and get/set functions. ###############
+    @property
+    def running(self):
+        with self._condition:
+            return self._running
+
+    @property
+    def dropped_count(self):
+        with self._condition:
+            return self._dropped_count
+    # ###############
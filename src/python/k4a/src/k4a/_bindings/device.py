@@ -327,9 +327,15 @@ class Device:
             stop_cameras() or close() is called on another thread, this 
             function will encounter an error and return None.
         '''
+        (capture, status) = self._get_capture_and_status(timeout_ms)
+        return capture
+
+    def _get_capture_and_status(self, timeout_ms:int)->(Capture, EWaitStatus):
+        # Like get_capture() but also returns the EWaitStatus so that a timeout
+        # can be told apart from the end of the stream.
         capture = None
 
-        # Get a capture handle.
+        # Get a capture handle. The ctypes call releases the GIL while it waits.
         capture_handle = _CaptureHandle()
         timeout_in_ms = _ctypes.c_int32(timeout_ms)
         status = k4a_device_get_capture(
@@ -337,10 +343,10 @@ class Device:
             _ctypes.byref(capture_handle),
             timeout_in_ms)
 
-        if status == EStatus.SUCCEEDED:
+        if status == EWaitStatus.SUCCEEDED:
             capture = Capture(capture_handle=capture_handle)
 
-        return capture
+        return (capture, status)
 
     def get_imu_sample(self, timeout_ms:int)->ImuSample:
         '''! Reads an IMU sample.
@@ -26,6 +26,14 @@ from .k4a import k4a_image_create, k4a_image_create_from_buffer, \
     k4a_image_get_white_balance, k4a_image_set_white_balance, \
     k4a_image_get_iso_speed, k4a_image_set_iso_speed
 
+class _ArrayInterface:
+    # Exposes an array interface so that an ndarray can view an image buffer.
+    # The ndarray references this object rather than the Image, so the Image
+    # does not end up in a reference cycle with its own data.
+    def __init__(self, interface:dict):
+        self.__array_interface__ = interface
+
+
 class Image:
     '''! A class that represents an image from an imaging sensor in an
     Azure Kinect device.
@@ -199,6 +207,14 @@ class Image:
     - Images stored in a capture are referenced by the capture until they are
     replaced or the capture is destroyed.
 
+    @remarks
+    - The image data is not copied to be used by other libraries. The data
+    property is a numpy ndarray that views the image buffer, and an Image can
+    be passed directly to numpy.asarray(), through the __array_interface__
+    attribute, or to memoryview() on Python 3.12 and later. The views can in
+    turn be passed to torch.from_numpy() or OpenCV without a copy. Modifying a
+    view modifies the image.
+
     @remarks 
     - An Image object may be copied or deep copied. A shallow copy
         shares the same data as the original, and any changes in one will
@@ -215,6 +231,10 @@ class Image:
         # object is created by the user with a backing buffer or not.
         self._data = None
 
+        # The ndarray whose memory backs the image, if it was created with
+        # create_from_ndarray().
+        self._buffer_owner = None
+
         self._image_format = None
         self._size_bytes = None
         self._width_pixels = None
@@ -227,44 +247,51 @@ class Image:
         self._iso_speed = None
 
     @staticmethod
-    def _get_array_type_from_format(
+    def _get_array_interface_from_format(
         image_format:EImageFormat,
-        buffer_size:int, 
-        width_pixels:int, 
-        height_pixels:int):
+        buffer_address:int,
+        buffer_size:int,
+        width_pixels:int,
+        height_pixels:int,
+        stride_bytes:int):
 
-        array_type = None
-        array_len_bytes = 0
+        # Describe the SDK buffer with the NumPy array interface so that an
+        # ndarray can view it in place. The rows are stride_bytes apart, which
+        # may be more than the bytes in a row of pixels.
+        shape = None
+        typestr = '|u1'
+        strides = None
 
         if image_format == EImageFormat.COLOR_MJPG:
-            array_type = _ctypes.c_ubyte * buffer_size
-            array_len_bytes = buffer_size
+            shape = (buffer_size,)
         elif image_format == EImageFormat.COLOR_NV12:
-            array_type = ((_ctypes.c_ubyte * 1) * width_pixels) * (height_pixels + int(height_pixels/2)) 
-            array_len_bytes = width_pixels * (height_pixels + int(height_pixels/2))
+            shape = (height_pixels + int(height_pixels/2), width_pixels)
+            strides = (stride_bytes, 1)
         elif image_format == EImageFormat.COLOR_YUY2:
-            array_type = (_ctypes.c_ubyte * width_pixels*2) * height_pixels
-            array_len_bytes = width_pixels * height_pixels * 2
+            shape = (height_pixels, width_pixels * 2)
+            strides = (stride_bytes, 1)
         elif image_format == EImageFormat.COLOR_BGRA32:
-            array_type = ((_ctypes.c_ubyte * 4) * width_pixels) * height_pixels
-            array_len_bytes = width_pixels * height_pixels * 4
-        elif image_format == EImageFormat.DEPTH16:
-            array_type = (_ctypes.c_uint16 * width_pixels) * height_pixels
-            array_len_bytes = width_pixels * height_pixels * 2
-        elif image_format == EImageFormat.IR16:
-            array_type = (_ctypes.c_uint16 * width_pixels) * height_pixels
-            array_len_bytes = width_pixels * height_pixels * 2
-        elif image_format == EImageFormat.CUSTOM16:
-            array_type = (_ctypes.c_uint16 * width_pixels) * height_pixels
-            array_len_bytes = width_pixels * height_pixels * 2
+            shape = (height_pixels, width_pixels, 4)
+            strides = (stride_bytes, 4, 1)
+        elif image_format in (EImageFormat.DEPTH16, EImageFormat.IR16, EImageFormat.CUSTOM16):
+            shape = (height_pixels, width_pixels)
+            typestr = '<u2'
+            strides = (stride_bytes, 2)
         elif image_format == EImageFormat.CUSTOM8:
-            array_type = (_ctypes.c_uint8 * width_pixels) * height_pixels
-            array_len_bytes = width_pixels * height_pixels
+            shape = (height_pixels, width_pixels)
+            strides = (stride_bytes, 1)
         elif image_format == EImageFormat.CUSTOM:
-            array_type = _ctypes.c_ubyte * buffer_size
-            array_len_bytes = buffer_size
+            shape = (buffer_size,)
 
-        return (array_type, array_len_bytes)
+        if shape is None:
+            return None
+
+        return {
+            'shape': shape,
+            'typestr': typestr,
+            'strides': strides,
+            'data': (buffer_address, False),
+            'version': 3}
 
     # This static method should not be called by users.
     # It is an internal-only function for instantiating an Image object.
@@ -400,41 +427,42 @@ class Image:
         '''
         image = None
 
-        assert(isinstance(arr, _nd.ndarray)), "arr must be a numpy ndarray object."
+        assert(isinstance(arr, _np.ndarray)), "arr must be a numpy ndarray object."
         assert(isinstance(image_format, EImageFormat)), "image_format parameter must be an EImageFormat."
+        assert(arr.flags.c_contiguous), "arr must be C contiguous."
 
-        # Get buffer pointer and sizes of the numpy ndarray.
-        buffer_ptr = ctypes.cast(
-            _ctypes.addressof(np.ctypeslib.as_ctypes(arr)), 
-            _ctypes.POINTER(_ctypes.c_uint8))
+        # Get buffer pointer and sizes of the numpy ndarray. The SDK uses the
+        # ndarray memory in place rather than a copy of it.
+        buffer_ptr = arr.ctypes.data_as(_ctypes.POINTER(_ctypes.c_uint8))
 
-        width_pixels = _ctypes.c_int(width_pixels_custom)
-        height_pixels = _ctypes.c_int(height_pixels_custom)
-        stride_bytes = _ctypes.c_int(stride_bytes_custom)
-        size_bytes = _ctypes.c_size_t(size_bytes_custom)
+        width_pixels = width_pixels_custom
+        height_pixels = height_pixels_custom
+        stride_bytes = stride_bytes_custom
+        size_bytes = size_bytes_custom
 
-        # Use the ndarray sizes if the custom size info is not passed in.
+        # Use the ndarray sizes if the custom size info is not passed in. The
+        # ndarray is indexed by row first, like the data property.
         if width_pixels == 0:
-            width_pixels = _ctypes.c_int(arr.shape[0])
+            width_pixels = arr.shape[1] if len(arr.shape) > 1 else arr.shape[0]
 
         if height_pixels == 0:
-            height_pixels = _ctypes.c_int(arr.shape[1])
+            height_pixels = arr.shape[0] if len(arr.shape) > 1 else 1
 
         if size_bytes == 0:
-            size_bytes = _ctypes.c_size_t(arr.itemsize * arr.size)
+            size_bytes = arr.nbytes
 
-        if len(arr.shape) > 2 and stride_bytes == 0:
-            stride_bytes = _ctypes.c_int(arr.shape[2])
+        if stride_bytes == 0 and len(arr.shape) > 1:
+            stride_bytes = arr.strides[0]
 
         # Create image from the numpy buffer.
         image_handle = _ImageHandle()
         status = k4a_image_create_from_buffer(
             image_format,
-            width_pixels,
-            height_pixels,
-            stride_bytes,
+            _ctypes.c_int(width_pixels),
+            _ctypes.c_int(height_pixels),
+            _ctypes.c_int(stride_bytes),
             buffer_ptr,
-            size_bytes,
+            _ctypes.c_size_t(size_bytes),
             None,
             None,
             _ctypes.byref(image_handle))
@@ -442,6 +470,9 @@ class Image:
         if status == EStatus.SUCCEEDED:
             image = Image._create_from_existing_image_handle(image_handle)
 
+            # The image must not outlive the memory it views.
+            image._buffer_owner = arr
+
         return image
 
     def _release(self):
@@ -472,6 +503,7 @@ class Image:
         # Create a shallow copy.
         new_image = Image(self._image_handle)
         new_image._data = self._data.view()
+        new_image._buffer_owner = self._buffer_owner
         new_image._image_format = self._image_format
         new_image._size_bytes = self._size_bytes
         new_image._width_pixels = self._width_pixels
@@ -579,16 +611,30 @@ class Image:
             assert(stride_bytes > height_pixels), "stride_bytes must be greater than height_pixels."
 
             # Construct a descriptor of the data in the buffer.
-            (array_type, array_len_bytes) = Image._get_array_type_from_format(
-                image_format, buffer_size, width_pixels, height_pixels)
-            assert(array_type is not None), "Unrecognized image format."
-            assert(array_len_bytes <= buffer_size), "ndarray size should be less than buffer size in bytes."
-
-            self._data = _np.ctypeslib.as_array(array_type.from_address(
-                _ctypes.c_void_p.from_buffer(buffer_ptr).value))
+            interface = Image._get_array_interface_from_format(
+                image_format,
+                _ctypes.cast(buffer_ptr, _ctypes.c_void_p).value,
+                buffer_size,
+                width_pixels,
+                height_pixels,
+                stride_bytes)
+            assert(interface is not None), "Unrecognized image format."
+
+            self._data = _np.asarray(_ArrayInterface(interface))
+            assert(self._data.nbytes <= buffer_size), "ndarray size should be less than buffer size in bytes."
 
         return self._data
 
+    @property
+    def __array_interface__(self):
+        # Lets numpy.asarray(image) view the image buffer without a copy.
+        return self.data.__array_interface__
+
+    def __buffer__(self, flags:int):
+        # Python 3.12 buffer protocol, lets memoryview(image) view the image
+        # buffer without a copy.
+        return memoryview(self.data)
+
     @data.deleter
     def data(self):
         del self._data
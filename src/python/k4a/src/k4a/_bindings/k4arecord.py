@@ -0,0 +1,102 @@
+'''!
+@file k4arecord.py
+
+Defines Python _ctypes equivalent functions to the playback functions defined
+in k4arecord/playback.h.
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+Licensed under the MIT License.
+Kinect For Azure SDK.
+'''
+
+
+import ctypes as _ctypes
+import os.path as _os_path
+import platform as _platform
+
+from .k4atypes import *
+from .k4atypes import _PlaybackHandle, _CaptureHandle, _Calibration
+
+
+__all__ = []
+
+
+# Load the k4arecord.dll. Unlike k4a.dll it is optional, only playback needs it.
+_k4arecord_lib = None
+try:
+    _IS_WINDOWS = 'Windows' == _platform.system()
+    _lib_dir = _os_path.join(_os_path.dirname(_os_path.dirname(__file__)), '_libs')
+
+    if _IS_WINDOWS:
+        _k4arecord_lib = _ctypes.CDLL(_os_path.join(_lib_dir, 'k4arecord.dll'))
+    else:
+        _k4arecord_lib = _ctypes.CDLL(_os_path.join(_lib_dir, 'libk4arecord.so'))
+
+except Exception:
+    _k4arecord_lib = None
+
+
+def k4arecord_is_loaded()->bool:
+    return _k4arecord_lib is not None
+
+
+# Map _ctypes symbols to functions in the k4arecord.dll.
+if _k4arecord_lib is not None:
+
+    #K4ARECORD_EXPORT k4a_result_t k4a_playback_open(const char *path, k4a_playback_t *playback_handle);
+    k4a_playback_open = _k4arecord_lib.k4a_playback_open
+    k4a_playback_open.restype = EStatus
+    k4a_playback_open.argtypes = (_ctypes.c_char_p, _ctypes.POINTER(_PlaybackHandle))
+
+
+    #K4ARECORD_EXPORT k4a_result_t k4a_playback_clone(k4a_playback_t playback_handle, k4a_playback_t *clone_handle);
+    k4a_playback_clone = _k4arecord_lib.k4a_playback_clone
+    k4a_playback_clone.restype = EStatus
+    k4a_playback_clone.argtypes = (_PlaybackHandle, _ctypes.POINTER(_PlaybackHandle))
+
+
+    #K4ARECORD_EXPORT k4a_result_t k4a_playback_get_calibration(k4a_playback_t playback_handle,
+    #                                                           k4a_calibration_t *calibration);
+    k4a_playback_get_calibration = _k4arecord_lib.k4a_playback_get_calibration
+    k4a_playback_get_calibration.restype = EStatus
+    k4a_playback_get_calibration.argtypes = (_PlaybackHandle, _ctypes.POINTER(_Calibration))
+
+
+    #K4ARECORD_EXPORT k4a_result_t k4a_playback_set_color_conversion(k4a_playback_t playback_handle,
+    #                                                                k4a_image_format_t target_format);
+    k4a_playback_set_color_conversion = _k4arecord_lib.k4a_playback_set_color_conversion
+    k4a_playback_set_color_conversion.restype = EStatus
+    k4a_playback_set_color_conversion.argtypes = (_PlaybackHandle, _ctypes.c_int)
+
+
+    #K4ARECORD_EXPORT k4a_result_t k4a_playback_set_decode_ahead(k4a_playback_t playback_handle, uint32_t capture_count);
+    k4a_playback_set_decode_ahead = _k4arecord_lib.k4a_playback_set_decode_ahead
+    k4a_playback_set_decode_ahead.restype = EStatus
+    k4a_playback_set_decode_ahead.argtypes = (_PlaybackHandle, _ctypes.c_uint32)
+
+
+    #K4ARECORD_EXPORT k4a_stream_result_t k4a_playback_get_next_capture(k4a_playback_t playback_handle,
+    #                                                                   k4a_capture_t *capture_handle);
+    k4a_playback_get_next_capture = _k4arecord_lib.k4a_playback_get_next_capture
+    k4a_playback_get_next_capture.restype = EStreamResult
+    k4a_playback_get_next_capture.argtypes = (_PlaybackHandle, _ctypes.POINTER(_CaptureHandle))
+
+
+    #K4ARECORD_EXPORT uint64_t k4a_playback_get_capture_count(k4a_playback_t playback_handle);
+    k4a_playback_get_capture_count = _k4arecord_lib.k4a_playback_get_capture_count
+    k4a_playback_get_capture_count.restype = _ctypes.c_uint64
+    k4a_playback_get_capture_count.argtypes = (_PlaybackHandle,)
+
+
+    #K4ARECORD_EXPORT k4a_stream_result_t k4a_playback_get_capture_at_index(k4a_playback_t playback_handle,
+    #                                                                       uint64_t capture_index,
+    #                                                                       k4a_capture_t *capture_handle);
+    k4a_playback_get_capture_at_index = _k4arecord_lib.k4a_playback_get_capture_at_index
+    k4a_playback_get_capture_at_index.restype = EStreamResult
+    k4a_playback_get_capture_at_index.argtypes = (_PlaybackHandle, _ctypes.c_uint64, _ctypes.POINTER(_CaptureHandle))
+
+
+    #K4ARECORD_EXPORT void k4a_playback_close(k4a_playback_t playback_handle);
+    k4a_playback_close = _k4arecord_lib.k4a_playback_close
+    k4a_playback_close.restype = None
+    k4a_playback_close.argtypes = (_PlaybackHandle,)
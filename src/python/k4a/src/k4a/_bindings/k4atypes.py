@@ -69,6 +69,21 @@ class EWaitStatus(_IntEnum):
     TIMEOUT = _auto()
 
 
+@_unique
+class EStreamResult(_IntEnum):
+    '''! Result code returned by Azure Kinect playback APIs.
+
+    Name                            | Description
+    ------------------------------- | -----------------------------------------
+    EStreamResult.SUCCEEDED         | Successful result status.
+    EStreamResult.FAILED            | Failed result status.
+    EStreamResult.EOF               | The end of the data stream was reached.
+    '''
+    SUCCEEDED = 0
+    FAILED = _auto()
+    EOF = _auto()
+
+
 @_unique
 class ELogLevel(_IntEnum):
     '''! Verbosity levels of debug messaging.
@@ -594,6 +609,14 @@ class __handle_k4a_transformation_t(_ctypes.Structure):
 _TransformationHandle = _ctypes.POINTER(__handle_k4a_transformation_t)
 
 
+# K4A_DECLARE_HANDLE(k4a_playback_t);
+class __handle_k4a_playback_t(_ctypes.Structure):
+     _fields_= [
+        ("_rsvd", _ctypes.c_size_t),
+    ]
+_PlaybackHandle = _ctypes.POINTER(__handle_k4a_playback_t)
+
+
 class DeviceConfiguration(_ctypes.Structure):
     '''! Configuration parameters for an Azure Kinect device.
 
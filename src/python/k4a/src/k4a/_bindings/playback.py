@@ -0,0 +1,410 @@
+'''!
+@file playback.py
+
+Defines a PlaybackBatchReader class that reads the captures of a recording in
+batches of stacked numpy ndarrays.
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+Licensed under the MIT License.
+Kinect For Azure SDK.
+'''
+
+import ctypes as _ctypes
+import threading as _threading
+import numpy as _np
+
+from .k4atypes import _PlaybackHandle, _CaptureHandle, _Calibration, \
+    EStatus, EStreamResult, EImageFormat, EDepthMode, EColorResolution
+
+from .k4a import k4a_capture_release, k4a_capture_get_color_image, \
+    k4a_capture_get_depth_image, k4a_capture_get_ir_image, \
+    k4a_image_get_device_timestamp_usec
+
+from .k4arecord import k4arecord_is_loaded
+
+from .image import Image
+from .calibration import Calibration
+from .transformation import Transformation
+
+if k4arecord_is_loaded():
+    from .k4arecord import k4a_playback_open, k4a_playback_clone, \
+        k4a_playback_get_calibration, k4a_playback_set_color_conversion, \
+        k4a_playback_set_decode_ahead, k4a_playback_get_next_capture, \
+        k4a_playback_get_capture_count, k4a_playback_get_capture_at_index, \
+        k4a_playback_close
+
+
+class PlaybackBatchReader:
+    '''! A class that reads the captures of a recording in batches.
+
+    Property Name | Type        | R/W | Description
+    ------------- | ----------- | --- | -----------------------------------------
+    calibration   | Calibration | R   | The calibration of the recording.
+    capture_count | int         | R   | The number of captures in the recording.
+    batch_size    | int         | R   | The number of captures in a batch.
+
+    @remarks
+    - Use the static factory function open() to get a PlaybackBatchReader
+        instance.
+
+    @remarks
+    - A batch is a dict of numpy ndarrays that each stack the images of
+        N consecutive captures, where N is the batch size, or less for the
+        last batch of the recording:
+        - 'color': (N, H, W, 4) uint8 BGRA color images.
+        - 'depth': (N, H, W, 1) uint16 depth images, in the geometry of the
+            color camera if the reader transforms depth to color.
+        - 'ir': (N, H, W, 1) uint16 IR images, only if depth is not
+            transformed to the color camera.
+        - 'device_timestamp_usec': (N,) uint64 device timestamps of the
+            captures.
+        A stream that is not in the recording has no entry. An image missing
+        from a capture is left as zeros, and so is its timestamp if the
+        capture has no image at all.
+
+    @remarks
+    - Iterating over the reader reads the batches in order on background
+        threads. Each thread reads from its own handle to the recording, and
+        the color images are decoded ahead by the playback's native thread
+        pool. The ctypes calls release the GIL, so the batches are read while
+        the application processes the previous ones.
+
+    @remarks
+    - The reader also supports len() and indexing, so it can be used as a
+        map-style PyTorch Dataset with a DataLoader batch_size of None. Each
+        DataLoader worker process should open its own reader.
+    '''
+
+    # Most captures the playback decodes ahead, see k4a_playback_set_decode_ahead().
+    _MAX_DECODE_AHEAD = 16
+
+    def __init__(self):
+        self._handles = []
+        self._transformations = []
+        self._transformed_depth = []
+        self._handle_locks = []
+        self._calibration = None
+        self._capture_count = 0
+        self._batch_size = 1
+        self._drop_last = False
+        self._color_shape = None
+        self._depth_shape = None
+        self._ir_shape = None
+        self._prefetch_batches = 1
+
+        self._condition = _threading.Condition()
+        self._threads = []
+        self._results = {}
+        self._next_batch = 0
+        self._stop_requested = False
+
+    # Allow syntax "with k4a.PlaybackBatchReader.open(path, 8) as reader:"
+    def __enter__(self):
+        return self
+
+    # Called automatically when exiting "with" block.
+    def __exit__(self, exc_type, exc_val, exc_tb):
+        self.close()
+
+    def __del__(self):
+        self.close()
+
+    @staticmethod
+    def open(
+        path:str,
+        batch_size:int,
+        color_format:EImageFormat=EImageFormat.COLOR_BGRA32,
+        depth_to_color:bool=False,
+        num_workers:int=1,
+        prefetch_batches:int=2,
+        drop_last:bool=False):
+        '''! Open a recording for reading in batches.
+
+        @param path (str): The path of the recording.
+
+        @param batch_size (int): The number of captures in a batch.
+
+        @param color_format (EImageFormat, optional): EImageFormat.COLOR_BGRA32
+            to read the color images converted to BGRA, or None to skip the
+            color images. Default value is EImageFormat.COLOR_BGRA32.
+
+        @param depth_to_color (bool, optional): If True, the depth images are
+            transformed into the geometry of the color camera. Default value
+            is False.
+
+        @param num_workers (int, optional): The number of background threads
+            reading batches when iterating. Default value is 1.
+
+        @param prefetch_batches (int, optional): The number of batches read
+            ahead of the one the application is processing. Default value is 2.
+
+        @param drop_last (bool, optional): If True, a last batch with fewer
+            than @p batch_size captures is dropped. Default value is False.
+
+        @returns An instance of a PlaybackBatchReader. If the recording can't
+            be opened or the options are not supported, then None is returned.
+
+        @remarks
+        - Transforming depth to color requires both streams in the recording.
+        '''
+        if not k4arecord_is_loaded():
+            return None
+
+        if batch_size < 1 or num_workers < 1:
+            return None
+
+        if color_format is not None and color_format != EImageFormat.COLOR_BGRA32:
+            # Only BGRA images have the same shape in every capture.
+            return None
+
+        reader = PlaybackBatchReader()
+        reader._batch_size = batch_size
+        reader._drop_last = drop_last
+        reader._prefetch_batches = max(1, prefetch_batches)
+
+        handle = _PlaybackHandle()
+        if k4a_playback_open(path.encode('utf-8'), _ctypes.byref(handle)) != EStatus.SUCCEEDED:
+            return None
+        reader._handles.append(handle)
+
+        _calibration = _Calibration()
+        if k4a_playback_get_calibration(handle, _ctypes.byref(_calibration)) != EStatus.SUCCEEDED:
+            reader.close()
+            return None
+        reader._calibration = Calibration(_calibration=_calibration)
+
+        has_color = (color_format is not None and
+            reader._calibration.color_resolution != EColorResolution.OFF)
+        has_depth = reader._calibration.depth_mode != EDepthMode.OFF
+
+        if depth_to_color and not (has_depth and
+            reader._calibration.color_resolution != EColorResolution.OFF):
+            reader.close()
+            return None
+
+        color_cal = reader._calibration.color_cam_cal
+        depth_cal = reader._calibration.depth_cam_cal
+
+        if has_color:
+            if k4a_playback_set_color_conversion(handle, color_format) != EStatus.SUCCEEDED:
+                reader.close()
+                return None
+            reader._color_shape = (color_cal.resolution_height, color_cal.resolution_width, 4)
+
+        if has_depth:
+            if depth_to_color:
+                reader._depth_shape = (color_cal.resolution_height, color_cal.resolution_width, 1)
+            else:
+                reader._depth_shape = (depth_cal.resolution_height, depth_cal.resolution_width, 1)
+                reader._ir_shape = reader._depth_shape
+
+        # The clones get the color conversion, decode ahead is set on each.
+        for i in range(1, num_workers):
+            clone = _PlaybackHandle()
+            if k4a_playback_clone(handle, _ctypes.byref(clone)) != EStatus.SUCCEEDED:
+                reader.close()
+                return None
+            reader._handles.append(clone)
+
+        for worker_handle in reader._handles:
+            if has_color:
+                k4a_playback_set_decode_ahead(
+                    worker_handle, min(batch_size, PlaybackBatchReader._MAX_DECODE_AHEAD))
+
+            reader._handle_locks.append(_threading.Lock())
+            reader._transformed_depth.append(None)
+            if depth_to_color:
+                reader._transformations.append(Transformation(reader._calibration))
+
+        reader._capture_count = k4a_playback_get_capture_count(handle)
+
+        return reader
+
+    def close(self):
+        '''! Stops reading and closes the recording.
+        '''
+        self._stop_workers()
+
+        for handle in self._handles:
+            k4a_playback_close(handle)
+
+        self._handles = []
+        self._transformed_depth = []
+        self._transformations = []
+
+    def __len__(self):
+        if self._drop_last:
+            return self._capture_count // self._batch_size
+        return (self._capture_count + self._batch_size - 1) // self._batch_size
+
+    def __getitem__(self, batch_index:int)->dict:
+        if batch_index < 0:
+            batch_index += len(self)
+        if batch_index < 0 or batch_index >= len(self):
+            raise IndexError("batch index out of range")
+
+        batch = self.get_batch(batch_index)
+        if batch is None:
+            raise IOError("failed to read the recording")
+        return batch
+
+    def __iter__(self):
+        self._start_workers()
+        try:
+            for batch_index in range(len(self)):
+                with self._condition:
+                    self._condition.wait_for(lambda: batch_index in self._results)
+                    batch = self._results.pop(batch_index)
+                    self._next_batch = batch_index + 1
+                    self._condition.notify_all()
+
+                if batch is None:
+                    break
+
+                yield batch
+        finally:
+            self._stop_workers()
+
+    def get_batch(self, batch_index:int)->dict:
+        '''! Reads a batch on the calling thread.
+
+        @param batch_index (int): The index of the batch, from 0 to len() - 1.
+
+        @returns A dict of stacked numpy ndarrays, see the class remarks. If
+            the batch can't be read, then None is returned.
+        '''
+        if batch_index < 0 or batch_index >= len(self):
+            return None
+
+        return self._read_batch(0, batch_index)
+
+    def _start_workers(self):
+        self._stop_workers()
+
+        with self._condition:
+            self._results = {}
+            self._next_batch = 0
+            self._stop_requested = False
+
+        for worker in range(len(self._handles)):
+            thread = _threading.Thread(target=self._run_worker, args=(worker,), daemon=True)
+            self._threads.append(thread)
+            thread.start()
+
+    def _stop_workers(self):
+        with self._condition:
+            self._stop_requested = True
+            self._condition.notify_all()
+
+        for thread in self._threads:
+            thread.join()
+        self._threads = []
+
+        with self._condition:
+            self._results = {}
+
+    def _run_worker(self, worker:int):
+        # Worker w reads batches w, w + num_workers, ... at most
+        # prefetch_batches ahead of the batch the application is processing.
+        for batch_index in range(worker, len(self), len(self._handles)):
+            with self._condition:
+                self._condition.wait_for(lambda: self._stop_requested or
+                    batch_index < self._next_batch + self._prefetch_batches)
+                if self._stop_requested:
+                    return
+
+            try:
+                batch = self._read_batch(worker, batch_index)
+            except Exception:
+                # End the iteration rather than leave it waiting for the batch.
+                batch = None
+
+            with self._condition:
+                self._results[batch_index] = batch
+                self._condition.notify_all()
+
+            if batch is None:
+                return
+
+    def _allocate_batch(self, count:int)->dict:
+        batch = {'device_timestamp_usec': _np.zeros((count,), dtype=_np.uint64)}
+        if self._color_shape is not None:
+            batch['color'] = _np.zeros((count,) + self._color_shape, dtype=_np.uint8)
+        if self._depth_shape is not None:
+            batch['depth'] = _np.zeros((count,) + self._depth_shape, dtype=_np.uint16)
+        if self._ir_shape is not None:
+            batch['ir'] = _np.zeros((count,) + self._ir_shape, dtype=_np.uint16)
+        return batch
+
+    def _read_batch(self, worker:int, batch_index:int)->dict:
+        start = batch_index * self._batch_size
+        count = min(self._batch_size, self._capture_count - start)
+        batch = self._allocate_batch(count)
+
+        with self._handle_locks[worker]:
+            handle = self._handles[worker]
+            for i in range(count):
+                capture_handle = _CaptureHandle()
+                if i == 0:
+                    result = k4a_playback_get_capture_at_index(handle, start, _ctypes.byref(capture_handle))
+                else:
+                    result = k4a_playback_get_next_capture(handle, _ctypes.byref(capture_handle))
+
+                if result != EStreamResult.SUCCEEDED:
+                    return None
+
+                try:
+                    self._copy_capture(worker, capture_handle, batch, i)
+                finally:
+                    k4a_capture_release(capture_handle)
+
+        return batch
+
+    def _copy_capture(self, worker:int, capture_handle:_CaptureHandle, batch:dict, i:int):
+        timestamp_usec = 0
+
+        if 'color' in batch:
+            color = self._get_image(k4a_capture_get_color_image(capture_handle))
+            if color is not None:
+                timestamp_usec = k4a_image_get_device_timestamp_usec(color._image_handle)
+                _np.copyto(batch['color'][i], color.data)
+
+        if 'depth' in batch:
+            depth = self._get_image(k4a_capture_get_depth_image(capture_handle))
+            if depth is not None:
+                timestamp_usec = k4a_image_get_device_timestamp_usec(depth._image_handle)
+                if len(self._transformations) > 0:
+                    # Reuse the output image of the previous capture.
+                    depth = self._transformations[worker].depth_image_to_color_camera(
+                        depth, out=self._transformed_depth[worker])
+                    self._transformed_depth[worker] = depth
+                if depth is not None:
+                    _np.copyto(batch['depth'][i, :, :, 0], depth.data)
+
+        if 'ir' in batch:
+            ir = self._get_image(k4a_capture_get_ir_image(capture_handle))
+            if ir is not None:
+                _np.copyto(batch['ir'][i, :, :, 0], ir.data)
+
+        batch['device_timestamp_usec'][i] = timestamp_usec
+
+    @staticmethod
+    def _get_image(image_handle)->Image:
+        # Images a capture does not have are returned as NULL handles.
+        if not image_handle:
+            return None
+        return Image._create_from_existing_image_handle(image_handle)
+
+    # Define properties and get/set functions. ###############
+    @property
+    def calibration(self):
+        return self._calibration
+
+    @property
+    def capture_count(self):
+        return self._capture_count
+
+    @property
+    def batch_size(self):
+        return self._batch_size
+    # ###############
@@ -22,8 +22,7 @@ from .k4a import k4a_transformation_create, k4a_transformation_destroy, \
     k4a_transformation_depth_image_to_color_camera, \
     k4a_transformation_depth_image_to_color_camera_custom, \
     k4a_transformation_color_image_to_depth_camera, \
-    k4a_transformation_depth_image_to_point_cloud, \
-    k4a_image_get_buffer
+    k4a_transformation_depth_image_to_point_cloud
 
 from .calibration import Calibration
 from .image import Image
@@ -373,11 +372,15 @@ class Transformation:
 
         return target_point
 
-    def depth_image_to_color_camera(self, depth:Image)->Image:
+    def depth_image_to_color_camera(self, depth:Image, out:Image=None)->Image:
         '''! Transforms the depth map into the geometry of the color camera.
 
         @param depth (Image): The depth image.
 
+        @param out (Image, optional): An image to write the transformed depth
+            image to, such as the one returned by a previous call. If None, a
+            new image is created.
+
         @returns (Image): The transformed depth image in the color camera
             coordinates. If an error occurs, then None is returned.
 
@@ -393,17 +396,24 @@ class Transformation:
         - The output transformed depth image will have a width and height 
             matching the width and height of the color camera in the mode
             specified by the Calibration used to create the Transformation.
+
+        @remarks
+        - Passing the image returned by the previous call as @p out avoids
+            allocating an image for every frame. The data of @p out is
+            overwritten.
         '''
         
         width_pixels = self._calibration.color_cam_cal.resolution_width
         height_pixels = self._calibration.color_cam_cal.resolution_height
 
         # Create an output image.
-        transformed_depth_image = Image.create(
-            depth.image_format,
-            width_pixels,
-            height_pixels,
-            width_pixels * 2)
+        transformed_depth_image = out
+        if transformed_depth_image is None:
+            transformed_depth_image = Image.create(
+                depth.image_format,
+                width_pixels,
+                height_pixels,
+                width_pixels * 2)
 
         status = k4a_transformation_depth_image_to_color_camera(
             self.__transform_handle,
@@ -412,11 +422,6 @@ class Transformation:
 
         if (status != EStatus.SUCCEEDED):
             transformed_depth_image = None
-        else:
-            buffer_ptr = k4a_image_get_buffer(transformed_depth_image._image_handle)
-            array_type = (_ctypes.c_uint16 * height_pixels) * width_pixels
-            self._data = _np.ctypeslib.as_array(array_type.from_address(
-                _ctypes.c_void_p.from_buffer(buffer_ptr).value))
 
         return transformed_depth_image
 
@@ -424,7 +429,9 @@ class Transformation:
         depth:Image,
         custom:Image,
         interp_type:ETransformInterpolationType,
-        invalid_value:int)->(Image, Image):
+        invalid_value:int,
+        out_depth:Image=None,
+        out_custom:Image=None)->(Image, Image):
         '''! Transforms depth map and a custom image into the geometry of the
         color camera.
 
@@ -444,6 +451,12 @@ class Transformation:
             should be written to the transformed images in case the corresponding
             depth pixel can not be transformed into the color camera space.
 
+        @param out_depth (Image, optional): An image to write the transformed
+            depth image to. If None, a new image is created.
+
+        @param out_custom (Image, optional): An image to write the transformed
+            custom image to. If None, a new image is created.
+
         @returns (Image, Image): The transformed depth image and transformed
             custom image in the color camera coordinates. If an error occurs, 
             then (None, None) is returned.
@@ -467,6 +480,11 @@ class Transformation:
             have a width and height matching the width and height of the color
             camera in the mode specified by the Calibration used to create the 
             Transformation.
+
+        @remarks
+        - Passing the images returned by the previous call as @p out_depth and
+            @p out_custom avoids allocating images for every frame. Their data
+            is overwritten.
         '''
 
         width_pixels = self._calibration.color_cam_cal.resolution_width
@@ -477,18 +495,22 @@ class Transformation:
             custom_stride_bytes = width_pixels * 2
 
         # Create an output image.
-        transformed_depth_image = Image.create(
-            depth.image_format,
-            width_pixels,
-            height_pixels,
-            width_pixels * 2)
+        transformed_depth_image = out_depth
+        if transformed_depth_image is None:
+            transformed_depth_image = Image.create(
+                depth.image_format,
+                width_pixels,
+                height_pixels,
+                width_pixels * 2)
 
         # Create an output image.
-        transformed_custom_image = Image.create(
-            custom.image_format,
-            width_pixels,
-            height_pixels,
-            custom_stride_bytes)
+        transformed_custom_image = out_custom
+        if transformed_custom_image is None:
+            transformed_custom_image = Image.create(
+                custom.image_format,
+                width_pixels,
+                height_pixels,
+                custom_stride_bytes)
 
         status = k4a_transformation_depth_image_to_color_camera_custom(
             self.__transform_handle,
@@ -507,13 +529,18 @@ class Transformation:
 
     def color_image_to_depth_camera(self,
         depth:Image,
-        color:Image)->Image:
+        color:Image,
+        out:Image=None)->Image:
         '''! Transforms a color image into the geometry of the depth camera.
 
         @param depth (Image): The depth image.
 
         @param color (Image): The color image to transform.
 
+        @param out (Image, optional): An image to write the transformed color
+            image to, such as the one returned by a previous call. If None, a
+            new image is created.
+
         @returns (Image): The transformed color image in the depth camera 
             coordinates. If an error occurs, then None is returned.
 
@@ -534,14 +561,21 @@ class Transformation:
         - The output transformed color image will have a width and height 
             matching the width and height of the depth camera in the mode 
             specified by the Calibration used to create the Transformation.
+
+        @remarks
+        - Passing the image returned by the previous call as @p out avoids
+            allocating an image for every frame. The data of @p out is
+            overwritten.
         '''
 
         # Create an output image.
-        transformed_color_image = Image.create(
-            color.image_format,
-            depth.width_pixels,
-            depth.height_pixels,
-            depth.width_pixels * 4)
+        transformed_color_image = out
+        if transformed_color_image is None:
+            transformed_color_image = Image.create(
+                color.image_format,
+                depth.width_pixels,
+                depth.height_pixels,
+                depth.width_pixels * 4)
 
         status = k4a_transformation_color_image_to_depth_camera(
             self.__transform_handle,
@@ -556,7 +590,8 @@ class Transformation:
 
     def depth_image_to_point_cloud(self,
         depth:Image, 
-        camera_type:ECalibrationType)->Image:
+        camera_type:ECalibrationType,
+        out:Image=None)->Image:
         '''! Transforms the depth image into 3 planar images representing 
             X, Y and Z-coordinates of corresponding 3D points.
 
@@ -565,6 +600,10 @@ class Transformation:
         @param camera_type (ECalibrationType): Geometry in which depth map was 
             computed.
 
+        @param out (Image, optional): An image to write the point cloud to,
+            such as the one returned by a previous call. If None, a new image
+            is created.
+
         @returns (Image): The output XYZ point cloud image in the depth camera 
             coordinates. If an error occurs, then None is returned.
 
@@ -586,14 +625,21 @@ class Transformation:
         - Each plane of the output image consists of the X, Y, and Z planar images of int16 samples.
           If out is the output image, then out[:,:,1] corresponds to the X coordinates, 
           out[:,:,2] corresponds to the Y coordinates, and out[:,:,3] is the Z depth image.
+
+        @remarks
+        - Passing the image returned by the previous call as @p out avoids
+            allocating an image for every frame. The data of @p out is
+            overwritten.
         '''
 
         # Create a custom image.
-        point_cloud_image = Image.create(
-            EImageFormat.CUSTOM,
-            depth.width_pixels,
-            depth.height_pixels,
-            depth.width_pixels * 6)
+        point_cloud_image = out
+        if point_cloud_image is None:
+            point_cloud_image = Image.create(
+                EImageFormat.CUSTOM,
+                depth.width_pixels,
+                depth.height_pixels,
+                depth.width_pixels * 6)
 
         status = k4a_transformation_depth_image_to_point_cloud(
             self.__transform_handle,
@@ -603,13 +649,11 @@ class Transformation:
 
         if (status != EStatus.SUCCEEDED):
             point_cloud_image = None
-        else:
-            # The ndarray for a CUSTOM image format is a flat buffer.
-            # Rewrite the ndarray to have 3 dimensions for X, Y, and Z points.
-            buffer_ptr = k4a_image_get_buffer(point_cloud_image._image_handle)
-            array_type = ((_ctypes.c_int16 * 3) * depth.width_pixels) * depth.height_pixels
-            point_cloud_image._data = _np.ctypeslib.as_array(array_type.from_address(
-                _ctypes.c_void_p.from_buffer(buffer_ptr).value))
+        elif point_cloud_image.data.ndim != 3:
+            # The ndarray for a CUSTOM image format is a flat buffer. View it
+            # in place with 3 dimensions for X, Y, and Z points.
+            point_cloud_image._data = point_cloud_image.data.view(_np.int16).reshape(
+                (depth.height_pixels, depth.width_pixels, 3))
 
         return point_cloud_image
 
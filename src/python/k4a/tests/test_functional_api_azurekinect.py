@@ -124,6 +124,28 @@ class Test_Functional_API_Device_AzureKinect(unittest.TestCase):
         # Stop the cameras.
         self.device.stop_cameras()
 
+    def test_functional_fast_api_capture_stream(self):
+
+        # Start the cameras.
+        status = self.device.start_cameras(
+            k4a.DEVICE_CONFIG_BGRA32_2160P_WFOV_UNBINNED_FPS15)
+        self.assertEqual(status, k4a.EStatus.SUCCEEDED)
+
+        # Get prefetched captures, waiting indefinitely.
+        with k4a.CaptureStream(self.device, queue_size=2) as stream:
+            self.assertTrue(stream.running)
+            for i in range(5):
+                capture = stream.get_capture(-1)
+                self.assertIsNotNone(capture)
+                self.assertIsNotNone(capture.depth)
+
+        # The stream ends when it is stopped.
+        self.assertFalse(stream.running)
+        self.assertIsNone(stream.get_capture(-1))
+
+        # Stop the cameras.
+        self.device.stop_cameras()
+
     def test_functional_fast_api_get_imu_sample(self):
 
         # Start the cameras.
@@ -620,6 +642,16 @@ class Test_Functional_API_Image_AzureKinect(unittest.TestCase):
         self.assertIsNotNone(data)
         self.assertIsInstance(data, np.ndarray)
 
+    def test_functional_fast_api_get_data_zero_copy(self):
+        depth = np.asarray(self.depth)
+        self.assertTrue(np.shares_memory(depth, self.depth.data))
+        self.assertEqual(depth.shape, (self.depth.height_pixels, self.depth.width_pixels))
+        self.assertEqual(depth.strides[0], self.depth.stride_bytes)
+
+        color = np.asarray(self.color)
+        self.assertTrue(np.shares_memory(color, self.color.data))
+        self.assertEqual(color.shape, (self.color.height_pixels, self.color.width_pixels, 4))
+
     def test_functional_fast_api_get_image_format(self):
         image_format = self.color.image_format
         self.assertIsNotNone(image_format)
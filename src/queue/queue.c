@@ -6,6 +6,7 @@
 
 // Dependent libraries
 #include <k4ainternal/allocator.h>
+#include <k4ainternal/atomic.h>
 #include <azure_c_shared_utility/lock.h>
 #include <azure_c_shared_utility/condition.h>
 #include <azure_c_shared_utility/threadapi.h>
@@ -22,18 +23,35 @@ typedef struct _queue_entry_t
 
 typedef struct _queue_context_t
 {
-    bool enabled;
+    volatile uint32_t enabled;
     bool stopped;
-    uint32_t queue_pop_blocked; // number of waiting threads for queue_pop so complete
-    uint32_t read_location;     // current location to read frokm
-    uint32_t write_location;    // current location to write to
-    queue_entry_t *queue;       // the queue array
-    uint32_t depth;             // 1 element larger than the max elements the queue can hold.
-    const char *name;           // Queue name in logger
-    uint32_t dropped_count;     // Count of the dropped captures
+    volatile uint32_t queue_pop_blocked; // number of waiting threads for queue_pop so complete
+    volatile uint32_t read_location;     // current location to read frokm
+    volatile uint32_t write_location;    // current location to write to
+    queue_entry_t *queue;                // the queue array
+    uint32_t depth;                      // 1 element larger than the max elements the queue can hold.
+    const char *name;                    // Queue name in logger
+    volatile uint32_t dropped_count;     // Count of the dropped captures
+
+    // Captures dropped since the queue was created, dropped_count is reset each time it is logged
+    volatile uint32_t total_dropped_count;
+
+    uint32_t capacity;                    // Max elements the queue can hold
+    k4a_queue_policy_t policy;            // What a push into a full queue does
+    volatile uint32_t queue_push_blocked; // number of threads waiting in a K4A_QUEUE_POLICY_BLOCK push for room
+
+    // Lock free queues (see queue_create_lockfree)
+    bool lockfree;
+    uint32_t mask;                 // Ring size minus 1, the ring size is a power of 2 no smaller than capacity
+    volatile uint32_t push_active; // Non zero while the producer is in queue_push_w_dropped
+
+    // Signaled while the queue holds captures or is disabled (see queue_get_wait_handle)
+    k4a_wait_handle_t wait_event;
+    volatile uint32_t wait_event_created; // Non zero once wait_event is valid, it is not destroyed before the queue
 
     LOCK_HANDLE lock;
     COND_HANDLE condition;
+    COND_HANDLE space_condition; // Posted when a pop makes room for a blocked push
 } queue_context_t;
 
 K4A_DECLARE_CONTEXT(queue_t, queue_context_t);
@@ -45,22 +63,67 @@ K4A_DECLARE_CONTEXT(queue_t, queue_context_t);
 #define is_queue_empty(queue) ((queue)->write_location == (queue)->read_location)
 #define is_queue_full(queue) (inc_read_write_location((queue), (queue)->write_location) == (queue)->read_location)
 
-k4a_result_t queue_create(uint32_t queue_depth, const char *queue_name, queue_t *queue_handle)
+// The lock free queue uses free running read and write counters, the number of elements held is write - read and the
+// entry is at counter & mask. An element is claimed by advancing the read counter with a compare and swap, which lets
+// the producer drop the oldest element while a consumer is popping it.
+#define lockfree_queue_count(queue, read) (k4a_atomic_load(&(queue)->write_location) - (read))
+#define lockfree_queue_entry(queue, location) (&(queue)->queue[(location) & (queue)->mask])
+
+// Allocates room for queue_depth captures. The queue must be empty and not in use.
+static k4a_result_t queue_allocate(queue_context_t *queue, uint32_t queue_depth)
+{
+    uint32_t depth;
+    if (queue->lockfree)
+    {
+        depth = 1;
+        while (depth < queue_depth)
+        {
+            depth <<= 1;
+        }
+    }
+    else
+    {
+        depth = queue_depth + 1; // Adding one; see comment on inc_read_write_location()
+    }
+
+    queue_entry_t *entries = malloc(sizeof(queue_entry_t) * depth);
+    k4a_result_t result = K4A_RESULT_FROM_BOOL(entries != NULL);
+
+    if (K4A_SUCCEEDED(result))
+    {
+        free(queue->queue);
+        queue->queue = entries;
+        queue->depth = depth;
+        queue->mask = depth - 1;
+        queue->capacity = queue_depth;
+        queue->read_location = 0;
+        queue->write_location = 0;
+    }
+    return result;
+}
+
+static k4a_result_t
+queue_create_internal(uint32_t queue_depth, const char *queue_name, bool lockfree, queue_t *queue_handle)
 {
     k4a_result_t result;
-    queue_context_t *queue = queue_t_create(queue_handle);
 
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, queue_handle == NULL);
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, queue_depth == 0);
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, queue_depth > 10000); // Sanity Check
-    queue->depth = queue_depth + 1;                              // Adding one; see comment on inc_read_write_location()
+
+    queue_context_t *queue = queue_t_create(queue_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, queue == NULL);
+
+    queue->lockfree = lockfree;
+    queue->wait_event = K4A_WAIT_HANDLE_INVALID;
+    queue->policy = K4A_QUEUE_POLICY_DROP_OLDEST;
     queue->name = queue_name;
     if (queue->name == NULL)
     {
         queue->name = "Unknown queue";
     }
 
-    queue->queue = malloc(sizeof(queue_entry_t) * queue->depth);
-    result = K4A_RESULT_FROM_BOOL(queue->queue != NULL);
+    result = TRACE_CALL(queue_allocate(queue, queue_depth));
 
     if (K4A_SUCCEEDED(result))
     {
@@ -71,8 +134,16 @@ k4a_result_t queue_create(uint32_t queue_depth, const char *queue_name, queue_t
     if (K4A_SUCCEEDED(result))
     {
         queue->condition = Condition_Init();
+        result = K4A_RESULT_FROM_BOOL(queue->condition != NULL);
     }
-    else
+
+    if (K4A_SUCCEEDED(result))
+    {
+        queue->space_condition = Condition_Init();
+        result = K4A_RESULT_FROM_BOOL(queue->space_condition != NULL);
+    }
+
+    if (K4A_FAILED(result))
     {
         if (queue)
         {
@@ -83,6 +154,291 @@ k4a_result_t queue_create(uint32_t queue_depth, const char *queue_name, queue_t
     return result;
 }
 
+k4a_result_t queue_create(uint32_t queue_depth, const char *queue_name, queue_t *queue_handle)
+{
+    return queue_create_internal(queue_depth, queue_name, false, queue_handle);
+}
+
+k4a_result_t queue_create_lockfree(uint32_t queue_depth, const char *queue_name, queue_t *queue_handle)
+{
+    return queue_create_internal(queue_depth, queue_name, true, queue_handle);
+}
+
+k4a_result_t queue_configure(queue_t queue_handle, uint32_t queue_depth, k4a_queue_policy_t policy)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, queue_t, queue_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, queue_depth == 0);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, queue_depth > 10000); // Sanity Check
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED,
+                        policy != K4A_QUEUE_POLICY_DROP_OLDEST && policy != K4A_QUEUE_POLICY_DROP_NEWEST &&
+                            policy != K4A_QUEUE_POLICY_BLOCK);
+    queue_context_t *queue = queue_t_get_context(queue_handle);
+
+    Lock(queue->lock);
+
+    // A disabled queue is empty and pushes leave it alone, so the storage can be replaced
+    k4a_result_t result = K4A_RESULT_FROM_BOOL(k4a_atomic_load(&queue->enabled) == false);
+    if (K4A_SUCCEEDED(result) && queue_depth != queue->capacity)
+    {
+        result = TRACE_CALL(queue_allocate(queue, queue_depth));
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        queue->policy = policy;
+    }
+
+    Unlock(queue->lock);
+    return result;
+}
+
+// Wakes a push waiting for room, called after a pop without holding the lock
+static bool queue_has_data(queue_context_t *queue)
+{
+    if (queue->lockfree)
+    {
+        return lockfree_queue_count(queue, k4a_atomic_load(&queue->read_location)) != 0;
+    }
+    return is_queue_empty(queue) == false;
+}
+
+// Called after a push has published its capture
+static void queue_signal_wait_event(queue_context_t *queue)
+{
+    if (k4a_atomic_load(&queue->wait_event_created) != 0)
+    {
+        queue_wait_event_set(queue->wait_event);
+    }
+}
+
+// Called after a pop that may have emptied the queue. The queue is checked again after the reset, so a push that
+// signaled in between is not lost.
+static void queue_update_wait_event(queue_context_t *queue)
+{
+    if (k4a_atomic_load(&queue->wait_event_created) != 0 && k4a_atomic_load(&queue->enabled) &&
+        queue_has_data(queue) == false)
+    {
+        queue_wait_event_reset(queue->wait_event);
+        if (queue_has_data(queue) || k4a_atomic_load(&queue->enabled) == false)
+        {
+            queue_wait_event_set(queue->wait_event);
+        }
+    }
+}
+
+static void queue_post_space(queue_context_t *queue)
+{
+    if (k4a_atomic_load(&queue->queue_push_blocked) != 0)
+    {
+        Lock(queue->lock);
+        Condition_Post(queue->space_condition);
+        Unlock(queue->lock);
+    }
+}
+
+static k4a_capture_t lockfree_queue_pop_internal(queue_context_t *queue)
+{
+    uint32_t read = k4a_atomic_load(&queue->read_location);
+    while (lockfree_queue_count(queue, read) != 0)
+    {
+        // The entry may be overwritten as soon as another thread advances read, so it is only used if our compare and
+        // swap of read succeeds.
+        k4a_capture_t capture = (k4a_capture_t)k4a_atomic_load_ptr(&lockfree_queue_entry(queue, read)->capture);
+        uint32_t expected = read;
+        if (k4a_atomic_cas(&queue->read_location, expected, read + 1))
+        {
+            return capture;
+        }
+        read = k4a_atomic_load(&queue->read_location);
+    }
+    return NULL;
+}
+
+static k4a_wait_result_t lockfree_queue_pop(queue_context_t *queue, int32_t wait_in_ms, k4a_capture_t *out_capture)
+{
+    k4a_capture_t capture = NULL;
+    k4a_wait_result_t wresult = K4A_WAIT_RESULT_SUCCEEDED;
+
+    if (k4a_atomic_load(&queue->enabled) == false)
+    {
+        LOG_ERROR("Queue \"%s\" was popped in a disabled state.", queue->name);
+        wresult = K4A_WAIT_RESULT_FAILED;
+    }
+
+    if (wresult == K4A_WAIT_RESULT_SUCCEEDED)
+    {
+        capture = lockfree_queue_pop_internal(queue);
+        if (capture == NULL)
+        {
+            wresult = K4A_WAIT_RESULT_TIMEOUT;
+        }
+    }
+
+    if (wresult == K4A_WAIT_RESULT_TIMEOUT && wait_in_ms != 0)
+    {
+        // Anything less than 0 is a wait forever condition in the lower level calls.
+        // K4A_WAIT_INFINITE (-1) is defined for the user for this purpose
+        if (wait_in_ms < 0)
+        {
+            wait_in_ms = 0; // infinite to Condition_wait
+        }
+
+        // The producer only takes the lock to post the condition when it sees queue_pop_blocked set, which we do
+        // before checking the queue one last time.
+        Lock(queue->lock);
+        k4a_atomic_add(&queue->queue_pop_blocked, 1);
+
+        COND_RESULT cond_result = COND_OK;
+        while (cond_result == COND_OK && k4a_atomic_load(&queue->enabled))
+        {
+            capture = lockfree_queue_pop_internal(queue);
+            if (capture != NULL)
+            {
+                wresult = K4A_WAIT_RESULT_SUCCEEDED;
+                break;
+            }
+
+            cond_result = Condition_Wait(queue->condition, queue->lock, wait_in_ms);
+            if (cond_result != COND_OK && cond_result != COND_TIMEOUT)
+            {
+                K4A_RESULT_FROM_BOOL(cond_result != COND_ERROR);
+                wresult = K4A_WAIT_RESULT_FAILED;
+            }
+        }
+
+        k4a_atomic_add(&queue->queue_pop_blocked, -1);
+        Unlock(queue->lock);
+    }
+
+    if (k4a_atomic_load(&queue->enabled) == false)
+    {
+        wresult = K4A_WAIT_RESULT_FAILED;
+        if (capture)
+        {
+            // drop the capture
+            capture_dec_ref(capture);
+            capture = NULL;
+        }
+    }
+
+    uint32_t dropped_count = k4a_atomic_exchange(&queue->dropped_count, 0);
+    if (dropped_count != 0)
+    {
+        LOG_INFO("Queue \"%s\" dropped %d captures from queue.", queue->name, dropped_count);
+    }
+
+    if (capture != NULL)
+    {
+        queue_update_wait_event(queue);
+        queue_post_space(queue);
+    }
+
+    // We are transfering the ref we had to the caller.
+    *out_capture = capture;
+
+    return wresult;
+}
+
+// K4A_QUEUE_POLICY_DROP_NEWEST keeps the queued captures and drops the one being pushed
+static void queue_drop_newest(queue_context_t *queue, k4a_capture_t capture, k4a_capture_t *dropped)
+{
+    if (dropped == NULL || *dropped != NULL)
+    {
+        k4a_atomic_add(&queue->dropped_count, 1);
+        k4a_atomic_add(&queue->total_dropped_count, 1);
+    }
+    else
+    {
+        // The caller owns what is returned in dropped
+        capture_inc_ref(capture);
+        *dropped = capture;
+    }
+}
+
+static void lockfree_queue_push(queue_context_t *queue, k4a_capture_t capture, k4a_capture_t *dropped)
+{
+    // queue_disable waits for push_active to clear before draining, so nothing is left behind in a disabled queue
+    k4a_atomic_add(&queue->push_active, 1);
+
+    if (k4a_atomic_load(&queue->enabled) == false)
+    {
+        LOG_WARNING("Capture pushed into disabled queue.", queue->name);
+    }
+    else
+    {
+        // Only the producer moves write, so it can only be full on entry of this call
+        uint32_t write = k4a_atomic_load(&queue->write_location);
+        uint32_t read = k4a_atomic_load(&queue->read_location);
+        if (write - read >= queue->capacity && queue->policy == K4A_QUEUE_POLICY_BLOCK)
+        {
+            // Consumers only take the lock to post space_condition when they see queue_push_blocked set, which we do
+            // before checking the queue again.
+            Lock(queue->lock);
+            k4a_atomic_add(&queue->queue_push_blocked, 1);
+            while (k4a_atomic_load(&queue->enabled) &&
+                   write - k4a_atomic_load(&queue->read_location) >= queue->capacity)
+            {
+                int infinite_timeout = 0;
+                (void)Condition_Wait(queue->space_condition, queue->lock, infinite_timeout);
+            }
+            k4a_atomic_add(&queue->queue_push_blocked, -1);
+            Unlock(queue->lock);
+            read = k4a_atomic_load(&queue->read_location);
+        }
+
+        if (k4a_atomic_load(&queue->enabled) == false)
+        {
+            // Disabled while waiting for room, the capture is not queued
+            capture = NULL;
+        }
+        else if (write - read >= queue->capacity && queue->policy == K4A_QUEUE_POLICY_DROP_NEWEST)
+        {
+            queue_drop_newest(queue, capture, dropped);
+            capture = NULL;
+        }
+
+        while (capture != NULL && write - read >= queue->capacity)
+        {
+            k4a_capture_t oldest = (k4a_capture_t)k4a_atomic_load_ptr(&lockfree_queue_entry(queue, read)->capture);
+            uint32_t expected = read;
+            if (k4a_atomic_cas(&queue->read_location, expected, read + 1))
+            {
+                if (dropped == NULL || *dropped != NULL)
+                {
+                    k4a_atomic_add(&queue->dropped_count, 1);
+                    k4a_atomic_add(&queue->total_dropped_count, 1);
+                    capture_dec_ref(oldest);
+                }
+                else
+                {
+                    *dropped = oldest;
+                }
+            }
+            read = k4a_atomic_load(&queue->read_location);
+        }
+
+        if (capture != NULL)
+        {
+            // We are accepting this into our queue, so add a ref to prevent it
+            // from being freed
+            capture_inc_ref(capture);
+
+            k4a_atomic_store_ptr(&lockfree_queue_entry(queue, write)->capture, capture);
+            k4a_atomic_store(&queue->write_location, write + 1);
+            queue_signal_wait_event(queue);
+
+            if (k4a_atomic_load(&queue->queue_pop_blocked) != 0)
+            {
+                Lock(queue->lock);
+                Condition_Post(queue->condition);
+                Unlock(queue->lock);
+            }
+        }
+    }
+
+    k4a_atomic_add(&queue->push_active, -1);
+}
+
 static k4a_capture_t queue_pop_internal_locked(queue_context_t *queue)
 {
     if (is_queue_empty(queue) == false)
@@ -105,6 +461,11 @@ k4a_wait_result_t queue_pop(queue_t queue_handle, int32_t wait_in_ms, k4a_captur
     k4a_capture_t capture = NULL;
     k4a_wait_result_t wresult = K4A_WAIT_RESULT_SUCCEEDED;
 
+    if (queue->lockfree)
+    {
+        return lockfree_queue_pop(queue, wait_in_ms, out_capture);
+    }
+
     Lock(queue->lock);
 
     if (queue->enabled != true)
@@ -167,10 +528,20 @@ k4a_wait_result_t queue_pop(queue_t queue_handle, int32_t wait_in_ms, k4a_captur
 
     if (queue->dropped_count != 0)
     {
-        LOG_INFO("Queue \"%s\" dropped oldest %d captures from queue.", queue->name, queue->dropped_count);
+        LOG_INFO("Queue \"%s\" dropped %d captures from queue.", queue->name, queue->dropped_count);
         queue->dropped_count = 0;
     }
 
+    if (capture != NULL)
+    {
+        queue_update_wait_event(queue);
+    }
+
+    if (capture != NULL && queue->queue_push_blocked != 0)
+    {
+        Condition_Post(queue->space_condition);
+    }
+
     Unlock(queue->lock);
 
     // We are transfering the ref we had to the caller.
@@ -195,12 +566,33 @@ void queue_push_w_dropped(queue_t queue_handle, k4a_capture_t capture, k4a_captu
 
     queue_context_t *queue = queue_t_get_context(queue_handle);
 
+    if (queue->lockfree)
+    {
+        lockfree_queue_push(queue, capture, dropped);
+        return;
+    }
+
     Lock(queue->lock);
 
+    if (queue->enabled && is_queue_full(queue) && queue->policy == K4A_QUEUE_POLICY_BLOCK)
+    {
+        queue->queue_push_blocked++;
+        while (queue->enabled && is_queue_full(queue))
+        {
+            int infinite_timeout = 0;
+            (void)Condition_Wait(queue->space_condition, queue->lock, infinite_timeout);
+        }
+        queue->queue_push_blocked--;
+    }
+
     if (queue->enabled == false)
     {
         LOG_WARNING("Capture pushed into disabled queue.", queue->name);
     }
+    else if (is_queue_full(queue) && queue->policy == K4A_QUEUE_POLICY_DROP_NEWEST)
+    {
+        queue_drop_newest(queue, capture, dropped);
+    }
     else
     {
         if (is_queue_full(queue))
@@ -208,6 +600,7 @@ void queue_push_w_dropped(queue_t queue_handle, k4a_capture_t capture, k4a_captu
             if (dropped == NULL)
             {
                 queue->dropped_count++;
+                k4a_atomic_add(&queue->total_dropped_count, 1);
                 capture_dec_ref(queue_pop_internal_locked(queue));
             }
             else
@@ -221,6 +614,7 @@ void queue_push_w_dropped(queue_t queue_handle, k4a_capture_t capture, k4a_captu
         capture_inc_ref(capture);
 
         queue_push_internal_locked(queue, capture);
+        queue_signal_wait_event(queue);
 
         Condition_Post(queue->condition);
     }
@@ -232,6 +626,14 @@ void queue_push(queue_t queue_handle, k4a_capture_t capture)
     queue_push_w_dropped(queue_handle, capture, NULL);
 }
 
+uint32_t queue_get_dropped_count(queue_t queue_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(0, queue_t, queue_handle);
+    queue_context_t *queue = queue_t_get_context(queue_handle);
+
+    return k4a_atomic_load(&queue->total_dropped_count);
+}
+
 void queue_destroy(queue_t queue_handle)
 {
     RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, queue_t, queue_handle);
@@ -244,11 +646,18 @@ void queue_destroy(queue_t queue_handle)
         Condition_Deinit(queue->condition);
     }
 
+    if (queue->space_condition)
+    {
+        Condition_Deinit(queue->space_condition);
+    }
+
     if (queue->queue)
     {
         free(queue->queue);
     }
 
+    queue_wait_event_destroy(queue->wait_event);
+
     Lock_Deinit(queue->lock);
 
     queue_t_destroy(queue_handle);
@@ -259,8 +668,9 @@ void queue_enable(queue_t queue_handle)
     RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, queue_t, queue_handle);
     queue_context_t *queue = queue_t_get_context(queue_handle);
     Lock(queue->lock);
-    queue->enabled = true;
+    k4a_atomic_store(&queue->enabled, true);
     queue->stopped = false;
+    queue_update_wait_event(queue);
     Unlock(queue->lock);
 }
 
@@ -271,9 +681,26 @@ void queue_disable(queue_t queue_handle)
 
     Lock(queue->lock);
 
-    queue->enabled = false;
+    k4a_atomic_store(&queue->enabled, false);
+
+    while (queue->lockfree && k4a_atomic_load(&queue->push_active) != 0)
+    {
+        // push does not take the lock, so let it finish before draining. It may be waiting for room.
+        Condition_Post(queue->space_condition);
+        Unlock(queue->lock);
+        ThreadAPI_Sleep(1);
+        Lock(queue->lock);
+    }
+
+    while (k4a_atomic_load(&queue->queue_push_blocked) != 0)
+    {
+        Condition_Post(queue->space_condition);
+        Unlock(queue->lock);
+        ThreadAPI_Sleep(1);
+        Lock(queue->lock);
+    }
 
-    while (queue->queue_pop_blocked != 0)
+    while (k4a_atomic_load(&queue->queue_pop_blocked) != 0)
     {
         LOG_INFO("Queue \"%s\" waiting for blocking call to complete.", queue->name);
         Condition_Post(queue->condition);
@@ -282,10 +709,24 @@ void queue_disable(queue_t queue_handle)
         Lock(queue->lock);
     }
 
-    while (is_queue_empty(queue) == false)
+    if (queue->lockfree)
+    {
+        k4a_capture_t capture;
+        while ((capture = lockfree_queue_pop_internal(queue)) != NULL)
+        {
+            capture_dec_ref(capture);
+        }
+    }
+    else
     {
-        capture_dec_ref(queue_pop_internal_locked(queue));
+        while (is_queue_empty(queue) == false)
+        {
+            capture_dec_ref(queue_pop_internal_locked(queue));
+        }
     }
+
+    // A waiter wakes up and finds out from queue_pop failing
+    queue_signal_wait_event(queue);
     Unlock(queue->lock);
 }
 
@@ -300,3 +741,30 @@ void queue_stop(queue_t queue_handle)
     LOG_INFO("Queue \"%s\" stopped, shutting down and notifying consumers.", queue->name);
     queue_disable(queue_handle);
 }
+
+k4a_result_t queue_get_wait_handle(queue_t queue_handle, k4a_wait_handle_t *wait_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, queue_t, queue_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, wait_handle == NULL);
+    queue_context_t *queue = queue_t_get_context(queue_handle);
+    k4a_result_t result = K4A_RESULT_SUCCEEDED;
+
+    Lock(queue->lock);
+    if (k4a_atomic_load(&queue->wait_event_created) == 0)
+    {
+        result = TRACE_CALL(queue_wait_event_create(&queue->wait_event));
+        if (K4A_SUCCEEDED(result))
+        {
+            // Pushes that did not see the flag yet are covered by checking the queue after setting it
+            k4a_atomic_store(&queue->wait_event_created, 1);
+            if (queue_has_data(queue) || k4a_atomic_load(&queue->enabled) == false)
+            {
+                queue_wait_event_set(queue->wait_event);
+            }
+        }
+    }
+    Unlock(queue->lock);
+
+    *wait_handle = K4A_SUCCEEDED(result) ? queue->wait_event : K4A_WAIT_HANDLE_INVALID;
+    return result;
+}
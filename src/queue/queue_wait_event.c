@@ -0,0 +1,80 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// This library
+#include <k4ainternal/queue.h>
+
+// Dependent libraries
+#include <k4ainternal/logging.h>
+
+// System dependencies
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <errno.h>
+#include <stdint.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+k4a_result_t queue_wait_event_create(k4a_wait_handle_t *wait_handle)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, wait_handle == NULL);
+
+#ifdef _WIN32
+    // Manual reset, so every waiter sees it until the queue is drained
+    HANDLE event = CreateEvent(NULL, TRUE, FALSE, NULL);
+    if (event == NULL)
+    {
+        LOG_ERROR("CreateEvent failed with %d", GetLastError());
+        *wait_handle = K4A_WAIT_HANDLE_INVALID;
+        return K4A_RESULT_FAILED;
+    }
+    *wait_handle = (k4a_wait_handle_t)event;
+#else
+    // A non zero counter polls as readable, which is the signaled state. Reads reset it and must not block.
+    int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd < 0)
+    {
+        LOG_ERROR("eventfd failed with %d", errno);
+        *wait_handle = K4A_WAIT_HANDLE_INVALID;
+        return K4A_RESULT_FAILED;
+    }
+    *wait_handle = fd;
+#endif
+    return K4A_RESULT_SUCCEEDED;
+}
+
+void queue_wait_event_destroy(k4a_wait_handle_t wait_handle)
+{
+    if (wait_handle != K4A_WAIT_HANDLE_INVALID)
+    {
+#ifdef _WIN32
+        CloseHandle((HANDLE)wait_handle);
+#else
+        close(wait_handle);
+#endif
+    }
+}
+
+void queue_wait_event_set(k4a_wait_handle_t wait_handle)
+{
+#ifdef _WIN32
+    SetEvent((HANDLE)wait_handle);
+#else
+    // Only fails with EAGAIN once the counter is near overflow, when it is signaled anyway
+    uint64_t one = 1;
+    (void)!write(wait_handle, &one, sizeof(one));
+#endif
+}
+
+void queue_wait_event_reset(k4a_wait_handle_t wait_handle)
+{
+#ifdef _WIN32
+    ResetEvent((HANDLE)wait_handle);
+#else
+    // Reading returns the counter and zeroes it, EAGAIN if it already was
+    uint64_t count;
+    (void)!read(wait_handle, &count, sizeof(count));
+#endif
+}
@@ -0,0 +1,359 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// This library
+#include <k4ainternal/queue.h>
+
+// Dependent libraries
+#include <k4ainternal/logging.h>
+#include <azure_c_shared_utility/lock.h>
+#include <azure_c_shared_utility/condition.h>
+#include <azure_c_shared_utility/threadapi.h>
+
+// System dependencies
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+typedef struct _sample_queue_context_t
+{
+    bool enabled;
+    uint32_t queue_pop_blocked;   // number of waiting threads for sample_queue_pop so complete
+    uint32_t read_location;       // index of the oldest element
+    uint32_t count;               // number of elements held
+    uint32_t depth;               // max elements the queue can hold
+    size_t element_size;          // size of each element in bytes
+    uint8_t *elements;            // depth * element_size bytes, allocated once at create
+    const char *name;             // Queue name in logger
+    uint32_t dropped_count;       // Count of the dropped elements, reset each time it is logged
+    uint32_t total_dropped_count; // Elements dropped since the queue was created
+    k4a_wait_handle_t wait_event; // Signaled while elements are held or disabled, see sample_queue_get_wait_handle
+
+    LOCK_HANDLE lock;
+    COND_HANDLE condition;
+} sample_queue_context_t;
+
+K4A_DECLARE_CONTEXT(sample_queue_t, sample_queue_context_t);
+
+#define sample_queue_element(queue, location)                                                                          \
+    (&(queue)->elements[(size_t)((location) % (queue)->depth) * (queue)->element_size])
+
+k4a_result_t sample_queue_create(size_t element_size,
+                                 uint32_t queue_depth,
+                                 const char *queue_name,
+                                 sample_queue_t *queue_handle)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, queue_handle == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, element_size == 0);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, queue_depth == 0);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, queue_depth > 100000); // Sanity Check
+
+    sample_queue_context_t *queue = sample_queue_t_create(queue_handle);
+    k4a_result_t result = K4A_RESULT_FROM_BOOL(queue != NULL);
+
+    if (K4A_SUCCEEDED(result))
+    {
+        queue->wait_event = K4A_WAIT_HANDLE_INVALID;
+        queue->depth = queue_depth;
+        queue->element_size = element_size;
+        queue->name = queue_name;
+        if (queue->name == NULL)
+        {
+            queue->name = "Unknown queue";
+        }
+
+        queue->elements = (uint8_t *)malloc(element_size * queue_depth);
+        result = K4A_RESULT_FROM_BOOL(queue->elements != NULL);
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        queue->lock = Lock_Init();
+        result = K4A_RESULT_FROM_BOOL(queue->lock != NULL);
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        queue->condition = Condition_Init();
+        result = K4A_RESULT_FROM_BOOL(queue->condition != NULL);
+    }
+
+    if (K4A_FAILED(result) && queue != NULL)
+    {
+        sample_queue_destroy(*queue_handle);
+        *queue_handle = NULL;
+    }
+    return result;
+}
+
+void sample_queue_destroy(sample_queue_t queue_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, sample_queue_t, queue_handle);
+    sample_queue_context_t *queue = sample_queue_t_get_context(queue_handle);
+
+    if (queue->lock)
+    {
+        sample_queue_disable(queue_handle);
+        Lock_Deinit(queue->lock);
+    }
+
+    if (queue->condition)
+    {
+        Condition_Deinit(queue->condition);
+    }
+
+    free(queue->elements);
+    queue_wait_event_destroy(queue->wait_event);
+
+    sample_queue_t_destroy(queue_handle);
+}
+
+void sample_queue_push(sample_queue_t queue_handle, const void *element)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, sample_queue_t, queue_handle);
+    RETURN_VALUE_IF_ARG(VOID_VALUE, element == NULL);
+
+    sample_queue_context_t *queue = sample_queue_t_get_context(queue_handle);
+
+    Lock(queue->lock);
+
+    if (queue->enabled == false)
+    {
+        LOG_WARNING("Sample pushed into disabled queue \"%s\".", queue->name);
+    }
+    else
+    {
+        if (queue->count == queue->depth)
+        {
+            // Full, overwrite the oldest element
+            queue->read_location = (queue->read_location + 1) % queue->depth;
+            queue->count--;
+            queue->dropped_count++;
+            queue->total_dropped_count++;
+        }
+
+        memcpy(sample_queue_element(queue, queue->read_location + queue->count), element, queue->element_size);
+        queue->count++;
+
+        if (queue->wait_event != K4A_WAIT_HANDLE_INVALID)
+        {
+            queue_wait_event_set(queue->wait_event);
+        }
+
+        if (queue->queue_pop_blocked != 0)
+        {
+            Condition_Post(queue->condition);
+        }
+    }
+    Unlock(queue->lock);
+}
+
+// Waits for an element like sample_queue_pop(). With latest, the newest element is copied and every element is
+// removed, otherwise the oldest elements, up to max_elements, are.
+static k4a_wait_result_t sample_queue_pop_internal(sample_queue_context_t *queue,
+                                                   int32_t wait_in_ms,
+                                                   void *elements,
+                                                   size_t max_elements,
+                                                   size_t *element_count,
+                                                   bool latest)
+{
+    k4a_wait_result_t wresult = K4A_WAIT_RESULT_SUCCEEDED;
+    size_t count = 0;
+
+    *element_count = 0;
+
+    Lock(queue->lock);
+
+    if (queue->enabled != true)
+    {
+        LOG_ERROR("Queue \"%s\" was popped in a disabled state.", queue->name);
+        wresult = K4A_WAIT_RESULT_FAILED;
+    }
+
+    if (wresult == K4A_WAIT_RESULT_SUCCEEDED && queue->count == 0)
+    {
+        wresult = K4A_WAIT_RESULT_TIMEOUT;
+        if (wait_in_ms != 0)
+        {
+            // Anything less than 0 is a wait forever condition in the lower level calls.
+            // K4A_WAIT_INFINITE (-1) is defined for the user for this purpose
+            if (wait_in_ms < 0)
+            {
+                wait_in_ms = 0; // infinite to Condition_wait
+            }
+
+            queue->queue_pop_blocked++;
+            COND_RESULT cond_result = Condition_Wait(queue->condition, queue->lock, wait_in_ms);
+            queue->queue_pop_blocked--;
+
+            if (cond_result == COND_OK)
+            {
+                wresult = queue->count != 0 ? K4A_WAIT_RESULT_SUCCEEDED : K4A_WAIT_RESULT_TIMEOUT;
+            }
+            else if (cond_result != COND_TIMEOUT)
+            {
+                K4A_RESULT_FROM_BOOL(cond_result != COND_ERROR);
+                wresult = K4A_WAIT_RESULT_FAILED;
+            }
+        }
+    }
+
+    if (queue->enabled == false)
+    {
+        wresult = K4A_WAIT_RESULT_FAILED;
+    }
+
+    if (wresult == K4A_WAIT_RESULT_SUCCEEDED && latest)
+    {
+        memcpy(elements, sample_queue_element(queue, queue->read_location + queue->count - 1), queue->element_size);
+        count = 1;
+        queue->read_location = 0;
+        queue->count = 0;
+    }
+    else if (wresult == K4A_WAIT_RESULT_SUCCEEDED)
+    {
+        // Copy out as much as we can in at most two contiguous runs
+        count = queue->count < max_elements ? queue->count : max_elements;
+        size_t first_run = queue->depth - queue->read_location;
+        if (first_run > count)
+        {
+            first_run = count;
+        }
+
+        memcpy(elements, sample_queue_element(queue, queue->read_location), first_run * queue->element_size);
+        if (count > first_run)
+        {
+            memcpy((uint8_t *)elements + first_run * queue->element_size,
+                   queue->elements,
+                   (count - first_run) * queue->element_size);
+        }
+
+        queue->read_location = (uint32_t)((queue->read_location + count) % queue->depth);
+        queue->count -= (uint32_t)count;
+    }
+
+    if (wresult == K4A_WAIT_RESULT_SUCCEEDED && queue->count == 0 && queue->wait_event != K4A_WAIT_HANDLE_INVALID)
+    {
+        queue_wait_event_reset(queue->wait_event);
+    }
+
+    if (queue->dropped_count != 0)
+    {
+        LOG_INFO("Queue \"%s\" dropped oldest %d samples from queue.", queue->name, queue->dropped_count);
+        queue->dropped_count = 0;
+    }
+
+    Unlock(queue->lock);
+
+    *element_count = count;
+    return wresult;
+}
+
+k4a_wait_result_t sample_queue_pop(sample_queue_t queue_handle,
+                                   int32_t wait_in_ms,
+                                   void *elements,
+                                   size_t max_elements,
+                                   size_t *element_count)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_WAIT_RESULT_FAILED, sample_queue_t, queue_handle);
+    RETURN_VALUE_IF_ARG(K4A_WAIT_RESULT_FAILED, elements == NULL);
+    RETURN_VALUE_IF_ARG(K4A_WAIT_RESULT_FAILED, max_elements == 0);
+    RETURN_VALUE_IF_ARG(K4A_WAIT_RESULT_FAILED, element_count == NULL);
+    sample_queue_context_t *queue = sample_queue_t_get_context(queue_handle);
+
+    return sample_queue_pop_internal(queue, wait_in_ms, elements, max_elements, element_count, false);
+}
+
+k4a_wait_result_t sample_queue_pop_latest(sample_queue_t queue_handle, int32_t wait_in_ms, void *element)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_WAIT_RESULT_FAILED, sample_queue_t, queue_handle);
+    RETURN_VALUE_IF_ARG(K4A_WAIT_RESULT_FAILED, element == NULL);
+    sample_queue_context_t *queue = sample_queue_t_get_context(queue_handle);
+    size_t element_count = 0;
+
+    return sample_queue_pop_internal(queue, wait_in_ms, element, 1, &element_count, true);
+}
+
+uint32_t sample_queue_get_dropped_count(sample_queue_t queue_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(0, sample_queue_t, queue_handle);
+    sample_queue_context_t *queue = sample_queue_t_get_context(queue_handle);
+    Lock(queue->lock);
+    uint32_t dropped_count = queue->total_dropped_count;
+    Unlock(queue->lock);
+    return dropped_count;
+}
+
+void sample_queue_enable(sample_queue_t queue_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, sample_queue_t, queue_handle);
+    sample_queue_context_t *queue = sample_queue_t_get_context(queue_handle);
+    Lock(queue->lock);
+    queue->enabled = true;
+    if (queue->count == 0 && queue->wait_event != K4A_WAIT_HANDLE_INVALID)
+    {
+        queue_wait_event_reset(queue->wait_event);
+    }
+    Unlock(queue->lock);
+}
+
+void sample_queue_disable(sample_queue_t queue_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, sample_queue_t, queue_handle);
+    sample_queue_context_t *queue = sample_queue_t_get_context(queue_handle);
+
+    Lock(queue->lock);
+
+    queue->enabled = false;
+
+    while (queue->queue_pop_blocked != 0)
+    {
+        LOG_INFO("Queue \"%s\" waiting for blocking call to complete.", queue->name);
+        Condition_Post(queue->condition);
+        Unlock(queue->lock);
+        ThreadAPI_Sleep(25);
+        Lock(queue->lock);
+    }
+
+    // Drop whatever is left
+    queue->read_location = 0;
+    queue->count = 0;
+
+    // A waiter wakes up and finds out from sample_queue_pop failing
+    if (queue->wait_event != K4A_WAIT_HANDLE_INVALID)
+    {
+        queue_wait_event_set(queue->wait_event);
+    }
+    Unlock(queue->lock);
+}
+
+void sample_queue_stop(sample_queue_t queue_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, sample_queue_t, queue_handle);
+    sample_queue_context_t *queue = sample_queue_t_get_context(queue_handle);
+
+    LOG_INFO("Queue \"%s\" stopped, shutting down and notifying consumers.", queue->name);
+    sample_queue_disable(queue_handle);
+}
+
+k4a_result_t sample_queue_get_wait_handle(sample_queue_t queue_handle, k4a_wait_handle_t *wait_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, sample_queue_t, queue_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, wait_handle == NULL);
+    sample_queue_context_t *queue = sample_queue_t_get_context(queue_handle);
+    k4a_result_t result = K4A_RESULT_SUCCEEDED;
+
+    Lock(queue->lock);
+    if (queue->wait_event == K4A_WAIT_HANDLE_INVALID)
+    {
+        result = TRACE_CALL(queue_wait_event_create(&queue->wait_event));
+        if (K4A_SUCCEEDED(result) && (queue->count != 0 || queue->enabled == false))
+        {
+            queue_wait_event_set(queue->wait_event);
+        }
+    }
+    *wait_handle = queue->wait_event;
+    Unlock(queue->lock);
+
+    return result;
+}
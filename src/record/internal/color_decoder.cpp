@@ -0,0 +1,262 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <algorithm>
+
+#include <k4a/k4a.h>
+#include <k4ainternal/matroska_read.h>
+#include <k4ainternal/logging.h>
+
+using namespace LIBMATROSKA_NAMESPACE;
+
+namespace k4arecord
+{
+_color_decode_job_t::~_color_decode_job_t()
+{
+    if (image != NULL)
+    {
+        k4a_image_release(image);
+    }
+}
+
+static void color_decoder_thread(k4a_playback_context_t *context)
+{
+    try
+    {
+        std::unique_lock<std::mutex> lock(context->color_decode_lock);
+        while (true)
+        {
+            context->color_decode_notify->wait(lock, [context]() {
+                return context->color_decoders_stopping || !context->color_decode_queue.empty();
+            });
+            if (context->color_decoders_stopping)
+            {
+                break;
+            }
+
+            std::shared_ptr<color_decode_job_t> job = context->color_decode_queue.front();
+            context->color_decode_queue.pop_front();
+
+            lock.unlock();
+            job->result = TRACE_CALL(
+                convert_block_to_image(context, job->block.get(), &job->image, context->color_format_conversion));
+            lock.lock();
+
+            job->done = true;
+            context->color_decode_done->notify_all();
+        }
+    }
+    catch (std::system_error &e)
+    {
+        LOG_ERROR("Color decoder thread threw exception: %s", e.what());
+    }
+}
+
+k4a_result_t start_color_decoder_threads(k4a_playback_context_t *context, size_t thread_count)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context->color_track == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, !context->color_decoders.empty());
+
+    try
+    {
+        // The decoder threads share the buffer pool of the track, it must exist before they allocate from it
+        if (context->color_track->buffer_pool == nullptr)
+        {
+            context->color_track->buffer_pool = std::make_shared<image_buffer_pool_t>();
+        }
+
+        context->color_decode_notify.reset(new std::condition_variable());
+        context->color_decode_done.reset(new std::condition_variable());
+
+        context->color_decoders_stopping = false;
+        for (size_t i = 0; i < thread_count; i++)
+        {
+            context->color_decoders.emplace_back(color_decoder_thread, context);
+        }
+    }
+    catch (std::system_error &e)
+    {
+        // The jobs no decoder takes are converted by get_capture(), so decode-ahead works with any thread count
+        if (context->color_decode_done == nullptr)
+        {
+            LOG_ERROR("Failed to start color decoder threads: %s", e.what());
+            return K4A_RESULT_FAILED;
+        }
+        LOG_WARNING("Failed to start color decoder thread: %s", e.what());
+    }
+
+    return K4A_RESULT_SUCCEEDED;
+}
+
+void stop_color_decoder_threads(k4a_playback_context_t *context)
+{
+    RETURN_VALUE_IF_ARG(VOID_VALUE, context == NULL);
+
+    reset_color_decode_ahead(context);
+    try
+    {
+        {
+            std::lock_guard<std::mutex> lock(context->color_decode_lock);
+            context->color_decoders_stopping = true;
+        }
+        if (context->color_decode_notify)
+        {
+            context->color_decode_notify->notify_all();
+        }
+        for (std::thread &decoder : context->color_decoders)
+        {
+            decoder.join();
+        }
+        context->color_decoders.clear();
+    }
+    catch (std::system_error &e)
+    {
+        LOG_ERROR("Failed to stop color decoder threads: %s", e.what());
+    }
+}
+
+// Queues the conversion of the color blocks following the last one queued, or the current color block, until
+// decode_ahead_count of them are ahead of get_capture().
+void decode_ahead_color_images(k4a_playback_context_t *context)
+{
+    RETURN_VALUE_IF_ARG(VOID_VALUE, context == NULL);
+    if (context->color_track == NULL || !context->color_track->enabled || context->color_decoders.empty())
+    {
+        return;
+    }
+
+    std::shared_ptr<block_info_t> block = context->decode_ahead_jobs.empty() ? context->color_track->current_block :
+                                                                               context->decode_ahead_jobs.back()->block;
+    try
+    {
+        while (block && context->decode_ahead_jobs.size() < context->decode_ahead_count)
+        {
+            block = next_block(context, block.get(), true);
+            if (block == nullptr || block->block == NULL)
+            {
+                // End of recording reached
+                break;
+            }
+
+            std::shared_ptr<color_decode_job_t> job = std::make_shared<color_decode_job_t>();
+            job->block = block;
+            context->decode_ahead_jobs.push_back(job);
+            {
+                std::lock_guard<std::mutex> lock(context->color_decode_lock);
+                context->color_decode_queue.push_back(job);
+            }
+            context->color_decode_notify->notify_one();
+        }
+    }
+    catch (std::system_error &e)
+    {
+        // The images not queued are converted by get_capture()
+        LOG_WARNING("Failed to queue color decode-ahead: %s", e.what());
+    }
+}
+
+// Waits for a job to be converted or, if no decoder thread has taken it yet, to be removed from the queue. Once it
+// returns, the decoder threads no longer use the job.
+static void cancel_color_decode_job(k4a_playback_context_t *context,
+                                    std::unique_lock<std::mutex> &lock,
+                                    const std::shared_ptr<color_decode_job_t> &job)
+{
+    auto queued = std::find(context->color_decode_queue.begin(), context->color_decode_queue.end(), job);
+    if (queued != context->color_decode_queue.end())
+    {
+        context->color_decode_queue.erase(queued);
+    }
+    else
+    {
+        context->color_decode_done->wait(lock, [&job]() { return job->done; });
+    }
+}
+
+// Takes the image the decoder threads converted from block, after dropping the jobs of the blocks before it. A job
+// no decoder thread has taken yet is converted on the calling thread. Returns false, after dropping every job, if
+// block wasn't queued.
+bool take_decoded_color_image(k4a_playback_context_t *context,
+                              block_info_t *block,
+                              k4a_image_t *image_out,
+                              k4a_result_t *result_out)
+{
+    RETURN_VALUE_IF_ARG(false, context == NULL);
+    RETURN_VALUE_IF_ARG(false, block == NULL);
+    RETURN_VALUE_IF_ARG(false, image_out == NULL);
+    RETURN_VALUE_IF_ARG(false, result_out == NULL);
+
+    auto match = std::find_if(context->decode_ahead_jobs.begin(),
+                              context->decode_ahead_jobs.end(),
+                              [block](const std::shared_ptr<color_decode_job_t> &job) {
+                                  return job->block->cluster->cluster_info == block->cluster->cluster_info &&
+                                         job->block->index == block->index;
+                              });
+    if (match == context->decode_ahead_jobs.end())
+    {
+        reset_color_decode_ahead(context);
+        return false;
+    }
+
+    try
+    {
+        std::unique_lock<std::mutex> lock(context->color_decode_lock);
+        while (context->decode_ahead_jobs.front() != *match)
+        {
+            cancel_color_decode_job(context, lock, context->decode_ahead_jobs.front());
+            context->decode_ahead_jobs.pop_front();
+        }
+
+        std::shared_ptr<color_decode_job_t> job = context->decode_ahead_jobs.front();
+        context->decode_ahead_jobs.pop_front();
+        auto queued = std::find(context->color_decode_queue.begin(), context->color_decode_queue.end(), job);
+        if (queued != context->color_decode_queue.end())
+        {
+            context->color_decode_queue.erase(queued);
+            lock.unlock();
+            job->result = TRACE_CALL(
+                convert_block_to_image(context, job->block.get(), &job->image, context->color_format_conversion));
+            lock.lock();
+            job->done = true;
+        }
+        context->color_decode_done->wait(lock, [&job]() { return job->done; });
+
+        *result_out = job->result;
+        *image_out = job->image;
+        job->image = NULL;
+        return true;
+    }
+    catch (std::system_error &e)
+    {
+        LOG_ERROR("Failed to wait for color decode-ahead: %s", e.what());
+        *result_out = K4A_RESULT_FAILED;
+        return true;
+    }
+}
+
+// Drops every decode-ahead job, waiting for the ones being converted. Called before the color conversion settings
+// change or playback moves to a block that wasn't queued.
+void reset_color_decode_ahead(k4a_playback_context_t *context)
+{
+    RETURN_VALUE_IF_ARG(VOID_VALUE, context == NULL);
+    if (context->decode_ahead_jobs.empty())
+    {
+        return;
+    }
+
+    try
+    {
+        std::unique_lock<std::mutex> lock(context->color_decode_lock);
+        for (const std::shared_ptr<color_decode_job_t> &job : context->decode_ahead_jobs)
+        {
+            cancel_color_decode_job(context, lock, job);
+        }
+    }
+    catch (std::system_error &e)
+    {
+        LOG_ERROR("Failed to wait for color decode-ahead: %s", e.what());
+    }
+    context->decode_ahead_jobs.clear();
+}
+
+} // namespace k4arecord
@@ -0,0 +1,346 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <k4a/k4a.h>
+#include <k4ainternal/matroska_write.h>
+#include <k4ainternal/logging.h>
+
+#include <turbojpeg.h>
+#include <libyuv.h>
+
+using namespace LIBMATROSKA_NAMESPACE;
+
+// Threads transcoding the color images queued by write_track_data(), the writer thread helps when they fall behind
+#define COLOR_ENCODER_THREAD_COUNT 3
+
+namespace k4arecord
+{
+_color_encode_job_t::~_color_encode_job_t()
+{
+    if (output != nullptr)
+    {
+        output->FreeBuffer(*output);
+        delete output;
+    }
+    if (image != NULL)
+    {
+        k4a_image_release(image);
+    }
+}
+
+// libjpeg-turbo compressor of the calling thread, created on its first color image
+static tjhandle get_thread_compressor()
+{
+    struct compressor_t
+    {
+        tjhandle handle = tjInitCompress();
+        ~compressor_t()
+        {
+            if (handle != nullptr)
+            {
+                (void)tjDestroy(handle);
+            }
+        }
+    };
+    static thread_local compressor_t compressor;
+    return compressor.handle;
+}
+
+static bool free_color_buffer(const DataBuffer &buffer)
+{
+    delete[] const_cast<binary *>(buffer.Buffer());
+    return true;
+}
+
+// Compresses a BGRA32, NV12 or YUY2 image to a JPEG of the given quality. Frames are compressed to a worst case
+// sized scratch buffer of the thread and copied to a buffer of their size, so queued frames don't hold the worst case.
+static DataBuffer *encode_color_image(k4a_image_t image, int quality)
+{
+    tjhandle compressor = get_thread_compressor();
+    if (compressor == nullptr)
+    {
+        LOG_ERROR("Failed to initialize the MJPG color encoder.", 0);
+        return NULL;
+    }
+
+    int width = k4a_image_get_width_pixels(image);
+    int height = k4a_image_get_height_pixels(image);
+    int stride = k4a_image_get_stride_bytes(image);
+    uint8_t *buffer = k4a_image_get_buffer(image);
+    size_t buffer_size = k4a_image_get_size(image);
+    if (buffer == NULL || width <= 0 || height <= 0)
+    {
+        LOG_ERROR("Invalid color image.", 0);
+        return NULL;
+    }
+
+    int chroma_width = (width + 1) / 2;
+    int chroma_height = (height + 1) / 2;
+    int subsampling = TJSAMP_420;
+    size_t required_size = (size_t)stride * (size_t)height;
+    k4a_image_format_t format = k4a_image_get_format(image);
+    switch (format)
+    {
+    case K4A_IMAGE_FORMAT_COLOR_BGRA32:
+        if (stride < width * 4)
+        {
+            required_size = SIZE_MAX;
+        }
+        break;
+    case K4A_IMAGE_FORMAT_COLOR_NV12:
+        required_size += (size_t)stride * (size_t)chroma_height;
+        if (stride < chroma_width * 2)
+        {
+            required_size = SIZE_MAX;
+        }
+        break;
+    case K4A_IMAGE_FORMAT_COLOR_YUY2:
+        subsampling = TJSAMP_422;
+        chroma_height = height;
+        if (stride < chroma_width * 4)
+        {
+            required_size = SIZE_MAX;
+        }
+        break;
+    default:
+        LOG_ERROR("Color images of format %d can't be transcoded to MJPG.", format);
+        return NULL;
+    }
+
+    if (buffer_size < required_size)
+    {
+        LOG_ERROR("The %zu byte buffer of a %d x %d color image is too small.", buffer_size, width, height);
+        return NULL;
+    }
+
+    static thread_local std::vector<uint8_t> jpeg_scratch;
+    static thread_local std::vector<uint8_t> plane_scratch;
+    unsigned long jpeg_size = tjBufSize(width, height, subsampling);
+    if (jpeg_size == (unsigned long)-1)
+    {
+        LOG_ERROR("Invalid %d x %d color image.", width, height);
+        return NULL;
+    }
+
+    int status = 0;
+    try
+    {
+        jpeg_scratch.resize(jpeg_size);
+        if (format != K4A_IMAGE_FORMAT_COLOR_BGRA32)
+        {
+            plane_scratch.resize((size_t)chroma_width * (size_t)chroma_height * 2 +
+                                 (format == K4A_IMAGE_FORMAT_COLOR_YUY2 ? (size_t)width * (size_t)height : 0));
+        }
+    }
+    catch (std::bad_alloc &)
+    {
+        LOG_ERROR("Failed to allocate the MJPG encoding buffers of a %d x %d color image.", width, height);
+        return NULL;
+    }
+
+    uint8_t *jpeg = jpeg_scratch.data();
+    if (format == K4A_IMAGE_FORMAT_COLOR_BGRA32)
+    {
+        status = tjCompress2(compressor,
+                             buffer,
+                             width,
+                             stride,
+                             height,
+                             TJPF_BGRA,
+                             &jpeg,
+                             &jpeg_size,
+                             subsampling,
+                             quality,
+                             TJFLAG_NOREALLOC | TJFLAG_FASTDCT);
+    }
+    else
+    {
+        // libjpeg-turbo compresses planar YUV without converting it to RGB, NV12 only needs its chroma split
+        uint8_t *u_plane = plane_scratch.data();
+        uint8_t *v_plane = u_plane + (size_t)chroma_width * (size_t)chroma_height;
+        const unsigned char *planes[3] = { buffer, u_plane, v_plane };
+        int strides[3] = { stride, chroma_width, chroma_width };
+        if (format == K4A_IMAGE_FORMAT_COLOR_NV12)
+        {
+            libyuv::SplitUVPlane(buffer + (size_t)stride * (size_t)height,
+                                 stride,
+                                 u_plane,
+                                 chroma_width,
+                                 v_plane,
+                                 chroma_width,
+                                 chroma_width,
+                                 chroma_height);
+        }
+        else
+        {
+            uint8_t *y_plane = v_plane + (size_t)chroma_width * (size_t)chroma_height;
+            (void)libyuv::YUY2ToI422(
+                buffer, stride, y_plane, width, u_plane, chroma_width, v_plane, chroma_width, width, height);
+            planes[0] = y_plane;
+            strides[0] = width;
+        }
+
+        status = tjCompressFromYUVPlanes(compressor,
+                                         planes,
+                                         width,
+                                         strides,
+                                         height,
+                                         subsampling,
+                                         &jpeg,
+                                         &jpeg_size,
+                                         quality,
+                                         TJFLAG_NOREALLOC | TJFLAG_FASTDCT);
+    }
+
+    if (status != 0 || jpeg_size > UINT32_MAX)
+    {
+        LOG_ERROR("Failed to compress a %d x %d color image to MJPG: %s", width, height, tjGetErrorStr());
+        return NULL;
+    }
+
+    binary *encoded = new (std::nothrow) binary[jpeg_size];
+    if (encoded == NULL)
+    {
+        return NULL;
+    }
+    memcpy(encoded, jpeg, jpeg_size);
+
+    DataBuffer *output = new (std::nothrow) DataBuffer(encoded, (uint32)jpeg_size, &free_color_buffer);
+    if (output == NULL)
+    {
+        delete[] encoded;
+    }
+    return output;
+}
+
+static void encode_color_job(k4a_record_context_t *context, color_encode_job_t *job)
+{
+    job->output = encode_color_image(job->image, (int)context->color_quality);
+    k4a_image_release(job->image);
+    job->image = NULL;
+}
+
+static void color_encoder_thread(k4a_record_context_t *context)
+{
+    try
+    {
+        std::unique_lock<std::mutex> lock(context->color_encode_lock);
+        while (true)
+        {
+            context->color_encode_notify->wait(lock, [context]() {
+                return context->color_encoders_stopping || !context->color_encode_queue.empty();
+            });
+            if (context->color_encoders_stopping)
+            {
+                break;
+            }
+
+            std::shared_ptr<color_encode_job_t> job = context->color_encode_queue.front();
+            context->color_encode_queue.pop_front();
+
+            lock.unlock();
+            encode_color_job(context, job.get());
+            lock.lock();
+
+            job->done = true;
+            context->color_encode_done->notify_all();
+        }
+    }
+    catch (std::system_error &e)
+    {
+        LOG_ERROR("Color encoder thread threw exception: %s", e.what());
+    }
+}
+
+k4a_result_t start_color_encoder_threads(k4a_record_context_t *context)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, !context->color_encoders.empty());
+
+    try
+    {
+        context->color_encode_notify.reset(new std::condition_variable());
+        context->color_encode_done.reset(new std::condition_variable());
+
+        context->color_encoders_stopping = false;
+        for (size_t i = 0; i < COLOR_ENCODER_THREAD_COUNT; i++)
+        {
+            context->color_encoders.emplace_back(color_encoder_thread, context);
+        }
+    }
+    catch (std::system_error &e)
+    {
+        // The jobs no encoder takes are encoded by write_cluster(), so the recording works with any thread count
+        if (context->color_encode_done == nullptr)
+        {
+            LOG_ERROR("Failed to start color encoder threads: %s", e.what());
+            return K4A_RESULT_FAILED;
+        }
+        LOG_WARNING("Failed to start color encoder thread: %s", e.what());
+    }
+
+    return K4A_RESULT_SUCCEEDED;
+}
+
+void stop_color_encoder_threads(k4a_record_context_t *context)
+{
+    RETURN_VALUE_IF_ARG(VOID_VALUE, context == NULL);
+
+    try
+    {
+        {
+            std::lock_guard<std::mutex> lock(context->color_encode_lock);
+            context->color_encoders_stopping = true;
+        }
+        if (context->color_encode_notify)
+        {
+            context->color_encode_notify->notify_all();
+        }
+        for (std::thread &encoder : context->color_encoders)
+        {
+            encoder.join();
+        }
+        context->color_encoders.clear();
+    }
+    catch (std::system_error &e)
+    {
+        LOG_ERROR("Failed to stop color encoder threads: %s", e.what());
+    }
+}
+
+// Queues a color image for the encoder threads. Lock(context->pending_cluster_lock) should be active when calling this
+// function, so the job is queued before write_cluster() can wait for it.
+void queue_color_encode_job(k4a_record_context_t *context, const std::shared_ptr<color_encode_job_t> &job)
+{
+    assert(context->color_encode_notify && context->color_encode_done);
+
+    {
+        std::lock_guard<std::mutex> lock(context->color_encode_lock);
+        context->color_encode_queue.push_back(job);
+    }
+    context->color_encode_notify->notify_one();
+}
+
+// Returns once the image of a job is encoded. A job no encoder thread has taken yet is encoded on the calling thread.
+void wait_color_encode_job(k4a_record_context_t *context, const std::shared_ptr<color_encode_job_t> &job)
+{
+    std::unique_lock<std::mutex> lock(context->color_encode_lock);
+    auto queued = std::find(context->color_encode_queue.begin(), context->color_encode_queue.end(), job);
+    if (queued != context->color_encode_queue.end())
+    {
+        context->color_encode_queue.erase(queued);
+        lock.unlock();
+        encode_color_job(context, job.get());
+        lock.lock();
+        job->done = true;
+    }
+
+    context->color_encode_done->wait(lock, [&job]() { return job->done; });
+}
+
+} // namespace k4arecord
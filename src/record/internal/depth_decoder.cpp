@@ -0,0 +1,394 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <algorithm>
+#include <cstring>
+
+#include <k4a/k4a.h>
+#include <k4ainternal/matroska_read.h>
+#include <k4ainternal/deloader.h>
+#include <k4ainternal/logging.h>
+
+using namespace LIBMATROSKA_NAMESPACE;
+
+namespace k4arecord
+{
+_depth_decode_job_t::~_depth_decode_job_t()
+{
+    if (depth_image != NULL)
+    {
+        k4a_image_release(depth_image);
+    }
+    if (ir_image != NULL)
+    {
+        k4a_image_release(ir_image);
+    }
+}
+
+// The depth engine modes of the sensor modes, as the SDK runs it while streaming
+static bool get_depth_engine_mode(k4a_depth_mode_t depth_mode,
+                                  k4a_depth_engine_mode_t *mode,
+                                  k4a_depth_engine_input_type_t *input_format)
+{
+    *input_format = K4A_DEPTH_ENGINE_INPUT_TYPE_12BIT_COMPRESSED;
+    switch (depth_mode)
+    {
+    case K4A_DEPTH_MODE_NFOV_2X2BINNED:
+        *mode = K4A_DEPTH_ENGINE_MODE_LT_SW_BINNING;
+        return true;
+    case K4A_DEPTH_MODE_WFOV_2X2BINNED:
+        *mode = K4A_DEPTH_ENGINE_MODE_QUARTER_MEGA_PIXEL;
+        return true;
+    case K4A_DEPTH_MODE_NFOV_UNBINNED:
+        *mode = K4A_DEPTH_ENGINE_MODE_LT_NATIVE;
+        return true;
+    case K4A_DEPTH_MODE_WFOV_UNBINNED:
+        *mode = K4A_DEPTH_ENGINE_MODE_MEGA_PIXEL;
+        *input_format = K4A_DEPTH_ENGINE_INPUT_TYPE_8BIT_COMPRESSED;
+        return true;
+    case K4A_DEPTH_MODE_PASSIVE_IR:
+        *mode = K4A_DEPTH_ENGINE_MODE_PCM;
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Creates the depth engine of a decoder thread. The calibrations must outlive the depth engine.
+static k4a_result_t create_depth_engine(k4a_playback_context_t *context,
+                                        std::vector<uint8_t> &calibration,
+                                        k4a_calibration_camera_t &camera_calibration,
+                                        std::vector<uint8_t> &output,
+                                        k4a_depth_engine_context_t **depth_engine)
+{
+    k4a_depth_engine_mode_t mode;
+    k4a_depth_engine_input_type_t input_format;
+    if (!get_depth_engine_mode(context->record_config.depth_mode, &mode, &input_format))
+    {
+        LOG_ERROR("Unsupported depth mode for raw depth payloads: %d", context->record_config.depth_mode);
+        return K4A_RESULT_FAILED;
+    }
+
+    try
+    {
+        KaxFileData &file_data = GetChild<KaxFileData>(*context->depth_calibration_attachment);
+        calibration.assign(file_data.GetBuffer(), file_data.GetBuffer() + file_data.GetSize());
+    }
+    catch (std::bad_alloc &)
+    {
+        LOG_ERROR("Failed to allocate the depth calibration of the depth engine.", 0);
+        return K4A_RESULT_FAILED;
+    }
+    camera_calibration = context->depth_engine_camera_calibration;
+
+    k4a_depth_engine_result_code_t deresult = deloader_depth_engine_create_and_initialize(depth_engine,
+                                                                                          calibration.size(),
+                                                                                          calibration.data(),
+                                                                                          mode,
+                                                                                          input_format,
+                                                                                          &camera_calibration,
+                                                                                          NULL,
+                                                                                          NULL);
+    if (deresult != K4A_DEPTH_ENGINE_RESULT_SUCCEEDED)
+    {
+        LOG_ERROR("Depth engine create and initialize failed with error code: %d.", deresult);
+        *depth_engine = NULL;
+        return K4A_RESULT_FAILED;
+    }
+
+    try
+    {
+        output.resize(deloader_depth_engine_get_output_frame_size(*depth_engine));
+    }
+    catch (std::bad_alloc &)
+    {
+        LOG_ERROR("Failed to allocate the depth engine output buffer.", 0);
+        deloader_depth_engine_destroy(depth_engine);
+        return K4A_RESULT_FAILED;
+    }
+    return K4A_RESULT_SUCCEEDED;
+}
+
+static void depth_decoder_thread(k4a_playback_context_t *context)
+{
+    k4a_depth_engine_context_t *depth_engine = NULL;
+    bool depth_engine_failed = false;
+    std::vector<uint8_t> calibration;
+    k4a_calibration_camera_t camera_calibration;
+    std::vector<uint8_t> output;
+
+    try
+    {
+        std::unique_lock<std::mutex> lock(context->depth_decode_lock);
+        while (true)
+        {
+            context->depth_decode_notify->wait(lock, [context]() {
+                return context->depth_decoders_stopping || !context->depth_decode_queue.empty();
+            });
+            if (context->depth_decoders_stopping)
+            {
+                break;
+            }
+
+            std::shared_ptr<depth_decode_job_t> job = context->depth_decode_queue.front();
+            context->depth_decode_queue.pop_front();
+
+            lock.unlock();
+            // The depth engine is created by the first payload, a thread that can't create one fails its jobs
+            if (depth_engine == NULL && !depth_engine_failed)
+            {
+                depth_engine_failed = K4A_FAILED(
+                    TRACE_CALL(create_depth_engine(context, calibration, camera_calibration, output, &depth_engine)));
+            }
+            if (depth_engine != NULL)
+            {
+                convert_raw_depth_block(context, depth_engine, output, job.get());
+            }
+            lock.lock();
+
+            job->done = true;
+            context->depth_decode_done->notify_all();
+        }
+    }
+    catch (std::system_error &e)
+    {
+        LOG_ERROR("Depth decoder thread threw exception: %s", e.what());
+    }
+
+    if (depth_engine != NULL)
+    {
+        deloader_depth_engine_destroy(&depth_engine);
+    }
+}
+
+k4a_result_t start_depth_decoder_threads(k4a_playback_context_t *context)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context->depth_track == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, !context->depth_decoders.empty());
+
+    if (context->depth_calibration_attachment == NULL || context->calibration_attachment == NULL)
+    {
+        LOG_ERROR("The depth engine needs the depth and device calibrations, they are missing from the recording.", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    // The depth engine is given the unbinned calibration of the depth camera, which the unbinned wide mode keeps as is
+    KaxFileData &file_data = GetChild<KaxFileData>(*context->calibration_attachment);
+    std::vector<char> buffer;
+    try
+    {
+        buffer.resize((size_t)file_data.GetSize() + 1);
+    }
+    catch (std::bad_alloc &)
+    {
+        LOG_ERROR("Failed to allocate the device calibration.", 0);
+        return K4A_RESULT_FAILED;
+    }
+    memcpy(buffer.data(), file_data.GetBuffer(), (size_t)file_data.GetSize());
+    buffer[buffer.size() - 1] = '\0';
+    k4a_calibration_t calibration;
+    RETURN_IF_ERROR(k4a_calibration_get_from_raw(
+        buffer.data(), buffer.size(), K4A_DEPTH_MODE_WFOV_UNBINNED, K4A_COLOR_RESOLUTION_OFF, &calibration));
+    context->depth_engine_camera_calibration = calibration.depth_camera_calibration;
+
+    try
+    {
+        // The decoder threads share the buffer pool of the track, it must exist before they allocate from it
+        if (context->depth_track->buffer_pool == nullptr)
+        {
+            context->depth_track->buffer_pool = std::make_shared<image_buffer_pool_t>();
+        }
+
+        context->depth_decode_notify.reset(new std::condition_variable());
+        context->depth_decode_done.reset(new std::condition_variable());
+
+        context->depth_decoders_stopping = false;
+        for (size_t i = 0; i < DEPTH_DECODER_THREAD_COUNT; i++)
+        {
+            context->depth_decoders.emplace_back(depth_decoder_thread, context);
+        }
+    }
+    catch (std::system_error &e)
+    {
+        // Unlike color images, raw payloads can only be converted by a decoder thread
+        if (context->depth_decoders.empty())
+        {
+            LOG_ERROR("Failed to start depth decoder threads: %s", e.what());
+            return K4A_RESULT_FAILED;
+        }
+        LOG_WARNING("Failed to start depth decoder thread: %s", e.what());
+    }
+
+    return K4A_RESULT_SUCCEEDED;
+}
+
+void stop_depth_decoder_threads(k4a_playback_context_t *context)
+{
+    RETURN_VALUE_IF_ARG(VOID_VALUE, context == NULL);
+
+    reset_depth_decode_ahead(context);
+    try
+    {
+        {
+            std::lock_guard<std::mutex> lock(context->depth_decode_lock);
+            context->depth_decoders_stopping = true;
+        }
+        if (context->depth_decode_notify)
+        {
+            context->depth_decode_notify->notify_all();
+        }
+        for (std::thread &decoder : context->depth_decoders)
+        {
+            decoder.join();
+        }
+        context->depth_decoders.clear();
+    }
+    catch (std::system_error &e)
+    {
+        LOG_ERROR("Failed to stop depth decoder threads: %s", e.what());
+    }
+}
+
+// Queues a job for block to the decoder threads, called with depth_decode_lock held
+static std::shared_ptr<depth_decode_job_t> queue_depth_decode_job(k4a_playback_context_t *context,
+                                                                  const std::shared_ptr<block_info_t> &block)
+{
+    std::shared_ptr<depth_decode_job_t> job = std::make_shared<depth_decode_job_t>();
+    job->block = block;
+    context->depth_decode_jobs.push_back(job);
+    context->depth_decode_queue.push_back(job);
+    context->depth_decode_notify->notify_one();
+    return job;
+}
+
+// Queues the conversion of the depth blocks following the last one queued, or the current depth block, until
+// DEPTH_DECODE_AHEAD_COUNT of them are ahead of get_capture().
+void decode_ahead_depth_images(k4a_playback_context_t *context)
+{
+    RETURN_VALUE_IF_ARG(VOID_VALUE, context == NULL);
+    if (context->depth_track == NULL || !context->depth_track->enabled || context->depth_decoders.empty())
+    {
+        return;
+    }
+
+    std::shared_ptr<block_info_t> block = context->depth_decode_jobs.empty() ? context->depth_track->current_block :
+                                                                              context->depth_decode_jobs.back()->block;
+    try
+    {
+        while (block && context->depth_decode_jobs.size() < DEPTH_DECODE_AHEAD_COUNT)
+        {
+            block = next_block(context, block.get(), true);
+            if (block == nullptr || block->block == NULL)
+            {
+                // End of recording reached
+                break;
+            }
+
+            std::lock_guard<std::mutex> lock(context->depth_decode_lock);
+            queue_depth_decode_job(context, block);
+        }
+    }
+    catch (std::system_error &e)
+    {
+        // The images not queued are queued by get_capture() once it reaches them
+        LOG_WARNING("Failed to queue depth decode-ahead: %s", e.what());
+    }
+}
+
+// Waits for a job to be converted or, if no decoder thread has taken it yet, removes it from the queue. Once it
+// returns, the decoder threads no longer use the job.
+static void cancel_depth_decode_job(k4a_playback_context_t *context,
+                                    std::unique_lock<std::mutex> &lock,
+                                    const std::shared_ptr<depth_decode_job_t> &job)
+{
+    auto queued = std::find(context->depth_decode_queue.begin(), context->depth_decode_queue.end(), job);
+    if (queued != context->depth_decode_queue.end())
+    {
+        context->depth_decode_queue.erase(queued);
+    }
+    else
+    {
+        context->depth_decode_done->wait(lock, [&job]() { return job->done; });
+    }
+}
+
+// Takes the images the decoder threads converted from block, after dropping the jobs of the blocks before it. A block
+// that wasn't queued ahead is queued first, after dropping every job. Starts the decoder threads on first use, returns
+// NULL if they can't be started.
+std::shared_ptr<depth_decode_job_t> take_decoded_depth_images(k4a_playback_context_t *context, block_info_t *block)
+{
+    RETURN_VALUE_IF_ARG(nullptr, context == NULL);
+    RETURN_VALUE_IF_ARG(nullptr, block == NULL);
+
+    if (context->depth_decoders.empty() && K4A_FAILED(TRACE_CALL(start_depth_decoder_threads(context))))
+    {
+        return nullptr;
+    }
+
+    auto match = std::find_if(context->depth_decode_jobs.begin(),
+                              context->depth_decode_jobs.end(),
+                              [block](const std::shared_ptr<depth_decode_job_t> &job) {
+                                  return job->block->cluster->cluster_info == block->cluster->cluster_info &&
+                                         job->block->index == block->index;
+                              });
+    if (match == context->depth_decode_jobs.end())
+    {
+        reset_depth_decode_ahead(context);
+    }
+
+    try
+    {
+        std::unique_lock<std::mutex> lock(context->depth_decode_lock);
+        if (context->depth_decode_jobs.empty())
+        {
+            // The copy of the block holds its cluster, which stays loaded for the job
+            queue_depth_decode_job(context, new_block_info(context, *block));
+        }
+        else
+        {
+            while (context->depth_decode_jobs.front() != *match)
+            {
+                cancel_depth_decode_job(context, lock, context->depth_decode_jobs.front());
+                context->depth_decode_jobs.pop_front();
+            }
+        }
+
+        std::shared_ptr<depth_decode_job_t> job = context->depth_decode_jobs.front();
+        context->depth_decode_jobs.pop_front();
+        context->depth_decode_done->wait(lock, [&job]() { return job->done; });
+        return job;
+    }
+    catch (std::system_error &e)
+    {
+        LOG_ERROR("Failed to wait for depth decode-ahead: %s", e.what());
+        return nullptr;
+    }
+}
+
+// Drops every decode-ahead job, waiting for the ones being converted. Called when playback moves to a block that
+// wasn't queued.
+void reset_depth_decode_ahead(k4a_playback_context_t *context)
+{
+    RETURN_VALUE_IF_ARG(VOID_VALUE, context == NULL);
+    if (context->depth_decode_jobs.empty())
+    {
+        return;
+    }
+
+    try
+    {
+        std::unique_lock<std::mutex> lock(context->depth_decode_lock);
+        for (const std::shared_ptr<depth_decode_job_t> &job : context->depth_decode_jobs)
+        {
+            cancel_depth_decode_job(context, lock, job);
+        }
+    }
+    catch (std::system_error &e)
+    {
+        LOG_ERROR("Failed to wait for depth decode-ahead: %s", e.what());
+    }
+    context->depth_decode_jobs.clear();
+}
+
+} // namespace k4arecord
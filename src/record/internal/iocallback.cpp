@@ -3,11 +3,60 @@
 
 #include "k4ainternal/matroska_common.h"
 
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 using namespace k4arecord;
 
+// Unbuffered IO needs the offset, size and memory of every read and write to be aligned to the sector size of the
+// device, 4KB covers the devices recordings are written to.
+#define UNBUFFERED_IO_ALIGNMENT 4096
+
+// Size of each write buffer of UnbufferedFileIOCallback, and so of the writes it issues
+#define UNBUFFERED_IO_BUFFER_SIZE (8 * 1024 * 1024)
+
+// Buffers of UnbufferedFileIOCallback, all but the one being filled can be waiting for the disk
+#define UNBUFFERED_IO_BUFFER_COUNT 4
+
+// Threads writing the full buffers of UnbufferedFileIOCallback, each keeps one write in flight
+#define UNBUFFERED_IO_WRITER_COUNT 2
+static_assert(UNBUFFERED_IO_BUFFER_SIZE % UNBUFFERED_IO_ALIGNMENT == 0, "Unaligned unbuffered IO buffer size");
+
 static_assert(sizeof(std::streamoff) == sizeof(int64), "64-bit seeking is not supported on this architecture");
 static_assert(sizeof(std::streamsize) == sizeof(int64), "64-bit seeking is not supported on this architecture");
 
+// Reserves the disk space of the first size bytes of a file, without changing the size of the file
+#ifdef _WIN32
+static bool reserve_disk_space(void *file, uint64_t size)
+{
+    FILE_ALLOCATION_INFO allocation;
+    allocation.AllocationSize.QuadPart = (LONGLONG)size;
+    return SetFileInformationByHandle(file, FileAllocationInfo, &allocation, sizeof(allocation)) != 0;
+}
+#else
+static bool reserve_disk_space(int fd, uint64_t size)
+{
+#ifdef FALLOC_FL_KEEP_SIZE
+    return fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, (off_t)size) == 0;
+#else
+    (void)fd;
+    (void)size;
+    return false;
+#endif
+}
+#endif
+
 LargeFileIOCallback::LargeFileIOCallback(const char *path, const open_mode mode) : m_owner(std::this_thread::get_id())
 {
     assert(path);
@@ -34,6 +83,11 @@ LargeFileIOCallback::LargeFileIOCallback(const char *path, const open_mode mode)
     m_stream.exceptions(std::ios::failbit | std::ios::badbit);
     m_stream.open(path, om);
     m_stream.exceptions(std::ios::badbit); // Don't throw exceptions for EOF errors
+
+    if (mode == MODE_WRITE || mode == MODE_CREATE)
+    {
+        m_path = path;
+    }
 }
 
 LargeFileIOCallback::~LargeFileIOCallback()
@@ -97,11 +151,1066 @@ void LargeFileIOCallback::close()
         // exception. Enable failbit exceptions again for file close.
         m_stream.clear();
         m_stream.exceptions(std::ios::failbit | std::ios::badbit);
-        m_stream.close();
+        try
+        {
+            m_stream.close();
+        }
+        catch (std::ios_base::failure &)
+        {
+            release_reservation();
+            throw;
+        }
     }
+    release_reservation();
 }
 
 void LargeFileIOCallback::setOwnerThread()
 {
     m_owner = std::this_thread::get_id();
 }
+
+bool LargeFileIOCallback::reserve(uint64_t size)
+{
+    assert(m_owner == std::this_thread::get_id());
+    if (size <= m_reserved)
+    {
+        return true;
+    }
+    if (m_path.empty() || !m_stream.is_open())
+    {
+        return false;
+    }
+
+    // std::fstream doesn't expose its file, so the space is reserved through a second handle to the file
+#ifdef _WIN32
+    if (m_reserve_file == nullptr)
+    {
+        HANDLE file = CreateFileA(m_path.c_str(),
+                                  GENERIC_WRITE,
+                                  FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                  NULL,
+                                  OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL,
+                                  NULL);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            return false;
+        }
+        m_reserve_file = file;
+    }
+    if (!reserve_disk_space(m_reserve_file, size))
+    {
+        return false;
+    }
+#else
+    if (m_reserve_fd < 0)
+    {
+        m_reserve_fd = ::open(m_path.c_str(), O_WRONLY | O_CLOEXEC);
+        if (m_reserve_fd < 0)
+        {
+            return false;
+        }
+    }
+    if (!reserve_disk_space(m_reserve_fd, size))
+    {
+        return false;
+    }
+#endif
+
+    m_reserved = size;
+    return true;
+}
+
+// Releases the disk space reserved past the end of the file, and closes the handle it was reserved through
+void LargeFileIOCallback::release_reservation()
+{
+#ifdef _WIN32
+    if (m_reserve_file != nullptr)
+    {
+        // The allocation past the end of the file is released once the last handle to the file is closed
+        CloseHandle(m_reserve_file);
+        m_reserve_file = nullptr;
+    }
+#else
+    if (m_reserve_fd >= 0)
+    {
+        // Truncating the file to its own size releases the blocks past its end. The file is complete either way, so
+        // failures are ignored.
+        struct stat file_stat;
+        if (fstat(m_reserve_fd, &file_stat) == 0)
+        {
+            (void)ftruncate(m_reserve_fd, file_stat.st_size);
+        }
+        ::close(m_reserve_fd);
+        m_reserve_fd = -1;
+    }
+#endif
+}
+
+static uint8_t *allocate_aligned(size_t size)
+{
+#ifdef _WIN32
+    return static_cast<uint8_t *>(_aligned_malloc(size, UNBUFFERED_IO_ALIGNMENT));
+#else
+    void *buffer = NULL;
+    return posix_memalign(&buffer, UNBUFFERED_IO_ALIGNMENT, size) == 0 ? static_cast<uint8_t *>(buffer) : NULL;
+#endif
+}
+
+static void free_aligned(uint8_t *buffer)
+{
+#ifdef _WIN32
+    _aligned_free(buffer);
+#else
+    free(buffer);
+#endif
+}
+
+static size_t align_up(size_t size)
+{
+    return (size + UNBUFFERED_IO_ALIGNMENT - 1) / UNBUFFERED_IO_ALIGNMENT * UNBUFFERED_IO_ALIGNMENT;
+}
+
+UnbufferedFileIOCallback::UnbufferedFileIOCallback(const char *path)
+{
+    assert(path);
+
+#ifdef _WIN32
+    m_file = CreateFileA(path,
+                         GENERIC_READ | GENERIC_WRITE,
+                         FILE_SHARE_READ,
+                         NULL,
+                         CREATE_ALWAYS,
+                         FILE_ATTRIBUTE_NORMAL | FILE_FLAG_NO_BUFFERING,
+                         NULL);
+    if (m_file == INVALID_HANDLE_VALUE)
+    {
+        m_file = nullptr;
+        throw std::ios_base::failure("Failed to create file for unbuffered IO: error " +
+                                     std::to_string(GetLastError()));
+    }
+#else
+    int flags = O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC;
+#ifdef O_DIRECT
+    flags |= O_DIRECT;
+#endif
+    m_fd = ::open(path, flags, 0644);
+    if (m_fd < 0)
+    {
+        throw std::ios_base::failure(std::string("Failed to create file for unbuffered IO: ") + strerror(errno));
+    }
+#if !defined(O_DIRECT) && defined(F_NOCACHE)
+    (void)fcntl(m_fd, F_NOCACHE, 1);
+#endif
+#endif
+
+    try
+    {
+        m_buffer_busy.resize(UNBUFFERED_IO_BUFFER_COUNT, false);
+        for (size_t i = 0; i < UNBUFFERED_IO_BUFFER_COUNT; i++)
+        {
+            m_buffers.push_back(allocate_aligned(UNBUFFERED_IO_BUFFER_SIZE));
+            if (m_buffers.back() == NULL)
+            {
+                throw std::ios_base::failure("Failed to allocate unbuffered IO buffers");
+            }
+        }
+
+        for (size_t i = 0; i < UNBUFFERED_IO_WRITER_COUNT; i++)
+        {
+            m_flushers.emplace_back(&UnbufferedFileIOCallback::flusher_thread, this);
+        }
+    }
+    catch (std::system_error &e)
+    {
+        release();
+        throw std::ios_base::failure(std::string("Failed to start unbuffered IO thread: ") + e.what());
+    }
+    catch (...)
+    {
+        release();
+        throw;
+    }
+}
+
+UnbufferedFileIOCallback::~UnbufferedFileIOCallback()
+{
+    try
+    {
+        close();
+    }
+    catch (std::ios_base::failure &)
+    {
+        // Callers that need to know whether the file was written completely call close() themselves
+    }
+}
+
+uint32 UnbufferedFileIOCallback::read(void *buffer, size_t size)
+{
+    assert(size <= UINT32_MAX); // can't properly return > uint32
+    assert(m_owner == std::this_thread::get_id());
+
+    uint64_t end_of_file = m_buffer_start + m_buffer_fill;
+    if (m_position >= end_of_file)
+    {
+        return 0;
+    }
+
+    uint8_t *data = static_cast<uint8_t *>(buffer);
+    size_t count = (size_t)std::min<uint64_t>(size, end_of_file - m_position);
+    size_t remaining = count;
+    if (m_position < m_buffer_start)
+    {
+        size_t disk_size = (size_t)std::min<uint64_t>(remaining, m_buffer_start - m_position);
+        access_disk(m_position, data, disk_size, false);
+        data += disk_size;
+        remaining -= disk_size;
+        m_position += disk_size;
+    }
+    if (remaining > 0)
+    {
+        memcpy(data, m_buffers[m_active] + (m_position - m_buffer_start), remaining);
+        m_position += remaining;
+    }
+    return (uint32)count;
+}
+
+void UnbufferedFileIOCallback::setFilePointer(int64 offset, libebml::seek_mode mode)
+{
+    assert(mode == SEEK_SET || mode == SEEK_CUR || mode == SEEK_END);
+    assert(m_owner == std::this_thread::get_id());
+
+    switch (mode)
+    {
+    case SEEK_SET:
+        m_position = (uint64_t)offset;
+        break;
+    case SEEK_CUR:
+        m_position += (uint64_t)offset;
+        break;
+    case SEEK_END:
+        m_position = m_buffer_start + m_buffer_fill + (uint64_t)offset;
+        break;
+    }
+}
+
+size_t UnbufferedFileIOCallback::write(const void *buffer, size_t size)
+{
+    assert(m_owner == std::this_thread::get_id());
+
+    const uint8_t *data = static_cast<const uint8_t *>(buffer);
+    size_t remaining = size;
+    uint64_t end_of_file = m_buffer_start + m_buffer_fill;
+    if (m_position > end_of_file)
+    {
+        // Seeking past the end of the file leaves a gap of zeros
+        append(NULL, (size_t)(m_position - end_of_file));
+        end_of_file = m_position;
+    }
+
+    if (remaining > 0 && m_position < m_buffer_start)
+    {
+        size_t disk_size = (size_t)std::min<uint64_t>(remaining, m_buffer_start - m_position);
+        access_disk(m_position, const_cast<uint8_t *>(data), disk_size, true);
+        data += disk_size;
+        remaining -= disk_size;
+        m_position += disk_size;
+    }
+
+    if (remaining > 0 && m_position < end_of_file)
+    {
+        size_t buffered_size = (size_t)std::min<uint64_t>(remaining, end_of_file - m_position);
+        memcpy(m_buffers[m_active] + (m_position - m_buffer_start), data, buffered_size);
+        data += buffered_size;
+        remaining -= buffered_size;
+        m_position += buffered_size;
+    }
+
+    if (remaining > 0)
+    {
+        append(data, remaining);
+        m_position += remaining;
+    }
+    return size;
+}
+
+uint64 UnbufferedFileIOCallback::getFilePointer()
+{
+    assert(m_owner == std::this_thread::get_id());
+    return m_position;
+}
+
+bool UnbufferedFileIOCallback::reserve(uint64_t size)
+{
+    assert(m_owner == std::this_thread::get_id());
+    if (size <= m_reserved)
+    {
+        return true;
+    }
+
+    // close() sets the size of the file, which releases the space reserved past its end
+#ifdef _WIN32
+    if (m_file == nullptr || !reserve_disk_space(m_file, size))
+#else
+    if (m_fd < 0 || !reserve_disk_space(m_fd, size))
+#endif
+    {
+        return false;
+    }
+    m_reserved = size;
+    return true;
+}
+
+void UnbufferedFileIOCallback::close()
+{
+    if (m_buffers.empty())
+    {
+        // Already closed
+        return;
+    }
+
+    // The partial last buffer is written padded to the alignment, and the padding is truncated
+    std::string error;
+    try
+    {
+        wait_for_flush();
+        if (m_buffer_fill > 0)
+        {
+            size_t padded_size = align_up(m_buffer_fill);
+            memset(m_buffers[m_active] + m_buffer_fill, 0, padded_size - m_buffer_fill);
+            write_at(m_buffer_start, m_buffers[m_active], padded_size);
+        }
+
+        uint64_t file_size = m_buffer_start + m_buffer_fill;
+#ifdef _WIN32
+        LARGE_INTEGER end_of_file;
+        end_of_file.QuadPart = (LONGLONG)file_size;
+        if (!SetFilePointerEx(m_file, end_of_file, NULL, FILE_BEGIN) || !SetEndOfFile(m_file))
+        {
+            throw std::ios_base::failure("Failed to set the size of the file: error " + std::to_string(GetLastError()));
+        }
+#else
+        if (ftruncate(m_fd, (off_t)file_size) != 0)
+        {
+            throw std::ios_base::failure(std::string("Failed to set the size of the file: ") + strerror(errno));
+        }
+#endif
+    }
+    catch (std::ios_base::failure &e)
+    {
+        error = e.what();
+    }
+
+    release();
+    if (!error.empty())
+    {
+        throw std::ios_base::failure(error);
+    }
+}
+
+// Appends data, or zeros if data is NULL, to the end of the file
+void UnbufferedFileIOCallback::append(const uint8_t *data, size_t size)
+{
+    while (size > 0)
+    {
+        size_t count = std::min(size, (size_t)UNBUFFERED_IO_BUFFER_SIZE - m_buffer_fill);
+        if (data != NULL)
+        {
+            memcpy(m_buffers[m_active] + m_buffer_fill, data, count);
+            data += count;
+        }
+        else
+        {
+            memset(m_buffers[m_active] + m_buffer_fill, 0, count);
+        }
+        m_buffer_fill += count;
+        size -= count;
+
+        if (m_buffer_fill == UNBUFFERED_IO_BUFFER_SIZE)
+        {
+            submit_active_buffer();
+        }
+    }
+}
+
+size_t UnbufferedFileIOCallback::getWritesInFlight()
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return m_writes_in_flight;
+}
+
+// Queues the full active buffer for the flusher threads, and continues in the next buffer once it is free. This only
+// blocks when every other buffer is still waiting for the disk.
+void UnbufferedFileIOCallback::submit_active_buffer()
+{
+    size_t next = (m_active + 1) % m_buffers.size();
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+        m_flush_queue.emplace_back(m_active, m_buffer_start);
+        m_buffer_busy[m_active] = true;
+        m_writes_in_flight++;
+        m_notify.notify_all();
+
+        m_notify.wait(lock, [this, next]() { return !m_buffer_busy[next] || !m_error.empty(); });
+        if (!m_error.empty())
+        {
+            throw std::ios_base::failure(m_error);
+        }
+    }
+
+    m_active = next;
+    m_buffer_start += UNBUFFERED_IO_BUFFER_SIZE;
+    m_buffer_fill = 0;
+}
+
+// Waits for the writes of the flusher threads to complete, and throws the error of the first one that failed
+void UnbufferedFileIOCallback::wait_for_flush()
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+    m_notify.wait(lock, [this]() { return m_writes_in_flight == 0; });
+    if (!m_error.empty())
+    {
+        throw std::ios_base::failure(m_error);
+    }
+}
+
+// Reads or writes data before m_buffer_start, in aligned blocks staged in an idle buffer
+void UnbufferedFileIOCallback::access_disk(uint64_t offset, uint8_t *data, size_t size, bool write)
+{
+    wait_for_flush();
+    uint8_t *staging = m_buffers[(m_active + 1) % m_buffers.size()];
+    while (size > 0)
+    {
+        uint64_t block_offset = offset - offset % UNBUFFERED_IO_ALIGNMENT;
+        size_t skip = (size_t)(offset - block_offset);
+        size_t count = std::min(size, (size_t)UNBUFFERED_IO_BUFFER_SIZE - skip);
+        size_t block_size = align_up(skip + count);
+        assert(block_offset + block_size <= m_buffer_start);
+
+        if (!write || skip != 0 || count != block_size)
+        {
+            read_at(block_offset, staging, block_size);
+        }
+        if (write)
+        {
+            memcpy(staging + skip, data, count);
+            write_at(block_offset, staging, block_size);
+        }
+        else
+        {
+            memcpy(data, staging + skip, count);
+        }
+
+        offset += count;
+        data += count;
+        size -= count;
+    }
+}
+
+// Buffers cover disjoint ranges of the file, so the flusher threads write them in any order
+void UnbufferedFileIOCallback::flusher_thread()
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+    while (true)
+    {
+        m_notify.wait(lock, [this]() { return m_stopping || !m_flush_queue.empty(); });
+        if (m_flush_queue.empty())
+        {
+            break;
+        }
+
+        size_t buffer = m_flush_queue.front().first;
+        uint64_t offset = m_flush_queue.front().second;
+        m_flush_queue.pop_front();
+        lock.unlock();
+        std::string error;
+        try
+        {
+            write_at(offset, m_buffers[buffer], UNBUFFERED_IO_BUFFER_SIZE);
+        }
+        catch (std::ios_base::failure &e)
+        {
+            error = e.what();
+        }
+        lock.lock();
+
+        if (m_error.empty())
+        {
+            m_error = error;
+        }
+        m_buffer_busy[buffer] = false;
+        m_writes_in_flight--;
+        m_notify.notify_all();
+    }
+}
+
+void UnbufferedFileIOCallback::write_at(uint64_t offset, const uint8_t *data, size_t size)
+{
+    assert(offset % UNBUFFERED_IO_ALIGNMENT == 0 && size % UNBUFFERED_IO_ALIGNMENT == 0);
+
+    while (size > 0)
+    {
+#ifdef _WIN32
+        OVERLAPPED overlapped = {};
+        overlapped.Offset = (DWORD)offset;
+        overlapped.OffsetHigh = (DWORD)(offset >> 32);
+        DWORD written = 0;
+        if (!WriteFile(m_file, data, (DWORD)std::min(size, (size_t)UNBUFFERED_IO_BUFFER_SIZE), &written, &overlapped))
+        {
+            throw std::ios_base::failure("Unbuffered file write failed: error " + std::to_string(GetLastError()));
+        }
+        size_t count = written;
+#else
+        ssize_t result = pwrite(m_fd, data, size, (off_t)offset);
+        if (result < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (result <= 0)
+        {
+            throw std::ios_base::failure(std::string("Unbuffered file write failed: ") + strerror(errno));
+        }
+        size_t count = (size_t)result;
+#endif
+        offset += count;
+        data += count;
+        size -= count;
+    }
+}
+
+void UnbufferedFileIOCallback::read_at(uint64_t offset, uint8_t *data, size_t size)
+{
+    assert(offset % UNBUFFERED_IO_ALIGNMENT == 0 && size % UNBUFFERED_IO_ALIGNMENT == 0);
+
+    while (size > 0)
+    {
+#ifdef _WIN32
+        OVERLAPPED overlapped = {};
+        overlapped.Offset = (DWORD)offset;
+        overlapped.OffsetHigh = (DWORD)(offset >> 32);
+        DWORD bytes_read = 0;
+        DWORD chunk_size = (DWORD)std::min(size, (size_t)UNBUFFERED_IO_BUFFER_SIZE);
+        if (!ReadFile(m_file, data, chunk_size, &bytes_read, &overlapped) || bytes_read == 0)
+        {
+            throw std::ios_base::failure("Unbuffered file read failed: error " + std::to_string(GetLastError()));
+        }
+        size_t count = bytes_read;
+#else
+        ssize_t result = pread(m_fd, data, size, (off_t)offset);
+        if (result < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (result <= 0)
+        {
+            throw std::ios_base::failure(std::string("Unbuffered file read failed: ") +
+                                         (result == 0 ? "unexpected end of file" : strerror(errno)));
+        }
+        size_t count = (size_t)result;
+#endif
+        offset += count;
+        data += count;
+        size -= count;
+    }
+}
+
+// Stops the flusher thread, closes the file and frees the buffers
+void UnbufferedFileIOCallback::release()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_stopping = true;
+    }
+    m_notify.notify_all();
+    for (std::thread &flusher : m_flushers)
+    {
+        flusher.join();
+    }
+    m_flushers.clear();
+
+#ifdef _WIN32
+    if (m_file != nullptr)
+    {
+        CloseHandle(m_file);
+        m_file = nullptr;
+    }
+#else
+    if (m_fd >= 0)
+    {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+#endif
+
+    for (uint8_t *buffer : m_buffers)
+    {
+        free_aligned(buffer);
+    }
+    m_buffers.clear();
+}
+
+_mapped_file_t::~_mapped_file_t()
+{
+    if (data != nullptr)
+    {
+#ifdef _WIN32
+        (void)UnmapViewOfFile(data);
+#else
+        (void)munmap(data, (size_t)size);
+#endif
+    }
+}
+
+MappedFileIOCallback::MappedFileIOCallback(const char *path)
+{
+    assert(path);
+
+    std::shared_ptr<mapped_file_t> mapping = std::make_shared<mapped_file_t>();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path,
+                              GENERIC_READ,
+                              FILE_SHARE_READ,
+                              NULL,
+                              OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+                              NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        throw std::ios_base::failure("Failed to open file for mapping: error " + std::to_string(GetLastError()));
+    }
+
+    // The view stays valid once the file and mapping handles are closed
+    LARGE_INTEGER file_size;
+    HANDLE file_mapping = NULL;
+    if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0 && (uint64_t)file_size.QuadPart <= SIZE_MAX)
+    {
+        mapping->size = (uint64_t)file_size.QuadPart;
+        file_mapping = CreateFileMappingA(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    }
+    if (file_mapping != NULL)
+    {
+        mapping->data = static_cast<uint8_t *>(MapViewOfFile(file_mapping, FILE_MAP_COPY, 0, 0, 0));
+        CloseHandle(file_mapping);
+    }
+    DWORD error = GetLastError();
+    CloseHandle(file);
+    if (mapping->data == nullptr)
+    {
+        throw std::ios_base::failure("Failed to map file: error " + std::to_string(error));
+    }
+#else
+    int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        throw std::ios_base::failure(std::string("Failed to open file for mapping: ") + strerror(errno));
+    }
+
+    // The mapping stays valid once the file is closed
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || file_stat.st_size <= 0 || (uint64_t)file_stat.st_size > SIZE_MAX)
+    {
+        ::close(fd);
+        throw std::ios_base::failure("Failed to map file: it is empty or too large to map");
+    }
+    void *data = mmap(NULL, (size_t)file_stat.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    int error = errno;
+    ::close(fd);
+    if (data == MAP_FAILED)
+    {
+        throw std::ios_base::failure(std::string("Failed to map file: ") + strerror(error));
+    }
+    mapping->data = static_cast<uint8_t *>(data);
+    mapping->size = (uint64_t)file_stat.st_size;
+#endif
+
+    m_mapping = mapping;
+}
+
+MappedFileIOCallback::MappedFileIOCallback(const std::shared_ptr<mapped_file_t> &mapping) : m_mapping(mapping)
+{
+    assert(mapping);
+}
+
+uint32 MappedFileIOCallback::read(void *buffer, size_t size)
+{
+    assert(size <= UINT32_MAX); // can't properly return > uint32
+    assert(m_owner == std::this_thread::get_id());
+
+    if (m_mapping == nullptr || m_position >= m_mapping->size)
+    {
+        return 0;
+    }
+
+    size_t count = (size_t)std::min((uint64_t)size, m_mapping->size - m_position);
+    memcpy(buffer, m_mapping->data + m_position, count);
+    m_position += count;
+    return (uint32)count;
+}
+
+void MappedFileIOCallback::setFilePointer(int64 offset, libebml::seek_mode mode)
+{
+    assert(mode == SEEK_SET || mode == SEEK_CUR || mode == SEEK_END);
+    assert(m_owner == std::this_thread::get_id());
+
+    switch (mode)
+    {
+    case SEEK_SET:
+        m_position = (uint64_t)offset;
+        break;
+    case SEEK_CUR:
+        m_position += (uint64_t)offset;
+        break;
+    case SEEK_END:
+        m_position = (m_mapping ? m_mapping->size : 0) + (uint64_t)offset;
+        break;
+    }
+}
+
+size_t MappedFileIOCallback::write(const void *buffer, size_t size)
+{
+    (void)buffer;
+    (void)size;
+    throw std::ios_base::failure("Mapped files are read-only");
+}
+
+uint64 MappedFileIOCallback::getFilePointer()
+{
+    assert(m_owner == std::this_thread::get_id());
+    return m_position;
+}
+
+void MappedFileIOCallback::close()
+{
+    // Images still pointing into the file keep it mapped
+    m_mapping.reset();
+}
+
+std::shared_ptr<mapped_file_t> MappedFileIOCallback::getMapping() const
+{
+    return m_mapping;
+}
+
+_io_callback_source_t::~_io_callback_source_t()
+{
+    if (callbacks.close != NULL)
+    {
+        callbacks.close(callbacks.context);
+    }
+}
+
+CallbackIOCallback::CallbackIOCallback(const std::shared_ptr<io_callback_source_t> &source) : m_source(source)
+{
+    assert(source);
+    assert(source->callbacks.read);
+
+    if (source->callbacks.forward_only)
+    {
+        m_history.resize(CALLBACK_IO_HISTORY_SIZE);
+    }
+}
+
+size_t CallbackIOCallback::readSource(uint64_t offset, uint8_t *buffer, size_t size)
+{
+    int64_t count = m_source->callbacks.read(m_source->callbacks.context, offset, buffer, size);
+    if (count < 0 || (uint64_t)count > size)
+    {
+        throw std::ios_base::failure("Failed to read the recording at " + std::to_string(offset));
+    }
+    return (size_t)count;
+}
+
+// Reads from the current offset of a forward-only source, keeping the bytes read in the history
+size_t CallbackIOCallback::readForward(uint8_t *buffer, size_t size)
+{
+    size_t count = readSource(m_source_position, buffer, size);
+
+    size_t history_size = m_history.size();
+    const uint8_t *kept = buffer + (count > history_size ? count - history_size : 0);
+    uint64_t kept_position = m_source_position + (uint64_t)(kept - buffer);
+    size_t remaining = (size_t)(buffer + count - kept);
+    while (remaining > 0)
+    {
+        size_t index = (size_t)(kept_position % history_size);
+        size_t chunk = std::min(remaining, history_size - index);
+        memcpy(m_history.data() + index, kept, chunk);
+        kept += chunk;
+        kept_position += chunk;
+        remaining -= chunk;
+    }
+
+    m_source_position += count;
+    return count;
+}
+
+// Reads size bytes from the current offset of a forward-only source into the history, growing it to keep them all up to
+// CALLBACK_IO_MAX_HISTORY_SIZE. Returns false if the end of the recording is reached first.
+bool CallbackIOCallback::skipForward(uint64_t size)
+{
+    uint64_t history_size = std::min(size + CALLBACK_IO_HISTORY_SIZE, (uint64_t)CALLBACK_IO_MAX_HISTORY_SIZE);
+    if (history_size > m_history.size())
+    {
+        // Move the bytes already kept to their place in the larger ring
+        std::vector<uint8_t> history((size_t)history_size);
+        uint64_t kept = std::min((uint64_t)m_history.size(), m_source_position);
+        for (uint64_t position = m_source_position - kept; position < m_source_position; position++)
+        {
+            history[(size_t)(position % history_size)] = m_history[(size_t)(position % m_history.size())];
+        }
+        m_history.swap(history);
+    }
+
+    while (size > 0)
+    {
+        size_t index = (size_t)(m_source_position % m_history.size());
+        size_t chunk = (size_t)std::min(size, (uint64_t)(m_history.size() - index));
+        size_t count = readSource(m_source_position, m_history.data() + index, chunk);
+        if (count == 0)
+        {
+            return false;
+        }
+        m_source_position += count;
+        size -= count;
+    }
+    return true;
+}
+
+uint32 CallbackIOCallback::read(void *buffer, size_t size)
+{
+    assert(size <= UINT32_MAX); // can't properly return > uint32
+    assert(m_owner == std::this_thread::get_id());
+
+    if (m_source == nullptr)
+    {
+        throw std::ios_base::failure("The recording is closed");
+    }
+
+    uint8_t *destination = static_cast<uint8_t *>(buffer);
+    size_t count = 0;
+    if (!m_source->callbacks.forward_only)
+    {
+        while (count < size)
+        {
+            size_t read_count = readSource(m_position, destination + count, size - count);
+            if (read_count == 0)
+            {
+                break;
+            }
+            count += read_count;
+            m_position += read_count;
+        }
+        return (uint32)count;
+    }
+
+    // Bytes before the source offset are copied from the history
+    if (m_position < m_source_position)
+    {
+        uint64_t history_start = m_source_position - std::min((uint64_t)m_history.size(), m_source_position);
+        if (m_position < history_start)
+        {
+            throw std::ios_base::failure("Failed to read the recording at " + std::to_string(m_position) +
+                                         ", it was already passed and the recording can only be read forward");
+        }
+
+        size_t history_count = (size_t)std::min((uint64_t)size, m_source_position - m_position);
+        while (count < history_count)
+        {
+            size_t index = (size_t)(m_position % m_history.size());
+            size_t chunk = std::min(history_count - count, m_history.size() - index);
+            memcpy(destination + count, m_history.data() + index, chunk);
+            count += chunk;
+            m_position += chunk;
+        }
+    }
+
+    // Bytes skipped by a forward seek are read into the history, parsing often skips an element before reading it
+    if (m_source_position < m_position && !skipForward(m_position - m_source_position))
+    {
+        return 0;
+    }
+
+    while (count < size)
+    {
+        size_t read_count = readForward(destination + count, size - count);
+        if (read_count == 0)
+        {
+            break;
+        }
+        count += read_count;
+        m_position += read_count;
+    }
+    return (uint32)count;
+}
+
+void CallbackIOCallback::setFilePointer(int64 offset, libebml::seek_mode mode)
+{
+    assert(mode == SEEK_SET || mode == SEEK_CUR || mode == SEEK_END);
+    assert(m_owner == std::this_thread::get_id());
+
+    switch (mode)
+    {
+    case SEEK_SET:
+        m_position = (uint64_t)offset;
+        break;
+    case SEEK_CUR:
+        m_position += (uint64_t)offset;
+        break;
+    case SEEK_END:
+    {
+        uint64_t size = 0;
+        if (m_source && m_source->callbacks.get_size)
+        {
+            size = m_source->callbacks.get_size(m_source->callbacks.context);
+        }
+        if (size == 0)
+        {
+            throw std::ios_base::failure("Failed to seek from the end of the recording, its size is unknown");
+        }
+        m_position = size + (uint64_t)offset;
+        break;
+    }
+    }
+}
+
+size_t CallbackIOCallback::write(const void *buffer, size_t size)
+{
+    (void)buffer;
+    (void)size;
+    throw std::ios_base::failure("Recordings read through I/O callbacks are read-only");
+}
+
+uint64 CallbackIOCallback::getFilePointer()
+{
+    assert(m_owner == std::this_thread::get_id());
+    return m_position;
+}
+
+void CallbackIOCallback::close()
+{
+    // The callbacks are closed once the other handlers sharing them are closed too
+    m_source.reset();
+}
+
+void CallbackIOCallback::readHint(uint64_t offset, uint64_t size)
+{
+    if (m_source && m_source->callbacks.read_hint && !m_source->callbacks.forward_only)
+    {
+        m_source->callbacks.read_hint(m_source->callbacks.context, offset, size);
+    }
+}
+
+StreamWriteIOCallback::StreamWriteIOCallback(const k4a_record_io_callbacks_t &callbacks) : m_callbacks(callbacks)
+{
+    assert(callbacks.write);
+}
+
+StreamWriteIOCallback::~StreamWriteIOCallback()
+{
+    try
+    {
+        close();
+    }
+    catch (std::ios_base::failure &)
+    {
+        // The recording is already failing, there's nothing to report the error to.
+    }
+}
+
+void StreamWriteIOCallback::writeCallback(const uint8_t *buffer, size_t size)
+{
+    int64_t count = m_callbacks.write(m_callbacks.context, buffer, size);
+    if (count < 0 || (uint64_t)count != size)
+    {
+        throw std::ios_base::failure("Failed to write the recording at " + std::to_string(m_position));
+    }
+}
+
+uint32 StreamWriteIOCallback::read(void *buffer, size_t size)
+{
+    (void)buffer;
+    (void)size;
+    throw std::ios_base::failure("Recordings written through I/O callbacks are write-only");
+}
+
+void StreamWriteIOCallback::setFilePointer(int64 offset, libebml::seek_mode mode)
+{
+    assert(mode == SEEK_SET || mode == SEEK_CUR || mode == SEEK_END);
+    assert(m_owner == std::this_thread::get_id());
+
+    uint64_t end = m_committed ? m_position : (uint64_t)m_pending.size();
+    uint64_t position = 0;
+    switch (mode)
+    {
+    case SEEK_SET:
+        position = (uint64_t)offset;
+        break;
+    case SEEK_CUR:
+        position = m_position + (uint64_t)offset;
+        break;
+    case SEEK_END:
+        position = end + (uint64_t)offset;
+        break;
+    }
+
+    if (position > end || (m_committed && position != end))
+    {
+        throw std::ios_base::failure("Recordings written through I/O callbacks can't seek after their header");
+    }
+    m_position = position;
+}
+
+size_t StreamWriteIOCallback::write(const void *buffer, size_t size)
+{
+    assert(m_owner == std::this_thread::get_id());
+
+    if (m_closed)
+    {
+        throw std::ios_base::failure("The recording is closed");
+    }
+
+    const uint8_t *source = static_cast<const uint8_t *>(buffer);
+    if (m_committed)
+    {
+        writeCallback(source, size);
+    }
+    else
+    {
+        size_t overwrite = std::min(size, (size_t)(m_pending.size() - m_position));
+        memcpy(m_pending.data() + m_position, source, overwrite);
+        m_pending.insert(m_pending.end(), source + overwrite, source + size);
+    }
+    m_position += size;
+    return size;
+}
+
+uint64 StreamWriteIOCallback::getFilePointer()
+{
+    assert(m_owner == std::this_thread::get_id());
+    return m_position;
+}
+
+void StreamWriteIOCallback::commit()
+{
+    if (m_committed)
+    {
+        return;
+    }
+
+    m_position = m_pending.size();
+    writeCallback(m_pending.data(), m_pending.size());
+    m_committed = true;
+    std::vector<uint8_t>().swap(m_pending);
+}
+
+void StreamWriteIOCallback::close()
+{
+    if (m_closed)
+    {
+        return;
+    }
+    m_closed = true;
+
+    if (m_callbacks.close != NULL)
+    {
+        m_callbacks.close(m_callbacks.context);
+    }
+}
@@ -0,0 +1,218 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <k4ainternal/matroska_common.h>
+
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+
+#if defined(__SSSE3__) || (defined(_MSC_VER) && (defined(_M_AMD64) || defined(_M_IX86)))
+#define K4A_USING_SSSE3
+#include <tmmintrin.h> // SSSE3
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define K4A_USING_NEON
+#include <arm_neon.h>
+#endif
+
+void swap_bytes_16_copy(uint16_t *destination, const uint16_t *source, size_t count)
+{
+    size_t i = 0;
+
+#if defined(K4A_USING_SSSE3)
+    // Each 16 byte load is shuffled before it is stored, which keeps in place swaps correct
+    const __m128i shuffle = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i));
+        __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i + 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(destination + i), _mm_shuffle_epi8(low, shuffle));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(destination + i + 8), _mm_shuffle_epi8(high, shuffle));
+    }
+#elif defined(K4A_USING_NEON)
+    for (; i + 16 <= count; i += 16)
+    {
+        uint8x16_t low = vld1q_u8(reinterpret_cast<const uint8_t *>(source + i));
+        uint8x16_t high = vld1q_u8(reinterpret_cast<const uint8_t *>(source + i + 8));
+        vst1q_u8(reinterpret_cast<uint8_t *>(destination + i), vrev16q_u8(low));
+        vst1q_u8(reinterpret_cast<uint8_t *>(destination + i + 8), vrev16q_u8(high));
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        destination[i] = swap_bytes_16(source[i]);
+    }
+}
+
+typedef struct _rvl_writer_t
+{
+    uint8_t *output;
+    uint32_t word; // Nibbles are packed in 32-bit words, most significant first
+    int nibbles;
+} rvl_writer_t;
+
+static void rvl_write_vle(rvl_writer_t *writer, uint32_t value)
+{
+    do
+    {
+        // 3 bits of the value per nibble, the high bit is set if more nibbles follow
+        uint32_t nibble = value & 0x7;
+        value >>= 3;
+        if (value != 0)
+        {
+            nibble |= 0x8;
+        }
+
+        writer->word = (writer->word << 4) | nibble;
+        if (++writer->nibbles == 8)
+        {
+            write_uint32_le(writer->output, writer->word);
+            writer->output += 4;
+            writer->word = 0;
+            writer->nibbles = 0;
+        }
+    } while (value != 0);
+}
+
+size_t rvl_encode(const uint16_t *source, size_t count, uint8_t *destination)
+{
+    assert(count <= UINT32_MAX);
+    rvl_writer_t writer = { destination, 0, 0 };
+    const uint16_t *end = source + count;
+    int32_t previous = 0;
+
+    while (source != end)
+    {
+        const uint16_t *run = source;
+        while (source != end && *source == 0)
+        {
+            source++;
+        }
+        rvl_write_vle(&writer, (uint32_t)(source - run));
+
+        run = source;
+        while (run != end && *run != 0)
+        {
+            run++;
+        }
+        rvl_write_vle(&writer, (uint32_t)(run - source));
+
+        for (; source != run; source++)
+        {
+            int32_t delta = (int32_t)*source - previous;
+            rvl_write_vle(&writer, ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31));
+            previous = *source;
+        }
+    }
+
+    if (writer.nibbles != 0)
+    {
+        write_uint32_le(writer.output, writer.word << (4 * (8 - writer.nibbles)));
+        writer.output += 4;
+    }
+
+    return (size_t)(writer.output - destination);
+}
+
+typedef struct _rvl_reader_t
+{
+    const uint8_t *input;
+    const uint8_t *end;
+    uint32_t word;
+    int nibbles;
+} rvl_reader_t;
+
+static bool rvl_read_vle(rvl_reader_t *reader, uint32_t *value)
+{
+    uint32_t result = 0;
+    for (int shift = 0; shift < 32; shift += 3)
+    {
+        if (reader->nibbles == 0)
+        {
+            if (reader->end - reader->input < 4)
+            {
+                return false;
+            }
+            reader->word = read_uint32_le(reader->input);
+            reader->input += 4;
+            reader->nibbles = 8;
+        }
+
+        uint32_t nibble = reader->word >> 28;
+        reader->word <<= 4;
+        reader->nibbles--;
+
+        result |= (nibble & 0x7) << shift;
+        if ((nibble & 0x8) == 0)
+        {
+            *value = result;
+            return true;
+        }
+    }
+
+    // Longer than any 32-bit value
+    return false;
+}
+
+bool rvl_decode(const uint8_t *source, size_t size, uint16_t *destination, size_t count)
+{
+    rvl_reader_t reader = { source, source + size, 0, 0 };
+    int32_t previous = 0;
+
+    while (count > 0)
+    {
+        uint32_t zeros = 0;
+        if (!rvl_read_vle(&reader, &zeros) || zeros > count)
+        {
+            return false;
+        }
+        memset(destination, 0, zeros * sizeof(uint16_t));
+        destination += zeros;
+        count -= zeros;
+
+        uint32_t nonzeros = 0;
+        if (!rvl_read_vle(&reader, &nonzeros) || nonzeros > count)
+        {
+            return false;
+        }
+        count -= nonzeros;
+
+        for (; nonzeros > 0; nonzeros--)
+        {
+            uint32_t zigzag = 0;
+            if (!rvl_read_vle(&reader, &zigzag))
+            {
+                return false;
+            }
+            previous += (int32_t)(zigzag >> 1) ^ -(int32_t)(zigzag & 1);
+            *destination++ = (uint16_t)previous;
+        }
+    }
+
+    return true;
+}
+
+namespace k4arecord
+{
+std::string get_segment_path(const char *path, uint32_t segment_index)
+{
+    std::string segment_path(path);
+    if (segment_index == 0)
+    {
+        return segment_path;
+    }
+
+    size_t name_start = segment_path.find_last_of("/\\");
+    size_t extension_start = segment_path.find_last_of('.');
+    if (extension_start == std::string::npos || (name_start != std::string::npos && extension_start < name_start))
+    {
+        extension_start = segment_path.size();
+    }
+
+    char index_str[16];
+    snprintf(index_str, sizeof(index_str), "_%04u", segment_index);
+    segment_path.insert(extension_start, index_str);
+    return segment_path;
+}
+} // namespace k4arecord
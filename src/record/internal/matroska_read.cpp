@@ -5,11 +5,13 @@
 #include <iostream>
 #include <algorithm>
 #include <climits>
+#include <cstring>
 #include <sstream>
 
 #include <k4a/k4a.h>
 #include <k4ainternal/matroska_read.h>
 #include <k4ainternal/common.h>
+#include <k4ainternal/deloader.h>
 #include <k4ainternal/logging.h>
 
 #include <turbojpeg.h>
@@ -17,6 +19,12 @@
 
 using namespace LIBMATROSKA_NAMESPACE;
 
+// Idle image buffers kept by each track, enough for the color conversion scratch and a few images held by the caller
+#define PLAYBACK_BUFFER_POOL_DEPTH 4
+
+// Idle block allocations kept by each playback, more than the blocks the tracks and the decode-ahead jobs hold at once
+#define PLAYBACK_BLOCK_POOL_DEPTH 32
+
 namespace k4arecord
 {
 std::unique_ptr<EbmlElement> next_child(k4a_playback_context_t *context, EbmlElement *parent)
@@ -127,6 +135,59 @@ bool seek_info_ready(k4a_playback_context_t *context)
            context->attachments_offset > 0 && context->first_cluster_offset > 0;
 }
 
+// Reads the header elements of a forward-only recording in the order they are in the file. The elements after the first
+// cluster, usually the Cues, can't be read before playback and are left out.
+static k4a_result_t read_header_in_file_order(k4a_playback_context_t *context)
+{
+    struct header_element_t
+    {
+        uint64_t offset;
+        const char *name;
+        bool required;
+        std::function<k4a_result_t()> read;
+    };
+    std::vector<header_element_t> elements = {
+        { context->segment_info_offset,
+          "segment info",
+          true,
+          [context]() { return read_offset(context, context->segment_info, context->segment_info_offset); } },
+        { context->tracks_offset,
+          "tracks",
+          true,
+          [context]() { return read_offset(context, context->tracks, context->tracks_offset); } },
+        { context->cues_offset,
+          "cues",
+          false,
+          [context]() { return read_offset(context, context->cues, context->cues_offset); } },
+        { context->attachments_offset,
+          "attachments",
+          false,
+          [context]() { return read_offset(context, context->attachments, context->attachments_offset); } },
+        { context->tags_offset,
+          "tags",
+          false,
+          [context]() { return read_offset(context, context->tags, context->tags_offset); } },
+    };
+    std::sort(elements.begin(), elements.end(), [](const header_element_t &a, const header_element_t &b) {
+        return a.offset < b.offset;
+    });
+
+    for (header_element_t &element : elements)
+    {
+        if (!element.required && (element.offset == 0 || element.offset > context->first_cluster_offset))
+        {
+            if (element.offset > 0)
+            {
+                LOG_INFO("The %s of the recording are after its clusters, they aren't read from a forward-only source.",
+                         element.name);
+            }
+            continue;
+        }
+        RETURN_IF_ERROR(element.read());
+    }
+    return K4A_RESULT_SUCCEEDED;
+}
+
 k4a_result_t parse_mkv(k4a_playback_context_t *context)
 {
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
@@ -182,6 +243,13 @@ k4a_result_t parse_mkv(k4a_playback_context_t *context)
             EbmlId element_id(*element);
             match_ebml_id(context, element_id, context->segment->GetRelativePosition(*element.get()));
 
+            if (context->forward_only && element_id == KaxCluster::ClassInfos.GlobalId)
+            {
+                // Nothing after the first cluster is read from a forward-only source, such as a streamed recording
+                // without a seek head, which would otherwise be read to its end here.
+                break;
+            }
+
             if (element_id == KaxSeekHead::ClassInfos.GlobalId)
             {
                 // Parse SeekHead offset positions
@@ -216,18 +284,48 @@ k4a_result_t parse_mkv(k4a_playback_context_t *context)
     }
 
     // Populate each element from the file (minus the actual Cluster data)
-    RETURN_IF_ERROR(read_offset(context, context->segment_info, context->segment_info_offset));
-    RETURN_IF_ERROR(read_offset(context, context->tracks, context->tracks_offset));
-    if (context->cues_offset > 0)
-        RETURN_IF_ERROR(read_offset(context, context->cues, context->cues_offset));
-    if (context->attachments_offset > 0)
-        RETURN_IF_ERROR(read_offset(context, context->attachments, context->attachments_offset));
-    if (context->tags_offset > 0)
-        RETURN_IF_ERROR(read_offset(context, context->tags, context->tags_offset));
-
-    RETURN_IF_ERROR(parse_recording_config(context));
+    if (context->forward_only)
+    {
+        RETURN_IF_ERROR(read_header_in_file_order(context));
+    }
+    else
+    {
+        RETURN_IF_ERROR(read_offset(context, context->segment_info, context->segment_info_offset));
+        RETURN_IF_ERROR(read_offset(context, context->tracks, context->tracks_offset));
+        if (context->cues_offset > 0)
+            RETURN_IF_ERROR(read_offset(context, context->cues, context->cues_offset));
+        if (context->attachments_offset > 0)
+            RETURN_IF_ERROR(read_offset(context, context->attachments, context->attachments_offset));
+        if (context->tags_offset > 0)
+            RETURN_IF_ERROR(read_offset(context, context->tags, context->tags_offset));
+    }
+
+    return parse_recording_config(context);
+}
+
+// Populates the cluster cache of a playback whose header was read by parse_mkv(), and finds the last timestamp of the
+// recording. This reads the Cues, or the whole file if there aren't any, and the last cluster.
+k4a_result_t parse_clusters(k4a_playback_context_t *context)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context->segment == nullptr);
+
     RETURN_IF_ERROR(populate_cluster_cache(context));
 
+    if (context->forward_only)
+    {
+        // The end of the recording can't be read before playback reaches it, use the duration of the segment instead.
+        EbmlElement *duration = context->segment_info->FindFirstElt(KaxDuration::ClassInfos);
+        context->last_file_timestamp_ns = 0;
+        if (duration != NULL)
+        {
+            context->last_file_timestamp_ns = (uint64_t)(static_cast<KaxDuration *>(duration)->GetValue() *
+                                                         (double)context->timecode_scale);
+        }
+        LOG_TRACE("Recording duration from segment info: %llu", context->last_file_timestamp_ns);
+        return K4A_RESULT_SUCCEEDED;
+    }
+
     // Find the last timestamp in the file
     context->last_file_timestamp_ns = 0;
     cluster_info_t *cluster_info = find_cluster(context, UINT64_MAX);
@@ -239,7 +337,7 @@ k4a_result_t parse_mkv(k4a_playback_context_t *context)
 
     KaxSimpleBlock *simple_block = NULL;
     KaxBlockGroup *block_group = NULL;
-    std::shared_ptr<KaxCluster> last_cluster = load_cluster_internal(context, cluster_info);
+    std::shared_ptr<KaxCluster> last_cluster = load_cluster_internal(context, cluster_info, false);
     if (last_cluster == nullptr)
     {
         LOG_ERROR("Failed to load end of recording.", 0);
@@ -302,6 +400,47 @@ static void cluster_cache_deleter(cluster_info_t *cluster_cache)
     }
 }
 
+// Fills the cluster cache, which only holds the first cluster, with the clusters of the recording index. Clusters that
+// follow each other in the file are linked with next_known, so they are found without reading the file. Returns false,
+// leaving the cache unchanged, if the index doesn't match the first cluster or isn't in file order.
+static bool populate_cluster_cache_from_index(k4a_playback_context_t *context,
+                                              const std::vector<recording_index_cluster_t> &index)
+{
+    cluster_info_t *first_cluster = context->cluster_cache.get();
+    if (index.front().file_offset != first_cluster->file_offset ||
+        index.front().cluster_size != first_cluster->cluster_size ||
+        index.front().timestamp_ns != first_cluster->timestamp_ns)
+    {
+        LOG_WARNING("Ignoring recording index, it doesn't match the first cluster of the recording.", 0);
+        return false;
+    }
+    for (size_t i = 1; i < index.size(); i++)
+    {
+        if (index[i].cluster_size == 0 || index[i].file_offset < index[i - 1].file_offset + index[i - 1].cluster_size ||
+            index[i].timestamp_ns < index[i - 1].timestamp_ns)
+        {
+            LOG_WARNING("Ignoring recording index, cluster %zu is out of order.", i);
+            return false;
+        }
+    }
+
+    cluster_info_t *cluster_cache_end = first_cluster;
+    for (size_t i = 1; i < index.size(); i++)
+    {
+        cluster_info_t *cluster_info = new cluster_info_t;
+        cluster_info->timestamp_ns = index[i].timestamp_ns;
+        cluster_info->file_offset = index[i].file_offset;
+        cluster_info->cluster_size = index[i].cluster_size;
+        cluster_info->previous = cluster_cache_end;
+
+        cluster_cache_end->next = cluster_info;
+        cluster_cache_end->next_known = cluster_cache_end->file_offset + cluster_cache_end->cluster_size ==
+                                        cluster_info->file_offset;
+        cluster_cache_end = cluster_info;
+    }
+    return true;
+}
+
 k4a_result_t populate_cluster_cache(k4a_playback_context_t *context)
 {
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
@@ -327,9 +466,17 @@ k4a_result_t populate_cluster_cache(k4a_playback_context_t *context)
         context->cluster_cache = cluster_cache_t(new cluster_info_t, cluster_cache_deleter);
         populate_cluster_info(context, first_cluster, context->cluster_cache.get());
 
-        // Populate the rest of the cache with the Cue data stored in the file.
+        // Populate the rest of the cache with the index sidecar of the recording if there is one, which links the
+        // whole cache at once, otherwise with the Cue data stored in the file.
         cluster_info_t *cluster_cache_end = context->cluster_cache.get();
-        if (context->cues)
+        std::vector<recording_index_cluster_t> index;
+        if (context->io_source == nullptr &&
+            K4A_SUCCEEDED(read_recording_index(context->file_path, context->timecode_scale, &index)) &&
+            populate_cluster_cache_from_index(context, index))
+        {
+            context->cluster_cache_indexed = true;
+        }
+        else if (context->cues)
         {
             uint64_t last_offset = context->first_cluster_offset;
             uint64_t last_timestamp_ns = context->cluster_cache->timestamp_ns;
@@ -386,6 +533,79 @@ k4a_result_t populate_cluster_cache(k4a_playback_context_t *context)
     return K4A_RESULT_SUCCEEDED;
 }
 
+// Copies the cluster cache of source into the empty cache of context, so the clusters source found don't have to be
+// searched again. The loaded clusters aren't copied, each playback reads its own.
+k4a_result_t copy_cluster_cache(k4a_playback_context_t *context, k4a_playback_context_t *source)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, source == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context->cluster_cache != nullptr);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, source->cluster_cache == nullptr);
+
+    try
+    {
+        std::lock_guard<std::recursive_mutex> source_lock(source->cache_lock);
+        std::lock_guard<std::recursive_mutex> lock(context->cache_lock);
+
+        context->cluster_cache = cluster_cache_t(new cluster_info_t, cluster_cache_deleter);
+        cluster_info_t *cluster_cache_end = context->cluster_cache.get();
+        for (cluster_info_t *cluster_info = source->cluster_cache.get(); cluster_info != NULL;
+             cluster_info = cluster_info->next)
+        {
+            if (cluster_info != source->cluster_cache.get())
+            {
+                cluster_info_t *cluster_copy = new cluster_info_t;
+                cluster_copy->previous = cluster_cache_end;
+                cluster_cache_end->next = cluster_copy;
+                cluster_cache_end = cluster_copy;
+            }
+            cluster_cache_end->timestamp_ns = cluster_info->timestamp_ns;
+            cluster_cache_end->file_offset = cluster_info->file_offset;
+            cluster_cache_end->cluster_size = cluster_info->cluster_size;
+            cluster_cache_end->next_known = cluster_info->next_known;
+        }
+        context->cluster_cache_indexed = source->cluster_cache_indexed;
+    }
+    catch (std::system_error &e)
+    {
+        LOG_ERROR("Failed to copy cluster cache: %s", e.what());
+        return K4A_RESULT_FAILED;
+    }
+
+    return K4A_RESULT_SUCCEEDED;
+}
+
+// Writes the index sidecar of the recording from the cluster cache. Fails if the cache doesn't link every cluster yet.
+k4a_result_t write_cluster_cache_index(k4a_playback_context_t *context)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context->cluster_cache == nullptr);
+
+    std::vector<recording_index_cluster_t> index;
+    try
+    {
+        std::lock_guard<std::recursive_mutex> lock(context->cache_lock);
+        for (cluster_info_t *cluster_info = context->cluster_cache.get(); cluster_info != NULL;
+             cluster_info = cluster_info->next)
+        {
+            if (cluster_info->cluster_size == 0 || (cluster_info->next != NULL && !cluster_info->next_known))
+            {
+                LOG_WARNING("The cluster cache of '%s' has gaps, the recording index isn't written.",
+                            context->file_path);
+                return K4A_RESULT_FAILED;
+            }
+            index.push_back({ cluster_info->timestamp_ns, cluster_info->file_offset, cluster_info->cluster_size });
+        }
+    }
+    catch (std::system_error &e)
+    {
+        LOG_ERROR("Failed to read cluster cache: %s", e.what());
+        return K4A_RESULT_FAILED;
+    }
+
+    return TRACE_CALL(write_recording_index(context->file_path, context->timecode_scale, index));
+}
+
 k4a_result_t parse_recording_config(k4a_playback_context_t *context)
 {
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
@@ -458,6 +678,7 @@ k4a_result_t parse_recording_config(k4a_playback_context_t *context)
         context->record_config.color_track_enabled = true;
         context->record_config.color_format = context->color_track->format;
         context->color_format_conversion = context->color_track->format;
+        context->color_decode = K4A_COLOR_DECODE_CONFIG_INIT_FULL_RESOLUTION;
     }
     else
     {
@@ -465,6 +686,7 @@ k4a_result_t parse_recording_config(k4a_playback_context_t *context)
         // Set to a default color format if color track is disabled.
         context->record_config.color_format = K4A_IMAGE_FORMAT_CUSTOM;
         context->color_format_conversion = K4A_IMAGE_FORMAT_CUSTOM;
+        context->color_decode = K4A_COLOR_DECODE_CONFIG_INIT_FULL_RESOLUTION;
     }
 
     KaxTag *depth_mode_tag = get_tag(context, "K4A_DEPTH_MODE");
@@ -549,7 +771,27 @@ k4a_result_t parse_recording_config(k4a_playback_context_t *context)
 
         RETURN_IF_ERROR(read_bitmap_info_header(context->depth_track));
 
-        context->record_config.depth_track_enabled = true;
+        if (context->depth_track->raw_depth_payload)
+        {
+            // The depth engine converts each payload to the depth and IR images, passive IR payloads only hold IR
+            context->depth_calibration_attachment = get_attachment_by_tag(context, "K4A_DEPTH_CALIBRATION_FILE");
+            if (context->depth_calibration_attachment == NULL)
+            {
+                context->depth_calibration_attachment = get_attachment_by_name(context, "depth_calibration.bin");
+            }
+            if (context->depth_calibration_attachment == NULL)
+            {
+                LOG_WARNING("Depth calibration is missing, the raw depth payloads of the recording can't be read.", 0);
+            }
+
+            context->record_config.depth_track_enabled = context->record_config.depth_mode !=
+                                                         K4A_DEPTH_MODE_PASSIVE_IR;
+            context->record_config.ir_track_enabled = true;
+        }
+        else
+        {
+            context->record_config.depth_track_enabled = true;
+        }
     }
 
     if (context->ir_track)
@@ -671,6 +913,21 @@ k4a_result_t parse_recording_config(k4a_playback_context_t *context)
         if (context->imu_track->type == track_subtitle)
         {
             context->record_config.imu_track_enabled = true;
+
+            KaxTag *imu_packing_tag = get_tag(context, "K4A_IMU_PACKING_USEC");
+            if (imu_packing_tag != NULL)
+            {
+                uint64_t imu_packing_usec;
+                std::istringstream imu_packing_str(get_tag_string(imu_packing_tag));
+                imu_packing_str >> imu_packing_usec;
+                if (imu_packing_str.fail())
+                {
+                    LOG_ERROR("Tag K4A_IMU_PACKING_USEC contains invalid value: %s",
+                              get_tag_string(imu_packing_tag).c_str());
+                    return K4A_RESULT_FAILED;
+                }
+                context->imu_track->imu_packed = imu_packing_usec > 0;
+            }
         }
         else
         {
@@ -792,9 +1049,24 @@ k4a_result_t read_bitmap_info_header(track_reader_t *track)
             track->format = K4A_IMAGE_FORMAT_COLOR_MJPG;
             track->stride = 0;
             break;
-        case 0x67363162: // b16g
+        case K4A_FOURCC_GRAY16_BIG_ENDIAN:
+            track->format = K4A_IMAGE_FORMAT_DEPTH16;
+            track->stride = track->width * 2;
+            track->gray16_encoding = GRAY16_ENCODING_BIG_ENDIAN;
+            break;
+        case K4A_FOURCC_GRAY16_LITTLE_ENDIAN:
+            track->format = K4A_IMAGE_FORMAT_DEPTH16;
+            track->stride = track->width * 2;
+            break;
+        case K4A_FOURCC_GRAY16_RVL:
             track->format = K4A_IMAGE_FORMAT_DEPTH16;
             track->stride = track->width * 2;
+            track->gray16_encoding = GRAY16_ENCODING_RVL;
+            break;
+        case K4A_FOURCC_DEPTH_RAW:
+            track->format = K4A_IMAGE_FORMAT_CUSTOM;
+            track->stride = 0;
+            track->raw_depth_payload = true;
             break;
         case 0x41524742: // BGRA
             track->format = K4A_IMAGE_FORMAT_COLOR_BGRA32;
@@ -822,6 +1094,8 @@ void reset_seek_pointers(k4a_playback_context_t *context, uint64_t seek_timestam
 {
     RETURN_VALUE_IF_ARG(VOID_VALUE, context == NULL);
 
+    reset_color_decode_ahead(context);
+    reset_depth_decode_ahead(context);
     context->seek_timestamp_ns = seek_timestamp_ns;
 
     for (auto &itr : context->track_map)
@@ -831,6 +1105,64 @@ void reset_seek_pointers(k4a_playback_context_t *context, uint64_t seek_timestam
     }
 }
 
+// Enables or disables the blocks of a track and seeks to the start of the recording. The clusters already loaded are
+// dropped since they were read with the previous filter.
+k4a_result_t set_track_enabled(k4a_playback_context_t *context, track_reader_t *track_reader, bool enabled)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, track_reader == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, track_reader->track == NULL);
+
+    // Releasing the loaded clusters waits for their read-ahead tasks, no cluster is being read past this point.
+    reset_seek_pointers(context, 0);
+    context->seek_cluster.reset();
+
+    try
+    {
+        std::lock_guard<std::recursive_mutex> cache_lock(context->cache_lock);
+        std::lock_guard<std::mutex> load_lock(context->cluster_load_lock);
+        evict_recent_clusters(context, 0);
+        for (cluster_info_t *cluster_info = context->cluster_cache.get(); cluster_info != NULL;
+             cluster_info = cluster_info->next)
+        {
+            cluster_info->cluster.reset();
+        }
+    }
+    catch (std::system_error &e)
+    {
+        LOG_ERROR("Failed to drop the loaded clusters: %s", e.what());
+        return K4A_RESULT_FAILED;
+    }
+
+    uint64_t track_number = track_reader->track->TrackNumber().GetValue();
+    std::vector<uint64_t> &skipped_tracks = context->skipped_track_numbers;
+    auto skipped = std::find(skipped_tracks.begin(), skipped_tracks.end(), track_number);
+    if (enabled && skipped != skipped_tracks.end())
+    {
+        skipped_tracks.erase(skipped);
+    }
+    else if (!enabled && skipped == skipped_tracks.end())
+    {
+        skipped_tracks.push_back(track_number);
+    }
+    track_reader->enabled = enabled;
+    context->capture_index_built = false;
+
+    cluster_info_t *seek_cluster_info = find_cluster(context, 0);
+    if (seek_cluster_info == NULL)
+    {
+        LOG_ERROR("Failed to find the first data cluster of recording.", 0);
+        return K4A_RESULT_FAILED;
+    }
+    context->seek_cluster = load_cluster(context, seek_cluster_info);
+    if (context->seek_cluster == nullptr)
+    {
+        LOG_ERROR("Failed to load first data cluster of recording.", 0);
+        return K4A_RESULT_FAILED;
+    }
+    return K4A_RESULT_SUCCEEDED;
+}
+
 k4a_result_t parse_tracks(k4a_playback_context_t *context)
 {
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
@@ -1200,29 +1532,41 @@ cluster_info_t *next_cluster(k4a_playback_context_t *context, cluster_info_t *cu
                 }
 
                 // Read forward in file to find next cluster and fill in cache
-                if (K4A_FAILED(seek_offset(context, current_cluster->file_offset)))
-                {
-                    LOG_ERROR("Failed to seek to current cluster element.", 0);
-                    return NULL;
-                }
-                std::shared_ptr<KaxCluster> current_element = find_next<KaxCluster>(context);
-                if (current_element == nullptr)
+                if (current_cluster->cluster_size > 0)
                 {
-                    LOG_ERROR("Failed to find current cluster element.", 0);
-                    return NULL;
+                    // The end of the current cluster is known, start there without reading its header again.
+                    if (K4A_FAILED(seek_offset(context, current_cluster->file_offset + current_cluster->cluster_size)))
+                    {
+                        LOG_ERROR("Failed to seek to next cluster element.", 0);
+                        return NULL;
+                    }
                 }
-                populate_cluster_info(context, current_element, current_cluster);
-                if (current_cluster->next_known)
+                else
                 {
-                    // If populate_cluster_info() just connected the next entry, we can exit early.
-                    return current_cluster->next;
-                }
+                    if (K4A_FAILED(seek_offset(context, current_cluster->file_offset)))
+                    {
+                        LOG_ERROR("Failed to seek to current cluster element.", 0);
+                        return NULL;
+                    }
+                    std::shared_ptr<KaxCluster> current_element = find_next<KaxCluster>(context);
+                    if (current_element == nullptr)
+                    {
+                        LOG_ERROR("Failed to find current cluster element.", 0);
+                        return NULL;
+                    }
+                    populate_cluster_info(context, current_element, current_cluster);
+                    if (current_cluster->next_known)
+                    {
+                        // If populate_cluster_info() just connected the next entry, we can exit early.
+                        return current_cluster->next;
+                    }
 
-                // Seek to the end of the current cluster so that find_next returns the next cluster in the file.
-                if (K4A_FAILED(skip_element(context, current_element.get())))
-                {
-                    LOG_ERROR("Failed to seek to next cluster element.", 0);
-                    return NULL;
+                    // Seek to the end of the current cluster so that find_next returns the next cluster in the file.
+                    if (K4A_FAILED(skip_element(context, current_element.get())))
+                    {
+                        LOG_ERROR("Failed to seek to next cluster element.", 0);
+                        return NULL;
+                    }
                 }
 
                 std::shared_ptr<KaxCluster> next_cluster = find_next<KaxCluster>(context, true);
@@ -1294,211 +1638,508 @@ cluster_info_t *next_cluster(k4a_playback_context_t *context, cluster_info_t *cu
     }
 }
 
-// Load a cluster from the cluster cache / disk without any neighbor preloading.
-// This should never fail unless there is a file IO error.
-std::shared_ptr<KaxCluster> load_cluster_internal(k4a_playback_context_t *context, cluster_info_t *cluster_info)
+// Opens a new file handle to read clusters with. Returns nullptr if the file can't be opened again, the cluster is then
+// read from context->ebml_file.
+std::unique_ptr<cluster_reader_t> open_cluster_reader(k4a_playback_context_t *context)
 {
-    RETURN_VALUE_IF_ARG(nullptr, context == NULL);
-    RETURN_VALUE_IF_ARG(nullptr, context->ebml_file == nullptr);
-
     try
     {
-        // Check if the cluster already exists in memory, and if so, return it.
-        std::shared_ptr<KaxCluster> cluster = cluster_info->cluster.lock();
-        if (cluster)
+        if (context->forward_only)
         {
-            context->cache_hits++;
+            // All reads go through context->ebml_file, in order
+            return nullptr;
+        }
+
+        std::unique_ptr<cluster_reader_t> reader = make_unique<cluster_reader_t>();
+        if (context->io_source)
+        {
+            reader->ebml_file = make_unique<CallbackIOCallback>(context->io_source);
+        }
+        else if (context->file_mapping)
+        {
+            reader->ebml_file = make_unique<MappedFileIOCallback>(context->file_mapping);
         }
         else
         {
-            std::lock_guard<std::mutex> lock(context->io_lock);
-            if (context->file_closing)
-            {
-                // User called k4a_playback_close(), return immediately.
-                return nullptr;
-            }
-
-            // The cluster may have been loaded while we were acquiring the io lock, check again before actually loading
-            // from disk.
-            cluster = cluster_info->cluster.lock();
-            if (cluster)
-            {
-                context->cache_hits++;
-            }
-            else
-            {
-                context->load_count++;
-
-                // Start reading the actual cluster data from disk.
-                LargeFileIOCallback *file_io = dynamic_cast<LargeFileIOCallback *>(context->ebml_file.get());
-                if (file_io != NULL)
-                {
-                    file_io->setOwnerThread();
-                }
-
-                if (K4A_FAILED(seek_offset(context, cluster_info->file_offset)))
-                {
-                    LOG_ERROR("Failed to seek to cluster cluster at: %llu", cluster_info->file_offset);
-                    return nullptr;
-                }
-                cluster = find_next<KaxCluster>(context, true);
-                if (cluster)
-                {
-                    if (read_element<KaxCluster>(context, cluster.get()) == NULL)
-                    {
-                        LOG_ERROR("Failed to load cluster at: %llu", cluster_info->file_offset);
-                        return nullptr;
-                    }
-
-                    uint64_t timecode = GetChild<KaxClusterTimecode>(*cluster).GetValue();
-                    assert(context->timecode_scale <= INT64_MAX);
-                    cluster->InitTimecode(timecode, (int64_t)context->timecode_scale);
-
-                    cluster_info->cluster = cluster;
-                }
-            }
+            reader->ebml_file = make_unique<LargeFileIOCallback>(context->file_path, MODE_READ);
         }
-        return cluster;
+        reader->stream = make_unique<libebml::EbmlStream>(*reader->ebml_file);
+        return reader;
     }
-    catch (std::system_error &e)
+    catch (std::ios_base::failure &e)
     {
-        LOG_ERROR("Failed to load cluster from disk: %s", e.what());
-        return nullptr;
+        LOG_WARNING("Unable to open '%s' for reading ahead, reading clusters one at a time: %s",
+                    context->file_path,
+                    e.what());
+    }
+    catch (std::bad_alloc &)
+    {
+        LOG_WARNING("Failed to allocate a cluster reader, reading clusters one at a time.", 0);
     }
+    return nullptr;
 }
 
-// Load the actual block data for a cluster off the disk, and start preloading the neighboring clusters.
-// This should never fail unless there is a file IO error.
-std::shared_ptr<loaded_cluster_t> load_cluster(k4a_playback_context_t *context, cluster_info_t *cluster_info)
+static bool is_skipped_track(k4a_playback_context_t *context, uint64_t track_number)
 {
-    RETURN_VALUE_IF_ARG(nullptr, context == NULL);
-    RETURN_VALUE_IF_ARG(nullptr, context->cluster_cache == nullptr);
-    RETURN_VALUE_IF_ARG(nullptr, cluster_info == NULL);
+    return std::find(context->skipped_track_numbers.begin(), context->skipped_track_numbers.end(), track_number) !=
+           context->skipped_track_numbers.end();
+}
 
-    std::shared_ptr<KaxCluster> cluster = load_cluster_internal(context, cluster_info);
-    if (cluster == nullptr)
+// Reads the track number and timecode relative to the cluster at the start of the block data, without moving the file
+// pointer. Returns false if the data is too short to hold a block header.
+static bool peek_block_header(IOCallback *ebml_file, uint64_t *track_number, int16_t *relative_timecode)
+{
+    uint64_t file_offset = ebml_file->getFilePointer();
+    binary header[10];
+    uint32 header_size = ebml_file->read(header, sizeof(header));
+    ebml_file->setFilePointer((int64_t)file_offset);
+
+    uint32 track_number_size = header_size;
+    uint64 size_unknown = 0;
+    *track_number = ReadCodedSizeValue(header, track_number_size, size_unknown);
+    if (track_number_size == 0 || track_number_size + 2 > header_size)
     {
-        return nullptr;
+        return false;
     }
+    *relative_timecode = (int16_t)((header[track_number_size] << 8) | header[track_number_size + 1]);
+    return true;
+}
 
-    std::shared_ptr<loaded_cluster_t> result = std::shared_ptr<loaded_cluster_t>(new loaded_cluster_t());
-    result->cluster_info = cluster_info;
-    result->cluster = cluster;
+// Reads the track number at the start of the SimpleBlock data, without moving the file pointer.
+static uint64_t peek_simple_block_track(IOCallback *ebml_file)
+{
+    uint64_t track_number = 0;
+    int16_t relative_timecode = 0;
+    return peek_block_header(ebml_file, &track_number, &relative_timecode) ? track_number : 0;
+}
 
-#if CLUSTER_READ_AHEAD_COUNT
+// Reads the children of a cluster like read_element() does, leaving out the blocks of the tracks disabled by
+// k4a_playback_set_track_filter(). The payload of a disabled SimpleBlock is seeked past without being read, the video
+// tracks are written as SimpleBlocks so their data never leaves the disk. Block groups are read before being dropped.
+static KaxCluster *read_filtered_cluster(k4a_playback_context_t *context,
+                                         KaxCluster *cluster,
+                                         IOCallback *ebml_file,
+                                         libebml::EbmlStream &stream)
+{
     try
     {
-        // Preload the neighboring clusters immediately
-        cluster_info_t *previous_cluster_info = cluster_info;
-        cluster_info_t *next_cluster_info = cluster_info;
-        for (size_t i = 0; i < CLUSTER_READ_AHEAD_COUNT; i++)
+        uint64_t cluster_end = cluster->GetEndPosition();
+        while (ebml_file->getFilePointer() < cluster_end)
         {
-            if (previous_cluster_info != NULL)
+            int upper_level = 0;
+            std::unique_ptr<EbmlElement> element(stream.FindNextElement(KaxCluster::ClassInfos.Context,
+                                                                        upper_level,
+                                                                        cluster_end - ebml_file->getFilePointer(),
+                                                                        false,
+                                                                        1));
+            if (element == nullptr)
+            {
+                break;
+            }
+            else if (upper_level != 0)
+            {
+                if (upper_level > 0)
+                {
+                    LOG_ERROR("Cluster element overlaps the next element at: %llu", element->GetElementPosition());
+                    return nullptr;
+                }
+                // Global elements such as EbmlVoid hold no data
+                element->SkipData(stream, KaxCluster::ClassInfos.Context);
+                continue;
+            }
+
+            if (EbmlId(*element) == KaxSimpleBlock::ClassInfos.GlobalId &&
+                is_skipped_track(context, peek_simple_block_track(ebml_file)))
+            {
+                element->SkipData(stream, KaxCluster::ClassInfos.Context);
+                continue;
+            }
+
+            EbmlElement *dummy = nullptr;
+            element->Read(stream, element->Generic().Context, upper_level, dummy, true);
+            if (dummy != nullptr)
             {
-                previous_cluster_info = next_cluster(context, previous_cluster_info, false);
+                delete dummy;
+                LOG_ERROR("Cluster element has unknown size at: %llu", element->GetElementPosition());
+                return nullptr;
             }
-            if (next_cluster_info != NULL)
+
+            KaxBlockGroup *block_group = NULL;
+            if (check_element_type(element.get(), &block_group) &&
+                is_skipped_track(context, (uint64_t)block_group->TrackNumber()))
             {
-                next_cluster_info = next_cluster(context, next_cluster_info, true);
+                continue;
             }
-            result->previous_clusters[i] = std::async(std::launch::deferred, [context, previous_cluster_info] {
-                return previous_cluster_info ? load_cluster_internal(context, previous_cluster_info) : nullptr;
-            });
-            result->next_clusters[i] = std::async(std::launch::deferred, [context, next_cluster_info] {
-                return next_cluster_info ? load_cluster_internal(context, next_cluster_info) : nullptr;
-            });
-            result->previous_clusters[i].wait();
-            result->next_clusters[i].wait();
+            cluster->PushElement(*element.release());
         }
+        return cluster;
     }
-    catch (std::system_error &e)
+    catch (std::ios_base::failure &e)
     {
-        LOG_ERROR("Failed to load read-ahead clusters: %s", e.what());
+        LOG_ERROR("Failed to read element %s in recording '%s': %s",
+                  KaxCluster::ClassInfos.GetName(),
+                  context->file_path,
+                  e.what());
         return nullptr;
     }
-#endif
-
-    return result;
 }
 
-// Load the next or previous cluster off the disk using the existing preloaded neighbors.
-// The next neighbor in sequence will start being preloaded asynchronously.
-std::shared_ptr<loaded_cluster_t> load_next_cluster(k4a_playback_context_t *context,
-                                                    loaded_cluster_t *current_cluster,
-                                                    bool next)
+// Reads a cluster from disk with a cluster reader, or from context->ebml_file if reader is nullptr.
+static std::shared_ptr<KaxCluster> read_cluster(k4a_playback_context_t *context,
+                                                cluster_reader_t *reader,
+                                                cluster_info_t *cluster_info)
 {
-    RETURN_VALUE_IF_ARG(nullptr, context == NULL);
-    RETURN_VALUE_IF_ARG(nullptr, context->cluster_cache == nullptr);
-    RETURN_VALUE_IF_ARG(nullptr, current_cluster == NULL);
-
-    cluster_info_t *cluster_info = next_cluster(context, current_cluster->cluster_info, next);
-    if (cluster_info == NULL)
+    try
     {
-        // End of file reached.
+        std::unique_lock<std::mutex> io_lock(context->io_lock, std::defer_lock);
+        IOCallback *ebml_file = context->ebml_file.get();
+        libebml::EbmlStream *stream = nullptr;
+        if (reader == nullptr)
+        {
+            io_lock.lock();
+            if (context->file_closing)
+            {
+                // User called k4a_playback_close(), return immediately.
+                return nullptr;
+            }
+        }
+        else
+        {
+            ebml_file = reader->ebml_file.get();
+            stream = reader->stream.get();
+        }
+
+        LargeFileIOCallback *file_io = dynamic_cast<LargeFileIOCallback *>(ebml_file);
+        if (file_io != NULL)
+        {
+            file_io->setOwnerThread();
+        }
+
+        uint64_t file_offset = context->segment->GetGlobalPosition(cluster_info->file_offset);
+        assert(file_offset <= INT64_MAX);
+        CallbackIOCallback *callback_io = dynamic_cast<CallbackIOCallback *>(ebml_file);
+        if (callback_io != NULL && cluster_info->cluster_size > 0)
+        {
+            callback_io->readHint(file_offset, cluster_info->cluster_size);
+        }
+        ebml_file->setFilePointer((int64_t)file_offset);
+
+        std::shared_ptr<KaxCluster> cluster = find_next<KaxCluster>(context, true, stream);
+        if (cluster)
+        {
+            KaxCluster *read_result = NULL;
+            if (context->skipped_track_numbers.empty())
+            {
+                read_result = read_element<KaxCluster>(context, cluster.get(), stream);
+            }
+            else
+            {
+                read_result = read_filtered_cluster(context,
+                                                    cluster.get(),
+                                                    ebml_file,
+                                                    stream ? *stream : *context->stream);
+            }
+            if (read_result == NULL)
+            {
+                LOG_ERROR("Failed to load cluster at: %llu", cluster_info->file_offset);
+                return nullptr;
+            }
+
+            uint64_t timecode = GetChild<KaxClusterTimecode>(*cluster).GetValue();
+            assert(context->timecode_scale <= INT64_MAX);
+            cluster->InitTimecode(timecode, (int64_t)context->timecode_scale);
+        }
+        return cluster;
+    }
+    catch (std::ios_base::failure &e)
+    {
+        LOG_ERROR("Failed to seek to cluster at %llu in '%s': %s",
+                  cluster_info->file_offset,
+                  context->file_path,
+                  e.what());
+        return nullptr;
+    }
+    catch (std::system_error &e)
+    {
+        LOG_ERROR("Failed to load cluster from disk: %s", e.what());
         return nullptr;
     }
+}
 
-    std::shared_ptr<loaded_cluster_t> result = std::shared_ptr<loaded_cluster_t>(new loaded_cluster_t());
-    result->cluster_info = cluster_info;
+// Drops the least recently used clusters until the clusters kept loaded fit in cache_size bytes.
+// The caller should own the lock for context->cluster_load_lock.
+void evict_recent_clusters(k4a_playback_context_t *context, uint64_t cache_size)
+{
+    RETURN_VALUE_IF_ARG(VOID_VALUE, context == NULL);
+
+    while (!context->recent_clusters.empty() && context->recent_clusters_size > cache_size)
+    {
+        cluster_info_t *cluster_info = context->recent_clusters.back();
+        context->recent_clusters.pop_back();
+        context->recent_clusters_size -= cluster_info->recent_size;
+        cluster_info->recent_size = 0;
+        cluster_info->recent_cluster.reset();
+        context->evict_count++;
+    }
+}
+
+// Marks cluster as the most recently used one, keeping it loaded while it fits in the cluster cache size.
+// The caller should own the lock for context->cluster_load_lock.
+static void keep_recent_cluster(k4a_playback_context_t *context,
+                                cluster_info_t *cluster_info,
+                                const std::shared_ptr<KaxCluster> &cluster)
+{
+    if (context->cluster_cache_size == 0)
+    {
+        return;
+    }
+
+    if (cluster_info->recent_cluster)
+    {
+        context->recent_clusters.splice(context->recent_clusters.begin(),
+                                        context->recent_clusters,
+                                        cluster_info->recent_entry);
+        return;
+    }
 
-#if CLUSTER_READ_AHEAD_COUNT
     try
     {
-        // Use the current cluster as one of the neightbors, and then wait for the target cluster to be available.
-        std::shared_ptr<KaxCluster> old_cluster = current_cluster->cluster;
-        if (next)
+        context->recent_clusters.push_front(cluster_info);
+    }
+    catch (std::bad_alloc &)
+    {
+        // The cluster just isn't kept loaded
+        return;
+    }
+    cluster_info->recent_entry = context->recent_clusters.begin();
+    cluster_info->recent_cluster = cluster;
+    cluster_info->recent_size = cluster_info->cluster_size;
+    context->recent_clusters_size += cluster_info->recent_size;
+    evict_recent_clusters(context, context->cluster_cache_size);
+}
+
+// Load a cluster from the cluster cache / disk without any neighbor preloading. Clusters are read concurrently with
+// cluster readers of their own, a cluster already being read is waited for instead of being read again. Only the
+// clusters playback needs, not the ones read ahead, count as cache hits and misses.
+// This should never fail unless there is a file IO error.
+std::shared_ptr<KaxCluster> load_cluster_internal(k4a_playback_context_t *context,
+                                                  cluster_info_t *cluster_info,
+                                                  bool read_ahead)
+{
+    RETURN_VALUE_IF_ARG(nullptr, context == NULL);
+    RETURN_VALUE_IF_ARG(nullptr, context->ebml_file == nullptr);
+
+    try
+    {
+        std::unique_lock<std::mutex> lock(context->cluster_load_lock);
+        context->cluster_loaded.wait(lock, [cluster_info]() { return !cluster_info->loading; });
+
+        // Check if the cluster already exists in memory, and if so, return it.
+        std::shared_ptr<KaxCluster> cluster = cluster_info->cluster.lock();
+        if (cluster)
         {
-            result->previous_clusters[0] = std::async(std::launch::deferred, [old_cluster] { return old_cluster; });
-            for (size_t i = 1; i < CLUSTER_READ_AHEAD_COUNT; i++)
+            if (!read_ahead)
             {
-                result->previous_clusters[i] = current_cluster->previous_clusters[i - 1];
+                context->cache_hits++;
+                keep_recent_cluster(context, cluster_info, cluster);
             }
+            return cluster;
+        }
+        if (context->file_closing)
+        {
+            // User called k4a_playback_close(), return immediately.
+            return nullptr;
+        }
 
-            current_cluster->next_clusters[0].wait();
-            result->cluster = current_cluster->next_clusters[0].get();
+        context->load_count++;
+        context->seek_count++;
+        if (!read_ahead)
+        {
+            context->cache_misses++;
         }
-        else
+        cluster_info->loading = true;
+        std::unique_ptr<cluster_reader_t> reader;
+        if (!context->idle_cluster_readers.empty())
         {
-            result->next_clusters[0] = std::async(std::launch::deferred, [old_cluster] { return old_cluster; });
-            for (size_t i = 1; i < CLUSTER_READ_AHEAD_COUNT; i++)
-            {
-                result->next_clusters[i] = current_cluster->next_clusters[i - 1];
-            }
+            reader = std::move(context->idle_cluster_readers.back());
+            context->idle_cluster_readers.pop_back();
+        }
+        lock.unlock();
 
-            current_cluster->previous_clusters[0].wait();
-            result->cluster = current_cluster->previous_clusters[0].get();
+        // Start reading the actual cluster data from disk.
+        if (reader == nullptr)
+        {
+            reader = open_cluster_reader(context);
         }
+        cluster = read_cluster(context, reader.get(), cluster_info);
 
-        // Spawn a new async task to preload the next cluster in sequence.
-        if (next)
+        lock.lock();
+        if (reader && context->idle_cluster_readers.size() < (size_t)context->read_ahead_count * 2)
+        {
+            context->idle_cluster_readers.push_back(std::move(reader));
+        }
+        cluster_info->loading = false;
+        if (cluster)
+        {
+            cluster_info->cluster = cluster;
+            keep_recent_cluster(context, cluster_info, cluster);
+        }
+        lock.unlock();
+        context->cluster_loaded.notify_all();
+        return cluster;
+    }
+    catch (std::system_error &e)
+    {
+        LOG_ERROR("Failed to load cluster from disk: %s", e.what());
+        return nullptr;
+    }
+}
+
+// A future of a cluster that is already loaded
+static future_cluster_t loaded_future_cluster(const std::shared_ptr<KaxCluster> &cluster)
+{
+    return std::async(std::launch::deferred, [cluster] { return cluster; });
+}
+
+// Starts reading the cluster distance clusters after or before cluster_info, on a thread of its own so the read-ahead
+// tasks keep several reads in flight. The playbacks of a playback group read on the threads of the group instead.
+static future_cluster_t read_ahead_cluster(k4a_playback_context_t *context,
+                                           cluster_info_t *cluster_info,
+                                           size_t distance,
+                                           bool next)
+{
+    auto load = [context, cluster_info, distance, next] {
+        cluster_info_t *ahead_cluster = cluster_info;
+        for (size_t i = 0; i < distance && ahead_cluster != NULL; i++)
+        {
+            ahead_cluster = next_cluster(context, ahead_cluster, next);
+        }
+        return ahead_cluster ? load_cluster_internal(context, ahead_cluster, true) : nullptr;
+    };
+
+    if (context->reader_pool != nullptr)
+    {
+        auto task = std::make_shared<std::packaged_task<std::shared_ptr<KaxCluster>()>>(load);
+        future_cluster_t future = task->get_future().share();
+        if (queue_pool_read(context, [task] { (*task)(); }))
+        {
+            return future;
+        }
+    }
+    return std::async(std::launch::async, load);
+}
+
+// Load the actual block data for a cluster off the disk, and start preloading the neighboring clusters.
+// This should never fail unless there is a file IO error.
+std::shared_ptr<loaded_cluster_t> load_cluster(k4a_playback_context_t *context, cluster_info_t *cluster_info)
+{
+    RETURN_VALUE_IF_ARG(nullptr, context == NULL);
+    RETURN_VALUE_IF_ARG(nullptr, context->cluster_cache == nullptr);
+    RETURN_VALUE_IF_ARG(nullptr, cluster_info == NULL);
+
+    std::shared_ptr<loaded_cluster_t> result = std::shared_ptr<loaded_cluster_t>(new loaded_cluster_t());
+    result->cluster_info = cluster_info;
+
+    try
+    {
+        // Start preloading the neighboring clusters while the target cluster is read. The full count is read in the
+        // direction playback last moved in, and a single cluster the other way so turning around doesn't stall.
+        // load_next_cluster() reads the rest once playback moves that way.
+        size_t read_ahead_count = context->read_ahead_count;
+        size_t read_behind_count = std::min<size_t>(read_ahead_count, 1);
+        size_t next_count = context->read_forward ? read_ahead_count : read_behind_count;
+        size_t previous_count = context->read_forward ? read_behind_count : read_ahead_count;
+        for (size_t i = 0; i < next_count; i++)
+        {
+            result->next_clusters.push_back(read_ahead_cluster(context, cluster_info, i + 1, true));
+        }
+        for (size_t i = 0; i < previous_count; i++)
+        {
+            result->previous_clusters.push_back(read_ahead_cluster(context, cluster_info, i + 1, false));
+        }
+    }
+    catch (std::system_error &e)
+    {
+        LOG_ERROR("Failed to load read-ahead clusters: %s", e.what());
+        return nullptr;
+    }
+
+    result->cluster = load_cluster_internal(context, cluster_info, false);
+    if (result->cluster == nullptr)
+    {
+        return nullptr;
+    }
+    return result;
+}
+
+// Load the next or previous cluster off the disk using the existing preloaded neighbors.
+// The neighbors in sequence that aren't preloaded yet start being preloaded asynchronously.
+std::shared_ptr<loaded_cluster_t> load_next_cluster(k4a_playback_context_t *context,
+                                                    loaded_cluster_t *current_cluster,
+                                                    bool next)
+{
+    RETURN_VALUE_IF_ARG(nullptr, context == NULL);
+    RETURN_VALUE_IF_ARG(nullptr, context->cluster_cache == nullptr);
+    RETURN_VALUE_IF_ARG(nullptr, current_cluster == NULL);
+
+    // Crossing a cluster boundary is what sets the direction of playback the next seek reads ahead in
+    context->read_forward = next;
+
+    cluster_info_t *cluster_info = next_cluster(context, current_cluster->cluster_info, next);
+    if (cluster_info == NULL)
+    {
+        // End of file reached.
+        return nullptr;
+    }
+
+    std::shared_ptr<loaded_cluster_t> result = std::shared_ptr<loaded_cluster_t>(new loaded_cluster_t());
+    result->cluster_info = cluster_info;
+
+    // Clusters in the direction of playback are "ahead", the read-ahead count may have changed since current_cluster
+    // was loaded.
+    std::vector<future_cluster_t> &ahead = next ? result->next_clusters : result->previous_clusters;
+    std::vector<future_cluster_t> &behind = next ? result->previous_clusters : result->next_clusters;
+    std::vector<future_cluster_t> &current_ahead = next ? current_cluster->next_clusters :
+                                                          current_cluster->previous_clusters;
+    std::vector<future_cluster_t> &current_behind = next ? current_cluster->previous_clusters :
+                                                           current_cluster->next_clusters;
+    size_t read_ahead_count = context->read_ahead_count;
+
+    try
+    {
+        // Use the current cluster as one of the neighbors, and keep the preloaded clusters ahead. Only the furthest
+        // neighbors are new, they are all read concurrently.
+        if (read_ahead_count > 0)
+        {
+            behind.push_back(loaded_future_cluster(current_cluster->cluster));
+        }
+        for (size_t i = 0; i + 1 < read_ahead_count && i < current_behind.size(); i++)
+        {
+            behind.push_back(current_behind[i]);
+        }
+        for (size_t i = 0; i < read_ahead_count; i++)
         {
-            for (size_t i = 0; i < CLUSTER_READ_AHEAD_COUNT - 1; i++)
+            if (i + 1 < current_ahead.size())
             {
-                result->next_clusters[i] = current_cluster->next_clusters[i + 1];
+                ahead.push_back(current_ahead[i + 1]);
+            }
+            else
+            {
+                ahead.push_back(read_ahead_cluster(context, cluster_info, i + 1, next));
             }
-            result->next_clusters[CLUSTER_READ_AHEAD_COUNT - 1] = std::async([context, cluster_info] {
-                cluster_info_t *new_cluster = cluster_info;
-                for (size_t i = 0; i < CLUSTER_READ_AHEAD_COUNT && new_cluster != NULL; i++)
-                {
-                    new_cluster = next_cluster(context, new_cluster, true);
-                }
-                return new_cluster ? load_cluster_internal(context, new_cluster) : nullptr;
-            });
         }
-        else
+
+        // Then wait for the target cluster to be available.
+        if (!current_ahead.empty())
         {
-            for (size_t i = 0; i < CLUSTER_READ_AHEAD_COUNT - 1; i++)
+            current_ahead[0].wait();
+            result->cluster = current_ahead[0].get();
+            if (result->cluster)
             {
-                result->previous_clusters[i] = current_cluster->previous_clusters[i + 1];
+                std::lock_guard<std::mutex> lock(context->cluster_load_lock);
+                context->cache_hits++;
+                keep_recent_cluster(context, cluster_info, result->cluster);
             }
-            result->previous_clusters[CLUSTER_READ_AHEAD_COUNT - 1] = std::async([context, cluster_info] {
-                cluster_info_t *new_cluster = cluster_info;
-                for (size_t i = 0; i < CLUSTER_READ_AHEAD_COUNT && new_cluster != NULL; i++)
-                {
-                    new_cluster = next_cluster(context, new_cluster, false);
-                }
-                return new_cluster ? load_cluster_internal(context, new_cluster) : nullptr;
-            });
         }
     }
     catch (std::system_error &e)
@@ -1506,10 +2147,11 @@ std::shared_ptr<loaded_cluster_t> load_next_cluster(k4a_playback_context_t *cont
         LOG_ERROR("Failed to load next cluster: %s", e.what());
         return nullptr;
     }
-#else
-    result->cluster = load_cluster_internal(context, cluster_info);
-#endif
 
+    if (current_ahead.empty())
+    {
+        result->cluster = load_cluster_internal(context, cluster_info, false);
+    }
     return result;
 }
 
@@ -1526,6 +2168,65 @@ uint64_t estimate_block_timestamp_ns(std::shared_ptr<block_info_t> &block)
     return timestamp_ns;
 }
 
+_block_info_pool_t::~_block_info_pool_t()
+{
+    for (void *allocation : free_allocations)
+    {
+        ::operator delete(allocation);
+    }
+}
+
+// Takes an idle allocation of the pool if it has one of the right size, so stepping through the blocks of a recording
+// allocates nothing once the pool holds as many blocks as are alive at a time.
+void *block_pool_allocate(block_info_pool_t *pool, size_t size)
+{
+    {
+        std::lock_guard<std::mutex> lock(pool->lock);
+        if (pool->allocation_size == 0)
+        {
+            pool->allocation_size = size;
+        }
+        if (size == pool->allocation_size && !pool->free_allocations.empty())
+        {
+            void *allocation = pool->free_allocations.back();
+            pool->free_allocations.pop_back();
+            return allocation;
+        }
+    }
+    return ::operator new(size);
+}
+
+void block_pool_free(block_info_pool_t *pool, void *allocation, size_t size)
+{
+    {
+        std::lock_guard<std::mutex> lock(pool->lock);
+        if (size == pool->allocation_size && pool->free_allocations.size() < PLAYBACK_BLOCK_POOL_DEPTH)
+        {
+            try
+            {
+                pool->free_allocations.push_back(allocation);
+                return;
+            }
+            catch (std::bad_alloc &)
+            {
+                // Freed below
+            }
+        }
+    }
+    ::operator delete(allocation);
+}
+
+// Copies a block into an allocation of the block pool of the playback. The copy and its shared_ptr control block are
+// one allocation, which goes back to the pool when the last reference to the block is released.
+std::shared_ptr<block_info_t> new_block_info(k4a_playback_context_t *context, const block_info_t &source)
+{
+    if (context->block_pool == nullptr)
+    {
+        return std::make_shared<block_info_t>(source);
+    }
+    return std::allocate_shared<block_info_t>(block_info_allocator_t<block_info_t>(context->block_pool), source);
+}
+
 // Find the first block with a timestamp >= the specified timestamp. If a block group containing the specified timestamp
 // is found, it will be returned. If no blocks are found, a pointer to EOF will be returned, or nullptr if an error
 // occurs.
@@ -1536,7 +2237,7 @@ std::shared_ptr<block_info_t> find_block(k4a_playback_context_t *context, track_
     RETURN_VALUE_IF_ARG(nullptr, reader->track == NULL);
 
     // Create a new block pointing to the start of the cluster containing timestamp_ns.
-    std::shared_ptr<block_info_t> block = std::make_shared<block_info_t>();
+    std::shared_ptr<block_info_t> block = new_block_info(context, block_info_t());
     block->reader = reader;
     block->index = -1;
     block->sub_index = 0;
@@ -1589,7 +2290,7 @@ std::shared_ptr<block_info_t> next_block(k4a_playback_context_t *context, block_
     uint16_t search_number = static_cast<uint16_t>(track_number);
 
     // Copy the current block and start the search at the next index / sub-index.
-    std::shared_ptr<block_info_t> next_block = std::shared_ptr<block_info_t>(new block_info_t(*current));
+    std::shared_ptr<block_info_t> next_block = new_block_info(context, *current);
     if (next_block->block != NULL)
     {
         next_block->sub_index += next ? 1 : -1;
@@ -1604,7 +2305,7 @@ std::shared_ptr<block_info_t> next_block(k4a_playback_context_t *context, block_
     while (search_cluster != nullptr && search_cluster->cluster != nullptr)
     {
         // Search through the current cluster for the next valid block.
-        std::vector<EbmlElement *> elements = next_block->cluster->cluster->GetElementList();
+        const std::vector<EbmlElement *> &elements = next_block->cluster->cluster->GetElementList();
         KaxSimpleBlock *simple_block = NULL;
         KaxBlockGroup *block_group = NULL;
         while (next_block->index < (int)elements.size() && next_block->index >= 0)
@@ -1663,63 +2364,558 @@ std::shared_ptr<block_info_t> next_block(k4a_playback_context_t *context, block_
     return next_block;
 }
 
-static void free_vector_buffer(void *buffer, void *context)
+// Pixel count of a KRVL image, or 0 if it doesn't start with a header
+static uint32_t rvl_get_pixel_count(const uint8_t *data, size_t size)
 {
-    (void)buffer;
-    assert(context != nullptr);
-    std::vector<uint8_t> *vector = static_cast<std::vector<uint8_t> *>(context);
-    delete vector;
+    return size < sizeof(uint32_t) * 2 ? 0 : read_uint32_le(data);
 }
 
-// Allocates a new image in the specified format from in_block
-k4a_result_t convert_block_to_image(k4a_playback_context_t *context,
-                                    block_info_t *in_block,
-                                    k4a_image_t *image_out,
-                                    k4a_image_format_t target_format)
+// Decodes a KRVL image of pixel_count pixels, see matroska_common.h for the layout
+static k4a_result_t decode_rvl_image(const uint8_t *data, size_t size, uint16_t *pixels, uint32_t pixel_count)
 {
-    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
-    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, in_block == nullptr);
-    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, image_out == nullptr);
-    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, in_block->reader == NULL);
-    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, in_block->block == NULL);
-    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, in_block->block->NumberFrames() != 1);
-
-    DataBuffer &data_buffer = in_block->block->GetBuffer(0);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, rvl_get_pixel_count(data, size) != pixel_count);
 
-    k4a_result_t result = K4A_RESULT_SUCCEEDED;
-    std::vector<uint8_t> *buffer = NULL;
-    assert(in_block->reader->width <= INT_MAX);
-    assert(in_block->reader->height <= INT_MAX);
-    assert(in_block->reader->stride <= INT_MAX);
-    int out_width = (int)in_block->reader->width;
-    int out_height = (int)in_block->reader->height;
-    int out_stride = (int)in_block->reader->stride;
-    assert(out_height >= 0 && out_width >= 0);
+    uint32_t band_count = read_uint32_le(data + sizeof(uint32_t));
+    size_t header_size = sizeof(uint32_t) * (2 + (size_t)band_count);
+    if (band_count == 0 || band_count > pixel_count || header_size > size)
+    {
+        LOG_ERROR("Invalid RVL image header with %u bands", band_count);
+        return K4A_RESULT_FAILED;
+    }
 
-    switch (target_format)
+    const uint8_t *band_data = data + header_size;
+    size_t remaining = size - header_size;
+    for (uint32_t band = 0; band < band_count; band++)
     {
-    case K4A_IMAGE_FORMAT_DEPTH16:
-    case K4A_IMAGE_FORMAT_IR16:
-        buffer = new std::vector<uint8_t>(data_buffer.Buffer(), data_buffer.Buffer() + data_buffer.Size());
-        if (in_block->reader->format == K4A_IMAGE_FORMAT_DEPTH16 || in_block->reader->format == K4A_IMAGE_FORMAT_IR16)
-        {
-            // 16 bit grayscale needs to be converted from big-endian back to little-endian.
-            assert(buffer->size() % sizeof(uint16_t) == 0);
-            uint16_t *buffer_raw = reinterpret_cast<uint16_t *>(buffer->data());
-            size_t buffer_size = buffer->size() / sizeof(uint16_t);
-            for (size_t i = 0; i < buffer_size; i++)
-            {
-                buffer_raw[i] = swap_bytes_16(buffer_raw[i]);
-            }
-        }
-        else if (in_block->reader->format == K4A_IMAGE_FORMAT_COLOR_YUY2)
+        size_t band_size = read_uint32_le(data + sizeof(uint32_t) * (2 + band));
+        size_t start = rvl_band_start(pixel_count, band_count, band);
+        size_t end = rvl_band_start(pixel_count, band_count, band + 1);
+        if (band_size > remaining || !rvl_decode(band_data, band_size, pixels + start, end - start))
         {
-            // For backward compatibility with early recordings, the YUY2 format was used. The actual data buffer is
-            // 16-bit little-endian, so we can just use the buffer as-is.
+            LOG_ERROR("Invalid RVL image band %u of %u", band, band_count);
+            return K4A_RESULT_FAILED;
         }
-        else
-        {
-            LOG_ERROR("Unsupported image format conversion: %d to %d", in_block->reader->format, target_format);
+        band_data += band_size;
+        remaining -= band_size;
+    }
+
+    return K4A_RESULT_SUCCEEDED;
+}
+
+// Takes a buffer of size bytes from the pool of a track, allocating one if none of the idle buffers are large enough
+static pooled_buffer_t *pool_alloc_buffer(track_reader_t *reader, size_t size)
+{
+    if (reader->buffer_pool == nullptr)
+    {
+        reader->buffer_pool = std::make_shared<image_buffer_pool_t>();
+    }
+
+    pooled_buffer_t *buffer = NULL;
+    {
+        std::lock_guard<std::mutex> lock(reader->buffer_pool->lock);
+        std::vector<pooled_buffer_t *> &free_buffers = reader->buffer_pool->free_buffers;
+        for (auto it = free_buffers.begin(); it != free_buffers.end(); ++it)
+        {
+            if ((*it)->data.capacity() >= size)
+            {
+                buffer = *it;
+                free_buffers.erase(it);
+                break;
+            }
+        }
+        if (buffer == NULL && !free_buffers.empty())
+        {
+            // Reuse the buffer object, its data grows to the size
+            buffer = free_buffers.back();
+            free_buffers.pop_back();
+        }
+    }
+    if (buffer == NULL)
+    {
+        buffer = new pooled_buffer_t();
+    }
+    buffer->pool = reader->buffer_pool;
+    buffer->data.resize(size);
+    return buffer;
+}
+
+_image_buffer_pool_t::~_image_buffer_pool_t()
+{
+    for (pooled_buffer_t *buffer : free_buffers)
+    {
+        delete buffer;
+    }
+}
+
+// Returns a buffer to its pool, matches k4a_memory_destroy_cb_t so images can release their buffer with it
+static void pool_free_buffer(void *buffer, void *context)
+{
+    (void)buffer;
+    assert(context != nullptr);
+    pooled_buffer_t *pooled = static_cast<pooled_buffer_t *>(context);
+
+    // The idle buffers don't hold their pool, it is kept alive here while the buffer is returned to it
+    std::shared_ptr<image_buffer_pool_t> pool = std::move(pooled->pool);
+    {
+        std::lock_guard<std::mutex> lock(pool->lock);
+        if (pool->free_buffers.size() < PLAYBACK_BUFFER_POOL_DEPTH)
+        {
+            try
+            {
+                pool->free_buffers.push_back(pooled);
+                return;
+            }
+            catch (std::bad_alloc &)
+            {
+                // Deleted below
+            }
+        }
+    }
+    delete pooled;
+}
+
+// Releases the reference an image holds on the mapped file it points into, matches k4a_memory_destroy_cb_t
+static void mapped_free_buffer(void *buffer, void *context)
+{
+    (void)buffer;
+    assert(context != nullptr);
+    delete static_cast<std::shared_ptr<mapped_file_t> *>(context);
+}
+
+// Returns a new reference on the mapped file for an image pointing to the data of a block in it, or NULL if the file
+// isn't mapped or the data can't be used in place. 16 bit images need their data to be aligned to 2 bytes.
+static std::shared_ptr<mapped_file_t> *reference_mapped_block(k4a_playback_context_t *context,
+                                                             block_info_t *in_block,
+                                                             size_t alignment,
+                                                             uint8_t **data_out)
+{
+    const std::shared_ptr<mapped_file_t> &mapping = context->file_mapping;
+    if (mapping == nullptr)
+    {
+        return NULL;
+    }
+
+    DataBuffer &data_buffer = in_block->block->GetBuffer(0);
+    uint64_t position = in_block->block->GetDataPosition(0);
+    if (position >= mapping->size || data_buffer.Size() > mapping->size - position || position % alignment != 0)
+    {
+        return NULL;
+    }
+
+    // libebml has already read the block, make sure its position is where the data actually is
+    uint8_t *data = mapping->data + position;
+    if (memcmp(data, data_buffer.Buffer(), std::min<size_t>(data_buffer.Size(), 16)) != 0)
+    {
+        return NULL;
+    }
+
+    *data_out = data;
+    return new (std::nothrow) std::shared_ptr<mapped_file_t>(mapping);
+}
+
+// libjpeg-turbo decompressor of the calling thread, created on its first MJPG conversion
+static tjhandle get_thread_decompressor()
+{
+    struct decompressor_t
+    {
+        tjhandle handle = tjInitDecompress();
+        ~decompressor_t()
+        {
+            if (handle != nullptr)
+            {
+                (void)tjDestroy(handle);
+            }
+        }
+    };
+    static thread_local decompressor_t decompressor;
+    return decompressor.handle;
+}
+
+// Decodes a color block to a BGRA32 buffer cropped and scaled by the color decode configuration of the playback
+static k4a_result_t decode_block_to_scaled_bgra(k4a_playback_context_t *context,
+                                                block_info_t *in_block,
+                                                pooled_buffer_t **buffer_out,
+                                                int *out_width,
+                                                int *out_height,
+                                                int *out_stride)
+{
+    const k4a_color_decode_configuration_t *config = &context->color_decode;
+    DataBuffer &data_buffer = in_block->block->GetBuffer(0);
+
+    k4a_rect_t crop = {};
+    uint32_t width = 0;
+    uint32_t height = 0;
+    if (!k4a_color_decode_get_output(
+            config, in_block->reader->width, in_block->reader->height, &crop, &width, &height))
+    {
+        LOG_ERROR("The color decode crop does not fit in %ux%u color images",
+                  in_block->reader->width,
+                  in_block->reader->height);
+        return K4A_RESULT_FAILED;
+    }
+
+    k4a_result_t result = K4A_RESULT_SUCCEEDED;
+    int scale = (int)config->scale_denominator;
+    int source_width = (int)in_block->reader->width;
+    int source_height = (int)in_block->reader->height;
+    int source_stride = (int)in_block->reader->stride;
+    const uint8_t *source = data_buffer.Buffer();
+    pooled_buffer_t *bgra = NULL;
+
+    switch (in_block->reader->format)
+    {
+    case K4A_IMAGE_FORMAT_COLOR_MJPG:
+    {
+        // libjpeg-turbo scales as it decodes, which leaves only the crop to apply
+        source_width = (source_width + scale - 1) / scale;
+        source_height = (source_height + scale - 1) / scale;
+        source_stride = source_width * 4;
+        crop.x /= scale;
+        crop.y /= scale;
+        crop.width = (int32_t)width;
+        crop.height = (int32_t)height;
+        bgra = pool_alloc_buffer(in_block->reader, (size_t)source_height * (size_t)source_stride);
+
+        if (tjDecompress2(get_thread_decompressor(),
+                          data_buffer.Buffer(),
+                          data_buffer.Size(),
+                          bgra->data.data(),
+                          source_width,
+                          0, // pitch
+                          source_height,
+                          TJPF_BGRA,
+                          TJFLAG_FASTDCT | TJFLAG_FASTUPSAMPLE) != 0)
+        {
+            LOG_ERROR("Failed to decompress jpeg image to BGRA format.", 0);
+            result = K4A_RESULT_FAILED;
+        }
+        source = bgra->data.data();
+        break;
+    }
+    case K4A_IMAGE_FORMAT_COLOR_NV12:
+        source_stride = source_width * 4;
+        bgra = pool_alloc_buffer(in_block->reader, (size_t)source_height * (size_t)source_stride);
+        if (libyuv::NV12ToARGB(data_buffer.Buffer(),
+                               (int)in_block->reader->stride,
+                               data_buffer.Buffer() + (source_height * (int)in_block->reader->stride),
+                               (int)in_block->reader->stride,
+                               bgra->data.data(),
+                               source_stride,
+                               source_width,
+                               source_height) != 0)
+        {
+            LOG_ERROR("Failed to convert NV12 image to BGRA format.", 0);
+            result = K4A_RESULT_FAILED;
+        }
+        source = bgra->data.data();
+        break;
+    case K4A_IMAGE_FORMAT_COLOR_YUY2:
+        source_stride = source_width * 4;
+        bgra = pool_alloc_buffer(in_block->reader, (size_t)source_height * (size_t)source_stride);
+        if (libyuv::YUY2ToARGB(data_buffer.Buffer(),
+                               (int)in_block->reader->stride,
+                               bgra->data.data(),
+                               source_stride,
+                               source_width,
+                               source_height) != 0)
+        {
+            LOG_ERROR("Failed to convert YUY2 image to BGRA format.", 0);
+            result = K4A_RESULT_FAILED;
+        }
+        source = bgra->data.data();
+        break;
+    case K4A_IMAGE_FORMAT_COLOR_BGRA32:
+        if (data_buffer.Size() < (size_t)source_height * (size_t)source_stride)
+        {
+            LOG_ERROR("The BGRA image is smaller than its resolution: %zu bytes", (size_t)data_buffer.Size());
+            result = K4A_RESULT_FAILED;
+        }
+        break;
+    default:
+        LOG_ERROR("Unsupported image format conversion: %d to %d",
+                  in_block->reader->format,
+                  K4A_IMAGE_FORMAT_COLOR_BGRA32);
+        result = K4A_RESULT_FAILED;
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        // The box filter averages the pixels of the crop covered by each output pixel. Equal sizes are a plain copy.
+        int stride = (int)width * 4;
+        pooled_buffer_t *buffer = pool_alloc_buffer(in_block->reader, (size_t)height * (size_t)stride);
+        if (libyuv::ARGBScale(source + (size_t)crop.y * (size_t)source_stride + (size_t)crop.x * 4,
+                              source_stride,
+                              crop.width,
+                              crop.height,
+                              buffer->data.data(),
+                              stride,
+                              (int)width,
+                              (int)height,
+                              libyuv::kFilterBox) != 0)
+        {
+            LOG_ERROR("Failed to scale BGRA image to %ux%u.", width, height);
+            pool_free_buffer(NULL, buffer);
+            result = K4A_RESULT_FAILED;
+        }
+        else
+        {
+            *buffer_out = buffer;
+            *out_width = (int)width;
+            *out_height = (int)height;
+            *out_stride = stride;
+        }
+    }
+
+    if (bgra != NULL)
+    {
+        pool_free_buffer(NULL, bgra);
+    }
+
+    return result;
+}
+
+// Returns the chroma subsampling of an MJPG image that can be decoded straight to NV12 or YUY2, or -1 if it has to go
+// through BGRA.
+static int get_mjpg_yuv_subsampling(DataBuffer &data_buffer, int width, int height)
+{
+    int jpeg_width = 0;
+    int jpeg_height = 0;
+    int subsampling = 0;
+    int colorspace = 0;
+    if (tjDecompressHeader3(get_thread_decompressor(),
+                            data_buffer.Buffer(),
+                            data_buffer.Size(),
+                            &jpeg_width,
+                            &jpeg_height,
+                            &subsampling,
+                            &colorspace) != 0 ||
+        jpeg_width != width || jpeg_height != height || colorspace != TJCS_YCbCr)
+    {
+        return -1;
+    }
+    return subsampling == TJSAMP_420 || subsampling == TJSAMP_422 ? subsampling : -1;
+}
+
+// Decodes an MJPG image to the Y, U and V planes it is stored as, and repacks them to NV12 or YUY2 without a round trip
+// through BGRA. The luma of NV12 is decoded in place, 4:2:2 chroma is box filtered to 4:2:0.
+static k4a_result_t decode_mjpg_to_yuv(track_reader_t *reader,
+                                       DataBuffer &data_buffer,
+                                       int subsampling,
+                                       k4a_image_format_t target_format,
+                                       int width,
+                                       int height,
+                                       pooled_buffer_t **buffer_out,
+                                       int *out_stride)
+{
+    int chroma_width = tjPlaneWidth(1, width, subsampling);
+    int chroma_height = tjPlaneHeight(1, height, subsampling);
+    int nv12_chroma_height = (height + 1) / 2;
+    size_t chroma_size = (size_t)chroma_width * (size_t)chroma_height;
+    size_t luma_size = (size_t)width * (size_t)height;
+
+    // U and V planes as decoded, then the downsampled U and V planes for NV12 or the Y plane for YUY2
+    static thread_local std::vector<uint8_t> plane_scratch;
+    try
+    {
+        plane_scratch.resize(chroma_size * 2 + (target_format == K4A_IMAGE_FORMAT_COLOR_NV12 ?
+                                                    (size_t)chroma_width * (size_t)nv12_chroma_height * 2 :
+                                                    luma_size));
+    }
+    catch (std::bad_alloc &)
+    {
+        LOG_ERROR("Failed to allocate the YUV planes of a %d x %d MJPG image.", width, height);
+        return K4A_RESULT_FAILED;
+    }
+    uint8_t *u_plane = plane_scratch.data();
+    uint8_t *v_plane = u_plane + chroma_size;
+    uint8_t *extra_planes = v_plane + chroma_size;
+
+    pooled_buffer_t *buffer = NULL;
+    unsigned char *planes[3] = { extra_planes, u_plane, v_plane };
+    if (target_format == K4A_IMAGE_FORMAT_COLOR_NV12)
+    {
+        *out_stride = width;
+        // Round up the size of the UV plane in case the resolution is odd.
+        buffer = pool_alloc_buffer(reader, luma_size + (luma_size + 1) / 2);
+        planes[0] = buffer->data.data();
+    }
+    else
+    {
+        *out_stride = width * 2;
+        buffer = pool_alloc_buffer(reader, (size_t)height * (size_t)*out_stride);
+    }
+
+    k4a_result_t result = K4A_RESULT_SUCCEEDED;
+    if (tjDecompressToYUVPlanes(get_thread_decompressor(),
+                                data_buffer.Buffer(),
+                                data_buffer.Size(),
+                                planes,
+                                width,
+                                nullptr, // strides
+                                height,
+                                TJFLAG_FASTDCT) != 0)
+    {
+        LOG_ERROR("Failed to decompress jpeg image to YUV planes.", 0);
+        result = K4A_RESULT_FAILED;
+    }
+    else if (target_format == K4A_IMAGE_FORMAT_COLOR_NV12)
+    {
+        if (subsampling == TJSAMP_422)
+        {
+            uint8_t *u_420 = extra_planes;
+            uint8_t *v_420 = u_420 + (size_t)chroma_width * (size_t)nv12_chroma_height;
+            libyuv::ScalePlane(u_plane,
+                               chroma_width,
+                               chroma_width,
+                               chroma_height,
+                               u_420,
+                               chroma_width,
+                               chroma_width,
+                               nv12_chroma_height,
+                               libyuv::kFilterBox);
+            libyuv::ScalePlane(v_plane,
+                               chroma_width,
+                               chroma_width,
+                               chroma_height,
+                               v_420,
+                               chroma_width,
+                               chroma_width,
+                               nv12_chroma_height,
+                               libyuv::kFilterBox);
+            u_plane = u_420;
+            v_plane = v_420;
+        }
+        libyuv::MergeUVPlane(u_plane,
+                             chroma_width,
+                             v_plane,
+                             chroma_width,
+                             buffer->data.data() + luma_size,
+                             *out_stride,
+                             chroma_width,
+                             nv12_chroma_height);
+    }
+    else
+    {
+        int status = subsampling == TJSAMP_422 ? libyuv::I422ToYUY2(extra_planes,
+                                                                    width,
+                                                                    u_plane,
+                                                                    chroma_width,
+                                                                    v_plane,
+                                                                    chroma_width,
+                                                                    buffer->data.data(),
+                                                                    *out_stride,
+                                                                    width,
+                                                                    height) :
+                                                 libyuv::I420ToYUY2(extra_planes,
+                                                                    width,
+                                                                    u_plane,
+                                                                    chroma_width,
+                                                                    v_plane,
+                                                                    chroma_width,
+                                                                    buffer->data.data(),
+                                                                    *out_stride,
+                                                                    width,
+                                                                    height);
+        if (status != 0)
+        {
+            LOG_ERROR("Failed to convert YUV planes to YUY2 format.", 0);
+            result = K4A_RESULT_FAILED;
+        }
+    }
+
+    if (K4A_FAILED(result))
+    {
+        pool_free_buffer(NULL, buffer);
+        buffer = NULL;
+    }
+    *buffer_out = buffer;
+    return result;
+}
+
+// Allocates a new image in the specified format from in_block
+k4a_result_t convert_block_to_image(k4a_playback_context_t *context,
+                                    block_info_t *in_block,
+                                    k4a_image_t *image_out,
+                                    k4a_image_format_t target_format)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, in_block == nullptr);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, image_out == nullptr);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, in_block->reader == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, in_block->block == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, in_block->block->NumberFrames() != 1);
+
+    DataBuffer &data_buffer = in_block->block->GetBuffer(0);
+
+    k4a_result_t result = K4A_RESULT_SUCCEEDED;
+    pooled_buffer_t *buffer = NULL;
+    std::shared_ptr<mapped_file_t> *mapped = NULL; // Set instead of buffer if the image points into a mapped file
+    uint8_t *mapped_data = NULL;
+    assert(in_block->reader->width <= INT_MAX);
+    assert(in_block->reader->height <= INT_MAX);
+    assert(in_block->reader->stride <= INT_MAX);
+    int out_width = (int)in_block->reader->width;
+    int out_height = (int)in_block->reader->height;
+    int out_stride = (int)in_block->reader->stride;
+    assert(out_height >= 0 && out_width >= 0);
+
+    // MJPG images are decoded to their YUV planes for YUV targets, unless their subsampling needs the BGRA path
+    int mjpg_subsampling = -1;
+    if (in_block->reader->format == K4A_IMAGE_FORMAT_COLOR_MJPG &&
+        (target_format == K4A_IMAGE_FORMAT_COLOR_NV12 || target_format == K4A_IMAGE_FORMAT_COLOR_YUY2))
+    {
+        mjpg_subsampling = get_mjpg_yuv_subsampling(data_buffer, out_width, out_height);
+    }
+
+    switch (target_format)
+    {
+    case K4A_IMAGE_FORMAT_DEPTH16:
+    case K4A_IMAGE_FORMAT_IR16:
+        if (in_block->reader->gray16_encoding == GRAY16_ENCODING_RVL)
+        {
+            uint32_t pixel_count = rvl_get_pixel_count(data_buffer.Buffer(), data_buffer.Size());
+            if (pixel_count == 0 || pixel_count > (uint64_t)in_block->reader->width * in_block->reader->height)
+            {
+                LOG_ERROR("Invalid RVL image of %u pixels in a %u x %u track",
+                          pixel_count,
+                          in_block->reader->width,
+                          in_block->reader->height);
+                result = K4A_RESULT_FAILED;
+            }
+            else
+            {
+                buffer = pool_alloc_buffer(in_block->reader, pixel_count * sizeof(uint16_t));
+                result = TRACE_CALL(decode_rvl_image(data_buffer.Buffer(),
+                                                     data_buffer.Size(),
+                                                     reinterpret_cast<uint16_t *>(buffer->data.data()),
+                                                     pixel_count));
+            }
+        }
+        else if (in_block->reader->gray16_encoding == GRAY16_ENCODING_BIG_ENDIAN)
+        {
+            // 16 bit grayscale needs to be converted from big-endian back to little-endian.
+            buffer = pool_alloc_buffer(in_block->reader, data_buffer.Size());
+            assert(buffer->data.size() % sizeof(uint16_t) == 0);
+            swap_bytes_16_copy(reinterpret_cast<uint16_t *>(buffer->data.data()),
+                               reinterpret_cast<const uint16_t *>(data_buffer.Buffer()),
+                               buffer->data.size() / sizeof(uint16_t));
+        }
+        else if (in_block->reader->format == K4A_IMAGE_FORMAT_DEPTH16 ||
+                 in_block->reader->format == K4A_IMAGE_FORMAT_IR16 ||
+                 in_block->reader->format == K4A_IMAGE_FORMAT_COLOR_YUY2)
+        {
+            // Little-endian recordings are stored as-is. For backward compatibility with early recordings, the YUY2
+            // format was also used, its data buffer is 16-bit little-endian as well.
+            mapped = reference_mapped_block(context, in_block, sizeof(uint16_t), &mapped_data);
+            if (mapped == NULL)
+            {
+                buffer = pool_alloc_buffer(in_block->reader, data_buffer.Size());
+                memcpy(buffer->data.data(), data_buffer.Buffer(), data_buffer.Size());
+            }
+        }
+        else
+        {
+            LOG_ERROR("Unsupported image format conversion: %d to %d", in_block->reader->format, target_format);
             result = K4A_RESULT_FAILED;
         }
         break;
@@ -1727,24 +2923,45 @@ k4a_result_t convert_block_to_image(k4a_playback_context_t *context,
     case K4A_IMAGE_FORMAT_COLOR_NV12:
     case K4A_IMAGE_FORMAT_COLOR_YUY2:
     case K4A_IMAGE_FORMAT_COLOR_BGRA32:
-        if (in_block->reader->format == target_format)
+        if (target_format == K4A_IMAGE_FORMAT_COLOR_BGRA32 &&
+            !k4a_color_decode_is_full_resolution(&context->color_decode))
+        {
+            result = TRACE_CALL(
+                decode_block_to_scaled_bgra(context, in_block, &buffer, &out_width, &out_height, &out_stride));
+        }
+        else if (in_block->reader->format == target_format)
+        {
+            // No format conversion is required, just copy the buffer, or use it in place in a mapped file.
+            mapped = reference_mapped_block(context, in_block, 1, &mapped_data);
+            if (mapped == NULL)
+            {
+                buffer = pool_alloc_buffer(in_block->reader, data_buffer.Size());
+                memcpy(buffer->data.data(), data_buffer.Buffer(), data_buffer.Size());
+            }
+        }
+        else if (mjpg_subsampling >= 0)
         {
-            // No format conversion is required, just copy the buffer.
-            buffer = new std::vector<uint8_t>(data_buffer.Buffer(), data_buffer.Buffer() + data_buffer.Size());
+            result = TRACE_CALL(decode_mjpg_to_yuv(in_block->reader,
+                                                   data_buffer,
+                                                   mjpg_subsampling,
+                                                   target_format,
+                                                   out_width,
+                                                   out_height,
+                                                   &buffer,
+                                                   &out_stride));
         }
         else
         {
             // Convert the buffer to BGRA format first
             out_stride = out_width * 4 * (int)sizeof(uint8_t);
-            buffer = new std::vector<uint8_t>((size_t)(out_height * out_stride));
+            buffer = pool_alloc_buffer(in_block->reader, (size_t)(out_height * out_stride));
 
             if (in_block->reader->format == K4A_IMAGE_FORMAT_COLOR_MJPG)
             {
-                tjhandle turbojpeg_handle = tjInitDecompress();
-                if (tjDecompress2(turbojpeg_handle,
+                if (tjDecompress2(get_thread_decompressor(),
                                   data_buffer.Buffer(),
                                   data_buffer.Size(),
-                                  buffer->data(),
+                                  buffer->data.data(),
                                   out_width,
                                   0, // pitch
                                   out_height,
@@ -1754,7 +2971,6 @@ k4a_result_t convert_block_to_image(k4a_playback_context_t *context,
                     LOG_ERROR("Failed to decompress jpeg image to BGRA format.", 0);
                     result = K4A_RESULT_FAILED;
                 }
-                (void)tjDestroy(turbojpeg_handle);
             }
             else if (in_block->reader->format == K4A_IMAGE_FORMAT_COLOR_NV12)
             {
@@ -1763,7 +2979,7 @@ k4a_result_t convert_block_to_image(k4a_playback_context_t *context,
                                        (int)in_block->reader->stride,
                                        data_buffer.Buffer() + (out_height * (int)in_block->reader->stride),
                                        (int)in_block->reader->stride,
-                                       buffer->data(),
+                                       buffer->data.data(),
                                        out_stride,
                                        out_width,
                                        out_height) != 0)
@@ -1777,7 +2993,7 @@ k4a_result_t convert_block_to_image(k4a_playback_context_t *context,
                 // The endianness of libyuv's ARGB is opposite our BGRA format. They are the same byte order.
                 if (libyuv::YUY2ToARGB(data_buffer.Buffer(),
                                        (int)in_block->reader->stride,
-                                       buffer->data(),
+                                       buffer->data.data(),
                                        out_stride,
                                        out_width,
                                        out_height) != 0)
@@ -1804,13 +3020,13 @@ k4a_result_t convert_block_to_image(k4a_playback_context_t *context,
                     size_t y_plane_size = (size_t)(out_height * out_stride);
                     // Round up the size of the UV plane in case the resolution is odd.
                     size_t uv_plane_size = (size_t)(out_height * out_stride + 1) / 2;
-                    buffer = new std::vector<uint8_t>(y_plane_size + uv_plane_size);
+                    buffer = pool_alloc_buffer(in_block->reader, y_plane_size + uv_plane_size);
 
-                    if (libyuv::ARGBToNV12(bgra_buffer->data(),
+                    if (libyuv::ARGBToNV12(bgra_buffer->data.data(),
                                            bgra_stride,
-                                           buffer->data(),
+                                           buffer->data.data(),
                                            out_stride,
-                                           buffer->data() + y_plane_size,
+                                           buffer->data.data() + y_plane_size,
                                            out_stride,
                                            out_width,
                                            out_height) != 0)
@@ -1822,10 +3038,14 @@ k4a_result_t convert_block_to_image(k4a_playback_context_t *context,
                 else if (target_format == K4A_IMAGE_FORMAT_COLOR_YUY2)
                 {
                     out_stride = out_width * 2;
-                    buffer = new std::vector<uint8_t>((size_t)(out_height * out_stride));
+                    buffer = pool_alloc_buffer(in_block->reader, (size_t)(out_height * out_stride));
 
-                    if (libyuv::ARGBToYUY2(
-                            bgra_buffer->data(), bgra_stride, buffer->data(), out_stride, out_width, out_height) != 0)
+                    if (libyuv::ARGBToYUY2(bgra_buffer->data.data(),
+                                           bgra_stride,
+                                           buffer->data.data(),
+                                           out_stride,
+                                           out_width,
+                                           out_height) != 0)
                     {
                         LOG_ERROR("Failed to convert BGRA image to YUY2 format.", 0);
                         result = K4A_RESULT_FAILED;
@@ -1839,7 +3059,7 @@ k4a_result_t convert_block_to_image(k4a_playback_context_t *context,
 
                 if (bgra_buffer != NULL)
                 {
-                    delete bgra_buffer;
+                    pool_free_buffer(NULL, bgra_buffer);
                 }
             }
         }
@@ -1849,17 +3069,32 @@ k4a_result_t convert_block_to_image(k4a_playback_context_t *context,
         result = K4A_RESULT_FAILED;
     }
 
-    if (K4A_SUCCEEDED(result) && buffer != NULL)
+    if (K4A_SUCCEEDED(result) && (buffer != NULL || mapped != NULL))
     {
-        result = TRACE_CALL(k4a_image_create_from_buffer(target_format,
-                                                         out_width,
-                                                         out_height,
-                                                         out_stride,
-                                                         buffer->data(),
-                                                         buffer->size(),
-                                                         &free_vector_buffer,
-                                                         buffer,
-                                                         image_out));
+        if (mapped != NULL)
+        {
+            result = TRACE_CALL(k4a_image_create_from_buffer(target_format,
+                                                             out_width,
+                                                             out_height,
+                                                             out_stride,
+                                                             mapped_data,
+                                                             data_buffer.Size(),
+                                                             &mapped_free_buffer,
+                                                             mapped,
+                                                             image_out));
+        }
+        else
+        {
+            result = TRACE_CALL(k4a_image_create_from_buffer(target_format,
+                                                             out_width,
+                                                             out_height,
+                                                             out_stride,
+                                                             buffer->data.data(),
+                                                             buffer->data.size(),
+                                                             &pool_free_buffer,
+                                                             buffer,
+                                                             image_out));
+        }
         uint64_t device_timestamp_usec = in_block->timestamp_ns / 1000 +
                                          (uint64_t)context->record_config.start_timestamp_offset_usec;
         k4a_image_set_device_timestamp_usec(*image_out, device_timestamp_usec);
@@ -1867,12 +3102,111 @@ k4a_result_t convert_block_to_image(k4a_playback_context_t *context,
 
     if (K4A_FAILED(result) && buffer != NULL)
     {
-        delete buffer;
+        pool_free_buffer(NULL, buffer);
+    }
+    if (K4A_FAILED(result) && mapped != NULL)
+    {
+        mapped_free_buffer(NULL, mapped);
     }
 
     return result;
 }
 
+// Copies a plane of the depth engine output to a new image of the depth track's buffer pool
+static k4a_result_t create_depth_engine_image(track_reader_t *reader,
+                                              k4a_image_format_t format,
+                                              const k4a_depth_engine_output_frame_info_t &frame_info,
+                                              const uint8_t *plane,
+                                              uint64_t device_timestamp_usec,
+                                              k4a_image_t *image_out)
+{
+    size_t plane_size = (size_t)frame_info.output_width * frame_info.output_height * sizeof(uint16_t);
+    pooled_buffer_t *buffer = pool_alloc_buffer(reader, plane_size);
+    memcpy(buffer->data.data(), plane, plane_size);
+
+    k4a_result_t result = TRACE_CALL(k4a_image_create_from_buffer(format,
+                                                                  (int)frame_info.output_width,
+                                                                  (int)frame_info.output_height,
+                                                                  (int)(frame_info.output_width * sizeof(uint16_t)),
+                                                                  buffer->data.data(),
+                                                                  buffer->data.size(),
+                                                                  &pool_free_buffer,
+                                                                  buffer,
+                                                                  image_out));
+    if (K4A_FAILED(result))
+    {
+        pool_free_buffer(NULL, buffer);
+        return result;
+    }
+    k4a_image_set_device_timestamp_usec(*image_out, device_timestamp_usec);
+    return result;
+}
+
+void convert_raw_depth_block(k4a_playback_context_t *context,
+                             k4a_depth_engine_context_t *depth_engine,
+                             std::vector<uint8_t> &output,
+                             depth_decode_job_t *job)
+{
+    RETURN_VALUE_IF_ARG(VOID_VALUE, context == NULL);
+    RETURN_VALUE_IF_ARG(VOID_VALUE, depth_engine == NULL);
+    RETURN_VALUE_IF_ARG(VOID_VALUE, job == NULL);
+    RETURN_VALUE_IF_ARG(VOID_VALUE, job->block == nullptr);
+    RETURN_VALUE_IF_ARG(VOID_VALUE, job->block->block == NULL);
+    RETURN_VALUE_IF_ARG(VOID_VALUE, job->block->block->NumberFrames() != 1);
+
+    DataBuffer &data_buffer = job->block->block->GetBuffer(0);
+    k4a_depth_engine_output_frame_info_t frame_info = {};
+    k4a_depth_engine_result_code_t deresult = deloader_depth_engine_process_frame(depth_engine,
+                                                                                  data_buffer.Buffer(),
+                                                                                  data_buffer.Size(),
+                                                                                  K4A_DEPTH_ENGINE_OUTPUT_TYPE_Z_DEPTH,
+                                                                                  output.data(),
+                                                                                  output.size(),
+                                                                                  &frame_info,
+                                                                                  NULL);
+    if (deresult != K4A_DEPTH_ENGINE_RESULT_SUCCEEDED)
+    {
+        LOG_ERROR("Depth engine failed to process the raw depth payload with error code: %d.", deresult);
+        job->result = K4A_RESULT_FAILED;
+        return;
+    }
+
+    // The center of exposure is in the device clock of the color images, the timestamp of the block is only an
+    // estimate of it. Recordings without color keep the timestamps of their blocks.
+    uint64_t device_timestamp_usec = job->block->timestamp_ns / 1000 +
+                                     (uint64_t)context->record_config.start_timestamp_offset_usec;
+    if (context->color_track != NULL && frame_info.center_of_exposure_in_ticks != 0)
+    {
+        device_timestamp_usec = K4A_90K_HZ_TICK_TO_USEC(frame_info.center_of_exposure_in_ticks);
+    }
+
+    // The output holds the depth image followed by the IR image, passive IR only outputs the IR image
+    const uint8_t *ir_plane = output.data();
+    k4a_result_t result = K4A_RESULT_SUCCEEDED;
+    if (context->record_config.depth_mode != K4A_DEPTH_MODE_PASSIVE_IR)
+    {
+        result = TRACE_CALL(create_depth_engine_image(job->block->reader,
+                                                      K4A_IMAGE_FORMAT_DEPTH16,
+                                                      frame_info,
+                                                      output.data(),
+                                                      device_timestamp_usec,
+                                                      &job->depth_image));
+        ir_plane += (size_t)frame_info.output_width * frame_info.output_height * sizeof(uint16_t);
+    }
+    if (K4A_SUCCEEDED(result))
+    {
+        result = TRACE_CALL(create_depth_engine_image(job->block->reader,
+                                                      K4A_IMAGE_FORMAT_IR16,
+                                                      frame_info,
+                                                      ir_plane,
+                                                      device_timestamp_usec,
+                                                      &job->ir_image));
+    }
+
+    job->temperature_c = frame_info.sensor_temp;
+    job->result = result;
+}
+
 k4a_result_t new_capture(k4a_playback_context_t *context, block_info_t *block, k4a_capture_t *capture_handle)
 {
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
@@ -1890,14 +3224,39 @@ k4a_result_t new_capture(k4a_playback_context_t *context, block_info_t *block, k
     k4a_result_t result = K4A_RESULT_SUCCEEDED;
     if (block->reader == context->color_track)
     {
-        result = TRACE_CALL(convert_block_to_image(context, block, &image_handle, context->color_format_conversion));
+        if (!take_decoded_color_image(context, block, &image_handle, &result))
+        {
+            result = TRACE_CALL(
+                convert_block_to_image(context, block, &image_handle, context->color_format_conversion));
+        }
         k4a_capture_set_color_image(*capture_handle, image_handle);
     }
-    else if (block->reader == context->depth_track)
+    else if (block->reader == context->depth_track && block->reader->raw_depth_payload)
     {
-        result = TRACE_CALL(convert_block_to_image(context, block, &image_handle, K4A_IMAGE_FORMAT_DEPTH16));
-        k4a_capture_set_depth_image(*capture_handle, image_handle);
-    }
+        std::shared_ptr<depth_decode_job_t> job = take_decoded_depth_images(context, block);
+        if (job == nullptr)
+        {
+            result = K4A_RESULT_FAILED;
+        }
+        else
+        {
+            result = job->result;
+            if (job->depth_image != NULL)
+            {
+                k4a_capture_set_depth_image(*capture_handle, job->depth_image);
+            }
+            if (job->ir_image != NULL)
+            {
+                k4a_capture_set_ir_image(*capture_handle, job->ir_image);
+            }
+            k4a_capture_set_temperature_c(*capture_handle, job->temperature_c);
+        }
+    }
+    else if (block->reader == context->depth_track)
+    {
+        result = TRACE_CALL(convert_block_to_image(context, block, &image_handle, K4A_IMAGE_FORMAT_DEPTH16));
+        k4a_capture_set_depth_image(*capture_handle, image_handle);
+    }
     else if (block->reader == context->ir_track)
     {
         result = TRACE_CALL(convert_block_to_image(context, block, &image_handle, K4A_IMAGE_FORMAT_IR16));
@@ -1922,6 +3281,14 @@ k4a_stream_result_t get_capture(k4a_playback_context_t *context, k4a_capture_t *
     RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, capture_handle == NULL);
 
     track_reader_t *blocks[] = { context->color_track, context->depth_track, context->ir_track };
+    for (size_t i = 0; i < arraysize(blocks); i++)
+    {
+        if (blocks[i] != NULL && !blocks[i]->enabled)
+        {
+            // Tracks disabled by k4a_playback_set_track_filter() are left out of the captures
+            blocks[i] = NULL;
+        }
+    }
     std::shared_ptr<block_info_t> next_blocks[arraysize(blocks)];
 
     uint64_t timestamp_start_ns = UINT64_MAX;
@@ -2084,15 +3451,226 @@ k4a_stream_result_t get_capture(k4a_playback_context_t *context, k4a_capture_t *
             }
         }
     }
+
+    if (next && valid_blocks > 0)
+    {
+        decode_ahead_color_images(context);
+        decode_ahead_depth_images(context);
+    }
     return valid_blocks == 0 ? K4A_STREAM_RESULT_EOF : K4A_STREAM_RESULT_SUCCEEDED;
 }
 
-// Returns NULL if the buffer is invalid.
-static matroska_imu_sample_t *parse_imu_sample_buffer(DataBuffer &data_buffer)
+// Reads every cluster of the recording once to index the blocks of the color, depth and IR tracks, then groups them in
+// captures the same way reading the captures forward from the start of the recording does.
+k4a_result_t build_capture_index(k4a_playback_context_t *context)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context->cluster_cache == nullptr);
+
+    track_reader_t *tracks[] = { context->color_track, context->depth_track, context->ir_track };
+    context->capture_index_built = false;
+    context->capture_index.clear();
+    try
+    {
+        for (size_t i = 0; i < arraysize(tracks); i++)
+        {
+            context->block_index[i].clear();
+            if (tracks[i] != NULL && !tracks[i]->enabled)
+            {
+                tracks[i] = NULL;
+            }
+        }
+
+        cluster_info_t *cluster_info = context->cluster_cache.get();
+        while (cluster_info != NULL)
+        {
+            std::shared_ptr<KaxCluster> cluster = load_cluster_internal(context, cluster_info, false);
+            if (cluster == nullptr)
+            {
+                LOG_ERROR("Failed to load cluster at %llu to index its captures.", cluster_info->file_offset);
+                return K4A_RESULT_FAILED;
+            }
+
+            const std::vector<EbmlElement *> &elements = cluster->GetElementList();
+            for (size_t index = 0; index < elements.size(); index++)
+            {
+                KaxSimpleBlock *simple_block = NULL;
+                KaxBlockGroup *block_group = NULL;
+                uint64_t track_number = 0;
+                if (check_element_type(elements[index], &simple_block))
+                {
+                    track_number = simple_block->TrackNum();
+                }
+                else if (check_element_type(elements[index], &block_group))
+                {
+                    track_number = block_group->TrackNumber();
+                }
+
+                for (size_t i = 0; i < arraysize(tracks); i++)
+                {
+                    if (tracks[i] == NULL || track_number != tracks[i]->track->TrackNumber().GetValue())
+                    {
+                        continue;
+                    }
+
+                    uint64_t timestamp_ns = 0;
+                    if (simple_block != NULL)
+                    {
+                        simple_block->SetParent(*cluster);
+                        timestamp_ns = simple_block->GlobalTimecode();
+                    }
+                    else
+                    {
+                        block_group->SetParent(*cluster);
+                        block_group->SetParentTrack(*tracks[i]->track);
+                        timestamp_ns = GetChild<KaxBlock>(*block_group).GlobalTimecode();
+                    }
+                    block_index_entry_t entry = { cluster_info, (int)index, timestamp_ns + tracks[i]->sync_delay_ns };
+                    context->block_index[i].push_back(entry);
+                    break;
+                }
+            }
+
+            cluster_info = next_cluster(context, cluster_info, true);
+        }
+
+        // A capture starts at the earliest block not in a capture yet, and holds the next block of each track within
+        // half a sync period of it.
+        size_t next[arraysize(tracks)] = { 0 };
+        while (true)
+        {
+            uint64_t timestamp_start_ns = UINT64_MAX;
+            for (size_t i = 0; i < arraysize(tracks); i++)
+            {
+                if (next[i] < context->block_index[i].size())
+                {
+                    timestamp_start_ns = std::min(timestamp_start_ns,
+                                                  context->block_index[i][next[i]].sync_timestamp_ns);
+                }
+            }
+            if (timestamp_start_ns == UINT64_MAX)
+            {
+                break;
+            }
+
+            capture_index_entry_t capture;
+            for (size_t i = 0; i < arraysize(tracks); i++)
+            {
+                capture.blocks[i] = -1;
+                if (next[i] < context->block_index[i].size() &&
+                    context->block_index[i][next[i]].sync_timestamp_ns - timestamp_start_ns <
+                        context->sync_period_ns / 2)
+                {
+                    capture.blocks[i] = (int64_t)next[i];
+                    next[i]++;
+                }
+            }
+            context->capture_index.push_back(capture);
+        }
+    }
+    catch (std::bad_alloc &)
+    {
+        LOG_ERROR("Failed to allocate the capture index.", 0);
+        context->capture_index.clear();
+        return K4A_RESULT_FAILED;
+    }
+
+    context->capture_index_built = true;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+// Reads a capture from the capture index, with a single cluster load unless its blocks span clusters. The following
+// get_capture() calls continue from this capture.
+k4a_stream_result_t get_capture_at_index(k4a_playback_context_t *context, uint64_t index, k4a_capture_t *capture_handle)
+{
+    RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, capture_handle == NULL);
+
+    if (!context->capture_index_built && K4A_FAILED(TRACE_CALL(build_capture_index(context))))
+    {
+        return K4A_STREAM_RESULT_FAILED;
+    }
+
+    *capture_handle = NULL;
+    if (index >= context->capture_index.size())
+    {
+        return K4A_STREAM_RESULT_EOF;
+    }
+
+    track_reader_t *tracks[] = { context->color_track, context->depth_track, context->ir_track };
+    std::shared_ptr<block_info_t> blocks[arraysize(tracks)];
+    std::shared_ptr<loaded_cluster_t> loaded_cluster;
+    uint64_t timestamp_ns = UINT64_MAX;
+
+    const capture_index_entry_t &capture = context->capture_index[(size_t)index];
+    for (size_t i = 0; i < arraysize(tracks); i++)
+    {
+        if (capture.blocks[i] < 0)
+        {
+            continue;
+        }
+
+        const block_index_entry_t &entry = context->block_index[i][(size_t)capture.blocks[i]];
+        if (loaded_cluster == nullptr || loaded_cluster->cluster_info != entry.cluster_info)
+        {
+            loaded_cluster = load_cluster(context, entry.cluster_info);
+            if (loaded_cluster == nullptr || loaded_cluster->cluster == nullptr)
+            {
+                LOG_ERROR("Failed to load data cluster of capture %llu.", index);
+                return K4A_STREAM_RESULT_FAILED;
+            }
+        }
+
+        // Search from the element before the indexed one, so next_block() fills in the block at the index
+        block_info_t search_start;
+        search_start.reader = tracks[i];
+        search_start.cluster = loaded_cluster;
+        search_start.index = entry.index - 1;
+        blocks[i] = next_block(context, &search_start, true);
+        if (blocks[i] == nullptr || blocks[i]->block == NULL || blocks[i]->cluster != loaded_cluster ||
+            blocks[i]->index != entry.index)
+        {
+            LOG_ERROR("Failed to find block of capture %llu in the recording.", index);
+            return K4A_STREAM_RESULT_FAILED;
+        }
+        timestamp_ns = std::min(timestamp_ns, blocks[i]->timestamp_ns);
+    }
+
+    reset_seek_pointers(context, timestamp_ns);
+    context->seek_cluster = loaded_cluster;
+    for (size_t i = 0; i < arraysize(tracks); i++)
+    {
+        if (blocks[i] == nullptr)
+        {
+            continue;
+        }
+
+        tracks[i]->current_block = blocks[i];
+        k4a_result_t result = TRACE_CALL(new_capture(context, blocks[i].get(), capture_handle));
+        if (K4A_FAILED(result))
+        {
+            if (*capture_handle != NULL)
+            {
+                k4a_capture_release(*capture_handle);
+                *capture_handle = NULL;
+            }
+            return K4A_STREAM_RESULT_FAILED;
+        }
+    }
+
+    decode_ahead_color_images(context);
+    decode_ahead_depth_images(context);
+    return K4A_STREAM_RESULT_SUCCEEDED;
+}
+
+// Returns NULL if the buffer is invalid. Packed buffers hold several samples, the first is returned.
+static matroska_imu_sample_t *parse_imu_sample_buffer(DataBuffer &data_buffer, bool packed)
 {
     uint32_t buffer_size = data_buffer.Size();
     binary *buffer = data_buffer.Buffer();
-    if (buffer_size != sizeof(matroska_imu_sample_t))
+    bool valid_size = packed ? buffer_size > 0 && buffer_size % sizeof(matroska_imu_sample_t) == 0 :
+                               buffer_size == sizeof(matroska_imu_sample_t);
+    if (!valid_size)
     {
         LOG_ERROR("Unsupported IMU sample size: %u", buffer_size);
         return NULL;
@@ -2108,6 +3686,122 @@ static matroska_imu_sample_t *parse_imu_sample_buffer(DataBuffer &data_buffer)
     }
 }
 
+// Number of IMU samples in a block, the frames of a laced block or the samples of a packed one
+static size_t imu_block_sample_count(const block_info_t *block_info)
+{
+    if (block_info->reader->imu_packed)
+    {
+        return block_info->block->NumberFrames() == 1 ?
+                   block_info->block->GetBuffer(0).Size() / sizeof(matroska_imu_sample_t) :
+                   0;
+    }
+    return block_info->block->NumberFrames();
+}
+
+// Returns NULL if the sample is invalid.
+static matroska_imu_sample_t *get_imu_block_sample(const block_info_t *block_info, size_t index)
+{
+    if (block_info->reader->imu_packed)
+    {
+        matroska_imu_sample_t *samples = parse_imu_sample_buffer(block_info->block->GetBuffer(0), true);
+        return samples == NULL ? NULL : samples + index;
+    }
+    return parse_imu_sample_buffer(block_info->block->GetBuffer((unsigned int)index), false);
+}
+
+// Finds the next / previous IMU sample given a current one, stepping within the samples of a packed block before moving
+// to the next block. Returns the same as next_block() at the ends of the recording.
+static std::shared_ptr<block_info_t> next_imu_sample(k4a_playback_context_t *context, block_info_t *current, bool next)
+{
+    if (!current->reader->imu_packed)
+    {
+        return next_block(context, current, next);
+    }
+
+    std::shared_ptr<block_info_t> block_info;
+    if (current->block != NULL)
+    {
+        int sub_index = current->sub_index + (next ? 1 : -1);
+        if (sub_index >= 0 && sub_index < (int)imu_block_sample_count(current))
+        {
+            block_info = new_block_info(context, *current);
+            block_info->sub_index = sub_index;
+            return block_info;
+        }
+
+        // Leave the block from its single frame
+        block_info_t edge = *current;
+        edge.sub_index = 0;
+        block_info = next_block(context, &edge, next);
+    }
+    else
+    {
+        block_info = next_block(context, current, next);
+    }
+
+    if (!next && block_info && block_info->block)
+    {
+        block_info->sub_index = (int)imu_block_sample_count(block_info.get()) - 1;
+    }
+    return block_info;
+}
+
+static void convert_imu_sample(const matroska_imu_sample_t *sample, k4a_imu_sample_t *imu_sample)
+{
+    imu_sample->acc_timestamp_usec = sample->acc_timestamp_ns / 1000;
+    imu_sample->gyro_timestamp_usec = sample->gyro_timestamp_ns / 1000;
+    imu_sample->temperature = std::numeric_limits<float>::quiet_NaN();
+    for (size_t i = 0; i < 3; i++)
+    {
+        imu_sample->acc_sample.v[i] = sample->acc_data[i];
+        imu_sample->gyro_sample.v[i] = sample->gyro_data[i];
+    }
+}
+
+// Finds the sample of a packed IMU track at the seek timestamp. Packed blocks are timestamped by their first sample, so
+// the sample may be in the block before the one found by find_block().
+static std::shared_ptr<block_info_t> seek_packed_imu_sample(k4a_playback_context_t *context,
+                                                            std::shared_ptr<block_info_t> found_block,
+                                                            bool next)
+{
+    std::shared_ptr<block_info_t> block_info = next_block(context, found_block.get(), false);
+    if (block_info == nullptr)
+    {
+        return nullptr;
+    }
+    else if (block_info->block == NULL)
+    {
+        block_info = found_block;
+    }
+    block_info->sub_index = 0;
+
+    // IMU timestamps within the sample buffer are device timestamps, not relative to start of file.
+    uint64_t seek_device_timestamp_ns = context->seek_timestamp_ns +
+                                        ((uint64_t)context->record_config.start_timestamp_offset_usec * 1000);
+    while (block_info && block_info->block)
+    {
+        if (block_info->sub_index < (int)imu_block_sample_count(block_info.get()))
+        {
+            matroska_imu_sample_t *sample = get_imu_block_sample(block_info.get(), (size_t)block_info->sub_index);
+            if (sample == NULL)
+            {
+                return nullptr;
+            }
+            else if (sample->acc_timestamp_ns >= seek_device_timestamp_ns)
+            {
+                break;
+            }
+        }
+        block_info = next_imu_sample(context, block_info.get(), true);
+    }
+
+    if (block_info && !next)
+    {
+        block_info = next_imu_sample(context, block_info.get(), false);
+    }
+    return block_info;
+}
+
 k4a_stream_result_t get_imu_sample(k4a_playback_context_t *context, k4a_imu_sample_t *imu_sample, bool next)
 {
     RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, context == NULL);
@@ -2119,10 +3813,25 @@ k4a_stream_result_t get_imu_sample(k4a_playback_context_t *context, k4a_imu_samp
         *imu_sample = { 0 };
         return K4A_STREAM_RESULT_EOF;
     }
+    else if (!context->imu_track->enabled)
+    {
+        LOG_WARNING("The IMU track is disabled by the track filter.", 0);
+        *imu_sample = { 0 };
+        return K4A_STREAM_RESULT_EOF;
+    }
 
     std::shared_ptr<block_info_t> block_info = context->imu_track->current_block;
 
-    if (block_info == nullptr)
+    if (block_info == nullptr && context->imu_track->imu_packed)
+    {
+        // There is no current IMU sample, find the next/previous sample based on seek_timestamp.
+        block_info = find_block(context, context->imu_track, context->seek_timestamp_ns);
+        if (block_info)
+        {
+            block_info = seek_packed_imu_sample(context, block_info, next);
+        }
+    }
+    else if (block_info == nullptr)
     {
         // There is no current IMU sample, find the next/previous sample based on seek_timestamp.
         block_info = find_block(context, context->imu_track, context->seek_timestamp_ns);
@@ -2159,7 +3868,7 @@ k4a_stream_result_t get_imu_sample(k4a_playback_context_t *context, k4a_imu_samp
                 for (size_t i = 0; i < sample_count; i++)
                 {
                     matroska_imu_sample_t *sample = parse_imu_sample_buffer(
-                        block_info->block->GetBuffer((unsigned int)i));
+                        block_info->block->GetBuffer((unsigned int)i), false);
                     if (sample == NULL)
                     {
                         *imu_sample = { 0 };
@@ -2180,16 +3889,15 @@ k4a_stream_result_t get_imu_sample(k4a_playback_context_t *context, k4a_imu_samp
     }
     else
     {
-        block_info = next_block(context, block_info.get(), next);
+        block_info = next_imu_sample(context, block_info.get(), next);
     }
 
     context->imu_track->current_block = block_info;
 
     if (block_info && block_info->block && block_info->sub_index >= 0 &&
-        block_info->sub_index < (int)block_info->block->NumberFrames())
+        block_info->sub_index < (int)imu_block_sample_count(block_info.get()))
     {
-        matroska_imu_sample_t *sample = parse_imu_sample_buffer(
-            block_info->block->GetBuffer((unsigned int)block_info->sub_index));
+        matroska_imu_sample_t *sample = get_imu_block_sample(block_info.get(), (size_t)block_info->sub_index);
         if (sample == NULL)
         {
             *imu_sample = { 0 };
@@ -2197,14 +3905,7 @@ k4a_stream_result_t get_imu_sample(k4a_playback_context_t *context, k4a_imu_samp
         }
         else
         {
-            imu_sample->acc_timestamp_usec = sample->acc_timestamp_ns / 1000;
-            imu_sample->gyro_timestamp_usec = sample->gyro_timestamp_ns / 1000;
-            imu_sample->temperature = std::numeric_limits<float>::quiet_NaN();
-            for (size_t i = 0; i < 3; i++)
-            {
-                imu_sample->acc_sample.v[i] = sample->acc_data[i];
-                imu_sample->gyro_sample.v[i] = sample->gyro_data[i];
-            }
+            convert_imu_sample(sample, imu_sample);
             return K4A_STREAM_RESULT_SUCCEEDED;
         }
     }
@@ -2214,6 +3915,359 @@ k4a_stream_result_t get_imu_sample(k4a_playback_context_t *context, k4a_imu_samp
     return K4A_STREAM_RESULT_EOF;
 }
 
+// Reads the IMU samples with an accelerometer timestamp in [start_timestamp_usec, end_timestamp_usec) a whole block at
+// a time, without moving the IMU position of the playback.
+k4a_result_t get_imu_samples(k4a_playback_context_t *context,
+                             uint64_t start_timestamp_usec,
+                             uint64_t end_timestamp_usec,
+                             k4a_imu_sample_t *samples,
+                             size_t max_sample_count,
+                             size_t *sample_count)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, samples == NULL && max_sample_count > 0);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, sample_count == NULL);
+
+    *sample_count = 0;
+    if (context->imu_track == NULL)
+    {
+        LOG_WARNING("Recording has no IMU track.", 0);
+        return K4A_RESULT_SUCCEEDED;
+    }
+    else if (!context->imu_track->enabled)
+    {
+        LOG_WARNING("The IMU track is disabled by the track filter.", 0);
+        return K4A_RESULT_SUCCEEDED;
+    }
+    else if (start_timestamp_usec >= end_timestamp_usec || max_sample_count == 0)
+    {
+        return K4A_RESULT_SUCCEEDED;
+    }
+
+    // IMU timestamps within the sample buffer are device timestamps, the blocks are found by their timestamp relative
+    // to the start of the file. A block starting before the start timestamp may still hold samples past it.
+    uint64_t start_offset_usec = (uint64_t)context->record_config.start_timestamp_offset_usec;
+    uint64_t seek_timestamp_ns = 0;
+    if (start_timestamp_usec > start_offset_usec)
+    {
+        seek_timestamp_ns = (start_timestamp_usec - start_offset_usec) * 1000;
+    }
+    std::shared_ptr<block_info_t> block_info = find_block(context, context->imu_track, seek_timestamp_ns);
+    if (block_info)
+    {
+        block_info->sub_index = 0;
+        std::shared_ptr<block_info_t> previous_block = next_block(context, block_info.get(), false);
+        if (previous_block && previous_block->block)
+        {
+            block_info = previous_block;
+        }
+    }
+
+    while (block_info && block_info->block)
+    {
+        size_t block_sample_count = imu_block_sample_count(block_info.get());
+        for (size_t i = 0; i < block_sample_count; i++)
+        {
+            matroska_imu_sample_t *sample = get_imu_block_sample(block_info.get(), i);
+            if (sample == NULL)
+            {
+                return K4A_RESULT_FAILED;
+            }
+
+            uint64_t timestamp_usec = sample->acc_timestamp_ns / 1000;
+            if (timestamp_usec >= end_timestamp_usec)
+            {
+                return K4A_RESULT_SUCCEEDED;
+            }
+            else if (timestamp_usec >= start_timestamp_usec)
+            {
+                convert_imu_sample(sample, &samples[*sample_count]);
+                if (++(*sample_count) == max_sample_count)
+                {
+                    return K4A_RESULT_SUCCEEDED;
+                }
+            }
+        }
+
+        // Continue with the first sample of the next block
+        block_info->sub_index = (int)block_sample_count - 1;
+        block_info = next_imu_sample(context, block_info.get(), true);
+    }
+
+    if (block_info == nullptr)
+    {
+        LOG_ERROR("Failed to read the IMU samples of the recording.", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    LOG_TRACE("End of recording reached", 0);
+    return K4A_RESULT_SUCCEEDED;
+}
+
+// Reads the timestamps of the blocks of a track within a cluster from the cluster timecode and the block headers, the
+// block data is seeked past without being read. Reads with a cluster reader, or from context->ebml_file if reader is
+// nullptr.
+static k4a_result_t read_cluster_timestamps(k4a_playback_context_t *context,
+                                            cluster_reader_t *reader,
+                                            cluster_info_t *cluster_info,
+                                            uint64_t track_number,
+                                            std::vector<uint64_t> *timestamps_ns)
+{
+    timestamps_ns->clear();
+    try
+    {
+        std::unique_lock<std::mutex> io_lock(context->io_lock, std::defer_lock);
+        IOCallback *ebml_file = context->ebml_file.get();
+        libebml::EbmlStream *stream = nullptr;
+        if (reader == nullptr)
+        {
+            io_lock.lock();
+            if (context->file_closing)
+            {
+                // User called k4a_playback_close(), return immediately.
+                return K4A_RESULT_FAILED;
+            }
+        }
+        else
+        {
+            ebml_file = reader->ebml_file.get();
+            stream = reader->stream.get();
+        }
+        libebml::EbmlStream &data_stream = stream ? *stream : *context->stream;
+
+        LargeFileIOCallback *file_io = dynamic_cast<LargeFileIOCallback *>(ebml_file);
+        if (file_io != NULL)
+        {
+            file_io->setOwnerThread();
+        }
+
+        uint64_t file_offset = context->segment->GetGlobalPosition(cluster_info->file_offset);
+        assert(file_offset <= INT64_MAX);
+        ebml_file->setFilePointer((int64_t)file_offset);
+
+        std::shared_ptr<KaxCluster> cluster = find_next<KaxCluster>(context, true, stream);
+        if (cluster == nullptr)
+        {
+            LOG_ERROR("Failed to find cluster at: %llu", cluster_info->file_offset);
+            return K4A_RESULT_FAILED;
+        }
+
+        uint64_t cluster_timecode = 0;
+        std::vector<int16_t> relative_timecodes;
+        uint64_t cluster_end = cluster->GetEndPosition();
+        while (ebml_file->getFilePointer() < cluster_end)
+        {
+            int upper_level = 0;
+            std::unique_ptr<EbmlElement> element(data_stream.FindNextElement(KaxCluster::ClassInfos.Context,
+                                                                             upper_level,
+                                                                             cluster_end - ebml_file->getFilePointer(),
+                                                                             false,
+                                                                             1));
+            if (element == nullptr)
+            {
+                break;
+            }
+            else if (upper_level > 0)
+            {
+                LOG_ERROR("Cluster element overlaps the next element at: %llu", element->GetElementPosition());
+                return K4A_RESULT_FAILED;
+            }
+
+            EbmlId element_id(*element);
+            uint64_t block_track_number = 0;
+            int16_t relative_timecode = 0;
+            if (upper_level == 0 && element_id == KaxClusterTimecode::ClassInfos.GlobalId)
+            {
+                KaxClusterTimecode *timecode = read_element<KaxClusterTimecode>(context, element.get(), stream);
+                if (timecode == NULL)
+                {
+                    return K4A_RESULT_FAILED;
+                }
+                cluster_timecode = timecode->GetValue();
+                continue;
+            }
+            else if (upper_level == 0 && element_id == KaxSimpleBlock::ClassInfos.GlobalId)
+            {
+                if (peek_block_header(ebml_file, &block_track_number, &relative_timecode) &&
+                    block_track_number == track_number)
+                {
+                    relative_timecodes.push_back(relative_timecode);
+                }
+            }
+            else if (upper_level == 0 && element_id == KaxBlockGroup::ClassInfos.GlobalId)
+            {
+                // Only the header of the block within the group is read
+                uint64_t group_end = element->GetEndPosition();
+                while (ebml_file->getFilePointer() < group_end)
+                {
+                    int child_level = 0;
+                    std::unique_ptr<EbmlElement> child(
+                        data_stream.FindNextElement(KaxBlockGroup::ClassInfos.Context,
+                                                    child_level,
+                                                    group_end - ebml_file->getFilePointer(),
+                                                    false,
+                                                    1));
+                    if (child == nullptr || child_level > 0)
+                    {
+                        break;
+                    }
+                    if (child_level == 0 && EbmlId(*child) == KaxBlock::ClassInfos.GlobalId &&
+                        peek_block_header(ebml_file, &block_track_number, &relative_timecode) &&
+                        block_track_number == track_number)
+                    {
+                        relative_timecodes.push_back(relative_timecode);
+                    }
+                    child->SkipData(data_stream, KaxBlockGroup::ClassInfos.Context);
+                }
+            }
+            element->SkipData(data_stream, KaxCluster::ClassInfos.Context);
+        }
+
+        for (int16_t relative_timecode : relative_timecodes)
+        {
+            int64_t timecode = (int64_t)cluster_timecode + relative_timecode;
+            if (timecode >= 0)
+            {
+                timestamps_ns->push_back((uint64_t)timecode * context->timecode_scale);
+            }
+        }
+        return K4A_RESULT_SUCCEEDED;
+    }
+    catch (std::ios_base::failure &e)
+    {
+        LOG_ERROR("Failed to read the block headers of the cluster at %llu in '%s': %s",
+                  cluster_info->file_offset,
+                  context->file_path,
+                  e.what());
+        return K4A_RESULT_FAILED;
+    }
+    catch (std::system_error &e)
+    {
+        LOG_ERROR("Failed to read the block headers of the cluster: %s", e.what());
+        return K4A_RESULT_FAILED;
+    }
+    catch (std::bad_alloc &)
+    {
+        LOG_ERROR("Failed to allocate the block timestamps of the cluster.", 0);
+        return K4A_RESULT_FAILED;
+    }
+}
+
+// Lists the device timestamps of the blocks of a track in [start_timestamp_usec, end_timestamp_usec), a cluster at a
+// time from their block headers. The clusters aren't loaded, so neither the playback position nor the cluster cache
+// changes.
+k4a_result_t get_track_timestamps(k4a_playback_context_t *context,
+                                  track_reader_t *track_reader,
+                                  uint64_t start_timestamp_usec,
+                                  uint64_t end_timestamp_usec,
+                                  uint64_t *timestamps_usec,
+                                  size_t max_timestamp_count,
+                                  size_t *timestamp_count)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context->segment == nullptr);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, track_reader == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, timestamps_usec == NULL && max_timestamp_count > 0);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, timestamp_count == NULL);
+
+    *timestamp_count = 0;
+    if (!track_reader->enabled)
+    {
+        LOG_WARNING("The track '%s' is disabled by the track filter.", track_reader->track_name.c_str());
+        return K4A_RESULT_SUCCEEDED;
+    }
+    else if (start_timestamp_usec >= end_timestamp_usec || max_timestamp_count == 0)
+    {
+        return K4A_RESULT_SUCCEEDED;
+    }
+
+    uint64_t start_offset_usec = (uint64_t)context->record_config.start_timestamp_offset_usec;
+    uint64_t seek_timestamp_ns = 0;
+    if (start_timestamp_usec > start_offset_usec)
+    {
+        seek_timestamp_ns = (start_timestamp_usec - start_offset_usec) * 1000;
+    }
+    cluster_info_t *cluster_info = find_cluster(context, seek_timestamp_ns);
+    if (cluster_info == NULL)
+    {
+        LOG_ERROR("Failed to find the cluster of timestamp: %llu", seek_timestamp_ns);
+        return K4A_RESULT_FAILED;
+    }
+    // Blocks of the previous cluster may still be past the start timestamp
+    cluster_info_t *previous_cluster_info = next_cluster(context, cluster_info, false);
+    if (previous_cluster_info != NULL)
+    {
+        cluster_info = previous_cluster_info;
+    }
+
+    std::unique_ptr<cluster_reader_t> reader;
+    try
+    {
+        std::lock_guard<std::mutex> lock(context->cluster_load_lock);
+        if (!context->idle_cluster_readers.empty())
+        {
+            reader = std::move(context->idle_cluster_readers.back());
+            context->idle_cluster_readers.pop_back();
+        }
+    }
+    catch (std::system_error &e)
+    {
+        LOG_ERROR("Failed to take a cluster reader: %s", e.what());
+        return K4A_RESULT_FAILED;
+    }
+    if (reader == nullptr)
+    {
+        reader = open_cluster_reader(context);
+    }
+
+    k4a_result_t result = K4A_RESULT_SUCCEEDED;
+    uint64_t track_number = track_reader->track->TrackNumber().GetValue();
+    std::vector<uint64_t> cluster_timestamps_ns;
+    while (cluster_info != NULL && *timestamp_count < max_timestamp_count)
+    {
+        if (cluster_info->timestamp_ns / 1000 + start_offset_usec >= end_timestamp_usec)
+        {
+            break;
+        }
+
+        result = read_cluster_timestamps(context, reader.get(), cluster_info, track_number, &cluster_timestamps_ns);
+        if (K4A_FAILED(result))
+        {
+            break;
+        }
+        for (uint64_t timestamp_ns : cluster_timestamps_ns)
+        {
+            uint64_t timestamp_usec = timestamp_ns / 1000 + start_offset_usec;
+            if (timestamp_usec >= start_timestamp_usec && timestamp_usec < end_timestamp_usec)
+            {
+                timestamps_usec[(*timestamp_count)++] = timestamp_usec;
+                if (*timestamp_count == max_timestamp_count)
+                {
+                    break;
+                }
+            }
+        }
+        cluster_info = next_cluster(context, cluster_info, true);
+    }
+
+    if (reader)
+    {
+        try
+        {
+            std::lock_guard<std::mutex> lock(context->cluster_load_lock);
+            if (context->idle_cluster_readers.size() < (size_t)context->read_ahead_count * 2)
+            {
+                context->idle_cluster_readers.push_back(std::move(reader));
+            }
+        }
+        catch (std::system_error &e)
+        {
+            LOG_WARNING("Failed to return the cluster reader: %s", e.what());
+        }
+    }
+    return result;
+}
+
 k4a_stream_result_t get_data_block(k4a_playback_context_t *context,
                                    track_reader_t *track_reader,
                                    k4a_playback_data_block_t *data_block_handle,
@@ -2223,6 +4277,12 @@ k4a_stream_result_t get_data_block(k4a_playback_context_t *context,
     RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, track_reader == NULL);
     RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, data_block_handle == NULL);
 
+    if (!track_reader->enabled)
+    {
+        LOG_WARNING("The track '%s' is disabled by the track filter.", track_reader->track_name.c_str());
+        return K4A_STREAM_RESULT_EOF;
+    }
+
     std::shared_ptr<block_info_t> read_block = track_reader->current_block;
     if (read_block == nullptr)
     {
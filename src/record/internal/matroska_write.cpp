@@ -4,14 +4,21 @@
 #include <ctime>
 #include <iostream>
 #include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <sstream>
 
 #include <k4a/k4a.h>
 #include <k4ainternal/matroska_write.h>
 #include <k4ainternal/logging.h>
+#include <k4ainternal/threadpolicy.h>
+#include <azure_c_shared_utility/envvariable.h>
 
 using namespace LIBMATROSKA_NAMESPACE;
 
+// Threads write_cluster() encodes the RVL bands of a cluster on, including the writer thread
+#define RVL_ENCODER_THREAD_COUNT 4
+
 namespace k4arecord
 {
 std::set<uint64_t> unique_ids;
@@ -93,7 +100,7 @@ populate_bitmap_info_header(BITMAPINFOHEADER *header, uint64_t width, uint64_t h
     case K4A_IMAGE_FORMAT_IR16:
         // Store depth in b16g format, which is supported by ffmpeg.
         header->biBitCount = 16;
-        header->biCompression = 0x67363162; // b16g (16 bit grayscale, big endian)
+        header->biCompression = K4A_FOURCC_GRAY16_BIG_ENDIAN;
         header->biSizeImage = sizeof(uint8_t) * header->biWidth * header->biHeight * 2;
         break;
     case K4A_IMAGE_FORMAT_COLOR_BGRA32:
@@ -171,6 +178,7 @@ track_header_t *add_track(k4a_record_context_t *context,
     track_header.track = track;
     track_header.custom_track = false;
     track_header.high_freq_data = false;
+    track_header.stage = std::make_shared<track_stage_t>();
     auto entry = context->tracks.emplace(std::string(name), track_header);
 
     return &entry.first->second;
@@ -188,35 +196,308 @@ void set_track_info_video(track_header_t *track, uint64_t width, uint64_t height
     GetChild<KaxVideoPixelHeight>(video_track).SetValue(height);
 }
 
+// Wakes the thread writing the clusters of the recording
+static void notify_writer(k4a_record_context_t *context)
+{
+    if (context->writer_pool)
+    {
+        context->writer_pool->notify->notify_one();
+    }
+    else if (context->writer_notify)
+    {
+        context->writer_notify->notify_one();
+    }
+}
+
+// Lock(context->pending_cluster_lock) should be active when calling this function
+static bool write_queue_full(k4a_record_context_t *context, uint64_t data_size)
+{
+    // Data larger than max_pending_bytes is accepted into an empty queue
+    return context->max_pending_bytes != 0 && context->pending_bytes != 0 &&
+           context->pending_bytes + data_size > context->max_pending_bytes;
+}
+
+// Lock(context->pending_cluster_lock) should be active when calling this function. Makes the writer thread write the
+// oldest complete cluster without waiting for the write delay.
+static void notify_write_queue_full(k4a_record_context_t *context)
+{
+    context->pending_overflow = true;
+    notify_writer(context);
+}
+
+// Drops queued color images, oldest first, until data_size bytes fit in the write queue. Clusters left empty are
+// removed. Lock(context->pending_cluster_lock) should be active when calling this function.
+static void drop_queued_color_images(k4a_record_context_t *context, uint64_t data_size)
+{
+    for (auto cluster = context->pending_clusters.begin();
+         cluster != context->pending_clusters.end() && write_queue_full(context, data_size);)
+    {
+        std::vector<std::pair<uint64_t, track_data_t>> &cluster_data = (*cluster)->data;
+        size_t kept = 0;
+        for (size_t i = 0; i < cluster_data.size(); i++)
+        {
+            track_data_t &data = cluster_data[i].second;
+            if (data.track != context->color_track || !write_queue_full(context, data_size))
+            {
+                cluster_data[kept++] = cluster_data[i];
+                continue;
+            }
+
+            if (data.buffer != NULL)
+            {
+                data.buffer->FreeBuffer(*data.buffer);
+                delete data.buffer;
+            }
+            if (data.color_job != nullptr)
+            {
+                std::lock_guard<std::mutex> lock(context->color_encode_lock);
+                auto queued = std::find(context->color_encode_queue.begin(),
+                                        context->color_encode_queue.end(),
+                                        data.color_job);
+                if (queued != context->color_encode_queue.end())
+                {
+                    context->color_encode_queue.erase(queued);
+                }
+            }
+            (*cluster)->size_bytes -= data.size_bytes;
+            context->pending_bytes -= data.size_bytes;
+            context->dropped_sample_count++;
+        }
+        cluster_data.resize(kept);
+
+        if (cluster_data.empty())
+        {
+            delete *cluster;
+            cluster = context->pending_clusters.erase(cluster);
+        }
+        else
+        {
+            cluster++;
+        }
+    }
+}
+
+// Makes room for data_size bytes in the write queue following the overflow policy, returns false if the data needs to
+// be dropped. Lock(context->pending_cluster_lock) should be held by lock.
+static bool make_pending_space(k4a_record_context_t *context,
+                               std::unique_lock<std::mutex> &lock,
+                               track_header_t *track,
+                               uint64_t data_size)
+{
+    if (!context->pending_space_notify || !write_queue_full(context, data_size))
+    {
+        return true;
+    }
+
+    // Captures are checked as a whole by k4a_record_write_capture() before their images are written
+    if (context->overflow_policy == K4A_RECORD_OVERFLOW_DROP_CAPTURE &&
+        (track == context->color_track || track == context->depth_track || track == context->ir_track))
+    {
+        return true;
+    }
+    notify_write_queue_full(context);
+
+    switch (context->overflow_policy)
+    {
+    case K4A_RECORD_OVERFLOW_BLOCK:
+    {
+        uint64_t timeout_ns = context->block_timeout_ns != 0 ? context->block_timeout_ns :
+                                                               context->cluster_write_delay_ns;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::nanoseconds(timeout_ns);
+        while (write_queue_full(context, data_size))
+        {
+            if (context->pending_space_notify->wait_until(lock, deadline) == std::cv_status::timeout)
+            {
+                return !write_queue_full(context, data_size);
+            }
+            // Another cluster is needed if the written one didn't free enough
+            notify_write_queue_full(context);
+        }
+        return true;
+    }
+    case K4A_RECORD_OVERFLOW_DROP_COLOR:
+        if (track != context->color_track)
+        {
+            drop_queued_color_images(context, data_size);
+            return !write_queue_full(context, data_size);
+        }
+        return false;
+    default:
+        return false;
+    }
+}
+
+bool drop_if_write_queue_full(k4a_record_context_t *context, uint64_t data_size, uint32_t sample_count)
+{
+    RETURN_VALUE_IF_ARG(false, context == NULL);
+
+    try
+    {
+        std::lock_guard<std::mutex> lock(context->pending_cluster_lock);
+        if (!context->pending_space_notify || !write_queue_full(context, data_size))
+        {
+            return false;
+        }
+
+        notify_write_queue_full(context);
+        context->dropped_sample_count += sample_count;
+    }
+    catch (std::system_error &e)
+    {
+        LOG_ERROR("Failed to check the write queue: %s", e.what());
+        return false;
+    }
+    return true;
+}
+
 // Buffer needs to be valid until it is flushed to disk. The DataBuffer free callback can be used to assist with this.
 // If a failure is returned, the caller will need to free the buffer.
-k4a_result_t
-write_track_data(k4a_record_context_t *context, track_header_t *track, uint64_t timestamp_ns, DataBuffer *buffer)
+// Color images transcoded by the color encoders are queued as a color_job, with no buffer.
+// Queues a block of track data in its pending cluster. Lock(context->pending_cluster_lock) should be active, lock is
+// released while waiting for space in the write queue.
+static k4a_result_t queue_track_data(k4a_record_context_t *context,
+                                     std::unique_lock<std::mutex> &lock,
+                                     track_header_t *track,
+                                     uint64_t timestamp_ns,
+                                     DataBuffer *buffer,
+                                     std::shared_ptr<color_encode_job_t> color_job)
+{
+    uint64_t data_size = buffer != NULL ? buffer->Size() : k4a_image_get_size(color_job->image);
+
+    if (!make_pending_space(context, lock, track, data_size))
+    {
+        context->dropped_sample_count++;
+        LOG_WARNING("The write queue is full, dropping data at timestamp %llu.", timestamp_ns);
+        return K4A_RESULT_FAILED;
+    }
+
+    if (context->most_recent_timestamp < timestamp_ns)
+    {
+        context->most_recent_timestamp = timestamp_ns;
+    }
+
+    cluster_t *cluster = get_cluster_for_timestamp(context, timestamp_ns);
+    if (cluster == NULL)
+    {
+        // The timestamp is too old, the block of data has already been written.
+        return K4A_RESULT_FAILED;
+    }
+
+    track_data_t data = { track, buffer, color_job, data_size };
+    cluster->data.push_back(std::make_pair(timestamp_ns, data));
+    cluster->size_bytes += data_size;
+    context->pending_bytes += data_size;
+    if (color_job != nullptr)
+    {
+        queue_color_encode_job(context, color_job);
+    }
+    return K4A_RESULT_SUCCEEDED;
+}
+
+// Without a write queue limit a block needs none of the accounting under the pending_cluster_lock before it is taken,
+// so it is staged on its track and the writer moves it into its cluster. Producers writing different tracks don't
+// contend, and pending_cluster_lock is only held by the writer while it moves the blocks.
+static bool can_stage_track_data(k4a_record_context_t *context, track_header_t *track)
+{
+    return context->max_pending_bytes == 0 && track->stage != nullptr;
+}
+
+// Stages count blocks of track data on their track, see can_stage_track_data()
+static k4a_result_t stage_track_data(k4a_record_context_t *context,
+                                     track_header_t *track,
+                                     const uint64_t *timestamps_ns,
+                                     DataBuffer *const *buffers,
+                                     size_t count)
+{
+    // Blocks older than the last written cluster are turned away like get_cluster_for_timestamp() does. One that only
+    // becomes too old before the writer takes it is dropped by stage_pending_track_data().
+    uint64_t written_timestamp = context->written_timestamp_hint.load();
+    for (size_t i = 0; i < count; i++)
+    {
+        if (timestamps_ns[i] < written_timestamp)
+        {
+            LOG_ERROR("The cluster containing the timestamp %llu has already been written to disk.", timestamps_ns[i]);
+            return K4A_RESULT_FAILED;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(track->stage->lock);
+    for (size_t i = 0; i < count; i++)
+    {
+        track_data_t data = { track, buffers[i], nullptr, buffers[i]->Size() };
+        track->stage->data.push_back(std::make_pair(timestamps_ns[i], data));
+    }
+    return K4A_RESULT_SUCCEEDED;
+}
+
+void stage_pending_track_data(k4a_record_context_t *context)
+{
+    RETURN_VALUE_IF_ARG(VOID_VALUE, context == NULL);
+
+    // The vectors are swapped, so the staging storage of each track is reused instead of reallocated
+    std::vector<std::pair<uint64_t, track_data_t>> staged;
+    for (auto &entry : context->tracks)
+    {
+        track_stage_t *stage = entry.second.stage.get();
+        if (stage == nullptr)
+        {
+            continue;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(stage->lock);
+            staged.swap(stage->data);
+        }
+
+        for (std::pair<uint64_t, track_data_t> &block : staged)
+        {
+            if (context->most_recent_timestamp < block.first)
+            {
+                context->most_recent_timestamp = block.first;
+            }
+
+            cluster_t *cluster = get_cluster_for_timestamp(context, block.first);
+            if (cluster == NULL)
+            {
+                // Its cluster was written after the block was staged, the write already succeeded so it is dropped
+                block.second.buffer->FreeBuffer(*block.second.buffer);
+                delete block.second.buffer;
+                context->dropped_sample_count++;
+                continue;
+            }
+
+            cluster->data.push_back(block);
+            cluster->size_bytes += block.second.size_bytes;
+            context->pending_bytes += block.second.size_bytes;
+        }
+        staged.clear();
+    }
+}
+
+k4a_result_t write_track_data(k4a_record_context_t *context,
+                              track_header_t *track,
+                              uint64_t timestamp_ns,
+                              DataBuffer *buffer,
+                              std::shared_ptr<color_encode_job_t> color_job)
 {
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, !context->header_written);
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, track == NULL);
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, track->track == NULL);
-    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, buffer == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, (buffer == NULL) == (color_job == nullptr));
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, color_job != nullptr && context->color_encode_done == nullptr);
 
     try
     {
-        std::lock_guard<std::mutex> lock(context->pending_cluster_lock);
-
-        if (context->most_recent_timestamp < timestamp_ns)
+        if (color_job == nullptr && can_stage_track_data(context, track))
         {
-            context->most_recent_timestamp = timestamp_ns;
+            RETURN_IF_ERROR(stage_track_data(context, track, &timestamp_ns, &buffer, 1));
         }
-
-        cluster_t *cluster = get_cluster_for_timestamp(context, timestamp_ns);
-        if (cluster == NULL)
+        else
         {
-            // The timestamp is too old, the block of data has already been written.
-            return K4A_RESULT_FAILED;
+            std::unique_lock<std::mutex> lock(context->pending_cluster_lock);
+            RETURN_IF_ERROR(queue_track_data(context, lock, track, timestamp_ns, buffer, color_job));
         }
-
-        track_data_t data = { track, buffer };
-        cluster->data.push_back(std::make_pair(timestamp_ns, data));
     }
     catch (std::system_error &e)
     {
@@ -224,12 +505,64 @@ write_track_data(k4a_record_context_t *context, track_header_t *track, uint64_t
         return K4A_RESULT_FAILED;
     }
 
-    if (context->writer_notify)
+    notify_writer(context);
+
+    return K4A_RESULT_SUCCEEDED;
+}
+
+// Queues count blocks of track data under one lock of the write queue. The blocks the recording took are counted in
+// queued_count, the caller frees the buffers of the others.
+k4a_result_t write_track_data_blocks(k4a_record_context_t *context,
+                                     track_header_t *track,
+                                     const uint64_t *timestamps_ns,
+                                     DataBuffer *const *buffers,
+                                     size_t count,
+                                     size_t *queued_count)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, queued_count == NULL);
+    *queued_count = 0;
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, !context->header_written);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, track == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, track->track == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, count > 0 && (timestamps_ns == NULL || buffers == NULL));
+
+    k4a_result_t result = K4A_RESULT_SUCCEEDED;
+    try
     {
-        context->writer_notify->notify_one();
+        if (can_stage_track_data(context, track))
+        {
+            // All of the blocks are staged or none
+            result = TRACE_CALL(stage_track_data(context, track, timestamps_ns, buffers, count));
+            *queued_count = K4A_SUCCEEDED(result) ? count : 0;
+            if (*queued_count > 0)
+            {
+                notify_writer(context);
+            }
+            return result;
+        }
+
+        std::unique_lock<std::mutex> lock(context->pending_cluster_lock);
+        for (size_t i = 0; i < count && K4A_SUCCEEDED(result); i++)
+        {
+            result = TRACE_CALL(queue_track_data(context, lock, track, timestamps_ns[i], buffers[i], nullptr));
+            if (K4A_SUCCEEDED(result))
+            {
+                (*queued_count)++;
+            }
+        }
+    }
+    catch (std::system_error &e)
+    {
+        LOG_ERROR("Failed to write track data to queue: %s", e.what());
+        result = K4A_RESULT_FAILED;
     }
 
-    return K4A_RESULT_SUCCEEDED;
+    if (*queued_count > 0)
+    {
+        notify_writer(context);
+    }
+    return result;
 }
 
 // Lock(context->pending_cluster_lock) should be active when calling this function
@@ -262,15 +595,15 @@ cluster_t *get_cluster_for_timestamp(k4a_record_context_t *context, uint64_t tim
         // Calculate the new cluster start, aligned to the current cluster length.
         uint64_t time_start_ns = selected_cluster == cluster_end ? context->last_written_timestamp :
                                                                    (*selected_cluster)->time_end_ns;
-        if (time_start_ns + MAX_CLUSTER_LENGTH_NS <= timestamp_ns)
+        if (time_start_ns + context->cluster_length_ns <= timestamp_ns)
         {
             uint64_t diff = timestamp_ns - time_start_ns;
-            time_start_ns += diff - (diff % MAX_CLUSTER_LENGTH_NS);
+            time_start_ns += diff - (diff % context->cluster_length_ns);
         }
 
         cluster_t *new_cluster = new cluster_t;
         new_cluster->time_start_ns = time_start_ns;
-        new_cluster->time_end_ns = time_start_ns + MAX_CLUSTER_LENGTH_NS;
+        new_cluster->time_end_ns = time_start_ns + context->cluster_length_ns;
         assert(new_cluster->time_start_ns <= timestamp_ns && new_cluster->time_end_ns > timestamp_ns);
 
         if (selected_cluster == cluster_end)
@@ -291,11 +624,198 @@ cluster_t *get_cluster_for_timestamp(k4a_record_context_t *context, uint64_t tim
     }
 }
 
+static bool free_encoded_buffer(const DataBuffer &buffer)
+{
+    delete[] const_cast<binary *>(buffer.Buffer());
+    return true;
+}
+
+// Copies and swaps 16 bit grayscale to big-endian in a single pass.
+static DataBuffer *create_byte_swapped_buffer(const binary *source, uint32 size)
+{
+    assert(size % sizeof(uint16_t) == 0);
+    binary *swapped = new (std::nothrow) binary[size];
+    if (swapped == NULL)
+    {
+        return NULL;
+    }
+
+    swap_bytes_16_copy(reinterpret_cast<uint16_t *>(swapped),
+                       reinterpret_cast<const uint16_t *>(source),
+                       size / sizeof(uint16_t));
+
+    DataBuffer *buffer = new (std::nothrow) DataBuffer(swapped, size, &free_encoded_buffer);
+    if (buffer == NULL)
+    {
+        delete[] swapped;
+    }
+    return buffer;
+}
+
+typedef struct _rvl_band_t
+{
+    const uint16_t *pixels;
+    size_t pixel_count;
+    uint8_t *output; // Has room for rvl_encode_bound(pixel_count) bytes
+    size_t size;
+} rvl_band_t;
+
+// Encodes the images of big-endian and RVL tracks, which are queued as image references in native byte order, so the
+// threads writing captures don't pay for it. The RVL bands of the whole cluster are spread over
+// RVL_ENCODER_THREAD_COUNT threads. Transcoded color images are taken from their color encoder jobs. Images that
+// can't be encoded are dropped from the cluster.
+static void encode_cluster_data(k4a_record_context_t *context, cluster_t *cluster)
+{
+    const size_t rvl_header_size = sizeof(uint32_t) * (2 + K4A_RVL_BAND_COUNT);
+    std::vector<DataBuffer *> encoded(cluster->data.size(), nullptr);
+    std::vector<binary *> rvl_images(cluster->data.size(), nullptr);
+    std::vector<rvl_band_t> bands;
+
+    for (size_t i = 0; i < cluster->data.size(); i++)
+    {
+        track_data_t &data = cluster->data[i].second;
+        if (data.color_job != nullptr)
+        {
+            wait_color_encode_job(context, data.color_job);
+            encoded[i] = data.color_job->output;
+            data.color_job->output = nullptr;
+            data.color_job.reset();
+        }
+        else if (data.track->gray16_encoding == GRAY16_ENCODING_BIG_ENDIAN)
+        {
+            encoded[i] = create_byte_swapped_buffer(data.buffer->Buffer(), data.buffer->Size());
+        }
+        else if (data.track->gray16_encoding == GRAY16_ENCODING_RVL)
+        {
+            // The bands are encoded after the header with room for their worst case, and compacted once encoded
+            const uint16_t *pixels = reinterpret_cast<const uint16_t *>(data.buffer->Buffer());
+            size_t pixel_count = data.buffer->Size() / sizeof(uint16_t);
+            size_t max_size = rvl_header_size + rvl_encode_bound(pixel_count) + sizeof(uint32_t) * K4A_RVL_BAND_COUNT;
+            rvl_images[i] = new (std::nothrow) binary[max_size];
+            if (rvl_images[i] != NULL)
+            {
+                write_uint32_le(rvl_images[i], (uint32_t)pixel_count);
+                write_uint32_le(rvl_images[i] + sizeof(uint32_t), K4A_RVL_BAND_COUNT);
+                uint8_t *band_output = rvl_images[i] + rvl_header_size;
+                for (size_t band = 0; band < K4A_RVL_BAND_COUNT; band++)
+                {
+                    size_t start = rvl_band_start(pixel_count, K4A_RVL_BAND_COUNT, band);
+                    size_t end = rvl_band_start(pixel_count, K4A_RVL_BAND_COUNT, band + 1);
+                    bands.push_back({ pixels + start, end - start, band_output, 0 });
+                    band_output += rvl_encode_bound(end - start);
+                }
+            }
+        }
+    }
+
+    if (!bands.empty())
+    {
+        std::atomic<size_t> next_band(0);
+        auto encode_bands = [&bands, &next_band]() {
+            for (size_t band = next_band++; band < bands.size(); band = next_band++)
+            {
+                bands[band].size = rvl_encode(bands[band].pixels, bands[band].pixel_count, bands[band].output);
+            }
+        };
+
+        std::vector<std::thread> encoders;
+        try
+        {
+            for (size_t i = 1; i < RVL_ENCODER_THREAD_COUNT && i < bands.size(); i++)
+            {
+                encoders.emplace_back(encode_bands);
+            }
+        }
+        catch (std::system_error &e)
+        {
+            // The remaining bands are encoded by the threads that did start
+            LOG_WARNING("Failed to start RVL encoder thread: %s", e.what());
+        }
+        encode_bands();
+        for (std::thread &encoder : encoders)
+        {
+            encoder.join();
+        }
+
+        // The bands are in the order of the images, each is moved after the end of the previous one
+        auto band = bands.begin();
+        for (size_t i = 0; i < cluster->data.size(); i++)
+        {
+            if (rvl_images[i] != NULL)
+            {
+                uint8_t *end = rvl_images[i] + rvl_header_size;
+                for (size_t j = 0; j < K4A_RVL_BAND_COUNT; j++, ++band)
+                {
+                    write_uint32_le(rvl_images[i] + sizeof(uint32_t) * (2 + j), (uint32_t)band->size);
+                    memmove(end, band->output, band->size);
+                    end += band->size;
+                }
+
+                size_t size = (size_t)(end - rvl_images[i]);
+                if (size <= UINT32_MAX)
+                {
+                    encoded[i] = new (std::nothrow) DataBuffer(rvl_images[i], (uint32)size, &free_encoded_buffer);
+                }
+                if (encoded[i] == NULL)
+                {
+                    delete[] rvl_images[i];
+                }
+            }
+        }
+    }
+
+    // Replace the image references with their encoded copies, and drop the images that couldn't be encoded
+    size_t kept = 0;
+    for (size_t i = 0; i < cluster->data.size(); i++)
+    {
+        track_data_t &data = cluster->data[i].second;
+        if (data.buffer == NULL)
+        {
+            data.buffer = encoded[i];
+        }
+        else if (data.track->gray16_encoding != GRAY16_ENCODING_NONE)
+        {
+            data.buffer->FreeBuffer(*data.buffer);
+            delete data.buffer;
+            data.buffer = encoded[i];
+        }
+
+        if (data.buffer != NULL)
+        {
+            cluster->data[kept++] = cluster->data[i];
+        }
+        else
+        {
+            LOG_ERROR("Failed to allocate the encoded copy of an image, dropping it.", 0);
+        }
+    }
+    cluster->data.resize(kept);
+}
+
 static bool sort_by_pair_asc(const std::pair<uint64_t, track_data_t> &a, const std::pair<uint64_t, track_data_t> &b)
 {
     return (a.first < b.first);
 }
 
+// Keeps the disk space of the file reserved one to two extents past the end of the next cluster, see
+// k4a_record_set_preallocation()
+static void reserve_file_space(k4a_record_context_t *context, uint64_t cluster_size)
+{
+    if (context->preallocation_bytes == 0)
+    {
+        return;
+    }
+
+    auto file = dynamic_cast<LargeFileIOCallback *>(context->ebml_file.get());
+    uint64_t extent_count = (context->ebml_file->getFilePointer() + cluster_size) / context->preallocation_bytes + 2;
+    if (file == nullptr || !file->reserve(extent_count * context->preallocation_bytes))
+    {
+        LOG_WARNING("Disk space can't be reserved for '%s', the recording is written without preallocation.",
+                    context->file_path);
+        context->preallocation_bytes = 0;
+    }
+}
+
 // Writes the cluster to disk and frees the cluster.
 // Updated time_end_ns is optionally returned through the argument pointer.
 k4a_result_t write_cluster(k4a_record_context_t *context, cluster_t *cluster, uint64_t *time_end_ns)
@@ -304,7 +824,16 @@ k4a_result_t write_cluster(k4a_record_context_t *context, cluster_t *cluster, ui
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, !context->header_written);
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, cluster == NULL);
 
-    if (cluster->data.size() == 0)
+    bool had_data = !cluster->data.empty();
+    encode_cluster_data(context, cluster);
+
+    if (had_data && cluster->data.empty())
+    {
+        // Every image was dropped by encode_cluster_data(), which already logged it
+        delete cluster;
+        return K4A_RESULT_SUCCEEDED;
+    }
+    else if (cluster->data.size() == 0)
     {
         LOG_WARNING("Tried to write empty cluster to disk", 0);
         delete cluster;
@@ -314,6 +843,21 @@ k4a_result_t write_cluster(k4a_record_context_t *context, cluster_t *cluster, ui
     // Sort the data in the cluster by timestamp so it can be written in order
     std::sort(cluster->data.begin(), cluster->data.end(), sort_by_pair_asc);
 
+    if (segment_limit_reached(context, cluster->data.front().first))
+    {
+        k4a_result_t segment_result = TRACE_CALL(start_next_segment(context));
+        if (K4A_FAILED(segment_result))
+        {
+            for (std::pair<uint64_t, track_data_t> data : cluster->data)
+            {
+                data.second.buffer->FreeBuffer(*data.second.buffer);
+                delete data.second.buffer;
+            }
+            delete cluster;
+            return segment_result;
+        }
+    }
+
     KaxCluster *new_cluster = new KaxCluster();
 
     // KaxCluster will be freed by libmatroska when the file is closed.
@@ -392,7 +936,8 @@ k4a_result_t write_cluster(k4a_record_context_t *context, cluster_t *cluster, ui
 
         // Only add one Cue entry once per cluster
         // We only need to write Cue entries for the first track.
-        if (first && GetChild<KaxTrackNumber>(*data.second.track->track).GetValue() == 1)
+        // Streamed recordings have no Cues.
+        if (first && !context->streaming && GetChild<KaxTrackNumber>(*data.second.track->track).GetValue() == 1)
         {
             // Add cue entries at a maximum rate specified by CUE_ENTRY_GAP_NS so that the index doesn't get too large.
             if (context->last_cues_entry_ns == 0 ||
@@ -411,7 +956,25 @@ k4a_result_t write_cluster(k4a_record_context_t *context, cluster_t *cluster, ui
     auto &cues = GetChild<KaxCues>(*context->file_segment);
     try
     {
+        reserve_file_space(context, cluster->size_bytes);
         new_cluster->Render(*context->ebml_file, cues);
+
+        if (context->write_recording_index)
+        {
+            recording_index_cluster_t index_cluster;
+            uint64_t cluster_timecode = GetChild<KaxClusterTimecode>(*new_cluster).GetValue();
+            index_cluster.timestamp_ns = cluster_timecode * context->timecode_scale;
+            index_cluster.file_offset = context->file_segment->GetRelativePosition(*new_cluster);
+            index_cluster.cluster_size = new_cluster->HeadSize() + new_cluster->GetSize();
+            context->index_clusters.push_back(index_cluster);
+        }
+
+        if (context->segment_empty)
+        {
+            context->segment_start_ns = cluster->time_start_ns;
+            context->segment_empty = false;
+        }
+        context->segment_last_timestamp_ns = cluster->data.back().first;
     }
     catch (std::ios_base::failure &e)
     {
@@ -451,10 +1014,74 @@ k4a_result_t write_cluster(k4a_record_context_t *context, cluster_t *cluster, ui
     return result;
 }
 
+// Lock(context->writer_lock) should be active when calling this function
+k4a_result_t write_pending_cluster(k4a_record_context_t *context, bool *written)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, written == NULL);
+
+    *written = false;
+    cluster_t *oldest_cluster = NULL;
+    uint64_t oldest_cluster_bytes = 0;
+    {
+        std::lock_guard<std::mutex> lock(context->pending_cluster_lock);
+        stage_pending_track_data(context);
+
+        // Check the oldest pending cluster to see if we should write to disk. A full write queue writes the oldest
+        // complete cluster without waiting for the write delay.
+        if (!context->pending_clusters.empty())
+        {
+            cluster_t *cluster = context->pending_clusters.front();
+            if (context->most_recent_timestamp >= cluster->time_end_ns)
+            {
+                uint64_t age = context->most_recent_timestamp - cluster->time_end_ns;
+                if (age > context->cluster_write_delay_ns || context->pending_overflow)
+                {
+                    assert(cluster->time_start_ns >= context->last_written_timestamp);
+                    context->pending_clusters.pop_front();
+                    context->last_written_timestamp = cluster->time_end_ns;
+                    context->written_timestamp_hint.store(cluster->time_end_ns);
+                    context->pending_overflow = false;
+                    oldest_cluster = cluster;
+                    oldest_cluster_bytes = cluster->size_bytes;
+                    if (age > context->cluster_write_delay_ns +
+                                  (CLUSTER_WRITE_QUEUE_WARNING_NS - CLUSTER_WRITE_DELAY_NS))
+                    {
+                        LOG_ERROR("Disk write speed is too low, write queue is filling up.", 0);
+                    }
+                }
+            }
+        }
+    }
+
+    if (oldest_cluster == NULL)
+    {
+        return K4A_RESULT_SUCCEEDED;
+    }
+
+    *written = true;
+    RETURN_IF_ERROR(write_cluster(context, oldest_cluster));
+
+    {
+        std::lock_guard<std::mutex> lock(context->pending_cluster_lock);
+        context->pending_bytes -= std::min(oldest_cluster_bytes, context->pending_bytes);
+    }
+    context->pending_space_notify->notify_all();
+
+    return K4A_RESULT_SUCCEEDED;
+}
+
 static void matroska_writer_thread(k4a_record_context_t *context)
 {
     assert(context->writer_notify);
 
+    // The policy is configured through k4a, this library holds its own copy of the threadpolicy module
+    k4a_thread_policy_t policy = {};
+    if (K4A_SUCCEEDED(k4a_get_thread_policy(K4A_SDK_THREAD_RECORD_WRITER, &policy)))
+    {
+        (void)threadpolicy_apply_to_current_thread("record writer", &policy);
+    }
+
     try
     {
         std::unique_lock<std::mutex> lock(context->writer_lock);
@@ -467,53 +1094,20 @@ static void matroska_writer_thread(k4a_record_context_t *context)
 
         while (!context->writer_stopping)
         {
-            context->pending_cluster_lock.lock();
-
-            // Check the oldest pending cluster to see if we should write to disk.
-            cluster_t *oldest_cluster = NULL;
-            if (!context->pending_clusters.empty())
-            {
-                oldest_cluster = context->pending_clusters.front();
-                if (context->most_recent_timestamp >= oldest_cluster->time_end_ns)
-                {
-                    uint64_t age = context->most_recent_timestamp - oldest_cluster->time_end_ns;
-                    if (age > CLUSTER_WRITE_DELAY_NS)
-                    {
-                        assert(oldest_cluster->time_start_ns >= context->last_written_timestamp);
-                        context->pending_clusters.pop_front();
-                        context->last_written_timestamp = oldest_cluster->time_end_ns;
-                        if (age > CLUSTER_WRITE_QUEUE_WARNING_NS)
-                        {
-                            LOG_ERROR("Disk write speed is too low, write queue is filling up.", 0);
-                        }
-                    }
-                    else
-                    {
-                        oldest_cluster = NULL;
-                    }
-                }
-                else
-                {
-                    oldest_cluster = NULL;
-                }
-            }
-
-            context->pending_cluster_lock.unlock();
-
-            if (oldest_cluster)
+            bool written = false;
+            k4a_result_t result = TRACE_CALL(write_pending_cluster(context, &written));
+            if (K4A_FAILED(result))
             {
-                k4a_result_t result = TRACE_CALL(write_cluster(context, oldest_cluster));
-                if (K4A_FAILED(result))
-                {
-                    // write_cluster failures are not recoverable (file IO errors only, the file is likely corrupt)
-                    LOG_ERROR("Cluster write failed, writer thread exiting.", 0);
-                    break;
-                }
+                // write_cluster failures are not recoverable (file IO errors only, the file is likely corrupt)
+                LOG_ERROR("Cluster write failed, writer thread exiting.", 0);
+                break;
             }
 
             // Wait until more clusters arrive up to 100ms, or 1ms if the queue is not empty.
-            context->writer_notify->wait_for(lock, std::chrono::milliseconds(oldest_cluster ? 1 : 100));
+            context->writer_notify->wait_for(lock, std::chrono::milliseconds(written ? 1 : 100));
 
+            // The file changes when the recording moves on to its next segment
+            file_io = dynamic_cast<LargeFileIOCallback *>(context->ebml_file.get());
             if (file_io != NULL)
             {
                 file_io->setOwnerThread();
@@ -531,16 +1125,32 @@ k4a_result_t start_matroska_writer_thread(k4a_record_context_t *context)
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context->writer_thread.joinable());
 
+    if (context->color_codec != K4A_RECORD_COLOR_CODEC_NATIVE)
+    {
+        RETURN_IF_ERROR(start_color_encoder_threads(context));
+    }
+
     try
     {
         context->writer_notify.reset(new std::condition_variable());
+        context->pending_space_notify.reset(new std::condition_variable());
 
         context->writer_stopping = false;
-        context->writer_thread = std::thread(matroska_writer_thread, context);
+        if (context->writer_pool)
+        {
+            // The clusters are written by the threads of the recording group
+            std::lock_guard<std::mutex> lock(context->writer_pool->lock);
+            context->writer_pool->recordings.push_back(context);
+        }
+        else
+        {
+            context->writer_thread = std::thread(matroska_writer_thread, context);
+        }
     }
     catch (std::system_error &e)
     {
         LOG_ERROR("Failed to start recording writer thread: %s", e.what());
+        stop_color_encoder_threads(context);
         return K4A_RESULT_FAILED;
     }
 
@@ -551,18 +1161,241 @@ void stop_matroska_writer_thread(k4a_record_context_t *context)
 {
     RETURN_VALUE_IF_ARG(VOID_VALUE, context == NULL);
     RETURN_VALUE_IF_ARG(VOID_VALUE, context->writer_notify == nullptr);
-    RETURN_VALUE_IF_ARG(VOID_VALUE, !context->writer_thread.joinable());
+    RETURN_VALUE_IF_ARG(VOID_VALUE, !context->writer_pool && !context->writer_thread.joinable());
 
     try
     {
         context->writer_stopping = true;
-        context->writer_notify->notify_one();
-        context->writer_thread.join();
+        if (context->writer_pool)
+        {
+            {
+                std::lock_guard<std::mutex> lock(context->writer_pool->lock);
+                std::vector<k4a_record_context_t *> &recordings = context->writer_pool->recordings;
+                recordings.erase(std::remove(recordings.begin(), recordings.end(), context), recordings.end());
+            }
+
+            {
+                // Wait for a cluster of this recording a pool thread may still be writing
+                std::lock_guard<std::mutex> writer_lock(context->writer_lock);
+            }
+            context->writer_pool.reset();
+        }
+        else
+        {
+            context->writer_notify->notify_one();
+            context->writer_thread.join();
+        }
     }
     catch (std::system_error &e)
     {
         LOG_ERROR("Failed to stop recording writer thread: %s", e.what());
     }
+
+    stop_color_encoder_threads(context);
+}
+
+std::unique_ptr<IOCallback> create_file_writer(const char *path)
+{
+    const char *unbuffered_io = environment_get_variable("K4A_RECORD_UNBUFFERED_IO");
+    if (unbuffered_io != NULL && strcmp(unbuffered_io, "1") == 0)
+    {
+        try
+        {
+            return make_unique<UnbufferedFileIOCallback>(path);
+        }
+        catch (std::ios_base::failure &e)
+        {
+            LOG_WARNING("Unbuffered IO is unavailable for '%s', writing through the page cache: %s", path, e.what());
+        }
+    }
+
+    return make_unique<LargeFileIOCallback>(path, MODE_CREATE);
+}
+
+k4a_result_t write_file_header(k4a_record_context_t *context)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+
+    try
+    {
+        // Make sure we're at the beginning of the file in case we're rewriting a file.
+        context->ebml_file->setFilePointer(0, libebml::seek_beginning);
+
+        { // Render Ebml header
+            EbmlHead file_head;
+
+            GetChild<EDocType>(file_head).SetValue("matroska");
+            GetChild<EDocTypeVersion>(file_head).SetValue(2);
+            GetChild<EDocTypeReadVersion>(file_head).SetValue(2);
+
+            file_head.Render(*context->ebml_file, true);
+        }
+
+        // Recordings can get very large, so pad the length field up to 8 bytes from the start.
+        context->file_segment->WriteHead(*context->ebml_file, 8);
+
+        if (context->streaming)
+        {
+            // Nothing is written back into a streamed recording, so its segment info is written up front
+            auto &segment_info = GetChild<KaxInfo>(*context->file_segment);
+            segment_info.Render(*context->ebml_file);
+        }
+        else
+        { // Write void blocks to reserve space for seeking metadata and the segment info so they can be updated at
+          // the end
+            context->seek_void = make_unique<EbmlVoid>();
+            context->seek_void->SetSize(1024);
+            context->seek_void->Render(*context->ebml_file);
+
+            context->segment_info_void = make_unique<EbmlVoid>();
+            context->segment_info_void->SetSize(256);
+            context->segment_info_void->Render(*context->ebml_file);
+        }
+
+        { // Write tracks
+            auto &tracks = GetChild<KaxTracks>(*context->file_segment);
+            tracks.Render(*context->ebml_file);
+        }
+
+        { // Write attachments
+            auto &attachments = GetChild<KaxAttachments>(*context->file_segment);
+            attachments.Render(*context->ebml_file);
+        }
+
+        { // Write tags with a void block after to make editing easier
+            auto &tags = GetChild<KaxTags>(*context->file_segment);
+            tags.Render(*context->ebml_file);
+
+            if (!context->streaming)
+            {
+                context->tags_void = make_unique<EbmlVoid>();
+                context->tags_void->SetSize(1024);
+                context->tags_void->Render(*context->ebml_file);
+            }
+        }
+
+        if (!context->streaming && context->cues_reserve_bytes > 0)
+        { // Reserve space for the Cues before the first cluster
+            context->cues_void = make_unique<EbmlVoid>();
+            context->cues_void->SetSize(context->cues_reserve_bytes);
+            context->cues_void->Render(*context->ebml_file);
+        }
+    }
+    catch (std::ios_base::failure &e)
+    {
+        LOG_ERROR("Failed to write recording header '%s': %s", context->file_path, e.what());
+        return K4A_RESULT_FAILED;
+    }
+
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t write_file_metadata(k4a_record_context_t *context, uint64_t last_timestamp_ns)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context->streaming);
+
+    try
+    {
+        auto &segment_info = GetChild<KaxInfo>(*context->file_segment);
+
+        uint64_t current_position = context->ebml_file->getFilePointer();
+
+        // Update segment info
+        GetChild<KaxDuration>(segment_info)
+            .SetValue((double)((last_timestamp_ns - context->start_timestamp_offset) / context->timecode_scale));
+        context->segment_info_void->ReplaceWith(segment_info, *context->ebml_file);
+
+        // Render cues into the space reserved for them, or after the clusters once they outgrow it
+        auto &cues = GetChild<KaxCues>(*context->file_segment);
+        if (context->cues_void != nullptr && context->cues_void->ReplaceWith(cues, *context->ebml_file) == 0)
+        {
+            // Clear the Cues of the previous flush out of the reserved space
+            context->ebml_file->setFilePointer((int64_t)context->cues_void->GetElementPosition());
+            context->cues_void->Render(*context->ebml_file);
+            context->cues_void.reset();
+            context->ebml_file->setFilePointer((int64_t)current_position);
+        }
+        if (context->cues_void == nullptr)
+        {
+            cues.Render(*context->ebml_file);
+        }
+
+        // Update tags
+        auto &tags = GetChild<KaxTags>(*context->file_segment);
+        if (tags.GetElementPosition() > 0)
+        {
+            context->ebml_file->setFilePointer((int64_t)tags.GetElementPosition());
+            tags.Render(*context->ebml_file);
+            if (tags.GetEndPosition() != context->tags_void->GetElementPosition())
+            {
+                // Rewrite the void block after tags
+                EbmlVoid tags_void;
+                tags_void.SetSize(context->tags_void->GetSize() -
+                                  (tags.GetEndPosition() - context->tags_void->GetElementPosition()));
+                tags_void.Render(*context->ebml_file);
+            }
+        }
+
+        { // Update seek info
+            auto &seek_head = GetChild<KaxSeekHead>(*context->file_segment);
+            // RemoveAll() has a bug and does not free the elements before emptying the list.
+            for (auto element : seek_head.GetElementList())
+            {
+                delete element;
+            }
+            seek_head.RemoveAll(); // Remove any seek entries from previous flushes
+
+            seek_head.IndexThis(segment_info, *context->file_segment);
+
+            auto &tracks = GetChild<KaxTracks>(*context->file_segment);
+            if (tracks.GetElementPosition() > 0)
+            {
+                seek_head.IndexThis(tracks, *context->file_segment);
+            }
+
+            auto &attachments = GetChild<KaxAttachments>(*context->file_segment);
+            if (attachments.GetElementPosition() > 0)
+            {
+                seek_head.IndexThis(attachments, *context->file_segment);
+            }
+
+            if (tags.GetElementPosition() > 0)
+            {
+                seek_head.IndexThis(tags, *context->file_segment);
+            }
+
+            if (cues.GetElementPosition() > 0)
+            {
+                seek_head.IndexThis(cues, *context->file_segment);
+            }
+
+            context->seek_void->ReplaceWith(seek_head, *context->ebml_file);
+        }
+
+        // Update the file segment head to write the current size
+        context->ebml_file->setFilePointer(0, seek_end);
+        uint64 segment_size = context->ebml_file->getFilePointer() - context->file_segment->GetElementPosition() -
+                              context->file_segment->HeadSize();
+        // Segment size can only be set once normally, so force the flag.
+        context->file_segment->SetSizeInfinite(true);
+        if (!context->file_segment->ForceSize(segment_size))
+        {
+            LOG_ERROR("Failed set file segment size.", 0);
+        }
+        context->file_segment->OverwriteHead(*context->ebml_file);
+
+        // Set the write pointer back in case we're not done recording yet.
+        assert(current_position <= INT64_MAX);
+        context->ebml_file->setFilePointer((int64_t)current_position);
+    }
+    catch (std::ios_base::failure &e)
+    {
+        LOG_ERROR("Failed to write recording '%s': %s", context->file_path, e.what());
+        return K4A_RESULT_FAILED;
+    }
+
+    return K4A_RESULT_SUCCEEDED;
 }
 
 KaxTag *
@@ -0,0 +1,149 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <k4a/k4a.h>
+#include <k4ainternal/matroska_read.h>
+#include <k4ainternal/logging.h>
+
+namespace k4arecord
+{
+static void reader_pool_thread(playback_reader_pool_t *pool)
+{
+    try
+    {
+        std::unique_lock<std::mutex> lock(pool->lock);
+        while (!pool->stopping)
+        {
+            if (pool->tasks.empty())
+            {
+                pool->notify->wait(lock);
+                continue;
+            }
+
+            // The loads are run in the order they were requested, so the recordings of the group take turns
+            std::pair<k4a_playback_context_t *, std::function<void()>> task = std::move(pool->tasks.front());
+            pool->tasks.pop_front();
+            lock.unlock();
+            task.second();
+            lock.lock();
+
+            task.first->pool_reads_pending--;
+            pool->task_done->notify_all();
+        }
+    }
+    catch (std::system_error &e)
+    {
+        LOG_ERROR("Playback group reader thread threw exception: %s", e.what());
+    }
+}
+
+_playback_reader_pool_t::~_playback_reader_pool_t()
+{
+    try
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        if (notify)
+        {
+            notify->notify_all();
+        }
+        for (std::thread &reader : readers)
+        {
+            reader.join();
+        }
+    }
+    catch (std::system_error &e)
+    {
+        LOG_ERROR("Failed to stop playback group reader threads: %s", e.what());
+    }
+}
+
+std::shared_ptr<playback_reader_pool_t> create_reader_pool(uint32_t thread_count)
+{
+    RETURN_VALUE_IF_ARG(nullptr, thread_count == 0);
+
+    std::shared_ptr<playback_reader_pool_t> pool;
+    try
+    {
+        pool = std::make_shared<playback_reader_pool_t>();
+        pool->notify.reset(new std::condition_variable());
+        pool->task_done.reset(new std::condition_variable());
+        for (uint32_t i = 0; i < thread_count; i++)
+        {
+            pool->readers.emplace_back(reader_pool_thread, pool.get());
+        }
+    }
+    catch (std::system_error &e)
+    {
+        // The threads that did start read the recordings of the group
+        if (pool == nullptr || pool->readers.empty())
+        {
+            LOG_ERROR("Failed to start playback group reader threads: %s", e.what());
+            return nullptr;
+        }
+        LOG_WARNING("Failed to start playback group reader thread: %s", e.what());
+    }
+    catch (std::bad_alloc &)
+    {
+        LOG_ERROR("Failed to allocate the playback group reader threads.", 0);
+        return nullptr;
+    }
+
+    return pool;
+}
+
+// Queues a read-ahead load of the playback on its reader pool. Returns false if it couldn't be queued, the caller then
+// runs it some other way.
+bool queue_pool_read(k4a_playback_context_t *context, std::function<void()> task)
+{
+    RETURN_VALUE_IF_ARG(false, context == NULL);
+    RETURN_VALUE_IF_ARG(false, context->reader_pool == nullptr);
+
+    playback_reader_pool_t *pool = context->reader_pool.get();
+    try
+    {
+        std::lock_guard<std::mutex> lock(pool->lock);
+        if (pool->stopping)
+        {
+            return false;
+        }
+        pool->tasks.emplace_back(context, std::move(task));
+        context->pool_reads_pending++;
+    }
+    catch (std::bad_alloc &)
+    {
+        return false;
+    }
+    catch (std::system_error &)
+    {
+        return false;
+    }
+    pool->notify->notify_one();
+    return true;
+}
+
+// Waits for the loads of the playback queued on its reader pool, which use the playback. context->file_closing should
+// be set so the queued loads return right away.
+void wait_for_pool_reads(k4a_playback_context_t *context)
+{
+    RETURN_VALUE_IF_ARG(VOID_VALUE, context == NULL);
+    if (context->reader_pool == nullptr)
+    {
+        return;
+    }
+
+    playback_reader_pool_t *pool = context->reader_pool.get();
+    try
+    {
+        std::unique_lock<std::mutex> lock(pool->lock);
+        pool->task_done->wait(lock, [context]() { return context->pool_reads_pending == 0; });
+    }
+    catch (std::system_error &e)
+    {
+        LOG_ERROR("Failed to wait for the playback group reader threads: %s", e.what());
+    }
+}
+
+} // namespace k4arecord
@@ -0,0 +1,173 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <k4ainternal/matroska_common.h>
+#include <k4ainternal/logging.h>
+
+#include <cstdio>
+#include <cstring>
+
+// The index sidecar stores, in little-endian:
+//   char[8]  magic, "K4AIDX" followed by the 16-bit format version
+//   uint64_t size of the recording the index was written for
+//   uint64_t timecode scale of the recording
+//   uint64_t cluster count
+//   followed by the timestamp_ns, file_offset and cluster_size of each cluster, in file order.
+static const uint8_t recording_index_magic[8] = { 'K', '4', 'A', 'I', 'D', 'X', 0, 1 };
+
+#define RECORDING_INDEX_HEADER_SIZE (sizeof(recording_index_magic) + sizeof(uint64_t) * 3)
+#define RECORDING_INDEX_CLUSTER_SIZE (sizeof(uint64_t) * 3)
+
+namespace k4arecord
+{
+static void write_uint64_le(uint8_t *destination, uint64_t value)
+{
+    write_uint32_le(destination, (uint32_t)value);
+    write_uint32_le(destination + 4, (uint32_t)(value >> 32));
+}
+
+static uint64_t read_uint64_le(const uint8_t *source)
+{
+    return (uint64_t)read_uint32_le(source) | (uint64_t)read_uint32_le(source + 4) << 32;
+}
+
+static bool get_file_size(const char *path, uint64_t *file_size)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file)
+    {
+        return false;
+    }
+    std::streamoff size = file.tellg();
+    if (size < 0)
+    {
+        return false;
+    }
+    *file_size = (uint64_t)size;
+    return true;
+}
+
+k4a_result_t write_recording_index(const char *recording_path,
+                                   uint64_t timecode_scale,
+                                   const std::vector<recording_index_cluster_t> &clusters)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, recording_path == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, clusters.empty());
+
+    uint64_t file_size = 0;
+    if (!get_file_size(recording_path, &file_size))
+    {
+        LOG_ERROR("Unable to get the size of recording '%s' for its index.", recording_path);
+        return K4A_RESULT_FAILED;
+    }
+
+    std::string index_path = std::string(recording_path) + RECORDING_INDEX_EXTENSION;
+    try
+    {
+        std::vector<uint8_t> buffer(RECORDING_INDEX_HEADER_SIZE + clusters.size() * RECORDING_INDEX_CLUSTER_SIZE);
+        uint8_t *position = buffer.data();
+        memcpy(position, recording_index_magic, sizeof(recording_index_magic));
+        position += sizeof(recording_index_magic);
+        write_uint64_le(position, file_size);
+        write_uint64_le(position + 8, timecode_scale);
+        write_uint64_le(position + 16, clusters.size());
+        position += 24;
+        for (const recording_index_cluster_t &cluster : clusters)
+        {
+            write_uint64_le(position, cluster.timestamp_ns);
+            write_uint64_le(position + 8, cluster.file_offset);
+            write_uint64_le(position + 16, cluster.cluster_size);
+            position += RECORDING_INDEX_CLUSTER_SIZE;
+        }
+
+        std::ofstream file;
+        file.exceptions(std::ios::failbit | std::ios::badbit);
+        file.open(index_path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char *>(buffer.data()), (std::streamsize)buffer.size());
+        file.close();
+    }
+    catch (std::ios_base::failure &e)
+    {
+        LOG_ERROR("Failed to write recording index '%s': %s", index_path.c_str(), e.what());
+        // Don't leave a partial index behind
+        std::remove(index_path.c_str());
+        return K4A_RESULT_FAILED;
+    }
+    catch (std::bad_alloc &)
+    {
+        LOG_ERROR("Failed to allocate the recording index of '%s'.", recording_path);
+        return K4A_RESULT_FAILED;
+    }
+
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t read_recording_index(const char *recording_path,
+                                  uint64_t timecode_scale,
+                                  std::vector<recording_index_cluster_t> *clusters)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, recording_path == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, clusters == NULL);
+
+    std::string index_path = std::string(recording_path) + RECORDING_INDEX_EXTENSION;
+    std::ifstream file(index_path, std::ios::binary);
+    if (!file)
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    uint64_t file_size = 0;
+    uint8_t header[RECORDING_INDEX_HEADER_SIZE];
+    if (!file.read(reinterpret_cast<char *>(header), sizeof(header)) ||
+        memcmp(header, recording_index_magic, sizeof(recording_index_magic)) != 0)
+    {
+        LOG_WARNING("Ignoring recording index '%s', the file is not an index.", index_path.c_str());
+        return K4A_RESULT_FAILED;
+    }
+    else if (!get_file_size(recording_path, &file_size) || read_uint64_le(header + 8) != file_size ||
+             read_uint64_le(header + 16) != timecode_scale)
+    {
+        LOG_WARNING("Ignoring recording index '%s', the recording changed since it was written.", index_path.c_str());
+        return K4A_RESULT_FAILED;
+    }
+
+    // Every cluster is at least the size of its entry, a larger count means the index is corrupt
+    uint64_t cluster_count = read_uint64_le(header + 24);
+    if (cluster_count == 0 || cluster_count > file_size / RECORDING_INDEX_CLUSTER_SIZE)
+    {
+        LOG_WARNING("Ignoring recording index '%s', the cluster count is invalid: %llu",
+                    index_path.c_str(),
+                    cluster_count);
+        return K4A_RESULT_FAILED;
+    }
+
+    try
+    {
+        std::vector<uint8_t> buffer((size_t)cluster_count * RECORDING_INDEX_CLUSTER_SIZE);
+        if (!file.read(reinterpret_cast<char *>(buffer.data()), (std::streamsize)buffer.size()))
+        {
+            LOG_WARNING("Ignoring recording index '%s', the file is truncated.", index_path.c_str());
+            return K4A_RESULT_FAILED;
+        }
+
+        clusters->resize((size_t)cluster_count);
+        for (size_t i = 0; i < clusters->size(); i++)
+        {
+            const uint8_t *entry = buffer.data() + i * RECORDING_INDEX_CLUSTER_SIZE;
+            (*clusters)[i].timestamp_ns = read_uint64_le(entry);
+            (*clusters)[i].file_offset = read_uint64_le(entry + 8);
+            (*clusters)[i].cluster_size = read_uint64_le(entry + 16);
+        }
+    }
+    catch (std::bad_alloc &)
+    {
+        LOG_WARNING("Ignoring recording index '%s', failed to allocate %llu clusters.",
+                    index_path.c_str(),
+                    cluster_count);
+        return K4A_RESULT_FAILED;
+    }
+
+    return K4A_RESULT_SUCCEEDED;
+}
+
+} // namespace k4arecord
@@ -0,0 +1,629 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+
+#include <k4a/k4a.h>
+#include <k4ainternal/matroska_read.h>
+#include <k4ainternal/logging.h>
+
+using namespace LIBMATROSKA_NAMESPACE;
+
+namespace k4arecord
+{
+// The trim copies the elements of the recording as raw bytes. Only the element headers of the clusters are parsed:
+// their timecode is rebased, the blocks outside of the trimmed range are left out, and their checksum is recomputed.
+
+// Size of the header of an element in a recording, a 4 byte ID and an 8 byte size at most
+#define MAX_ELEMENT_HEADER_SIZE 12
+
+// Reads the ID and data size of the element at the start of data, returns false if data doesn't hold a valid element
+// header of known size.
+static bool
+read_element_header(const uint8_t *data, size_t size, uint32_t *id, size_t *header_size, uint64_t *data_size)
+{
+    if (size == 0)
+    {
+        return false;
+    }
+
+    size_t id_length = 1;
+    while (id_length <= 4 && (data[0] & (0x80 >> (id_length - 1))) == 0)
+    {
+        id_length++;
+    }
+    if (id_length > 4 || id_length >= size)
+    {
+        return false;
+    }
+    *id = 0;
+    for (size_t i = 0; i < id_length; i++)
+    {
+        *id = *id << 8 | data[i];
+    }
+
+    uint32 size_length = (uint32)std::min(size - id_length, (size_t)8);
+    uint64 size_unknown = 0;
+    *data_size = ReadCodedSizeValue(data + id_length, size_length, size_unknown);
+    if (size_length == 0 || *data_size == size_unknown)
+    {
+        return false;
+    }
+    *header_size = id_length + size_length;
+    return true;
+}
+
+// Appends the header of an element with an 8 byte size, the size of the recording elements written by the SDK
+static void write_element_header(std::vector<uint8_t> &output, uint32_t id, uint64_t data_size)
+{
+    for (int shift = 24; shift >= 0; shift -= 8)
+    {
+        if ((id >> shift) != 0)
+        {
+            output.push_back((uint8_t)(id >> shift));
+        }
+    }
+    output.push_back(0x01);
+    for (int shift = 48; shift >= 0; shift -= 8)
+    {
+        output.push_back((uint8_t)(data_size >> shift));
+    }
+}
+
+// Appends an unsigned integer element
+static void write_uint_element(std::vector<uint8_t> &output, uint32_t id, uint64_t value)
+{
+    uint8_t value_size = 1;
+    while (value_size < 8 && (value >> (value_size * 8)) != 0)
+    {
+        value_size++;
+    }
+    for (int shift = 24; shift >= 0; shift -= 8)
+    {
+        if ((id >> shift) != 0)
+        {
+            output.push_back((uint8_t)(id >> shift));
+        }
+    }
+    output.push_back((uint8_t)(0x80 | value_size));
+    for (int i = value_size - 1; i >= 0; i--)
+    {
+        output.push_back((uint8_t)(value >> (i * 8)));
+    }
+}
+
+// Reads the whole element at offset, relative to the segment of the recording, into buffer.
+static k4a_result_t read_source_element(k4a_playback_context_t *context,
+                                        IOCallback *source,
+                                        uint64_t offset,
+                                        std::vector<uint8_t> &buffer)
+{
+    uint64_t file_offset = context->segment->GetGlobalPosition(offset);
+    assert(file_offset <= INT64_MAX);
+    source->setFilePointer((int64_t)file_offset);
+
+    uint8_t header[MAX_ELEMENT_HEADER_SIZE];
+    uint32 header_read = source->read(header, sizeof(header));
+    uint32_t id = 0;
+    size_t header_size = 0;
+    uint64_t data_size = 0;
+    if (!read_element_header(header, header_read, &id, &header_size, &data_size) ||
+        data_size > SIZE_MAX - header_size)
+    {
+        LOG_ERROR("Invalid element header at: %llu", offset);
+        return K4A_RESULT_FAILED;
+    }
+
+    buffer.resize(header_size + (size_t)data_size);
+    source->setFilePointer((int64_t)file_offset);
+    if (source->read(buffer.data(), buffer.size()) != buffer.size())
+    {
+        LOG_ERROR("Recording ends within the element at: %llu", offset);
+        return K4A_RESULT_FAILED;
+    }
+    return K4A_RESULT_SUCCEEDED;
+}
+
+typedef struct _trim_range_t
+{
+    uint64_t timecode_scale;
+    uint64_t start_ns; // Blocks in [start_ns, end_ns) are kept, relative to the start of the source recording
+    uint64_t end_ns;
+    uint64_t rebase_timecode; // Subtracted from the timecodes, the trimmed recording starts at timecode 0
+
+    uint64_t last_timecode = 0; // The rebased timecode of the last block kept
+    bool past_end = false;      // Set once a cluster starts at or after end_ns
+} trim_range_t;
+
+// Rewrites the cluster to output with the blocks in the trimmed range, output is left empty if none are. cue_track is
+// set to the track of the first block kept.
+static k4a_result_t trim_cluster(trim_range_t *range,
+                                 const std::vector<uint8_t> &cluster,
+                                 std::vector<uint8_t> &output,
+                                 uint64_t *cluster_timecode_out,
+                                 uint64_t *cue_track)
+{
+    uint32_t id = 0;
+    size_t header_size = 0;
+    uint64_t data_size = 0;
+    if (!read_element_header(cluster.data(), cluster.size(), &id, &header_size, &data_size) ||
+        id != KaxCluster::ClassInfos.GlobalId.GetValue())
+    {
+        LOG_ERROR("Invalid cluster header.", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    std::vector<uint8_t> children;
+    children.reserve(cluster.size());
+    bool checksum = false;
+    bool timecode_found = false;
+    uint64_t cluster_timecode = 0;
+    uint64_t new_cluster_timecode = 0;
+    int64_t block_shift = 0; // Added to the block timecodes of a cluster starting before the rebase timecode
+    size_t block_count = 0;
+    *cue_track = 0;
+
+    size_t offset = header_size;
+    while (offset < cluster.size())
+    {
+        uint32_t child_id = 0;
+        size_t child_header_size = 0;
+        uint64_t child_size = 0;
+        if (!read_element_header(
+                &cluster[offset], cluster.size() - offset, &child_id, &child_header_size, &child_size) ||
+            child_size > cluster.size() - offset - child_header_size)
+        {
+            LOG_ERROR("Invalid cluster element header.", 0);
+            return K4A_RESULT_FAILED;
+        }
+        size_t child_end = offset + child_header_size + (size_t)child_size;
+        const uint8_t *child_data = &cluster[offset + child_header_size];
+
+        if (child_id == KaxClusterTimecode::ClassInfos.GlobalId.GetValue())
+        {
+            for (size_t i = 0; i < child_size; i++)
+            {
+                cluster_timecode = cluster_timecode << 8 | child_data[i];
+            }
+            timecode_found = true;
+            if (cluster_timecode * range->timecode_scale >= range->end_ns)
+            {
+                range->past_end = true;
+                break;
+            }
+            if (cluster_timecode >= range->rebase_timecode)
+            {
+                new_cluster_timecode = cluster_timecode - range->rebase_timecode;
+            }
+            else
+            {
+                block_shift = (int64_t)cluster_timecode - (int64_t)range->rebase_timecode;
+            }
+            write_uint_element(children, child_id, new_cluster_timecode);
+        }
+        else if (child_id == KaxSimpleBlock::ClassInfos.GlobalId.GetValue() ||
+                 child_id == KaxBlockGroup::ClassInfos.GlobalId.GetValue())
+        {
+            if (!timecode_found)
+            {
+                LOG_ERROR("Cluster block found before the cluster timecode.", 0);
+                return K4A_RESULT_FAILED;
+            }
+
+            // The header of a block is its track number followed by its timecode relative to the cluster
+            const uint8_t *block_data = child_data;
+            uint64_t block_size = child_size;
+            if (child_id == KaxBlockGroup::ClassInfos.GlobalId.GetValue())
+            {
+                block_data = NULL;
+                const uint8_t *group_end = child_data + child_size;
+                const uint8_t *element = child_data;
+                while (element < group_end)
+                {
+                    uint32_t element_id = 0;
+                    size_t element_header_size = 0;
+                    uint64_t element_size = 0;
+                    if (!read_element_header(element,
+                                             (size_t)(group_end - element),
+                                             &element_id,
+                                             &element_header_size,
+                                             &element_size) ||
+                        element_size > (uint64_t)(group_end - element) - element_header_size)
+                    {
+                        break;
+                    }
+                    if (element_id == KaxBlock::ClassInfos.GlobalId.GetValue())
+                    {
+                        block_data = element + element_header_size;
+                        block_size = element_size;
+                        break;
+                    }
+                    element += element_header_size + element_size;
+                }
+            }
+
+            uint32 track_number_size = (uint32)std::min(block_size, (uint64_t)8);
+            uint64 size_unknown = 0;
+            uint64_t track_number = 0;
+            if (block_data != NULL)
+            {
+                track_number = ReadCodedSizeValue(block_data, track_number_size, size_unknown);
+            }
+            if (block_data == NULL || track_number_size == 0 || track_number_size + 2 > block_size)
+            {
+                LOG_ERROR("Invalid block header in cluster at timecode %llu.", cluster_timecode);
+                return K4A_RESULT_FAILED;
+            }
+            int16_t relative_timecode = (int16_t)((block_data[track_number_size] << 8) |
+                                                  block_data[track_number_size + 1]);
+
+            int64_t timecode = (int64_t)cluster_timecode + relative_timecode;
+            uint64_t timestamp_ns = timecode < 0 ? 0 : (uint64_t)timecode * range->timecode_scale;
+            if (timecode >= 0 && timestamp_ns >= range->start_ns && timestamp_ns < range->end_ns)
+            {
+                size_t block_start = children.size();
+                children.insert(children.end(), &cluster[offset], &cluster[offset] + (child_end - offset));
+                if (block_shift != 0)
+                {
+                    // Kept blocks are past the rebase timecode, so the shifted timecode is between 0 and the original
+                    int64_t shifted_timecode = relative_timecode + block_shift;
+                    assert(shifted_timecode >= 0 && shifted_timecode <= INT16_MAX);
+                    size_t timecode_offset = block_start + (size_t)(block_data - &cluster[offset]) + track_number_size;
+                    children[timecode_offset] = (uint8_t)((uint16_t)shifted_timecode >> 8);
+                    children[timecode_offset + 1] = (uint8_t)shifted_timecode;
+                }
+
+                range->last_timecode = std::max(range->last_timecode, (uint64_t)timecode - range->rebase_timecode);
+                if (block_count++ == 0)
+                {
+                    *cue_track = track_number;
+                }
+            }
+        }
+        else if (child_id == EbmlCrc32::ClassInfos.GlobalId.GetValue())
+        {
+            checksum = true;
+        }
+        else if (child_id != KaxClusterPosition::ClassInfos.GlobalId.GetValue() &&
+                 child_id != KaxClusterPrevSize::ClassInfos.GlobalId.GetValue() &&
+                 child_id != EbmlVoid::ClassInfos.GlobalId.GetValue())
+        {
+            // Positions in the source recording are left out, other elements are copied
+            children.insert(children.end(), &cluster[offset], &cluster[offset] + (child_end - offset));
+        }
+        offset = child_end;
+    }
+
+    output.clear();
+    if (block_count == 0)
+    {
+        return K4A_RESULT_SUCCEEDED;
+    }
+
+    const size_t checksum_size = 6;
+    write_element_header(output, id, children.size() + (checksum ? checksum_size : 0));
+    if (checksum)
+    {
+        EbmlCrc32 crc;
+        crc.FillCRC32(children.data(), (uint32)children.size());
+        output.push_back((uint8_t)EbmlCrc32::ClassInfos.GlobalId.GetValue());
+        output.push_back(0x84);
+        output.resize(output.size() + 4);
+        write_uint32_le(&output[output.size() - 4], crc.GetCrc32());
+    }
+    output.insert(output.end(), children.begin(), children.end());
+    *cluster_timecode_out = new_cluster_timecode;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+// Copies the element at offset in the source recording to the trimmed recording, returning its position in the segment
+// of the trimmed recording.
+static k4a_result_t copy_source_element(k4a_playback_context_t *context,
+                                        IOCallback *source,
+                                        uint64_t offset,
+                                        KaxSegment &segment,
+                                        IOCallback &output,
+                                        std::vector<uint8_t> &buffer,
+                                        uint64_t *position)
+{
+    RETURN_IF_ERROR(read_source_element(context, source, offset, buffer));
+    *position = segment.GetRelativePosition(output.getFilePointer());
+    output.writeFully(buffer.data(), buffer.size());
+    return K4A_RESULT_SUCCEEDED;
+}
+
+static void add_seek_entry(KaxSeekHead &seek_head, const EbmlId &id, uint64_t position)
+{
+    KaxSeek *seek = new KaxSeek();
+    seek_head.PushElement(*seek); // Seek entry will be freed with the seek head.
+
+    binary id_buffer[4];
+    unsigned int id_length = id.GetLength();
+    for (unsigned int i = 0; i < id_length; i++)
+    {
+        id_buffer[i] = (binary)(id.GetValue() >> ((id_length - i - 1) * 8));
+    }
+    GetChild<KaxSeekID>(*seek).CopyBuffer(id_buffer, id_length);
+    GetChild<KaxSeekPosition>(*seek).SetValue(position);
+}
+
+// Sets the K4A_START_OFFSET_NS tag of the trimmed recording, adding it if the source recording has none.
+static void set_start_offset_tag(KaxTags &tags, uint64_t start_offset_ns)
+{
+    std::ostringstream offset_str;
+    offset_str << start_offset_ns;
+
+    KaxTag *tag = NULL;
+    for (EbmlElement *e : tags.GetElementList())
+    {
+        if (check_element_type(e, &tag))
+        {
+            KaxTagSimple &tag_simple = GetChild<KaxTagSimple>(*tag);
+            if (GetChild<KaxTagName>(tag_simple).GetValueUTF8() == "K4A_START_OFFSET_NS")
+            {
+                GetChild<KaxTagString>(tag_simple).SetValueUTF8(offset_str.str());
+                return;
+            }
+        }
+    }
+
+    tag = new KaxTag();
+    tags.PushElement(*tag); // Tag will be freed with the tags.
+    // Force KaxTagTargets element to get rendered since it is a "mandatory" element.
+    GetChild<KaxTagTrackUID>(GetChild<KaxTagTargets>(*tag)).SetValue(0);
+    KaxTagSimple &tag_simple = GetChild<KaxTagSimple>(*tag);
+    GetChild<KaxTagName>(tag_simple).SetValueUTF8("K4A_START_OFFSET_NS");
+    GetChild<KaxTagString>(tag_simple).SetValueUTF8(offset_str.str());
+}
+
+static uint64_t get_start_offset_ns(k4a_playback_context_t *context)
+{
+    KaxTag *start_offset_tag = get_tag(context, "K4A_START_OFFSET_NS");
+    uint64_t start_offset_ns = 0;
+    if (start_offset_tag != NULL)
+    {
+        std::istringstream start_offset_str(get_tag_string(start_offset_tag));
+        start_offset_str >> start_offset_ns;
+        if (start_offset_str.fail())
+        {
+            start_offset_ns = (uint64_t)context->record_config.start_timestamp_offset_usec * 1000;
+        }
+    }
+    return start_offset_ns;
+}
+
+// Writes the clusters of the source recording from cluster_info on to the trimmed recording, adding their Cue entries.
+static k4a_result_t write_trimmed_clusters(k4a_playback_context_t *context,
+                                           cluster_reader_t *reader,
+                                           cluster_info_t *cluster_info,
+                                           trim_range_t *range,
+                                           KaxSegment &segment,
+                                           IOCallback &output,
+                                           KaxCues &cues,
+                                           size_t *cluster_count)
+{
+    std::vector<uint8_t> source_cluster;
+    std::vector<uint8_t> trimmed_cluster;
+    bool cue_added = false;
+    uint64_t last_cue_ns = 0;
+
+    *cluster_count = 0;
+    while (cluster_info != NULL && !range->past_end)
+    {
+        IOCallback *source = reader->ebml_file.get();
+        RETURN_IF_ERROR(read_source_element(context, source, cluster_info->file_offset, source_cluster));
+
+        uint64_t cluster_timecode = 0;
+        uint64_t cue_track = 0;
+        RETURN_IF_ERROR(trim_cluster(range, source_cluster, trimmed_cluster, &cluster_timecode, &cue_track));
+        if (!trimmed_cluster.empty())
+        {
+            uint64_t position = segment.GetRelativePosition(output.getFilePointer());
+            output.writeFully(trimmed_cluster.data(), trimmed_cluster.size());
+            (*cluster_count)++;
+
+            // Cue entries are added at a maximum rate of CUE_ENTRY_GAP_NS, like the recordings written by the SDK
+            uint64_t cluster_ns = cluster_timecode * range->timecode_scale;
+            if (!cue_added || cluster_ns >= last_cue_ns + CUE_ENTRY_GAP_NS)
+            {
+                KaxCuePoint *cue_point = new KaxCuePoint();
+                cues.PushElement(*cue_point); // Cue point will be freed with the cues.
+                GetChild<KaxCueTime>(*cue_point).SetValue(cluster_timecode);
+                KaxCueTrackPositions &positions = GetChild<KaxCueTrackPositions>(*cue_point);
+                GetChild<KaxCueTrack>(positions).SetValue(cue_track);
+                GetChild<KaxCueClusterPosition>(positions).SetValue(position);
+                cue_added = true;
+                last_cue_ns = cluster_ns;
+            }
+        }
+
+        cluster_info = next_cluster(context, cluster_info, true);
+    }
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t write_trimmed_recording(k4a_playback_context_t *context,
+                                     const char *path,
+                                     uint64_t start_timestamp_usec,
+                                     uint64_t end_timestamp_usec)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context->segment == nullptr);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context->tracks == nullptr);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, path == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, start_timestamp_usec >= end_timestamp_usec);
+
+    if (context->forward_only)
+    {
+        LOG_ERROR("Recordings read in order through callbacks or the network can't be trimmed.", 0);
+        return K4A_RESULT_FAILED;
+    }
+    if (context->file_path != NULL && strcmp(context->file_path, path) == 0)
+    {
+        LOG_ERROR("The trimmed recording can't be written over its source: %s", path);
+        return K4A_RESULT_FAILED;
+    }
+
+    // The range is converted to timestamps relative to the start of the source recording
+    uint64_t start_offset_usec = (uint64_t)context->record_config.start_timestamp_offset_usec;
+    trim_range_t range;
+    range.timecode_scale = context->timecode_scale;
+    range.start_ns = start_timestamp_usec > start_offset_usec ? (start_timestamp_usec - start_offset_usec) * 1000 : 0;
+    if (end_timestamp_usec <= start_offset_usec)
+    {
+        LOG_ERROR("The trimmed range ends before the start of the recording: %llu usec", end_timestamp_usec);
+        return K4A_RESULT_FAILED;
+    }
+    range.end_ns = end_timestamp_usec - start_offset_usec > UINT64_MAX / 1000 ?
+                       UINT64_MAX :
+                       (end_timestamp_usec - start_offset_usec) * 1000;
+    range.rebase_timecode = range.start_ns / range.timecode_scale;
+
+    cluster_info_t *cluster_info = find_cluster(context, range.start_ns);
+    if (cluster_info == NULL)
+    {
+        LOG_ERROR("Failed to find the cluster of timestamp: %llu", range.start_ns);
+        return K4A_RESULT_FAILED;
+    }
+    // Blocks of the previous cluster may still be past the start timestamp
+    cluster_info_t *previous_cluster_info = next_cluster(context, cluster_info, false);
+    if (previous_cluster_info != NULL)
+    {
+        cluster_info = previous_cluster_info;
+    }
+
+    // The source is read with a file handle of its own, the playback position and cluster cache don't change
+    std::unique_ptr<cluster_reader_t> reader = open_cluster_reader(context);
+    if (reader == nullptr)
+    {
+        LOG_ERROR("Failed to open a second handle on the recording to trim it.", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    k4a_result_t result = K4A_RESULT_SUCCEEDED;
+    bool output_created = false;
+    try
+    {
+        LargeFileIOCallback output(path, MODE_CREATE);
+        output_created = true;
+
+        { // Render Ebml header
+            EbmlHead file_head;
+
+            GetChild<EDocType>(file_head).SetValue("matroska");
+            GetChild<EDocTypeVersion>(file_head).SetValue(2);
+            GetChild<EDocTypeReadVersion>(file_head).SetValue(2);
+
+            file_head.Render(output, true);
+        }
+
+        KaxSegment segment;
+        segment.WriteHead(output, 8);
+
+        // The seeking metadata and the segment info are written once the clusters are
+        EbmlVoid seek_void;
+        seek_void.SetSize(1024);
+        seek_void.Render(output);
+
+        EbmlVoid segment_info_void;
+        segment_info_void.SetSize(std::max<uint64_t>(256,
+                                                     context->segment_info->HeadSize() +
+                                                         context->segment_info->GetSize() + 64));
+        segment_info_void.Render(output);
+
+        std::vector<uint8_t> buffer;
+        uint64_t tracks_position = 0;
+        result = TRACE_CALL(copy_source_element(
+            context, reader->ebml_file.get(), context->tracks_offset, segment, output, buffer, &tracks_position));
+
+        uint64_t attachments_position = 0;
+        if (K4A_SUCCEEDED(result) && context->attachments)
+        {
+            result = TRACE_CALL(copy_source_element(context,
+                                                    reader->ebml_file.get(),
+                                                    context->attachments_offset,
+                                                    segment,
+                                                    output,
+                                                    buffer,
+                                                    &attachments_position));
+        }
+
+        // The timestamps of the trimmed recording are rebased, the start offset keeps the device timestamps unchanged
+        std::unique_ptr<KaxTags> tags(context->tags ? static_cast<KaxTags *>(context->tags->Clone()) : new KaxTags());
+        set_start_offset_tag(*tags, get_start_offset_ns(context) + range.rebase_timecode * range.timecode_scale);
+        uint64_t tags_position = segment.GetRelativePosition(output.getFilePointer());
+        tags->Render(output);
+
+        KaxCues cues;
+        size_t cluster_count = 0;
+        if (K4A_SUCCEEDED(result))
+        {
+            result = TRACE_CALL(write_trimmed_clusters(
+                context, reader.get(), cluster_info, &range, segment, output, cues, &cluster_count));
+        }
+        if (K4A_SUCCEEDED(result) && cluster_count == 0)
+        {
+            LOG_ERROR("The recording has no data between %llu usec and %llu usec.",
+                      start_timestamp_usec,
+                      end_timestamp_usec);
+            result = K4A_RESULT_FAILED;
+        }
+
+        if (K4A_SUCCEEDED(result))
+        {
+            uint64_t cues_position = segment.GetRelativePosition(output.getFilePointer());
+            cues.Render(output);
+
+            std::unique_ptr<KaxInfo> segment_info(static_cast<KaxInfo *>(context->segment_info->Clone()));
+            GetChild<KaxDuration>(*segment_info).SetValue((double)range.last_timecode);
+            uint64_t segment_info_position = segment.GetRelativePosition(segment_info_void.GetElementPosition());
+            segment_info_void.ReplaceWith(*segment_info, output);
+
+            KaxSeekHead seek_head;
+            add_seek_entry(seek_head, KaxInfo::ClassInfos.GlobalId, segment_info_position);
+            add_seek_entry(seek_head, KaxTracks::ClassInfos.GlobalId, tracks_position);
+            if (context->attachments)
+            {
+                add_seek_entry(seek_head, KaxAttachments::ClassInfos.GlobalId, attachments_position);
+            }
+            add_seek_entry(seek_head, KaxTags::ClassInfos.GlobalId, tags_position);
+            add_seek_entry(seek_head, KaxCues::ClassInfos.GlobalId, cues_position);
+            seek_void.ReplaceWith(seek_head, output);
+
+            // Update the file segment head to write the final size
+            output.setFilePointer(0, seek_end);
+            uint64 segment_size = output.getFilePointer() - segment.GetElementPosition() - segment.HeadSize();
+            // Segment size can only be set once normally, so force the flag.
+            segment.SetSizeInfinite(true);
+            if (!segment.ForceSize(segment_size))
+            {
+                LOG_ERROR("Failed set file segment size.", 0);
+                result = K4A_RESULT_FAILED;
+            }
+            segment.OverwriteHead(output);
+        }
+
+        output.close();
+    }
+    catch (std::ios_base::failure &e)
+    {
+        LOG_ERROR("Failed to write trimmed recording '%s': %s", path, e.what());
+        result = K4A_RESULT_FAILED;
+    }
+    catch (std::bad_alloc &)
+    {
+        LOG_ERROR("Failed to allocate the elements of the trimmed recording.", 0);
+        result = K4A_RESULT_FAILED;
+    }
+
+    if (K4A_FAILED(result) && output_created)
+    {
+        (void)std::remove(path);
+    }
+    return result;
+}
+
+} // namespace k4arecord
@@ -0,0 +1,110 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <sstream>
+
+#include <k4a/k4a.h>
+#include <k4ainternal/matroska_write.h>
+#include <k4ainternal/logging.h>
+
+using namespace LIBMATROSKA_NAMESPACE;
+
+namespace k4arecord
+{
+// Each segment of a recording is a complete recording written from the same KaxSegment: the tracks, attachments and
+// tags are rendered again at the start of each file, and the Cues are emptied between files. The segments keep the
+// start offset of the first one, so the timestamps of a segment continue where the previous one ended.
+
+// Lock(context->writer_lock) should be active when calling this function
+bool segment_limit_reached(k4a_record_context_t *context, uint64_t cluster_start_ns)
+{
+    RETURN_VALUE_IF_ARG(false, context == NULL);
+
+    if (context->segment_empty)
+    {
+        // A segment holds at least one cluster
+        return false;
+    }
+    else if (context->max_segment_ns > 0 && cluster_start_ns - context->segment_start_ns >= context->max_segment_ns)
+    {
+        return true;
+    }
+    return context->max_segment_bytes > 0 && context->ebml_file->getFilePointer() >= context->max_segment_bytes;
+}
+
+// Finishes the current segment file and writes the header of the next one. Lock(context->writer_lock) should be active
+// when calling this function.
+k4a_result_t start_next_segment(k4a_record_context_t *context)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context->streaming);
+
+    std::string next_path;
+    std::unique_ptr<IOCallback> next_file;
+    try
+    {
+        next_path = get_segment_path(context->base_path.c_str(), context->segment_index + 1);
+        next_file = create_file_writer(next_path.c_str());
+    }
+    catch (std::ios_base::failure &e)
+    {
+        // The current segment is still open, the recording goes on in it rather than losing data
+        LOG_ERROR("Unable to open segment '%s', the recording continues in '%s': %s",
+                  next_path.c_str(),
+                  context->file_path,
+                  e.what());
+        context->max_segment_ns = 0;
+        context->max_segment_bytes = 0;
+        return K4A_RESULT_SUCCEEDED;
+    }
+    catch (std::bad_alloc &)
+    {
+        LOG_ERROR("Failed to allocate the writer of the next segment.", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    RETURN_IF_ERROR(write_file_metadata(context, context->segment_last_timestamp_ns));
+    try
+    {
+        context->ebml_file->close();
+    }
+    catch (std::ios_base::failure &e)
+    {
+        LOG_ERROR("Failed to close segment '%s': %s", context->file_path, e.what());
+        return K4A_RESULT_FAILED;
+    }
+
+    if (context->write_recording_index && !context->index_clusters.empty())
+    {
+        (void)TRACE_CALL(write_recording_index(context->file_path, context->timecode_scale, context->index_clusters));
+    }
+    context->index_clusters.clear();
+
+    context->segment_index++;
+    context->segment_path = next_path;
+    context->file_path = context->segment_path.c_str();
+    context->ebml_file = std::move(next_file);
+    context->segment_empty = true;
+
+    // The Cue entries point into the previous segment
+    auto &cues = GetChild<KaxCues>(*context->file_segment);
+    // RemoveAll() has a bug and does not free the elements before emptying the list.
+    for (auto element : cues.GetElementList())
+    {
+        delete element;
+    }
+    cues.RemoveAll();
+    context->last_cues_entry_ns = 0;
+
+    if (context->segment_index_tag != nullptr)
+    {
+        std::ostringstream index_str;
+        index_str << context->segment_index;
+        GetChild<KaxTagString>(GetChild<KaxTagSimple>(*context->segment_index_tag)).SetValueUTF8(index_str.str());
+    }
+
+    LOG_INFO("Recording continues in segment '%s'", context->file_path);
+    return write_file_header(context);
+}
+
+} // namespace k4arecord
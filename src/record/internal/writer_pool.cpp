@@ -0,0 +1,126 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <k4a/k4a.h>
+#include <k4ainternal/matroska_write.h>
+#include <k4ainternal/logging.h>
+#include <k4ainternal/threadpolicy.h>
+
+using namespace LIBMATROSKA_NAMESPACE;
+
+namespace k4arecord
+{
+static void writer_pool_thread(record_writer_pool_t *pool)
+{
+    // The policy is configured through k4a, this library holds its own copy of the threadpolicy module
+    k4a_thread_policy_t policy = {};
+    if (K4A_SUCCEEDED(k4a_get_thread_policy(K4A_SDK_THREAD_RECORD_WRITER, &policy)))
+    {
+        (void)threadpolicy_apply_to_current_thread("record writer", &policy);
+    }
+
+    try
+    {
+        std::unique_lock<std::mutex> lock(pool->lock);
+        while (!pool->stopping)
+        {
+            // Write one cluster of the next recording that has one due, so a recording with a long queue doesn't hold
+            // up the others. Recordings written by another pool thread, or being flushed, are skipped.
+            bool written = false;
+            for (size_t i = 0; i < pool->recordings.size() && !written; i++)
+            {
+                pool->next_recording = (pool->next_recording + 1) % pool->recordings.size();
+                k4a_record_context_t *context = pool->recordings[pool->next_recording];
+                std::unique_lock<std::mutex> writer_lock(context->writer_lock, std::try_to_lock);
+                if (!writer_lock.owns_lock())
+                {
+                    continue;
+                }
+
+                lock.unlock();
+                LargeFileIOCallback *file_io = dynamic_cast<LargeFileIOCallback *>(context->ebml_file.get());
+                if (file_io != NULL)
+                {
+                    file_io->setOwnerThread();
+                }
+                k4a_result_t result = TRACE_CALL(write_pending_cluster(context, &written));
+                lock.lock();
+
+                if (K4A_FAILED(result))
+                {
+                    // write_cluster failures are not recoverable (file IO errors only, the file is likely corrupt)
+                    LOG_ERROR("Cluster write of '%s' failed, it is no longer written.", context->file_path);
+                    pool->recordings.erase(pool->recordings.begin() + (std::ptrdiff_t)pool->next_recording);
+                }
+            }
+
+            // Wait until more clusters arrive up to 100ms, or go around again if a cluster was written.
+            if (!written)
+            {
+                pool->notify->wait_for(lock, std::chrono::milliseconds(100));
+            }
+        }
+    }
+    catch (std::system_error &e)
+    {
+        LOG_ERROR("Recording group writer thread threw exception: %s", e.what());
+    }
+}
+
+_record_writer_pool_t::~_record_writer_pool_t()
+{
+    try
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        if (notify)
+        {
+            notify->notify_all();
+        }
+        for (std::thread &writer : writers)
+        {
+            writer.join();
+        }
+    }
+    catch (std::system_error &e)
+    {
+        LOG_ERROR("Failed to stop recording group writer threads: %s", e.what());
+    }
+}
+
+std::shared_ptr<record_writer_pool_t> create_writer_pool(uint32_t thread_count)
+{
+    RETURN_VALUE_IF_ARG(nullptr, thread_count == 0);
+
+    std::shared_ptr<record_writer_pool_t> pool;
+    try
+    {
+        pool = std::make_shared<record_writer_pool_t>();
+        pool->notify.reset(new std::condition_variable());
+        for (uint32_t i = 0; i < thread_count; i++)
+        {
+            pool->writers.emplace_back(writer_pool_thread, pool.get());
+        }
+    }
+    catch (std::system_error &e)
+    {
+        // The threads that did start write the recordings of the group
+        if (pool == nullptr || pool->writers.empty())
+        {
+            LOG_ERROR("Failed to start recording group writer threads: %s", e.what());
+            return nullptr;
+        }
+        LOG_WARNING("Failed to start recording group writer thread: %s", e.what());
+    }
+    catch (std::bad_alloc &)
+    {
+        LOG_ERROR("Failed to allocate the recording group writer threads.", 0);
+        return nullptr;
+    }
+
+    return pool;
+}
+
+} // namespace k4arecord
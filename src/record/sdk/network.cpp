@@ -0,0 +1,284 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// Streams recordings over TCP. The server writes a recording through k4a_record_create_callbacks() to the socket of a
+// client, and the client reads it with k4a_playback_open_callbacks() as a forward-only recording, so the captures, IMU
+// samples and calibration of the remote device are sent in the same Matroska format and codecs as a recording file.
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <string>
+
+#include <k4a/k4a.h>
+#include <k4arecord/record.h>
+#include <k4arecord/playback.h>
+#include <k4ainternal/logging.h>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+
+typedef SOCKET network_socket_t;
+#define NETWORK_INVALID_SOCKET INVALID_SOCKET
+#define NETWORK_SEND_FLAGS 0
+#define network_close_socket closesocket
+#else
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+typedef int network_socket_t;
+#define NETWORK_INVALID_SOCKET (-1)
+// Report a closed connection as an error of the write instead of raising SIGPIPE
+#define NETWORK_SEND_FLAGS MSG_NOSIGNAL
+#define network_close_socket close
+#endif
+
+typedef struct _network_connection_t
+{
+    network_socket_t socket;
+} network_connection_t;
+
+static bool network_startup()
+{
+#ifdef _WIN32
+    WSADATA wsa_data;
+    int error = WSAStartup(MAKEWORD(2, 2), &wsa_data);
+    if (error != 0)
+    {
+        LOG_ERROR("Failed to start Winsock: %d", error);
+        return false;
+    }
+#endif
+    return true;
+}
+
+static void network_cleanup()
+{
+#ifdef _WIN32
+    (void)WSACleanup();
+#endif
+}
+
+// Creates the connection of a socket, or closes the socket if that fails
+static network_connection_t *create_connection(network_socket_t socket)
+{
+    network_connection_t *connection = new (std::nothrow) network_connection_t();
+    if (connection == NULL)
+    {
+        LOG_ERROR("Failed to allocate the network connection.", 0);
+        network_close_socket(socket);
+        network_cleanup();
+        return NULL;
+    }
+
+    // Clusters are written whole, don't hold back their last segment
+    int no_delay = 1;
+    (void)setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char *>(&no_delay), sizeof(no_delay));
+
+    connection->socket = socket;
+    return connection;
+}
+
+static void close_connection(void *context)
+{
+    network_connection_t *connection = static_cast<network_connection_t *>(context);
+    network_close_socket(connection->socket);
+    delete connection;
+    network_cleanup();
+}
+
+static int64_t write_connection(void *context, const void *buffer, size_t size)
+{
+    network_connection_t *connection = static_cast<network_connection_t *>(context);
+    const char *data = static_cast<const char *>(buffer);
+    size_t sent = 0;
+    while (sent < size)
+    {
+        // Blocks the writer thread of the recording when the client reads slower than the recording is written
+        int chunk = (int)std::min(size - sent, (size_t)INT32_MAX);
+        int count = send(connection->socket, data + sent, chunk, NETWORK_SEND_FLAGS);
+        if (count <= 0)
+        {
+            LOG_ERROR("Failed to send the recording to the client.", 0);
+            return -1;
+        }
+        sent += (size_t)count;
+    }
+    return (int64_t)size;
+}
+
+static int64_t read_connection(void *context, uint64_t offset, void *buffer, size_t size)
+{
+    (void)offset; // Forward-only, offset always follows the previous read
+    network_connection_t *connection = static_cast<network_connection_t *>(context);
+    int chunk = (int)std::min(size, (size_t)INT32_MAX);
+    int count = recv(connection->socket, static_cast<char *>(buffer), chunk, 0);
+    if (count < 0)
+    {
+        LOG_ERROR("Failed to receive the recording from the server.", 0);
+        return -1;
+    }
+    return count;
+}
+
+// Waits on port for a client to connect, and returns its socket
+static network_socket_t accept_client(uint16_t port)
+{
+    struct addrinfo hints = {};
+    hints.ai_family = AF_INET6;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+
+    struct addrinfo *addresses = NULL;
+    std::string port_str = std::to_string(port);
+    if (getaddrinfo(NULL, port_str.c_str(), &hints, &addresses) != 0 || addresses == NULL)
+    {
+        // No IPv6 on this machine, listen on IPv4 only
+        hints.ai_family = AF_INET;
+        if (getaddrinfo(NULL, port_str.c_str(), &hints, &addresses) != 0 || addresses == NULL)
+        {
+            LOG_ERROR("Failed to resolve the address to listen on port %u.", port);
+            return NETWORK_INVALID_SOCKET;
+        }
+    }
+
+    network_socket_t listener = socket(addresses->ai_family, addresses->ai_socktype, addresses->ai_protocol);
+    if (listener == NETWORK_INVALID_SOCKET)
+    {
+        LOG_ERROR("Failed to create the socket to listen on port %u.", port);
+        freeaddrinfo(addresses);
+        return NETWORK_INVALID_SOCKET;
+    }
+
+    int option = 1;
+    (void)setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char *>(&option), sizeof(option));
+    if (addresses->ai_family == AF_INET6)
+    {
+        // Take IPv4 clients on the same socket
+        option = 0;
+        (void)setsockopt(listener, IPPROTO_IPV6, IPV6_V6ONLY, reinterpret_cast<const char *>(&option), sizeof(option));
+    }
+
+    bool listening = bind(listener, addresses->ai_addr, (int)addresses->ai_addrlen) == 0 && listen(listener, 1) == 0;
+    freeaddrinfo(addresses);
+    if (!listening)
+    {
+        LOG_ERROR("Failed to listen on port %u.", port);
+        network_close_socket(listener);
+        return NETWORK_INVALID_SOCKET;
+    }
+
+    LOG_INFO("Waiting for a client on port %u.", port);
+    network_socket_t client = accept(listener, NULL, NULL);
+    network_close_socket(listener);
+    if (client == NETWORK_INVALID_SOCKET)
+    {
+        LOG_ERROR("Failed to accept a client on port %u.", port);
+    }
+    return client;
+}
+
+// Connects to the server at host and port, and returns the socket
+static network_socket_t connect_server(const char *host, uint16_t port)
+{
+    struct addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    struct addrinfo *addresses = NULL;
+    if (getaddrinfo(host, std::to_string(port).c_str(), &hints, &addresses) != 0)
+    {
+        LOG_ERROR("Failed to resolve '%s'.", host);
+        return NETWORK_INVALID_SOCKET;
+    }
+
+    network_socket_t server = NETWORK_INVALID_SOCKET;
+    for (struct addrinfo *address = addresses; address != NULL && server == NETWORK_INVALID_SOCKET;
+         address = address->ai_next)
+    {
+        server = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (server != NETWORK_INVALID_SOCKET && connect(server, address->ai_addr, (int)address->ai_addrlen) != 0)
+        {
+            network_close_socket(server);
+            server = NETWORK_INVALID_SOCKET;
+        }
+    }
+    freeaddrinfo(addresses);
+
+    if (server == NETWORK_INVALID_SOCKET)
+    {
+        LOG_ERROR("Failed to connect to '%s' on port %u.", host, port);
+    }
+    return server;
+}
+
+k4a_result_t k4a_record_create_network(uint16_t port,
+                                       k4a_device_t device,
+                                       const k4a_device_configuration_t device_config,
+                                       k4a_record_t *recording_handle)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, recording_handle == NULL);
+
+    if (!network_startup())
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    network_socket_t client = accept_client(port);
+    if (client == NETWORK_INVALID_SOCKET)
+    {
+        network_cleanup();
+        return K4A_RESULT_FAILED;
+    }
+
+    network_connection_t *connection = create_connection(client);
+    if (connection == NULL)
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    k4a_record_io_callbacks_t callbacks = {};
+    callbacks.context = connection;
+    callbacks.write = write_connection;
+    callbacks.close = close_connection;
+
+    // The connection is closed by the recording, or by this call if it fails
+    return TRACE_CALL(k4a_record_create_callbacks(&callbacks, device, device_config, recording_handle));
+}
+
+k4a_result_t k4a_playback_open_network(const char *host, uint16_t port, k4a_playback_t *playback_handle)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, host == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, playback_handle == NULL);
+
+    if (!network_startup())
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    network_socket_t server = connect_server(host, port);
+    if (server == NETWORK_INVALID_SOCKET)
+    {
+        network_cleanup();
+        return K4A_RESULT_FAILED;
+    }
+
+    network_connection_t *connection = create_connection(server);
+    if (connection == NULL)
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    k4a_playback_io_callbacks_t callbacks = {};
+    callbacks.context = connection;
+    callbacks.read = read_connection;
+    callbacks.close = close_connection;
+    callbacks.forward_only = true;
+
+    // The connection is closed by the playback, or by this call if it fails
+    return TRACE_CALL(k4a_playback_open_callbacks(&callbacks, playback_handle));
+}
@@ -1,6 +1,8 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <algorithm>
+#include <cstring>
 #include <ctime>
 #include <iostream>
 #include <sstream>
@@ -9,13 +11,117 @@
 #include <k4arecord/playback.h>
 #include <k4ainternal/matroska_read.h>
 #include <k4ainternal/common.h>
+#include <azure_c_shared_utility/envvariable.h>
 
 using namespace k4arecord;
 using namespace LIBMATROSKA_NAMESPACE;
 
+// Populates the cluster cache of a playback and seeks to the start of the recording, if it isn't done yet. Playbacks
+// opened with K4A_PLAYBACK_OPEN_HEADER_ONLY only have the header of the recording until this is called.
+static k4a_result_t load_playback_clusters(k4a_playback_context_t *context)
+{
+    if (context->clusters_loaded)
+    {
+        return K4A_RESULT_SUCCEEDED;
+    }
+    else if (context->cluster_cache != nullptr)
+    {
+        LOG_ERROR("Failed to read the clusters of the recording earlier.", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    RETURN_IF_ERROR(parse_clusters(context));
+
+    if (context->io_source == nullptr && context->cues == nullptr && !context->cluster_cache_indexed)
+    {
+        // Without Cues, parse_clusters() searched the whole file for its clusters. Save them for the next open.
+        const char *recording_index = environment_get_variable("K4A_RECORDING_INDEX");
+        if (recording_index != NULL && strcmp(recording_index, "1") == 0)
+        {
+            (void)TRACE_CALL(write_cluster_cache_index(context));
+        }
+    }
+
+    // Seek to the first cluster
+    cluster_info_t *seek_cluster_info = find_cluster(context, 0);
+    if (seek_cluster_info == NULL)
+    {
+        LOG_ERROR("Failed to parse recording, recording is empty.", 0);
+        return K4A_RESULT_FAILED;
+    }
+    context->seek_cluster = load_cluster(context, seek_cluster_info);
+    if (context->seek_cluster == nullptr)
+    {
+        LOG_ERROR("Failed to load first data cluster of recording.", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    reset_seek_pointers(context, 0);
+    context->clusters_loaded = true;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+// Parses the recording of a playback that was just created and seeks to its start, or destroys the playback if this
+// or the earlier steps of opening it failed. With header_only, the clusters are left for load_playback_clusters().
+// Creates the pool the blocks of the playback are allocated from. Without it new_block_info() allocates each block.
+static void create_block_pool(k4a_playback_context_t *context)
+{
+    try
+    {
+        context->block_pool = std::make_shared<block_info_pool_t>();
+    }
+    catch (std::bad_alloc &)
+    {
+        LOG_WARNING("Failed to allocate the block pool of the recording.", 0);
+    }
+}
+
+static k4a_result_t finish_playback_open(k4a_playback_context_t *context,
+                                         k4a_result_t result,
+                                         k4a_playback_t *playback_handle,
+                                         bool header_only = false)
+{
+    if (K4A_SUCCEEDED(result))
+    {
+        create_block_pool(context);
+        result = TRACE_CALL(parse_mkv(context));
+    }
+
+    if (K4A_SUCCEEDED(result) && !header_only)
+    {
+        result = TRACE_CALL(load_playback_clusters(context));
+    }
+
+    if (K4A_FAILED(result))
+    {
+        if (context && context->ebml_file)
+        {
+            try
+            {
+                context->ebml_file->close();
+            }
+            catch (std::ios_base::failure &)
+            {
+                // The file was opened as read-only, ignore any close failures.
+            }
+        }
+
+        k4a_playback_t_destroy(*playback_handle);
+        *playback_handle = NULL;
+    }
+
+    return result;
+}
+
 k4a_result_t k4a_playback_open(const char *path, k4a_playback_t *playback_handle)
+{
+    return k4a_playback_open_ex(path, K4A_PLAYBACK_OPEN_DEFAULT, playback_handle);
+}
+
+k4a_result_t k4a_playback_open_ex(const char *path, uint32_t flags, k4a_playback_t *playback_handle)
 {
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, path == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, (flags & ~(uint32_t)K4A_PLAYBACK_OPEN_HEADER_ONLY) != 0);
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, playback_handle == NULL);
     k4a_playback_context_t *context = NULL;
     k4a_result_t result = K4A_RESULT_SUCCEEDED;
@@ -27,10 +133,29 @@ k4a_result_t k4a_playback_open(const char *path, k4a_playback_t *playback_handle
     {
         context->file_path = path;
         context->file_closing = false;
+        context->read_ahead_count = CLUSTER_READ_AHEAD_COUNT;
 
         try
         {
-            context->ebml_file = make_unique<LargeFileIOCallback>(path, MODE_READ);
+            const char *mapped_io = environment_get_variable("K4A_PLAYBACK_MAPPED_IO");
+            if (mapped_io != NULL && strcmp(mapped_io, "1") == 0)
+            {
+                try
+                {
+                    std::unique_ptr<MappedFileIOCallback> mapped_file = make_unique<MappedFileIOCallback>(path);
+                    context->file_mapping = mapped_file->getMapping();
+                    context->ebml_file = std::move(mapped_file);
+                }
+                catch (std::ios_base::failure &e)
+                {
+                    LOG_WARNING("Unable to map '%s', reading it through file IO: %s", path, e.what());
+                }
+            }
+
+            if (context->ebml_file == nullptr)
+            {
+                context->ebml_file = make_unique<LargeFileIOCallback>(path, MODE_READ);
+            }
             context->stream = make_unique<libebml::EbmlStream>(*context->ebml_file);
         }
         catch (std::ios_base::failure &e)
@@ -40,34 +165,169 @@ k4a_result_t k4a_playback_open(const char *path, k4a_playback_t *playback_handle
         }
     }
 
-    if (K4A_SUCCEEDED(result))
-    {
-        result = TRACE_CALL(parse_mkv(context));
-    }
+    return finish_playback_open(context, result, playback_handle, (flags & K4A_PLAYBACK_OPEN_HEADER_ONLY) != 0);
+}
+
+k4a_result_t k4a_playback_open_callbacks(const k4a_playback_io_callbacks_t *callbacks, k4a_playback_t *playback_handle)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, callbacks == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, callbacks->read == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, playback_handle == NULL);
+    k4a_playback_context_t *context = NULL;
+    k4a_result_t result = K4A_RESULT_SUCCEEDED;
+
+    context = k4a_playback_t_create(playback_handle);
+    result = K4A_RESULT_FROM_BOOL(context != NULL);
 
     if (K4A_SUCCEEDED(result))
     {
-        // Seek to the first cluster
-        cluster_info_t *seek_cluster_info = find_cluster(context, 0);
-        if (seek_cluster_info == NULL)
+        context->file_path = "<I/O callbacks>";
+        context->file_closing = false;
+        context->forward_only = callbacks->forward_only;
+        // Read-ahead tasks read clusters out of order, which forward-only sources can't do
+        context->read_ahead_count = callbacks->forward_only ? 0 : CLUSTER_READ_AHEAD_COUNT;
+
+        try
         {
-            LOG_ERROR("Failed to parse recording, recording is empty.", 0);
+            context->io_source = std::make_shared<io_callback_source_t>();
+            context->io_source->callbacks = *callbacks;
+            context->ebml_file = make_unique<CallbackIOCallback>(context->io_source);
+            context->stream = make_unique<libebml::EbmlStream>(*context->ebml_file);
+        }
+        catch (std::bad_alloc &)
+        {
+            LOG_ERROR("Failed to allocate the reader of the recording.", 0);
             result = K4A_RESULT_FAILED;
         }
-        else
+    }
+
+    if (K4A_FAILED(result) && (context == NULL || context->io_source == nullptr) && callbacks->close != NULL)
+    {
+        // The callbacks are closed like the ones of a playback that failed to open
+        callbacks->close(callbacks->context);
+    }
+
+    return finish_playback_open(context, result, playback_handle);
+}
+
+k4a_result_t k4a_playback_clone(k4a_playback_t playback_handle, k4a_playback_t *clone_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_playback_t, playback_handle);
+    k4a_playback_context_t *source = k4a_playback_t_get_context(playback_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, source == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, clone_handle == NULL);
+    RETURN_IF_ERROR(load_playback_clusters(source));
+    k4a_playback_context_t *context = NULL;
+    k4a_result_t result = K4A_RESULT_SUCCEEDED;
+
+    context = k4a_playback_t_create(clone_handle);
+    result = K4A_RESULT_FROM_BOOL(context != NULL);
+
+    if (K4A_SUCCEEDED(result))
+    {
+        context->file_path = source->file_path;
+        context->file_closing = false;
+        context->read_ahead_count = source->read_ahead_count;
+        context->cluster_cache_size = source->cluster_cache_size;
+
+        try
         {
-            context->seek_cluster = load_cluster(context, seek_cluster_info);
-            if (context->seek_cluster == nullptr)
+            if (source->forward_only)
             {
-                LOG_ERROR("Failed to load first data cluster of recording.", 0);
+                LOG_ERROR("A recording read through forward-only I/O callbacks can't be cloned.", 0);
                 result = K4A_RESULT_FAILED;
             }
+            else if (source->io_source)
+            {
+                context->io_source = source->io_source;
+                context->ebml_file = make_unique<CallbackIOCallback>(source->io_source);
+            }
+            else if (source->file_mapping)
+            {
+                context->file_mapping = source->file_mapping;
+                context->ebml_file = make_unique<MappedFileIOCallback>(source->file_mapping);
+            }
+            else
+            {
+                context->ebml_file = make_unique<LargeFileIOCallback>(source->file_path, MODE_READ);
+            }
+            if (context->ebml_file)
+            {
+                context->stream = make_unique<libebml::EbmlStream>(*context->ebml_file);
+            }
+        }
+        catch (std::ios_base::failure &e)
+        {
+            LOG_ERROR("Unable to open file '%s': %s", source->file_path, e.what());
+            result = K4A_RESULT_FAILED;
+        }
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        create_block_pool(context);
+        context->timecode_scale = source->timecode_scale;
+        context->record_config = source->record_config;
+        context->color_format_conversion = source->color_format_conversion;
+        context->color_decode = source->color_decode;
+
+        context->segment = source->segment;
+        context->segment_info = source->segment_info;
+        context->tracks = source->tracks;
+        context->cues = source->cues;
+        context->attachments = source->attachments;
+        context->tags = source->tags;
+
+        context->calibration_attachment = source->calibration_attachment;
+        context->depth_calibration_attachment = source->depth_calibration_attachment;
+        if (source->device_calibration)
+        {
+            context->device_calibration = make_unique<k4a_calibration_t>(*source->device_calibration);
+        }
+
+        context->sync_period_ns = source->sync_period_ns;
+        context->segment_info_offset = source->segment_info_offset;
+        context->first_cluster_offset = source->first_cluster_offset;
+        context->tracks_offset = source->tracks_offset;
+        context->cues_offset = source->cues_offset;
+        context->attachments_offset = source->attachments_offset;
+        context->tags_offset = source->tags_offset;
+        context->last_file_timestamp_ns = source->last_file_timestamp_ns;
+
+        // The track readers keep the read position and image buffers of their playback, the clone starts without
+        context->track_map = source->track_map;
+        for (auto &track : context->track_map)
+        {
+            track.second.current_block.reset();
+            track.second.buffer_pool.reset();
+        }
+        auto clone_track = [context](track_reader_t *source_track) -> track_reader_t * {
+            return source_track == nullptr ? nullptr : &context->track_map[source_track->track_name];
+        };
+        context->color_track = clone_track(source->color_track);
+        context->depth_track = clone_track(source->depth_track);
+        context->ir_track = clone_track(source->ir_track);
+        context->imu_track = clone_track(source->imu_track);
+        context->skipped_track_numbers = source->skipped_track_numbers;
+
+        result = TRACE_CALL(copy_cluster_cache(context, source));
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        // Seek to the first cluster
+        context->seek_cluster = load_cluster(context, context->cluster_cache.get());
+        if (context->seek_cluster == nullptr)
+        {
+            LOG_ERROR("Failed to load first data cluster of recording.", 0);
+            result = K4A_RESULT_FAILED;
         }
     }
 
     if (K4A_SUCCEEDED(result))
     {
         reset_seek_pointers(context, 0);
+        context->clusters_loaded = true;
     }
     else
     {
@@ -83,8 +343,8 @@ k4a_result_t k4a_playback_open(const char *path, k4a_playback_t *playback_handle
             }
         }
 
-        k4a_playback_t_destroy(*playback_handle);
-        *playback_handle = NULL;
+        k4a_playback_t_destroy(*clone_handle);
+        *clone_handle = NULL;
     }
 
     return result;
@@ -178,6 +438,15 @@ k4a_result_t k4a_playback_get_record_configuration(k4a_playback_t playback_handl
     return K4A_RESULT_SUCCEEDED;
 }
 
+bool k4a_playback_has_raw_depth_payload(k4a_playback_t playback_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(false, k4a_playback_t, playback_handle);
+    k4a_playback_context_t *context = k4a_playback_t_get_context(playback_handle);
+    RETURN_VALUE_IF_ARG(false, context == NULL);
+
+    return context->depth_track != nullptr && context->depth_track->raw_depth_payload;
+}
+
 bool k4a_playback_check_track_exists(k4a_playback_t playback_handle, const char *track_name)
 {
     RETURN_VALUE_IF_HANDLE_INVALID(false, k4a_playback_t, playback_handle);
@@ -386,6 +655,9 @@ k4a_result_t k4a_playback_set_color_conversion(k4a_playback_t playback_handle, k
         return K4A_RESULT_FAILED;
     }
 
+    // Images converted ahead with the previous format are dropped
+    reset_color_decode_ahead(context);
+
     switch (target_format)
     {
     case K4A_IMAGE_FORMAT_COLOR_MJPG:
@@ -412,6 +684,185 @@ k4a_result_t k4a_playback_set_color_conversion(k4a_playback_t playback_handle, k
     return K4A_RESULT_SUCCEEDED;
 }
 
+k4a_result_t k4a_playback_set_color_decode(k4a_playback_t playback_handle,
+                                           const k4a_color_decode_configuration_t *config)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_playback_t, playback_handle);
+    k4a_playback_context_t *context = k4a_playback_t_get_context(playback_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+
+    if (context->color_track == NULL)
+    {
+        LOG_ERROR("The color track is not enabled in this recording. The color decode cannot be set.", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    reset_color_decode_ahead(context);
+
+    if (config == NULL)
+    {
+        context->color_decode = K4A_COLOR_DECODE_CONFIG_INIT_FULL_RESOLUTION;
+        return K4A_RESULT_SUCCEEDED;
+    }
+
+    if (!k4a_color_decode_get_output(
+            config, context->color_track->width, context->color_track->height, NULL, NULL, NULL))
+    {
+        LOG_ERROR("Invalid color decode configuration for %ux%u color images: scale 1/%u, crop %d,%d %dx%d",
+                  context->color_track->width,
+                  context->color_track->height,
+                  config->scale_denominator,
+                  config->crop.x,
+                  config->crop.y,
+                  config->crop.width,
+                  config->crop.height);
+        return K4A_RESULT_FAILED;
+    }
+
+    context->color_decode = *config;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t k4a_playback_set_decode_ahead(k4a_playback_t playback_handle, uint32_t capture_count)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_playback_t, playback_handle);
+    k4a_playback_context_t *context = k4a_playback_t_get_context(playback_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+
+    if (context->color_track == NULL)
+    {
+        LOG_ERROR("The color track is not enabled in this recording. The color decode-ahead cannot be set.", 0);
+        return K4A_RESULT_FAILED;
+    }
+    if (capture_count > MAX_COLOR_DECODE_AHEAD_COUNT)
+    {
+        LOG_ERROR("The decode-ahead count must be at most %d captures: %u",
+                  MAX_COLOR_DECODE_AHEAD_COUNT,
+                  capture_count);
+        return K4A_RESULT_FAILED;
+    }
+
+    // Restart the decoder threads for the new count, the next capture read queues the images to convert
+    stop_color_decoder_threads(context);
+    context->decode_ahead_count = capture_count;
+    if (capture_count > 0)
+    {
+        size_t thread_count = std::min<size_t>(capture_count, COLOR_DECODER_THREAD_COUNT);
+        if (K4A_FAILED(TRACE_CALL(start_color_decoder_threads(context, thread_count))))
+        {
+            context->decode_ahead_count = 0;
+            return K4A_RESULT_FAILED;
+        }
+    }
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t k4a_playback_set_track_filter(k4a_playback_t playback_handle, const char *track_name, bool enabled)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_playback_t, playback_handle);
+    k4a_playback_context_t *context = k4a_playback_t_get_context(playback_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, track_name == NULL);
+
+    track_reader_t *track_reader = get_track_reader_by_name(context, track_name);
+    if (track_reader == nullptr)
+    {
+        LOG_ERROR("Track name cannot be found: %s", track_name);
+        return K4A_RESULT_FAILED;
+    }
+
+    if (track_reader->enabled == enabled)
+    {
+        return K4A_RESULT_SUCCEEDED;
+    }
+    if (K4A_FAILED(load_playback_clusters(context)))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    return TRACE_CALL(set_track_enabled(context, track_reader, enabled));
+}
+
+k4a_result_t k4a_playback_set_read_ahead(k4a_playback_t playback_handle, uint32_t cluster_count)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_playback_t, playback_handle);
+    k4a_playback_context_t *context = k4a_playback_t_get_context(playback_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+
+    if (cluster_count > MAX_CLUSTER_READ_AHEAD_COUNT)
+    {
+        LOG_ERROR("The read-ahead count must be at most %d clusters: %u", MAX_CLUSTER_READ_AHEAD_COUNT, cluster_count);
+        return K4A_RESULT_FAILED;
+    }
+    else if (context->forward_only && cluster_count > 0)
+    {
+        LOG_ERROR("Recordings read through forward-only I/O callbacks can't be read ahead.", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    // The clusters already preloaded are kept, the new count applies as playback moves to the following clusters
+    try
+    {
+        std::lock_guard<std::mutex> lock(context->cluster_load_lock);
+        context->read_ahead_count = cluster_count;
+        if (context->idle_cluster_readers.size() > (size_t)cluster_count * 2)
+        {
+            context->idle_cluster_readers.resize((size_t)cluster_count * 2);
+        }
+    }
+    catch (std::system_error &e)
+    {
+        LOG_ERROR("Failed to set the read-ahead count: %s", e.what());
+        return K4A_RESULT_FAILED;
+    }
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t k4a_playback_set_cluster_cache_size(k4a_playback_t playback_handle, uint64_t cache_size)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_playback_t, playback_handle);
+    k4a_playback_context_t *context = k4a_playback_t_get_context(playback_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+
+    try
+    {
+        std::lock_guard<std::mutex> lock(context->cluster_load_lock);
+        context->cluster_cache_size = cache_size;
+        evict_recent_clusters(context, cache_size);
+    }
+    catch (std::system_error &e)
+    {
+        LOG_ERROR("Failed to set the cluster cache size: %s", e.what());
+        return K4A_RESULT_FAILED;
+    }
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t k4a_playback_get_cluster_cache_stats(k4a_playback_t playback_handle,
+                                                  k4a_playback_cluster_cache_stats_t *stats)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_playback_t, playback_handle);
+    k4a_playback_context_t *context = k4a_playback_t_get_context(playback_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, stats == NULL);
+
+    try
+    {
+        std::lock_guard<std::mutex> lock(context->cluster_load_lock);
+        stats->hit_count = context->cache_hits;
+        stats->miss_count = context->cache_misses;
+        stats->load_count = context->load_count;
+        stats->evict_count = context->evict_count;
+        stats->cached_bytes = context->recent_clusters_size;
+    }
+    catch (std::system_error &e)
+    {
+        LOG_ERROR("Failed to get the cluster cache stats: %s", e.what());
+        return K4A_RESULT_FAILED;
+    }
+    return K4A_RESULT_SUCCEEDED;
+}
+
 k4a_buffer_result_t
 k4a_playback_get_attachment(k4a_playback_t playback_handle, const char *file_name, uint8_t *data, size_t *data_size)
 {
@@ -451,6 +902,11 @@ k4a_stream_result_t k4a_playback_get_next_capture(k4a_playback_t playback_handle
     RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, context == NULL);
     RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, capture_handle == NULL);
 
+    if (K4A_FAILED(load_playback_clusters(context)))
+    {
+        return K4A_STREAM_RESULT_FAILED;
+    }
+
     return get_capture(context, capture_handle, true);
 }
 
@@ -461,9 +917,49 @@ k4a_stream_result_t k4a_playback_get_previous_capture(k4a_playback_t playback_ha
     RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, context == NULL);
     RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, capture_handle == NULL);
 
+    if (K4A_FAILED(load_playback_clusters(context)))
+    {
+        return K4A_STREAM_RESULT_FAILED;
+    }
+
     return get_capture(context, capture_handle, false);
 }
 
+uint64_t k4a_playback_get_capture_count(k4a_playback_t playback_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(0, k4a_playback_t, playback_handle);
+    k4a_playback_context_t *context = k4a_playback_t_get_context(playback_handle);
+    RETURN_VALUE_IF_ARG(0, context == NULL);
+
+    if (K4A_FAILED(load_playback_clusters(context)))
+    {
+        return 0;
+    }
+
+    if (!context->capture_index_built && K4A_FAILED(TRACE_CALL(build_capture_index(context))))
+    {
+        return 0;
+    }
+    return context->capture_index.size();
+}
+
+k4a_stream_result_t k4a_playback_get_capture_at_index(k4a_playback_t playback_handle,
+                                                      uint64_t capture_index,
+                                                      k4a_capture_t *capture_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_STREAM_RESULT_FAILED, k4a_playback_t, playback_handle);
+    k4a_playback_context_t *context = k4a_playback_t_get_context(playback_handle);
+    RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, capture_handle == NULL);
+
+    if (K4A_FAILED(load_playback_clusters(context)))
+    {
+        return K4A_STREAM_RESULT_FAILED;
+    }
+
+    return get_capture_at_index(context, capture_index, capture_handle);
+}
+
 k4a_stream_result_t k4a_playback_get_next_imu_sample(k4a_playback_t playback_handle, k4a_imu_sample_t *imu_sample)
 {
     RETURN_VALUE_IF_HANDLE_INVALID(K4A_STREAM_RESULT_FAILED, k4a_playback_t, playback_handle);
@@ -471,6 +967,11 @@ k4a_stream_result_t k4a_playback_get_next_imu_sample(k4a_playback_t playback_han
     RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, context == NULL);
     RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, imu_sample == NULL);
 
+    if (K4A_FAILED(load_playback_clusters(context)))
+    {
+        return K4A_STREAM_RESULT_FAILED;
+    }
+
     return get_imu_sample(context, imu_sample, true);
 }
 
@@ -481,9 +982,90 @@ k4a_stream_result_t k4a_playback_get_previous_imu_sample(k4a_playback_t playback
     RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, context == NULL);
     RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, imu_sample == NULL);
 
+    if (K4A_FAILED(load_playback_clusters(context)))
+    {
+        return K4A_STREAM_RESULT_FAILED;
+    }
+
     return get_imu_sample(context, imu_sample, false);
 }
 
+k4a_result_t k4a_playback_get_imu_samples(k4a_playback_t playback_handle,
+                                          uint64_t start_timestamp_usec,
+                                          uint64_t end_timestamp_usec,
+                                          k4a_imu_sample_t *samples,
+                                          size_t max_sample_count,
+                                          size_t *sample_count)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_playback_t, playback_handle);
+    k4a_playback_context_t *context = k4a_playback_t_get_context(playback_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, samples == NULL && max_sample_count > 0);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, sample_count == NULL);
+
+    if (K4A_FAILED(load_playback_clusters(context)))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    return get_imu_samples(context, start_timestamp_usec, end_timestamp_usec, samples, max_sample_count, sample_count);
+}
+
+k4a_result_t k4a_playback_get_track_timestamps(k4a_playback_t playback_handle,
+                                               const char *track_name,
+                                               uint64_t start_timestamp_usec,
+                                               uint64_t end_timestamp_usec,
+                                               uint64_t *timestamps_usec,
+                                               size_t max_timestamp_count,
+                                               size_t *timestamp_count)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_playback_t, playback_handle);
+    k4a_playback_context_t *context = k4a_playback_t_get_context(playback_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, track_name == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, timestamps_usec == NULL && max_timestamp_count > 0);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, timestamp_count == NULL);
+
+    track_reader_t *track_reader = get_track_reader_by_name(context, track_name);
+    if (track_reader == nullptr)
+    {
+        LOG_ERROR("Track name cannot be found: %s", track_name);
+        return K4A_RESULT_FAILED;
+    }
+
+    if (K4A_FAILED(load_playback_clusters(context)))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    return get_track_timestamps(context,
+                                track_reader,
+                                start_timestamp_usec,
+                                end_timestamp_usec,
+                                timestamps_usec,
+                                max_timestamp_count,
+                                timestamp_count);
+}
+
+k4a_result_t k4a_playback_trim(k4a_playback_t playback_handle,
+                               const char *path,
+                               uint64_t start_timestamp_usec,
+                               uint64_t end_timestamp_usec)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_playback_t, playback_handle);
+    k4a_playback_context_t *context = k4a_playback_t_get_context(playback_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, path == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, start_timestamp_usec >= end_timestamp_usec);
+
+    if (K4A_FAILED(load_playback_clusters(context)))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    return write_trimmed_recording(context, path, start_timestamp_usec, end_timestamp_usec);
+}
+
 k4a_stream_result_t k4a_playback_get_next_data_block(k4a_playback_t playback_handle,
                                                      const char *track_name,
                                                      k4a_playback_data_block_t *data_block_handle)
@@ -507,6 +1089,11 @@ k4a_stream_result_t k4a_playback_get_next_data_block(k4a_playback_t playback_han
         return K4A_STREAM_RESULT_FAILED;
     }
 
+    if (K4A_FAILED(load_playback_clusters(context)))
+    {
+        return K4A_STREAM_RESULT_FAILED;
+    }
+
     return get_data_block(context, track_reader, data_block_handle, true);
 }
 
@@ -533,6 +1120,11 @@ k4a_stream_result_t k4a_playback_get_previous_data_block(k4a_playback_t playback
         return K4A_STREAM_RESULT_FAILED;
     }
 
+    if (K4A_FAILED(load_playback_clusters(context)))
+    {
+        return K4A_STREAM_RESULT_FAILED;
+    }
+
     return get_data_block(context, track_reader, data_block_handle, false);
 }
 
@@ -579,6 +1171,11 @@ k4a_result_t k4a_playback_seek_timestamp(k4a_playback_t playback_handle,
                         origin != K4A_PLAYBACK_SEEK_BEGIN && origin != K4A_PLAYBACK_SEEK_END &&
                             origin != K4A_PLAYBACK_SEEK_DEVICE_TIME);
 
+    if (K4A_FAILED(load_playback_clusters(context)))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
     // If seeking to a device timestamp, calculate the offset relative to the start of file.
     if (origin == K4A_PLAYBACK_SEEK_DEVICE_TIME)
     {
@@ -615,6 +1212,16 @@ k4a_result_t k4a_playback_seek_timestamp(k4a_playback_t playback_handle,
         target_time_ns = (uint64_t)offset_usec * 1000;
     }
 
+    if (origin == K4A_PLAYBACK_SEEK_END && offset_usec == 0)
+    {
+        // Only previous captures can be read from the end, so the clusters before it are read ahead
+        context->read_forward = false;
+    }
+    else if (origin == K4A_PLAYBACK_SEEK_BEGIN && offset_usec == 0)
+    {
+        context->read_forward = true;
+    }
+
     cluster_info_t *seek_cluster_info = find_cluster(context, target_time_ns);
     if (seek_cluster_info == NULL)
     {
@@ -641,6 +1248,11 @@ uint64_t k4a_playback_get_recording_length_usec(k4a_playback_t playback_handle)
 
     k4a_playback_context_t *context = k4a_playback_t_get_context(playback_handle);
     RETURN_VALUE_IF_ARG(0, context == NULL);
+    if (K4A_FAILED(load_playback_clusters(context)))
+    {
+        return 0;
+    }
+
     return context->last_file_timestamp_ns / 1000;
 }
 
@@ -650,6 +1262,11 @@ uint64_t k4a_playback_get_last_timestamp_usec(k4a_playback_t playback_handle)
 
     k4a_playback_context_t *context = k4a_playback_t_get_context(playback_handle);
     RETURN_VALUE_IF_ARG(0, context == NULL);
+    if (K4A_FAILED(load_playback_clusters(context)))
+    {
+        return 0;
+    }
+
     return context->last_file_timestamp_ns / 1000;
 }
 
@@ -664,8 +1281,14 @@ void k4a_playback_close(const k4a_playback_t playback_handle)
         LOG_TRACE("  Seek count: %llu", context->seek_count);
         LOG_TRACE("  Cluster load count: %llu", context->load_count);
         LOG_TRACE("  Cluster cache hits: %llu", context->cache_hits);
+        LOG_TRACE("  Cluster cache misses: %llu", context->cache_misses);
+        LOG_TRACE("  Cluster cache evictions: %llu", context->evict_count);
+
+        stop_color_decoder_threads(context);
+        stop_depth_decoder_threads(context);
 
         context->file_closing = true;
+        wait_for_pool_reads(context);
 
         try
         {
@@ -685,6 +1308,9 @@ void k4a_playback_close(const k4a_playback_t playback_handle)
         }
 
         context->io_lock.unlock();
+
+        // Wait for the read-ahead tasks of the seek cluster while the cluster cache they use still exists
+        context->seek_cluster.reset();
     }
     k4a_playback_t_destroy(playback_handle);
 }
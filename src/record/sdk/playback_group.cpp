@@ -0,0 +1,269 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <algorithm>
+
+#include <k4a/k4a.h>
+#include <k4arecord/playback.h>
+#include <k4ainternal/common.h>
+#include <k4ainternal/matroska_read.h>
+#include <k4ainternal/logging.h>
+
+using namespace k4arecord;
+
+// The recordings of a group are read through a playback handle each. They are opened header-only and given the reader
+// pool of the group before their first read, so all their read-ahead loads run on the threads of the group.
+
+// Returns the time a capture was taken on the master's timeline.
+static int64_t get_group_time(const k4a_record_configuration_t &config, k4a_capture_t capture)
+{
+    int64_t time_usec = 0;
+    k4a_image_t image = k4a_capture_get_depth_image(capture);
+    if (image == NULL)
+    {
+        image = k4a_capture_get_ir_image(capture);
+    }
+    if (image != NULL)
+    {
+        time_usec = (int64_t)k4a_image_get_device_timestamp_usec(image) - config.depth_delay_off_color_usec;
+    }
+    else
+    {
+        image = k4a_capture_get_color_image(capture);
+        if (image != NULL)
+        {
+            time_usec = (int64_t)k4a_image_get_device_timestamp_usec(image);
+        }
+    }
+    if (image != NULL)
+    {
+        k4a_image_release(image);
+    }
+    return time_usec - (int64_t)config.subordinate_delay_off_master_usec;
+}
+
+k4a_result_t k4a_playback_group_open(const char *const *paths,
+                                     size_t path_count,
+                                     uint32_t reader_thread_count,
+                                     k4a_playback_group_t *group_handle)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, paths == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, path_count == 0 || path_count > UINT32_MAX);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, group_handle == NULL);
+
+    k4a_playback_group_context_t *context = k4a_playback_group_t_create(group_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+
+    k4a_result_t result = K4A_RESULT_SUCCEEDED;
+    context->reader_pool = create_reader_pool(reader_thread_count == 0 ? (uint32_t)path_count : reader_thread_count);
+    if (context->reader_pool == nullptr)
+    {
+        result = K4A_RESULT_FAILED;
+    }
+
+    uint32_t camera_fps = 0;
+    for (size_t i = 0; i < path_count && K4A_SUCCEEDED(result); i++)
+    {
+        k4a_playback_t playback = NULL;
+        result = TRACE_CALL(k4a_playback_open_ex(paths[i], K4A_PLAYBACK_OPEN_HEADER_ONLY, &playback));
+        if (K4A_FAILED(result))
+        {
+            LOG_ERROR("Failed to open recording %zu of the group: %s", i, paths[i]);
+            break;
+        }
+
+        k4a_record_configuration_t config = {};
+        try
+        {
+            context->playbacks.push_back(playback);
+            context->next_captures.push_back(NULL);
+            context->ended.push_back(false);
+        }
+        catch (std::bad_alloc &)
+        {
+            LOG_ERROR("Failed to allocate the recording list of the group.", 0);
+            k4a_playback_close(playback);
+            result = K4A_RESULT_FAILED;
+            break;
+        }
+
+        k4a_playback_context_t *playback_context = k4a_playback_t_get_context(playback);
+        playback_context->reader_pool = context->reader_pool;
+
+        result = TRACE_CALL(k4a_playback_get_record_configuration(playback, &config));
+        if (K4A_SUCCEEDED(result))
+        {
+            if (i > 0 && config.wired_sync_mode == K4A_WIRED_SYNC_MODE_MASTER)
+            {
+                LOG_WARNING("Recording %zu of the group is from a master device, the master should be first: %s",
+                            i,
+                            paths[i]);
+            }
+            camera_fps = std::max(camera_fps, k4a_convert_fps_to_uint(config.camera_fps));
+            try
+            {
+                context->configs.push_back(config);
+            }
+            catch (std::bad_alloc &)
+            {
+                LOG_ERROR("Failed to allocate the recording list of the group.", 0);
+                result = K4A_RESULT_FAILED;
+            }
+        }
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        context->match_window_usec = camera_fps > 0 ? HZ_TO_PERIOD_US(camera_fps) / 2 : 0;
+    }
+    else
+    {
+        k4a_playback_group_close(*group_handle);
+        *group_handle = NULL;
+    }
+    return result;
+}
+
+size_t k4a_playback_group_get_count(k4a_playback_group_t group_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(0, k4a_playback_group_t, group_handle);
+    k4a_playback_group_context_t *context = k4a_playback_group_t_get_context(group_handle);
+    RETURN_VALUE_IF_ARG(0, context == NULL);
+
+    return context->playbacks.size();
+}
+
+k4a_playback_t k4a_playback_group_get_playback(k4a_playback_group_t group_handle, size_t index)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(NULL, k4a_playback_group_t, group_handle);
+    k4a_playback_group_context_t *context = k4a_playback_group_t_get_context(group_handle);
+    RETURN_VALUE_IF_ARG(NULL, context == NULL);
+    RETURN_VALUE_IF_ARG(NULL, index >= context->playbacks.size());
+
+    return context->playbacks[index];
+}
+
+k4a_stream_result_t k4a_playback_group_get_next_captures(k4a_playback_group_t group_handle,
+                                                         k4a_capture_t *capture_handles)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_STREAM_RESULT_FAILED, k4a_playback_group_t, group_handle);
+    k4a_playback_group_context_t *context = k4a_playback_group_t_get_context(group_handle);
+    RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, capture_handles == NULL);
+
+    size_t count = context->playbacks.size();
+    for (size_t i = 0; i < count; i++)
+    {
+        capture_handles[i] = NULL;
+        if (context->next_captures[i] == NULL && !context->ended[i])
+        {
+            k4a_stream_result_t result = k4a_playback_get_next_capture(context->playbacks[i],
+                                                                       &context->next_captures[i]);
+            if (result == K4A_STREAM_RESULT_FAILED)
+            {
+                context->next_captures[i] = NULL;
+                return result;
+            }
+            context->ended[i] = result == K4A_STREAM_RESULT_EOF;
+        }
+    }
+
+    // Find the earliest capture not yet returned
+    bool found = false;
+    int64_t earliest_usec = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (context->next_captures[i] != NULL)
+        {
+            int64_t time_usec = get_group_time(context->configs[i], context->next_captures[i]);
+            if (!found || time_usec < earliest_usec)
+            {
+                earliest_usec = time_usec;
+                found = true;
+            }
+        }
+    }
+    if (!found)
+    {
+        return K4A_STREAM_RESULT_EOF;
+    }
+
+    // Return it with the captures of the other recordings taken close to it, the others are kept for the next call
+    for (size_t i = 0; i < count; i++)
+    {
+        if (context->next_captures[i] != NULL &&
+            get_group_time(context->configs[i], context->next_captures[i]) - earliest_usec <=
+                (int64_t)context->match_window_usec)
+        {
+            capture_handles[i] = context->next_captures[i];
+            context->next_captures[i] = NULL;
+        }
+    }
+    return K4A_STREAM_RESULT_SUCCEEDED;
+}
+
+k4a_result_t k4a_playback_group_seek_timestamp(k4a_playback_group_t group_handle,
+                                               int64_t offset_usec,
+                                               k4a_playback_seek_origin_t origin)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_playback_group_t, group_handle);
+    k4a_playback_group_context_t *context = k4a_playback_group_t_get_context(group_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED,
+                        origin != K4A_PLAYBACK_SEEK_BEGIN && origin != K4A_PLAYBACK_SEEK_END &&
+                            origin != K4A_PLAYBACK_SEEK_DEVICE_TIME);
+
+    // The target is converted to a device time of the master recording
+    int64_t target_usec = offset_usec;
+    if (origin == K4A_PLAYBACK_SEEK_BEGIN)
+    {
+        target_usec += (int64_t)context->configs[0].start_timestamp_offset_usec;
+    }
+    else if (origin == K4A_PLAYBACK_SEEK_END)
+    {
+        uint64_t length_usec = k4a_playback_get_recording_length_usec(context->playbacks[0]);
+        target_usec += (int64_t)(context->configs[0].start_timestamp_offset_usec + length_usec);
+    }
+
+    for (size_t i = 0; i < context->playbacks.size(); i++)
+    {
+        if (context->next_captures[i] != NULL)
+        {
+            k4a_capture_release(context->next_captures[i]);
+            context->next_captures[i] = NULL;
+        }
+        context->ended[i] = false;
+
+        int64_t device_usec = target_usec + (int64_t)context->configs[i].subordinate_delay_off_master_usec;
+        RETURN_IF_ERROR(k4a_playback_seek_timestamp(context->playbacks[i],
+                                                    std::max(device_usec, (int64_t)0),
+                                                    K4A_PLAYBACK_SEEK_DEVICE_TIME));
+    }
+    return K4A_RESULT_SUCCEEDED;
+}
+
+void k4a_playback_group_close(k4a_playback_group_t group_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, k4a_playback_group_t, group_handle);
+
+    k4a_playback_group_context_t *context = k4a_playback_group_t_get_context(group_handle);
+    if (context != NULL)
+    {
+        for (k4a_capture_t capture : context->next_captures)
+        {
+            if (capture != NULL)
+            {
+                k4a_capture_release(capture);
+            }
+        }
+
+        // The playbacks wait for their loads queued on the pool when closed, the pool threads are stopped after
+        for (k4a_playback_t playback : context->playbacks)
+        {
+            k4a_playback_close(playback);
+        }
+        context->playbacks.clear();
+        context->reader_pool.reset();
+    }
+    k4a_playback_group_t_destroy(group_handle);
+}
@@ -0,0 +1,435 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <algorithm>
+#include <fstream>
+
+#include <k4a/k4a.h>
+#include <k4arecord/playback.h>
+#include <k4ainternal/matroska_read.h>
+#include <k4ainternal/logging.h>
+
+using namespace k4arecord;
+
+// The segments of a recording are read through a playback handle per segment. Segments are opened when the captures
+// or the IMU samples move into them, or when a seek needs their length, and closed once neither is read from them.
+
+// Returns the playback of a segment, opening it if needed.
+static k4a_playback_t get_segment_playback(k4a_playback_segments_context_t *context, size_t index)
+{
+    playback_segment_t &segment = context->segments[index];
+    if (segment.playback != NULL)
+    {
+        return segment.playback;
+    }
+
+    if (K4A_FAILED(TRACE_CALL(k4a_playback_open(segment.path.c_str(), &segment.playback))))
+    {
+        LOG_ERROR("Failed to open segment %zu of the recording: %s", index, segment.path.c_str());
+        segment.playback = NULL;
+        return NULL;
+    }
+
+    if (context->color_conversion_set &&
+        K4A_FAILED(TRACE_CALL(k4a_playback_set_color_conversion(segment.playback, context->color_conversion))))
+    {
+        k4a_playback_close(segment.playback);
+        segment.playback = NULL;
+        return NULL;
+    }
+
+    segment.length_usec = k4a_playback_get_recording_length_usec(segment.playback);
+    segment.length_known = true;
+    return segment.playback;
+}
+
+// Returns the playback the IMU samples of a segment are read with, cloning it from the segment playback if needed.
+static k4a_playback_t get_segment_imu_playback(k4a_playback_segments_context_t *context, size_t index)
+{
+    playback_segment_t &segment = context->segments[index];
+    if (segment.imu_playback == NULL)
+    {
+        k4a_playback_t playback = get_segment_playback(context, index);
+        if (playback == NULL || K4A_FAILED(TRACE_CALL(k4a_playback_clone(playback, &segment.imu_playback))))
+        {
+            segment.imu_playback = NULL;
+            return NULL;
+        }
+    }
+    return segment.imu_playback;
+}
+
+static uint64_t get_segment_length(k4a_playback_segments_context_t *context, size_t index)
+{
+    if (!context->segments[index].length_known)
+    {
+        (void)get_segment_playback(context, index);
+    }
+    return context->segments[index].length_usec;
+}
+
+// Closes a segment no longer read from. Its length stays known.
+static void release_segment(k4a_playback_segments_context_t *context, size_t index)
+{
+    playback_segment_t &segment = context->segments[index];
+    if (index == context->capture_segment || index == context->imu_segment || segment.pinned)
+    {
+        return;
+    }
+
+    if (segment.imu_playback != NULL)
+    {
+        k4a_playback_close(segment.imu_playback);
+        segment.imu_playback = NULL;
+    }
+    if (segment.playback != NULL)
+    {
+        k4a_playback_close(segment.playback);
+        segment.playback = NULL;
+    }
+}
+
+k4a_result_t k4a_playback_segments_open(const char *path, k4a_playback_segments_t *segments_handle)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, path == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, segments_handle == NULL);
+
+    k4a_playback_segments_context_t *context = k4a_playback_segments_t_create(segments_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+
+    k4a_result_t result = K4A_RESULT_SUCCEEDED;
+    try
+    {
+        for (uint32_t index = 0; index < UINT32_MAX; index++)
+        {
+            playback_segment_t segment;
+            segment.path = get_segment_path(path, index);
+            if (index > 0 && !std::ifstream(segment.path, std::ios::binary))
+            {
+                break;
+            }
+            context->segments.push_back(segment);
+        }
+    }
+    catch (std::bad_alloc &)
+    {
+        LOG_ERROR("Failed to allocate the segment list of the recording.", 0);
+        result = K4A_RESULT_FAILED;
+    }
+
+    k4a_playback_t first_playback = NULL;
+    if (K4A_SUCCEEDED(result))
+    {
+        first_playback = get_segment_playback(context, 0);
+        result = K4A_RESULT_FROM_BOOL(first_playback != NULL);
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        k4a_record_configuration_t config;
+        result = TRACE_CALL(k4a_playback_get_record_configuration(first_playback, &config));
+        context->start_offset_usec = config.start_timestamp_offset_usec;
+    }
+
+    if (K4A_FAILED(result))
+    {
+        k4a_playback_segments_close(*segments_handle);
+        *segments_handle = NULL;
+    }
+    return result;
+}
+
+size_t k4a_playback_segments_get_count(k4a_playback_segments_t segments_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(0, k4a_playback_segments_t, segments_handle);
+    k4a_playback_segments_context_t *context = k4a_playback_segments_t_get_context(segments_handle);
+    RETURN_VALUE_IF_ARG(0, context == NULL);
+
+    return context->segments.size();
+}
+
+k4a_result_t k4a_playback_segments_get_playback(k4a_playback_segments_t segments_handle,
+                                                size_t index,
+                                                k4a_playback_t *playback_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_playback_segments_t, segments_handle);
+    k4a_playback_segments_context_t *context = k4a_playback_segments_t_get_context(segments_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, index >= context->segments.size());
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, playback_handle == NULL);
+
+    *playback_handle = get_segment_playback(context, index);
+    if (*playback_handle == NULL)
+    {
+        return K4A_RESULT_FAILED;
+    }
+    context->segments[index].pinned = true;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t k4a_playback_segments_set_color_conversion(k4a_playback_segments_t segments_handle,
+                                                        k4a_image_format_t target_format)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_playback_segments_t, segments_handle);
+    k4a_playback_segments_context_t *context = k4a_playback_segments_t_get_context(segments_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+
+    for (playback_segment_t &segment : context->segments)
+    {
+        if (segment.playback != NULL)
+        {
+            RETURN_IF_ERROR(k4a_playback_set_color_conversion(segment.playback, target_format));
+        }
+    }
+    context->color_conversion = target_format;
+    context->color_conversion_set = true;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_stream_result_t k4a_playback_segments_get_next_capture(k4a_playback_segments_t segments_handle,
+                                                           k4a_capture_t *capture_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_STREAM_RESULT_FAILED, k4a_playback_segments_t, segments_handle);
+    k4a_playback_segments_context_t *context = k4a_playback_segments_t_get_context(segments_handle);
+    RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, capture_handle == NULL);
+
+    while (true)
+    {
+        k4a_playback_t playback = get_segment_playback(context, context->capture_segment);
+        if (playback == NULL)
+        {
+            return K4A_STREAM_RESULT_FAILED;
+        }
+
+        k4a_stream_result_t result = k4a_playback_get_next_capture(playback, capture_handle);
+        if (result != K4A_STREAM_RESULT_EOF || context->capture_segment + 1 >= context->segments.size())
+        {
+            return result;
+        }
+
+        // Go on from the start of the next segment
+        k4a_playback_t next_playback = get_segment_playback(context, context->capture_segment + 1);
+        if (next_playback == NULL ||
+            K4A_FAILED(TRACE_CALL(k4a_playback_seek_timestamp(next_playback, 0, K4A_PLAYBACK_SEEK_BEGIN))))
+        {
+            return K4A_STREAM_RESULT_FAILED;
+        }
+        context->capture_segment++;
+        release_segment(context, context->capture_segment - 1);
+    }
+}
+
+k4a_stream_result_t k4a_playback_segments_get_previous_capture(k4a_playback_segments_t segments_handle,
+                                                               k4a_capture_t *capture_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_STREAM_RESULT_FAILED, k4a_playback_segments_t, segments_handle);
+    k4a_playback_segments_context_t *context = k4a_playback_segments_t_get_context(segments_handle);
+    RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, capture_handle == NULL);
+
+    while (true)
+    {
+        k4a_playback_t playback = get_segment_playback(context, context->capture_segment);
+        if (playback == NULL)
+        {
+            return K4A_STREAM_RESULT_FAILED;
+        }
+
+        k4a_stream_result_t result = k4a_playback_get_previous_capture(playback, capture_handle);
+        if (result != K4A_STREAM_RESULT_EOF || context->capture_segment == 0)
+        {
+            return result;
+        }
+
+        // Go on from the end of the previous segment
+        k4a_playback_t previous_playback = get_segment_playback(context, context->capture_segment - 1);
+        if (previous_playback == NULL ||
+            K4A_FAILED(TRACE_CALL(k4a_playback_seek_timestamp(previous_playback, 0, K4A_PLAYBACK_SEEK_END))))
+        {
+            return K4A_STREAM_RESULT_FAILED;
+        }
+        context->capture_segment--;
+        release_segment(context, context->capture_segment + 1);
+    }
+}
+
+k4a_stream_result_t k4a_playback_segments_get_next_imu_sample(k4a_playback_segments_t segments_handle,
+                                                              k4a_imu_sample_t *imu_sample)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_STREAM_RESULT_FAILED, k4a_playback_segments_t, segments_handle);
+    k4a_playback_segments_context_t *context = k4a_playback_segments_t_get_context(segments_handle);
+    RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, imu_sample == NULL);
+
+    while (true)
+    {
+        k4a_playback_t playback = get_segment_imu_playback(context, context->imu_segment);
+        if (playback == NULL)
+        {
+            return K4A_STREAM_RESULT_FAILED;
+        }
+
+        k4a_stream_result_t result = k4a_playback_get_next_imu_sample(playback, imu_sample);
+        if (result != K4A_STREAM_RESULT_EOF || context->imu_segment + 1 >= context->segments.size())
+        {
+            return result;
+        }
+
+        // Go on from the start of the next segment
+        k4a_playback_t next_playback = get_segment_imu_playback(context, context->imu_segment + 1);
+        if (next_playback == NULL ||
+            K4A_FAILED(TRACE_CALL(k4a_playback_seek_timestamp(next_playback, 0, K4A_PLAYBACK_SEEK_BEGIN))))
+        {
+            return K4A_STREAM_RESULT_FAILED;
+        }
+        context->imu_segment++;
+        release_segment(context, context->imu_segment - 1);
+    }
+}
+
+k4a_stream_result_t k4a_playback_segments_get_previous_imu_sample(k4a_playback_segments_t segments_handle,
+                                                                  k4a_imu_sample_t *imu_sample)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_STREAM_RESULT_FAILED, k4a_playback_segments_t, segments_handle);
+    k4a_playback_segments_context_t *context = k4a_playback_segments_t_get_context(segments_handle);
+    RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, imu_sample == NULL);
+
+    while (true)
+    {
+        k4a_playback_t playback = get_segment_imu_playback(context, context->imu_segment);
+        if (playback == NULL)
+        {
+            return K4A_STREAM_RESULT_FAILED;
+        }
+
+        k4a_stream_result_t result = k4a_playback_get_previous_imu_sample(playback, imu_sample);
+        if (result != K4A_STREAM_RESULT_EOF || context->imu_segment == 0)
+        {
+            return result;
+        }
+
+        // Go on from the end of the previous segment
+        k4a_playback_t previous_playback = get_segment_imu_playback(context, context->imu_segment - 1);
+        if (previous_playback == NULL ||
+            K4A_FAILED(TRACE_CALL(k4a_playback_seek_timestamp(previous_playback, 0, K4A_PLAYBACK_SEEK_END))))
+        {
+            return K4A_STREAM_RESULT_FAILED;
+        }
+        context->imu_segment--;
+        release_segment(context, context->imu_segment + 1);
+    }
+}
+
+k4a_result_t k4a_playback_segments_seek_timestamp(k4a_playback_segments_t segments_handle,
+                                                  int64_t offset_usec,
+                                                  k4a_playback_seek_origin_t origin)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_playback_segments_t, segments_handle);
+    k4a_playback_segments_context_t *context = k4a_playback_segments_t_get_context(segments_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED,
+                        origin != K4A_PLAYBACK_SEEK_BEGIN && origin != K4A_PLAYBACK_SEEK_END &&
+                            origin != K4A_PLAYBACK_SEEK_DEVICE_TIME);
+
+    // The target is converted to a timestamp from the start of the timeline shared by the segments
+    int64_t target_usec = offset_usec;
+    if (origin == K4A_PLAYBACK_SEEK_DEVICE_TIME)
+    {
+        target_usec -= (int64_t)context->start_offset_usec;
+    }
+    else if (origin == K4A_PLAYBACK_SEEK_END)
+    {
+        size_t last_segment = context->segments.size() - 1;
+        if (get_segment_playback(context, last_segment) == NULL)
+        {
+            return K4A_RESULT_FAILED;
+        }
+        target_usec = (int64_t)get_segment_length(context, last_segment) + std::min(offset_usec, (int64_t)0);
+        release_segment(context, last_segment);
+    }
+    target_usec = std::max(target_usec, (int64_t)0);
+
+    // Find the first segment ending at or after the target, the segment lengths increase along the timeline
+    size_t low = 0;
+    size_t high = context->segments.size() - 1;
+    while (low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+        bool was_closed = context->segments[middle].playback == NULL;
+        uint64_t length_usec = get_segment_length(context, middle);
+        if (was_closed)
+        {
+            release_segment(context, middle);
+        }
+        if (!context->segments[middle].length_known)
+        {
+            return K4A_RESULT_FAILED;
+        }
+
+        if (length_usec < (uint64_t)target_usec)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    k4a_playback_t playback = get_segment_playback(context, low);
+    k4a_playback_t imu_playback = get_segment_imu_playback(context, low);
+    if (playback == NULL || imu_playback == NULL)
+    {
+        return K4A_RESULT_FAILED;
+    }
+    RETURN_IF_ERROR(k4a_playback_seek_timestamp(playback, target_usec, K4A_PLAYBACK_SEEK_BEGIN));
+    RETURN_IF_ERROR(k4a_playback_seek_timestamp(imu_playback, target_usec, K4A_PLAYBACK_SEEK_BEGIN));
+
+    size_t previous_capture_segment = context->capture_segment;
+    size_t previous_imu_segment = context->imu_segment;
+    context->capture_segment = low;
+    context->imu_segment = low;
+    release_segment(context, previous_capture_segment);
+    release_segment(context, previous_imu_segment);
+    return K4A_RESULT_SUCCEEDED;
+}
+
+uint64_t k4a_playback_segments_get_recording_length_usec(k4a_playback_segments_t segments_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(0, k4a_playback_segments_t, segments_handle);
+    k4a_playback_segments_context_t *context = k4a_playback_segments_t_get_context(segments_handle);
+    RETURN_VALUE_IF_ARG(0, context == NULL);
+
+    size_t last_segment = context->segments.size() - 1;
+    bool was_closed = context->segments[last_segment].playback == NULL;
+    uint64_t length_usec = get_segment_length(context, last_segment);
+    if (was_closed)
+    {
+        release_segment(context, last_segment);
+    }
+    return length_usec;
+}
+
+void k4a_playback_segments_close(k4a_playback_segments_t segments_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, k4a_playback_segments_t, segments_handle);
+
+    k4a_playback_segments_context_t *context = k4a_playback_segments_t_get_context(segments_handle);
+    if (context != NULL)
+    {
+        for (playback_segment_t &segment : context->segments)
+        {
+            if (segment.imu_playback != NULL)
+            {
+                k4a_playback_close(segment.imu_playback);
+            }
+            if (segment.playback != NULL)
+            {
+                k4a_playback_close(segment.playback);
+            }
+        }
+    }
+    k4a_playback_segments_t_destroy(segments_handle);
+}
@@ -1,6 +1,7 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <cstring>
 #include <ctime>
 #include <iostream>
 #include <sstream>
@@ -10,30 +11,124 @@
 #include <k4ainternal/matroska_write.h>
 #include <k4ainternal/logging.h>
 #include <k4ainternal/common.h>
+#include <azure_c_shared_utility/envvariable.h>
 
 using namespace k4arecord;
 using namespace LIBMATROSKA_NAMESPACE;
 
-k4a_result_t k4a_record_create(const char *path,
-                               k4a_device_t device,
-                               const k4a_device_configuration_t device_config,
-                               k4a_record_t *recording_handle)
+// DataBuffer over the buffer of an image, without copying it. The buffer holds a reference on the image until
+// write_cluster() frees it, after rendering it to disk or swapping it to big-endian.
+class ImageDataBuffer : public DataBuffer
+{
+public:
+    ImageDataBuffer(k4a_image_t image) :
+        DataBuffer(k4a_image_get_buffer(image), (uint32)k4a_image_get_size(image), &ImageDataBuffer::ReleaseImage),
+        m_image(image)
+    {
+        k4a_image_reference(m_image);
+    }
+
+    virtual ~ImageDataBuffer()
+    {
+        // FreeBuffer() only calls ReleaseImage() once, even though write_cluster() has already freed the buffer.
+        FreeBuffer(*this);
+    }
+
+private:
+    static bool ReleaseImage(const DataBuffer &buffer)
+    {
+        k4a_image_release(static_cast<const ImageDataBuffer &>(buffer).m_image);
+        return true;
+    }
+
+    k4a_image_t m_image;
+};
+
+// DataBuffer over a custom track buffer handed over by the caller, without copying it. The buffer is returned through
+// the callback of the caller once write_cluster() frees it, or if the block couldn't be queued.
+class CallbackDataBuffer : public DataBuffer
+{
+public:
+    CallbackDataBuffer(uint8_t *buffer, uint32 size, k4a_memory_destroy_cb_t *release_cb, void *release_cb_context) :
+        DataBuffer(buffer, size, &CallbackDataBuffer::ReleaseBuffer),
+        m_buffer(buffer),
+        m_release_cb(release_cb),
+        m_release_cb_context(release_cb_context)
+    {
+    }
+
+    virtual ~CallbackDataBuffer()
+    {
+        // FreeBuffer() only calls ReleaseBuffer() once, even though write_cluster() has already freed the buffer.
+        FreeBuffer(*this);
+    }
+
+private:
+    static bool ReleaseBuffer(const DataBuffer &buffer)
+    {
+        const CallbackDataBuffer &data_buffer = static_cast<const CallbackDataBuffer &>(buffer);
+        data_buffer.m_release_cb(data_buffer.m_buffer, data_buffer.m_release_cb_context);
+        return true;
+    }
+
+    uint8_t *m_buffer;
+    k4a_memory_destroy_cb_t *m_release_cb;
+    void *m_release_cb_context;
+};
+
+// Name of a color format in the K4A_COLOR_MODE tag, or NULL if it can't be recorded
+static const char *get_color_format_name(k4a_image_format_t format)
+{
+    switch (format)
+    {
+    case K4A_IMAGE_FORMAT_COLOR_NV12:
+        return "NV12";
+    case K4A_IMAGE_FORMAT_COLOR_YUY2:
+        return "YUY2";
+    case K4A_IMAGE_FORMAT_COLOR_MJPG:
+        return "MJPG";
+    case K4A_IMAGE_FORMAT_COLOR_BGRA32:
+        return "BGRA";
+    default:
+        return NULL;
+    }
+}
+
+// Creates a recording written to the file at path, or through callbacks if path is NULL
+static k4a_result_t create_recording(const char *path,
+                                     const k4a_record_io_callbacks_t *callbacks,
+                                     k4a_device_t device,
+                                     const k4a_device_configuration_t device_config,
+                                     k4a_record_t *recording_handle)
 {
-    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, path == NULL);
-    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, recording_handle == NULL);
     k4a_record_context_t *context = NULL;
     k4a_result_t result = K4A_RESULT_SUCCEEDED;
 
     context = k4a_record_t_create(recording_handle);
     result = K4A_RESULT_FROM_BOOL(context != NULL);
 
-    if (K4A_SUCCEEDED(result))
+    if (K4A_SUCCEEDED(result) && path == NULL)
+    {
+        context->file_path = "<I/O callbacks>";
+        context->streaming = true;
+
+        try
+        {
+            context->ebml_file = make_unique<StreamWriteIOCallback>(*callbacks);
+        }
+        catch (std::bad_alloc &)
+        {
+            LOG_ERROR("Failed to allocate the writer of the recording.", 0);
+            result = K4A_RESULT_FAILED;
+        }
+    }
+    else if (K4A_SUCCEEDED(result))
     {
         context->file_path = path;
 
         try
         {
-            context->ebml_file = make_unique<LargeFileIOCallback>(path, MODE_CREATE);
+            context->ebml_file = create_file_writer(path);
         }
         catch (std::ios_base::failure &e)
         {
@@ -42,17 +137,47 @@ k4a_result_t k4a_record_create(const char *path,
         }
     }
 
+    if (K4A_FAILED(result) && (context == NULL || context->ebml_file == nullptr) && callbacks != NULL &&
+        callbacks->close != NULL)
+    {
+        // Once the writer is created, it closes the callbacks when the recording is destroyed
+        callbacks->close(callbacks->context);
+    }
+
     if (K4A_SUCCEEDED(result))
     {
         context->device_config = device_config;
+        if (device != NULL)
+        {
+            // Raw depth payloads are a start option of the device, the matching track is set up here
+            k4a_device_start_options_t start_options = K4A_DEVICE_START_OPTIONS_INIT;
+            result = TRACE_CALL(k4a_device_get_start_options(device, &start_options));
+            context->raw_depth_payload = start_options.raw_depth_payload;
+        }
 
         context->timecode_scale = MATROSKA_TIMESCALE_NS;
+
+        const char *recording_index = environment_get_variable("K4A_RECORDING_INDEX");
+        context->write_recording_index = !context->streaming && recording_index != NULL &&
+                                         strcmp(recording_index, "1") == 0;
         context->camera_fps = k4a_convert_fps_to_uint(device_config.camera_fps);
         if (context->camera_fps == 0)
         {
             // Set camera FPS to 30 if no cameras are enabled so IMU can still be written.
             context->camera_fps = 30;
         }
+
+        if (K4A_SUCCEEDED(result) && context->raw_depth_payload)
+        {
+            if (device == NULL || device_config.depth_mode == K4A_DEPTH_MODE_OFF)
+            {
+                LOG_ERROR("Raw depth payloads are recorded with a depth_mode and the device to read the depth "
+                          "calibration from.",
+                          0);
+                result = K4A_RESULT_FAILED;
+            }
+            context->raw_depth_device = device;
+        }
     }
 
     uint32_t color_width = 0;
@@ -71,21 +196,13 @@ k4a_result_t k4a_record_create(const char *path,
     {
         if (device_config.color_resolution != K4A_COLOR_RESOLUTION_OFF)
         {
-            switch (device_config.color_format)
+            const char *format_name = get_color_format_name(device_config.color_format);
+            if (format_name != NULL)
+            {
+                color_mode_str << format_name << "_" << color_height << "P";
+            }
+            else
             {
-            case K4A_IMAGE_FORMAT_COLOR_NV12:
-                color_mode_str << "NV12_" << color_height << "P";
-                break;
-            case K4A_IMAGE_FORMAT_COLOR_YUY2:
-                color_mode_str << "YUY2_" << color_height << "P";
-                break;
-            case K4A_IMAGE_FORMAT_COLOR_MJPG:
-                color_mode_str << "MJPG_" << color_height << "P";
-                break;
-            case K4A_IMAGE_FORMAT_COLOR_BGRA32:
-                color_mode_str << "BGRA_" << color_height << "P";
-                break;
-            default:
                 LOG_ERROR("Unsupported color_format specified in recording: %d", device_config.color_format);
                 result = K4A_RESULT_FAILED;
             }
@@ -164,7 +281,8 @@ k4a_result_t k4a_record_create(const char *path,
             std::ostringstream track_uid_str;
             track_uid_str << track_uid;
             add_tag(context, "K4A_COLOR_TRACK", track_uid_str.str().c_str(), TAG_TARGET_TYPE_TRACK, track_uid);
-            add_tag(context, "K4A_COLOR_MODE", color_mode_str.str().c_str(), TAG_TARGET_TYPE_TRACK, track_uid);
+            context->color_mode_tag = add_tag(
+                context, "K4A_COLOR_MODE", color_mode_str.str().c_str(), TAG_TARGET_TYPE_TRACK, track_uid);
         }
         else
         {
@@ -175,7 +293,7 @@ k4a_result_t k4a_record_create(const char *path,
 
     if (K4A_SUCCEEDED(result))
     {
-        if (device_config.depth_mode == K4A_DEPTH_MODE_PASSIVE_IR)
+        if (device_config.depth_mode == K4A_DEPTH_MODE_PASSIVE_IR && !context->raw_depth_payload)
         {
             add_tag(context, "K4A_DEPTH_MODE", depth_mode_str);
         }
@@ -192,6 +310,19 @@ k4a_result_t k4a_record_create(const char *path,
                                              "V_MS/VFW/FOURCC",
                                              reinterpret_cast<uint8_t *>(&codec_info),
                                              sizeof(codec_info));
+            if (context->depth_track != nullptr && context->raw_depth_payload)
+            {
+                // Raw payloads vary in size, they are turned into depth and IR images at playback
+                codec_info.biCompression = K4A_FOURCC_DEPTH_RAW;
+                codec_info.biSizeImage = 0;
+                GetChild<KaxCodecPrivate>(*context->depth_track->track)
+                    .CopyBuffer(reinterpret_cast<uint8_t *>(&codec_info), sizeof(codec_info));
+            }
+            else if (context->depth_track != nullptr)
+            {
+                context->depth_track->gray16_encoding = GRAY16_ENCODING_BIG_ENDIAN;
+            }
+
             if (context->depth_track != nullptr)
             {
                 set_track_info_video(context->depth_track, depth_width, depth_height, context->camera_fps);
@@ -210,7 +341,7 @@ k4a_result_t k4a_record_create(const char *path,
         }
     }
 
-    if (K4A_SUCCEEDED(result) && device_config.depth_mode != K4A_DEPTH_MODE_OFF)
+    if (K4A_SUCCEEDED(result) && device_config.depth_mode != K4A_DEPTH_MODE_OFF && !context->raw_depth_payload)
     {
         // IR Track
         BITMAPINFOHEADER codec_info = {};
@@ -224,6 +355,7 @@ k4a_result_t k4a_record_create(const char *path,
                                       sizeof(codec_info));
         if (context->ir_track != nullptr)
         {
+            context->ir_track->gray16_encoding = GRAY16_ENCODING_BIG_ENDIAN;
             set_track_info_video(context->ir_track, depth_width, depth_height, context->camera_fps);
 
             uint64_t track_uid = GetChild<KaxTrackUID>(*context->ir_track->track).GetValue();
@@ -362,6 +494,29 @@ k4a_result_t k4a_record_create(const char *path,
     return result;
 }
 
+k4a_result_t k4a_record_create(const char *path,
+                               k4a_device_t device,
+                               const k4a_device_configuration_t device_config,
+                               k4a_record_t *recording_handle)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, path == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, recording_handle == NULL);
+
+    return create_recording(path, NULL, device, device_config, recording_handle);
+}
+
+k4a_result_t k4a_record_create_callbacks(const k4a_record_io_callbacks_t *callbacks,
+                                         k4a_device_t device,
+                                         const k4a_device_configuration_t device_config,
+                                         k4a_record_t *recording_handle)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, callbacks == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, callbacks->write == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, recording_handle == NULL);
+
+    return create_recording(NULL, callbacks, device, device_config, recording_handle);
+}
+
 k4a_result_t k4a_record_add_tag(const k4a_record_t recording_handle, const char *name, const char *value)
 {
     RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_record_t, recording_handle);
@@ -404,6 +559,230 @@ k4a_result_t k4a_record_add_attachment(const k4a_record_t recording_handle,
     return K4A_RESULT_FROM_BOOL(attached != NULL);
 }
 
+// Applies the depth codec and byte order of the recording to the codec private and encoding of the depth and IR tracks
+static void update_gray16_tracks(k4a_record_context_t *context)
+{
+    track_header_t *tracks[] = { context->depth_track, context->ir_track };
+    for (track_header_t *track : tracks)
+    {
+        // Raw depth payloads are stored as they are
+        if (track != nullptr && !(track == context->depth_track && context->raw_depth_payload))
+        {
+            KaxCodecPrivate &codec_private = GetChild<KaxCodecPrivate>(*track->track);
+            assert(codec_private.GetSize() == sizeof(BITMAPINFOHEADER));
+            BITMAPINFOHEADER codec_info;
+            memcpy(&codec_info, codec_private.GetBuffer(), sizeof(codec_info));
+
+            if (context->depth_codec == K4A_RECORD_DEPTH_CODEC_RVL)
+            {
+                codec_info.biCompression = K4A_FOURCC_GRAY16_RVL;
+                codec_info.biSizeImage = 0; // RVL is variable size
+                track->gray16_encoding = GRAY16_ENCODING_RVL;
+            }
+            else
+            {
+                codec_info.biCompression = context->gray16_little_endian ? K4A_FOURCC_GRAY16_LITTLE_ENDIAN :
+                                                                           K4A_FOURCC_GRAY16_BIG_ENDIAN;
+                codec_info.biSizeImage = sizeof(uint16_t) * codec_info.biWidth * codec_info.biHeight;
+                track->gray16_encoding = context->gray16_little_endian ? GRAY16_ENCODING_NONE :
+                                                                         GRAY16_ENCODING_BIG_ENDIAN;
+            }
+            codec_private.CopyBuffer(reinterpret_cast<uint8_t *>(&codec_info), sizeof(codec_info));
+        }
+    }
+}
+
+k4a_result_t k4a_record_set_gray16_little_endian(const k4a_record_t recording_handle, bool little_endian)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_record_t, recording_handle);
+
+    k4a_record_context_t *context = k4a_record_t_get_context(recording_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+
+    if (context->header_written)
+    {
+        LOG_ERROR("The depth and IR byte order must be set before the recording header is written.", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    context->gray16_little_endian = little_endian;
+    update_gray16_tracks(context);
+
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t k4a_record_set_depth_codec(const k4a_record_t recording_handle, k4a_record_depth_codec_t codec)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_record_t, recording_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, codec != K4A_RECORD_DEPTH_CODEC_RAW && codec != K4A_RECORD_DEPTH_CODEC_RVL);
+
+    k4a_record_context_t *context = k4a_record_t_get_context(recording_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+
+    if (context->header_written)
+    {
+        LOG_ERROR("The depth codec must be set before the recording header is written.", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    context->depth_codec = codec;
+    update_gray16_tracks(context);
+
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t k4a_record_set_color_codec(const k4a_record_t recording_handle,
+                                        k4a_record_color_codec_t codec,
+                                        uint32_t quality)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_record_t, recording_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED,
+                        codec != K4A_RECORD_COLOR_CODEC_NATIVE && codec != K4A_RECORD_COLOR_CODEC_MJPG);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, codec == K4A_RECORD_COLOR_CODEC_MJPG && (quality < 1 || quality > 100));
+
+    k4a_record_context_t *context = k4a_record_t_get_context(recording_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+
+    if (context->header_written)
+    {
+        LOG_ERROR("The color codec must be set before the recording header is written.", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    if (context->color_track == nullptr)
+    {
+        LOG_ERROR("The color codec can only be set on recordings with a color track.", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    if (codec == K4A_RECORD_COLOR_CODEC_MJPG && context->device_config.color_format == K4A_IMAGE_FORMAT_COLOR_MJPG)
+    {
+        LOG_ERROR("The color track is already recorded as MJPG.", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    // The track is played back as the format it is stored in
+    k4a_image_format_t format = codec == K4A_RECORD_COLOR_CODEC_MJPG ? K4A_IMAGE_FORMAT_COLOR_MJPG :
+                                                                       context->device_config.color_format;
+    KaxCodecPrivate &codec_private = GetChild<KaxCodecPrivate>(*context->color_track->track);
+    assert(codec_private.GetSize() == sizeof(BITMAPINFOHEADER));
+    BITMAPINFOHEADER codec_info;
+    memcpy(&codec_info, codec_private.GetBuffer(), sizeof(codec_info));
+    RETURN_IF_ERROR(populate_bitmap_info_header(&codec_info, codec_info.biWidth, codec_info.biHeight, format));
+    codec_private.CopyBuffer(reinterpret_cast<uint8_t *>(&codec_info), sizeof(codec_info));
+
+    if (context->color_mode_tag != nullptr)
+    {
+        std::ostringstream color_mode_str;
+        color_mode_str << get_color_format_name(format) << "_" << codec_info.biHeight << "P";
+        GetChild<KaxTagString>(GetChild<KaxTagSimple>(*context->color_mode_tag)).SetValueUTF8(color_mode_str.str());
+    }
+
+    context->color_codec = codec;
+    context->color_quality = quality;
+
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t k4a_record_set_write_options(const k4a_record_t recording_handle,
+                                          const k4a_record_write_options_t *options)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_record_t, recording_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, options == NULL);
+    // Block timestamps are 16 bit offsets from their cluster, which limits the cluster length
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED,
+                        options->cluster_length_usec < 1000 ||
+                            options->cluster_length_usec > MAX_CLUSTER_LENGTH_NS / 1_us);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, options->write_delay_usec < (uint64_t)options->cluster_length_usec * 2);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED,
+                        options->overflow_policy < K4A_RECORD_OVERFLOW_BLOCK ||
+                            options->overflow_policy > K4A_RECORD_OVERFLOW_DROP_COLOR);
+
+    k4a_record_context_t *context = k4a_record_t_get_context(recording_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+
+    if (context->header_written)
+    {
+        LOG_ERROR("The write options must be set before the recording header is written.", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    context->cluster_length_ns = options->cluster_length_usec * 1_us;
+    context->cluster_write_delay_ns = options->write_delay_usec * 1_us;
+    context->max_pending_bytes = options->max_pending_bytes;
+    context->overflow_policy = options->overflow_policy;
+    context->block_timeout_ns = options->block_timeout_usec * 1_us;
+
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t k4a_record_set_segment_limits(const k4a_record_t recording_handle,
+                                          uint64_t max_segment_usec,
+                                          uint64_t max_segment_bytes)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_record_t, recording_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, max_segment_usec > UINT64_MAX / 1_us);
+
+    k4a_record_context_t *context = k4a_record_t_get_context(recording_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+
+    if (context->header_written)
+    {
+        LOG_ERROR("The segment limits must be set before the recording header is written.", 0);
+        return K4A_RESULT_FAILED;
+    }
+    if (context->streaming)
+    {
+        LOG_ERROR("A recording written through I/O callbacks can't be split into segments.", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    try
+    {
+        context->base_path = context->file_path;
+    }
+    catch (std::bad_alloc &)
+    {
+        LOG_ERROR("Failed to allocate the path of the recording segments.", 0);
+        return K4A_RESULT_FAILED;
+    }
+    context->max_segment_ns = max_segment_usec * 1_us;
+    context->max_segment_bytes = max_segment_bytes;
+
+    if ((max_segment_usec > 0 || max_segment_bytes > 0) && context->segment_index_tag == nullptr)
+    {
+        context->segment_index_tag = add_tag(context, "K4A_SEGMENT_INDEX", "0");
+    }
+
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t k4a_record_set_preallocation(const k4a_record_t recording_handle,
+                                         uint64_t preallocation_bytes,
+                                         uint32_t cues_reserve_bytes)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_record_t, recording_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, preallocation_bytes > UINT64_MAX / 4);
+
+    k4a_record_context_t *context = k4a_record_t_get_context(recording_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+
+    if (context->header_written)
+    {
+        LOG_ERROR("The preallocation must be set before the recording header is written.", 0);
+        return K4A_RESULT_FAILED;
+    }
+    if (context->streaming)
+    {
+        LOG_ERROR("A recording written through I/O callbacks has no disk space to reserve.", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    context->preallocation_bytes = preallocation_bytes;
+    context->cues_reserve_bytes = cues_reserve_bytes;
+    return K4A_RESULT_SUCCEEDED;
+}
+
 k4a_result_t k4a_record_add_imu_track(const k4a_record_t recording_handle)
 {
     RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_record_t, recording_handle);
@@ -441,6 +820,48 @@ k4a_result_t k4a_record_add_imu_track(const k4a_record_t recording_handle)
     return K4A_RESULT_SUCCEEDED;
 }
 
+k4a_result_t k4a_record_set_imu_packing(const k4a_record_t recording_handle, uint32_t pack_duration_usec)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_record_t, recording_handle);
+
+    k4a_record_context_t *context = k4a_record_t_get_context(recording_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+
+    if (context->header_written)
+    {
+        LOG_ERROR("The IMU packing must be set before the recording header is written.", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    if (!context->imu_track)
+    {
+        LOG_ERROR("The IMU track needs to be added with k4a_record_add_imu_track() before its packing is set.", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    if (context->imu_packing_ns > 0)
+    {
+        LOG_ERROR("The IMU packing has already been set for this recording.", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    if (pack_duration_usec == 0)
+    {
+        return K4A_RESULT_SUCCEEDED;
+    }
+
+    // Each pack is stored as a single frame, instead of lacing the samples of a cluster into one block group
+    context->imu_packing_ns = pack_duration_usec * 1_us;
+    context->imu_track->high_freq_data = false;
+
+    uint64_t track_uid = GetChild<KaxTrackUID>(*context->imu_track->track).GetValue();
+    std::ostringstream packing_str;
+    packing_str << pack_duration_usec;
+    add_tag(context, "K4A_IMU_PACKING_USEC", packing_str.str().c_str(), TAG_TARGET_TYPE_TRACK, track_uid);
+
+    return K4A_RESULT_SUCCEEDED;
+}
+
 k4a_result_t k4a_record_add_custom_video_track(const k4a_record_t recording_handle,
                                                const char *track_name,
                                                const char *codec_id,
@@ -521,71 +942,111 @@ k4a_result_t k4a_record_add_custom_subtitle_track(const k4a_record_t recording_h
     return K4A_RESULT_SUCCEEDED;
 }
 
-k4a_result_t k4a_record_write_header(const k4a_record_t recording_handle)
+// Passes the header of a streamed recording on to its callbacks. The segment is given an unknown size first, since its
+// size can't be written back at the end.
+static void finish_stream_header(k4a_record_context_t *context)
 {
-    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_record_t, recording_handle);
+    StreamWriteIOCallback *stream_io = dynamic_cast<StreamWriteIOCallback *>(context->ebml_file.get());
+    assert(stream_io != NULL);
 
-    k4a_record_context_t *context = k4a_record_t_get_context(recording_handle);
-    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+    // The 8 byte size field follows the 4 byte Segment ID, all size bits set marks the size as unknown
+    static const uint8_t unknown_size[8] = { 0x01, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+    uint64_t end_position = stream_io->getFilePointer();
+    stream_io->setFilePointer((int64_t)context->file_segment->GetElementPosition() + 4);
+    stream_io->write(unknown_size, sizeof(unknown_size));
+    stream_io->setFilePointer((int64_t)end_position);
 
-    if (context->header_written)
+    stream_io->commit();
+}
+
+// Adds the depth calibration the depth engine needs to play raw depth payloads back
+static k4a_result_t add_raw_depth_calibration(k4a_record_context_t *context)
+{
+    size_t calibration_size = 0;
+    k4a_buffer_result_t buffer_result = TRACE_BUFFER_CALL(
+        k4a_device_get_raw_depth_calibration(context->raw_depth_device, NULL, &calibration_size));
+    if (buffer_result != K4A_BUFFER_RESULT_TOO_SMALL)
     {
-        LOG_ERROR("The header for this recording has already been written.", 0);
+        LOG_ERROR("The depth calibration of raw depth payloads is read once the cameras are started.", 0);
         return K4A_RESULT_FAILED;
     }
 
+    std::vector<uint8_t> calibration_buffer;
     try
     {
-        // Make sure we're at the beginning of the file in case we're rewriting a file.
-        context->ebml_file->setFilePointer(0, libebml::seek_beginning);
-
-        { // Render Ebml header
-            EbmlHead file_head;
+        calibration_buffer.resize(calibration_size);
+    }
+    catch (std::bad_alloc &)
+    {
+        LOG_ERROR("Failed to allocate the %zu byte depth calibration.", calibration_size);
+        return K4A_RESULT_FAILED;
+    }
 
-            GetChild<EDocType>(file_head).SetValue("matroska");
-            GetChild<EDocTypeVersion>(file_head).SetValue(2);
-            GetChild<EDocTypeReadVersion>(file_head).SetValue(2);
+    buffer_result = TRACE_BUFFER_CALL(
+        k4a_device_get_raw_depth_calibration(context->raw_depth_device, calibration_buffer.data(), &calibration_size));
+    if (buffer_result != K4A_BUFFER_RESULT_SUCCEEDED)
+    {
+        return K4A_RESULT_FAILED;
+    }
 
-            file_head.Render(*context->ebml_file, true);
-        }
+    KaxAttached *attached = add_attachment(context,
+                                           "depth_calibration.bin",
+                                           "application/octet-stream",
+                                           calibration_buffer.data(),
+                                           calibration_size);
+    if (attached == NULL)
+    {
+        return K4A_RESULT_FAILED;
+    }
+    add_tag(context,
+            "K4A_DEPTH_CALIBRATION_FILE",
+            "depth_calibration.bin",
+            TAG_TARGET_TYPE_ATTACHMENT,
+            get_attachment_uid(attached));
+    return K4A_RESULT_SUCCEEDED;
+}
 
-        // Recordings can get very large, so pad the length field up to 8 bytes from the start.
-        context->file_segment->WriteHead(*context->ebml_file, 8);
+k4a_result_t k4a_record_write_header(const k4a_record_t recording_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_record_t, recording_handle);
 
-        { // Write void blocks to reserve space for seeking metadata and the segment info so they can be updated at
-          // the end
-            context->seek_void = make_unique<EbmlVoid>();
-            context->seek_void->SetSize(1024);
-            context->seek_void->Render(*context->ebml_file);
+    k4a_record_context_t *context = k4a_record_t_get_context(recording_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
 
-            context->segment_info_void = make_unique<EbmlVoid>();
-            context->segment_info_void->SetSize(256);
-            context->segment_info_void->Render(*context->ebml_file);
-        }
+    if (context->header_written)
+    {
+        LOG_ERROR("The header for this recording has already been written.", 0);
+        return K4A_RESULT_FAILED;
+    }
 
-        { // Write tracks
-            auto &tracks = GetChild<KaxTracks>(*context->file_segment);
-            tracks.Render(*context->ebml_file);
-        }
+    if (context->imu_packing_ns >= context->cluster_write_delay_ns)
+    {
+        // A pack is only queued once complete, it would be older than the write delay by then
+        LOG_ERROR("The IMU pack duration of %llu usec must be shorter than the write delay of %llu usec.",
+                  (unsigned long long)(context->imu_packing_ns / 1_us),
+                  (unsigned long long)(context->cluster_write_delay_ns / 1_us));
+        return K4A_RESULT_FAILED;
+    }
 
-        { // Write attachments
-            auto &attachments = GetChild<KaxAttachments>(*context->file_segment);
-            attachments.Render(*context->ebml_file);
-        }
+    if (context->raw_depth_device != NULL)
+    {
+        RETURN_IF_ERROR(add_raw_depth_calibration(context));
+        context->raw_depth_device = NULL;
+    }
 
-        { // Write tags with a void block after to make editing easier
-            auto &tags = GetChild<KaxTags>(*context->file_segment);
-            tags.Render(*context->ebml_file);
+    RETURN_IF_ERROR(write_file_header(context));
 
-            context->tags_void = make_unique<EbmlVoid>();
-            context->tags_void->SetSize(1024);
-            context->tags_void->Render(*context->ebml_file);
-        }
-    }
-    catch (std::ios_base::failure &e)
+    if (context->streaming)
     {
-        LOG_ERROR("Failed to write recording header '%s': %s", context->file_path, e.what());
-        return K4A_RESULT_FAILED;
+        try
+        {
+            finish_stream_header(context);
+        }
+        catch (std::ios_base::failure &e)
+        {
+            LOG_ERROR("Failed to write recording header '%s': %s", context->file_path, e.what());
+            return K4A_RESULT_FAILED;
+        }
     }
 
     RETURN_IF_ERROR(start_matroska_writer_thread(context));
@@ -615,12 +1076,41 @@ k4a_result_t k4a_record_write_capture(const k4a_record_t recording_handle, k4a_c
         k4a_capture_get_ir_image(capture),
     };
     k4a_image_format_t expected_formats[] = { context->device_config.color_format,
-                                              K4A_IMAGE_FORMAT_DEPTH16,
+                                              context->raw_depth_payload ? K4A_IMAGE_FORMAT_CUSTOM :
+                                                                                         K4A_IMAGE_FORMAT_DEPTH16,
                                               K4A_IMAGE_FORMAT_IR16 };
     track_header_t *tracks[] = { context->color_track, context->depth_track, context->ir_track };
     static_assert(arraysize(images) == arraysize(tracks), "Invalid mapping from images to track");
     static_assert(arraysize(images) == arraysize(expected_formats), "Invalid mapping from images to formats");
 
+    if (context->overflow_policy == K4A_RECORD_OVERFLOW_DROP_CAPTURE)
+    {
+        // Captures only go in the write queue as a whole
+        uint64_t capture_size = 0;
+        uint32_t image_count = 0;
+        for (size_t i = 0; i < arraysize(images); i++)
+        {
+            if (images[i])
+            {
+                capture_size += k4a_image_get_size(images[i]);
+                image_count++;
+            }
+        }
+
+        if (drop_if_write_queue_full(context, capture_size, image_count))
+        {
+            LOG_WARNING("The write queue is full, dropping a capture of %u images.", image_count);
+            for (size_t i = 0; i < arraysize(images); i++)
+            {
+                if (images[i])
+                {
+                    k4a_image_release(images[i]);
+                }
+            }
+            return K4A_RESULT_FAILED;
+        }
+    }
+
     k4a_result_t result = K4A_RESULT_SUCCEEDED;
     for (size_t i = 0; i < arraysize(images); i++)
     {
@@ -631,32 +1121,58 @@ k4a_result_t k4a_record_write_capture(const k4a_record_t recording_handle, k4a_c
             if (image_buffer != NULL && buffer_size > 0)
             {
                 k4a_image_format_t image_format = k4a_image_get_format(images[i]);
-                if (image_format == expected_formats[i])
+                if (image_format == expected_formats[i] && tracks[i] == context->color_track &&
+                    context->color_codec != K4A_RECORD_COLOR_CODEC_NATIVE)
                 {
-                    // Create a copy of the image buffer for writing to file.
-                    assert(buffer_size <= UINT32_MAX);
-                    DataBuffer *data_buffer = new (std::nothrow)
-                        DataBuffer(image_buffer, (uint32)buffer_size, NULL, true);
-                    if (image_format == K4A_IMAGE_FORMAT_DEPTH16 || image_format == K4A_IMAGE_FORMAT_IR16)
+                    // Transcoded color images are queued to the color encoder threads
+                    std::shared_ptr<color_encode_job_t> color_job;
+                    try
+                    {
+                        color_job = std::make_shared<color_encode_job_t>();
+                    }
+                    catch (std::bad_alloc &)
                     {
-                        // 16 bit grayscale needs to be converted to big-endian in the file.
-                        assert(data_buffer->Size() % sizeof(uint16_t) == 0);
-                        uint16_t *data_buffer_raw = reinterpret_cast<uint16_t *>(data_buffer->Buffer());
-                        for (size_t j = 0; j < data_buffer->Size() / sizeof(uint16_t); j++)
+                        LOG_ERROR("Failed to allocate the encoder job of a %zu byte color image.", buffer_size);
+                        result = K4A_RESULT_FAILED;
+                    }
+
+                    if (color_job != nullptr)
+                    {
+                        k4a_image_reference(images[i]);
+                        color_job->image = images[i];
+
+                        uint64_t timestamp_ns = k4a_image_get_device_timestamp_usec(images[i]) * 1000;
+                        k4a_result_t tmp_result = TRACE_CALL(
+                            write_track_data(context, tracks[i], timestamp_ns, NULL, color_job));
+                        if (K4A_FAILED(tmp_result))
                         {
-                            data_buffer_raw[j] = swap_bytes_16(data_buffer_raw[j]);
+                            result = tmp_result;
                         }
                     }
-
-                    uint64_t timestamp_ns = k4a_image_get_device_timestamp_usec(images[i]) * 1000;
-                    k4a_result_t tmp_result = TRACE_CALL(
-                        write_track_data(context, tracks[i], timestamp_ns, data_buffer));
-                    if (K4A_FAILED(tmp_result))
+                }
+                else if (image_format == expected_formats[i])
+                {
+                    // Only a reference on the image is queued, big-endian and RVL depth and IR tracks are
+                    // encoded by write_cluster() on the writer thread.
+                    assert(buffer_size <= UINT32_MAX);
+                    DataBuffer *data_buffer = new (std::nothrow) ImageDataBuffer(images[i]);
+                    if (data_buffer == NULL)
                     {
-                        // Write as many of the image buffers as possible, even if some fail due to timestamp.
-                        result = tmp_result;
-                        data_buffer->FreeBuffer(*data_buffer);
-                        delete data_buffer;
+                        LOG_ERROR("Failed to allocate the recording buffer of a %zu byte image.", buffer_size);
+                        result = K4A_RESULT_FAILED;
+                    }
+                    else
+                    {
+                        uint64_t timestamp_ns = k4a_image_get_device_timestamp_usec(images[i]) * 1000;
+                        k4a_result_t tmp_result = TRACE_CALL(
+                            write_track_data(context, tracks[i], timestamp_ns, data_buffer));
+                        if (K4A_FAILED(tmp_result))
+                        {
+                            // Write as many of the image buffers as possible, even if some fail due to timestamp.
+                            result = tmp_result;
+                            data_buffer->FreeBuffer(*data_buffer);
+                            delete data_buffer;
+                        }
                     }
                 }
                 else
@@ -672,6 +1188,34 @@ k4a_result_t k4a_record_write_capture(const k4a_record_t recording_handle, k4a_c
     return result;
 }
 
+// Writes the packed IMU samples as one frame, at the timestamp of the first sample. Called with imu_pack_lock held.
+static k4a_result_t write_imu_pack(k4a_record_context_t *context)
+{
+    if (context->imu_pack.empty())
+    {
+        return K4A_RESULT_SUCCEEDED;
+    }
+
+    uint64_t timestamp_ns = context->imu_pack.front().acc_timestamp_ns;
+    uint32_t size = (uint32_t)(context->imu_pack.size() * sizeof(matroska_imu_sample_t));
+    DataBuffer *data_buffer = new (std::nothrow)
+        DataBuffer(reinterpret_cast<binary *>(context->imu_pack.data()), size, NULL, true);
+    context->imu_pack.clear();
+    if (data_buffer == NULL)
+    {
+        LOG_ERROR("Failed to allocate imu pack.", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    k4a_result_t result = TRACE_CALL(write_track_data(context, context->imu_track, timestamp_ns, data_buffer));
+    if (K4A_FAILED(result))
+    {
+        data_buffer->FreeBuffer(*data_buffer);
+        delete data_buffer;
+    }
+    return result;
+}
+
 k4a_result_t k4a_record_write_imu_sample(const k4a_record_t recording_handle, k4a_imu_sample_t imu_sample)
 {
     RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_record_t, recording_handle);
@@ -701,8 +1245,44 @@ k4a_result_t k4a_record_write_imu_sample(const k4a_record_t recording_handle, k4
         sample_data.gyro_data[i] = imu_sample.gyro_sample.v[i];
     }
 
+    if (context->imu_packing_ns > 0)
+    {
+        try
+        {
+            std::lock_guard<std::mutex> lock(context->imu_pack_lock);
+
+            k4a_result_t result = K4A_RESULT_SUCCEEDED;
+            if (!context->imu_pack.empty())
+            {
+                uint64_t pack_start_ns = context->imu_pack.front().acc_timestamp_ns;
+                if (sample_data.acc_timestamp_ns < pack_start_ns ||
+                    sample_data.acc_timestamp_ns - pack_start_ns >= context->imu_packing_ns)
+                {
+                    result = TRACE_CALL(write_imu_pack(context));
+                }
+            }
+            context->imu_pack.push_back(sample_data);
+            return result;
+        }
+        catch (std::system_error &e)
+        {
+            LOG_ERROR("Failed to pack imu sample: %s", e.what());
+            return K4A_RESULT_FAILED;
+        }
+        catch (std::bad_alloc &)
+        {
+            LOG_ERROR("Failed to allocate imu pack.", 0);
+            return K4A_RESULT_FAILED;
+        }
+    }
+
     DataBuffer *data_buffer = new (std::nothrow)
         DataBuffer(reinterpret_cast<binary *>(&sample_data), sizeof(matroska_imu_sample_t), NULL, true);
+    if (data_buffer == NULL)
+    {
+        LOG_ERROR("Failed to allocate imu sample.", 0);
+        return K4A_RESULT_FAILED;
+    }
     k4a_result_t result = write_track_data(context, context->imu_track, sample_data.acc_timestamp_ns, data_buffer);
     if (K4A_FAILED(result))
     {
@@ -714,34 +1294,45 @@ k4a_result_t k4a_record_write_imu_sample(const k4a_record_t recording_handle, k4
     return K4A_RESULT_SUCCEEDED;
 }
 
-k4a_result_t k4a_record_write_custom_track_data(const k4a_record_t recording_handle,
-                                                const char *track_name,
-                                                uint64_t device_timestamp_usec,
-                                                uint8_t *buffer,
-                                                size_t buffer_size)
+// Returns the custom track data is written to, or NULL if it can't be written yet
+static track_header_t *find_custom_track(k4a_record_context_t *context, const char *track_name)
 {
-    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_record_t, recording_handle);
-    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, track_name == NULL);
-    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, buffer == NULL);
-
-    k4a_record_context_t *context = k4a_record_t_get_context(recording_handle);
-    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
-
     if (!context->header_written)
     {
         LOG_ERROR("The recording header needs to be written before any track data.", 0);
-        return K4A_RESULT_FAILED;
+        return NULL;
     }
 
     auto itr = context->tracks.find(track_name);
     if (itr == context->tracks.end())
     {
         LOG_ERROR("The custom track does not exist: %s", track_name);
-        return K4A_RESULT_FAILED;
+        return NULL;
     }
     if (!itr->second.custom_track)
     {
         LOG_ERROR("Custom track data cannot be written to built-in track: %s", track_name);
+        return NULL;
+    }
+    return &itr->second;
+}
+
+k4a_result_t k4a_record_write_custom_track_data(const k4a_record_t recording_handle,
+                                                const char *track_name,
+                                                uint64_t device_timestamp_usec,
+                                                uint8_t *buffer,
+                                                size_t buffer_size)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_record_t, recording_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, track_name == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, buffer == NULL);
+
+    k4a_record_context_t *context = k4a_record_t_get_context(recording_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+
+    track_header_t *track = find_custom_track(context, track_name);
+    if (track == NULL)
+    {
         return K4A_RESULT_FAILED;
     }
 
@@ -749,8 +1340,7 @@ k4a_result_t k4a_record_write_custom_track_data(const k4a_record_t recording_han
     assert(buffer_size <= UINT32_MAX);
     DataBuffer *data_buffer = new DataBuffer(buffer, (uint32_t)buffer_size, NULL, true);
 
-    k4a_result_t result = TRACE_CALL(
-        write_track_data(context, &itr->second, device_timestamp_usec * 1000, data_buffer));
+    k4a_result_t result = TRACE_CALL(write_track_data(context, track, device_timestamp_usec * 1000, data_buffer));
     if (K4A_FAILED(result))
     {
         // Clean up the data_buffer if write_track_data failed.
@@ -761,6 +1351,114 @@ k4a_result_t k4a_record_write_custom_track_data(const k4a_record_t recording_han
     return result;
 }
 
+// Queues the blocks of k4a_record_write_custom_track_blocks(). taken_count is the number of blocks whose buffer was
+// handed to a DataBuffer, which copied it or releases it through buffer_release_cb.
+static k4a_result_t queue_custom_track_blocks(const k4a_record_t recording_handle,
+                                              const char *track_name,
+                                              const k4a_record_custom_track_block_t *blocks,
+                                              size_t block_count,
+                                              k4a_memory_destroy_cb_t *buffer_release_cb,
+                                              void *buffer_release_cb_context,
+                                              size_t *taken_count)
+{
+    *taken_count = 0;
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_record_t, recording_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, track_name == NULL);
+
+    k4a_record_context_t *context = k4a_record_t_get_context(recording_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+
+    track_header_t *track = find_custom_track(context, track_name);
+    if (track == NULL)
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    std::vector<uint64_t> timestamps_ns;
+    std::vector<DataBuffer *> buffers;
+    k4a_result_t result = K4A_RESULT_SUCCEEDED;
+    try
+    {
+        timestamps_ns.reserve(block_count);
+        buffers.reserve(block_count);
+        for (size_t i = 0; i < block_count; i++)
+        {
+            if (blocks[i].buffer == NULL || blocks[i].buffer_size > UINT32_MAX)
+            {
+                LOG_ERROR("Invalid buffer for custom track block %zu of %zu.", i, block_count);
+                result = K4A_RESULT_FAILED;
+                break;
+            }
+
+            uint32_t size = (uint32_t)blocks[i].buffer_size;
+            if (buffer_release_cb != NULL)
+            {
+                buffers.push_back(
+                    new CallbackDataBuffer(blocks[i].buffer, size, buffer_release_cb, buffer_release_cb_context));
+            }
+            else
+            {
+                // Create a copy of the buffer for writing to file.
+                buffers.push_back(new DataBuffer(blocks[i].buffer, size, NULL, true));
+            }
+            timestamps_ns.push_back(blocks[i].device_timestamp_usec * 1000);
+            (*taken_count)++;
+        }
+    }
+    catch (std::bad_alloc &)
+    {
+        LOG_ERROR("Failed to allocate the custom track blocks.", 0);
+        result = K4A_RESULT_FAILED;
+    }
+
+    size_t queued_count = 0;
+    if (K4A_SUCCEEDED(result))
+    {
+        result = TRACE_CALL(write_track_data_blocks(
+            context, track, timestamps_ns.data(), buffers.data(), buffers.size(), &queued_count));
+    }
+
+    // Clean up the buffers the recording didn't take.
+    for (size_t i = queued_count; i < buffers.size(); i++)
+    {
+        buffers[i]->FreeBuffer(*buffers[i]);
+        delete buffers[i];
+    }
+    return result;
+}
+
+k4a_result_t k4a_record_write_custom_track_blocks(const k4a_record_t recording_handle,
+                                                  const char *track_name,
+                                                  const k4a_record_custom_track_block_t *blocks,
+                                                  size_t block_count,
+                                                  k4a_memory_destroy_cb_t *buffer_release_cb,
+                                                  void *buffer_release_cb_context)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, blocks == NULL && block_count > 0);
+
+    size_t taken_count = 0;
+    k4a_result_t result = TRACE_CALL(queue_custom_track_blocks(recording_handle,
+                                                               track_name,
+                                                               blocks,
+                                                               block_count,
+                                                               buffer_release_cb,
+                                                               buffer_release_cb_context,
+                                                               &taken_count));
+
+    // The buffers handed over are released whatever the result
+    if (buffer_release_cb != NULL)
+    {
+        for (size_t i = taken_count; i < block_count; i++)
+        {
+            if (blocks[i].buffer != NULL)
+            {
+                buffer_release_cb(blocks[i].buffer, buffer_release_cb_context);
+            }
+        }
+    }
+    return result;
+}
+
 k4a_result_t k4a_record_flush(const k4a_record_t recording_handle)
 {
     RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_record_t, recording_handle);
@@ -772,6 +1470,13 @@ k4a_result_t k4a_record_flush(const k4a_record_t recording_handle)
 
     try
     {
+        if (context->imu_packing_ns > 0)
+        {
+            // Queue the partial pack so the flush writes every sample so far
+            std::lock_guard<std::mutex> pack_lock(context->imu_pack_lock);
+            result = TRACE_CALL(write_imu_pack(context));
+        }
+
         // Lock the writer thread first so we don't have conflicts
         std::lock_guard<std::mutex> writer_lock(context->writer_lock);
 
@@ -782,6 +1487,7 @@ k4a_result_t k4a_record_flush(const k4a_record_t recording_handle)
         }
 
         std::lock_guard<std::mutex> cluster_lock(context->pending_cluster_lock);
+        stage_pending_track_data(context);
 
         if (!context->pending_clusters.empty())
         {
@@ -796,89 +1502,41 @@ k4a_result_t k4a_record_flush(const k4a_record_t recording_handle)
                 }
             }
             context->pending_clusters.clear();
+            context->written_timestamp_hint.store(context->last_written_timestamp);
         }
-
-        auto &segment_info = GetChild<KaxInfo>(*context->file_segment);
-
-        uint64_t current_position = context->ebml_file->getFilePointer();
-
-        // Update segment info
-        GetChild<KaxDuration>(segment_info)
-            .SetValue(
-                (double)((context->most_recent_timestamp - context->start_timestamp_offset) / context->timecode_scale));
-        context->segment_info_void->ReplaceWith(segment_info, *context->ebml_file);
-
-        // Render cues
-        auto &cues = GetChild<KaxCues>(*context->file_segment);
-        cues.Render(*context->ebml_file);
-
-        // Update tags
-        auto &tags = GetChild<KaxTags>(*context->file_segment);
-        if (tags.GetElementPosition() > 0)
+        context->pending_bytes = 0;
+        context->pending_overflow = false;
+        if (context->pending_space_notify)
         {
-            context->ebml_file->setFilePointer((int64_t)tags.GetElementPosition());
-            tags.Render(*context->ebml_file);
-            if (tags.GetEndPosition() != context->tags_void->GetElementPosition())
-            {
-                // Rewrite the void block after tags
-                EbmlVoid tags_void;
-                tags_void.SetSize(context->tags_void->GetSize() -
-                                  (tags.GetEndPosition() - context->tags_void->GetElementPosition()));
-                tags_void.Render(*context->ebml_file);
-            }
+            context->pending_space_notify->notify_all();
         }
 
-        { // Update seek info
-            auto &seek_head = GetChild<KaxSeekHead>(*context->file_segment);
-            // RemoveAll() has a bug and does not free the elements before emptying the list.
-            for (auto element : seek_head.GetElementList())
-            {
-                delete element;
-            }
-            seek_head.RemoveAll(); // Remove any seek entries from previous flushes
-
-            seek_head.IndexThis(segment_info, *context->file_segment);
-
-            auto &tracks = GetChild<KaxTracks>(*context->file_segment);
-            if (tracks.GetElementPosition() > 0)
-            {
-                seek_head.IndexThis(tracks, *context->file_segment);
-            }
-
-            auto &attachments = GetChild<KaxAttachments>(*context->file_segment);
-            if (attachments.GetElementPosition() > 0)
-            {
-                seek_head.IndexThis(attachments, *context->file_segment);
-            }
+        if (context->streaming)
+        {
+            // The header of a streamed recording has already been passed on, only the clusters are written.
+            return result;
+        }
 
-            if (tags.GetElementPosition() > 0)
+        if (context->dropped_sample_count > 0)
+        {
+            std::ostringstream dropped_str;
+            dropped_str << context->dropped_sample_count;
+            if (context->dropped_samples_tag == nullptr)
             {
-                seek_head.IndexThis(tags, *context->file_segment);
+                context->dropped_samples_tag = add_tag(context, "K4A_DROPPED_SAMPLE_COUNT", dropped_str.str().c_str());
             }
-
-            if (cues.GetElementPosition() > 0)
+            else
             {
-                seek_head.IndexThis(cues, *context->file_segment);
+                GetChild<KaxTagString>(GetChild<KaxTagSimple>(*context->dropped_samples_tag))
+                    .SetValueUTF8(dropped_str.str());
             }
-
-            context->seek_void->ReplaceWith(seek_head, *context->ebml_file);
         }
 
-        // Update the file segment head to write the current size
-        context->ebml_file->setFilePointer(0, seek_end);
-        uint64 segment_size = context->ebml_file->getFilePointer() - context->file_segment->GetElementPosition() -
-                              context->file_segment->HeadSize();
-        // Segment size can only be set once normally, so force the flag.
-        context->file_segment->SetSizeInfinite(true);
-        if (!context->file_segment->ForceSize(segment_size))
+        k4a_result_t write_result = TRACE_CALL(write_file_metadata(context, context->most_recent_timestamp));
+        if (K4A_FAILED(write_result))
         {
-            LOG_ERROR("Failed set file segment size.", 0);
+            result = write_result;
         }
-        context->file_segment->OverwriteHead(*context->ebml_file);
-
-        // Set the write pointer back in case we're not done recording yet.
-        assert(current_position <= INT64_MAX);
-        context->ebml_file->setFilePointer((int64_t)current_position);
     }
     catch (std::ios_base::failure &e)
     {
@@ -893,6 +1551,43 @@ k4a_result_t k4a_record_flush(const k4a_record_t recording_handle)
     return result;
 }
 
+k4a_result_t k4a_record_get_write_queue_status(const k4a_record_t recording_handle,
+                                               k4a_record_write_queue_status_t *status)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_record_t, recording_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, status == NULL);
+
+    k4a_record_context_t *context = k4a_record_t_get_context(recording_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+
+    *status = {};
+    try
+    {
+        std::lock_guard<std::mutex> lock(context->pending_cluster_lock);
+        stage_pending_track_data(context);
+        if (context->most_recent_timestamp > context->last_written_timestamp)
+        {
+            status->queued_usec = (context->most_recent_timestamp - context->last_written_timestamp) / 1000;
+        }
+        status->queued_cluster_count = (uint32_t)context->pending_clusters.size();
+        status->queued_bytes = context->pending_bytes;
+        status->dropped_sample_count = context->dropped_sample_count;
+    }
+    catch (std::system_error &e)
+    {
+        LOG_ERROR("Failed to get the write queue status: %s", e.what());
+        return K4A_RESULT_FAILED;
+    }
+
+    UnbufferedFileIOCallback *file_io = dynamic_cast<UnbufferedFileIOCallback *>(context->ebml_file.get());
+    if (file_io != NULL)
+    {
+        status->writes_in_flight = (uint32_t)file_io->getWritesInFlight();
+    }
+
+    return K4A_RESULT_SUCCEEDED;
+}
+
 void k4a_record_close(const k4a_record_t recording_handle)
 {
     RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, k4a_record_t, recording_handle);
@@ -908,6 +1603,7 @@ void k4a_record_close(const k4a_record_t recording_handle)
             stop_matroska_writer_thread(context);
         }
 
+        bool closed = true;
         try
         {
             context->ebml_file->close();
@@ -915,7 +1611,69 @@ void k4a_record_close(const k4a_record_t recording_handle)
         catch (std::ios_base::failure &e)
         {
             LOG_ERROR("Failed to close recording '%s': %s", context->file_path, e.what());
+            closed = false;
+        }
+
+        if (closed && context->write_recording_index && !context->index_clusters.empty())
+        {
+            (void)TRACE_CALL(
+                write_recording_index(context->file_path, context->timecode_scale, context->index_clusters));
         }
     }
     k4a_record_t_destroy(recording_handle);
 }
+
+k4a_result_t k4a_record_group_create(uint32_t writer_thread_count, k4a_record_group_t *group_handle)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, writer_thread_count == 0 || writer_thread_count > 64);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, group_handle == NULL);
+
+    k4a_record_group_context_t *context = NULL;
+    k4a_record_group_t handle = NULL;
+    context = k4a_record_group_t_create(&handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+
+    context->writer_pool = create_writer_pool(writer_thread_count);
+    if (context->writer_pool == nullptr)
+    {
+        k4a_record_group_t_destroy(handle);
+        return K4A_RESULT_FAILED;
+    }
+
+    *group_handle = handle;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t k4a_record_group_add_recording(const k4a_record_group_t group_handle, const k4a_record_t recording_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_record_group_t, group_handle);
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_record_t, recording_handle);
+
+    k4a_record_group_context_t *group = k4a_record_group_t_get_context(group_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, group == NULL);
+    k4a_record_context_t *context = k4a_record_t_get_context(recording_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+
+    if (context->header_written)
+    {
+        LOG_ERROR("Recordings must be added to a group before the recording header is written.", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    if (context->writer_pool != nullptr && context->writer_pool != group->writer_pool)
+    {
+        LOG_ERROR("The recording '%s' is already in another group.", context->file_path);
+        return K4A_RESULT_FAILED;
+    }
+
+    context->writer_pool = group->writer_pool;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+void k4a_record_group_destroy(const k4a_record_group_t group_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, k4a_record_group_t, group_handle);
+
+    // The writer threads stop once the recordings of the group are closed as well
+    k4a_record_group_t_destroy(group_handle);
+}
@@ -14,9 +14,17 @@
 #include <k4ainternal/depth_mcu.h>
 #include <k4ainternal/calibration.h>
 #include <k4ainternal/capturesync.h>
+#include <k4ainternal/clockmodel.h>
+#include <k4ainternal/deloader.h>
+#include <k4ainternal/groupsync.h>
 #include <k4ainternal/transformation.h>
 #include <k4ainternal/logging.h>
+#include <k4ainternal/threadpolicy.h>
+#include <k4ainternal/threadpool.h>
+#include <k4ainternal/tracing.h>
 #include <azure_c_shared_utility/tickcounter.h>
+#include <azure_c_shared_utility/envvariable.h>
+#include <azure_c_shared_utility/threadapi.h>
 
 // System dependencies
 #include <stdlib.h>
@@ -30,6 +38,20 @@ extern "C" {
 
 char K4A_ENV_VAR_LOG_TO_A_FILE[] = K4A_ENABLE_LOG_TO_A_FILE;
 
+// Durations of the phases of the last k4a_device_open() and k4a_device_start_cameras(), see k4a_device_statistics_t
+typedef struct _k4a_startup_times_t
+{
+    uint32_t open_time_usec;
+    uint32_t open_depth_mcu_time_usec;
+    uint32_t open_calibration_time_usec;
+    uint32_t open_color_time_usec;
+    uint32_t open_depth_engine_load_time_usec;
+    uint32_t open_imu_time_usec;
+    uint32_t start_time_usec;
+    uint32_t start_depth_time_usec;
+    uint32_t start_color_time_usec;
+} k4a_startup_times_t;
+
 typedef struct _k4a_context_t
 {
     TICK_COUNTER_HANDLE tick_handle;
@@ -40,6 +62,7 @@ typedef struct _k4a_context_t
     colormcu_t colormcu;
 
     capturesync_t capturesync;
+    clockmodel_t clockmodel;
 
     imu_t imu;
     color_t color;
@@ -48,6 +71,16 @@ typedef struct _k4a_context_t
     bool depth_started;
     bool color_started;
     bool imu_started;
+    bool clock_from_color;         // The clock model follows the color camera when the depth camera is off
+    bool raw_depth_payload;        // Depth captures hold raw payloads without a device timestamp
+    bool raw_depth_from_clock;     // Raw payloads are timestamped through the clock model of the color camera
+    uint64_t raw_depth_start_nsec; // System time the raw payloads are timestamped from without a color camera
+    k4a_device_configuration_t camera_config; // Configuration the cameras are running with
+    k4a_device_start_options_t camera_options; // Start options the cameras are running with
+    k4a_device_start_options_t start_options;  // Start options of the next k4a_device_start_cameras()
+    allocator_hook_t allocator; // Allocator and buffer rings of the device, the device holds a reference on the rings
+
+    k4a_startup_times_t startup_times;
 } k4a_context_t;
 
 K4A_DECLARE_CONTEXT(k4a_device_t, k4a_context_t);
@@ -55,6 +88,7 @@ K4A_DECLARE_CONTEXT(k4a_device_t, k4a_context_t);
 #define DEPTH_CAPTURE (false)
 #define COLOR_CAPTURE (true)
 #define TRANSFORM_ENABLE_GPU_OPTIMIZATION (true)
+#define K4A_MAX_QUEUE_DEPTH 10000 // Matches the sanity check in queue_configure()
 #define K4A_DEPTH_MODE_TO_STRING_CASE(depth_mode)                                                                      \
     case depth_mode:                                                                                                   \
         return #depth_mode
@@ -75,6 +109,14 @@ uint32_t k4a_device_get_installed_count(void)
     return device_count;
 }
 
+k4a_result_t k4a_device_enumerate(k4a_installed_device_t *devices, uint32_t max_devices, uint32_t *device_count)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, device_count == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, devices == NULL && max_devices != 0);
+
+    return TRACE_CALL(usb_cmd_get_installed_devices(devices, max_devices, device_count));
+}
+
 k4a_result_t k4a_set_debug_message_handler(k4a_logging_message_cb_t *message_cb,
                                            void *message_cb_context,
                                            k4a_log_level_t min_level)
@@ -87,14 +129,135 @@ k4a_result_t k4a_set_allocator(k4a_memory_allocate_cb_t allocate, k4a_memory_des
     return allocator_set_allocator(allocate, free);
 }
 
+k4a_result_t k4a_set_default_allocator_pool_size(size_t max_retained_bytes)
+{
+    return allocator_set_default_pool_size(max_retained_bytes);
+}
+
+k4a_result_t k4a_set_default_allocator_huge_page_threshold(size_t min_bytes)
+{
+    return allocator_set_huge_page_threshold(min_bytes);
+}
+
+k4a_result_t k4a_get_allocator_stats(k4a_allocation_source_t source, k4a_allocator_stats_t *stats)
+{
+    return allocator_get_stats((allocation_source_t)source, stats);
+}
+
+k4a_result_t k4a_set_thread_policy(k4a_sdk_thread_t thread, const k4a_thread_policy_t *policy)
+{
+    return threadpolicy_set(thread, policy);
+}
+
+k4a_result_t k4a_get_thread_policy(k4a_sdk_thread_t thread, k4a_thread_policy_t *policy)
+{
+    return threadpolicy_get(thread, policy);
+}
+
+k4a_result_t k4a_set_thread_pool_options(const k4a_thread_pool_options_t *options)
+{
+    return TRACE_CALL(threadpool_set_options(options));
+}
+
+k4a_result_t k4a_get_thread_pool_options(k4a_thread_pool_options_t *options)
+{
+    return threadpool_get_options(options);
+}
+
+k4a_result_t k4a_set_usb_event_thread_count(uint32_t thread_count)
+{
+    return usb_cmd_set_shared_event_threads(thread_count);
+}
+
+k4a_result_t k4a_preload_depth_engine(void)
+{
+    return TRACE_CALL(deloader_load_async());
+}
+
+k4a_result_t k4a_tracing_start(void)
+{
+    return TRACE_CALL(tracing_start());
+}
+
+k4a_result_t k4a_tracing_stop(const char *path)
+{
+    return TRACE_CALL(tracing_stop(path));
+}
+
 depth_cb_streaming_capture_t depth_capture_ready;
 color_cb_streaming_capture_t color_capture_ready;
+imu_sample_listener_t imu_samples_ready;
+
+// Adds the timestamps of a capture from the depth or color camera to the clock model of the device. The depth images
+// are timestamped when their USB transfer completes, so their system timestamps have the least jitter.
+static void k4a_clock_model_add_capture(k4a_context_t *device, k4a_capture_t capture_handle)
+{
+    k4a_image_t image = capture_get_ir_image(capture_handle);
+    if (image == NULL)
+    {
+        image = capture_get_depth_image(capture_handle);
+    }
+    if (image == NULL)
+    {
+        image = capture_get_color_image(capture_handle);
+    }
+    if (image != NULL)
+    {
+        clockmodel_add_sample(device->clockmodel,
+                              image_get_device_timestamp_usec(image),
+                              image_get_system_timestamp_nsec(image));
+        image_dec_ref(image);
+    }
+}
+
+// Raw depth payloads only get their device timestamp from the depth engine at playback, until then they are given the
+// device time of their system timestamp in the clock model of the color camera. Without a color camera the device
+// time is the time since the depth camera started. Returns false to drop a payload that arrives before the model has
+// a sample.
+static bool k4a_timestamp_raw_depth_payload(k4a_context_t *device, k4a_capture_t capture_handle)
+{
+    k4a_image_t image = capture_get_depth_image(capture_handle);
+    if (image == NULL)
+    {
+        return false;
+    }
+
+    uint64_t system_timestamp_nsec = image_get_system_timestamp_nsec(image);
+    uint64_t device_timestamp_usec = 0;
+    bool timestamped = true;
+    if (device->raw_depth_from_clock)
+    {
+        timestamped = K4A_SUCCEEDED(
+            clockmodel_convert_system(device->clockmodel, system_timestamp_nsec, &device_timestamp_usec));
+    }
+    else if (system_timestamp_nsec > device->raw_depth_start_nsec)
+    {
+        device_timestamp_usec = (system_timestamp_nsec - device->raw_depth_start_nsec) / 1000;
+    }
+
+    if (timestamped)
+    {
+        image_set_device_timestamp_usec(image, device_timestamp_usec);
+    }
+    image_dec_ref(image);
+    return timestamped;
+}
 
 void depth_capture_ready(k4a_result_t result, k4a_capture_t capture_handle, void *callback_context)
 {
     k4a_device_t device_handle = (k4a_device_t)callback_context;
     RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, k4a_device_t, device_handle);
     k4a_context_t *device = k4a_device_t_get_context(device_handle);
+    if (K4A_SUCCEEDED(result) && device->raw_depth_payload &&
+        !k4a_timestamp_raw_depth_payload(device, capture_handle))
+    {
+        LOG_WARNING("Dropping raw depth payload received before the first color image", 0);
+        return;
+    }
+    if (K4A_SUCCEEDED(result) && !device->clock_from_color)
+    {
+        k4a_clock_model_add_capture(device, capture_handle);
+    }
     capturesync_add_capture(device->capturesync, result, capture_handle, DEPTH_CAPTURE);
 }
 
@@ -103,9 +266,84 @@ void color_capture_ready(k4a_result_t result, k4a_capture_t capture_handle, void
     k4a_device_t device_handle = (k4a_device_t)callback_context;
     RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, k4a_device_t, device_handle);
     k4a_context_t *device = k4a_device_t_get_context(device_handle);
+    if (K4A_SUCCEEDED(result) && device->clock_from_color)
+    {
+        k4a_clock_model_add_capture(device, capture_handle);
+    }
     capturesync_add_capture(device->capturesync, result, capture_handle, COLOR_CAPTURE);
 }
 
+void imu_samples_ready(const k4a_imu_sample_t *samples, size_t sample_count, void *callback_context)
+{
+    k4a_device_t device_handle = (k4a_device_t)callback_context;
+    RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, k4a_device_t, device_handle);
+    k4a_context_t *device = k4a_device_t_get_context(device_handle);
+    capturesync_add_imu_samples(device->capturesync, samples, sample_count);
+}
+
+static uint32_t k4a_elapsed_usec(uint64_t start_nsec)
+{
+    uint64_t elapsed_usec = (image_get_system_time_nsec() - start_nsec) / 1000;
+    return elapsed_usec > UINT32_MAX ? UINT32_MAX : (uint32_t)elapsed_usec;
+}
+
+typedef struct _k4a_calibration_download_t
+{
+    depthmcu_t depthmcu;
+    calibration_t calibration;
+    k4a_result_t result;
+    uint32_t time_usec;
+} k4a_calibration_download_t;
+
+static int calibration_download_thread(void *param)
+{
+    k4a_calibration_download_t *download = (k4a_calibration_download_t *)param;
+    uint64_t start_nsec = image_get_system_time_nsec();
+    download->result = TRACE_CALL(calibration_create(download->depthmcu, &download->calibration));
+    download->time_usec = k4a_elapsed_usec(start_nsec);
+    return 0;
+}
+
+// Loading the depth engine plugin only needs the file system, so it is done while the device is being opened instead
+// of by the first depth_start(). Failing to load is not an error here, depth_start() reports it.
+static int depth_engine_load_thread(void *param)
+{
+    uint32_t *time_usec = (uint32_t *)param;
+    uint64_t start_nsec = image_get_system_time_nsec();
+    (void)deloader_load();
+    *time_usec = k4a_elapsed_usec(start_nsec);
+    return 0;
+}
+
+typedef struct _k4a_color_start_t
+{
+    color_t color;
+    const k4a_device_configuration_t *config;
+    const k4a_device_start_options_t *options;
+    k4a_result_t result;
+    uint32_t time_usec;
+} k4a_color_start_t;
+
+static int color_start_thread(void *param)
+{
+    k4a_color_start_t *start = (k4a_color_start_t *)param;
+    uint64_t start_nsec = image_get_system_time_nsec();
+    start->result = TRACE_CALL(color_start(start->color, start->config, start->options));
+    start->time_usec = k4a_elapsed_usec(start_nsec);
+    return 0;
+}
+
+static void k4a_join_startup_thread(THREAD_HANDLE *thread)
+{
+    if (*thread)
+    {
+        int thread_result;
+        THREADAPI_RESULT tresult = ThreadAPI_Join(*thread, &thread_result);
+        (void)K4A_RESULT_FROM_BOOL(tresult == THREADAPI_OK); // Trace the issue, the thread's own result is what matters
+        *thread = NULL;
+    }
+}
+
 k4a_result_t k4a_device_open(uint32_t index, k4a_device_t *device_handle)
 {
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, device_handle == NULL);
@@ -115,6 +353,12 @@ k4a_result_t k4a_device_open(uint32_t index, k4a_device_t *device_handle)
     const guid_t *container_id = NULL;
     char serial_number[MAX_SERIAL_NUMBER_LENGTH];
     size_t serial_number_size = sizeof(serial_number);
+    k4a_calibration_download_t calibration_download = { 0 };
+    THREAD_HANDLE calibration_thread = NULL;
+    THREAD_HANDLE depth_engine_load_thread_handle = NULL;
+    uint32_t depth_engine_load_time_usec = 0;
+    uint64_t open_start_nsec = image_get_system_time_nsec();
+    uint64_t phase_start_nsec = 0;
 
     allocator_initialize();
 
@@ -123,14 +367,28 @@ k4a_result_t k4a_device_open(uint32_t index, k4a_device_t *device_handle)
 
     if (K4A_SUCCEEDED(result))
     {
+        device->start_options = K4A_DEVICE_START_OPTIONS_INIT;
         result = K4A_RESULT_FROM_BOOL((device->tick_handle = tickcounter_create()) != NULL);
     }
 
+    if (K4A_SUCCEEDED(result))
+    {
+        if (ThreadAPI_Create(&depth_engine_load_thread_handle,
+                             depth_engine_load_thread,
+                             &depth_engine_load_time_usec) != THREADAPI_OK)
+        {
+            // Leave the load to depth_start()
+            depth_engine_load_thread_handle = NULL;
+        }
+    }
+
     // Create MCU modules
     if (K4A_SUCCEEDED(result))
     {
         // This will block until the depth process is ready to receive commands
+        phase_start_nsec = image_get_system_time_nsec();
         result = TRACE_CALL(depthmcu_create(index, &device->depthmcu));
+        device->startup_times.open_depth_mcu_time_usec = k4a_elapsed_usec(phase_start_nsec);
     }
 
     if (K4A_SUCCEEDED(result))
@@ -147,15 +405,25 @@ k4a_result_t k4a_device_open(uint32_t index, k4a_device_t *device_handle)
         }
     }
 
+    // Create calibration module - ensure we can read calibration before proceeding. Downloading the calibration
+    // blob is a series of depth MCU commands, so it runs on its own thread while the color MCU and the color camera,
+    // which are separate USB devices, are opened.
     if (K4A_SUCCEEDED(result))
     {
-        result = TRACE_CALL(colormcu_create(container_id, &device->colormcu));
+        calibration_download.depthmcu = device->depthmcu;
+        calibration_download.result = K4A_RESULT_FAILED;
+        if (ThreadAPI_Create(&calibration_thread, calibration_download_thread, &calibration_download) != THREADAPI_OK)
+        {
+            // Fall back to downloading the calibration on this thread
+            calibration_thread = NULL;
+            calibration_download_thread(&calibration_download);
+        }
     }
 
-    // Create calibration module - ensure we can read calibration before proceeding
+    phase_start_nsec = image_get_system_time_nsec();
     if (K4A_SUCCEEDED(result))
     {
-        result = TRACE_CALL(calibration_create(device->depthmcu, &device->calibration));
+        result = TRACE_CALL(colormcu_create(container_id, &device->colormcu));
     }
 
     if (K4A_SUCCEEDED(result))
@@ -163,11 +431,9 @@ k4a_result_t k4a_device_open(uint32_t index, k4a_device_t *device_handle)
         result = TRACE_CALL(capturesync_create(&device->capturesync));
     }
 
-    // Open Depth Module
     if (K4A_SUCCEEDED(result))
     {
-        result = TRACE_CALL(
-            depth_create(device->depthmcu, device->calibration, depth_capture_ready, handle, &device->depth));
+        result = TRACE_CALL(clockmodel_create(&device->clockmodel));
     }
 
     // Create color Module
@@ -175,12 +441,49 @@ k4a_result_t k4a_device_open(uint32_t index, k4a_device_t *device_handle)
     {
         result = TRACE_CALL(color_create(
             device->tick_handle, container_id, serial_number, color_capture_ready, handle, &device->color));
+        device->startup_times.open_color_time_usec = k4a_elapsed_usec(phase_start_nsec);
+    }
+
+    k4a_join_startup_thread(&calibration_thread);
+
+    // Hand the calibration to the device even if something else failed, so k4a_device_close() destroys it
+    if (device != NULL)
+    {
+        device->calibration = calibration_download.calibration;
+        device->startup_times.open_calibration_time_usec = calibration_download.time_usec;
+    }
+    if (K4A_SUCCEEDED(result))
+    {
+        result = calibration_download.result;
+    }
+
+    // Open Depth Module
+    if (K4A_SUCCEEDED(result))
+    {
+        result = TRACE_CALL(
+            depth_create(device->depthmcu, device->calibration, depth_capture_ready, handle, &device->depth));
     }
 
     // Create imu Module
     if (K4A_SUCCEEDED(result))
     {
+        phase_start_nsec = image_get_system_time_nsec();
         result = TRACE_CALL(imu_create(device->tick_handle, device->colormcu, device->calibration, &device->imu));
+        device->startup_times.open_imu_time_usec = k4a_elapsed_usec(phase_start_nsec);
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        // capturesync ignores the samples unless the cameras are started with attach_imu_samples
+        result = TRACE_CALL(imu_set_sample_listener(device->imu, imu_samples_ready, handle));
+    }
+
+    k4a_join_startup_thread(&depth_engine_load_thread_handle);
+
+    if (device != NULL)
+    {
+        device->startup_times.open_depth_engine_load_time_usec = depth_engine_load_time_usec;
+        device->startup_times.open_time_usec = k4a_elapsed_usec(open_start_nsec);
     }
 
     if (K4A_FAILED(result))
@@ -196,6 +499,94 @@ k4a_result_t k4a_device_open(uint32_t index, k4a_device_t *device_handle)
     return result;
 }
 
+// Open the device at index and keep it only if it has the requested serial number
+static k4a_result_t k4a_device_open_if_serial(uint32_t index, const char *serial_number, k4a_device_t *device_handle)
+{
+    char opened_serial_number[MAX_SERIAL_NUMBER_LENGTH];
+    size_t serial_number_size = sizeof(opened_serial_number);
+    k4a_result_t result = TRACE_CALL(k4a_device_open(index, device_handle));
+
+    if (K4A_SUCCEEDED(result))
+    {
+        result = K4A_RESULT_FROM_BOOL(
+            k4a_device_get_serialnum(*device_handle, opened_serial_number, &serial_number_size) ==
+                K4A_BUFFER_RESULT_SUCCEEDED &&
+            strcmp(opened_serial_number, serial_number) == 0);
+        if (K4A_FAILED(result))
+        {
+            // The devices were re-enumerated since they were listed
+            k4a_device_close(*device_handle);
+            *device_handle = NULL;
+        }
+    }
+    return result;
+}
+
+k4a_result_t k4a_device_open_by_serial(const char *serial_number, k4a_device_t *device_handle)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, serial_number == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, serial_number[0] == '\0');
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, device_handle == NULL);
+    k4a_installed_device_t *devices = NULL;
+    uint32_t device_count = 0;
+    uint32_t listed_count = 0;
+    k4a_result_t result = TRACE_CALL(usb_cmd_get_installed_devices(NULL, 0, &device_count));
+
+    if (K4A_SUCCEEDED(result))
+    {
+        result = K4A_RESULT_FROM_BOOL(device_count != 0);
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        devices = (k4a_installed_device_t *)malloc(device_count * sizeof(k4a_installed_device_t));
+        result = K4A_RESULT_FROM_BOOL(devices != NULL);
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        // A device may have been unplugged between the two calls, only the entries written are valid
+        result = TRACE_CALL(usb_cmd_get_installed_devices(devices, device_count, &listed_count));
+        if (listed_count < device_count)
+        {
+            device_count = listed_count;
+        }
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        result = K4A_RESULT_FAILED;
+        for (uint32_t i = 0; i < device_count && K4A_FAILED(result); i++)
+        {
+            if (strcmp(devices[i].serial_number, serial_number) == 0)
+            {
+                result = k4a_device_open_if_serial(devices[i].index, serial_number, device_handle);
+            }
+        }
+
+        // Fall back to the devices whose serial number is not known, the open fails for those in use elsewhere
+        for (uint32_t i = 0; i < device_count && K4A_FAILED(result); i++)
+        {
+            if (devices[i].serial_number[0] == '\0')
+            {
+                result = k4a_device_open_if_serial(devices[i].index, serial_number, device_handle);
+            }
+        }
+
+        if (K4A_FAILED(result))
+        {
+            LOG_ERROR("No device with serial number %s could be opened", serial_number);
+        }
+    }
+
+    if (devices != NULL)
+    {
+        free(devices);
+    }
+
+    return result;
+}
+
 void k4a_device_close(k4a_device_t device_handle)
 {
     RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, k4a_device_t, device_handle);
@@ -230,6 +621,21 @@ void k4a_device_close(k4a_device_t device_handle)
         capturesync_destroy(device->capturesync);
         device->capturesync = NULL;
     }
+    if (device->clockmodel)
+    {
+        clockmodel_destroy(device->clockmodel);
+        device->clockmodel = NULL;
+    }
+
+    // The modules allocating from the buffer rings are destroyed, images still holding slots keep the rings alive
+    for (int source = 0; source < K4A_ALLOCATION_SOURCE_COUNT; source++)
+    {
+        if (device->allocator.rings[source] != NULL)
+        {
+            allocator_ring_release(device->allocator.rings[source]);
+            device->allocator.rings[source] = NULL;
+        }
+    }
 
     // calibration rely's on depthmcu, so it needs to be destroyed first.
     if (device->calibration)
@@ -266,7 +672,24 @@ k4a_wait_result_t k4a_device_get_capture(k4a_device_t device_handle,
     RETURN_VALUE_IF_HANDLE_INVALID(K4A_WAIT_RESULT_FAILED, k4a_device_t, device_handle);
     RETURN_VALUE_IF_ARG(K4A_WAIT_RESULT_FAILED, capture_handle == NULL);
     k4a_context_t *device = k4a_device_t_get_context(device_handle);
-    return TRACE_WAIT_CALL(capturesync_get_capture(device->capturesync, capture_handle, timeout_in_ms));
+    TRACE_SPAN_BEGIN("user get capture", 0);
+    k4a_wait_result_t wresult = capturesync_get_capture(device->capturesync, capture_handle, timeout_in_ms);
+    TRACE_SPAN_END("user get capture", 0);
+    if (wresult == K4A_WAIT_RESULT_SUCCEEDED)
+    {
+        capture_set_stage_timestamp(*capture_handle, K4A_IMAGE_STAGE_USER_POP);
+    }
+    if (wresult == K4A_WAIT_RESULT_SUCCEEDED && tracing_is_enabled())
+    {
+        // Ties the end of the capture's path to the depth frame id the earlier stages recorded
+        k4a_image_t image = capture_get_ir_image(*capture_handle);
+        if (image != NULL)
+        {
+            TRACE_INSTANT("user capture delivered", image_get_system_timestamp_nsec(image));
+            image_dec_ref(image);
+        }
+    }
+    return TRACE_WAIT_CALL(wresult);
 }
 
 k4a_wait_result_t k4a_device_get_imu_sample(k4a_device_t device_handle,
@@ -279,6 +702,104 @@ k4a_wait_result_t k4a_device_get_imu_sample(k4a_device_t device_handle,
     return TRACE_WAIT_CALL(imu_get_sample(device->imu, imu_sample, timeout_in_ms));
 }
 
+k4a_wait_result_t k4a_device_get_imu_samples(k4a_device_t device_handle,
+                                             k4a_imu_sample_t *imu_samples,
+                                             size_t max_samples,
+                                             size_t *sample_count,
+                                             int32_t timeout_in_ms)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_WAIT_RESULT_FAILED, k4a_device_t, device_handle);
+    RETURN_VALUE_IF_ARG(K4A_WAIT_RESULT_FAILED, imu_samples == NULL);
+    RETURN_VALUE_IF_ARG(K4A_WAIT_RESULT_FAILED, max_samples == 0);
+    RETURN_VALUE_IF_ARG(K4A_WAIT_RESULT_FAILED, sample_count == NULL);
+    k4a_context_t *device = k4a_device_t_get_context(device_handle);
+    return TRACE_WAIT_CALL(imu_get_samples(device->imu, imu_samples, max_samples, sample_count, timeout_in_ms));
+}
+
+k4a_wait_result_t k4a_device_get_latest_imu_sample(k4a_device_t device_handle,
+                                                   k4a_imu_sample_t *imu_sample,
+                                                   int32_t timeout_in_ms)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_WAIT_RESULT_FAILED, k4a_device_t, device_handle);
+    RETURN_VALUE_IF_ARG(K4A_WAIT_RESULT_FAILED, imu_sample == NULL);
+    k4a_context_t *device = k4a_device_t_get_context(device_handle);
+    return TRACE_WAIT_CALL(imu_get_latest_sample(device->imu, imu_sample, timeout_in_ms));
+}
+
+k4a_result_t k4a_device_get_capture_wait_handle(k4a_device_t device_handle, k4a_wait_handle_t *wait_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_device_t, device_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, wait_handle == NULL);
+    k4a_context_t *device = k4a_device_t_get_context(device_handle);
+    return TRACE_CALL(capturesync_get_wait_handle(device->capturesync, wait_handle));
+}
+
+k4a_result_t k4a_device_get_imu_wait_handle(k4a_device_t device_handle, k4a_wait_handle_t *wait_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_device_t, device_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, wait_handle == NULL);
+    k4a_context_t *device = k4a_device_t_get_context(device_handle);
+    return TRACE_CALL(imu_get_wait_handle(device->imu, wait_handle));
+}
+
+k4a_result_t k4a_device_set_capture_callback(k4a_device_t device_handle,
+                                             k4a_capture_ready_cb_t *callback,
+                                             void *context)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_device_t, device_handle);
+    k4a_context_t *device = k4a_device_t_get_context(device_handle);
+
+    if (device->depth_started || device->color_started)
+    {
+        LOG_ERROR("The capture callback can not be changed while the cameras are running", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    return TRACE_CALL(capturesync_set_callback(device->capturesync, callback, context));
+}
+
+k4a_result_t k4a_device_set_imu_callback(k4a_device_t device_handle, k4a_imu_sample_ready_cb_t *callback, void *context)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_device_t, device_handle);
+    k4a_context_t *device = k4a_device_t_get_context(device_handle);
+
+    if (device->imu_started)
+    {
+        LOG_ERROR("The IMU callback can not be changed while the IMU is running", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    return TRACE_CALL(imu_set_callback(device->imu, callback, context));
+}
+
+k4a_result_t k4a_device_set_imu_preintegration(k4a_device_t device_handle, bool enabled)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_device_t, device_handle);
+    k4a_context_t *device = k4a_device_t_get_context(device_handle);
+
+    if (device->imu_started)
+    {
+        LOG_ERROR("The IMU preintegration can not be changed while the IMU is running", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    return TRACE_CALL(imu_set_preintegration(device->imu, enabled));
+}
+
+k4a_wait_result_t k4a_device_get_imu_preintegration(k4a_device_t device_handle,
+                                                    uint64_t start_timestamp_usec,
+                                                    uint64_t end_timestamp_usec,
+                                                    k4a_imu_preintegration_t *preintegration,
+                                                    int32_t timeout_in_ms)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_WAIT_RESULT_FAILED, k4a_device_t, device_handle);
+    RETURN_VALUE_IF_ARG(K4A_WAIT_RESULT_FAILED, preintegration == NULL);
+    RETURN_VALUE_IF_ARG(K4A_WAIT_RESULT_FAILED, end_timestamp_usec < start_timestamp_usec);
+    k4a_context_t *device = k4a_device_t_get_context(device_handle);
+    return TRACE_WAIT_CALL(imu_get_preintegration(
+        device->imu, start_timestamp_usec, end_timestamp_usec, preintegration, timeout_in_ms));
+}
+
 k4a_result_t k4a_device_start_imu(k4a_device_t device_handle)
 {
     RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_device_t, device_handle);
@@ -363,9 +884,14 @@ k4a_image_t k4a_capture_get_ir_image(k4a_capture_t capture_handle)
     return capture_get_ir_image(capture_handle);
 }
 
-void k4a_capture_set_color_image(k4a_capture_t capture_handle, k4a_image_t image_handle)
+k4a_image_t k4a_capture_get_imu_samples_image(k4a_capture_t capture_handle)
 {
-    capture_set_color_image(capture_handle, image_handle);
+    return capture_get_imu_samples_image(capture_handle);
+}
+
+void k4a_capture_set_color_image(k4a_capture_t capture_handle, k4a_image_t image_handle)
+{
+    capture_set_color_image(capture_handle, image_handle);
 }
 
 void k4a_capture_set_depth_image(k4a_capture_t capture_handle, k4a_image_t image_handle)
@@ -378,6 +904,11 @@ void k4a_capture_set_ir_image(k4a_capture_t capture_handle, k4a_image_t image_ha
     capture_set_ir_image(capture_handle, image_handle);
 }
 
+void k4a_capture_set_imu_samples_image(k4a_capture_t capture_handle, k4a_image_t image_handle)
+{
+    capture_set_imu_samples_image(capture_handle, image_handle);
+}
+
 void k4a_capture_set_temperature_c(k4a_capture_t capture_handle, float temperature_c)
 {
     capture_set_temperature_c(capture_handle, temperature_c);
@@ -392,6 +923,17 @@ k4a_result_t k4a_image_create(k4a_image_format_t format,
     return image_create(format, width_pixels, height_pixels, stride_bytes, ALLOCATION_SOURCE_USER, image_handle);
 }
 
+k4a_result_t k4a_image_create_aligned(k4a_image_format_t format,
+                                      int width_pixels,
+                                      int height_pixels,
+                                      int stride_bytes,
+                                      size_t alignment,
+                                      k4a_image_t *image_handle)
+{
+    return image_create_aligned(
+        format, width_pixels, height_pixels, stride_bytes, alignment, ALLOCATION_SOURCE_USER, image_handle);
+}
+
 k4a_result_t k4a_image_create_from_buffer(k4a_image_format_t format,
                                           int width_pixels,
                                           int height_pixels,
@@ -413,6 +955,49 @@ k4a_result_t k4a_image_create_from_buffer(k4a_image_format_t format,
                                     image_handle);
 }
 
+k4a_result_t k4a_buffer_ring_create(uint8_t *buffer,
+                                    size_t slot_size,
+                                    uint32_t slot_count,
+                                    k4a_buffer_ring_t *ring_handle)
+{
+    return TRACE_CALL(allocator_ring_create(buffer, slot_size, slot_count, ring_handle));
+}
+
+void k4a_buffer_ring_destroy(k4a_buffer_ring_t ring_handle)
+{
+    allocator_ring_release(ring_handle);
+}
+
+k4a_result_t k4a_buffer_ring_get_slot(k4a_buffer_ring_t ring_handle,
+                                      k4a_image_t image_handle,
+                                      uint32_t *slot_index,
+                                      size_t *buffer_offset)
+{
+    // An invalid image has no buffer to look up
+    return allocator_ring_get_slot(ring_handle, image_get_buffer(image_handle), slot_index, buffer_offset);
+}
+
+k4a_result_t k4a_buffer_ring_create_image(k4a_buffer_ring_t ring_handle,
+                                          k4a_image_format_t format,
+                                          int width_pixels,
+                                          int height_pixels,
+                                          int stride_bytes,
+                                          k4a_image_t *image_handle)
+{
+    return TRACE_CALL(
+        allocator_ring_create_image(ring_handle, format, width_pixels, height_pixels, stride_bytes, image_handle));
+}
+
+k4a_result_t k4a_image_create_view(k4a_image_t parent_handle,
+                                   int x,
+                                   int y,
+                                   int width_pixels,
+                                   int height_pixels,
+                                   k4a_image_t *image_handle)
+{
+    return image_create_view(parent_handle, x, y, width_pixels, height_pixels, image_handle);
+}
+
 uint8_t *k4a_image_get_buffer(k4a_image_t image_handle)
 {
     return image_get_buffer(image_handle);
@@ -458,6 +1043,11 @@ uint64_t k4a_image_get_system_timestamp_nsec(k4a_image_t image_handle)
     return image_get_system_timestamp_nsec(image_handle);
 }
 
+uint64_t k4a_image_get_stage_timestamp_nsec(k4a_image_t image_handle, k4a_image_stage_t stage)
+{
+    return image_get_stage_timestamp_nsec(image_handle, stage);
+}
+
 uint64_t k4a_image_get_exposure_usec(k4a_image_t image_handle)
 {
     return image_get_exposure_usec(image_handle);
@@ -473,6 +1063,23 @@ uint32_t k4a_image_get_iso_speed(k4a_image_t image_handle)
     return image_get_iso_speed(image_handle);
 }
 
+k4a_result_t k4a_image_get_info(k4a_image_t image_handle, k4a_image_info_t *info)
+{
+    return TRACE_CALL(image_get_info(image_handle, info));
+}
+
+k4a_result_t k4a_image_get_view(k4a_image_t image_handle, uint32_t version, k4a_image_view_t *view)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, version == 0 || version > K4A_VIEW_VERSION);
+    return TRACE_CALL(image_get_view(image_handle, view));
+}
+
+k4a_result_t k4a_capture_get_view(k4a_capture_t capture_handle, uint32_t version, k4a_capture_view_t *view)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, version == 0 || version > K4A_VIEW_VERSION);
+    return TRACE_CALL(capture_get_view(capture_handle, view));
+}
+
 void k4a_image_set_device_timestamp_usec(k4a_image_t image_handle, uint64_t timestamp_usec)
 {
     image_set_device_timestamp_usec(image_handle, timestamp_usec);
@@ -520,6 +1127,43 @@ void k4a_image_release(k4a_image_t image_handle)
     image_dec_ref(image_handle);
 }
 
+k4a_result_t k4a_image_convert_to_bgra32(k4a_image_t source_image_handle, k4a_image_t bgra_image_handle)
+{
+    return TRACE_CALL(image_convert_to_bgra32(source_image_handle, bgra_image_handle));
+}
+
+k4a_result_t k4a_image_convert_from_bgra32(k4a_image_t bgra_image_handle, k4a_image_t output_image_handle)
+{
+    return TRACE_CALL(image_convert_from_bgra32(bgra_image_handle, output_image_handle));
+}
+
+k4a_result_t k4a_image_convert_to_grayscale(k4a_image_t color_image_handle, k4a_image_t custom8_image_handle)
+{
+    return TRACE_CALL(image_convert_to_grayscale(color_image_handle, custom8_image_handle));
+}
+
+k4a_result_t k4a_image_convert_to_float(k4a_image_t source_image_handle, float scale, k4a_image_t float_image_handle)
+{
+    return TRACE_CALL(image_convert_to_float(source_image_handle, scale, float_image_handle));
+}
+
+k4a_result_t k4a_image_convert_to_custom8(k4a_image_t source_image_handle,
+                                          uint16_t min_value,
+                                          uint16_t max_value,
+                                          k4a_image_t custom8_image_handle)
+{
+    return TRACE_CALL(image_convert_to_custom8(source_image_handle, min_value, max_value, custom8_image_handle));
+}
+
+k4a_result_t k4a_image_colorize(k4a_image_t source_image_handle,
+                                uint16_t min_value,
+                                uint16_t max_value,
+                                k4a_colormap_t colormap,
+                                k4a_image_t bgra_image_handle)
+{
+    return TRACE_CALL(image_colorize(source_image_handle, min_value, max_value, colormap, bgra_image_handle));
+}
+
 static const char *k4a_depth_mode_to_string(k4a_depth_mode_t depth_mode)
 {
     switch (depth_mode)
@@ -577,9 +1221,12 @@ static const char *k4a_fps_to_string(k4a_fps_t fps)
     return "Unexpected k4a_fps_t value.";
 }
 
-static k4a_result_t validate_configuration(k4a_context_t *device, const k4a_device_configuration_t *config)
+static k4a_result_t validate_configuration(k4a_context_t *device,
+                                           const k4a_device_configuration_t *config,
+                                           const k4a_device_start_options_t *options)
 {
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, config == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, options == NULL);
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, device == NULL);
     k4a_result_t result = K4A_RESULT_SUCCEEDED;
     bool depth_enabled = false;
@@ -786,6 +1433,55 @@ static k4a_result_t validate_configuration(k4a_context_t *device, const k4a_devi
                           k4a_fps_to_string(config->camera_fps));
             }
         }
+
+        if (options->depth_image_only && (!depth_enabled || config->depth_mode == K4A_DEPTH_MODE_PASSIVE_IR))
+        {
+            result = K4A_RESULT_FAILED;
+            LOG_ERROR("To enable depth_image_only, the depth_mode must produce depth images. User requested %s",
+                      k4a_depth_mode_to_string(config->depth_mode));
+        }
+
+        if (options->raw_depth_payload && (!depth_enabled || options->depth_image_only))
+        {
+            result = K4A_RESULT_FAILED;
+            LOG_ERROR("To enable raw_depth_payload, the depth camera must be on and depth_image_only must be off. User "
+                      "requested %s",
+                      k4a_depth_mode_to_string(config->depth_mode));
+        }
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        if (options->depth_engine_queue_depth > K4A_MAX_QUEUE_DEPTH ||
+            options->capture_queue_depth > K4A_MAX_QUEUE_DEPTH)
+        {
+            result = K4A_RESULT_FAILED;
+            LOG_ERROR("The configured depth_engine_queue_depth %d and capture_queue_depth %d can not exceed %d.",
+                      options->depth_engine_queue_depth,
+                      options->capture_queue_depth,
+                      K4A_MAX_QUEUE_DEPTH);
+        }
+
+        if (options->depth_engine_queue_policy < K4A_QUEUE_POLICY_DROP_OLDEST ||
+            options->depth_engine_queue_policy > K4A_QUEUE_POLICY_BLOCK ||
+            options->capture_queue_policy < K4A_QUEUE_POLICY_DROP_OLDEST ||
+            options->capture_queue_policy > K4A_QUEUE_POLICY_BLOCK)
+        {
+            result = K4A_RESULT_FAILED;
+            LOG_ERROR("The configured depth_engine_queue_policy %d or capture_queue_policy %d is invalid.",
+                      options->depth_engine_queue_policy,
+                      options->capture_queue_policy);
+        }
+
+        if (options->latest_capture_only &&
+            (options->capture_queue_depth > 1 || options->capture_queue_policy != K4A_QUEUE_POLICY_DROP_OLDEST))
+        {
+            result = K4A_RESULT_FAILED;
+            LOG_ERROR("latest_capture_only needs a capture_queue_depth of 0 or 1 and K4A_QUEUE_POLICY_DROP_OLDEST. "
+                      "User requested %d and %d.",
+                      options->capture_queue_depth,
+                      options->capture_queue_policy);
+        }
     }
 
     if (K4A_SUCCEEDED(result))
@@ -846,6 +1542,11 @@ k4a_result_t k4a_device_start_cameras(k4a_device_t device_handle, const k4a_devi
     RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_device_t, device_handle);
     k4a_result_t result = K4A_RESULT_SUCCEEDED;
     k4a_context_t *device = k4a_device_t_get_context(device_handle);
+    k4a_device_start_options_t options = device->start_options;
+    k4a_color_start_t color_start_context = { 0 };
+    THREAD_HANDLE color_start_thread_handle = NULL;
+    uint64_t start_nsec = image_get_system_time_nsec();
+    uint64_t phase_start_nsec = 0;
 
     LOG_TRACE("k4a_device_start_cameras starting", 0);
     if (device->depth_started == true || device->color_started == true)
@@ -875,7 +1576,18 @@ k4a_result_t k4a_device_start_cameras(k4a_device_t device_handle, const k4a_devi
         LOG_INFO("    wired_sync_mode:%d", config->wired_sync_mode);
         LOG_INFO("    subordinate_delay_off_master_usec:%d", config->subordinate_delay_off_master_usec);
         LOG_INFO("    disable_streaming_indicator:%d", config->disable_streaming_indicator);
-        result = TRACE_CALL(validate_configuration(device, config));
+        LOG_INFO("Starting camera's with the following options.", 0);
+        LOG_INFO("    depth_image_only:%d", options.depth_image_only);
+        LOG_INFO("    depth_engine_queue_depth:%d", options.depth_engine_queue_depth);
+        LOG_INFO("    depth_engine_queue_policy:%d", options.depth_engine_queue_policy);
+        LOG_INFO("    capture_queue_depth:%d", options.capture_queue_depth);
+        LOG_INFO("    capture_queue_policy:%d", options.capture_queue_policy);
+        LOG_INFO("    raw_depth_payload:%d", options.raw_depth_payload);
+        LOG_INFO("    attach_imu_samples:%d", options.attach_imu_samples);
+        LOG_INFO("    depth_delivery_divisor:%d", options.depth_delivery_divisor);
+        LOG_INFO("    latest_capture_only:%d", options.latest_capture_only);
+        LOG_INFO("    prefault_buffers:%d", options.prefault_buffers);
+        result = TRACE_CALL(validate_configuration(device, config, &options));
     }
 
     if (K4A_SUCCEEDED(result))
@@ -883,36 +1595,80 @@ k4a_result_t k4a_device_start_cameras(k4a_device_t device_handle, const k4a_devi
         result = TRACE_CALL(colormcu_set_multi_device_mode(device->colormcu, config));
     }
 
+    if (K4A_SUCCEEDED(result) && options.prefault_buffers)
+    {
+        // Every frame is delivered in a capture, the depth and color buffers are pre-faulted as their streams start
+        capture_pool_prefill();
+    }
+
     if (K4A_SUCCEEDED(result))
     {
-        result = TRACE_CALL(capturesync_start(device->capturesync, config));
+        result = TRACE_CALL(capturesync_start(device->capturesync, config, &options));
     }
 
     if (K4A_SUCCEEDED(result))
     {
-        if (config->depth_mode != K4A_DEPTH_MODE_OFF)
-        {
-            result = TRACE_CALL(depth_start(device->depth, config));
-        }
-        if (K4A_SUCCEEDED(result))
-        {
-            device->depth_started = true;
-        }
+        // Starting the color camera resets the device timestamps
+        clockmodel_reset(device->clockmodel);
+        device->clock_from_color = config->depth_mode == K4A_DEPTH_MODE_OFF || options.raw_depth_payload;
+        device->raw_depth_payload = options.raw_depth_payload;
+        device->raw_depth_from_clock = config->color_resolution != K4A_COLOR_RESOLUTION_OFF;
+        device->raw_depth_start_nsec = image_get_system_time_nsec();
     }
 
+    // The color camera and the depth sensor are separate USB devices, so the color camera is started on a helper
+    // thread while the depth engine and the depth stream start on this one.
     if (K4A_SUCCEEDED(result))
     {
+        color_start_context.color = device->color;
+        color_start_context.config = config;
+        color_start_context.options = &options;
+        color_start_context.result = K4A_RESULT_SUCCEEDED;
         if (config->color_resolution != K4A_COLOR_RESOLUTION_OFF)
         {
             // NOTE: Color must be started before depth and IMU as it triggers the sync of PTS. If it starts after
             // depth or IMU, the user will see timestamps reset back to zero when the color camera is started.
-            result = TRACE_CALL(color_start(device->color, config));
+            if (ThreadAPI_Create(&color_start_thread_handle, color_start_thread, &color_start_context) != THREADAPI_OK)
+            {
+                // Fall back to starting the color camera on this thread
+                color_start_thread_handle = NULL;
+                color_start_thread(&color_start_context);
+            }
         }
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        phase_start_nsec = image_get_system_time_nsec();
+        if (config->depth_mode != K4A_DEPTH_MODE_OFF)
+        {
+            result = TRACE_CALL(depth_start(device->depth, config, &options));
+        }
+        device->startup_times.start_depth_time_usec = k4a_elapsed_usec(phase_start_nsec);
         if (K4A_SUCCEEDED(result))
         {
-            device->color_started = true;
+            device->depth_started = true;
         }
     }
+
+    k4a_join_startup_thread(&color_start_thread_handle);
+    device->startup_times.start_color_time_usec = color_start_context.time_usec;
+
+    if (K4A_SUCCEEDED(color_start_context.result) && color_start_context.config != NULL)
+    {
+        // Set even if depth failed, so the k4a_device_stop_cameras() below stops the color camera
+        device->color_started = true;
+    }
+    if (K4A_SUCCEEDED(result))
+    {
+        result = color_start_context.result;
+    }
+    if (K4A_SUCCEEDED(result))
+    {
+        device->camera_config = *config;
+        device->camera_options = options;
+    }
+    device->startup_times.start_time_usec = k4a_elapsed_usec(start_nsec);
     LOG_INFO("k4a_device_start_cameras started", 0);
 
     if (K4A_FAILED(result))
@@ -952,6 +1708,70 @@ void k4a_device_stop_cameras(k4a_device_t device_handle)
     LOG_INFO("k4a_device_stop_cameras stopped", 0);
 }
 
+k4a_result_t k4a_device_set_depth_mode(k4a_device_t device_handle, k4a_depth_mode_t depth_mode, k4a_fps_t camera_fps)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_device_t, device_handle);
+    k4a_context_t *device = k4a_device_t_get_context(device_handle);
+
+    if (!device->depth_started || device->camera_config.depth_mode == K4A_DEPTH_MODE_OFF)
+    {
+        LOG_ERROR("k4a_device_set_depth_mode called while the depth camera is not running, start the cameras", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    if (depth_mode == K4A_DEPTH_MODE_OFF)
+    {
+        LOG_ERROR("k4a_device_set_depth_mode can't turn the depth camera off, stop the cameras", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    if (device->color_started && camera_fps != device->camera_config.camera_fps)
+    {
+        LOG_ERROR("k4a_device_set_depth_mode can't change the frame rate of the running color camera from %s to %s, "
+                  "restart the cameras",
+                  k4a_fps_to_string(device->camera_config.camera_fps),
+                  k4a_fps_to_string(camera_fps));
+        return K4A_RESULT_FAILED;
+    }
+
+    if (depth_mode == device->camera_config.depth_mode && camera_fps == device->camera_config.camera_fps)
+    {
+        return K4A_RESULT_SUCCEEDED;
+    }
+
+    k4a_device_configuration_t config = device->camera_config;
+    config.depth_mode = depth_mode;
+    config.camera_fps = camera_fps;
+
+    LOG_INFO("k4a_device_set_depth_mode switching to depth_mode:%d camera_fps:%d", depth_mode, camera_fps);
+    k4a_result_t result = TRACE_CALL(validate_configuration(device, &config, &device->camera_options));
+
+    if (K4A_SUCCEEDED(result))
+    {
+        // The depth engine thread and, for an unchanged depth mode, the depth engine are reused. The color camera,
+        // the clock model and the capture queue keep running, a repeated capturesync_start() only updates the
+        // frame period the captures are matched with.
+        result = TRACE_CALL(depth_reconfigure(device->depth, &config, &device->camera_options));
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        result = TRACE_CALL(capturesync_start(device->capturesync, &config, &device->camera_options));
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        device->camera_config = config;
+    }
+    else
+    {
+        // A failed depth start leaves the depth camera stopped
+        k4a_device_stop_cameras(device_handle);
+    }
+
+    return result;
+}
+
 k4a_buffer_result_t k4a_device_get_serialnum(k4a_device_t device_handle,
                                              char *serial_number,
                                              size_t *serial_number_size)
@@ -981,122 +1801,378 @@ k4a_result_t k4a_device_get_sync_jack(k4a_device_t device_handle,
         colormcu_get_external_sync_jack_state(device->colormcu, sync_in_jack_connected, sync_out_jack_connected));
 }
 
-k4a_result_t k4a_device_get_color_control_capabilities(k4a_device_t device_handle,
-                                                       k4a_color_control_command_t command,
-                                                       bool *supports_auto,
-                                                       int32_t *min_value,
-                                                       int32_t *max_value,
-                                                       int32_t *step_value,
-                                                       int32_t *default_value,
-                                                       k4a_color_control_mode_t *default_mode)
+k4a_result_t k4a_device_set_usb_streaming_options(k4a_device_t device_handle,
+                                                  const k4a_usb_streaming_options_t *options)
 {
     RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_device_t, device_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, options == NULL);
     k4a_context_t *device = k4a_device_t_get_context(device_handle);
 
-    return TRACE_CALL(color_get_control_capabilities(
-        device->color, command, supports_auto, min_value, max_value, step_value, default_value, default_mode));
+    return TRACE_CALL(depthmcu_depth_set_transfer_limits(device->depthmcu,
+                                                         options->max_transfer_count,
+                                                         options->max_transfer_pool_size));
 }
 
-k4a_result_t k4a_device_get_color_control(k4a_device_t device_handle,
-                                          k4a_color_control_command_t command,
-                                          k4a_color_control_mode_t *mode,
-                                          int32_t *value)
+// True if struct_size is the size of a k4a_device_start_options_t of this or an earlier version, which only lacks
+// the fields appended since
+static bool k4a_is_start_options_size_valid(uint32_t struct_size)
+{
+    return struct_size > sizeof(uint32_t) && struct_size <= sizeof(k4a_device_start_options_t);
+}
+
+k4a_result_t k4a_device_set_start_options(k4a_device_t device_handle, const k4a_device_start_options_t *options)
 {
     RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_device_t, device_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, options == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, !k4a_is_start_options_size_valid(options->struct_size));
     k4a_context_t *device = k4a_device_t_get_context(device_handle);
 
-    return TRACE_CALL(color_get_control(device->color, command, mode, value));
+    if (device->depth_started || device->color_started)
+    {
+        LOG_ERROR("The start options can not be changed while the cameras are running", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    // Fields the caller does not know of keep their defaults
+    k4a_device_start_options_t start_options = K4A_DEVICE_START_OPTIONS_INIT;
+    memcpy(&start_options, options, options->struct_size);
+    start_options.struct_size = sizeof(k4a_device_start_options_t);
+    device->start_options = start_options;
+    return K4A_RESULT_SUCCEEDED;
 }
 
-k4a_result_t k4a_device_set_color_control(k4a_device_t device_handle,
-                                          k4a_color_control_command_t command,
-                                          k4a_color_control_mode_t mode,
-                                          int32_t value)
+k4a_result_t k4a_device_get_start_options(k4a_device_t device_handle, k4a_device_start_options_t *options)
 {
     RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_device_t, device_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, options == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, !k4a_is_start_options_size_valid(options->struct_size));
     k4a_context_t *device = k4a_device_t_get_context(device_handle);
 
-    return TRACE_CALL(color_set_control(device->color, command, mode, value));
+    uint32_t struct_size = options->struct_size;
+    memcpy(options, &device->start_options, struct_size);
+    options->struct_size = struct_size;
+    return K4A_RESULT_SUCCEEDED;
 }
 
-k4a_buffer_result_t k4a_device_get_raw_calibration(k4a_device_t device_handle, uint8_t *data, size_t *data_size)
+// Hands the allocator and buffer rings of the device to every module allocating for it
+static k4a_result_t k4a_device_apply_allocator(k4a_context_t *device)
 {
-    RETURN_VALUE_IF_HANDLE_INVALID(K4A_BUFFER_RESULT_FAILED, k4a_device_t, device_handle);
+    k4a_result_t result = TRACE_CALL(depth_set_allocator(device->depth, &device->allocator));
+    if (K4A_SUCCEEDED(result))
+    {
+        result = TRACE_CALL(color_set_allocator(device->color, &device->allocator));
+    }
+    if (K4A_SUCCEEDED(result))
+    {
+        result = TRACE_CALL(colormcu_imu_set_allocator(device->colormcu, &device->allocator));
+    }
+    return result;
+}
+
+k4a_result_t k4a_device_set_allocator(k4a_device_t device_handle,
+                                      k4a_memory_allocate_source_cb_t *allocate,
+                                      k4a_memory_destroy_cb_t *free,
+                                      void *allocator_context)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_device_t, device_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, (allocate == NULL) != (free == NULL));
     k4a_context_t *device = k4a_device_t_get_context(device_handle);
 
-    return calibration_get_raw_data(device->calibration, data, data_size);
+    if (device->depth_started || device->color_started || device->imu_started)
+    {
+        LOG_ERROR("The device allocator can not be changed while the cameras or IMU are running", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    device->allocator.allocate = allocate;
+    device->allocator.free = free;
+    device->allocator.context = allocator_context;
+    return TRACE_CALL(k4a_device_apply_allocator(device));
 }
 
-k4a_result_t k4a_device_get_calibration(k4a_device_t device_handle,
-                                        const k4a_depth_mode_t depth_mode,
-                                        const k4a_color_resolution_t color_resolution,
-                                        k4a_calibration_t *calibration)
+k4a_result_t k4a_device_set_buffer_ring(k4a_device_t device_handle,
+                                        k4a_allocation_source_t source,
+                                        k4a_buffer_ring_t ring_handle)
 {
     RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_device_t, device_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED,
+                        source <= K4A_ALLOCATION_SOURCE_USER || source >= K4A_ALLOCATION_SOURCE_COUNT);
     k4a_context_t *device = k4a_device_t_get_context(device_handle);
 
-    k4a_calibration_camera_t depth_calibration;
-    if (K4A_FAILED(
-            TRACE_CALL(calibration_get_camera(device->calibration, K4A_CALIBRATION_TYPE_DEPTH, &depth_calibration))))
+    if (device->depth_started || device->color_started || device->imu_started)
     {
+        LOG_ERROR("The buffer rings of a device can not be changed while the cameras or IMU are running", 0);
         return K4A_RESULT_FAILED;
     }
 
-    k4a_calibration_camera_t color_calibration;
-    if (K4A_FAILED(
-            TRACE_CALL(calibration_get_camera(device->calibration, K4A_CALIBRATION_TYPE_COLOR, &color_calibration))))
+    if (ring_handle != NULL && K4A_FAILED(TRACE_CALL(allocator_ring_add_ref(ring_handle))))
     {
         return K4A_RESULT_FAILED;
     }
-
-    k4a_calibration_extrinsics_t *gyro_extrinsics = imu_get_gyro_extrinsics(device->imu);
-    k4a_calibration_extrinsics_t *accel_extrinsics = imu_get_accel_extrinsics(device->imu);
-
-    return TRACE_CALL(transformation_get_mode_specific_calibration(&depth_calibration,
-                                                                   &color_calibration,
-                                                                   gyro_extrinsics,
-                                                                   accel_extrinsics,
-                                                                   depth_mode,
-                                                                   color_resolution,
-                                                                   calibration));
+    if (device->allocator.rings[source] != NULL)
+    {
+        // Slots in use keep their own reference on the ring
+        allocator_ring_release(device->allocator.rings[source]);
+    }
+    device->allocator.rings[source] = ring_handle;
+    return TRACE_CALL(k4a_device_apply_allocator(device));
 }
 
-k4a_result_t k4a_calibration_get_from_raw(char *raw_calibration,
-                                          size_t raw_calibration_size,
-                                          const k4a_depth_mode_t depth_mode,
-                                          const k4a_color_resolution_t color_resolution,
-                                          k4a_calibration_t *calibration)
+k4a_result_t k4a_device_set_depth_engine_gpu(k4a_device_t device_handle, int32_t gpu_index)
 {
-    k4a_calibration_camera_t depth_calibration;
-    k4a_calibration_camera_t color_calibration;
-    k4a_calibration_imu_t gyro_calibration;
-    k4a_calibration_imu_t accel_calibration;
-    k4a_result_t result;
-
-    result = TRACE_CALL(calibration_create_from_raw(raw_calibration,
-                                                    raw_calibration_size,
-                                                    &depth_calibration,
-                                                    &color_calibration,
-                                                    &gyro_calibration,
-                                                    &accel_calibration));
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_device_t, device_handle);
+    k4a_context_t *device = k4a_device_t_get_context(device_handle);
 
-    if (K4A_SUCCEEDED(result))
+    if (device->depth_started)
     {
-        result = TRACE_CALL(transformation_get_mode_specific_calibration(&depth_calibration,
-                                                                         &color_calibration,
-                                                                         &gyro_calibration.depth_to_imu,
-                                                                         &accel_calibration.depth_to_imu,
-                                                                         depth_mode,
-                                                                         color_resolution,
-                                                                         calibration));
+        LOG_ERROR("The depth engine GPU can not be changed while the depth camera is running", 0);
+        return K4A_RESULT_FAILED;
     }
-    return result;
+
+    return TRACE_CALL(depth_set_depth_engine_gpu(device->depth, gpu_index));
 }
 
-k4a_result_t k4a_calibration_3d_to_3d(const k4a_calibration_t *calibration,
-                                      const k4a_float3_t *source_point3d_mm,
-                                      const k4a_calibration_type_t source_camera,
-                                      const k4a_calibration_type_t target_camera,
+k4a_result_t k4a_device_set_depth_filter(k4a_device_t device_handle, const k4a_depth_filter_configuration_t *config)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_device_t, device_handle);
+    k4a_context_t *device = k4a_device_t_get_context(device_handle);
+
+    if (device->depth_started)
+    {
+        LOG_ERROR("The depth filter can not be changed while the depth camera is running", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    return TRACE_CALL(depth_set_depth_filter(device->depth, config));
+}
+
+k4a_result_t k4a_device_set_color_decode(k4a_device_t device_handle, const k4a_color_decode_configuration_t *config)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_device_t, device_handle);
+    k4a_context_t *device = k4a_device_t_get_context(device_handle);
+
+    if (device->color_started)
+    {
+        LOG_ERROR("The color decode can not be changed while the color camera is running", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    return TRACE_CALL(color_set_decode(device->color, config));
+}
+
+k4a_result_t k4a_device_set_depth_engine_keep_alive(k4a_device_t device_handle, bool keep_alive)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_device_t, device_handle);
+    k4a_context_t *device = k4a_device_t_get_context(device_handle);
+
+    return TRACE_CALL(depth_set_depth_engine_keep_alive(device->depth, keep_alive));
+}
+
+k4a_result_t k4a_device_get_depth_engine_gpu_statistics(k4a_device_t device_handle,
+                                                        k4a_depth_engine_gpu_statistics_t *statistics)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_device_t, device_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, statistics == NULL);
+    k4a_context_t *device = k4a_device_t_get_context(device_handle);
+
+    return TRACE_CALL(depth_get_depth_engine_gpu_statistics(device->depth, statistics));
+}
+
+k4a_result_t k4a_device_get_statistics(k4a_device_t device_handle, k4a_device_statistics_t *statistics)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_device_t, device_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, statistics == NULL);
+    k4a_context_t *device = k4a_device_t_get_context(device_handle);
+
+    memset(statistics, 0, sizeof(*statistics));
+    k4a_result_t result = TRACE_CALL(depth_get_statistics(device->depth, statistics));
+    if (K4A_SUCCEEDED(result))
+    {
+        result = TRACE_CALL(capturesync_get_statistics(device->capturesync, statistics));
+    }
+    if (K4A_SUCCEEDED(result) && device->imu != NULL)
+    {
+        result = TRACE_CALL(imu_get_statistics(device->imu, statistics));
+    }
+    if (K4A_SUCCEEDED(result))
+    {
+        statistics->open_time_usec = device->startup_times.open_time_usec;
+        statistics->open_depth_mcu_time_usec = device->startup_times.open_depth_mcu_time_usec;
+        statistics->open_calibration_time_usec = device->startup_times.open_calibration_time_usec;
+        statistics->open_color_time_usec = device->startup_times.open_color_time_usec;
+        statistics->open_depth_engine_load_time_usec = device->startup_times.open_depth_engine_load_time_usec;
+        statistics->open_imu_time_usec = device->startup_times.open_imu_time_usec;
+        statistics->start_time_usec = device->startup_times.start_time_usec;
+        statistics->start_depth_time_usec = device->startup_times.start_depth_time_usec;
+        statistics->start_color_time_usec = device->startup_times.start_color_time_usec;
+    }
+    return result;
+}
+
+k4a_result_t k4a_device_get_clock_model(k4a_device_t device_handle, k4a_device_clock_model_t *clock_model)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_device_t, device_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, clock_model == NULL);
+    k4a_context_t *device = k4a_device_t_get_context(device_handle);
+
+    return TRACE_CALL(clockmodel_get(device->clockmodel, clock_model));
+}
+
+k4a_result_t k4a_device_convert_device_timestamp(k4a_device_t device_handle,
+                                                 uint64_t device_timestamp_usec,
+                                                 uint64_t *system_timestamp_nsec)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_device_t, device_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, system_timestamp_nsec == NULL);
+    k4a_context_t *device = k4a_device_t_get_context(device_handle);
+
+    return TRACE_CALL(clockmodel_convert(device->clockmodel, device_timestamp_usec, system_timestamp_nsec));
+}
+
+k4a_result_t k4a_device_get_usb_streaming_transfer_count(k4a_device_t device_handle, uint32_t *transfer_count)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_device_t, device_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, transfer_count == NULL);
+    k4a_context_t *device = k4a_device_t_get_context(device_handle);
+
+    return TRACE_CALL(depthmcu_depth_get_transfer_count(device->depthmcu, transfer_count));
+}
+
+k4a_result_t k4a_device_get_color_control_capabilities(k4a_device_t device_handle,
+                                                       k4a_color_control_command_t command,
+                                                       bool *supports_auto,
+                                                       int32_t *min_value,
+                                                       int32_t *max_value,
+                                                       int32_t *step_value,
+                                                       int32_t *default_value,
+                                                       k4a_color_control_mode_t *default_mode)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_device_t, device_handle);
+    k4a_context_t *device = k4a_device_t_get_context(device_handle);
+
+    return TRACE_CALL(color_get_control_capabilities(
+        device->color, command, supports_auto, min_value, max_value, step_value, default_value, default_mode));
+}
+
+k4a_result_t k4a_device_get_color_control(k4a_device_t device_handle,
+                                          k4a_color_control_command_t command,
+                                          k4a_color_control_mode_t *mode,
+                                          int32_t *value)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_device_t, device_handle);
+    k4a_context_t *device = k4a_device_t_get_context(device_handle);
+
+    return TRACE_CALL(color_get_control(device->color, command, mode, value));
+}
+
+k4a_result_t k4a_device_refresh_color_control(k4a_device_t device_handle,
+                                              k4a_color_control_command_t command,
+                                              k4a_color_control_mode_t *mode,
+                                              int32_t *value)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_device_t, device_handle);
+    k4a_context_t *device = k4a_device_t_get_context(device_handle);
+
+    return TRACE_CALL(color_refresh_control(device->color, command, mode, value));
+}
+
+k4a_result_t k4a_device_set_color_control(k4a_device_t device_handle,
+                                          k4a_color_control_command_t command,
+                                          k4a_color_control_mode_t mode,
+                                          int32_t value)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_device_t, device_handle);
+    k4a_context_t *device = k4a_device_t_get_context(device_handle);
+
+    return TRACE_CALL(color_set_control(device->color, command, mode, value));
+}
+
+k4a_buffer_result_t k4a_device_get_raw_calibration(k4a_device_t device_handle, uint8_t *data, size_t *data_size)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_BUFFER_RESULT_FAILED, k4a_device_t, device_handle);
+    k4a_context_t *device = k4a_device_t_get_context(device_handle);
+
+    return calibration_get_raw_data(device->calibration, data, data_size);
+}
+
+k4a_buffer_result_t k4a_device_get_raw_depth_calibration(k4a_device_t device_handle, uint8_t *data, size_t *data_size)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_BUFFER_RESULT_FAILED, k4a_device_t, device_handle);
+    k4a_context_t *device = k4a_device_t_get_context(device_handle);
+
+    return depth_get_raw_calibration(device->depth, data, data_size);
+}
+
+k4a_result_t k4a_device_get_calibration(k4a_device_t device_handle,
+                                        const k4a_depth_mode_t depth_mode,
+                                        const k4a_color_resolution_t color_resolution,
+                                        k4a_calibration_t *calibration)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_device_t, device_handle);
+    k4a_context_t *device = k4a_device_t_get_context(device_handle);
+
+    k4a_calibration_camera_t depth_calibration;
+    if (K4A_FAILED(
+            TRACE_CALL(calibration_get_camera(device->calibration, K4A_CALIBRATION_TYPE_DEPTH, &depth_calibration))))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    k4a_calibration_camera_t color_calibration;
+    if (K4A_FAILED(
+            TRACE_CALL(calibration_get_camera(device->calibration, K4A_CALIBRATION_TYPE_COLOR, &color_calibration))))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    k4a_calibration_extrinsics_t *gyro_extrinsics = imu_get_gyro_extrinsics(device->imu);
+    k4a_calibration_extrinsics_t *accel_extrinsics = imu_get_accel_extrinsics(device->imu);
+
+    return TRACE_CALL(transformation_get_mode_specific_calibration(&depth_calibration,
+                                                                   &color_calibration,
+                                                                   gyro_extrinsics,
+                                                                   accel_extrinsics,
+                                                                   depth_mode,
+                                                                   color_resolution,
+                                                                   calibration));
+}
+
+k4a_result_t k4a_calibration_get_from_raw(char *raw_calibration,
+                                          size_t raw_calibration_size,
+                                          const k4a_depth_mode_t depth_mode,
+                                          const k4a_color_resolution_t color_resolution,
+                                          k4a_calibration_t *calibration)
+{
+    k4a_calibration_camera_t depth_calibration;
+    k4a_calibration_camera_t color_calibration;
+    k4a_calibration_imu_t gyro_calibration;
+    k4a_calibration_imu_t accel_calibration;
+    k4a_result_t result;
+
+    result = TRACE_CALL(calibration_create_from_raw(raw_calibration,
+                                                    raw_calibration_size,
+                                                    &depth_calibration,
+                                                    &color_calibration,
+                                                    &gyro_calibration,
+                                                    &accel_calibration));
+
+    if (K4A_SUCCEEDED(result))
+    {
+        result = TRACE_CALL(transformation_get_mode_specific_calibration(&depth_calibration,
+                                                                         &color_calibration,
+                                                                         &gyro_calibration.depth_to_imu,
+                                                                         &accel_calibration.depth_to_imu,
+                                                                         depth_mode,
+                                                                         color_resolution,
+                                                                         calibration));
+    }
+    return result;
+}
+
+k4a_result_t k4a_calibration_3d_to_3d(const k4a_calibration_t *calibration,
+                                      const k4a_float3_t *source_point3d_mm,
+                                      const k4a_calibration_type_t source_camera,
+                                      const k4a_calibration_type_t target_camera,
                                       k4a_float3_t *target_point3d_mm)
 {
     return TRACE_CALL(
@@ -1148,9 +2224,95 @@ k4a_result_t k4a_calibration_color_2d_to_depth_2d(const k4a_calibration_t *calib
         transformation_color_2d_to_depth_2d(calibration, source_point2d->v, depth_image, target_point2d->v, valid));
 }
 
+k4a_result_t k4a_calibration_2d_to_3d_batch(const k4a_calibration_t *calibration,
+                                            const k4a_float2_t *source_point2d,
+                                            const float *source_depth_mm,
+                                            size_t point_count,
+                                            const k4a_calibration_type_t source_camera,
+                                            const k4a_calibration_type_t target_camera,
+                                            k4a_float3_t *target_point3d_mm,
+                                            int *valid)
+{
+    return TRACE_CALL(transformation_2d_to_3d_batch(calibration,
+                                                    source_point2d->v,
+                                                    source_depth_mm,
+                                                    point_count,
+                                                    source_camera,
+                                                    target_camera,
+                                                    target_point3d_mm->v,
+                                                    valid));
+}
+
+k4a_result_t k4a_calibration_3d_to_2d_batch(const k4a_calibration_t *calibration,
+                                            const k4a_float3_t *source_point3d_mm,
+                                            size_t point_count,
+                                            const k4a_calibration_type_t source_camera,
+                                            const k4a_calibration_type_t target_camera,
+                                            k4a_float2_t *target_point2d,
+                                            int *valid)
+{
+    return TRACE_CALL(transformation_3d_to_2d_batch(
+        calibration, source_point3d_mm->v, point_count, source_camera, target_camera, target_point2d->v, valid));
+}
+
+k4a_result_t k4a_calibration_2d_to_2d_batch(const k4a_calibration_t *calibration,
+                                            const k4a_float2_t *source_point2d,
+                                            const float *source_depth_mm,
+                                            size_t point_count,
+                                            const k4a_calibration_type_t source_camera,
+                                            const k4a_calibration_type_t target_camera,
+                                            k4a_float2_t *target_point2d,
+                                            int *valid)
+{
+    return TRACE_CALL(transformation_2d_to_2d_batch(calibration,
+                                                    source_point2d->v,
+                                                    source_depth_mm,
+                                                    point_count,
+                                                    source_camera,
+                                                    target_camera,
+                                                    target_point2d->v,
+                                                    valid));
+}
+
+k4a_result_t k4a_calibration_color_2d_to_depth_2d_batch(const k4a_calibration_t *calibration,
+                                                        const k4a_float2_t *source_point2d,
+                                                        size_t point_count,
+                                                        const k4a_image_t depth_image,
+                                                        k4a_float2_t *target_point2d,
+                                                        int *valid)
+{
+    return TRACE_CALL(transformation_color_2d_to_depth_2d_batch(
+        calibration, source_point2d->v, point_count, depth_image, target_point2d->v, valid));
+}
+
+// Transformations run on the GPU unless K4A_TRANSFORMATION_DISABLE_GPU is set to 1, for hosts without a usable GPU
+static bool k4a_transformation_use_gpu(void)
+{
+    const char *disable_gpu = environment_get_variable("K4A_TRANSFORMATION_DISABLE_GPU");
+    if (disable_gpu != NULL && disable_gpu[0] == '1')
+    {
+        return false;
+    }
+    return TRANSFORM_ENABLE_GPU_OPTIMIZATION;
+}
+
 k4a_transformation_t k4a_transformation_create(const k4a_calibration_t *calibration)
 {
-    return transformation_create(calibration, TRANSFORM_ENABLE_GPU_OPTIMIZATION);
+    return transformation_create(calibration, k4a_transformation_use_gpu());
+}
+
+k4a_transformation_t k4a_transformation_create_with_allocator(const k4a_calibration_t *calibration,
+                                                              k4a_memory_allocate_source_cb_t *allocate,
+                                                              k4a_memory_destroy_cb_t *free,
+                                                              void *allocator_context)
+{
+    RETURN_VALUE_IF_ARG(NULL, (allocate == NULL) != (free == NULL));
+
+    allocator_hook_t hook = { 0 };
+    hook.allocate = allocate;
+    hook.free = free;
+    hook.context = allocator_context;
+    return transformation_create_with_allocator(calibration, k4a_transformation_use_gpu(), &hook);
 }
 
 void k4a_transformation_destroy(k4a_transformation_t transformation_handle)
@@ -1158,132 +2320,1250 @@ void k4a_transformation_destroy(k4a_transformation_t transformation_handle)
     transformation_destroy(transformation_handle);
 }
 
-static k4a_transformation_image_descriptor_t k4a_image_get_descriptor(const k4a_image_t image)
+k4a_result_t k4a_transformation_warm_up(k4a_transformation_t transformation_handle)
 {
-    k4a_transformation_image_descriptor_t descriptor;
-    descriptor.width_pixels = k4a_image_get_width_pixels(image);
-    descriptor.height_pixels = k4a_image_get_height_pixels(image);
-    descriptor.stride_bytes = k4a_image_get_stride_bytes(image);
-    descriptor.format = k4a_image_get_format(image);
-    return descriptor;
+    return TRACE_CALL(transformation_warm_up(transformation_handle));
 }
 
-k4a_result_t k4a_transformation_depth_image_to_color_camera(k4a_transformation_t transformation_handle,
-                                                            const k4a_image_t depth_image,
-                                                            k4a_image_t transformed_depth_image)
+k4a_result_t k4a_transformation_set_cpu_thread_count(k4a_transformation_t transformation_handle, uint32_t thread_count)
 {
-    k4a_transformation_image_descriptor_t depth_image_descriptor = k4a_image_get_descriptor(depth_image);
-    k4a_transformation_image_descriptor_t transformed_depth_image_descriptor = k4a_image_get_descriptor(
-        transformed_depth_image);
+    return TRACE_CALL(transformation_set_cpu_thread_count(transformation_handle, thread_count));
+}
 
-    uint8_t *depth_image_buffer = k4a_image_get_buffer(depth_image);
-    uint8_t *transformed_depth_image_buffer = k4a_image_get_buffer(transformed_depth_image);
+k4a_result_t k4a_transformation_set_depth_to_color_mode(k4a_transformation_t transformation_handle,
+                                                        k4a_transformation_depth_to_color_mode_t mode)
+{
+    return TRACE_CALL(transformation_set_depth_to_color_mode(transformation_handle, mode));
+}
 
-    // Both k4a_transformation_depth_image_to_color_camera and k4a_transformation_depth_image_to_color_camera_custom
-    // call the same implementation of transformation_depth_image_to_color_camera_custom. The below parameters need
-    // to be passed in but they will be ignored in the internal implementation.
-    k4a_transformation_image_descriptor_t dummy_descriptor = { 0 };
-    uint8_t *custom_image_buffer = NULL;
-    uint8_t *transformed_custom_image_buffer = NULL;
-    k4a_transformation_interpolation_type_t interpolation_type = K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR;
-    uint32_t invalid_custom_value = 0;
+k4a_result_t k4a_transformation_set_fixed_point_bilinear(k4a_transformation_t transformation_handle, bool enable)
+{
+    return TRACE_CALL(transformation_set_fixed_point_bilinear(transformation_handle, enable));
+}
 
-    return TRACE_CALL(transformation_depth_image_to_color_camera_custom(transformation_handle,
-                                                                        depth_image_buffer,
-                                                                        &depth_image_descriptor,
-                                                                        custom_image_buffer,
-                                                                        &dummy_descriptor,
-                                                                        transformed_depth_image_buffer,
-                                                                        &transformed_depth_image_descriptor,
-                                                                        transformed_custom_image_buffer,
-                                                                        &dummy_descriptor,
-                                                                        interpolation_type,
-                                                                        invalid_custom_value));
+k4a_result_t k4a_transformation_get_xy_table(k4a_transformation_t transformation_handle,
+                                            k4a_calibration_type_t camera,
+                                            k4a_xy_table_t *xy_table)
+{
+    return TRACE_CALL(transformation_get_xy_table(transformation_handle, camera, xy_table));
 }
 
-k4a_result_t
-k4a_transformation_depth_image_to_color_camera_custom(k4a_transformation_t transformation_handle,
-                                                      const k4a_image_t depth_image,
-                                                      const k4a_image_t custom_image,
-                                                      k4a_image_t transformed_depth_image,
-                                                      k4a_image_t transformed_custom_image,
-                                                      k4a_transformation_interpolation_type_t interpolation_type,
-                                                      uint32_t invalid_custom_value)
+k4a_result_t k4a_transformation_set_precomputed_rays(k4a_transformation_t transformation_handle, bool enable)
 {
-    k4a_transformation_image_descriptor_t depth_image_descriptor = k4a_image_get_descriptor(depth_image);
-    k4a_transformation_image_descriptor_t custom_image_descriptor = k4a_image_get_descriptor(custom_image);
-    k4a_transformation_image_descriptor_t transformed_depth_image_descriptor = k4a_image_get_descriptor(
-        transformed_depth_image);
-    k4a_transformation_image_descriptor_t transformed_custom_image_descriptor = k4a_image_get_descriptor(
-        transformed_custom_image);
-
-    uint8_t *depth_image_buffer = k4a_image_get_buffer(depth_image);
-    uint8_t *custom_image_buffer = k4a_image_get_buffer(custom_image);
-    uint8_t *transformed_depth_image_buffer = k4a_image_get_buffer(transformed_depth_image);
-    uint8_t *transformed_custom_image_buffer = k4a_image_get_buffer(transformed_custom_image);
-
-    return TRACE_CALL(transformation_depth_image_to_color_camera_custom(transformation_handle,
-                                                                        depth_image_buffer,
-                                                                        &depth_image_descriptor,
-                                                                        custom_image_buffer,
-                                                                        &custom_image_descriptor,
-                                                                        transformed_depth_image_buffer,
-                                                                        &transformed_depth_image_descriptor,
-                                                                        transformed_custom_image_buffer,
-                                                                        &transformed_custom_image_descriptor,
-                                                                        interpolation_type,
-                                                                        invalid_custom_value));
+    return TRACE_CALL(transformation_set_precomputed_rays(transformation_handle, enable));
 }
 
-k4a_result_t k4a_transformation_color_image_to_depth_camera(k4a_transformation_t transformation_handle,
-                                                            const k4a_image_t depth_image,
-                                                            const k4a_image_t color_image,
-                                                            k4a_image_t transformed_color_image)
+k4a_result_t k4a_transformation_set_backend(k4a_transformation_t transformation_handle,
+                                            k4a_transformation_backend_t backend)
 {
-    k4a_transformation_image_descriptor_t depth_image_descriptor = k4a_image_get_descriptor(depth_image);
-    k4a_transformation_image_descriptor_t color_image_descriptor = k4a_image_get_descriptor(color_image);
-    k4a_transformation_image_descriptor_t transformed_color_image_descriptor = k4a_image_get_descriptor(
-        transformed_color_image);
+    return TRACE_CALL(transformation_set_backend(transformation_handle, backend));
+}
 
-    k4a_image_format_t color_image_format = k4a_image_get_format(color_image);
-    k4a_image_format_t transformed_color_image_format = k4a_image_get_format(transformed_color_image);
-    if (!(color_image_format == K4A_IMAGE_FORMAT_COLOR_BGRA32 &&
-          transformed_color_image_format == K4A_IMAGE_FORMAT_COLOR_BGRA32))
-    {
-        LOG_ERROR("Require color image and transformed color image both have bgra32 format.", 0);
-        return K4A_RESULT_FAILED;
-    }
+k4a_result_t k4a_transformation_set_gpu_output(k4a_transformation_t transformation_handle, bool enable)
+{
+    return TRACE_CALL(transformation_set_gpu_output(transformation_handle, enable));
+}
 
-    uint8_t *depth_image_buffer = k4a_image_get_buffer(depth_image);
-    uint8_t *color_image_buffer = k4a_image_get_buffer(color_image);
-    uint8_t *transformed_color_image_buffer = k4a_image_get_buffer(transformed_color_image);
+k4a_result_t k4a_transformation_get_gpu_output(k4a_transformation_t transformation_handle,
+                                               k4a_transformation_gpu_output_t output,
+                                               void **gpu_buffer)
+{
+    return TRACE_CALL(transformation_get_gpu_output(transformation_handle, output, gpu_buffer));
+}
 
-    return TRACE_CALL(transformation_color_image_to_depth_camera(transformation_handle,
-                                                                 depth_image_buffer,
-                                                                 &depth_image_descriptor,
-                                                                 color_image_buffer,
-                                                                 &color_image_descriptor,
-                                                                 transformed_color_image_buffer,
-                                                                 &transformed_color_image_descriptor));
+k4a_result_t k4a_transformation_set_gpu_context(k4a_transformation_t transformation_handle,
+                                                void *gpu_context,
+                                                void *gpu_device)
+{
+    return TRACE_CALL(transformation_set_gpu_context(transformation_handle, gpu_context, gpu_device));
 }
 
-k4a_result_t k4a_transformation_depth_image_to_point_cloud(k4a_transformation_t transformation_handle,
-                                                           const k4a_image_t depth_image,
-                                                           const k4a_calibration_type_t camera,
-                                                           k4a_image_t xyz_image)
+k4a_result_t k4a_transformation_set_gpu_output_target(k4a_transformation_t transformation_handle,
+                                                      k4a_transformation_gpu_output_t output,
+                                                      k4a_transformation_gpu_target_t target_type,
+                                                      void *target)
 {
-    k4a_transformation_image_descriptor_t depth_image_descriptor = k4a_image_get_descriptor(depth_image);
-    k4a_transformation_image_descriptor_t xyz_image_descriptor = k4a_image_get_descriptor(xyz_image);
+    return TRACE_CALL(transformation_set_gpu_output_target(transformation_handle, output, target_type, target));
+}
 
-    uint8_t *depth_image_buffer = k4a_image_get_buffer(depth_image);
-    uint8_t *xyz_image_buffer = k4a_image_get_buffer(xyz_image);
+static k4a_transformation_image_descriptor_t k4a_image_get_descriptor(const k4a_image_t image)
+{
+    k4a_transformation_image_descriptor_t descriptor;
+    k4a_image_info_t info = { 0 };
+    if (K4A_FAILED(image_get_info(image, &info)))
+    {
+        // Match the individual getters for an invalid handle
+        info.format = K4A_IMAGE_FORMAT_CUSTOM;
+    }
+    descriptor.width_pixels = info.width_pixels;
+    descriptor.height_pixels = info.height_pixels;
+    descriptor.stride_bytes = info.stride_bytes;
+    descriptor.format = info.format;
+    return descriptor;
+}
+
+// An image as passed to the transformation engine. The engine requires packed rows, so images with a padded stride,
+// such as views from k4a_image_create_view(), are copied to a packed buffer for the call.
+typedef struct
+{
+    k4a_image_t image;
+    k4a_transformation_image_descriptor_t descriptor;
+    uint8_t *buffer;
+    bool packed;
+} k4a_transformation_image_t;
+
+static void k4a_transformation_image_copy_rows(uint8_t *dst,
+                                               size_t dst_stride,
+                                               const uint8_t *src,
+                                               size_t src_stride,
+                                               size_t row_bytes,
+                                               int rows)
+{
+    for (int row = 0; row < rows; row++)
+    {
+        memcpy(dst + (size_t)row * dst_stride, src + (size_t)row * src_stride, row_bytes);
+    }
+}
+
+static k4a_result_t k4a_transformation_image_begin(const k4a_image_t image, k4a_transformation_image_t *timage)
+{
+    timage->image = image;
+    timage->descriptor = k4a_image_get_descriptor(image);
+    timage->buffer = k4a_image_get_buffer(image);
+    timage->packed = false;
+
+    // NV12 has a second plane and the transformations reject it, the engine validates everything else
+    int bytes_per_pixel = image_get_bytes_per_pixel(timage->descriptor.format);
+    if (timage->buffer == NULL || bytes_per_pixel == 0 || timage->descriptor.format == K4A_IMAGE_FORMAT_COLOR_NV12)
+    {
+        return K4A_RESULT_SUCCEEDED;
+    }
+
+    size_t row_bytes = (size_t)timage->descriptor.width_pixels * (size_t)bytes_per_pixel;
+    if ((size_t)timage->descriptor.stride_bytes <= row_bytes || timage->descriptor.height_pixels <= 0)
+    {
+        return K4A_RESULT_SUCCEEDED;
+    }
+
+    // Outputs are copied in too, not every transformation writes every pixel
+    uint8_t *packed = (uint8_t *)malloc(row_bytes * (size_t)timage->descriptor.height_pixels);
+    if (packed == NULL)
+    {
+        LOG_ERROR("Failed to allocate a packed copy of a %dx%d image.",
+                  timage->descriptor.width_pixels,
+                  timage->descriptor.height_pixels);
+        return K4A_RESULT_FAILED;
+    }
+    k4a_transformation_image_copy_rows(packed,
+                                       row_bytes,
+                                       timage->buffer,
+                                       (size_t)timage->descriptor.stride_bytes,
+                                       row_bytes,
+                                       timage->descriptor.height_pixels);
+    timage->buffer = packed;
+    timage->descriptor.stride_bytes = (int)row_bytes;
+    timage->packed = true;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+static void k4a_transformation_image_end(k4a_transformation_image_t *timage, bool write_back)
+{
+    if (!timage->packed)
+    {
+        return;
+    }
+    if (write_back)
+    {
+        k4a_image_info_t info = { 0 };
+        if (K4A_SUCCEEDED(image_get_info(timage->image, &info)))
+        {
+            k4a_transformation_image_copy_rows(k4a_image_get_buffer(timage->image),
+                                               (size_t)info.stride_bytes,
+                                               timage->buffer,
+                                               (size_t)timage->descriptor.stride_bytes,
+                                               (size_t)timage->descriptor.stride_bytes,
+                                               timage->descriptor.height_pixels);
+        }
+    }
+    free(timage->buffer);
+    timage->buffer = NULL;
+    timage->packed = false;
+}
+
+// Prepares the images of a transformation call, NULL entries are skipped
+static k4a_result_t
+k4a_transformation_images_begin(k4a_transformation_image_t *timages, const k4a_image_t *images, int count)
+{
+    k4a_result_t result = K4A_RESULT_SUCCEEDED;
+    int i = 0;
+    for (; i < count && K4A_SUCCEEDED(result); i++)
+    {
+        result = TRACE_CALL(k4a_transformation_image_begin(images[i], &timages[i]));
+    }
+    if (K4A_FAILED(result))
+    {
+        for (int j = 0; j < i - 1; j++)
+        {
+            k4a_transformation_image_end(&timages[j], false);
+        }
+    }
+    return result;
+}
+
+// Releases the packed copies, writing the outputs, entries from first_output on, back when the call succeeded
+static void
+k4a_transformation_images_end(k4a_transformation_image_t *timages, int count, int first_output, k4a_result_t result)
+{
+    for (int i = 0; i < count; i++)
+    {
+        k4a_transformation_image_end(&timages[i], i >= first_output && K4A_SUCCEEDED(result));
+    }
+}
+
+k4a_result_t k4a_transformation_depth_image_to_color_camera(k4a_transformation_t transformation_handle,
+                                                            const k4a_image_t depth_image,
+                                                            k4a_image_t transformed_depth_image)
+{
+    const k4a_image_t images[] = { depth_image, transformed_depth_image };
+    k4a_transformation_image_t timages[2];
+    if (K4A_FAILED(TRACE_CALL(k4a_transformation_images_begin(timages, images, 2))))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    // Both k4a_transformation_depth_image_to_color_camera and k4a_transformation_depth_image_to_color_camera_custom
+    // call the same implementation of transformation_depth_image_to_color_camera_custom. The below parameters need
+    // to be passed in but they will be ignored in the internal implementation.
+    k4a_transformation_image_descriptor_t dummy_descriptor = { 0 };
+    uint8_t *custom_image_buffer = NULL;
+    uint8_t *transformed_custom_image_buffer = NULL;
+    k4a_transformation_interpolation_type_t interpolation_type = K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR;
+    uint32_t invalid_custom_value = 0;
+
+    k4a_result_t result = TRACE_CALL(transformation_depth_image_to_color_camera_custom(transformation_handle,
+                                                                                       timages[0].buffer,
+                                                                                       &timages[0].descriptor,
+                                                                                       custom_image_buffer,
+                                                                                       &dummy_descriptor,
+                                                                                       timages[1].buffer,
+                                                                                       &timages[1].descriptor,
+                                                                                       transformed_custom_image_buffer,
+                                                                                       &dummy_descriptor,
+                                                                                       interpolation_type,
+                                                                                       invalid_custom_value));
+    k4a_transformation_images_end(timages, 2, 1, result);
+    return result;
+}
+
+k4a_result_t k4a_transformation_depth_image_to_color_camera_roi(k4a_transformation_t transformation_handle,
+                                                                const k4a_image_t depth_image,
+                                                                const k4a_rect_t *roi,
+                                                                k4a_image_t transformed_depth_image)
+{
+    const k4a_image_t images[] = { depth_image, transformed_depth_image };
+    k4a_transformation_image_t timages[2];
+    if (K4A_FAILED(TRACE_CALL(k4a_transformation_images_begin(timages, images, 2))))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    k4a_result_t result = TRACE_CALL(transformation_depth_image_to_color_camera_roi(transformation_handle,
+                                                                                    timages[0].buffer,
+                                                                                    &timages[0].descriptor,
+                                                                                    roi,
+                                                                                    timages[1].buffer,
+                                                                                    &timages[1].descriptor));
+    k4a_transformation_images_end(timages, 2, 1, result);
+    return result;
+}
+
+k4a_result_t
+k4a_transformation_depth_image_to_color_camera_custom(k4a_transformation_t transformation_handle,
+                                                      const k4a_image_t depth_image,
+                                                      const k4a_image_t custom_image,
+                                                      k4a_image_t transformed_depth_image,
+                                                      k4a_image_t transformed_custom_image,
+                                                      k4a_transformation_interpolation_type_t interpolation_type,
+                                                      uint32_t invalid_custom_value)
+{
+    const k4a_image_t images[] = { depth_image, custom_image, transformed_depth_image, transformed_custom_image };
+    k4a_transformation_image_t timages[4];
+    if (K4A_FAILED(TRACE_CALL(k4a_transformation_images_begin(timages, images, 4))))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    k4a_result_t result = TRACE_CALL(transformation_depth_image_to_color_camera_custom(transformation_handle,
+                                                                                       timages[0].buffer,
+                                                                                       &timages[0].descriptor,
+                                                                                       timages[1].buffer,
+                                                                                       &timages[1].descriptor,
+                                                                                       timages[2].buffer,
+                                                                                       &timages[2].descriptor,
+                                                                                       timages[3].buffer,
+                                                                                       &timages[3].descriptor,
+                                                                                       interpolation_type,
+                                                                                       invalid_custom_value));
+    k4a_transformation_images_end(timages, 4, 2, result);
+    return result;
+}
+
+k4a_result_t
+k4a_transformation_depth_image_to_color_camera_custom_planes(k4a_transformation_t transformation_handle,
+                                                             const k4a_image_t depth_image,
+                                                             const k4a_image_t *custom_images,
+                                                             uint32_t custom_image_count,
+                                                             k4a_image_t transformed_depth_image,
+                                                             k4a_image_t *transformed_custom_images,
+                                                             k4a_transformation_interpolation_type_t interpolation_type,
+                                                             uint32_t invalid_custom_value)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED,
+                        custom_image_count == 0 || custom_image_count > K4A_TRANSFORMATION_MAX_CUSTOM_PLANES);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, custom_images == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, transformed_custom_images == NULL);
+
+    // Laid out as the depth image, the custom images, the transformed depth image and the transformed custom images
+    int count = (int)(2 * custom_image_count + 2);
+    int first_output = (int)custom_image_count + 1;
+    k4a_image_t images[2 * K4A_TRANSFORMATION_MAX_CUSTOM_PLANES + 2];
+    images[0] = depth_image;
+    images[first_output] = transformed_depth_image;
+    for (uint32_t i = 0; i < custom_image_count; i++)
+    {
+        images[1 + i] = custom_images[i];
+        images[first_output + 1 + (int)i] = transformed_custom_images[i];
+    }
+
+    k4a_transformation_image_t timages[2 * K4A_TRANSFORMATION_MAX_CUSTOM_PLANES + 2];
+    if (K4A_FAILED(TRACE_CALL(k4a_transformation_images_begin(timages, images, count))))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    // The planes share descriptors, packed copies already have their rows compacted
+    k4a_result_t result = K4A_RESULT_SUCCEEDED;
+    const uint8_t *custom_buffers[K4A_TRANSFORMATION_MAX_CUSTOM_PLANES];
+    uint8_t *transformed_custom_buffers[K4A_TRANSFORMATION_MAX_CUSTOM_PLANES];
+    for (uint32_t i = 0; i < custom_image_count && K4A_SUCCEEDED(result); i++)
+    {
+        const k4a_transformation_image_t *custom = &timages[1 + i];
+        const k4a_transformation_image_t *transformed_custom = &timages[first_output + 1 + (int)i];
+        if (memcmp(&custom->descriptor, &timages[1].descriptor, sizeof(custom->descriptor)) != 0 ||
+            memcmp(&transformed_custom->descriptor,
+                   &timages[first_output + 1].descriptor,
+                   sizeof(transformed_custom->descriptor)) != 0)
+        {
+            LOG_ERROR("Custom image %u does not match the format and size of the first custom image.", i);
+            result = K4A_RESULT_FAILED;
+        }
+        custom_buffers[i] = custom->buffer;
+        transformed_custom_buffers[i] = transformed_custom->buffer;
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        k4a_transformation_image_t *transformed_depth = &timages[first_output];
+        result = TRACE_CALL(
+            transformation_depth_image_to_color_camera_custom_planes(transformation_handle,
+                                                                     timages[0].buffer,
+                                                                     &timages[0].descriptor,
+                                                                     custom_buffers,
+                                                                     &timages[1].descriptor,
+                                                                     custom_image_count,
+                                                                     transformed_depth->buffer,
+                                                                     &transformed_depth->descriptor,
+                                                                     transformed_custom_buffers,
+                                                                     &transformed_depth[1].descriptor,
+                                                                     interpolation_type,
+                                                                     invalid_custom_value));
+    }
+    k4a_transformation_images_end(timages, count, first_output, result);
+    return result;
+}
+
+k4a_result_t k4a_transformation_color_image_to_depth_camera(k4a_transformation_t transformation_handle,
+                                                            const k4a_image_t depth_image,
+                                                            const k4a_image_t color_image,
+                                                            k4a_image_t transformed_color_image)
+{
+    k4a_image_format_t color_image_format = k4a_image_get_format(color_image);
+    k4a_image_format_t transformed_color_image_format = k4a_image_get_format(transformed_color_image);
+    if (!(color_image_format == K4A_IMAGE_FORMAT_COLOR_BGRA32 &&
+          transformed_color_image_format == K4A_IMAGE_FORMAT_COLOR_BGRA32))
+    {
+        LOG_ERROR("Require color image and transformed color image both have bgra32 format.", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    const k4a_image_t images[] = { depth_image, color_image, transformed_color_image };
+    k4a_transformation_image_t timages[3];
+    if (K4A_FAILED(TRACE_CALL(k4a_transformation_images_begin(timages, images, 3))))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    k4a_result_t result = TRACE_CALL(transformation_color_image_to_depth_camera(transformation_handle,
+                                                                                timages[0].buffer,
+                                                                                &timages[0].descriptor,
+                                                                                timages[1].buffer,
+                                                                                &timages[1].descriptor,
+                                                                                timages[2].buffer,
+                                                                                &timages[2].descriptor));
+    k4a_transformation_images_end(timages, 3, 2, result);
+    return result;
+}
+
+k4a_result_t k4a_transformation_color_image_to_depth_camera_roi(k4a_transformation_t transformation_handle,
+                                                                const k4a_image_t depth_image,
+                                                                const k4a_image_t color_image,
+                                                                const k4a_rect_t *roi,
+                                                                k4a_image_t transformed_color_image)
+{
+    const k4a_image_t images[] = { depth_image, color_image, transformed_color_image };
+    k4a_transformation_image_t timages[3];
+    if (K4A_FAILED(TRACE_CALL(k4a_transformation_images_begin(timages, images, 3))))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    k4a_result_t result = TRACE_CALL(transformation_color_image_to_depth_camera_roi(transformation_handle,
+                                                                                    timages[0].buffer,
+                                                                                    &timages[0].descriptor,
+                                                                                    timages[1].buffer,
+                                                                                    &timages[1].descriptor,
+                                                                                    roi,
+                                                                                    timages[2].buffer,
+                                                                                    &timages[2].descriptor));
+    k4a_transformation_images_end(timages, 3, 2, result);
+    return result;
+}
+
+k4a_result_t k4a_transformation_depth_image_to_point_cloud(k4a_transformation_t transformation_handle,
+                                                           const k4a_image_t depth_image,
+                                                           const k4a_calibration_type_t camera,
+                                                           k4a_image_t xyz_image)
+{
+    const k4a_image_t images[] = { depth_image, xyz_image };
+    k4a_transformation_image_t timages[2];
+    if (K4A_FAILED(TRACE_CALL(k4a_transformation_images_begin(timages, images, 2))))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    k4a_result_t result = TRACE_CALL(transformation_depth_image_to_point_cloud(transformation_handle,
+                                                                               timages[0].buffer,
+                                                                               &timages[0].descriptor,
+                                                                               camera,
+                                                                               timages[1].buffer,
+                                                                               &timages[1].descriptor));
+    k4a_transformation_images_end(timages, 2, 1, result);
+    return result;
+}
+
+k4a_result_t k4a_transformation_depth_image_to_point_cloud_roi(k4a_transformation_t transformation_handle,
+                                                               const k4a_image_t depth_image,
+                                                               const k4a_calibration_type_t camera,
+                                                               const k4a_rect_t *roi,
+                                                               k4a_image_t xyz_image)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, roi == NULL);
+    const k4a_image_t images[] = { depth_image, xyz_image };
+    k4a_transformation_image_t timages[2];
+    if (K4A_FAILED(TRACE_CALL(k4a_transformation_images_begin(timages, images, 2))))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    k4a_result_t result = TRACE_CALL(
+        transformation_depth_image_to_formatted_point_cloud(transformation_handle,
+                                                            timages[0].buffer,
+                                                            &timages[0].descriptor,
+                                                            camera,
+                                                            K4A_POINT_CLOUD_FORMAT_INT16_XYZ,
+                                                            roi,
+                                                            timages[1].buffer,
+                                                            &timages[1].descriptor));
+    k4a_transformation_images_end(timages, 2, 1, result);
+    return result;
+}
+
+k4a_result_t k4a_transformation_depth_image_to_formatted_point_cloud(k4a_transformation_t transformation_handle,
+                                                                     const k4a_image_t depth_image,
+                                                                     const k4a_calibration_type_t camera,
+                                                                     k4a_point_cloud_format_t format,
+                                                                     k4a_image_t xyz_image)
+{
+    const k4a_image_t images[] = { depth_image, xyz_image };
+    k4a_transformation_image_t timages[2];
+    if (K4A_FAILED(TRACE_CALL(k4a_transformation_images_begin(timages, images, 2))))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    k4a_result_t result = TRACE_CALL(transformation_depth_image_to_formatted_point_cloud(transformation_handle,
+                                                                                         timages[0].buffer,
+                                                                                         &timages[0].descriptor,
+                                                                                         camera,
+                                                                                         format,
+                                                                                         NULL,
+                                                                                         timages[1].buffer,
+                                                                                         &timages[1].descriptor));
+    k4a_transformation_images_end(timages, 2, 1, result);
+    return result;
+}
+
+k4a_result_t k4a_transformation_depth_image_to_valid_point_cloud(k4a_transformation_t transformation_handle,
+                                                                 const k4a_image_t depth_image,
+                                                                 const k4a_calibration_type_t camera,
+                                                                 k4a_image_t xyz_image,
+                                                                 uint32_t *pixel_indices,
+                                                                 size_t *point_count)
+{
+    const k4a_image_t images[] = { depth_image, xyz_image };
+    k4a_transformation_image_t timages[2];
+    if (K4A_FAILED(TRACE_CALL(k4a_transformation_images_begin(timages, images, 2))))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    k4a_result_t result = TRACE_CALL(transformation_depth_image_to_valid_point_cloud(transformation_handle,
+                                                                                     timages[0].buffer,
+                                                                                     &timages[0].descriptor,
+                                                                                     camera,
+                                                                                     timages[1].buffer,
+                                                                                     &timages[1].descriptor,
+                                                                                     pixel_indices,
+                                                                                     point_count));
+    k4a_transformation_images_end(timages, 2, 1, result);
+    return result;
+}
+
+k4a_result_t k4a_transformation_depth_image_to_colored_point_cloud(k4a_transformation_t transformation_handle,
+                                                                   const k4a_image_t depth_image,
+                                                                   const k4a_image_t color_image,
+                                                                   bool valid_points_only,
+                                                                   k4a_image_t xyz_image,
+                                                                   k4a_image_t bgra_image,
+                                                                   size_t *point_count)
+{
+    const k4a_image_t images[] = { depth_image, color_image, xyz_image, bgra_image };
+    k4a_transformation_image_t timages[4];
+    if (K4A_FAILED(TRACE_CALL(k4a_transformation_images_begin(timages, images, 4))))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    k4a_result_t result = TRACE_CALL(transformation_depth_image_to_colored_point_cloud(transformation_handle,
+                                                                                       timages[0].buffer,
+                                                                                       &timages[0].descriptor,
+                                                                                       timages[1].buffer,
+                                                                                       &timages[1].descriptor,
+                                                                                       valid_points_only,
+                                                                                       timages[2].buffer,
+                                                                                       &timages[2].descriptor,
+                                                                                       timages[3].buffer,
+                                                                                       &timages[3].descriptor,
+                                                                                       point_count));
+    k4a_transformation_images_end(timages, 4, 2, result);
+    return result;
+}
+
+k4a_result_t k4a_transformation_fuse_point_clouds(const k4a_point_cloud_fusion_input_t *inputs,
+                                                  uint32_t input_count,
+                                                  k4a_point_cloud_format_t format,
+                                                  bool valid_points_only,
+                                                  k4a_image_t xyz_image,
+                                                  k4a_image_t bgra_image,
+                                                  size_t *point_count)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, inputs == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, input_count == 0 || input_count > INT32_MAX / 2 - 1);
+
+    // The depth and color images of every input, then the outputs
+    int image_count = 2 * (int)input_count + 2;
+    k4a_image_t *images = (k4a_image_t *)malloc((size_t)image_count * sizeof(k4a_image_t));
+    k4a_transformation_image_t *timages = (k4a_transformation_image_t *)malloc((size_t)image_count *
+                                                                               sizeof(k4a_transformation_image_t));
+    k4a_transformation_fusion_source_t *sources = (k4a_transformation_fusion_source_t *)calloc(input_count,
+                                                                                               sizeof(*sources));
+    k4a_result_t result = K4A_RESULT_FROM_BOOL(images != NULL && timages != NULL && sources != NULL);
+
+    if (K4A_SUCCEEDED(result))
+    {
+        for (uint32_t i = 0; i < input_count; i++)
+        {
+            images[2 * i] = inputs[i].depth_image;
+            images[2 * i + 1] = inputs[i].color_image;
+        }
+        images[image_count - 2] = xyz_image;
+        images[image_count - 1] = bgra_image;
+        result = TRACE_CALL(k4a_transformation_images_begin(timages, images, image_count));
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        for (uint32_t i = 0; i < input_count; i++)
+        {
+            sources[i].transformation_handle = inputs[i].transformation_handle;
+            sources[i].depth_image_data = timages[2 * i].buffer;
+            sources[i].depth_image_descriptor = &timages[2 * i].descriptor;
+            sources[i].color_image_data = timages[2 * i + 1].buffer;
+            sources[i].color_image_descriptor = &timages[2 * i + 1].descriptor;
+            sources[i].depth_to_common = inputs[i].depth_to_common;
+        }
+
+        result = TRACE_CALL(transformation_fuse_point_clouds(sources,
+                                                             input_count,
+                                                             format,
+                                                             valid_points_only,
+                                                             timages[image_count - 2].buffer,
+                                                             &timages[image_count - 2].descriptor,
+                                                             timages[image_count - 1].buffer,
+                                                             &timages[image_count - 1].descriptor,
+                                                             point_count));
+        k4a_transformation_images_end(timages, image_count, image_count - 2, result);
+    }
+
+    free(sources);
+    free(timages);
+    free(images);
+    return result;
+}
+
+k4a_result_t k4a_transformation_point_cloud_to_normals(const k4a_image_t xyz_image, k4a_image_t normal_image)
+{
+    const k4a_image_t images[] = { xyz_image, normal_image };
+    k4a_transformation_image_t timages[2];
+    if (K4A_FAILED(TRACE_CALL(k4a_transformation_images_begin(timages, images, 2))))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    k4a_result_t result = TRACE_CALL(transformation_point_cloud_to_normals(timages[0].buffer,
+                                                                           &timages[0].descriptor,
+                                                                           timages[1].buffer,
+                                                                           &timages[1].descriptor));
+    k4a_transformation_images_end(timages, 2, 1, result);
+    return result;
+}
+
+k4a_result_t k4a_transformation_point_cloud_voxel_downsample(const k4a_image_t xyz_image,
+                                                             const k4a_image_t normal_image,
+                                                             float voxel_size,
+                                                             k4a_image_t downsampled_xyz_image,
+                                                             k4a_image_t downsampled_normal_image,
+                                                             size_t *point_count)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, (normal_image == NULL) != (downsampled_normal_image == NULL));
+    const k4a_image_t images[] = { xyz_image, normal_image, downsampled_xyz_image, downsampled_normal_image };
+    k4a_transformation_image_t timages[4];
+    if (K4A_FAILED(TRACE_CALL(k4a_transformation_images_begin(timages, images, 4))))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    k4a_result_t result = TRACE_CALL(transformation_point_cloud_voxel_downsample(timages[0].buffer,
+                                                                                 &timages[0].descriptor,
+                                                                                 timages[1].buffer,
+                                                                                 &timages[1].descriptor,
+                                                                                 voxel_size,
+                                                                                 timages[2].buffer,
+                                                                                 &timages[2].descriptor,
+                                                                                 timages[3].buffer,
+                                                                                 &timages[3].descriptor,
+                                                                                 point_count));
+    k4a_transformation_images_end(timages, 4, 2, result);
+    return result;
+}
+
+k4a_result_t k4a_transformation_create_undistort_map(k4a_transformation_t transformation_handle,
+                                                     const k4a_calibration_type_t camera,
+                                                     const k4a_pinhole_t *pinhole,
+                                                     k4a_transformation_interpolation_type_t interpolation_type,
+                                                     k4a_undistort_map_t *undistort_map_handle)
+{
+    k4a_transformation_pinhole_t transformation_pinhole = { 0 };
+    if (pinhole != NULL)
+    {
+        transformation_pinhole.px = pinhole->px;
+        transformation_pinhole.py = pinhole->py;
+        transformation_pinhole.fx = pinhole->fx;
+        transformation_pinhole.fy = pinhole->fy;
+        transformation_pinhole.width = pinhole->width;
+        transformation_pinhole.height = pinhole->height;
+    }
+
+    return TRACE_CALL(transformation_undistort_map_create(transformation_handle,
+                                                          camera,
+                                                          pinhole != NULL ? &transformation_pinhole : NULL,
+                                                          interpolation_type,
+                                                          undistort_map_handle));
+}
+
+void k4a_undistort_map_destroy(k4a_undistort_map_t undistort_map_handle)
+{
+    transformation_undistort_map_destroy(undistort_map_handle);
+}
+
+k4a_result_t k4a_undistort_map_get_pinhole(k4a_undistort_map_t undistort_map_handle, k4a_pinhole_t *pinhole)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, pinhole == NULL);
+
+    k4a_transformation_pinhole_t transformation_pinhole;
+    k4a_result_t result = TRACE_CALL(transformation_undistort_map_get_pinhole(undistort_map_handle,
+                                                                              &transformation_pinhole));
+    if (K4A_SUCCEEDED(result))
+    {
+        pinhole->px = transformation_pinhole.px;
+        pinhole->py = transformation_pinhole.py;
+        pinhole->fx = transformation_pinhole.fx;
+        pinhole->fy = transformation_pinhole.fy;
+        pinhole->width = transformation_pinhole.width;
+        pinhole->height = transformation_pinhole.height;
+    }
+    return result;
+}
+
+k4a_result_t k4a_transformation_undistort(k4a_undistort_map_t undistort_map_handle,
+                                          const k4a_image_t image,
+                                          k4a_image_t undistorted_image)
+{
+    const k4a_image_t images[] = { image, undistorted_image };
+    k4a_transformation_image_t timages[2];
+    if (K4A_FAILED(TRACE_CALL(k4a_transformation_images_begin(timages, images, 2))))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    k4a_result_t result = TRACE_CALL(transformation_undistort(undistort_map_handle,
+                                                              timages[0].buffer,
+                                                              &timages[0].descriptor,
+                                                              timages[1].buffer,
+                                                              &timages[1].descriptor));
+    k4a_transformation_images_end(timages, 2, 1, result);
+    return result;
+}
+
+typedef enum
+{
+    K4A_TRANSFORMATION_ASYNC_DEPTH_TO_COLOR = 0,
+    K4A_TRANSFORMATION_ASYNC_DEPTH_CUSTOM_TO_COLOR,
+    K4A_TRANSFORMATION_ASYNC_COLOR_TO_DEPTH,
+    K4A_TRANSFORMATION_ASYNC_POINT_CLOUD,
+} k4a_transformation_async_type_t;
+
+// A transformation queued by one of the k4a_transformation_*_async() functions
+typedef struct
+{
+    k4a_transformation_t transformation_handle;
+    k4a_transformation_async_type_t type;
+    k4a_image_t images[4]; // Referenced until the callback returns, unused entries are NULL
+    k4a_calibration_type_t camera;
+    k4a_transformation_interpolation_type_t interpolation_type;
+    uint32_t invalid_custom_value;
+    k4a_transformation_complete_cb_t *callback;
+    void *callback_context;
+} k4a_transformation_async_t;
+
+static void k4a_transformation_async_run(void *context)
+{
+    k4a_transformation_async_t *job = (k4a_transformation_async_t *)context;
+    k4a_result_t result = K4A_RESULT_FAILED;
+
+    switch (job->type)
+    {
+    case K4A_TRANSFORMATION_ASYNC_DEPTH_TO_COLOR:
+        result = k4a_transformation_depth_image_to_color_camera(job->transformation_handle,
+                                                                job->images[0],
+                                                                job->images[1]);
+        break;
+    case K4A_TRANSFORMATION_ASYNC_DEPTH_CUSTOM_TO_COLOR:
+        result = k4a_transformation_depth_image_to_color_camera_custom(job->transformation_handle,
+                                                                       job->images[0],
+                                                                       job->images[1],
+                                                                       job->images[2],
+                                                                       job->images[3],
+                                                                       job->interpolation_type,
+                                                                       job->invalid_custom_value);
+        break;
+    case K4A_TRANSFORMATION_ASYNC_COLOR_TO_DEPTH:
+        result = k4a_transformation_color_image_to_depth_camera(job->transformation_handle,
+                                                                job->images[0],
+                                                                job->images[1],
+                                                                job->images[2]);
+        break;
+    case K4A_TRANSFORMATION_ASYNC_POINT_CLOUD:
+        result = k4a_transformation_depth_image_to_point_cloud(job->transformation_handle,
+                                                               job->images[0],
+                                                               job->camera,
+                                                               job->images[1]);
+        break;
+    }
+
+    job->callback(result, job->callback_context);
+
+    for (size_t i = 0; i < COUNTOF(job->images); i++)
+    {
+        if (job->images[i] != NULL)
+        {
+            image_dec_ref(job->images[i]);
+        }
+    }
+    free(job);
+}
+
+// Takes the image references and queues job, which is freed here on failure
+static k4a_result_t k4a_transformation_async_submit(k4a_transformation_async_t *job)
+{
+    for (size_t i = 0; i < COUNTOF(job->images); i++)
+    {
+        if (job->images[i] != NULL)
+        {
+            image_inc_ref(job->images[i]);
+        }
+    }
+
+    k4a_result_t result = TRACE_CALL(
+        transformation_run_async(job->transformation_handle, k4a_transformation_async_run, job));
+
+    if (K4A_FAILED(result))
+    {
+        for (size_t i = 0; i < COUNTOF(job->images); i++)
+        {
+            if (job->images[i] != NULL)
+            {
+                image_dec_ref(job->images[i]);
+            }
+        }
+        free(job);
+    }
+
+    return result;
+}
+
+static k4a_transformation_async_t *k4a_transformation_async_create(k4a_transformation_t transformation_handle,
+                                                                   k4a_transformation_async_type_t type,
+                                                                   k4a_transformation_complete_cb_t *callback,
+                                                                   void *callback_context)
+{
+    k4a_transformation_async_t *job = (k4a_transformation_async_t *)calloc(1, sizeof(k4a_transformation_async_t));
+    if (job != NULL)
+    {
+        job->transformation_handle = transformation_handle;
+        job->type = type;
+        job->callback = callback;
+        job->callback_context = callback_context;
+    }
+    return job;
+}
+
+k4a_result_t k4a_transformation_depth_image_to_color_camera_async(k4a_transformation_t transformation_handle,
+                                                                  const k4a_image_t depth_image,
+                                                                  k4a_image_t transformed_depth_image,
+                                                                  k4a_transformation_complete_cb_t *callback,
+                                                                  void *callback_context)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, callback == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, depth_image == NULL || transformed_depth_image == NULL);
+
+    k4a_transformation_async_t *job = k4a_transformation_async_create(transformation_handle,
+                                                                      K4A_TRANSFORMATION_ASYNC_DEPTH_TO_COLOR,
+                                                                      callback,
+                                                                      callback_context);
+    k4a_result_t result = K4A_RESULT_FROM_BOOL(job != NULL);
+    if (K4A_SUCCEEDED(result))
+    {
+        job->images[0] = depth_image;
+        job->images[1] = transformed_depth_image;
+        result = k4a_transformation_async_submit(job);
+    }
+    return result;
+}
+
+k4a_result_t
+k4a_transformation_depth_image_to_color_camera_custom_async(k4a_transformation_t transformation_handle,
+                                                            const k4a_image_t depth_image,
+                                                            const k4a_image_t custom_image,
+                                                            k4a_image_t transformed_depth_image,
+                                                            k4a_image_t transformed_custom_image,
+                                                            k4a_transformation_interpolation_type_t interpolation_type,
+                                                            uint32_t invalid_custom_value,
+                                                            k4a_transformation_complete_cb_t *callback,
+                                                            void *callback_context)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, callback == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, depth_image == NULL || transformed_depth_image == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, custom_image == NULL || transformed_custom_image == NULL);
+
+    k4a_transformation_async_t *job = k4a_transformation_async_create(transformation_handle,
+                                                                      K4A_TRANSFORMATION_ASYNC_DEPTH_CUSTOM_TO_COLOR,
+                                                                      callback,
+                                                                      callback_context);
+    k4a_result_t result = K4A_RESULT_FROM_BOOL(job != NULL);
+    if (K4A_SUCCEEDED(result))
+    {
+        job->images[0] = depth_image;
+        job->images[1] = custom_image;
+        job->images[2] = transformed_depth_image;
+        job->images[3] = transformed_custom_image;
+        job->interpolation_type = interpolation_type;
+        job->invalid_custom_value = invalid_custom_value;
+        result = k4a_transformation_async_submit(job);
+    }
+    return result;
+}
+
+k4a_result_t k4a_transformation_color_image_to_depth_camera_async(k4a_transformation_t transformation_handle,
+                                                                  const k4a_image_t depth_image,
+                                                                  const k4a_image_t color_image,
+                                                                  k4a_image_t transformed_color_image,
+                                                                  k4a_transformation_complete_cb_t *callback,
+                                                                  void *callback_context)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, callback == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED,
+                        depth_image == NULL || color_image == NULL || transformed_color_image == NULL);
+
+    k4a_transformation_async_t *job = k4a_transformation_async_create(transformation_handle,
+                                                                      K4A_TRANSFORMATION_ASYNC_COLOR_TO_DEPTH,
+                                                                      callback,
+                                                                      callback_context);
+    k4a_result_t result = K4A_RESULT_FROM_BOOL(job != NULL);
+    if (K4A_SUCCEEDED(result))
+    {
+        job->images[0] = depth_image;
+        job->images[1] = color_image;
+        job->images[2] = transformed_color_image;
+        result = k4a_transformation_async_submit(job);
+    }
+    return result;
+}
+
+k4a_result_t k4a_transformation_depth_image_to_point_cloud_async(k4a_transformation_t transformation_handle,
+                                                                 const k4a_image_t depth_image,
+                                                                 const k4a_calibration_type_t camera,
+                                                                 k4a_image_t xyz_image,
+                                                                 k4a_transformation_complete_cb_t *callback,
+                                                                 void *callback_context)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, callback == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, depth_image == NULL || xyz_image == NULL);
+
+    k4a_transformation_async_t *job = k4a_transformation_async_create(transformation_handle,
+                                                                      K4A_TRANSFORMATION_ASYNC_POINT_CLOUD,
+                                                                      callback,
+                                                                      callback_context);
+    k4a_result_t result = K4A_RESULT_FROM_BOOL(job != NULL);
+    if (K4A_SUCCEEDED(result))
+    {
+        job->images[0] = depth_image;
+        job->images[1] = xyz_image;
+        job->camera = camera;
+        result = k4a_transformation_async_submit(job);
+    }
+    return result;
+}
+
+typedef struct _k4a_device_group_member_t
+{
+    k4a_device_t device;
+    uint32_t index;
+    groupsync_t groupsync;
+
+    // What the capture timestamps are read from and how much later than the master's color images they are taken
+    bool timestamp_from_depth;
+    int64_t timestamp_delay_usec;
+    bool master;
+    bool started;
+} k4a_device_group_member_t;
+
+typedef struct _k4a_device_group_context_t
+{
+    uint32_t device_count;
+    k4a_device_group_member_t *members;
+    groupsync_t groupsync;
+    bool started;
+} k4a_device_group_context_t;
+
+K4A_DECLARE_CONTEXT(k4a_device_group_t, k4a_device_group_context_t);
+
+k4a_result_t k4a_device_group_open(const uint32_t *device_indices,
+                                   uint32_t device_count,
+                                   k4a_device_group_t *group_handle)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, device_count == 0);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, group_handle == NULL);
+    k4a_device_group_t handle = NULL;
+
+    k4a_device_group_context_t *group = k4a_device_group_t_create(&handle);
+    k4a_result_t result = K4A_RESULT_FROM_BOOL(group != NULL);
+
+    if (K4A_SUCCEEDED(result))
+    {
+        group->members = (k4a_device_group_member_t *)calloc(device_count, sizeof(k4a_device_group_member_t));
+        result = K4A_RESULT_FROM_BOOL(group->members != NULL);
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        result = TRACE_CALL(groupsync_create(device_count, &group->groupsync));
+    }
+
+    for (uint32_t i = 0; K4A_SUCCEEDED(result) && i < device_count; i++)
+    {
+        uint32_t index = device_indices == NULL ? i : device_indices[i];
+        result = TRACE_CALL(k4a_device_open(index, &group->members[i].device));
+        group->device_count = K4A_SUCCEEDED(result) ? i + 1 : i;
+    }
+
+    // Put the master first, it is the one with only the sync out jack connected
+    for (uint32_t i = 1; K4A_SUCCEEDED(result) && i < device_count; i++)
+    {
+        bool sync_in = false;
+        bool sync_out = false;
+        if (K4A_SUCCEEDED(k4a_device_get_sync_jack(group->members[i].device, &sync_in, &sync_out)) && sync_out &&
+            !sync_in)
+        {
+            k4a_device_t master = group->members[i].device;
+            memmove(&group->members[1], &group->members[0], i * sizeof(k4a_device_group_member_t));
+            group->members[0].device = master;
+            break;
+        }
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        for (uint32_t i = 0; i < device_count; i++)
+        {
+            group->members[i].index = i;
+            group->members[i].groupsync = group->groupsync;
+        }
+        *group_handle = handle;
+    }
+    else
+    {
+        k4a_device_group_close(handle);
+    }
+
+    return result;
+}
+
+void k4a_device_group_close(k4a_device_group_t group_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, k4a_device_group_t, group_handle);
+    k4a_device_group_context_t *group = k4a_device_group_t_get_context(group_handle);
+
+    if (group->started)
+    {
+        k4a_device_group_stop_cameras(group_handle);
+    }
+
+    for (uint32_t i = 0; i < group->device_count; i++)
+    {
+        k4a_device_close(group->members[i].device);
+    }
+    if (group->groupsync)
+    {
+        groupsync_destroy(group->groupsync);
+    }
+    free(group->members);
+
+    k4a_device_group_t_destroy(group_handle);
+}
+
+uint32_t k4a_device_group_get_device_count(k4a_device_group_t group_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(0, k4a_device_group_t, group_handle);
+    k4a_device_group_context_t *group = k4a_device_group_t_get_context(group_handle);
+
+    return group->device_count;
+}
+
+k4a_device_t k4a_device_group_get_device(k4a_device_group_t group_handle, uint32_t index)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(NULL, k4a_device_group_t, group_handle);
+    k4a_device_group_context_t *group = k4a_device_group_t_get_context(group_handle);
+    RETURN_VALUE_IF_ARG(NULL, index >= group->device_count);
+
+    return group->members[index].device;
+}
+
+// Hands a capture of one device to the matcher, with its timestamp in the clock shared by the devices of the group
+static void k4a_device_group_capture_ready(k4a_capture_t capture_handle, void *context)
+{
+    k4a_device_group_member_t *member = (k4a_device_group_member_t *)context;
+
+    k4a_image_t image = NULL;
+    if (member->timestamp_from_depth)
+    {
+        image = capture_get_depth_image(capture_handle);
+        if (image == NULL)
+        {
+            image = capture_get_ir_image(capture_handle);
+        }
+    }
+    else
+    {
+        image = capture_get_color_image(capture_handle);
+    }
+    if (image == NULL)
+    {
+        return;
+    }
+
+    // The device clocks are independent, so the timestamps are compared in the clock of the system timestamps
+    uint64_t system_timestamp_nsec = 0;
+    k4a_result_t result = k4a_device_convert_device_timestamp(member->device,
+                                                              image_get_device_timestamp_usec(image),
+                                                              &system_timestamp_nsec);
+    image_dec_ref(image);
+
+    if (K4A_SUCCEEDED(result))
+    {
+        int64_t timestamp_usec = (int64_t)(system_timestamp_nsec / 1000) - member->timestamp_delay_usec;
+        groupsync_add_capture(member->groupsync, member->index, capture_handle, timestamp_usec);
+    }
+}
+
+static k4a_result_t k4a_device_group_start_member(k4a_device_group_member_t *member,
+                                                  const k4a_device_configuration_t *config)
+{
+    member->master = config->wired_sync_mode == K4A_WIRED_SYNC_MODE_MASTER;
+    member->timestamp_from_depth = config->depth_mode != K4A_DEPTH_MODE_OFF;
+    member->timestamp_delay_usec = member->timestamp_from_depth ? config->depth_delay_off_color_usec : 0;
+    if (config->wired_sync_mode == K4A_WIRED_SYNC_MODE_SUBORDINATE)
+    {
+        member->timestamp_delay_usec += config->subordinate_delay_off_master_usec;
+    }
+
+    k4a_result_t result = TRACE_CALL(
+        k4a_device_set_capture_callback(member->device, k4a_device_group_capture_ready, member));
+    if (K4A_SUCCEEDED(result))
+    {
+        result = TRACE_CALL(k4a_device_start_cameras(member->device, config));
+        member->started = K4A_SUCCEEDED(result);
+    }
+    if (K4A_FAILED(result))
+    {
+        (void)k4a_device_set_capture_callback(member->device, NULL, NULL);
+    }
+    return result;
+}
+
+k4a_result_t k4a_device_group_start_cameras(k4a_device_group_t group_handle, const k4a_device_configuration_t *configs)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_device_group_t, group_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, configs == NULL);
+    k4a_device_group_context_t *group = k4a_device_group_t_get_context(group_handle);
+    k4a_result_t result = K4A_RESULT_SUCCEEDED;
+
+    if (group->started)
+    {
+        LOG_ERROR("k4a_device_group_start_cameras called while the group is running", 0);
+        result = K4A_RESULT_FAILED;
+    }
+
+    uint32_t master_count = 0;
+    uint32_t standalone_count = 0;
+    for (uint32_t i = 0; K4A_SUCCEEDED(result) && i < group->device_count; i++)
+    {
+        master_count += configs[i].wired_sync_mode == K4A_WIRED_SYNC_MODE_MASTER ? 1 : 0;
+        standalone_count += configs[i].wired_sync_mode == K4A_WIRED_SYNC_MODE_STANDALONE ? 1 : 0;
+        if (configs[i].camera_fps != configs[0].camera_fps)
+        {
+            LOG_ERROR("All the devices of a group must use the same camera_fps, device %u uses %s instead of %s",
+                      i,
+                      k4a_fps_to_string(configs[i].camera_fps),
+                      k4a_fps_to_string(configs[0].camera_fps));
+            result = K4A_RESULT_FAILED;
+        }
+    }
+    if (K4A_SUCCEEDED(result) && (master_count > 1 || (master_count == 1 && standalone_count > 0)))
+    {
+        LOG_ERROR("A group has at most one master and the other devices are subordinates, found %u masters and %u "
+                  "standalone devices",
+                  master_count,
+                  standalone_count);
+        result = K4A_RESULT_FAILED;
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        // Captures of different devices closer than half a frame period are from the same frame
+        uint32_t tolerance_usec = HZ_TO_PERIOD_US(k4a_convert_fps_to_uint(configs[0].camera_fps)) / 2;
+        result = TRACE_CALL(groupsync_start(group->groupsync, tolerance_usec));
+        group->started = K4A_SUCCEEDED(result);
+    }
+
+    // Subordinates must be waiting for the sync signal before the master starts sending it
+    for (uint32_t i = 0; K4A_SUCCEEDED(result) && i < group->device_count; i++)
+    {
+        if (configs[i].wired_sync_mode != K4A_WIRED_SYNC_MODE_MASTER)
+        {
+            result = TRACE_CALL(k4a_device_group_start_member(&group->members[i], &configs[i]));
+        }
+    }
+    for (uint32_t i = 0; K4A_SUCCEEDED(result) && i < group->device_count; i++)
+    {
+        if (configs[i].wired_sync_mode == K4A_WIRED_SYNC_MODE_MASTER)
+        {
+            result = TRACE_CALL(k4a_device_group_start_member(&group->members[i], &configs[i]));
+        }
+    }
+
+    if (K4A_FAILED(result) && group->started)
+    {
+        k4a_device_group_stop_cameras(group_handle);
+    }
+
+    return result;
+}
+
+void k4a_device_group_stop_cameras(k4a_device_group_t group_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, k4a_device_group_t, group_handle);
+    k4a_device_group_context_t *group = k4a_device_group_t_get_context(group_handle);
+
+    // The master stops first, so the subordinates don't see a partial frame of sync pulses
+    for (uint32_t pass = 0; pass < 2; pass++)
+    {
+        for (uint32_t i = 0; i < group->device_count; i++)
+        {
+            k4a_device_group_member_t *member = &group->members[i];
+            if (member->started && (pass == 0) == member->master)
+            {
+                k4a_device_stop_cameras(member->device);
+                (void)k4a_device_set_capture_callback(member->device, NULL, NULL);
+                member->started = false;
+            }
+        }
+    }
+
+    // No capture is added once the cameras are stopped
+    groupsync_stop(group->groupsync);
+    group->started = false;
+}
+
+k4a_wait_result_t k4a_device_group_get_capture(k4a_device_group_t group_handle,
+                                               k4a_capture_t *capture_handles,
+                                               int32_t timeout_in_ms)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_WAIT_RESULT_FAILED, k4a_device_group_t, group_handle);
+    RETURN_VALUE_IF_ARG(K4A_WAIT_RESULT_FAILED, capture_handles == NULL);
+    k4a_device_group_context_t *group = k4a_device_group_t_get_context(group_handle);
+
+    return TRACE_WAIT_CALL(groupsync_get_captures(group->groupsync, capture_handles, timeout_in_ms));
+}
+
+k4a_result_t k4a_device_group_get_statistics(k4a_device_group_t group_handle,
+                                             k4a_device_group_statistics_t *statistics)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_device_group_t, group_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, statistics == NULL);
+    k4a_device_group_context_t *group = k4a_device_group_t_get_context(group_handle);
 
-    return TRACE_CALL(transformation_depth_image_to_point_cloud(transformation_handle,
-                                                                depth_image_buffer,
-                                                                &depth_image_descriptor,
-                                                                camera,
-                                                                xyz_image_buffer,
-                                                                &xyz_image_descriptor));
+    return TRACE_CALL(groupsync_get_statistics(group->groupsync, statistics));
 }
 
 #ifdef __cplusplus
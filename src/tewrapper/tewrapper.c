@@ -6,6 +6,7 @@
 
 // Dependent libraries
 #include <k4ainternal/deloader.h>
+#include <k4ainternal/threadpolicy.h>
 #include <azure_c_shared_utility/threadapi.h>
 #include <azure_c_shared_utility/condition.h>
 #include <azure_c_shared_utility/lock.h>
@@ -14,22 +15,13 @@
 #include <stdlib.h>
 #include <stdbool.h>
 
-typedef struct _tewrapper_context_t
+// A frame waiting for, or processed by, the transform engine thread
+typedef struct _tewrapper_request_context_t
 {
-    k4a_transform_engine_calibration_t *transform_engine_calibration; // Copy of transform engine calibration passed in
-                                                                      // - we do not own this memory
-    k4a_transform_engine_context_t *transform_engine;
-
-    THREAD_HANDLE thread;
-    LOCK_HANDLE main_lock;
-    COND_HANDLE main_condition;
-    LOCK_HANDLE worker_lock;
-    COND_HANDLE worker_condition;
-    volatile bool thread_started;
-    volatile bool thread_stop;
-    volatile bool worker_locked;
-    k4a_result_t thread_start_result;
-    k4a_result_t thread_processing_result;
+    struct _tewrapper_request_context_t *next; // Next request in tewrapper->request_head, written while holding lock
+    COND_HANDLE condition;                     // Posted by the transform engine thread once completed is set
+    bool completed;
+    k4a_result_t result;
 
     k4a_transform_engine_type_t type;
     const void *depth_image_data;
@@ -42,7 +34,28 @@ typedef struct _tewrapper_context_t
     size_t transformed_image2_size;
     k4a_transform_engine_interpolation_t interpolation;
     uint32_t invalid_value;
+} tewrapper_request_context_t;
+
+K4A_DECLARE_CONTEXT(tewrapper_request_t, tewrapper_request_context_t);
 
+typedef struct _tewrapper_context_t
+{
+    k4a_transform_engine_calibration_t *transform_engine_calibration; // Copy of transform engine calibration passed in
+                                                                      // - we do not own this memory
+    k4a_transform_engine_context_t *transform_engine;
+
+    THREAD_HANDLE thread;
+    LOCK_HANDLE lock;
+    COND_HANDLE main_condition;   // Posted when the transform engine thread has started
+    COND_HANDLE worker_condition; // Posted when a request is queued or the thread should stop
+    bool thread_started;
+    bool thread_stop;
+    bool thread_exited; // Set with lock held, requests are no longer accepted
+    k4a_result_t thread_start_result;
+
+    // Requests in submission order, only accessed while holding lock
+    tewrapper_request_context_t *request_head;
+    tewrapper_request_context_t *request_tail;
 } tewrapper_context_t;
 
 K4A_DECLARE_CONTEXT(tewrapper_t, tewrapper_context_t);
@@ -77,117 +90,270 @@ static void transform_engine_stop_helper(tewrapper_context_t *tewrapper)
     }
 }
 
+static k4a_result_t transform_engine_process_request(tewrapper_context_t *tewrapper,
+                                                     tewrapper_request_context_t *request)
+{
+    k4a_result_t result = K4A_RESULT_SUCCEEDED;
+
+    if (request->type == K4A_TRANSFORM_ENGINE_TYPE_DEPTH_TO_COLOR ||
+        request->type == K4A_TRANSFORM_ENGINE_TYPE_COLOR_TO_DEPTH)
+    {
+        size_t transform_engine_output_buffer_size =
+            deloader_transform_engine_get_output_frame_size(tewrapper->transform_engine, request->type);
+        if (request->transformed_image_size != transform_engine_output_buffer_size)
+        {
+            LOG_ERROR("Transform engine output buffer size not expected. Expect: %d, Actual: %d.",
+                      transform_engine_output_buffer_size,
+                      request->transformed_image_size);
+            result = K4A_RESULT_FAILED;
+        }
+    }
+    else if (request->type == K4A_TRANSFORM_ENGINE_TYPE_DEPTH_CUSTOM8_TO_COLOR ||
+             request->type == K4A_TRANSFORM_ENGINE_TYPE_DEPTH_CUSTOM16_TO_COLOR)
+    {
+        size_t transform_engine_output_buffer_size =
+            deloader_transform_engine_get_output_frame_size(tewrapper->transform_engine,
+                                                            K4A_TRANSFORM_ENGINE_TYPE_DEPTH_TO_COLOR);
+        if (request->transformed_image_size != transform_engine_output_buffer_size)
+        {
+            LOG_ERROR("Transform engine output buffer size not expected. Expect: %d, Actual: %d.",
+                      transform_engine_output_buffer_size,
+                      request->transformed_image_size);
+            result = K4A_RESULT_FAILED;
+        }
+
+        size_t transform_engine_output_buffer2_size =
+            deloader_transform_engine_get_output_frame_size(tewrapper->transform_engine, request->type);
+        if (request->transformed_image2_size != transform_engine_output_buffer2_size)
+        {
+            LOG_ERROR("Transform engine output buffer 2 size not expected. Expect: %d, Actual: %d.",
+                      transform_engine_output_buffer2_size,
+                      request->transformed_image2_size);
+            result = K4A_RESULT_FAILED;
+        }
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        k4a_depth_engine_result_code_t teresult =
+            deloader_transform_engine_process_frame(tewrapper->transform_engine,
+                                                    request->type,
+                                                    request->depth_image_data,
+                                                    request->depth_image_size,
+                                                    request->image2_data,
+                                                    request->image2_size,
+                                                    request->transformed_image_data,
+                                                    request->transformed_image_size,
+                                                    request->transformed_image2_data,
+                                                    request->transformed_image2_size,
+                                                    request->interpolation,
+                                                    request->invalid_value);
+        if (teresult == K4A_DEPTH_ENGINE_RESULT_FATAL_ERROR_WAIT_PROCESSING_COMPLETE_FAILED ||
+            teresult == K4A_DEPTH_ENGINE_RESULT_FATAL_ERROR_GPU_TIMEOUT)
+        {
+            LOG_ERROR("Timeout during depth engine process frame.", 0);
+            LOG_ERROR("SDK should be restarted since it looks like GPU has encountered an unrecoverable error.", 0);
+            result = K4A_RESULT_FAILED;
+        }
+        else if (teresult != K4A_DEPTH_ENGINE_RESULT_SUCCEEDED)
+        {
+            LOG_ERROR("Transform engine process frame failed with error code: %d.", teresult);
+            result = K4A_RESULT_FAILED;
+        }
+    }
+
+    return result;
+}
+
+// Marks request completed and wakes the thread waiting on it. The caller holds tewrapper->lock.
+static void transform_engine_complete_request(tewrapper_request_context_t *request, k4a_result_t result)
+{
+    request->result = result;
+    request->completed = true;
+    Condition_Post(request->condition);
+}
+
 static int transform_engine_thread(void *param)
 {
     tewrapper_context_t *tewrapper = (tewrapper_context_t *)param;
 
     k4a_result_t result = K4A_RESULT_SUCCEEDED;
 
+    threadpolicy_apply(K4A_SDK_THREAD_TRANSFORM_ENGINE);
+
     result = TRACE_CALL(transform_engine_start_helper(tewrapper));
 
     // The Start routine is blocked waiting for this thread to complete startup, so we signal it here and share our
     // startup status.
-    Lock(tewrapper->main_lock);
+    Lock(tewrapper->lock);
     tewrapper->thread_started = true;
     tewrapper->thread_start_result = result;
-    tewrapper->worker_locked = false;
     Condition_Post(tewrapper->main_condition);
-    Unlock(tewrapper->main_lock);
 
-    while (result != K4A_RESULT_FAILED && tewrapper->thread_stop == false)
+    while (K4A_SUCCEEDED(result) && tewrapper->thread_stop == false)
     {
-        // Waiting the main thread to request processing a frame
-        Lock(tewrapper->worker_lock);
-        tewrapper->worker_locked = true;
-        Condition_Post(tewrapper->main_condition);
-        int infinite_timeout = 0;
-        COND_RESULT cond_result = Condition_Wait(tewrapper->worker_condition, tewrapper->worker_lock, infinite_timeout);
-        result = K4A_RESULT_FROM_BOOL(cond_result == COND_OK);
+        tewrapper_request_context_t *request = tewrapper->request_head;
+        if (request == NULL)
+        {
+            // Waiting for an API thread to queue a frame
+            int infinite_timeout = 0;
+            COND_RESULT cond_result = Condition_Wait(tewrapper->worker_condition, tewrapper->lock, infinite_timeout);
+            result = K4A_RESULT_FROM_BOOL(cond_result == COND_OK);
+            continue;
+        }
+
+        tewrapper->request_head = request->next;
+        if (tewrapper->request_head == NULL)
+        {
+            tewrapper->request_tail = NULL;
+        }
+
+        // Other API threads can queue more frames while this one is processed
+        Unlock(tewrapper->lock);
+        result = transform_engine_process_request(tewrapper, request);
+        Lock(tewrapper->lock);
 
-        if (tewrapper->thread_stop == false)
+        if (K4A_FAILED(result))
         {
-            if (K4A_SUCCEEDED(result))
+            LOG_ERROR("Transform Engine thread failed to process", 0);
+        }
+        transform_engine_complete_request(request, result);
+    }
+
+    // Fail whatever is still queued, no more requests are accepted once thread_exited is set
+    tewrapper->thread_exited = true;
+    while (tewrapper->request_head != NULL)
+    {
+        tewrapper_request_context_t *request = tewrapper->request_head;
+        tewrapper->request_head = request->next;
+        transform_engine_complete_request(request, K4A_RESULT_FAILED);
+    }
+    tewrapper->request_tail = NULL;
+    Unlock(tewrapper->lock);
+
+    transform_engine_stop_helper(tewrapper);
+
+    return (int)result;
+}
+
+static void tewrapper_request_destroy(tewrapper_request_t request_handle)
+{
+    tewrapper_request_context_t *request = tewrapper_request_t_get_context(request_handle);
+
+    if (request->condition)
+    {
+        Condition_Deinit(request->condition);
+    }
+
+    tewrapper_request_t_destroy(request_handle);
+}
+
+k4a_result_t tewrapper_submit_frame(tewrapper_t tewrapper_handle,
+                                    k4a_transform_engine_type_t type,
+                                    const void *depth_image_data,
+                                    size_t depth_image_size,
+                                    const void *image2_data,
+                                    size_t image2_size,
+                                    void *transformed_image_data,
+                                    size_t transformed_image_size,
+                                    void *transformed_image2_data,
+                                    size_t transformed_image2_size,
+                                    k4a_transform_engine_interpolation_t interpolation,
+                                    uint32_t invalid_value,
+                                    tewrapper_request_t *request_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, tewrapper_t, tewrapper_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, request_handle == NULL);
+    tewrapper_context_t *tewrapper = tewrapper_t_get_context(tewrapper_handle);
+
+    *request_handle = NULL;
+    tewrapper_request_t new_request_handle = NULL;
+    tewrapper_request_context_t *request = tewrapper_request_t_create(&new_request_handle);
+    k4a_result_t result = K4A_RESULT_FROM_BOOL(request != NULL);
+
+    if (K4A_SUCCEEDED(result))
+    {
+        request->condition = Condition_Init();
+        result = K4A_RESULT_FROM_BOOL(request->condition != NULL);
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        request->type = type;
+        request->depth_image_data = depth_image_data;
+        request->depth_image_size = depth_image_size;
+        request->image2_data = image2_data;
+        request->image2_size = image2_size;
+        request->transformed_image_data = transformed_image_data;
+        request->transformed_image_size = transformed_image_size;
+        request->transformed_image2_data = transformed_image2_data;
+        request->transformed_image2_size = transformed_image2_size;
+        request->interpolation = interpolation;
+        request->invalid_value = invalid_value;
+
+        // Notify the transform engine thread to process a frame
+        Lock(tewrapper->lock);
+        result = K4A_RESULT_FROM_BOOL(!tewrapper->thread_exited && !tewrapper->thread_stop);
+        if (K4A_SUCCEEDED(result))
+        {
+            if (tewrapper->request_tail == NULL)
             {
-                if (tewrapper->type == K4A_TRANSFORM_ENGINE_TYPE_DEPTH_TO_COLOR ||
-                    tewrapper->type == K4A_TRANSFORM_ENGINE_TYPE_COLOR_TO_DEPTH)
-                {
-                    size_t transform_engine_output_buffer_size =
-                        deloader_transform_engine_get_output_frame_size(tewrapper->transform_engine, tewrapper->type);
-                    if (tewrapper->transformed_image_size != transform_engine_output_buffer_size)
-                    {
-                        LOG_ERROR("Transform engine output buffer size not expected. Expect: %d, Actual: %d.",
-                                  transform_engine_output_buffer_size,
-                                  tewrapper->transformed_image_size);
-                        result = K4A_RESULT_FAILED;
-                    }
-                }
-                else if (tewrapper->type == K4A_TRANSFORM_ENGINE_TYPE_DEPTH_CUSTOM8_TO_COLOR ||
-                         tewrapper->type == K4A_TRANSFORM_ENGINE_TYPE_DEPTH_CUSTOM16_TO_COLOR)
-                {
-                    size_t transform_engine_output_buffer_size =
-                        deloader_transform_engine_get_output_frame_size(tewrapper->transform_engine,
-                                                                        K4A_TRANSFORM_ENGINE_TYPE_DEPTH_TO_COLOR);
-                    if (tewrapper->transformed_image_size != transform_engine_output_buffer_size)
-                    {
-                        LOG_ERROR("Transform engine output buffer size not expected. Expect: %d, Actual: %d.",
-                                  transform_engine_output_buffer_size,
-                                  tewrapper->transformed_image_size);
-                        result = K4A_RESULT_FAILED;
-                    }
-
-                    size_t transform_engine_output_buffer2_size =
-                        deloader_transform_engine_get_output_frame_size(tewrapper->transform_engine, tewrapper->type);
-                    if (tewrapper->transformed_image2_size != transform_engine_output_buffer2_size)
-                    {
-                        LOG_ERROR("Transform engine output buffer 2 size not expected. Expect: %d, Actual: %d.",
-                                  transform_engine_output_buffer2_size,
-                                  tewrapper->transformed_image2_size);
-                        result = K4A_RESULT_FAILED;
-                    }
-                }
+                tewrapper->request_head = request;
             }
-
-            if (K4A_SUCCEEDED(result))
+            else
             {
-                k4a_depth_engine_result_code_t teresult =
-                    deloader_transform_engine_process_frame(tewrapper->transform_engine,
-                                                            tewrapper->type,
-                                                            tewrapper->depth_image_data,
-                                                            tewrapper->depth_image_size,
-                                                            tewrapper->image2_data,
-                                                            tewrapper->image2_size,
-                                                            tewrapper->transformed_image_data,
-                                                            tewrapper->transformed_image_size,
-                                                            tewrapper->transformed_image2_data,
-                                                            tewrapper->transformed_image2_size,
-                                                            tewrapper->interpolation,
-                                                            tewrapper->invalid_value);
-                if (teresult == K4A_DEPTH_ENGINE_RESULT_FATAL_ERROR_WAIT_PROCESSING_COMPLETE_FAILED ||
-                    teresult == K4A_DEPTH_ENGINE_RESULT_FATAL_ERROR_GPU_TIMEOUT)
-                {
-                    LOG_ERROR("Timeout during depth engine process frame.", 0);
-                    LOG_ERROR("SDK should be restarted since it looks like GPU has encountered an unrecoverable error.",
-                              0);
-                    result = K4A_RESULT_FAILED;
-                }
-                else if (teresult != K4A_DEPTH_ENGINE_RESULT_SUCCEEDED)
-                {
-                    LOG_ERROR("Transform engine process frame failed with error code: %d.", teresult);
-                    result = K4A_RESULT_FAILED;
-                }
+                tewrapper->request_tail->next = request;
             }
+            tewrapper->request_tail = request;
+            Condition_Post(tewrapper->worker_condition);
         }
+        Unlock(tewrapper->lock);
+    }
 
-        // Notify the API thread that transform engine thread completed a frame processing
-        tewrapper->thread_processing_result = result;
-        Condition_Post(tewrapper->main_condition);
-        Unlock(tewrapper->worker_lock);
-        tewrapper->worker_locked = false;
+    if (K4A_SUCCEEDED(result))
+    {
+        *request_handle = new_request_handle;
+    }
+    else if (request != NULL)
+    {
+        tewrapper_request_destroy(new_request_handle);
     }
 
-    transform_engine_stop_helper(tewrapper);
+    return result;
+}
 
-    return (int)result;
+k4a_result_t tewrapper_complete_frame(tewrapper_t tewrapper_handle, tewrapper_request_t request_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, tewrapper_t, tewrapper_handle);
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, tewrapper_request_t, request_handle);
+    tewrapper_context_t *tewrapper = tewrapper_t_get_context(tewrapper_handle);
+    tewrapper_request_context_t *request = tewrapper_request_t_get_context(request_handle);
+
+    k4a_result_t result = K4A_RESULT_SUCCEEDED;
+
+    // Waiting the transform engine thread to finish processing
+    Lock(tewrapper->lock);
+    while (K4A_SUCCEEDED(result) && !request->completed)
+    {
+        int infinite_timeout = 0;
+        COND_RESULT cond_result = Condition_Wait(request->condition, tewrapper->lock, infinite_timeout);
+        result = K4A_RESULT_FROM_BOOL(cond_result == COND_OK);
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        result = request->result;
+    }
+    bool completed = request->completed;
+    Unlock(tewrapper->lock);
+
+    // A request the thread still references can't be released
+    if (completed)
+    {
+        tewrapper_request_destroy(request_handle);
+    }
+
+    return result;
 }
 
 k4a_result_t tewrapper_process_frame(tewrapper_t tewrapper_handle,
@@ -203,54 +369,26 @@ k4a_result_t tewrapper_process_frame(tewrapper_t tewrapper_handle,
                                      k4a_transform_engine_interpolation_t interpolation,
                                      uint32_t invalid_value)
 {
-    tewrapper_context_t *tewrapper = tewrapper_t_get_context(tewrapper_handle);
-
-    k4a_result_t result = K4A_RESULT_SUCCEEDED;
-
-    Lock(tewrapper->main_lock);
-
-    // Ensure the worker thread loop to acquire the worker lock before this function acquires the worker lock to avoid
-    // dead lock
-    if (!tewrapper->worker_locked)
-    {
-        int infinite_timeout = 0;
-        COND_RESULT cond_result = Condition_Wait(tewrapper->main_condition, tewrapper->main_lock, infinite_timeout);
-        result = K4A_RESULT_FROM_BOOL(cond_result == COND_OK);
-    }
+    tewrapper_request_t request = NULL;
+    k4a_result_t result = TRACE_CALL(tewrapper_submit_frame(tewrapper_handle,
+                                                            type,
+                                                            depth_image_data,
+                                                            depth_image_size,
+                                                            image2_data,
+                                                            image2_size,
+                                                            transformed_image_data,
+                                                            transformed_image_size,
+                                                            transformed_image2_data,
+                                                            transformed_image2_size,
+                                                            interpolation,
+                                                            invalid_value,
+                                                            &request));
 
     if (K4A_SUCCEEDED(result))
     {
-        // Notify the transform engine thread to process a frame
-        Lock(tewrapper->worker_lock);
-        tewrapper->type = type;
-        tewrapper->depth_image_data = depth_image_data;
-        tewrapper->depth_image_size = depth_image_size;
-        tewrapper->image2_data = image2_data;
-        tewrapper->image2_size = image2_size;
-        tewrapper->transformed_image_data = transformed_image_data;
-        tewrapper->transformed_image_size = transformed_image_size;
-        tewrapper->transformed_image2_data = transformed_image2_data;
-        tewrapper->transformed_image2_size = transformed_image2_size;
-        tewrapper->interpolation = interpolation;
-        tewrapper->invalid_value = invalid_value;
-        Condition_Post(tewrapper->worker_condition);
-
-        // Waiting the transform engine thread to finish processing
-        int infinite_timeout = 0;
-        COND_RESULT cond_result = Condition_Wait(tewrapper->main_condition, tewrapper->worker_lock, infinite_timeout);
-        result = K4A_RESULT_FROM_BOOL(cond_result == COND_OK);
-
-        if (K4A_SUCCEEDED(result) && K4A_FAILED(tewrapper->thread_processing_result))
-        {
-            LOG_ERROR("Transform Engine thread failed to process", 0);
-            result = tewrapper->thread_processing_result;
-        }
-
-        Unlock(tewrapper->worker_lock);
+        result = TRACE_CALL(tewrapper_complete_frame(tewrapper_handle, request));
     }
 
-    Unlock(tewrapper->main_lock);
-
     return result;
 }
 
@@ -264,13 +402,8 @@ tewrapper_t tewrapper_create(k4a_transform_engine_calibration_t *transform_engin
     tewrapper->transform_engine_calibration = transform_engine_calibration;
     tewrapper->thread_start_result = K4A_RESULT_FAILED;
 
-    tewrapper->main_lock = Lock_Init();
-    k4a_result_t result = K4A_RESULT_FROM_BOOL(tewrapper->main_lock != NULL);
-    if (K4A_SUCCEEDED(result))
-    {
-        tewrapper->worker_lock = Lock_Init();
-        result = K4A_RESULT_FROM_BOOL(tewrapper->worker_lock != NULL);
-    }
+    tewrapper->lock = Lock_Init();
+    k4a_result_t result = K4A_RESULT_FROM_BOOL(tewrapper->lock != NULL);
 
     if (K4A_SUCCEEDED(result))
     {
@@ -296,14 +429,12 @@ tewrapper_t tewrapper_create(k4a_transform_engine_calibration_t *transform_engin
 
         if (K4A_SUCCEEDED(result))
         {
-            Lock(tewrapper->main_lock);
+            Lock(tewrapper->lock);
             locked = true;
-            if (!tewrapper->thread_started)
+            while (K4A_SUCCEEDED(result) && !tewrapper->thread_started)
             {
                 int infinite_timeout = 0;
-                COND_RESULT cond_result = Condition_Wait(tewrapper->main_condition,
-                                                         tewrapper->main_lock,
-                                                         infinite_timeout);
+                COND_RESULT cond_result = Condition_Wait(tewrapper->main_condition, tewrapper->lock, infinite_timeout);
                 result = K4A_RESULT_FROM_BOOL(cond_result == COND_OK);
             }
         }
@@ -316,7 +447,7 @@ tewrapper_t tewrapper_create(k4a_transform_engine_calibration_t *transform_engin
 
         if (locked)
         {
-            Unlock(tewrapper->main_lock);
+            Unlock(tewrapper->lock);
             locked = false;
         }
     }
@@ -335,16 +466,20 @@ void tewrapper_destroy(tewrapper_t tewrapper_handle)
     RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, tewrapper_t, tewrapper_handle);
     tewrapper_context_t *tewrapper = tewrapper_t_get_context(tewrapper_handle);
 
-    // Notify the transform engine thread to stop
-    Lock(tewrapper->worker_lock);
-    tewrapper->thread_stop = true;
-    Condition_Post(tewrapper->worker_condition);
-    Unlock(tewrapper->worker_lock);
-
-    Lock(tewrapper->main_lock);
-    THREAD_HANDLE thread = tewrapper->thread;
-    tewrapper->thread = NULL;
-    Unlock(tewrapper->main_lock);
+    // Notify the transform engine thread to stop, it fails any requests still queued
+    THREAD_HANDLE thread = NULL;
+    if (tewrapper->lock)
+    {
+        Lock(tewrapper->lock);
+        tewrapper->thread_stop = true;
+        if (tewrapper->worker_condition)
+        {
+            Condition_Post(tewrapper->worker_condition);
+        }
+        thread = tewrapper->thread;
+        tewrapper->thread = NULL;
+        Unlock(tewrapper->lock);
+    }
 
     if (thread)
     {
@@ -363,14 +498,9 @@ void tewrapper_destroy(tewrapper_t tewrapper_handle)
         Condition_Deinit(tewrapper->worker_condition);
     }
 
-    if (tewrapper->main_lock)
-    {
-        Lock_Deinit(tewrapper->main_lock);
-    }
-
-    if (tewrapper->worker_lock)
+    if (tewrapper->lock)
     {
-        Lock_Deinit(tewrapper->worker_lock);
+        Lock_Deinit(tewrapper->lock);
     }
 
     tewrapper_t_destroy(tewrapper_handle);
@@ -0,0 +1,96 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// This library
+#include <k4ainternal/threadpolicy.h>
+
+// Dependent libraries
+#include <k4ainternal/common.h>
+#include <k4ainternal/global.h>
+#include <k4ainternal/logging.h>
+#include <k4ainternal/rwlock.h>
+
+// System dependencies
+#include <string.h>
+
+// Policies configured for the process, shared by every device
+typedef struct
+{
+    k4a_rwlock_t lock;
+
+    // Access to the policies may only occur while holding lock
+    k4a_thread_policy_t policy[K4A_SDK_THREAD_COUNT];
+} threadpolicy_global_t;
+
+static void threadpolicy_global_init(threadpolicy_global_t *g_threadpolicy)
+{
+    rwlock_init(&g_threadpolicy->lock);
+}
+
+K4A_DECLARE_GLOBAL(threadpolicy_global_t, threadpolicy_global_init);
+
+static const char *threadpolicy_thread_name(k4a_sdk_thread_t thread)
+{
+    switch (thread)
+    {
+    case K4A_SDK_THREAD_DEPTH_USB:
+        return "depth usb";
+    case K4A_SDK_THREAD_IMU_USB:
+        return "imu usb";
+    case K4A_SDK_THREAD_DEPTH_ENGINE:
+        return "depth engine";
+    case K4A_SDK_THREAD_TRANSFORM_ENGINE:
+        return "transform engine";
+    case K4A_SDK_THREAD_COLOR_READER:
+        return "color reader";
+    case K4A_SDK_THREAD_RECORD_WRITER:
+        return "record writer";
+    case K4A_SDK_THREAD_TRANSFORMATION:
+        return "transformation";
+    case K4A_SDK_THREAD_POOL:
+        return "thread pool";
+    default:
+        return "unknown";
+    }
+}
+
+k4a_result_t threadpolicy_set(k4a_sdk_thread_t thread, const k4a_thread_policy_t *policy)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, thread < K4A_SDK_THREAD_DEPTH_USB || thread >= K4A_SDK_THREAD_COUNT);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, policy == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED,
+                        policy->priority < K4A_THREAD_PRIORITY_DEFAULT ||
+                            policy->priority > K4A_THREAD_PRIORITY_REALTIME);
+
+    threadpolicy_global_t *g_threadpolicy = threadpolicy_global_t_get();
+
+    rwlock_acquire_write(&g_threadpolicy->lock);
+    g_threadpolicy->policy[thread] = *policy;
+    rwlock_release_write(&g_threadpolicy->lock);
+
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t threadpolicy_get(k4a_sdk_thread_t thread, k4a_thread_policy_t *policy)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, thread < K4A_SDK_THREAD_DEPTH_USB || thread >= K4A_SDK_THREAD_COUNT);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, policy == NULL);
+
+    threadpolicy_global_t *g_threadpolicy = threadpolicy_global_t_get();
+
+    rwlock_acquire_read(&g_threadpolicy->lock);
+    *policy = g_threadpolicy->policy[thread];
+    rwlock_release_read(&g_threadpolicy->lock);
+
+    return K4A_RESULT_SUCCEEDED;
+}
+
+void threadpolicy_apply(k4a_sdk_thread_t thread)
+{
+    k4a_thread_policy_t policy = { 0 };
+
+    if (K4A_SUCCEEDED(threadpolicy_get(thread, &policy)))
+    {
+        (void)threadpolicy_apply_to_current_thread(threadpolicy_thread_name(thread), &policy);
+    }
+}
@@ -0,0 +1,94 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// pthread_setaffinity_np and CPU_SET are GNU extensions
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+// This library
+#include <k4ainternal/threadpolicy.h>
+
+// Dependent libraries
+#include <k4ainternal/common.h>
+#include <k4ainternal/logging.h>
+
+// System dependencies
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Nice values used for the priorities within the normal scheduling class
+#define THREADPOLICY_NICE_ABOVE_NORMAL (-5)
+#define THREADPOLICY_NICE_HIGHEST (-10)
+
+k4a_result_t threadpolicy_apply_to_current_thread(const char *name, const k4a_thread_policy_t *policy)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, name == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, policy == NULL);
+
+    k4a_result_t result = K4A_RESULT_SUCCEEDED;
+    int err;
+
+    if (policy->cpu_affinity_mask != 0)
+    {
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        for (int cpu = 0; cpu < 64; cpu++)
+        {
+            if (policy->cpu_affinity_mask & (1ULL << cpu))
+            {
+                CPU_SET(cpu, &cpu_set);
+            }
+        }
+
+        if ((err = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set)) != 0)
+        {
+            LOG_WARNING("Failed to set CPU affinity 0x%llx on %s thread: %s",
+                        (unsigned long long)policy->cpu_affinity_mask,
+                        name,
+                        strerror(err));
+            result = K4A_RESULT_FAILED;
+        }
+    }
+
+    if (policy->priority == K4A_THREAD_PRIORITY_REALTIME)
+    {
+        struct sched_param param = { 0 };
+        int min_priority = sched_get_priority_min(SCHED_FIFO);
+        int max_priority = sched_get_priority_max(SCHED_FIFO);
+
+        // Middle of the range leaves room above for kernel and system real-time threads
+        param.sched_priority = min_priority + (max_priority - min_priority) / 2;
+        if ((err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param)) != 0)
+        {
+            LOG_WARNING("Failed to set real-time priority on %s thread: %s", name, strerror(err));
+            result = K4A_RESULT_FAILED;
+        }
+    }
+    else if (policy->priority != K4A_THREAD_PRIORITY_DEFAULT)
+    {
+        // On Linux the nice value of a thread id only affects that thread
+        int nice_value = policy->priority == K4A_THREAD_PRIORITY_HIGHEST ? THREADPOLICY_NICE_HIGHEST :
+                                                                           THREADPOLICY_NICE_ABOVE_NORMAL;
+        if (setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), nice_value) != 0)
+        {
+            LOG_WARNING("Failed to set priority on %s thread: %s", name, strerror(errno));
+            result = K4A_RESULT_FAILED;
+        }
+    }
+
+    if (K4A_SUCCEEDED(result) && (policy->cpu_affinity_mask != 0 || policy->priority != K4A_THREAD_PRIORITY_DEFAULT))
+    {
+        LOG_INFO("Applied CPU affinity 0x%llx and priority %d to %s thread",
+                 (unsigned long long)policy->cpu_affinity_mask,
+                 policy->priority,
+                 name);
+    }
+
+    return result;
+}
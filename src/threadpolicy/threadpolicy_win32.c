@@ -0,0 +1,64 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// This library
+#include <k4ainternal/threadpolicy.h>
+
+// Dependent libraries
+#include <k4ainternal/common.h>
+#include <k4ainternal/logging.h>
+
+// System dependencies
+#include <windows.h>
+
+k4a_result_t threadpolicy_apply_to_current_thread(const char *name, const k4a_thread_policy_t *policy)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, name == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, policy == NULL);
+
+    k4a_result_t result = K4A_RESULT_SUCCEEDED;
+
+    if (policy->cpu_affinity_mask != 0)
+    {
+        if (SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)policy->cpu_affinity_mask) == 0)
+        {
+            LOG_WARNING("Failed to set CPU affinity 0x%llx on %s thread: %d",
+                        (unsigned long long)policy->cpu_affinity_mask,
+                        name,
+                        GetLastError());
+            result = K4A_RESULT_FAILED;
+        }
+    }
+
+    if (policy->priority != K4A_THREAD_PRIORITY_DEFAULT)
+    {
+        int priority = THREAD_PRIORITY_ABOVE_NORMAL;
+        switch (policy->priority)
+        {
+        case K4A_THREAD_PRIORITY_HIGHEST:
+            priority = THREAD_PRIORITY_HIGHEST;
+            break;
+        case K4A_THREAD_PRIORITY_REALTIME:
+            priority = THREAD_PRIORITY_TIME_CRITICAL;
+            break;
+        default:
+            break;
+        }
+
+        if (!SetThreadPriority(GetCurrentThread(), priority))
+        {
+            LOG_WARNING("Failed to set priority on %s thread: %d", name, GetLastError());
+            result = K4A_RESULT_FAILED;
+        }
+    }
+
+    if (K4A_SUCCEEDED(result) && (policy->cpu_affinity_mask != 0 || policy->priority != K4A_THREAD_PRIORITY_DEFAULT))
+    {
+        LOG_INFO("Applied CPU affinity 0x%llx and priority %d to %s thread",
+                 (unsigned long long)policy->cpu_affinity_mask,
+                 policy->priority,
+                 name);
+    }
+
+    return result;
+}
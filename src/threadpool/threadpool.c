@@ -0,0 +1,490 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// This library
+#include <k4ainternal/threadpool.h>
+
+// Dependent libraries
+#include <k4ainternal/atomic.h>
+#include <k4ainternal/common.h>
+#include <k4ainternal/global.h>
+#include <k4ainternal/logging.h>
+#include <k4ainternal/threadpolicy.h>
+#include <azure_c_shared_utility/condition.h>
+#include <azure_c_shared_utility/lock.h>
+#include <azure_c_shared_utility/threadapi.h>
+
+// System dependencies
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+// Tasks each worker can hold, submitting runs the task on the calling thread once every queue is full
+#define THREADPOOL_QUEUE_SIZE 256
+
+typedef struct
+{
+    k4a_thread_pool_task_t *fn;
+    void *context;
+} threadpool_task_t;
+
+typedef struct _threadpool_global_t threadpool_global_t;
+
+// A worker thread and the deque of tasks submitted to it. The worker takes its newest task, idle workers steal the
+// oldest.
+typedef struct
+{
+    threadpool_global_t *pool;
+    uint32_t index;
+    THREAD_HANDLE thread;
+
+    LOCK_HANDLE lock;
+
+    // Access to the deque may only occur while holding lock
+    threadpool_task_t tasks[THREADPOOL_QUEUE_SIZE];
+    uint32_t head;
+    uint32_t count;
+} threadpool_worker_t;
+
+struct _threadpool_global_t
+{
+    // Serializes threadpool_set_options so only one caller stops and restarts the workers
+    LOCK_HANDLE options_lock;
+
+    LOCK_HANDLE lock;
+    COND_HANDLE condition; // Posted when a task is queued or the workers are stopped
+
+    // Access to the following may only occur while holding lock
+    k4a_thread_pool_options_t options;
+    threadpool_worker_t *workers; // Only freed once every worker has exited
+    uint32_t worker_count;
+    bool started;
+    bool stop;
+
+    volatile uint32_t pending;     // Tasks queued on any worker
+    volatile uint32_t next_worker; // Round robin start of the search for a queue with space
+};
+
+static void threadpool_global_init(threadpool_global_t *g_threadpool)
+{
+    g_threadpool->options_lock = Lock_Init();
+    g_threadpool->lock = Lock_Init();
+    g_threadpool->condition = Condition_Init();
+}
+
+K4A_DECLARE_GLOBAL(threadpool_global_t, threadpool_global_init);
+
+static uint32_t threadpool_get_cpu_count(void)
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    long count = (long)info.dwNumberOfProcessors;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    return count < 1 ? 1 : (uint32_t)MIN(count, THREADPOOL_MAX_THREAD_COUNT);
+}
+
+static bool threadpool_worker_push(threadpool_worker_t *worker, const threadpool_task_t *task)
+{
+    bool pushed = false;
+    Lock(worker->lock);
+    if (worker->count < THREADPOOL_QUEUE_SIZE)
+    {
+        worker->tasks[(worker->head + worker->count) % THREADPOOL_QUEUE_SIZE] = *task;
+        worker->count++;
+        pushed = true;
+    }
+    Unlock(worker->lock);
+    return pushed;
+}
+
+// Takes the newest task of a worker, or the oldest when stealing
+static bool threadpool_worker_pop(threadpool_worker_t *worker, bool steal, threadpool_task_t *task)
+{
+    bool popped = false;
+    Lock(worker->lock);
+    if (worker->count > 0)
+    {
+        if (steal)
+        {
+            *task = worker->tasks[worker->head];
+            worker->head = (worker->head + 1) % THREADPOOL_QUEUE_SIZE;
+        }
+        else
+        {
+            *task = worker->tasks[(worker->head + worker->count - 1) % THREADPOOL_QUEUE_SIZE];
+        }
+        worker->count--;
+        popped = true;
+    }
+    Unlock(worker->lock);
+
+    if (popped)
+    {
+        k4a_atomic_add(&worker->pool->pending, (uint32_t)-1);
+    }
+    return popped;
+}
+
+// Takes a task from the worker first, then from the others starting after it
+static bool threadpool_take_task(threadpool_global_t *g_threadpool,
+                                 threadpool_worker_t *workers,
+                                 uint32_t worker_count,
+                                 uint32_t first,
+                                 threadpool_task_t *task)
+{
+    if (k4a_atomic_load(&g_threadpool->pending) == 0)
+    {
+        return false;
+    }
+    for (uint32_t i = 0; i < worker_count; i++)
+    {
+        if (threadpool_worker_pop(&workers[(first + i) % worker_count], i != 0, task))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static int threadpool_worker_thread(void *param)
+{
+    threadpool_worker_t *worker = (threadpool_worker_t *)param;
+    threadpool_global_t *g_threadpool = worker->pool;
+
+    threadpolicy_apply(K4A_SDK_THREAD_POOL);
+
+    // The workers array and count don't change while a worker runs
+    Lock(g_threadpool->lock);
+    threadpool_worker_t *workers = g_threadpool->workers;
+    uint32_t worker_count = g_threadpool->worker_count;
+    Unlock(g_threadpool->lock);
+
+    while (true)
+    {
+        threadpool_task_t task;
+        if (threadpool_take_task(g_threadpool, workers, worker_count, worker->index, &task))
+        {
+            task.fn(task.context);
+            continue;
+        }
+
+        // Queued tasks are drained before a stop is honored
+        Lock(g_threadpool->lock);
+        bool idle = k4a_atomic_load(&g_threadpool->pending) == 0;
+        bool stop = g_threadpool->stop && idle;
+        if (idle && !stop)
+        {
+            int infinite_timeout = 0;
+            (void)Condition_Wait(g_threadpool->condition, g_threadpool->lock, infinite_timeout);
+        }
+        Unlock(g_threadpool->lock);
+
+        if (stop)
+        {
+            break;
+        }
+    }
+
+    return 0;
+}
+
+// Starts the workers, called with lock held
+static void threadpool_start(threadpool_global_t *g_threadpool)
+{
+    g_threadpool->started = true;
+    if (g_threadpool->options.executor != NULL)
+    {
+        return;
+    }
+
+    uint32_t thread_count = g_threadpool->options.thread_count;
+    if (thread_count == 0)
+    {
+        thread_count = threadpool_get_cpu_count();
+    }
+
+    g_threadpool->workers = (threadpool_worker_t *)calloc(thread_count, sizeof(threadpool_worker_t));
+    if (g_threadpool->workers == NULL)
+    {
+        LOG_ERROR("Failed to allocate %u thread pool workers, tasks run on the submitting threads", thread_count);
+        return;
+    }
+
+    // A worker reads the count once it starts, after lock is released
+    uint32_t started = 0;
+    for (uint32_t i = 0; i < thread_count; i++)
+    {
+        threadpool_worker_t *worker = &g_threadpool->workers[started];
+        worker->pool = g_threadpool;
+        worker->index = started;
+        worker->lock = Lock_Init();
+        if (worker->lock == NULL)
+        {
+            break;
+        }
+        if (ThreadAPI_Create(&worker->thread, threadpool_worker_thread, worker) != THREADAPI_OK)
+        {
+            Lock_Deinit(worker->lock);
+            worker->lock = NULL;
+            break;
+        }
+        started++;
+    }
+
+    if (started != thread_count)
+    {
+        LOG_WARNING("Started %u of %u thread pool workers", started, thread_count);
+    }
+    g_threadpool->worker_count = started;
+}
+
+k4a_result_t threadpool_set_options(const k4a_thread_pool_options_t *options)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, options == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, options->thread_count > THREADPOOL_MAX_THREAD_COUNT);
+
+    threadpool_global_t *g_threadpool = threadpool_global_t_get();
+
+    Lock(g_threadpool->options_lock);
+
+    // Stop the workers, tasks submitted meanwhile run on their submitting threads
+    Lock(g_threadpool->lock);
+    threadpool_worker_t *workers = g_threadpool->workers;
+    uint32_t worker_count = g_threadpool->worker_count;
+    g_threadpool->stop = true;
+    for (uint32_t i = 0; i < worker_count; i++)
+    {
+        Condition_Post(g_threadpool->condition);
+    }
+    Unlock(g_threadpool->lock);
+
+    for (uint32_t i = 0; i < worker_count; i++)
+    {
+        int thread_result;
+        (void)ThreadAPI_Join(workers[i].thread, &thread_result);
+        Lock_Deinit(workers[i].lock);
+    }
+    free(workers);
+
+    Lock(g_threadpool->lock);
+    g_threadpool->workers = NULL;
+    g_threadpool->worker_count = 0;
+    g_threadpool->started = false;
+    g_threadpool->stop = false;
+    g_threadpool->options = *options;
+    Unlock(g_threadpool->lock);
+
+    Unlock(g_threadpool->options_lock);
+
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t threadpool_get_options(k4a_thread_pool_options_t *options)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, options == NULL);
+
+    threadpool_global_t *g_threadpool = threadpool_global_t_get();
+
+    Lock(g_threadpool->lock);
+    *options = g_threadpool->options;
+    Unlock(g_threadpool->lock);
+
+    return K4A_RESULT_SUCCEEDED;
+}
+
+void threadpool_submit(k4a_thread_pool_task_t *task, void *task_context)
+{
+    threadpool_global_t *g_threadpool = threadpool_global_t_get();
+    threadpool_task_t entry = { task, task_context };
+    bool queued = false;
+    k4a_thread_pool_executor_t *executor = NULL;
+    void *executor_context = NULL;
+
+    Lock(g_threadpool->lock);
+    if (!g_threadpool->stop)
+    {
+        if (!g_threadpool->started)
+        {
+            threadpool_start(g_threadpool);
+        }
+        executor = g_threadpool->options.executor;
+        executor_context = g_threadpool->options.executor_context;
+
+        // Counted before it is queued so that a worker taking it never sees the count go below zero
+        uint32_t worker_count = executor == NULL ? g_threadpool->worker_count : 0;
+        uint32_t first = k4a_atomic_load(&g_threadpool->next_worker);
+        k4a_atomic_add(&g_threadpool->next_worker, 1);
+        k4a_atomic_add(&g_threadpool->pending, 1);
+        for (uint32_t i = 0; i < worker_count && !queued; i++)
+        {
+            queued = threadpool_worker_push(&g_threadpool->workers[(first + i) % worker_count], &entry);
+        }
+        if (queued)
+        {
+            Condition_Post(g_threadpool->condition);
+        }
+        else
+        {
+            k4a_atomic_add(&g_threadpool->pending, (uint32_t)-1);
+        }
+    }
+    Unlock(g_threadpool->lock);
+
+    if (executor != NULL)
+    {
+        executor(task, task_context, executor_context);
+    }
+    else if (!queued)
+    {
+        task(task_context);
+    }
+}
+
+// Runs one queued task on the calling thread, false when none is queued
+static bool threadpool_run_queued_task(void)
+{
+    threadpool_global_t *g_threadpool = threadpool_global_t_get();
+    threadpool_task_t task;
+
+    Lock(g_threadpool->lock);
+    threadpool_worker_t *workers = g_threadpool->workers;
+    uint32_t worker_count = g_threadpool->worker_count;
+    uint32_t first = k4a_atomic_load(&g_threadpool->next_worker);
+
+    // Stealing under lock keeps threadpool_set_options from freeing the workers meanwhile
+    bool taken = worker_count > 0 && threadpool_take_task(g_threadpool, workers, worker_count, first, &task);
+    Unlock(g_threadpool->lock);
+
+    if (taken)
+    {
+        task.fn(task.context);
+    }
+    return taken;
+}
+
+typedef struct
+{
+    threadpool_for_fn_t *fn;
+    void *context;
+    uint32_t count;
+    volatile uint32_t next; // Next index to call fn for
+
+    LOCK_HANDLE lock;
+    COND_HANDLE condition; // Posted when the last helper returns
+
+    // Access to helpers may only occur while holding lock
+    uint32_t helpers; // Submitted helper tasks that have not returned
+} threadpool_for_t;
+
+static void threadpool_for_run(threadpool_for_t *job)
+{
+    while (true)
+    {
+        uint32_t index = k4a_atomic_load(&job->next);
+        if (index >= job->count)
+        {
+            break;
+        }
+        if (k4a_atomic_cas(&job->next, index, index + 1))
+        {
+            job->fn(job->context, index);
+        }
+    }
+}
+
+static void threadpool_for_helper(void *task_context)
+{
+    threadpool_for_t *job = (threadpool_for_t *)task_context;
+    threadpool_for_run(job);
+
+    Lock(job->lock);
+    job->helpers--;
+    if (job->helpers == 0)
+    {
+        Condition_Post(job->condition);
+    }
+    Unlock(job->lock);
+}
+
+void threadpool_parallel_for(threadpool_for_fn_t *fn, void *context, uint32_t count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    threadpool_for_t job = { 0 };
+    job.fn = fn;
+    job.context = context;
+    job.count = count;
+
+    // The calling thread takes part, so one index needs no helpers and a failed setup just runs every index here
+    uint32_t helpers = count - 1;
+    if (helpers > 0)
+    {
+        job.lock = Lock_Init();
+        job.condition = Condition_Init();
+        if (job.lock == NULL || job.condition == NULL)
+        {
+            helpers = 0;
+        }
+    }
+
+    if (helpers > 0)
+    {
+        threadpool_global_t *g_threadpool = threadpool_global_t_get();
+        Lock(g_threadpool->lock);
+        uint32_t worker_count = g_threadpool->options.executor != NULL ? THREADPOOL_MAX_THREAD_COUNT :
+                                                                         g_threadpool->worker_count;
+        if (!g_threadpool->started)
+        {
+            worker_count = g_threadpool->options.thread_count == 0 ? threadpool_get_cpu_count() :
+                                                                     g_threadpool->options.thread_count;
+        }
+        Unlock(g_threadpool->lock);
+        helpers = MIN(helpers, worker_count);
+
+        job.helpers = helpers;
+        for (uint32_t i = 0; i < helpers; i++)
+        {
+            threadpool_submit(threadpool_for_helper, &job);
+        }
+    }
+
+    threadpool_for_run(&job);
+
+    if (helpers > 0)
+    {
+        // Help with queued tasks, which may be this job's helpers, until every helper has returned
+        Lock(job.lock);
+        while (job.helpers > 0)
+        {
+            Unlock(job.lock);
+            bool ran = threadpool_run_queued_task();
+            Lock(job.lock);
+            if (!ran && job.helpers > 0)
+            {
+                // Nothing is queued, so the remaining helpers are running on other threads
+                int infinite_timeout = 0;
+                (void)Condition_Wait(job.condition, job.lock, infinite_timeout);
+            }
+        }
+        Unlock(job.lock);
+    }
+
+    if (job.condition != NULL)
+    {
+        Condition_Deinit(job.condition);
+    }
+    if (job.lock != NULL)
+    {
+        Lock_Deinit(job.lock);
+    }
+}
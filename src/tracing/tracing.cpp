@@ -0,0 +1,249 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// This library
+#include <k4ainternal/tracing.h>
+
+// Dependent libraries
+#include <k4ainternal/logging.h>
+
+// System dependencies
+#include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <new>
+#include <vector>
+
+// Events each thread can record in one trace, 32 bytes each
+#define TRACING_BUFFER_EVENTS (32 * 1024)
+
+volatile int32_t g_tracing_enabled = 0;
+
+typedef struct
+{
+    uint64_t timestamp_nsec;
+    const char *name;
+    uint64_t frame;
+    uint32_t thread_id;
+    char phase;
+} tracing_event_t;
+
+// Written only by the thread that holds the buffer. The exporter reads events below count once the buffer's generation
+// matches the trace being exported.
+typedef struct
+{
+    std::atomic<uint32_t> generation;
+    std::atomic<uint32_t> count;
+    std::atomic<uint32_t> dropped_count;
+    bool in_use; // Protected by tracing_registry_t::lock
+    tracing_event_t events[TRACING_BUFFER_EVENTS];
+} tracing_buffer_t;
+
+// Buffers are handed back when their thread exits and reused by later threads, so SDK threads that come and go with
+// each stream start don't allocate a new buffer every time. They are never freed.
+typedef struct
+{
+    std::mutex lock;
+    std::vector<tracing_buffer_t *> buffers;
+} tracing_registry_t;
+
+// Serializes tracing_start() and tracing_stop()
+static std::mutex g_tracing_control_lock;
+static std::atomic<uint32_t> g_tracing_generation(0);
+static std::atomic<uint64_t> g_tracing_start_nsec(0);
+static std::atomic<uint32_t> g_tracing_next_thread_id(1);
+
+static tracing_registry_t *tracing_registry()
+{
+    // Leaked on purpose, threads may still record while static destructors run
+    static tracing_registry_t *registry = new tracing_registry_t();
+    return registry;
+}
+
+static uint64_t tracing_get_time_nsec()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+class tracing_thread_state_t
+{
+public:
+    tracing_buffer_t *buffer = nullptr;
+    uint32_t thread_id = 0;
+
+    ~tracing_thread_state_t()
+    {
+        if (buffer != nullptr)
+        {
+            tracing_registry_t *registry = tracing_registry();
+            std::lock_guard<std::mutex> lock(registry->lock);
+            buffer->in_use = false;
+        }
+    }
+};
+
+static thread_local tracing_thread_state_t t_tracing_state;
+
+static tracing_buffer_t *tracing_acquire_buffer()
+{
+    tracing_registry_t *registry = tracing_registry();
+    std::lock_guard<std::mutex> lock(registry->lock);
+
+    for (tracing_buffer_t *buffer : registry->buffers)
+    {
+        if (!buffer->in_use)
+        {
+            buffer->in_use = true;
+            return buffer;
+        }
+    }
+
+    tracing_buffer_t *buffer = new (std::nothrow) tracing_buffer_t();
+    if (buffer != nullptr)
+    {
+        buffer->in_use = true;
+        registry->buffers.push_back(buffer);
+    }
+    return buffer;
+}
+
+void tracing_record(trace_phase_t phase, const char *name, uint64_t frame)
+{
+    tracing_thread_state_t &state = t_tracing_state;
+    if (state.buffer == nullptr)
+    {
+        state.buffer = tracing_acquire_buffer();
+        state.thread_id = g_tracing_next_thread_id.fetch_add(1, std::memory_order_relaxed);
+        if (state.buffer == nullptr)
+        {
+            return;
+        }
+    }
+
+    // The first event of a new trace discards this buffer's events from the previous one
+    tracing_buffer_t *buffer = state.buffer;
+    uint32_t generation = g_tracing_generation.load(std::memory_order_acquire);
+    if (buffer->generation.load(std::memory_order_relaxed) != generation)
+    {
+        buffer->count.store(0, std::memory_order_relaxed);
+        buffer->dropped_count.store(0, std::memory_order_relaxed);
+        buffer->generation.store(generation, std::memory_order_release);
+    }
+
+    uint32_t index = buffer->count.load(std::memory_order_relaxed);
+    if (index >= TRACING_BUFFER_EVENTS)
+    {
+        buffer->dropped_count.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    tracing_event_t *event = &buffer->events[index];
+    event->timestamp_nsec = tracing_get_time_nsec();
+    event->name = name;
+    event->frame = frame;
+    event->thread_id = state.thread_id;
+    event->phase = (char)phase;
+    buffer->count.store(index + 1, std::memory_order_release);
+}
+
+static void tracing_set_enabled(bool enabled)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __atomic_store_n(&g_tracing_enabled, enabled ? 1 : 0, __ATOMIC_RELAXED);
+#else
+    g_tracing_enabled = enabled ? 1 : 0;
+#endif
+}
+
+k4a_result_t tracing_start(void)
+{
+    std::lock_guard<std::mutex> lock(g_tracing_control_lock);
+
+    g_tracing_start_nsec.store(tracing_get_time_nsec(), std::memory_order_relaxed);
+    g_tracing_generation.fetch_add(1, std::memory_order_release);
+    tracing_set_enabled(true);
+    return K4A_RESULT_SUCCEEDED;
+}
+
+static bool tracing_write_chrome_trace(const char *path,
+                                       const std::vector<tracing_event_t> &events,
+                                       uint64_t start_nsec,
+                                       uint32_t dropped_count)
+{
+    FILE *file = fopen(path, "w");
+    if (file == NULL)
+    {
+        LOG_ERROR("Failed to create the trace file %s.", path);
+        return false;
+    }
+
+    bool written = fprintf(file,
+                           "{\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped_events\":%u},\"traceEvents\":[",
+                           dropped_count) > 0;
+    for (size_t i = 0; i < events.size() && written; i++)
+    {
+        const tracing_event_t &event = events[i];
+        double timestamp_usec = (double)(int64_t)(event.timestamp_nsec - start_nsec) / 1000.0;
+        written = fprintf(file,
+                          "%s\n{\"name\":\"%s\",\"cat\":\"k4a\",\"ph\":\"%c\",%s\"ts\":%.3f,\"pid\":1,\"tid\":%u,"
+                          "\"args\":{\"frame\":%llu}}",
+                          i == 0 ? "" : ",",
+                          event.name,
+                          event.phase,
+                          event.phase == TRACE_PHASE_INSTANT ? "\"s\":\"t\"," : "",
+                          timestamp_usec,
+                          event.thread_id,
+                          (unsigned long long)event.frame) > 0;
+    }
+    written = written && fprintf(file, "\n]}\n") > 0;
+    written = fclose(file) == 0 && written;
+
+    if (!written)
+    {
+        LOG_ERROR("Failed to write the trace file %s.", path);
+    }
+    return written;
+}
+
+k4a_result_t tracing_stop(const char *path)
+{
+    std::lock_guard<std::mutex> lock(g_tracing_control_lock);
+    tracing_set_enabled(false);
+
+    if (path == NULL)
+    {
+        return K4A_RESULT_SUCCEEDED;
+    }
+
+    // Copy the events out so the file is written without holding the registry lock. A thread that saw tracing enabled
+    // just before it was disabled may still be recording, only the events it completed are exported.
+    std::vector<tracing_event_t> events;
+    uint32_t dropped_count = 0;
+    uint32_t generation = g_tracing_generation.load(std::memory_order_relaxed);
+    {
+        tracing_registry_t *registry = tracing_registry();
+        std::lock_guard<std::mutex> registry_lock(registry->lock);
+        for (tracing_buffer_t *buffer : registry->buffers)
+        {
+            if (buffer->generation.load(std::memory_order_acquire) != generation)
+            {
+                continue;
+            }
+            uint32_t count = buffer->count.load(std::memory_order_acquire);
+            events.insert(events.end(), buffer->events, buffer->events + count);
+            dropped_count += buffer->dropped_count.load(std::memory_order_relaxed);
+        }
+    }
+
+    if (dropped_count != 0)
+    {
+        LOG_WARNING("%u trace events were dropped, the trace buffers were full.", dropped_count);
+    }
+
+    bool written =
+        tracing_write_chrome_trace(path, events, g_tracing_start_nsec.load(std::memory_order_relaxed), dropped_count);
+    return written ? K4A_RESULT_SUCCEEDED : K4A_RESULT_FAILED;
+}
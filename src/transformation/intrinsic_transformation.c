@@ -11,11 +11,36 @@
 // calibration. So we fire the warning 1 time instead of every time a transformation call is made
 static int g_deprecated_6kt_message_fired = false;
 
-static k4a_result_t transformation_project_internal(const k4a_calibration_camera_t *camera_calibration,
-                                                    const float xy[2],
-                                                    float uv[2],
-                                                    int *valid,
-                                                    float J_xy[2 * 2])
+#if defined(__amd64__) || defined(_M_AMD64) || defined(__i386__) || defined(_M_IX86)
+#define K4A_USING_SSE
+#include <smmintrin.h> // SSE4.1
+#endif
+
+// Camera intrinsics read and validated once for any number of points
+typedef struct _transformation_intrinsics_t
+{
+    float cx;
+    float cy;
+    float fx;
+    float fy;
+    float k1;
+    float k2;
+    float k3;
+    float k4;
+    float k5;
+    float k6;
+    float codx; // center of distortion is set to 0 for Brown Conrady model
+    float cody;
+    float p1;
+    float p2;
+    float max_radius_for_projection;
+    // the only difference from Rational6ktCameraModel is 2 multiplier for the tangential coefficient term xyp*p1 and
+    // xyp*p2
+    float tangential_scale;
+} transformation_intrinsics_t;
+
+static k4a_result_t transformation_get_intrinsics(const k4a_calibration_camera_t *camera_calibration,
+                                                  transformation_intrinsics_t *intrinsics)
 {
     if (K4A_FAILED(K4A_RESULT_FROM_BOOL(
             (camera_calibration->intrinsics.type == K4A_CALIBRATION_LENS_DISTORTION_MODEL_RATIONAL_6KT ||
@@ -48,30 +73,58 @@ static k4a_result_t transformation_project_internal(const k4a_calibration_camera
 
     const k4a_calibration_intrinsic_parameters_t *params = &camera_calibration->intrinsics.parameters;
 
-    float cx = params->param.cx;
-    float cy = params->param.cy;
-    float fx = params->param.fx;
-    float fy = params->param.fy;
-    float k1 = params->param.k1;
-    float k2 = params->param.k2;
-    float k3 = params->param.k3;
-    float k4 = params->param.k4;
-    float k5 = params->param.k5;
-    float k6 = params->param.k6;
-    float codx = params->param.codx; // center of distortion is set to 0 for Brown Conrady model
-    float cody = params->param.cody;
-    float p1 = params->param.p1;
-    float p2 = params->param.p2;
-    float max_radius_for_projection = camera_calibration->metric_radius;
-
-    if (K4A_FAILED(K4A_RESULT_FROM_BOOL(fx > 0.f && fy > 0.f)))
+    intrinsics->cx = params->param.cx;
+    intrinsics->cy = params->param.cy;
+    intrinsics->fx = params->param.fx;
+    intrinsics->fy = params->param.fy;
+    intrinsics->k1 = params->param.k1;
+    intrinsics->k2 = params->param.k2;
+    intrinsics->k3 = params->param.k3;
+    intrinsics->k4 = params->param.k4;
+    intrinsics->k5 = params->param.k5;
+    intrinsics->k6 = params->param.k6;
+    intrinsics->codx = params->param.codx;
+    intrinsics->cody = params->param.cody;
+    intrinsics->p1 = params->param.p1;
+    intrinsics->p2 = params->param.p2;
+    intrinsics->max_radius_for_projection = camera_calibration->metric_radius;
+    intrinsics->tangential_scale =
+        camera_calibration->intrinsics.type == K4A_CALIBRATION_LENS_DISTORTION_MODEL_RATIONAL_6KT ? 1.f : 2.f;
+
+    if (K4A_FAILED(K4A_RESULT_FROM_BOOL(intrinsics->fx > 0.f && intrinsics->fy > 0.f)))
     {
         LOG_ERROR("Expect both fx and fy are larger than 0, actual values are fx: %lf, fy: %lf.",
-                  (double)fx,
-                  (double)fy);
+                  (double)intrinsics->fx,
+                  (double)intrinsics->fy);
         return K4A_RESULT_FAILED;
     }
 
+    return K4A_RESULT_SUCCEEDED;
+}
+
+static void transformation_project_point(const transformation_intrinsics_t *intrinsics,
+                                         const float xy[2],
+                                         float uv[2],
+                                         int *valid,
+                                         float J_xy[2 * 2])
+{
+    float cx = intrinsics->cx;
+    float cy = intrinsics->cy;
+    float fx = intrinsics->fx;
+    float fy = intrinsics->fy;
+    float k1 = intrinsics->k1;
+    float k2 = intrinsics->k2;
+    float k3 = intrinsics->k3;
+    float k4 = intrinsics->k4;
+    float k5 = intrinsics->k5;
+    float k6 = intrinsics->k6;
+    float codx = intrinsics->codx;
+    float cody = intrinsics->cody;
+    float p1 = intrinsics->p1;
+    float p2 = intrinsics->p2;
+    float t = intrinsics->tangential_scale;
+    float max_radius_for_projection = intrinsics->max_radius_for_projection;
+
     *valid = 1;
 
     float xp = xy[0] - codx;
@@ -84,7 +137,7 @@ static k4a_result_t transformation_project_internal(const k4a_calibration_camera
     if (rs > max_radius_for_projection * max_radius_for_projection)
     {
         *valid = 0;
-        return K4A_RESULT_SUCCEEDED;
+        return;
     }
     float rss = rs * rs;
     float rsc = rss * rs;
@@ -107,18 +160,8 @@ static k4a_result_t transformation_project_internal(const k4a_calibration_camera
     float rs_2xp2 = rs + 2.f * xp2;
     float rs_2yp2 = rs + 2.f * yp2;
 
-    if (camera_calibration->intrinsics.type == K4A_CALIBRATION_LENS_DISTORTION_MODEL_RATIONAL_6KT)
-    {
-        xp_d += rs_2xp2 * p2 + xyp * p1;
-        yp_d += rs_2yp2 * p1 + xyp * p2;
-    }
-    else
-    {
-        // the only difference from Rational6ktCameraModel is 2 multiplier for the tangential coefficient term xyp*p1
-        // and xyp*p2
-        xp_d += rs_2xp2 * p2 + 2.f * xyp * p1;
-        yp_d += rs_2yp2 * p1 + 2.f * xyp * p2;
-    }
+    xp_d += rs_2xp2 * p2 + t * xyp * p1;
+    yp_d += rs_2yp2 * p1 + t * xyp * p2;
 
     float xp_d_cx = xp_d + codx;
     float yp_d_cy = yp_d + cody;
@@ -128,7 +171,7 @@ static k4a_result_t transformation_project_internal(const k4a_calibration_camera
 
     if (J_xy == 0)
     {
-        return K4A_RESULT_SUCCEEDED;
+        return;
     }
 
     // compute Jacobian matrix
@@ -142,22 +185,10 @@ static k4a_result_t transformation_project_internal(const k4a_calibration_camera
     float xp_dddrs_2 = xp * dddrs_2;
     float yp_xp_dddrs_2 = yp * xp_dddrs_2;
     // compute d(u)/d(xp)
-    if (camera_calibration->intrinsics.type == K4A_CALIBRATION_LENS_DISTORTION_MODEL_RATIONAL_6KT)
-    {
-        J_xy[0] = fx * (d + xp * xp_dddrs_2 + 6.f * xp * p2 + yp * p1);
-        J_xy[1] = fx * (yp_xp_dddrs_2 + 2.f * yp * p2 + xp * p1);
-        J_xy[2] = fy * (yp_xp_dddrs_2 + 2.f * xp * p1 + yp * p2);
-        J_xy[3] = fy * (d + yp * yp * dddrs_2 + 6.f * yp * p1 + xp * p2);
-    }
-    else
-    {
-        J_xy[0] = fx * (d + xp * xp_dddrs_2 + 6.f * xp * p2 + 2.f * yp * p1);
-        J_xy[1] = fx * (yp_xp_dddrs_2 + 2.f * yp * p2 + 2.f * xp * p1);
-        J_xy[2] = fy * (yp_xp_dddrs_2 + 2.f * xp * p1 + 2.f * yp * p2);
-        J_xy[3] = fy * (d + yp * yp * dddrs_2 + 6.f * yp * p1 + 2.f * xp * p2);
-    }
-
-    return K4A_RESULT_SUCCEEDED;
+    J_xy[0] = fx * (d + xp * xp_dddrs_2 + 6.f * xp * p2 + t * yp * p1);
+    J_xy[1] = fx * (yp_xp_dddrs_2 + 2.f * yp * p2 + t * xp * p1);
+    J_xy[2] = fy * (yp_xp_dddrs_2 + 2.f * xp * p1 + t * yp * p2);
+    J_xy[3] = fy * (d + yp * yp * dddrs_2 + 6.f * yp * p1 + t * xp * p2);
 }
 
 static void invert_2x2(const float J[2 * 2], float Jinv[2 * 2])
@@ -171,11 +202,11 @@ static void invert_2x2(const float J[2 * 2], float Jinv[2 * 2])
     Jinv[2] = -inv_detJ * J[2];
 }
 
-static k4a_result_t transformation_iterative_unproject(const k4a_calibration_camera_t *camera_calibration,
-                                                       const float uv[2],
-                                                       float xy[2],
-                                                       int *valid,
-                                                       unsigned int max_passes)
+static void transformation_iterative_unproject(const transformation_intrinsics_t *intrinsics,
+                                               const float uv[2],
+                                               float xy[2],
+                                               int *valid,
+                                               unsigned int max_passes)
 {
     *valid = 1;
     float Jinv[2 * 2];
@@ -187,13 +218,10 @@ static k4a_result_t transformation_iterative_unproject(const k4a_calibration_cam
         float p[2];
         float J[2 * 2];
 
-        if (K4A_FAILED(TRACE_CALL(transformation_project_internal(camera_calibration, xy, p, valid, J))))
-        {
-            return K4A_RESULT_FAILED;
-        }
+        transformation_project_point(intrinsics, xy, p, valid, J);
         if (*valid == 0)
         {
-            return K4A_RESULT_SUCCEEDED;
+            return;
         }
 
         float err_x = uv[0] - p[0];
@@ -226,68 +254,27 @@ static k4a_result_t transformation_iterative_unproject(const k4a_calibration_cam
     {
         *valid = 0;
     }
-
-    return K4A_RESULT_SUCCEEDED;
 }
 
-static k4a_result_t transformation_unproject_internal(const k4a_calibration_camera_t *camera_calibration,
-                                                      const float uv[2],
-                                                      float xy[2],
-                                                      int *valid)
+static void transformation_unproject_point(const transformation_intrinsics_t *intrinsics,
+                                           const float uv[2],
+                                           float xy[2],
+                                           int *valid)
 {
-    if (K4A_FAILED(K4A_RESULT_FROM_BOOL(
-            (camera_calibration->intrinsics.type == K4A_CALIBRATION_LENS_DISTORTION_MODEL_RATIONAL_6KT ||
-             camera_calibration->intrinsics.type == K4A_CALIBRATION_LENS_DISTORTION_MODEL_BROWN_CONRADY) &&
-            camera_calibration->intrinsics.parameter_count >= 14)))
-    {
-        LOG_ERROR("Unexpected camera calibration model type %d, should either be "
-                  "K4A_CALIBRATION_LENS_DISTORTION_MODEL_RATIONAL_6KT (%d) or "
-                  "K4A_CALIBRATION_LENS_DISTORTION_MODEL_BROWN_CONRADY (%d).",
-                  camera_calibration->intrinsics.type,
-                  K4A_CALIBRATION_LENS_DISTORTION_MODEL_RATIONAL_6KT,
-                  K4A_CALIBRATION_LENS_DISTORTION_MODEL_BROWN_CONRADY);
-        if (camera_calibration->intrinsics.type == K4A_CALIBRATION_LENS_DISTORTION_MODEL_BROWN_CONRADY)
-        {
-            LOG_ERROR("Unexpected parameter count %d, should be %d.",
-                      camera_calibration->intrinsics.parameter_count,
-                      14);
-        }
-        return K4A_RESULT_FAILED;
-    }
-
-    if (camera_calibration->intrinsics.type == K4A_CALIBRATION_LENS_DISTORTION_MODEL_RATIONAL_6KT &&
-        g_deprecated_6kt_message_fired == false)
-    {
-        g_deprecated_6kt_message_fired = true;
-        LOG_CRITICAL("Rational 6KT is deprecated (only supported early internal devices). Please replace your Azure "
-                     "Kinect with a retail device.",
-                     0);
-    }
-
-    const k4a_calibration_intrinsic_parameters_t *params = &camera_calibration->intrinsics.parameters;
-
-    float cx = params->param.cx;
-    float cy = params->param.cy;
-    float fx = params->param.fx;
-    float fy = params->param.fy;
-    float k1 = params->param.k1;
-    float k2 = params->param.k2;
-    float k3 = params->param.k3;
-    float k4 = params->param.k4;
-    float k5 = params->param.k5;
-    float k6 = params->param.k6;
-    float codx = params->param.codx; // center of distortion is set to 0 for Brown Conrady model
-    float cody = params->param.cody;
-    float p1 = params->param.p1;
-    float p2 = params->param.p2;
-
-    if (K4A_FAILED(K4A_RESULT_FROM_BOOL(fx > 0.f && fy > 0.f)))
-    {
-        LOG_ERROR("Expect both fx and fy are larger than 0, actual values are fx: %lf, fy: %lf.",
-                  (double)fx,
-                  (double)fy);
-        return K4A_RESULT_FAILED;
-    }
+    float cx = intrinsics->cx;
+    float cy = intrinsics->cy;
+    float fx = intrinsics->fx;
+    float fy = intrinsics->fy;
+    float k1 = intrinsics->k1;
+    float k2 = intrinsics->k2;
+    float k3 = intrinsics->k3;
+    float k4 = intrinsics->k4;
+    float k5 = intrinsics->k5;
+    float k6 = intrinsics->k6;
+    float codx = intrinsics->codx;
+    float cody = intrinsics->cody;
+    float p1 = intrinsics->p1;
+    float p2 = intrinsics->p2;
 
     // correction for radial distortion
     float xp_d = (uv[0] - cx) / fx - codx;
@@ -324,7 +311,315 @@ static k4a_result_t transformation_unproject_internal(const k4a_calibration_came
     xy[0] += codx;
     xy[1] += cody;
 
-    return transformation_iterative_unproject(camera_calibration, uv, xy, valid, 20);
+    transformation_iterative_unproject(intrinsics, uv, xy, valid, 20);
+}
+
+static void transformation_unproject_with_depth(const transformation_intrinsics_t *intrinsics,
+                                                const float point2d[2],
+                                                const float depth,
+                                                float point3d[3],
+                                                int *valid)
+{
+    if (depth == 0.f)
+    {
+        point3d[0] = 0.f;
+        point3d[1] = 0.f;
+        point3d[2] = 0.f;
+        *valid = 0;
+        return;
+    }
+
+    transformation_unproject_point(intrinsics, point2d, point3d, valid);
+
+    point3d[0] *= depth;
+    point3d[1] *= depth;
+    point3d[2] = depth;
+}
+
+static void transformation_project_with_depth(const transformation_intrinsics_t *intrinsics,
+                                              const float point3d[3],
+                                              float point2d[2],
+                                              int *valid)
+{
+    if (point3d[2] <= 0.f)
+    {
+        point2d[0] = 0.f;
+        point2d[1] = 0.f;
+        *valid = 0;
+        return;
+    }
+
+    float xy[2];
+    xy[0] = point3d[0] / point3d[2];
+    xy[1] = point3d[1] / point3d[2];
+
+    transformation_project_point(intrinsics, xy, point2d, valid, 0);
+}
+
+#if defined(K4A_USING_SSE)
+// transformation_project_point() for 4 points at once, with the same operations in the same order so every lane matches
+// the scalar result. inside is set for the lanes within the metric radius, the other lanes of uv are undefined.
+static void transformation_project_point_sse(const transformation_intrinsics_t *intrinsics,
+                                             __m128 x,
+                                             __m128 y,
+                                             __m128 *u,
+                                             __m128 *v,
+                                             __m128 *inside,
+                                             __m128 J_xy[2 * 2])
+{
+    const __m128 one = _mm_set1_ps(1.f);
+    const __m128 two = _mm_set1_ps(2.f);
+    const __m128 k1 = _mm_set1_ps(intrinsics->k1);
+    const __m128 k2 = _mm_set1_ps(intrinsics->k2);
+    const __m128 k3 = _mm_set1_ps(intrinsics->k3);
+    const __m128 k4 = _mm_set1_ps(intrinsics->k4);
+    const __m128 k5 = _mm_set1_ps(intrinsics->k5);
+    const __m128 k6 = _mm_set1_ps(intrinsics->k6);
+    const __m128 codx = _mm_set1_ps(intrinsics->codx);
+    const __m128 cody = _mm_set1_ps(intrinsics->cody);
+    const __m128 p1 = _mm_set1_ps(intrinsics->p1);
+    const __m128 p2 = _mm_set1_ps(intrinsics->p2);
+    const __m128 t = _mm_set1_ps(intrinsics->tangential_scale);
+    const __m128 fx = _mm_set1_ps(intrinsics->fx);
+    const __m128 fy = _mm_set1_ps(intrinsics->fy);
+
+    __m128 xp = _mm_sub_ps(x, codx);
+    __m128 yp = _mm_sub_ps(y, cody);
+
+    __m128 xp2 = _mm_mul_ps(xp, xp);
+    __m128 yp2 = _mm_mul_ps(yp, yp);
+    __m128 xyp = _mm_mul_ps(xp, yp);
+    __m128 rs = _mm_add_ps(xp2, yp2);
+    *inside = _mm_cmpngt_ps(
+        rs, _mm_set1_ps(intrinsics->max_radius_for_projection * intrinsics->max_radius_for_projection));
+    __m128 rss = _mm_mul_ps(rs, rs);
+    __m128 rsc = _mm_mul_ps(rss, rs);
+    __m128 a = _mm_add_ps(_mm_add_ps(_mm_add_ps(one, _mm_mul_ps(k1, rs)), _mm_mul_ps(k2, rss)), _mm_mul_ps(k3, rsc));
+    __m128 b = _mm_add_ps(_mm_add_ps(_mm_add_ps(one, _mm_mul_ps(k4, rs)), _mm_mul_ps(k5, rss)), _mm_mul_ps(k6, rsc));
+    __m128 bi = _mm_blendv_ps(one, _mm_div_ps(one, b), _mm_cmpneq_ps(b, _mm_setzero_ps()));
+    __m128 d = _mm_mul_ps(a, bi);
+
+    __m128 xp_d = _mm_mul_ps(xp, d);
+    __m128 yp_d = _mm_mul_ps(yp, d);
+
+    __m128 rs_2xp2 = _mm_add_ps(rs, _mm_mul_ps(two, xp2));
+    __m128 rs_2yp2 = _mm_add_ps(rs, _mm_mul_ps(two, yp2));
+
+    __m128 t_xyp = _mm_mul_ps(t, xyp);
+    xp_d = _mm_add_ps(xp_d, _mm_add_ps(_mm_mul_ps(rs_2xp2, p2), _mm_mul_ps(t_xyp, p1)));
+    yp_d = _mm_add_ps(yp_d, _mm_add_ps(_mm_mul_ps(rs_2yp2, p1), _mm_mul_ps(t_xyp, p2)));
+
+    *u = _mm_add_ps(_mm_mul_ps(_mm_add_ps(xp_d, codx), fx), _mm_set1_ps(intrinsics->cx));
+    *v = _mm_add_ps(_mm_mul_ps(_mm_add_ps(yp_d, cody), fy), _mm_set1_ps(intrinsics->cy));
+
+    if (J_xy == 0)
+    {
+        return;
+    }
+
+    const __m128 three = _mm_set1_ps(3.f);
+    const __m128 six = _mm_set1_ps(6.f);
+    __m128 dudrs = _mm_add_ps(_mm_add_ps(k1, _mm_mul_ps(_mm_mul_ps(two, k2), rs)),
+                              _mm_mul_ps(_mm_mul_ps(three, k3), rss));
+    __m128 dvdrs = _mm_add_ps(_mm_add_ps(k4, _mm_mul_ps(_mm_mul_ps(two, k5), rs)),
+                              _mm_mul_ps(_mm_mul_ps(three, k6), rss));
+    __m128 bis = _mm_mul_ps(bi, bi);
+    __m128 dddrs = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(dudrs, b), _mm_mul_ps(a, dvdrs)), bis);
+
+    __m128 dddrs_2 = _mm_mul_ps(dddrs, two);
+    __m128 xp_dddrs_2 = _mm_mul_ps(xp, dddrs_2);
+    __m128 yp_xp_dddrs_2 = _mm_mul_ps(yp, xp_dddrs_2);
+    __m128 t_xp = _mm_mul_ps(t, xp);
+    __m128 t_yp = _mm_mul_ps(t, yp);
+    J_xy[0] = _mm_mul_ps(fx,
+                         _mm_add_ps(_mm_add_ps(_mm_add_ps(d, _mm_mul_ps(xp, xp_dddrs_2)),
+                                               _mm_mul_ps(_mm_mul_ps(six, xp), p2)),
+                                    _mm_mul_ps(t_yp, p1)));
+    J_xy[1] = _mm_mul_ps(fx,
+                         _mm_add_ps(_mm_add_ps(yp_xp_dddrs_2, _mm_mul_ps(_mm_mul_ps(two, yp), p2)),
+                                    _mm_mul_ps(t_xp, p1)));
+    J_xy[2] = _mm_mul_ps(fy,
+                         _mm_add_ps(_mm_add_ps(yp_xp_dddrs_2, _mm_mul_ps(_mm_mul_ps(two, xp), p1)),
+                                    _mm_mul_ps(t_yp, p2)));
+    J_xy[3] = _mm_mul_ps(fy,
+                         _mm_add_ps(_mm_add_ps(_mm_add_ps(d, _mm_mul_ps(_mm_mul_ps(yp, yp), dddrs_2)),
+                                               _mm_mul_ps(_mm_mul_ps(six, yp), p1)),
+                                    _mm_mul_ps(t_xp, p2)));
+}
+
+// transformation_unproject_with_depth() for 4 points at once. Each lane leaves the Newton iterations when it would have
+// returned or broken out of the scalar loop, so the lanes keep matching the scalar results.
+static void transformation_unproject_with_depth_sse(const transformation_intrinsics_t *intrinsics,
+                                                    const float *point2d,
+                                                    const float *depth,
+                                                    float *point3d,
+                                                    int *valid)
+{
+    const __m128 one = _mm_set1_ps(1.f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 codx = _mm_set1_ps(intrinsics->codx);
+    const __m128 cody = _mm_set1_ps(intrinsics->cody);
+    const __m128 p1 = _mm_set1_ps(intrinsics->p1);
+    const __m128 p2 = _mm_set1_ps(intrinsics->p2);
+    const __m128 three = _mm_set1_ps(3.f);
+
+    __m128 uv01 = _mm_loadu_ps(point2d);
+    __m128 uv23 = _mm_loadu_ps(point2d + 4);
+    __m128 u = _mm_shuffle_ps(uv01, uv23, _MM_SHUFFLE(2, 0, 2, 0));
+    __m128 v = _mm_shuffle_ps(uv01, uv23, _MM_SHUFFLE(3, 1, 3, 1));
+
+    // correction for radial distortion
+    __m128 xp_d = _mm_sub_ps(_mm_div_ps(_mm_sub_ps(u, _mm_set1_ps(intrinsics->cx)), _mm_set1_ps(intrinsics->fx)),
+                             codx);
+    __m128 yp_d = _mm_sub_ps(_mm_div_ps(_mm_sub_ps(v, _mm_set1_ps(intrinsics->cy)), _mm_set1_ps(intrinsics->fy)),
+                             cody);
+
+    __m128 rs = _mm_add_ps(_mm_mul_ps(xp_d, xp_d), _mm_mul_ps(yp_d, yp_d));
+    __m128 rss = _mm_mul_ps(rs, rs);
+    __m128 rsc = _mm_mul_ps(rss, rs);
+    __m128 a = _mm_add_ps(_mm_add_ps(_mm_add_ps(one, _mm_mul_ps(_mm_set1_ps(intrinsics->k1), rs)),
+                                     _mm_mul_ps(_mm_set1_ps(intrinsics->k2), rss)),
+                          _mm_mul_ps(_mm_set1_ps(intrinsics->k3), rsc));
+    __m128 b = _mm_add_ps(_mm_add_ps(_mm_add_ps(one, _mm_mul_ps(_mm_set1_ps(intrinsics->k4), rs)),
+                                     _mm_mul_ps(_mm_set1_ps(intrinsics->k5), rss)),
+                          _mm_mul_ps(_mm_set1_ps(intrinsics->k6), rsc));
+    __m128 ai = _mm_blendv_ps(one, _mm_div_ps(one, a), _mm_cmpneq_ps(a, zero));
+    __m128 di = _mm_mul_ps(ai, b);
+
+    __m128 x = _mm_mul_ps(xp_d, di);
+    __m128 y = _mm_mul_ps(yp_d, di);
+
+    // approximate correction for tangential params
+    __m128 two_xy = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(2.f), x), y);
+    __m128 xx = _mm_mul_ps(x, x);
+    __m128 yy = _mm_mul_ps(y, y);
+
+    x = _mm_sub_ps(x, _mm_add_ps(_mm_mul_ps(_mm_add_ps(yy, _mm_mul_ps(three, xx)), p2), _mm_mul_ps(two_xy, p1)));
+    y = _mm_sub_ps(y, _mm_add_ps(_mm_mul_ps(_mm_add_ps(xx, _mm_mul_ps(three, yy)), p1), _mm_mul_ps(two_xy, p2)));
+
+    // add on center of distortion
+    x = _mm_add_ps(x, codx);
+    y = _mm_add_ps(y, cody);
+
+    // Newton iterations, see transformation_iterative_unproject()
+    __m128 active = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    __m128 outside = zero;
+    __m128 best_x = zero;
+    __m128 best_y = zero;
+    __m128 best_err = _mm_set1_ps(FLT_MAX);
+    for (unsigned int pass = 0; pass < 20 && _mm_movemask_ps(active) != 0; pass++)
+    {
+        __m128 p_u, p_v, inside;
+        __m128 J[2 * 2];
+        transformation_project_point_sse(intrinsics, x, y, &p_u, &p_v, &inside, J);
+        outside = _mm_or_ps(outside, _mm_andnot_ps(inside, active));
+        active = _mm_and_ps(active, inside);
+
+        __m128 err_x = _mm_sub_ps(u, p_u);
+        __m128 err_y = _mm_sub_ps(v, p_v);
+        __m128 err = _mm_add_ps(_mm_mul_ps(err_x, err_x), _mm_mul_ps(err_y, err_y));
+        __m128 worse = _mm_and_ps(active, _mm_cmpge_ps(err, best_err));
+        x = _mm_blendv_ps(x, best_x, worse);
+        y = _mm_blendv_ps(y, best_y, worse);
+        active = _mm_andnot_ps(worse, active);
+
+        best_err = _mm_blendv_ps(best_err, err, active);
+        best_x = _mm_blendv_ps(best_x, x, active);
+        best_y = _mm_blendv_ps(best_y, y, active);
+        if (pass + 1 == 20)
+        {
+            break;
+        }
+        active = _mm_andnot_ps(_mm_cmplt_ps(best_err, _mm_set1_ps(1e-22f)), active);
+
+        __m128 inv_detJ = _mm_div_ps(one, _mm_sub_ps(_mm_mul_ps(J[0], J[3]), _mm_mul_ps(J[1], J[2])));
+        __m128 Jinv0 = _mm_mul_ps(inv_detJ, J[3]);
+        __m128 Jinv3 = _mm_mul_ps(inv_detJ, J[0]);
+        __m128 Jinv1 = _mm_mul_ps(_mm_xor_ps(inv_detJ, _mm_set1_ps(-0.f)), J[1]);
+        __m128 Jinv2 = _mm_mul_ps(_mm_xor_ps(inv_detJ, _mm_set1_ps(-0.f)), J[2]);
+
+        __m128 dx = _mm_add_ps(_mm_mul_ps(Jinv0, err_x), _mm_mul_ps(Jinv1, err_y));
+        __m128 dy = _mm_add_ps(_mm_mul_ps(Jinv2, err_x), _mm_mul_ps(Jinv3, err_y));
+        x = _mm_blendv_ps(x, _mm_add_ps(x, dx), active);
+        y = _mm_blendv_ps(y, _mm_add_ps(y, dy), active);
+    }
+
+    __m128 d = _mm_loadu_ps(depth);
+    __m128 has_depth = _mm_cmpneq_ps(d, zero);
+    __m128 is_valid = _mm_andnot_ps(_mm_or_ps(outside, _mm_cmpgt_ps(best_err, _mm_set1_ps(1e-6f))), has_depth);
+
+    float xyz[3][4];
+    _mm_storeu_ps(xyz[0], _mm_and_ps(_mm_mul_ps(x, d), has_depth));
+    _mm_storeu_ps(xyz[1], _mm_and_ps(_mm_mul_ps(y, d), has_depth));
+    _mm_storeu_ps(xyz[2], _mm_and_ps(d, has_depth));
+    for (int i = 0; i < 4; i++)
+    {
+        point3d[3 * i + 0] = xyz[0][i];
+        point3d[3 * i + 1] = xyz[1][i];
+        point3d[3 * i + 2] = xyz[2][i];
+    }
+    _mm_storeu_si128((__m128i *)valid, _mm_and_si128(_mm_castps_si128(is_valid), _mm_set1_epi32(1)));
+}
+
+// transformation_project_with_depth() for 4 points at once
+static void transformation_project_with_depth_sse(const transformation_intrinsics_t *intrinsics,
+                                                  const float *point3d,
+                                                  float *point2d,
+                                                  int *valid)
+{
+    float xyz[3][4];
+    for (int i = 0; i < 4; i++)
+    {
+        xyz[0][i] = point3d[3 * i + 0];
+        xyz[1][i] = point3d[3 * i + 1];
+        xyz[2][i] = point3d[3 * i + 2];
+    }
+    __m128 z = _mm_loadu_ps(xyz[2]);
+    __m128 in_front = _mm_cmpnle_ps(z, _mm_setzero_ps());
+
+    __m128 u, v, inside;
+    transformation_project_point_sse(
+        intrinsics, _mm_div_ps(_mm_loadu_ps(xyz[0]), z), _mm_div_ps(_mm_loadu_ps(xyz[1]), z), &u, &v, &inside, 0);
+    __m128 is_valid = _mm_and_ps(in_front, inside);
+
+    // Points behind the camera are set to 0
+    u = _mm_and_ps(u, in_front);
+    v = _mm_and_ps(v, in_front);
+    _mm_storeu_ps(point2d, _mm_unpacklo_ps(u, v));
+    _mm_storeu_ps(point2d + 4, _mm_unpackhi_ps(u, v));
+    _mm_storeu_si128((__m128i *)valid, _mm_and_si128(_mm_castps_si128(is_valid), _mm_set1_epi32(1)));
+}
+#endif
+
+static k4a_result_t transformation_project_internal(const k4a_calibration_camera_t *camera_calibration,
+                                                    const float xy[2],
+                                                    float uv[2],
+                                                    int *valid,
+                                                    float J_xy[2 * 2])
+{
+    transformation_intrinsics_t intrinsics;
+    if (K4A_FAILED(TRACE_CALL(transformation_get_intrinsics(camera_calibration, &intrinsics))))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    transformation_project_point(&intrinsics, xy, uv, valid, J_xy);
+    return K4A_RESULT_SUCCEEDED;
+}
+
+static k4a_result_t transformation_unproject_internal(const k4a_calibration_camera_t *camera_calibration,
+                                                      const float uv[2],
+                                                      float xy[2],
+                                                      int *valid)
+{
+    transformation_intrinsics_t intrinsics;
+    if (K4A_FAILED(TRACE_CALL(transformation_get_intrinsics(camera_calibration, &intrinsics))))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    transformation_unproject_point(&intrinsics, uv, xy, valid);
+    return K4A_RESULT_SUCCEEDED;
 }
 
 k4a_result_t transformation_unproject(const k4a_calibration_camera_t *camera_calibration,
@@ -378,3 +673,58 @@ k4a_result_t transformation_project(const k4a_calibration_camera_t *camera_calib
 
     return K4A_RESULT_SUCCEEDED;
 }
+
+k4a_result_t transformation_unproject_batch(const k4a_calibration_camera_t *camera_calibration,
+                                            const float *point2d,
+                                            const float *depth,
+                                            size_t point_count,
+                                            float *point3d,
+                                            int *valid)
+{
+    transformation_intrinsics_t intrinsics;
+    if (K4A_FAILED(TRACE_CALL(transformation_get_intrinsics(camera_calibration, &intrinsics))))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    size_t i = 0;
+#if defined(K4A_USING_SSE)
+    for (; i + 4 <= point_count; i += 4)
+    {
+        transformation_unproject_with_depth_sse(&intrinsics, point2d + 2 * i, depth + i, point3d + 3 * i, valid + i);
+    }
+#endif
+    for (; i < point_count; i++)
+    {
+        transformation_unproject_with_depth(&intrinsics, point2d + 2 * i, depth[i], point3d + 3 * i, valid + i);
+    }
+
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t transformation_project_batch(const k4a_calibration_camera_t *camera_calibration,
+                                          const float *point3d,
+                                          size_t point_count,
+                                          float *point2d,
+                                          int *valid)
+{
+    transformation_intrinsics_t intrinsics;
+    if (K4A_FAILED(TRACE_CALL(transformation_get_intrinsics(camera_calibration, &intrinsics))))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    size_t i = 0;
+#if defined(K4A_USING_SSE)
+    for (; i + 4 <= point_count; i += 4)
+    {
+        transformation_project_with_depth_sse(&intrinsics, point3d + 3 * i, point2d + 2 * i, valid + i);
+    }
+#endif
+    for (; i < point_count; i++)
+    {
+        transformation_project_with_depth(&intrinsics, point3d + 3 * i, point2d + 2 * i, valid + i);
+    }
+
+    return K4A_RESULT_SUCCEEDED;
+}
@@ -3,8 +3,12 @@
 
 #include <k4ainternal/transformation.h>
 #include <k4ainternal/logging.h>
+#include <k4ainternal/global.h>
+#include <k4ainternal/atomic.h>
+#include <k4ainternal/threadpool.h>
 
 #include <stdlib.h>
+#include <string.h>
 #include <limits.h>
 #include <math.h>
 
@@ -13,6 +17,18 @@
 #include <emmintrin.h> // SSE2
 #include <tmmintrin.h> // SSE3
 #include <smmintrin.h> // SSE4.1
+#include <immintrin.h> // AVX2 and AVX-512, only used by functions built for them and selected at runtime
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define K4A_TARGET_AVX2
+#define K4A_TARGET_AVX512
+#define K4A_TARGET_F16C
+#else
+#include <cpuid.h>
+#define K4A_TARGET_AVX2 __attribute__((target("avx2")))
+#define K4A_TARGET_AVX512 __attribute__((target("avx2,avx512f")))
+#define K4A_TARGET_F16C __attribute__((target("f16c")))
+#endif
 #elif defined(__aarch64__) || defined(_M_ARM64)
 #define K4A_USING_NEON
 #include <arm_neon.h>
@@ -36,15 +52,22 @@ typedef struct _k4a_transformation_rgbz_context_t
 {
     const k4a_calibration_t *calibration;
     const k4a_transformation_xy_tables_t *xy_tables;
+    const k4a_transformation_ray_tables_t *ray_tables; // NULL unless precomputed rays are enabled
     k4a_transformation_input_image_t depth_image;
     k4a_transformation_input_image_t color_image;
-    k4a_transformation_input_image_t custom_image;
+    k4a_transformation_input_image_t custom_images[K4A_TRANSFORMATION_MAX_CUSTOM_PLANES];
     k4a_transformation_output_image_t transformed_image;
-    k4a_transformation_output_image_t transformed_custom_image;
+    k4a_transformation_output_image_t transformed_custom_images[K4A_TRANSFORMATION_MAX_CUSTOM_PLANES];
+    uint32_t custom_count; // Planes of custom_images and transformed_custom_images, all CUSTOM8 or all CUSTOM16
     k4a_transformation_interpolation_type_t interpolation_type;
     uint16_t invalid_value;
     bool enable_custom8;
     bool enable_custom16;
+    k4a_transformation_depth_to_color_mode_t mode;
+    bool fixed_point; // Color to depth blends with transformation_bilinear_bgra_row_fixed_c() and its vector versions
+    uint32_t thread_count; // Bands depth to color splits its work into, run on the SDK thread pool
+    int block_size;        // Edge in depth pixels of the blocks depth to color renders quads in, 0 for whole rows
+    k4a_rect_t roi;        // Region of the color (depth to color) or depth (color to depth) image the outputs hold
 } k4a_transformation_rgbz_context_t;
 
 typedef struct _k4a_correspondence_t
@@ -60,8 +83,8 @@ typedef struct _k4a_bounding_box_t
     int bottom_right[2];
 } k4a_bounding_box_t;
 
-// g_transformation_instruction_type is set to SSE, NEON, None, or NULL
-static char g_transformation_instruction_type[5] = { 0 };
+// g_transformation_instruction_type is set to AVX512, AVX2, SSE, NEON, None, or NULL
+static char g_transformation_instruction_type[8] = { 0 };
 
 // Share g_transformation_instruction_type with tests to confirm this is built correctly.
 char *transformation_get_instruction_type(void);
@@ -76,12 +99,145 @@ static void set_special_instruction_optimization(char *opt)
     // Only set this once
     if (g_transformation_instruction_type[0] == '\0')
     {
-        size_t sz = MIN(sizeof(opt), sizeof(g_transformation_instruction_type) - 1);
+        size_t sz = MIN(strlen(opt), sizeof(g_transformation_instruction_type) - 1);
         memcpy(g_transformation_instruction_type, opt, sz);
         LOG_INFO("Compiled special instruction type is: %s\n", opt);
     }
 }
 
+#if defined(K4A_USING_SSE)
+typedef enum
+{
+    TRANSFORMATION_INSTRUCTION_SET_SSE = 0,
+    TRANSFORMATION_INSTRUCTION_SET_AVX2,
+    TRANSFORMATION_INSTRUCTION_SET_AVX512,
+} transformation_instruction_set_t;
+
+typedef struct
+{
+    transformation_instruction_set_t instruction_set;
+    bool f16c; // Half precision conversions, independent of the instruction set
+} transformation_cpu_features_t;
+
+static void transformation_cpuid(int leaf, int subleaf, int regs[4])
+{
+#if defined(_MSC_VER)
+    __cpuidex(regs, leaf, subleaf);
+#else
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+    __cpuid_count((unsigned int)leaf, (unsigned int)subleaf, eax, ebx, ecx, edx);
+    regs[0] = (int)eax;
+    regs[1] = (int)ebx;
+    regs[2] = (int)ecx;
+    regs[3] = (int)edx;
+#endif
+}
+
+// Register state the OS saves on a context switch
+static uint64_t transformation_xgetbv(void)
+{
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    unsigned int eax = 0, edx = 0;
+    __asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((uint64_t)edx << 32) | eax;
+#endif
+}
+
+static void transformation_cpu_features_init(transformation_cpu_features_t *features)
+{
+    int regs[4] = { 0 };
+
+    features->instruction_set = TRANSFORMATION_INSTRUCTION_SET_SSE;
+    features->f16c = false;
+
+    transformation_cpuid(0, 0, regs);
+    int max_leaf = regs[0];
+    if (max_leaf < 7)
+    {
+        return;
+    }
+
+    // AVX needs OSXSAVE and the OS to save the XMM and YMM registers
+    transformation_cpuid(1, 0, regs);
+    bool osxsave = (regs[2] & (1 << 27)) != 0;
+    bool avx = (regs[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx)
+    {
+        return;
+    }
+    uint64_t xcr0 = transformation_xgetbv();
+    if ((xcr0 & 0x6) != 0x6)
+    {
+        return;
+    }
+    features->f16c = (regs[2] & (1 << 29)) != 0;
+
+    transformation_cpuid(7, 0, regs);
+    bool avx2 = (regs[1] & (1 << 5)) != 0;
+    bool avx512f = (regs[1] & (1 << 16)) != 0;
+    if (avx2)
+    {
+        features->instruction_set = TRANSFORMATION_INSTRUCTION_SET_AVX2;
+    }
+
+    // AVX-512 additionally needs the opmask and ZMM registers saved
+    if (avx2 && avx512f && (xcr0 & 0xE6) == 0xE6)
+    {
+        features->instruction_set = TRANSFORMATION_INSTRUCTION_SET_AVX512;
+    }
+}
+
+K4A_DECLARE_GLOBAL(transformation_cpu_features_t, transformation_cpu_features_init);
+
+// Widest instruction set the kernels may use, see transformation_set_instruction_set_limit()
+static volatile uint32_t g_transformation_instruction_set_limit = UINT32_MAX;
+
+// The widest kernel the CPU and OS support, chosen once per process, unless limited to a narrower one
+static transformation_instruction_set_t transformation_get_instruction_set(void)
+{
+    uint32_t limit = k4a_atomic_load(&g_transformation_instruction_set_limit);
+    transformation_instruction_set_t instruction_set = transformation_cpu_features_t_get()->instruction_set;
+    return (uint32_t)instruction_set < limit ? instruction_set : (transformation_instruction_set_t)limit;
+}
+#endif
+
+static const char *const g_transformation_instruction_set_names[] = {
+#if defined(K4A_USING_SSE)
+    "SSE",
+    "AVX2",
+    "AVX512",
+#elif defined(K4A_USING_NEON)
+    "NEON",
+#else
+    "None",
+#endif
+};
+
+uint32_t transformation_get_instruction_set_count(void)
+{
+#if defined(K4A_USING_SSE)
+    return (uint32_t)transformation_cpu_features_t_get()->instruction_set + 1;
+#else
+    return 1;
+#endif
+}
+
+const char *transformation_get_instruction_set_name(uint32_t index)
+{
+    return index < transformation_get_instruction_set_count() ? g_transformation_instruction_set_names[index] : NULL;
+}
+
+k4a_result_t transformation_set_instruction_set_limit(uint32_t index)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, index >= transformation_get_instruction_set_count());
+#if defined(K4A_USING_SSE)
+    k4a_atomic_store(&g_transformation_instruction_set_limit, index);
+#endif
+    return K4A_RESULT_SUCCEEDED;
+}
+
 static k4a_transformation_image_descriptor_t
 transformation_init_image_descriptor(int width, int height, int stride, k4a_image_format_t format)
 {
@@ -116,6 +272,36 @@ static bool transformation_compare_image_descriptors(const k4a_transformation_im
     return true;
 }
 
+// Fills rect with the region of a width x height image roi covers, the whole image when roi is NULL. Fails when roi
+// is empty or not inside the image.
+static bool transformation_get_roi(const k4a_rect_t *roi, int width, int height, k4a_rect_t *rect)
+{
+    if (roi == NULL)
+    {
+        rect->x = 0;
+        rect->y = 0;
+        rect->width = width;
+        rect->height = height;
+        return true;
+    }
+
+    if (roi->width <= 0 || roi->height <= 0 || roi->x < 0 || roi->y < 0 || roi->x > width - roi->width ||
+        roi->y > height - roi->height)
+    {
+        LOG_ERROR("Region of interest %dx%d at (%d, %d) is not inside the %dx%d image.",
+                  roi->width,
+                  roi->height,
+                  roi->x,
+                  roi->y,
+                  width,
+                  height);
+        return false;
+    }
+
+    *rect = *roi;
+    return true;
+}
+
 static k4a_transformation_input_image_t
 transformation_init_input_image(const k4a_transformation_image_descriptor_t *descriptor, const uint8_t *data)
 {
@@ -147,6 +333,23 @@ static k4a_result_t transformation_compute_correspondence(const int depth_index,
         return K4A_RESULT_SUCCEEDED;
     }
 
+    if (context->ray_tables != NULL)
+    {
+        // The rotation is already applied to the rays, leaving a multiply-add per coordinate before the projection
+        const k4a_transformation_ray_tables_t *ray_tables = context->ray_tables;
+        float z = (float)depth;
+        k4a_float3_t color_point3d;
+        color_point3d.xyz.x = ray_tables->x_table[depth_index] * z + ray_tables->translation[0];
+        color_point3d.xyz.y = ray_tables->y_table[depth_index] * z + ray_tables->translation[1];
+        color_point3d.xyz.z = ray_tables->z_table[depth_index] * z + ray_tables->translation[2];
+        correspondence->depth = color_point3d.xyz.z;
+
+        return TRACE_CALL(transformation_project(&context->calibration->color_camera_calibration,
+                                                 color_point3d.v,
+                                                 correspondence->point2d.v,
+                                                 &correspondence->valid));
+    }
+
     k4a_float3_t depth_point3d;
     depth_point3d.xyz.z = (float)depth;
     depth_point3d.xyz.x = context->xy_tables->x_table[depth_index] * depth_point3d.xyz.z;
@@ -209,8 +412,7 @@ static k4a_bounding_box_t transformation_compute_bounding_box(const k4a_correspo
                                                               const k4a_correspondence_t *v2,
                                                               const k4a_correspondence_t *v3,
                                                               const k4a_correspondence_t *v4,
-                                                              int width,
-                                                              int height)
+                                                              const k4a_rect_t *roi)
 {
     k4a_bounding_box_t bounding_box;
 
@@ -219,10 +421,10 @@ static k4a_bounding_box_t transformation_compute_bounding_box(const k4a_correspo
     float x_max = transformation_max4f(v1->point2d.xy.x, v2->point2d.xy.x, v3->point2d.xy.x, v4->point2d.xy.x);
     float y_max = transformation_max4f(v1->point2d.xy.y, v2->point2d.xy.y, v3->point2d.xy.y, v4->point2d.xy.y);
 
-    bounding_box.top_left[0] = transformation_max2((int)(ceilf(x_min)), 0);
-    bounding_box.top_left[1] = transformation_max2((int)(ceilf(y_min)), 0);
-    bounding_box.bottom_right[0] = transformation_min2((int)(ceilf(x_max)), width);
-    bounding_box.bottom_right[1] = transformation_min2((int)(ceilf(y_max)), height);
+    bounding_box.top_left[0] = transformation_max2((int)(ceilf(x_min)), roi->x);
+    bounding_box.top_left[1] = transformation_max2((int)(ceilf(y_min)), roi->y);
+    bounding_box.bottom_right[0] = transformation_min2((int)(ceilf(x_max)), roi->x + roi->width);
+    bounding_box.bottom_right[1] = transformation_min2((int)(ceilf(y_max)), roi->y + roi->height);
 
     return bounding_box;
 }
@@ -255,19 +457,20 @@ static inline uint16_t transformation_interpolate_custom(const uint16_t *c1,
     return result;
 }
 
-static bool transformation_check_valid_correspondences(const k4a_correspondence_t *top_left,
-                                                       const k4a_correspondence_t *top_right,
-                                                       const k4a_correspondence_t *bottom_right,
-                                                       const k4a_correspondence_t *bottom_left,
-                                                       k4a_correspondence_t *valid_top_left,
-                                                       k4a_correspondence_t *valid_top_right,
-                                                       k4a_correspondence_t *valid_bottom_right,
-                                                       k4a_correspondence_t *valid_bottom_left,
-                                                       uint16_t *custom_top_left,
-                                                       uint16_t *custom_top_right,
-                                                       uint16_t *custom_bottom_right,
-                                                       uint16_t *custom_bottom_left,
-                                                       bool use_linear_interpolation)
+static FORCEINLINE bool transformation_check_valid_correspondences(const k4a_correspondence_t *top_left,
+                                                                   const k4a_correspondence_t *top_right,
+                                                                   const k4a_correspondence_t *bottom_right,
+                                                                   const k4a_correspondence_t *bottom_left,
+                                                                   k4a_correspondence_t *valid_top_left,
+                                                                   k4a_correspondence_t *valid_top_right,
+                                                                   k4a_correspondence_t *valid_bottom_right,
+                                                                   k4a_correspondence_t *valid_bottom_left,
+                                                                   uint16_t *custom_top_left,
+                                                                   uint16_t *custom_top_right,
+                                                                   uint16_t *custom_bottom_right,
+                                                                   uint16_t *custom_bottom_left,
+                                                                   uint32_t custom_count,
+                                                                   bool use_linear_interpolation)
 {
     *valid_top_left = *top_left;
     *valid_top_right = *top_right;
@@ -276,47 +479,60 @@ static bool transformation_check_valid_correspondences(const k4a_correspondence_
 
     // Check if a vertex is invalid and replace invalid ones with either existing
     // or interpolated vertices. Make sure the winding order of vertices stays clockwise.
+    // The custom values of each plane are replaced the same way.
     int num_invalid = 0;
 
     if (top_left->valid == 0)
     {
         num_invalid++;
         *valid_top_left = transformation_interpolate_correspondences(top_right, bottom_left);
-        *custom_top_left = transformation_interpolate_custom(custom_top_right,
-                                                             custom_bottom_left,
-                                                             custom_bottom_right,
-                                                             use_linear_interpolation);
+        for (uint32_t i = 0; i < custom_count; i++)
+        {
+            custom_top_left[i] = transformation_interpolate_custom(&custom_top_right[i],
+                                                                   &custom_bottom_left[i],
+                                                                   &custom_bottom_right[i],
+                                                                   use_linear_interpolation);
+        }
     }
     if (top_right->valid == 0)
     {
         num_invalid++;
         *valid_top_right = *bottom_right;
         *valid_bottom_right = transformation_interpolate_correspondences(bottom_right, bottom_left);
-        *custom_top_right = *custom_bottom_right;
-        *custom_bottom_right = transformation_interpolate_custom(custom_bottom_right,
-                                                                 custom_bottom_left,
-                                                                 custom_bottom_left,
-                                                                 use_linear_interpolation);
+        for (uint32_t i = 0; i < custom_count; i++)
+        {
+            custom_top_right[i] = custom_bottom_right[i];
+            custom_bottom_right[i] = transformation_interpolate_custom(&custom_bottom_right[i],
+                                                                       &custom_bottom_left[i],
+                                                                       &custom_bottom_left[i],
+                                                                       use_linear_interpolation);
+        }
     }
     if (bottom_right->valid == 0)
     {
         num_invalid++;
         *valid_bottom_right = transformation_interpolate_correspondences(top_right, bottom_left);
-        *custom_bottom_right = transformation_interpolate_custom(custom_top_right,
-                                                                 custom_bottom_left,
-                                                                 custom_top_left,
-                                                                 use_linear_interpolation);
+        for (uint32_t i = 0; i < custom_count; i++)
+        {
+            custom_bottom_right[i] = transformation_interpolate_custom(&custom_top_right[i],
+                                                                       &custom_bottom_left[i],
+                                                                       &custom_top_left[i],
+                                                                       use_linear_interpolation);
+        }
     }
     if (bottom_left->valid == 0)
     {
         num_invalid++;
         *valid_bottom_left = *bottom_right;
         *valid_bottom_right = transformation_interpolate_correspondences(top_right, bottom_right);
-        *custom_bottom_left = *custom_bottom_right;
-        *custom_bottom_right = transformation_interpolate_custom(custom_top_right,
-                                                                 custom_bottom_right,
-                                                                 custom_top_right,
-                                                                 use_linear_interpolation);
+        for (uint32_t i = 0; i < custom_count; i++)
+        {
+            custom_bottom_left[i] = custom_bottom_right[i];
+            custom_bottom_right[i] = transformation_interpolate_custom(&custom_top_right[i],
+                                                                       &custom_bottom_right[i],
+                                                                       &custom_top_right[i],
+                                                                       use_linear_interpolation);
+        }
     }
 
     // If two or more vertices are invalid then we can't create a valid triangle
@@ -355,18 +571,24 @@ static inline float transformation_area_function(const k4a_float2_t *a, const k4
     return (c->xy.y - a->xy.y) * (b->xy.x - a->xy.x) - (c->xy.x - a->xy.x) * (b->xy.y - a->xy.y);
 }
 
-static bool transformation_point_inside_triangle(const k4a_correspondence_t *valid_top_left,
-                                                 const k4a_correspondence_t *valid_intermediate,
-                                                 const k4a_correspondence_t *valid_bottom_right,
-                                                 uint16_t custom_top_left,
-                                                 uint16_t custom_intermediate,
-                                                 uint16_t custom_bottom_right,
-                                                 const k4a_float2_t *point,
-                                                 float area_intermediate,
-                                                 bool counter_clockwise,
-                                                 float *depth,
-                                                 float *custom,
-                                                 bool use_linear_interpolation)
+// Weights of the vertices of the triangle of a quad a point is inside of, from transformation_point_inside_quad()
+typedef struct _k4a_transformation_quad_weights_t
+{
+    float top_left;
+    float intermediate; // The bottom left vertex when intermediate_is_bottom_left, otherwise the top right one
+    float bottom_right;
+    float inverse_sum; // 1 over the sum of the weights, 0 if they sum to 0
+    bool intermediate_is_bottom_left;
+} k4a_transformation_quad_weights_t;
+
+static FORCEINLINE bool transformation_point_inside_triangle(const k4a_correspondence_t *valid_top_left,
+                                                             const k4a_correspondence_t *valid_intermediate,
+                                                             const k4a_correspondence_t *valid_bottom_right,
+                                                             const k4a_float2_t *point,
+                                                             float area_intermediate,
+                                                             bool counter_clockwise,
+                                                             float *depth,
+                                                             k4a_transformation_quad_weights_t *weights)
 {
     // Calculate sub triangle areas
     float area_top_left = transformation_area_function(&valid_intermediate->point2d, &valid_top_left->point2d, point);
@@ -398,24 +620,12 @@ static bool transformation_point_inside_triangle(const k4a_correspondence_t *val
                   area_bottom_right * valid_top_left->depth) *
                  sum_weights;
 
-        if (use_linear_interpolation)
-        {
-            *custom = (area_top_left * (float)custom_bottom_right + area_intermediate * (float)custom_intermediate +
-                       area_bottom_right * (float)custom_top_left) *
-                      sum_weights;
-        }
-        else
-        {
-            // Select custom based on highest weight (nearest neighbor)
-            if (area_top_left > area_intermediate)
-            {
-                *custom = area_top_left > area_bottom_right ? (float)custom_bottom_right : (float)custom_top_left;
-            }
-            else
-            {
-                *custom = area_intermediate > area_bottom_right ? (float)custom_intermediate : (float)custom_top_left;
-            }
-        }
+        // Each vertex is weighted by the area of the sub triangle opposite to it
+        weights->top_left = area_bottom_right;
+        weights->intermediate = area_intermediate;
+        weights->bottom_right = area_top_left;
+        weights->inverse_sum = sum_weights;
+        weights->intermediate_is_bottom_left = counter_clockwise;
 
         return true;
     }
@@ -423,18 +633,13 @@ static bool transformation_point_inside_triangle(const k4a_correspondence_t *val
     return false;
 }
 
-static bool transformation_point_inside_quad(const k4a_correspondence_t *valid_top_left,
-                                             const k4a_correspondence_t *valid_top_right,
-                                             const k4a_correspondence_t *valid_bottom_right,
-                                             const k4a_correspondence_t *valid_bottom_left,
-                                             uint16_t custom_top_left,
-                                             uint16_t custom_top_right,
-                                             uint16_t custom_bottom_right,
-                                             uint16_t custom_bottom_left,
-                                             const k4a_float2_t *point,
-                                             float *depth,
-                                             float *custom,
-                                             bool use_linear_interpolation)
+static FORCEINLINE bool transformation_point_inside_quad(const k4a_correspondence_t *valid_top_left,
+                                                         const k4a_correspondence_t *valid_top_right,
+                                                         const k4a_correspondence_t *valid_bottom_right,
+                                                         const k4a_correspondence_t *valid_bottom_left,
+                                                         const k4a_float2_t *point,
+                                                         float *depth,
+                                                         k4a_transformation_quad_weights_t *weights)
 {
     // Calculate area to see if point is to the left or right of vector (valid_top_left - valid_bottom_right).
     // Set counter_clockwise flag true for all positions to the right of the aforementioned vector.
@@ -447,83 +652,100 @@ static bool transformation_point_inside_quad(const k4a_correspondence_t *valid_t
     return transformation_point_inside_triangle(valid_top_left,
                                                 counter_clockwise ? valid_bottom_left : valid_top_right,
                                                 valid_bottom_right,
-                                                custom_top_left,
-                                                counter_clockwise ? custom_bottom_left : custom_top_right,
-                                                custom_bottom_right,
                                                 point,
                                                 area_intermediate,
                                                 counter_clockwise,
                                                 depth,
-                                                custom,
-                                                use_linear_interpolation);
-}
-
-static void transformation_draw_rectangle(const k4a_bounding_box_t *bounding_box,
-                                          const k4a_correspondence_t *valid_top_left,
-                                          const k4a_correspondence_t *valid_top_right,
-                                          const k4a_correspondence_t *valid_bottom_right,
-                                          const k4a_correspondence_t *valid_bottom_left,
-                                          uint16_t custom_top_left,
-                                          uint16_t custom_top_right,
-                                          uint16_t custom_bottom_right,
-                                          uint16_t custom_bottom_left,
-                                          bool use_linear_interpolation,
-                                          bool enable_custom8,
-                                          bool enable_custom16,
-                                          k4a_transformation_output_image_t *depth_out,
-                                          k4a_transformation_output_image_t *custom_out)
+                                                weights);
+}
+
+// Custom value of one plane at a point inside a quad
+static inline float transformation_interpolate_quad_custom(const k4a_transformation_quad_weights_t *weights,
+                                                           uint16_t custom_top_left,
+                                                           uint16_t custom_intermediate,
+                                                           uint16_t custom_bottom_right,
+                                                           bool use_linear_interpolation)
+{
+    if (use_linear_interpolation)
+    {
+        return (weights->bottom_right * (float)custom_bottom_right +
+                weights->intermediate * (float)custom_intermediate + weights->top_left * (float)custom_top_left) *
+               weights->inverse_sum;
+    }
+
+    // Select custom based on highest weight (nearest neighbor)
+    if (weights->bottom_right > weights->intermediate)
+    {
+        return weights->bottom_right > weights->top_left ? (float)custom_bottom_right : (float)custom_top_left;
+    }
+    return weights->intermediate > weights->top_left ? (float)custom_intermediate : (float)custom_top_left;
+}
+
+static FORCEINLINE void transformation_draw_rectangle(const k4a_bounding_box_t *bounding_box,
+                                                      const k4a_correspondence_t *valid_top_left,
+                                                      const k4a_correspondence_t *valid_top_right,
+                                                      const k4a_correspondence_t *valid_bottom_right,
+                                                      const k4a_correspondence_t *valid_bottom_left,
+                                                      const uint16_t *custom_top_left,
+                                                      const uint16_t *custom_top_right,
+                                                      const uint16_t *custom_bottom_right,
+                                                      const uint16_t *custom_bottom_left,
+                                                      uint32_t custom_count,
+                                                      bool use_linear_interpolation,
+                                                      bool enable_custom8,
+                                                      const k4a_rect_t *roi,
+                                                      k4a_transformation_output_image_t *depth_out,
+                                                      k4a_transformation_output_image_t *custom_out)
 {
+    // The bounding box is in color image coordinates, the outputs only hold roi
     k4a_float2_t point;
     for (int y = bounding_box->top_left[1]; y < bounding_box->bottom_right[1]; y++)
     {
-        uint16_t *depth_row = depth_out->data_uint16 + y * depth_out->descriptor->width_pixels;
-
-        uint8_t *custom8_row = 0;
-        uint16_t *custom16_row = 0;
-        if (enable_custom8)
-        {
-            custom8_row = custom_out->data_uint8 + y * custom_out->descriptor->width_pixels;
-        }
-        else if (enable_custom16)
-        {
-            custom16_row = custom_out->data_uint16 + y * custom_out->descriptor->width_pixels;
-        }
+        int row = y - roi->y;
+        uint16_t *depth_row = depth_out->data_uint16 + row * depth_out->descriptor->width_pixels;
 
         point.xy.y = (float)y;
 
         for (int x = bounding_box->top_left[0]; x < bounding_box->bottom_right[0]; x++)
         {
             point.xy.x = (float)x;
+            int column = x - roi->x;
 
             float interpolated_depth = 0.0f;
-            float interpolated_custom = 0.0f;
+            k4a_transformation_quad_weights_t weights;
             if (transformation_point_inside_quad(valid_top_left,
                                                  valid_top_right,
                                                  valid_bottom_right,
                                                  valid_bottom_left,
-                                                 custom_top_left,
-                                                 custom_top_right,
-                                                 custom_bottom_right,
-                                                 custom_bottom_left,
                                                  &point,
                                                  &interpolated_depth,
-                                                 &interpolated_custom,
-                                                 use_linear_interpolation))
+                                                 &weights))
             {
                 uint16_t depth = (uint16_t)(interpolated_depth + 0.5f);
 
                 // handle occlusions
-                if (depth_row[x] == 0 || (depth < depth_row[x]))
+                if (depth_row[column] == 0 || (depth < depth_row[column]))
                 {
-                    depth_row[x] = depth;
+                    depth_row[column] = depth;
 
-                    if (enable_custom8)
+                    const uint16_t *custom_intermediate = weights.intermediate_is_bottom_left ? custom_bottom_left :
+                                                                                                custom_top_right;
+                    for (uint32_t i = 0; i < custom_count; i++)
                     {
-                        custom8_row[x] = (uint8_t)(interpolated_custom + 0.5f);
-                    }
-                    else if (enable_custom16)
-                    {
-                        custom16_row[x] = (uint16_t)(interpolated_custom + 0.5f);
+                        float interpolated_custom = transformation_interpolate_quad_custom(&weights,
+                                                                                           custom_top_left[i],
+                                                                                           custom_intermediate[i],
+                                                                                           custom_bottom_right[i],
+                                                                                           use_linear_interpolation);
+                        int custom_index = row * custom_out[i].descriptor->width_pixels + column;
+                        if (enable_custom8)
+                        {
+                            custom_out[i].data_uint8[custom_index] = (uint8_t)(interpolated_custom + 0.5f);
+                        }
+                        else
+                        {
+                            custom_out[i].data_uint16[custom_index] = (uint16_t)(interpolated_custom + 0.5f);
+                        }
                     }
                 }
             }
@@ -531,204 +753,721 @@ static void transformation_draw_rectangle(const k4a_bounding_box_t *bounding_box
     }
 }
 
-static k4a_result_t transformation_depth_to_color(k4a_transformation_rgbz_context_t *context)
+#define K4A_TRANSFORMATION_MIN_BLOCK_SIZE 16 // Smaller blocks cost more to switch between than they save
+
+// Bytes of the transformed images each block of depth to color should cover, see
+// transformation_set_depth_to_color_block_cache_size(). Rows measured at least as fast up to 3072P, where the quads of
+// one depth row already fit in L2, so they stay the default.
+static volatile uint32_t g_transformation_block_cache_bytes = 0;
+
+void transformation_set_depth_to_color_block_cache_size(uint32_t cache_bytes)
 {
-    memset(context->transformed_image.data_uint8,
-           0,
-           (size_t)(context->transformed_image.descriptor->stride_bytes *
-                    context->transformed_image.descriptor->height_pixels));
+    k4a_atomic_store(&g_transformation_block_cache_bytes, cache_bytes);
+}
+
+// Edge of the square of depth pixels whose quads cover about cache_bytes of the transformed images. A depth pixel
+// spans the ratio of the focal lengths of the cameras in color pixels along each axis.
+static int transformation_depth_to_color_block_size(const k4a_transformation_rgbz_context_t *context)
+{
+    uint32_t cache_bytes = k4a_atomic_load(&g_transformation_block_cache_bytes);
+    if (cache_bytes == 0)
+    {
+        return 0;
+    }
+
+    const k4a_calibration_intrinsic_parameters_t *depth_parameters =
+        &context->calibration->depth_camera_calibration.intrinsics.parameters;
+    const k4a_calibration_intrinsic_parameters_t *color_parameters =
+        &context->calibration->color_camera_calibration.intrinsics.parameters;
+    float scale = transformation_max2f(color_parameters->param.fx / depth_parameters->param.fx,
+                                       color_parameters->param.fy / depth_parameters->param.fy);
 
+    float pixel_bytes = (float)sizeof(uint16_t);
     if (context->enable_custom8)
     {
-        int num_pixels = context->transformed_custom_image.descriptor->width_pixels *
-                         context->transformed_custom_image.descriptor->height_pixels;
-        for (int i = 0; i < num_pixels; i++)
-        {
-            context->transformed_custom_image.data_uint8[i] = (uint8_t)context->invalid_value;
-        }
+        pixel_bytes += (float)(sizeof(uint8_t) * context->custom_count);
     }
     else if (context->enable_custom16)
     {
-        int num_pixels = context->transformed_custom_image.descriptor->width_pixels *
-                         context->transformed_custom_image.descriptor->height_pixels;
-        for (int i = 0; i < num_pixels; i++)
-        {
-            context->transformed_custom_image.data_uint16[i] = context->invalid_value;
-        }
+        pixel_bytes += (float)(sizeof(uint16_t) * context->custom_count);
     }
 
-    bool use_linear_interpolation = context->interpolation_type == K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR;
+    float block_size = sqrtf((float)cache_bytes / pixel_bytes) / transformation_max2f(scale, 1.f);
+    return transformation_max2((int)block_size, K4A_TRANSFORMATION_MIN_BLOCK_SIZE);
+}
 
-    k4a_correspondence_t *vertex_row = (k4a_correspondence_t *)malloc(
-        (size_t)context->depth_image.descriptor->width_pixels * sizeof(k4a_correspondence_t));
+// Quads of the depth image between two rows, rendered by one thread of transformation_depth_to_color()
+typedef struct _k4a_transformation_rgbz_band_t
+{
+    const k4a_transformation_rgbz_context_t *context;
+    int y_begin; // First depth row used as the bottom edge of a quad, at least 1
+    int y_end;   // One past the last depth row used as the bottom edge of a quad
+    k4a_transformation_output_image_t transformed_image;
+    k4a_transformation_output_image_t transformed_custom_images[K4A_TRANSFORMATION_MAX_CUSTOM_PLANES];
+    int touched_top; // The band wrote rows [touched_top, touched_bottom) of transformed_image
+    int touched_bottom;
+    k4a_result_t result;
+} k4a_transformation_rgbz_band_t;
+
+// Only called with constant custom_count, use_linear_interpolation and enable_custom8 by the specializations of
+// K4A_TRANSFORMATION_DEPTH_TO_COLOR_BAND, which fold the plane, format and interpolation branches of every quad and
+// pixel out of their loops
+static FORCEINLINE k4a_result_t transformation_depth_to_color_band_generic(k4a_transformation_rgbz_band_t *band,
+                                                                          uint32_t custom_count,
+                                                                          bool use_linear_interpolation,
+                                                                          bool enable_custom8)
+{
+    const k4a_transformation_rgbz_context_t *context = band->context;
+    int width = context->depth_image.descriptor->width_pixels;
 
-    int idx = 0;
-    for (; idx < context->depth_image.descriptor->width_pixels; idx++)
+    // Without blocks the whole band is one block, rendered row after row
+    int block_rows = band->y_end - band->y_begin;
+    int block_columns = width - 1;
+    if (context->block_size > 0)
     {
-        if (K4A_FAILED(TRACE_CALL(transformation_compute_correspondence(
-                idx, context->depth_image.data_uint16[idx], context, vertex_row + idx))))
-        {
-            free(vertex_row);
-            return K4A_RESULT_FAILED;
-        }
+        block_rows = transformation_min2(block_rows, context->block_size);
+        block_columns = transformation_min2(block_columns, context->block_size);
+    }
+
+    // vertex_row holds the vertices of the last row rendered in each column, left_column and right_column those of the
+    // columns bordering the current block
+    size_t vertex_count = (size_t)width + 2 * (size_t)(block_rows + 1);
+    k4a_correspondence_t *vertex_row = (k4a_correspondence_t *)malloc(vertex_count * sizeof(k4a_correspondence_t));
+    if (vertex_row == NULL)
+    {
+        LOG_ERROR("Failed to allocate the correspondence row.", 0);
+        return K4A_RESULT_FAILED;
     }
+    k4a_correspondence_t *left_column = vertex_row + width;
+    k4a_correspondence_t *right_column = left_column + block_rows + 1;
 
-    for (int y = 1; y < context->depth_image.descriptor->height_pixels; y++)
+    int idx = (band->y_begin - 1) * width;
+    for (int x = 0; x < width; x++, idx++)
     {
-        k4a_correspondence_t top_left = vertex_row[0];
-        k4a_correspondence_t bottom_left;
         if (K4A_FAILED(TRACE_CALL(transformation_compute_correspondence(
-                idx, context->depth_image.data_uint16[idx], context, &bottom_left))))
+                idx, context->depth_image.data_uint16[idx], context, vertex_row + x))))
         {
             free(vertex_row);
             return K4A_RESULT_FAILED;
         }
-        idx++;
-        vertex_row[0] = bottom_left;
+    }
+
+    for (int block_y = band->y_begin; block_y < band->y_end; block_y += block_rows)
+    {
+        int block_y_end = transformation_min2(block_y + block_rows, band->y_end);
 
-        for (int x = 1; x < context->depth_image.descriptor->width_pixels; x++, idx++)
+        // The first block of the row starts at column 0
+        left_column[0] = vertex_row[0];
+        for (int y = block_y; y < block_y_end; y++)
         {
-            k4a_correspondence_t top_right = vertex_row[x];
-            k4a_correspondence_t bottom_right;
+            idx = y * width;
             if (K4A_FAILED(TRACE_CALL(transformation_compute_correspondence(
-                    idx, context->depth_image.data_uint16[idx], context, &bottom_right))))
+                    idx, context->depth_image.data_uint16[idx], context, &left_column[y - block_y + 1]))))
             {
                 free(vertex_row);
                 return K4A_RESULT_FAILED;
             }
+        }
+        vertex_row[0] = left_column[block_y_end - block_y];
 
-            uint16_t custom_top_left = 0;
-            uint16_t custom_top_right = 0;
-            uint16_t custom_bottom_right = 0;
-            uint16_t custom_bottom_left = 0;
+        for (int block_x = 1; block_x < width; block_x += block_columns)
+        {
+            int block_x_end = transformation_min2(block_x + block_columns, width);
+            right_column[0] = vertex_row[block_x_end - 1];
 
-            if (context->enable_custom8)
-            {
-                int custom_width = context->custom_image.descriptor->width_pixels;
-                custom_top_left = context->custom_image.data_uint8[(y - 1) * custom_width + x - 1];
-                custom_top_right = context->custom_image.data_uint8[(y - 1) * custom_width + x];
-                custom_bottom_right = context->custom_image.data_uint8[y * custom_width + x];
-                custom_bottom_left = context->custom_image.data_uint8[y * custom_width + x - 1];
-            }
-            else if (context->enable_custom16)
+            for (int y = block_y; y < block_y_end; y++)
             {
-                int custom_width = context->custom_image.descriptor->width_pixels;
-                custom_top_left = context->custom_image.data_uint16[(y - 1) * custom_width + x - 1];
-                custom_top_right = context->custom_image.data_uint16[(y - 1) * custom_width + x];
-                custom_bottom_right = context->custom_image.data_uint16[y * custom_width + x];
-                custom_bottom_left = context->custom_image.data_uint16[y * custom_width + x - 1];
-            }
+                k4a_correspondence_t top_left = left_column[y - block_y];
+                k4a_correspondence_t bottom_left = left_column[y - block_y + 1];
+                idx = y * width + block_x;
 
-            k4a_correspondence_t valid_top_left, valid_top_right, valid_bottom_right, valid_bottom_left;
-            if (transformation_check_valid_correspondences(&top_left,
-                                                           &top_right,
-                                                           &bottom_right,
-                                                           &bottom_left,
-                                                           &valid_top_left,
-                                                           &valid_top_right,
-                                                           &valid_bottom_right,
-                                                           &valid_bottom_left,
-                                                           &custom_top_left,
-                                                           &custom_top_right,
-                                                           &custom_bottom_right,
-                                                           &custom_bottom_left,
-                                                           use_linear_interpolation))
-            {
-                k4a_bounding_box_t bounding_box =
-                    transformation_compute_bounding_box(&valid_top_left,
-                                                        &valid_top_right,
-                                                        &valid_bottom_right,
-                                                        &valid_bottom_left,
-                                                        context->transformed_image.descriptor->width_pixels,
-                                                        context->transformed_image.descriptor->height_pixels);
-
-                transformation_draw_rectangle(&bounding_box,
-                                              &valid_top_left,
-                                              &valid_top_right,
-                                              &valid_bottom_right,
-                                              &valid_bottom_left,
-                                              custom_top_left,
-                                              custom_top_right,
-                                              custom_bottom_right,
-                                              custom_bottom_left,
-                                              use_linear_interpolation,
-                                              context->enable_custom8,
-                                              context->enable_custom16,
-                                              &context->transformed_image,
-                                              &context->transformed_custom_image);
+                for (int x = block_x; x < block_x_end; x++, idx++)
+                {
+                    k4a_correspondence_t top_right = vertex_row[x];
+                    k4a_correspondence_t bottom_right;
+                    if (K4A_FAILED(TRACE_CALL(transformation_compute_correspondence(
+                            idx, context->depth_image.data_uint16[idx], context, &bottom_right))))
+                    {
+                        free(vertex_row);
+                        return K4A_RESULT_FAILED;
+                    }
+
+                    uint16_t custom_top_left[K4A_TRANSFORMATION_MAX_CUSTOM_PLANES];
+                    uint16_t custom_top_right[K4A_TRANSFORMATION_MAX_CUSTOM_PLANES];
+                    uint16_t custom_bottom_right[K4A_TRANSFORMATION_MAX_CUSTOM_PLANES];
+                    uint16_t custom_bottom_left[K4A_TRANSFORMATION_MAX_CUSTOM_PLANES];
+
+                    for (uint32_t i = 0; i < custom_count; i++)
+                    {
+                        const k4a_transformation_input_image_t *custom_image = &context->custom_images[i];
+                        int custom_width = custom_image->descriptor->width_pixels;
+                        int top_index = (y - 1) * custom_width + x;
+                        int bottom_index = y * custom_width + x;
+                        if (enable_custom8)
+                        {
+                            custom_top_left[i] = custom_image->data_uint8[top_index - 1];
+                            custom_top_right[i] = custom_image->data_uint8[top_index];
+                            custom_bottom_right[i] = custom_image->data_uint8[bottom_index];
+                            custom_bottom_left[i] = custom_image->data_uint8[bottom_index - 1];
+                        }
+                        else
+                        {
+                            custom_top_left[i] = custom_image->data_uint16[top_index - 1];
+                            custom_top_right[i] = custom_image->data_uint16[top_index];
+                            custom_bottom_right[i] = custom_image->data_uint16[bottom_index];
+                            custom_bottom_left[i] = custom_image->data_uint16[bottom_index - 1];
+                        }
+                    }
+
+                    k4a_correspondence_t valid_top_left, valid_top_right, valid_bottom_right, valid_bottom_left;
+                    if (transformation_check_valid_correspondences(&top_left,
+                                                                   &top_right,
+                                                                   &bottom_right,
+                                                                   &bottom_left,
+                                                                   &valid_top_left,
+                                                                   &valid_top_right,
+                                                                   &valid_bottom_right,
+                                                                   &valid_bottom_left,
+                                                                   custom_top_left,
+                                                                   custom_top_right,
+                                                                   custom_bottom_right,
+                                                                   custom_bottom_left,
+                                                                   custom_count,
+                                                                   use_linear_interpolation))
+                    {
+                        k4a_bounding_box_t bounding_box =
+                            transformation_compute_bounding_box(&valid_top_left,
+                                                                &valid_top_right,
+                                                                &valid_bottom_right,
+                                                                &valid_bottom_left,
+                                                                &context->roi);
+
+                        transformation_draw_rectangle(&bounding_box,
+                                                      &valid_top_left,
+                                                      &valid_top_right,
+                                                      &valid_bottom_right,
+                                                      &valid_bottom_left,
+                                                      custom_top_left,
+                                                      custom_top_right,
+                                                      custom_bottom_right,
+                                                      custom_bottom_left,
+                                                      custom_count,
+                                                      use_linear_interpolation,
+                                                      enable_custom8,
+                                                      &context->roi,
+                                                      &band->transformed_image,
+                                                      band->transformed_custom_images);
+
+                        if (bounding_box.top_left[1] < bounding_box.bottom_right[1])
+                        {
+                            int top = bounding_box.top_left[1] - context->roi.y;
+                            int bottom = bounding_box.bottom_right[1] - context->roi.y;
+                            band->touched_top = transformation_min2(band->touched_top, top);
+                            band->touched_bottom = transformation_max2(band->touched_bottom, bottom);
+                        }
+                    }
+
+                    vertex_row[x] = bottom_right;
+                    top_left = top_right;
+                    bottom_left = bottom_right;
+                }
+                right_column[y - block_y + 1] = bottom_left;
             }
 
-            vertex_row[x] = bottom_right;
-            top_left = top_right;
-            bottom_left = bottom_right;
+            // The right border of this block is the left border of the next one
+            k4a_correspondence_t *column = left_column;
+            left_column = right_column;
+            right_column = column;
         }
     }
     free(vertex_row);
     return K4A_RESULT_SUCCEEDED;
 }
 
-k4a_buffer_result_t transformation_depth_image_to_color_camera_validate_parameters(
-    const k4a_calibration_t *calibration,
-    const k4a_transformation_xy_tables_t *xy_tables_depth_camera,
-    const uint8_t *depth_image_data,
-    const k4a_transformation_image_descriptor_t *depth_image_descriptor,
-    const uint8_t *custom_image_data,
-    const k4a_transformation_image_descriptor_t *custom_image_descriptor,
-    uint8_t *transformed_depth_image_data,
-    k4a_transformation_image_descriptor_t *transformed_depth_image_descriptor,
-    uint8_t *transformed_custom_image_data,
-    k4a_transformation_image_descriptor_t *transformed_custom_image_descriptor)
+typedef k4a_result_t (*k4a_transformation_depth_to_color_band_t)(k4a_transformation_rgbz_band_t *band);
+
+// Defines a specialization of transformation_depth_to_color_band_generic(). Without custom planes custom_count is
+// folded to 0, so the plane loops disappear along with the format and interpolation branches.
+#define K4A_TRANSFORMATION_DEPTH_TO_COLOR_BAND(name, has_custom, use_linear_interpolation, enable_custom8)             \
+    static k4a_result_t name(k4a_transformation_rgbz_band_t *band)                                                     \
+    {                                                                                                                  \
+        return transformation_depth_to_color_band_generic(band,                                                        \
+                                                          (has_custom) ? band->context->custom_count : 0,              \
+                                                          use_linear_interpolation,                                    \
+                                                          enable_custom8);                                             \
+    }
+
+K4A_TRANSFORMATION_DEPTH_TO_COLOR_BAND(transformation_depth_to_color_band_depth, false, false, false)
+K4A_TRANSFORMATION_DEPTH_TO_COLOR_BAND(transformation_depth_to_color_band_custom8_nearest, true, false, true)
+K4A_TRANSFORMATION_DEPTH_TO_COLOR_BAND(transformation_depth_to_color_band_custom8_linear, true, true, true)
+K4A_TRANSFORMATION_DEPTH_TO_COLOR_BAND(transformation_depth_to_color_band_custom16_nearest, true, false, false)
+K4A_TRANSFORMATION_DEPTH_TO_COLOR_BAND(transformation_depth_to_color_band_custom16_linear, true, true, false)
+
+// Specialization of transformation_depth_to_color_band_generic() for the planes and interpolation of a call
+static k4a_transformation_depth_to_color_band_t
+transformation_select_depth_to_color_band(const k4a_transformation_rgbz_context_t *context)
 {
-    if (depth_image_descriptor == 0 || custom_image_descriptor == 0 || transformed_depth_image_descriptor == 0 ||
-        transformed_custom_image_descriptor == 0)
+    bool use_linear_interpolation = context->interpolation_type == K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR;
+    if (context->custom_count == 0)
     {
-        return K4A_BUFFER_RESULT_FAILED;
+        return transformation_depth_to_color_band_depth;
     }
-
-    if (calibration == 0)
+    if (context->enable_custom8)
     {
-        LOG_ERROR("Calibration is null.", 0);
-        return K4A_BUFFER_RESULT_FAILED;
+        return use_linear_interpolation ? transformation_depth_to_color_band_custom8_linear :
+                                          transformation_depth_to_color_band_custom8_nearest;
     }
+    return use_linear_interpolation ? transformation_depth_to_color_band_custom16_linear :
+                                      transformation_depth_to_color_band_custom16_nearest;
+}
 
-    if (xy_tables_depth_camera == 0)
+// Color camera points of count depth pixels from depth_index for the splatting modes. The rays are those
+// transformation_compute_correspondence() uses, points of invalid depth pixels are 0 so they do not project.
+static void transformation_splat_points_c(const k4a_transformation_rgbz_context_t *context,
+                                          int depth_index,
+                                          int count,
+                                          float *point3d)
+{
+    const k4a_calibration_extrinsics_t *extrinsics =
+        &context->calibration->extrinsics[K4A_CALIBRATION_TYPE_DEPTH][K4A_CALIBRATION_TYPE_COLOR];
+    const float *R = extrinsics->rotation;
+    const float *t = extrinsics->translation;
+
+    for (int i = 0; i < count; i++)
     {
-        LOG_ERROR("Depth camera xy table is null.", 0);
-        return K4A_BUFFER_RESULT_FAILED;
+        int idx = depth_index + i;
+        float x = context->xy_tables->x_table[idx];
+        float y = context->xy_tables->y_table[idx];
+        float z = (float)context->depth_image.data_uint16[idx];
+        float *point = point3d + 3 * i;
+        if (z == 0.f || isnan(x))
+        {
+            point[0] = 0.f;
+            point[1] = 0.f;
+            point[2] = 0.f;
+            continue;
+        }
+
+        if (context->ray_tables != NULL)
+        {
+            point[0] = context->ray_tables->x_table[idx] * z + t[0];
+            point[1] = context->ray_tables->y_table[idx] * z + t[1];
+            point[2] = context->ray_tables->z_table[idx] * z + t[2];
+        }
+        else
+        {
+            point[0] = (R[0] * x + R[1] * y + R[2]) * z + t[0];
+            point[1] = (R[3] * x + R[4] * y + R[5]) * z + t[1];
+            point[2] = (R[6] * x + R[7] * y + R[8]) * z + t[2];
+        }
     }
+}
 
-    if (depth_image_data == 0)
+#if defined(K4A_USING_SSE)
+// transformation_splat_points_c() for 4 depth pixels at a time, returns how many were computed. point3d must have room
+// for one float past the points, each group of 4 is transposed into place with overlapping stores.
+static int transformation_splat_points_sse(const k4a_transformation_rgbz_context_t *context,
+                                           int depth_index,
+                                           int count,
+                                           float *point3d)
+{
+    const k4a_calibration_extrinsics_t *extrinsics =
+        &context->calibration->extrinsics[K4A_CALIBRATION_TYPE_DEPTH][K4A_CALIBRATION_TYPE_COLOR];
+    const float *R = extrinsics->rotation;
+    const __m128 t0 = _mm_set1_ps(extrinsics->translation[0]);
+    const __m128 t1 = _mm_set1_ps(extrinsics->translation[1]);
+    const __m128 t2 = _mm_set1_ps(extrinsics->translation[2]);
+    const __m128 zero = _mm_setzero_ps();
+
+    const uint16_t *depth = context->depth_image.data_uint16;
+    const float *x_table = context->xy_tables->x_table;
+    const float *y_table = context->xy_tables->y_table;
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
     {
-        LOG_ERROR("Depth image data is null.", 0);
-        return K4A_BUFFER_RESULT_FAILED;
+        int idx = depth_index + i;
+        __m128 x = _mm_loadu_ps(x_table + idx);
+        __m128 y = _mm_loadu_ps(y_table + idx);
+        __m128i depth_u16 = _mm_loadl_epi64((const __m128i *)(const void *)(depth + idx));
+        __m128 z = _mm_cvtepi32_ps(_mm_unpacklo_epi16(depth_u16, _mm_setzero_si128()));
+        __m128 valid = _mm_and_ps(_mm_cmpneq_ps(z, zero), _mm_cmpord_ps(x, x));
+
+        __m128 ray_x, ray_y, ray_z;
+        if (context->ray_tables != NULL)
+        {
+            ray_x = _mm_loadu_ps(context->ray_tables->x_table + idx);
+            ray_y = _mm_loadu_ps(context->ray_tables->y_table + idx);
+            ray_z = _mm_loadu_ps(context->ray_tables->z_table + idx);
+        }
+        else
+        {
+            ray_x = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(R[0]), x), _mm_mul_ps(_mm_set1_ps(R[1]), y)),
+                               _mm_set1_ps(R[2]));
+            ray_y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(R[3]), x), _mm_mul_ps(_mm_set1_ps(R[4]), y)),
+                               _mm_set1_ps(R[5]));
+            ray_z = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(R[6]), x), _mm_mul_ps(_mm_set1_ps(R[7]), y)),
+                               _mm_set1_ps(R[8]));
+        }
+
+        __m128 point_x = _mm_and_ps(_mm_add_ps(_mm_mul_ps(ray_x, z), t0), valid);
+        __m128 point_y = _mm_and_ps(_mm_add_ps(_mm_mul_ps(ray_y, z), t1), valid);
+        __m128 point_z = _mm_and_ps(_mm_add_ps(_mm_mul_ps(ray_z, z), t2), valid);
+        __m128 point_w = zero;
+        _MM_TRANSPOSE4_PS(point_x, point_y, point_z, point_w);
+
+        float *point = point3d + 3 * i;
+        _mm_storeu_ps(point, point_x);
+        _mm_storeu_ps(point + 3, point_y);
+        _mm_storeu_ps(point + 6, point_z);
+        _mm_storeu_ps(point + 9, point_w);
     }
+    return i;
+}
+#endif
 
-    if (transformed_depth_image_data == 0)
+// Writes the projection of each valid point of a depth row to the nearest color pixel, or the 2x2 color pixels around
+// it, keeping the closest depth
+static void transformation_splat_row(k4a_transformation_rgbz_band_t *band,
+                                     int y,
+                                     const float *point3d,
+                                     const float *point2d,
+                                     const int *valid)
+{
+    const k4a_transformation_rgbz_context_t *context = band->context;
+    const k4a_rect_t *roi = &context->roi;
+    int width = context->depth_image.descriptor->width_pixels;
+    int transformed_width = band->transformed_image.descriptor->width_pixels;
+    int size = context->mode == K4A_TRANSFORMATION_DEPTH_TO_COLOR_MODE_SPLAT_2X2 ? 2 : 1;
+
+    // The nearest pixel rounds the point, 2x2 splats start at the pixel above and left of it
+    float offset = size == 1 ? 0.5f : 0.f;
+
+    for (int x = 0; x < width; x++)
     {
-        LOG_ERROR("Transformed depth image data is null.", 0);
-        return K4A_BUFFER_RESULT_FAILED;
+        if (!valid[x])
+        {
+            continue;
+        }
+
+        uint16_t depth = (uint16_t)(point3d[3 * x + 2] + 0.5f);
+
+        int left = (int)floorf(point2d[2 * x] + offset) - roi->x;
+        int top = (int)floorf(point2d[2 * x + 1] + offset) - roi->y;
+        int column_begin = transformation_max2(left, 0);
+        int column_end = transformation_min2(left + size, roi->width);
+        int row_begin = transformation_max2(top, 0);
+        int row_end = transformation_min2(top + size, roi->height);
+        if (column_begin >= column_end || row_begin >= row_end)
+        {
+            continue;
+        }
+
+        for (int row = row_begin; row < row_end; row++)
+        {
+            uint16_t *depth_row = band->transformed_image.data_uint16 + row * transformed_width;
+            for (int column = column_begin; column < column_end; column++)
+            {
+                if (depth_row[column] == 0 || depth < depth_row[column])
+                {
+                    depth_row[column] = depth;
+                    for (uint32_t i = 0; i < context->custom_count; i++)
+                    {
+                        int custom_index = y * context->custom_images[i].descriptor->width_pixels + x;
+                        int transformed_index = row * band->transformed_custom_images[i].descriptor->width_pixels +
+                                                column;
+                        if (context->enable_custom8)
+                        {
+                            band->transformed_custom_images[i].data_uint8[transformed_index] =
+                                context->custom_images[i].data_uint8[custom_index];
+                        }
+                        else
+                        {
+                            band->transformed_custom_images[i].data_uint16[transformed_index] =
+                                context->custom_images[i].data_uint16[custom_index];
+                        }
+                    }
+                }
+            }
+        }
+        band->touched_top = transformation_min2(band->touched_top, row_begin);
+        band->touched_bottom = transformation_max2(band->touched_bottom, row_end);
     }
+}
 
-    if (transformed_custom_image_data != 0 && custom_image_data == 0)
+// Splats the depth pixels of a band, the rows of its quads and, for the first band, row 0 above them
+static k4a_result_t transformation_depth_to_color_splat_band(k4a_transformation_rgbz_band_t *band)
+{
+    const k4a_transformation_rgbz_context_t *context = band->context;
+    int width = context->depth_image.descriptor->width_pixels;
+
+    // One float past the points for transformation_splat_points_sse()
+    size_t point3d_count = 3 * (size_t)width + 1;
+    size_t point2d_count = 2 * (size_t)width;
+    float *points = (float *)malloc((point3d_count + point2d_count) * sizeof(float));
+    int *valid = (int *)malloc((size_t)width * sizeof(int));
+    if (points == NULL || valid == NULL)
     {
-        LOG_ERROR("Custom image data is null.", 0);
-        return K4A_BUFFER_RESULT_FAILED;
+        LOG_ERROR("Failed to allocate the splatted points.", 0);
+        free(points);
+        free(valid);
+        return K4A_RESULT_FAILED;
     }
+    float *point3d = points;
+    float *point2d = points + point3d_count;
 
-    if (custom_image_data != 0 && transformed_custom_image_data == 0)
+    k4a_result_t result = K4A_RESULT_SUCCEEDED;
+    for (int y = band->y_begin == 1 ? 0 : band->y_begin; y < band->y_end && K4A_SUCCEEDED(result); y++)
     {
-        LOG_ERROR("Transformed custom image data is null.", 0);
-        return K4A_BUFFER_RESULT_FAILED;
+        int idx = y * width;
+        int x = 0;
+#if defined(K4A_USING_SSE)
+        x = transformation_splat_points_sse(context, idx, width, point3d);
+#endif
+        transformation_splat_points_c(context, idx + x, width - x, point3d + 3 * x);
+
+        result = TRACE_CALL(transformation_project_batch(
+            &context->calibration->color_camera_calibration, point3d, (size_t)width, point2d, valid));
+        if (K4A_SUCCEEDED(result))
+        {
+            transformation_splat_row(band, y, point3d, point2d, valid);
+        }
     }
 
-    k4a_transformation_image_descriptor_t expected_depth_image_descriptor =
-        transformation_init_image_descriptor(calibration->depth_camera_calibration.resolution_width,
-                                             calibration->depth_camera_calibration.resolution_height,
-                                             calibration->depth_camera_calibration.resolution_width *
-                                                 (int)sizeof(uint16_t),
-                                             K4A_IMAGE_FORMAT_DEPTH16);
+    free(points);
+    free(valid);
+    return result;
+}
 
-    if (transformation_compare_image_descriptors(depth_image_descriptor, &expected_depth_image_descriptor) == false)
+static void transformation_depth_to_color_band_task(void *context, uint32_t index)
+{
+    k4a_transformation_rgbz_band_t *band = (k4a_transformation_rgbz_band_t *)context + index;
+    if (band->context->mode == K4A_TRANSFORMATION_DEPTH_TO_COLOR_MODE_QUADS)
+    {
+        k4a_transformation_depth_to_color_band_t render = transformation_select_depth_to_color_band(band->context);
+        band->result = TRACE_CALL(render(band));
+    }
+    else
+    {
+        band->result = TRACE_CALL(transformation_depth_to_color_splat_band(band));
+    }
+}
+
+// Folds a band rendered into its own buffers into the output. Bands are merged in row order and only replace strictly
+// closer pixels, which keeps the first quad to reach the smallest depth, as rendering every quad in order would.
+static void transformation_depth_to_color_merge_band(const k4a_transformation_rgbz_context_t *context,
+                                                     const k4a_transformation_rgbz_band_t *band)
+{
+    int width = context->transformed_image.descriptor->width_pixels;
+    for (int y = band->touched_top; y < band->touched_bottom; y++)
+    {
+        const uint16_t *band_depth_row = band->transformed_image.data_uint16 + y * width;
+        uint16_t *depth_row = context->transformed_image.data_uint16 + y * width;
+        for (int x = 0; x < width; x++)
+        {
+            uint16_t depth = band_depth_row[x];
+            if (depth != 0 && (depth_row[x] == 0 || depth < depth_row[x]))
+            {
+                depth_row[x] = depth;
+                for (uint32_t i = 0; i < context->custom_count; i++)
+                {
+                    int custom_index = y * context->transformed_custom_images[i].descriptor->width_pixels + x;
+                    if (context->enable_custom8)
+                    {
+                        context->transformed_custom_images[i].data_uint8[custom_index] =
+                            band->transformed_custom_images[i].data_uint8[custom_index];
+                    }
+                    else
+                    {
+                        context->transformed_custom_images[i].data_uint16[custom_index] =
+                            band->transformed_custom_images[i].data_uint16[custom_index];
+                    }
+                }
+            }
+        }
+    }
+}
+
+static k4a_result_t transformation_depth_to_color(k4a_transformation_rgbz_context_t *context)
+{
+    memset(context->transformed_image.data_uint8,
+           0,
+           (size_t)(context->transformed_image.descriptor->stride_bytes *
+                    context->transformed_image.descriptor->height_pixels));
+
+    for (uint32_t plane = 0; plane < context->custom_count; plane++)
+    {
+        k4a_transformation_output_image_t *transformed_custom_image = &context->transformed_custom_images[plane];
+        int num_pixels = transformed_custom_image->descriptor->width_pixels *
+                         transformed_custom_image->descriptor->height_pixels;
+        if (context->enable_custom8)
+        {
+            memset(transformed_custom_image->data_uint8, (uint8_t)context->invalid_value, (size_t)num_pixels);
+        }
+        else
+        {
+            for (int i = 0; i < num_pixels; i++)
+            {
+                transformed_custom_image->data_uint16[i] = context->invalid_value;
+            }
+        }
+    }
+
+    // Each band needs at least one row of quads
+    int quad_rows = context->depth_image.descriptor->height_pixels - 1;
+    int band_count = (int)context->thread_count;
+    if (band_count > quad_rows)
+    {
+        band_count = quad_rows;
+    }
+    if (band_count < 1)
+    {
+        band_count = 1;
+    }
+
+    k4a_transformation_rgbz_band_t bands[K4A_TRANSFORMATION_MAX_THREAD_COUNT];
+    k4a_result_t result = K4A_RESULT_SUCCEEDED;
+
+    size_t transformed_pixels = (size_t)context->transformed_image.descriptor->width_pixels *
+                                (size_t)context->transformed_image.descriptor->height_pixels;
+    size_t custom_pixel_size = context->enable_custom16 ? sizeof(uint16_t) : sizeof(uint8_t);
+
+    for (int i = 0; i < band_count; i++)
+    {
+        k4a_transformation_rgbz_band_t *band = &bands[i];
+        memset(band, 0, sizeof(*band));
+        band->context = context;
+        band->y_begin = 1 + (int)((int64_t)quad_rows * i / band_count);
+        band->y_end = 1 + (int)((int64_t)quad_rows * (i + 1) / band_count);
+        band->touched_top = INT_MAX;
+        band->touched_bottom = 0;
+        band->result = K4A_RESULT_FAILED;
+
+        // The first band renders straight into the output, the others into their own zeroed buffers that are merged
+        // afterwards
+        band->transformed_image = context->transformed_image;
+        memcpy(band->transformed_custom_images,
+               context->transformed_custom_images,
+               context->custom_count * sizeof(k4a_transformation_output_image_t));
+        if (i != 0)
+        {
+            band->transformed_image.data_uint8 = NULL;
+            band->transformed_image.data_uint16 = NULL;
+            for (uint32_t plane = 0; plane < context->custom_count; plane++)
+            {
+                band->transformed_custom_images[plane].data_uint8 = NULL;
+                band->transformed_custom_images[plane].data_uint16 = NULL;
+            }
+        }
+
+        if (i != 0 && K4A_SUCCEEDED(result))
+        {
+            band->transformed_image.data_uint8 = (uint8_t *)calloc(transformed_pixels, sizeof(uint16_t));
+            band->transformed_image.data_uint16 = (uint16_t *)(void *)band->transformed_image.data_uint8;
+            result = K4A_RESULT_FROM_BOOL(band->transformed_image.data_uint8 != NULL);
+
+            // All custom planes of a band share one allocation, owned by the first plane
+            if (K4A_SUCCEEDED(result) && context->custom_count > 0)
+            {
+                size_t plane_size = transformed_pixels * custom_pixel_size;
+                uint8_t *custom_data = (uint8_t *)malloc(plane_size * context->custom_count);
+                result = K4A_RESULT_FROM_BOOL(custom_data != NULL);
+                for (uint32_t plane = 0; plane < context->custom_count && K4A_SUCCEEDED(result); plane++)
+                {
+                    band->transformed_custom_images[plane].data_uint8 = custom_data + plane * plane_size;
+                    band->transformed_custom_images[plane].data_uint16 =
+                        (uint16_t *)(void *)band->transformed_custom_images[plane].data_uint8;
+                }
+            }
+        }
+    }
+
+    // Bands run on the SDK thread pool alongside the calling thread
+    if (K4A_SUCCEEDED(result))
+    {
+        threadpool_parallel_for(transformation_depth_to_color_band_task, bands, (uint32_t)band_count);
+        for (int i = 0; i < band_count && K4A_SUCCEEDED(result); i++)
+        {
+            result = bands[i].result;
+        }
+    }
+
+    for (int i = 1; i < band_count; i++)
+    {
+        if (K4A_SUCCEEDED(result))
+        {
+            transformation_depth_to_color_merge_band(context, &bands[i]);
+        }
+        free(bands[i].transformed_image.data_uint8);
+        free(bands[i].transformed_custom_images[0].data_uint8);
+    }
+
+    return result;
+}
+
+k4a_buffer_result_t transformation_depth_image_to_color_camera_validate_parameters(
+    const k4a_calibration_t *calibration,
+    const k4a_transformation_xy_tables_t *xy_tables_depth_camera,
+    const uint8_t *depth_image_data,
+    const k4a_transformation_image_descriptor_t *depth_image_descriptor,
+    const uint8_t *custom_image_data,
+    const k4a_transformation_image_descriptor_t *custom_image_descriptor,
+    uint8_t *transformed_depth_image_data,
+    k4a_transformation_image_descriptor_t *transformed_depth_image_descriptor,
+    uint8_t *transformed_custom_image_data,
+    k4a_transformation_image_descriptor_t *transformed_custom_image_descriptor,
+    const k4a_rect_t *roi)
+{
+    if (depth_image_descriptor == 0 || custom_image_descriptor == 0 || transformed_depth_image_descriptor == 0 ||
+        transformed_custom_image_descriptor == 0)
+    {
+        return K4A_BUFFER_RESULT_FAILED;
+    }
+
+    if (calibration == 0)
+    {
+        LOG_ERROR("Calibration is null.", 0);
+        return K4A_BUFFER_RESULT_FAILED;
+    }
+
+    if (xy_tables_depth_camera == 0)
+    {
+        LOG_ERROR("Depth camera xy table is null.", 0);
+        return K4A_BUFFER_RESULT_FAILED;
+    }
+
+    if (depth_image_data == 0)
+    {
+        LOG_ERROR("Depth image data is null.", 0);
+        return K4A_BUFFER_RESULT_FAILED;
+    }
+
+    if (transformed_depth_image_data == 0)
+    {
+        LOG_ERROR("Transformed depth image data is null.", 0);
+        return K4A_BUFFER_RESULT_FAILED;
+    }
+
+    if (transformed_custom_image_data != 0 && custom_image_data == 0)
+    {
+        LOG_ERROR("Custom image data is null.", 0);
+        return K4A_BUFFER_RESULT_FAILED;
+    }
+
+    if (custom_image_data != 0 && transformed_custom_image_data == 0)
+    {
+        LOG_ERROR("Transformed custom image data is null.", 0);
+        return K4A_BUFFER_RESULT_FAILED;
+    }
+
+    k4a_transformation_image_descriptor_t expected_depth_image_descriptor =
+        transformation_init_image_descriptor(calibration->depth_camera_calibration.resolution_width,
+                                             calibration->depth_camera_calibration.resolution_height,
+                                             calibration->depth_camera_calibration.resolution_width *
+                                                 (int)sizeof(uint16_t),
+                                             K4A_IMAGE_FORMAT_DEPTH16);
+
+    if (transformation_compare_image_descriptors(depth_image_descriptor, &expected_depth_image_descriptor) == false)
     {
         LOG_ERROR("Unexpected depth image descriptor, see details above.", 0);
         return K4A_BUFFER_RESULT_FAILED;
@@ -756,11 +1495,19 @@ k4a_buffer_result_t transformation_depth_image_to_color_camera_validate_paramete
         return K4A_BUFFER_RESULT_FAILED;
     }
 
+    k4a_rect_t rect;
+    if (!transformation_get_roi(roi,
+                                calibration->color_camera_calibration.resolution_width,
+                                calibration->color_camera_calibration.resolution_height,
+                                &rect))
+    {
+        return K4A_BUFFER_RESULT_FAILED;
+    }
+
     k4a_transformation_image_descriptor_t expected_transformed_depth_image_descriptor =
-        transformation_init_image_descriptor(calibration->color_camera_calibration.resolution_width,
-                                             calibration->color_camera_calibration.resolution_height,
-                                             calibration->color_camera_calibration.resolution_width *
-                                                 (int)sizeof(uint16_t),
+        transformation_init_image_descriptor(rect.width,
+                                             rect.height,
+                                             rect.width * (int)sizeof(uint16_t),
                                              K4A_IMAGE_FORMAT_DEPTH16);
 
     if (transformation_compare_image_descriptors(transformed_depth_image_descriptor,
@@ -771,10 +1518,9 @@ k4a_buffer_result_t transformation_depth_image_to_color_camera_validate_paramete
     }
 
     k4a_transformation_image_descriptor_t expected_transformed_custom_image_descriptor =
-        transformation_init_image_descriptor(calibration->color_camera_calibration.resolution_width,
-                                             calibration->color_camera_calibration.resolution_height,
-                                             calibration->color_camera_calibration.resolution_width *
-                                                 custom_bytes_per_pixel,
+        transformation_init_image_descriptor(rect.width,
+                                             rect.height,
+                                             rect.width * custom_bytes_per_pixel,
                                              custom_format);
 
     if (transformed_custom_image_data != 0 &&
@@ -791,62 +1537,92 @@ k4a_buffer_result_t transformation_depth_image_to_color_camera_validate_paramete
 k4a_buffer_result_t transformation_depth_image_to_color_camera_internal(
     const k4a_calibration_t *calibration,
     const k4a_transformation_xy_tables_t *xy_tables_depth_camera,
+    const k4a_transformation_ray_tables_t *ray_tables_depth_camera,
     const uint8_t *depth_image_data,
     const k4a_transformation_image_descriptor_t *depth_image_descriptor,
-    const uint8_t *custom_image_data,
+    const uint8_t *const *custom_images_data,
     const k4a_transformation_image_descriptor_t *custom_image_descriptor,
     uint8_t *transformed_depth_image_data,
     k4a_transformation_image_descriptor_t *transformed_depth_image_descriptor,
-    uint8_t *transformed_custom_image_data,
+    uint8_t *const *transformed_custom_images_data,
     k4a_transformation_image_descriptor_t *transformed_custom_image_descriptor,
+    uint32_t custom_image_count,
     k4a_transformation_interpolation_type_t interpolation_type,
-    uint32_t invalid_custom_value)
+    uint32_t invalid_custom_value,
+    k4a_transformation_depth_to_color_mode_t mode,
+    uint32_t thread_count,
+    const k4a_rect_t *roi)
 {
-    if (K4A_BUFFER_RESULT_SUCCEEDED !=
-        TRACE_BUFFER_CALL(
-            transformation_depth_image_to_color_camera_validate_parameters(calibration,
-                                                                           xy_tables_depth_camera,
-                                                                           depth_image_data,
-                                                                           depth_image_descriptor,
-                                                                           custom_image_data,
-                                                                           custom_image_descriptor,
-                                                                           transformed_depth_image_data,
-                                                                           transformed_depth_image_descriptor,
-                                                                           transformed_custom_image_data,
-                                                                           transformed_custom_image_descriptor)))
+    if (custom_image_count > K4A_TRANSFORMATION_MAX_CUSTOM_PLANES ||
+        (custom_image_count > 0 && (custom_images_data == NULL || transformed_custom_images_data == NULL)))
     {
+        LOG_ERROR("Invalid custom image planes.", 0);
         return K4A_BUFFER_RESULT_FAILED;
     }
 
+    // Every plane shares the custom descriptors, only the data pointers differ. Without planes only the depth
+    // images are checked.
+    for (uint32_t plane = 0; plane < (custom_image_count > 0 ? custom_image_count : 1); plane++)
+    {
+        if (K4A_BUFFER_RESULT_SUCCEEDED !=
+            TRACE_BUFFER_CALL(transformation_depth_image_to_color_camera_validate_parameters(
+                calibration,
+                xy_tables_depth_camera,
+                depth_image_data,
+                depth_image_descriptor,
+                custom_image_count > 0 ? custom_images_data[plane] : NULL,
+                custom_image_descriptor,
+                transformed_depth_image_data,
+                transformed_depth_image_descriptor,
+                custom_image_count > 0 ? transformed_custom_images_data[plane] : NULL,
+                transformed_custom_image_descriptor,
+                roi)))
+        {
+            return K4A_BUFFER_RESULT_FAILED;
+        }
+    }
+
     k4a_transformation_rgbz_context_t context;
     memset(&context, 0, sizeof(k4a_transformation_rgbz_context_t));
 
     context.xy_tables = xy_tables_depth_camera;
+    context.ray_tables = ray_tables_depth_camera;
     context.calibration = calibration;
 
     context.depth_image = transformation_init_input_image(depth_image_descriptor, depth_image_data);
 
-    context.custom_image = transformation_init_input_image(custom_image_descriptor, custom_image_data);
+    for (uint32_t plane = 0; plane < custom_image_count; plane++)
+    {
+        context.custom_images[plane] = transformation_init_input_image(custom_image_descriptor,
+                                                                       custom_images_data[plane]);
+        context.transformed_custom_images[plane] = transformation_init_output_image(
+            transformed_custom_image_descriptor, transformed_custom_images_data[plane]);
+    }
+    context.custom_count = custom_image_count;
 
     context.transformed_image = transformation_init_output_image(transformed_depth_image_descriptor,
                                                                  transformed_depth_image_data);
 
-    context.transformed_custom_image = transformation_init_output_image(transformed_custom_image_descriptor,
-                                                                        transformed_custom_image_data);
-
     context.enable_custom8 = false;
     context.enable_custom16 = false;
-    if (custom_image_descriptor->format == K4A_IMAGE_FORMAT_CUSTOM8)
+    if (custom_image_count > 0 && custom_image_descriptor->format == K4A_IMAGE_FORMAT_CUSTOM8)
     {
         context.enable_custom8 = true;
     }
-    else if (custom_image_descriptor->format == K4A_IMAGE_FORMAT_CUSTOM16)
+    else if (custom_image_count > 0 && custom_image_descriptor->format == K4A_IMAGE_FORMAT_CUSTOM16)
     {
         context.enable_custom16 = true;
     }
 
     context.interpolation_type = interpolation_type;
     context.invalid_value = (uint16_t)(invalid_custom_value & 0xffff);
+    context.mode = mode;
+    context.thread_count = thread_count;
+    context.block_size = transformation_depth_to_color_block_size(&context);
+    transformation_get_roi(roi,
+                           calibration->color_camera_calibration.resolution_width,
+                           calibration->color_camera_calibration.resolution_height,
+                           &context.roi);
 
     if (K4A_FAILED(TRACE_CALL(transformation_depth_to_color(&context))))
     {
@@ -855,7 +1631,7 @@ k4a_buffer_result_t transformation_depth_image_to_color_camera_internal(
     return K4A_BUFFER_RESULT_SUCCEEDED;
 }
 
-static inline int transformation_point_inside_image(int width, int height, k4a_float2_t *point2d)
+static inline int transformation_point_inside_image(int width, int height, const k4a_float2_t *point2d)
 {
     int point_floor[2];
     point_floor[0] = (int)(floorf(point2d->xy.x));
@@ -867,7 +1643,8 @@ static inline int transformation_point_inside_image(int width, int height, k4a_f
     return 1;
 }
 
-static inline uint8_t transformation_bilinear_interpolation(const uint8_t *image, int stride, k4a_float2_t *point2d)
+static inline uint8_t
+transformation_bilinear_interpolation(const uint8_t *image, int stride, const k4a_float2_t *point2d)
 {
     int point_floor[2];
     point_floor[0] = (int)(floorf(point2d->xy.x));
@@ -893,125 +1670,805 @@ static inline uint8_t transformation_bilinear_interpolation(const uint8_t *image
     return (uint8_t)(interpol_y + 0.5f);
 }
 
-static k4a_result_t transformation_color_to_depth(k4a_transformation_rgbz_context_t *context)
+// Writes the bilinear blend of the 4 BGRA pixels around each correspondence of a row, or 0 for correspondences that
+// are not valid or not inside the color image
+static void transformation_bilinear_bgra_row_c(const uint8_t *image,
+                                               int stride,
+                                               int width,
+                                               int height,
+                                               const k4a_correspondence_t *correspondences,
+                                               int count,
+                                               uint8_t *bgra)
 {
-    memset(context->transformed_image.data_uint8,
-           0,
-           (size_t)(context->transformed_image.descriptor->stride_bytes *
-                    context->transformed_image.descriptor->height_pixels));
-
-    for (int idx = 0;
-         idx < context->depth_image.descriptor->width_pixels * context->depth_image.descriptor->height_pixels;
-         idx++)
+    for (int i = 0; i < count; i++, bgra += 4)
     {
-        k4a_correspondence_t correspondence;
-        if (K4A_FAILED(TRACE_CALL(transformation_compute_correspondence(
-                idx, context->depth_image.data_uint16[idx], context, &correspondence))))
+        const k4a_correspondence_t *correspondence = &correspondences[i];
+        if (!correspondence->valid || !transformation_point_inside_image(width, height, &correspondence->point2d))
         {
-            return K4A_RESULT_FAILED;
+            bgra[0] = bgra[1] = bgra[2] = bgra[3] = 0;
+            continue;
         }
 
-        if (correspondence.valid && transformation_point_inside_image(context->color_image.descriptor->width_pixels,
-                                                                      context->color_image.descriptor->height_pixels,
-                                                                      &correspondence.point2d))
+        uint8_t b = transformation_bilinear_interpolation(image, stride, &correspondence->point2d);
+        uint8_t g = transformation_bilinear_interpolation(image + 1, stride, &correspondence->point2d);
+        uint8_t r = transformation_bilinear_interpolation(image + 2, stride, &correspondence->point2d);
+        uint8_t alpha = transformation_bilinear_interpolation(image + 3, stride, &correspondence->point2d);
+
+        // bgra = (0,0,0,0) is used to indicate that the bgra pixel is invalid. A valid bgra pixel with values
+        // (0,0,0,0) is mapped to (1,0,0,0) to express that it is valid and very close to black.
+        if (b == 0 && g == 0 && r == 0 && alpha == 0)
         {
-            uint8_t b = transformation_bilinear_interpolation(context->color_image.data_uint8,
-                                                              context->color_image.descriptor->stride_bytes,
-                                                              &correspondence.point2d);
+            b++;
+        }
 
-            uint8_t g = transformation_bilinear_interpolation(context->color_image.data_uint8 + 1,
-                                                              context->color_image.descriptor->stride_bytes,
-                                                              &correspondence.point2d);
+        bgra[0] = b;
+        bgra[1] = g;
+        bgra[2] = r;
+        bgra[3] = alpha;
+    }
+}
 
-            uint8_t r = transformation_bilinear_interpolation(context->color_image.data_uint8 + 2,
-                                                              context->color_image.descriptor->stride_bytes,
-                                                              &correspondence.point2d);
+// The vector versions of transformation_bilinear_bgra_row_c() blend all 4 channels of several pixels at once with the
+// same float operations in the same order, so the results are identical. Each returns the number of leading
+// correspondences it converted and leaves the rest of the row to transformation_bilinear_bgra_row_c(). Correspondences
+// that are not inside the color image read the top left pixels, so the image must be at least 2x2.
+#if defined(K4A_USING_SSE)
+// Blends one channel of BGRA pixels packed in 32 bit lanes
+static inline __m128i transformation_bilinear_channel_sse(__m128i top_left,
+                                                          __m128i top_right,
+                                                          __m128i bottom_left,
+                                                          __m128i bottom_right,
+                                                          int channel,
+                                                          __m128 fractional_x,
+                                                          __m128 fractional_y)
+{
+    __m128i shift = _mm_cvtsi32_si128(8 * channel);
+    __m128i mask = _mm_set1_epi32(0xff);
+    __m128 one = _mm_set1_ps(1.f);
+
+    __m128 vals_0 = _mm_cvtepi32_ps(_mm_and_si128(_mm_srl_epi32(top_left, shift), mask));
+    __m128 vals_1 = _mm_cvtepi32_ps(_mm_and_si128(_mm_srl_epi32(top_right, shift), mask));
+    __m128 vals_2 = _mm_cvtepi32_ps(_mm_and_si128(_mm_srl_epi32(bottom_left, shift), mask));
+    __m128 vals_3 = _mm_cvtepi32_ps(_mm_and_si128(_mm_srl_epi32(bottom_right, shift), mask));
+
+    __m128 inverse_x = _mm_sub_ps(one, fractional_x);
+    __m128 interpol_x_0 = _mm_add_ps(_mm_mul_ps(inverse_x, vals_0), _mm_mul_ps(fractional_x, vals_1));
+    __m128 interpol_x_1 = _mm_add_ps(_mm_mul_ps(inverse_x, vals_2), _mm_mul_ps(fractional_x, vals_3));
+    __m128 interpol_y = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(one, fractional_y), interpol_x_0),
+                                   _mm_mul_ps(fractional_y, interpol_x_1));
+
+    __m128i value = _mm_cvttps_epi32(_mm_add_ps(interpol_y, _mm_set1_ps(0.5f)));
+    return _mm_sll_epi32(value, shift);
+}
 
-            uint8_t alpha = transformation_bilinear_interpolation(context->color_image.data_uint8 + 3,
-                                                                  context->color_image.descriptor->stride_bytes,
-                                                                  &correspondence.point2d);
+static int transformation_bilinear_bgra_row_sse(const uint8_t *image,
+                                                int stride,
+                                                int width,
+                                                int height,
+                                                const k4a_correspondence_t *correspondences,
+                                                int count,
+                                                uint8_t *bgra)
+{
+    if (width < 2 || height < 2)
+    {
+        return 0;
+    }
 
-            // bgra = (0,0,0,0) is used to indicate that the bgra pixel is invalid. A valid bgra pixel with values
-            // (0,0,0,0) is mapped to (1,0,0,0) to express that it is valid and very close to black.
-            if (b == 0 && g == 0 && r == 0 && alpha == 0)
-            {
-                b++;
-            }
+    __m128 max_x = _mm_set1_ps((float)(width - 1));
+    __m128 max_y = _mm_set1_ps((float)(height - 1));
+    int i = 0;
 
-            context->transformed_image.data_uint8[4 * idx + 0] = b;
-            context->transformed_image.data_uint8[4 * idx + 1] = g;
-            context->transformed_image.data_uint8[4 * idx + 2] = r;
-            context->transformed_image.data_uint8[4 * idx + 3] = alpha;
+    for (; i + 4 <= count; i += 4)
+    {
+        // point2d x, point2d y, depth and valid of 4 correspondences
+        __m128 x = _mm_loadu_ps((const float *)&correspondences[i]);
+        __m128 y = _mm_loadu_ps((const float *)&correspondences[i + 1]);
+        __m128 depth = _mm_loadu_ps((const float *)&correspondences[i + 2]);
+        __m128 valid = _mm_loadu_ps((const float *)&correspondences[i + 3]);
+        _MM_TRANSPOSE4_PS(x, y, depth, valid);
+
+        // Same test as transformation_point_inside_image(), NAN fails every comparison
+        __m128 floor_x = _mm_floor_ps(x);
+        __m128 floor_y = _mm_floor_ps(y);
+        __m128 inside = _mm_and_ps(_mm_cmpge_ps(floor_x, _mm_setzero_ps()), _mm_cmpge_ps(floor_y, _mm_setzero_ps()));
+        inside = _mm_and_ps(inside, _mm_and_ps(_mm_cmplt_ps(floor_x, max_x), _mm_cmplt_ps(floor_y, max_y)));
+        __m128i not_valid = _mm_cmpeq_epi32(_mm_castps_si128(valid), _mm_setzero_si128());
+        inside = _mm_andnot_ps(_mm_castsi128_ps(not_valid), inside);
+
+        __m128 fractional_x = _mm_sub_ps(x, floor_x);
+        __m128 fractional_y = _mm_sub_ps(y, floor_y);
+        __m128i top_left_x = _mm_cvttps_epi32(_mm_and_ps(floor_x, inside));
+        __m128i top_left_y = _mm_cvttps_epi32(_mm_and_ps(floor_y, inside));
+        __m128i offset = _mm_add_epi32(_mm_mullo_epi32(top_left_y, _mm_set1_epi32(stride)),
+                                       _mm_slli_epi32(top_left_x, 2));
+
+        int32_t offsets[4];
+        _mm_storeu_si128((__m128i *)offsets, offset);
+
+        // Each 64 bit load holds the left and right pixel of a pair
+        __m128i top_01 = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)(image + offsets[0])),
+                                            _mm_loadl_epi64((const __m128i *)(image + offsets[1])));
+        __m128i top_23 = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)(image + offsets[2])),
+                                            _mm_loadl_epi64((const __m128i *)(image + offsets[3])));
+        __m128i bottom_01 = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)(image + offsets[0] + stride)),
+                                               _mm_loadl_epi64((const __m128i *)(image + offsets[1] + stride)));
+        __m128i bottom_23 = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)(image + offsets[2] + stride)),
+                                               _mm_loadl_epi64((const __m128i *)(image + offsets[3] + stride)));
+
+        __m128i top_left = _mm_castps_si128(
+            _mm_shuffle_ps(_mm_castsi128_ps(top_01), _mm_castsi128_ps(top_23), _MM_SHUFFLE(2, 0, 2, 0)));
+        __m128i top_right = _mm_castps_si128(
+            _mm_shuffle_ps(_mm_castsi128_ps(top_01), _mm_castsi128_ps(top_23), _MM_SHUFFLE(3, 1, 3, 1)));
+        __m128i bottom_left = _mm_castps_si128(
+            _mm_shuffle_ps(_mm_castsi128_ps(bottom_01), _mm_castsi128_ps(bottom_23), _MM_SHUFFLE(2, 0, 2, 0)));
+        __m128i bottom_right = _mm_castps_si128(
+            _mm_shuffle_ps(_mm_castsi128_ps(bottom_01), _mm_castsi128_ps(bottom_23), _MM_SHUFFLE(3, 1, 3, 1)));
+
+        __m128i result = _mm_setzero_si128();
+        for (int channel = 0; channel < 4; channel++)
+        {
+            __m128i value = transformation_bilinear_channel_sse(
+                top_left, top_right, bottom_left, bottom_right, channel, fractional_x, fractional_y);
+            result = _mm_or_si128(result, value);
         }
+
+        // Valid black (0,0,0,0) becomes (1,0,0,0), since (0,0,0,0) marks invalid pixels
+        result = _mm_add_epi32(result, _mm_and_si128(_mm_cmpeq_epi32(result, _mm_setzero_si128()), _mm_set1_epi32(1)));
+        result = _mm_and_si128(result, _mm_castps_si128(inside));
+        _mm_storeu_si128((__m128i *)(bgra + 4 * i), result);
     }
-    return K4A_RESULT_SUCCEEDED;
+    return i;
 }
 
-k4a_buffer_result_t transformation_color_image_to_depth_camera_validate_parameters(
-    const k4a_calibration_t *calibration,
-    const k4a_transformation_xy_tables_t *xy_tables_depth_camera,
-    const uint8_t *depth_image_data,
-    const k4a_transformation_image_descriptor_t *depth_image_descriptor,
-    const uint8_t *color_image_data,
-    const k4a_transformation_image_descriptor_t *color_image_descriptor,
-    uint8_t *transformed_color_image_data,
-    k4a_transformation_image_descriptor_t *transformed_color_image_descriptor)
+K4A_TARGET_AVX2 static inline __m256i transformation_bilinear_channel_avx2(__m256i top_left,
+                                                                           __m256i top_right,
+                                                                           __m256i bottom_left,
+                                                                           __m256i bottom_right,
+                                                                           int channel,
+                                                                           __m256 fractional_x,
+                                                                           __m256 fractional_y)
 {
-    if (transformed_color_image_descriptor == 0 || calibration == 0)
+    __m128i shift = _mm_cvtsi32_si128(8 * channel);
+    __m256i mask = _mm256_set1_epi32(0xff);
+    __m256 one = _mm256_set1_ps(1.f);
+
+    __m256 vals_0 = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srl_epi32(top_left, shift), mask));
+    __m256 vals_1 = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srl_epi32(top_right, shift), mask));
+    __m256 vals_2 = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srl_epi32(bottom_left, shift), mask));
+    __m256 vals_3 = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srl_epi32(bottom_right, shift), mask));
+
+    __m256 inverse_x = _mm256_sub_ps(one, fractional_x);
+    __m256 interpol_x_0 = _mm256_add_ps(_mm256_mul_ps(inverse_x, vals_0), _mm256_mul_ps(fractional_x, vals_1));
+    __m256 interpol_x_1 = _mm256_add_ps(_mm256_mul_ps(inverse_x, vals_2), _mm256_mul_ps(fractional_x, vals_3));
+    __m256 interpol_y = _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(one, fractional_y), interpol_x_0),
+                                      _mm256_mul_ps(fractional_y, interpol_x_1));
+
+    __m256i value = _mm256_cvttps_epi32(_mm256_add_ps(interpol_y, _mm256_set1_ps(0.5f)));
+    return _mm256_sll_epi32(value, shift);
+}
+
+K4A_TARGET_AVX2 static int transformation_bilinear_bgra_row_avx2(const uint8_t *image,
+                                                                 int stride,
+                                                                 int width,
+                                                                 int height,
+                                                                 const k4a_correspondence_t *correspondences,
+                                                                 int count,
+                                                                 uint8_t *bgra)
+{
+    if (width < 2 || height < 2)
     {
-        if (calibration == 0)
+        return 0;
+    }
+
+    __m256 max_x = _mm256_set1_ps((float)(width - 1));
+    __m256 max_y = _mm256_set1_ps((float)(height - 1));
+    // The transpose below leaves correspondences in the order 0, 2, 4, 6, 1, 3, 5, 7
+    __m256i pixel_order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    int i = 0;
+
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 rows_01 = _mm256_loadu_ps((const float *)&correspondences[i]);
+        __m256 rows_23 = _mm256_loadu_ps((const float *)&correspondences[i + 2]);
+        __m256 rows_45 = _mm256_loadu_ps((const float *)&correspondences[i + 4]);
+        __m256 rows_67 = _mm256_loadu_ps((const float *)&correspondences[i + 6]);
+        __m256 xy_0123 = _mm256_unpacklo_ps(rows_01, rows_23);
+        __m256 xy_4567 = _mm256_unpacklo_ps(rows_45, rows_67);
+        __m256 valid_0123 = _mm256_unpackhi_ps(rows_01, rows_23);
+        __m256 valid_4567 = _mm256_unpackhi_ps(rows_45, rows_67);
+        __m256 x = _mm256_shuffle_ps(xy_0123, xy_4567, _MM_SHUFFLE(1, 0, 1, 0));
+        __m256 y = _mm256_shuffle_ps(xy_0123, xy_4567, _MM_SHUFFLE(3, 2, 3, 2));
+        __m256 valid = _mm256_shuffle_ps(valid_0123, valid_4567, _MM_SHUFFLE(3, 2, 3, 2));
+
+        // Same test as transformation_point_inside_image(), NAN fails every comparison
+        __m256 floor_x = _mm256_floor_ps(x);
+        __m256 floor_y = _mm256_floor_ps(y);
+        __m256 inside = _mm256_and_ps(_mm256_cmp_ps(floor_x, _mm256_setzero_ps(), _CMP_GE_OQ),
+                                      _mm256_cmp_ps(floor_y, _mm256_setzero_ps(), _CMP_GE_OQ));
+        inside = _mm256_and_ps(inside,
+                               _mm256_and_ps(_mm256_cmp_ps(floor_x, max_x, _CMP_LT_OQ),
+                                             _mm256_cmp_ps(floor_y, max_y, _CMP_LT_OQ)));
+        __m256i not_valid = _mm256_cmpeq_epi32(_mm256_castps_si256(valid), _mm256_setzero_si256());
+        inside = _mm256_andnot_ps(_mm256_castsi256_ps(not_valid), inside);
+
+        __m256 fractional_x = _mm256_sub_ps(x, floor_x);
+        __m256 fractional_y = _mm256_sub_ps(y, floor_y);
+        __m256i top_left_x = _mm256_cvttps_epi32(_mm256_and_ps(floor_x, inside));
+        __m256i top_left_y = _mm256_cvttps_epi32(_mm256_and_ps(floor_y, inside));
+        __m256i offset = _mm256_add_epi32(_mm256_mullo_epi32(top_left_y, _mm256_set1_epi32(stride)),
+                                          _mm256_slli_epi32(top_left_x, 2));
+
+        __m256i top_left = _mm256_i32gather_epi32((const int *)image, offset, 1);
+        __m256i top_right = _mm256_i32gather_epi32((const int *)(image + 4), offset, 1);
+        __m256i bottom_left = _mm256_i32gather_epi32((const int *)(image + stride), offset, 1);
+        __m256i bottom_right = _mm256_i32gather_epi32((const int *)(image + stride + 4), offset, 1);
+
+        __m256i result = _mm256_setzero_si256();
+        for (int channel = 0; channel < 4; channel++)
         {
-            LOG_ERROR("Calibration is null.", 0);
+            __m256i value = transformation_bilinear_channel_avx2(
+                top_left, top_right, bottom_left, bottom_right, channel, fractional_x, fractional_y);
+            result = _mm256_or_si256(result, value);
         }
-        return K4A_BUFFER_RESULT_FAILED;
+
+        // Valid black (0,0,0,0) becomes (1,0,0,0), since (0,0,0,0) marks invalid pixels
+        __m256i black = _mm256_cmpeq_epi32(result, _mm256_setzero_si256());
+        result = _mm256_add_epi32(result, _mm256_and_si256(black, _mm256_set1_epi32(1)));
+        result = _mm256_and_si256(result, _mm256_castps_si256(inside));
+        result = _mm256_permutevar8x32_epi32(result, pixel_order);
+        _mm256_storeu_si256((__m256i *)(bgra + 4 * i), result);
     }
+    return i;
+}
 
-    k4a_transformation_image_descriptor_t expected_transformed_color_image_descriptor =
-        transformation_init_image_descriptor(calibration->depth_camera_calibration.resolution_width,
-                                             calibration->depth_camera_calibration.resolution_height,
-                                             calibration->depth_camera_calibration.resolution_width * 4 *
-                                                 (int)sizeof(uint8_t),
-                                             K4A_IMAGE_FORMAT_COLOR_BGRA32);
+#elif defined(K4A_USING_NEON)
+static inline uint32x4_t transformation_bilinear_channel_neon(uint32x4_t top_left,
+                                                              uint32x4_t top_right,
+                                                              uint32x4_t bottom_left,
+                                                              uint32x4_t bottom_right,
+                                                              int channel,
+                                                              float32x4_t fractional_x,
+                                                              float32x4_t fractional_y)
+{
+    int32x4_t shift_right = vdupq_n_s32(-8 * channel);
+    uint32x4_t mask = vdupq_n_u32(0xff);
+    float32x4_t one = vdupq_n_f32(1.f);
+
+    float32x4_t vals_0 = vcvtq_f32_u32(vandq_u32(vshlq_u32(top_left, shift_right), mask));
+    float32x4_t vals_1 = vcvtq_f32_u32(vandq_u32(vshlq_u32(top_right, shift_right), mask));
+    float32x4_t vals_2 = vcvtq_f32_u32(vandq_u32(vshlq_u32(bottom_left, shift_right), mask));
+    float32x4_t vals_3 = vcvtq_f32_u32(vandq_u32(vshlq_u32(bottom_right, shift_right), mask));
+
+    float32x4_t inverse_x = vsubq_f32(one, fractional_x);
+    float32x4_t interpol_x_0 = vaddq_f32(vmulq_f32(inverse_x, vals_0), vmulq_f32(fractional_x, vals_1));
+    float32x4_t interpol_x_1 = vaddq_f32(vmulq_f32(inverse_x, vals_2), vmulq_f32(fractional_x, vals_3));
+    float32x4_t interpol_y = vaddq_f32(vmulq_f32(vsubq_f32(one, fractional_y), interpol_x_0),
+                                       vmulq_f32(fractional_y, interpol_x_1));
+
+    // convert from float to int using NEON is round to zero, like the cast in the scalar code
+    uint32x4_t value = vcvtq_u32_f32(vaddq_f32(interpol_y, vdupq_n_f32(0.5f)));
+    return vshlq_u32(value, vdupq_n_s32(8 * channel));
+}
 
-    if (transformed_color_image_data == 0 ||
-        transformation_compare_image_descriptors(transformed_color_image_descriptor,
-                                                 &expected_transformed_color_image_descriptor) == false)
+static int transformation_bilinear_bgra_row_neon(const uint8_t *image,
+                                                 int stride,
+                                                 int width,
+                                                 int height,
+                                                 const k4a_correspondence_t *correspondences,
+                                                 int count,
+                                                 uint8_t *bgra)
+{
+    if (width < 2 || height < 2)
     {
-        if (transformed_color_image_data == 0)
+        return 0;
+    }
+
+    float32x4_t max_x = vdupq_n_f32((float)(width - 1));
+    float32x4_t max_y = vdupq_n_f32((float)(height - 1));
+    int i = 0;
+
+    for (; i + 4 <= count; i += 4)
+    {
+        // deinterleaves point2d x, point2d y, depth and valid of 4 correspondences
+        float32x4x4_t fields = vld4q_f32((const float *)&correspondences[i]);
+        float32x4_t x = fields.val[0];
+        float32x4_t y = fields.val[1];
+        uint32x4_t valid = vreinterpretq_u32_f32(fields.val[3]);
+
+        // Same test as transformation_point_inside_image(), NAN fails every comparison
+        float32x4_t floor_x = vrndmq_f32(x);
+        float32x4_t floor_y = vrndmq_f32(y);
+        uint32x4_t inside = vandq_u32(vcgeq_f32(floor_x, vdupq_n_f32(0.f)), vcgeq_f32(floor_y, vdupq_n_f32(0.f)));
+        inside = vandq_u32(inside, vandq_u32(vcltq_f32(floor_x, max_x), vcltq_f32(floor_y, max_y)));
+        inside = vbicq_u32(inside, vceqq_u32(valid, vdupq_n_u32(0)));
+
+        float32x4_t fractional_x = vsubq_f32(x, floor_x);
+        float32x4_t fractional_y = vsubq_f32(y, floor_y);
+        int32x4_t top_left_x = vcvtq_s32_f32(vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(floor_x), inside)));
+        int32x4_t top_left_y = vcvtq_s32_f32(vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(floor_y), inside)));
+        int32x4_t offset = vaddq_s32(vmulq_n_s32(top_left_y, stride), vshlq_n_s32(top_left_x, 2));
+
+        int32_t offsets[4];
+        vst1q_s32(offsets, offset);
+
+        uint32_t pixels[4][4];
+        for (int lane = 0; lane < 4; lane++)
         {
-            LOG_ERROR("Transformed color image data is null.", 0);
+            const uint8_t *top = image + offsets[lane];
+            memcpy(&pixels[0][lane], top, sizeof(uint32_t));
+            memcpy(&pixels[1][lane], top + 4, sizeof(uint32_t));
+            memcpy(&pixels[2][lane], top + stride, sizeof(uint32_t));
+            memcpy(&pixels[3][lane], top + stride + 4, sizeof(uint32_t));
         }
-        else
+        uint32x4_t top_left = vld1q_u32(pixels[0]);
+        uint32x4_t top_right = vld1q_u32(pixels[1]);
+        uint32x4_t bottom_left = vld1q_u32(pixels[2]);
+        uint32x4_t bottom_right = vld1q_u32(pixels[3]);
+
+        uint32x4_t result = vdupq_n_u32(0);
+        for (int channel = 0; channel < 4; channel++)
         {
-            LOG_ERROR("Unexpected transformed color image descriptor, see details above.", 0);
+            uint32x4_t value = transformation_bilinear_channel_neon(
+                top_left, top_right, bottom_left, bottom_right, channel, fractional_x, fractional_y);
+            result = vorrq_u32(result, value);
         }
-        return K4A_BUFFER_RESULT_TOO_SMALL;
+
+        // Valid black (0,0,0,0) becomes (1,0,0,0), since (0,0,0,0) marks invalid pixels
+        result = vaddq_u32(result, vandq_u32(vceqq_u32(result, vdupq_n_u32(0)), vdupq_n_u32(1)));
+        result = vandq_u32(result, inside);
+        vst1q_u8(bgra + 4 * i, vreinterpretq_u8_u32(result));
     }
+    return i;
+}
+#endif
 
-    if (xy_tables_depth_camera == 0 || depth_image_data == 0 || depth_image_descriptor == 0 || color_image_data == 0 ||
-        color_image_descriptor == 0 || transformed_color_image_data == 0)
+// Fixed point versions of the blend, see transformation_set_fixed_point_bilinear(). The fractional position is rounded
+// to K4A_TRANSFORMATION_BILINEAR_FRACTION_BITS bits, the horizontal blends are exact in 16 bits and the vertical blend
+// rounds their 32 bit sum back to 8 bits. Integer arithmetic gives the same result on every CPU, within 1 of the float
+// blend in every channel.
+#define K4A_TRANSFORMATION_BILINEAR_FRACTION_BITS 8
+#define K4A_TRANSFORMATION_BILINEAR_ONE (1 << K4A_TRANSFORMATION_BILINEAR_FRACTION_BITS)
+
+static inline int transformation_bilinear_fixed_weight(float fractional)
+{
+    return (int)(fractional * (float)K4A_TRANSFORMATION_BILINEAR_ONE + 0.5f);
+}
+
+static void transformation_bilinear_bgra_row_fixed_c(const uint8_t *image,
+                                                     int stride,
+                                                     int width,
+                                                     int height,
+                                                     const k4a_correspondence_t *correspondences,
+                                                     int count,
+                                                     uint8_t *bgra)
+{
+    for (int i = 0; i < count; i++, bgra += 4)
     {
-        if (xy_tables_depth_camera == 0)
+        const k4a_correspondence_t *correspondence = &correspondences[i];
+        if (!correspondence->valid || !transformation_point_inside_image(width, height, &correspondence->point2d))
         {
-            LOG_ERROR("Depth camera xy table is null.", 0);
-        }
-        if (depth_image_data == 0)
-        {
-            LOG_ERROR("Depth image data is null.", 0);
+            bgra[0] = bgra[1] = bgra[2] = bgra[3] = 0;
+            continue;
         }
-        if (color_image_data == 0)
+
+        float floor_x = floorf(correspondence->point2d.xy.x);
+        float floor_y = floorf(correspondence->point2d.xy.y);
+        uint32_t weight_x = (uint32_t)transformation_bilinear_fixed_weight(correspondence->point2d.xy.x - floor_x);
+        uint32_t weight_y = (uint32_t)transformation_bilinear_fixed_weight(correspondence->point2d.xy.y - floor_y);
+        const uint8_t *top = image + (int)floor_y * stride + 4 * (int)floor_x;
+        const uint8_t *bottom = top + stride;
+
+        for (int channel = 0; channel < 4; channel++)
         {
-            LOG_ERROR("Color image data is null.", 0);
+            uint32_t interpol_x_0 = top[channel] * (K4A_TRANSFORMATION_BILINEAR_ONE - weight_x) +
+                                    top[channel + 4] * weight_x;
+            uint32_t interpol_x_1 = bottom[channel] * (K4A_TRANSFORMATION_BILINEAR_ONE - weight_x) +
+                                    bottom[channel + 4] * weight_x;
+            uint32_t interpol_y = interpol_x_0 * (K4A_TRANSFORMATION_BILINEAR_ONE - weight_y) + interpol_x_1 * weight_y;
+            bgra[channel] = (uint8_t)((interpol_y + (1u << (2 * K4A_TRANSFORMATION_BILINEAR_FRACTION_BITS - 1))) >>
+                                      (2 * K4A_TRANSFORMATION_BILINEAR_FRACTION_BITS));
         }
-        if (transformed_color_image_data == 0)
+
+        // Valid black (0,0,0,0) becomes (1,0,0,0), since (0,0,0,0) marks invalid pixels
+        if (bgra[0] == 0 && bgra[1] == 0 && bgra[2] == 0 && bgra[3] == 0)
         {
-            LOG_ERROR("Transformed color image data is null.", 0);
+            bgra[0] = 1;
         }
-        return K4A_BUFFER_RESULT_FAILED;
     }
+}
 
-    k4a_transformation_image_descriptor_t expected_depth_image_descriptor =
-        transformation_init_image_descriptor(calibration->depth_camera_calibration.resolution_width,
+#if defined(K4A_USING_SSE)
+// Blends the 4 channels of one pixel. left_right holds the left and right pixel of a row with their channels
+// interleaved, weight_x the pixel's (ONE - weight_x, weight_x) pair in every 32 bit lane and weight_y its weight_y.
+static inline __m128i transformation_bilinear_pixel_fixed_sse(__m128i top_left_right,
+                                                              __m128i bottom_left_right,
+                                                              __m128i weight_x,
+                                                              __m128i weight_y)
+{
+    __m128i interpol_x_0 = _mm_madd_epi16(top_left_right, weight_x);
+    __m128i interpol_x_1 = _mm_madd_epi16(bottom_left_right, weight_x);
+    __m128i interpol_y = _mm_add_epi32(
+        _mm_mullo_epi32(interpol_x_0, _mm_sub_epi32(_mm_set1_epi32(K4A_TRANSFORMATION_BILINEAR_ONE), weight_y)),
+        _mm_mullo_epi32(interpol_x_1, weight_y));
+    interpol_y = _mm_add_epi32(interpol_y, _mm_set1_epi32(1 << (2 * K4A_TRANSFORMATION_BILINEAR_FRACTION_BITS - 1)));
+    return _mm_srli_epi32(interpol_y, 2 * K4A_TRANSFORMATION_BILINEAR_FRACTION_BITS);
+}
+
+static int transformation_bilinear_bgra_row_fixed_sse(const uint8_t *image,
+                                                      int stride,
+                                                      int width,
+                                                      int height,
+                                                      const k4a_correspondence_t *correspondences,
+                                                      int count,
+                                                      uint8_t *bgra)
+{
+    if (width < 2 || height < 2)
+    {
+        return 0;
+    }
+
+    __m128 max_x = _mm_set1_ps((float)(width - 1));
+    __m128 max_y = _mm_set1_ps((float)(height - 1));
+    __m128 scale = _mm_set1_ps((float)K4A_TRANSFORMATION_BILINEAR_ONE);
+    // Interleaves the channels of the left and right pixel in each half: l0 r0 l1 r1 l2 r2 l3 r3
+    __m128i interleave = _mm_setr_epi8(0, 4, 1, 5, 2, 6, 3, 7, 8, 12, 9, 13, 10, 14, 11, 15);
+    int i = 0;
+
+    for (; i + 4 <= count; i += 4)
+    {
+        // point2d x, point2d y, depth and valid of 4 correspondences
+        __m128 x = _mm_loadu_ps((const float *)&correspondences[i]);
+        __m128 y = _mm_loadu_ps((const float *)&correspondences[i + 1]);
+        __m128 depth = _mm_loadu_ps((const float *)&correspondences[i + 2]);
+        __m128 valid = _mm_loadu_ps((const float *)&correspondences[i + 3]);
+        _MM_TRANSPOSE4_PS(x, y, depth, valid);
+
+        // Same test as transformation_point_inside_image(), NAN fails every comparison
+        __m128 floor_x = _mm_floor_ps(x);
+        __m128 floor_y = _mm_floor_ps(y);
+        __m128 inside = _mm_and_ps(_mm_cmpge_ps(floor_x, _mm_setzero_ps()), _mm_cmpge_ps(floor_y, _mm_setzero_ps()));
+        inside = _mm_and_ps(inside, _mm_and_ps(_mm_cmplt_ps(floor_x, max_x), _mm_cmplt_ps(floor_y, max_y)));
+        __m128i not_valid = _mm_cmpeq_epi32(_mm_castps_si128(valid), _mm_setzero_si128());
+        inside = _mm_andnot_ps(_mm_castsi128_ps(not_valid), inside);
+
+        // Same rounding as transformation_bilinear_fixed_weight(), the lanes outside the image are masked below
+        __m128i weight_x = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_sub_ps(x, floor_x), scale), _mm_set1_ps(0.5f)));
+        __m128i weight_y = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_sub_ps(y, floor_y), scale), _mm_set1_ps(0.5f)));
+        weight_x = _mm_and_si128(weight_x, _mm_castps_si128(inside));
+        weight_y = _mm_and_si128(weight_y, _mm_castps_si128(inside));
+        __m128i weight_pairs = _mm_or_si128(_mm_sub_epi32(_mm_set1_epi32(K4A_TRANSFORMATION_BILINEAR_ONE), weight_x),
+                                            _mm_slli_epi32(weight_x, 16));
+
+        __m128i top_left_x = _mm_cvttps_epi32(_mm_and_ps(floor_x, inside));
+        __m128i top_left_y = _mm_cvttps_epi32(_mm_and_ps(floor_y, inside));
+        __m128i offset = _mm_add_epi32(_mm_mullo_epi32(top_left_y, _mm_set1_epi32(stride)),
+                                       _mm_slli_epi32(top_left_x, 2));
+
+        int32_t offsets[4];
+        _mm_storeu_si128((__m128i *)offsets, offset);
+
+        // Each 64 bit load holds the left and right pixel of a pair
+        __m128i top_01 = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)(image + offsets[0])),
+                                            _mm_loadl_epi64((const __m128i *)(image + offsets[1])));
+        __m128i top_23 = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)(image + offsets[2])),
+                                            _mm_loadl_epi64((const __m128i *)(image + offsets[3])));
+        __m128i bottom_01 = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)(image + offsets[0] + stride)),
+                                               _mm_loadl_epi64((const __m128i *)(image + offsets[1] + stride)));
+        __m128i bottom_23 = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)(image + offsets[2] + stride)),
+                                               _mm_loadl_epi64((const __m128i *)(image + offsets[3] + stride)));
+        top_01 = _mm_shuffle_epi8(top_01, interleave);
+        top_23 = _mm_shuffle_epi8(top_23, interleave);
+        bottom_01 = _mm_shuffle_epi8(bottom_01, interleave);
+        bottom_23 = _mm_shuffle_epi8(bottom_23, interleave);
+
+        __m128i zero = _mm_setzero_si128();
+        __m128i pixel_0 = transformation_bilinear_pixel_fixed_sse(_mm_unpacklo_epi8(top_01, zero),
+                                                                  _mm_unpacklo_epi8(bottom_01, zero),
+                                                                  _mm_shuffle_epi32(weight_pairs, 0x00),
+                                                                  _mm_shuffle_epi32(weight_y, 0x00));
+        __m128i pixel_1 = transformation_bilinear_pixel_fixed_sse(_mm_unpackhi_epi8(top_01, zero),
+                                                                  _mm_unpackhi_epi8(bottom_01, zero),
+                                                                  _mm_shuffle_epi32(weight_pairs, 0x55),
+                                                                  _mm_shuffle_epi32(weight_y, 0x55));
+        __m128i pixel_2 = transformation_bilinear_pixel_fixed_sse(_mm_unpacklo_epi8(top_23, zero),
+                                                                  _mm_unpacklo_epi8(bottom_23, zero),
+                                                                  _mm_shuffle_epi32(weight_pairs, 0xaa),
+                                                                  _mm_shuffle_epi32(weight_y, 0xaa));
+        __m128i pixel_3 = transformation_bilinear_pixel_fixed_sse(_mm_unpackhi_epi8(top_23, zero),
+                                                                  _mm_unpackhi_epi8(bottom_23, zero),
+                                                                  _mm_shuffle_epi32(weight_pairs, 0xff),
+                                                                  _mm_shuffle_epi32(weight_y, 0xff));
+        __m128i result = _mm_packus_epi16(_mm_packs_epi32(pixel_0, pixel_1), _mm_packs_epi32(pixel_2, pixel_3));
+
+        // Valid black (0,0,0,0) becomes (1,0,0,0), since (0,0,0,0) marks invalid pixels
+        result = _mm_add_epi32(result, _mm_and_si128(_mm_cmpeq_epi32(result, _mm_setzero_si128()), _mm_set1_epi32(1)));
+        result = _mm_and_si128(result, _mm_castps_si128(inside));
+        _mm_storeu_si128((__m128i *)(bgra + 4 * i), result);
+    }
+    return i;
+}
+
+#elif defined(K4A_USING_NEON)
+// Repeats the weight of each of 4 pixels across its 4 channels, pixels 0 and 1 in *weight_01 and 2 and 3 in *weight_23
+static inline void transformation_bilinear_spread_weights_neon(uint32x4_t weight,
+                                                               uint16x8_t *weight_01,
+                                                               uint16x8_t *weight_23)
+{
+    uint16x4_t narrow = vmovn_u32(weight);
+    uint16x4x2_t pairs = vzip_u16(narrow, narrow);
+    uint16x4x2_t pixels_01 = vzip_u16(pairs.val[0], pairs.val[0]);
+    uint16x4x2_t pixels_23 = vzip_u16(pairs.val[1], pairs.val[1]);
+    *weight_01 = vcombine_u16(pixels_01.val[0], pixels_01.val[1]);
+    *weight_23 = vcombine_u16(pixels_23.val[0], pixels_23.val[1]);
+}
+
+// Blends the channels of 2 pixels widened to 16 bits, with their weights spread by
+// transformation_bilinear_spread_weights_neon()
+static inline uint8x8_t transformation_bilinear_pixels_fixed_neon(uint16x8_t top_left,
+                                                                  uint16x8_t top_right,
+                                                                  uint16x8_t bottom_left,
+                                                                  uint16x8_t bottom_right,
+                                                                  uint16x8_t weight_x,
+                                                                  uint16x8_t weight_y)
+{
+    uint16x8_t one = vdupq_n_u16(K4A_TRANSFORMATION_BILINEAR_ONE);
+    uint16x8_t inverse_x = vsubq_u16(one, weight_x);
+    uint16x8_t inverse_y = vsubq_u16(one, weight_y);
+
+    // At most 255 * K4A_TRANSFORMATION_BILINEAR_ONE, which fits in 16 bits
+    uint16x8_t interpol_x_0 = vmlaq_u16(vmulq_u16(top_left, inverse_x), top_right, weight_x);
+    uint16x8_t interpol_x_1 = vmlaq_u16(vmulq_u16(bottom_left, inverse_x), bottom_right, weight_x);
+
+    uint32x4_t interpol_y_0 = vmlal_u16(vmull_u16(vget_low_u16(interpol_x_0), vget_low_u16(inverse_y)),
+                                        vget_low_u16(interpol_x_1),
+                                        vget_low_u16(weight_y));
+    uint32x4_t interpol_y_1 = vmlal_u16(vmull_u16(vget_high_u16(interpol_x_0), vget_high_u16(inverse_y)),
+                                        vget_high_u16(interpol_x_1),
+                                        vget_high_u16(weight_y));
+
+    // The rounding shift adds half of the divisor like transformation_bilinear_bgra_row_fixed_c()
+    uint16x8_t value = vcombine_u16(vrshrn_n_u32(interpol_y_0, 2 * K4A_TRANSFORMATION_BILINEAR_FRACTION_BITS),
+                                    vrshrn_n_u32(interpol_y_1, 2 * K4A_TRANSFORMATION_BILINEAR_FRACTION_BITS));
+    return vmovn_u16(value);
+}
+
+static int transformation_bilinear_bgra_row_fixed_neon(const uint8_t *image,
+                                                       int stride,
+                                                       int width,
+                                                       int height,
+                                                       const k4a_correspondence_t *correspondences,
+                                                       int count,
+                                                       uint8_t *bgra)
+{
+    if (width < 2 || height < 2)
+    {
+        return 0;
+    }
+
+    float32x4_t max_x = vdupq_n_f32((float)(width - 1));
+    float32x4_t max_y = vdupq_n_f32((float)(height - 1));
+    float32x4_t scale = vdupq_n_f32((float)K4A_TRANSFORMATION_BILINEAR_ONE);
+    int i = 0;
+
+    for (; i + 4 <= count; i += 4)
+    {
+        // deinterleaves point2d x, point2d y, depth and valid of 4 correspondences
+        float32x4x4_t fields = vld4q_f32((const float *)&correspondences[i]);
+        float32x4_t x = fields.val[0];
+        float32x4_t y = fields.val[1];
+        uint32x4_t valid = vreinterpretq_u32_f32(fields.val[3]);
+
+        // Same test as transformation_point_inside_image(), NAN fails every comparison
+        float32x4_t floor_x = vrndmq_f32(x);
+        float32x4_t floor_y = vrndmq_f32(y);
+        uint32x4_t inside = vandq_u32(vcgeq_f32(floor_x, vdupq_n_f32(0.f)), vcgeq_f32(floor_y, vdupq_n_f32(0.f)));
+        inside = vandq_u32(inside, vandq_u32(vcltq_f32(floor_x, max_x), vcltq_f32(floor_y, max_y)));
+        inside = vbicq_u32(inside, vceqq_u32(valid, vdupq_n_u32(0)));
+
+        // Same rounding as transformation_bilinear_fixed_weight(), the lanes outside the image are masked below
+        uint32x4_t weight_x = vcvtq_u32_f32(vaddq_f32(vmulq_f32(vsubq_f32(x, floor_x), scale), vdupq_n_f32(0.5f)));
+        uint32x4_t weight_y = vcvtq_u32_f32(vaddq_f32(vmulq_f32(vsubq_f32(y, floor_y), scale), vdupq_n_f32(0.5f)));
+        uint16x8_t weight_x_01, weight_x_23, weight_y_01, weight_y_23;
+        transformation_bilinear_spread_weights_neon(vandq_u32(weight_x, inside), &weight_x_01, &weight_x_23);
+        transformation_bilinear_spread_weights_neon(vandq_u32(weight_y, inside), &weight_y_01, &weight_y_23);
+
+        int32x4_t top_left_x = vcvtq_s32_f32(vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(floor_x), inside)));
+        int32x4_t top_left_y = vcvtq_s32_f32(vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(floor_y), inside)));
+        int32x4_t offset = vaddq_s32(vmulq_n_s32(top_left_y, stride), vshlq_n_s32(top_left_x, 2));
+
+        int32_t offsets[4];
+        vst1q_s32(offsets, offset);
+
+        uint32_t pixels[4][4];
+        for (int lane = 0; lane < 4; lane++)
+        {
+            const uint8_t *top = image + offsets[lane];
+            memcpy(&pixels[0][lane], top, sizeof(uint32_t));
+            memcpy(&pixels[1][lane], top + 4, sizeof(uint32_t));
+            memcpy(&pixels[2][lane], top + stride, sizeof(uint32_t));
+            memcpy(&pixels[3][lane], top + stride + 4, sizeof(uint32_t));
+        }
+        uint8x16_t top_left = vld1q_u8((const uint8_t *)pixels[0]);
+        uint8x16_t top_right = vld1q_u8((const uint8_t *)pixels[1]);
+        uint8x16_t bottom_left = vld1q_u8((const uint8_t *)pixels[2]);
+        uint8x16_t bottom_right = vld1q_u8((const uint8_t *)pixels[3]);
+
+        uint8x8_t pixels_01 = transformation_bilinear_pixels_fixed_neon(vmovl_u8(vget_low_u8(top_left)),
+                                                                        vmovl_u8(vget_low_u8(top_right)),
+                                                                        vmovl_u8(vget_low_u8(bottom_left)),
+                                                                        vmovl_u8(vget_low_u8(bottom_right)),
+                                                                        weight_x_01,
+                                                                        weight_y_01);
+        uint8x8_t pixels_23 = transformation_bilinear_pixels_fixed_neon(vmovl_u8(vget_high_u8(top_left)),
+                                                                        vmovl_u8(vget_high_u8(top_right)),
+                                                                        vmovl_u8(vget_high_u8(bottom_left)),
+                                                                        vmovl_u8(vget_high_u8(bottom_right)),
+                                                                        weight_x_23,
+                                                                        weight_y_23);
+        uint32x4_t result = vreinterpretq_u32_u8(vcombine_u8(pixels_01, pixels_23));
+
+        // Valid black (0,0,0,0) becomes (1,0,0,0), since (0,0,0,0) marks invalid pixels
+        result = vaddq_u32(result, vandq_u32(vceqq_u32(result, vdupq_n_u32(0)), vdupq_n_u32(1)));
+        result = vandq_u32(result, inside);
+        vst1q_u8(bgra + 4 * i, vreinterpretq_u8_u32(result));
+    }
+    return i;
+}
+#endif
+
+static void transformation_bilinear_bgra_row(const k4a_transformation_input_image_t *color_image,
+                                             bool fixed_point,
+                                             const k4a_correspondence_t *correspondences,
+                                             int count,
+                                             uint8_t *bgra)
+{
+    const uint8_t *image = color_image->data_uint8;
+    int stride = color_image->descriptor->stride_bytes;
+    int width = color_image->descriptor->width_pixels;
+    int height = color_image->descriptor->height_pixels;
+    int done = 0;
+
+    if (fixed_point)
+    {
+#if defined(K4A_USING_SSE)
+        done = transformation_bilinear_bgra_row_fixed_sse(image, stride, width, height, correspondences, count, bgra);
+#elif defined(K4A_USING_NEON)
+        done = transformation_bilinear_bgra_row_fixed_neon(image, stride, width, height, correspondences, count, bgra);
+#endif
+        transformation_bilinear_bgra_row_fixed_c(
+            image, stride, width, height, correspondences + done, count - done, bgra + 4 * done);
+        return;
+    }
+
+#if defined(K4A_USING_SSE)
+    if (transformation_get_instruction_set() != TRANSFORMATION_INSTRUCTION_SET_SSE)
+    {
+        done = transformation_bilinear_bgra_row_avx2(image, stride, width, height, correspondences, count, bgra);
+    }
+    done += transformation_bilinear_bgra_row_sse(
+        image, stride, width, height, correspondences + done, count - done, bgra + 4 * done);
+#elif defined(K4A_USING_NEON)
+    done = transformation_bilinear_bgra_row_neon(image, stride, width, height, correspondences, count, bgra);
+#endif
+
+    transformation_bilinear_bgra_row_c(
+        image, stride, width, height, correspondences + done, count - done, bgra + 4 * done);
+}
+
+static k4a_result_t transformation_color_to_depth(k4a_transformation_rgbz_context_t *context)
+{
+    int depth_width = context->depth_image.descriptor->width_pixels;
+    int width = context->roi.width;
+    int height = context->roi.height;
+
+    // Correspondences are computed a row at a time so the blend can work on whole rows
+    k4a_correspondence_t *correspondence_row = (k4a_correspondence_t *)malloc((size_t)width *
+                                                                              sizeof(k4a_correspondence_t));
+    if (correspondence_row == NULL)
+    {
+        LOG_ERROR("Failed to allocate the correspondence row.", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    for (int y = 0; y < height; y++)
+    {
+        int idx = (context->roi.y + y) * depth_width + context->roi.x;
+        for (int x = 0; x < width; x++, idx++)
+        {
+            if (K4A_FAILED(TRACE_CALL(transformation_compute_correspondence(
+                    idx, context->depth_image.data_uint16[idx], context, &correspondence_row[x]))))
+            {
+                free(correspondence_row);
+                return K4A_RESULT_FAILED;
+            }
+        }
+
+        transformation_bilinear_bgra_row(&context->color_image,
+                                         context->fixed_point,
+                                         correspondence_row,
+                                         width,
+                                         context->transformed_image.data_uint8 +
+                                             (size_t)y * (size_t)context->transformed_image.descriptor->stride_bytes);
+    }
+
+    free(correspondence_row);
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_buffer_result_t transformation_color_image_to_depth_camera_validate_parameters(
+    const k4a_calibration_t *calibration,
+    const k4a_transformation_xy_tables_t *xy_tables_depth_camera,
+    const uint8_t *depth_image_data,
+    const k4a_transformation_image_descriptor_t *depth_image_descriptor,
+    const uint8_t *color_image_data,
+    const k4a_transformation_image_descriptor_t *color_image_descriptor,
+    uint8_t *transformed_color_image_data,
+    k4a_transformation_image_descriptor_t *transformed_color_image_descriptor,
+    const k4a_rect_t *roi)
+{
+    if (transformed_color_image_descriptor == 0 || calibration == 0)
+    {
+        if (calibration == 0)
+        {
+            LOG_ERROR("Calibration is null.", 0);
+        }
+        return K4A_BUFFER_RESULT_FAILED;
+    }
+
+    k4a_rect_t rect;
+    if (!transformation_get_roi(roi,
+                                calibration->depth_camera_calibration.resolution_width,
+                                calibration->depth_camera_calibration.resolution_height,
+                                &rect))
+    {
+        return K4A_BUFFER_RESULT_FAILED;
+    }
+
+    k4a_transformation_image_descriptor_t expected_transformed_color_image_descriptor =
+        transformation_init_image_descriptor(rect.width,
+                                             rect.height,
+                                             rect.width * 4 * (int)sizeof(uint8_t),
+                                             K4A_IMAGE_FORMAT_COLOR_BGRA32);
+
+    if (transformed_color_image_data == 0 ||
+        transformation_compare_image_descriptors(transformed_color_image_descriptor,
+                                                 &expected_transformed_color_image_descriptor) == false)
+    {
+        if (transformed_color_image_data == 0)
+        {
+            LOG_ERROR("Transformed color image data is null.", 0);
+        }
+        else
+        {
+            LOG_ERROR("Unexpected transformed color image descriptor, see details above.", 0);
+        }
+        return K4A_BUFFER_RESULT_TOO_SMALL;
+    }
+
+    if (xy_tables_depth_camera == 0 || depth_image_data == 0 || depth_image_descriptor == 0 || color_image_data == 0 ||
+        color_image_descriptor == 0 || transformed_color_image_data == 0)
+    {
+        if (xy_tables_depth_camera == 0)
+        {
+            LOG_ERROR("Depth camera xy table is null.", 0);
+        }
+        if (depth_image_data == 0)
+        {
+            LOG_ERROR("Depth image data is null.", 0);
+        }
+        if (color_image_data == 0)
+        {
+            LOG_ERROR("Color image data is null.", 0);
+        }
+        if (transformed_color_image_data == 0)
+        {
+            LOG_ERROR("Transformed color image data is null.", 0);
+        }
+        return K4A_BUFFER_RESULT_FAILED;
+    }
+
+    k4a_transformation_image_descriptor_t expected_depth_image_descriptor =
+        transformation_init_image_descriptor(calibration->depth_camera_calibration.resolution_width,
                                              calibration->depth_camera_calibration.resolution_height,
                                              calibration->depth_camera_calibration.resolution_width *
                                                  (int)sizeof(uint16_t),
@@ -1042,12 +2499,15 @@ k4a_buffer_result_t transformation_color_image_to_depth_camera_validate_paramete
 k4a_buffer_result_t transformation_color_image_to_depth_camera_internal(
     const k4a_calibration_t *calibration,
     const k4a_transformation_xy_tables_t *xy_tables_depth_camera,
+    const k4a_transformation_ray_tables_t *ray_tables_depth_camera,
     const uint8_t *depth_image_data,
     const k4a_transformation_image_descriptor_t *depth_image_descriptor,
     const uint8_t *color_image_data,
     const k4a_transformation_image_descriptor_t *color_image_descriptor,
     uint8_t *transformed_color_image_data,
-    k4a_transformation_image_descriptor_t *transformed_color_image_descriptor)
+    k4a_transformation_image_descriptor_t *transformed_color_image_descriptor,
+    bool fixed_point,
+    const k4a_rect_t *roi)
 {
     if (K4A_BUFFER_RESULT_SUCCEEDED !=
         TRACE_BUFFER_CALL(
@@ -1058,7 +2518,8 @@ k4a_buffer_result_t transformation_color_image_to_depth_camera_internal(
                                                                            color_image_data,
                                                                            color_image_descriptor,
                                                                            transformed_color_image_data,
-                                                                           transformed_color_image_descriptor)))
+                                                                           transformed_color_image_descriptor,
+                                                                           roi)))
     {
         return K4A_BUFFER_RESULT_FAILED;
     }
@@ -1067,6 +2528,7 @@ k4a_buffer_result_t transformation_color_image_to_depth_camera_internal(
     memset(&context, 0, sizeof(k4a_transformation_rgbz_context_t));
 
     context.xy_tables = xy_tables_depth_camera;
+    context.ray_tables = ray_tables_depth_camera;
     context.calibration = calibration;
 
     context.depth_image = transformation_init_input_image(depth_image_descriptor, depth_image_data);
@@ -1075,6 +2537,11 @@ k4a_buffer_result_t transformation_color_image_to_depth_camera_internal(
 
     context.transformed_image = transformation_init_output_image(transformed_color_image_descriptor,
                                                                  transformed_color_image_data);
+    context.fixed_point = fixed_point;
+    transformation_get_roi(roi,
+                           calibration->depth_camera_calibration.resolution_width,
+                           calibration->depth_camera_calibration.resolution_height,
+                           &context.roi);
 
     if (K4A_FAILED(TRACE_CALL(transformation_color_to_depth(&context))))
     {
@@ -1083,28 +2550,25 @@ k4a_buffer_result_t transformation_color_image_to_depth_camera_internal(
     return K4A_BUFFER_RESULT_SUCCEEDED;
 }
 
-#if !defined(K4A_USING_SSE) && !defined(K4A_USING_NEON)
 // This is the same function as transformation_depth_to_xyz without the SSE
-// instructions. This code is kept here for readability.
-static void transformation_depth_to_xyz(k4a_transformation_xy_tables_t *xy_tables,
-                                        const void *depth_image_data,
-                                        void *xyz_image_data)
+// instructions. This code is kept here for readability, and converts the pixels the vector versions leave over.
+static void transformation_depth_to_xyz_c(const float *x_table,
+                                          const float *y_table,
+                                          const uint16_t *depth_image_data_uint16,
+                                          int16_t *xyz_data_int16,
+                                          int count)
 {
-    const uint16_t *depth_image_data_uint16 = (const uint16_t *)depth_image_data;
-    int16_t *xyz_data_int16 = (int16_t *)xyz_image_data;
     int16_t x, y, z;
 
-    set_special_instruction_optimization("None");
-
-    for (int i = 0; i < xy_tables->width * xy_tables->height; i++)
+    for (int i = 0; i < count; i++)
     {
-        float x_tab = xy_tables->x_table[i];
+        float x_tab = x_table[i];
 
         if (!isnan(x_tab))
         {
             z = (int16_t)depth_image_data_uint16[i];
             x = (int16_t)(floorf(x_tab * (float)z + 0.5f));
-            y = (int16_t)(floorf(xy_tables->y_table[i] * (float)z + 0.5f));
+            y = (int16_t)(floorf(y_table[i] * (float)z + 0.5f));
         }
         else
         {
@@ -1119,6 +2583,20 @@ static void transformation_depth_to_xyz(k4a_transformation_xy_tables_t *xy_table
     }
 }
 
+#if !defined(K4A_USING_SSE) && !defined(K4A_USING_NEON)
+static void transformation_depth_to_xyz(const k4a_transformation_xy_tables_t *xy_tables,
+                                        const void *depth_image_data,
+                                        void *xyz_image_data)
+{
+    set_special_instruction_optimization("None");
+
+    transformation_depth_to_xyz_c(xy_tables->x_table,
+                                  xy_tables->y_table,
+                                  (const uint16_t *)depth_image_data,
+                                  (int16_t *)xyz_image_data,
+                                  xy_tables->width * xy_tables->height);
+}
+
 #elif defined(K4A_USING_NEON)
 // convert from float to int using NEON is round to zero
 // make separate function to do floor
@@ -1129,7 +2607,7 @@ static inline int32x4_t neon_floor(float32x4_t v)
     return vaddq_s32(v0, a0);
 }
 
-static void transformation_depth_to_xyz(k4a_transformation_xy_tables_t *xy_tables,
+static void transformation_depth_to_xyz(const k4a_transformation_xy_tables_t *xy_tables,
                                         const void *depth_image_data,
                                         void *xyz_image_data)
 {
@@ -1178,28 +2656,20 @@ static void transformation_depth_to_xyz(k4a_transformation_xy_tables_t *xy_table
         // x0 y0 z0 x1 y1 z1 .. x15 y15 z15
         vst3q_s16(xyz_data_int16 + offset * 3, store);
     }
+
+    int done = xy_tables->width * xy_tables->height / 8 * 8;
+    transformation_depth_to_xyz_c(x_tab + done,
+                                  y_tab + done,
+                                  depth_image_data_uint16 + done,
+                                  xyz_data_int16 + done * 3,
+                                  xy_tables->width * xy_tables->height - done);
 }
 
 #else /* defined(K4A_USING_SSE) */
 
-static void transformation_depth_to_xyz(k4a_transformation_xy_tables_t *xy_tables,
-                                        const void *depth_image_data,
-                                        void *xyz_image_data)
+// Interleaves 8 x, y and z values into 3 vectors of x0, y0, z0, x1, ...
+static inline void transformation_store_xyz_sse(__m128i x, __m128i y, __m128i z, __m128i *xyz_data_m128i)
 {
-    const __m128i *depth_image_data_m128i = (const __m128i *)depth_image_data;
-#if defined(__clang__) || defined(__GNUC__)
-    void *x_table = __builtin_assume_aligned(xy_tables->x_table, 16);
-    void *y_table = __builtin_assume_aligned(xy_tables->y_table, 16);
-#else
-    void *x_table = (void *)xy_tables->x_table;
-    void *y_table = (void *)xy_tables->y_table;
-#endif
-    __m128 *x_table_m128 = (__m128 *)x_table;
-    __m128 *y_table_m128 = (__m128 *)y_table;
-    __m128i *xyz_data_m128i = (__m128i *)xyz_image_data;
-
-    set_special_instruction_optimization("SSE");
-
     const int16_t pos0 = 0x0100;
     const int16_t pos1 = 0x0302;
     const int16_t pos2 = 0x0504;
@@ -1216,18 +2686,42 @@ static void transformation_depth_to_xyz(k4a_transformation_xy_tables_t *xy_table
     // z2, z5, z0, z3, z6, z1, z4, z7
     __m128i z_shuffle = _mm_setr_epi16(pos2, pos5, pos0, pos3, pos6, pos1, pos4, pos7);
 
+    x = _mm_shuffle_epi8(x, x_shuffle);
+    y = _mm_shuffle_epi8(y, y_shuffle);
+    z = _mm_shuffle_epi8(z, z_shuffle);
+
+    // x0, y0, z0, x1, y1, z1, x2, y2
+    _mm_storeu_si128(xyz_data_m128i + 0, _mm_blend_epi16(_mm_blend_epi16(x, y, 0x92), z, 0x24));
+    // z2, x3, y3, z3, x4, y4, z4, x5
+    _mm_storeu_si128(xyz_data_m128i + 1, _mm_blend_epi16(_mm_blend_epi16(x, y, 0x24), z, 0x49));
+    // y5, z5, x6, y6, z6, x7, y7, z7
+    _mm_storeu_si128(xyz_data_m128i + 2, _mm_blend_epi16(_mm_blend_epi16(x, y, 0x49), z, 0x92));
+}
+
+// Converts count / 8 blocks of 8 pixels
+static void transformation_depth_to_xyz_sse(const float *x_table,
+                                            const float *y_table,
+                                            const uint16_t *depth_image_data,
+                                            int16_t *xyz_image_data,
+                                            int count)
+{
+    const int16_t pos0 = 0x0100;
+    const int16_t pos2 = 0x0504;
+    const int16_t pos4 = 0x0908;
+    const int16_t pos6 = 0x0D0C;
     __m128i valid_shuffle = _mm_setr_epi16(pos0, pos2, pos4, pos6, pos0, pos2, pos4, pos6);
 
-    for (int i = 0; i < xy_tables->width * xy_tables->height / 8; i++)
+    for (int i = 0; i < count / 8; i++)
     {
-        __m128i z = *depth_image_data_m128i++;
+        int offset = i * 8;
+        __m128i z = _mm_loadu_si128((const __m128i *)(depth_image_data + offset));
 
-        __m128 x_tab_lo = *x_table_m128++;
-        __m128 x_tab_hi = *x_table_m128++;
+        __m128 x_tab_lo = _mm_loadu_ps(x_table + offset);
+        __m128 x_tab_hi = _mm_loadu_ps(x_table + offset + 4);
         __m128 valid_lo = _mm_cmpeq_ps(x_tab_lo, x_tab_lo);
         __m128 valid_hi = _mm_cmpeq_ps(x_tab_hi, x_tab_hi);
-        __m128i valid_shuffle_lo = _mm_shuffle_epi8(*((__m128i *)&valid_lo), valid_shuffle);
-        __m128i valid_shuffle_hi = _mm_shuffle_epi8(*((__m128i *)&valid_hi), valid_shuffle);
+        __m128i valid_shuffle_lo = _mm_shuffle_epi8(_mm_castps_si128(valid_lo), valid_shuffle);
+        __m128i valid_shuffle_hi = _mm_shuffle_epi8(_mm_castps_si128(valid_hi), valid_shuffle);
         __m128i valid = _mm_blend_epi16(valid_shuffle_lo, valid_shuffle_hi, 0xF0);
         z = _mm_blendv_epi8(_mm_setzero_si128(), z, valid);
 
@@ -1238,73 +2732,1905 @@ static void transformation_depth_to_xyz(k4a_transformation_xy_tables_t *xy_table
         __m128i x_hi = _mm_cvtps_epi32(_mm_mul_ps(depth_hi, x_tab_hi));
         __m128i x = _mm_packs_epi32(x_lo, x_hi);
         x = _mm_blendv_epi8(_mm_setzero_si128(), x, valid);
-        x = _mm_shuffle_epi8(x, x_shuffle);
 
-        __m128i y_lo = _mm_cvtps_epi32(_mm_mul_ps(depth_lo, *y_table_m128++));
-        __m128i y_hi = _mm_cvtps_epi32(_mm_mul_ps(depth_hi, *y_table_m128++));
+        __m128i y_lo = _mm_cvtps_epi32(_mm_mul_ps(depth_lo, _mm_loadu_ps(y_table + offset)));
+        __m128i y_hi = _mm_cvtps_epi32(_mm_mul_ps(depth_hi, _mm_loadu_ps(y_table + offset + 4)));
         __m128i y = _mm_packs_epi32(y_lo, y_hi);
-        y = _mm_shuffle_epi8(y, y_shuffle);
 
-        z = _mm_shuffle_epi8(z, z_shuffle);
+        transformation_store_xyz_sse(x, y, z, (__m128i *)(xyz_image_data + offset * 3));
+    }
+}
+
+// Same as transformation_depth_to_xyz_sse with 16 pixels per iteration, the remaining block of 8 is left to the
+// caller
+K4A_TARGET_AVX2 static void transformation_depth_to_xyz_avx2(const float *x_table,
+                                                             const float *y_table,
+                                                             const uint16_t *depth_image_data,
+                                                             int16_t *xyz_image_data,
+                                                             int count)
+{
+    for (int i = 0; i < count / 16; i++)
+    {
+        int offset = i * 16;
+        __m256i z = _mm256_loadu_si256((const __m256i *)(depth_image_data + offset));
+
+        __m256 x_tab_lo = _mm256_loadu_ps(x_table + offset);
+        __m256 x_tab_hi = _mm256_loadu_ps(x_table + offset + 8);
+        __m256 valid_lo = _mm256_cmp_ps(x_tab_lo, x_tab_lo, _CMP_EQ_OQ);
+        __m256 valid_hi = _mm256_cmp_ps(x_tab_hi, x_tab_hi, _CMP_EQ_OQ);
+        // packs works within each 128 bit lane, the permute restores pixel order
+        __m256i valid = _mm256_permute4x64_epi64(
+            _mm256_packs_epi32(_mm256_castps_si256(valid_lo), _mm256_castps_si256(valid_hi)), 0xD8);
+        z = _mm256_and_si256(z, valid);
+
+        __m256 depth_lo = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm256_castsi256_si128(z)));
+        __m256 depth_hi = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm256_extracti128_si256(z, 1)));
+
+        __m256i x_lo = _mm256_cvtps_epi32(_mm256_mul_ps(depth_lo, x_tab_lo));
+        __m256i x_hi = _mm256_cvtps_epi32(_mm256_mul_ps(depth_hi, x_tab_hi));
+        __m256i x = _mm256_permute4x64_epi64(_mm256_packs_epi32(x_lo, x_hi), 0xD8);
+        x = _mm256_and_si256(x, valid);
+
+        __m256i y_lo = _mm256_cvtps_epi32(_mm256_mul_ps(depth_lo, _mm256_loadu_ps(y_table + offset)));
+        __m256i y_hi = _mm256_cvtps_epi32(_mm256_mul_ps(depth_hi, _mm256_loadu_ps(y_table + offset + 8)));
+        __m256i y = _mm256_permute4x64_epi64(_mm256_packs_epi32(y_lo, y_hi), 0xD8);
+
+        __m128i *xyz_data_m128i = (__m128i *)(xyz_image_data + offset * 3);
+        transformation_store_xyz_sse(
+            _mm256_castsi256_si128(x), _mm256_castsi256_si128(y), _mm256_castsi256_si128(z), xyz_data_m128i);
+        transformation_store_xyz_sse(_mm256_extracti128_si256(x, 1),
+                                     _mm256_extracti128_si256(y, 1),
+                                     _mm256_extracti128_si256(z, 1),
+                                     xyz_data_m128i + 3);
+    }
+}
+
+// Same as transformation_depth_to_xyz_sse with 16 pixels per iteration in one register, the remaining block of 8 is
+// left to the caller
+K4A_TARGET_AVX512 static void transformation_depth_to_xyz_avx512(const float *x_table,
+                                                                 const float *y_table,
+                                                                 const uint16_t *depth_image_data,
+                                                                 int16_t *xyz_image_data,
+                                                                 int count)
+{
+    for (int i = 0; i < count / 16; i++)
+    {
+        int offset = i * 16;
+        __m256i z = _mm256_loadu_si256((const __m256i *)(depth_image_data + offset));
+
+        __m512 x_tab = _mm512_loadu_ps(x_table + offset);
+        __mmask16 valid = _mm512_cmp_ps_mask(x_tab, x_tab, _CMP_EQ_OQ);
+        __m512i z_32 = _mm512_maskz_mov_epi32(valid, _mm512_cvtepu16_epi32(z));
+        __m512 depth = _mm512_cvtepi32_ps(z_32);
+
+        // Saturate to 16 bits like _mm_packs_epi32
+        __m512i x_32 = _mm512_maskz_mov_epi32(valid, _mm512_cvtps_epi32(_mm512_mul_ps(depth, x_tab)));
+        __m256i x = _mm512_cvtsepi32_epi16(x_32);
+        __m256i y = _mm512_cvtsepi32_epi16(
+            _mm512_cvtps_epi32(_mm512_mul_ps(depth, _mm512_loadu_ps(y_table + offset))));
+        z = _mm512_cvtepi32_epi16(z_32);
+
+        __m128i *xyz_data_m128i = (__m128i *)(xyz_image_data + offset * 3);
+        transformation_store_xyz_sse(
+            _mm256_castsi256_si128(x), _mm256_castsi256_si128(y), _mm256_castsi256_si128(z), xyz_data_m128i);
+        transformation_store_xyz_sse(_mm256_extracti128_si256(x, 1),
+                                     _mm256_extracti128_si256(y, 1),
+                                     _mm256_extracti128_si256(z, 1),
+                                     xyz_data_m128i + 3);
+    }
+}
+
+static void transformation_depth_to_xyz(const k4a_transformation_xy_tables_t *xy_tables,
+                                        const void *depth_image_data,
+                                        void *xyz_image_data)
+{
+    const float *x_table = xy_tables->x_table;
+    const float *y_table = xy_tables->y_table;
+    const uint16_t *depth_image_data_uint16 = (const uint16_t *)depth_image_data;
+    int16_t *xyz_data_int16 = (int16_t *)xyz_image_data;
+    int count = xy_tables->width * xy_tables->height;
+    int done = 0;
 
-        // x0, y0, z0, x1, y1, z1, x2, y2
-        *xyz_data_m128i++ = _mm_blend_epi16(_mm_blend_epi16(x, y, 0x92), z, 0x24);
-        // z2, x3, y3, z3, x4, y4, z4, x5
-        *xyz_data_m128i++ = _mm_blend_epi16(_mm_blend_epi16(x, y, 0x24), z, 0x49);
-        // y5, z5, x6, y6, z6, x7, y7, z7
-        *xyz_data_m128i++ = _mm_blend_epi16(_mm_blend_epi16(x, y, 0x49), z, 0x92);
+    switch (transformation_get_instruction_set())
+    {
+    case TRANSFORMATION_INSTRUCTION_SET_AVX512:
+        set_special_instruction_optimization("AVX512");
+        transformation_depth_to_xyz_avx512(x_table, y_table, depth_image_data_uint16, xyz_data_int16, count);
+        done = count / 16 * 16;
+        break;
+    case TRANSFORMATION_INSTRUCTION_SET_AVX2:
+        set_special_instruction_optimization("AVX2");
+        transformation_depth_to_xyz_avx2(x_table, y_table, depth_image_data_uint16, xyz_data_int16, count);
+        done = count / 16 * 16;
+        break;
+    default:
+        set_special_instruction_optimization("SSE");
+        break;
     }
+
+    transformation_depth_to_xyz_sse(
+        x_table + done, y_table + done, depth_image_data_uint16 + done, xyz_data_int16 + done * 3, count - done);
+    done += (count - done) / 8 * 8;
+
+    // Less than 8 pixels remain when the image size is not a multiple of 8
+    transformation_depth_to_xyz_c(
+        x_table + done, y_table + done, depth_image_data_uint16 + done, xyz_data_int16 + done * 3, count - done);
 }
 #endif
 
-k4a_buffer_result_t
-transformation_depth_image_to_point_cloud_internal(k4a_transformation_xy_tables_t *xy_tables,
-                                                   const uint8_t *depth_image_data,
-                                                   const k4a_transformation_image_descriptor_t *depth_image_descriptor,
-                                                   uint8_t *xyz_image_data,
-                                                   k4a_transformation_image_descriptor_t *xyz_image_descriptor)
+// Bytes per point of format, 0 for an unexpected format
+static int transformation_point_cloud_format_size(k4a_point_cloud_format_t format)
 {
-    if (xyz_image_descriptor == 0)
+    switch (format)
     {
-        return K4A_BUFFER_RESULT_FAILED;
+    case K4A_POINT_CLOUD_FORMAT_INT16_XYZ:
+        return 3 * (int)sizeof(int16_t);
+    case K4A_POINT_CLOUD_FORMAT_FLOAT32_XYZ:
+        return 3 * (int)sizeof(float);
+    case K4A_POINT_CLOUD_FORMAT_FLOAT32_XYZW:
+        return 4 * (int)sizeof(float);
+    case K4A_POINT_CLOUD_FORMAT_FLOAT16_XYZ:
+        return 3 * (int)sizeof(uint16_t);
+    case K4A_POINT_CLOUD_FORMAT_FLOAT16_XYZW:
+        return 4 * (int)sizeof(uint16_t);
+    default:
+        return 0;
+    }
+}
+
+// Rounds to the nearest half precision value, ties to even like the hardware conversions. Values too large for half
+// precision become infinity, point coordinates are never NaN.
+static uint16_t transformation_float_to_half(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint16_t sign = (uint16_t)((bits >> 16) & 0x8000);
+    uint32_t abs_bits = bits & 0x7FFFFFFF;
+
+    // 65520 and above round to infinity
+    if (abs_bits >= 0x477FF000)
+    {
+        return (uint16_t)(sign | 0x7C00);
     }
 
-    k4a_transformation_image_descriptor_t expected_xyz_image_descriptor = transformation_init_image_descriptor(
-        xy_tables->width, xy_tables->height, xy_tables->width * 3 * (int)sizeof(int16_t), xyz_image_descriptor->format);
+    // Below the smallest normal half, 2^-14, the result counts multiples of 2^-24
+    if (abs_bits < 0x38800000)
+    {
+        return (uint16_t)(sign | (uint16_t)lrintf(fabsf(value) * 16777216.0f));
+    }
 
-    if (xyz_image_data == 0 ||
-        transformation_compare_image_descriptors(xyz_image_descriptor, &expected_xyz_image_descriptor) == false)
+    // Rebias the exponent from 127 to 15 and round the mantissa to 10 bits, a carry moves into the exponent
+    uint32_t half = (abs_bits - 0x38000000) >> 13;
+    uint32_t rest = abs_bits & 0x1FFF;
+    if (rest > 0x1000 || (rest == 0x1000 && (half & 1) != 0))
     {
-        if (xyz_image_data == 0)
+        half++;
+    }
+    return (uint16_t)(sign | half);
+}
+
+// Converts count pixels to a float point cloud format, the reference for the SIMD kernels below
+static void transformation_depth_to_points_c(const float *x_table,
+                                             const float *y_table,
+                                             const uint16_t *depth_image_data,
+                                             k4a_point_cloud_format_t format,
+                                             uint8_t *points,
+                                             int count)
+{
+    int point_size = transformation_point_cloud_format_size(format);
+
+    for (int i = 0; i < count; i++)
+    {
+        float point[4] = { 0.f, 0.f, 0.f, 0.f };
+        if (!isnan(x_table[i]))
         {
-            LOG_ERROR("XYZ image data is null.", 0);
+            point[2] = (float)depth_image_data[i];
+            point[0] = point[2] * x_table[i];
+            point[1] = point[2] * y_table[i];
+        }
+
+        uint8_t *destination = points + (size_t)i * (size_t)point_size;
+        if (format == K4A_POINT_CLOUD_FORMAT_FLOAT32_XYZ || format == K4A_POINT_CLOUD_FORMAT_FLOAT32_XYZW)
+        {
+            memcpy(destination, point, (size_t)point_size);
         }
         else
         {
-            LOG_ERROR("Unexpected XYZ image descriptor, see details above.", 0);
+            uint16_t point_half[4];
+            for (int j = 0; j < 4; j++)
+            {
+                point_half[j] = transformation_float_to_half(point[j]);
+            }
+            memcpy(destination, point_half, (size_t)point_size);
         }
-        return K4A_BUFFER_RESULT_TOO_SMALL;
     }
+}
 
-    if (depth_image_data == 0 || depth_image_descriptor == 0)
+#if defined(K4A_USING_SSE)
+// Computes 4 pixels starting at offset, transposed to 4 vectors of x, y, z, 0
+static inline void transformation_depth_to_points_block_sse(const float *x_table,
+                                                            const float *y_table,
+                                                            const uint16_t *depth_image_data,
+                                                            int offset,
+                                                            __m128 point[4])
+{
+    __m128 x_tab = _mm_loadu_ps(x_table + offset);
+    __m128 valid = _mm_cmpeq_ps(x_tab, x_tab);
+    __m128i depth = _mm_cvtepu16_epi32(_mm_loadl_epi64((const __m128i *)(depth_image_data + offset)));
+
+    __m128 z = _mm_and_ps(valid, _mm_cvtepi32_ps(depth));
+    __m128 x = _mm_and_ps(valid, _mm_mul_ps(z, x_tab));
+    __m128 y = _mm_and_ps(valid, _mm_mul_ps(z, _mm_loadu_ps(y_table + offset)));
+    __m128 w = _mm_setzero_ps();
+    _MM_TRANSPOSE4_PS(x, y, z, w);
+
+    point[0] = x;
+    point[1] = y;
+    point[2] = z;
+    point[3] = w;
+}
+
+// Stores the 4 x, y, z, w vectors of transformation_depth_to_points_block_sse() as 4 points of a float32 format
+static inline void
+transformation_store_float_points_sse(const __m128 point[4], k4a_point_cloud_format_t format, uint8_t *points)
+{
+    float *destination = (float *)(void *)points;
+    if (format == K4A_POINT_CLOUD_FORMAT_FLOAT32_XYZW)
     {
-        if (depth_image_data == 0)
+        for (int j = 0; j < 4; j++)
         {
-            LOG_ERROR("Depth image data is null.", 0);
+            _mm_storeu_ps(destination + 4 * j, point[j]);
         }
-        return K4A_BUFFER_RESULT_FAILED;
     }
+    else
+    {
+        // The padding of each of the first 3 points is overwritten by the next one, the last stops at z
+        for (int j = 0; j < 3; j++)
+        {
+            _mm_storeu_ps(destination + 3 * j, point[j]);
+        }
+        _mm_storel_pi((__m64 *)(void *)(destination + 9), point[3]);
+        _mm_store_ss(destination + 11, _mm_movehl_ps(point[3], point[3]));
+    }
+}
 
-    k4a_transformation_image_descriptor_t expected_depth_image_descriptor = transformation_init_image_descriptor(
-        xy_tables->width, xy_tables->height, xy_tables->width * (int)sizeof(uint16_t), K4A_IMAGE_FORMAT_DEPTH16);
+// Converts count / 4 blocks of 4 pixels to a float32 point cloud format
+static void transformation_depth_to_points_sse(const float *x_table,
+                                               const float *y_table,
+                                               const uint16_t *depth_image_data,
+                                               k4a_point_cloud_format_t format,
+                                               uint8_t *points,
+                                               int count)
+{
+    int point_size = transformation_point_cloud_format_size(format);
+    for (int i = 0; i < count / 4; i++)
+    {
+        int offset = i * 4;
+        __m128 point[4];
+        transformation_depth_to_points_block_sse(x_table, y_table, depth_image_data, offset, point);
+        transformation_store_float_points_sse(point, format, points + (size_t)offset * (size_t)point_size);
+    }
+}
 
-    if (transformation_compare_image_descriptors(depth_image_descriptor, &expected_depth_image_descriptor) == false)
+// Same as transformation_depth_to_points_sse for the float16 formats, for CPUs with half precision conversions
+K4A_TARGET_F16C static void transformation_depth_to_points_f16c(const float *x_table,
+                                                                const float *y_table,
+                                                                const uint16_t *depth_image_data,
+                                                                k4a_point_cloud_format_t format,
+                                                                uint8_t *points,
+                                                                int count)
+{
+    for (int i = 0; i < count / 4; i++)
     {
-        LOG_ERROR("Unexpected depth image descriptor, see details above.", 0);
-        return K4A_BUFFER_RESULT_FAILED;
+        int offset = i * 4;
+        __m128 point[4];
+        transformation_depth_to_points_block_sse(x_table, y_table, depth_image_data, offset, point);
+
+        __m128i point_half[4];
+        for (int j = 0; j < 4; j++)
+        {
+            point_half[j] = _mm_cvtps_ph(point[j], _MM_FROUND_TO_NEAREST_INT);
+        }
+
+        if (format == K4A_POINT_CLOUD_FORMAT_FLOAT16_XYZW)
+        {
+            __m128i *destination = (__m128i *)(void *)(points + (size_t)offset * 8);
+            _mm_storeu_si128(destination + 0, _mm_unpacklo_epi64(point_half[0], point_half[1]));
+            _mm_storeu_si128(destination + 1, _mm_unpacklo_epi64(point_half[2], point_half[3]));
+        }
+        else
+        {
+            // As with float32, each padding but the last is overwritten by the next point
+            uint8_t *destination = points + (size_t)offset * 6;
+            for (int j = 0; j < 3; j++)
+            {
+                _mm_storel_epi64((__m128i *)(void *)(destination + 6 * j), point_half[j]);
+            }
+            uint16_t last[4];
+            _mm_storel_epi64((__m128i *)(void *)last, point_half[3]);
+            memcpy(destination + 18, last, 6);
+        }
     }
+}
 
-    transformation_depth_to_xyz(xy_tables, (const void *)depth_image_data, (void *)xyz_image_data);
+#elif defined(K4A_USING_NEON)
+// Converts count / 4 blocks of 4 pixels to a float point cloud format
+static void transformation_depth_to_points_neon(const float *x_table,
+                                                const float *y_table,
+                                                const uint16_t *depth_image_data,
+                                                k4a_point_cloud_format_t format,
+                                                uint8_t *points,
+                                                int count)
+{
+    int point_size = transformation_point_cloud_format_size(format);
 
-    return K4A_BUFFER_RESULT_SUCCEEDED;
+    for (int i = 0; i < count / 4; i++)
+    {
+        int offset = i * 4;
+        float32x4_t x_tab = vld1q_f32(x_table + offset);
+        uint32x4_t valid = vceqq_f32(x_tab, x_tab);
+        float32x4_t depth = vcvtq_f32_u32(vmovl_u16(vld1_u16(depth_image_data + offset)));
+
+        // Multiply rather than multiply-add so the results match transformation_depth_to_points_c
+        float32x4_t z = vreinterpretq_f32_u32(vandq_u32(valid, vreinterpretq_u32_f32(depth)));
+        float32x4_t x = vreinterpretq_f32_u32(vandq_u32(valid, vreinterpretq_u32_f32(vmulq_f32(z, x_tab))));
+        float32x4_t y = vreinterpretq_f32_u32(
+            vandq_u32(valid, vreinterpretq_u32_f32(vmulq_f32(z, vld1q_f32(y_table + offset)))));
+
+        uint8_t *destination = points + (size_t)offset * (size_t)point_size;
+        switch (format)
+        {
+        case K4A_POINT_CLOUD_FORMAT_FLOAT32_XYZ:
+        {
+            float32x4x3_t store = { { x, y, z } };
+            vst3q_f32((float *)(void *)destination, store);
+            break;
+        }
+        case K4A_POINT_CLOUD_FORMAT_FLOAT32_XYZW:
+        {
+            float32x4x4_t store = { { x, y, z, vdupq_n_f32(0.f) } };
+            vst4q_f32((float *)(void *)destination, store);
+            break;
+        }
+        case K4A_POINT_CLOUD_FORMAT_FLOAT16_XYZ:
+        {
+            uint16x4x3_t store = { { vreinterpret_u16_f16(vcvt_f16_f32(x)),
+                                     vreinterpret_u16_f16(vcvt_f16_f32(y)),
+                                     vreinterpret_u16_f16(vcvt_f16_f32(z)) } };
+            vst3_u16((uint16_t *)(void *)destination, store);
+            break;
+        }
+        default:
+        {
+            uint16x4x4_t store = { { vreinterpret_u16_f16(vcvt_f16_f32(x)),
+                                     vreinterpret_u16_f16(vcvt_f16_f32(y)),
+                                     vreinterpret_u16_f16(vcvt_f16_f32(z)),
+                                     vdup_n_u16(0) } };
+            vst4_u16((uint16_t *)(void *)destination, store);
+            break;
+        }
+        }
+    }
+}
+#endif
+
+static void transformation_depth_to_points(const k4a_transformation_xy_tables_t *xy_tables,
+                                           const uint16_t *depth_image_data,
+                                           k4a_point_cloud_format_t format,
+                                           uint8_t *points)
+{
+    if (format == K4A_POINT_CLOUD_FORMAT_INT16_XYZ)
+    {
+        transformation_depth_to_xyz(xy_tables, depth_image_data, points);
+        return;
+    }
+
+    const float *x_table = xy_tables->x_table;
+    const float *y_table = xy_tables->y_table;
+    int count = xy_tables->width * xy_tables->height;
+    int done = 0;
+
+#if defined(K4A_USING_SSE)
+    if (format == K4A_POINT_CLOUD_FORMAT_FLOAT32_XYZ || format == K4A_POINT_CLOUD_FORMAT_FLOAT32_XYZW)
+    {
+        transformation_depth_to_points_sse(x_table, y_table, depth_image_data, format, points, count);
+        done = count / 4 * 4;
+    }
+    else if (transformation_cpu_features_t_get()->f16c)
+    {
+        transformation_depth_to_points_f16c(x_table, y_table, depth_image_data, format, points, count);
+        done = count / 4 * 4;
+    }
+#elif defined(K4A_USING_NEON)
+    transformation_depth_to_points_neon(x_table, y_table, depth_image_data, format, points, count);
+    done = count / 4 * 4;
+#endif
+
+    // The pixels left by the SIMD kernels, or all of them without one
+    int point_size = transformation_point_cloud_format_size(format);
+    transformation_depth_to_points_c(x_table + done,
+                                     y_table + done,
+                                     depth_image_data + done,
+                                     format,
+                                     points + (size_t)done * (size_t)point_size,
+                                     count - done);
+}
+
+k4a_buffer_result_t
+transformation_depth_image_to_point_cloud_internal(const k4a_transformation_xy_tables_t *xy_tables,
+                                                   const uint8_t *depth_image_data,
+                                                   const k4a_transformation_image_descriptor_t *depth_image_descriptor,
+                                                   k4a_point_cloud_format_t format,
+                                                   const k4a_rect_t *roi,
+                                                   uint8_t *xyz_image_data,
+                                                   k4a_transformation_image_descriptor_t *xyz_image_descriptor)
+{
+    if (xyz_image_descriptor == 0)
+    {
+        return K4A_BUFFER_RESULT_FAILED;
+    }
+
+    int point_size = transformation_point_cloud_format_size(format);
+    if (point_size == 0)
+    {
+        LOG_ERROR("Unexpected point cloud format %d.", format);
+        return K4A_BUFFER_RESULT_FAILED;
+    }
+
+    k4a_rect_t rect;
+    if (!transformation_get_roi(roi, xy_tables->width, xy_tables->height, &rect))
+    {
+        return K4A_BUFFER_RESULT_FAILED;
+    }
+
+    k4a_transformation_image_descriptor_t expected_xyz_image_descriptor = transformation_init_image_descriptor(
+        rect.width, rect.height, rect.width * point_size, xyz_image_descriptor->format);
+
+    if (xyz_image_data == 0 ||
+        transformation_compare_image_descriptors(xyz_image_descriptor, &expected_xyz_image_descriptor) == false)
+    {
+        if (xyz_image_data == 0)
+        {
+            LOG_ERROR("XYZ image data is null.", 0);
+        }
+        else
+        {
+            LOG_ERROR("Unexpected XYZ image descriptor, see details above.", 0);
+        }
+        return K4A_BUFFER_RESULT_TOO_SMALL;
+    }
+
+    if (depth_image_data == 0 || depth_image_descriptor == 0)
+    {
+        if (depth_image_data == 0)
+        {
+            LOG_ERROR("Depth image data is null.", 0);
+        }
+        return K4A_BUFFER_RESULT_FAILED;
+    }
+
+    k4a_transformation_image_descriptor_t expected_depth_image_descriptor = transformation_init_image_descriptor(
+        xy_tables->width, xy_tables->height, xy_tables->width * (int)sizeof(uint16_t), K4A_IMAGE_FORMAT_DEPTH16);
+
+    if (transformation_compare_image_descriptors(depth_image_descriptor, &expected_depth_image_descriptor) == false)
+    {
+        LOG_ERROR("Unexpected depth image descriptor, see details above.", 0);
+        return K4A_BUFFER_RESULT_FAILED;
+    }
+
+    const uint16_t *depth_image_data_uint16 = (const uint16_t *)(const void *)depth_image_data;
+    if (roi == NULL)
+    {
+        transformation_depth_to_points(xy_tables, depth_image_data_uint16, format, xyz_image_data);
+        return K4A_BUFFER_RESULT_SUCCEEDED;
+    }
+
+    // Each row of the region is a view of the tables and depth of the full image
+    k4a_transformation_xy_tables_t row_xy_tables = *xy_tables;
+    row_xy_tables.width = rect.width;
+    row_xy_tables.height = 1;
+    for (int y = 0; y < rect.height; y++)
+    {
+        size_t offset = (size_t)(rect.y + y) * (size_t)xy_tables->width + (size_t)rect.x;
+        row_xy_tables.x_table = xy_tables->x_table + offset;
+        row_xy_tables.y_table = xy_tables->y_table + offset;
+        transformation_depth_to_points(&row_xy_tables,
+                                       depth_image_data_uint16 + offset,
+                                       format,
+                                       xyz_image_data + (size_t)y * (size_t)xyz_image_descriptor->stride_bytes);
+    }
+
+    return K4A_BUFFER_RESULT_SUCCEEDED;
+}
+
+// Moves the points of an xyz row with z != 0 to its front, keeping their order, and copies the color and pixel index of
+// each kept point alongside when color_row or pixel_indices are not NULL. Returns the number of points kept.
+static size_t transformation_pack_valid_points_row(int16_t *xyz_row,
+                                                   int width,
+                                                   const uint8_t *color_row,
+                                                   uint8_t *bgra,
+                                                   uint32_t *pixel_indices,
+                                                   uint32_t first_pixel_index)
+{
+    size_t count = 0;
+    for (int x = 0; x < width; x++)
+    {
+        // z is 0 without depth and where the camera has no valid ray
+        if (xyz_row[3 * x + 2] == 0)
+        {
+            continue;
+        }
+
+        if (count != (size_t)x)
+        {
+            memcpy(xyz_row + 3 * count, xyz_row + 3 * x, 3 * sizeof(int16_t));
+        }
+        if (color_row != NULL)
+        {
+            memcpy(bgra + 4 * count, color_row + 4 * x, 4);
+        }
+        if (pixel_indices != NULL)
+        {
+            pixel_indices[count] = first_pixel_index + (uint32_t)x;
+        }
+        count++;
+    }
+    return count;
+}
+
+k4a_buffer_result_t transformation_depth_image_to_colored_point_cloud_internal(
+    const k4a_transformation_xy_tables_t *xy_tables_color_camera,
+    const uint8_t *depth_image_data,
+    const k4a_transformation_image_descriptor_t *depth_image_descriptor,
+    const uint8_t *color_image_data,
+    const k4a_transformation_image_descriptor_t *color_image_descriptor,
+    bool valid_points_only,
+    uint8_t *xyz_image_data,
+    k4a_transformation_image_descriptor_t *xyz_image_descriptor,
+    uint8_t *bgra_image_data,
+    k4a_transformation_image_descriptor_t *bgra_image_descriptor,
+    size_t *point_count)
+{
+    if (xyz_image_descriptor == 0 || bgra_image_descriptor == 0 || point_count == 0)
+    {
+        return K4A_BUFFER_RESULT_FAILED;
+    }
+
+    int width = xy_tables_color_camera->width;
+    int height = xy_tables_color_camera->height;
+
+    k4a_transformation_image_descriptor_t expected_xyz_image_descriptor = transformation_init_image_descriptor(
+        width, height, width * 3 * (int)sizeof(int16_t), xyz_image_descriptor->format);
+    k4a_transformation_image_descriptor_t expected_bgra_image_descriptor = transformation_init_image_descriptor(
+        width, height, width * 4 * (int)sizeof(uint8_t), K4A_IMAGE_FORMAT_COLOR_BGRA32);
+
+    if (xyz_image_data == 0 || bgra_image_data == 0 ||
+        transformation_compare_image_descriptors(xyz_image_descriptor, &expected_xyz_image_descriptor) == false ||
+        transformation_compare_image_descriptors(bgra_image_descriptor, &expected_bgra_image_descriptor) == false)
+    {
+        LOG_ERROR("Unexpected colored point cloud image data or descriptor, see details above.", 0);
+        return K4A_BUFFER_RESULT_TOO_SMALL;
+    }
+
+    if (depth_image_data == 0 || depth_image_descriptor == 0 || color_image_data == 0 || color_image_descriptor == 0)
+    {
+        LOG_ERROR("Depth or color image data is null.", 0);
+        return K4A_BUFFER_RESULT_FAILED;
+    }
+
+    k4a_transformation_image_descriptor_t expected_depth_image_descriptor = transformation_init_image_descriptor(
+        width, height, width * (int)sizeof(uint16_t), K4A_IMAGE_FORMAT_DEPTH16);
+
+    if (transformation_compare_image_descriptors(depth_image_descriptor, &expected_depth_image_descriptor) == false ||
+        transformation_compare_image_descriptors(color_image_descriptor, &expected_bgra_image_descriptor) == false)
+    {
+        LOG_ERROR("Unexpected depth or color image descriptor, see details above.", 0);
+        return K4A_BUFFER_RESULT_FAILED;
+    }
+
+    k4a_transformation_xy_tables_t row_xy_tables = *xy_tables_color_camera;
+    row_xy_tables.height = 1;
+
+    int16_t *xyz_data_int16 = (int16_t *)(void *)xyz_image_data;
+    size_t count = 0;
+    for (int y = 0; y < height; y++)
+    {
+        size_t row_offset = (size_t)y * (size_t)width;
+        const uint16_t *depth_row = (const uint16_t *)(const void *)depth_image_data + row_offset;
+        const uint8_t *color_row = color_image_data + 4 * row_offset;
+        row_xy_tables.x_table = xy_tables_color_camera->x_table + row_offset;
+        row_xy_tables.y_table = xy_tables_color_camera->y_table + row_offset;
+
+        if (!valid_points_only)
+        {
+            transformation_depth_to_xyz(&row_xy_tables, depth_row, xyz_data_int16 + 3 * row_offset);
+            memcpy(bgra_image_data + 4 * row_offset, color_row, (size_t)width * 4);
+            continue;
+        }
+
+        // count never exceeds row_offset, so the row is converted right after the points already packed
+        transformation_depth_to_xyz(&row_xy_tables, depth_row, xyz_data_int16 + 3 * count);
+        count += transformation_pack_valid_points_row(
+            xyz_data_int16 + 3 * count, width, color_row, bgra_image_data + 4 * count, NULL, 0);
+    }
+
+    *point_count = valid_points_only ? count : (size_t)width * (size_t)height;
+    return K4A_BUFFER_RESULT_SUCCEEDED;
+}
+
+k4a_buffer_result_t transformation_depth_image_to_valid_point_cloud_internal(
+    const k4a_transformation_xy_tables_t *xy_tables,
+    const uint8_t *depth_image_data,
+    const k4a_transformation_image_descriptor_t *depth_image_descriptor,
+    uint8_t *xyz_image_data,
+    k4a_transformation_image_descriptor_t *xyz_image_descriptor,
+    uint32_t *pixel_indices,
+    size_t *point_count)
+{
+    if (xyz_image_descriptor == 0 || point_count == 0)
+    {
+        return K4A_BUFFER_RESULT_FAILED;
+    }
+
+    int width = xy_tables->width;
+    int height = xy_tables->height;
+
+    k4a_transformation_image_descriptor_t expected_xyz_image_descriptor = transformation_init_image_descriptor(
+        width, height, width * 3 * (int)sizeof(int16_t), xyz_image_descriptor->format);
+
+    if (xyz_image_data == 0 ||
+        transformation_compare_image_descriptors(xyz_image_descriptor, &expected_xyz_image_descriptor) == false)
+    {
+        if (xyz_image_data == 0)
+        {
+            LOG_ERROR("XYZ image data is null.", 0);
+        }
+        else
+        {
+            LOG_ERROR("Unexpected XYZ image descriptor, see details above.", 0);
+        }
+        return K4A_BUFFER_RESULT_TOO_SMALL;
+    }
+
+    if (depth_image_data == 0 || depth_image_descriptor == 0)
+    {
+        if (depth_image_data == 0)
+        {
+            LOG_ERROR("Depth image data is null.", 0);
+        }
+        return K4A_BUFFER_RESULT_FAILED;
+    }
+
+    k4a_transformation_image_descriptor_t expected_depth_image_descriptor = transformation_init_image_descriptor(
+        width, height, width * (int)sizeof(uint16_t), K4A_IMAGE_FORMAT_DEPTH16);
+
+    if (transformation_compare_image_descriptors(depth_image_descriptor, &expected_depth_image_descriptor) == false)
+    {
+        LOG_ERROR("Unexpected depth image descriptor, see details above.", 0);
+        return K4A_BUFFER_RESULT_FAILED;
+    }
+
+    k4a_transformation_xy_tables_t row_xy_tables = *xy_tables;
+    row_xy_tables.height = 1;
+
+    int16_t *xyz_data_int16 = (int16_t *)(void *)xyz_image_data;
+    size_t count = 0;
+    for (int y = 0; y < height; y++)
+    {
+        size_t row_offset = (size_t)y * (size_t)width;
+        row_xy_tables.x_table = xy_tables->x_table + row_offset;
+        row_xy_tables.y_table = xy_tables->y_table + row_offset;
+
+        // count never exceeds row_offset, so the row is converted right after the points already packed
+        transformation_depth_to_xyz(&row_xy_tables,
+                                    (const uint16_t *)(const void *)depth_image_data + row_offset,
+                                    xyz_data_int16 + 3 * count);
+        count += transformation_pack_valid_points_row(xyz_data_int16 + 3 * count,
+                                                      width,
+                                                      NULL,
+                                                      NULL,
+                                                      pixel_indices == NULL ? NULL : pixel_indices + count,
+                                                      (uint32_t)row_offset);
+    }
+
+    *point_count = count;
+    return K4A_BUFFER_RESULT_SUCCEEDED;
+}
+
+// Converts count pixels to float32 points of the common frame, (0, 0, 0) where there is no depth. The reference for
+// the SIMD kernels below.
+static void transformation_fuse_points_c(const float *x_table,
+                                         const float *y_table,
+                                         const uint16_t *depth_image_data,
+                                         const k4a_calibration_extrinsics_t *depth_to_common,
+                                         int point_size,
+                                         uint8_t *points,
+                                         int count)
+{
+    const float *r = depth_to_common->rotation;
+    const float *t = depth_to_common->translation;
+    for (int i = 0; i < count; i++)
+    {
+        float point[4] = { 0.f, 0.f, 0.f, 0.f };
+        if (!isnan(x_table[i]) && depth_image_data[i] != 0)
+        {
+            float z = (float)depth_image_data[i];
+            float x = z * x_table[i];
+            float y = z * y_table[i];
+            point[0] = r[0] * x + r[1] * y + r[2] * z + t[0];
+            point[1] = r[3] * x + r[4] * y + r[5] * z + t[1];
+            point[2] = r[6] * x + r[7] * y + r[8] * z + t[2];
+        }
+        memcpy(points + (size_t)i * (size_t)point_size, point, (size_t)point_size);
+    }
+}
+
+#if defined(K4A_USING_SSE)
+// Converts count / 4 blocks of 4 pixels, multiplying and adding in the order of transformation_fuse_points_c
+static void transformation_fuse_points_sse(const float *x_table,
+                                           const float *y_table,
+                                           const uint16_t *depth_image_data,
+                                           const k4a_calibration_extrinsics_t *depth_to_common,
+                                           k4a_point_cloud_format_t format,
+                                           uint8_t *points,
+                                           int count)
+{
+    __m128 r[9];
+    __m128 t[3];
+    for (int j = 0; j < 9; j++)
+    {
+        r[j] = _mm_set1_ps(depth_to_common->rotation[j]);
+    }
+    for (int j = 0; j < 3; j++)
+    {
+        t[j] = _mm_set1_ps(depth_to_common->translation[j]);
+    }
+
+    int point_size = transformation_point_cloud_format_size(format);
+    for (int i = 0; i < count / 4; i++)
+    {
+        int offset = i * 4;
+        __m128 x_tab = _mm_loadu_ps(x_table + offset);
+        __m128i depth = _mm_cvtepu16_epi32(_mm_loadl_epi64((const __m128i *)(depth_image_data + offset)));
+        __m128 z = _mm_cvtepi32_ps(depth);
+        __m128 valid = _mm_and_ps(_mm_cmpeq_ps(x_tab, x_tab), _mm_cmpgt_ps(z, _mm_setzero_ps()));
+        __m128 x = _mm_mul_ps(z, x_tab);
+        __m128 y = _mm_mul_ps(z, _mm_loadu_ps(y_table + offset));
+
+        __m128 point[4];
+        for (int j = 0; j < 3; j++)
+        {
+            __m128 sum = _mm_add_ps(_mm_mul_ps(r[3 * j], x), _mm_mul_ps(r[3 * j + 1], y));
+            sum = _mm_add_ps(_mm_add_ps(sum, _mm_mul_ps(r[3 * j + 2], z)), t[j]);
+            point[j] = _mm_and_ps(valid, sum);
+        }
+        point[3] = _mm_setzero_ps();
+        _MM_TRANSPOSE4_PS(point[0], point[1], point[2], point[3]);
+        transformation_store_float_points_sse(point, format, points + (size_t)offset * (size_t)point_size);
+    }
+}
+
+#elif defined(K4A_USING_NEON)
+// Converts count / 4 blocks of 4 pixels, multiplying and adding in the order of transformation_fuse_points_c
+static void transformation_fuse_points_neon(const float *x_table,
+                                            const float *y_table,
+                                            const uint16_t *depth_image_data,
+                                            const k4a_calibration_extrinsics_t *depth_to_common,
+                                            k4a_point_cloud_format_t format,
+                                            uint8_t *points,
+                                            int count)
+{
+    const float *r = depth_to_common->rotation;
+    const float *t = depth_to_common->translation;
+    int point_size = transformation_point_cloud_format_size(format);
+    for (int i = 0; i < count / 4; i++)
+    {
+        int offset = i * 4;
+        float32x4_t x_tab = vld1q_f32(x_table + offset);
+        float32x4_t z = vcvtq_f32_u32(vmovl_u16(vld1_u16(depth_image_data + offset)));
+        uint32x4_t valid = vandq_u32(vceqq_f32(x_tab, x_tab), vcgtq_f32(z, vdupq_n_f32(0.f)));
+        float32x4_t x = vmulq_f32(z, x_tab);
+        float32x4_t y = vmulq_f32(z, vld1q_f32(y_table + offset));
+
+        float32x4_t point[3];
+        for (int j = 0; j < 3; j++)
+        {
+            float32x4_t sum = vaddq_f32(vmulq_n_f32(x, r[3 * j]), vmulq_n_f32(y, r[3 * j + 1]));
+            sum = vaddq_f32(vaddq_f32(sum, vmulq_n_f32(z, r[3 * j + 2])), vdupq_n_f32(t[j]));
+            point[j] = vreinterpretq_f32_u32(vandq_u32(valid, vreinterpretq_u32_f32(sum)));
+        }
+
+        float *destination = (float *)(void *)(points + (size_t)offset * (size_t)point_size);
+        if (format == K4A_POINT_CLOUD_FORMAT_FLOAT32_XYZW)
+        {
+            float32x4x4_t store = { { point[0], point[1], point[2], vdupq_n_f32(0.f) } };
+            vst4q_f32(destination, store);
+        }
+        else
+        {
+            float32x4x3_t store = { { point[0], point[1], point[2] } };
+            vst3q_f32(destination, store);
+        }
+    }
+}
+#endif
+
+static void transformation_fuse_points(const float *x_table,
+                                       const float *y_table,
+                                       const uint16_t *depth_image_data,
+                                       const k4a_calibration_extrinsics_t *depth_to_common,
+                                       k4a_point_cloud_format_t format,
+                                       uint8_t *points,
+                                       int count)
+{
+    int done = 0;
+#if defined(K4A_USING_SSE)
+    transformation_fuse_points_sse(x_table, y_table, depth_image_data, depth_to_common, format, points, count);
+    done = count / 4 * 4;
+#elif defined(K4A_USING_NEON)
+    transformation_fuse_points_neon(x_table, y_table, depth_image_data, depth_to_common, format, points, count);
+    done = count / 4 * 4;
+#endif
+
+    int point_size = transformation_point_cloud_format_size(format);
+    transformation_fuse_points_c(x_table + done,
+                                 y_table + done,
+                                 depth_image_data + done,
+                                 depth_to_common,
+                                 point_size,
+                                 points + (size_t)done * (size_t)point_size,
+                                 count - done);
+}
+
+// Moves the points of a fused row whose pixel has depth to its front, keeping their order, and copies their colors
+// alongside when color_row is not NULL. Returns the number of points kept.
+static size_t transformation_pack_fused_points_row(uint8_t *points,
+                                                   int point_size,
+                                                   const float *x_table,
+                                                   const uint16_t *depth_row,
+                                                   int width,
+                                                   const uint8_t *color_row,
+                                                   uint8_t *bgra)
+{
+    size_t count = 0;
+    for (int x = 0; x < width; x++)
+    {
+        // A point of the common frame can have any coordinate 0, so validity comes from the pixel
+        if (depth_row[x] == 0 || isnan(x_table[x]))
+        {
+            continue;
+        }
+
+        if (count != (size_t)x)
+        {
+            memcpy(points + count * (size_t)point_size, points + (size_t)x * (size_t)point_size, (size_t)point_size);
+        }
+        if (color_row != NULL)
+        {
+            memcpy(bgra + 4 * count, color_row + 4 * x, 4);
+        }
+        count++;
+    }
+    return count;
+}
+
+typedef struct _k4a_transformation_fusion_band_t
+{
+    const k4a_transformation_fusion_source_t *source;
+    int y_begin; // Rows of the source depth image
+    int y_end;
+    size_t first_point; // Index of the first pixel of the band among the pixels of all sources
+    size_t count;       // Points written from first_point on
+} k4a_transformation_fusion_band_t;
+
+typedef struct _k4a_transformation_fusion_context_t
+{
+    k4a_transformation_fusion_band_t *bands;
+    k4a_point_cloud_format_t format;
+    bool valid_points_only;
+    uint8_t *xyz_image_data;
+    uint8_t *bgra_image_data;
+} k4a_transformation_fusion_context_t;
+
+static void transformation_fuse_band_task(void *task_context, uint32_t index)
+{
+    const k4a_transformation_fusion_context_t *context = (const k4a_transformation_fusion_context_t *)task_context;
+    k4a_transformation_fusion_band_t *band = &context->bands[index];
+    const k4a_transformation_fusion_source_t *source = band->source;
+    const k4a_transformation_xy_tables_t *xy_tables = source->xy_tables;
+    const uint16_t *depth_image_data = (const uint16_t *)(const void *)source->depth_image_data;
+    const uint8_t *color_image_data = context->bgra_image_data != NULL ? source->color_image_data : NULL;
+    int width = xy_tables->width;
+    int point_size = transformation_point_cloud_format_size(context->format);
+
+    size_t count = 0;
+    for (int y = band->y_begin; y < band->y_end; y++)
+    {
+        // count never exceeds the pixels of the rows before, so a row is converted right after the points kept
+        size_t row_offset = (size_t)y * (size_t)width;
+        size_t first = band->first_point + count;
+        uint8_t *points = context->xyz_image_data + first * (size_t)point_size;
+        transformation_fuse_points(xy_tables->x_table + row_offset,
+                                   xy_tables->y_table + row_offset,
+                                   depth_image_data + row_offset,
+                                   &source->depth_to_common,
+                                   context->format,
+                                   points,
+                                   width);
+
+        const uint8_t *color_row = color_image_data != NULL ? color_image_data + 4 * row_offset : NULL;
+        uint8_t *bgra = color_row != NULL ? context->bgra_image_data + 4 * first : NULL;
+        if (!context->valid_points_only)
+        {
+            if (color_row != NULL)
+            {
+                memcpy(bgra, color_row, (size_t)width * 4);
+            }
+            count += (size_t)width;
+            continue;
+        }
+
+        count += transformation_pack_fused_points_row(
+            points, point_size, xy_tables->x_table + row_offset, depth_image_data + row_offset, width, color_row, bgra);
+    }
+    band->count = count;
+}
+
+k4a_buffer_result_t
+transformation_fuse_point_clouds_internal(const k4a_transformation_fusion_source_t *sources,
+                                          uint32_t source_count,
+                                          k4a_point_cloud_format_t format,
+                                          bool valid_points_only,
+                                          uint8_t *xyz_image_data,
+                                          k4a_transformation_image_descriptor_t *xyz_image_descriptor,
+                                          uint8_t *bgra_image_data,
+                                          k4a_transformation_image_descriptor_t *bgra_image_descriptor,
+                                          size_t *point_count)
+{
+    if (sources == 0 || source_count == 0 || xyz_image_descriptor == 0 || point_count == 0)
+    {
+        return K4A_BUFFER_RESULT_FAILED;
+    }
+
+    if (format != K4A_POINT_CLOUD_FORMAT_FLOAT32_XYZ && format != K4A_POINT_CLOUD_FORMAT_FLOAT32_XYZW)
+    {
+        LOG_ERROR("Unexpected fused point cloud format %d, expected a float32 format.", format);
+        return K4A_BUFFER_RESULT_FAILED;
+    }
+    int point_size = transformation_point_cloud_format_size(format);
+
+    size_t pixel_count = 0;
+    uint32_t band_count = 0;
+    for (uint32_t i = 0; i < source_count; i++)
+    {
+        const k4a_transformation_fusion_source_t *source = &sources[i];
+        const k4a_transformation_xy_tables_t *xy_tables = source->xy_tables;
+        if (xy_tables == 0 || source->depth_image_data == 0 || source->depth_image_descriptor == 0)
+        {
+            LOG_ERROR("Depth image data of fused source %u is null.", i);
+            return K4A_BUFFER_RESULT_FAILED;
+        }
+
+        k4a_transformation_image_descriptor_t expected_depth_image_descriptor = transformation_init_image_descriptor(
+            xy_tables->width, xy_tables->height, xy_tables->width * (int)sizeof(uint16_t), K4A_IMAGE_FORMAT_DEPTH16);
+        if (transformation_compare_image_descriptors(source->depth_image_descriptor,
+                                                     &expected_depth_image_descriptor) == false)
+        {
+            LOG_ERROR("Unexpected depth image descriptor of fused source %u, see details above.", i);
+            return K4A_BUFFER_RESULT_FAILED;
+        }
+
+        if (bgra_image_data != 0)
+        {
+            k4a_transformation_image_descriptor_t expected_color_image_descriptor =
+                transformation_init_image_descriptor(xy_tables->width,
+                                                     xy_tables->height,
+                                                     xy_tables->width * 4 * (int)sizeof(uint8_t),
+                                                     K4A_IMAGE_FORMAT_COLOR_BGRA32);
+            if (source->color_image_data == 0 || source->color_image_descriptor == 0 ||
+                transformation_compare_image_descriptors(source->color_image_descriptor,
+                                                         &expected_color_image_descriptor) == false)
+            {
+                LOG_ERROR("Fused source %u needs a color image in the depth camera geometry, see details above.", i);
+                return K4A_BUFFER_RESULT_FAILED;
+            }
+        }
+
+        pixel_count += (size_t)xy_tables->width * (size_t)xy_tables->height;
+        uint32_t source_band_count = source->band_count;
+        if (source_band_count > (uint32_t)xy_tables->height)
+        {
+            source_band_count = (uint32_t)xy_tables->height;
+        }
+        band_count += source_band_count < 1 ? 1 : source_band_count;
+    }
+
+    // The points are one row of an image, whose stride is an int
+    if (pixel_count > (size_t)INT_MAX / 16)
+    {
+        LOG_ERROR("Too many pixels to fuse, %zu.", pixel_count);
+        return K4A_BUFFER_RESULT_FAILED;
+    }
+
+    k4a_transformation_image_descriptor_t expected_xyz_image_descriptor = transformation_init_image_descriptor(
+        (int)pixel_count, 1, (int)pixel_count * point_size, xyz_image_descriptor->format);
+    k4a_transformation_image_descriptor_t expected_bgra_image_descriptor = transformation_init_image_descriptor(
+        (int)pixel_count, 1, (int)pixel_count * 4, K4A_IMAGE_FORMAT_COLOR_BGRA32);
+
+    if (xyz_image_data == 0 ||
+        transformation_compare_image_descriptors(xyz_image_descriptor, &expected_xyz_image_descriptor) == false ||
+        (bgra_image_data != 0 &&
+         (bgra_image_descriptor == 0 ||
+          transformation_compare_image_descriptors(bgra_image_descriptor, &expected_bgra_image_descriptor) == false)))
+    {
+        LOG_ERROR("Unexpected fused point cloud image data or descriptor, see details above.", 0);
+        return K4A_BUFFER_RESULT_TOO_SMALL;
+    }
+
+    k4a_transformation_fusion_band_t *bands = (k4a_transformation_fusion_band_t *)malloc(band_count * sizeof(*bands));
+    if (bands == NULL)
+    {
+        LOG_ERROR("Failed to allocate %u fused point cloud bands.", band_count);
+        return K4A_BUFFER_RESULT_FAILED;
+    }
+
+    // Bands split each source into runs of rows, their points land where the pixels of the band are in the output
+    uint32_t band = 0;
+    size_t first_point = 0;
+    for (uint32_t i = 0; i < source_count; i++)
+    {
+        const k4a_transformation_fusion_source_t *source = &sources[i];
+        int width = source->xy_tables->width;
+        int height = source->xy_tables->height;
+        int source_band_count = (int)source->band_count;
+        source_band_count = source_band_count > height ? height : (source_band_count < 1 ? 1 : source_band_count);
+        for (int j = 0; j < source_band_count; j++, band++)
+        {
+            bands[band].source = source;
+            bands[band].y_begin = (int)((int64_t)height * j / source_band_count);
+            bands[band].y_end = (int)((int64_t)height * (j + 1) / source_band_count);
+            bands[band].first_point = first_point + (size_t)bands[band].y_begin * (size_t)width;
+            bands[band].count = 0;
+        }
+        first_point += (size_t)width * (size_t)height;
+    }
+
+    k4a_transformation_fusion_context_t context;
+    context.bands = bands;
+    context.format = format;
+    context.valid_points_only = valid_points_only;
+    context.xyz_image_data = xyz_image_data;
+    context.bgra_image_data = bgra_image_data;
+    threadpool_parallel_for(transformation_fuse_band_task, &context, band_count);
+
+    // Each band packed its points to its own front, which only leaves joining them up
+    size_t count = 0;
+    for (uint32_t i = 0; i < band_count; i++)
+    {
+        if (count != bands[i].first_point && bands[i].count != 0)
+        {
+            memmove(xyz_image_data + count * (size_t)point_size,
+                    xyz_image_data + bands[i].first_point * (size_t)point_size,
+                    bands[i].count * (size_t)point_size);
+            if (bgra_image_data != 0)
+            {
+                memmove(bgra_image_data + 4 * count, bgra_image_data + 4 * bands[i].first_point, 4 * bands[i].count);
+            }
+        }
+        count += bands[i].count;
+    }
+    free(bands);
+
+    *point_count = count;
+    return K4A_BUFFER_RESULT_SUCCEEDED;
+}
+
+// A neighbor further than this ratio of the center depth from it is taken to be on another surface. The neighbors of
+// a normal are 2 pixels apart, so this is twice the ratio undistortion uses for adjacent pixels.
+#define TRANSFORMATION_NORMAL_DEPTH_DISCONTINUITY_RATIO 0.09386883518f
+
+// Planar float copy of a row of int16 xyz points
+static void transformation_deinterleave_xyz_row(const int16_t *xyz_row, int width, float *planes[3])
+{
+    for (int x = 0; x < width; x++)
+    {
+        planes[0][x] = (float)xyz_row[3 * x + 0];
+        planes[1][x] = (float)xyz_row[3 * x + 1];
+        planes[2][x] = (float)xyz_row[3 * x + 2];
+    }
+}
+
+// Writes the unit normal of the pixels [begin, end) of the center row of rows, each row being planar x, y and z. The
+// normal faces the camera, it is 0 where the pixel or one of its 4 neighbors has no depth or is across an edge.
+static void transformation_normals_row_c(float *const rows[3][3], int begin, int end, float *normals)
+{
+    float *const *up = rows[0];
+    float *const *center = rows[1];
+    float *const *down = rows[2];
+    for (int i = begin; i < end; i++)
+    {
+        float normal[3] = { 0.f, 0.f, 0.f };
+        float z = center[2][i];
+        float limit = TRANSFORMATION_NORMAL_DEPTH_DISCONTINUITY_RATIO * z;
+
+        // A neighbor without depth is further than the limit from any center with depth
+        if (z > 0.f && fabsf(center[2][i - 1] - z) <= limit && fabsf(center[2][i + 1] - z) <= limit &&
+            fabsf(up[2][i] - z) <= limit && fabsf(down[2][i] - z) <= limit)
+        {
+            float a[3];
+            float b[3];
+            for (int j = 0; j < 3; j++)
+            {
+                a[j] = center[j][i + 1] - center[j][i - 1];
+                b[j] = down[j][i] - up[j][i];
+            }
+
+            // b x a, as a x b points away from the camera with x right, y down and z forward
+            float n[3] = { b[1] * a[2] - b[2] * a[1], b[2] * a[0] - b[0] * a[2], b[0] * a[1] - b[1] * a[0] };
+            float length = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            if (length > 0.f)
+            {
+                float scale = 1.f / length;
+                for (int j = 0; j < 3; j++)
+                {
+                    normal[j] = n[j] * scale;
+                }
+            }
+        }
+        memcpy(normals + 3 * i, normal, sizeof(normal));
+    }
+}
+
+#if defined(K4A_USING_SSE)
+// transformation_normals_row_c for 4 pixels at a time from begin, with the same operations in the same order. Returns
+// the first pixel left.
+static int transformation_normals_row_sse(float *const rows[3][3], int begin, int end, float *normals)
+{
+    const __m128 ratio = _mm_set1_ps(TRANSFORMATION_NORMAL_DEPTH_DISCONTINUITY_RATIO);
+    const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    int i = begin;
+    for (; i + 4 <= end; i += 4)
+    {
+        __m128 z = _mm_loadu_ps(rows[1][2] + i);
+        __m128 limit = _mm_mul_ps(ratio, z);
+        __m128 valid = _mm_cmpgt_ps(z, _mm_setzero_ps());
+        const float *neighbors[4] = { rows[1][2] + i - 1, rows[1][2] + i + 1, rows[0][2] + i, rows[2][2] + i };
+        for (int j = 0; j < 4; j++)
+        {
+            __m128 difference = _mm_and_ps(abs_mask, _mm_sub_ps(_mm_loadu_ps(neighbors[j]), z));
+            valid = _mm_and_ps(valid, _mm_cmple_ps(difference, limit));
+        }
+
+        __m128 a[3];
+        __m128 b[3];
+        for (int j = 0; j < 3; j++)
+        {
+            a[j] = _mm_sub_ps(_mm_loadu_ps(rows[1][j] + i + 1), _mm_loadu_ps(rows[1][j] + i - 1));
+            b[j] = _mm_sub_ps(_mm_loadu_ps(rows[2][j] + i), _mm_loadu_ps(rows[0][j] + i));
+        }
+
+        __m128 n[4];
+        n[0] = _mm_sub_ps(_mm_mul_ps(b[1], a[2]), _mm_mul_ps(b[2], a[1]));
+        n[1] = _mm_sub_ps(_mm_mul_ps(b[2], a[0]), _mm_mul_ps(b[0], a[2]));
+        n[2] = _mm_sub_ps(_mm_mul_ps(b[0], a[1]), _mm_mul_ps(b[1], a[0]));
+        __m128 length = _mm_sqrt_ps(
+            _mm_add_ps(_mm_add_ps(_mm_mul_ps(n[0], n[0]), _mm_mul_ps(n[1], n[1])), _mm_mul_ps(n[2], n[2])));
+        valid = _mm_and_ps(valid, _mm_cmpgt_ps(length, _mm_setzero_ps()));
+        __m128 scale = _mm_div_ps(_mm_set1_ps(1.f), length);
+        for (int j = 0; j < 3; j++)
+        {
+            n[j] = _mm_and_ps(valid, _mm_mul_ps(n[j], scale));
+        }
+        n[3] = _mm_setzero_ps();
+        _MM_TRANSPOSE4_PS(n[0], n[1], n[2], n[3]);
+        transformation_store_float_points_sse(
+            n, K4A_POINT_CLOUD_FORMAT_FLOAT32_XYZ, (uint8_t *)(void *)(normals + 3 * i));
+    }
+    return i;
+}
+
+#elif defined(K4A_USING_NEON)
+// transformation_normals_row_c for 4 pixels at a time from begin, with the same operations in the same order. Returns
+// the first pixel left.
+static int transformation_normals_row_neon(float *const rows[3][3], int begin, int end, float *normals)
+{
+    int i = begin;
+    for (; i + 4 <= end; i += 4)
+    {
+        float32x4_t z = vld1q_f32(rows[1][2] + i);
+        float32x4_t limit = vmulq_n_f32(z, TRANSFORMATION_NORMAL_DEPTH_DISCONTINUITY_RATIO);
+        uint32x4_t valid = vcgtq_f32(z, vdupq_n_f32(0.f));
+        const float *neighbors[4] = { rows[1][2] + i - 1, rows[1][2] + i + 1, rows[0][2] + i, rows[2][2] + i };
+        for (int j = 0; j < 4; j++)
+        {
+            valid = vandq_u32(valid, vcleq_f32(vabsq_f32(vsubq_f32(vld1q_f32(neighbors[j]), z)), limit));
+        }
+
+        float32x4_t a[3];
+        float32x4_t b[3];
+        for (int j = 0; j < 3; j++)
+        {
+            a[j] = vsubq_f32(vld1q_f32(rows[1][j] + i + 1), vld1q_f32(rows[1][j] + i - 1));
+            b[j] = vsubq_f32(vld1q_f32(rows[2][j] + i), vld1q_f32(rows[0][j] + i));
+        }
+
+        float32x4_t n[3];
+        n[0] = vsubq_f32(vmulq_f32(b[1], a[2]), vmulq_f32(b[2], a[1]));
+        n[1] = vsubq_f32(vmulq_f32(b[2], a[0]), vmulq_f32(b[0], a[2]));
+        n[2] = vsubq_f32(vmulq_f32(b[0], a[1]), vmulq_f32(b[1], a[0]));
+        float32x4_t length = vsqrtq_f32(
+            vaddq_f32(vaddq_f32(vmulq_f32(n[0], n[0]), vmulq_f32(n[1], n[1])), vmulq_f32(n[2], n[2])));
+        valid = vandq_u32(valid, vcgtq_f32(length, vdupq_n_f32(0.f)));
+        float32x4_t scale = vdivq_f32(vdupq_n_f32(1.f), length);
+        for (int j = 0; j < 3; j++)
+        {
+            n[j] = vreinterpretq_f32_u32(vandq_u32(valid, vreinterpretq_u32_f32(vmulq_f32(n[j], scale))));
+        }
+        float32x4x3_t store = { { n[0], n[1], n[2] } };
+        vst3q_f32(normals + 3 * i, store);
+    }
+    return i;
+}
+#endif
+
+k4a_buffer_result_t
+transformation_point_cloud_to_normals_internal(const uint8_t *xyz_image_data,
+                                               const k4a_transformation_image_descriptor_t *xyz_image_descriptor,
+                                               uint8_t *normal_image_data,
+                                               k4a_transformation_image_descriptor_t *normal_image_descriptor)
+{
+    if (xyz_image_descriptor == 0 || normal_image_descriptor == 0)
+    {
+        return K4A_BUFFER_RESULT_FAILED;
+    }
+
+    int width = xyz_image_descriptor->width_pixels;
+    int height = xyz_image_descriptor->height_pixels;
+    k4a_transformation_image_descriptor_t expected_normal_image_descriptor = transformation_init_image_descriptor(
+        width, height, width * 3 * (int)sizeof(float), normal_image_descriptor->format);
+
+    if (normal_image_data == 0 ||
+        transformation_compare_image_descriptors(normal_image_descriptor, &expected_normal_image_descriptor) == false)
+    {
+        LOG_ERROR("Unexpected normal image data or descriptor, see details above.", 0);
+        return K4A_BUFFER_RESULT_TOO_SMALL;
+    }
+
+    if (xyz_image_data == 0 || width <= 0 || height <= 0 || xyz_image_descriptor->stride_bytes != width * 6)
+    {
+        LOG_ERROR("Unexpected XYZ image, expected 3 int16_t per pixel.", 0);
+        return K4A_BUFFER_RESULT_FAILED;
+    }
+
+    // The pixels of the border have no 4 neighbors
+    float *normals = (float *)(void *)normal_image_data;
+    memset(normals, 0, (size_t)width * (size_t)height * 3 * sizeof(float));
+    if (width < 3 || height < 3)
+    {
+        return K4A_BUFFER_RESULT_SUCCEEDED;
+    }
+
+    // Planar x, y and z of the 3 rows around the current one, each converted once
+    float *planes = (float *)malloc((size_t)width * 9 * sizeof(float));
+    if (planes == NULL)
+    {
+        LOG_ERROR("Failed to allocate the normal rows.", 0);
+        return K4A_BUFFER_RESULT_FAILED;
+    }
+    float *ring[3][3];
+    for (int row = 0; row < 3; row++)
+    {
+        for (int j = 0; j < 3; j++)
+        {
+            ring[row][j] = planes + (size_t)(3 * row + j) * (size_t)width;
+        }
+    }
+
+    const int16_t *xyz = (const int16_t *)(const void *)xyz_image_data;
+    for (int row = 0; row < 2; row++)
+    {
+        transformation_deinterleave_xyz_row(xyz + (size_t)row * (size_t)width * 3, width, ring[row]);
+    }
+
+    for (int y = 1; y < height - 1; y++)
+    {
+        transformation_deinterleave_xyz_row(xyz + (size_t)(y + 1) * (size_t)width * 3, width, ring[(y + 1) % 3]);
+        float *rows[3][3];
+        for (int j = 0; j < 3; j++)
+        {
+            rows[0][j] = ring[(y - 1) % 3][j];
+            rows[1][j] = ring[y % 3][j];
+            rows[2][j] = ring[(y + 1) % 3][j];
+        }
+
+        float *normal_row = normals + (size_t)y * (size_t)width * 3;
+        int done = 1;
+#if defined(K4A_USING_SSE)
+        done = transformation_normals_row_sse(rows, 1, width - 1, normal_row);
+#elif defined(K4A_USING_NEON)
+        done = transformation_normals_row_neon(rows, 1, width - 1, normal_row);
+#endif
+        transformation_normals_row_c(rows, done, width - 1, normal_row);
+    }
+
+    free(planes);
+    return K4A_BUFFER_RESULT_SUCCEEDED;
+}
+
+// A voxel of the downsampling grid, the sums of its points and normals
+typedef struct _k4a_transformation_voxel_t
+{
+    int32_t key[3];
+    uint32_t count;
+    int64_t sum[3];
+    float normal_sum[3];
+} k4a_transformation_voxel_t;
+
+static inline bool transformation_voxel_key_equal(const int32_t a[3], const int32_t b[3])
+{
+    return a[0] == b[0] && a[1] == b[1] && a[2] == b[2];
+}
+
+static inline uint32_t transformation_voxel_hash(const int32_t key[3])
+{
+    // Large primes spread neighboring voxels over the table
+    return ((uint32_t)key[0] * 73856093u) ^ ((uint32_t)key[1] * 19349663u) ^ ((uint32_t)key[2] * 83492791u);
+}
+
+k4a_buffer_result_t transformation_point_cloud_voxel_downsample_internal(
+    const uint8_t *xyz_image_data,
+    const k4a_transformation_image_descriptor_t *xyz_image_descriptor,
+    const uint8_t *normal_image_data,
+    const k4a_transformation_image_descriptor_t *normal_image_descriptor,
+    float voxel_size,
+    uint8_t *downsampled_xyz_image_data,
+    k4a_transformation_image_descriptor_t *downsampled_xyz_image_descriptor,
+    uint8_t *downsampled_normal_image_data,
+    k4a_transformation_image_descriptor_t *downsampled_normal_image_descriptor,
+    size_t *point_count)
+{
+    if (xyz_image_descriptor == 0 || downsampled_xyz_image_descriptor == 0 || point_count == 0)
+    {
+        return K4A_BUFFER_RESULT_FAILED;
+    }
+
+    if (!(voxel_size > 0.f))
+    {
+        LOG_ERROR("Unexpected voxel size %f, expected a positive size in millimeters.", (double)voxel_size);
+        return K4A_BUFFER_RESULT_FAILED;
+    }
+
+    int width = xyz_image_descriptor->width_pixels;
+    int height = xyz_image_descriptor->height_pixels;
+    if (xyz_image_data == 0 || width <= 0 || height <= 0 || xyz_image_descriptor->stride_bytes != width * 6 ||
+        (size_t)width * (size_t)height > (size_t)INT_MAX / 12)
+    {
+        LOG_ERROR("Unexpected XYZ image, expected 3 int16_t per pixel.", 0);
+        return K4A_BUFFER_RESULT_FAILED;
+    }
+    int pixel_count = width * height;
+
+    // Normals are averaged only when both the input and output normals are given
+    bool with_normals = downsampled_normal_image_data != 0;
+    if (with_normals)
+    {
+        k4a_transformation_image_descriptor_t expected_normal_image_descriptor = transformation_init_image_descriptor(
+            width, height, width * 3 * (int)sizeof(float), K4A_IMAGE_FORMAT_CUSTOM);
+        if (normal_image_data == 0 || normal_image_descriptor == 0 ||
+            transformation_compare_image_descriptors(normal_image_descriptor, &expected_normal_image_descriptor) ==
+                false)
+        {
+            LOG_ERROR("Unexpected normal image data or descriptor, see details above.", 0);
+            return K4A_BUFFER_RESULT_FAILED;
+        }
+    }
+
+    // One row that can hold a point for every pixel
+    k4a_transformation_image_descriptor_t expected_downsampled_image_descriptor = transformation_init_image_descriptor(
+        pixel_count, 1, pixel_count * 3 * (int)sizeof(float), downsampled_xyz_image_descriptor->format);
+    if (downsampled_xyz_image_data == 0 ||
+        transformation_compare_image_descriptors(downsampled_xyz_image_descriptor,
+                                                 &expected_downsampled_image_descriptor) == false ||
+        (with_normals && (downsampled_normal_image_descriptor == 0 ||
+                          transformation_compare_image_descriptors(downsampled_normal_image_descriptor,
+                                                                   &expected_downsampled_image_descriptor) == false)))
+    {
+        LOG_ERROR("Unexpected downsampled image data or descriptor, see details above.", 0);
+        return K4A_BUFFER_RESULT_TOO_SMALL;
+    }
+
+    const int16_t *xyz = (const int16_t *)(const void *)xyz_image_data;
+    const float *normals = (const float *)(const void *)normal_image_data;
+    size_t valid_count = 0;
+    for (int i = 0; i < pixel_count; i++)
+    {
+        valid_count += xyz[3 * i + 2] != 0 ? 1 : 0;
+    }
+
+    // Open addressing, at most half full. Slots hold the index of their voxel plus 1, 0 for an empty slot.
+    size_t capacity = 16;
+    while (capacity < 2 * valid_count)
+    {
+        capacity *= 2;
+    }
+    uint32_t *slots = (uint32_t *)calloc(capacity, sizeof(uint32_t));
+    k4a_transformation_voxel_t *voxels = (k4a_transformation_voxel_t *)malloc(
+        (valid_count > 0 ? valid_count : 1) * sizeof(k4a_transformation_voxel_t));
+    if (slots == NULL || voxels == NULL)
+    {
+        LOG_ERROR("Failed to allocate a voxel grid for %zu points.", valid_count);
+        free(slots);
+        free(voxels);
+        return K4A_BUFFER_RESULT_FAILED;
+    }
+
+    // Voxels are numbered in the order of their first point, so the output follows the pixel order
+    uint32_t voxel_count = 0;
+    k4a_transformation_voxel_t *last_voxel = NULL;
+    for (int i = 0; i < pixel_count; i++)
+    {
+        const int16_t *point = xyz + 3 * i;
+        if (point[2] == 0)
+        {
+            continue;
+        }
+
+        int32_t key[3];
+        for (int j = 0; j < 3; j++)
+        {
+            key[j] = (int32_t)floorf((float)point[j] / voxel_size);
+        }
+
+        // Neighboring pixels mostly fall in the same voxel, which then needs no lookup
+        k4a_transformation_voxel_t *voxel = NULL;
+        if (last_voxel != NULL && transformation_voxel_key_equal(last_voxel->key, key))
+        {
+            voxel = last_voxel;
+        }
+
+        size_t slot = transformation_voxel_hash(key) & (capacity - 1);
+        while (voxel == NULL && slots[slot] != 0)
+        {
+            k4a_transformation_voxel_t *candidate = &voxels[slots[slot] - 1];
+            if (transformation_voxel_key_equal(candidate->key, key))
+            {
+                voxel = candidate;
+                break;
+            }
+            slot = (slot + 1) & (capacity - 1);
+        }
+
+        if (voxel == NULL)
+        {
+            voxel = &voxels[voxel_count++];
+            slots[slot] = voxel_count;
+            memcpy(voxel->key, key, sizeof(key));
+            memset(voxel->sum, 0, sizeof(voxel->sum));
+            memset(voxel->normal_sum, 0, sizeof(voxel->normal_sum));
+            voxel->count = 0;
+        }
+        last_voxel = voxel;
+
+        voxel->count++;
+        for (int j = 0; j < 3; j++)
+        {
+            voxel->sum[j] += point[j];
+        }
+        if (with_normals)
+        {
+            for (int j = 0; j < 3; j++)
+            {
+                voxel->normal_sum[j] += normals[3 * i + j];
+            }
+        }
+    }
+
+    // Each voxel becomes the centroid of its points, with the mean direction of their normals
+    float *downsampled_xyz = (float *)(void *)downsampled_xyz_image_data;
+    float *downsampled_normals = (float *)(void *)downsampled_normal_image_data;
+    for (uint32_t v = 0; v < voxel_count; v++)
+    {
+        const k4a_transformation_voxel_t *voxel = &voxels[v];
+        for (int j = 0; j < 3; j++)
+        {
+            downsampled_xyz[3 * v + j] = (float)((double)voxel->sum[j] / (double)voxel->count);
+        }
+
+        if (with_normals)
+        {
+            const float *n = voxel->normal_sum;
+            float length = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            for (int j = 0; j < 3; j++)
+            {
+                downsampled_normals[3 * v + j] = length > 0.f ? n[j] / length : 0.f;
+            }
+        }
+    }
+
+    free(slots);
+    free(voxels);
+    *point_count = voxel_count;
+    return K4A_BUFFER_RESULT_SUCCEEDED;
+}
+
+struct _k4a_transformation_undistort_lut_t
+{
+    int width; // Size of the undistorted image
+    int height;
+    int source_width; // Size of the distorted image
+    int source_height;
+    k4a_transformation_interpolation_type_t interpolation_type;
+    int32_t *indices;                      // Nearest: source pixel of each pixel, -1 for pixels without one
+    k4a_correspondence_t *correspondences; // Linear: distorted coordinates of each pixel
+};
+
+k4a_transformation_undistort_lut_t *
+transformation_undistort_lut_create(const k4a_calibration_camera_t *camera_calibration,
+                                    const k4a_transformation_pinhole_t *pinhole,
+                                    k4a_transformation_interpolation_type_t interpolation_type)
+{
+    if (pinhole->width <= 0 || pinhole->height <= 0 || pinhole->fx <= 0.f || pinhole->fy <= 0.f)
+    {
+        LOG_ERROR("Unexpected pinhole %dx%d with fx: %lf, fy: %lf.",
+                  pinhole->width,
+                  pinhole->height,
+                  (double)pinhole->fx,
+                  (double)pinhole->fy);
+        return NULL;
+    }
+    if (interpolation_type != K4A_TRANSFORMATION_INTERPOLATION_TYPE_NEAREST &&
+        interpolation_type != K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR)
+    {
+        LOG_ERROR("Unexpected interpolation type %d.", interpolation_type);
+        return NULL;
+    }
+
+    k4a_transformation_undistort_lut_t *lut = (k4a_transformation_undistort_lut_t *)calloc(1, sizeof(*lut));
+    size_t width = (size_t)pinhole->width;
+    size_t pixel_count = width * (size_t)pinhole->height;
+    float *rays = (float *)malloc(3 * width * sizeof(float));
+    float *point2d = (float *)malloc(2 * width * sizeof(float));
+    int *valid = (int *)malloc(width * sizeof(int));
+    if (lut == NULL || rays == NULL || point2d == NULL || valid == NULL)
+    {
+        LOG_ERROR("Failed to allocate the undistort map.", 0);
+        transformation_undistort_lut_destroy(lut);
+        lut = NULL;
+    }
+
+    if (lut != NULL)
+    {
+        lut->width = pinhole->width;
+        lut->height = pinhole->height;
+        lut->source_width = camera_calibration->resolution_width;
+        lut->source_height = camera_calibration->resolution_height;
+        lut->interpolation_type = interpolation_type;
+        if (interpolation_type == K4A_TRANSFORMATION_INTERPOLATION_TYPE_NEAREST)
+        {
+            lut->indices = (int32_t *)malloc(pixel_count * sizeof(int32_t));
+        }
+        else
+        {
+            lut->correspondences = (k4a_correspondence_t *)malloc(pixel_count * sizeof(k4a_correspondence_t));
+        }
+        if (lut->indices == NULL && lut->correspondences == NULL)
+        {
+            LOG_ERROR("Failed to allocate the undistort map.", 0);
+            transformation_undistort_lut_destroy(lut);
+            lut = NULL;
+        }
+    }
+
+    // The pixels of a row are projected into the distorted image together
+    for (int y = 0; lut != NULL && y < lut->height; y++)
+    {
+        for (size_t x = 0; x < width; x++)
+        {
+            rays[3 * x + 0] = ((float)x - pinhole->px) / pinhole->fx;
+            rays[3 * x + 1] = ((float)y - pinhole->py) / pinhole->fy;
+            rays[3 * x + 2] = 1.f;
+        }
+        if (K4A_FAILED(TRACE_CALL(transformation_project_batch(camera_calibration, rays, width, point2d, valid))))
+        {
+            transformation_undistort_lut_destroy(lut);
+            lut = NULL;
+            break;
+        }
+
+        size_t row_offset = (size_t)y * width;
+        for (size_t x = 0; x < width; x++)
+        {
+            if (lut->indices != NULL)
+            {
+                int u = (int)floorf(point2d[2 * x + 0] + 0.5f);
+                int v = (int)floorf(point2d[2 * x + 1] + 0.5f);
+                bool inside = valid[x] && u >= 0 && u < lut->source_width && v >= 0 && v < lut->source_height;
+                lut->indices[row_offset + x] = inside ? v * lut->source_width + u : -1;
+            }
+            else
+            {
+                k4a_correspondence_t *correspondence = &lut->correspondences[row_offset + x];
+                correspondence->point2d.xy.x = point2d[2 * x + 0];
+                correspondence->point2d.xy.y = point2d[2 * x + 1];
+                correspondence->depth = 0.f;
+                correspondence->valid = valid[x];
+            }
+        }
+    }
+
+    free(rays);
+    free(point2d);
+    free(valid);
+    return lut;
+}
+
+void transformation_undistort_lut_destroy(k4a_transformation_undistort_lut_t *lut)
+{
+    if (lut != NULL)
+    {
+        free(lut->indices);
+        free(lut->correspondences);
+        free(lut);
+    }
+}
+
+// Below this ratio of the nearest depth, the 4 depth pixels around a point are taken to be on one surface: sin() of the
+// angle between two pixels in binned resolution (0.234375 degree) over cos() of a highly slanted surface (85 degree)
+#define TRANSFORMATION_UNDISTORT_DEPTH_DISCONTINUITY_RATIO 0.04693441759f
+
+// Writes the bilinear blend of the 4 pixels around each correspondence of a row, or 0 for correspondences that are not
+// valid or not inside the image. For depth, points next to missing depth or a depth discontinuity are 0 as well, so
+// edges are not blended with the background.
+static void transformation_bilinear_uint16_row_c(const uint16_t *image,
+                                                 int stride_pixels,
+                                                 int width,
+                                                 int height,
+                                                 bool depth,
+                                                 const k4a_correspondence_t *correspondences,
+                                                 int count,
+                                                 uint16_t *output)
+{
+    for (int i = 0; i < count; i++)
+    {
+        const k4a_correspondence_t *correspondence = &correspondences[i];
+        output[i] = 0;
+        if (!correspondence->valid || !transformation_point_inside_image(width, height, &correspondence->point2d))
+        {
+            continue;
+        }
+
+        float floor_x = floorf(correspondence->point2d.xy.x);
+        float floor_y = floorf(correspondence->point2d.xy.y);
+        float fractional_x = correspondence->point2d.xy.x - floor_x;
+        float fractional_y = correspondence->point2d.xy.y - floor_y;
+        const uint16_t *top = image + (int)floor_y * stride_pixels + (int)floor_x;
+        uint16_t vals[4] = { top[0], top[1], top[stride_pixels], top[stride_pixels + 1] };
+
+        if (depth)
+        {
+            uint16_t depth_min = MIN(MIN(vals[0], vals[1]), MIN(vals[2], vals[3]));
+            uint16_t depth_max = MAX(MAX(vals[0], vals[1]), MAX(vals[2], vals[3]));
+            if (depth_min == 0 ||
+                (float)depth_max - (float)depth_min > TRANSFORMATION_UNDISTORT_DEPTH_DISCONTINUITY_RATIO * depth_min)
+            {
+                continue;
+            }
+        }
+
+        float interpol_x_0 = (1.f - fractional_x) * vals[0] + fractional_x * vals[1];
+        float interpol_x_1 = (1.f - fractional_x) * vals[2] + fractional_x * vals[3];
+        float interpol_y = (1.f - fractional_y) * interpol_x_0 + fractional_y * interpol_x_1;
+        output[i] = (uint16_t)(interpol_y + 0.5f);
+    }
+}
+
+#if defined(K4A_USING_SSE)
+// transformation_bilinear_uint16_row_c() for 4 correspondences at a time, with the same float operations. Returns the
+// number of leading correspondences it converted.
+static int transformation_bilinear_uint16_row_sse(const uint16_t *image,
+                                                  int stride_pixels,
+                                                  int width,
+                                                  int height,
+                                                  bool depth,
+                                                  const k4a_correspondence_t *correspondences,
+                                                  int count,
+                                                  uint16_t *output)
+{
+    if (width < 2 || height < 2)
+    {
+        return 0;
+    }
+
+    __m128 one = _mm_set1_ps(1.f);
+    __m128 max_x = _mm_set1_ps((float)(width - 1));
+    __m128 max_y = _mm_set1_ps((float)(height - 1));
+    int i = 0;
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 x = _mm_loadu_ps((const float *)&correspondences[i]);
+        __m128 y = _mm_loadu_ps((const float *)&correspondences[i + 1]);
+        __m128 unused = _mm_loadu_ps((const float *)&correspondences[i + 2]);
+        __m128 valid = _mm_loadu_ps((const float *)&correspondences[i + 3]);
+        _MM_TRANSPOSE4_PS(x, y, unused, valid);
+
+        // Same test as transformation_point_inside_image(), NAN fails every comparison
+        __m128 floor_x = _mm_floor_ps(x);
+        __m128 floor_y = _mm_floor_ps(y);
+        __m128 inside = _mm_and_ps(_mm_cmpge_ps(floor_x, _mm_setzero_ps()), _mm_cmpge_ps(floor_y, _mm_setzero_ps()));
+        inside = _mm_and_ps(inside, _mm_and_ps(_mm_cmplt_ps(floor_x, max_x), _mm_cmplt_ps(floor_y, max_y)));
+        __m128i not_valid = _mm_cmpeq_epi32(_mm_castps_si128(valid), _mm_setzero_si128());
+        inside = _mm_andnot_ps(_mm_castsi128_ps(not_valid), inside);
+
+        __m128 fractional_x = _mm_sub_ps(x, floor_x);
+        __m128 fractional_y = _mm_sub_ps(y, floor_y);
+        __m128i top_left_x = _mm_cvttps_epi32(_mm_and_ps(floor_x, inside));
+        __m128i top_left_y = _mm_cvttps_epi32(_mm_and_ps(floor_y, inside));
+        __m128i offset = _mm_add_epi32(_mm_mullo_epi32(top_left_y, _mm_set1_epi32(stride_pixels)), top_left_x);
+
+        int32_t offsets[4];
+        _mm_storeu_si128((__m128i *)offsets, offset);
+
+        // Each 32 bit load holds the left and right pixel of a pair
+        int32_t top[4], bottom[4];
+        for (int j = 0; j < 4; j++)
+        {
+            memcpy(&top[j], image + offsets[j], sizeof(int32_t));
+            memcpy(&bottom[j], image + offsets[j] + stride_pixels, sizeof(int32_t));
+        }
+        __m128i top_pairs = _mm_loadu_si128((const __m128i *)top);
+        __m128i bottom_pairs = _mm_loadu_si128((const __m128i *)bottom);
+        __m128i mask = _mm_set1_epi32(0xffff);
+        __m128i vals_0 = _mm_and_si128(top_pairs, mask);
+        __m128i vals_1 = _mm_srli_epi32(top_pairs, 16);
+        __m128i vals_2 = _mm_and_si128(bottom_pairs, mask);
+        __m128i vals_3 = _mm_srli_epi32(bottom_pairs, 16);
+
+        if (depth)
+        {
+            __m128i depth_min = _mm_min_epi32(_mm_min_epi32(vals_0, vals_1), _mm_min_epi32(vals_2, vals_3));
+            __m128i depth_max = _mm_max_epi32(_mm_max_epi32(vals_0, vals_1), _mm_max_epi32(vals_2, vals_3));
+            __m128 depth_min_f = _mm_cvtepi32_ps(depth_min);
+            __m128 discontinuity = _mm_cmpgt_ps(
+                _mm_sub_ps(_mm_cvtepi32_ps(depth_max), depth_min_f),
+                _mm_mul_ps(_mm_set1_ps(TRANSFORMATION_UNDISTORT_DEPTH_DISCONTINUITY_RATIO), depth_min_f));
+            __m128i missing = _mm_cmpeq_epi32(depth_min, _mm_setzero_si128());
+            inside = _mm_andnot_ps(_mm_or_ps(discontinuity, _mm_castsi128_ps(missing)), inside);
+        }
+
+        __m128 inverse_x = _mm_sub_ps(one, fractional_x);
+        __m128 interpol_x_0 = _mm_add_ps(_mm_mul_ps(inverse_x, _mm_cvtepi32_ps(vals_0)),
+                                         _mm_mul_ps(fractional_x, _mm_cvtepi32_ps(vals_1)));
+        __m128 interpol_x_1 = _mm_add_ps(_mm_mul_ps(inverse_x, _mm_cvtepi32_ps(vals_2)),
+                                         _mm_mul_ps(fractional_x, _mm_cvtepi32_ps(vals_3)));
+        __m128 interpol_y = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(one, fractional_y), interpol_x_0),
+                                       _mm_mul_ps(fractional_y, interpol_x_1));
+
+        __m128i value = _mm_cvttps_epi32(_mm_add_ps(interpol_y, _mm_set1_ps(0.5f)));
+        value = _mm_and_si128(value, _mm_castps_si128(inside));
+        _mm_storel_epi64((__m128i *)(output + i), _mm_packus_epi32(value, value));
+    }
+    return i;
+}
+#endif
+
+static void transformation_bilinear_uint16_row(const uint16_t *image,
+                                               int stride_pixels,
+                                               int width,
+                                               int height,
+                                               bool depth,
+                                               const k4a_correspondence_t *correspondences,
+                                               int count,
+                                               uint16_t *output)
+{
+    int done = 0;
+#if defined(K4A_USING_SSE)
+    done = transformation_bilinear_uint16_row_sse(
+        image, stride_pixels, width, height, depth, correspondences, count, output);
+#endif
+    transformation_bilinear_uint16_row_c(
+        image, stride_pixels, width, height, depth, correspondences + done, count - done, output + done);
+}
+
+k4a_result_t transformation_undistort_internal(const k4a_transformation_undistort_lut_t *lut,
+                                               const uint8_t *image_data,
+                                               const k4a_transformation_image_descriptor_t *image_descriptor,
+                                               uint8_t *undistorted_image_data,
+                                               k4a_transformation_image_descriptor_t *undistorted_image_descriptor)
+{
+    if (image_data == NULL || image_descriptor == NULL || undistorted_image_data == NULL ||
+        undistorted_image_descriptor == NULL)
+    {
+        LOG_ERROR("Image data or descriptor is null.", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    int pixel_size = 0;
+    switch (image_descriptor->format)
+    {
+    case K4A_IMAGE_FORMAT_DEPTH16:
+    case K4A_IMAGE_FORMAT_IR16:
+        pixel_size = (int)sizeof(uint16_t);
+        break;
+    case K4A_IMAGE_FORMAT_COLOR_BGRA32:
+        pixel_size = 4 * (int)sizeof(uint8_t);
+        break;
+    default:
+        LOG_ERROR("Unexpected image format %d, should be K4A_IMAGE_FORMAT_DEPTH16 (%d), K4A_IMAGE_FORMAT_IR16 (%d) or "
+                  "K4A_IMAGE_FORMAT_COLOR_BGRA32 (%d).",
+                  image_descriptor->format,
+                  K4A_IMAGE_FORMAT_DEPTH16,
+                  K4A_IMAGE_FORMAT_IR16,
+                  K4A_IMAGE_FORMAT_COLOR_BGRA32);
+        return K4A_RESULT_FAILED;
+    }
+
+    k4a_transformation_image_descriptor_t expected_image_descriptor = transformation_init_image_descriptor(
+        lut->source_width, lut->source_height, lut->source_width * pixel_size, image_descriptor->format);
+    if (transformation_compare_image_descriptors(image_descriptor, &expected_image_descriptor) == false)
+    {
+        LOG_ERROR("Unexpected image descriptor, see details above.", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    k4a_transformation_image_descriptor_t expected_undistorted_image_descriptor = transformation_init_image_descriptor(
+        lut->width, lut->height, lut->width * pixel_size, image_descriptor->format);
+    if (transformation_compare_image_descriptors(undistorted_image_descriptor,
+                                                 &expected_undistorted_image_descriptor) == false)
+    {
+        LOG_ERROR("Unexpected undistorted image descriptor, see details above.", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    size_t pixel_count = (size_t)lut->width * (size_t)lut->height;
+    if (lut->indices != NULL)
+    {
+        if (pixel_size == (int)sizeof(uint16_t))
+        {
+            const uint16_t *image = (const uint16_t *)(const void *)image_data;
+            uint16_t *undistorted_image = (uint16_t *)(void *)undistorted_image_data;
+            for (size_t i = 0; i < pixel_count; i++)
+            {
+                int32_t index = lut->indices[i];
+                undistorted_image[i] = index < 0 ? 0 : image[index];
+            }
+        }
+        else
+        {
+            const uint32_t *image = (const uint32_t *)(const void *)image_data;
+            uint32_t *undistorted_image = (uint32_t *)(void *)undistorted_image_data;
+            for (size_t i = 0; i < pixel_count; i++)
+            {
+                int32_t index = lut->indices[i];
+                // Like transformation_bilinear_bgra_row_c(), (0,0,0,0) marks pixels without a source so valid black
+                // pixels become (1,0,0,0)
+                uint32_t bgra = index < 0 ? 0 : image[index];
+                undistorted_image[i] = index >= 0 && bgra == 0 ? 1 : bgra;
+            }
+        }
+        return K4A_RESULT_SUCCEEDED;
+    }
+
+    k4a_transformation_input_image_t image = transformation_init_input_image(image_descriptor, image_data);
+    for (int y = 0; y < lut->height; y++)
+    {
+        const k4a_correspondence_t *correspondence_row = lut->correspondences + (size_t)y * (size_t)lut->width;
+        uint8_t *row = undistorted_image_data + (size_t)y * (size_t)undistorted_image_descriptor->stride_bytes;
+        if (pixel_size == (int)sizeof(uint16_t))
+        {
+            transformation_bilinear_uint16_row(image.data_uint16,
+                                               lut->source_width,
+                                               lut->source_width,
+                                               lut->source_height,
+                                               image_descriptor->format == K4A_IMAGE_FORMAT_DEPTH16,
+                                               correspondence_row,
+                                               lut->width,
+                                               (uint16_t *)(void *)row);
+        }
+        else
+        {
+            transformation_bilinear_bgra_row(&image, false, correspondence_row, lut->width, row);
+        }
+    }
+    return K4A_RESULT_SUCCEEDED;
 }
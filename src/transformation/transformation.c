@@ -7,10 +7,18 @@
 
 #include <k4ainternal/logging.h>
 #include <k4ainternal/deloader.h>
+#include <k4ainternal/global.h>
 #include <k4ainternal/tewrapper.h>
+#include <k4ainternal/clwrapper.h>
 #include <k4ainternal/image.h>
+#include <k4ainternal/threadpolicy.h>
+#include <azure_c_shared_utility/condition.h>
+#include <azure_c_shared_utility/envvariable.h>
+#include <azure_c_shared_utility/lock.h>
+#include <azure_c_shared_utility/threadapi.h>
 
 // System dependencies
+#include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
 #include <float.h>
@@ -98,12 +106,6 @@ static k4a_result_t transformation_possible(const k4a_calibration_t *camera_cali
     return K4A_RESULT_SUCCEEDED;
 }
 
-static bool transformation_is_pixel_within_line_segment(const float p[2], const float start[2], const float stop[2])
-{
-    return (stop[0] >= start[0] ? stop[0] >= p[0] && p[0] >= start[0] : stop[0] <= p[0] && p[0] <= start[0]) &&
-           (stop[1] >= start[1] ? stop[1] >= p[1] && p[1] >= start[1] : stop[1] <= p[1] && p[1] <= start[1]);
-}
-
 static bool transformation_is_pixel_within_image(const float p[2], const int width, const int height)
 {
     return p[0] >= 0 && p[0] < width && p[1] >= 0 && p[1] < height;
@@ -310,11 +312,198 @@ k4a_result_t transformation_2d_to_2d(const k4a_calibration_t *calibration,
     return K4A_RESULT_SUCCEEDED;
 }
 
-k4a_result_t transformation_color_2d_to_depth_2d(const k4a_calibration_t *calibration,
-                                                 const float source_point2d[2],
-                                                 const k4a_image_t depth_image,
-                                                 float target_point2d[2],
-                                                 int *valid)
+// Samples along the epipolar line that the coarse pass of the color to depth search skips between evaluations. The
+// reprojection error is close to linear in the distance from its minimum on a surface, so the best coarse sample is
+// within a step of the minimum and halving the step around it finds the same sample as a pixel by pixel walk.
+#define TRANSFORMATION_EPIPOLAR_COARSE_STEP 8
+
+// Segment of the epipolar line of a color pixel in the undistorted depth image
+typedef struct _transformation_epipolar_line_t
+{
+    const k4a_calibration_t *calibration;
+    const k4a_transformation_pinhole_t *pinhole;
+    const float *source_point2d;
+    const uint16_t *depth_image_data;
+    int depth_image_width_pixels;
+    int depth_image_height_pixels;
+    float start_point2d[2];
+    float step_point2d[2]; // Offset between samples, 1 pixel along the major axis of the line
+    int step_count;        // Samples after the start point that are still on the segment
+} transformation_epipolar_line_t;
+
+// Reprojects the depth of the sample step of the line into the color image. error is its distance from the color
+// pixel, FLT_MAX when the sample has no valid depth or reprojection.
+static k4a_result_t transformation_epipolar_line_error(const transformation_epipolar_line_t *line,
+                                                       int step,
+                                                       float depth_point2d[2],
+                                                       float *error)
+{
+    *error = FLT_MAX;
+
+    // Compute the ray from the depth camera origin, intersecting with the current searching pixel on the epipolar line
+    const k4a_transformation_pinhole_t *pinhole = line->pinhole;
+    float p[2];
+    p[0] = line->start_point2d[0] + (float)step * line->step_point2d[0];
+    p[1] = line->start_point2d[1] + (float)step * line->step_point2d[1];
+    float ray[3];
+    ray[0] = (p[0] - pinhole->px) / pinhole->fx;
+    ray[1] = (p[1] - pinhole->py) / pinhole->fy;
+    ray[2] = 1.f;
+
+    // Project the ray to the distorted depth image to read the depth value from nearest pixel
+    int p_valid = 0;
+    if (K4A_FAILED(TRACE_CALL(transformation_3d_to_2d(
+            line->calibration, ray, K4A_CALIBRATION_TYPE_DEPTH, K4A_CALIBRATION_TYPE_DEPTH, depth_point2d, &p_valid))))
+    {
+        return K4A_RESULT_FAILED;
+    }
+    if (p_valid != 1 ||
+        !transformation_is_pixel_within_image(depth_point2d,
+                                              line->depth_image_width_pixels,
+                                              line->depth_image_height_pixels))
+    {
+        return K4A_RESULT_SUCCEEDED;
+    }
+
+    // Transform the current searching depth pixel to color image
+    int u = (int)(floorf(depth_point2d[0] + 0.5f));
+    int v = (int)(floorf(depth_point2d[1] + 0.5f));
+    uint16_t d = line->depth_image_data[v * line->depth_image_width_pixels + u];
+    float reprojected_point2d[2];
+    if (K4A_FAILED(TRACE_CALL(transformation_2d_to_2d(line->calibration,
+                                                      depth_point2d,
+                                                      d,
+                                                      K4A_CALIBRATION_TYPE_DEPTH,
+                                                      K4A_CALIBRATION_TYPE_COLOR,
+                                                      reprojected_point2d,
+                                                      &p_valid))))
+    {
+        return K4A_RESULT_FAILED;
+    }
+    if (p_valid == 1 &&
+        transformation_is_pixel_within_image(reprojected_point2d,
+                                             line->calibration->color_camera_calibration.resolution_width,
+                                             line->calibration->color_camera_calibration.resolution_height))
+    {
+        // Compute the 2d reprojection error
+        *error = sqrtf(powf(reprojected_point2d[0] - line->source_point2d[0], 2) +
+                       powf(reprojected_point2d[1] - line->source_point2d[1], 2));
+    }
+    return K4A_RESULT_SUCCEEDED;
+}
+
+// Evaluates sample step and keeps it if its error is the smallest so far
+static k4a_result_t transformation_epipolar_line_update(const transformation_epipolar_line_t *line,
+                                                        int step,
+                                                        int *best_step,
+                                                        float *best_error,
+                                                        float best_point2d[2])
+{
+    float depth_point2d[2];
+    float error;
+    if (K4A_FAILED(TRACE_CALL(transformation_epipolar_line_error(line, step, depth_point2d, &error))))
+    {
+        return K4A_RESULT_FAILED;
+    }
+    if (error < *best_error)
+    {
+        *best_step = step;
+        *best_error = error;
+        best_point2d[0] = depth_point2d[0];
+        best_point2d[1] = depth_point2d[1];
+    }
+    return K4A_RESULT_SUCCEEDED;
+}
+
+// Searches the epipolar line between the depth camera points a color pixel maps to at the minimum and maximum depth.
+// With exhaustive every pixel of the line is evaluated, otherwise every TRANSFORMATION_EPIPOLAR_COARSE_STEP pixel and
+// then the neighborhood of the best of those with a halving step.
+static k4a_result_t transformation_color_2d_to_depth_2d_search(const k4a_calibration_t *calibration,
+                                                               const k4a_transformation_pinhole_t *pinhole,
+                                                               const float source_point2d[2],
+                                                               const float start_point3d[3],
+                                                               const float stop_point3d[3],
+                                                               const k4a_image_t depth_image,
+                                                               bool exhaustive,
+                                                               float target_point2d[2],
+                                                               int *valid)
+{
+    *valid = 1;
+
+    // Project above two 3d points into the undistorted depth image space with the pinhole model, both start and stop 2d
+    // points are expected to locate on the epipolar line
+    transformation_epipolar_line_t line;
+    float stop_point2d[2];
+    line.start_point2d[0] = start_point3d[0] / start_point3d[2] * pinhole->fx + pinhole->px;
+    line.start_point2d[1] = start_point3d[1] / start_point3d[2] * pinhole->fy + pinhole->py;
+    stop_point2d[0] = stop_point3d[0] / stop_point3d[2] * pinhole->fx + pinhole->px;
+    stop_point2d[1] = stop_point3d[1] / stop_point3d[2] * pinhole->fy + pinhole->py;
+
+    float delta[2] = { stop_point2d[0] - line.start_point2d[0], stop_point2d[1] - line.start_point2d[1] };
+    float length = fmaxf(fabsf(delta[0]), fabsf(delta[1]));
+    if (!(length > 0.f))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    line.calibration = calibration;
+    line.pinhole = pinhole;
+    line.source_point2d = source_point2d;
+    line.depth_image_data = (const uint16_t *)(const void *)(image_get_buffer(depth_image));
+    line.depth_image_width_pixels = image_get_width_pixels(depth_image);
+    line.depth_image_height_pixels = image_get_height_pixels(depth_image);
+    line.step_point2d[0] = delta[0] / length;
+    line.step_point2d[1] = delta[1] / length;
+    line.step_count = (int)floorf(length);
+
+    // Search the pixels on the epipolar line so that its reprojected pixel coordinates in color image have minimum
+    // distance from the input color pixel coordinates
+    int best_step = -1;
+    float best_error = FLT_MAX;
+    int stride = exhaustive ? 1 : TRANSFORMATION_EPIPOLAR_COARSE_STEP;
+    for (int step = 0; step <= line.step_count; step += stride)
+    {
+        if (K4A_FAILED(TRACE_CALL(
+                transformation_epipolar_line_update(&line, step, &best_step, &best_error, target_point2d))))
+        {
+            return K4A_RESULT_FAILED;
+        }
+    }
+
+    if (!exhaustive && best_step >= 0)
+    {
+        for (int half_step = TRANSFORMATION_EPIPOLAR_COARSE_STEP / 2; half_step >= 1; half_step /= 2)
+        {
+            int center = best_step;
+            if (center - half_step >= 0 &&
+                K4A_FAILED(TRACE_CALL(transformation_epipolar_line_update(
+                    &line, center - half_step, &best_step, &best_error, target_point2d))))
+            {
+                return K4A_RESULT_FAILED;
+            }
+            if (center + half_step <= line.step_count &&
+                K4A_FAILED(TRACE_CALL(transformation_epipolar_line_update(
+                    &line, center + half_step, &best_step, &best_error, target_point2d))))
+            {
+                return K4A_RESULT_FAILED;
+            }
+        }
+    }
+
+    if (best_error > 10)
+    {
+        *valid = 0;
+    }
+
+    return K4A_RESULT_SUCCEEDED;
+}
+
+static k4a_result_t transformation_color_2d_to_depth_2d_point(const k4a_calibration_t *calibration,
+                                                              const float source_point2d[2],
+                                                              const k4a_image_t depth_image,
+                                                              bool exhaustive,
+                                                              float target_point2d[2],
+                                                              int *valid)
 {
     k4a_transformation_pinhole_t pinhole = { 0 };
     if (K4A_FAILED(TRACE_CALL(transformation_create_depth_camera_pinhole(calibration, &pinhole))))
@@ -356,107 +545,298 @@ k4a_result_t transformation_color_2d_to_depth_2d(const k4a_calibration_t *calibr
         return K4A_RESULT_SUCCEEDED;
     }
 
-    // Project above two 3d points into the undistorted depth image space with the pinhole model, both start and stop 2d
-    // points are expected to locate on the epipolar line
-    float start_point2d[2], stop_point2d[2];
-    start_point2d[0] = start_point3d[0] / start_point3d[2] * pinhole.fx + pinhole.px;
-    start_point2d[1] = start_point3d[1] / start_point3d[2] * pinhole.fy + pinhole.py;
-    stop_point2d[0] = stop_point3d[0] / stop_point3d[2] * pinhole.fx + pinhole.px;
-    stop_point2d[1] = stop_point3d[1] / stop_point3d[2] * pinhole.fy + pinhole.py;
+    return TRACE_CALL(transformation_color_2d_to_depth_2d_search(calibration,
+                                                                 &pinhole,
+                                                                 source_point2d,
+                                                                 start_point3d,
+                                                                 stop_point3d,
+                                                                 depth_image,
+                                                                 exhaustive,
+                                                                 target_point2d,
+                                                                 valid));
+}
 
-    // Search every pixel on the epipolar line so that its reprojected pixel coordinates in color image have minimum
-    // distance from the input color pixel coordinates
-    int depth_image_width_pixels = image_get_width_pixels(depth_image);
-    int depth_image_height_pixels = image_get_height_pixels(depth_image);
-    const uint16_t *depth_image_data = (const uint16_t *)(const void *)(image_get_buffer(depth_image));
-    float best_error = FLT_MAX;
-    float p[2];
-    p[0] = start_point2d[0];
-    p[1] = start_point2d[1];
-    if (stop_point2d[0] - start_point2d[0] == 0.0f)
+k4a_result_t transformation_color_2d_to_depth_2d(const k4a_calibration_t *calibration,
+                                                 const float source_point2d[2],
+                                                 const k4a_image_t depth_image,
+                                                 float target_point2d[2],
+                                                 int *valid)
+{
+    return TRACE_CALL(transformation_color_2d_to_depth_2d_point(
+        calibration, source_point2d, depth_image, false, target_point2d, valid));
+}
+
+k4a_result_t transformation_color_2d_to_depth_2d_exhaustive(const k4a_calibration_t *calibration,
+                                                            const float source_point2d[2],
+                                                            const k4a_image_t depth_image,
+                                                            float target_point2d[2],
+                                                            int *valid)
+{
+    return TRACE_CALL(transformation_color_2d_to_depth_2d_point(
+        calibration, source_point2d, depth_image, true, target_point2d, valid));
+}
+
+// The batch functions keep intermediate points on the stack, this many at a time
+#define TRANSFORMATION_BATCH_CHUNK_POINTS 256
+
+static k4a_result_t transformation_3d_to_3d_batch(const k4a_calibration_t *calibration,
+                                                  const float *source_point3d,
+                                                  size_t point_count,
+                                                  const k4a_calibration_type_t source_camera,
+                                                  const k4a_calibration_type_t target_camera,
+                                                  float *target_point3d)
+{
+    if (K4A_FAILED(TRACE_CALL(transformation_possible(calibration, source_camera))) ||
+        K4A_FAILED(TRACE_CALL(transformation_possible(calibration, target_camera))))
     {
         return K4A_RESULT_FAILED;
     }
-    float epipolar_line_slope = (stop_point2d[1] - start_point2d[1]) / (stop_point2d[0] - start_point2d[0]);
-    bool xStep1 = fabs(epipolar_line_slope) < 1;
-    bool stop_larger_than_start = xStep1 ? stop_point2d[0] > start_point2d[0] : stop_point2d[1] > start_point2d[1];
-    while (transformation_is_pixel_within_line_segment(p, start_point2d, stop_point2d))
-    {
-        // Compute the ray from the depth camera oringin, intersecting with the current searching pixel on the epipolar
-        // line
-        float ray[3];
-        ray[0] = (p[0] - pinhole.px) / pinhole.fx;
-        ray[1] = (p[1] - pinhole.py) / pinhole.fy;
-        ray[2] = 1.f;
 
-        // Project the ray to the distorted depth image to read the depth value from nearest pixel
-        float depth_point2d[2];
-        int p_valid = 0;
-        if (K4A_FAILED(TRACE_CALL(transformation_3d_to_2d(
-                calibration, ray, K4A_CALIBRATION_TYPE_DEPTH, K4A_CALIBRATION_TYPE_DEPTH, depth_point2d, &p_valid))))
+    for (size_t i = 0; i < point_count; i++)
+    {
+        if (source_camera == target_camera)
+        {
+            target_point3d[3 * i + 0] = source_point3d[3 * i + 0];
+            target_point3d[3 * i + 1] = source_point3d[3 * i + 1];
+            target_point3d[3 * i + 2] = source_point3d[3 * i + 2];
+        }
+        else if (K4A_FAILED(TRACE_CALL(transformation_apply_extrinsic_transformation(
+                     &calibration->extrinsics[source_camera][target_camera],
+                     source_point3d + 3 * i,
+                     target_point3d + 3 * i))))
         {
             return K4A_RESULT_FAILED;
         }
+    }
+
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t transformation_2d_to_3d_batch(const k4a_calibration_t *calibration,
+                                           const float *source_point2d,
+                                           const float *source_depth,
+                                           size_t point_count,
+                                           const k4a_calibration_type_t source_camera,
+                                           const k4a_calibration_type_t target_camera,
+                                           float *target_point3d,
+                                           int *valid)
+{
+    if (K4A_FAILED(TRACE_CALL(transformation_possible(calibration, source_camera))))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    const k4a_calibration_camera_t *camera_calibration = NULL;
+    if (source_camera == K4A_CALIBRATION_TYPE_DEPTH)
+    {
+        camera_calibration = &calibration->depth_camera_calibration;
+    }
+    else if (source_camera == K4A_CALIBRATION_TYPE_COLOR)
+    {
+        camera_calibration = &calibration->color_camera_calibration;
+    }
+    else
+    {
+        LOG_ERROR("Unexpected source camera calibration type %d, should either be K4A_CALIBRATION_TYPE_DEPTH (%d) or "
+                  "K4A_CALIBRATION_TYPE_COLOR (%d).",
+                  source_camera,
+                  K4A_CALIBRATION_TYPE_DEPTH,
+                  K4A_CALIBRATION_TYPE_COLOR);
+        return K4A_RESULT_FAILED; // unproject only supported for depth and color cameras
+    }
+
+    if (K4A_FAILED(TRACE_CALL(transformation_unproject_batch(
+            camera_calibration, source_point2d, source_depth, point_count, target_point3d, valid))))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    if (source_camera == target_camera)
+    {
+        return K4A_RESULT_SUCCEEDED;
+    }
+    return TRACE_CALL(transformation_3d_to_3d_batch(
+        calibration, target_point3d, point_count, source_camera, target_camera, target_point3d));
+}
+
+k4a_result_t transformation_3d_to_2d_batch(const k4a_calibration_t *calibration,
+                                           const float *source_point3d,
+                                           size_t point_count,
+                                           const k4a_calibration_type_t source_camera,
+                                           const k4a_calibration_type_t target_camera,
+                                           float *target_point2d,
+                                           int *valid)
+{
+    if (K4A_FAILED(TRACE_CALL(transformation_possible(calibration, target_camera))))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    const k4a_calibration_camera_t *camera_calibration = NULL;
+    if (target_camera == K4A_CALIBRATION_TYPE_DEPTH)
+    {
+        camera_calibration = &calibration->depth_camera_calibration;
+    }
+    else if (target_camera == K4A_CALIBRATION_TYPE_COLOR)
+    {
+        camera_calibration = &calibration->color_camera_calibration;
+    }
+    else
+    {
+        LOG_ERROR("Unexpected target camera calibration type %d, should either be K4A_CALIBRATION_TYPE_DEPTH (%d) or "
+                  "K4A_CALIBRATION_TYPE_COLOR (%d).",
+                  target_camera,
+                  K4A_CALIBRATION_TYPE_DEPTH,
+                  K4A_CALIBRATION_TYPE_COLOR);
+        return K4A_RESULT_FAILED; // project only supported for depth and color cameras
+    }
+
+    if (source_camera == target_camera)
+    {
+        return TRACE_CALL(
+            transformation_project_batch(camera_calibration, source_point3d, point_count, target_point2d, valid));
+    }
 
-        if (p_valid == 1)
+    float target_point3d[3 * TRANSFORMATION_BATCH_CHUNK_POINTS];
+    for (size_t i = 0; i < point_count; i += TRANSFORMATION_BATCH_CHUNK_POINTS)
+    {
+        size_t chunk_count = point_count - i < TRANSFORMATION_BATCH_CHUNK_POINTS ? point_count - i :
+                                                                                   TRANSFORMATION_BATCH_CHUNK_POINTS;
+        if (K4A_FAILED(TRACE_CALL(transformation_3d_to_3d_batch(
+                calibration, source_point3d + 3 * i, chunk_count, source_camera, target_camera, target_point3d))) ||
+            K4A_FAILED(TRACE_CALL(transformation_project_batch(
+                camera_calibration, target_point3d, chunk_count, target_point2d + 2 * i, valid + i))))
         {
-            // Transform the current searching depth pixel to color image
-            if (transformation_is_pixel_within_image(depth_point2d,
-                                                     depth_image_width_pixels,
-                                                     depth_image_height_pixels))
-            {
-                int u = (int)(floorf(depth_point2d[0] + 0.5f));
-                int v = (int)(floorf(depth_point2d[1] + 0.5f));
-                uint16_t d = depth_image_data[v * depth_image_width_pixels + u];
-                float reprojected_point2d[2];
-                if (K4A_FAILED(TRACE_CALL(transformation_2d_to_2d(calibration,
-                                                                  depth_point2d,
-                                                                  d,
-                                                                  K4A_CALIBRATION_TYPE_DEPTH,
-                                                                  K4A_CALIBRATION_TYPE_COLOR,
-                                                                  reprojected_point2d,
-                                                                  &p_valid))))
-                {
-                    return K4A_RESULT_FAILED;
-                }
+            return K4A_RESULT_FAILED;
+        }
+    }
 
-                if (p_valid == 1)
-                {
-                    if (transformation_is_pixel_within_image(reprojected_point2d,
-                                                             calibration->color_camera_calibration.resolution_width,
-                                                             calibration->color_camera_calibration.resolution_height))
-                    {
-
-                        // Compute the 2d reprojection error and store the minimum one
-                        float error = sqrtf(powf(reprojected_point2d[0] - source_point2d[0], 2) +
-                                            powf(reprojected_point2d[1] - source_point2d[1], 2));
-                        if (error < best_error)
-                        {
-                            best_error = error;
-                            target_point2d[0] = depth_point2d[0];
-                            target_point2d[1] = depth_point2d[1];
-                        }
-                    }
-                }
-            }
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t transformation_2d_to_2d_batch(const k4a_calibration_t *calibration,
+                                           const float *source_point2d,
+                                           const float *source_depth,
+                                           size_t point_count,
+                                           const k4a_calibration_type_t source_camera,
+                                           const k4a_calibration_type_t target_camera,
+                                           float *target_point2d,
+                                           int *valid)
+{
+    if (source_camera == target_camera)
+    {
+        for (size_t i = 0; i < point_count; i++)
+        {
+            target_point2d[2 * i + 0] = source_point2d[2 * i + 0];
+            target_point2d[2 * i + 1] = source_point2d[2 * i + 1];
+            valid[i] = 1;
         }
+        return K4A_RESULT_SUCCEEDED;
+    }
 
-        // Compute next pixel to search for on the epipolar line
-        if (xStep1)
+    float target_point3d[3 * TRANSFORMATION_BATCH_CHUNK_POINTS];
+    int valid_transformation1[TRANSFORMATION_BATCH_CHUNK_POINTS];
+    for (size_t i = 0; i < point_count; i += TRANSFORMATION_BATCH_CHUNK_POINTS)
+    {
+        size_t chunk_count = point_count - i < TRANSFORMATION_BATCH_CHUNK_POINTS ? point_count - i :
+                                                                                   TRANSFORMATION_BATCH_CHUNK_POINTS;
+        if (K4A_FAILED(TRACE_CALL(transformation_2d_to_3d_batch(calibration,
+                                                                source_point2d + 2 * i,
+                                                                source_depth + i,
+                                                                chunk_count,
+                                                                source_camera,
+                                                                target_camera,
+                                                                target_point3d,
+                                                                valid_transformation1))) ||
+            K4A_FAILED(TRACE_CALL(transformation_3d_to_2d_batch(calibration,
+                                                                target_point3d,
+                                                                chunk_count,
+                                                                target_camera,
+                                                                target_camera,
+                                                                target_point2d + 2 * i,
+                                                                valid + i))))
         {
-            p[0] = stop_larger_than_start ? p[0] + 1 : p[0] - 1;
-            p[1] = stop_larger_than_start ? p[1] + epipolar_line_slope : p[1] - epipolar_line_slope;
+            return K4A_RESULT_FAILED;
         }
-        else
+
+        for (size_t j = 0; j < chunk_count; j++)
         {
-            p[1] = stop_larger_than_start ? p[1] + 1 : p[1] - 1;
-            p[0] = stop_larger_than_start ? p[1] + 1 / epipolar_line_slope : p[1] - 1 / epipolar_line_slope;
+            valid[i + j] = valid[i + j] && valid_transformation1[j];
         }
     }
 
-    if (best_error > 10)
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t transformation_color_2d_to_depth_2d_batch(const k4a_calibration_t *calibration,
+                                                       const float *source_point2d,
+                                                       size_t point_count,
+                                                       const k4a_image_t depth_image,
+                                                       float *target_point2d,
+                                                       int *valid)
+{
+    k4a_transformation_pinhole_t pinhole = { 0 };
+    if (K4A_FAILED(TRACE_CALL(transformation_create_depth_camera_pinhole(calibration, &pinhole))))
     {
-        *valid = 0;
+        return K4A_RESULT_FAILED;
+    }
+
+    // Unproject whole chunks with the minimum and maximum depth values (mm) of transformation_color_2d_to_depth_2d(),
+    // only the epipolar line search is done a point at a time
+    float depth_range_mm[2][TRANSFORMATION_BATCH_CHUNK_POINTS];
+    for (size_t j = 0; j < TRANSFORMATION_BATCH_CHUNK_POINTS; j++)
+    {
+        depth_range_mm[0][j] = 50.f;
+        depth_range_mm[1][j] = 14000.f;
+    }
+
+    float start_point3d[3 * TRANSFORMATION_BATCH_CHUNK_POINTS], stop_point3d[3 * TRANSFORMATION_BATCH_CHUNK_POINTS];
+    int start_valid[TRANSFORMATION_BATCH_CHUNK_POINTS], stop_valid[TRANSFORMATION_BATCH_CHUNK_POINTS];
+    for (size_t i = 0; i < point_count; i += TRANSFORMATION_BATCH_CHUNK_POINTS)
+    {
+        size_t chunk_count = point_count - i < TRANSFORMATION_BATCH_CHUNK_POINTS ? point_count - i :
+                                                                                   TRANSFORMATION_BATCH_CHUNK_POINTS;
+        if (K4A_FAILED(TRACE_CALL(transformation_2d_to_3d_batch(calibration,
+                                                                source_point2d + 2 * i,
+                                                                depth_range_mm[0],
+                                                                chunk_count,
+                                                                K4A_CALIBRATION_TYPE_COLOR,
+                                                                K4A_CALIBRATION_TYPE_DEPTH,
+                                                                start_point3d,
+                                                                start_valid))) ||
+            K4A_FAILED(TRACE_CALL(transformation_2d_to_3d_batch(calibration,
+                                                                source_point2d + 2 * i,
+                                                                depth_range_mm[1],
+                                                                chunk_count,
+                                                                K4A_CALIBRATION_TYPE_COLOR,
+                                                                K4A_CALIBRATION_TYPE_DEPTH,
+                                                                stop_point3d,
+                                                                stop_valid))))
+        {
+            return K4A_RESULT_FAILED;
+        }
+
+        for (size_t j = 0; j < chunk_count; j++)
+        {
+            valid[i + j] = start_valid[j] && stop_valid[j];
+            if (valid[i + j] == 0)
+            {
+                continue;
+            }
+
+            if (K4A_FAILED(TRACE_CALL(transformation_color_2d_to_depth_2d_search(calibration,
+                                                                                 &pinhole,
+                                                                                 source_point2d + 2 * (i + j),
+                                                                                 start_point3d + 3 * j,
+                                                                                 stop_point3d + 3 * j,
+                                                                                 depth_image,
+                                                                                 false,
+                                                                                 target_point2d + 2 * (i + j),
+                                                                                 valid + i + j))))
+            {
+                return K4A_RESULT_FAILED;
+            }
+        }
     }
 
     return K4A_RESULT_SUCCEEDED;
@@ -542,8 +922,45 @@ static k4a_buffer_result_t transformation_init_xy_tables(const k4a_calibration_t
     }
 }
 
+// Large tables are backed by huge pages when enabled with allocator_set_huge_page_threshold(), context is set to
+// non-NULL for them
+static float *transformation_aligned_alloc_floats(size_t count, void **context)
+{
+    *context = NULL;
+    if (count * sizeof(float) <= INT32_MAX)
+    {
+        float *data = (float *)allocator_huge_page_alloc((int)(count * sizeof(float)), context);
+        if (data != NULL)
+        {
+            return data;
+        }
+    }
+
+#ifdef _MSC_VER
+    return (float *)_aligned_malloc(count * sizeof(float), 16);
+#else
+    return (float *)aligned_alloc(16, count * sizeof(float));
+#endif
+}
+
+static void transformation_aligned_free_floats(float *data, void *context)
+{
+    if (context != NULL)
+    {
+        allocator_huge_page_free(data, context);
+        return;
+    }
+
+#ifdef _MSC_VER
+    _aligned_free(data);
+#else
+    free(data);
+#endif
+}
+
 static k4a_result_t transformation_allocate_xy_tables(const k4a_calibration_t *calibration,
                                                       k4a_calibration_type_t camera,
+                                                      const allocator_hook_t *hook,
                                                       float **buffer,
                                                       k4a_transformation_xy_tables_t *xy_tables)
 {
@@ -555,11 +972,8 @@ static k4a_result_t transformation_allocate_xy_tables(const k4a_calibration_t *c
         return K4A_RESULT_FAILED;
     }
 
-#ifdef _MSC_VER
-    *buffer = _aligned_malloc(xy_tables_data_size * sizeof(float), 16);
-#else
-    *buffer = aligned_alloc(16, xy_tables_data_size * sizeof(float));
-#endif
+    // Freed with allocator_free(), a NULL hook allocates from the process allocator
+    *buffer = (float *)allocator_alloc_hooked(hook, ALLOCATION_SOURCE_USER, xy_tables_data_size * sizeof(float), 16);
 
     if (K4A_BUFFER_RESULT_SUCCEEDED !=
         TRACE_BUFFER_CALL(transformation_init_xy_tables(calibration, camera, *buffer, &xy_tables_data_size, xy_tables)))
@@ -569,107 +983,1033 @@ static k4a_result_t transformation_allocate_xy_tables(const k4a_calibration_t *c
     return K4A_RESULT_SUCCEEDED;
 }
 
-typedef struct _k4a_transformation_context_t
+// The xy tables of a camera only depend on these calibration fields, which are hashed to find shared tables. The
+// struct is zero initialized before it is filled so it can be hashed and compared bytewise.
+typedef struct _transformation_xy_tables_key_t
 {
-    k4a_calibration_t calibration;
-    k4a_transformation_xy_tables_t depth_camera_xy_tables;
-    float *memory_depth_camera_xy_tables;
-    k4a_transformation_xy_tables_t color_camera_xy_tables;
-    float *memory_color_camera_xy_tables;
-    bool enable_gpu_optimization;
-    bool enable_depth_color_transform;
-    tewrapper_t tewrapper;
-} k4a_transformation_context_t;
-
-K4A_DECLARE_CONTEXT(k4a_transformation_t, k4a_transformation_context_t);
+    k4a_calibration_intrinsics_t intrinsics;
+    int resolution_width;
+    int resolution_height;
+    float metric_radius;
+} transformation_xy_tables_key_t;
+
+// xy tables of the handles created without an allocator hook, shared by every handle with the same camera calibration
+// and freed with the last of them
+typedef struct _transformation_shared_xy_tables_t
+{
+    struct _transformation_shared_xy_tables_t *next;
+    transformation_xy_tables_key_t key;
+    uint64_t hash;
+    uint32_t ref_count;
+    float *data;
+    void *data_context; // Set when data is backed by huge pages
+    k4a_transformation_xy_tables_t xy_tables;
+} transformation_shared_xy_tables_t;
+
+typedef struct
+{
+    // Serializes the lookups, table building included, so tables of the same calibration are only built once
+    LOCK_HANDLE lock;
+    transformation_shared_xy_tables_t *head;
+} transformation_xy_tables_global_t;
 
-k4a_transformation_t transformation_create(const k4a_calibration_t *calibration, bool gpu_optimization)
+static void transformation_xy_tables_global_init(transformation_xy_tables_global_t *g_xy_tables)
 {
-    k4a_transformation_t transformation_handle = NULL;
+    g_xy_tables->lock = Lock_Init();
+}
+
+K4A_DECLARE_GLOBAL(transformation_xy_tables_global_t, transformation_xy_tables_global_init);
+
+// Files of the disk cache start with this header followed by the x table and the y table. Bump the version when the
+// table computation changes.
+#define TRANSFORMATION_XY_TABLES_CACHE_MAGIC 0x59584B34 // "4KXY"
+#define TRANSFORMATION_XY_TABLES_CACHE_VERSION 1
+
+typedef struct _transformation_xy_tables_cache_header_t
+{
+    uint32_t magic;
+    uint32_t version;
+    transformation_xy_tables_key_t key;
+} transformation_xy_tables_cache_header_t;
+
+static void transformation_get_xy_tables_key(const k4a_calibration_t *calibration,
+                                             k4a_calibration_type_t camera,
+                                             transformation_xy_tables_key_t *key,
+                                             uint64_t *hash)
+{
+    const k4a_calibration_camera_t *camera_calibration = camera == K4A_CALIBRATION_TYPE_COLOR ?
+                                                             &calibration->color_camera_calibration :
+                                                             &calibration->depth_camera_calibration;
+    memset(key, 0, sizeof(transformation_xy_tables_key_t));
+    key->intrinsics = camera_calibration->intrinsics;
+    key->resolution_width = camera_calibration->resolution_width;
+    key->resolution_height = camera_calibration->resolution_height;
+    key->metric_radius = camera_calibration->metric_radius;
+
+    // 64 bit FNV-1a
+    const uint8_t *bytes = (const uint8_t *)key;
+    *hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < sizeof(transformation_xy_tables_key_t); i++)
+    {
+        *hash = (*hash ^ bytes[i]) * 1099511628211ULL;
+    }
+}
+
+// Tables are persisted in the directory set with K4A_TRANSFORMATION_XY_TABLES_CACHE, returns false if it is not set
+static bool transformation_get_xy_tables_cache_path(uint64_t hash, char *path, size_t path_size)
+{
+    const char *directory = environment_get_variable("K4A_TRANSFORMATION_XY_TABLES_CACHE");
+    if (directory == NULL || directory[0] == '\0')
+    {
+        return false;
+    }
+
+    int length = snprintf(path, path_size, "%s/k4a_xy_tables_%016llx.bin", directory, (unsigned long long)hash);
+    return length > 0 && (size_t)length < path_size;
+}
+
+static bool transformation_load_xy_tables(const transformation_shared_xy_tables_t *shared, size_t data_size)
+{
+    char path[1024];
+    if (!transformation_get_xy_tables_cache_path(shared->hash, path, sizeof(path)))
+    {
+        return false;
+    }
+
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    transformation_xy_tables_cache_header_t header;
+    bool loaded = fread(&header, sizeof(header), 1, file) == 1 &&
+                  header.magic == TRANSFORMATION_XY_TABLES_CACHE_MAGIC &&
+                  header.version == TRANSFORMATION_XY_TABLES_CACHE_VERSION &&
+                  memcmp(&header.key, &shared->key, sizeof(transformation_xy_tables_key_t)) == 0 &&
+                  fread(shared->data, sizeof(float), data_size, file) == data_size && fgetc(file) == EOF;
+    fclose(file);
+
+    if (!loaded)
+    {
+        LOG_WARNING("Ignoring the xy tables cache file %s, it does not match the calibration.", path);
+    }
+    return loaded;
+}
+
+// Writes a temporary file renamed into place once complete, so concurrent processes never load a partial file
+static void transformation_save_xy_tables(const transformation_shared_xy_tables_t *shared, size_t data_size)
+{
+    char path[1024];
+    char temporary_path[1040];
+    if (!transformation_get_xy_tables_cache_path(shared->hash, path, sizeof(path)))
+    {
+        return;
+    }
+    snprintf(temporary_path, sizeof(temporary_path), "%s.tmp", path);
+
+    FILE *file = fopen(temporary_path, "wb");
+    if (file == NULL)
+    {
+        LOG_WARNING("Failed to create the xy tables cache file %s.", temporary_path);
+        return;
+    }
+
+    transformation_xy_tables_cache_header_t header;
+    memset(&header, 0, sizeof(header));
+    header.magic = TRANSFORMATION_XY_TABLES_CACHE_MAGIC;
+    header.version = TRANSFORMATION_XY_TABLES_CACHE_VERSION;
+    header.key = shared->key;
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                   fwrite(shared->data, sizeof(float), data_size, file) == data_size;
+    written = fclose(file) == 0 && written;
+
+    // Renaming fails on Windows if another process saved the same tables first, which is just as good
+    if (!written || rename(temporary_path, path) != 0)
+    {
+        remove(temporary_path);
+    }
+}
+
+static transformation_shared_xy_tables_t *
+transformation_create_shared_xy_tables(const k4a_calibration_t *calibration,
+                                       k4a_calibration_type_t camera,
+                                       const transformation_xy_tables_key_t *key,
+                                       uint64_t hash)
+{
+    transformation_shared_xy_tables_t *shared = (transformation_shared_xy_tables_t *)calloc(
+        1, sizeof(transformation_shared_xy_tables_t));
+    if (shared == NULL)
+    {
+        LOG_ERROR("Failed to allocate the shared xy tables.", 0);
+        return NULL;
+    }
+    shared->key = *key;
+    shared->hash = hash;
+    shared->ref_count = 1;
+
+    size_t data_size = 0;
+    k4a_result_t result = K4A_RESULT_FROM_BOOL(
+        K4A_BUFFER_RESULT_TOO_SMALL ==
+        TRACE_BUFFER_CALL(transformation_init_xy_tables(calibration, camera, NULL, &data_size, &shared->xy_tables)));
+
+    if (K4A_SUCCEEDED(result))
+    {
+        shared->data = transformation_aligned_alloc_floats(data_size, &shared->data_context);
+        result = K4A_RESULT_FROM_BOOL(shared->data != NULL);
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        if (transformation_load_xy_tables(shared, data_size))
+        {
+            size_t table_size = data_size / 2;
+            shared->xy_tables.width = key->resolution_width;
+            shared->xy_tables.height = key->resolution_height;
+            shared->xy_tables.x_table = shared->data;
+            shared->xy_tables.y_table = shared->data + table_size;
+        }
+        else
+        {
+            result = K4A_RESULT_FROM_BOOL(
+                K4A_BUFFER_RESULT_SUCCEEDED ==
+                TRACE_BUFFER_CALL(
+                    transformation_init_xy_tables(calibration, camera, shared->data, &data_size, &shared->xy_tables)));
+            if (K4A_SUCCEEDED(result))
+            {
+                transformation_save_xy_tables(shared, data_size);
+            }
+        }
+    }
+
+    if (K4A_FAILED(result))
+    {
+        transformation_aligned_free_floats(shared->data, shared->data_context);
+        free(shared);
+        return NULL;
+    }
+    return shared;
+}
+
+// Returns the tables of camera shared with the other handles of the same camera calibration, building them if this is
+// the first handle. Release them with transformation_release_shared_xy_tables().
+static transformation_shared_xy_tables_t *
+transformation_acquire_shared_xy_tables(const k4a_calibration_t *calibration, k4a_calibration_type_t camera)
+{
+    transformation_xy_tables_key_t key;
+    uint64_t hash = 0;
+    transformation_get_xy_tables_key(calibration, camera, &key, &hash);
+
+    transformation_xy_tables_global_t *g_xy_tables = transformation_xy_tables_global_t_get();
+    if (g_xy_tables->lock == NULL)
+    {
+        LOG_ERROR("Failed to initialize the shared xy tables lock.", 0);
+        return NULL;
+    }
+
+    Lock(g_xy_tables->lock);
+    transformation_shared_xy_tables_t *shared = g_xy_tables->head;
+    while (shared != NULL &&
+           (shared->hash != hash || memcmp(&shared->key, &key, sizeof(transformation_xy_tables_key_t)) != 0))
+    {
+        shared = shared->next;
+    }
+
+    if (shared != NULL)
+    {
+        shared->ref_count++;
+    }
+    else
+    {
+        shared = transformation_create_shared_xy_tables(calibration, camera, &key, hash);
+        if (shared != NULL)
+        {
+            shared->next = g_xy_tables->head;
+            g_xy_tables->head = shared;
+        }
+    }
+    Unlock(g_xy_tables->lock);
+    return shared;
+}
+
+static void transformation_release_shared_xy_tables(transformation_shared_xy_tables_t *shared)
+{
+    transformation_xy_tables_global_t *g_xy_tables = transformation_xy_tables_global_t_get();
+
+    Lock(g_xy_tables->lock);
+    if (--shared->ref_count == 0)
+    {
+        transformation_shared_xy_tables_t **link = &g_xy_tables->head;
+        while (*link != shared)
+        {
+            link = &(*link)->next;
+        }
+        *link = shared->next;
+
+        transformation_aligned_free_floats(shared->data, shared->data_context);
+        free(shared);
+    }
+    Unlock(g_xy_tables->lock);
+}
+
+// Work queued with transformation_run_async()
+typedef struct _transformation_async_job_t
+{
+    struct _transformation_async_job_t *next;
+    transformation_async_fn_t *fn;
+    void *context;
+} transformation_async_job_t;
+
+// Transformation threads that released their handle themselves, they are joined by the next create or destroy
+typedef struct _transformation_async_exited_t
+{
+    struct _transformation_async_exited_t *next;
+    THREAD_HANDLE thread;
+} transformation_async_exited_t;
+
+typedef struct
+{
+    LOCK_HANDLE lock;
+    transformation_async_exited_t *head;
+} transformation_async_global_t;
+
+static void transformation_async_global_init(transformation_async_global_t *g_async)
+{
+    g_async->lock = Lock_Init();
+}
+
+K4A_DECLARE_GLOBAL(transformation_async_global_t, transformation_async_global_init);
+
+#ifdef _MSC_VER
+#define TRANSFORMATION_THREAD_LOCAL __declspec(thread)
+#else
+#define TRANSFORMATION_THREAD_LOCAL __thread
+#endif
+
+// Context of the transformation thread running on this thread, NULL on every other thread
+static TRANSFORMATION_THREAD_LOCAL void *g_async_thread_context = NULL;
+
+static void transformation_join_exited_async_threads(void)
+{
+    transformation_async_global_t *g_async = transformation_async_global_t_get();
+
+    Lock(g_async->lock);
+    transformation_async_exited_t *exited = g_async->head;
+    g_async->head = NULL;
+    Unlock(g_async->lock);
+
+    while (exited != NULL)
+    {
+        transformation_async_exited_t *next = exited->next;
+        int thread_result;
+        THREADAPI_RESULT tresult = ThreadAPI_Join(exited->thread, &thread_result);
+        (void)K4A_RESULT_FROM_BOOL(tresult == THREADAPI_OK); // Trace the issue, but we don't return a failure
+        free(exited);
+        exited = next;
+    }
+}
+
+static void transformation_free_ray_tables(k4a_transformation_ray_tables_t *ray_tables)
+{
+    // The y and z tables share the x table allocation
+    free(ray_tables->x_table);
+    memset(ray_tables, 0, sizeof(k4a_transformation_ray_tables_t));
+}
+
+static k4a_result_t transformation_init_ray_tables(const k4a_calibration_t *calibration,
+                                                   const k4a_transformation_xy_tables_t *xy_tables,
+                                                   k4a_transformation_ray_tables_t *ray_tables)
+{
+    size_t table_size = (size_t)xy_tables->width * (size_t)xy_tables->height;
+    float *data = (float *)malloc(3 * table_size * sizeof(float));
+    if (data == NULL)
+    {
+        LOG_ERROR("Failed to allocate the precomputed rays.", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    const k4a_calibration_extrinsics_t *extrinsics =
+        &calibration->extrinsics[K4A_CALIBRATION_TYPE_DEPTH][K4A_CALIBRATION_TYPE_COLOR];
+    const float *R = extrinsics->rotation;
+
+    ray_tables->x_table = data;
+    ray_tables->y_table = data + table_size;
+    ray_tables->z_table = data + 2 * table_size;
+    memcpy(ray_tables->translation, extrinsics->translation, sizeof(ray_tables->translation));
+    ray_tables->width = xy_tables->width;
+    ray_tables->height = xy_tables->height;
+
+    for (size_t idx = 0; idx < table_size; idx++)
+    {
+        float x = xy_tables->x_table[idx];
+        float y = xy_tables->y_table[idx];
+        if (isnan(x))
+        {
+            ray_tables->x_table[idx] = NAN;
+            ray_tables->y_table[idx] = 0.f;
+            ray_tables->z_table[idx] = 0.f;
+            continue;
+        }
+
+        // Rotation of the depth camera point (x, y, 1), the depth scales it per frame
+        ray_tables->x_table[idx] = R[0] * x + R[1] * y + R[2];
+        ray_tables->y_table[idx] = R[3] * x + R[4] * y + R[5];
+        ray_tables->z_table[idx] = R[6] * x + R[7] * y + R[8];
+    }
+    return K4A_RESULT_SUCCEEDED;
+}
+
+typedef struct _k4a_transformation_context_t
+{
+    k4a_calibration_t calibration;
+
+    // The xy tables and the transform engine are built by the first call that needs them, or by
+    // transformation_warm_up(), while holding setup_lock. Read them with transformation_get_xy_tables() and
+    // transformation_get_tewrapper().
+    LOCK_HANDLE setup_lock;
+    bool depth_camera_xy_tables_built;
+    bool color_camera_xy_tables_built;
+    k4a_transformation_xy_tables_t depth_camera_xy_tables;
+    float *memory_depth_camera_xy_tables;
+    k4a_transformation_xy_tables_t color_camera_xy_tables;
+    float *memory_color_camera_xy_tables;
+    bool xy_tables_from_allocator; // xy table memory is allocated from hook and freed with allocator_free()
+    allocator_hook_t hook;
+    // Tables of the handles without an allocator hook, the memory_ pointers are NULL
+    transformation_shared_xy_tables_t *shared_depth_camera_xy_tables;
+    transformation_shared_xy_tables_t *shared_color_camera_xy_tables;
+    bool enable_gpu_optimization;
+    bool enable_depth_color_transform;
+    uint32_t cpu_thread_count; // Threads of the CPU depth to color implementation
+    k4a_transformation_depth_to_color_mode_t depth_to_color_mode; // Rendering of the CPU depth to color implementation
+    bool fixed_point_bilinear; // The CPU color to depth implementation blends in integer arithmetic
+    k4a_transformation_ray_tables_t depth_camera_ray_tables; // x_table is NULL unless precomputed rays are enabled
+    tewrapper_t tewrapper;
+    k4a_transformation_backend_t backend;
+    clwrapper_t clwrapper; // Created when the OpenCL backend is first selected
+    bool gpu_output;       // OpenCL results are not copied to the output images
+    void *gpu_context;     // cl_context and cl_device_id of the caller for the OpenCL backend, NULL for the default
+    void *gpu_device;
+
+    // Asynchronous transformations, async_thread is created by the first transformation_run_async()
+    LOCK_HANDLE async_lock;
+    COND_HANDLE async_condition;
+    THREAD_HANDLE async_thread;
+    bool async_stop;
+    k4a_transformation_t async_release_handle; // Set when destroyed from a callback, the thread releases the handle
+    transformation_async_job_t *async_head; // Only accessed while holding async_lock
+    transformation_async_job_t *async_tail;
+} k4a_transformation_context_t;
+
+K4A_DECLARE_CONTEXT(k4a_transformation_t, k4a_transformation_context_t);
+
+// Returns the xy tables of camera, building them on the first call. NULL if they could not be built.
+static const k4a_transformation_xy_tables_t *
+transformation_get_xy_tables(k4a_transformation_context_t *transformation_context, k4a_calibration_type_t camera)
+{
+    bool depth = camera == K4A_CALIBRATION_TYPE_DEPTH;
+    k4a_transformation_xy_tables_t *xy_tables = depth ? &transformation_context->depth_camera_xy_tables :
+                                                        &transformation_context->color_camera_xy_tables;
+    bool *built = depth ? &transformation_context->depth_camera_xy_tables_built :
+                          &transformation_context->color_camera_xy_tables_built;
+
+    Lock(transformation_context->setup_lock);
+    if (!*built)
+    {
+        if (transformation_context->xy_tables_from_allocator)
+        {
+            float **memory = depth ? &transformation_context->memory_depth_camera_xy_tables :
+                                     &transformation_context->memory_color_camera_xy_tables;
+            *built = K4A_SUCCEEDED(TRACE_CALL(transformation_allocate_xy_tables(
+                &transformation_context->calibration, camera, &transformation_context->hook, memory, xy_tables)));
+            if (!*built && *memory != 0)
+            {
+                allocator_free(*memory);
+                *memory = 0;
+            }
+        }
+        else
+        {
+            // Read only after they are built, so every handle of the same cameras uses the same tables
+            transformation_shared_xy_tables_t **shared = depth ?
+                                                             &transformation_context->shared_depth_camera_xy_tables :
+                                                             &transformation_context->shared_color_camera_xy_tables;
+            *shared = transformation_acquire_shared_xy_tables(&transformation_context->calibration, camera);
+            *built = K4A_SUCCEEDED(K4A_RESULT_FROM_BOOL(*shared != NULL));
+            if (*built)
+            {
+                *xy_tables = (*shared)->xy_tables;
+            }
+        }
+    }
+    bool ready = *built;
+    Unlock(transformation_context->setup_lock);
+    return ready ? xy_tables : NULL;
+}
+
+// Returns the transform engine, starting it on the first call. NULL if it could not be started.
+static tewrapper_t transformation_get_tewrapper(k4a_transformation_context_t *transformation_context)
+{
+    const k4a_transformation_xy_tables_t *depth_camera_xy_tables =
+        transformation_get_xy_tables(transformation_context, K4A_CALIBRATION_TYPE_DEPTH);
+    if (depth_camera_xy_tables == NULL)
+    {
+        return NULL;
+    }
+
+    Lock(transformation_context->setup_lock);
+    if (transformation_context->tewrapper == NULL)
+    {
+        // Set up transform engine expected calibration struct
+        k4a_transform_engine_calibration_t transform_engine_calibration;
+        memcpy(&transform_engine_calibration.depth_camera_calibration,
+               &transformation_context->calibration.depth_camera_calibration,
+               sizeof(k4a_calibration_camera_t));
+        memcpy(&transform_engine_calibration.color_camera_calibration,
+               &transformation_context->calibration.color_camera_calibration,
+               sizeof(k4a_calibration_camera_t));
+        memcpy(&transform_engine_calibration.depth_camera_to_color_camera_extrinsics,
+               &transformation_context->calibration.extrinsics[K4A_CALIBRATION_TYPE_DEPTH][K4A_CALIBRATION_TYPE_COLOR],
+               sizeof(k4a_calibration_extrinsics_t));
+        memcpy(&transform_engine_calibration.color_camera_to_depth_camera_extrinsics,
+               &transformation_context->calibration.extrinsics[K4A_CALIBRATION_TYPE_COLOR][K4A_CALIBRATION_TYPE_DEPTH],
+               sizeof(k4a_calibration_extrinsics_t));
+        memcpy(&transform_engine_calibration.depth_camera_xy_tables,
+               depth_camera_xy_tables,
+               sizeof(k4a_transformation_xy_tables_t));
+
+        transformation_context->tewrapper = tewrapper_create(&transform_engine_calibration);
+    }
+    tewrapper_t tewrapper = transformation_context->tewrapper;
+    Unlock(transformation_context->setup_lock);
+
+    (void)K4A_RESULT_FROM_BOOL(tewrapper != NULL); // Traced here, the callers return the failure
+    return tewrapper;
+}
+
+k4a_transformation_t transformation_create(const k4a_calibration_t *calibration, bool gpu_optimization)
+{
+    return transformation_create_with_allocator(calibration, gpu_optimization, NULL);
+}
+
+k4a_transformation_t transformation_create_with_allocator(const k4a_calibration_t *calibration,
+                                                          bool gpu_optimization,
+                                                          const allocator_hook_t *hook)
+{
+    transformation_join_exited_async_threads();
+
+    k4a_transformation_t transformation_handle = NULL;
     k4a_transformation_context_t *transformation_context = k4a_transformation_t_create(&transformation_handle);
 
-    memcpy(&transformation_context->calibration, calibration, sizeof(k4a_calibration_t));
+    memcpy(&transformation_context->calibration, calibration, sizeof(k4a_calibration_t));
+
+    transformation_context->setup_lock = Lock_Init();
+    transformation_context->async_lock = Lock_Init();
+    transformation_context->async_condition = Condition_Init();
+    if (K4A_FAILED(K4A_RESULT_FROM_BOOL(transformation_context->setup_lock != NULL &&
+                                        transformation_context->async_lock != NULL &&
+                                        transformation_context->async_condition != NULL)))
+    {
+        transformation_destroy(transformation_handle);
+        return 0;
+    }
+
+    if (hook != NULL && hook->allocate != NULL)
+    {
+        transformation_context->xy_tables_from_allocator = true;
+        transformation_context->hook = *hook;
+    }
+
+    transformation_context->enable_gpu_optimization = gpu_optimization;
+    transformation_context->cpu_thread_count = 1;
+    transformation_context->depth_to_color_mode = K4A_TRANSFORMATION_DEPTH_TO_COLOR_MODE_QUADS;
+    transformation_context->fixed_point_bilinear = false;
+    transformation_context->enable_depth_color_transform = transformation_context->calibration.color_resolution !=
+                                                               K4A_COLOR_RESOLUTION_OFF &&
+                                                           transformation_context->calibration.depth_mode !=
+                                                               K4A_DEPTH_MODE_OFF;
+
+    return transformation_handle;
+}
+
+// Releases everything but the transformation thread, which has exited or is the calling thread
+static void transformation_release(k4a_transformation_t transformation_handle)
+{
+    k4a_transformation_context_t *transformation_context = k4a_transformation_t_get_context(transformation_handle);
+
+    if (transformation_context->async_condition)
+    {
+        Condition_Deinit(transformation_context->async_condition);
+    }
+
+    if (transformation_context->async_lock)
+    {
+        Lock_Deinit(transformation_context->async_lock);
+    }
+
+    if (transformation_context->setup_lock)
+    {
+        Lock_Deinit(transformation_context->setup_lock);
+    }
+
+    if (transformation_context->xy_tables_from_allocator)
+    {
+        if (transformation_context->memory_depth_camera_xy_tables != 0)
+        {
+            allocator_free(transformation_context->memory_depth_camera_xy_tables);
+        }
+        if (transformation_context->memory_color_camera_xy_tables != 0)
+        {
+            allocator_free(transformation_context->memory_color_camera_xy_tables);
+        }
+    }
+
+    if (transformation_context->shared_depth_camera_xy_tables != NULL)
+    {
+        transformation_release_shared_xy_tables(transformation_context->shared_depth_camera_xy_tables);
+    }
+    if (transformation_context->shared_color_camera_xy_tables != NULL)
+    {
+        transformation_release_shared_xy_tables(transformation_context->shared_color_camera_xy_tables);
+    }
+    transformation_free_ray_tables(&transformation_context->depth_camera_ray_tables);
+    if (transformation_context->tewrapper)
+    {
+        tewrapper_destroy(transformation_context->tewrapper);
+    }
+    if (transformation_context->clwrapper)
+    {
+        clwrapper_destroy(transformation_context->clwrapper);
+    }
+    k4a_transformation_t_destroy(transformation_handle);
+}
+
+void transformation_destroy(k4a_transformation_t transformation_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, k4a_transformation_t, transformation_handle);
+    k4a_transformation_context_t *transformation_context = k4a_transformation_t_get_context(transformation_handle);
+
+    // Let the transformation thread finish what is queued, the jobs use the tables released below
+    THREAD_HANDLE async_thread = NULL;
+    if (transformation_context->async_lock)
+    {
+        Lock(transformation_context->async_lock);
+        transformation_context->async_stop = true;
+        if (g_async_thread_context == transformation_context)
+        {
+            // Called from a callback, the thread can't join itself so it releases the handle once the queue is empty
+            transformation_context->async_release_handle = transformation_handle;
+            Unlock(transformation_context->async_lock);
+            return;
+        }
+        async_thread = transformation_context->async_thread;
+        transformation_context->async_thread = NULL;
+        Condition_Post(transformation_context->async_condition);
+        Unlock(transformation_context->async_lock);
+    }
+
+    if (async_thread)
+    {
+        int thread_result;
+        THREADAPI_RESULT tresult = ThreadAPI_Join(async_thread, &thread_result);
+        (void)K4A_RESULT_FROM_BOOL(tresult == THREADAPI_OK); // Trace the issue, but we don't return a failure
+    }
+
+    transformation_release(transformation_handle);
+    transformation_join_exited_async_threads();
+}
+
+k4a_result_t transformation_warm_up(k4a_transformation_t transformation_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_transformation_t, transformation_handle);
+    k4a_transformation_context_t *transformation_context = k4a_transformation_t_get_context(transformation_handle);
+
+    k4a_result_t result = K4A_RESULT_SUCCEEDED;
+    if (transformation_context->calibration.depth_mode != K4A_DEPTH_MODE_OFF)
+    {
+        result = K4A_RESULT_FROM_BOOL(transformation_get_xy_tables(transformation_context,
+                                                                   K4A_CALIBRATION_TYPE_DEPTH) != NULL);
+    }
+    if (K4A_SUCCEEDED(result) && transformation_context->calibration.color_resolution != K4A_COLOR_RESOLUTION_OFF)
+    {
+        result = K4A_RESULT_FROM_BOOL(transformation_get_xy_tables(transformation_context,
+                                                                   K4A_CALIBRATION_TYPE_COLOR) != NULL);
+    }
+    if (K4A_SUCCEEDED(result) && transformation_context->enable_gpu_optimization &&
+        transformation_context->enable_depth_color_transform)
+    {
+        result = K4A_RESULT_FROM_BOOL(transformation_get_tewrapper(transformation_context) != NULL);
+    }
+    return result;
+}
+
+k4a_result_t transformation_set_cpu_thread_count(k4a_transformation_t transformation_handle, uint32_t thread_count)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_transformation_t, transformation_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, thread_count == 0 || thread_count > K4A_TRANSFORMATION_MAX_THREAD_COUNT);
+    k4a_transformation_context_t *transformation_context = k4a_transformation_t_get_context(transformation_handle);
+
+    transformation_context->cpu_thread_count = thread_count;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t transformation_set_depth_to_color_mode(k4a_transformation_t transformation_handle,
+                                                    k4a_transformation_depth_to_color_mode_t mode)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_transformation_t, transformation_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED,
+                        mode != K4A_TRANSFORMATION_DEPTH_TO_COLOR_MODE_QUADS &&
+                            mode != K4A_TRANSFORMATION_DEPTH_TO_COLOR_MODE_SPLAT &&
+                            mode != K4A_TRANSFORMATION_DEPTH_TO_COLOR_MODE_SPLAT_2X2);
+    k4a_transformation_context_t *transformation_context = k4a_transformation_t_get_context(transformation_handle);
+
+    transformation_context->depth_to_color_mode = mode;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t transformation_set_fixed_point_bilinear(k4a_transformation_t transformation_handle, bool enable)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_transformation_t, transformation_handle);
+    k4a_transformation_context_t *transformation_context = k4a_transformation_t_get_context(transformation_handle);
+
+    transformation_context->fixed_point_bilinear = enable;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t transformation_get_xy_table(k4a_transformation_t transformation_handle,
+                                        k4a_calibration_type_t camera,
+                                        k4a_xy_table_t *xy_table)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_transformation_t, transformation_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, camera != K4A_CALIBRATION_TYPE_DEPTH && camera != K4A_CALIBRATION_TYPE_COLOR);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, xy_table == NULL);
+    k4a_transformation_context_t *transformation_context = k4a_transformation_t_get_context(transformation_handle);
+
+    memset(xy_table, 0, sizeof(*xy_table));
+    const k4a_transformation_xy_tables_t *xy_tables = transformation_get_xy_tables(transformation_context, camera);
+    if (xy_tables == NULL)
+    {
+        return K4A_RESULT_FAILED;
+    }
+    if (xy_tables->x_table == NULL || xy_tables->width <= 0 || xy_tables->height <= 0)
+    {
+        LOG_ERROR("The %s camera of the transformation calibration is off.",
+                  camera == K4A_CALIBRATION_TYPE_DEPTH ? "depth" : "color");
+        return K4A_RESULT_FAILED;
+    }
+
+    xy_table->x_table = xy_tables->x_table;
+    xy_table->y_table = xy_tables->y_table;
+    xy_table->width = xy_tables->width;
+    xy_table->height = xy_tables->height;
+    return K4A_RESULT_SUCCEEDED;
+}
 
-    if (K4A_FAILED(TRACE_CALL(transformation_allocate_xy_tables(&transformation_context->calibration,
-                                                                K4A_CALIBRATION_TYPE_DEPTH,
-                                                                &transformation_context->memory_depth_camera_xy_tables,
-                                                                &transformation_context->depth_camera_xy_tables))))
+k4a_result_t transformation_set_precomputed_rays(k4a_transformation_t transformation_handle, bool enable)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_transformation_t, transformation_handle);
+    k4a_transformation_context_t *transformation_context = k4a_transformation_t_get_context(transformation_handle);
+
+    if (!enable)
     {
-        transformation_destroy(transformation_handle);
-        return 0;
+        transformation_free_ray_tables(&transformation_context->depth_camera_ray_tables);
+        return K4A_RESULT_SUCCEEDED;
     }
 
-    if (K4A_FAILED(TRACE_CALL(transformation_allocate_xy_tables(&transformation_context->calibration,
-                                                                K4A_CALIBRATION_TYPE_COLOR,
-                                                                &transformation_context->memory_color_camera_xy_tables,
-                                                                &transformation_context->color_camera_xy_tables))))
+    if (transformation_context->depth_camera_ray_tables.x_table != NULL)
     {
-        transformation_destroy(transformation_handle);
-        return 0;
+        return K4A_RESULT_SUCCEEDED;
     }
 
-    transformation_context->enable_gpu_optimization = gpu_optimization;
-    transformation_context->enable_depth_color_transform = transformation_context->calibration.color_resolution !=
-                                                               K4A_COLOR_RESOLUTION_OFF &&
-                                                           transformation_context->calibration.depth_mode !=
-                                                               K4A_DEPTH_MODE_OFF;
-    if (transformation_context->enable_gpu_optimization && transformation_context->enable_depth_color_transform)
+    if (!transformation_context->enable_depth_color_transform)
     {
-        // Set up transform engine expected calibration struct
-        k4a_transform_engine_calibration_t transform_engine_calibration;
-        memcpy(&transform_engine_calibration.depth_camera_calibration,
-               &transformation_context->calibration.depth_camera_calibration,
-               sizeof(k4a_calibration_camera_t));
-        memcpy(&transform_engine_calibration.color_camera_calibration,
-               &transformation_context->calibration.color_camera_calibration,
-               sizeof(k4a_calibration_camera_t));
-        memcpy(&transform_engine_calibration.depth_camera_to_color_camera_extrinsics,
-               &transformation_context->calibration.extrinsics[K4A_CALIBRATION_TYPE_DEPTH][K4A_CALIBRATION_TYPE_COLOR],
-               sizeof(k4a_calibration_extrinsics_t));
-        memcpy(&transform_engine_calibration.color_camera_to_depth_camera_extrinsics,
-               &transformation_context->calibration.extrinsics[K4A_CALIBRATION_TYPE_COLOR][K4A_CALIBRATION_TYPE_DEPTH],
-               sizeof(k4a_calibration_extrinsics_t));
-        memcpy(&transform_engine_calibration.depth_camera_xy_tables,
-               &transformation_context->depth_camera_xy_tables,
-               sizeof(k4a_transformation_xy_tables_t));
+        LOG_ERROR("Precomputed rays need both the depth camera and the color camera calibration.", 0);
+        return K4A_RESULT_FAILED;
+    }
 
-        transformation_context->tewrapper = tewrapper_create(&transform_engine_calibration);
-        if (K4A_FAILED(K4A_RESULT_FROM_BOOL(transformation_context->tewrapper != NULL)))
+    const k4a_transformation_xy_tables_t *depth_camera_xy_tables =
+        transformation_get_xy_tables(transformation_context, K4A_CALIBRATION_TYPE_DEPTH);
+    if (depth_camera_xy_tables == NULL)
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    return TRACE_CALL(transformation_init_ray_tables(&transformation_context->calibration,
+                                                     depth_camera_xy_tables,
+                                                     &transformation_context->depth_camera_ray_tables));
+}
+
+// Ray tables for the CPU transformations, NULL to compute correspondences from the calibration
+static const k4a_transformation_ray_tables_t *
+transformation_get_ray_tables(const k4a_transformation_context_t *transformation_context)
+{
+    if (transformation_context->depth_camera_ray_tables.x_table == NULL)
+    {
+        return NULL;
+    }
+    return &transformation_context->depth_camera_ray_tables;
+}
+
+k4a_result_t transformation_set_backend(k4a_transformation_t transformation_handle,
+                                        k4a_transformation_backend_t backend)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_transformation_t, transformation_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED,
+                        backend != K4A_TRANSFORMATION_BACKEND_DEFAULT && backend != K4A_TRANSFORMATION_BACKEND_CPU &&
+                            backend != K4A_TRANSFORMATION_BACKEND_OPENCL);
+    k4a_transformation_context_t *transformation_context = k4a_transformation_t_get_context(transformation_handle);
+
+    if (backend == K4A_TRANSFORMATION_BACKEND_OPENCL && transformation_context->clwrapper == NULL)
+    {
+        const k4a_transformation_xy_tables_t *depth_camera_xy_tables =
+            transformation_get_xy_tables(transformation_context, K4A_CALIBRATION_TYPE_DEPTH);
+        const k4a_transformation_xy_tables_t *color_camera_xy_tables =
+            transformation_get_xy_tables(transformation_context, K4A_CALIBRATION_TYPE_COLOR);
+        if (depth_camera_xy_tables == NULL || color_camera_xy_tables == NULL)
+        {
+            return K4A_RESULT_FAILED;
+        }
+
+        // The rays are only needed while they are uploaded
+        k4a_transformation_ray_tables_t ray_tables = { 0 };
+        const k4a_transformation_ray_tables_t *rays = NULL;
+        if (transformation_context->enable_depth_color_transform)
+        {
+            rays = transformation_get_ray_tables(transformation_context);
+            if (rays == NULL)
+            {
+                k4a_result_t result = TRACE_CALL(
+                    transformation_init_ray_tables(&transformation_context->calibration,
+                                                   depth_camera_xy_tables,
+                                                   &ray_tables));
+                if (K4A_FAILED(result))
+                {
+                    return result;
+                }
+                rays = &ray_tables;
+            }
+        }
+
+        transformation_context->clwrapper = clwrapper_create(&transformation_context->calibration,
+                                                             rays,
+                                                             depth_camera_xy_tables,
+                                                             color_camera_xy_tables,
+                                                             transformation_context->gpu_context,
+                                                             transformation_context->gpu_device);
+        transformation_free_ray_tables(&ray_tables);
+        if (K4A_FAILED(K4A_RESULT_FROM_BOOL(transformation_context->clwrapper != NULL)))
         {
-            transformation_destroy(transformation_handle);
-            return 0;
+            return K4A_RESULT_FAILED;
         }
     }
 
-    return transformation_handle;
+    if (backend != K4A_TRANSFORMATION_BACKEND_OPENCL)
+    {
+        transformation_context->gpu_output = false;
+    }
+    transformation_context->backend = backend;
+    return K4A_RESULT_SUCCEEDED;
 }
 
-void transformation_destroy(k4a_transformation_t transformation_handle)
+k4a_result_t transformation_set_gpu_output(k4a_transformation_t transformation_handle, bool enable)
 {
-    RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, k4a_transformation_t, transformation_handle);
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_transformation_t, transformation_handle);
     k4a_transformation_context_t *transformation_context = k4a_transformation_t_get_context(transformation_handle);
 
-    if (transformation_context->memory_depth_camera_xy_tables != 0)
+    if (enable && transformation_context->backend != K4A_TRANSFORMATION_BACKEND_OPENCL)
     {
-#ifdef _MSC_VER
-        _aligned_free(transformation_context->memory_depth_camera_xy_tables);
-#else
-        free(transformation_context->memory_depth_camera_xy_tables);
-#endif
+        LOG_ERROR("GPU outputs need the OpenCL transformation backend.", 0);
+        return K4A_RESULT_FAILED;
     }
-    if (transformation_context->memory_color_camera_xy_tables != 0)
+
+    transformation_context->gpu_output = enable;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t transformation_get_gpu_output(k4a_transformation_t transformation_handle,
+                                           k4a_transformation_gpu_output_t output,
+                                           void **gpu_buffer)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_transformation_t, transformation_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, gpu_buffer == NULL);
+    k4a_transformation_context_t *transformation_context = k4a_transformation_t_get_context(transformation_handle);
+
+    *gpu_buffer = NULL;
+    if (transformation_context->clwrapper == NULL)
     {
-#ifdef _MSC_VER
-        _aligned_free(transformation_context->memory_color_camera_xy_tables);
-#else
-        free(transformation_context->memory_color_camera_xy_tables);
-#endif
+        LOG_ERROR("GPU outputs need the OpenCL transformation backend.", 0);
+        return K4A_RESULT_FAILED;
     }
-    if (transformation_context->tewrapper)
+    return TRACE_CALL(clwrapper_get_output(transformation_context->clwrapper, output, gpu_buffer));
+}
+
+k4a_result_t transformation_set_gpu_context(k4a_transformation_t transformation_handle,
+                                            void *gpu_context,
+                                            void *gpu_device)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_transformation_t, transformation_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, (gpu_context == NULL) != (gpu_device == NULL));
+    k4a_transformation_context_t *transformation_context = k4a_transformation_t_get_context(transformation_handle);
+
+    if (transformation_context->clwrapper != NULL)
     {
-        tewrapper_destroy(transformation_context->tewrapper);
+        LOG_ERROR("The GPU context must be set before the OpenCL backend is first selected.", 0);
+        return K4A_RESULT_FAILED;
     }
-    k4a_transformation_t_destroy(transformation_handle);
+
+    transformation_context->gpu_context = gpu_context;
+    transformation_context->gpu_device = gpu_device;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t transformation_set_gpu_output_target(k4a_transformation_t transformation_handle,
+                                                  k4a_transformation_gpu_output_t output,
+                                                  k4a_transformation_gpu_target_t target_type,
+                                                  void *target)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_transformation_t, transformation_handle);
+    k4a_transformation_context_t *transformation_context = k4a_transformation_t_get_context(transformation_handle);
+
+    if (transformation_context->clwrapper == NULL)
+    {
+        LOG_ERROR("GPU outputs need the OpenCL transformation backend.", 0);
+        return K4A_RESULT_FAILED;
+    }
+    return TRACE_CALL(clwrapper_set_output_target(transformation_context->clwrapper, output, target_type, target));
+}
+
+// The closed source transform engine runs the transformations when the handle was created for the GPU, unless another
+// backend was selected
+static bool transformation_use_transform_engine(const k4a_transformation_context_t *transformation_context)
+{
+    return transformation_context->enable_gpu_optimization &&
+           transformation_context->backend == K4A_TRANSFORMATION_BACKEND_DEFAULT;
+}
+
+// Host buffer the OpenCL backend copies an output to, NULL while the outputs are kept in GPU memory
+static void *transformation_get_host_output(const k4a_transformation_context_t *transformation_context, uint8_t *data)
+{
+    return transformation_context->gpu_output ? NULL : data;
+}
+
+static int transformation_async_thread(void *param)
+{
+    k4a_transformation_context_t *transformation_context = (k4a_transformation_context_t *)param;
+
+    threadpolicy_apply(K4A_SDK_THREAD_TRANSFORMATION);
+    g_async_thread_context = transformation_context;
+
+    Lock(transformation_context->async_lock);
+    while (true)
+    {
+        transformation_async_job_t *job = transformation_context->async_head;
+        if (job == NULL)
+        {
+            if (transformation_context->async_stop)
+            {
+                break;
+            }
+
+            int infinite_timeout = 0;
+            (void)Condition_Wait(transformation_context->async_condition,
+                                 transformation_context->async_lock,
+                                 infinite_timeout);
+            continue;
+        }
+
+        transformation_context->async_head = job->next;
+        if (transformation_context->async_head == NULL)
+        {
+            transformation_context->async_tail = NULL;
+        }
+
+        Unlock(transformation_context->async_lock);
+        job->fn(job->context);
+        free(job);
+        Lock(transformation_context->async_lock);
+    }
+    k4a_transformation_t release_handle = transformation_context->async_release_handle;
+    THREAD_HANDLE async_thread = transformation_context->async_thread;
+    Unlock(transformation_context->async_lock);
+
+    g_async_thread_context = NULL;
+    if (release_handle != NULL)
+    {
+        // Destroyed from a callback, hand this thread over to be joined by the next transformation_create() or
+        // transformation_destroy()
+        transformation_release(release_handle);
+
+        transformation_async_exited_t *exited = (transformation_async_exited_t *)malloc(
+            sizeof(transformation_async_exited_t));
+        if (K4A_SUCCEEDED(K4A_RESULT_FROM_BOOL(exited != NULL)))
+        {
+            transformation_async_global_t *g_async = transformation_async_global_t_get();
+            exited->thread = async_thread;
+            Lock(g_async->lock);
+            exited->next = g_async->head;
+            g_async->head = exited;
+            Unlock(g_async->lock);
+        }
+    }
+
+    return 0;
+}
+
+k4a_result_t transformation_run_async(k4a_transformation_t transformation_handle,
+                                      transformation_async_fn_t *fn,
+                                      void *context)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_transformation_t, transformation_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, fn == NULL);
+    k4a_transformation_context_t *transformation_context = k4a_transformation_t_get_context(transformation_handle);
+
+    transformation_async_job_t *job = (transformation_async_job_t *)malloc(sizeof(transformation_async_job_t));
+    k4a_result_t result = K4A_RESULT_FROM_BOOL(job != NULL);
+    if (K4A_FAILED(result))
+    {
+        return result;
+    }
+
+    job->next = NULL;
+    job->fn = fn;
+    job->context = context;
+
+    Lock(transformation_context->async_lock);
+    result = K4A_RESULT_FROM_BOOL(!transformation_context->async_stop);
+
+    if (K4A_SUCCEEDED(result) && transformation_context->async_thread == NULL)
+    {
+        THREADAPI_RESULT tresult = ThreadAPI_Create(&transformation_context->async_thread,
+                                                    transformation_async_thread,
+                                                    transformation_context);
+        result = K4A_RESULT_FROM_BOOL(tresult == THREADAPI_OK);
+        if (K4A_FAILED(result))
+        {
+            transformation_context->async_thread = NULL;
+        }
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        if (transformation_context->async_tail == NULL)
+        {
+            transformation_context->async_head = job;
+        }
+        else
+        {
+            transformation_context->async_tail->next = job;
+        }
+        transformation_context->async_tail = job;
+        Condition_Post(transformation_context->async_condition);
+    }
+    Unlock(transformation_context->async_lock);
+
+    if (K4A_FAILED(result))
+    {
+        free(job);
+    }
+
+    return result;
 }
 
 k4a_result_t transformation_depth_image_to_color_camera_custom(
@@ -694,12 +2034,20 @@ k4a_result_t transformation_depth_image_to_color_camera_custom(
         return K4A_RESULT_FAILED;
     }
 
-    if (transformation_context->enable_gpu_optimization)
+    const k4a_transformation_xy_tables_t *depth_camera_xy_tables =
+        transformation_get_xy_tables(transformation_context, K4A_CALIBRATION_TYPE_DEPTH);
+    if (depth_camera_xy_tables == NULL)
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    bool use_opencl = transformation_context->backend == K4A_TRANSFORMATION_BACKEND_OPENCL;
+    if (use_opencl || transformation_use_transform_engine(transformation_context))
     {
         if (K4A_BUFFER_RESULT_SUCCEEDED !=
             TRACE_BUFFER_CALL(transformation_depth_image_to_color_camera_validate_parameters(
                 &transformation_context->calibration,
-                &transformation_context->depth_camera_xy_tables,
+                depth_camera_xy_tables,
                 depth_image_data,
                 depth_image_descriptor,
                 custom_image_data,
@@ -707,7 +2055,27 @@ k4a_result_t transformation_depth_image_to_color_camera_custom(
                 transformed_depth_image_data,
                 transformed_depth_image_descriptor,
                 transformed_custom_image_data,
-                transformed_custom_image_descriptor)))
+                transformed_custom_image_descriptor,
+                NULL)))
+        {
+            return K4A_RESULT_FAILED;
+        }
+
+        if (use_opencl)
+        {
+            return TRACE_CALL(clwrapper_depth_to_color(
+                transformation_context->clwrapper,
+                (const uint16_t *)(const void *)depth_image_data,
+                custom_image_data,
+                custom_image_descriptor->format,
+                interpolation_type,
+                invalid_custom_value,
+                (uint16_t *)transformation_get_host_output(transformation_context, transformed_depth_image_data),
+                (uint8_t *)transformation_get_host_output(transformation_context, transformed_custom_image_data)));
+        }
+
+        tewrapper_t tewrapper = transformation_get_tewrapper(transformation_context);
+        if (tewrapper == NULL)
         {
             return K4A_RESULT_FAILED;
         }
@@ -738,50 +2106,195 @@ k4a_result_t transformation_depth_image_to_color_camera_custom(
             interpolation = K4A_TRANSFORM_ENGINE_INTERPOLATION_NEAREST;
             break;
 
-        case K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR:
-            interpolation = K4A_TRANSFORM_ENGINE_INTERPOLATION_LINEAR;
-            break;
+        case K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR:
+            interpolation = K4A_TRANSFORM_ENGINE_INTERPOLATION_LINEAR;
+            break;
+
+        default:
+            interpolation = K4A_TRANSFORM_ENGINE_INTERPOLATION_LINEAR;
+            break;
+        }
+
+        if (K4A_FAILED(TRACE_CALL(tewrapper_process_frame(tewrapper,
+                                                          transform_type,
+                                                          depth_image_data,
+                                                          depth_image_size,
+                                                          custom_image_data,
+                                                          custom_image_size,
+                                                          transformed_depth_image_data,
+                                                          transformed_depth_image_size,
+                                                          transformed_custom_image_data,
+                                                          transformed_custom_image_size,
+                                                          interpolation,
+                                                          invalid_custom_value))))
+        {
+            return K4A_RESULT_FAILED;
+        }
+    }
+    else
+    {
+        const k4a_transformation_ray_tables_t *ray_tables = transformation_get_ray_tables(transformation_context);
+        if (K4A_BUFFER_RESULT_SUCCEEDED !=
+            TRACE_BUFFER_CALL(
+                transformation_depth_image_to_color_camera_internal(&transformation_context->calibration,
+                                                                    depth_camera_xy_tables,
+                                                                    ray_tables,
+                                                                    depth_image_data,
+                                                                    depth_image_descriptor,
+                                                                    &custom_image_data,
+                                                                    custom_image_descriptor,
+                                                                    transformed_depth_image_data,
+                                                                    transformed_depth_image_descriptor,
+                                                                    &transformed_custom_image_data,
+                                                                    transformed_custom_image_descriptor,
+                                                                    custom_image_data != NULL ? 1 : 0,
+                                                                    interpolation_type,
+                                                                    invalid_custom_value,
+                                                                    transformation_context->depth_to_color_mode,
+                                                                    transformation_context->cpu_thread_count,
+                                                                    NULL)))
+        {
+            return K4A_RESULT_FAILED;
+        }
+    }
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t transformation_depth_image_to_color_camera_custom_planes(
+    k4a_transformation_t transformation_handle,
+    const uint8_t *depth_image_data,
+    const k4a_transformation_image_descriptor_t *depth_image_descriptor,
+    const uint8_t *const *custom_images_data,
+    const k4a_transformation_image_descriptor_t *custom_image_descriptor,
+    uint32_t custom_image_count,
+    uint8_t *transformed_depth_image_data,
+    k4a_transformation_image_descriptor_t *transformed_depth_image_descriptor,
+    uint8_t *const *transformed_custom_images_data,
+    k4a_transformation_image_descriptor_t *transformed_custom_image_descriptor,
+    k4a_transformation_interpolation_type_t interpolation_type,
+    uint32_t invalid_custom_value)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_transformation_t, transformation_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED,
+                        custom_image_count == 0 || custom_image_count > K4A_TRANSFORMATION_MAX_CUSTOM_PLANES);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, custom_images_data == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, transformed_custom_images_data == NULL);
+    k4a_transformation_context_t *transformation_context = k4a_transformation_t_get_context(transformation_handle);
+
+    if (!transformation_context->enable_depth_color_transform)
+    {
+        LOG_ERROR("Expect both depth camera and color camera are running to transform depth image to color camera.", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    const k4a_transformation_xy_tables_t *depth_camera_xy_tables =
+        transformation_get_xy_tables(transformation_context, K4A_CALIBRATION_TYPE_DEPTH);
+    if (depth_camera_xy_tables == NULL)
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    bool use_opencl = transformation_context->backend == K4A_TRANSFORMATION_BACKEND_OPENCL;
+    if (use_opencl || transformation_use_transform_engine(transformation_context))
+    {
+        // The transform engine and the OpenCL kernel carry a single custom image, each pass also rewrites the same
+        // transformed depth image
+        for (uint32_t plane = 0; plane < custom_image_count; plane++)
+        {
+            if (K4A_FAILED(TRACE_CALL(
+                    transformation_depth_image_to_color_camera_custom(transformation_handle,
+                                                                      depth_image_data,
+                                                                      depth_image_descriptor,
+                                                                      custom_images_data[plane],
+                                                                      custom_image_descriptor,
+                                                                      transformed_depth_image_data,
+                                                                      transformed_depth_image_descriptor,
+                                                                      transformed_custom_images_data[plane],
+                                                                      transformed_custom_image_descriptor,
+                                                                      interpolation_type,
+                                                                      invalid_custom_value))))
+            {
+                return K4A_RESULT_FAILED;
+            }
+        }
+        return K4A_RESULT_SUCCEEDED;
+    }
+
+    const k4a_transformation_ray_tables_t *ray_tables = transformation_get_ray_tables(transformation_context);
+    if (K4A_BUFFER_RESULT_SUCCEEDED !=
+        TRACE_BUFFER_CALL(
+            transformation_depth_image_to_color_camera_internal(&transformation_context->calibration,
+                                                                depth_camera_xy_tables,
+                                                                ray_tables,
+                                                                depth_image_data,
+                                                                depth_image_descriptor,
+                                                                custom_images_data,
+                                                                custom_image_descriptor,
+                                                                transformed_depth_image_data,
+                                                                transformed_depth_image_descriptor,
+                                                                transformed_custom_images_data,
+                                                                transformed_custom_image_descriptor,
+                                                                custom_image_count,
+                                                                interpolation_type,
+                                                                invalid_custom_value,
+                                                                transformation_context->depth_to_color_mode,
+                                                                transformation_context->cpu_thread_count,
+                                                                NULL)))
+    {
+        return K4A_RESULT_FAILED;
+    }
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t transformation_depth_image_to_color_camera_roi(
+    k4a_transformation_t transformation_handle,
+    const uint8_t *depth_image_data,
+    const k4a_transformation_image_descriptor_t *depth_image_descriptor,
+    const k4a_rect_t *roi,
+    uint8_t *transformed_depth_image_data,
+    k4a_transformation_image_descriptor_t *transformed_depth_image_descriptor)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_transformation_t, transformation_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, roi == NULL);
+    k4a_transformation_context_t *transformation_context = k4a_transformation_t_get_context(transformation_handle);
 
-        default:
-            interpolation = K4A_TRANSFORM_ENGINE_INTERPOLATION_LINEAR;
-            break;
-        }
+    if (!transformation_context->enable_depth_color_transform)
+    {
+        LOG_ERROR("Expect both depth camera and color camera are running to transform depth image to color camera.", 0);
+        return K4A_RESULT_FAILED;
+    }
 
-        if (K4A_FAILED(TRACE_CALL(tewrapper_process_frame(transformation_context->tewrapper,
-                                                          transform_type,
-                                                          depth_image_data,
-                                                          depth_image_size,
-                                                          custom_image_data,
-                                                          custom_image_size,
-                                                          transformed_depth_image_data,
-                                                          transformed_depth_image_size,
-                                                          transformed_custom_image_data,
-                                                          transformed_custom_image_size,
-                                                          interpolation,
-                                                          invalid_custom_value))))
-        {
-            return K4A_RESULT_FAILED;
-        }
+    const k4a_transformation_xy_tables_t *depth_camera_xy_tables =
+        transformation_get_xy_tables(transformation_context, K4A_CALIBRATION_TYPE_DEPTH);
+    if (depth_camera_xy_tables == NULL)
+    {
+        return K4A_RESULT_FAILED;
     }
-    else
+
+    // The transform engine only works on whole images
+    k4a_transformation_image_descriptor_t dummy_descriptor = { 0 };
+    const k4a_transformation_ray_tables_t *ray_tables = transformation_get_ray_tables(transformation_context);
+    if (K4A_BUFFER_RESULT_SUCCEEDED !=
+        TRACE_BUFFER_CALL(
+            transformation_depth_image_to_color_camera_internal(&transformation_context->calibration,
+                                                                depth_camera_xy_tables,
+                                                                ray_tables,
+                                                                depth_image_data,
+                                                                depth_image_descriptor,
+                                                                NULL,
+                                                                &dummy_descriptor,
+                                                                transformed_depth_image_data,
+                                                                transformed_depth_image_descriptor,
+                                                                NULL,
+                                                                &dummy_descriptor,
+                                                                0,
+                                                                K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR,
+                                                                0,
+                                                                transformation_context->depth_to_color_mode,
+                                                                transformation_context->cpu_thread_count,
+                                                                roi)))
     {
-        if (K4A_BUFFER_RESULT_SUCCEEDED !=
-            TRACE_BUFFER_CALL(
-                transformation_depth_image_to_color_camera_internal(&transformation_context->calibration,
-                                                                    &transformation_context->depth_camera_xy_tables,
-                                                                    depth_image_data,
-                                                                    depth_image_descriptor,
-                                                                    custom_image_data,
-                                                                    custom_image_descriptor,
-                                                                    transformed_depth_image_data,
-                                                                    transformed_depth_image_descriptor,
-                                                                    transformed_custom_image_data,
-                                                                    transformed_custom_image_descriptor,
-                                                                    interpolation_type,
-                                                                    invalid_custom_value)))
-        {
-            return K4A_RESULT_FAILED;
-        }
+        return K4A_RESULT_FAILED;
     }
     return K4A_RESULT_SUCCEEDED;
 }
@@ -804,18 +2317,42 @@ transformation_color_image_to_depth_camera(k4a_transformation_t transformation_h
         return K4A_RESULT_FAILED;
     }
 
-    if (transformation_context->enable_gpu_optimization)
+    const k4a_transformation_xy_tables_t *depth_camera_xy_tables =
+        transformation_get_xy_tables(transformation_context, K4A_CALIBRATION_TYPE_DEPTH);
+    if (depth_camera_xy_tables == NULL)
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    bool use_opencl = transformation_context->backend == K4A_TRANSFORMATION_BACKEND_OPENCL;
+    if (use_opencl || transformation_use_transform_engine(transformation_context))
     {
         if (K4A_BUFFER_RESULT_SUCCEEDED !=
             TRACE_BUFFER_CALL(transformation_color_image_to_depth_camera_validate_parameters(
                 &transformation_context->calibration,
-                &transformation_context->depth_camera_xy_tables,
+                depth_camera_xy_tables,
                 depth_image_data,
                 depth_image_descriptor,
                 color_image_data,
                 color_image_descriptor,
                 transformed_color_image_data,
-                transformed_color_image_descriptor)))
+                transformed_color_image_descriptor,
+                NULL)))
+        {
+            return K4A_RESULT_FAILED;
+        }
+
+        if (use_opencl)
+        {
+            return TRACE_CALL(clwrapper_color_to_depth(
+                transformation_context->clwrapper,
+                (const uint16_t *)(const void *)depth_image_data,
+                color_image_data,
+                (uint8_t *)transformation_get_host_output(transformation_context, transformed_color_image_data)));
+        }
+
+        tewrapper_t tewrapper = transformation_get_tewrapper(transformation_context);
+        if (tewrapper == NULL)
         {
             return K4A_RESULT_FAILED;
         }
@@ -827,7 +2364,7 @@ transformation_color_image_to_depth_camera(k4a_transformation_t transformation_h
         size_t transformed_color_image_size = (size_t)(transformed_color_image_descriptor->stride_bytes *
                                                        transformed_color_image_descriptor->height_pixels);
 
-        if (K4A_FAILED(TRACE_CALL(tewrapper_process_frame(transformation_context->tewrapper,
+        if (K4A_FAILED(TRACE_CALL(tewrapper_process_frame(tewrapper,
                                                           K4A_TRANSFORM_ENGINE_TYPE_COLOR_TO_DEPTH,
                                                           depth_image_data,
                                                           depth_image_size,
@@ -845,16 +2382,20 @@ transformation_color_image_to_depth_camera(k4a_transformation_t transformation_h
     }
     else
     {
+        const k4a_transformation_ray_tables_t *ray_tables = transformation_get_ray_tables(transformation_context);
         if (K4A_BUFFER_RESULT_SUCCEEDED !=
             TRACE_BUFFER_CALL(
                 transformation_color_image_to_depth_camera_internal(&transformation_context->calibration,
-                                                                    &transformation_context->depth_camera_xy_tables,
+                                                                    depth_camera_xy_tables,
+                                                                    ray_tables,
                                                                     depth_image_data,
                                                                     depth_image_descriptor,
                                                                     color_image_data,
                                                                     color_image_descriptor,
                                                                     transformed_color_image_data,
-                                                                    transformed_color_image_descriptor)))
+                                                                    transformed_color_image_descriptor,
+                                                                    transformation_context->fixed_point_bilinear,
+                                                                    NULL)))
         {
             return K4A_RESULT_FAILED;
         }
@@ -862,6 +2403,111 @@ transformation_color_image_to_depth_camera(k4a_transformation_t transformation_h
     return K4A_RESULT_SUCCEEDED;
 }
 
+k4a_result_t transformation_color_image_to_depth_camera_roi(
+    k4a_transformation_t transformation_handle,
+    const uint8_t *depth_image_data,
+    const k4a_transformation_image_descriptor_t *depth_image_descriptor,
+    const uint8_t *color_image_data,
+    const k4a_transformation_image_descriptor_t *color_image_descriptor,
+    const k4a_rect_t *roi,
+    uint8_t *transformed_color_image_data,
+    k4a_transformation_image_descriptor_t *transformed_color_image_descriptor)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_transformation_t, transformation_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, roi == NULL);
+    k4a_transformation_context_t *transformation_context = k4a_transformation_t_get_context(transformation_handle);
+
+    if (!transformation_context->enable_depth_color_transform)
+    {
+        LOG_ERROR("Expect both depth camera and color camera are running to transform color image to depth camera.", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    const k4a_transformation_xy_tables_t *depth_camera_xy_tables =
+        transformation_get_xy_tables(transformation_context, K4A_CALIBRATION_TYPE_DEPTH);
+    if (depth_camera_xy_tables == NULL)
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    // The transform engine only works on whole images
+    const k4a_transformation_ray_tables_t *ray_tables = transformation_get_ray_tables(transformation_context);
+    if (K4A_BUFFER_RESULT_SUCCEEDED !=
+        TRACE_BUFFER_CALL(
+            transformation_color_image_to_depth_camera_internal(&transformation_context->calibration,
+                                                                depth_camera_xy_tables,
+                                                                ray_tables,
+                                                                depth_image_data,
+                                                                depth_image_descriptor,
+                                                                color_image_data,
+                                                                color_image_descriptor,
+                                                                transformed_color_image_data,
+                                                                transformed_color_image_descriptor,
+                                                                transformation_context->fixed_point_bilinear,
+                                                                roi)))
+    {
+        return K4A_RESULT_FAILED;
+    }
+    return K4A_RESULT_SUCCEEDED;
+}
+
+// Returns the xy tables of the camera a point cloud is computed in, or NULL for an unexpected camera or if they could
+// not be built
+static const k4a_transformation_xy_tables_t *
+transformation_get_point_cloud_xy_tables(k4a_transformation_context_t *transformation_context,
+                                         const k4a_calibration_type_t camera)
+{
+    if (camera == K4A_CALIBRATION_TYPE_DEPTH || camera == K4A_CALIBRATION_TYPE_COLOR)
+    {
+        return transformation_get_xy_tables(transformation_context, camera);
+    }
+
+    LOG_ERROR("Unexpected camera calibration type %d, should either be K4A_CALIBRATION_TYPE_DEPTH (%d) or "
+              "K4A_CALIBRATION_TYPE_COLOR (%d).",
+              camera,
+              K4A_CALIBRATION_TYPE_DEPTH,
+              K4A_CALIBRATION_TYPE_COLOR);
+    return NULL;
+}
+
+// Checks the images of a whole image INT16 point cloud as transformation_depth_image_to_point_cloud_internal() does
+static k4a_result_t
+transformation_point_cloud_validate_parameters(const k4a_transformation_xy_tables_t *xy_tables,
+                                               const uint8_t *depth_image_data,
+                                               const k4a_transformation_image_descriptor_t *depth_image_descriptor,
+                                               const uint8_t *xyz_image_data,
+                                               const k4a_transformation_image_descriptor_t *xyz_image_descriptor)
+{
+    if (depth_image_data == NULL || depth_image_descriptor == NULL || xyz_image_data == NULL ||
+        xyz_image_descriptor == NULL)
+    {
+        LOG_ERROR("Point cloud images must not be null.", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    if (depth_image_descriptor->width_pixels != xy_tables->width ||
+        depth_image_descriptor->height_pixels != xy_tables->height ||
+        depth_image_descriptor->stride_bytes != xy_tables->width * (int)sizeof(uint16_t) ||
+        depth_image_descriptor->format != K4A_IMAGE_FORMAT_DEPTH16)
+    {
+        LOG_ERROR("Unexpected depth image descriptor, expected a %dx%d K4A_IMAGE_FORMAT_DEPTH16 image.",
+                  xy_tables->width,
+                  xy_tables->height);
+        return K4A_RESULT_FAILED;
+    }
+
+    if (xyz_image_descriptor->width_pixels != xy_tables->width ||
+        xyz_image_descriptor->height_pixels != xy_tables->height ||
+        xyz_image_descriptor->stride_bytes != xy_tables->width * 3 * (int)sizeof(int16_t))
+    {
+        LOG_ERROR("Unexpected XYZ image descriptor, expected a %dx%d image of 3 int16_t per pixel.",
+                  xy_tables->width,
+                  xy_tables->height);
+        return K4A_RESULT_FAILED;
+    }
+    return K4A_RESULT_SUCCEEDED;
+}
+
 k4a_result_t
 transformation_depth_image_to_point_cloud(k4a_transformation_t transformation_handle,
                                           const uint8_t *depth_image_data,
@@ -869,34 +2515,380 @@ transformation_depth_image_to_point_cloud(k4a_transformation_t transformation_ha
                                           const k4a_calibration_type_t camera,
                                           uint8_t *xyz_image_data,
                                           k4a_transformation_image_descriptor_t *xyz_image_descriptor)
+{
+    return transformation_depth_image_to_formatted_point_cloud(transformation_handle,
+                                                               depth_image_data,
+                                                               depth_image_descriptor,
+                                                               camera,
+                                                               K4A_POINT_CLOUD_FORMAT_INT16_XYZ,
+                                                               NULL,
+                                                               xyz_image_data,
+                                                               xyz_image_descriptor);
+}
+
+k4a_result_t
+transformation_depth_image_to_formatted_point_cloud(k4a_transformation_t transformation_handle,
+                                                    const uint8_t *depth_image_data,
+                                                    const k4a_transformation_image_descriptor_t *depth_image_descriptor,
+                                                    const k4a_calibration_type_t camera,
+                                                    k4a_point_cloud_format_t format,
+                                                    const k4a_rect_t *roi,
+                                                    uint8_t *xyz_image_data,
+                                                    k4a_transformation_image_descriptor_t *xyz_image_descriptor)
 {
     RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_transformation_t, transformation_handle);
     k4a_transformation_context_t *transformation_context = k4a_transformation_t_get_context(transformation_handle);
 
-    k4a_transformation_xy_tables_t *xy_tables;
-    if (camera == K4A_CALIBRATION_TYPE_DEPTH)
+    const k4a_transformation_xy_tables_t *xy_tables = transformation_get_point_cloud_xy_tables(transformation_context,
+                                                                                               camera);
+    if (xy_tables == NULL)
     {
-        xy_tables = &transformation_context->depth_camera_xy_tables;
+        return K4A_RESULT_FAILED;
     }
-    else if (camera == K4A_CALIBRATION_TYPE_COLOR)
+
+    // The OpenCL backend computes whole images in the default format, anything else runs on the CPU
+    if (transformation_context->backend == K4A_TRANSFORMATION_BACKEND_OPENCL &&
+        format == K4A_POINT_CLOUD_FORMAT_INT16_XYZ && roi == NULL)
     {
-        xy_tables = &transformation_context->color_camera_xy_tables;
+        if (K4A_FAILED(TRACE_CALL(transformation_point_cloud_validate_parameters(
+                xy_tables, depth_image_data, depth_image_descriptor, xyz_image_data, xyz_image_descriptor))))
+        {
+            return K4A_RESULT_FAILED;
+        }
+
+        return TRACE_CALL(clwrapper_depth_to_point_cloud(
+            transformation_context->clwrapper,
+            camera,
+            (const uint16_t *)(const void *)depth_image_data,
+            (int16_t *)transformation_get_host_output(transformation_context, xyz_image_data)));
     }
-    else
+
+    if (K4A_BUFFER_RESULT_SUCCEEDED !=
+        TRACE_BUFFER_CALL(transformation_depth_image_to_point_cloud_internal(
+            xy_tables, depth_image_data, depth_image_descriptor, format, roi, xyz_image_data, xyz_image_descriptor)))
     {
-        LOG_ERROR("Unexpected camera calibration type %d, should either be K4A_CALIBRATION_TYPE_DEPTH (%d) or "
+        return K4A_RESULT_FAILED;
+    }
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t
+transformation_depth_image_to_valid_point_cloud(k4a_transformation_t transformation_handle,
+                                                const uint8_t *depth_image_data,
+                                                const k4a_transformation_image_descriptor_t *depth_image_descriptor,
+                                                const k4a_calibration_type_t camera,
+                                                uint8_t *xyz_image_data,
+                                                k4a_transformation_image_descriptor_t *xyz_image_descriptor,
+                                                uint32_t *pixel_indices,
+                                                size_t *point_count)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_transformation_t, transformation_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, point_count == NULL);
+    k4a_transformation_context_t *transformation_context = k4a_transformation_t_get_context(transformation_handle);
+
+    *point_count = 0;
+
+    const k4a_transformation_xy_tables_t *xy_tables = transformation_get_point_cloud_xy_tables(transformation_context,
+                                                                                               camera);
+    if (xy_tables == NULL)
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    if (K4A_BUFFER_RESULT_SUCCEEDED !=
+        TRACE_BUFFER_CALL(transformation_depth_image_to_valid_point_cloud_internal(xy_tables,
+                                                                                   depth_image_data,
+                                                                                   depth_image_descriptor,
+                                                                                   xyz_image_data,
+                                                                                   xyz_image_descriptor,
+                                                                                   pixel_indices,
+                                                                                   point_count)))
+    {
+        return K4A_RESULT_FAILED;
+    }
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t transformation_depth_image_to_colored_point_cloud(
+    k4a_transformation_t transformation_handle,
+    const uint8_t *depth_image_data,
+    const k4a_transformation_image_descriptor_t *depth_image_descriptor,
+    const uint8_t *color_image_data,
+    const k4a_transformation_image_descriptor_t *color_image_descriptor,
+    bool valid_points_only,
+    uint8_t *xyz_image_data,
+    k4a_transformation_image_descriptor_t *xyz_image_descriptor,
+    uint8_t *bgra_image_data,
+    k4a_transformation_image_descriptor_t *bgra_image_descriptor,
+    size_t *point_count)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_transformation_t, transformation_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, point_count == NULL);
+    k4a_transformation_context_t *transformation_context = k4a_transformation_t_get_context(transformation_handle);
+
+    *point_count = 0;
+
+    if (!transformation_context->enable_depth_color_transform)
+    {
+        LOG_ERROR("Expect both depth camera and color camera are running to transform depth image to color camera.", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    const k4a_transformation_xy_tables_t *color_camera_xy_tables =
+        transformation_get_xy_tables(transformation_context, K4A_CALIBRATION_TYPE_COLOR);
+    if (color_camera_xy_tables == NULL)
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    // The depth to color transformation needs the full transformed depth image as its z-buffer before any point is
+    // final, so it is kept internal rather than being a second image the caller walks
+    int width = transformation_context->calibration.color_camera_calibration.resolution_width;
+    int height = transformation_context->calibration.color_camera_calibration.resolution_height;
+    k4a_transformation_image_descriptor_t transformed_depth_image_descriptor = {
+        width, height, width * (int)sizeof(uint16_t), K4A_IMAGE_FORMAT_DEPTH16
+    };
+    uint8_t *transformed_depth_image_data = (uint8_t *)malloc((size_t)width * (size_t)height * sizeof(uint16_t));
+    if (transformed_depth_image_data == NULL)
+    {
+        LOG_ERROR("Failed to allocate the transformed depth image.", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    // Ignored without a custom image
+    k4a_transformation_image_descriptor_t dummy_descriptor = { 0 };
+    k4a_result_t result = TRACE_CALL(
+        transformation_depth_image_to_color_camera_custom(transformation_handle,
+                                                          depth_image_data,
+                                                          depth_image_descriptor,
+                                                          NULL,
+                                                          &dummy_descriptor,
+                                                          transformed_depth_image_data,
+                                                          &transformed_depth_image_descriptor,
+                                                          NULL,
+                                                          &dummy_descriptor,
+                                                          K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR,
+                                                          0));
+
+    if (K4A_SUCCEEDED(result) &&
+        K4A_BUFFER_RESULT_SUCCEEDED !=
+            TRACE_BUFFER_CALL(transformation_depth_image_to_colored_point_cloud_internal(
+                color_camera_xy_tables,
+                transformed_depth_image_data,
+                &transformed_depth_image_descriptor,
+                color_image_data,
+                color_image_descriptor,
+                valid_points_only,
+                xyz_image_data,
+                xyz_image_descriptor,
+                bgra_image_data,
+                bgra_image_descriptor,
+                point_count)))
+    {
+        result = K4A_RESULT_FAILED;
+    }
+
+    free(transformed_depth_image_data);
+    return result;
+}
+
+k4a_result_t transformation_fuse_point_clouds(k4a_transformation_fusion_source_t *sources,
+                                              uint32_t source_count,
+                                              k4a_point_cloud_format_t format,
+                                              bool valid_points_only,
+                                              uint8_t *xyz_image_data,
+                                              k4a_transformation_image_descriptor_t *xyz_image_descriptor,
+                                              uint8_t *bgra_image_data,
+                                              k4a_transformation_image_descriptor_t *bgra_image_descriptor,
+                                              size_t *point_count)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, sources == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, source_count == 0);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, point_count == NULL);
+
+    *point_count = 0;
+
+    // Always on the CPU, every source is split into the bands its own handle would use for depth to color
+    for (uint32_t i = 0; i < source_count; i++)
+    {
+        RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_transformation_t, sources[i].transformation_handle);
+        k4a_transformation_context_t *transformation_context = k4a_transformation_t_get_context(
+            sources[i].transformation_handle);
+
+        sources[i].xy_tables = transformation_get_xy_tables(transformation_context, K4A_CALIBRATION_TYPE_DEPTH);
+        if (sources[i].xy_tables == NULL)
+        {
+            return K4A_RESULT_FAILED;
+        }
+        sources[i].band_count = transformation_context->cpu_thread_count;
+    }
+
+    if (K4A_BUFFER_RESULT_SUCCEEDED !=
+        TRACE_BUFFER_CALL(transformation_fuse_point_clouds_internal(sources,
+                                                                    source_count,
+                                                                    format,
+                                                                    valid_points_only,
+                                                                    xyz_image_data,
+                                                                    xyz_image_descriptor,
+                                                                    bgra_image_data,
+                                                                    bgra_image_descriptor,
+                                                                    point_count)))
+    {
+        return K4A_RESULT_FAILED;
+    }
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t transformation_point_cloud_to_normals(const uint8_t *xyz_image_data,
+                                                   const k4a_transformation_image_descriptor_t *xyz_image_descriptor,
+                                                   uint8_t *normal_image_data,
+                                                   k4a_transformation_image_descriptor_t *normal_image_descriptor)
+{
+    if (K4A_BUFFER_RESULT_SUCCEEDED !=
+        TRACE_BUFFER_CALL(transformation_point_cloud_to_normals_internal(
+            xyz_image_data, xyz_image_descriptor, normal_image_data, normal_image_descriptor)))
+    {
+        return K4A_RESULT_FAILED;
+    }
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t transformation_point_cloud_voxel_downsample(
+    const uint8_t *xyz_image_data,
+    const k4a_transformation_image_descriptor_t *xyz_image_descriptor,
+    const uint8_t *normal_image_data,
+    const k4a_transformation_image_descriptor_t *normal_image_descriptor,
+    float voxel_size,
+    uint8_t *downsampled_xyz_image_data,
+    k4a_transformation_image_descriptor_t *downsampled_xyz_image_descriptor,
+    uint8_t *downsampled_normal_image_data,
+    k4a_transformation_image_descriptor_t *downsampled_normal_image_descriptor,
+    size_t *point_count)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, point_count == NULL);
+
+    *point_count = 0;
+    if (K4A_BUFFER_RESULT_SUCCEEDED !=
+        TRACE_BUFFER_CALL(transformation_point_cloud_voxel_downsample_internal(xyz_image_data,
+                                                                               xyz_image_descriptor,
+                                                                               normal_image_data,
+                                                                               normal_image_descriptor,
+                                                                               voxel_size,
+                                                                               downsampled_xyz_image_data,
+                                                                               downsampled_xyz_image_descriptor,
+                                                                               downsampled_normal_image_data,
+                                                                               downsampled_normal_image_descriptor,
+                                                                               point_count)))
+    {
+        return K4A_RESULT_FAILED;
+    }
+    return K4A_RESULT_SUCCEEDED;
+}
+
+typedef struct _k4a_undistort_map_context_t
+{
+    k4a_transformation_pinhole_t pinhole;
+    k4a_transformation_undistort_lut_t *lut;
+} k4a_undistort_map_context_t;
+
+K4A_DECLARE_CONTEXT(k4a_undistort_map_t, k4a_undistort_map_context_t);
+
+k4a_result_t transformation_undistort_map_create(k4a_transformation_t transformation_handle,
+                                                 k4a_calibration_type_t camera,
+                                                 const k4a_transformation_pinhole_t *pinhole,
+                                                 k4a_transformation_interpolation_type_t interpolation_type,
+                                                 k4a_undistort_map_t *undistort_map_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_transformation_t, transformation_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, undistort_map_handle == NULL);
+    k4a_transformation_context_t *transformation_context = k4a_transformation_t_get_context(transformation_handle);
+
+    *undistort_map_handle = NULL;
+    if (camera != K4A_CALIBRATION_TYPE_DEPTH && camera != K4A_CALIBRATION_TYPE_COLOR)
+    {
+        LOG_ERROR("Unexpected camera calibration type %d, should be K4A_CALIBRATION_TYPE_DEPTH (%d) or "
                   "K4A_CALIBRATION_TYPE_COLOR (%d).",
                   camera,
                   K4A_CALIBRATION_TYPE_DEPTH,
                   K4A_CALIBRATION_TYPE_COLOR);
         return K4A_RESULT_FAILED;
     }
+    if (K4A_FAILED(TRACE_CALL(transformation_possible(&transformation_context->calibration, camera))))
+    {
+        return K4A_RESULT_FAILED;
+    }
 
-    if (K4A_BUFFER_RESULT_SUCCEEDED !=
-        TRACE_BUFFER_CALL(transformation_depth_image_to_point_cloud_internal(
-            xy_tables, depth_image_data, depth_image_descriptor, xyz_image_data, xyz_image_descriptor)))
+    const k4a_calibration_t *calibration = &transformation_context->calibration;
+    const k4a_calibration_camera_t *camera_calibration = camera == K4A_CALIBRATION_TYPE_DEPTH ?
+                                                             &calibration->depth_camera_calibration :
+                                                             &calibration->color_camera_calibration;
+
+    k4a_undistort_map_context_t *undistort_map_context = k4a_undistort_map_t_create(undistort_map_handle);
+    if (undistort_map_context == NULL)
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    if (pinhole != NULL)
+    {
+        undistort_map_context->pinhole = *pinhole;
+    }
+    else
+    {
+        // Same intrinsics without the distortion, like cv::undistort() without new camera intrinsics
+        const k4a_calibration_intrinsic_parameters_t *params = &camera_calibration->intrinsics.parameters;
+        undistort_map_context->pinhole.px = params->param.cx;
+        undistort_map_context->pinhole.py = params->param.cy;
+        undistort_map_context->pinhole.fx = params->param.fx;
+        undistort_map_context->pinhole.fy = params->param.fy;
+        undistort_map_context->pinhole.width = camera_calibration->resolution_width;
+        undistort_map_context->pinhole.height = camera_calibration->resolution_height;
+    }
+
+    undistort_map_context->lut = transformation_undistort_lut_create(camera_calibration,
+                                                                     &undistort_map_context->pinhole,
+                                                                     interpolation_type);
+    if (undistort_map_context->lut == NULL)
     {
+        k4a_undistort_map_t_destroy(*undistort_map_handle);
+        *undistort_map_handle = NULL;
         return K4A_RESULT_FAILED;
     }
     return K4A_RESULT_SUCCEEDED;
 }
+
+void transformation_undistort_map_destroy(k4a_undistort_map_t undistort_map_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, k4a_undistort_map_t, undistort_map_handle);
+    k4a_undistort_map_context_t *undistort_map_context = k4a_undistort_map_t_get_context(undistort_map_handle);
+
+    transformation_undistort_lut_destroy(undistort_map_context->lut);
+    k4a_undistort_map_t_destroy(undistort_map_handle);
+}
+
+k4a_result_t transformation_undistort_map_get_pinhole(k4a_undistort_map_t undistort_map_handle,
+                                                      k4a_transformation_pinhole_t *pinhole)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_undistort_map_t, undistort_map_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, pinhole == NULL);
+    k4a_undistort_map_context_t *undistort_map_context = k4a_undistort_map_t_get_context(undistort_map_handle);
+
+    *pinhole = undistort_map_context->pinhole;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t transformation_undistort(k4a_undistort_map_t undistort_map_handle,
+                                      const uint8_t *image_data,
+                                      const k4a_transformation_image_descriptor_t *image_descriptor,
+                                      uint8_t *undistorted_image_data,
+                                      k4a_transformation_image_descriptor_t *undistorted_image_descriptor)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_undistort_map_t, undistort_map_handle);
+    k4a_undistort_map_context_t *undistort_map_context = k4a_undistort_map_t_get_context(undistort_map_handle);
+
+    return TRACE_CALL(transformation_undistort_internal(undistort_map_context->lut,
+                                                        image_data,
+                                                        image_descriptor,
+                                                        undistorted_image_data,
+                                                        undistorted_image_descriptor));
+}
@@ -16,6 +16,7 @@
 
 // Dependent libraries
 #include <k4ainternal/allocator.h>
+#include <azure_c_shared_utility/condition.h>
 #include <azure_c_shared_utility/lock.h>
 #include <azure_c_shared_utility/threadapi.h>
 
@@ -33,13 +34,20 @@ extern "C" {
 
 //**************Symbolic Constant Macros (defines)  *************
 #define USB_CMD_MAX_WAIT_TIME 2000
-#define USB_CMD_MAX_XFR_COUNT 8 // Upper limit to the number of outstanding transfer
+#define USB_CMD_MAX_XFR_COUNT 32    // Upper limit to the number of outstanding transfer
+#define USB_CMD_DEFAULT_XFR_COUNT 8 // Number of outstanding transfers used unless configured
 #ifdef _WIN32
 #define USB_CMD_MAX_XFR_POOL 80000000 // Memory pool size for outstanding transfers (based on empirical testing)
 #else
 #define USB_CMD_MAX_XFR_POOL 10000000 // Memory pool size for outstanding transfers (based on empirical testing)
 #endif
+#define USB_CMD_POOL_EXTRA_BUFFERS 4 // Buffers kept beyond the transfer count to cover images held downstream
 #define USB_CMD_PORT_DEPTH 8
+#define USB_CMD_MAX_SHARED_CONTEXTS 16 // Upper limit to the number of libusb contexts shared between devices
+#define USB_CMD_SHARED_CANCEL_WAIT_TIME (2 * USB_CMD_MAX_WAIT_TIME) // Wait for transfers cancelled on a shared context
+#define USB_CMD_SHARED_CANCEL_RETRY_TIME 10 // Cancel again after waiting this long, a racing callback may resubmit
+#define USB_CMD_SERIAL_CACHE_SIZE 16  // Serial numbers kept for usb_cmd_get_installed_devices()
+#define USB_CMD_MAX_PORT_NUMBERS 7    // Longest port path allowed by the USB 3.0 specification
 
 #define USB_CMD_EVENT_WAIT_TIME 1
 #define USB_MAX_TX_DATA 128
@@ -77,6 +85,7 @@ typedef struct _usbcmd_context_t
     libusb_device_handle *libusb;
     libusb_context *libusb_context;
     enum libusb_log_level libusb_verbosity;
+    bool shared_context; // libusb_context is serviced by a shared event thread
 
     uint8_t index;
     uint16_t pid;
@@ -92,8 +101,25 @@ typedef struct _usbcmd_context_t
     usb_cmd_stream_cb_t *callback;
     void *stream_context;
     bool stream_going;
+    bool shared_stream_active;
+    // transfer_lock guards transfer_list and transfers_pending against the completion callbacks, which release their
+    // transfer on the event thread. transfer_released is posted under it each time transfers_pending drops.
+    LOCK_HANDLE transfer_lock;
+    COND_HANDLE transfer_released;
     usb_async_transfer_data_t *transfer_list[USB_CMD_MAX_XFR_COUNT];
+    uint32_t transfers_pending; // Transfers submitted and not yet released by their callback
     size_t stream_size;
+    uint32_t xfr_count_limit; // 0 for USB_CMD_DEFAULT_XFR_COUNT
+    size_t xfr_pool_limit;    // 0 for USB_CMD_MAX_XFR_POOL or K4A_MAX_LIBUSB_POOL
+    volatile long xfr_count;  // Transfers submitted by the current (or last) stream
+    // Allocator for the stream buffers, no callbacks for the process allocator
+    allocator_hook_t allocator;
+    allocator_pool_t *pool;
+    bool prefault_pool; // Touch the pool buffers before the transfers of the next stream are submitted
+    volatile long pool_size;
+    volatile long pool_recycled_count;
+    volatile long pool_exhausted_count;
+    volatile long timeout_count; // Stream transfers that timed out since the handle was created
     LOCK_HANDLE lock;
     THREAD_HANDLE stream_handle;
 } usbcmd_context_t;
@@ -105,6 +131,10 @@ K4A_DECLARE_CONTEXT(usbcmd_t, usbcmd_context_t);
 //******************* Function Prototypes ***********************
 void LIBUSB_CALL usb_cmd_libusb_cb(struct libusb_transfer *bulk_transfer);
 
+// Get the libusb context for a new usbcmd instance, shared if usb_cmd_set_shared_event_threads() enabled sharing
+k4a_result_t usb_cmd_context_acquire(libusb_context **context, bool *shared);
+void usb_cmd_context_release(libusb_context *context, bool shared);
+
 #ifdef __cplusplus
 }
 #endif
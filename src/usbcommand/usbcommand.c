@@ -6,6 +6,9 @@
 // This library
 #include "usb_cmd_priv.h"
 
+// Dependent libraries
+#include <k4ainternal/global.h>
+
 // System dependencies
 #include <stdlib.h>
 #include <string.h>
@@ -76,12 +79,103 @@ typedef struct _descriptor_choice_t
     usbcmd_context_t **handle_list;
 } descriptor_choice_t;
 
+// Serial number of a device, keyed by where it is connected so a re-plugged device is read again
+typedef struct _usb_serial_cache_entry_t
+{
+    bool valid;
+    uint8_t bus;
+    uint8_t address;
+    uint8_t port_count;
+    uint8_t ports[USB_CMD_MAX_PORT_NUMBERS];
+    char serial_number[MAX_SERIAL_NUMBER_LENGTH];
+} usb_serial_cache_entry_t;
+
+typedef struct
+{
+    LOCK_HANDLE lock;
+
+    // Access to these fields may only occur while holding lock
+    usb_serial_cache_entry_t entries[USB_CMD_SERIAL_CACHE_SIZE];
+    uint32_t next_entry; // Entry replaced when the cache is full
+} usb_serial_cache_global_t;
+
 //************ Declarations (Statics and globals) ***************
+static void usb_serial_cache_global_init(usb_serial_cache_global_t *global)
+{
+    global->lock = Lock_Init();
+}
+
+K4A_DECLARE_GLOBAL(usb_serial_cache_global_t, usb_serial_cache_global_init);
 
 //******************* Function Prototypes ***********************
 
 //*********************** Functions *****************************
 
+static void usb_serial_cache_key(libusb_device *device, usb_serial_cache_entry_t *key)
+{
+    memset(key, 0, sizeof(*key));
+    key->bus = libusb_get_bus_number(device);
+    key->address = libusb_get_device_address(device);
+    int port_count = libusb_get_port_numbers(device, key->ports, (int)sizeof(key->ports));
+    key->port_count = port_count > 0 ? (uint8_t)port_count : 0;
+}
+
+static usb_serial_cache_entry_t *usb_serial_cache_find(usb_serial_cache_global_t *cache,
+                                                       const usb_serial_cache_entry_t *key)
+{
+    for (uint32_t i = 0; i < USB_CMD_SERIAL_CACHE_SIZE; i++)
+    {
+        usb_serial_cache_entry_t *entry = &cache->entries[i];
+        if (entry->valid && entry->bus == key->bus && entry->address == key->address &&
+            entry->port_count == key->port_count && memcmp(entry->ports, key->ports, key->port_count) == 0)
+        {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+// Look up the serial number of device, returns false if it has not been read yet
+static bool usb_serial_cache_get(libusb_device *device, char *serial_number, size_t serial_number_size)
+{
+    usb_serial_cache_global_t *cache = usb_serial_cache_global_t_get();
+    usb_serial_cache_entry_t key;
+    bool found = false;
+
+    usb_serial_cache_key(device, &key);
+
+    Lock(cache->lock);
+    usb_serial_cache_entry_t *entry = usb_serial_cache_find(cache, &key);
+    if (entry != NULL)
+    {
+        snprintf(serial_number, serial_number_size, "%s", entry->serial_number);
+        found = true;
+    }
+    Unlock(cache->lock);
+
+    return found;
+}
+
+static void usb_serial_cache_set(libusb_device *device, const char *serial_number)
+{
+    usb_serial_cache_global_t *cache = usb_serial_cache_global_t_get();
+    usb_serial_cache_entry_t key;
+
+    usb_serial_cache_key(device, &key);
+
+    Lock(cache->lock);
+    usb_serial_cache_entry_t *entry = usb_serial_cache_find(cache, &key);
+    if (entry == NULL)
+    {
+        entry = &cache->entries[cache->next_entry];
+        cache->next_entry = (cache->next_entry + 1) % USB_CMD_SERIAL_CACHE_SIZE;
+    }
+    *entry = key;
+    snprintf(entry->serial_number, sizeof(entry->serial_number), "%s", serial_number);
+    entry->valid = true;
+    Unlock(cache->lock);
+}
+
 #define UUID_STR_LENGTH sizeof("{00000000-0000-0000-0000-000000000000}")
 static void uuid_to_string(const guid_t *guid, char *string, size_t string_size)
 {
@@ -240,7 +334,7 @@ static k4a_result_t find_libusb_device(uint32_t device_index,
     int access_denied = 0;
 
     // Initialize library
-    result = K4A_RESULT_FROM_LIBUSB(libusb_init(&usbcmd->libusb_context));
+    result = TRACE_CALL(usb_cmd_context_acquire(&usbcmd->libusb_context, &usbcmd->shared_context));
 
     if (K4A_SUCCEEDED(result))
     {
@@ -399,6 +493,13 @@ k4a_result_t usb_cmd_create(usb_command_device_type_t device_type,
         result = K4A_RESULT_FROM_BOOL((usbcmd->lock = Lock_Init()) != NULL);
     }
 
+    if (K4A_SUCCEEDED(result))
+    {
+        usbcmd->transfer_lock = Lock_Init();
+        usbcmd->transfer_released = Condition_Init();
+        result = K4A_RESULT_FROM_BOOL(usbcmd->transfer_lock != NULL && usbcmd->transfer_released != NULL);
+    }
+
     if (K4A_SUCCEEDED(result))
     {
         if (device_type == USB_DEVICE_DEPTH_PROCESSOR)
@@ -427,6 +528,12 @@ k4a_result_t usb_cmd_create(usb_command_device_type_t device_type,
         result = populate_serialnumber(usbcmd, &desc);
     }
 
+    if (K4A_SUCCEEDED(result) && usbcmd->pid == K4A_DEPTH_PID)
+    {
+        // Let usb_cmd_get_installed_devices() report this device without opening it
+        usb_serial_cache_set(libusb_get_device(usbcmd->libusb), (const char *)usbcmd->serial_number);
+    }
+
     if (K4A_SUCCEEDED(result))
     {
         // Set up the configuration and interfaces based on known descriptor definition
@@ -505,7 +612,7 @@ void usb_cmd_destroy(usbcmd_t usbcmd_handle)
     if (usbcmd->libusb_context)
     {
         // close the instance
-        libusb_exit(usbcmd->libusb_context);
+        usb_cmd_context_release(usbcmd->libusb_context, usbcmd->shared_context);
         usbcmd->libusb_context = 0;
     }
 
@@ -516,6 +623,18 @@ void usb_cmd_destroy(usbcmd_t usbcmd_handle)
         usbcmd->lock = 0;
     }
 
+    if (usbcmd->transfer_released)
+    {
+        Condition_Deinit(usbcmd->transfer_released);
+        usbcmd->transfer_released = NULL;
+    }
+
+    if (usbcmd->transfer_lock)
+    {
+        Lock_Deinit(usbcmd->transfer_lock);
+        usbcmd->transfer_lock = NULL;
+    }
+
     // Destroy the allocator
     usbcmd_t_destroy(usbcmd_handle);
 }
@@ -1072,6 +1191,116 @@ k4a_result_t usb_cmd_get_device_count(uint32_t *p_device_count)
     return result;
 }
 
+/**
+ *  Function to list the depth devices attached and their serial numbers
+ *
+ *  @param devices
+ *   Array of max_devices entries the devices are written to
+ *
+ *  @param max_devices
+ *   Number of entries devices can hold
+ *
+ *  @param device_count
+ *   Pointer to where the number of devices attached will be placed
+ *
+ *  @return
+ *   K4A_RESULT_SUCCEEDED   Operation successful
+ *   K4A_RESULT_FAILED      Operation failed
+ *
+ */
+k4a_result_t usb_cmd_get_installed_devices(k4a_installed_device_t *devices,
+                                           uint32_t max_devices,
+                                           uint32_t *device_count)
+{
+    k4a_result_t result = K4A_RESULT_SUCCEEDED;
+    struct libusb_device_descriptor desc;
+    libusb_context *libusb_ctx;
+    libusb_device **dev_list; // pointer to pointer of device, used to retrieve a list of devices
+    ssize_t count;            // holding number of devices in list
+    int err;
+    uint32_t depth_device_count = 0;
+
+    if (device_count == NULL || (devices == NULL && max_devices != 0))
+    {
+        LOG_ERROR("Error device_count or devices is NULL", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    *device_count = 0;
+    if ((err = libusb_init(&libusb_ctx)) < 0)
+    {
+        LOG_ERROR("Error calling libusb_init, result:%s", libusb_error_name(err));
+        return K4A_RESULT_FAILED;
+    }
+
+    // As in usb_cmd_get_device_count(), this local context is only used to list devices. Opening a device already in
+    // use by another process also fails noisily on Windows.
+    libusb_logging_disable(libusb_ctx);
+
+    count = libusb_get_device_list(libusb_ctx, &dev_list);
+    if (count < 0 || count > INT32_MAX)
+    {
+        LOG_ERROR("Error listing devices", 0);
+        libusb_exit(libusb_ctx);
+        return K4A_RESULT_FAILED;
+    }
+
+    // Devices are indexed in list order as find_libusb_device() does for depth devices
+    for (int loop = 0; loop < count; loop++)
+    {
+        result = K4A_RESULT_FROM_LIBUSB(libusb_get_device_descriptor(dev_list[loop], &desc));
+        if (K4A_FAILED(result))
+        {
+            break;
+        }
+
+        if (desc.idVendor != K4A_MSFT_VID || desc.idProduct != K4A_DEPTH_PID)
+        {
+            continue;
+        }
+
+        if (depth_device_count < max_devices)
+        {
+            k4a_installed_device_t *device = &devices[depth_device_count];
+            device->index = depth_device_count;
+            device->serial_number[0] = '\0';
+
+            if (!usb_serial_cache_get(dev_list[loop], device->serial_number, sizeof(device->serial_number)) &&
+                desc.iSerialNumber != 0)
+            {
+                // Only the string descriptor is read, no command is sent to the device
+                libusb_device_handle *handle = NULL;
+                if (libusb_open(dev_list[loop], &handle) == LIBUSB_SUCCESS)
+                {
+                    if (libusb_get_string_descriptor_ascii(handle,
+                                                           desc.iSerialNumber,
+                                                           (unsigned char *)device->serial_number,
+                                                           sizeof(device->serial_number)) >= 0)
+                    {
+                        usb_serial_cache_set(dev_list[loop], device->serial_number);
+                    }
+                    else
+                    {
+                        device->serial_number[0] = '\0';
+                    }
+                    libusb_close(handle);
+                }
+            }
+        }
+        depth_device_count += 1;
+    }
+
+    libusb_free_device_list(dev_list, (int)count);
+    libusb_exit(libusb_ctx);
+
+    if (K4A_SUCCEEDED(result))
+    {
+        *device_count = depth_device_count;
+    }
+
+    return result;
+}
+
 // Waiting on hot-plugging support
 #if 0
 /**
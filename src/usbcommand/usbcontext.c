@@ -0,0 +1,223 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+//************************ Includes *****************************
+// This library
+#include <k4ainternal/usbcommand.h>
+#include "usb_cmd_priv.h"
+
+// Dependent libraries
+#include <k4ainternal/global.h>
+#include <k4ainternal/threadpolicy.h>
+
+// System dependencies
+#include <string.h>
+
+//**************Symbolic Constant Macros (defines)  *************
+#define USB_CMD_SHARED_EVENT_TIMEOUT 1
+
+//************************ Typedefs *****************************
+// A libusb context shared by several usbcmd instances and the thread servicing its events
+typedef struct _usb_cmd_shared_context_t
+{
+    libusb_context *libusb_context;
+    uint32_t users;
+    THREAD_HANDLE thread;
+    volatile bool running;
+} usb_cmd_shared_context_t;
+
+typedef struct
+{
+    LOCK_HANDLE lock;
+
+    // Access to these fields may only occur while holding lock
+    uint32_t thread_count; // 0 when contexts are not shared
+    usb_cmd_shared_context_t contexts[USB_CMD_MAX_SHARED_CONTEXTS];
+} usb_cmd_context_global_t;
+
+//************ Declarations (Statics and globals) ***************
+static void usb_cmd_context_global_init(usb_cmd_context_global_t *global)
+{
+    global->lock = Lock_Init();
+}
+
+K4A_DECLARE_GLOBAL(usb_cmd_context_global_t, usb_cmd_context_global_init);
+
+//*********************** Functions *****************************
+/**
+ *  Thread servicing the events of a shared libusb context for every stream using it
+ *
+ *  @param var
+ *   Pointer to the shared context
+ *
+ */
+static int usb_cmd_shared_event_thread(void *var)
+{
+    usb_cmd_shared_context_t *shared = (usb_cmd_shared_context_t *)var;
+    struct timeval tv = { 0 };
+    int err;
+
+    // Shared event threads carry depth traffic, so they follow the depth USB policy
+    threadpolicy_apply(K4A_SDK_THREAD_DEPTH_USB);
+
+    tv.tv_sec = USB_CMD_SHARED_EVENT_TIMEOUT;
+
+    while (shared->running)
+    {
+        if ((err = libusb_handle_events_timeout_completed(shared->libusb_context, &tv, NULL)) < 0 &&
+            err != LIBUSB_ERROR_INTERRUPTED)
+        {
+            // Other streams may still be healthy so keep servicing the context
+            LOG_ERROR("Error calling libusb_handle_events_timeout failed, result:%s", libusb_error_name(err));
+            ThreadAPI_Sleep(USB_CMD_EVENT_WAIT_TIME);
+        }
+    }
+
+    ThreadAPI_Exit(0);
+    return 0;
+}
+
+k4a_result_t usb_cmd_set_shared_event_threads(uint32_t thread_count)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, thread_count > USB_CMD_MAX_SHARED_CONTEXTS);
+
+    usb_cmd_context_global_t *global = usb_cmd_context_global_t_get();
+
+    Lock(global->lock);
+    global->thread_count = thread_count;
+    Unlock(global->lock);
+
+    return K4A_RESULT_SUCCEEDED;
+}
+
+/**
+ *  Get a libusb context for a new usbcmd instance
+ *
+ *  @param context
+ *   Location to write the context to
+ *
+ *  @param shared
+ *   Set to true if the context is serviced by a shared event thread, in which case
+ *   the instance must not run its own event loop
+ *
+ *  @return
+ *   K4A_RESULT_SUCCEEDED   Operation successful
+ *   K4A_RESULT_FAILED      Operation failed
+ *
+ */
+k4a_result_t usb_cmd_context_acquire(libusb_context **context, bool *shared)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, shared == NULL);
+
+    usb_cmd_context_global_t *global = usb_cmd_context_global_t_get();
+    k4a_result_t result = K4A_RESULT_SUCCEEDED;
+    int err;
+
+    *context = NULL;
+    *shared = false;
+
+    Lock(global->lock);
+    if (global->thread_count == 0)
+    {
+        if ((err = libusb_init(context)) < 0)
+        {
+            LOG_ERROR("Error calling libusb_init, result:%s", libusb_error_name(err));
+            result = K4A_RESULT_FAILED;
+        }
+    }
+    else
+    {
+        // Spread the instances over the shared contexts by load
+        usb_cmd_shared_context_t *selected = &global->contexts[0];
+        for (uint32_t i = 1; i < global->thread_count; i++)
+        {
+            if (global->contexts[i].users < selected->users)
+            {
+                selected = &global->contexts[i];
+            }
+        }
+
+        if (selected->libusb_context == NULL)
+        {
+            if ((err = libusb_init(&selected->libusb_context)) < 0)
+            {
+                LOG_ERROR("Error calling libusb_init, result:%s", libusb_error_name(err));
+                selected->libusb_context = NULL;
+                result = K4A_RESULT_FAILED;
+            }
+
+            if (K4A_SUCCEEDED(result))
+            {
+                selected->running = true;
+                if (ThreadAPI_Create(&selected->thread, usb_cmd_shared_event_thread, selected) != THREADAPI_OK)
+                {
+                    LOG_ERROR("Could not start shared libusb event thread", 0);
+                    selected->running = false;
+                    libusb_exit(selected->libusb_context);
+                    selected->libusb_context = NULL;
+                    result = K4A_RESULT_FAILED;
+                }
+            }
+        }
+
+        if (K4A_SUCCEEDED(result))
+        {
+            selected->users++;
+            *context = selected->libusb_context;
+            *shared = true;
+        }
+    }
+    Unlock(global->lock);
+
+    return result;
+}
+
+/**
+ *  Release a libusb context obtained from usb_cmd_context_acquire()
+ *
+ *  @param context
+ *   Context to release
+ *
+ *  @param shared
+ *   Value returned by usb_cmd_context_acquire() for this context
+ *
+ */
+void usb_cmd_context_release(libusb_context *context, bool shared)
+{
+    if (context == NULL)
+    {
+        return;
+    }
+
+    if (!shared)
+    {
+        libusb_exit(context);
+        return;
+    }
+
+    usb_cmd_context_global_t *global = usb_cmd_context_global_t_get();
+
+    Lock(global->lock);
+    for (uint32_t i = 0; i < USB_CMD_MAX_SHARED_CONTEXTS; i++)
+    {
+        usb_cmd_shared_context_t *shared_context = &global->contexts[i];
+        if (shared_context->libusb_context != context)
+        {
+            continue;
+        }
+
+        if (--shared_context->users == 0)
+        {
+            shared_context->running = false;
+#if (LIBUSB_API_VERSION >= 0x01000105)
+            libusb_interrupt_event_handler(context);
+#endif
+            ThreadAPI_Join(shared_context->thread, NULL);
+            libusb_exit(context);
+            memset(shared_context, 0, sizeof(*shared_context));
+        }
+        break;
+    }
+    Unlock(global->lock);
+}
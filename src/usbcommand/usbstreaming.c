@@ -6,12 +6,17 @@
 #include <k4ainternal/usbcommand.h>
 #include "usb_cmd_priv.h"
 
+// Dependent libraries
+#include <k4ainternal/threadpolicy.h>
+#include <k4ainternal/tracing.h>
+
 // System dependencies
 #include <assert.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
 #include <azure_c_shared_utility/envvariable.h>
+#include <azure_c_shared_utility/refcount.h>
 
 //**************Symbolic Constant Macros (defines)  *************
 #define USB_CMD_LIBUSB_EVENT_TIMEOUT 1
@@ -23,6 +28,82 @@
 //******************* Function Prototypes ***********************
 
 //*********************** Functions *****************************
+static void usb_cmd_stream_buffer_free(void *buffer, void *context)
+{
+    (void)context;
+    allocator_free(buffer);
+}
+
+/**
+ *  Allocate the image for the next transfer, taking the buffer from the stream pool when one is idle
+ *
+ *  @param usbcmd
+ *   Context of the stream the transfer belongs to
+ *
+ *  @param image
+ *   Location to write the new image to
+ *
+ *  @return
+ *   K4A_RESULT_SUCCEEDED   Operation successful
+ *   K4A_RESULT_FAILED      Operation failed
+ *
+ */
+static k4a_result_t usb_cmd_stream_image_create(usbcmd_context_t *usbcmd, k4a_image_t *image)
+{
+    allocator_pool_t *pool = usbcmd->pool;
+    uint8_t *buffer = NULL;
+    bool recycled = false;
+
+    if (pool == NULL)
+    {
+        if (!allocator_hook_is_set(&usbcmd->allocator, usbcmd->source))
+        {
+            return TRACE_CALL(image_create_empty_internal(usbcmd->source, usbcmd->stream_size, image));
+        }
+
+        buffer = allocator_alloc_hooked(&usbcmd->allocator,
+                                        usbcmd->source,
+                                        usbcmd->stream_size,
+                                        ALLOCATOR_DEFAULT_ALIGNMENT);
+        k4a_result_t result = K4A_RESULT_FROM_BOOL(buffer != NULL);
+        if (K4A_SUCCEEDED(result))
+        {
+            result = TRACE_CALL(image_create_empty_from_buffer_internal(
+                buffer, usbcmd->stream_size, usb_cmd_stream_buffer_free, NULL, image));
+            if (K4A_FAILED(result))
+            {
+                allocator_free(buffer);
+            }
+        }
+        return result;
+    }
+
+    buffer = allocator_pool_alloc(pool, &recycled);
+    if (buffer == NULL)
+    {
+        LOG_ERROR("Failed to allocate a %llu byte streaming buffer", (unsigned long long)usbcmd->stream_size);
+        return K4A_RESULT_FAILED;
+    }
+
+    if (recycled)
+    {
+        INC_REF_VAR(usbcmd->pool_recycled_count);
+    }
+    else
+    {
+        // Images are being held downstream longer than the pool covers
+        INC_REF_VAR(usbcmd->pool_exhausted_count);
+    }
+
+    k4a_result_t result = TRACE_CALL(
+        image_create_empty_from_buffer_internal(buffer, usbcmd->stream_size, allocator_pool_free, pool, image));
+    if (K4A_FAILED(result))
+    {
+        allocator_pool_free(buffer, pool);
+    }
+    return result;
+}
+
 /**
  *  Utility function for releasing the transfer resources
  *
@@ -35,10 +116,14 @@ static void usb_cmd_release_xfr(struct libusb_transfer *bulk_transfer)
     usb_async_transfer_data_t *transfer = (usb_async_transfer_data_t *)(bulk_transfer->user_data);
     usbcmd_context_t *usbcmd = transfer->usbcmd;
 
+    // Once out of the list the transfer can't be cancelled any more, so it can be freed
+    Lock(usbcmd->transfer_lock);
     if (usbcmd->transfer_list[transfer->list_index] == transfer)
     {
         usbcmd->transfer_list[transfer->list_index] = NULL;
     }
+    Unlock(usbcmd->transfer_lock);
+
     if (transfer->image)
     {
         image_dec_ref(transfer->image);
@@ -48,6 +133,13 @@ static void usb_cmd_release_xfr(struct libusb_transfer *bulk_transfer)
     // free the allocated resources
     libusb_free_transfer(bulk_transfer);
     free(transfer);
+
+    // Last use of the context, the stream can be stopped and the pool released as soon as the lock is dropped
+    Lock(usbcmd->transfer_lock);
+    assert(usbcmd->transfers_pending > 0);
+    usbcmd->transfers_pending--;
+    Condition_Post(usbcmd->transfer_released);
+    Unlock(usbcmd->transfer_lock);
 }
 
 /**
@@ -62,10 +154,15 @@ void LIBUSB_CALL usb_cmd_libusb_cb(struct libusb_transfer *bulk_transfer)
     usb_async_transfer_data_t *transfer = (usb_async_transfer_data_t *)(bulk_transfer->user_data);
     usbcmd_context_t *usbcmd = transfer->usbcmd;
     k4a_result_t result = K4A_RESULT_FAILED;
+    const char *trace_name = usbcmd->interface == USB_CMD_DEPTH_INTERFACE ? "usb depth transfer" : "usb imu transfer";
+    uint64_t trace_frame = 0;
 
     result = image_apply_system_timestamp(transfer->image);
     if (K4A_SUCCEEDED(result))
     {
+        trace_frame = image_get_system_timestamp_nsec(transfer->image);
+        TRACE_SPAN_BEGIN(trace_name, trace_frame);
+
         if (((bulk_transfer->status == LIBUSB_TRANSFER_COMPLETED) ||
              bulk_transfer->status == LIBUSB_TRANSFER_TIMED_OUT) &&
             (usbcmd->stream_going))
@@ -78,6 +175,10 @@ void LIBUSB_CALL usb_cmd_libusb_cb(struct libusb_transfer *bulk_transfer)
             }
             else
             {
+                if (bulk_transfer->status == LIBUSB_TRANSFER_TIMED_OUT)
+                {
+                    INC_REF_VAR(usbcmd->timeout_count);
+                }
                 LOG_WARNING("USB timeout on streaming endpoint for %s",
                             usbcmd->interface == USB_CMD_DEPTH_INTERFACE ? "depth" : "imu");
             }
@@ -87,8 +188,8 @@ void LIBUSB_CALL usb_cmd_libusb_cb(struct libusb_transfer *bulk_transfer)
             image_dec_ref(transfer->image);
             transfer->image = NULL;
 
-            // allocate next buffer and re-use transfer
-            result = TRACE_CALL(image_create_empty_internal(usbcmd->source, usbcmd->stream_size, &transfer->image));
+            // get the next buffer and re-use transfer
+            result = TRACE_CALL(usb_cmd_stream_image_create(usbcmd, &transfer->image));
             if (K4A_SUCCEEDED(result))
             {
                 int err = LIBUSB_ERROR_OTHER;
@@ -142,29 +243,32 @@ void LIBUSB_CALL usb_cmd_libusb_cb(struct libusb_transfer *bulk_transfer)
         // release resource for phy related changes or transfer stopped
         usb_cmd_release_xfr(bulk_transfer);
     }
+
+    if (trace_frame != 0)
+    {
+        TRACE_SPAN_END(trace_name, trace_frame);
+    }
 }
 
 /**
- *  LibUsb context thread for monitoring events in the usb lib
+ *  Create the buffer pool and submit the stream transfers.
  *
- *  @param var
- *   context variable.  In this case, this points to a command handle
- *   associated with the streaming.
+ *  @param usbcmd
+ *   Context of the stream being started
  *
  *  @return
  *   K4A_RESULT_SUCCEEDED   Operation successful
- *   K4A_RESULT_FAILED      Operation failed
+ *   K4A_RESULT_FAILED      Operation failed, transfers submitted so far are left in transfer_list
  *
  */
-static int usb_cmd_lib_usb_thread(void *var)
+static k4a_result_t usb_cmd_stream_submit_transfers(usbcmd_context_t *usbcmd)
 {
     k4a_result_t result = K4A_RESULT_SUCCEEDED;
-    usbcmd_context_t *usbcmd = (usbcmd_context_t *)var;
-    libusb_context *p_ctx = usbcmd->libusb_context;
     int err = LIBUSB_SUCCESS;
-    struct timeval tv = { 0 };
     size_t xfer_pool = usbcmd->stream_size;
     size_t max_xfr_pool = USB_CMD_MAX_XFR_POOL;
+    uint32_t max_xfr_count = USB_CMD_DEFAULT_XFR_COUNT;
+    uint32_t xfr_count = 0;
 
     // override the xfr pool if the environment variable is defined
     const char *env_max_pool = environment_get_variable("K4A_MAX_LIBUSB_POOL");
@@ -173,7 +277,16 @@ static int usb_cmd_lib_usb_thread(void *var)
         max_xfr_pool = (size_t)strtol(env_max_pool, NULL, 10);
     }
 
-    tv.tv_sec = USB_CMD_LIBUSB_EVENT_TIMEOUT;
+    // limits configured for this device take precedence
+    if (usbcmd->xfr_pool_limit != 0)
+    {
+        max_xfr_pool = usbcmd->xfr_pool_limit;
+    }
+    if (usbcmd->xfr_count_limit != 0)
+    {
+        max_xfr_count = usbcmd->xfr_count_limit;
+    }
+    usbcmd->xfr_count = 0;
 
     if (usbcmd->stream_size > INT32_MAX)
     {
@@ -181,8 +294,32 @@ static int usb_cmd_lib_usb_thread(void *var)
     }
     else
     {
-        // set up the transfers.  Limit the overall amount of resources to a predefined amount
-        for (uint32_t i = 0; (i < USB_CMD_MAX_XFR_COUNT) && (xfer_pool < max_xfr_pool); i++)
+        // Limit the overall amount of resources to a predefined amount
+        for (size_t pool_size = xfer_pool; (xfr_count < max_xfr_count) && (pool_size < max_xfr_pool);
+             pool_size += usbcmd->stream_size)
+        {
+            xfr_count++;
+        }
+
+        // Pre-allocate the buffers for the transfers plus the images held downstream so the completion path recycles
+        // memory instead of going back to the allocator for every frame
+        usbcmd->pool = allocator_pool_create(&usbcmd->allocator,
+                                             usbcmd->source,
+                                             usbcmd->stream_size,
+                                             xfr_count + USB_CMD_POOL_EXTRA_BUFFERS);
+        if (usbcmd->pool == NULL)
+        {
+            LOG_WARNING("Failed to pre-allocate streaming buffers, allocating per transfer instead", 0);
+        }
+        usbcmd->pool_size = usbcmd->pool ? (long)(xfr_count + USB_CMD_POOL_EXTRA_BUFFERS) : 0;
+        if (usbcmd->pool != NULL && usbcmd->prefault_pool)
+        {
+            // Completions write straight into these buffers, so page faults would land on the first frames
+            allocator_pool_prefault(usbcmd->pool);
+        }
+
+        // set up the transfers.
+        for (uint32_t i = 0; i < xfr_count; i++)
         {
             usb_async_transfer_data_t *transfer;
             transfer = calloc(sizeof(usb_async_transfer_data_t), sizeof(int));
@@ -190,17 +327,15 @@ static int usb_cmd_lib_usb_thread(void *var)
 
             if (K4A_SUCCEEDED(result))
             {
-                xfer_pool += usbcmd->stream_size;
                 transfer->usbcmd = usbcmd;
                 transfer->list_index = i;
-                usbcmd->transfer_list[i] = transfer;
                 transfer->bulk_transfer = libusb_alloc_transfer(0);
                 result = K4A_RESULT_FROM_BOOL(transfer->bulk_transfer != NULL);
             }
 
             if (K4A_SUCCEEDED(result))
             {
-                result = TRACE_CALL(image_create_empty_internal(usbcmd->source, usbcmd->stream_size, &transfer->image));
+                result = TRACE_CALL(usb_cmd_stream_image_create(usbcmd, &transfer->image));
             }
 
             if (K4A_SUCCEEDED(result))
@@ -215,8 +350,19 @@ static int usb_cmd_lib_usb_thread(void *var)
                                           transfer,
                                           USB_CMD_MAX_WAIT_TIME);
 
+                // Counted before the submit, a shared event thread can complete and release the transfer right away
+                Lock(usbcmd->transfer_lock);
+                usbcmd->transfer_list[i] = transfer;
+                usbcmd->transfers_pending++;
+                Unlock(usbcmd->transfer_lock);
+
                 if ((err = libusb_submit_transfer(transfer->bulk_transfer)) != LIBUSB_SUCCESS)
                 {
+                    Lock(usbcmd->transfer_lock);
+                    usbcmd->transfer_list[i] = NULL;
+                    usbcmd->transfers_pending--;
+                    Unlock(usbcmd->transfer_lock);
+
                     if (i == 0)
                     {
                         // Could not even submit one.  This is an error
@@ -233,6 +379,10 @@ static int usb_cmd_lib_usb_thread(void *var)
                             i + 1);
                     }
                 }
+                else
+                {
+                    usbcmd->xfr_count++;
+                }
             }
 
             if (K4A_FAILED(result))
@@ -249,13 +399,129 @@ static int usb_cmd_lib_usb_thread(void *var)
                     }
                     free(transfer);
                 }
-
-                usbcmd->transfer_list[i] = NULL;
                 break; // exit loop
             }
         }
     }
 
+
+    if (result == K4A_RESULT_SUCCEEDED)
+    {
+        LOG_INFO("%ld libusb transfers of %llu bytes submitted for %s",
+                 usbcmd->xfr_count,
+                 (unsigned long long)usbcmd->stream_size,
+                 usbcmd->interface == USB_CMD_DEPTH_INTERFACE ? "depth" : "imu");
+    }
+
+    return result;
+}
+
+/**
+ *  Release the stream buffer pool once all transfers are gone. Buffers still
+ *  referenced downstream are freed when their images are released.
+ *
+ *  @param usbcmd
+ *   Context of the stream being stopped
+ *
+ */
+static void usb_cmd_stream_release_pool(usbcmd_context_t *usbcmd)
+{
+    if (usbcmd->pool != NULL)
+    {
+        LOG_INFO("Streaming buffer pool of %ld: %ld recycled, %ld exhausted",
+                 usbcmd->pool_size,
+                 usbcmd->pool_recycled_count,
+                 usbcmd->pool_exhausted_count);
+        allocator_pool_close(usbcmd->pool);
+        usbcmd->pool = NULL;
+    }
+}
+
+/**
+ *  Cancel every transfer still in the transfer list. The caller must hold
+ *  transfer_lock, which keeps the callbacks from freeing the transfers.
+ *
+ *  @param usbcmd
+ *   Context of the stream being stopped
+ *
+ */
+static void usb_cmd_stream_cancel_listed(usbcmd_context_t *usbcmd)
+{
+    for (uint32_t i = 0; i < USB_CMD_MAX_XFR_COUNT; i++)
+    {
+        usb_async_transfer_data_t *transfer = usbcmd->transfer_list[i];
+        if (transfer != NULL)
+        {
+            libusb_cancel_transfer(transfer->bulk_transfer);
+        }
+    }
+}
+
+/**
+ *  Cancel the stream transfers while a shared event thread services the
+ *  context, and wait for their callbacks to release them. Does not return
+ *  while any transfer is still in flight, as the pool and the context must
+ *  outlive them.
+ *
+ *  @param usbcmd
+ *   Context of the stream being stopped
+ *
+ */
+static void usb_cmd_stream_cancel_shared(usbcmd_context_t *usbcmd)
+{
+    uint32_t waited = 0;
+    bool reported = false;
+
+    Lock(usbcmd->transfer_lock);
+    while (usbcmd->transfers_pending != 0)
+    {
+        // A callback that raced with stream_going being cleared can resubmit its transfer, so cancel again after
+        // every wait
+        usb_cmd_stream_cancel_listed(usbcmd);
+        if (Condition_Wait(usbcmd->transfer_released, usbcmd->transfer_lock, USB_CMD_SHARED_CANCEL_RETRY_TIME) ==
+            COND_TIMEOUT)
+        {
+            waited += USB_CMD_SHARED_CANCEL_RETRY_TIME;
+        }
+
+        if (!reported && waited >= USB_CMD_SHARED_CANCEL_WAIT_TIME)
+        {
+            LOG_ERROR("Still waiting for %u %s transfers to be cancelled",
+                      usbcmd->transfers_pending,
+                      usbcmd->interface == USB_CMD_DEPTH_INTERFACE ? "depth" : "imu");
+            reported = true;
+        }
+    }
+    Unlock(usbcmd->transfer_lock);
+}
+
+/**
+ *  LibUsb context thread for monitoring events in the usb lib
+ *
+ *  @param var
+ *   context variable.  In this case, this points to a command handle
+ *   associated with the streaming.
+ *
+ *  @return
+ *   K4A_RESULT_SUCCEEDED   Operation successful
+ *   K4A_RESULT_FAILED      Operation failed
+ *
+ */
+static int usb_cmd_lib_usb_thread(void *var)
+{
+    k4a_result_t result = K4A_RESULT_SUCCEEDED;
+    usbcmd_context_t *usbcmd = (usbcmd_context_t *)var;
+    libusb_context *p_ctx = usbcmd->libusb_context;
+    int err = LIBUSB_SUCCESS;
+    struct timeval tv = { 0 };
+
+    threadpolicy_apply(usbcmd->interface == USB_CMD_DEPTH_INTERFACE ? K4A_SDK_THREAD_DEPTH_USB :
+                                                                     K4A_SDK_THREAD_IMU_USB);
+
+    tv.tv_sec = USB_CMD_LIBUSB_EVENT_TIMEOUT;
+
+    result = usb_cmd_stream_submit_transfers(usbcmd);
+
     // loop servicing libusb
     if (result == K4A_RESULT_SUCCEEDED)
     {
@@ -270,29 +536,36 @@ static int usb_cmd_lib_usb_thread(void *var)
         }
     }
 
-    // cancel everything just in case of errors
-    for (uint32_t i = 0; i < USB_CMD_MAX_XFR_COUNT; i++)
+    // Cancel everything and service the library until the callbacks have released every transfer, this thread is the
+    // only one running them
+    for (;;)
     {
-        if (usbcmd->transfer_list[i] != NULL)
+        Lock(usbcmd->transfer_lock);
+        uint32_t pending = usbcmd->transfers_pending;
+        usb_cmd_stream_cancel_listed(usbcmd);
+        Unlock(usbcmd->transfer_lock);
+
+        if (pending == 0)
         {
-            // Cancel any outstanding transfer
-            libusb_cancel_transfer(usbcmd->transfer_list[i]->bulk_transfer);
-            // Service the library after  cancellation
-            if ((err = libusb_handle_events_timeout_completed(p_ctx, &tv, NULL)) < 0)
-            {
-                LOG_ERROR("Error calling libusb_handle_events_timeout failed, result:%s", libusb_error_name(err));
-                result = K4A_RESULT_FAILED;
-            }
+            break;
+        }
+        if ((err = libusb_handle_events_timeout_completed(p_ctx, &tv, NULL)) < 0)
+        {
+            LOG_ERROR("Error calling libusb_handle_events_timeout failed, result:%s", libusb_error_name(err));
+            result = K4A_RESULT_FAILED;
+            break;
         }
     }
 
+    usb_cmd_stream_release_pool(usbcmd);
+
     ThreadAPI_Exit((int)result);
     return 0;
 }
 
 /**
  *  Function to queue up the stream transfer.  This function will allocation
- *  USB_CMD_MAX_XFR_COUNT number of transfers on the stream pipe and
+ *  up to the configured number of transfers on the stream pipe and
  *  start the transfers.
  *
  *  @param usbcmd_handle
@@ -332,7 +605,22 @@ k4a_result_t usb_cmd_stream_start(usbcmd_t usbcmd_handle, size_t payload_size)
         {
             usbcmd->stream_size = payload_size;
             usbcmd->stream_going = true;
-            if (ThreadAPI_Create(&(usbcmd->stream_handle), usb_cmd_lib_usb_thread, usbcmd) != THREADAPI_OK)
+            if (usbcmd->shared_context)
+            {
+                // The shared event thread services the transfers, so they are submitted from here
+                result = usb_cmd_stream_submit_transfers(usbcmd);
+                if (K4A_SUCCEEDED(result))
+                {
+                    usbcmd->shared_stream_active = true;
+                }
+                else
+                {
+                    usbcmd->stream_going = false;
+                    usb_cmd_stream_cancel_shared(usbcmd);
+                    usb_cmd_stream_release_pool(usbcmd);
+                }
+            }
+            else if (ThreadAPI_Create(&(usbcmd->stream_handle), usb_cmd_lib_usb_thread, usbcmd) != THREADAPI_OK)
             {
                 usbcmd->stream_going = false;
                 LOG_ERROR("Could not start stream thread", 0);
@@ -348,6 +636,125 @@ k4a_result_t usb_cmd_stream_start(usbcmd_t usbcmd_handle, size_t payload_size)
     return result;
 }
 
+/**
+ *  Function to limit the transfers queued by the next usb_cmd_stream_start()
+ *
+ *  @param usbcmd_handle
+ *   Handle to the entry the stream runs on
+ *
+ *  @param max_transfer_count
+ *   Upper limit on outstanding transfers, 0 for USB_CMD_DEFAULT_XFR_COUNT
+ *
+ *  @param max_transfer_pool_size
+ *   Upper limit in bytes on memory used by outstanding transfers, 0 for the default
+ *
+ *  @return
+ *   K4A_RESULT_SUCCEEDED   Operation successful
+ *   K4A_RESULT_FAILED      Limits out of range or stream already started
+ *
+ */
+k4a_result_t usb_cmd_stream_set_transfer_limits(usbcmd_t usbcmd_handle,
+                                                uint32_t max_transfer_count,
+                                                size_t max_transfer_pool_size)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, usbcmd_t, usbcmd_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, max_transfer_count > USB_CMD_MAX_XFR_COUNT);
+
+    usbcmd_context_t *usbcmd = usbcmd_t_get_context(usbcmd_handle);
+    k4a_result_t result = K4A_RESULT_SUCCEEDED;
+
+    Lock(usbcmd->lock);
+    if (usbcmd->stream_going)
+    {
+        LOG_ERROR("Transfer limits can not be changed while streaming", 0);
+        result = K4A_RESULT_FAILED;
+    }
+    else
+    {
+        usbcmd->xfr_count_limit = max_transfer_count;
+        usbcmd->xfr_pool_limit = max_transfer_pool_size;
+    }
+    Unlock(usbcmd->lock);
+
+    return result;
+}
+
+/**
+ *  Function to set the allocator of the buffers used by the next usb_cmd_stream_start()
+ *
+ *  @param usbcmd_handle
+ *   Handle to the entry the stream runs on
+ *
+ *  @param hook
+ *   Allocator callbacks to copy, NULL for the process allocator
+ *
+ *  @return
+ *   K4A_RESULT_SUCCEEDED   Operation successful
+ *   K4A_RESULT_FAILED      Stream already started
+ *
+ */
+k4a_result_t usb_cmd_stream_set_allocator(usbcmd_t usbcmd_handle, const allocator_hook_t *hook)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, usbcmd_t, usbcmd_handle);
+
+    usbcmd_context_t *usbcmd = usbcmd_t_get_context(usbcmd_handle);
+    k4a_result_t result = K4A_RESULT_SUCCEEDED;
+
+    Lock(usbcmd->lock);
+    if (usbcmd->stream_going)
+    {
+        LOG_ERROR("The allocator can not be changed while streaming", 0);
+        result = K4A_RESULT_FAILED;
+    }
+    else if (hook)
+    {
+        usbcmd->allocator = *hook;
+    }
+    else
+    {
+        memset(&usbcmd->allocator, 0, sizeof(usbcmd->allocator));
+    }
+    Unlock(usbcmd->lock);
+
+    return result;
+}
+
+/**
+ *  Function to pre-fault the buffers of the next usb_cmd_stream_start()
+ *
+ *  @param usbcmd_handle
+ *   Handle to the entry the stream runs on
+ *
+ *  @param prefault
+ *   True to touch every pooled buffer before the transfers are submitted
+ *
+ *  @return
+ *   K4A_RESULT_SUCCEEDED   Operation successful
+ *   K4A_RESULT_FAILED      Stream already started
+ *
+ */
+k4a_result_t usb_cmd_stream_set_prefault(usbcmd_t usbcmd_handle, bool prefault)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, usbcmd_t, usbcmd_handle);
+
+    usbcmd_context_t *usbcmd = usbcmd_t_get_context(usbcmd_handle);
+    k4a_result_t result = K4A_RESULT_SUCCEEDED;
+
+    Lock(usbcmd->lock);
+    if (usbcmd->stream_going)
+    {
+        LOG_ERROR("Buffer pre-faulting can not be changed while streaming", 0);
+        result = K4A_RESULT_FAILED;
+    }
+    else
+    {
+        usbcmd->prefault_pool = prefault;
+    }
+    Unlock(usbcmd->lock);
+
+    return result;
+}
+
 /**
  *  Function for stopping the streaming on a handle. This function
  *  will block until the stream is stopped.  It is called implicitly
@@ -384,6 +791,13 @@ k4a_result_t usb_cmd_stream_stop(usbcmd_t usbcmd_handle)
             ThreadAPI_Join(usbcmd->stream_handle, NULL);
             usbcmd->stream_handle = NULL;
         }
+
+        if (usbcmd->shared_stream_active)
+        {
+            usb_cmd_stream_cancel_shared(usbcmd);
+            usb_cmd_stream_release_pool(usbcmd);
+            usbcmd->shared_stream_active = false;
+        }
         Unlock(usbcmd->lock);
 
         result = K4A_RESULT_SUCCEEDED;
@@ -391,3 +805,19 @@ k4a_result_t usb_cmd_stream_stop(usbcmd_t usbcmd_handle)
 
     return result;
 }
+
+k4a_result_t usb_cmd_get_stream_pool_stats(usbcmd_t usbcmd_handle, usb_cmd_stream_pool_stats_t *stats)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, usbcmd_t, usbcmd_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, stats == NULL);
+
+    usbcmd_context_t *usbcmd = usbcmd_t_get_context(usbcmd_handle);
+
+    stats->transfer_count = (uint32_t)usbcmd->xfr_count;
+    stats->pool_size = (uint32_t)usbcmd->pool_size;
+    stats->recycled_count = (uint32_t)usbcmd->pool_recycled_count;
+    stats->exhausted_count = (uint32_t)usbcmd->pool_exhausted_count;
+    stats->timeout_count = (uint32_t)usbcmd->timeout_count;
+
+    return K4A_RESULT_SUCCEEDED;
+}
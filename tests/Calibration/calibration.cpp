@@ -14,6 +14,18 @@ using namespace testing;
 #define GTEST_LOG_INFO std::cout << "[     INFO ] "
 #define FAKE_MCU ((depthmcu_t)0xface000)
 
+#ifdef _WIN32
+#define MKDIR(path) "if not exist " + path + " mkdir " + path
+#define RMDIR(path) "rmdir /S /Q " + path
+#define SETENV(env, value) _putenv_s(env, value)
+#else
+#define MKDIR(path) "mkdir -p " + path
+#define RMDIR(path) "rm -rf " + path
+#define SETENV(env, value) setenv(env, value, 1)
+#endif
+
+static int g_extrinsic_calibration_reads = 0;
+
 // Define the symbols needed from the usb_cmd module.
 // Only functions required to link the depth module are needed
 k4a_result_t
@@ -21,6 +33,7 @@ depthmcu_get_extrinsic_calibration(depthmcu_t depthmcu_handle, char *json, size_
 {
     (void)depthmcu_handle;
 
+    g_extrinsic_calibration_reads++;
     if (json_size < sizeof(g_test_json))
     {
         return K4A_RESULT_FAILED;
@@ -30,6 +43,32 @@ depthmcu_get_extrinsic_calibration(depthmcu_t depthmcu_handle, char *json, size_
     return K4A_RESULT_SUCCEEDED;
 }
 
+k4a_buffer_result_t depthmcu_get_serialnum(depthmcu_t depthmcu_handle, char *serial_number, size_t *serial_number_size)
+{
+    (void)depthmcu_handle;
+
+    const char fake_serial_number[] = "000123456789";
+    if (*serial_number_size < sizeof(fake_serial_number))
+    {
+        *serial_number_size = sizeof(fake_serial_number);
+        return K4A_BUFFER_RESULT_TOO_SMALL;
+    }
+    memcpy(serial_number, fake_serial_number, sizeof(fake_serial_number));
+    *serial_number_size = sizeof(fake_serial_number);
+    return K4A_BUFFER_RESULT_SUCCEEDED;
+}
+
+k4a_result_t depthmcu_get_version(depthmcu_t depthmcu_handle, depthmcu_firmware_versions_t *version)
+{
+    (void)depthmcu_handle;
+
+    memset(version, 0, sizeof(depthmcu_firmware_versions_t));
+    version->depth_major = 1;
+    version->depth_minor = 6;
+    version->depth_build = 110;
+    return K4A_RESULT_SUCCEEDED;
+}
+
 TEST(calibration_ut, api_validation)
 {
     calibration_t calibration;
@@ -347,6 +386,57 @@ TEST(calibration_ut, validate_raw_data_api)
     free(json);
 }
 
+TEST(calibration_ut, calibration_cache)
+{
+    calibration_t calibration;
+    k4a_calibration_camera_t reference_depth;
+    k4a_calibration_imu_t reference_accel;
+
+    ASSERT_EQ(calibration_create(FAKE_MCU, &calibration), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(calibration_get_camera(calibration, K4A_CALIBRATION_TYPE_DEPTH, &reference_depth), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(calibration_get_imu(calibration, K4A_CALIBRATION_TYPE_ACCEL, &reference_accel), K4A_RESULT_SUCCEEDED);
+    calibration_destroy(calibration);
+
+    // The first create reads the calibration from the device and saves it, the second loads it from the cache
+    const std::string cache_directory = "calibration_cache";
+    ASSERT_EQ(system(std::string(MKDIR(cache_directory)).c_str()), 0);
+    ASSERT_EQ(SETENV("K4A_CALIBRATION_CACHE", cache_directory.c_str()), 0);
+    for (int i = 0; i < 2; i++)
+    {
+        g_extrinsic_calibration_reads = 0;
+        ASSERT_EQ(calibration_create(FAKE_MCU, &calibration), K4A_RESULT_SUCCEEDED);
+        ASSERT_EQ(g_extrinsic_calibration_reads, i == 0 ? 1 : 0);
+
+        k4a_calibration_camera_t depth;
+        k4a_calibration_imu_t accel;
+        ASSERT_EQ(calibration_get_camera(calibration, K4A_CALIBRATION_TYPE_DEPTH, &depth), K4A_RESULT_SUCCEEDED);
+        ASSERT_EQ(calibration_get_imu(calibration, K4A_CALIBRATION_TYPE_ACCEL, &accel), K4A_RESULT_SUCCEEDED);
+        ASSERT_EQ(memcmp(&depth, &reference_depth, sizeof(depth)), 0);
+        ASSERT_EQ(memcmp(&accel, &reference_accel, sizeof(accel)), 0);
+
+        size_t raw_size = 0;
+        ASSERT_EQ(calibration_get_raw_data(calibration, NULL, &raw_size), K4A_BUFFER_RESULT_TOO_SMALL);
+        ASSERT_EQ(raw_size, sizeof(g_test_json));
+        calibration_destroy(calibration);
+    }
+
+    // A corrupted cache file is ignored and replaced
+    const std::string cache_file = cache_directory + "/k4a_calibration_000123456789.bin";
+    FILE *file = fopen(cache_file.c_str(), "r+b");
+    ASSERT_NE(file, (FILE *)NULL);
+    ASSERT_EQ(fseek(file, -1, SEEK_END), 0);
+    ASSERT_EQ(fputc(0x5A, file), 0x5A);
+    ASSERT_EQ(fclose(file), 0);
+
+    g_extrinsic_calibration_reads = 0;
+    ASSERT_EQ(calibration_create(FAKE_MCU, &calibration), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(g_extrinsic_calibration_reads, 1);
+    calibration_destroy(calibration);
+
+    ASSERT_EQ(SETENV("K4A_CALIBRATION_CACHE", ""), 0);
+    ASSERT_EQ(system(std::string(RMDIR(cache_directory)).c_str()), 0);
+}
+
 int main(int argc, char **argv)
 {
     return k4a_test_common_main(argc, argv);
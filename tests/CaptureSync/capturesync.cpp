@@ -11,6 +11,8 @@
 #include <azure_c_shared_utility/threadapi.h>
 #include <azure_c_shared_utility/condition.h>
 
+#include <atomic>
+
 // This wait is effectively an infinite wait, setting to 5 min will prevent the test from blocking indefinately in the
 // event the test regresses.
 #define WAIT_TEST_INFINITE (5 * 60 * 1000)
@@ -50,13 +52,14 @@ TEST(capturesync_ut, capturesync)
     config.camera_fps = K4A_FRAMES_PER_SECOND_5;
 
     ASSERT_EQ(capturesync_create(&sync), K4A_RESULT_SUCCEEDED);
-    ASSERT_EQ(capturesync_start(NULL, NULL), K4A_RESULT_FAILED);
-    ASSERT_EQ(capturesync_start(sync, NULL), K4A_RESULT_FAILED);
-    ASSERT_EQ(capturesync_start(NULL, &config), K4A_RESULT_FAILED);
-    ASSERT_EQ(capturesync_start(sync, &config), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(capturesync_start(NULL, NULL, NULL), K4A_RESULT_FAILED);
+    ASSERT_EQ(capturesync_start(sync, NULL, &K4A_DEVICE_START_OPTIONS_INIT), K4A_RESULT_FAILED);
+    ASSERT_EQ(capturesync_start(sync, &config, NULL), K4A_RESULT_FAILED);
+    ASSERT_EQ(capturesync_start(NULL, &config, &K4A_DEVICE_START_OPTIONS_INIT), K4A_RESULT_FAILED);
+    ASSERT_EQ(capturesync_start(sync, &config, &K4A_DEVICE_START_OPTIONS_INIT), K4A_RESULT_SUCCEEDED);
     // 2nd time should pass - public API does not allow start to be called twice, but internally we don't need to push
     // that requirement on each sub module
-    ASSERT_EQ(capturesync_start(sync, &config), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(capturesync_start(sync, &config, &K4A_DEVICE_START_OPTIONS_INIT), K4A_RESULT_SUCCEEDED);
 
     capturesync_stop(NULL);
     capturesync_stop(sync);
@@ -66,7 +69,7 @@ TEST(capturesync_ut, capturesync)
     // This should fail because we are in a stopped state.
     ASSERT_EQ(capturesync_get_capture(sync, &capture, 0), K4A_WAIT_RESULT_FAILED);
 
-    ASSERT_EQ(capturesync_start(sync, &config), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(capturesync_start(sync, &config, &K4A_DEVICE_START_OPTIONS_INIT), K4A_RESULT_SUCCEEDED);
     // This should timeout because we are in a running state and there is no data
     ASSERT_EQ(capturesync_get_capture(sync, &capture, 0), K4A_WAIT_RESULT_TIMEOUT);
 
@@ -415,6 +418,11 @@ capturesync_push_single_capture(k4a_result_t status, capturesync_t sync, bool co
     if (K4A_SUCCEEDED(result))
     {
         image_set_device_timestamp_usec(image, timestamp);
+        result = TRACE_CALL(image_apply_system_timestamp(image));
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
         if (color_capture)
         {
             capture_set_color_image(capture, image);
@@ -536,7 +544,7 @@ static void capturesync_validate_synchronization(capturesync_test_timing_t *test
         config.depth_delay_off_color_usec = -1;
     }
 
-    ASSERT_EQ(capturesync_start(sync, &config), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(capturesync_start(sync, &config, &K4A_DEVICE_START_OPTIONS_INIT), K4A_RESULT_SUCCEEDED);
 
     // prevent the threads from running yet
     Lock(depth_test.lock);
@@ -702,6 +710,409 @@ static capturesync_test_timing_t *invert_test_data_for_depth_first(capturesync_t
     return copy;
 }
 
+TEST(capturesync_ut, latency_histogram)
+{
+    capturesync_t sync;
+    k4a_capture_t capture;
+    capturesync_latency_histogram_t histogram;
+    k4a_device_configuration_t config = K4A_DEVICE_CONFIG_INIT_DISABLE_ALL;
+
+    config.color_format = K4A_IMAGE_FORMAT_COLOR_MJPG;
+    config.color_resolution = K4A_COLOR_RESOLUTION_1080P;
+    config.depth_mode = K4A_DEPTH_MODE_NFOV_2X2BINNED;
+    config.camera_fps = K4A_FRAMES_PER_SECOND_30;
+
+    ASSERT_EQ(capturesync_create(&sync), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(capturesync_get_latency_histogram(NULL, &histogram), K4A_RESULT_FAILED);
+    ASSERT_EQ(capturesync_get_latency_histogram(sync, NULL), K4A_RESULT_FAILED);
+    ASSERT_EQ(capturesync_start(sync, &config, &K4A_DEVICE_START_OPTIONS_INIT), K4A_RESULT_SUCCEEDED);
+
+    // Every arrival is counted, matched or not
+    const uint32_t arrivals = 10;
+    for (uint32_t i = 0; i < arrivals / 2; i++)
+    {
+        ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+                  capturesync_push_single_capture(K4A_RESULT_SUCCEEDED, sync, COLOR_CAPTURE, FPS_30_US(i, 0)));
+        ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+                  capturesync_push_single_capture(K4A_RESULT_SUCCEEDED, sync, DEPTH_CAPTURE, FPS_30_US(i, 0)));
+        ASSERT_EQ(capturesync_get_capture(sync, &capture, WAIT_TEST_INFINITE), (int)K4A_WAIT_RESULT_SUCCEEDED);
+        capture_dec_ref(capture);
+    }
+
+    ASSERT_EQ(capturesync_get_latency_histogram(sync, &histogram), K4A_RESULT_SUCCEEDED);
+    uint32_t total = 0;
+    for (int i = 0; i < CAPTURESYNC_LATENCY_BUCKETS; i++)
+    {
+        total += histogram.count[i];
+    }
+    ASSERT_EQ(total, arrivals);
+
+    capturesync_stop(sync);
+    capturesync_destroy(sync);
+    ASSERT_EQ(0, allocator_test_for_leaks());
+}
+
+TEST(capturesync_ut, dropped_counts)
+{
+    capturesync_t sync;
+    uint32_t sync_dropped = 0;
+    uint32_t queue_dropped = 0;
+    k4a_device_configuration_t config = K4A_DEVICE_CONFIG_INIT_DISABLE_ALL;
+
+    config.color_format = K4A_IMAGE_FORMAT_COLOR_MJPG;
+    config.color_resolution = K4A_COLOR_RESOLUTION_1080P;
+    config.depth_mode = K4A_DEPTH_MODE_NFOV_2X2BINNED;
+    config.camera_fps = K4A_FRAMES_PER_SECOND_30;
+    config.synchronized_images_only = true;
+
+    ASSERT_EQ(capturesync_create(&sync), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(capturesync_get_dropped_counts(NULL, &sync_dropped, &queue_dropped), K4A_RESULT_FAILED);
+    ASSERT_EQ(capturesync_get_dropped_counts(sync, NULL, &queue_dropped), K4A_RESULT_FAILED);
+    ASSERT_EQ(capturesync_get_dropped_counts(sync, &sync_dropped, NULL), K4A_RESULT_FAILED);
+    ASSERT_EQ(capturesync_start(sync, &config, &K4A_DEVICE_START_OPTIONS_INIT), K4A_RESULT_SUCCEEDED);
+
+    // Color captures without a depth capture to pair with are dropped while synchronizing
+    for (uint32_t i = 0; i <= 10; i++)
+    {
+        ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+                  capturesync_push_single_capture(K4A_RESULT_SUCCEEDED, sync, COLOR_CAPTURE, FPS_30_US(i, 0)));
+        if (i == 0 || i == 10)
+        {
+            ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+                      capturesync_push_single_capture(K4A_RESULT_SUCCEEDED, sync, DEPTH_CAPTURE, FPS_30_US(i, 0)));
+        }
+    }
+    ASSERT_EQ(capturesync_get_dropped_counts(sync, &sync_dropped, &queue_dropped), K4A_RESULT_SUCCEEDED);
+    ASSERT_GT(sync_dropped, 0u);
+    ASSERT_EQ(queue_dropped, 0u);
+
+    // Pairs nobody reads overflow the capture queue
+    for (uint32_t i = 11; i < 100; i++)
+    {
+        ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+                  capturesync_push_single_capture(K4A_RESULT_SUCCEEDED, sync, COLOR_CAPTURE, FPS_30_US(i, 0)));
+        ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+                  capturesync_push_single_capture(K4A_RESULT_SUCCEEDED, sync, DEPTH_CAPTURE, FPS_30_US(i, 0)));
+    }
+    ASSERT_EQ(capturesync_get_dropped_counts(sync, &sync_dropped, &queue_dropped), K4A_RESULT_SUCCEEDED);
+    ASSERT_GT(queue_dropped, 0u);
+
+    capturesync_stop(sync);
+    capturesync_destroy(sync);
+    ASSERT_EQ(0, allocator_test_for_leaks());
+}
+
+typedef struct _capture_callback_test_t
+{
+    uint32_t count;
+    uint64_t last_color_ts;
+    k4a_capture_t kept;
+} capture_callback_test_t;
+
+static void capture_callback_test_cb(k4a_capture_t capture_handle, void *context)
+{
+    capture_callback_test_t *test = (capture_callback_test_t *)context;
+    k4a_image_t color = capture_get_color_image(capture_handle);
+    if (color != NULL)
+    {
+        test->last_color_ts = image_get_device_timestamp_usec(color);
+        image_dec_ref(color);
+    }
+
+    // The capture is borrowed, keep the first one to check a ref can be taken
+    if (test->count++ == 0)
+    {
+        capture_inc_ref(capture_handle);
+        test->kept = capture_handle;
+    }
+}
+
+TEST(capturesync_ut, statistics)
+{
+    capturesync_t sync;
+    k4a_capture_t capture;
+    k4a_device_statistics_t statistics = { 0 };
+    k4a_device_configuration_t config = K4A_DEVICE_CONFIG_INIT_DISABLE_ALL;
+
+    config.color_format = K4A_IMAGE_FORMAT_COLOR_MJPG;
+    config.color_resolution = K4A_COLOR_RESOLUTION_1080P;
+    config.depth_mode = K4A_DEPTH_MODE_NFOV_2X2BINNED;
+    config.camera_fps = K4A_FRAMES_PER_SECOND_30;
+
+    ASSERT_EQ(capturesync_create(&sync), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(capturesync_get_statistics(NULL, &statistics), K4A_RESULT_FAILED);
+    ASSERT_EQ(capturesync_get_statistics(sync, NULL), K4A_RESULT_FAILED);
+
+    // Nothing is reported before the first capture
+    ASSERT_EQ(capturesync_get_statistics(sync, &statistics), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(statistics.delivered_capture_count, 0u);
+    ASSERT_EQ(statistics.capture_latency_min_usec, 0u);
+    ASSERT_EQ(statistics.capture_latency_max_usec, 0u);
+
+    ASSERT_EQ(capturesync_start(sync, &config, &K4A_DEVICE_START_OPTIONS_INIT), K4A_RESULT_SUCCEEDED);
+    const uint32_t pairs = 5;
+    for (uint32_t i = 0; i < pairs; i++)
+    {
+        ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+                  capturesync_push_single_capture(K4A_RESULT_SUCCEEDED, sync, COLOR_CAPTURE, FPS_30_US(i, 0)));
+        ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+                  capturesync_push_single_capture(K4A_RESULT_SUCCEEDED, sync, DEPTH_CAPTURE, FPS_30_US(i, 0)));
+        ASSERT_EQ(capturesync_get_capture(sync, &capture, WAIT_TEST_INFINITE), (int)K4A_WAIT_RESULT_SUCCEEDED);
+        capture_dec_ref(capture);
+    }
+
+    ASSERT_EQ(capturesync_get_statistics(sync, &statistics), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(statistics.depth_capture_count, pairs);
+    ASSERT_EQ(statistics.color_capture_count, pairs);
+    ASSERT_EQ(statistics.synchronized_capture_count, pairs);
+    ASSERT_EQ(statistics.delivered_capture_count, pairs);
+    ASSERT_EQ(statistics.capturesync_dropped_count, 0u);
+    ASSERT_EQ(statistics.capture_queue_dropped_count, 0u);
+
+    uint32_t total = 0;
+    for (int i = 0; i < K4A_DEVICE_STATISTICS_LATENCY_BUCKETS; i++)
+    {
+        total += statistics.capture_latency_histogram[i];
+    }
+    ASSERT_EQ(total, pairs);
+    ASSERT_LE(statistics.capture_latency_min_usec, statistics.capture_latency_average_usec);
+    ASSERT_LE(statistics.capture_latency_average_usec, statistics.capture_latency_max_usec);
+
+    capturesync_stop(sync);
+    capturesync_destroy(sync);
+    ASSERT_EQ(0, allocator_test_for_leaks());
+}
+
+TEST(capturesync_ut, capture_callback)
+{
+    capturesync_t sync;
+    k4a_capture_t capture;
+    capture_callback_test_t test = { 0 };
+    k4a_device_configuration_t config = K4A_DEVICE_CONFIG_INIT_DISABLE_ALL;
+
+    config.color_format = K4A_IMAGE_FORMAT_COLOR_MJPG;
+    config.color_resolution = K4A_COLOR_RESOLUTION_1080P;
+    config.depth_mode = K4A_DEPTH_MODE_NFOV_2X2BINNED;
+    config.camera_fps = K4A_FRAMES_PER_SECOND_30;
+
+    ASSERT_EQ(capturesync_create(&sync), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(capturesync_set_callback(NULL, capture_callback_test_cb, &test), K4A_RESULT_FAILED);
+    ASSERT_EQ(capturesync_set_callback(sync, capture_callback_test_cb, &test), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(capturesync_start(sync, &config, &K4A_DEVICE_START_OPTIONS_INIT), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(capturesync_set_callback(sync, NULL, NULL), K4A_RESULT_FAILED);
+
+    const uint32_t pairs = 5;
+    for (uint32_t i = 0; i < pairs; i++)
+    {
+        ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+                  capturesync_push_single_capture(K4A_RESULT_SUCCEEDED, sync, COLOR_CAPTURE, FPS_30_US(i, 0)));
+        ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+                  capturesync_push_single_capture(K4A_RESULT_SUCCEEDED, sync, DEPTH_CAPTURE, FPS_30_US(i, 0)));
+    }
+
+    // Captures were delivered in order on the pushing thread, and bypassed the queue
+    uint32_t last = test.count - 1;
+    ASSERT_GE(test.count, pairs - 1);
+    ASSERT_EQ(test.last_color_ts, (uint64_t)FPS_30_US(last, 0));
+    ASSERT_EQ(capturesync_get_capture(sync, &capture, 0), K4A_WAIT_RESULT_TIMEOUT);
+    ASSERT_NE(test.kept, (k4a_capture_t)NULL);
+    capture_dec_ref(test.kept);
+
+    capturesync_stop(sync);
+    ASSERT_EQ(capturesync_set_callback(sync, NULL, NULL), K4A_RESULT_SUCCEEDED);
+    capturesync_destroy(sync);
+    ASSERT_EQ(0, allocator_test_for_leaks());
+}
+
+typedef struct _capturesync_restart_test_t
+{
+    capturesync_t sync;
+    std::atomic<bool> stop;
+    std::atomic<uint32_t> pushed;
+} capturesync_restart_test_t;
+
+static int capturesync_restart_push_thread(void *param)
+{
+    capturesync_restart_test_t *test = (capturesync_restart_test_t *)param;
+    for (uint32_t i = 0; !test->stop; i++)
+    {
+        // Pushes fail while the sync is briefly in between starts, which is fine here
+        capturesync_push_single_capture(K4A_RESULT_SUCCEEDED, test->sync, COLOR_CAPTURE, FPS_30_US((uint64_t)i, 0));
+        capturesync_push_single_capture(K4A_RESULT_SUCCEEDED, test->sync, DEPTH_CAPTURE, FPS_30_US((uint64_t)i, 0));
+        test->pushed = i + 1;
+    }
+    return 0;
+}
+
+TEST(capturesync_ut, restart_while_streaming)
+{
+    capturesync_restart_test_t test;
+    test.sync = NULL;
+    test.stop = false;
+    test.pushed = 0;
+    THREAD_HANDLE thread = NULL;
+    k4a_capture_t capture;
+    k4a_device_configuration_t config = K4A_DEVICE_CONFIG_INIT_DISABLE_ALL;
+
+    config.color_format = K4A_IMAGE_FORMAT_COLOR_MJPG;
+    config.color_resolution = K4A_COLOR_RESOLUTION_1080P;
+    config.depth_mode = K4A_DEPTH_MODE_NFOV_2X2BINNED;
+    config.camera_fps = K4A_FRAMES_PER_SECOND_30;
+
+    ASSERT_EQ(capturesync_create(&test.sync), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(capturesync_start(test.sync, &config, &K4A_DEVICE_START_OPTIONS_INIT), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(THREADAPI_OK, ThreadAPI_Create(&thread, capturesync_restart_push_thread, &test));
+
+    // k4a_device_set_depth_mode() starts the running sync again, with the callbacks still delivering captures
+    for (uint32_t i = 0; test.pushed < 2000; i++)
+    {
+        config.depth_mode = (i % 2) ? K4A_DEPTH_MODE_WFOV_2X2BINNED : K4A_DEPTH_MODE_NFOV_2X2BINNED;
+        config.camera_fps = (i % 2) ? K4A_FRAMES_PER_SECOND_15 : K4A_FRAMES_PER_SECOND_30;
+        ASSERT_EQ(capturesync_start(test.sync, &config, &K4A_DEVICE_START_OPTIONS_INIT), K4A_RESULT_SUCCEEDED);
+        while (capturesync_get_capture(test.sync, &capture, 0) == K4A_WAIT_RESULT_SUCCEEDED)
+        {
+            capture_dec_ref(capture);
+        }
+    }
+
+    test.stop = true;
+    int thread_result;
+    ASSERT_EQ(THREADAPI_OK, ThreadAPI_Join(thread, &thread_result));
+
+    capturesync_stop(test.sync);
+    capturesync_destroy(test.sync);
+    ASSERT_EQ(0, allocator_test_for_leaks());
+}
+
+static void capturesync_add_imu_samples_at(capturesync_t sync, uint64_t start_usec, uint32_t count)
+{
+    k4a_imu_sample_t samples[8] = { 0 };
+    for (uint32_t i = 0; i < count; i++)
+    {
+        samples[i].acc_timestamp_usec = start_usec + i * 1000;
+        samples[i].gyro_timestamp_usec = samples[i].acc_timestamp_usec;
+    }
+    capturesync_add_imu_samples(sync, samples, count);
+}
+
+TEST(capturesync_ut, attach_imu_samples)
+{
+    capturesync_t sync;
+    k4a_capture_t capture;
+    k4a_device_configuration_t config = K4A_DEVICE_CONFIG_INIT_DISABLE_ALL;
+
+    config.color_format = K4A_IMAGE_FORMAT_COLOR_MJPG;
+    config.color_resolution = K4A_COLOR_RESOLUTION_1080P;
+    config.depth_mode = K4A_DEPTH_MODE_NFOV_2X2BINNED;
+    config.camera_fps = K4A_FRAMES_PER_SECOND_30;
+
+    k4a_device_start_options_t options = K4A_DEVICE_START_OPTIONS_INIT;
+    options.attach_imu_samples = true;
+
+    ASSERT_EQ(capturesync_create(&sync), K4A_RESULT_SUCCEEDED);
+
+    // Samples are ignored until started
+    capturesync_add_imu_samples_at(sync, 0, 8);
+    ASSERT_EQ(capturesync_start(sync, &config, &options), K4A_RESULT_SUCCEEDED);
+
+    // 8 samples from 1ms before the first frame to 6ms after it, then 8 more along the second frame
+    capturesync_add_imu_samples_at(sync, FPS_30_US(1, 0) - 1000, 8);
+    for (uint32_t i = 1; i < 4; i++)
+    {
+        ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+                  capturesync_push_single_capture(K4A_RESULT_SUCCEEDED, sync, COLOR_CAPTURE, FPS_30_US(i, 0)));
+        ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+                  capturesync_push_single_capture(K4A_RESULT_SUCCEEDED, sync, DEPTH_CAPTURE, FPS_30_US(i, 0)));
+        if (i == 1)
+        {
+            capturesync_add_imu_samples_at(sync, FPS_30_US(2, 0) - 1000, 8);
+        }
+    }
+
+    // The first capture gets the samples up to its timestamp, the second the ones after until its own
+    uint32_t expected_counts[] = { 2, 8 };
+    uint64_t expected_first_usec[] = { (uint64_t)FPS_30_US(1, 0) - 1000, (uint64_t)FPS_30_US(1, 0) + 1000 };
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        ASSERT_EQ(capturesync_get_capture(sync, &capture, WAIT_TEST_INFINITE), (int)K4A_WAIT_RESULT_SUCCEEDED);
+        k4a_image_t image = capture_get_imu_samples_image(capture);
+        ASSERT_NE(image, (k4a_image_t)NULL);
+        ASSERT_EQ(image_get_format(image), K4A_IMAGE_FORMAT_CUSTOM);
+        ASSERT_EQ(image_get_width_pixels(image), (int)expected_counts[i]);
+        ASSERT_EQ(image_get_size(image), expected_counts[i] * sizeof(k4a_imu_sample_t));
+        uint32_t capture_num = i + 1;
+        ASSERT_EQ(image_get_device_timestamp_usec(image), (uint64_t)FPS_30_US(capture_num, 0));
+        const k4a_imu_sample_t *samples = (const k4a_imu_sample_t *)image_get_buffer(image);
+        ASSERT_EQ(samples[0].acc_timestamp_usec, expected_first_usec[i]);
+        image_dec_ref(image);
+        capture_dec_ref(capture);
+    }
+
+    capturesync_stop(sync);
+    capturesync_destroy(sync);
+    ASSERT_EQ(0, allocator_test_for_leaks());
+}
+
+// Push two depth captures that are both within the sync window of the color capture that follows, and return the
+// timestamp of the depth image it gets paired with
+static uint64_t capturesync_pair_from_window(uint32_t window)
+{
+    capturesync_t sync;
+    k4a_capture_t capture;
+    uint64_t ts_depth = 0;
+    k4a_device_configuration_t config = K4A_DEVICE_CONFIG_INIT_DISABLE_ALL;
+
+    config.color_format = K4A_IMAGE_FORMAT_COLOR_MJPG;
+    config.color_resolution = K4A_COLOR_RESOLUTION_720P;
+    config.depth_mode = K4A_DEPTH_MODE_WFOV_2X2BINNED;
+    config.camera_fps = K4A_FRAMES_PER_SECOND_30;
+    config.depth_delay_off_color_usec = 1;
+
+    EXPECT_EQ(capturesync_create(&sync), K4A_RESULT_SUCCEEDED);
+    EXPECT_EQ(capturesync_set_window(sync, window, window), K4A_RESULT_SUCCEEDED);
+    EXPECT_EQ(capturesync_start(sync, &config, &K4A_DEVICE_START_OPTIONS_INIT), K4A_RESULT_SUCCEEDED);
+    EXPECT_EQ(capturesync_set_window(sync, window, window), K4A_RESULT_FAILED);
+
+    EXPECT_EQ(K4A_RESULT_SUCCEEDED,
+              capturesync_push_single_capture(K4A_RESULT_SUCCEEDED, sync, DEPTH_CAPTURE, FPS_30_US(1, -20)));
+    EXPECT_EQ(K4A_RESULT_SUCCEEDED,
+              capturesync_push_single_capture(K4A_RESULT_SUCCEEDED, sync, DEPTH_CAPTURE, FPS_30_US(1, 5)));
+    EXPECT_EQ(K4A_RESULT_SUCCEEDED,
+              capturesync_push_single_capture(K4A_RESULT_SUCCEEDED, sync, COLOR_CAPTURE, FPS_30_US(1, 0)));
+
+    // Skip the depth capture that was published on its own
+    while (ts_depth == 0 && capturesync_get_capture(sync, &capture, 0) == K4A_WAIT_RESULT_SUCCEEDED)
+    {
+        k4a_image_t color = capture_get_color_image(capture);
+        k4a_image_t depth = capture_get_depth_image(capture);
+        if (color != NULL && depth != NULL)
+        {
+            ts_depth = image_get_device_timestamp_usec(depth);
+        }
+        if (color)
+        {
+            image_dec_ref(color);
+        }
+        if (depth)
+        {
+            image_dec_ref(depth);
+        }
+        capture_dec_ref(capture);
+    }
+
+    capturesync_stop(sync);
+    capturesync_destroy(sync);
+    EXPECT_EQ(0, allocator_test_for_leaks());
+    return ts_depth;
+}
+
+TEST(capturesync_ut, best_match_from_window)
+{
+    // With a window of 1 the oldest capture within the sync window is used, with 2 the closer one is
+    ASSERT_EQ(capturesync_pair_from_window(1), (uint64_t)FPS_30_US(1, -20));
+    ASSERT_EQ(capturesync_pair_from_window(2), (uint64_t)FPS_30_US(1, 5));
+}
+
 TEST(capturesync_ut, test_c_Drop1Sample)
 {
     capturesync_validate_synchronization(Drop1Sample, COLOR_FIRST);
@@ -170,7 +170,7 @@ TEST_F(color_ut, streaming)
     config.depth_mode = K4A_DEPTH_MODE_OFF;
 
     // test color_start()
-    ASSERT_EQ(K4A_RESULT_SUCCEEDED, color_start(color_handle, &config));
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, color_start(color_handle, &config, &K4A_DEVICE_START_OPTIONS_INIT));
 
     color_destroy(color_handle);
     tickcounter_destroy(tick);
@@ -211,7 +211,7 @@ TEST_F(color_ut, exposure_control)
     ASSERT_EQ(value, 500);
 
     // test color_start()
-    ASSERT_EQ(K4A_RESULT_SUCCEEDED, color_start(color_handle, &config));
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, color_start(color_handle, &config, &K4A_DEVICE_START_OPTIONS_INIT));
 
     // test color_stop()
     color_stop(color_handle);
@@ -219,6 +219,45 @@ TEST_F(color_ut, exposure_control)
     tickcounter_destroy(tick);
 }
 
+#ifndef _WIN32
+TEST_F(color_ut, control_value_cache)
+{
+    color_t color_handle = NULL;
+    k4a_color_control_mode_t control_mode;
+    int32_t value;
+    TICK_COUNTER_HANDLE tick;
+
+    ASSERT_NE((TICK_COUNTER_HANDLE)0, (tick = tickcounter_create()));
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+              color_create(tick, &guid_FakeGoodContainerId, str_FakeGoodSerialNumber, NULL, NULL, &color_handle));
+
+    // The set reads the value back from the mocked device
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+              color_set_control(color_handle, K4A_COLOR_CONTROL_BRIGHTNESS, K4A_COLOR_CONTROL_MODE_MANUAL, 100));
+
+    // After the set only the refresh may reach the device
+    EXPECT_CALL(m_mockLibUVC, uvc_get_brightness(_, _, UVC_GET_CUR))
+        .Times(1)
+        .WillOnce(DoAll(SetArgPointee<1>((int16_t)50), Return(UVC_SUCCESS)));
+
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+              color_get_control(color_handle, K4A_COLOR_CONTROL_BRIGHTNESS, &control_mode, &value));
+    ASSERT_EQ(control_mode, K4A_COLOR_CONTROL_MODE_MANUAL);
+    ASSERT_EQ(value, 100);
+
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+              color_refresh_control(color_handle, K4A_COLOR_CONTROL_BRIGHTNESS, &control_mode, &value));
+    ASSERT_EQ(value, 50);
+
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+              color_get_control(color_handle, K4A_COLOR_CONTROL_BRIGHTNESS, &control_mode, &value));
+    ASSERT_EQ(value, 50);
+
+    color_destroy(color_handle);
+    tickcounter_destroy(tick);
+}
+#endif // !_WIN32
+
 int main(int argc, char **argv)
 {
     return k4a_test_common_main(argc, argv);
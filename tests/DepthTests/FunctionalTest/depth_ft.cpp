@@ -543,6 +543,49 @@ TEST_F(depth_ft, depthModeChange)
     k4a_device_stop_cameras(m_device);
 }
 
+TEST_F(depth_ft, depthModeHotSwitch)
+{
+    int32_t timeout_ms = ERROR_START_STREAM_TIME;
+    k4a_device_configuration_t config = K4A_DEVICE_CONFIG_INIT_DISABLE_ALL;
+    k4a_capture_t depth_capture;
+    k4a_image_t image;
+    const size_t switched_expected_capture_size = K4A_DEPTH_MODE_NFOV_2X2BINNED_EXPECTED_SIZE;
+
+    config.color_format = K4A_IMAGE_FORMAT_COLOR_MJPG;
+    config.color_resolution = K4A_COLOR_RESOLUTION_OFF;
+    config.depth_mode = K4A_DEPTH_MODE_NFOV_UNBINNED;
+    config.camera_fps = K4A_FRAMES_PER_SECOND_15;
+
+    // Switching requires running cameras
+    //
+    ASSERT_EQ(K4A_RESULT_FAILED,
+              k4a_device_set_depth_mode(m_device, K4A_DEPTH_MODE_NFOV_2X2BINNED, K4A_FRAMES_PER_SECOND_15));
+
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, k4a_device_start_cameras(m_device, &config));
+    ASSERT_EQ(K4A_WAIT_RESULT_SUCCEEDED, k4a_device_get_capture(m_device, &depth_capture, timeout_ms));
+    k4a_capture_release(depth_capture);
+
+    EXPECT_EQ(K4A_RESULT_FAILED, k4a_device_set_depth_mode(m_device, K4A_DEPTH_MODE_OFF, K4A_FRAMES_PER_SECOND_15));
+
+    // Switch the mode and the frame rate without stopping, captures queued before the switch are skipped
+    //
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+              k4a_device_set_depth_mode(m_device, K4A_DEPTH_MODE_NFOV_2X2BINNED, K4A_FRAMES_PER_SECOND_30));
+
+    size_t ir_size = 0;
+    for (int i = 0; i < 10 && ir_size != switched_expected_capture_size; i++)
+    {
+        ASSERT_EQ(K4A_WAIT_RESULT_SUCCEEDED, k4a_device_get_capture(m_device, &depth_capture, timeout_ms));
+        ASSERT_NE(image = k4a_capture_get_ir_image(depth_capture), (k4a_image_t)NULL);
+        ir_size = k4a_image_get_size(image);
+        k4a_image_release(image);
+        k4a_capture_release(depth_capture);
+    }
+    EXPECT_EQ(switched_expected_capture_size, ir_size);
+
+    k4a_device_stop_cameras(m_device);
+}
+
 int main(int argc, char **argv)
 {
     return k4a_test_common_main(argc, argv);
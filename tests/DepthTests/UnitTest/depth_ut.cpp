@@ -200,11 +200,13 @@ void dewrapper_destroy(dewrapper_t dewrapper_handle)
 }
 k4a_result_t dewrapper_start(dewrapper_t dewrapper_handle,
                              const k4a_device_configuration_t *config,
+                             const k4a_device_start_options_t *options,
                              uint8_t *calibration_memory,
                              size_t calibration_memory_size)
 {
     (void)dewrapper_handle;
     (void)config;
+    (void)options;
     (void)calibration_memory;
     (void)calibration_memory_size;
     return K4A_RESULT_SUCCEEDED;
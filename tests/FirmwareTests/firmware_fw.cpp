@@ -333,3 +333,45 @@ TEST_F(firmware_fw, simple_update_from_factory)
 
     ASSERT_EQ(K4A_RESULT_SUCCEEDED, open_firmware_device(&firmware_handle));
 }
+
+TEST_F(firmware_fw, update_devices)
+{
+    LOG_INFO("Beginning the update test through firmware_update_devices.", 0);
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, connect_device());
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, read_calibration(&calibration_pre_update, &calibration_pre_update_size));
+
+    depthmcu_t depth_handle = nullptr;
+    char *serial_number = nullptr;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, TRACE_CALL(depthmcu_create(K4A_DEVICE_DEFAULT, &depth_handle)));
+    k4a_result_t result = firmware_get_serial_number(nullptr, depth_handle, &serial_number);
+    depthmcu_destroy(depth_handle);
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, result);
+
+    firmware_update_device_t device = {};
+    device.serial_number = serial_number;
+
+    for (const firmware_package_info_t *package_info :
+         { &g_candidate_firmware_package_info, &g_test_firmware_package_info })
+    {
+        printf("\n == Updating the device to firmware %d.%d.%d.\n",
+               package_info->depth.major,
+               package_info->depth.minor,
+               package_info->depth.iteration);
+        result = firmware_update_devices(package_info, &device, 1, nullptr, nullptr);
+        if (K4A_FAILED(result))
+        {
+            break;
+        }
+
+        EXPECT_EQ(FIRMWARE_UPDATE_STAGE_COMPLETE, device.stage);
+        EXPECT_TRUE(device.updated_version_valid);
+        EXPECT_TRUE(compare_version(package_info->audio, device.updated_version.audio));
+        EXPECT_TRUE(compare_version(package_info->depth, device.updated_version.depth));
+        EXPECT_TRUE(compare_version(package_info->rgb, device.updated_version.rgb));
+    }
+    firmware_free_serial_number(serial_number);
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, result);
+
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, read_calibration(&calibration_post_update, &calibration_post_update_size));
+    ASSERT_TRUE(compare_calibration());
+}
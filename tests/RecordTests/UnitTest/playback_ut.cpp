@@ -7,15 +7,26 @@
 #include <k4ainternal/matroska_common.h>
 
 #include "test_helpers.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
 #include <thread>
+#include <mutex>
 #include <chrono>
 
 // Module being tested
 #include <k4arecord/playback.h>
+#include <k4arecord/record.h>
 
 using namespace testing;
 
+#ifdef _WIN32
+#define SETENV(env, value) _putenv_s(env, value)
+#else
+#define SETENV(env, value) setenv(env, value, 1)
+#endif
+
 class playback_ut : public ::testing::Test
 {
 protected:
@@ -524,6 +535,414 @@ TEST_F(playback_ut, playback_seek_test)
     k4a_playback_close(handle);
 }
 
+TEST_F(playback_ut, playback_read_ahead)
+{
+    k4a_playback_t handle = NULL;
+    k4a_result_t result = k4a_playback_open("record_test_full.mkv", &handle);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+    k4a_record_configuration_t config;
+    result = k4a_playback_get_record_configuration(handle, &config);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+    uint64_t timestamp_delta = HZ_TO_PERIOD_US(k4a_convert_fps_to_uint(config.camera_fps));
+
+    ASSERT_EQ(k4a_playback_set_read_ahead(handle, 33), K4A_RESULT_FAILED);
+
+    // Every count reads the same captures in both directions, including when it changes mid-playback
+    uint32_t read_ahead_counts[] = { 0, 1, 8, 32, 2 };
+    for (uint32_t read_ahead_count : read_ahead_counts)
+    {
+        ASSERT_EQ(k4a_playback_set_read_ahead(handle, read_ahead_count), K4A_RESULT_SUCCEEDED);
+        ASSERT_EQ(k4a_playback_seek_timestamp(handle, 0, K4A_PLAYBACK_SEEK_BEGIN), K4A_RESULT_SUCCEEDED);
+
+        uint64_t timestamps[3] = { 0, 1000, 1000 };
+        k4a_capture_t capture = NULL;
+        for (size_t i = 0; i < test_frame_count; i++)
+        {
+            ASSERT_EQ(k4a_playback_get_next_capture(handle, &capture), K4A_STREAM_RESULT_SUCCEEDED);
+            ASSERT_TRUE(validate_test_capture(
+                capture, timestamps, config.color_format, config.color_resolution, config.depth_mode));
+            k4a_capture_release(capture);
+            timestamps[0] += timestamp_delta;
+            timestamps[1] += timestamp_delta;
+            timestamps[2] += timestamp_delta;
+        }
+        ASSERT_EQ(k4a_playback_get_next_capture(handle, &capture), K4A_STREAM_RESULT_EOF);
+
+        ASSERT_EQ(k4a_playback_seek_timestamp(handle, 0, K4A_PLAYBACK_SEEK_END), K4A_RESULT_SUCCEEDED);
+        for (size_t i = 0; i < test_frame_count; i++)
+        {
+            timestamps[0] -= timestamp_delta;
+            timestamps[1] -= timestamp_delta;
+            timestamps[2] -= timestamp_delta;
+            ASSERT_EQ(k4a_playback_get_previous_capture(handle, &capture), K4A_STREAM_RESULT_SUCCEEDED);
+            ASSERT_TRUE(validate_test_capture(
+                capture, timestamps, config.color_format, config.color_resolution, config.depth_mode));
+            k4a_capture_release(capture);
+        }
+        ASSERT_EQ(k4a_playback_get_previous_capture(handle, &capture), K4A_STREAM_RESULT_EOF);
+    }
+
+    k4a_playback_close(handle);
+}
+
+TEST_F(playback_ut, playback_cluster_cache)
+{
+    k4a_playback_t handle = NULL;
+    k4a_result_t result = k4a_playback_open("record_test_full.mkv", &handle);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(k4a_playback_set_read_ahead(handle, 0), K4A_RESULT_SUCCEEDED);
+
+    auto read_all_captures = [handle]() {
+        k4a_capture_t capture = NULL;
+        if (k4a_playback_seek_timestamp(handle, 0, K4A_PLAYBACK_SEEK_BEGIN) != K4A_RESULT_SUCCEEDED)
+        {
+            return false;
+        }
+        for (size_t i = 0; i < test_frame_count; i++)
+        {
+            if (k4a_playback_get_next_capture(handle, &capture) != K4A_STREAM_RESULT_SUCCEEDED)
+            {
+                return false;
+            }
+            k4a_capture_release(capture);
+        }
+        return true;
+    };
+
+    // Without a cache, reading the recording again reads its clusters from the file again
+    k4a_playback_cluster_cache_stats_t first_stats, stats;
+    ASSERT_TRUE(read_all_captures());
+    ASSERT_EQ(k4a_playback_get_cluster_cache_stats(handle, &first_stats), K4A_RESULT_SUCCEEDED);
+    ASSERT_GT(first_stats.miss_count, 0u);
+    ASSERT_EQ(first_stats.cached_bytes, 0u);
+    ASSERT_TRUE(read_all_captures());
+    ASSERT_EQ(k4a_playback_get_cluster_cache_stats(handle, &stats), K4A_RESULT_SUCCEEDED);
+    ASSERT_GT(stats.miss_count, first_stats.miss_count);
+    ASSERT_GT(stats.load_count, first_stats.load_count);
+
+    // With a cache large enough for the whole recording, it is read from the file once
+    ASSERT_EQ(k4a_playback_set_cluster_cache_size(handle, 1ull << 30), K4A_RESULT_SUCCEEDED);
+    ASSERT_TRUE(read_all_captures());
+    ASSERT_EQ(k4a_playback_get_cluster_cache_stats(handle, &first_stats), K4A_RESULT_SUCCEEDED);
+    ASSERT_GT(first_stats.cached_bytes, 0u);
+    ASSERT_TRUE(read_all_captures());
+    ASSERT_EQ(k4a_playback_get_cluster_cache_stats(handle, &stats), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(stats.miss_count, first_stats.miss_count);
+    ASSERT_EQ(stats.load_count, first_stats.load_count);
+    ASSERT_GT(stats.hit_count, first_stats.hit_count);
+    ASSERT_EQ(stats.cached_bytes, first_stats.cached_bytes);
+    ASSERT_EQ(stats.evict_count, 0u);
+
+    // Shrinking the cache drops the least recently used clusters
+    ASSERT_EQ(k4a_playback_set_cluster_cache_size(handle, stats.cached_bytes / 2), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(k4a_playback_get_cluster_cache_stats(handle, &stats), K4A_RESULT_SUCCEEDED);
+    ASSERT_LE(stats.cached_bytes, first_stats.cached_bytes / 2);
+    ASSERT_GT(stats.evict_count, 0u);
+    ASSERT_EQ(k4a_playback_set_cluster_cache_size(handle, 0), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(k4a_playback_get_cluster_cache_stats(handle, &stats), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(stats.cached_bytes, 0u);
+
+    ASSERT_EQ(k4a_playback_get_cluster_cache_stats(handle, NULL), K4A_RESULT_FAILED);
+    k4a_playback_close(handle);
+}
+
+TEST_F(playback_ut, playback_track_filter)
+{
+    k4a_playback_t handle = NULL;
+    k4a_result_t result = k4a_playback_open("record_test_full.mkv", &handle);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+    k4a_record_configuration_t config;
+    result = k4a_playback_get_record_configuration(handle, &config);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+    uint64_t timestamp_delta = HZ_TO_PERIOD_US(k4a_convert_fps_to_uint(config.camera_fps));
+
+    ASSERT_EQ(k4a_playback_set_track_filter(handle, "UNKNOWN", false), K4A_RESULT_FAILED);
+    ASSERT_EQ(k4a_playback_set_track_filter(handle, "COLOR", false), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(k4a_playback_set_track_filter(handle, "IMU", false), K4A_RESULT_SUCCEEDED);
+
+    // Captures of the recording without the color images
+    uint64_t timestamps[3] = { 0, 1000, 1000 };
+    k4a_capture_t capture = NULL;
+    for (size_t i = 0; i < test_frame_count; i++)
+    {
+        ASSERT_EQ(k4a_playback_get_next_capture(handle, &capture), K4A_STREAM_RESULT_SUCCEEDED);
+        ASSERT_TRUE(validate_test_capture(
+            capture, timestamps, config.color_format, K4A_COLOR_RESOLUTION_OFF, config.depth_mode));
+        ASSERT_EQ(k4a_capture_get_color_image(capture), nullptr);
+        k4a_capture_release(capture);
+        timestamps[0] += timestamp_delta;
+        timestamps[1] += timestamp_delta;
+        timestamps[2] += timestamp_delta;
+    }
+    ASSERT_EQ(k4a_playback_get_next_capture(handle, &capture), K4A_STREAM_RESULT_EOF);
+
+    k4a_imu_sample_t imu_sample = { 0 };
+    ASSERT_EQ(k4a_playback_get_next_imu_sample(handle, &imu_sample), K4A_STREAM_RESULT_EOF);
+
+    // Enabling the track again seeks to the start of the recording
+    ASSERT_EQ(k4a_playback_set_track_filter(handle, "COLOR", true), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(k4a_playback_set_track_filter(handle, "IMU", true), K4A_RESULT_SUCCEEDED);
+    timestamps[0] = 0;
+    timestamps[1] = 1000;
+    timestamps[2] = 1000;
+    ASSERT_EQ(k4a_playback_get_next_capture(handle, &capture), K4A_STREAM_RESULT_SUCCEEDED);
+    ASSERT_TRUE(
+        validate_test_capture(capture, timestamps, config.color_format, config.color_resolution, config.depth_mode));
+    k4a_capture_release(capture);
+    ASSERT_EQ(k4a_playback_get_next_imu_sample(handle, &imu_sample), K4A_STREAM_RESULT_SUCCEEDED);
+    ASSERT_TRUE(validate_imu_sample(imu_sample, 1150));
+
+    k4a_playback_close(handle);
+}
+
+TEST_F(playback_ut, playback_capture_index)
+{
+    k4a_playback_t handle = NULL;
+    k4a_result_t result = k4a_playback_open("record_test_full.mkv", &handle);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+    k4a_record_configuration_t config;
+    result = k4a_playback_get_record_configuration(handle, &config);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+    uint64_t timestamp_delta = HZ_TO_PERIOD_US(k4a_convert_fps_to_uint(config.camera_fps));
+
+    ASSERT_EQ(k4a_playback_get_capture_count(handle), test_frame_count);
+
+    // Captures are read in any order, and playback continues from the last one read
+    size_t indexes[] = { 50, 97, 0, 73, 73, 1, 98 };
+    k4a_capture_t capture = NULL;
+    for (size_t index : indexes)
+    {
+        uint64_t timestamps[3] = { timestamp_delta * index, 1000 + timestamp_delta * index, 0 };
+        timestamps[2] = timestamps[1];
+        ASSERT_EQ(k4a_playback_get_capture_at_index(handle, index, &capture), K4A_STREAM_RESULT_SUCCEEDED);
+        ASSERT_TRUE(validate_test_capture(
+            capture, timestamps, config.color_format, config.color_resolution, config.depth_mode));
+        k4a_capture_release(capture);
+
+        timestamps[0] += timestamp_delta;
+        timestamps[1] += timestamp_delta;
+        timestamps[2] += timestamp_delta;
+        ASSERT_EQ(k4a_playback_get_next_capture(handle, &capture), K4A_STREAM_RESULT_SUCCEEDED);
+        ASSERT_TRUE(validate_test_capture(
+            capture, timestamps, config.color_format, config.color_resolution, config.depth_mode));
+        k4a_capture_release(capture);
+    }
+
+    ASSERT_EQ(k4a_playback_get_capture_at_index(handle, 10, &capture), K4A_STREAM_RESULT_SUCCEEDED);
+    k4a_capture_release(capture);
+    uint64_t timestamps[3] = { timestamp_delta * 9, 1000 + timestamp_delta * 9, 1000 + timestamp_delta * 9 };
+    ASSERT_EQ(k4a_playback_get_previous_capture(handle, &capture), K4A_STREAM_RESULT_SUCCEEDED);
+    ASSERT_TRUE(
+        validate_test_capture(capture, timestamps, config.color_format, config.color_resolution, config.depth_mode));
+    k4a_capture_release(capture);
+
+    ASSERT_EQ(k4a_playback_get_capture_at_index(handle, test_frame_count, &capture), K4A_STREAM_RESULT_EOF);
+    ASSERT_EQ(capture, nullptr);
+
+    // Disabling a track rebuilds the index without it
+    ASSERT_EQ(k4a_playback_set_track_filter(handle, "COLOR", false), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(k4a_playback_get_capture_count(handle), test_frame_count);
+    ASSERT_EQ(k4a_playback_get_capture_at_index(handle, 20, &capture), K4A_STREAM_RESULT_SUCCEEDED);
+    ASSERT_EQ(k4a_capture_get_color_image(capture), nullptr);
+    k4a_capture_release(capture);
+
+    k4a_playback_close(handle);
+}
+
+TEST_F(playback_ut, playback_clone)
+{
+    k4a_playback_t handle = NULL;
+    k4a_result_t result = k4a_playback_open("record_test_full.mkv", &handle);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+    k4a_record_configuration_t config;
+    result = k4a_playback_get_record_configuration(handle, &config);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+    uint64_t timestamp_delta = HZ_TO_PERIOD_US(k4a_convert_fps_to_uint(config.camera_fps));
+
+    k4a_playback_t clone_handle = NULL;
+    ASSERT_EQ(k4a_playback_clone(handle, &clone_handle), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(k4a_playback_clone(handle, NULL), K4A_RESULT_FAILED);
+
+    k4a_record_configuration_t clone_config;
+    ASSERT_EQ(k4a_playback_get_record_configuration(clone_handle, &clone_config), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(clone_config.color_format, config.color_format);
+    ASSERT_EQ(clone_config.depth_mode, config.depth_mode);
+    ASSERT_EQ(clone_config.camera_fps, config.camera_fps);
+    ASSERT_EQ(k4a_playback_get_recording_length_usec(clone_handle), k4a_playback_get_recording_length_usec(handle));
+
+    // Each handle reads its half of the recording on its own thread
+    auto read_captures = [&](k4a_playback_t playback, size_t first, size_t last) {
+        for (size_t index = first; index < last; index++)
+        {
+            k4a_capture_t capture = NULL;
+            k4a_stream_result_t stream_result = index == first ?
+                                                    k4a_playback_get_capture_at_index(playback, index, &capture) :
+                                                    k4a_playback_get_next_capture(playback, &capture);
+            if (stream_result != K4A_STREAM_RESULT_SUCCEEDED)
+            {
+                return false;
+            }
+            uint64_t timestamps[3] = { timestamp_delta * index,
+                                       1000 + timestamp_delta * index,
+                                       1000 + timestamp_delta * index };
+            bool valid = validate_test_capture(
+                capture, timestamps, config.color_format, config.color_resolution, config.depth_mode);
+            k4a_capture_release(capture);
+            if (!valid)
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+    bool first_half_valid = false;
+    bool second_half_valid = false;
+    std::thread first_half([&]() { first_half_valid = read_captures(handle, 0, test_frame_count / 2); });
+    std::thread second_half(
+        [&]() { second_half_valid = read_captures(clone_handle, test_frame_count / 2, test_frame_count); });
+    first_half.join();
+    second_half.join();
+    ASSERT_TRUE(first_half_valid);
+    ASSERT_TRUE(second_half_valid);
+
+    // The clone keeps working once the handle it was cloned from is closed
+    k4a_playback_close(handle);
+    k4a_capture_t capture = NULL;
+    ASSERT_EQ(k4a_playback_get_next_capture(clone_handle, &capture), K4A_STREAM_RESULT_EOF);
+    ASSERT_EQ(k4a_playback_seek_timestamp(clone_handle, 0, K4A_PLAYBACK_SEEK_BEGIN), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(k4a_playback_get_next_capture(clone_handle, &capture), K4A_STREAM_RESULT_SUCCEEDED);
+    uint64_t timestamps[3] = { 0, 1000, 1000 };
+    ASSERT_TRUE(
+        validate_test_capture(capture, timestamps, config.color_format, config.color_resolution, config.depth_mode));
+    k4a_capture_release(capture);
+
+    k4a_playback_close(clone_handle);
+}
+
+TEST_F(playback_ut, open_header_only)
+{
+    k4a_playback_t handle = NULL;
+    ASSERT_EQ(k4a_playback_open_ex("record_test_full.mkv", 1u << 31, &handle), K4A_RESULT_FAILED);
+    ASSERT_EQ(k4a_playback_open_ex("record_test_full.mkv", K4A_PLAYBACK_OPEN_HEADER_ONLY, &handle),
+              K4A_RESULT_SUCCEEDED);
+
+    // The header is read when the recording is opened
+    k4a_record_configuration_t config;
+    ASSERT_EQ(k4a_playback_get_record_configuration(handle, &config), K4A_RESULT_SUCCEEDED);
+    ASSERT_TRUE(config.depth_track_enabled);
+    k4a_calibration_t calibration;
+    ASSERT_EQ(k4a_playback_get_calibration(handle, &calibration), K4A_RESULT_SUCCEEDED);
+    uint64_t timestamp_delta = HZ_TO_PERIOD_US(k4a_convert_fps_to_uint(config.camera_fps));
+
+    // The clusters are read on first use
+    k4a_playback_t full_handle = NULL;
+    ASSERT_EQ(k4a_playback_open("record_test_full.mkv", &full_handle), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(k4a_playback_get_recording_length_usec(handle), k4a_playback_get_recording_length_usec(full_handle));
+    k4a_playback_close(full_handle);
+
+    k4a_capture_t capture = NULL;
+    uint64_t timestamps[3] = { 0, 1000, 1000 };
+    ASSERT_EQ(k4a_playback_get_next_capture(handle, &capture), K4A_STREAM_RESULT_SUCCEEDED);
+    ASSERT_TRUE(
+        validate_test_capture(capture, timestamps, config.color_format, config.color_resolution, config.depth_mode));
+    k4a_capture_release(capture);
+    k4a_playback_close(handle);
+
+    // Seeking loads the clusters too
+    ASSERT_EQ(k4a_playback_open_ex("record_test_full.mkv", K4A_PLAYBACK_OPEN_HEADER_ONLY, &handle),
+              K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(k4a_playback_seek_timestamp(handle, 0, K4A_PLAYBACK_SEEK_END), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(k4a_playback_get_previous_capture(handle, &capture), K4A_STREAM_RESULT_SUCCEEDED);
+    timestamps[0] = timestamp_delta * (test_frame_count - 1);
+    timestamps[1] = timestamps[0] + 1000;
+    timestamps[2] = timestamps[1];
+    ASSERT_TRUE(
+        validate_test_capture(capture, timestamps, config.color_format, config.color_resolution, config.depth_mode));
+    k4a_capture_release(capture);
+    k4a_playback_close(handle);
+}
+
+TEST_F(playback_ut, playback_decode_ahead)
+{
+    k4a_playback_t handle = NULL;
+    k4a_playback_t reference_handle = NULL;
+    ASSERT_EQ(k4a_playback_open("record_test_transcode.mkv", &handle), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(k4a_playback_open("record_test_transcode.mkv", &reference_handle), K4A_RESULT_SUCCEEDED);
+
+    ASSERT_EQ(k4a_playback_set_decode_ahead(handle, 17), K4A_RESULT_FAILED);
+    ASSERT_EQ(k4a_playback_set_decode_ahead(handle, 4), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(k4a_playback_set_color_conversion(handle, K4A_IMAGE_FORMAT_COLOR_BGRA32), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(k4a_playback_set_color_conversion(reference_handle, K4A_IMAGE_FORMAT_COLOR_BGRA32),
+              K4A_RESULT_SUCCEEDED);
+
+    // The images converted ahead match the ones converted when read, across seeks and changes of direction. The
+    // recording has 10 captures.
+    const char *steps = "nnnnpppnnnsnnnnnnnnnnn";
+    k4a_capture_t capture = NULL;
+    k4a_capture_t reference_capture = NULL;
+    size_t capture_count = 0;
+    for (const char *step = steps; *step != '\0'; step++)
+    {
+        if (*step == 's')
+        {
+            ASSERT_EQ(k4a_playback_seek_timestamp(handle, 0, K4A_PLAYBACK_SEEK_BEGIN), K4A_RESULT_SUCCEEDED);
+            ASSERT_EQ(k4a_playback_seek_timestamp(reference_handle, 0, K4A_PLAYBACK_SEEK_BEGIN),
+                      K4A_RESULT_SUCCEEDED);
+            continue;
+        }
+
+        k4a_stream_result_t stream_result = K4A_STREAM_RESULT_FAILED;
+        k4a_stream_result_t reference_result = K4A_STREAM_RESULT_FAILED;
+        if (*step == 'n')
+        {
+            stream_result = k4a_playback_get_next_capture(handle, &capture);
+            reference_result = k4a_playback_get_next_capture(reference_handle, &reference_capture);
+        }
+        else
+        {
+            stream_result = k4a_playback_get_previous_capture(handle, &capture);
+            reference_result = k4a_playback_get_previous_capture(reference_handle, &reference_capture);
+        }
+        ASSERT_EQ(stream_result, reference_result);
+        if (stream_result == K4A_STREAM_RESULT_EOF)
+        {
+            continue;
+        }
+        ASSERT_EQ(stream_result, K4A_STREAM_RESULT_SUCCEEDED);
+        capture_count++;
+
+        k4a_image_t image = k4a_capture_get_color_image(capture);
+        k4a_image_t reference_image = k4a_capture_get_color_image(reference_capture);
+        ASSERT_NE(image, (k4a_image_t)NULL);
+        ASSERT_NE(reference_image, (k4a_image_t)NULL);
+        ASSERT_EQ(k4a_image_get_format(image), K4A_IMAGE_FORMAT_COLOR_BGRA32);
+        ASSERT_EQ(k4a_image_get_device_timestamp_usec(image), k4a_image_get_device_timestamp_usec(reference_image));
+        ASSERT_EQ(k4a_image_get_size(image), k4a_image_get_size(reference_image));
+        ASSERT_EQ(memcmp(k4a_image_get_buffer(image), k4a_image_get_buffer(reference_image), k4a_image_get_size(image)),
+                  0);
+        k4a_image_release(image);
+        k4a_image_release(reference_image);
+        k4a_capture_release(capture);
+        k4a_capture_release(reference_capture);
+    }
+    ASSERT_EQ(capture_count, (size_t)20);
+
+    ASSERT_EQ(k4a_playback_set_decode_ahead(handle, 0), K4A_RESULT_SUCCEEDED);
+    k4a_playback_close(handle);
+    k4a_playback_close(reference_handle);
+
+    // Closing a playback with images converted ahead releases them
+    ASSERT_EQ(k4a_playback_open("record_test_transcode.mkv", &handle), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(k4a_playback_set_decode_ahead(handle, 16), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(k4a_playback_get_next_capture(handle, &capture), K4A_STREAM_RESULT_SUCCEEDED);
+    k4a_capture_release(capture);
+    k4a_playback_close(handle);
+}
+
 TEST_F(playback_ut, open_skipped_frames_file)
 {
     k4a_playback_t handle = NULL;
@@ -789,69 +1208,322 @@ TEST_F(playback_ut, open_imu_playback_file)
     k4a_playback_close(handle);
 }
 
-TEST_F(playback_ut, open_start_offset_file)
+TEST_F(playback_ut, playback_imu_samples)
 {
     k4a_playback_t handle = NULL;
-    k4a_result_t result = k4a_playback_open("record_test_offset.mkv", &handle);
+    k4a_result_t result = k4a_playback_open("record_test_full.mkv", &handle);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+    // Read the whole recording a chunk at a time, each chunk starting after the last sample of the previous one
+    std::vector<k4a_imu_sample_t> samples(500);
+    uint64_t imu_timestamp = 1150;
+    uint64_t start_timestamp = 0;
+    size_t total_sample_count = 0;
+    size_t sample_count = 0;
+    do
+    {
+        result = k4a_playback_get_imu_samples(
+            handle, start_timestamp, UINT64_MAX, samples.data(), samples.size(), &sample_count);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+        for (size_t i = 0; i < sample_count; i++)
+        {
+            ASSERT_TRUE(validate_imu_sample(samples[i], imu_timestamp));
+            imu_timestamp += 1000;
+        }
+        total_sample_count += sample_count;
+        if (sample_count > 0)
+        {
+            start_timestamp = samples[sample_count - 1].acc_timestamp_usec + 1;
+        }
+    } while (sample_count == samples.size());
+    ASSERT_EQ(total_sample_count, 3333u);
+
+    // Ranges starting and ending within blocks
+    result = k4a_playback_get_imu_samples(handle, 10000, 20000, samples.data(), samples.size(), &sample_count);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(sample_count, 10u);
+    for (size_t i = 0; i < sample_count; i++)
+    {
+        ASSERT_TRUE(validate_imu_sample(samples[i], 10150 + i * 1000));
+    }
+    result = k4a_playback_get_imu_samples(handle, 20150, 20151, samples.data(), samples.size(), &sample_count);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(sample_count, 1u);
+    ASSERT_TRUE(validate_imu_sample(samples[0], 20150));
+    result = k4a_playback_get_imu_samples(handle, 5000000, UINT64_MAX, samples.data(), samples.size(), &sample_count);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(sample_count, 0u);
+    result = k4a_playback_get_imu_samples(handle, 0, UINT64_MAX, NULL, 1, &sample_count);
+    ASSERT_EQ(result, K4A_RESULT_FAILED);
+
+    // The IMU position of the playback is unchanged
+    k4a_imu_sample_t imu_sample = { 0 };
+    ASSERT_EQ(k4a_playback_get_next_imu_sample(handle, &imu_sample), K4A_STREAM_RESULT_SUCCEEDED);
+    ASSERT_TRUE(validate_imu_sample(imu_sample, 1150));
+
+    k4a_playback_close(handle);
+}
+
+TEST_F(playback_ut, open_packed_imu_file)
+{
+    k4a_playback_t handle = NULL;
+    k4a_result_t result = k4a_playback_open("record_test_imu_packed.mkv", &handle);
     ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
 
-    // Read recording configuration
     k4a_record_configuration_t config;
     result = k4a_playback_get_record_configuration(handle, &config);
     ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
-    ASSERT_EQ(config.color_format, K4A_IMAGE_FORMAT_COLOR_MJPG);
-    ASSERT_EQ(config.color_resolution, K4A_COLOR_RESOLUTION_1080P);
-    ASSERT_EQ(config.depth_mode, K4A_DEPTH_MODE_NFOV_UNBINNED);
-    ASSERT_EQ(config.camera_fps, K4A_FRAMES_PER_SECOND_30);
-    ASSERT_TRUE(config.color_track_enabled);
-    ASSERT_TRUE(config.depth_track_enabled);
-    ASSERT_TRUE(config.ir_track_enabled);
     ASSERT_TRUE(config.imu_track_enabled);
-    ASSERT_EQ(config.depth_delay_off_color_usec, 0);
-    ASSERT_EQ(config.wired_sync_mode, K4A_WIRED_SYNC_MODE_STANDALONE);
-    ASSERT_EQ(config.subordinate_delay_off_master_usec, (uint32_t)0);
-    ASSERT_EQ(config.start_timestamp_offset_usec, (uint32_t)1000000);
 
-    k4a_capture_t capture = NULL;
     k4a_imu_sample_t imu_sample = { 0 };
     k4a_stream_result_t stream_result = K4A_STREAM_RESULT_FAILED;
-    uint64_t timestamps[3] = { 1000000, 1000000, 1000000 };
-    uint64_t imu_timestamp = 1001150;
-    uint64_t timestamp_delta = HZ_TO_PERIOD_US(k4a_convert_fps_to_uint(config.camera_fps));
-    uint64_t last_timestamp = k4a_playback_get_recording_length_usec(handle) +
-                              (uint64_t)config.start_timestamp_offset_usec;
-    ASSERT_EQ(last_timestamp, (uint64_t)config.start_timestamp_offset_usec + 3333150);
+    uint64_t imu_timestamp = 1150;
 
-    // Read capture forward
-    for (size_t i = 0; i < test_frame_count; i++)
+    // Read forward across the packed blocks
+    for (size_t i = 0; i < 3333; i++)
     {
-        stream_result = k4a_playback_get_next_capture(handle, &capture);
+        stream_result = k4a_playback_get_next_imu_sample(handle, &imu_sample);
         ASSERT_EQ(stream_result, K4A_STREAM_RESULT_SUCCEEDED);
-        ASSERT_TRUE(validate_test_capture(capture,
-                                          timestamps,
-                                          config.color_format,
-                                          config.color_resolution,
-                                          config.depth_mode));
-        k4a_capture_release(capture);
-        timestamps[0] += timestamp_delta;
-        timestamps[1] += timestamp_delta;
-        timestamps[2] += timestamp_delta;
+        ASSERT_TRUE(validate_imu_sample(imu_sample, imu_timestamp));
+        imu_timestamp += 1000;
     }
-    stream_result = k4a_playback_get_next_capture(handle, &capture);
+    stream_result = k4a_playback_get_next_imu_sample(handle, &imu_sample);
     ASSERT_EQ(stream_result, K4A_STREAM_RESULT_EOF);
-    ASSERT_EQ(capture, (k4a_capture_t)NULL);
 
-    // Read capture backward
-    for (size_t i = 0; i < test_frame_count; i++)
+    // Read backward
+    while (imu_timestamp > 1150)
     {
-        timestamps[0] -= timestamp_delta;
-        timestamps[1] -= timestamp_delta;
-        timestamps[2] -= timestamp_delta;
-        stream_result = k4a_playback_get_previous_capture(handle, &capture);
+        imu_timestamp -= 1000;
+        stream_result = k4a_playback_get_previous_imu_sample(handle, &imu_sample);
         ASSERT_EQ(stream_result, K4A_STREAM_RESULT_SUCCEEDED);
-        ASSERT_TRUE(validate_test_capture(capture,
-                                          timestamps,
-                                          config.color_format,
+        ASSERT_TRUE(validate_imu_sample(imu_sample, imu_timestamp));
+    }
+    stream_result = k4a_playback_get_previous_imu_sample(handle, &imu_sample);
+    ASSERT_EQ(stream_result, K4A_STREAM_RESULT_EOF);
+
+    // Seek to samples within and at the edges of the packs
+    for (size_t i = 0; i < 30; i++)
+    {
+        result = k4a_playback_seek_timestamp(handle, (int64_t)imu_timestamp - 100, K4A_PLAYBACK_SEEK_BEGIN);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+        stream_result = k4a_playback_get_next_imu_sample(handle, &imu_sample);
+        ASSERT_EQ(stream_result, K4A_STREAM_RESULT_SUCCEEDED);
+        ASSERT_TRUE(validate_imu_sample(imu_sample, imu_timestamp));
+
+        result = k4a_playback_seek_timestamp(handle, (int64_t)imu_timestamp + 100, K4A_PLAYBACK_SEEK_BEGIN);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+        stream_result = k4a_playback_get_previous_imu_sample(handle, &imu_sample);
+        ASSERT_EQ(stream_result, K4A_STREAM_RESULT_SUCCEEDED);
+        ASSERT_TRUE(validate_imu_sample(imu_sample, imu_timestamp));
+
+        imu_timestamp += 1000;
+    }
+
+    // Ranges starting and ending within packs
+    std::vector<k4a_imu_sample_t> samples(500);
+    size_t sample_count = 0;
+    result = k4a_playback_get_imu_samples(handle, 15000, 27000, samples.data(), samples.size(), &sample_count);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(sample_count, 12u);
+    for (size_t i = 0; i < sample_count; i++)
+    {
+        ASSERT_TRUE(validate_imu_sample(samples[i], 15150 + i * 1000));
+    }
+
+    k4a_playback_close(handle);
+}
+
+TEST_F(playback_ut, playback_track_timestamps)
+{
+    k4a_playback_t handle = NULL;
+    k4a_result_t result = k4a_playback_open("record_test_full.mkv", &handle);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+    k4a_record_configuration_t config;
+    result = k4a_playback_get_record_configuration(handle, &config);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+    uint64_t timestamp_delta = HZ_TO_PERIOD_US(k4a_convert_fps_to_uint(config.camera_fps));
+
+    // List the whole tracks a few timestamps at a time
+    const char *track_names[3] = { "COLOR", "DEPTH", "IR" };
+    uint64_t first_timestamps[3] = { 0, 1000, 1000 };
+    std::vector<uint64_t> timestamps(7);
+    for (size_t track = 0; track < 3; track++)
+    {
+        size_t total_count = 0;
+        size_t timestamp_count = 0;
+        uint64_t start_timestamp = 0;
+        do
+        {
+            result = k4a_playback_get_track_timestamps(handle,
+                                                       track_names[track],
+                                                       start_timestamp,
+                                                       UINT64_MAX,
+                                                       timestamps.data(),
+                                                       timestamps.size(),
+                                                       &timestamp_count);
+            ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+            for (size_t i = 0; i < timestamp_count; i++)
+            {
+                ASSERT_EQ(timestamps[i], first_timestamps[track] + timestamp_delta * (total_count + i));
+            }
+            total_count += timestamp_count;
+            if (timestamp_count > 0)
+            {
+                start_timestamp = timestamps[timestamp_count - 1] + 1;
+            }
+        } while (timestamp_count == timestamps.size());
+        ASSERT_EQ(total_count, test_frame_count);
+    }
+
+    // Ranges starting and ending between blocks
+    size_t timestamp_count = 0;
+    result = k4a_playback_get_track_timestamps(
+        handle, "DEPTH", timestamp_delta * 10, timestamp_delta * 12 + 1000, timestamps.data(), 7, &timestamp_count);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(timestamp_count, 2u);
+    ASSERT_EQ(timestamps[0], timestamp_delta * 10 + 1000);
+    ASSERT_EQ(timestamps[1], timestamp_delta * 11 + 1000);
+    result = k4a_playback_get_track_timestamps(
+        handle, "COLOR", timestamp_delta * test_frame_count, UINT64_MAX, timestamps.data(), 7, &timestamp_count);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(timestamp_count, 0u);
+    result = k4a_playback_get_track_timestamps(
+        handle, "MISSING", 0, UINT64_MAX, timestamps.data(), 7, &timestamp_count);
+    ASSERT_EQ(result, K4A_RESULT_FAILED);
+
+    // The playback position is unchanged
+    k4a_capture_t capture = NULL;
+    uint64_t capture_timestamps[3] = { 0, 1000, 1000 };
+    ASSERT_EQ(k4a_playback_get_next_capture(handle, &capture), K4A_STREAM_RESULT_SUCCEEDED);
+    ASSERT_TRUE(validate_test_capture(capture,
+                                      capture_timestamps,
+                                      config.color_format,
+                                      config.color_resolution,
+                                      config.depth_mode));
+    k4a_capture_release(capture);
+
+    k4a_playback_close(handle);
+}
+
+TEST_F(playback_ut, playback_trim)
+{
+    k4a_playback_t handle = NULL;
+    ASSERT_EQ(k4a_playback_open("record_test_full.mkv", &handle), K4A_RESULT_SUCCEEDED);
+
+    k4a_record_configuration_t config;
+    ASSERT_EQ(k4a_playback_get_record_configuration(handle, &config), K4A_RESULT_SUCCEEDED);
+    uint64_t timestamp_delta = HZ_TO_PERIOD_US(k4a_convert_fps_to_uint(config.camera_fps));
+
+    ASSERT_EQ(k4a_playback_trim(handle, "record_test_full.mkv", 0, UINT64_MAX), K4A_RESULT_FAILED);
+    ASSERT_EQ(k4a_playback_trim(handle, "record_test_trim.mkv", timestamp_delta * 10, timestamp_delta * 10),
+              K4A_RESULT_FAILED);
+    ASSERT_EQ(k4a_playback_trim(handle,
+                                "record_test_trim.mkv",
+                                timestamp_delta * (test_frame_count + 1),
+                                timestamp_delta * (test_frame_count + 2)),
+              K4A_RESULT_FAILED);
+    ASSERT_EQ(k4a_playback_trim(handle, "record_test_trim.mkv", timestamp_delta * 10, timestamp_delta * 20),
+              K4A_RESULT_SUCCEEDED);
+    k4a_playback_close(handle);
+
+    // The trimmed recording keeps the device timestamps of the source recording
+    ASSERT_EQ(k4a_playback_open("record_test_trim.mkv", &handle), K4A_RESULT_SUCCEEDED);
+    k4a_record_configuration_t trim_config;
+    ASSERT_EQ(k4a_playback_get_record_configuration(handle, &trim_config), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(trim_config.start_timestamp_offset_usec, config.start_timestamp_offset_usec + timestamp_delta * 10);
+    ASSERT_EQ(trim_config.depth_mode, config.depth_mode);
+
+    uint64_t timestamps[3] = { timestamp_delta * 10, timestamp_delta * 10 + 1000, timestamp_delta * 10 + 1000 };
+    k4a_capture_t capture = NULL;
+    for (size_t i = 0; i < 10; i++)
+    {
+        ASSERT_EQ(k4a_playback_get_next_capture(handle, &capture), K4A_STREAM_RESULT_SUCCEEDED);
+        ASSERT_TRUE(validate_test_capture(capture,
+                                          timestamps,
+                                          config.color_format,
+                                          config.color_resolution,
+                                          config.depth_mode));
+        k4a_capture_release(capture);
+        for (size_t j = 0; j < 3; j++)
+        {
+            timestamps[j] += timestamp_delta;
+        }
+    }
+    ASSERT_EQ(k4a_playback_get_next_capture(handle, &capture), K4A_STREAM_RESULT_EOF);
+
+    // Seeking uses the Cues of the trimmed recording
+    ASSERT_EQ(k4a_playback_seek_timestamp(handle, 0, K4A_PLAYBACK_SEEK_END), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(k4a_playback_get_previous_capture(handle, &capture), K4A_STREAM_RESULT_SUCCEEDED);
+    k4a_capture_release(capture);
+    k4a_playback_close(handle);
+
+    ASSERT_EQ(std::remove("record_test_trim.mkv"), 0);
+}
+
+TEST_F(playback_ut, open_start_offset_file)
+{
+    k4a_playback_t handle = NULL;
+    k4a_result_t result = k4a_playback_open("record_test_offset.mkv", &handle);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+    // Read recording configuration
+    k4a_record_configuration_t config;
+    result = k4a_playback_get_record_configuration(handle, &config);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(config.color_format, K4A_IMAGE_FORMAT_COLOR_MJPG);
+    ASSERT_EQ(config.color_resolution, K4A_COLOR_RESOLUTION_1080P);
+    ASSERT_EQ(config.depth_mode, K4A_DEPTH_MODE_NFOV_UNBINNED);
+    ASSERT_EQ(config.camera_fps, K4A_FRAMES_PER_SECOND_30);
+    ASSERT_TRUE(config.color_track_enabled);
+    ASSERT_TRUE(config.depth_track_enabled);
+    ASSERT_TRUE(config.ir_track_enabled);
+    ASSERT_TRUE(config.imu_track_enabled);
+    ASSERT_EQ(config.depth_delay_off_color_usec, 0);
+    ASSERT_EQ(config.wired_sync_mode, K4A_WIRED_SYNC_MODE_STANDALONE);
+    ASSERT_EQ(config.subordinate_delay_off_master_usec, (uint32_t)0);
+    ASSERT_EQ(config.start_timestamp_offset_usec, (uint32_t)1000000);
+
+    k4a_capture_t capture = NULL;
+    k4a_imu_sample_t imu_sample = { 0 };
+    k4a_stream_result_t stream_result = K4A_STREAM_RESULT_FAILED;
+    uint64_t timestamps[3] = { 1000000, 1000000, 1000000 };
+    uint64_t imu_timestamp = 1001150;
+    uint64_t timestamp_delta = HZ_TO_PERIOD_US(k4a_convert_fps_to_uint(config.camera_fps));
+    uint64_t last_timestamp = k4a_playback_get_recording_length_usec(handle) +
+                              (uint64_t)config.start_timestamp_offset_usec;
+    ASSERT_EQ(last_timestamp, (uint64_t)config.start_timestamp_offset_usec + 3333150);
+
+    // Read capture forward
+    for (size_t i = 0; i < test_frame_count; i++)
+    {
+        stream_result = k4a_playback_get_next_capture(handle, &capture);
+        ASSERT_EQ(stream_result, K4A_STREAM_RESULT_SUCCEEDED);
+        ASSERT_TRUE(validate_test_capture(capture,
+                                          timestamps,
+                                          config.color_format,
+                                          config.color_resolution,
+                                          config.depth_mode));
+        k4a_capture_release(capture);
+        timestamps[0] += timestamp_delta;
+        timestamps[1] += timestamp_delta;
+        timestamps[2] += timestamp_delta;
+    }
+    stream_result = k4a_playback_get_next_capture(handle, &capture);
+    ASSERT_EQ(stream_result, K4A_STREAM_RESULT_EOF);
+    ASSERT_EQ(capture, (k4a_capture_t)NULL);
+
+    // Read capture backward
+    for (size_t i = 0; i < test_frame_count; i++)
+    {
+        timestamps[0] -= timestamp_delta;
+        timestamps[1] -= timestamp_delta;
+        timestamps[2] -= timestamp_delta;
+        stream_result = k4a_playback_get_previous_capture(handle, &capture);
+        ASSERT_EQ(stream_result, K4A_STREAM_RESULT_SUCCEEDED);
+        ASSERT_TRUE(validate_test_capture(capture,
+                                          timestamps,
+                                          config.color_format,
                                           config.color_resolution,
                                           config.depth_mode));
         k4a_capture_release(capture);
@@ -1022,6 +1694,826 @@ TEST_F(playback_ut, open_bgra_color_file)
     k4a_playback_close(handle);
 }
 
+TEST_F(playback_ut, open_transcoded_color_file)
+{
+    k4a_playback_t handle = NULL;
+    k4a_result_t result = k4a_playback_open("record_test_transcode.mkv", &handle);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+    // The BGRA32 color track was stored as MJPG
+    k4a_record_configuration_t config;
+    result = k4a_playback_get_record_configuration(handle, &config);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(config.color_format, K4A_IMAGE_FORMAT_COLOR_MJPG);
+    ASSERT_EQ(config.color_resolution, K4A_COLOR_RESOLUTION_720P);
+    ASSERT_TRUE(config.color_track_enabled);
+    ASSERT_FALSE(config.depth_track_enabled);
+
+    k4a_capture_t capture = NULL;
+    ASSERT_EQ(k4a_playback_get_next_capture(handle, &capture), K4A_STREAM_RESULT_SUCCEEDED);
+    k4a_image_t color_image = k4a_capture_get_color_image(capture);
+    ASSERT_NE(color_image, nullptr);
+    ASSERT_EQ(k4a_image_get_format(color_image), K4A_IMAGE_FORMAT_COLOR_MJPG);
+    ASSERT_GT(k4a_image_get_size(color_image), (size_t)0);
+    ASSERT_LT(k4a_image_get_size(color_image), (size_t)1280 * 720 * 4 / 10);
+    k4a_image_release(color_image);
+    k4a_capture_release(capture);
+
+    // The remaining frames decode back to the recorded gradient
+    result = k4a_playback_set_color_conversion(handle, K4A_IMAGE_FORMAT_COLOR_BGRA32);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+    size_t frame_count = 1;
+    while (k4a_playback_get_next_capture(handle, &capture) == K4A_STREAM_RESULT_SUCCEEDED)
+    {
+        color_image = k4a_capture_get_color_image(capture);
+        ASSERT_TRUE(validate_gradient_test_image(color_image, 1280, 720, 8));
+        k4a_image_release(color_image);
+        k4a_capture_release(capture);
+        frame_count++;
+    }
+    ASSERT_EQ(frame_count, (size_t)10);
+
+    k4a_playback_close(handle);
+}
+
+TEST_F(playback_ut, open_little_endian_file)
+{
+    k4a_playback_t handle = NULL;
+    k4a_result_t result = k4a_playback_open("record_test_little_endian.mkv", &handle);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+    k4a_record_configuration_t config;
+    result = k4a_playback_get_record_configuration(handle, &config);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+    ASSERT_TRUE(config.depth_track_enabled);
+    ASSERT_TRUE(config.ir_track_enabled);
+
+    // Both 16-bit tracks are flagged as little-endian in their codec header
+    const char *track_names[] = { "DEPTH", "IR" };
+    for (const char *track_name : track_names)
+    {
+        k4arecord::BITMAPINFOHEADER codec_header;
+        size_t data_size = sizeof(codec_header);
+        ASSERT_EQ(k4a_playback_track_get_codec_context(handle,
+                                                       track_name,
+                                                       reinterpret_cast<uint8_t *>(&codec_header),
+                                                       &data_size),
+                  K4A_BUFFER_RESULT_SUCCEEDED);
+        ASSERT_EQ(data_size, sizeof(codec_header));
+        ASSERT_EQ(codec_header.biCompression, static_cast<uint32_t>(K4A_FOURCC_GRAY16_LITTLE_ENDIAN));
+    }
+
+    // The images read back match the ones written, with no byte swap on either side
+    uint64_t timestamps[3] = { 0, 0, 0 };
+    k4a_capture_t capture = NULL;
+    k4a_stream_result_t stream_result = k4a_playback_get_next_capture(handle, &capture);
+    ASSERT_EQ(stream_result, K4A_STREAM_RESULT_SUCCEEDED);
+    ASSERT_TRUE(
+        validate_test_capture(capture, timestamps, config.color_format, config.color_resolution, config.depth_mode));
+    k4a_capture_release(capture);
+
+    k4a_playback_close(handle);
+}
+
+TEST_F(playback_ut, mapped_file_io)
+{
+    k4arecord::LargeFileIOCallback file("record_test_little_endian.mkv", MODE_READ);
+    k4arecord::MappedFileIOCallback mapped_file("record_test_little_endian.mkv");
+    std::shared_ptr<k4arecord::mapped_file_t> mapping = mapped_file.getMapping();
+    ASSERT_NE(mapping, nullptr);
+
+    file.setFilePointer(0, libebml::seek_end);
+    mapped_file.setFilePointer(0, libebml::seek_end);
+    ASSERT_EQ(mapping->size, file.getFilePointer());
+    ASSERT_EQ(mapped_file.getFilePointer(), file.getFilePointer());
+
+    // Reads match the file from any position, and stop at its end
+    std::vector<uint8_t> expected(mapping->size + 1);
+    file.setFilePointer(0);
+    ASSERT_EQ(file.read(expected.data(), expected.size()), mapping->size);
+    std::vector<uint8_t> actual(expected.size());
+    mapped_file.setFilePointer(0);
+    ASSERT_EQ(mapped_file.read(actual.data(), actual.size()), mapping->size);
+    ASSERT_TRUE(std::equal(actual.begin(), actual.end() - 1, expected.begin()));
+    ASSERT_EQ(mapped_file.read(actual.data(), 1), 0u);
+
+    mapped_file.setFilePointer(-10, libebml::seek_end);
+    mapped_file.setFilePointer(4, libebml::seek_current);
+    ASSERT_EQ(mapped_file.getFilePointer(), mapping->size - 6);
+    ASSERT_EQ(mapped_file.read(actual.data(), actual.size()), 6u);
+    ASSERT_TRUE(std::equal(actual.begin(), actual.begin() + 6, expected.end() - 7));
+
+    // Mapped files are read-only. Once closed, the mapping is only kept by its other references.
+    ASSERT_THROW(mapped_file.write(actual.data(), 1), std::ios_base::failure);
+    mapped_file.close();
+    ASSERT_EQ(mapped_file.getMapping(), nullptr);
+    ASSERT_EQ(mapping->data[0], expected[0]);
+    file.close();
+}
+
+struct test_io_source_t
+{
+    FILE *file = NULL;
+    std::mutex lock;
+    uint64_t next_offset = 0;
+    bool out_of_order = false;
+    size_t hint_count = 0;
+    size_t close_count = 0;
+};
+
+static int64_t test_io_read(void *context, uint64_t offset, void *buffer, size_t size)
+{
+    test_io_source_t *source = static_cast<test_io_source_t *>(context);
+    std::lock_guard<std::mutex> lock(source->lock);
+    if (offset != source->next_offset)
+    {
+        source->out_of_order = true;
+    }
+    if (fseek(source->file, (long)offset, SEEK_SET) != 0)
+    {
+        return -1;
+    }
+    size_t count = fread(buffer, 1, size, source->file);
+    source->next_offset = offset + count;
+    return ferror(source->file) ? -1 : (int64_t)count;
+}
+
+static uint64_t test_io_get_size(void *context)
+{
+    test_io_source_t *source = static_cast<test_io_source_t *>(context);
+    std::lock_guard<std::mutex> lock(source->lock);
+    fseek(source->file, 0, SEEK_END);
+    long size = ftell(source->file);
+    return size < 0 ? 0 : (uint64_t)size;
+}
+
+static void test_io_read_hint(void *context, uint64_t offset, uint64_t size)
+{
+    (void)offset;
+    (void)size;
+    test_io_source_t *source = static_cast<test_io_source_t *>(context);
+    std::lock_guard<std::mutex> lock(source->lock);
+    source->hint_count++;
+}
+
+static void test_io_close(void *context)
+{
+    test_io_source_t *source = static_cast<test_io_source_t *>(context);
+    std::lock_guard<std::mutex> lock(source->lock);
+    source->close_count++;
+}
+
+TEST_F(playback_ut, playback_io_callbacks)
+{
+    k4a_playback_t file_handle = NULL;
+    ASSERT_EQ(k4a_playback_open("record_test_full.mkv", &file_handle), K4A_RESULT_SUCCEEDED);
+    k4a_record_configuration_t config;
+    ASSERT_EQ(k4a_playback_get_record_configuration(file_handle, &config), K4A_RESULT_SUCCEEDED);
+    uint64_t timestamp_delta = HZ_TO_PERIOD_US(k4a_convert_fps_to_uint(config.camera_fps));
+    uint64_t recording_length = k4a_playback_get_recording_length_usec(file_handle);
+    k4a_playback_close(file_handle);
+
+    ASSERT_EQ(k4a_playback_open_callbacks(NULL, &file_handle), K4A_RESULT_FAILED);
+
+    for (int forward_only = 0; forward_only < 2; forward_only++)
+    {
+        test_io_source_t source;
+        source.file = fopen("record_test_full.mkv", "rb");
+        ASSERT_NE(source.file, nullptr);
+
+        k4a_playback_io_callbacks_t callbacks = {};
+        callbacks.context = &source;
+        callbacks.read = test_io_read;
+        callbacks.get_size = test_io_get_size;
+        callbacks.read_hint = test_io_read_hint;
+        callbacks.close = test_io_close;
+        callbacks.forward_only = forward_only != 0;
+
+        k4a_playback_t handle = NULL;
+        ASSERT_EQ(k4a_playback_open_callbacks(&callbacks, &handle), K4A_RESULT_SUCCEEDED);
+        if (forward_only)
+        {
+            // The length comes from the segment duration, and the recording can't be read from two places at once
+            ASSERT_GT(k4a_playback_get_recording_length_usec(handle), 0u);
+            ASSERT_EQ(k4a_playback_set_read_ahead(handle, 1), K4A_RESULT_FAILED);
+            k4a_playback_t clone_handle = NULL;
+            ASSERT_EQ(k4a_playback_clone(handle, &clone_handle), K4A_RESULT_FAILED);
+        }
+        else
+        {
+            ASSERT_EQ(k4a_playback_get_recording_length_usec(handle), recording_length);
+        }
+
+        uint64_t timestamps[3] = { 0, 1000, 1000 };
+        k4a_capture_t capture = NULL;
+        for (size_t i = 0; i < test_frame_count; i++)
+        {
+            ASSERT_EQ(k4a_playback_get_next_capture(handle, &capture), K4A_STREAM_RESULT_SUCCEEDED);
+            ASSERT_TRUE(validate_test_capture(
+                capture, timestamps, config.color_format, config.color_resolution, config.depth_mode));
+            k4a_capture_release(capture);
+            timestamps[0] += timestamp_delta;
+            timestamps[1] += timestamp_delta;
+            timestamps[2] += timestamp_delta;
+        }
+        ASSERT_EQ(k4a_playback_get_next_capture(handle, &capture), K4A_STREAM_RESULT_EOF);
+
+        k4a_playback_close(handle);
+        ASSERT_EQ(source.close_count, 1u);
+        if (forward_only)
+        {
+            ASSERT_FALSE(source.out_of_order);
+            ASSERT_EQ(source.hint_count, 0u);
+        }
+        else
+        {
+            ASSERT_GT(source.hint_count, 0u);
+        }
+        fclose(source.file);
+    }
+}
+
+// A recording held in memory, written by a streamed recording and read back by a forward-only playback
+struct test_stream_t
+{
+    std::vector<uint8_t> data;
+    size_t read_offset = 0;
+    size_t write_close_count = 0;
+    size_t read_close_count = 0;
+};
+
+static int64_t test_stream_write(void *context, const void *buffer, size_t size)
+{
+    test_stream_t *stream = static_cast<test_stream_t *>(context);
+    const uint8_t *bytes = static_cast<const uint8_t *>(buffer);
+    stream->data.insert(stream->data.end(), bytes, bytes + size);
+    return (int64_t)size;
+}
+
+static void test_stream_write_close(void *context)
+{
+    static_cast<test_stream_t *>(context)->write_close_count++;
+}
+
+static int64_t test_stream_read(void *context, uint64_t offset, void *buffer, size_t size)
+{
+    test_stream_t *stream = static_cast<test_stream_t *>(context);
+    if (offset != stream->read_offset)
+    {
+        return -1;
+    }
+    size_t count = std::min(size, stream->data.size() - stream->read_offset);
+    memcpy(buffer, stream->data.data() + stream->read_offset, count);
+    stream->read_offset += count;
+    return (int64_t)count;
+}
+
+static void test_stream_read_close(void *context)
+{
+    static_cast<test_stream_t *>(context)->read_close_count++;
+}
+
+TEST_F(playback_ut, playback_streamed_recording)
+{
+    k4a_device_configuration_t record_config = {};
+    record_config.color_resolution = K4A_COLOR_RESOLUTION_OFF;
+    record_config.depth_mode = K4A_DEPTH_MODE_NFOV_UNBINNED;
+    record_config.camera_fps = K4A_FRAMES_PER_SECOND_30;
+    uint64_t timestamp_delta = HZ_TO_PERIOD_US(k4a_convert_fps_to_uint(record_config.camera_fps));
+
+    test_stream_t stream;
+    k4a_record_io_callbacks_t record_callbacks = {};
+    record_callbacks.context = &stream;
+    record_callbacks.write = test_stream_write;
+    record_callbacks.close = test_stream_write_close;
+
+    k4a_record_t record_handle = NULL;
+    ASSERT_EQ(k4a_record_create_callbacks(NULL, NULL, record_config, &record_handle), K4A_RESULT_FAILED);
+    ASSERT_EQ(k4a_record_create_callbacks(&record_callbacks, NULL, record_config, &record_handle),
+              K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(k4a_record_set_depth_codec(record_handle, K4A_RECORD_DEPTH_CODEC_RVL), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(k4a_record_add_imu_track(record_handle), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(k4a_record_write_header(record_handle), K4A_RESULT_SUCCEEDED);
+
+    // The header is passed on as soon as it is written, so a client can start reading
+    ASSERT_GT(stream.data.size(), 0u);
+
+    uint64_t timestamps[3] = { 0, 1000, 1000 };
+    for (size_t i = 0; i < test_frame_count; i++)
+    {
+        k4a_capture_t capture = create_test_capture(timestamps,
+                                                    record_config.color_format,
+                                                    record_config.color_resolution,
+                                                    record_config.depth_mode);
+        ASSERT_EQ(k4a_record_write_capture(record_handle, capture), K4A_RESULT_SUCCEEDED);
+        k4a_capture_release(capture);
+        ASSERT_EQ(k4a_record_write_imu_sample(record_handle, create_test_imu_sample(timestamps[1])),
+                  K4A_RESULT_SUCCEEDED);
+        timestamps[1] += timestamp_delta;
+        timestamps[2] += timestamp_delta;
+    }
+    ASSERT_EQ(k4a_record_flush(record_handle), K4A_RESULT_SUCCEEDED);
+
+    // Flushing a streamed recording only appends its clusters
+    size_t flushed_size = stream.data.size();
+    std::vector<uint8_t> flushed_data = stream.data;
+    k4a_record_close(record_handle);
+    ASSERT_EQ(stream.write_close_count, 1u);
+    ASSERT_GE(stream.data.size(), flushed_size);
+    ASSERT_TRUE(std::equal(flushed_data.begin(), flushed_data.end(), stream.data.begin()));
+
+    k4a_playback_io_callbacks_t playback_callbacks = {};
+    playback_callbacks.context = &stream;
+    playback_callbacks.read = test_stream_read;
+    playback_callbacks.close = test_stream_read_close;
+    playback_callbacks.forward_only = true;
+
+    k4a_playback_t handle = NULL;
+    ASSERT_EQ(k4a_playback_open_callbacks(&playback_callbacks, &handle), K4A_RESULT_SUCCEEDED);
+
+    // The segment info of a stream has no duration
+    ASSERT_EQ(k4a_playback_get_recording_length_usec(handle), 0u);
+
+    k4a_record_configuration_t config;
+    ASSERT_EQ(k4a_playback_get_record_configuration(handle, &config), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(config.depth_mode, record_config.depth_mode);
+    ASSERT_TRUE(config.imu_track_enabled);
+
+    timestamps[1] = 1000;
+    timestamps[2] = 1000;
+    k4a_capture_t capture = NULL;
+    for (size_t i = 0; i < test_frame_count; i++)
+    {
+        ASSERT_EQ(k4a_playback_get_next_capture(handle, &capture), K4A_STREAM_RESULT_SUCCEEDED);
+        ASSERT_TRUE(validate_test_capture(capture,
+                                          timestamps,
+                                          record_config.color_format,
+                                          record_config.color_resolution,
+                                          record_config.depth_mode));
+        k4a_capture_release(capture);
+        timestamps[1] += timestamp_delta;
+        timestamps[2] += timestamp_delta;
+    }
+    ASSERT_EQ(k4a_playback_get_next_capture(handle, &capture), K4A_STREAM_RESULT_EOF);
+
+    k4a_playback_close(handle);
+    ASSERT_EQ(stream.read_close_count, 1u);
+}
+
+TEST_F(playback_ut, recording_index_sidecar)
+{
+    k4a_device_configuration_t record_config = {};
+    record_config.color_resolution = K4A_COLOR_RESOLUTION_OFF;
+    record_config.depth_mode = K4A_DEPTH_MODE_NFOV_UNBINNED;
+    record_config.camera_fps = K4A_FRAMES_PER_SECOND_30;
+    uint64_t timestamp_delta = HZ_TO_PERIOD_US(k4a_convert_fps_to_uint(record_config.camera_fps));
+
+    // The recording writes its index when closed
+    SETENV("K4A_RECORDING_INDEX", "1");
+    k4a_record_t record_handle = NULL;
+    ASSERT_EQ(k4a_record_create("record_test_index.mkv", NULL, record_config, &record_handle), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(k4a_record_write_header(record_handle), K4A_RESULT_SUCCEEDED);
+    uint64_t timestamps[3] = { 0, 1000, 1000 };
+    for (size_t i = 0; i < test_frame_count; i++)
+    {
+        k4a_capture_t capture = create_test_capture(timestamps,
+                                                    record_config.color_format,
+                                                    record_config.color_resolution,
+                                                    record_config.depth_mode);
+        ASSERT_EQ(k4a_record_write_capture(record_handle, capture), K4A_RESULT_SUCCEEDED);
+        k4a_capture_release(capture);
+        timestamps[1] += timestamp_delta;
+        timestamps[2] += timestamp_delta;
+    }
+    k4a_record_close(record_handle);
+    SETENV("K4A_RECORDING_INDEX", "0");
+
+    std::vector<k4arecord::recording_index_cluster_t> clusters;
+    ASSERT_EQ(k4arecord::read_recording_index("record_test_index.mkv", MATROSKA_TIMESCALE_NS * 10, &clusters),
+              K4A_RESULT_FAILED);
+    ASSERT_EQ(k4arecord::read_recording_index("record_test_index.mkv", MATROSKA_TIMESCALE_NS, &clusters),
+              K4A_RESULT_SUCCEEDED);
+    ASSERT_GT(clusters.size(), 1u);
+    for (size_t i = 1; i < clusters.size(); i++)
+    {
+        ASSERT_EQ(clusters[i].file_offset, clusters[i - 1].file_offset + clusters[i - 1].cluster_size);
+        ASSERT_GT(clusters[i].timestamp_ns, clusters[i - 1].timestamp_ns);
+    }
+
+    // Playback is the same with the index, and with an index that doesn't match the recording, which is ignored
+    for (int corrupt = 0; corrupt < 2; corrupt++)
+    {
+        if (corrupt)
+        {
+            clusters[1].file_offset++;
+            ASSERT_EQ(k4arecord::write_recording_index("record_test_index.mkv", MATROSKA_TIMESCALE_NS, clusters),
+                      K4A_RESULT_SUCCEEDED);
+        }
+
+        k4a_playback_t handle = NULL;
+        ASSERT_EQ(k4a_playback_open("record_test_index.mkv", &handle), K4A_RESULT_SUCCEEDED);
+
+        timestamps[1] = 1000;
+        timestamps[2] = 1000;
+        k4a_capture_t capture = NULL;
+        for (size_t i = 0; i < test_frame_count; i++)
+        {
+            ASSERT_EQ(k4a_playback_get_next_capture(handle, &capture), K4A_STREAM_RESULT_SUCCEEDED);
+            ASSERT_TRUE(validate_test_capture(capture,
+                                              timestamps,
+                                              record_config.color_format,
+                                              record_config.color_resolution,
+                                              record_config.depth_mode));
+            k4a_capture_release(capture);
+            timestamps[1] += timestamp_delta;
+            timestamps[2] += timestamp_delta;
+        }
+        ASSERT_EQ(k4a_playback_get_next_capture(handle, &capture), K4A_STREAM_RESULT_EOF);
+
+        ASSERT_EQ(k4a_playback_seek_timestamp(handle, 0, K4A_PLAYBACK_SEEK_END), K4A_RESULT_SUCCEEDED);
+        ASSERT_EQ(k4a_playback_get_previous_capture(handle, &capture), K4A_STREAM_RESULT_SUCCEEDED);
+        k4a_capture_release(capture);
+        k4a_playback_close(handle);
+    }
+
+    ASSERT_EQ(std::remove("record_test_index.mkv" RECORDING_INDEX_EXTENSION), 0);
+    ASSERT_EQ(std::remove("record_test_index.mkv"), 0);
+}
+
+TEST_F(playback_ut, recording_segments)
+{
+    k4a_device_configuration_t record_config = {};
+    record_config.color_resolution = K4A_COLOR_RESOLUTION_OFF;
+    record_config.depth_mode = K4A_DEPTH_MODE_NFOV_UNBINNED;
+    record_config.camera_fps = K4A_FRAMES_PER_SECOND_30;
+    uint64_t timestamp_delta = HZ_TO_PERIOD_US(k4a_convert_fps_to_uint(record_config.camera_fps));
+
+    // Start a new segment every second of the recording
+    k4a_record_t record_handle = NULL;
+    ASSERT_EQ(k4a_record_create("record_test_segments.mkv", NULL, record_config, &record_handle),
+              K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(k4a_record_set_segment_limits(record_handle, 1000000, 0), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(k4a_record_write_header(record_handle), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(k4a_record_set_segment_limits(record_handle, 0, 0), K4A_RESULT_FAILED);
+    uint64_t timestamps[3] = { 0, 1000, 1000 };
+    for (size_t i = 0; i < test_frame_count; i++)
+    {
+        k4a_capture_t capture = create_test_capture(timestamps,
+                                                    record_config.color_format,
+                                                    record_config.color_resolution,
+                                                    record_config.depth_mode);
+        ASSERT_EQ(k4a_record_write_capture(record_handle, capture), K4A_RESULT_SUCCEEDED);
+        k4a_capture_release(capture);
+        timestamps[1] += timestamp_delta;
+        timestamps[2] += timestamp_delta;
+    }
+    k4a_record_close(record_handle);
+
+    k4a_playback_segments_t handle = NULL;
+    ASSERT_EQ(k4a_playback_segments_open("record_test_segments.mkv", &handle), K4A_RESULT_SUCCEEDED);
+    size_t segment_count = k4a_playback_segments_get_count(handle);
+    ASSERT_GT(segment_count, 1u);
+
+    // Each segment is a recording of its own, tagged with its index
+    for (size_t i = 0; i < segment_count; i++)
+    {
+        k4a_playback_t segment = NULL;
+        ASSERT_EQ(k4a_playback_segments_get_playback(handle, i, &segment), K4A_RESULT_SUCCEEDED);
+        char index_str[16];
+        size_t index_size = sizeof(index_str);
+        ASSERT_EQ(k4a_playback_get_tag(segment, "K4A_SEGMENT_INDEX", index_str, &index_size),
+                  K4A_BUFFER_RESULT_SUCCEEDED);
+        ASSERT_EQ(std::to_string(i), index_str);
+    }
+
+    // The captures are read in order across the segments
+    timestamps[1] = 1000;
+    timestamps[2] = 1000;
+    k4a_capture_t capture = NULL;
+    for (size_t i = 0; i < test_frame_count; i++)
+    {
+        ASSERT_EQ(k4a_playback_segments_get_next_capture(handle, &capture), K4A_STREAM_RESULT_SUCCEEDED);
+        ASSERT_TRUE(validate_test_capture(capture,
+                                          timestamps,
+                                          record_config.color_format,
+                                          record_config.color_resolution,
+                                          record_config.depth_mode));
+        k4a_capture_release(capture);
+        timestamps[1] += timestamp_delta;
+        timestamps[2] += timestamp_delta;
+    }
+    ASSERT_EQ(k4a_playback_segments_get_next_capture(handle, &capture), K4A_STREAM_RESULT_EOF);
+
+    // Seek into the middle of the recording and read back across a segment boundary
+    size_t middle = test_frame_count / 2;
+    timestamps[1] = 1000 + timestamp_delta * middle;
+    timestamps[2] = timestamps[1];
+    ASSERT_EQ(k4a_playback_segments_seek_timestamp(handle, (int64_t)timestamps[1], K4A_PLAYBACK_SEEK_DEVICE_TIME),
+              K4A_RESULT_SUCCEEDED);
+    for (size_t i = middle; i > 0; i--)
+    {
+        timestamps[1] -= timestamp_delta;
+        timestamps[2] -= timestamp_delta;
+        ASSERT_EQ(k4a_playback_segments_get_previous_capture(handle, &capture), K4A_STREAM_RESULT_SUCCEEDED);
+        ASSERT_TRUE(validate_test_capture(capture,
+                                          timestamps,
+                                          record_config.color_format,
+                                          record_config.color_resolution,
+                                          record_config.depth_mode));
+        k4a_capture_release(capture);
+    }
+    ASSERT_EQ(k4a_playback_segments_get_previous_capture(handle, &capture), K4A_STREAM_RESULT_EOF);
+
+    ASSERT_EQ(k4a_playback_segments_seek_timestamp(handle, 0, K4A_PLAYBACK_SEEK_END), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(k4a_playback_segments_get_previous_capture(handle, &capture), K4A_STREAM_RESULT_SUCCEEDED);
+    timestamps[1] = 1000 + timestamp_delta * (test_frame_count - 1);
+    timestamps[2] = timestamps[1];
+    ASSERT_TRUE(validate_test_capture(capture,
+                                      timestamps,
+                                      record_config.color_format,
+                                      record_config.color_resolution,
+                                      record_config.depth_mode));
+    k4a_capture_release(capture);
+    k4a_playback_segments_close(handle);
+
+    for (size_t i = 0; i < segment_count; i++)
+    {
+        ASSERT_EQ(std::remove(k4arecord::get_segment_path("record_test_segments.mkv", (uint32_t)i).c_str()), 0);
+    }
+}
+
+TEST_F(playback_ut, recording_preallocation)
+{
+    k4a_device_configuration_t record_config = {};
+    record_config.color_resolution = K4A_COLOR_RESOLUTION_OFF;
+    record_config.depth_mode = K4A_DEPTH_MODE_NFOV_UNBINNED;
+    record_config.camera_fps = K4A_FRAMES_PER_SECOND_30;
+    uint64_t timestamp_delta = HZ_TO_PERIOD_US(k4a_convert_fps_to_uint(record_config.camera_fps));
+
+    k4a_record_t record_handle = NULL;
+    ASSERT_EQ(k4a_record_create("record_test_preallocation.mkv", NULL, record_config, &record_handle),
+              K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(k4a_record_set_preallocation(record_handle, 16 * 1024 * 1024, 64 * 1024), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(k4a_record_write_header(record_handle), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(k4a_record_set_preallocation(record_handle, 0, 0), K4A_RESULT_FAILED);
+    uint64_t timestamps[3] = { 0, 1000, 1000 };
+    for (size_t i = 0; i < test_frame_count; i++)
+    {
+        k4a_capture_t capture = create_test_capture(timestamps,
+                                                    record_config.color_format,
+                                                    record_config.color_resolution,
+                                                    record_config.depth_mode);
+        ASSERT_EQ(k4a_record_write_capture(record_handle, capture), K4A_RESULT_SUCCEEDED);
+        k4a_capture_release(capture);
+        timestamps[1] += timestamp_delta;
+        timestamps[2] += timestamp_delta;
+    }
+    k4a_record_close(record_handle);
+
+    // The Cues are written in the space reserved before the first cluster
+    {
+        std::ifstream file("record_test_preallocation.mkv", std::ios::binary);
+        std::vector<char> head(256 * 1024);
+        file.read(head.data(), (std::streamsize)head.size());
+        const char cues_id[] = { '\x1C', '\x53', '\xBB', '\x6B' };
+        const char cluster_id[] = { '\x1F', '\x43', '\xB6', '\x75' };
+        auto cues = std::search(head.begin(), head.end(), std::begin(cues_id), std::end(cues_id));
+        auto cluster = std::search(head.begin(), head.end(), std::begin(cluster_id), std::end(cluster_id));
+        ASSERT_NE(cues, head.end());
+        ASSERT_NE(cluster, head.end());
+        ASSERT_LT(cues, cluster);
+    }
+
+    k4a_playback_t handle = NULL;
+    ASSERT_EQ(k4a_playback_open("record_test_preallocation.mkv", &handle), K4A_RESULT_SUCCEEDED);
+    timestamps[1] = 1000 + timestamp_delta * (test_frame_count / 2);
+    timestamps[2] = timestamps[1];
+    ASSERT_EQ(k4a_playback_seek_timestamp(handle, (int64_t)timestamps[1], K4A_PLAYBACK_SEEK_DEVICE_TIME),
+              K4A_RESULT_SUCCEEDED);
+    k4a_capture_t capture = NULL;
+    ASSERT_EQ(k4a_playback_get_next_capture(handle, &capture), K4A_STREAM_RESULT_SUCCEEDED);
+    ASSERT_TRUE(validate_test_capture(capture,
+                                      timestamps,
+                                      record_config.color_format,
+                                      record_config.color_resolution,
+                                      record_config.depth_mode));
+    k4a_capture_release(capture);
+    k4a_playback_close(handle);
+
+    ASSERT_EQ(std::remove("record_test_preallocation.mkv"), 0);
+}
+
+TEST_F(playback_ut, open_rvl_file)
+{
+    k4a_playback_t handle = NULL;
+    k4a_result_t result = k4a_playback_open("record_test_rvl.mkv", &handle);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+    k4a_record_configuration_t config;
+    result = k4a_playback_get_record_configuration(handle, &config);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+    ASSERT_TRUE(config.depth_track_enabled);
+    ASSERT_TRUE(config.ir_track_enabled);
+
+    const char *track_names[] = { "DEPTH", "IR" };
+    for (const char *track_name : track_names)
+    {
+        k4arecord::BITMAPINFOHEADER codec_header;
+        size_t data_size = sizeof(codec_header);
+        ASSERT_EQ(k4a_playback_track_get_codec_context(handle,
+                                                       track_name,
+                                                       reinterpret_cast<uint8_t *>(&codec_header),
+                                                       &data_size),
+                  K4A_BUFFER_RESULT_SUCCEEDED);
+        ASSERT_EQ(codec_header.biCompression, static_cast<uint32_t>(K4A_FOURCC_GRAY16_RVL));
+    }
+
+    // Every image decompresses to the one that was written
+    uint64_t timestamps[3] = { 0, 1000, 1000 };
+    uint32_t timestamp_delta = HZ_TO_PERIOD_US(k4a_convert_fps_to_uint(config.camera_fps));
+    for (size_t i = 0; i < test_frame_count; i++)
+    {
+        k4a_capture_t capture = NULL;
+        k4a_stream_result_t stream_result = k4a_playback_get_next_capture(handle, &capture);
+        ASSERT_EQ(stream_result, K4A_STREAM_RESULT_SUCCEEDED);
+        ASSERT_TRUE(validate_test_capture(capture,
+                                          timestamps,
+                                          config.color_format,
+                                          config.color_resolution,
+                                          config.depth_mode));
+        k4a_capture_release(capture);
+
+        timestamps[0] += timestamp_delta;
+        timestamps[1] += timestamp_delta;
+        timestamps[2] += timestamp_delta;
+    }
+
+    k4a_playback_close(handle);
+}
+
+TEST_F(playback_ut, open_dropped_samples_file)
+{
+    k4a_playback_t handle = NULL;
+    k4a_result_t result = k4a_playback_open("record_test_dropped.mkv", &handle);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+    // The depth and IR images didn't fit in the write queue
+    char tag_value[32];
+    size_t tag_value_size = sizeof(tag_value);
+    k4a_buffer_result_t buffer_result = k4a_playback_get_tag(handle,
+                                                             "K4A_DROPPED_SAMPLE_COUNT",
+                                                             tag_value,
+                                                             &tag_value_size);
+    ASSERT_EQ(buffer_result, K4A_BUFFER_RESULT_SUCCEEDED);
+    ASSERT_STREQ(tag_value, "2");
+
+    k4a_capture_t capture = NULL;
+    k4a_stream_result_t stream_result = k4a_playback_get_next_capture(handle, &capture);
+    ASSERT_EQ(stream_result, K4A_STREAM_RESULT_SUCCEEDED);
+    k4a_image_t color_image = k4a_capture_get_color_image(capture);
+    k4a_image_t depth_image = k4a_capture_get_depth_image(capture);
+    ASSERT_NE(color_image, nullptr);
+    ASSERT_EQ(depth_image, nullptr);
+    k4a_image_release(color_image);
+    k4a_capture_release(capture);
+
+    stream_result = k4a_playback_get_next_capture(handle, &capture);
+    ASSERT_EQ(stream_result, K4A_STREAM_RESULT_EOF);
+
+    k4a_playback_close(handle);
+}
+
+TEST_F(playback_ut, open_recording_group_files)
+{
+    const char *paths[2] = { "record_test_group_1.mkv", "record_test_group_2.mkv" };
+    for (const char *path : paths)
+    {
+        k4a_playback_t handle = NULL;
+        k4a_result_t result = k4a_playback_open(path, &handle);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+        k4a_record_configuration_t config;
+        result = k4a_playback_get_record_configuration(handle, &config);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+        // Every capture is written once and in order by the shared writer thread
+        uint64_t timestamps[3] = { 0, 1000, 1000 };
+        uint64_t timestamp_delta = HZ_TO_PERIOD_US(k4a_convert_fps_to_uint(config.camera_fps));
+        k4a_capture_t capture = NULL;
+        for (size_t i = 0; i < test_frame_count; i++)
+        {
+            k4a_stream_result_t stream_result = k4a_playback_get_next_capture(handle, &capture);
+            ASSERT_EQ(stream_result, K4A_STREAM_RESULT_SUCCEEDED);
+            ASSERT_TRUE(validate_test_capture(capture,
+                                              timestamps,
+                                              config.color_format,
+                                              config.color_resolution,
+                                              config.depth_mode));
+            k4a_capture_release(capture);
+            timestamps[0] += timestamp_delta;
+            timestamps[1] += timestamp_delta;
+            timestamps[2] += timestamp_delta;
+        }
+        k4a_stream_result_t stream_result = k4a_playback_get_next_capture(handle, &capture);
+        ASSERT_EQ(stream_result, K4A_STREAM_RESULT_EOF);
+
+        k4a_playback_close(handle);
+    }
+}
+
+TEST_F(playback_ut, playback_group)
+{
+    const char *paths[2] = { "record_test_group_1.mkv", "record_test_group_2.mkv" };
+    k4a_playback_group_t group = NULL;
+    ASSERT_EQ(k4a_playback_group_open(paths, 2, 1, &group), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(k4a_playback_group_get_count(group), 2u);
+    ASSERT_NE(k4a_playback_group_get_playback(group, 1), nullptr);
+    ASSERT_EQ(k4a_playback_group_get_playback(group, 2), nullptr);
+
+    k4a_record_configuration_t config;
+    ASSERT_EQ(k4a_playback_get_record_configuration(k4a_playback_group_get_playback(group, 0), &config),
+              K4A_RESULT_SUCCEEDED);
+
+    // The recordings were written with the same timestamps, so every capture is matched
+    uint64_t timestamps[3] = { 0, 1000, 1000 };
+    uint64_t timestamp_delta = HZ_TO_PERIOD_US(k4a_convert_fps_to_uint(config.camera_fps));
+    k4a_capture_t captures[2] = { NULL, NULL };
+    for (size_t i = 0; i < test_frame_count; i++)
+    {
+        ASSERT_EQ(k4a_playback_group_get_next_captures(group, captures), K4A_STREAM_RESULT_SUCCEEDED);
+        for (k4a_capture_t capture : captures)
+        {
+            ASSERT_NE(capture, nullptr);
+            ASSERT_TRUE(validate_test_capture(capture,
+                                              timestamps,
+                                              config.color_format,
+                                              config.color_resolution,
+                                              config.depth_mode));
+            k4a_capture_release(capture);
+        }
+        timestamps[0] += timestamp_delta;
+        timestamps[1] += timestamp_delta;
+        timestamps[2] += timestamp_delta;
+    }
+    ASSERT_EQ(k4a_playback_group_get_next_captures(group, captures), K4A_STREAM_RESULT_EOF);
+
+    // Seeking moves both recordings back to their first capture
+    ASSERT_EQ(k4a_playback_group_seek_timestamp(group, 0, K4A_PLAYBACK_SEEK_BEGIN), K4A_RESULT_SUCCEEDED);
+    timestamps[0] = 0;
+    timestamps[1] = timestamps[2] = 1000;
+    ASSERT_EQ(k4a_playback_group_get_next_captures(group, captures), K4A_STREAM_RESULT_SUCCEEDED);
+    for (k4a_capture_t capture : captures)
+    {
+        ASSERT_NE(capture, nullptr);
+        ASSERT_TRUE(validate_test_capture(capture,
+                                          timestamps,
+                                          config.color_format,
+                                          config.color_resolution,
+                                          config.depth_mode));
+        k4a_capture_release(capture);
+    }
+
+    k4a_playback_group_close(group);
+}
+
+TEST_F(playback_ut, set_color_decode)
+{
+    k4a_playback_t handle = NULL;
+    k4a_result_t result = k4a_playback_open("record_test_depth_only.mkv", &handle);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+    // The configuration needs a color track
+    k4a_color_decode_configuration_t decode = K4A_COLOR_DECODE_CONFIG_INIT_FULL_RESOLUTION;
+    ASSERT_EQ(k4a_playback_set_color_decode(handle, &decode), K4A_RESULT_FAILED);
+    k4a_playback_close(handle);
+
+    result = k4a_playback_open("record_test_bgra_color.mkv", &handle);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(k4a_playback_set_color_decode(handle, &decode), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(k4a_playback_set_color_decode(handle, NULL), K4A_RESULT_SUCCEEDED);
+
+    decode.scale_denominator = 3;
+    ASSERT_EQ(k4a_playback_set_color_decode(handle, &decode), K4A_RESULT_FAILED);
+    decode.scale_denominator = 0;
+    ASSERT_EQ(k4a_playback_set_color_decode(handle, &decode), K4A_RESULT_FAILED);
+
+    // 1/4 of the centered 960x540 region of the 1080P images
+    decode.scale_denominator = 4;
+    decode.crop = { 480, 272, 960, 540 };
+    ASSERT_EQ(k4a_playback_set_color_decode(handle, &decode), K4A_RESULT_SUCCEEDED);
+
+    // The crop origin must be a multiple of the scale denominator and the crop must fit in the image
+    decode.crop = { 482, 272, 960, 540 };
+    ASSERT_EQ(k4a_playback_set_color_decode(handle, &decode), K4A_RESULT_FAILED);
+    decode.crop = { 960, 272, 968, 540 };
+    ASSERT_EQ(k4a_playback_set_color_decode(handle, &decode), K4A_RESULT_FAILED);
+    decode.crop = { -4, 0, 960, 540 };
+    ASSERT_EQ(k4a_playback_set_color_decode(handle, &decode), K4A_RESULT_FAILED);
+
+    k4a_playback_close(handle);
+}
+
 int main(int argc, char **argv)
 {
     k4a_unittest_init();
@@ -0,0 +1,415 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <utcommon.h>
+#include <k4a/k4a.h>
+#include <k4ainternal/common.h>
+
+#include "test_helpers.h"
+#include <turbojpeg.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Module being tested
+#include <k4arecord/record.h>
+#include <k4arecord/playback.h>
+
+using namespace testing;
+
+// Directories the recordings are written to, e.g. a tmpfs and an NVMe drive. The current directory if none are given.
+static std::vector<std::string> g_record_dirs;
+static uint32_t g_frame_count = 90;
+
+// One recording of synthesized captures, written and then played back from each directory
+struct record_perf_config
+{
+    k4a_image_format_t color_format;
+    k4a_color_resolution_t color_resolution;
+    k4a_depth_mode_t depth_mode;
+};
+
+// Image data shared by every frame of a recording. Each frame wraps it in new images with their own timestamps, so
+// synthesizing a capture costs next to nothing next to writing it.
+struct record_perf_stream
+{
+    k4a_image_format_t format = K4A_IMAGE_FORMAT_CUSTOM;
+    int width = 0;
+    int height = 0;
+    int stride = 0;
+    std::vector<uint8_t> buffer;
+};
+
+static void record_perf_fill_pattern(std::vector<uint8_t> &buffer)
+{
+    for (size_t i = 0; i < buffer.size(); i++)
+    {
+        buffer[i] = (uint8_t)((i * 7) ^ (i >> 11));
+    }
+}
+
+// Playback decodes MJPG for color conversion, so the MJPG payload is a real JPEG of a gradient
+static bool record_perf_create_mjpg(int width, int height, std::vector<uint8_t> &buffer)
+{
+    std::vector<uint8_t> bgra((size_t)width * height * 4);
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            uint8_t *pixel = &bgra[((size_t)y * width + x) * 4];
+            pixel[0] = (uint8_t)x;
+            pixel[1] = (uint8_t)y;
+            pixel[2] = (uint8_t)(x + y);
+            pixel[3] = 0xFF;
+        }
+    }
+
+    tjhandle compressor = tjInitCompress();
+    if (compressor == NULL)
+    {
+        return false;
+    }
+    unsigned char *jpeg = NULL;
+    unsigned long jpeg_size = 0;
+    bool compressed = tjCompress2(compressor,
+                                  bgra.data(),
+                                  width,
+                                  width * 4,
+                                  height,
+                                  TJPF_BGRA,
+                                  &jpeg,
+                                  &jpeg_size,
+                                  TJSAMP_422,
+                                  90,
+                                  TJFLAG_FASTDCT) == 0;
+    if (compressed)
+    {
+        buffer.assign(jpeg, jpeg + jpeg_size);
+    }
+    tjFree(jpeg);
+    tjDestroy(compressor);
+    return compressed;
+}
+
+static bool record_perf_create_streams(const record_perf_config &config,
+                                       record_perf_stream &color,
+                                       record_perf_stream &depth,
+                                       record_perf_stream &ir)
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    if (!k4a_convert_resolution_to_width_height(config.color_resolution, &width, &height))
+    {
+        return false;
+    }
+    color.format = config.color_format;
+    color.width = (int)width;
+    color.height = (int)height;
+    switch (config.color_format)
+    {
+    case K4A_IMAGE_FORMAT_COLOR_MJPG:
+        color.stride = 0;
+        if (!record_perf_create_mjpg(color.width, color.height, color.buffer))
+        {
+            return false;
+        }
+        break;
+    case K4A_IMAGE_FORMAT_COLOR_NV12:
+        color.stride = color.width;
+        color.buffer.resize((size_t)color.width * color.height * 3 / 2);
+        break;
+    case K4A_IMAGE_FORMAT_COLOR_YUY2:
+        color.stride = color.width * 2;
+        color.buffer.resize((size_t)color.stride * color.height);
+        break;
+    default:
+        color.stride = color.width * 4;
+        color.buffer.resize((size_t)color.stride * color.height);
+        break;
+    }
+    if (config.color_format != K4A_IMAGE_FORMAT_COLOR_MJPG)
+    {
+        record_perf_fill_pattern(color.buffer);
+    }
+
+    if (!k4a_convert_depth_mode_to_width_height(config.depth_mode, &width, &height))
+    {
+        return false;
+    }
+    ir.format = K4A_IMAGE_FORMAT_IR16;
+    ir.width = (int)width;
+    ir.height = (int)height;
+    ir.stride = ir.width * (int)sizeof(uint16_t);
+    ir.buffer.resize((size_t)ir.stride * ir.height);
+    record_perf_fill_pattern(ir.buffer);
+
+    // Passive IR has no depth images
+    if (config.depth_mode != K4A_DEPTH_MODE_PASSIVE_IR)
+    {
+        depth = ir;
+        depth.format = K4A_IMAGE_FORMAT_DEPTH16;
+    }
+    return true;
+}
+
+static k4a_result_t record_perf_add_image(k4a_capture_t capture, record_perf_stream &stream, uint64_t timestamp_usec)
+{
+    if (stream.buffer.empty())
+    {
+        return K4A_RESULT_SUCCEEDED;
+    }
+
+    k4a_image_t image = NULL;
+    k4a_result_t result = k4a_image_create_from_buffer(stream.format,
+                                                       stream.width,
+                                                       stream.height,
+                                                       stream.stride,
+                                                       stream.buffer.data(),
+                                                       stream.buffer.size(),
+                                                       NULL,
+                                                       NULL,
+                                                       &image);
+    if (K4A_SUCCEEDED(result))
+    {
+        k4a_image_set_device_timestamp_usec(image, timestamp_usec);
+        switch (stream.format)
+        {
+        case K4A_IMAGE_FORMAT_DEPTH16:
+            k4a_capture_set_depth_image(capture, image);
+            break;
+        case K4A_IMAGE_FORMAT_IR16:
+            k4a_capture_set_ir_image(capture, image);
+            break;
+        default:
+            k4a_capture_set_color_image(capture, image);
+            break;
+        }
+        k4a_image_release(image);
+    }
+    return result;
+}
+
+static size_t record_perf_capture_bytes(k4a_capture_t capture)
+{
+    size_t bytes = 0;
+    k4a_image_t images[] = { k4a_capture_get_color_image(capture),
+                             k4a_capture_get_depth_image(capture),
+                             k4a_capture_get_ir_image(capture) };
+    for (k4a_image_t image : images)
+    {
+        if (image != NULL)
+        {
+            bytes += k4a_image_get_size(image);
+            k4a_image_release(image);
+        }
+    }
+    return bytes;
+}
+
+static void record_perf_print_rate(const char *name, size_t bytes, uint32_t frames, double seconds)
+{
+    printf("    %-28s %9.1f MB/s %8.1f frames/s\n",
+           name,
+           seconds > 0 ? (double)bytes / seconds / 1e6 : 0.0,
+           seconds > 0 ? (double)frames / seconds : 0.0);
+}
+
+static void record_perf_write(const std::string &path, const record_perf_config &config)
+{
+    record_perf_stream color, depth, ir;
+    ASSERT_TRUE(record_perf_create_streams(config, color, depth, ir));
+
+    k4a_device_configuration_t device_config = K4A_DEVICE_CONFIG_INIT_DISABLE_ALL;
+    device_config.color_format = config.color_format;
+    device_config.color_resolution = config.color_resolution;
+    device_config.depth_mode = config.depth_mode;
+    device_config.camera_fps = K4A_FRAMES_PER_SECOND_30;
+
+    k4a_record_t handle = NULL;
+    ASSERT_EQ(k4a_record_create(path.c_str(), NULL, device_config, &handle), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(k4a_record_write_header(handle), K4A_RESULT_SUCCEEDED);
+
+    k4a_record_write_queue_status_t status = {};
+    uint64_t peak_queued_bytes = 0;
+    uint32_t peak_queued_clusters = 0;
+    size_t bytes = 0;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (uint32_t i = 0; i < g_frame_count; i++)
+    {
+        uint64_t timestamp_usec = (uint64_t)i * test_timestamp_delta_usec;
+        k4a_capture_t capture = NULL;
+        ASSERT_EQ(k4a_capture_create(&capture), K4A_RESULT_SUCCEEDED);
+        ASSERT_EQ(record_perf_add_image(capture, color, timestamp_usec), K4A_RESULT_SUCCEEDED);
+        ASSERT_EQ(record_perf_add_image(capture, depth, timestamp_usec), K4A_RESULT_SUCCEEDED);
+        ASSERT_EQ(record_perf_add_image(capture, ir, timestamp_usec), K4A_RESULT_SUCCEEDED);
+        bytes += record_perf_capture_bytes(capture);
+
+        ASSERT_EQ(k4a_record_write_capture(handle, capture), K4A_RESULT_SUCCEEDED);
+        k4a_capture_release(capture);
+
+        ASSERT_EQ(k4a_record_get_write_queue_status(handle, &status), K4A_RESULT_SUCCEEDED);
+        peak_queued_bytes = std::max(peak_queued_bytes, status.queued_bytes);
+        peak_queued_clusters = std::max(peak_queued_clusters, status.queued_cluster_count);
+    }
+    ASSERT_EQ(k4a_record_flush(handle), K4A_RESULT_SUCCEEDED);
+    double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    ASSERT_EQ(k4a_record_get_write_queue_status(handle, &status), K4A_RESULT_SUCCEEDED);
+    k4a_record_close(handle);
+
+    record_perf_print_rate("Record", bytes, g_frame_count, seconds);
+    printf("    %-28s %9.1f MB, %u clusters, %llu samples dropped\n",
+           "Write queue high-water mark",
+           (double)peak_queued_bytes / 1e6,
+           peak_queued_clusters,
+           (unsigned long long)status.dropped_sample_count);
+}
+
+static void record_perf_read(const std::string &path, k4a_image_format_t color_conversion)
+{
+    k4a_playback_t handle = NULL;
+    ASSERT_EQ(k4a_playback_open(path.c_str(), &handle), K4A_RESULT_SUCCEEDED);
+    bool convert = color_conversion != K4A_IMAGE_FORMAT_CUSTOM;
+    if (convert)
+    {
+        ASSERT_EQ(k4a_playback_set_color_conversion(handle, color_conversion), K4A_RESULT_SUCCEEDED);
+    }
+
+    size_t bytes = 0;
+    uint32_t frames = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    while (true)
+    {
+        k4a_capture_t capture = NULL;
+        k4a_stream_result_t result = k4a_playback_get_next_capture(handle, &capture);
+        ASSERT_NE(result, K4A_STREAM_RESULT_FAILED);
+        if (result == K4A_STREAM_RESULT_EOF)
+        {
+            break;
+        }
+        bytes += record_perf_capture_bytes(capture);
+        frames++;
+        k4a_capture_release(capture);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+    k4a_playback_cluster_cache_stats_t stats = {};
+    ASSERT_EQ(k4a_playback_get_cluster_cache_stats(handle, &stats), K4A_RESULT_SUCCEEDED);
+    k4a_playback_close(handle);
+
+    const char *label = !convert ? "Playback" :
+                                   color_conversion == K4A_IMAGE_FORMAT_COLOR_BGRA32 ? "Playback, converted to BGRA" :
+                                                                                       "Playback, converted to NV12";
+    record_perf_print_rate(label, bytes, frames, seconds);
+    printf("    %-28s %llu hits, %llu misses, %llu loads\n",
+           "Cluster cache",
+           (unsigned long long)stats.hit_count,
+           (unsigned long long)stats.miss_count,
+           (unsigned long long)stats.load_count);
+    ASSERT_EQ(frames, g_frame_count);
+}
+
+class record_perf : public ::testing::TestWithParam<record_perf_config>
+{
+};
+
+TEST_P(record_perf, write_and_read)
+{
+    const record_perf_config &config = GetParam();
+    for (const std::string &dir : g_record_dirs)
+    {
+        std::string path = dir + "/record_perf.mkv";
+        printf("%s, %s, %s, %u frames in %s\n",
+               format_names[config.color_format],
+               resolution_names[config.color_resolution],
+               depth_names[config.depth_mode],
+               g_frame_count,
+               dir.c_str());
+
+        record_perf_write(path, config);
+        if (!HasFatalFailure())
+        {
+            record_perf_read(path, K4A_IMAGE_FORMAT_CUSTOM);
+        }
+        if (!HasFatalFailure() && config.color_format != K4A_IMAGE_FORMAT_COLOR_BGRA32)
+        {
+            record_perf_read(path, K4A_IMAGE_FORMAT_COLOR_BGRA32);
+        }
+        if (!HasFatalFailure() && config.color_format == K4A_IMAGE_FORMAT_COLOR_MJPG)
+        {
+            // Decoded straight to YUV planes, without going through BGRA
+            record_perf_read(path, K4A_IMAGE_FORMAT_COLOR_NV12);
+        }
+        remove(path.c_str());
+        if (HasFatalFailure())
+        {
+            return;
+        }
+    }
+}
+
+// Every color format with the same depth mode, and every depth mode with the same color format. NV12 and YUY2 are
+// only supported at 720P.
+static record_perf_config record_perf_configs[] = {
+    { K4A_IMAGE_FORMAT_COLOR_MJPG, K4A_COLOR_RESOLUTION_1080P, K4A_DEPTH_MODE_NFOV_UNBINNED },
+    { K4A_IMAGE_FORMAT_COLOR_NV12, K4A_COLOR_RESOLUTION_720P, K4A_DEPTH_MODE_NFOV_UNBINNED },
+    { K4A_IMAGE_FORMAT_COLOR_YUY2, K4A_COLOR_RESOLUTION_720P, K4A_DEPTH_MODE_NFOV_UNBINNED },
+    { K4A_IMAGE_FORMAT_COLOR_BGRA32, K4A_COLOR_RESOLUTION_1080P, K4A_DEPTH_MODE_NFOV_UNBINNED },
+    { K4A_IMAGE_FORMAT_COLOR_MJPG, K4A_COLOR_RESOLUTION_1080P, K4A_DEPTH_MODE_NFOV_2X2BINNED },
+    { K4A_IMAGE_FORMAT_COLOR_MJPG, K4A_COLOR_RESOLUTION_1080P, K4A_DEPTH_MODE_WFOV_2X2BINNED },
+    { K4A_IMAGE_FORMAT_COLOR_MJPG, K4A_COLOR_RESOLUTION_1080P, K4A_DEPTH_MODE_WFOV_UNBINNED },
+    { K4A_IMAGE_FORMAT_COLOR_MJPG, K4A_COLOR_RESOLUTION_1080P, K4A_DEPTH_MODE_PASSIVE_IR },
+};
+
+INSTANTIATE_TEST_CASE_P(color_and_depth, record_perf, ValuesIn(record_perf_configs));
+
+int main(int argc, char **argv)
+{
+    bool error = false;
+    k4a_unittest_init();
+
+    ::testing::InitGoogleTest(&argc, argv);
+
+    for (int i = 1; i < argc; ++i)
+    {
+        char *argument = argv[i];
+        if (strcmp(argument, "--dir") == 0 && i + 1 < argc)
+        {
+            g_record_dirs.push_back(argv[++i]);
+        }
+        else if (strcmp(argument, "--frame_count") == 0 && i + 1 < argc)
+        {
+            long frame_count = strtol(argv[++i], NULL, 10);
+            error = error || frame_count <= 0;
+            g_frame_count = (uint32_t)frame_count;
+        }
+        else
+        {
+            error = true;
+        }
+    }
+
+    if (error)
+    {
+        printf("\n\nOptional Custom Test Settings:\n");
+        printf("  --dir <directory>\n");
+        printf("      Directory the recordings are written to and played back from, may be given more than once,\n");
+        printf("      e.g. --dir /dev/shm --dir /mnt/nvme. The current directory by default.\n");
+        printf("  --frame_count <count>\n");
+        printf("      Number of captures in each recording; default is 90\n");
+        return 1; // Indicates an error or warning
+    }
+
+    if (g_record_dirs.empty())
+    {
+        g_record_dirs.push_back(".");
+    }
+
+    int results = RUN_ALL_TESTS();
+    k4a_unittest_deinit();
+    return results;
+}
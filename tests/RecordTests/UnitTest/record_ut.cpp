@@ -2,7 +2,10 @@
 // Licensed under the MIT License.
 
 #include <utcommon.h>
+#include <algorithm>
+#include <cstdio>
 #include <iostream>
+#include <vector>
 
 // Module being tested
 #include <k4ainternal/matroska_write.h>
@@ -132,6 +135,177 @@ TEST_F(record_ut, new_cluster_out_of_order)
     ASSERT_EQ(context->pending_clusters.size(), 3u);
 }
 
+TEST_F(record_ut, new_clusters_custom_length)
+{
+    context->cluster_length_ns = 10_ms;
+
+    cluster_t *cluster1 = get_cluster_for_timestamp(context, 5_ms);
+    ASSERT_NE(cluster1, nullptr);
+    ASSERT_EQ(cluster1->time_start_ns, 0);
+    ASSERT_EQ(cluster1->time_end_ns, 10_ms);
+
+    // Empty ranges are skipped, new clusters stay aligned to the cluster length
+    cluster_t *cluster2 = get_cluster_for_timestamp(context, 35_ms);
+    ASSERT_NE(cluster2, nullptr);
+    ASSERT_EQ(cluster2->time_start_ns, 30_ms);
+    ASSERT_EQ(cluster2->time_end_ns, 40_ms);
+
+    ASSERT_EQ(get_cluster_for_timestamp(context, 9_ms), cluster1);
+    ASSERT_EQ(context->pending_clusters.size(), 2u);
+}
+
+TEST_F(record_ut, staged_track_data)
+{
+    context->cluster_length_ns = 10_ms;
+    track_header_t &color_track = context->tracks["COLOR"];
+    track_header_t &imu_track = context->tracks["IMU"];
+    color_track.stage = std::make_shared<track_stage_t>();
+    imu_track.stage = std::make_shared<track_stage_t>();
+
+    binary payload[16] = {};
+    auto stage = [&](track_header_t &track, uint64_t timestamp_ns) {
+        track_data_t data = { &track, new libmatroska::DataBuffer(payload, sizeof(payload)), nullptr, sizeof(payload) };
+        track.stage->data.push_back(std::make_pair(timestamp_ns, data));
+    };
+
+    // Blocks of each track are moved into the cluster of their timestamp
+    stage(color_track, 15_ms);
+    stage(color_track, 5_ms);
+    stage(imu_track, 25_ms);
+    stage(imu_track, 6_ms);
+    stage_pending_track_data(context);
+
+    ASSERT_TRUE(color_track.stage->data.empty());
+    ASSERT_TRUE(imu_track.stage->data.empty());
+    ASSERT_EQ(context->pending_clusters.size(), 3u);
+    ASSERT_EQ(context->pending_bytes, 4 * sizeof(payload));
+    ASSERT_EQ(context->most_recent_timestamp, 25_ms);
+
+    cluster_t *cluster = get_cluster_for_timestamp(context, 0);
+    ASSERT_EQ(cluster->data.size(), 2u);
+    ASSERT_EQ(cluster->size_bytes, 2 * sizeof(payload));
+
+    // A block staged after its cluster was written is dropped
+    for (cluster_t *pending : context->pending_clusters)
+    {
+        for (std::pair<uint64_t, track_data_t> &data : pending->data)
+        {
+            delete data.second.buffer;
+        }
+        delete pending;
+    }
+    context->pending_clusters.clear();
+    context->last_written_timestamp = 30_ms;
+
+    stage(color_track, 29_ms);
+    stage_pending_track_data(context);
+    ASSERT_TRUE(context->pending_clusters.empty());
+    ASSERT_EQ(context->dropped_sample_count, 1u);
+}
+
+TEST_F(record_ut, rvl_round_trip)
+{
+    // Runs of holes, smooth surfaces, and the largest deltas in both directions
+    std::vector<uint16_t> pixels(4099);
+    for (size_t i = 0; i < pixels.size(); i++)
+    {
+        pixels[i] = (uint16_t)(i % 97 < 20 ? 0 : 1000 + (i * 7) % 300);
+    }
+    pixels[500] = 65535;
+    pixels[501] = 1;
+    pixels[502] = 65535;
+    pixels.back() = 0;
+
+    for (size_t count : { (size_t)0, (size_t)1, (size_t)7, pixels.size() })
+    {
+        std::vector<uint8_t> encoded(rvl_encode_bound(count));
+        size_t size = rvl_encode(pixels.data(), count, encoded.data());
+        ASSERT_LE(size, encoded.size());
+        ASSERT_EQ(size % sizeof(uint32_t), 0u);
+
+        std::vector<uint16_t> decoded(count, 0xFFFF);
+        ASSERT_TRUE(rvl_decode(encoded.data(), size, decoded.data(), count));
+        ASSERT_TRUE(std::equal(decoded.begin(), decoded.end(), pixels.begin())) << count << " pixels";
+
+        if (count > 1)
+        {
+            // Truncated streams and streams of fewer pixels are rejected
+            ASSERT_FALSE(rvl_decode(encoded.data(), size - sizeof(uint32_t), decoded.data(), count));
+            decoded.push_back(0);
+            ASSERT_FALSE(rvl_decode(encoded.data(), size, decoded.data(), count + 1));
+        }
+    }
+
+    // The worst case, alternating holes and the largest deltas, stays within the bound
+    std::vector<uint16_t> worst(1000);
+    for (size_t i = 0; i < worst.size(); i++)
+    {
+        worst[i] = (uint16_t)(i % 2 == 0 ? 0 : (i % 4 == 1 ? 65535 : 1));
+    }
+    std::vector<uint8_t> encoded(rvl_encode_bound(worst.size()));
+    ASSERT_LE(rvl_encode(worst.data(), worst.size(), encoded.data()), encoded.size());
+}
+
+TEST_F(record_ut, unbuffered_file_io)
+{
+    std::unique_ptr<UnbufferedFileIOCallback> file;
+    try
+    {
+        file = make_unique<UnbufferedFileIOCallback>("record_test_unbuffered.bin");
+    }
+    catch (std::ios_base::failure &e)
+    {
+        std::cout << "Unbuffered IO is not supported here, skipping: " << e.what() << std::endl;
+        return;
+    }
+
+    // Several buffers of appends, with rewrites of flushed, in flight and buffered data, and a gap past the end
+    std::vector<uint8_t> expected(20 * 1024 * 1024 + 1234);
+    for (size_t i = 0; i < expected.size(); i++)
+    {
+        expected[i] = (uint8_t)(i * 31 + i / 4099);
+    }
+    for (size_t offset = 0; offset < expected.size(); offset += 100003)
+    {
+        ASSERT_EQ(file->write(expected.data() + offset, std::min((size_t)100003, expected.size() - offset)),
+                  std::min((size_t)100003, expected.size() - offset));
+    }
+    ASSERT_EQ(file->getFilePointer(), expected.size());
+    ASSERT_LT(file->getWritesInFlight(), 4u);
+
+    const size_t rewrites[][2] = { { 10, 5000 }, { 8 * 1024 * 1024 - 3, 9 }, { 16 * 1024 * 1024 - 100, 300 },
+                                   { expected.size() - 7, 7 } };
+    for (const auto &rewrite : rewrites)
+    {
+        std::vector<uint8_t> data(rewrite[1], 0xA5);
+        file->setFilePointer((int64)rewrite[0]);
+        ASSERT_EQ(file->write(data.data(), data.size()), data.size());
+        std::copy(data.begin(), data.end(), expected.begin() + (std::ptrdiff_t)rewrite[0]);
+
+        std::vector<uint8_t> read(rewrite[1] + 9);
+        file->setFilePointer((int64)rewrite[0] - 4);
+        uint32 size = file->read(read.data(), read.size());
+        ASSERT_EQ(size, std::min(read.size(), expected.size() - rewrite[0] + 4));
+        ASSERT_TRUE(std::equal(read.begin(), read.begin() + size, expected.begin() + (std::ptrdiff_t)rewrite[0] - 4));
+    }
+
+    file->setFilePointer(100, libebml::seek_end);
+    uint8_t tail = 0x5A;
+    ASSERT_EQ(file->write(&tail, 1), 1u);
+    expected.resize(expected.size() + 100, 0);
+    expected.push_back(tail);
+    file->close();
+
+    // The file is exactly the data written, without the alignment padding
+    LargeFileIOCallback reader("record_test_unbuffered.bin", MODE_READ);
+    std::vector<uint8_t> actual(expected.size() + 1);
+    ASSERT_EQ(reader.read(actual.data(), actual.size()), expected.size());
+    actual.pop_back();
+    ASSERT_TRUE(actual == expected);
+    reader.close();
+    ASSERT_EQ(std::remove("record_test_unbuffered.bin"), 0);
+}
+
 // This test's goal is to fill up the write queue by saturating disk write.
 // It should trigger the write speed warning message in the logs.
 // Since this test is unlikely to complete, and needs to be manually run, it is disabled.
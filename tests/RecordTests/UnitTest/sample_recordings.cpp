@@ -3,7 +3,9 @@
 
 #include "test_helpers.h"
 
+#include <atomic>
 #include <cstdio>
+#include <cstring>
 #include <k4arecord/record.h>
 #include <k4ainternal/common.h>
 #include <k4ainternal/matroska_write.h>
@@ -92,9 +94,20 @@ void SampleRecordings::SetUp()
             }
         }
 
+        // The newest data is held in memory until it is old enough to be written, or flushed
+        k4a_record_write_queue_status_t status;
+        result = k4a_record_get_write_queue_status(handle, &status);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+        ASSERT_GT(status.queued_cluster_count, 0u);
+        ASSERT_GT(status.queued_usec, 0u);
+
         result = k4a_record_flush(handle);
         ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
 
+        result = k4a_record_get_write_queue_status(handle, &status);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+        ASSERT_EQ(status.queued_cluster_count, 0u);
+
         k4a_record_close(handle);
     }
     { // Create a recording file with a depth delay offset
@@ -311,6 +324,68 @@ void SampleRecordings::SetUp()
 
         k4a_record_close(handle);
     }
+    { // Create a recording file with little-endian depth and IR tracks
+        k4a_record_t handle = NULL;
+        k4a_result_t result =
+            k4a_record_create("record_test_little_endian.mkv", NULL, record_config_depth_only, &handle);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+        result = k4a_record_set_gray16_little_endian(handle, true);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+        result = k4a_record_write_header(handle);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+        result = k4a_record_set_gray16_little_endian(handle, false);
+        ASSERT_EQ(result, K4A_RESULT_FAILED);
+
+        uint64_t timestamps[3] = { 0, 0, 0 };
+        k4a_capture_t capture = create_test_capture(timestamps,
+                                                    record_config_depth_only.color_format,
+                                                    record_config_depth_only.color_resolution,
+                                                    record_config_depth_only.depth_mode);
+        result = k4a_record_write_capture(handle, capture);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+        k4a_capture_release(capture);
+
+        result = k4a_record_flush(handle);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+        k4a_record_close(handle);
+    }
+    { // Create a recording file with RVL compressed depth and IR tracks
+        k4a_record_t handle = NULL;
+        k4a_result_t result = k4a_record_create("record_test_rvl.mkv", NULL, record_config_full, &handle);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+        result = k4a_record_set_depth_codec(handle, K4A_RECORD_DEPTH_CODEC_RVL);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+        result = k4a_record_write_header(handle);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+        uint64_t timestamps[3] = { 0, 1000, 1000 };
+        uint32_t timestamp_delta = HZ_TO_PERIOD_US(k4a_convert_fps_to_uint(record_config_full.camera_fps));
+        for (size_t i = 0; i < test_frame_count; i++)
+        {
+            k4a_capture_t capture = create_test_capture(timestamps,
+                                                        record_config_full.color_format,
+                                                        record_config_full.color_resolution,
+                                                        record_config_full.depth_mode);
+            result = k4a_record_write_capture(handle, capture);
+            ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+            k4a_capture_release(capture);
+
+            timestamps[0] += timestamp_delta;
+            timestamps[1] += timestamp_delta;
+            timestamps[2] += timestamp_delta;
+        }
+
+        result = k4a_record_flush(handle);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+        k4a_record_close(handle);
+    }
     { // Create a recording file with BGRA color
         k4a_record_t handle = NULL;
         k4a_result_t result = k4a_record_create("record_test_bgra_color.mkv", NULL, record_config_bgra_color, &handle);
@@ -333,6 +408,244 @@ void SampleRecordings::SetUp()
 
         k4a_record_close(handle);
     }
+    { // Create a recording file with BGRA color transcoded to MJPG
+        k4a_device_configuration_t record_config_transcode = record_config_bgra_color;
+        record_config_transcode.color_resolution = K4A_COLOR_RESOLUTION_720P;
+
+        k4a_record_t handle = NULL;
+        k4a_result_t result = k4a_record_create("record_test_transcode.mkv", NULL, record_config_transcode, &handle);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+        result = k4a_record_set_color_codec(handle, K4A_RECORD_COLOR_CODEC_MJPG, 0);
+        ASSERT_EQ(result, K4A_RESULT_FAILED);
+        result = k4a_record_set_color_codec(handle, K4A_RECORD_COLOR_CODEC_MJPG, 90);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+        result = k4a_record_write_header(handle);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+        // The codec can't change once the header is written
+        result = k4a_record_set_color_codec(handle, K4A_RECORD_COLOR_CODEC_NATIVE, 0);
+        ASSERT_EQ(result, K4A_RESULT_FAILED);
+
+        uint32_t timestamp_delta = HZ_TO_PERIOD_US(k4a_convert_fps_to_uint(record_config_transcode.camera_fps));
+        for (uint64_t i = 0; i < 10; i++)
+        {
+            k4a_capture_t capture = NULL;
+            ASSERT_EQ(k4a_capture_create(&capture), K4A_RESULT_SUCCEEDED);
+            k4a_image_t color_image = create_gradient_test_image(i * timestamp_delta, 1280, 720);
+            k4a_capture_set_color_image(capture, color_image);
+            k4a_image_release(color_image);
+
+            result = k4a_record_write_capture(handle, capture);
+            ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+            k4a_capture_release(capture);
+        }
+
+        result = k4a_record_flush(handle);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+        k4a_record_close(handle);
+    }
+    { // Write options are validated, and a full write queue drops data with the drop policy
+        k4a_record_t handle = NULL;
+        k4a_result_t result = k4a_record_create("record_test_dropped.mkv", NULL, record_config_full, &handle);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+        k4a_record_write_options_t options = K4A_RECORD_WRITE_OPTIONS_INIT_DEFAULT;
+        options.cluster_length_usec = 40000; // Longer than the 16 bit block timestamps allow
+        ASSERT_EQ(k4a_record_set_write_options(handle, &options), K4A_RESULT_FAILED);
+        options.cluster_length_usec = 16000;
+        options.write_delay_usec = 16000; // Shorter than 2 clusters
+        ASSERT_EQ(k4a_record_set_write_options(handle, &options), K4A_RESULT_FAILED);
+        options.write_delay_usec = 500000;
+        options.max_pending_bytes = 1;
+        options.overflow_policy = K4A_RECORD_OVERFLOW_DROP;
+        ASSERT_EQ(k4a_record_set_write_options(handle, &options), K4A_RESULT_SUCCEEDED);
+
+        result = k4a_record_write_header(handle);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+        ASSERT_EQ(k4a_record_set_write_options(handle, &options), K4A_RESULT_FAILED);
+
+        // The color image fills the queue, the depth and IR images 1ms later are dropped
+        uint64_t timestamps[3] = { 0, 1000, 1000 };
+        k4a_capture_t capture = create_test_capture(timestamps,
+                                                    record_config_full.color_format,
+                                                    record_config_full.color_resolution,
+                                                    record_config_full.depth_mode);
+        result = k4a_record_write_capture(handle, capture);
+        ASSERT_EQ(result, K4A_RESULT_FAILED);
+        k4a_capture_release(capture);
+
+        k4a_record_write_queue_status_t status;
+        result = k4a_record_get_write_queue_status(handle, &status);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+        ASSERT_GT(status.queued_bytes, 0u);
+        ASSERT_EQ(status.dropped_sample_count, 2u);
+
+        result = k4a_record_flush(handle);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+        result = k4a_record_get_write_queue_status(handle, &status);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+        ASSERT_EQ(status.queued_bytes, 0u);
+
+        k4a_record_close(handle);
+    }
+    { // Captures are kept whole with the drop capture policy
+        k4a_record_t handle = NULL;
+        k4a_result_t result = k4a_record_create("record_test_drop_capture.mkv", NULL, record_config_full, &handle);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+        k4a_record_write_options_t options = K4A_RECORD_WRITE_OPTIONS_INIT_DEFAULT;
+        options.max_pending_bytes = 1;
+        options.overflow_policy = K4A_RECORD_OVERFLOW_DROP_CAPTURE;
+        ASSERT_EQ(k4a_record_set_write_options(handle, &options), K4A_RESULT_SUCCEEDED);
+
+        result = k4a_record_write_header(handle);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+        // The first capture goes in the empty queue whole, the next is dropped whole
+        uint64_t timestamps[3] = { 0, 1000, 1000 };
+        uint32_t timestamp_delta = HZ_TO_PERIOD_US(k4a_convert_fps_to_uint(record_config_full.camera_fps));
+        k4a_result_t expected_results[2] = { K4A_RESULT_SUCCEEDED, K4A_RESULT_FAILED };
+        for (k4a_result_t expected_result : expected_results)
+        {
+            k4a_capture_t capture = create_test_capture(timestamps,
+                                                        record_config_full.color_format,
+                                                        record_config_full.color_resolution,
+                                                        record_config_full.depth_mode);
+            result = k4a_record_write_capture(handle, capture);
+            ASSERT_EQ(result, expected_result);
+            k4a_capture_release(capture);
+
+            timestamps[0] += timestamp_delta;
+            timestamps[1] += timestamp_delta;
+            timestamps[2] += timestamp_delta;
+        }
+
+        k4a_record_write_queue_status_t status;
+        result = k4a_record_get_write_queue_status(handle, &status);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+        ASSERT_EQ(status.dropped_sample_count, 3u);
+
+        result = k4a_record_flush(handle);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+        k4a_record_close(handle);
+        ASSERT_EQ(std::remove("record_test_drop_capture.mkv"), 0);
+    }
+    { // Create 2 recordings written by the single writer thread of a recording group
+        k4a_record_group_t group = NULL;
+        ASSERT_EQ(k4a_record_group_create(0, &group), K4A_RESULT_FAILED);
+        ASSERT_EQ(k4a_record_group_create(1, &group), K4A_RESULT_SUCCEEDED);
+
+        // A short write delay so the group thread writes clusters while captures are added
+        k4a_record_write_options_t options = K4A_RECORD_WRITE_OPTIONS_INIT_DEFAULT;
+        options.write_delay_usec = 100000;
+
+        const char *paths[2] = { "record_test_group_1.mkv", "record_test_group_2.mkv" };
+        k4a_record_t handles[2] = { NULL, NULL };
+        for (size_t i = 0; i < arraysize(handles); i++)
+        {
+            k4a_result_t result = k4a_record_create(paths[i], NULL, record_config_full, &handles[i]);
+            ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+            ASSERT_EQ(k4a_record_set_write_options(handles[i], &options), K4A_RESULT_SUCCEEDED);
+            ASSERT_EQ(k4a_record_group_add_recording(group, handles[i]), K4A_RESULT_SUCCEEDED);
+            result = k4a_record_write_header(handles[i]);
+            ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+            ASSERT_EQ(k4a_record_group_add_recording(group, handles[i]), K4A_RESULT_FAILED);
+        }
+
+        uint64_t timestamps[3] = { 0, 1000, 1000 };
+        uint32_t timestamp_delta = HZ_TO_PERIOD_US(k4a_convert_fps_to_uint(record_config_full.camera_fps));
+        for (size_t i = 0; i < test_frame_count; i++)
+        {
+            for (k4a_record_t handle : handles)
+            {
+                k4a_capture_t capture = create_test_capture(timestamps,
+                                                            record_config_full.color_format,
+                                                            record_config_full.color_resolution,
+                                                            record_config_full.depth_mode);
+                k4a_result_t result = k4a_record_write_capture(handle, capture);
+                ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+                k4a_capture_release(capture);
+            }
+
+            timestamps[0] += timestamp_delta;
+            timestamps[1] += timestamp_delta;
+            timestamps[2] += timestamp_delta;
+        }
+
+        // The recordings keep the group thread until they are closed
+        k4a_record_group_destroy(group);
+        for (k4a_record_t handle : handles)
+        {
+            k4a_result_t result = k4a_record_flush(handle);
+            ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+            k4a_record_close(handle);
+        }
+    }
+    { // Create a recording with the IMU samples packed 10 to a block
+        k4a_record_t handle = NULL;
+        k4a_result_t result = k4a_record_create("record_test_imu_packed.mkv", NULL, record_config_full, &handle);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+        ASSERT_EQ(k4a_record_set_imu_packing(handle, 10000), K4A_RESULT_FAILED); // The IMU track isn't added yet
+        result = k4a_record_add_imu_track(handle);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+        result = k4a_record_set_imu_packing(handle, 10000);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+        result = k4a_record_write_header(handle);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+        ASSERT_EQ(k4a_record_set_imu_packing(handle, 10000), K4A_RESULT_FAILED);
+
+        uint64_t timestamps[3] = { 0, 1000, 1000 };
+        uint64_t imu_timestamp = 1150;
+        uint32_t timestamp_delta = HZ_TO_PERIOD_US(k4a_convert_fps_to_uint(record_config_full.camera_fps));
+        for (size_t i = 0; i < test_frame_count; i++)
+        {
+            k4a_capture_t capture = create_test_capture(timestamps,
+                                                        record_config_full.color_format,
+                                                        record_config_full.color_resolution,
+                                                        record_config_full.depth_mode);
+            result = k4a_record_write_capture(handle, capture);
+            ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+            k4a_capture_release(capture);
+
+            timestamps[0] += timestamp_delta;
+            timestamps[1] += timestamp_delta;
+            timestamps[2] += timestamp_delta;
+
+            while (imu_timestamp < timestamps[0])
+            {
+                k4a_imu_sample_t imu_sample = create_test_imu_sample(imu_timestamp);
+                result = k4a_record_write_imu_sample(handle, imu_sample);
+                ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+                imu_timestamp += 1000; // 1ms
+            }
+        }
+
+        // The flush writes the last, partial pack
+        result = k4a_record_flush(handle);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+        k4a_record_close(handle);
+    }
+    { // Recordings of MJPG color can't be transcoded, and recordings without color have nothing to transcode
+        k4a_record_t handle = NULL;
+        k4a_result_t result = k4a_record_create("record_test_transcode_invalid.mkv", NULL, record_config_full, &handle);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+        result = k4a_record_set_color_codec(handle, K4A_RECORD_COLOR_CODEC_MJPG, 90);
+        ASSERT_EQ(result, K4A_RESULT_FAILED);
+        k4a_record_close(handle);
+
+        result = k4a_record_create("record_test_transcode_invalid.mkv", NULL, record_config_depth_only, &handle);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+        result = k4a_record_set_color_codec(handle, K4A_RECORD_COLOR_CODEC_MJPG, 90);
+        ASSERT_EQ(result, K4A_RESULT_FAILED);
+        k4a_record_close(handle);
+        ASSERT_EQ(std::remove("record_test_transcode_invalid.mkv"), 0);
+    }
 }
 
 void SampleRecordings::TearDown()
@@ -346,10 +659,26 @@ void SampleRecordings::TearDown()
     ASSERT_EQ(std::remove("record_test_color_only.mkv"), 0);
     ASSERT_EQ(std::remove("record_test_depth_only.mkv"), 0);
     ASSERT_EQ(std::remove("record_test_bgra_color.mkv"), 0);
+    ASSERT_EQ(std::remove("record_test_little_endian.mkv"), 0);
+    ASSERT_EQ(std::remove("record_test_rvl.mkv"), 0);
+    ASSERT_EQ(std::remove("record_test_transcode.mkv"), 0);
+    ASSERT_EQ(std::remove("record_test_dropped.mkv"), 0);
+    ASSERT_EQ(std::remove("record_test_group_1.mkv"), 0);
+    ASSERT_EQ(std::remove("record_test_group_2.mkv"), 0);
+    ASSERT_EQ(std::remove("record_test_imu_packed.mkv"), 0);
+}
+
+// Frees a buffer handed to the recording by k4a_record_write_custom_track_blocks(), counting the calls in context
+static void release_custom_track_buffer(void *buffer, void *context)
+{
+    delete[] static_cast<uint8_t *>(buffer);
+    (*static_cast<std::atomic<size_t> *>(context))++;
 }
 
 void CustomTrackRecordings::SetUp()
 {
+    std::atomic<size_t> released_buffer_count(0);
+
     // Use custom track recording API to create a recording with Depth and IR tracks
     k4a_record_t handle = NULL;
     k4a_result_t result =
@@ -457,18 +786,24 @@ void CustomTrackRecordings::SetUp()
                                                     custom_track_block.size());
         ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
 
-        // Write the high frequency track at 10x the rate of the regular track.
+        // Write the high frequency track at 10x the rate of the regular track, handing the buffers to the recording.
+        k4a_record_custom_track_block_t high_freq_blocks[10];
         for (uint64_t j = 0; j < 10; j++)
         {
             uint64_t timestamp_usec_high_freq = timestamp_usec + j * test_timestamp_delta_usec / 10;
             custom_track_block = create_test_custom_track_block(timestamp_usec_high_freq);
-            result = k4a_record_write_custom_track_data(handle,
-                                                        "CUSTOM_TRACK_HIGH_FREQ",
-                                                        timestamp_usec_high_freq,
-                                                        custom_track_block.data(),
-                                                        custom_track_block.size());
-            ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+            high_freq_blocks[j].device_timestamp_usec = timestamp_usec_high_freq;
+            high_freq_blocks[j].buffer = new uint8_t[custom_track_block.size()];
+            high_freq_blocks[j].buffer_size = custom_track_block.size();
+            memcpy(high_freq_blocks[j].buffer, custom_track_block.data(), custom_track_block.size());
         }
+        result = k4a_record_write_custom_track_blocks(handle,
+                                                      "CUSTOM_TRACK_HIGH_FREQ",
+                                                      high_freq_blocks,
+                                                      10,
+                                                      &release_custom_track_buffer,
+                                                      &released_buffer_count);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
 
         k4a_image_release(depth_image);
         k4a_image_release(ir_image);
@@ -480,6 +815,7 @@ void CustomTrackRecordings::SetUp()
     ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
 
     k4a_record_close(handle);
+    ASSERT_EQ(released_buffer_count.load(), test_frame_count * 10);
 }
 
 void CustomTrackRecordings::TearDown()
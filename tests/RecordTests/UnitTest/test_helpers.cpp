@@ -3,6 +3,8 @@
 
 #include "test_helpers.h"
 
+#include <cstdlib>
+
 #include <k4ainternal/common.h>
 #include <k4ainternal/logging.h>
 #include <k4ainternal/matroska_common.h>
@@ -252,6 +254,72 @@ bool validate_test_image(k4a_image_t image,
     return false;
 }
 
+// Smooth gradient, so a lossy codec keeps each channel within a few levels of it
+static uint32_t gradient_test_pixel(uint32_t x, uint32_t y)
+{
+    uint32_t b = (x / 8) & 0xFF;
+    uint32_t g = (y / 4) & 0xFF;
+    uint32_t r = ((x + y) / 16) & 0xFF;
+    return 0xFF000000 | (r << 16) | (g << 8) | b;
+}
+
+k4a_image_t create_gradient_test_image(uint64_t timestamp_us, uint32_t width, uint32_t height)
+{
+    k4a_image_t image = NULL;
+    k4a_result_t result =
+        k4a_image_create(K4A_IMAGE_FORMAT_COLOR_BGRA32, (int)width, (int)height, (int)width * 4, &image);
+    EXIT_IF_FALSE(result == K4A_RESULT_SUCCEEDED);
+
+    uint32_t *buffer = reinterpret_cast<uint32_t *>(k4a_image_get_buffer(image));
+    for (uint32_t y = 0; y < height; y++)
+    {
+        for (uint32_t x = 0; x < width; x++)
+        {
+            buffer[y * width + x] = gradient_test_pixel(x, y);
+        }
+    }
+
+    k4a_image_set_device_timestamp_usec(image, timestamp_us);
+    return image;
+}
+
+bool validate_gradient_test_image(k4a_image_t image, uint32_t width, uint32_t height, int tolerance)
+{
+    if (image != NULL)
+    {
+        VALIDATE_PARAMETER(k4a_image_get_format(image), K4A_IMAGE_FORMAT_COLOR_BGRA32);
+        VALIDATE_PARAMETER(k4a_image_get_width_pixels(image), (int)width);
+        VALIDATE_PARAMETER(k4a_image_get_height_pixels(image), (int)height);
+        VALIDATE_PARAMETER(k4a_image_get_stride_bytes(image), (int)width * 4);
+
+        const uint8_t *buffer = k4a_image_get_buffer(image);
+        for (uint32_t y = 0; y < height; y++)
+        {
+            for (uint32_t x = 0; x < width; x++)
+            {
+                uint32_t expected = gradient_test_pixel(x, y);
+                for (uint32_t channel = 0; channel < 4; channel++)
+                {
+                    int actual_value = buffer[((size_t)y * width + x) * 4 + channel];
+                    int expected_value = (int)((expected >> (channel * 8)) & 0xFF);
+                    if (abs(actual_value - expected_value) > tolerance)
+                    {
+                        LOG_ERROR("PlaybackTest, Image data is incorrect (%d, %d): 0x%X != 0x%X",
+                                  x,
+                                  y,
+                                  reinterpret_cast<const uint32_t *>(buffer)[y * width + x],
+                                  expected);
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+    LOG_ERROR("PlaybackTest, Image is NULL", 0);
+    return false;
+}
+
 k4a_imu_sample_t create_test_imu_sample(uint64_t timestamp_us)
 {
     k4a_imu_sample_t sample = {};
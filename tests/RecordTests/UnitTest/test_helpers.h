@@ -50,6 +50,10 @@ bool validate_test_image(k4a_image_t image,
                          uint32_t height,
                          uint32_t stride);
 
+// Full size BGRA32 image of a gradient, which survives lossy color codecs within a tolerance
+k4a_image_t create_gradient_test_image(uint64_t timestamp_us, uint32_t width, uint32_t height);
+bool validate_gradient_test_image(k4a_image_t image, uint32_t width, uint32_t height, int tolerance);
+
 k4a_imu_sample_t create_test_imu_sample(uint64_t timestamp_us);
 bool validate_imu_sample(k4a_imu_sample_t &imu_sample, uint64_t timestamp_us);
 bool validate_null_imu_sample(k4a_imu_sample_t &imu_sample);
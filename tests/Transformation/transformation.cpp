@@ -10,6 +10,13 @@
 #include <k4ainternal/common.h>
 #include <k4ainternal/image.h>
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <thread>
+
 using namespace testing;
 
 class transformation_ut : public ::testing::Test
@@ -84,6 +91,16 @@ protected:
         ASSERT_EQ_FLT(A[2], B[2])                                                                                      \
     }
 
+#ifdef _WIN32
+#define MKDIR(path) "if not exist " + path + " mkdir " + path
+#define RMDIR(path) "rmdir /S /Q " + path
+#define SETENV(env, value) _putenv_s(env, value)
+#else
+#define MKDIR(path) "mkdir -p " + path
+#define RMDIR(path) "rm -rf " + path
+#define SETENV(env, value) setenv(env, value, 1)
+#endif
+
 // Export function from transformation.c to snoop on the compiler setting used.
 extern "C" char *transformation_get_instruction_type();
 
@@ -349,6 +366,228 @@ TEST_F(transformation_ut, transformation_color_2d_to_depth_2d)
     ASSERT_LT(fabs(point2d[1] - m_depth_point2d_reference[1]), 1);
 }
 
+TEST_F(transformation_ut, transformation_color_2d_to_depth_2d_coarse_to_fine)
+{
+    int width = m_calibration.depth_camera_calibration.resolution_width;
+    int height = m_calibration.depth_camera_calibration.resolution_height;
+    int color_width = m_calibration.color_camera_calibration.resolution_width;
+    int color_height = m_calibration.color_camera_calibration.resolution_height;
+    k4a_image_t depth_image = NULL;
+    ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_DEPTH16,
+                           width,
+                           height,
+                           width * (int)sizeof(uint16_t),
+                           ALLOCATION_SOURCE_USER,
+                           &depth_image),
+              K4A_RESULT_SUCCEEDED);
+
+    // A slanted plane and a closer box in front of it
+    uint16_t *depth_image_buffer = (uint16_t *)(void *)image_get_buffer(depth_image);
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            bool box = x > width / 3 && x < width / 2 && y > height / 3 && y < height / 2;
+            depth_image_buffer[y * width + x] = (uint16_t)(box ? 600 : 1500 + 2 * x + y);
+        }
+    }
+
+    // The coarse to fine search finds the sample the exhaustive walk finds, apart from the rare pixel whose
+    // reprojection error has more than one minimum near a depth edge
+    int count = 0, valid_count = 0, match_count = 0;
+    for (int y = 0; y < color_height; y += 97)
+    {
+        for (int x = 0; x < color_width; x += 89)
+        {
+            float source_point2d[2] = { (float)x, (float)y };
+            float point2d[2] = { 0.f, 0.f }, expected_point2d[2] = { 0.f, 0.f };
+            int valid = 0, expected_valid = 0;
+            ASSERT_EQ(transformation_color_2d_to_depth_2d(&m_calibration, source_point2d, depth_image, point2d, &valid),
+                      K4A_RESULT_SUCCEEDED);
+            ASSERT_EQ(transformation_color_2d_to_depth_2d_exhaustive(
+                          &m_calibration, source_point2d, depth_image, expected_point2d, &expected_valid),
+                      K4A_RESULT_SUCCEEDED);
+
+            count++;
+            if (expected_valid)
+            {
+                valid_count++;
+                if (valid && fabs(point2d[0] - expected_point2d[0]) < 1 && fabs(point2d[1] - expected_point2d[1]) < 1)
+                {
+                    match_count++;
+                }
+            }
+        }
+    }
+    ASSERT_GT(valid_count, count / 4);
+    ASSERT_GE(match_count, valid_count * 95 / 100);
+
+    image_dec_ref(depth_image);
+}
+
+TEST_F(transformation_ut, transformation_batch)
+{
+    // More points than the batch functions compute at a time, including invalid ones: no depth, behind the camera and
+    // outside the field of view
+    const size_t point_count = 301;
+    int width = m_calibration.depth_camera_calibration.resolution_width;
+    int height = m_calibration.depth_camera_calibration.resolution_height;
+    std::vector<float> point2d(2 * point_count);
+    std::vector<float> depth(point_count);
+    for (size_t i = 0; i < point_count; i++)
+    {
+        point2d[2 * i + 0] = (float)(i * 37 % (size_t)(2 * width)) - width / 2.f + 0.25f;
+        point2d[2 * i + 1] = (float)(i * 53 % (size_t)(2 * height)) - height / 2.f + 0.5f;
+        depth[i] = i % 11 == 0 ? 0.f : 300.f + 13.f * (float)i;
+    }
+
+    k4a_calibration_type_t cameras[2] = { K4A_CALIBRATION_TYPE_DEPTH, K4A_CALIBRATION_TYPE_COLOR };
+    for (k4a_calibration_type_t source_camera : cameras)
+    {
+        for (k4a_calibration_type_t target_camera : cameras)
+        {
+            std::vector<float> point3d(3 * point_count);
+            std::vector<float> target_point2d(2 * point_count);
+            std::vector<int> valid(point_count);
+            ASSERT_EQ(transformation_2d_to_3d_batch(&m_calibration,
+                                                    point2d.data(),
+                                                    depth.data(),
+                                                    point_count,
+                                                    source_camera,
+                                                    target_camera,
+                                                    point3d.data(),
+                                                    valid.data()),
+                      K4A_RESULT_SUCCEEDED);
+
+            size_t valid_count = 0;
+            for (size_t i = 0; i < point_count; i++)
+            {
+                float expected[3];
+                int expected_valid = 0;
+                ASSERT_EQ(transformation_2d_to_3d(&m_calibration,
+                                                  &point2d[2 * i],
+                                                  depth[i],
+                                                  source_camera,
+                                                  target_camera,
+                                                  expected,
+                                                  &expected_valid),
+                          K4A_RESULT_SUCCEEDED);
+                ASSERT_EQ(valid[i], expected_valid);
+                if (expected_valid)
+                {
+                    ASSERT_EQ_FLT3((&point3d[3 * i]), expected);
+                    valid_count++;
+                }
+            }
+            ASSERT_GT(valid_count, 0u);
+            ASSERT_LT(valid_count, point_count);
+
+            // Some of the points end up behind the target camera
+            for (size_t i = 0; i < point_count; i += 7)
+            {
+                point3d[3 * i + 2] = -point3d[3 * i + 2];
+            }
+            ASSERT_EQ(transformation_3d_to_2d_batch(&m_calibration,
+                                                    point3d.data(),
+                                                    point_count,
+                                                    target_camera,
+                                                    source_camera,
+                                                    target_point2d.data(),
+                                                    valid.data()),
+                      K4A_RESULT_SUCCEEDED);
+            for (size_t i = 0; i < point_count; i++)
+            {
+                float expected[2];
+                int expected_valid = 0;
+                ASSERT_EQ(transformation_3d_to_2d(
+                              &m_calibration, &point3d[3 * i], target_camera, source_camera, expected, &expected_valid),
+                          K4A_RESULT_SUCCEEDED);
+                ASSERT_EQ(valid[i], expected_valid);
+                if (expected_valid)
+                {
+                    ASSERT_EQ_FLT2((&target_point2d[2 * i]), expected);
+                }
+            }
+
+            ASSERT_EQ(transformation_2d_to_2d_batch(&m_calibration,
+                                                    point2d.data(),
+                                                    depth.data(),
+                                                    point_count,
+                                                    source_camera,
+                                                    target_camera,
+                                                    target_point2d.data(),
+                                                    valid.data()),
+                      K4A_RESULT_SUCCEEDED);
+            for (size_t i = 0; i < point_count; i++)
+            {
+                float expected[2];
+                int expected_valid = 0;
+                ASSERT_EQ(transformation_2d_to_2d(&m_calibration,
+                                                  &point2d[2 * i],
+                                                  depth[i],
+                                                  source_camera,
+                                                  target_camera,
+                                                  expected,
+                                                  &expected_valid),
+                          K4A_RESULT_SUCCEEDED);
+                ASSERT_EQ(valid[i], expected_valid);
+                if (expected_valid)
+                {
+                    ASSERT_EQ_FLT2((&target_point2d[2 * i]), expected);
+                }
+            }
+        }
+    }
+
+    k4a_image_t depth_image = NULL;
+    ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_DEPTH16,
+                           width,
+                           height,
+                           width * (int)sizeof(uint16_t),
+                           ALLOCATION_SOURCE_USER,
+                           &depth_image),
+              K4A_RESULT_SUCCEEDED);
+    uint16_t *depth_image_buffer = (uint16_t *)(void *)image_get_buffer(depth_image);
+    for (int i = 0; i < width * height; i++)
+    {
+        depth_image_buffer[i] = (uint16_t)1000;
+    }
+
+    const size_t color_point_count = 5;
+    float color_point2d[2 * color_point_count] = { m_color_point2d_reference[0],
+                                                   m_color_point2d_reference[1],
+                                                   m_color_point2d_reference[0] + 20.f,
+                                                   m_color_point2d_reference[1] - 10.f,
+                                                   -5000.f,
+                                                   -5000.f,
+                                                   m_color_point2d_reference[0] - 30.f,
+                                                   m_color_point2d_reference[1] + 15.f,
+                                                   m_color_point2d_reference[0] + 1.5f,
+                                                   m_color_point2d_reference[1] + 2.5f };
+    float depth_point2d[2 * color_point_count];
+    int valid[color_point_count];
+    ASSERT_EQ(transformation_color_2d_to_depth_2d_batch(
+                  &m_calibration, color_point2d, color_point_count, depth_image, depth_point2d, valid),
+              K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(valid[0], 1);
+    ASSERT_EQ(valid[2], 0);
+    for (size_t i = 0; i < color_point_count; i++)
+    {
+        float expected[2];
+        int expected_valid = 0;
+        ASSERT_EQ(transformation_color_2d_to_depth_2d(
+                      &m_calibration, &color_point2d[2 * i], depth_image, expected, &expected_valid),
+                  K4A_RESULT_SUCCEEDED);
+        ASSERT_EQ(valid[i], expected_valid);
+        if (expected_valid)
+        {
+            ASSERT_EQ_FLT2((&depth_point2d[2 * i]), expected);
+        }
+    }
+
+    image_dec_ref(depth_image);
+}
+
 TEST_F(transformation_ut, transformation_depth_image_to_point_cloud)
 {
     k4a_transformation_t transformation_handle = transformation_create(&m_calibration, false);
@@ -411,22 +650,24 @@ TEST_F(transformation_ut, transformation_depth_image_to_point_cloud)
     {
         // Are we compiled for the correct instruction type
 #if defined(__amd64__) || defined(_M_AMD64) || defined(__i386__) || defined(_M_IX86)
-#define SPECIAL_INSTRUCTION_OPTIMIZATION "SSE\0"
+        // x86 picks the widest kernel the CPU supports at runtime
+        const char *expected_types[] = { "SSE", "AVX2", "AVX512" };
 #elif defined(__aarch64__) || defined(_M_ARM64)
-#define SPECIAL_INSTRUCTION_OPTIMIZATION "NEON"
+        const char *expected_types[] = { "NEON" };
 #else
 // Omit defining this when not SSE or NEON. Should result in a build break. We are either SSE or Neon.
-//#define SPECIAL_INSTRUCTION_OPTIMIZATION "None"
+//const char *expected_types[] = { "None" };
 #endif
         char *compile_type = transformation_get_instruction_type();
         ASSERT_NE(compile_type, (char *)nullptr);
         ASSERT_NE(compile_type[0], '\0');
         std::cout << "*** K4A Sensor SDK Compile type is: " << compile_type << " ***\n";
-        ASSERT_TRUE(memcmp(compile_type, SPECIAL_INSTRUCTION_OPTIMIZATION, strlen(compile_type)) == 0)
-            << "Expecting " << SPECIAL_INSTRUCTION_OPTIMIZATION << " but compiled for " << compile_type << "\n";
-        ASSERT_TRUE(memcmp(compile_type, SPECIAL_INSTRUCTION_OPTIMIZATION, strlen(compile_type)) == 0)
-            << "Expecting " << SPECIAL_INSTRUCTION_OPTIMIZATION << " but compiled for " << compile_type << "\n";
-        ASSERT_EQ(strlen(compile_type), strlen(SPECIAL_INSTRUCTION_OPTIMIZATION));
+        bool expected = false;
+        for (const char *expected_type : expected_types)
+        {
+            expected = expected || strcmp(compile_type, expected_type) == 0;
+        }
+        ASSERT_TRUE(expected) << "Unexpected instruction type " << compile_type << "\n";
     }
 
     image_dec_ref(depth_image);
@@ -434,6 +675,2425 @@ TEST_F(transformation_ut, transformation_depth_image_to_point_cloud)
     transformation_destroy(transformation_handle);
 }
 
+// Mean absolute coordinate of the point cloud of a constant depth of 1000, as checked by
+// transformation_depth_image_to_point_cloud
+static double point_cloud_check_sum(k4a_transformation_t transformation_handle, const k4a_calibration_t *calibration)
+{
+    int width = calibration->depth_camera_calibration.resolution_width;
+    int height = calibration->depth_camera_calibration.resolution_height;
+    std::vector<uint16_t> depth_image(width * height, (uint16_t)1000);
+    std::vector<int16_t> xyz_image(3 * width * height);
+    k4a_transformation_image_descriptor_t depth_image_descriptor = {
+        width, height, width * (int)sizeof(uint16_t), K4A_IMAGE_FORMAT_DEPTH16
+    };
+    k4a_transformation_image_descriptor_t xyz_image_descriptor = {
+        width, height, width * 3 * (int)sizeof(int16_t), K4A_IMAGE_FORMAT_CUSTOM
+    };
+
+    if (K4A_FAILED(transformation_depth_image_to_point_cloud(transformation_handle,
+                                                             (const uint8_t *)depth_image.data(),
+                                                             &depth_image_descriptor,
+                                                             K4A_CALIBRATION_TYPE_DEPTH,
+                                                             (uint8_t *)xyz_image.data(),
+                                                             &xyz_image_descriptor)))
+    {
+        return 0;
+    }
+
+    double check_sum = 0;
+    for (int16_t value : xyz_image)
+    {
+        check_sum += (double)abs(value);
+    }
+    return check_sum / (double)xyz_image.size();
+}
+
+TEST_F(transformation_ut, transformation_shared_xy_tables)
+{
+    const double reference_val = 562.20976003011071;
+
+    // The second handle shares the tables of the first and keeps them once the first is destroyed
+    k4a_transformation_t first_handle = transformation_create(&m_calibration, false);
+    ASSERT_NE(first_handle, (k4a_transformation_t)NULL);
+    k4a_transformation_t second_handle = transformation_create(&m_calibration, false);
+    ASSERT_NE(second_handle, (k4a_transformation_t)NULL);
+    ASSERT_NEAR(point_cloud_check_sum(first_handle, &m_calibration), reference_val, 0.001);
+    transformation_destroy(first_handle);
+    ASSERT_NEAR(point_cloud_check_sum(second_handle, &m_calibration), reference_val, 0.001);
+
+    // Other calibrations get their own tables
+    k4a_calibration_t other_calibration;
+    ASSERT_EQ(k4a_calibration_get_from_raw(g_test_json,
+                                           sizeof(g_test_json),
+                                           K4A_DEPTH_MODE_NFOV_UNBINNED,
+                                           K4A_COLOR_RESOLUTION_720P,
+                                           &other_calibration),
+              K4A_RESULT_SUCCEEDED);
+    k4a_transformation_t other_handle = transformation_create(&other_calibration, false);
+    ASSERT_NE(other_handle, (k4a_transformation_t)NULL);
+    ASSERT_NE(point_cloud_check_sum(other_handle, &other_calibration), 0);
+    ASSERT_NEAR(point_cloud_check_sum(second_handle, &m_calibration), reference_val, 0.001);
+    transformation_destroy(other_handle);
+    transformation_destroy(second_handle);
+
+    // With no handle left the tables are built again, saved to the disk cache by the first handle and loaded by the
+    // second
+    const std::string cache_directory = "transformation_xy_tables_cache";
+    ASSERT_EQ(system(std::string(MKDIR(cache_directory)).c_str()), 0);
+    ASSERT_EQ(SETENV("K4A_TRANSFORMATION_XY_TABLES_CACHE", cache_directory.c_str()), 0);
+    for (int i = 0; i < 2; i++)
+    {
+        k4a_transformation_t transformation_handle = transformation_create(&m_calibration, false);
+        ASSERT_NE(transformation_handle, (k4a_transformation_t)NULL);
+        ASSERT_NEAR(point_cloud_check_sum(transformation_handle, &m_calibration), reference_val, 0.001);
+        transformation_destroy(transformation_handle);
+    }
+    ASSERT_EQ(SETENV("K4A_TRANSFORMATION_XY_TABLES_CACHE", ""), 0);
+    ASSERT_EQ(system(std::string(RMDIR(cache_directory)).c_str()), 0);
+}
+
+TEST_F(transformation_ut, transformation_get_xy_table)
+{
+    k4a_transformation_t transformation_handle = transformation_create(&m_calibration, false);
+    ASSERT_NE(transformation_handle, (k4a_transformation_t)NULL);
+
+    k4a_xy_table_t depth_table;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+              transformation_get_xy_table(transformation_handle, K4A_CALIBRATION_TYPE_DEPTH, &depth_table));
+    ASSERT_EQ(depth_table.width, m_calibration.depth_camera_calibration.resolution_width);
+    ASSERT_EQ(depth_table.height, m_calibration.depth_camera_calibration.resolution_height);
+    ASSERT_EQ((uintptr_t)depth_table.x_table % 16, (uintptr_t)0);
+
+    // Scaling a pixel's entries by its depth gives the point transformation_2d_to_3d() unprojects
+    int index = (int)m_depth_point2d_reference[1] * depth_table.width + (int)m_depth_point2d_reference[0];
+    float depth = m_depth_point3d_reference[2];
+    float point3d[3] = { depth_table.x_table[index] * depth, depth_table.y_table[index] * depth, depth };
+    ASSERT_EQ_FLT3(point3d, m_depth_point3d_reference);
+
+    // Pixels that do not unproject are marked
+    for (int i = 0; i < depth_table.width * depth_table.height; i += 97)
+    {
+        float point2d[2] = { (float)(i % depth_table.width), (float)(i / depth_table.width) };
+        int valid = 0;
+        ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+                  transformation_2d_to_3d(&m_calibration,
+                                          point2d,
+                                          1.f,
+                                          K4A_CALIBRATION_TYPE_DEPTH,
+                                          K4A_CALIBRATION_TYPE_DEPTH,
+                                          point3d,
+                                          &valid));
+        if (valid)
+        {
+            ASSERT_EQ_FLT(depth_table.x_table[i], point3d[0]);
+            ASSERT_EQ_FLT(depth_table.y_table[i], point3d[1]);
+        }
+        else
+        {
+            ASSERT_TRUE(std::isnan(depth_table.x_table[i]));
+            ASSERT_EQ(depth_table.y_table[i], 0.f);
+        }
+    }
+
+    k4a_xy_table_t color_table;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+              transformation_get_xy_table(transformation_handle, K4A_CALIBRATION_TYPE_COLOR, &color_table));
+    ASSERT_EQ(color_table.width, m_calibration.color_camera_calibration.resolution_width);
+    ASSERT_EQ(color_table.height, m_calibration.color_camera_calibration.resolution_height);
+    ASSERT_NE(color_table.x_table, depth_table.x_table);
+
+    ASSERT_EQ(K4A_RESULT_FAILED,
+              transformation_get_xy_table(transformation_handle, K4A_CALIBRATION_TYPE_GYRO, &depth_table));
+    ASSERT_EQ(K4A_RESULT_FAILED, transformation_get_xy_table(transformation_handle, K4A_CALIBRATION_TYPE_DEPTH, NULL));
+    ASSERT_EQ(K4A_RESULT_FAILED, transformation_get_xy_table(NULL, K4A_CALIBRATION_TYPE_DEPTH, &depth_table));
+
+    transformation_destroy(transformation_handle);
+}
+
+// Allocator callbacks counting the allocations of the xy tables
+static int g_xy_tables_allocation_count = 0;
+
+static uint8_t *count_xy_tables_allocation(int size,
+                                           k4a_allocation_source_t source,
+                                           void *allocator_context,
+                                           void **context)
+{
+    (void)source;
+    (void)allocator_context;
+    *context = NULL;
+    g_xy_tables_allocation_count++;
+    return (uint8_t *)malloc((size_t)size);
+}
+
+static void free_xy_tables_allocation(void *buffer, void *context)
+{
+    (void)context;
+    free(buffer);
+}
+
+TEST_F(transformation_ut, transformation_warm_up)
+{
+    // Creating the handle builds nothing, each table is built by the first call that needs it
+    allocator_hook_t hook = {};
+    hook.allocate = count_xy_tables_allocation;
+    hook.free = free_xy_tables_allocation;
+    g_xy_tables_allocation_count = 0;
+    k4a_transformation_t transformation_handle = transformation_create_with_allocator(&m_calibration, false, &hook);
+    ASSERT_NE(transformation_handle, (k4a_transformation_t)NULL);
+    ASSERT_EQ(g_xy_tables_allocation_count, 0);
+
+    ASSERT_NEAR(point_cloud_check_sum(transformation_handle, &m_calibration), 562.20976003011071, 0.001);
+    ASSERT_EQ(g_xy_tables_allocation_count, 1);
+
+    k4a_xy_table_t depth_table;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+              transformation_get_xy_table(transformation_handle, K4A_CALIBRATION_TYPE_DEPTH, &depth_table));
+    ASSERT_EQ(g_xy_tables_allocation_count, 1);
+
+    // Warming up builds the color camera table, and only once
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, transformation_warm_up(transformation_handle));
+    ASSERT_EQ(g_xy_tables_allocation_count, 2);
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, transformation_warm_up(transformation_handle));
+    ASSERT_EQ(g_xy_tables_allocation_count, 2);
+
+    k4a_xy_table_t warm_depth_table;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+              transformation_get_xy_table(transformation_handle, K4A_CALIBRATION_TYPE_DEPTH, &warm_depth_table));
+    ASSERT_EQ(warm_depth_table.x_table, depth_table.x_table);
+    ASSERT_NEAR(point_cloud_check_sum(transformation_handle, &m_calibration), 562.20976003011071, 0.001);
+    transformation_destroy(transformation_handle);
+
+    // A depth only calibration builds no color camera table
+    k4a_calibration_t depth_calibration;
+    ASSERT_EQ(k4a_calibration_get_from_raw(g_test_json,
+                                           sizeof(g_test_json),
+                                           K4A_DEPTH_MODE_NFOV_UNBINNED,
+                                           K4A_COLOR_RESOLUTION_OFF,
+                                           &depth_calibration),
+              K4A_RESULT_SUCCEEDED);
+    g_xy_tables_allocation_count = 0;
+    transformation_handle = transformation_create_with_allocator(&depth_calibration, false, &hook);
+    ASSERT_NE(transformation_handle, (k4a_transformation_t)NULL);
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, transformation_warm_up(transformation_handle));
+    ASSERT_EQ(g_xy_tables_allocation_count, 1);
+    transformation_destroy(transformation_handle);
+
+    ASSERT_EQ(K4A_RESULT_FAILED, transformation_warm_up(NULL));
+}
+
+// Decodes an IEEE half precision value
+static float half_to_float(uint16_t half)
+{
+    float magnitude = (half & 0x7C00) == 0 ? (float)(half & 0x3FF) / 16777216.0f
+                                           : ldexpf((float)((half & 0x3FF) | 0x400), ((half >> 10) & 0x1F) - 25);
+    return (half & 0x8000) != 0 ? -magnitude : magnitude;
+}
+
+TEST_F(transformation_ut, transformation_depth_image_to_formatted_point_cloud)
+{
+    k4a_transformation_t transformation_handle = transformation_create(&m_calibration, false);
+    ASSERT_NE(transformation_handle, (k4a_transformation_t)NULL);
+
+    int width = m_calibration.depth_camera_calibration.resolution_width;
+    int height = m_calibration.depth_camera_calibration.resolution_height;
+    k4a_image_t depth_image = NULL;
+    ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_DEPTH16,
+                           width,
+                           height,
+                           width * (int)sizeof(uint16_t),
+                           ALLOCATION_SOURCE_USER,
+                           &depth_image),
+              K4A_RESULT_SUCCEEDED);
+    ASSERT_NE(depth_image, (k4a_image_t)NULL);
+    k4a_transformation_image_descriptor_t depth_image_descriptor = image_get_descriptor(depth_image);
+
+    uint16_t *depth_image_buffer = (uint16_t *)(void *)image_get_buffer(depth_image);
+    for (int i = 0; i < width * height; i++)
+    {
+        depth_image_buffer[i] = (uint16_t)(i % 11 == 0 ? 0 : 500 + i % 5000);
+    }
+
+    k4a_image_t reference_image = NULL;
+    ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_CUSTOM,
+                           width,
+                           height,
+                           width * 3 * (int)sizeof(int16_t),
+                           ALLOCATION_SOURCE_USER,
+                           &reference_image),
+              K4A_RESULT_SUCCEEDED);
+    k4a_transformation_image_descriptor_t reference_image_descriptor = image_get_descriptor(reference_image);
+    ASSERT_EQ(transformation_depth_image_to_point_cloud(transformation_handle,
+                                                        image_get_buffer(depth_image),
+                                                        &depth_image_descriptor,
+                                                        K4A_CALIBRATION_TYPE_DEPTH,
+                                                        image_get_buffer(reference_image),
+                                                        &reference_image_descriptor),
+              K4A_RESULT_SUCCEEDED);
+    const int16_t *reference = (const int16_t *)(const void *)image_get_buffer(reference_image);
+
+    struct
+    {
+        k4a_point_cloud_format_t format;
+        int components;
+        bool half;
+    } formats[] = { { K4A_POINT_CLOUD_FORMAT_FLOAT32_XYZ, 3, false },
+                    { K4A_POINT_CLOUD_FORMAT_FLOAT32_XYZW, 4, false },
+                    { K4A_POINT_CLOUD_FORMAT_FLOAT16_XYZ, 3, true },
+                    { K4A_POINT_CLOUD_FORMAT_FLOAT16_XYZW, 4, true } };
+
+    for (const auto &format : formats)
+    {
+        int point_size = format.components * (format.half ? (int)sizeof(uint16_t) : (int)sizeof(float));
+        k4a_image_t xyz_image = NULL;
+        ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_CUSTOM,
+                               width,
+                               height,
+                               width * point_size,
+                               ALLOCATION_SOURCE_USER,
+                               &xyz_image),
+                  K4A_RESULT_SUCCEEDED);
+        k4a_transformation_image_descriptor_t xyz_image_descriptor = image_get_descriptor(xyz_image);
+
+        // The stride must match the point size of the format
+        if (point_size != reference_image_descriptor.stride_bytes / width)
+        {
+            k4a_transformation_image_descriptor_t int16_descriptor = reference_image_descriptor;
+            ASSERT_EQ(transformation_depth_image_to_formatted_point_cloud(transformation_handle,
+                                                                          image_get_buffer(depth_image),
+                                                                          &depth_image_descriptor,
+                                                                          K4A_CALIBRATION_TYPE_DEPTH,
+                                                                          format.format,
+                                                                          NULL,
+                                                                          image_get_buffer(xyz_image),
+                                                                          &int16_descriptor),
+                      K4A_RESULT_FAILED);
+        }
+
+        ASSERT_EQ(transformation_depth_image_to_formatted_point_cloud(transformation_handle,
+                                                                      image_get_buffer(depth_image),
+                                                                      &depth_image_descriptor,
+                                                                      K4A_CALIBRATION_TYPE_DEPTH,
+                                                                      format.format,
+                                                                      NULL,
+                                                                      image_get_buffer(xyz_image),
+                                                                      &xyz_image_descriptor),
+                  K4A_RESULT_SUCCEEDED);
+
+        const uint8_t *xyz_image_buffer = image_get_buffer(xyz_image);
+        for (int i = 0; i < width * height; i++)
+        {
+            float point[4];
+            for (int j = 0; j < format.components; j++)
+            {
+                if (format.half)
+                {
+                    uint16_t value;
+                    memcpy(&value, xyz_image_buffer + i * point_size + j * 2, sizeof(value));
+                    point[j] = half_to_float(value);
+                }
+                else
+                {
+                    memcpy(&point[j], xyz_image_buffer + i * point_size + j * 4, sizeof(float));
+                }
+            }
+
+            // The int16 reference rounds to whole millimeters, and half precision keeps 11 significant bits
+            for (int j = 0; j < 3; j++)
+            {
+                float expected = (float)reference[3 * i + j];
+                float tolerance = 0.5f + (format.half ? std::abs(expected) / 1024.f : 0.f);
+                ASSERT_LE(std::abs(point[j] - expected), tolerance) << "pixel " << i << " component " << j;
+            }
+            if (format.components == 4)
+            {
+                ASSERT_EQ(point[3], 0.f);
+            }
+        }
+
+        image_dec_ref(xyz_image);
+    }
+
+    image_dec_ref(reference_image);
+    image_dec_ref(depth_image);
+    transformation_destroy(transformation_handle);
+}
+
+TEST_F(transformation_ut, transformation_depth_image_to_valid_point_cloud)
+{
+    k4a_transformation_t transformation_handle = transformation_create(&m_calibration, false);
+    ASSERT_NE(transformation_handle, (k4a_transformation_t)NULL);
+
+    int width = m_calibration.depth_camera_calibration.resolution_width;
+    int height = m_calibration.depth_camera_calibration.resolution_height;
+    k4a_image_t depth_image = NULL;
+    ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_DEPTH16,
+                           width,
+                           height,
+                           width * (int)sizeof(uint16_t),
+                           ALLOCATION_SOURCE_USER,
+                           &depth_image),
+              K4A_RESULT_SUCCEEDED);
+    ASSERT_NE(depth_image, (k4a_image_t)NULL);
+    k4a_transformation_image_descriptor_t depth_image_descriptor = image_get_descriptor(depth_image);
+
+    uint16_t *depth_image_buffer = (uint16_t *)(void *)image_get_buffer(depth_image);
+    for (int i = 0; i < width * height; i++)
+    {
+        // Leave some pixels without depth
+        depth_image_buffer[i] = (uint16_t)(i % 3 == 0 ? 0 : 1000 + i % 500);
+    }
+
+    k4a_image_t xyz_images[2] = { NULL, NULL };
+    k4a_transformation_image_descriptor_t xyz_image_descriptors[2];
+    for (int i = 0; i < 2; i++)
+    {
+        ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_CUSTOM,
+                               width,
+                               height,
+                               width * 3 * (int)sizeof(int16_t),
+                               ALLOCATION_SOURCE_USER,
+                               &xyz_images[i]),
+                  K4A_RESULT_SUCCEEDED);
+        ASSERT_NE(xyz_images[i], (k4a_image_t)NULL);
+        xyz_image_descriptors[i] = image_get_descriptor(xyz_images[i]);
+    }
+
+    ASSERT_EQ(transformation_depth_image_to_point_cloud(transformation_handle,
+                                                        image_get_buffer(depth_image),
+                                                        &depth_image_descriptor,
+                                                        K4A_CALIBRATION_TYPE_DEPTH,
+                                                        image_get_buffer(xyz_images[0]),
+                                                        &xyz_image_descriptors[0]),
+              K4A_RESULT_SUCCEEDED);
+
+    std::vector<uint32_t> pixel_indices((size_t)(width * height));
+    size_t point_count = 0;
+    ASSERT_EQ(transformation_depth_image_to_valid_point_cloud(transformation_handle,
+                                                              image_get_buffer(depth_image),
+                                                              &depth_image_descriptor,
+                                                              K4A_CALIBRATION_TYPE_DEPTH,
+                                                              image_get_buffer(xyz_images[1]),
+                                                              &xyz_image_descriptors[1],
+                                                              pixel_indices.data(),
+                                                              &point_count),
+              K4A_RESULT_SUCCEEDED);
+
+    // The packed points are the points of the full point cloud with z != 0, in pixel order
+    const int16_t *reference = (const int16_t *)(const void *)image_get_buffer(xyz_images[0]);
+    const int16_t *packed = (const int16_t *)(const void *)image_get_buffer(xyz_images[1]);
+    size_t expected_count = 0;
+    for (int i = 0; i < width * height; i++)
+    {
+        if (reference[3 * i + 2] == 0)
+        {
+            continue;
+        }
+        ASSERT_LT(expected_count, point_count);
+        ASSERT_EQ(pixel_indices[expected_count], (uint32_t)i);
+        ASSERT_EQ(memcmp(packed + 3 * expected_count, reference + 3 * i, 3 * sizeof(int16_t)), 0);
+        expected_count++;
+    }
+    ASSERT_EQ(point_count, expected_count);
+    ASSERT_LT(point_count, (size_t)(width * height));
+
+    // The pixel indices are optional
+    size_t point_count_without_indices = 0;
+    ASSERT_EQ(transformation_depth_image_to_valid_point_cloud(transformation_handle,
+                                                              image_get_buffer(depth_image),
+                                                              &depth_image_descriptor,
+                                                              K4A_CALIBRATION_TYPE_DEPTH,
+                                                              image_get_buffer(xyz_images[1]),
+                                                              &xyz_image_descriptors[1],
+                                                              NULL,
+                                                              &point_count_without_indices),
+              K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(point_count_without_indices, point_count);
+
+    image_dec_ref(depth_image);
+    image_dec_ref(xyz_images[0]);
+    image_dec_ref(xyz_images[1]);
+    transformation_destroy(transformation_handle);
+}
+
+TEST_F(transformation_ut, transformation_fuse_point_clouds)
+{
+    // The second device splits its image into bands
+    k4a_transformation_t transformation_handles[2];
+    for (int i = 0; i < 2; i++)
+    {
+        transformation_handles[i] = transformation_create(&m_calibration, false);
+        ASSERT_NE(transformation_handles[i], (k4a_transformation_t)NULL);
+    }
+    ASSERT_EQ(transformation_set_cpu_thread_count(transformation_handles[1], 3), K4A_RESULT_SUCCEEDED);
+
+    int width = m_calibration.depth_camera_calibration.resolution_width;
+    int height = m_calibration.depth_camera_calibration.resolution_height;
+    size_t pixel_count = (size_t)(width * height);
+    k4a_transformation_image_descriptor_t depth_image_descriptor = { width,
+                                                                     height,
+                                                                     width * (int)sizeof(uint16_t),
+                                                                     K4A_IMAGE_FORMAT_DEPTH16 };
+    k4a_transformation_image_descriptor_t color_image_descriptor = { width,
+                                                                     height,
+                                                                     width * 4,
+                                                                     K4A_IMAGE_FORMAT_COLOR_BGRA32 };
+    k4a_transformation_image_descriptor_t reference_image_descriptor = { width,
+                                                                         height,
+                                                                         width * 3 * (int)sizeof(float),
+                                                                         K4A_IMAGE_FORMAT_CUSTOM };
+
+    std::vector<uint16_t> depth_images[2];
+    std::vector<uint8_t> color_images[2];
+    std::vector<float> references[2];
+    k4a_transformation_fusion_source_t sources[2];
+    memset(sources, 0, sizeof(sources));
+    for (int i = 0; i < 2; i++)
+    {
+        depth_images[i].resize(pixel_count);
+        color_images[i].resize(pixel_count * 4);
+        for (size_t j = 0; j < pixel_count; j++)
+        {
+            // Leave some pixels without depth
+            depth_images[i][j] = (uint16_t)(j % (5 + i) == 0 ? 0 : 700 + (j * (i + 1)) % 3000);
+            for (int c = 0; c < 4; c++)
+            {
+                color_images[i][4 * j + c] = (uint8_t)(j * (c + 1) + i);
+            }
+        }
+
+        references[i].resize(pixel_count * 3);
+        ASSERT_EQ(transformation_depth_image_to_formatted_point_cloud(transformation_handles[i],
+                                                                      (const uint8_t *)depth_images[i].data(),
+                                                                      &depth_image_descriptor,
+                                                                      K4A_CALIBRATION_TYPE_DEPTH,
+                                                                      K4A_POINT_CLOUD_FORMAT_FLOAT32_XYZ,
+                                                                      NULL,
+                                                                      (uint8_t *)references[i].data(),
+                                                                      &reference_image_descriptor),
+                  K4A_RESULT_SUCCEEDED);
+
+        sources[i].transformation_handle = transformation_handles[i];
+        sources[i].depth_image_data = (const uint8_t *)depth_images[i].data();
+        sources[i].depth_image_descriptor = &depth_image_descriptor;
+        sources[i].color_image_data = color_images[i].data();
+        sources[i].color_image_descriptor = &color_image_descriptor;
+    }
+
+    // The first device is the common frame, the second is turned 90 degrees about y and moved
+    float identity[9] = { 1.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 1.f };
+    float turn[9] = { 0.f, 0.f, 1.f, 0.f, 1.f, 0.f, -1.f, 0.f, 0.f };
+    memcpy(sources[0].depth_to_common.rotation, identity, sizeof(identity));
+    memcpy(sources[1].depth_to_common.rotation, turn, sizeof(turn));
+    sources[1].depth_to_common.translation[0] = -2000.f;
+    sources[1].depth_to_common.translation[1] = 10.f;
+    sources[1].depth_to_common.translation[2] = 2500.f;
+
+    k4a_point_cloud_format_t formats[] = { K4A_POINT_CLOUD_FORMAT_FLOAT32_XYZ, K4A_POINT_CLOUD_FORMAT_FLOAT32_XYZW };
+    for (k4a_point_cloud_format_t format : formats)
+    {
+        int components = format == K4A_POINT_CLOUD_FORMAT_FLOAT32_XYZ ? 3 : 4;
+        std::vector<float> xyz(2 * pixel_count * (size_t)components);
+        std::vector<uint8_t> bgra(2 * pixel_count * 4);
+        k4a_transformation_image_descriptor_t xyz_image_descriptor = { 2 * width * height,
+                                                                       1,
+                                                                       2 * width * height * components *
+                                                                           (int)sizeof(float),
+                                                                       K4A_IMAGE_FORMAT_CUSTOM };
+        k4a_transformation_image_descriptor_t bgra_image_descriptor = { 2 * width * height,
+                                                                        1,
+                                                                        2 * width * height * 4,
+                                                                        K4A_IMAGE_FORMAT_COLOR_BGRA32 };
+
+        for (int valid_points_only = 0; valid_points_only < 2; valid_points_only++)
+        {
+            size_t point_count = 0;
+            ASSERT_EQ(transformation_fuse_point_clouds(sources,
+                                                       2,
+                                                       format,
+                                                       valid_points_only != 0,
+                                                       (uint8_t *)xyz.data(),
+                                                       &xyz_image_descriptor,
+                                                       bgra.data(),
+                                                       &bgra_image_descriptor,
+                                                       &point_count),
+                      K4A_RESULT_SUCCEEDED);
+
+            // Every point is the depth camera point of its pixel moved into the common frame, in source and pixel order
+            size_t expected_count = 0;
+            for (int i = 0; i < 2; i++)
+            {
+                const float *r = sources[i].depth_to_common.rotation;
+                const float *t = sources[i].depth_to_common.translation;
+                for (size_t j = 0; j < pixel_count; j++)
+                {
+                    const float *p = &references[i][3 * j];
+                    bool valid = p[2] != 0.f;
+                    if (valid_points_only && !valid)
+                    {
+                        continue;
+                    }
+                    ASSERT_LT(expected_count, 2 * pixel_count);
+
+                    const float *point = &xyz[expected_count * (size_t)components];
+                    for (int k = 0; k < 3; k++)
+                    {
+                        float expected = valid ? r[3 * k] * p[0] + r[3 * k + 1] * p[1] + r[3 * k + 2] * p[2] + t[k] :
+                                                 0.f;
+                        ASSERT_NEAR(point[k], expected, 0.01f);
+                    }
+                    if (components == 4)
+                    {
+                        ASSERT_EQ(point[3], 0.f);
+                    }
+                    ASSERT_EQ(memcmp(&bgra[4 * expected_count], &color_images[i][4 * j], 4), 0);
+                    expected_count++;
+                }
+            }
+            ASSERT_EQ(point_count, expected_count);
+        }
+
+        // The colors are optional
+        size_t point_count = 0;
+        ASSERT_EQ(transformation_fuse_point_clouds(sources,
+                                                   2,
+                                                   format,
+                                                   true,
+                                                   (uint8_t *)xyz.data(),
+                                                   &xyz_image_descriptor,
+                                                   NULL,
+                                                   NULL,
+                                                   &point_count),
+                  K4A_RESULT_SUCCEEDED);
+        ASSERT_GT(point_count, 0u);
+        ASSERT_LT(point_count, 2 * pixel_count);
+
+        // The xyz image must hold every pixel of every source
+        xyz_image_descriptor.width_pixels = width * height;
+        xyz_image_descriptor.stride_bytes = width * height * components * (int)sizeof(float);
+        ASSERT_EQ(transformation_fuse_point_clouds(sources,
+                                                   2,
+                                                   format,
+                                                   false,
+                                                   (uint8_t *)xyz.data(),
+                                                   &xyz_image_descriptor,
+                                                   NULL,
+                                                   NULL,
+                                                   &point_count),
+                  K4A_RESULT_FAILED);
+    }
+
+    // Only float32 formats can hold points of the common frame
+    std::vector<int16_t> xyz_int16(2 * pixel_count * 3);
+    k4a_transformation_image_descriptor_t xyz_int16_descriptor = { 2 * width * height,
+                                                                   1,
+                                                                   2 * width * height * 3 * (int)sizeof(int16_t),
+                                                                   K4A_IMAGE_FORMAT_CUSTOM };
+    size_t point_count = 0;
+    ASSERT_EQ(transformation_fuse_point_clouds(sources,
+                                               2,
+                                               K4A_POINT_CLOUD_FORMAT_INT16_XYZ,
+                                               false,
+                                               (uint8_t *)xyz_int16.data(),
+                                               &xyz_int16_descriptor,
+                                               NULL,
+                                               NULL,
+                                               &point_count),
+              K4A_RESULT_FAILED);
+
+    for (int i = 0; i < 2; i++)
+    {
+        transformation_destroy(transformation_handles[i]);
+    }
+}
+
+TEST_F(transformation_ut, transformation_point_cloud_normals_and_voxel_downsample)
+{
+    k4a_transformation_t transformation_handle = transformation_create(&m_calibration, false);
+    ASSERT_NE(transformation_handle, (k4a_transformation_t)NULL);
+
+    int width = m_calibration.depth_camera_calibration.resolution_width;
+    int height = m_calibration.depth_camera_calibration.resolution_height;
+    size_t pixel_count = (size_t)(width * height);
+    k4a_transformation_image_descriptor_t depth_image_descriptor = { width,
+                                                                     height,
+                                                                     width * (int)sizeof(uint16_t),
+                                                                     K4A_IMAGE_FORMAT_DEPTH16 };
+    k4a_transformation_image_descriptor_t xyz_image_descriptor = { width,
+                                                                   height,
+                                                                   width * 3 * (int)sizeof(int16_t),
+                                                                   K4A_IMAGE_FORMAT_CUSTOM };
+    k4a_transformation_image_descriptor_t normal_image_descriptor = { width,
+                                                                      height,
+                                                                      width * 3 * (int)sizeof(float),
+                                                                      K4A_IMAGE_FORMAT_CUSTOM };
+
+    // A slanted plane with holes and a step
+    std::vector<uint16_t> depth((size_t)pixel_count);
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            uint16_t value = (uint16_t)(1000 + 2 * x + (x > width / 2 ? 300 : 0));
+            depth[(size_t)(y * width + x)] = (y * width + x) % 97 == 0 ? 0 : value;
+        }
+    }
+
+    std::vector<int16_t> xyz(pixel_count * 3);
+    ASSERT_EQ(transformation_depth_image_to_point_cloud(transformation_handle,
+                                                        (const uint8_t *)depth.data(),
+                                                        &depth_image_descriptor,
+                                                        K4A_CALIBRATION_TYPE_DEPTH,
+                                                        (uint8_t *)xyz.data(),
+                                                        &xyz_image_descriptor),
+              K4A_RESULT_SUCCEEDED);
+
+    std::vector<float> normals(pixel_count * 3, 1.f);
+    ASSERT_EQ(transformation_point_cloud_to_normals((const uint8_t *)xyz.data(),
+                                                    &xyz_image_descriptor,
+                                                    (uint8_t *)normals.data(),
+                                                    &normal_image_descriptor),
+              K4A_RESULT_SUCCEEDED);
+
+    // Each normal is the cross product of the neighbor differences, or 0 across an edge, a hole or the border
+    size_t normal_count = 0;
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            size_t i = (size_t)(y * width + x);
+            const float *normal = &normals[3 * i];
+            float expected[3] = { 0.f, 0.f, 0.f };
+            if (x > 0 && y > 0 && x < width - 1 && y < height - 1)
+            {
+                const int16_t *center = &xyz[3 * i];
+                const int16_t *left = center - 3;
+                const int16_t *right = center + 3;
+                const int16_t *up = center - 3 * width;
+                const int16_t *down = center + 3 * width;
+                float z = (float)center[2];
+                float limit = 0.09386883518f * z;
+                bool valid = z > 0.f;
+                for (const int16_t *neighbor : { left, right, up, down })
+                {
+                    valid = valid && std::abs((float)neighbor[2] - z) <= limit;
+                }
+                if (valid)
+                {
+                    float a[3];
+                    float b[3];
+                    for (int j = 0; j < 3; j++)
+                    {
+                        a[j] = (float)right[j] - (float)left[j];
+                        b[j] = (float)down[j] - (float)up[j];
+                    }
+                    float n[3] = { b[1] * a[2] - b[2] * a[1], b[2] * a[0] - b[0] * a[2], b[0] * a[1] - b[1] * a[0] };
+                    float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+                    for (int j = 0; j < 3; j++)
+                    {
+                        expected[j] = n[j] / length;
+                    }
+
+                    // Facing the camera
+                    ASSERT_LT(expected[2], 0.f);
+                    normal_count++;
+                }
+            }
+            for (int j = 0; j < 3; j++)
+            {
+                ASSERT_NEAR(normal[j], expected[j], 1e-5f);
+            }
+        }
+    }
+    ASSERT_GT(normal_count, pixel_count / 2);
+
+    // The reference downsampling keeps the voxels in the order of their first point
+    const float voxel_size = 40.f;
+    std::map<std::array<int32_t, 3>, size_t> voxel_indices;
+    std::vector<std::array<double, 7>> voxel_sums;
+    for (size_t i = 0; i < pixel_count; i++)
+    {
+        const int16_t *point = &xyz[3 * i];
+        if (point[2] == 0)
+        {
+            continue;
+        }
+        std::array<int32_t, 3> key;
+        for (int j = 0; j < 3; j++)
+        {
+            key[j] = (int32_t)std::floor((float)point[j] / voxel_size);
+        }
+        auto found = voxel_indices.emplace(key, voxel_sums.size());
+        if (found.second)
+        {
+            voxel_sums.push_back({ 0, 0, 0, 0, 0, 0, 0 });
+        }
+        std::array<double, 7> &sums = voxel_sums[found.first->second];
+        for (int j = 0; j < 3; j++)
+        {
+            sums[j] += point[j];
+            sums[3 + j] += normals[3 * i + j];
+        }
+        sums[6]++;
+    }
+    ASSERT_LT(voxel_sums.size(), pixel_count / 10);
+
+    std::vector<float> downsampled_xyz(pixel_count * 3);
+    std::vector<float> downsampled_normals(pixel_count * 3);
+    k4a_transformation_image_descriptor_t downsampled_image_descriptor = { width * height,
+                                                                           1,
+                                                                           width * height * 3 * (int)sizeof(float),
+                                                                           K4A_IMAGE_FORMAT_CUSTOM };
+    for (int with_normals = 0; with_normals < 2; with_normals++)
+    {
+        size_t point_count = 0;
+        ASSERT_EQ(transformation_point_cloud_voxel_downsample(
+                      (const uint8_t *)xyz.data(),
+                      &xyz_image_descriptor,
+                      with_normals ? (const uint8_t *)normals.data() : NULL,
+                      with_normals ? &normal_image_descriptor : NULL,
+                      voxel_size,
+                      (uint8_t *)downsampled_xyz.data(),
+                      &downsampled_image_descriptor,
+                      with_normals ? (uint8_t *)downsampled_normals.data() : NULL,
+                      with_normals ? &downsampled_image_descriptor : NULL,
+                      &point_count),
+                  K4A_RESULT_SUCCEEDED);
+        ASSERT_EQ(point_count, voxel_sums.size());
+
+        for (size_t v = 0; v < point_count; v++)
+        {
+            const std::array<double, 7> &sums = voxel_sums[v];
+            for (int j = 0; j < 3; j++)
+            {
+                ASSERT_NEAR(downsampled_xyz[3 * v + j], sums[j] / sums[6], 1e-3);
+            }
+            if (with_normals)
+            {
+                double length = std::sqrt(sums[3] * sums[3] + sums[4] * sums[4] + sums[5] * sums[5]);
+                for (int j = 0; j < 3; j++)
+                {
+                    ASSERT_NEAR(downsampled_normals[3 * v + j], length > 0 ? sums[3 + j] / length : 0, 1e-4);
+                }
+            }
+        }
+    }
+
+    // The voxels must have a size and the output must hold a point for every pixel
+    size_t point_count = 0;
+    ASSERT_EQ(transformation_point_cloud_voxel_downsample((const uint8_t *)xyz.data(),
+                                                          &xyz_image_descriptor,
+                                                          NULL,
+                                                          NULL,
+                                                          0.f,
+                                                          (uint8_t *)downsampled_xyz.data(),
+                                                          &downsampled_image_descriptor,
+                                                          NULL,
+                                                          NULL,
+                                                          &point_count),
+              K4A_RESULT_FAILED);
+    downsampled_image_descriptor.width_pixels--;
+    ASSERT_EQ(transformation_point_cloud_voxel_downsample((const uint8_t *)xyz.data(),
+                                                          &xyz_image_descriptor,
+                                                          NULL,
+                                                          NULL,
+                                                          voxel_size,
+                                                          (uint8_t *)downsampled_xyz.data(),
+                                                          &downsampled_image_descriptor,
+                                                          NULL,
+                                                          NULL,
+                                                          &point_count),
+              K4A_RESULT_FAILED);
+
+    transformation_destroy(transformation_handle);
+}
+
+TEST_F(transformation_ut, transformation_depth_image_to_color_camera_threads)
+{
+    k4a_transformation_t transformation_handle = transformation_create(&m_calibration, false);
+    ASSERT_NE(transformation_handle, (k4a_transformation_t)NULL);
+    ASSERT_EQ(transformation_set_cpu_thread_count(transformation_handle, 0), K4A_RESULT_FAILED);
+    ASSERT_EQ(transformation_set_cpu_thread_count(transformation_handle, K4A_TRANSFORMATION_MAX_THREAD_COUNT + 1),
+              K4A_RESULT_FAILED);
+
+    int width = m_calibration.depth_camera_calibration.resolution_width;
+    int height = m_calibration.depth_camera_calibration.resolution_height;
+    int color_width = m_calibration.color_camera_calibration.resolution_width;
+    int color_height = m_calibration.color_camera_calibration.resolution_height;
+
+    k4a_image_t depth_image = NULL;
+    ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_DEPTH16,
+                           width,
+                           height,
+                           width * (int)sizeof(uint16_t),
+                           ALLOCATION_SOURCE_USER,
+                           &depth_image),
+              K4A_RESULT_SUCCEEDED);
+    k4a_image_t custom_image = NULL;
+    ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_CUSTOM16,
+                           width,
+                           height,
+                           width * (int)sizeof(uint16_t),
+                           ALLOCATION_SOURCE_USER,
+                           &custom_image),
+              K4A_RESULT_SUCCEEDED);
+
+    // A checkerboard of near and far surfaces, so bands overlap and occlude each other in the color camera
+    uint16_t *depth_image_buffer = (uint16_t *)(void *)image_get_buffer(depth_image);
+    uint16_t *custom_image_buffer = (uint16_t *)(void *)image_get_buffer(custom_image);
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            bool near = (x / 32 + y / 32) % 2 == 0;
+            depth_image_buffer[y * width + x] = (uint16_t)(near ? 700 + x / 4 : 2000 + y);
+            custom_image_buffer[y * width + x] = (uint16_t)(y * width + x);
+        }
+    }
+
+    k4a_image_t transformed_images[2][2] = { { NULL, NULL }, { NULL, NULL } };
+    uint32_t thread_counts[2] = { 1, 7 };
+    for (int i = 0; i < 2; i++)
+    {
+        ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_DEPTH16,
+                               color_width,
+                               color_height,
+                               color_width * (int)sizeof(uint16_t),
+                               ALLOCATION_SOURCE_USER,
+                               &transformed_images[i][0]),
+                  K4A_RESULT_SUCCEEDED);
+        ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_CUSTOM16,
+                               color_width,
+                               color_height,
+                               color_width * (int)sizeof(uint16_t),
+                               ALLOCATION_SOURCE_USER,
+                               &transformed_images[i][1]),
+                  K4A_RESULT_SUCCEEDED);
+
+        k4a_transformation_image_descriptor_t depth_image_descriptor = image_get_descriptor(depth_image);
+        k4a_transformation_image_descriptor_t custom_image_descriptor = image_get_descriptor(custom_image);
+        k4a_transformation_image_descriptor_t transformed_depth_image_descriptor = image_get_descriptor(
+            transformed_images[i][0]);
+        k4a_transformation_image_descriptor_t transformed_custom_image_descriptor = image_get_descriptor(
+            transformed_images[i][1]);
+
+        ASSERT_EQ(transformation_set_cpu_thread_count(transformation_handle, thread_counts[i]), K4A_RESULT_SUCCEEDED);
+        ASSERT_EQ(transformation_depth_image_to_color_camera_custom(transformation_handle,
+                                                                    image_get_buffer(depth_image),
+                                                                    &depth_image_descriptor,
+                                                                    image_get_buffer(custom_image),
+                                                                    &custom_image_descriptor,
+                                                                    image_get_buffer(transformed_images[i][0]),
+                                                                    &transformed_depth_image_descriptor,
+                                                                    image_get_buffer(transformed_images[i][1]),
+                                                                    &transformed_custom_image_descriptor,
+                                                                    K4A_TRANSFORMATION_INTERPOLATION_TYPE_NEAREST,
+                                                                    0xffff),
+                  K4A_RESULT_SUCCEEDED);
+    }
+
+    // Splitting the work must not change a single pixel
+    for (int j = 0; j < 2; j++)
+    {
+        ASSERT_EQ(image_get_size(transformed_images[0][j]), image_get_size(transformed_images[1][j]));
+        ASSERT_EQ(memcmp(image_get_buffer(transformed_images[0][j]),
+                         image_get_buffer(transformed_images[1][j]),
+                         image_get_size(transformed_images[0][j])),
+                  0);
+    }
+
+    for (int i = 0; i < 2; i++)
+    {
+        image_dec_ref(transformed_images[i][0]);
+        image_dec_ref(transformed_images[i][1]);
+    }
+    image_dec_ref(depth_image);
+    image_dec_ref(custom_image);
+    transformation_destroy(transformation_handle);
+}
+
+TEST_F(transformation_ut, transformation_depth_image_to_color_camera_splat)
+{
+    k4a_transformation_t transformation_handle = transformation_create(&m_calibration, false);
+    ASSERT_NE(transformation_handle, (k4a_transformation_t)NULL);
+    ASSERT_EQ(transformation_set_depth_to_color_mode(transformation_handle,
+                                                     (k4a_transformation_depth_to_color_mode_t)42),
+              K4A_RESULT_FAILED);
+
+    int width = m_calibration.depth_camera_calibration.resolution_width;
+    int height = m_calibration.depth_camera_calibration.resolution_height;
+    int color_width = m_calibration.color_camera_calibration.resolution_width;
+    int color_height = m_calibration.color_camera_calibration.resolution_height;
+
+    // A slanted wall with a few holes
+    std::vector<uint16_t> depth((size_t)width * height);
+    std::vector<uint16_t> custom((size_t)width * height);
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            depth[(size_t)y * width + x] = (uint16_t)((x % 37 == 0 && y % 41 == 0) ? 0 : 1500 + 2 * x + y);
+            custom[(size_t)y * width + x] = (uint16_t)(y * width + x);
+        }
+    }
+
+    k4a_transformation_image_descriptor_t depth_descriptor = { width,
+                                                               height,
+                                                               width * (int)sizeof(uint16_t),
+                                                               K4A_IMAGE_FORMAT_DEPTH16 };
+    k4a_transformation_image_descriptor_t custom_descriptor = { width,
+                                                                height,
+                                                                width * (int)sizeof(uint16_t),
+                                                                K4A_IMAGE_FORMAT_CUSTOM16 };
+    k4a_transformation_image_descriptor_t transformed_depth_descriptor = { color_width,
+                                                                           color_height,
+                                                                           color_width * (int)sizeof(uint16_t),
+                                                                           K4A_IMAGE_FORMAT_DEPTH16 };
+    k4a_transformation_image_descriptor_t transformed_custom_descriptor = { color_width,
+                                                                            color_height,
+                                                                            color_width * (int)sizeof(uint16_t),
+                                                                            K4A_IMAGE_FORMAT_CUSTOM16 };
+
+    const k4a_transformation_depth_to_color_mode_t modes[3] = { K4A_TRANSFORMATION_DEPTH_TO_COLOR_MODE_QUADS,
+                                                                K4A_TRANSFORMATION_DEPTH_TO_COLOR_MODE_SPLAT,
+                                                                K4A_TRANSFORMATION_DEPTH_TO_COLOR_MODE_SPLAT_2X2 };
+    const uint32_t thread_counts[2] = { 1, 7 };
+    k4a_transformation_interpolation_type_t interpolation_type = K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR;
+    std::vector<uint16_t> transformed_depth[3][2];
+    std::vector<uint16_t> transformed_custom[3][2];
+    for (int precomputed_rays = 0; precomputed_rays < 2; precomputed_rays++)
+    {
+        ASSERT_EQ(transformation_set_precomputed_rays(transformation_handle, precomputed_rays != 0),
+                  K4A_RESULT_SUCCEEDED);
+        for (int i = 0; i < 3; i++)
+        {
+            ASSERT_EQ(transformation_set_depth_to_color_mode(transformation_handle, modes[i]), K4A_RESULT_SUCCEEDED);
+            for (int j = 0; j < 2; j++)
+            {
+                transformed_depth[i][j].assign((size_t)color_width * color_height, 0);
+                transformed_custom[i][j].assign((size_t)color_width * color_height, 0);
+                uint8_t *transformed_depth_data = (uint8_t *)transformed_depth[i][j].data();
+                uint8_t *transformed_custom_data = (uint8_t *)transformed_custom[i][j].data();
+                ASSERT_EQ(transformation_set_cpu_thread_count(transformation_handle, thread_counts[j]),
+                          K4A_RESULT_SUCCEEDED);
+                ASSERT_EQ(transformation_depth_image_to_color_camera_custom(transformation_handle,
+                                                                            (const uint8_t *)depth.data(),
+                                                                            &depth_descriptor,
+                                                                            (const uint8_t *)custom.data(),
+                                                                            &custom_descriptor,
+                                                                            transformed_depth_data,
+                                                                            &transformed_depth_descriptor,
+                                                                            transformed_custom_data,
+                                                                            &transformed_custom_descriptor,
+                                                                            interpolation_type,
+                                                                            0xffff),
+                          K4A_RESULT_SUCCEEDED);
+            }
+
+            // Splitting the work must not change a single pixel
+            ASSERT_TRUE(transformed_depth[i][0] == transformed_depth[i][1]);
+            ASSERT_TRUE(transformed_custom[i][0] == transformed_custom[i][1]);
+        }
+
+        // Splats land on the wall the quads cover, with the depth and custom value of a depth pixel
+        size_t splat_pixels[3] = { 0, 0, 0 };
+        for (int i = 1; i < 3; i++)
+        {
+            for (size_t k = 0; k < transformed_depth[i][0].size(); k++)
+            {
+                uint16_t splat_depth = transformed_depth[i][0][k];
+                if (splat_depth == 0)
+                {
+                    ASSERT_EQ(transformed_custom[i][0][k], 0xffff);
+                    continue;
+                }
+                splat_pixels[i]++;
+                ASSERT_LT(transformed_custom[i][0][k], width * height);
+                if (transformed_depth[0][0][k] != 0)
+                {
+                    ASSERT_NEAR(splat_depth, transformed_depth[0][0][k], 10);
+                }
+            }
+        }
+        ASSERT_GT(splat_pixels[1], (size_t)width * height / 2);
+        ASSERT_GT(splat_pixels[2], splat_pixels[1]);
+    }
+
+    transformation_destroy(transformation_handle);
+}
+
+TEST_F(transformation_ut, transformation_depth_image_to_color_camera_custom_planes)
+{
+    k4a_transformation_t transformation_handle = transformation_create(&m_calibration, false);
+    ASSERT_NE(transformation_handle, (k4a_transformation_t)NULL);
+    ASSERT_EQ(transformation_set_cpu_thread_count(transformation_handle, 3), K4A_RESULT_SUCCEEDED);
+
+    int width = m_calibration.depth_camera_calibration.resolution_width;
+    int height = m_calibration.depth_camera_calibration.resolution_height;
+    int color_width = m_calibration.color_camera_calibration.resolution_width;
+    int color_height = m_calibration.color_camera_calibration.resolution_height;
+    const uint32_t plane_count = 3;
+
+    std::vector<uint16_t> depth((size_t)width * height);
+    std::vector<uint16_t> custom[plane_count];
+    for (uint32_t plane = 0; plane < plane_count; plane++)
+    {
+        custom[plane].resize((size_t)width * height);
+    }
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            size_t index = (size_t)y * width + x;
+            depth[index] = (uint16_t)((x % 37 == 0 && y % 41 == 0) ? 0 : 1500 + 2 * x + y);
+            custom[0][index] = (uint16_t)(y * width + x);
+            custom[1][index] = (uint16_t)(x * 97);
+            custom[2][index] = (uint16_t)((x ^ y) * 13);
+        }
+    }
+
+    k4a_transformation_image_descriptor_t depth_descriptor = { width,
+                                                               height,
+                                                               width * (int)sizeof(uint16_t),
+                                                               K4A_IMAGE_FORMAT_DEPTH16 };
+    k4a_transformation_image_descriptor_t custom_descriptor = { width,
+                                                                height,
+                                                                width * (int)sizeof(uint16_t),
+                                                                K4A_IMAGE_FORMAT_CUSTOM16 };
+    k4a_transformation_image_descriptor_t transformed_depth_descriptor = { color_width,
+                                                                           color_height,
+                                                                           color_width * (int)sizeof(uint16_t),
+                                                                           K4A_IMAGE_FORMAT_DEPTH16 };
+    k4a_transformation_image_descriptor_t transformed_custom_descriptor = { color_width,
+                                                                            color_height,
+                                                                            color_width * (int)sizeof(uint16_t),
+                                                                            K4A_IMAGE_FORMAT_CUSTOM16 };
+
+    const k4a_transformation_depth_to_color_mode_t modes[2] = { K4A_TRANSFORMATION_DEPTH_TO_COLOR_MODE_QUADS,
+                                                                K4A_TRANSFORMATION_DEPTH_TO_COLOR_MODE_SPLAT };
+    const k4a_transformation_interpolation_type_t interpolation_types[2] = {
+        K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR, K4A_TRANSFORMATION_INTERPOLATION_TYPE_NEAREST
+    };
+    size_t color_pixels = (size_t)color_width * color_height;
+    for (int i = 0; i < 2; i++)
+    {
+        ASSERT_EQ(transformation_set_depth_to_color_mode(transformation_handle, modes[i]), K4A_RESULT_SUCCEEDED);
+        for (int j = 0; j < 2; j++)
+        {
+            // One pass over all planes matches one transformation per plane
+            std::vector<uint16_t> transformed_depth(color_pixels, 0);
+            std::vector<uint16_t> transformed_custom[plane_count];
+            const uint8_t *custom_data[plane_count];
+            uint8_t *transformed_custom_data[plane_count];
+            for (uint32_t plane = 0; plane < plane_count; plane++)
+            {
+                transformed_custom[plane].assign(color_pixels, 0);
+                custom_data[plane] = (const uint8_t *)custom[plane].data();
+                transformed_custom_data[plane] = (uint8_t *)transformed_custom[plane].data();
+            }
+            ASSERT_EQ(transformation_depth_image_to_color_camera_custom_planes(transformation_handle,
+                                                                               (const uint8_t *)depth.data(),
+                                                                               &depth_descriptor,
+                                                                               custom_data,
+                                                                               &custom_descriptor,
+                                                                               plane_count,
+                                                                               (uint8_t *)transformed_depth.data(),
+                                                                               &transformed_depth_descriptor,
+                                                                               transformed_custom_data,
+                                                                               &transformed_custom_descriptor,
+                                                                               interpolation_types[j],
+                                                                               0xffff),
+                      K4A_RESULT_SUCCEEDED);
+
+            for (uint32_t plane = 0; plane < plane_count; plane++)
+            {
+                std::vector<uint16_t> expected_depth(color_pixels, 0);
+                std::vector<uint16_t> expected_custom(color_pixels, 0);
+                ASSERT_EQ(transformation_depth_image_to_color_camera_custom(transformation_handle,
+                                                                            (const uint8_t *)depth.data(),
+                                                                            &depth_descriptor,
+                                                                            custom_data[plane],
+                                                                            &custom_descriptor,
+                                                                            (uint8_t *)expected_depth.data(),
+                                                                            &transformed_depth_descriptor,
+                                                                            (uint8_t *)expected_custom.data(),
+                                                                            &transformed_custom_descriptor,
+                                                                            interpolation_types[j],
+                                                                            0xffff),
+                          K4A_RESULT_SUCCEEDED);
+                ASSERT_TRUE(expected_depth == transformed_depth);
+                ASSERT_TRUE(expected_custom == transformed_custom[plane]);
+            }
+        }
+    }
+
+    const uint8_t *custom_data[K4A_TRANSFORMATION_MAX_CUSTOM_PLANES + 1] = { 0 };
+    uint8_t *transformed_custom_data[K4A_TRANSFORMATION_MAX_CUSTOM_PLANES + 1] = { 0 };
+    std::vector<uint16_t> transformed_depth(color_pixels, 0);
+    ASSERT_EQ(transformation_depth_image_to_color_camera_custom_planes(transformation_handle,
+                                                                       (const uint8_t *)depth.data(),
+                                                                       &depth_descriptor,
+                                                                       custom_data,
+                                                                       &custom_descriptor,
+                                                                       K4A_TRANSFORMATION_MAX_CUSTOM_PLANES + 1,
+                                                                       (uint8_t *)transformed_depth.data(),
+                                                                       &transformed_depth_descriptor,
+                                                                       transformed_custom_data,
+                                                                       &transformed_custom_descriptor,
+                                                                       K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR,
+                                                                       0xffff),
+              K4A_RESULT_FAILED);
+
+    transformation_destroy(transformation_handle);
+}
+
+TEST_F(transformation_ut, transformation_depth_image_to_color_camera_precomputed_rays)
+{
+    k4a_transformation_t transformation_handle = transformation_create(&m_calibration, false);
+    ASSERT_NE(transformation_handle, (k4a_transformation_t)NULL);
+
+    int width = m_calibration.depth_camera_calibration.resolution_width;
+    int height = m_calibration.depth_camera_calibration.resolution_height;
+    int color_width = m_calibration.color_camera_calibration.resolution_width;
+    int color_height = m_calibration.color_camera_calibration.resolution_height;
+
+    k4a_image_t depth_image = NULL;
+    ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_DEPTH16,
+                           width,
+                           height,
+                           width * (int)sizeof(uint16_t),
+                           ALLOCATION_SOURCE_USER,
+                           &depth_image),
+              K4A_RESULT_SUCCEEDED);
+
+    // A slanted plane
+    uint16_t *depth_image_buffer = (uint16_t *)(void *)image_get_buffer(depth_image);
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            depth_image_buffer[y * width + x] = (uint16_t)(1000 + x + y);
+        }
+    }
+
+    // Computed from the calibration, with the precomputed rays, and from the calibration again after releasing them
+    k4a_image_t transformed_images[3] = { NULL, NULL, NULL };
+    bool precomputed_rays[3] = { false, true, false };
+    for (int i = 0; i < 3; i++)
+    {
+        ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_DEPTH16,
+                               color_width,
+                               color_height,
+                               color_width * (int)sizeof(uint16_t),
+                               ALLOCATION_SOURCE_USER,
+                               &transformed_images[i]),
+                  K4A_RESULT_SUCCEEDED);
+
+        k4a_transformation_image_descriptor_t depth_image_descriptor = image_get_descriptor(depth_image);
+        k4a_transformation_image_descriptor_t transformed_image_descriptor = image_get_descriptor(
+            transformed_images[i]);
+        // Ignored without a custom image
+        k4a_transformation_image_descriptor_t dummy_descriptor = { 0 };
+
+        ASSERT_EQ(transformation_set_precomputed_rays(transformation_handle, precomputed_rays[i]),
+                  K4A_RESULT_SUCCEEDED);
+        ASSERT_EQ(transformation_depth_image_to_color_camera_custom(transformation_handle,
+                                                                    image_get_buffer(depth_image),
+                                                                    &depth_image_descriptor,
+                                                                    NULL,
+                                                                    &dummy_descriptor,
+                                                                    image_get_buffer(transformed_images[i]),
+                                                                    &transformed_image_descriptor,
+                                                                    NULL,
+                                                                    &dummy_descriptor,
+                                                                    K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR,
+                                                                    0),
+                  K4A_RESULT_SUCCEEDED);
+    }
+
+    // The rays only change the rounding, so the images agree up to a handful of pixels along the edges
+    const uint16_t *computed = (const uint16_t *)(void *)image_get_buffer(transformed_images[0]);
+    const uint16_t *precomputed = (const uint16_t *)(void *)image_get_buffer(transformed_images[1]);
+    int pixel_count = color_width * color_height;
+    int valid_count = 0;
+    int different_count = 0;
+    for (int i = 0; i < pixel_count; i++)
+    {
+        valid_count += computed[i] != 0;
+        if (abs((int)computed[i] - (int)precomputed[i]) > 1)
+        {
+            different_count++;
+        }
+    }
+    ASSERT_GT(valid_count, 0);
+    ASSERT_LT(different_count, valid_count / 100);
+
+    ASSERT_EQ(memcmp(image_get_buffer(transformed_images[0]),
+                     image_get_buffer(transformed_images[2]),
+                     image_get_size(transformed_images[0])),
+              0);
+
+    for (int i = 0; i < 3; i++)
+    {
+        image_dec_ref(transformed_images[i]);
+    }
+    image_dec_ref(depth_image);
+    transformation_destroy(transformation_handle);
+}
+
+TEST_F(transformation_ut, transformation_backend)
+{
+    k4a_transformation_t transformation_handle = transformation_create(&m_calibration, false);
+    ASSERT_NE(transformation_handle, (k4a_transformation_t)NULL);
+
+    int width = m_calibration.depth_camera_calibration.resolution_width;
+    int height = m_calibration.depth_camera_calibration.resolution_height;
+    int color_width = m_calibration.color_camera_calibration.resolution_width;
+    int color_height = m_calibration.color_camera_calibration.resolution_height;
+
+    // GPU outputs only exist with the OpenCL backend
+    void *gpu_buffer = NULL;
+    ASSERT_EQ(transformation_set_gpu_output(transformation_handle, true), K4A_RESULT_FAILED);
+    ASSERT_EQ(transformation_get_gpu_output(transformation_handle,
+                                            K4A_TRANSFORMATION_GPU_OUTPUT_TRANSFORMED_DEPTH,
+                                            &gpu_buffer),
+              K4A_RESULT_FAILED);
+    ASSERT_EQ(transformation_set_backend(transformation_handle, (k4a_transformation_backend_t)42), K4A_RESULT_FAILED);
+    ASSERT_EQ(transformation_set_gpu_output_target(transformation_handle,
+                                                   K4A_TRANSFORMATION_GPU_OUTPUT_TRANSFORMED_DEPTH,
+                                                   K4A_TRANSFORMATION_GPU_TARGET_NONE,
+                                                   NULL),
+              K4A_RESULT_FAILED);
+    ASSERT_EQ(transformation_set_gpu_context(transformation_handle, &gpu_buffer, NULL), K4A_RESULT_FAILED);
+    ASSERT_EQ(transformation_set_gpu_context(transformation_handle, NULL, NULL), K4A_RESULT_SUCCEEDED);
+
+    k4a_image_t depth_image = NULL;
+    ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_DEPTH16,
+                           width,
+                           height,
+                           width * (int)sizeof(uint16_t),
+                           ALLOCATION_SOURCE_USER,
+                           &depth_image),
+              K4A_RESULT_SUCCEEDED);
+
+    // A slanted plane
+    uint16_t *depth_image_buffer = (uint16_t *)(void *)image_get_buffer(depth_image);
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            depth_image_buffer[y * width + x] = (uint16_t)(1000 + x + y);
+        }
+    }
+
+    // Transformed with the default backend, the CPU backend and the OpenCL backend if it is available
+    k4a_image_t transformed_images[3] = { NULL, NULL, NULL };
+    k4a_image_t xyz_images[3] = { NULL, NULL, NULL };
+    k4a_transformation_backend_t backends[3] = { K4A_TRANSFORMATION_BACKEND_DEFAULT,
+                                                 K4A_TRANSFORMATION_BACKEND_CPU,
+                                                 K4A_TRANSFORMATION_BACKEND_OPENCL };
+    int backend_count = 3;
+    for (int i = 0; i < backend_count; i++)
+    {
+        k4a_result_t result = transformation_set_backend(transformation_handle, backends[i]);
+        if (backends[i] == K4A_TRANSFORMATION_BACKEND_OPENCL && K4A_FAILED(result))
+        {
+            std::cout << "OpenCL transformation backend not available, only the CPU backends are compared" << std::endl;
+            backend_count = i;
+            break;
+        }
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+        ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_DEPTH16,
+                               color_width,
+                               color_height,
+                               color_width * (int)sizeof(uint16_t),
+                               ALLOCATION_SOURCE_USER,
+                               &transformed_images[i]),
+                  K4A_RESULT_SUCCEEDED);
+        ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_CUSTOM,
+                               width,
+                               height,
+                               width * 3 * (int)sizeof(int16_t),
+                               ALLOCATION_SOURCE_USER,
+                               &xyz_images[i]),
+                  K4A_RESULT_SUCCEEDED);
+
+        k4a_transformation_image_descriptor_t depth_image_descriptor = image_get_descriptor(depth_image);
+        k4a_transformation_image_descriptor_t transformed_image_descriptor = image_get_descriptor(
+            transformed_images[i]);
+        k4a_transformation_image_descriptor_t xyz_image_descriptor = image_get_descriptor(xyz_images[i]);
+        // Ignored without a custom image
+        k4a_transformation_image_descriptor_t dummy_descriptor = { 0 };
+
+        ASSERT_EQ(transformation_depth_image_to_color_camera_custom(transformation_handle,
+                                                                    image_get_buffer(depth_image),
+                                                                    &depth_image_descriptor,
+                                                                    NULL,
+                                                                    &dummy_descriptor,
+                                                                    image_get_buffer(transformed_images[i]),
+                                                                    &transformed_image_descriptor,
+                                                                    NULL,
+                                                                    &dummy_descriptor,
+                                                                    K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR,
+                                                                    0),
+                  K4A_RESULT_SUCCEEDED);
+        ASSERT_EQ(transformation_depth_image_to_point_cloud(transformation_handle,
+                                                            image_get_buffer(depth_image),
+                                                            &depth_image_descriptor,
+                                                            K4A_CALIBRATION_TYPE_DEPTH,
+                                                            image_get_buffer(xyz_images[i]),
+                                                            &xyz_image_descriptor),
+                  K4A_RESULT_SUCCEEDED);
+    }
+
+    // The handle was created without the transform engine, so the default backend is the CPU
+    ASSERT_EQ(memcmp(image_get_buffer(transformed_images[0]),
+                     image_get_buffer(transformed_images[1]),
+                     image_get_size(transformed_images[0])),
+              0);
+    ASSERT_EQ(memcmp(image_get_buffer(xyz_images[0]), image_get_buffer(xyz_images[1]), image_get_size(xyz_images[0])),
+              0);
+
+    if (backend_count == 3)
+    {
+        // The GPU rounds differently, so the images agree up to a handful of pixels along the edges
+        const uint16_t *cpu = (const uint16_t *)(void *)image_get_buffer(transformed_images[1]);
+        const uint16_t *gpu = (const uint16_t *)(void *)image_get_buffer(transformed_images[2]);
+        int valid_count = 0;
+        int different_count = 0;
+        for (int i = 0; i < color_width * color_height; i++)
+        {
+            valid_count += cpu[i] != 0;
+            if (abs((int)cpu[i] - (int)gpu[i]) > 1)
+            {
+                different_count++;
+            }
+        }
+        ASSERT_GT(valid_count, 0);
+        ASSERT_LT(different_count, valid_count / 100);
+
+        const int16_t *cpu_xyz = (const int16_t *)(void *)image_get_buffer(xyz_images[1]);
+        const int16_t *gpu_xyz = (const int16_t *)(void *)image_get_buffer(xyz_images[2]);
+        for (int i = 0; i < 3 * width * height; i++)
+        {
+            ASSERT_LE(abs((int)cpu_xyz[i] - (int)gpu_xyz[i]), 1);
+        }
+
+        ASSERT_EQ(transformation_set_gpu_output(transformation_handle, true), K4A_RESULT_SUCCEEDED);
+        ASSERT_EQ(transformation_get_gpu_output(transformation_handle,
+                                                K4A_TRANSFORMATION_GPU_OUTPUT_TRANSFORMED_COLOR,
+                                                &gpu_buffer),
+                  K4A_RESULT_FAILED);
+        ASSERT_EQ(transformation_get_gpu_output(transformation_handle,
+                                                K4A_TRANSFORMATION_GPU_OUTPUT_TRANSFORMED_DEPTH,
+                                                &gpu_buffer),
+                  K4A_RESULT_SUCCEEDED);
+        ASSERT_NE(gpu_buffer, (void *)NULL);
+        ASSERT_EQ(transformation_set_gpu_context(transformation_handle, NULL, NULL), K4A_RESULT_FAILED);
+
+        k4a_transformation_image_descriptor_t depth_image_descriptor = image_get_descriptor(depth_image);
+        k4a_transformation_image_descriptor_t xyz_image_descriptor = image_get_descriptor(xyz_images[2]);
+
+        // A buffer of the context is written in place, the smaller depth buffer cannot hold the point cloud
+        void *target_buffer = NULL;
+        ASSERT_EQ(transformation_set_gpu_output_target(transformation_handle,
+                                                       K4A_TRANSFORMATION_GPU_OUTPUT_TRANSFORMED_DEPTH,
+                                                       K4A_TRANSFORMATION_GPU_TARGET_OPENCL_BUFFER,
+                                                       gpu_buffer),
+                  K4A_RESULT_SUCCEEDED);
+        ASSERT_EQ(transformation_get_gpu_output(transformation_handle,
+                                                K4A_TRANSFORMATION_GPU_OUTPUT_TRANSFORMED_DEPTH,
+                                                &target_buffer),
+                  K4A_RESULT_FAILED);
+        ASSERT_EQ(transformation_set_gpu_output_target(transformation_handle,
+                                                       K4A_TRANSFORMATION_GPU_OUTPUT_POINT_CLOUD,
+                                                       K4A_TRANSFORMATION_GPU_TARGET_OPENCL_BUFFER,
+                                                       gpu_buffer),
+                  K4A_RESULT_SUCCEEDED);
+        ASSERT_EQ(transformation_depth_image_to_point_cloud(transformation_handle,
+                                                            image_get_buffer(depth_image),
+                                                            &depth_image_descriptor,
+                                                            K4A_CALIBRATION_TYPE_DEPTH,
+                                                            image_get_buffer(xyz_images[2]),
+                                                            &xyz_image_descriptor),
+                  K4A_RESULT_FAILED);
+        ASSERT_EQ(transformation_set_gpu_output_target(transformation_handle,
+                                                       K4A_TRANSFORMATION_GPU_OUTPUT_POINT_CLOUD,
+                                                       K4A_TRANSFORMATION_GPU_TARGET_NONE,
+                                                       NULL),
+                  K4A_RESULT_SUCCEEDED);
+        ASSERT_EQ(transformation_depth_image_to_point_cloud(transformation_handle,
+                                                            image_get_buffer(depth_image),
+                                                            &depth_image_descriptor,
+                                                            K4A_CALIBRATION_TYPE_DEPTH,
+                                                            image_get_buffer(xyz_images[2]),
+                                                            &xyz_image_descriptor),
+                  K4A_RESULT_SUCCEEDED);
+
+        // Buffers of another context are rejected
+        k4a_transformation_t other_handle = transformation_create(&m_calibration, false);
+        ASSERT_NE(other_handle, (k4a_transformation_t)NULL);
+        ASSERT_EQ(transformation_set_backend(other_handle, K4A_TRANSFORMATION_BACKEND_OPENCL), K4A_RESULT_SUCCEEDED);
+        ASSERT_EQ(transformation_set_gpu_output_target(other_handle,
+                                                       K4A_TRANSFORMATION_GPU_OUTPUT_TRANSFORMED_DEPTH,
+                                                       K4A_TRANSFORMATION_GPU_TARGET_OPENCL_BUFFER,
+                                                       gpu_buffer),
+                  K4A_RESULT_FAILED);
+        transformation_destroy(other_handle);
+
+        // Selecting another backend copies the results to the images again
+        ASSERT_EQ(transformation_set_backend(transformation_handle, K4A_TRANSFORMATION_BACKEND_CPU),
+                  K4A_RESULT_SUCCEEDED);
+        ASSERT_EQ(transformation_set_gpu_output(transformation_handle, true), K4A_RESULT_FAILED);
+    }
+
+    for (int i = 0; i < backend_count; i++)
+    {
+        image_dec_ref(transformed_images[i]);
+        image_dec_ref(xyz_images[i]);
+    }
+    image_dec_ref(depth_image);
+    transformation_destroy(transformation_handle);
+}
+
+TEST_F(transformation_ut, transformation_depth_image_to_colored_point_cloud)
+{
+    k4a_transformation_t transformation_handle = transformation_create(&m_calibration, false);
+    ASSERT_NE(transformation_handle, (k4a_transformation_t)NULL);
+
+    int width = m_calibration.depth_camera_calibration.resolution_width;
+    int height = m_calibration.depth_camera_calibration.resolution_height;
+    int color_width = m_calibration.color_camera_calibration.resolution_width;
+    int color_height = m_calibration.color_camera_calibration.resolution_height;
+
+    k4a_image_t depth_image = NULL;
+    ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_DEPTH16,
+                           width,
+                           height,
+                           width * (int)sizeof(uint16_t),
+                           ALLOCATION_SOURCE_USER,
+                           &depth_image),
+              K4A_RESULT_SUCCEEDED);
+    k4a_image_t color_image = NULL;
+    ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_COLOR_BGRA32,
+                           color_width,
+                           color_height,
+                           color_width * 4 * (int)sizeof(uint8_t),
+                           ALLOCATION_SOURCE_USER,
+                           &color_image),
+              K4A_RESULT_SUCCEEDED);
+
+    // A slanted plane with square holes without depth
+    uint16_t *depth_image_buffer = (uint16_t *)(void *)image_get_buffer(depth_image);
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            bool hole = (x / 16 + y / 16) % 5 == 0;
+            depth_image_buffer[y * width + x] = (uint16_t)(hole ? 0 : 1000 + x + y);
+        }
+    }
+    uint32_t *color_image_buffer = (uint32_t *)(void *)image_get_buffer(color_image);
+    for (int i = 0; i < color_width * color_height; i++)
+    {
+        color_image_buffer[i] = (uint32_t)i;
+    }
+
+    // The two step reference
+    k4a_image_t transformed_depth_image = NULL;
+    ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_DEPTH16,
+                           color_width,
+                           color_height,
+                           color_width * (int)sizeof(uint16_t),
+                           ALLOCATION_SOURCE_USER,
+                           &transformed_depth_image),
+              K4A_RESULT_SUCCEEDED);
+    k4a_image_t reference_xyz_image = NULL;
+    ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_CUSTOM,
+                           color_width,
+                           color_height,
+                           color_width * 3 * (int)sizeof(int16_t),
+                           ALLOCATION_SOURCE_USER,
+                           &reference_xyz_image),
+              K4A_RESULT_SUCCEEDED);
+
+    k4a_transformation_image_descriptor_t depth_image_descriptor = image_get_descriptor(depth_image);
+    k4a_transformation_image_descriptor_t color_image_descriptor = image_get_descriptor(color_image);
+    k4a_transformation_image_descriptor_t transformed_depth_image_descriptor = image_get_descriptor(
+        transformed_depth_image);
+    k4a_transformation_image_descriptor_t reference_xyz_image_descriptor = image_get_descriptor(reference_xyz_image);
+    k4a_transformation_image_descriptor_t dummy_descriptor = { 0 };
+
+    ASSERT_EQ(transformation_depth_image_to_color_camera_custom(transformation_handle,
+                                                                image_get_buffer(depth_image),
+                                                                &depth_image_descriptor,
+                                                                NULL,
+                                                                &dummy_descriptor,
+                                                                image_get_buffer(transformed_depth_image),
+                                                                &transformed_depth_image_descriptor,
+                                                                NULL,
+                                                                &dummy_descriptor,
+                                                                K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR,
+                                                                0),
+              K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(transformation_depth_image_to_point_cloud(transformation_handle,
+                                                        image_get_buffer(transformed_depth_image),
+                                                        &transformed_depth_image_descriptor,
+                                                        K4A_CALIBRATION_TYPE_COLOR,
+                                                        image_get_buffer(reference_xyz_image),
+                                                        &reference_xyz_image_descriptor),
+              K4A_RESULT_SUCCEEDED);
+    const int16_t *reference_xyz = (const int16_t *)(void *)image_get_buffer(reference_xyz_image);
+
+    for (int valid_points_only = 0; valid_points_only < 2; valid_points_only++)
+    {
+        k4a_image_t xyz_image = NULL;
+        ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_CUSTOM,
+                               color_width,
+                               color_height,
+                               color_width * 3 * (int)sizeof(int16_t),
+                               ALLOCATION_SOURCE_USER,
+                               &xyz_image),
+                  K4A_RESULT_SUCCEEDED);
+        k4a_image_t bgra_image = NULL;
+        ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_COLOR_BGRA32,
+                               color_width,
+                               color_height,
+                               color_width * 4 * (int)sizeof(uint8_t),
+                               ALLOCATION_SOURCE_USER,
+                               &bgra_image),
+                  K4A_RESULT_SUCCEEDED);
+
+        k4a_transformation_image_descriptor_t xyz_image_descriptor = image_get_descriptor(xyz_image);
+        k4a_transformation_image_descriptor_t bgra_image_descriptor = image_get_descriptor(bgra_image);
+        size_t point_count = 0;
+        ASSERT_EQ(transformation_depth_image_to_colored_point_cloud(transformation_handle,
+                                                                    image_get_buffer(depth_image),
+                                                                    &depth_image_descriptor,
+                                                                    image_get_buffer(color_image),
+                                                                    &color_image_descriptor,
+                                                                    valid_points_only != 0,
+                                                                    image_get_buffer(xyz_image),
+                                                                    &xyz_image_descriptor,
+                                                                    image_get_buffer(bgra_image),
+                                                                    &bgra_image_descriptor,
+                                                                    &point_count),
+                  K4A_RESULT_SUCCEEDED);
+
+        // Every point of the reference, either in place or packed in order
+        const int16_t *xyz = (const int16_t *)(void *)image_get_buffer(xyz_image);
+        const uint32_t *bgra = (const uint32_t *)(void *)image_get_buffer(bgra_image);
+        size_t point = 0;
+        for (int i = 0; i < color_width * color_height; i++)
+        {
+            if (valid_points_only && reference_xyz[3 * i + 2] == 0)
+            {
+                continue;
+            }
+            ASSERT_LT(point, point_count);
+            ASSERT_EQ(memcmp(&xyz[3 * point], &reference_xyz[3 * i], 3 * sizeof(int16_t)), 0);
+            ASSERT_EQ(bgra[point], color_image_buffer[i]);
+            point++;
+        }
+        ASSERT_EQ(point, point_count);
+        ASSERT_GT(point_count, 0u);
+
+        image_dec_ref(xyz_image);
+        image_dec_ref(bgra_image);
+    }
+
+    image_dec_ref(reference_xyz_image);
+    image_dec_ref(transformed_depth_image);
+    image_dec_ref(color_image);
+    image_dec_ref(depth_image);
+    transformation_destroy(transformation_handle);
+}
+
+TEST_F(transformation_ut, transformation_roi)
+{
+    k4a_transformation_t transformation_handle = transformation_create(&m_calibration, false);
+    ASSERT_NE(transformation_handle, (k4a_transformation_t)NULL);
+
+    int width = m_calibration.depth_camera_calibration.resolution_width;
+    int height = m_calibration.depth_camera_calibration.resolution_height;
+    int color_width = m_calibration.color_camera_calibration.resolution_width;
+    int color_height = m_calibration.color_camera_calibration.resolution_height;
+
+    k4a_image_t depth_image = NULL;
+    ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_DEPTH16,
+                           width,
+                           height,
+                           width * (int)sizeof(uint16_t),
+                           ALLOCATION_SOURCE_USER,
+                           &depth_image),
+              K4A_RESULT_SUCCEEDED);
+    k4a_image_t color_image = NULL;
+    ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_COLOR_BGRA32,
+                           color_width,
+                           color_height,
+                           color_width * 4 * (int)sizeof(uint8_t),
+                           ALLOCATION_SOURCE_USER,
+                           &color_image),
+              K4A_RESULT_SUCCEEDED);
+
+    // A smooth surface with holes
+    uint16_t *depth_image_buffer = (uint16_t *)(void *)image_get_buffer(depth_image);
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            bool hole = (x / 16 + y / 16) % 5 == 0;
+            depth_image_buffer[y * width + x] = (uint16_t)(hole ? 0 : 1000 + x + y);
+        }
+    }
+    uint32_t *color_image_buffer = (uint32_t *)(void *)image_get_buffer(color_image);
+    for (int i = 0; i < color_width * color_height; i++)
+    {
+        color_image_buffer[i] = (uint32_t)i | 0xff000000;
+    }
+
+    k4a_image_t transformed_depth_image = NULL;
+    ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_DEPTH16,
+                           color_width,
+                           color_height,
+                           color_width * (int)sizeof(uint16_t),
+                           ALLOCATION_SOURCE_USER,
+                           &transformed_depth_image),
+              K4A_RESULT_SUCCEEDED);
+    k4a_image_t transformed_color_image = NULL;
+    ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_COLOR_BGRA32,
+                           width,
+                           height,
+                           width * 4 * (int)sizeof(uint8_t),
+                           ALLOCATION_SOURCE_USER,
+                           &transformed_color_image),
+              K4A_RESULT_SUCCEEDED);
+    k4a_image_t xyz_image = NULL;
+    ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_CUSTOM,
+                           width,
+                           height,
+                           width * 3 * (int)sizeof(int16_t),
+                           ALLOCATION_SOURCE_USER,
+                           &xyz_image),
+              K4A_RESULT_SUCCEEDED);
+
+    k4a_transformation_image_descriptor_t depth_image_descriptor = image_get_descriptor(depth_image);
+    k4a_transformation_image_descriptor_t color_image_descriptor = image_get_descriptor(color_image);
+    k4a_transformation_image_descriptor_t transformed_depth_image_descriptor = image_get_descriptor(
+        transformed_depth_image);
+    k4a_transformation_image_descriptor_t transformed_color_image_descriptor = image_get_descriptor(
+        transformed_color_image);
+    k4a_transformation_image_descriptor_t xyz_image_descriptor = image_get_descriptor(xyz_image);
+    k4a_transformation_image_descriptor_t dummy_descriptor = { 0 };
+
+    ASSERT_EQ(transformation_depth_image_to_color_camera_custom(transformation_handle,
+                                                                image_get_buffer(depth_image),
+                                                                &depth_image_descriptor,
+                                                                NULL,
+                                                                &dummy_descriptor,
+                                                                image_get_buffer(transformed_depth_image),
+                                                                &transformed_depth_image_descriptor,
+                                                                NULL,
+                                                                &dummy_descriptor,
+                                                                K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR,
+                                                                0),
+              K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(transformation_color_image_to_depth_camera(transformation_handle,
+                                                         image_get_buffer(depth_image),
+                                                         &depth_image_descriptor,
+                                                         image_get_buffer(color_image),
+                                                         &color_image_descriptor,
+                                                         image_get_buffer(transformed_color_image),
+                                                         &transformed_color_image_descriptor),
+              K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(transformation_depth_image_to_point_cloud(transformation_handle,
+                                                        image_get_buffer(depth_image),
+                                                        &depth_image_descriptor,
+                                                        K4A_CALIBRATION_TYPE_DEPTH,
+                                                        image_get_buffer(xyz_image),
+                                                        &xyz_image_descriptor),
+              K4A_RESULT_SUCCEEDED);
+
+    // Each region of interest must match the same region of the whole image result
+    k4a_rect_t color_roi = { color_width / 4, color_height / 3, color_width / 2, color_height / 4 };
+    k4a_rect_t depth_roi = { width / 5, height / 4, width / 2, height / 3 };
+    uint32_t thread_counts[2] = { 1, 5 };
+    for (int i = 0; i < 2; i++)
+    {
+        k4a_image_t roi_depth_image = NULL;
+        ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_DEPTH16,
+                               color_roi.width,
+                               color_roi.height,
+                               color_roi.width * (int)sizeof(uint16_t),
+                               ALLOCATION_SOURCE_USER,
+                               &roi_depth_image),
+                  K4A_RESULT_SUCCEEDED);
+        k4a_transformation_image_descriptor_t roi_depth_image_descriptor = image_get_descriptor(roi_depth_image);
+
+        ASSERT_EQ(transformation_set_cpu_thread_count(transformation_handle, thread_counts[i]), K4A_RESULT_SUCCEEDED);
+        ASSERT_EQ(transformation_depth_image_to_color_camera_roi(transformation_handle,
+                                                                 image_get_buffer(depth_image),
+                                                                 &depth_image_descriptor,
+                                                                 &color_roi,
+                                                                 image_get_buffer(roi_depth_image),
+                                                                 &roi_depth_image_descriptor),
+                  K4A_RESULT_SUCCEEDED);
+
+        const uint16_t *full = (const uint16_t *)(const void *)image_get_buffer(transformed_depth_image);
+        const uint16_t *roi = (const uint16_t *)(const void *)image_get_buffer(roi_depth_image);
+        for (int y = 0; y < color_roi.height; y++)
+        {
+            ASSERT_EQ(memcmp(roi + y * color_roi.width,
+                             full + (color_roi.y + y) * color_width + color_roi.x,
+                             color_roi.width * sizeof(uint16_t)),
+                      0);
+        }
+        image_dec_ref(roi_depth_image);
+    }
+
+    k4a_image_t roi_color_image = NULL;
+    ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_COLOR_BGRA32,
+                           depth_roi.width,
+                           depth_roi.height,
+                           depth_roi.width * 4 * (int)sizeof(uint8_t),
+                           ALLOCATION_SOURCE_USER,
+                           &roi_color_image),
+              K4A_RESULT_SUCCEEDED);
+    k4a_transformation_image_descriptor_t roi_color_image_descriptor = image_get_descriptor(roi_color_image);
+    ASSERT_EQ(transformation_color_image_to_depth_camera_roi(transformation_handle,
+                                                             image_get_buffer(depth_image),
+                                                             &depth_image_descriptor,
+                                                             image_get_buffer(color_image),
+                                                             &color_image_descriptor,
+                                                             &depth_roi,
+                                                             image_get_buffer(roi_color_image),
+                                                             &roi_color_image_descriptor),
+              K4A_RESULT_SUCCEEDED);
+
+    k4a_image_t roi_xyz_image = NULL;
+    ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_CUSTOM,
+                           depth_roi.width,
+                           depth_roi.height,
+                           depth_roi.width * 3 * (int)sizeof(int16_t),
+                           ALLOCATION_SOURCE_USER,
+                           &roi_xyz_image),
+              K4A_RESULT_SUCCEEDED);
+    k4a_transformation_image_descriptor_t roi_xyz_image_descriptor = image_get_descriptor(roi_xyz_image);
+    ASSERT_EQ(transformation_depth_image_to_formatted_point_cloud(transformation_handle,
+                                                                  image_get_buffer(depth_image),
+                                                                  &depth_image_descriptor,
+                                                                  K4A_CALIBRATION_TYPE_DEPTH,
+                                                                  K4A_POINT_CLOUD_FORMAT_INT16_XYZ,
+                                                                  &depth_roi,
+                                                                  image_get_buffer(roi_xyz_image),
+                                                                  &roi_xyz_image_descriptor),
+              K4A_RESULT_SUCCEEDED);
+
+    for (int y = 0; y < depth_roi.height; y++)
+    {
+        size_t full_offset = (size_t)((depth_roi.y + y) * width + depth_roi.x);
+        ASSERT_EQ(memcmp(image_get_buffer(roi_color_image) + (size_t)(y * depth_roi.width) * 4,
+                         image_get_buffer(transformed_color_image) + full_offset * 4,
+                         (size_t)depth_roi.width * 4),
+                  0);
+        ASSERT_EQ(memcmp(image_get_buffer(roi_xyz_image) + (size_t)(y * depth_roi.width) * 3 * sizeof(int16_t),
+                         image_get_buffer(xyz_image) + full_offset * 3 * sizeof(int16_t),
+                         (size_t)depth_roi.width * 3 * sizeof(int16_t)),
+                  0);
+    }
+
+    // Regions that do not fit in the image are rejected
+    k4a_rect_t outside_roi = { width - depth_roi.width / 2, 0, depth_roi.width, depth_roi.height };
+    ASSERT_EQ(transformation_depth_image_to_formatted_point_cloud(transformation_handle,
+                                                                  image_get_buffer(depth_image),
+                                                                  &depth_image_descriptor,
+                                                                  K4A_CALIBRATION_TYPE_DEPTH,
+                                                                  K4A_POINT_CLOUD_FORMAT_INT16_XYZ,
+                                                                  &outside_roi,
+                                                                  image_get_buffer(roi_xyz_image),
+                                                                  &roi_xyz_image_descriptor),
+              K4A_RESULT_FAILED);
+    k4a_rect_t empty_roi = { 0, 0, 0, depth_roi.height };
+    ASSERT_EQ(transformation_color_image_to_depth_camera_roi(transformation_handle,
+                                                             image_get_buffer(depth_image),
+                                                             &depth_image_descriptor,
+                                                             image_get_buffer(color_image),
+                                                             &color_image_descriptor,
+                                                             &empty_roi,
+                                                             image_get_buffer(roi_color_image),
+                                                             &roi_color_image_descriptor),
+              K4A_RESULT_FAILED);
+    ASSERT_EQ(transformation_depth_image_to_color_camera_roi(transformation_handle,
+                                                             image_get_buffer(depth_image),
+                                                             &depth_image_descriptor,
+                                                             NULL,
+                                                             image_get_buffer(transformed_depth_image),
+                                                             &transformed_depth_image_descriptor),
+              K4A_RESULT_FAILED);
+
+    image_dec_ref(roi_xyz_image);
+    image_dec_ref(roi_color_image);
+    image_dec_ref(xyz_image);
+    image_dec_ref(transformed_color_image);
+    image_dec_ref(transformed_depth_image);
+    image_dec_ref(color_image);
+    image_dec_ref(depth_image);
+    transformation_destroy(transformation_handle);
+}
+
+TEST_F(transformation_ut, transformation_color_image_to_depth_camera_fixed_point)
+{
+    k4a_transformation_t transformation_handle = transformation_create(&m_calibration, false);
+    ASSERT_NE(transformation_handle, (k4a_transformation_t)NULL);
+
+    int width = m_calibration.depth_camera_calibration.resolution_width;
+    int height = m_calibration.depth_camera_calibration.resolution_height;
+    int color_width = m_calibration.color_camera_calibration.resolution_width;
+    int color_height = m_calibration.color_camera_calibration.resolution_height;
+
+    // A slanted wall with a few holes in front of a noisy color image
+    std::vector<uint16_t> depth((size_t)width * height);
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            depth[(size_t)y * width + x] = (uint16_t)((x % 37 == 0 && y % 41 == 0) ? 0 : 1500 + 2 * x + y);
+        }
+    }
+    std::vector<uint8_t> color((size_t)color_width * color_height * 4);
+    uint32_t seed = 1;
+    for (size_t i = 0; i < color.size(); i++)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        color[i] = (uint8_t)(seed >> 24);
+    }
+
+    k4a_transformation_image_descriptor_t depth_descriptor = { width,
+                                                               height,
+                                                               width * (int)sizeof(uint16_t),
+                                                               K4A_IMAGE_FORMAT_DEPTH16 };
+    k4a_transformation_image_descriptor_t color_descriptor = { color_width,
+                                                               color_height,
+                                                               color_width * 4,
+                                                               K4A_IMAGE_FORMAT_COLOR_BGRA32 };
+    k4a_transformation_image_descriptor_t transformed_color_descriptor = { width,
+                                                                           height,
+                                                                           width * 4,
+                                                                           K4A_IMAGE_FORMAT_COLOR_BGRA32 };
+
+    std::vector<uint8_t> transformed_color[2];
+    for (int fixed_point = 0; fixed_point < 2; fixed_point++)
+    {
+        transformed_color[fixed_point].assign((size_t)width * height * 4, 0);
+        ASSERT_EQ(transformation_set_fixed_point_bilinear(transformation_handle, fixed_point != 0),
+                  K4A_RESULT_SUCCEEDED);
+        ASSERT_EQ(transformation_color_image_to_depth_camera(transformation_handle,
+                                                             (const uint8_t *)depth.data(),
+                                                             &depth_descriptor,
+                                                             color.data(),
+                                                             &color_descriptor,
+                                                             transformed_color[fixed_point].data(),
+                                                             &transformed_color_descriptor),
+                  K4A_RESULT_SUCCEEDED);
+    }
+
+    // Every channel of the fixed point blend is within 1 of the float blend, and both mark the same pixels invalid
+    size_t exact_channels = 0;
+    size_t valid_pixels = 0;
+    for (size_t i = 0; i < transformed_color[0].size(); i += 4)
+    {
+        uint32_t float_pixel, fixed_pixel;
+        memcpy(&float_pixel, &transformed_color[0][i], sizeof(uint32_t));
+        memcpy(&fixed_pixel, &transformed_color[1][i], sizeof(uint32_t));
+        ASSERT_EQ(float_pixel == 0, fixed_pixel == 0);
+        valid_pixels += float_pixel != 0;
+        for (size_t channel = 0; channel < 4; channel++)
+        {
+            int difference = (int)transformed_color[0][i + channel] - (int)transformed_color[1][i + channel];
+            ASSERT_LE(std::abs(difference), 1);
+            exact_channels += difference == 0;
+        }
+    }
+    ASSERT_GT(valid_pixels, (size_t)width * height / 2);
+    ASSERT_GT(exact_channels, transformed_color[0].size() / 2);
+
+    // A region starting at an odd column moves pixels between the vector and the scalar blend, which must agree
+    k4a_rect_t roi = { 3, height / 4, width / 2 + 1, height / 2 };
+    std::vector<uint8_t> roi_color((size_t)roi.width * roi.height * 4);
+    k4a_transformation_image_descriptor_t roi_color_descriptor = { roi.width,
+                                                                   roi.height,
+                                                                   roi.width * 4,
+                                                                   K4A_IMAGE_FORMAT_COLOR_BGRA32 };
+    ASSERT_EQ(transformation_color_image_to_depth_camera_roi(transformation_handle,
+                                                             (const uint8_t *)depth.data(),
+                                                             &depth_descriptor,
+                                                             color.data(),
+                                                             &color_descriptor,
+                                                             &roi,
+                                                             roi_color.data(),
+                                                             &roi_color_descriptor),
+              K4A_RESULT_SUCCEEDED);
+    for (int y = 0; y < roi.height; y++)
+    {
+        ASSERT_EQ(memcmp(roi_color.data() + (size_t)y * roi.width * 4,
+                         transformed_color[1].data() + ((size_t)(roi.y + y) * width + roi.x) * 4,
+                         (size_t)roi.width * 4),
+                  0);
+    }
+
+    transformation_destroy(transformation_handle);
+}
+
+// Bilinear blend of the 4 pixels around point2d like the undistortion of 16 bit images, 0 outside the image and, for
+// depth, next to missing depth or a depth discontinuity
+static uint16_t
+undistort_bilinear_reference(const uint16_t *image, int width, int height, const float *point2d, bool depth)
+{
+    int x = (int)floorf(point2d[0]);
+    int y = (int)floorf(point2d[1]);
+    if (x < 0 || y < 0 || x + 1 >= width || y + 1 >= height)
+    {
+        return 0;
+    }
+
+    const uint16_t *top = image + y * width + x;
+    uint16_t vals[4] = { top[0], top[1], top[width], top[width + 1] };
+    if (depth)
+    {
+        uint16_t depth_min = std::min(std::min(vals[0], vals[1]), std::min(vals[2], vals[3]));
+        uint16_t depth_max = std::max(std::max(vals[0], vals[1]), std::max(vals[2], vals[3]));
+        if (depth_min == 0 || (float)depth_max - (float)depth_min > 0.04693441759f * depth_min)
+        {
+            return 0;
+        }
+    }
+
+    float fractional_x = point2d[0] - floorf(point2d[0]);
+    float fractional_y = point2d[1] - floorf(point2d[1]);
+    float interpol_x_0 = (1.f - fractional_x) * vals[0] + fractional_x * vals[1];
+    float interpol_x_1 = (1.f - fractional_x) * vals[2] + fractional_x * vals[3];
+    return (uint16_t)((1.f - fractional_y) * interpol_x_0 + fractional_y * interpol_x_1 + 0.5f);
+}
+
+TEST_F(transformation_ut, transformation_undistort)
+{
+    k4a_transformation_t transformation_handle = transformation_create(&m_calibration, false);
+    ASSERT_NE(transformation_handle, (k4a_transformation_t)NULL);
+
+    const k4a_calibration_camera_t *camera_calibration = &m_calibration.depth_camera_calibration;
+    int width = camera_calibration->resolution_width;
+    int height = camera_calibration->resolution_height;
+
+    k4a_image_t depth_image = NULL;
+    ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_DEPTH16,
+                           width,
+                           height,
+                           width * (int)sizeof(uint16_t),
+                           ALLOCATION_SOURCE_USER,
+                           &depth_image),
+              K4A_RESULT_SUCCEEDED);
+    k4a_image_t ir_image = NULL;
+    ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_IR16,
+                           width,
+                           height,
+                           width * (int)sizeof(uint16_t),
+                           ALLOCATION_SOURCE_USER,
+                           &ir_image),
+              K4A_RESULT_SUCCEEDED);
+    k4a_image_t bgra_image = NULL;
+    ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_COLOR_BGRA32,
+                           width,
+                           height,
+                           width * 4 * (int)sizeof(uint8_t),
+                           ALLOCATION_SOURCE_USER,
+                           &bgra_image),
+              K4A_RESULT_SUCCEEDED);
+
+    // A smooth surface with holes and steps
+    uint16_t *depth_image_buffer = (uint16_t *)(void *)image_get_buffer(depth_image);
+    uint16_t *ir_image_buffer = (uint16_t *)(void *)image_get_buffer(ir_image);
+    uint32_t *bgra_image_buffer = (uint32_t *)(void *)image_get_buffer(bgra_image);
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            bool hole = (x / 16 + y / 16) % 5 == 0;
+            int step = (x / 64) % 2 == 0 ? 0 : 500;
+            depth_image_buffer[y * width + x] = (uint16_t)(hole ? 0 : 1000 + step + x + y);
+            ir_image_buffer[y * width + x] = (uint16_t)(x * 97 + y * 31);
+            bgra_image_buffer[y * width + x] = 0xff000000 | (uint32_t)((x & 0xff) | (y & 0xff) << 8 | (x + y) << 16);
+        }
+    }
+
+    k4a_undistort_map_t nearest_map = NULL;
+    ASSERT_EQ(transformation_undistort_map_create(transformation_handle,
+                                                  K4A_CALIBRATION_TYPE_DEPTH,
+                                                  NULL,
+                                                  K4A_TRANSFORMATION_INTERPOLATION_TYPE_NEAREST,
+                                                  &nearest_map),
+              K4A_RESULT_SUCCEEDED);
+    k4a_undistort_map_t linear_map = NULL;
+    ASSERT_EQ(transformation_undistort_map_create(transformation_handle,
+                                                  K4A_CALIBRATION_TYPE_DEPTH,
+                                                  NULL,
+                                                  K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR,
+                                                  &linear_map),
+              K4A_RESULT_SUCCEEDED);
+
+    // Without a pinhole the map keeps the camera intrinsics and resolution
+    k4a_transformation_pinhole_t pinhole;
+    ASSERT_EQ(transformation_undistort_map_get_pinhole(linear_map, &pinhole), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(pinhole.width, width);
+    ASSERT_EQ(pinhole.height, height);
+    ASSERT_EQ(pinhole.px, camera_calibration->intrinsics.parameters.param.cx);
+    ASSERT_EQ(pinhole.fy, camera_calibration->intrinsics.parameters.param.fy);
+
+    k4a_image_t undistorted_images[3] = { NULL, NULL, NULL };
+    k4a_image_t images[3] = { depth_image, ir_image, bgra_image };
+    for (int i = 0; i < 3; i++)
+    {
+        ASSERT_EQ(image_create(image_get_format(images[i]),
+                               width,
+                               height,
+                               image_get_stride_bytes(images[i]),
+                               ALLOCATION_SOURCE_USER,
+                               &undistorted_images[i]),
+                  K4A_RESULT_SUCCEEDED);
+    }
+
+    for (int interpolation = 0; interpolation < 2; interpolation++)
+    {
+        k4a_undistort_map_t map = interpolation == 0 ? nearest_map : linear_map;
+        for (int i = 0; i < 3; i++)
+        {
+            k4a_transformation_image_descriptor_t image_descriptor = image_get_descriptor(images[i]);
+            k4a_transformation_image_descriptor_t undistorted_image_descriptor = image_get_descriptor(
+                undistorted_images[i]);
+            ASSERT_EQ(transformation_undistort(map,
+                                               image_get_buffer(images[i]),
+                                               &image_descriptor,
+                                               image_get_buffer(undistorted_images[i]),
+                                               &undistorted_image_descriptor),
+                      K4A_RESULT_SUCCEEDED);
+        }
+
+        const uint16_t *undistorted_depth = (const uint16_t *)(void *)image_get_buffer(undistorted_images[0]);
+        const uint16_t *undistorted_ir = (const uint16_t *)(void *)image_get_buffer(undistorted_images[1]);
+        const uint8_t *undistorted_bgra = image_get_buffer(undistorted_images[2]);
+        const uint8_t *bgra = image_get_buffer(bgra_image);
+        int valid_count = 0;
+        for (int y = 0; y < height; y++)
+        {
+            for (int x = 0; x < width; x++)
+            {
+                int idx = y * width + x;
+                float ray[3] = { ((float)x - pinhole.px) / pinhole.fx, ((float)y - pinhole.py) / pinhole.fy, 1.f };
+                float point2d[2];
+                int valid = 0;
+                ASSERT_EQ(transformation_project(camera_calibration, ray, point2d, &valid), K4A_RESULT_SUCCEEDED);
+
+                if (interpolation == 0)
+                {
+                    int u = (int)floorf(point2d[0] + 0.5f);
+                    int v = (int)floorf(point2d[1] + 0.5f);
+                    bool inside = valid && u >= 0 && u < width && v >= 0 && v < height;
+                    ASSERT_EQ(undistorted_depth[idx], inside ? depth_image_buffer[v * width + u] : 0);
+                    ASSERT_EQ(undistorted_ir[idx], inside ? ir_image_buffer[v * width + u] : 0);
+                    for (int c = 0; c < 4; c++)
+                    {
+                        ASSERT_EQ(undistorted_bgra[4 * idx + c], inside ? bgra[4 * (v * width + u) + c] : 0);
+                    }
+                    valid_count += inside ? 1 : 0;
+                    continue;
+                }
+
+                uint16_t expected_depth = 0;
+                uint16_t expected_ir = 0;
+                if (valid)
+                {
+                    expected_depth = undistort_bilinear_reference(depth_image_buffer, width, height, point2d, true);
+                    expected_ir = undistort_bilinear_reference(ir_image_buffer, width, height, point2d, false);
+                }
+                ASSERT_EQ(undistorted_depth[idx], expected_depth);
+                ASSERT_LE(std::abs(undistorted_ir[idx] - expected_ir), 1);
+                if (expected_ir == 0)
+                {
+                    for (int c = 0; c < 4; c++)
+                    {
+                        ASSERT_EQ(undistorted_bgra[4 * idx + c], 0);
+                    }
+                }
+                else
+                {
+                    ASSERT_EQ(undistorted_bgra[4 * idx + 3], 0xff);
+                    valid_count++;
+                }
+            }
+        }
+        ASSERT_GT(valid_count, width * height / 2);
+    }
+
+    // A pinhole of half the resolution with a wider field of view
+    pinhole.px = pinhole.px / 2;
+    pinhole.py = pinhole.py / 2;
+    pinhole.fx = pinhole.fx / 3;
+    pinhole.fy = pinhole.fy / 3;
+    pinhole.width = width / 2;
+    pinhole.height = height / 2;
+    k4a_undistort_map_t pinhole_map = NULL;
+    ASSERT_EQ(transformation_undistort_map_create(transformation_handle,
+                                                  K4A_CALIBRATION_TYPE_DEPTH,
+                                                  &pinhole,
+                                                  K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR,
+                                                  &pinhole_map),
+              K4A_RESULT_SUCCEEDED);
+    k4a_transformation_pinhole_t map_pinhole;
+    ASSERT_EQ(transformation_undistort_map_get_pinhole(pinhole_map, &map_pinhole), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(map_pinhole.width, width / 2);
+    ASSERT_EQ(map_pinhole.fx, pinhole.fx);
+
+    k4a_image_t small_image = NULL;
+    ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_IR16,
+                           width / 2,
+                           height / 2,
+                           width / 2 * (int)sizeof(uint16_t),
+                           ALLOCATION_SOURCE_USER,
+                           &small_image),
+              K4A_RESULT_SUCCEEDED);
+    k4a_transformation_image_descriptor_t ir_image_descriptor = image_get_descriptor(ir_image);
+    k4a_transformation_image_descriptor_t small_image_descriptor = image_get_descriptor(small_image);
+    k4a_transformation_image_descriptor_t undistorted_image_descriptor = image_get_descriptor(undistorted_images[1]);
+    ASSERT_EQ(transformation_undistort(pinhole_map,
+                                       image_get_buffer(ir_image),
+                                       &ir_image_descriptor,
+                                       image_get_buffer(small_image),
+                                       &small_image_descriptor),
+              K4A_RESULT_SUCCEEDED);
+
+    // The output must have the pinhole resolution and the format of the input
+    ASSERT_EQ(transformation_undistort(pinhole_map,
+                                       image_get_buffer(ir_image),
+                                       &ir_image_descriptor,
+                                       image_get_buffer(undistorted_images[1]),
+                                       &undistorted_image_descriptor),
+              K4A_RESULT_FAILED);
+    k4a_transformation_image_descriptor_t depth_image_descriptor = image_get_descriptor(depth_image);
+    ASSERT_EQ(transformation_undistort(pinhole_map,
+                                       image_get_buffer(depth_image),
+                                       &depth_image_descriptor,
+                                       image_get_buffer(small_image),
+                                       &small_image_descriptor),
+              K4A_RESULT_FAILED);
+
+    k4a_transformation_image_descriptor_t custom_image_descriptor = ir_image_descriptor;
+    custom_image_descriptor.format = K4A_IMAGE_FORMAT_CUSTOM16;
+    ASSERT_EQ(transformation_undistort(linear_map,
+                                       image_get_buffer(ir_image),
+                                       &custom_image_descriptor,
+                                       image_get_buffer(undistorted_images[1]),
+                                       &custom_image_descriptor),
+              K4A_RESULT_FAILED);
+
+    k4a_undistort_map_t invalid_map = NULL;
+    pinhole.fx = 0.f;
+    ASSERT_EQ(transformation_undistort_map_create(transformation_handle,
+                                                  K4A_CALIBRATION_TYPE_DEPTH,
+                                                  &pinhole,
+                                                  K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR,
+                                                  &invalid_map),
+              K4A_RESULT_FAILED);
+    ASSERT_EQ(invalid_map, (k4a_undistort_map_t)NULL);
+    ASSERT_EQ(transformation_undistort_map_create(transformation_handle,
+                                                  K4A_CALIBRATION_TYPE_GYRO,
+                                                  NULL,
+                                                  K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR,
+                                                  &invalid_map),
+              K4A_RESULT_FAILED);
+
+    image_dec_ref(small_image);
+    for (int i = 0; i < 3; i++)
+    {
+        image_dec_ref(undistorted_images[i]);
+    }
+    image_dec_ref(bgra_image);
+    image_dec_ref(ir_image);
+    image_dec_ref(depth_image);
+    transformation_undistort_map_destroy(pinhole_map);
+    transformation_undistort_map_destroy(linear_map);
+    transformation_undistort_map_destroy(nearest_map);
+    transformation_destroy(transformation_handle);
+}
+
+typedef struct
+{
+    int completed;
+    int succeeded;
+} transformation_async_results_t;
+
+static void transformation_async_complete(k4a_result_t result, void *context)
+{
+    transformation_async_results_t *results = (transformation_async_results_t *)context;
+    results->completed++;
+    if (K4A_SUCCEEDED(result))
+    {
+        results->succeeded++;
+    }
+}
+
+TEST_F(transformation_ut, transformation_depth_image_to_point_cloud_async)
+{
+    k4a_transformation_t transformation_handle = transformation_create(&m_calibration, false);
+    ASSERT_NE(transformation_handle, (k4a_transformation_t)NULL);
+
+    int width = m_calibration.depth_camera_calibration.resolution_width;
+    int height = m_calibration.depth_camera_calibration.resolution_height;
+    k4a_image_t depth_image = NULL;
+    ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_DEPTH16,
+                           width,
+                           height,
+                           width * (int)sizeof(uint16_t),
+                           ALLOCATION_SOURCE_USER,
+                           &depth_image),
+              K4A_RESULT_SUCCEEDED);
+
+    uint16_t *depth_image_buffer = (uint16_t *)(void *)image_get_buffer(depth_image);
+    for (int i = 0; i < width * height; i++)
+    {
+        depth_image_buffer[i] = (uint16_t)1000;
+    }
+
+    k4a_image_t xyz_image = NULL;
+    ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_CUSTOM,
+                           width,
+                           height,
+                           width * 3 * (int)sizeof(int16_t),
+                           ALLOCATION_SOURCE_USER,
+                           &xyz_image),
+              K4A_RESULT_SUCCEEDED);
+
+    transformation_async_results_t results = { 0, 0 };
+    ASSERT_EQ(k4a_transformation_depth_image_to_point_cloud_async(
+                  transformation_handle, depth_image, K4A_CALIBRATION_TYPE_DEPTH, xyz_image, NULL, &results),
+              K4A_RESULT_FAILED);
+
+    const int queued = 3;
+    for (int i = 0; i < queued; i++)
+    {
+        ASSERT_EQ(k4a_transformation_depth_image_to_point_cloud_async(transformation_handle,
+                                                                      depth_image,
+                                                                      K4A_CALIBRATION_TYPE_DEPTH,
+                                                                      xyz_image,
+                                                                      transformation_async_complete,
+                                                                      &results),
+                  K4A_RESULT_SUCCEEDED);
+    }
+
+    // A mismatched output is reported through the callback
+    ASSERT_EQ(k4a_transformation_depth_image_to_point_cloud_async(transformation_handle,
+                                                                  depth_image,
+                                                                  K4A_CALIBRATION_TYPE_DEPTH,
+                                                                  depth_image,
+                                                                  transformation_async_complete,
+                                                                  &results),
+              K4A_RESULT_SUCCEEDED);
+
+    // Destroying waits for everything queued
+    transformation_destroy(transformation_handle);
+    ASSERT_EQ(results.completed, queued + 1);
+    ASSERT_EQ(results.succeeded, queued);
+
+    int16_t *xyz_image_buffer = (int16_t *)(void *)image_get_buffer(xyz_image);
+    double check_sum = 0;
+    for (int i = 0; i < 3 * width * height; i++)
+    {
+        check_sum += (double)abs(xyz_image_buffer[i]);
+    }
+    check_sum /= (double)(3 * width * height);
+
+    // Same reference as transformation_depth_image_to_point_cloud
+    const double reference_val = 562.20976003011071;
+    if (std::abs(check_sum - reference_val) > 0.001)
+    {
+        ASSERT_EQ(check_sum, reference_val);
+    }
+
+    image_dec_ref(depth_image);
+    image_dec_ref(xyz_image);
+}
+
+typedef struct
+{
+    k4a_transformation_t transformation_handle;
+    std::atomic<int> completed;
+} transformation_async_destroy_context_t;
+
+static void transformation_async_destroy_complete(k4a_result_t result, void *context)
+{
+    transformation_async_destroy_context_t *destroy_context = (transformation_async_destroy_context_t *)context;
+    (void)result;
+    if (destroy_context->completed.fetch_add(1) == 0)
+    {
+        // Returns without waiting for this callback, the handle is released after the last queued transformation
+        transformation_destroy(destroy_context->transformation_handle);
+    }
+}
+
+TEST_F(transformation_ut, transformation_destroy_from_async_callback)
+{
+    transformation_async_destroy_context_t destroy_context;
+    destroy_context.transformation_handle = transformation_create(&m_calibration, false);
+    destroy_context.completed = 0;
+    ASSERT_NE(destroy_context.transformation_handle, (k4a_transformation_t)NULL);
+
+    int width = m_calibration.depth_camera_calibration.resolution_width;
+    int height = m_calibration.depth_camera_calibration.resolution_height;
+    k4a_image_t depth_image = NULL;
+    ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_DEPTH16,
+                           width,
+                           height,
+                           width * (int)sizeof(uint16_t),
+                           ALLOCATION_SOURCE_USER,
+                           &depth_image),
+              K4A_RESULT_SUCCEEDED);
+    memset(image_get_buffer(depth_image), 0, image_get_size(depth_image));
+
+    k4a_image_t xyz_image = NULL;
+    ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_CUSTOM,
+                           width,
+                           height,
+                           width * 3 * (int)sizeof(int16_t),
+                           ALLOCATION_SOURCE_USER,
+                           &xyz_image),
+              K4A_RESULT_SUCCEEDED);
+
+    const int queued = 3;
+    for (int i = 0; i < queued; i++)
+    {
+        ASSERT_EQ(k4a_transformation_depth_image_to_point_cloud_async(destroy_context.transformation_handle,
+                                                                      depth_image,
+                                                                      K4A_CALIBRATION_TYPE_DEPTH,
+                                                                      xyz_image,
+                                                                      transformation_async_destroy_complete,
+                                                                      &destroy_context),
+                  K4A_RESULT_SUCCEEDED);
+    }
+
+    // The transformations queued behind the destroying callback still complete
+    for (int i = 0; i < 1000 && destroy_context.completed < queued; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_EQ(destroy_context.completed, queued);
+
+    // Joins the thread of the released handle
+    k4a_transformation_t transformation_handle = transformation_create(&m_calibration, false);
+    ASSERT_NE(transformation_handle, (k4a_transformation_t)NULL);
+    transformation_destroy(transformation_handle);
+
+    image_dec_ref(depth_image);
+    image_dec_ref(xyz_image);
+}
+
 TEST_F(transformation_ut, transformation_all_image_functions_with_failure_cases)
 {
     int depth_image_width_pixels = 640;
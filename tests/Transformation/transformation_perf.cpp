@@ -0,0 +1,471 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <utcommon.h>
+#include <ut_calibration_data.h>
+
+// Module being tested
+#include <k4a/k4a.h>
+#include <k4ainternal/transformation.h>
+#include <k4ainternal/image.h>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace testing;
+
+class transformation_perf : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_EQ(k4a_calibration_get_from_raw(g_test_json,
+                                               sizeof(g_test_json),
+                                               K4A_DEPTH_MODE_WFOV_2X2BINNED,
+                                               K4A_COLOR_RESOLUTION_2160P,
+                                               &m_calibration),
+                  K4A_RESULT_SUCCEEDED);
+
+        int width = m_calibration.depth_camera_calibration.resolution_width;
+        int height = m_calibration.depth_camera_calibration.resolution_height;
+        ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_DEPTH16,
+                               width,
+                               height,
+                               width * (int)sizeof(uint16_t),
+                               ALLOCATION_SOURCE_USER,
+                               &m_depth_image),
+                  K4A_RESULT_SUCCEEDED);
+
+        // A slanted wall with a closer box in front of it
+        uint16_t *depth_image_buffer = (uint16_t *)(void *)image_get_buffer(m_depth_image);
+        for (int y = 0; y < height; y++)
+        {
+            for (int x = 0; x < width; x++)
+            {
+                bool box = x > width / 3 && x < width / 2 && y > height / 3 && y < height / 2;
+                depth_image_buffer[y * width + x] = (uint16_t)(box ? 600 : 1500 + 2 * x + y);
+            }
+        }
+
+        // Color pixels spread over the image
+        int color_width = m_calibration.color_camera_calibration.resolution_width;
+        int color_height = m_calibration.color_camera_calibration.resolution_height;
+        for (int y = color_height / 40; y < color_height; y += color_height / 20)
+        {
+            for (int x = color_width / 40; x < color_width; x += color_width / 20)
+            {
+                m_color_point2d.push_back((float)x);
+                m_color_point2d.push_back((float)y);
+            }
+        }
+    }
+
+    void TearDown() override
+    {
+        if (m_depth_image != NULL)
+        {
+            image_dec_ref(m_depth_image);
+        }
+    }
+
+    k4a_calibration_t m_calibration;
+    k4a_image_t m_depth_image = NULL;
+    std::vector<float> m_color_point2d;
+};
+
+TEST_F(transformation_perf, color_2d_to_depth_2d)
+{
+    size_t point_count = m_color_point2d.size() / 2;
+    std::vector<float> exhaustive_point2d(2 * point_count), point2d(2 * point_count), batch_point2d(2 * point_count);
+    std::vector<int> exhaustive_valid(point_count), valid(point_count), batch_valid(point_count);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < point_count; i++)
+    {
+        ASSERT_EQ(transformation_color_2d_to_depth_2d_exhaustive(&m_calibration,
+                                                                 &m_color_point2d[2 * i],
+                                                                 m_depth_image,
+                                                                 &exhaustive_point2d[2 * i],
+                                                                 &exhaustive_valid[i]),
+                  K4A_RESULT_SUCCEEDED);
+    }
+    auto exhaustive_stop = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < point_count; i++)
+    {
+        ASSERT_EQ(transformation_color_2d_to_depth_2d(
+                      &m_calibration, &m_color_point2d[2 * i], m_depth_image, &point2d[2 * i], &valid[i]),
+                  K4A_RESULT_SUCCEEDED);
+    }
+    auto coarse_to_fine_stop = std::chrono::high_resolution_clock::now();
+    ASSERT_EQ(transformation_color_2d_to_depth_2d_batch(&m_calibration,
+                                                        m_color_point2d.data(),
+                                                        point_count,
+                                                        m_depth_image,
+                                                        batch_point2d.data(),
+                                                        batch_valid.data()),
+              K4A_RESULT_SUCCEEDED);
+    auto batch_stop = std::chrono::high_resolution_clock::now();
+
+    size_t valid_count = 0, match_count = 0;
+    for (size_t i = 0; i < point_count; i++)
+    {
+        if (exhaustive_valid[i])
+        {
+            valid_count++;
+            if (valid[i] && fabs(point2d[2 * i] - exhaustive_point2d[2 * i]) < 1 &&
+                fabs(point2d[2 * i + 1] - exhaustive_point2d[2 * i + 1]) < 1)
+            {
+                match_count++;
+            }
+        }
+    }
+
+    double exhaustive_us = std::chrono::duration<double, std::micro>(exhaustive_stop - start).count();
+    double coarse_to_fine_us = std::chrono::duration<double, std::micro>(coarse_to_fine_stop - exhaustive_stop).count();
+    double batch_us = std::chrono::duration<double, std::micro>(batch_stop - coarse_to_fine_stop).count();
+    printf("%zu color pixels, %zu with a depth pixel, %zu found by both searches\n",
+           point_count,
+           valid_count,
+           match_count);
+    printf("Exhaustive walk:       %8.2f us per point\n", exhaustive_us / point_count);
+    printf("Coarse to fine search: %8.2f us per point (%.1fx)\n",
+           coarse_to_fine_us / point_count,
+           exhaustive_us / coarse_to_fine_us);
+    printf("Coarse to fine batch:  %8.2f us per point (%.1fx)\n",
+           batch_us / point_count,
+           exhaustive_us / batch_us);
+}
+
+// Times the whole image CPU transformations of every depth mode and color resolution with the kernels of each
+// instruction set this CPU supports. Throughput is in megapixels of the transformed image per second: color pixels for
+// depth to color, depth pixels for color to depth and the point cloud.
+#define TRANSFORMATION_PERF_ITERATIONS 5
+
+struct transformation_perf_images
+{
+    std::vector<uint16_t> depth;
+    std::vector<uint8_t> color;
+    std::vector<uint16_t> transformed_depth;
+    std::vector<uint8_t> transformed_color;
+    std::vector<int16_t> xyz;
+    k4a_transformation_image_descriptor_t depth_descriptor;
+    k4a_transformation_image_descriptor_t color_descriptor;
+    k4a_transformation_image_descriptor_t transformed_depth_descriptor;
+    k4a_transformation_image_descriptor_t transformed_color_descriptor;
+    k4a_transformation_image_descriptor_t xyz_descriptor;
+};
+
+static void transformation_perf_create_images(const k4a_calibration_t *calibration, transformation_perf_images *images)
+{
+    int width = calibration->depth_camera_calibration.resolution_width;
+    int height = calibration->depth_camera_calibration.resolution_height;
+    int color_width = calibration->color_camera_calibration.resolution_width;
+    int color_height = calibration->color_camera_calibration.resolution_height;
+
+    // A slanted wall, so neighbouring depth pixels land on different color pixels
+    images->depth.resize((size_t)width * height);
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            images->depth[(size_t)y * width + x] = (uint16_t)(1500 + x + y);
+        }
+    }
+    images->color.resize((size_t)color_width * color_height * 4);
+    for (size_t i = 0; i < images->color.size(); i++)
+    {
+        images->color[i] = (uint8_t)(i * 13);
+    }
+    images->transformed_depth.resize((size_t)color_width * color_height);
+    images->transformed_color.resize((size_t)width * height * 4);
+    images->xyz.resize((size_t)width * height * 3);
+
+    images->depth_descriptor = { width, height, width * (int)sizeof(uint16_t), K4A_IMAGE_FORMAT_DEPTH16 };
+    images->color_descriptor = { color_width, color_height, color_width * 4, K4A_IMAGE_FORMAT_COLOR_BGRA32 };
+    images->transformed_depth_descriptor = {
+        color_width, color_height, color_width * (int)sizeof(uint16_t), K4A_IMAGE_FORMAT_DEPTH16
+    };
+    images->transformed_color_descriptor = { width, height, width * 4, K4A_IMAGE_FORMAT_COLOR_BGRA32 };
+    images->xyz_descriptor = { width, height, width * 3 * (int)sizeof(int16_t), K4A_IMAGE_FORMAT_CUSTOM };
+}
+
+// Megapixels per second of running fn TRANSFORMATION_PERF_ITERATIONS times after a warm up run
+template<typename T> static double transformation_perf_time(int output_pixels, T fn)
+{
+    if (K4A_FAILED(fn()))
+    {
+        return 0;
+    }
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < TRANSFORMATION_PERF_ITERATIONS; i++)
+    {
+        if (K4A_FAILED(fn()))
+        {
+            return 0;
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    return (double)output_pixels * TRANSFORMATION_PERF_ITERATIONS / seconds / 1e6;
+}
+
+TEST(transformation_kernels_perf, kernels)
+{
+    const k4a_depth_mode_t depth_modes[] = { K4A_DEPTH_MODE_NFOV_2X2BINNED,
+                                             K4A_DEPTH_MODE_NFOV_UNBINNED,
+                                             K4A_DEPTH_MODE_WFOV_2X2BINNED,
+                                             K4A_DEPTH_MODE_WFOV_UNBINNED };
+    const k4a_color_resolution_t color_resolutions[] = { K4A_COLOR_RESOLUTION_720P,  K4A_COLOR_RESOLUTION_1080P,
+                                                         K4A_COLOR_RESOLUTION_1440P, K4A_COLOR_RESOLUTION_1536P,
+                                                         K4A_COLOR_RESOLUTION_2160P, K4A_COLOR_RESOLUTION_3072P };
+    uint32_t thread_count = std::min((uint32_t)std::max(1u, std::thread::hardware_concurrency()),
+                                     (uint32_t)K4A_TRANSFORMATION_MAX_THREAD_COUNT);
+
+    printf("Mpixel/s of the transformed image, %d runs each, depth to color with 1 and %u threads\n",
+           TRANSFORMATION_PERF_ITERATIONS,
+           thread_count);
+    printf("%-6s %-10s %-9s %9s %14s %14s %14s\n",
+           "isa",
+           "depth",
+           "color",
+           "d2c 1 thr",
+           "d2c threaded",
+           "color to depth",
+           "point cloud");
+
+    for (uint32_t instruction_set = 0; instruction_set < transformation_get_instruction_set_count(); instruction_set++)
+    {
+        ASSERT_EQ(transformation_set_instruction_set_limit(instruction_set), K4A_RESULT_SUCCEEDED);
+        for (k4a_depth_mode_t depth_mode : depth_modes)
+        {
+            for (k4a_color_resolution_t color_resolution : color_resolutions)
+            {
+                k4a_calibration_t calibration;
+                ASSERT_EQ(k4a_calibration_get_from_raw(
+                              g_test_json, sizeof(g_test_json), depth_mode, color_resolution, &calibration),
+                          K4A_RESULT_SUCCEEDED);
+                k4a_transformation_t transformation_handle = transformation_create(&calibration, false);
+                ASSERT_NE(transformation_handle, (k4a_transformation_t)NULL);
+
+                transformation_perf_images images;
+                transformation_perf_create_images(&calibration, &images);
+                int depth_pixels = images.depth_descriptor.width_pixels * images.depth_descriptor.height_pixels;
+                int color_pixels = images.color_descriptor.width_pixels * images.color_descriptor.height_pixels;
+
+                // Without a custom image its descriptors are ignored
+                k4a_transformation_image_descriptor_t no_custom_descriptor = { 0, 0, 0, K4A_IMAGE_FORMAT_CUSTOM };
+                auto depth_to_color = [&]() {
+                    return transformation_depth_image_to_color_camera_custom(
+                        transformation_handle,
+                        (const uint8_t *)images.depth.data(),
+                        &images.depth_descriptor,
+                        NULL,
+                        &no_custom_descriptor,
+                        (uint8_t *)images.transformed_depth.data(),
+                        &images.transformed_depth_descriptor,
+                        NULL,
+                        &no_custom_descriptor,
+                        K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR,
+                        0);
+                };
+                ASSERT_EQ(transformation_set_cpu_thread_count(transformation_handle, 1), K4A_RESULT_SUCCEEDED);
+                double depth_to_color_single = transformation_perf_time(color_pixels, depth_to_color);
+                ASSERT_EQ(transformation_set_cpu_thread_count(transformation_handle, thread_count),
+                          K4A_RESULT_SUCCEEDED);
+                double depth_to_color_threaded = transformation_perf_time(color_pixels, depth_to_color);
+
+                double color_to_depth = transformation_perf_time(depth_pixels, [&]() {
+                    return transformation_color_image_to_depth_camera(transformation_handle,
+                                                                      (const uint8_t *)images.depth.data(),
+                                                                      &images.depth_descriptor,
+                                                                      images.color.data(),
+                                                                      &images.color_descriptor,
+                                                                      images.transformed_color.data(),
+                                                                      &images.transformed_color_descriptor);
+                });
+
+                double point_cloud = transformation_perf_time(depth_pixels, [&]() {
+                    return transformation_depth_image_to_point_cloud(transformation_handle,
+                                                                     (const uint8_t *)images.depth.data(),
+                                                                     &images.depth_descriptor,
+                                                                     K4A_CALIBRATION_TYPE_DEPTH,
+                                                                     (uint8_t *)images.xyz.data(),
+                                                                     &images.xyz_descriptor);
+                });
+
+                printf("%-6s %4dx%-5d %4dx%-4d %9.1f %14.1f %14.1f %14.1f\n",
+                       transformation_get_instruction_set_name(instruction_set),
+                       images.depth_descriptor.width_pixels,
+                       images.depth_descriptor.height_pixels,
+                       images.color_descriptor.width_pixels,
+                       images.color_descriptor.height_pixels,
+                       depth_to_color_single,
+                       depth_to_color_threaded,
+                       color_to_depth,
+                       point_cloud);
+
+                transformation_destroy(transformation_handle);
+
+                ASSERT_GT(depth_to_color_single, 0);
+                ASSERT_GT(depth_to_color_threaded, 0);
+                ASSERT_GT(color_to_depth, 0);
+                ASSERT_GT(point_cloud, 0);
+            }
+        }
+    }
+
+    // Later tests use the widest kernels again
+    ASSERT_EQ(transformation_set_instruction_set_limit(transformation_get_instruction_set_count() - 1),
+              K4A_RESULT_SUCCEEDED);
+}
+
+TEST(transformation_kernels_perf, depth_to_color_blocks)
+{
+    const k4a_depth_mode_t depth_modes[] = { K4A_DEPTH_MODE_NFOV_2X2BINNED,
+                                             K4A_DEPTH_MODE_NFOV_UNBINNED,
+                                             K4A_DEPTH_MODE_WFOV_2X2BINNED,
+                                             K4A_DEPTH_MODE_WFOV_UNBINNED };
+    const uint32_t cache_sizes[] = { 64 * 1024, 256 * 1024, 1024 * 1024 };
+
+    printf("Mpixel/s of depth to color at 3072P, %d runs each, by rows and by blocks covering each cache size\n",
+           TRANSFORMATION_PERF_ITERATIONS);
+    printf("%-10s %-9s %9s %9s %9s %9s\n", "depth", "color", "rows", "64 KiB", "256 KiB", "1 MiB");
+
+    for (k4a_depth_mode_t depth_mode : depth_modes)
+    {
+        k4a_calibration_t calibration;
+        ASSERT_EQ(k4a_calibration_get_from_raw(
+                      g_test_json, sizeof(g_test_json), depth_mode, K4A_COLOR_RESOLUTION_3072P, &calibration),
+                  K4A_RESULT_SUCCEEDED);
+        k4a_transformation_t transformation_handle = transformation_create(&calibration, false);
+        ASSERT_NE(transformation_handle, (k4a_transformation_t)NULL);
+
+        transformation_perf_images images;
+        transformation_perf_create_images(&calibration, &images);
+        int color_pixels = images.color_descriptor.width_pixels * images.color_descriptor.height_pixels;
+
+        k4a_transformation_image_descriptor_t no_custom_descriptor = { 0, 0, 0, K4A_IMAGE_FORMAT_CUSTOM };
+        auto depth_to_color = [&]() {
+            return transformation_depth_image_to_color_camera_custom(transformation_handle,
+                                                                     (const uint8_t *)images.depth.data(),
+                                                                     &images.depth_descriptor,
+                                                                     NULL,
+                                                                     &no_custom_descriptor,
+                                                                     (uint8_t *)images.transformed_depth.data(),
+                                                                     &images.transformed_depth_descriptor,
+                                                                     NULL,
+                                                                     &no_custom_descriptor,
+                                                                     K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR,
+                                                                     0);
+        };
+
+        transformation_set_depth_to_color_block_cache_size(0);
+        double rows = transformation_perf_time(color_pixels, depth_to_color);
+        std::vector<uint16_t> rows_depth = images.transformed_depth;
+
+        double blocks[3];
+        for (size_t i = 0; i < 3; i++)
+        {
+            transformation_set_depth_to_color_block_cache_size(cache_sizes[i]);
+            blocks[i] = transformation_perf_time(color_pixels, depth_to_color);
+
+            // The closest depth of each pixel does not depend on the order quads are rendered in
+            ASSERT_TRUE(rows_depth == images.transformed_depth);
+        }
+
+        printf("%4dx%-5d %4dx%-4d %9.1f %9.1f %9.1f %9.1f\n",
+               images.depth_descriptor.width_pixels,
+               images.depth_descriptor.height_pixels,
+               images.color_descriptor.width_pixels,
+               images.color_descriptor.height_pixels,
+               rows,
+               blocks[0],
+               blocks[1],
+               blocks[2]);
+
+        transformation_destroy(transformation_handle);
+
+        ASSERT_GT(rows, 0);
+        for (double block : blocks)
+        {
+            ASSERT_GT(block, 0);
+        }
+    }
+
+    // Later tests render rows again
+    transformation_set_depth_to_color_block_cache_size(0);
+}
+
+TEST(transformation_kernels_perf, depth_to_color_modes)
+{
+    const k4a_depth_mode_t depth_modes[] = { K4A_DEPTH_MODE_NFOV_UNBINNED, K4A_DEPTH_MODE_WFOV_2X2BINNED };
+    const k4a_color_resolution_t color_resolutions[] = { K4A_COLOR_RESOLUTION_720P, K4A_COLOR_RESOLUTION_3072P };
+    const k4a_transformation_depth_to_color_mode_t modes[] = { K4A_TRANSFORMATION_DEPTH_TO_COLOR_MODE_QUADS,
+                                                               K4A_TRANSFORMATION_DEPTH_TO_COLOR_MODE_SPLAT,
+                                                               K4A_TRANSFORMATION_DEPTH_TO_COLOR_MODE_SPLAT_2X2 };
+
+    printf("Mpixel/s of the transformed image, %d runs each, depth to color by quads and splats\n",
+           TRANSFORMATION_PERF_ITERATIONS);
+    printf("%-10s %-9s %9s %9s %9s\n", "depth", "color", "quads", "splat", "splat 2x2");
+
+    for (k4a_depth_mode_t depth_mode : depth_modes)
+    {
+        for (k4a_color_resolution_t color_resolution : color_resolutions)
+        {
+            k4a_calibration_t calibration;
+            ASSERT_EQ(k4a_calibration_get_from_raw(
+                          g_test_json, sizeof(g_test_json), depth_mode, color_resolution, &calibration),
+                      K4A_RESULT_SUCCEEDED);
+            k4a_transformation_t transformation_handle = transformation_create(&calibration, false);
+            ASSERT_NE(transformation_handle, (k4a_transformation_t)NULL);
+
+            transformation_perf_images images;
+            transformation_perf_create_images(&calibration, &images);
+            int color_pixels = images.color_descriptor.width_pixels * images.color_descriptor.height_pixels;
+
+            k4a_transformation_image_descriptor_t no_custom_descriptor = { 0, 0, 0, K4A_IMAGE_FORMAT_CUSTOM };
+            auto depth_to_color = [&]() {
+                return transformation_depth_image_to_color_camera_custom(transformation_handle,
+                                                                         (const uint8_t *)images.depth.data(),
+                                                                         &images.depth_descriptor,
+                                                                         NULL,
+                                                                         &no_custom_descriptor,
+                                                                         (uint8_t *)images.transformed_depth.data(),
+                                                                         &images.transformed_depth_descriptor,
+                                                                         NULL,
+                                                                         &no_custom_descriptor,
+                                                                         K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR,
+                                                                         0);
+            };
+
+            double mode_rates[3];
+            for (size_t i = 0; i < 3; i++)
+            {
+                ASSERT_EQ(transformation_set_depth_to_color_mode(transformation_handle, modes[i]),
+                          K4A_RESULT_SUCCEEDED);
+                mode_rates[i] = transformation_perf_time(color_pixels, depth_to_color);
+            }
+
+            printf("%4dx%-5d %4dx%-4d %9.1f %9.1f %9.1f\n",
+                   images.depth_descriptor.width_pixels,
+                   images.depth_descriptor.height_pixels,
+                   images.color_descriptor.width_pixels,
+                   images.color_descriptor.height_pixels,
+                   mode_rates[0],
+                   mode_rates[1],
+                   mode_rates[2]);
+
+            transformation_destroy(transformation_handle);
+
+            for (double rate : mode_rates)
+            {
+                ASSERT_GT(rate, 0);
+            }
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    return k4a_test_common_main(argc, argv);
+}
@@ -3,11 +3,15 @@
 
 #include <utcommon.h>
 #include <math.h>
+#include <string.h>
+
+#include <algorithm>
 
 #include <gtest/gtest.h>
 
 #include <k4ainternal/allocator.h>
 #include <k4ainternal/capture.h>
+#include <k4a/k4a_unchecked.h>
 #include <azure_c_shared_utility/lock.h>
 #include <azure_c_shared_utility/tickcounter.h>
 #include <azure_c_shared_utility/threadapi.h>
@@ -555,6 +559,720 @@ TEST(allocator_ut, manual_image_system_time)
     ASSERT_EQ(allocator_test_for_leaks(), 0);
 }
 
+TEST(allocator_ut, image_get_info)
+{
+    k4a_image_t image = NULL;
+    k4a_image_info_t info;
+
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, image_create(K4A_IMAGE_FORMAT_DEPTH16, 64, 32, 0, ALLOCATION_SOURCE_USER, &image));
+    image_set_device_timestamp_usec(image, 100);
+    image_set_system_timestamp_nsec(image, 200);
+    image_set_exposure_usec(image, 300);
+    image_set_white_balance(image, 4000);
+    image_set_iso_speed(image, 800);
+
+    ASSERT_EQ(K4A_RESULT_FAILED, image_get_info(NULL, &info));
+    ASSERT_EQ(K4A_RESULT_FAILED, image_get_info(image, NULL));
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, image_get_info(image, &info));
+
+    ASSERT_EQ(info.format, image_get_format(image));
+    ASSERT_EQ(info.width_pixels, image_get_width_pixels(image));
+    ASSERT_EQ(info.height_pixels, image_get_height_pixels(image));
+    ASSERT_EQ(info.stride_bytes, image_get_stride_bytes(image));
+    ASSERT_EQ(info.size, image_get_size(image));
+    ASSERT_EQ(info.device_timestamp_usec, (uint64_t)100);
+    ASSERT_EQ(info.system_timestamp_nsec, (uint64_t)200);
+    ASSERT_EQ(info.exposure_usec, (uint64_t)300);
+    ASSERT_EQ(info.white_balance, (uint32_t)4000);
+    ASSERT_EQ(info.iso_speed, (uint32_t)800);
+
+    image_dec_ref(image);
+    ASSERT_EQ(allocator_test_for_leaks(), 0);
+}
+
+TEST(allocator_ut, image_and_capture_get_view)
+{
+    k4a_image_t image = NULL;
+    k4a_capture_t capture = NULL;
+    k4a_image_view_t view;
+    k4a_capture_view_t capture_view;
+
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, image_create(K4A_IMAGE_FORMAT_DEPTH16, 64, 32, 0, ALLOCATION_SOURCE_USER, &image));
+    image_set_device_timestamp_usec(image, 100);
+    image_set_system_timestamp_nsec(image, 200);
+
+    ASSERT_EQ(K4A_RESULT_FAILED, image_get_view(NULL, &view));
+    ASSERT_EQ(K4A_RESULT_FAILED, image_get_view(image, NULL));
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, image_get_view(image, &view));
+
+    ASSERT_TRUE(k4a_image_view_is_valid(&view));
+    ASSERT_EQ(view.buffer, image_get_buffer(image));
+    ASSERT_EQ(view.size, image_get_size(image));
+    ASSERT_EQ(view.format, K4A_IMAGE_FORMAT_DEPTH16);
+    ASSERT_EQ(view.width_pixels, 64);
+    ASSERT_EQ(view.height_pixels, 32);
+    ASSERT_EQ(view.stride_bytes, image_get_stride_bytes(image));
+    ASSERT_EQ(view.device_timestamp_usec, (uint64_t)100);
+    ASSERT_EQ(view.system_timestamp_nsec, (uint64_t)200);
+
+    uint16_t *row = (uint16_t *)(void *)(image_get_buffer(image) + 5 * image_get_stride_bytes(image));
+    row[7] = 1234;
+    ASSERT_EQ(k4a_image_view_row_u16(&view, 5), row);
+    ASSERT_EQ(k4a_image_view_pixel_u16(&view, 7, 5), 1234);
+
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, capture_create(&capture));
+    capture_set_depth_image(capture, image);
+    capture_set_temperature_c(capture, 25.0f);
+
+    ASSERT_EQ(K4A_RESULT_FAILED, capture_get_view(NULL, &capture_view));
+    ASSERT_EQ(K4A_RESULT_FAILED, capture_get_view(capture, NULL));
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, capture_get_view(capture, &capture_view));
+
+    ASSERT_FALSE(k4a_image_view_is_valid(&capture_view.color));
+    ASSERT_EQ(capture_view.color.size, (size_t)0);
+    ASSERT_FALSE(k4a_image_view_is_valid(&capture_view.ir));
+    ASSERT_EQ(0, memcmp(&capture_view.depth, &view, sizeof(view)));
+    ASSERT_EQ(capture_view.temperature_c, 25.0f);
+
+    image_dec_ref(image);
+    capture_dec_ref(capture);
+    ASSERT_EQ(allocator_test_for_leaks(), 0);
+}
+
+TEST(allocator_ut, image_create_view)
+{
+    k4a_image_t image = NULL;
+    k4a_image_t view = NULL;
+
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, image_create(K4A_IMAGE_FORMAT_DEPTH16, 64, 32, 0, ALLOCATION_SOURCE_USER, &image));
+    image_set_device_timestamp_usec(image, 100);
+
+    // Out of bounds and invalid arguments
+    ASSERT_EQ(K4A_RESULT_FAILED, image_create_view(NULL, 0, 0, 8, 8, &view));
+    ASSERT_EQ(K4A_RESULT_FAILED, image_create_view(image, 0, 0, 8, 8, NULL));
+    ASSERT_EQ(K4A_RESULT_FAILED, image_create_view(image, -1, 0, 8, 8, &view));
+    ASSERT_EQ(K4A_RESULT_FAILED, image_create_view(image, 0, 0, 0, 8, &view));
+    ASSERT_EQ(K4A_RESULT_FAILED, image_create_view(image, 57, 0, 8, 8, &view));
+    ASSERT_EQ(K4A_RESULT_FAILED, image_create_view(image, 0, 25, 8, 8, &view));
+
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, image_create_view(image, 56, 24, 8, 8, &view));
+    ASSERT_EQ(K4A_IMAGE_FORMAT_DEPTH16, image_get_format(view));
+    ASSERT_EQ(8, image_get_width_pixels(view));
+    ASSERT_EQ(8, image_get_height_pixels(view));
+    ASSERT_EQ(image_get_stride_bytes(image), image_get_stride_bytes(view));
+    ASSERT_EQ(image_get_buffer(image) + 24 * image_get_stride_bytes(image) + 56 * 2, image_get_buffer(view));
+    ASSERT_EQ((size_t)(7 * image_get_stride_bytes(image) + 8 * 2), image_get_size(view));
+    ASSERT_EQ((uint64_t)100, image_get_device_timestamp_usec(view));
+
+    // The view keeps the parent's buffer alive
+    image_dec_ref(image);
+    image_get_buffer(view)[0] = 0x5a;
+    image_dec_ref(view);
+    ASSERT_EQ(allocator_test_for_leaks(), 0);
+
+    // Formats without a constant pixel size can't be viewed, YUY2 needs whole pixel pairs
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+              image_create(K4A_IMAGE_FORMAT_COLOR_YUY2, 16, 16, 0, ALLOCATION_SOURCE_USER, &image));
+    ASSERT_EQ(K4A_RESULT_FAILED, image_create_view(image, 1, 0, 4, 4, &view));
+    ASSERT_EQ(K4A_RESULT_FAILED, image_create_view(image, 0, 0, 3, 4, &view));
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, image_create_view(image, 2, 0, 4, 4, &view));
+    image_dec_ref(view);
+    image_dec_ref(image);
+
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+              image_create(K4A_IMAGE_FORMAT_COLOR_NV12, 16, 16, 0, ALLOCATION_SOURCE_USER, &image));
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, image_create_view(image, 0, 0, 4, 4, &view));
+    ASSERT_EQ(K4A_IMAGE_FORMAT_CUSTOM8, image_get_format(view));
+    image_dec_ref(view);
+    image_dec_ref(image);
+
+    ASSERT_EQ(allocator_test_for_leaks(), 0);
+}
+
+TEST(allocator_ut, image_convert_16bit)
+{
+    // An odd width and a padded stride exercise the SIMD kernels and the scalar end of every row
+    const int width = 37;
+    const int height = 5;
+    k4a_image_t depth = NULL;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+              image_create(K4A_IMAGE_FORMAT_DEPTH16, width, height, width * 2 + 6, ALLOCATION_SOURCE_USER, &depth));
+    int depth_stride = image_get_stride_bytes(depth) / 2;
+    uint16_t *depth_pixels = (uint16_t *)(void *)image_get_buffer(depth);
+    for (int i = 0; i < depth_stride * height; i++)
+    {
+        depth_pixels[i] = (uint16_t)((i * 997) % 5000);
+    }
+    depth_pixels[1] = 0;
+    image_set_device_timestamp_usec(depth, 100);
+
+    k4a_image_t floats = NULL;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+              image_create(K4A_IMAGE_FORMAT_CUSTOM, width, height, width * 4, ALLOCATION_SOURCE_USER, &floats));
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, image_convert_to_float(depth, 0.001f, floats));
+    const float *float_pixels = (const float *)(void *)image_get_buffer(floats);
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            ASSERT_EQ((float)depth_pixels[y * depth_stride + x] * 0.001f, float_pixels[y * width + x]);
+        }
+    }
+    ASSERT_EQ((uint64_t)100, image_get_device_timestamp_usec(floats));
+
+    k4a_image_t custom8 = NULL;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+              image_create(K4A_IMAGE_FORMAT_CUSTOM8, width, height, 0, ALLOCATION_SOURCE_USER, &custom8));
+    ASSERT_EQ(K4A_RESULT_FAILED, image_convert_to_custom8(depth, 500, 500, custom8));
+    ASSERT_EQ(K4A_RESULT_FAILED, image_convert_to_custom8(floats, 500, 4000, custom8));
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, image_convert_to_custom8(depth, 500, 4000, custom8));
+    const uint8_t *custom8_pixels = image_get_buffer(custom8);
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            int value = std::min(std::max((int)depth_pixels[y * depth_stride + x], 500), 4000);
+            // Off by one at most where the rounding of a float and a double differ
+            ASSERT_NEAR((value - 500) * 255.0 / 3500.0, custom8_pixels[y * width + x], 0.5 + 1e-3);
+        }
+    }
+
+    k4a_image_t bgra = NULL;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+              image_create(K4A_IMAGE_FORMAT_COLOR_BGRA32, width, height, 0, ALLOCATION_SOURCE_USER, &bgra));
+    const uint8_t *bgra_pixels = image_get_buffer(bgra);
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, image_colorize(depth, 500, 4000, K4A_COLORMAP_GREYSCALE, bgra));
+    for (int i = 0; i < width * height; i++)
+    {
+        ASSERT_EQ(custom8_pixels[i], bgra_pixels[4 * i + 0]);
+        ASSERT_EQ(custom8_pixels[i], bgra_pixels[4 * i + 1]);
+        ASSERT_EQ(custom8_pixels[i], bgra_pixels[4 * i + 2]);
+        ASSERT_EQ(0xFF, bgra_pixels[4 * i + 3]);
+    }
+
+    // Invalid depth is black, the ends of the range are blue and red
+    depth_pixels[0] = 500;
+    depth_pixels[2] = 4000;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, image_colorize(depth, 500, 4000, K4A_COLORMAP_BLUE_TO_RED, bgra));
+    const uint8_t expected[3][4] = { { 0xFF, 0, 0, 0xFF }, { 0, 0, 0, 0xFF }, { 0, 0, 0xFF, 0xFF } };
+    for (int i = 0; i < 3; i++)
+    {
+        ASSERT_EQ(0, memcmp(expected[i], bgra_pixels + 4 * i, 4));
+    }
+
+    image_dec_ref(bgra);
+    image_dec_ref(custom8);
+    image_dec_ref(floats);
+    image_dec_ref(depth);
+    ASSERT_EQ(allocator_test_for_leaks(), 0);
+}
+
+TEST(allocator_ut, capture_recycle)
+{
+    k4a_capture_t capture = NULL;
+    k4a_capture_t recycled = NULL;
+
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, capture_create(&capture));
+    capture_set_temperature_c(capture, 25.0f);
+    capture_dec_ref(capture);
+
+    // The released handle is pooled and no longer valid
+    ASSERT_TRUE(isnan(capture_get_temperature_c(capture)));
+
+    // The next capture reuses it, starting from a clean state
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, capture_create(&recycled));
+    ASSERT_EQ(capture, recycled);
+    ASSERT_TRUE(isnan(capture_get_temperature_c(recycled)));
+    ASSERT_EQ((k4a_image_t)NULL, capture_get_color_image(recycled));
+    capture_dec_ref(recycled);
+
+    ASSERT_EQ(allocator_test_for_leaks(), 0);
+}
+
+TEST(allocator_ut, capture_peek_timestamp)
+{
+    k4a_capture_t capture = NULL;
+    k4a_image_t image = NULL;
+    uint64_t timestamp_usec = 0;
+
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, capture_create(&capture));
+    ASSERT_EQ(K4A_RESULT_FAILED, capture_peek_color_image_timestamp(capture, &timestamp_usec));
+    ASSERT_EQ(K4A_RESULT_FAILED, capture_peek_ir_image_timestamp(capture, &timestamp_usec));
+    ASSERT_EQ(K4A_RESULT_FAILED, capture_peek_ir_image_timestamp(capture, NULL));
+    ASSERT_EQ(K4A_RESULT_FAILED, capture_peek_ir_image_timestamp(NULL, &timestamp_usec));
+
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, image_create_empty_internal(ALLOCATION_SOURCE_DEPTH, 128, &image));
+    image_set_device_timestamp_usec(image, 1234);
+    capture_set_ir_image(capture, image);
+
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, capture_peek_ir_image_timestamp(capture, &timestamp_usec));
+    ASSERT_EQ(timestamp_usec, (uint64_t)1234);
+    ASSERT_EQ(K4A_RESULT_FAILED, capture_peek_color_image_timestamp(capture, &timestamp_usec));
+
+    // Peeking takes no reference, so these two releases free the image
+    image_dec_ref(image);
+    capture_dec_ref(capture);
+    ASSERT_EQ(allocator_test_for_leaks(), 0);
+}
+
+TEST(allocator_ut, allocator_pool_recycle)
+{
+    ASSERT_EQ(allocator_pool_create(NULL, ALLOCATION_SOURCE_DEPTH, 0, 2), (allocator_pool_t *)NULL);
+    ASSERT_EQ(allocator_pool_alloc(NULL, NULL), (uint8_t *)NULL);
+
+    allocator_pool_t *pool = allocator_pool_create(NULL, ALLOCATION_SOURCE_DEPTH, 1024, 2);
+    ASSERT_NE(pool, (allocator_pool_t *)NULL);
+    ASSERT_EQ(allocator_pool_get_buffer_size(pool), (size_t)1024);
+
+    bool recycled = false;
+    uint8_t *buffer1 = allocator_pool_alloc(pool, &recycled);
+    ASSERT_NE(buffer1, (uint8_t *)NULL);
+    ASSERT_TRUE(recycled);
+    uint8_t *buffer2 = allocator_pool_alloc(pool, &recycled);
+    ASSERT_NE(buffer2, (uint8_t *)NULL);
+    ASSERT_TRUE(recycled);
+
+    // Pool is empty, so this one comes from the allocator
+    uint8_t *buffer3 = allocator_pool_alloc(pool, &recycled);
+    ASSERT_NE(buffer3, (uint8_t *)NULL);
+    ASSERT_FALSE(recycled);
+
+    // Returned buffers are handed out again
+    allocator_pool_free(buffer1, pool);
+    uint8_t *buffer4 = allocator_pool_alloc(pool, &recycled);
+    ASSERT_TRUE(recycled);
+    ASSERT_EQ(buffer4, buffer1);
+
+    // Images built on pool buffers return them when released
+    k4a_image_t image = NULL;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+              image_create_empty_from_buffer_internal(buffer4, 1024, allocator_pool_free, pool, &image));
+    image_dec_ref(image);
+
+    allocator_pool_free(buffer2, pool);
+
+    // Buffers outstanding when the pool is closed are still freed when they are returned
+    allocator_pool_close(pool);
+    allocator_pool_free(buffer3, pool);
+
+    // Verify all our allocations were released
+    ASSERT_EQ(allocator_test_for_leaks(), 0);
+}
+
+TEST(allocator_ut, allocator_prefault)
+{
+    // Idle pool buffers are touched, buffers handed out keep their contents
+    allocator_pool_t *pool = allocator_pool_create(NULL, ALLOCATION_SOURCE_COLOR, 3 * 4096 + 100, 2);
+    ASSERT_NE(pool, (allocator_pool_t *)NULL);
+    uint8_t *held = allocator_pool_alloc(pool, NULL);
+    ASSERT_NE(held, (uint8_t *)NULL);
+    memset(held, 0xAB, 3 * 4096 + 100);
+    allocator_pool_prefault(pool);
+    ASSERT_EQ(held[0], 0xAB);
+    ASSERT_EQ(held[3 * 4096 + 99], 0xAB);
+
+    uint8_t *idle = allocator_pool_alloc(pool, NULL);
+    ASSERT_NE(idle, (uint8_t *)NULL);
+    ASSERT_EQ(idle[0], 0);
+    ASSERT_EQ(idle[4096], 0);
+    ASSERT_EQ(idle[3 * 4096 + 99], 0);
+
+    allocator_pool_free(held, pool);
+    allocator_pool_free(idle, pool);
+    allocator_pool_close(pool);
+    allocator_pool_prefault(NULL);
+
+    // Captures created after prefilling come from the pool
+    capture_pool_prefill();
+    k4a_capture_t capture = NULL;
+    ASSERT_EQ(capture_create(&capture), K4A_RESULT_SUCCEEDED);
+    capture_dec_ref(capture);
+
+    // Verify all our allocations were released
+    ASSERT_EQ(allocator_test_for_leaks(), 0);
+}
+
+TEST(allocator_ut, allocator_stats)
+{
+    k4a_allocator_stats_t stats_before, stats;
+
+    ASSERT_EQ(allocator_get_stats(ALLOCATION_SOURCE_COLOR, NULL), K4A_RESULT_FAILED);
+    ASSERT_EQ(allocator_get_stats((allocation_source_t)K4A_ALLOCATION_SOURCE_COUNT, &stats), K4A_RESULT_FAILED);
+
+    ASSERT_EQ(allocator_get_stats(ALLOCATION_SOURCE_COLOR, &stats_before), K4A_RESULT_SUCCEEDED);
+
+    uint8_t *buffer1 = allocator_alloc(ALLOCATION_SOURCE_COLOR, 1000);
+    ASSERT_NE(buffer1, (uint8_t *)NULL);
+    uint8_t *buffer2 = allocator_alloc(ALLOCATION_SOURCE_COLOR, 500);
+    ASSERT_NE(buffer2, (uint8_t *)NULL);
+
+    ASSERT_EQ(allocator_get_stats(ALLOCATION_SOURCE_COLOR, &stats), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(stats.buffer_count, stats_before.buffer_count + 2);
+    ASSERT_EQ(stats.allocated_bytes, stats_before.allocated_bytes + 1500);
+    ASSERT_GE(stats.peak_allocated_bytes, stats.allocated_bytes);
+    ASSERT_EQ(stats.total_allocation_count, stats_before.total_allocation_count + 2);
+
+    allocator_free(buffer1);
+    allocator_free(buffer2);
+
+    // Peak is retained after the buffers are released
+    ASSERT_EQ(allocator_get_stats(ALLOCATION_SOURCE_COLOR, &stats), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(stats.buffer_count, stats_before.buffer_count);
+    ASSERT_EQ(stats.allocated_bytes, stats_before.allocated_bytes);
+    ASSERT_GE(stats.peak_allocated_bytes, stats_before.allocated_bytes + 1500);
+
+    // Other sources are not affected
+    ASSERT_EQ(allocator_get_stats(ALLOCATION_SOURCE_USB_IMU, &stats), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(stats.buffer_count, (uint32_t)0);
+    ASSERT_EQ(stats.allocated_bytes, (uint64_t)0);
+
+    // Rate is measured over windows of at least a second
+    for (int i = 0; i < 10; i++)
+    {
+        allocator_free(allocator_alloc(ALLOCATION_SOURCE_COLOR, 10));
+    }
+    ThreadAPI_Sleep(1100);
+    ASSERT_EQ(allocator_get_stats(ALLOCATION_SOURCE_COLOR, &stats), K4A_RESULT_SUCCEEDED);
+    ASSERT_GT(stats.allocations_per_second, 0.0f);
+
+    // Verify all our allocations were released
+    ASSERT_EQ(allocator_test_for_leaks(), 0);
+}
+
+TEST(allocator_ut, allocator_size_class_pool)
+{
+    // Pooling disabled, nothing is retained
+    ASSERT_EQ(allocator_set_default_pool_size(0), K4A_RESULT_SUCCEEDED);
+    allocator_free(allocator_alloc(ALLOCATION_SOURCE_DEPTH, 100000));
+    ASSERT_EQ(allocator_size_class_get_retained_bytes(), (size_t)0);
+
+    ASSERT_EQ(allocator_set_default_pool_size(1024 * 1024), K4A_RESULT_SUCCEEDED);
+
+    // Freed buffers are retained and reused for requests of the same size class
+    uint8_t *buffer1 = allocator_alloc(ALLOCATION_SOURCE_DEPTH, 100000);
+    ASSERT_NE(buffer1, (uint8_t *)NULL);
+    memset(buffer1, 0xAB, 100000);
+    allocator_free(buffer1);
+    size_t retained = allocator_size_class_get_retained_bytes();
+    ASSERT_GE(retained, (size_t)100000);
+    ASSERT_LE(retained, (size_t)(100000 + 100000 / 8 + 4096));
+
+    uint8_t *buffer2 = allocator_alloc(ALLOCATION_SOURCE_COLOR, 99000);
+    ASSERT_NE(buffer2, (uint8_t *)NULL);
+    ASSERT_EQ(allocator_size_class_get_retained_bytes(), (size_t)0);
+    allocator_free(buffer2);
+
+    // Small allocations are not pooled
+    allocator_free(allocator_alloc(ALLOCATION_SOURCE_IMU, 16));
+    ASSERT_EQ(allocator_size_class_get_retained_bytes(), retained);
+
+    // Buffers beyond the cap are freed
+    uint8_t *large = allocator_alloc(ALLOCATION_SOURCE_DEPTH, 2 * 1024 * 1024);
+    ASSERT_NE(large, (uint8_t *)NULL);
+    allocator_free(large);
+    ASSERT_EQ(allocator_size_class_get_retained_bytes(), retained);
+
+    // Lowering the cap releases retained buffers
+    ASSERT_EQ(allocator_set_default_pool_size(0), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(allocator_size_class_get_retained_bytes(), (size_t)0);
+
+    // Verify all our allocations were released
+    ASSERT_EQ(allocator_test_for_leaks(), 0);
+}
+
+TEST(allocator_ut, allocator_huge_page_threshold)
+{
+    void *context = NULL;
+
+    // Disabled by default, and requests below the threshold are not backed by huge pages
+    ASSERT_EQ(allocator_set_huge_page_threshold(0), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(allocator_huge_page_alloc(8 * 1024 * 1024, &context), (uint8_t *)NULL);
+    ASSERT_EQ(allocator_set_huge_page_threshold(4 * 1024 * 1024), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(allocator_huge_page_alloc(1024 * 1024, &context), (uint8_t *)NULL);
+    ASSERT_EQ(context, (void *)NULL);
+
+#ifdef __linux__
+    // Mapped 2MB aligned so the whole buffer can use huge pages
+    uint8_t *mapping = allocator_huge_page_alloc(5 * 1024 * 1024, &context);
+    ASSERT_NE(mapping, (uint8_t *)NULL);
+    ASSERT_NE(context, (void *)NULL);
+    ASSERT_EQ((uintptr_t)mapping % (2 * 1024 * 1024), (uintptr_t)0);
+    memset(mapping, 0xAB, 5 * 1024 * 1024);
+    allocator_huge_page_free(mapping, context);
+#endif
+
+    // Color and depth buffers above the threshold are usable and freed like any other
+    ASSERT_EQ(allocator_set_default_pool_size(1024 * 1024 * 1024), K4A_RESULT_SUCCEEDED);
+    uint8_t *color = allocator_alloc(ALLOCATION_SOURCE_COLOR, 5 * 1024 * 1024);
+    ASSERT_NE(color, (uint8_t *)NULL);
+    ASSERT_EQ((uintptr_t)color % ALLOCATOR_DEFAULT_ALIGNMENT, (uintptr_t)0);
+    memset(color, 0xCD, 5 * 1024 * 1024);
+    uint8_t *imu = allocator_alloc(ALLOCATION_SOURCE_IMU, 5 * 1024 * 1024);
+    ASSERT_NE(imu, (uint8_t *)NULL);
+    allocator_free(color);
+    allocator_free(imu);
+
+#ifdef __linux__
+    // Only the IMU buffer went to the size class pool
+    ASSERT_GE(allocator_size_class_get_retained_bytes(), (size_t)5 * 1024 * 1024);
+    ASSERT_LT(allocator_size_class_get_retained_bytes(), (size_t)10 * 1024 * 1024);
+#endif
+
+    ASSERT_EQ(allocator_set_default_pool_size(0), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(allocator_set_huge_page_threshold(0), K4A_RESULT_SUCCEEDED);
+
+    // Verify all our allocations were released
+    ASSERT_EQ(allocator_test_for_leaks(), 0);
+}
+
+// Allocator that returns buffers at an odd address to show the SDK aligns regardless of the callback
+static uint8_t *allocator_misaligned_alloc(int size, void **context)
+{
+    uint8_t *full_buffer = (uint8_t *)malloc((size_t)size + 1);
+    *context = full_buffer;
+    return full_buffer ? full_buffer + 1 : NULL;
+}
+
+static void allocator_misaligned_free(void *buffer, void *context)
+{
+    (void)buffer;
+    free(context);
+}
+
+TEST(allocator_ut, allocator_alignment)
+{
+    ASSERT_EQ(allocator_alloc_aligned(ALLOCATION_SOURCE_USER, 1024, 0), (uint8_t *)NULL);
+    ASSERT_EQ(allocator_alloc_aligned(ALLOCATION_SOURCE_USER, 1024, 48), (uint8_t *)NULL);
+    ASSERT_EQ(allocator_alloc_aligned(ALLOCATION_SOURCE_USER, 1024, ALLOCATOR_MAX_ALIGNMENT * 2), (uint8_t *)NULL);
+
+    for (int i = 0; i < 2; i++)
+    {
+        if (i == 1)
+        {
+            ASSERT_EQ(allocator_set_allocator(allocator_misaligned_alloc, allocator_misaligned_free),
+                      K4A_RESULT_SUCCEEDED);
+        }
+
+        uint8_t *buffer = allocator_alloc(ALLOCATION_SOURCE_USER, 100);
+        ASSERT_NE(buffer, (uint8_t *)NULL);
+        ASSERT_EQ((uintptr_t)buffer % ALLOCATOR_DEFAULT_ALIGNMENT, (uintptr_t)0);
+        allocator_free(buffer);
+
+        for (size_t alignment = 1; alignment <= 4096; alignment *= 2)
+        {
+            buffer = allocator_alloc_aligned(ALLOCATION_SOURCE_USER, 1000, alignment);
+            ASSERT_NE(buffer, (uint8_t *)NULL);
+            ASSERT_EQ((uintptr_t)buffer % alignment, (uintptr_t)0);
+            memset(buffer, 0xAB, 1000);
+            allocator_free(buffer);
+        }
+
+        // Images created with a zero stride get padded rows
+        k4a_image_t image = NULL;
+        ASSERT_EQ(image_create_aligned(K4A_IMAGE_FORMAT_CUSTOM16, 100, 10, 0, 4096, ALLOCATION_SOURCE_USER, &image),
+                  K4A_RESULT_SUCCEEDED);
+        ASSERT_EQ((uintptr_t)image_get_buffer(image) % 4096, (uintptr_t)0);
+        ASSERT_EQ(image_get_stride_bytes(image), 4096);
+        ASSERT_EQ(image_get_size(image), (size_t)4096 * 10);
+        image_dec_ref(image);
+
+        // An explicit stride is kept
+        ASSERT_EQ(image_create_aligned(K4A_IMAGE_FORMAT_DEPTH16, 100, 10, 200, 64, ALLOCATION_SOURCE_USER, &image),
+                  K4A_RESULT_SUCCEEDED);
+        ASSERT_EQ((uintptr_t)image_get_buffer(image) % 64, (uintptr_t)0);
+        ASSERT_EQ(image_get_stride_bytes(image), 200);
+        image_dec_ref(image);
+
+        // image_create keeps the minimum stride
+        ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_COLOR_BGRA32, 100, 10, 0, ALLOCATION_SOURCE_USER, &image),
+                  K4A_RESULT_SUCCEEDED);
+        ASSERT_EQ((uintptr_t)image_get_buffer(image) % ALLOCATOR_DEFAULT_ALIGNMENT, (uintptr_t)0);
+        ASSERT_EQ(image_get_stride_bytes(image), 400);
+        image_dec_ref(image);
+    }
+
+    ASSERT_EQ(allocator_set_allocator(NULL, NULL), K4A_RESULT_SUCCEEDED);
+
+    // Verify all our allocations were released
+    ASSERT_EQ(allocator_test_for_leaks(), 0);
+}
+
+// Distinct allocate and free pairs, each counts the buffers it has outstanding
+#define ALLOCATOR_REINSTALL_COUNT 40
+static int g_reinstall_outstanding[ALLOCATOR_REINSTALL_COUNT];
+
+template<int N> static uint8_t *allocator_reinstall_alloc(int size, void **context)
+{
+    g_reinstall_outstanding[N]++;
+    *context = NULL;
+    return (uint8_t *)malloc((size_t)size);
+}
+
+template<int N> static void allocator_reinstall_free(void *buffer, void *context)
+{
+    (void)context;
+    g_reinstall_outstanding[N]--;
+    free(buffer);
+}
+
+template<int N> static void allocator_reinstall(uint8_t **buffers)
+{
+    allocator_reinstall<N - 1>(buffers);
+    ASSERT_EQ(allocator_set_allocator(allocator_reinstall_alloc<N - 1>, allocator_reinstall_free<N - 1>),
+              K4A_RESULT_SUCCEEDED);
+    buffers[N - 1] = allocator_alloc(ALLOCATION_SOURCE_USER, 100);
+    ASSERT_NE(buffers[N - 1], (uint8_t *)NULL);
+}
+
+template<> void allocator_reinstall<0>(uint8_t **buffers)
+{
+    (void)buffers;
+}
+
+TEST(allocator_ut, allocator_reinstall)
+{
+    // More allocators than there are entries, installing one never fails
+    uint8_t *buffers[ALLOCATOR_REINSTALL_COUNT] = {};
+    allocator_reinstall<ALLOCATOR_REINSTALL_COUNT>(buffers);
+    ASSERT_EQ(allocator_set_allocator(NULL, NULL), K4A_RESULT_SUCCEEDED);
+
+    // Buffers are freed by the allocator they came from, even once its entry was reused
+    for (int i = 0; i < ALLOCATOR_REINSTALL_COUNT; i++)
+    {
+        ASSERT_EQ(g_reinstall_outstanding[i], 1);
+        allocator_free(buffers[i]);
+        ASSERT_EQ(g_reinstall_outstanding[i], 0);
+    }
+
+    // Verify all our allocations were released
+    ASSERT_EQ(allocator_test_for_leaks(), 0);
+}
+
+typedef struct _allocator_hook_test_t
+{
+    int allocations;
+    int frees;
+    k4a_allocation_source_t last_source;
+} allocator_hook_test_t;
+
+static uint8_t *allocator_hook_test_alloc(int size, k4a_allocation_source_t source, void *allocator_context, void **context)
+{
+    allocator_hook_test_t *test = (allocator_hook_test_t *)allocator_context;
+    test->allocations++;
+    test->last_source = source;
+    *context = test;
+    return (uint8_t *)malloc((size_t)size);
+}
+
+static void allocator_hook_test_free(void *buffer, void *context)
+{
+    allocator_hook_test_t *test = (allocator_hook_test_t *)context;
+    test->frees++;
+    free(buffer);
+}
+
+TEST(allocator_ut, allocator_hook)
+{
+    allocator_hook_test_t test = {};
+    allocator_hook_t hook = {};
+    hook.allocate = allocator_hook_test_alloc;
+    hook.free = allocator_hook_test_free;
+    hook.context = &test;
+
+    // The hook receives the source and its context
+    uint8_t *buffer = allocator_alloc_hooked(&hook, ALLOCATION_SOURCE_COLOR, 100, ALLOCATOR_DEFAULT_ALIGNMENT);
+    ASSERT_NE(buffer, (uint8_t *)NULL);
+    ASSERT_EQ(test.allocations, 1);
+    ASSERT_EQ(test.last_source, K4A_ALLOCATION_SOURCE_COLOR);
+    allocator_free(buffer);
+    ASSERT_EQ(test.frees, 1);
+
+    // A hook without callbacks uses the process allocator
+    allocator_hook_t empty_hook = {};
+    buffer = allocator_alloc_hooked(&empty_hook, ALLOCATION_SOURCE_COLOR, 100, ALLOCATOR_DEFAULT_ALIGNMENT);
+    ASSERT_NE(buffer, (uint8_t *)NULL);
+    allocator_free(buffer);
+    ASSERT_EQ(test.allocations, 1);
+
+    // Pools allocate from their hook and free through it after being closed
+    allocator_pool_t *pool = allocator_pool_create(&hook, ALLOCATION_SOURCE_USB_DEPTH, 1024, 2);
+    ASSERT_NE(pool, (allocator_pool_t *)NULL);
+    ASSERT_EQ(test.allocations, 3);
+    ASSERT_EQ(test.last_source, K4A_ALLOCATION_SOURCE_USB_DEPTH);
+    buffer = allocator_pool_alloc(pool, NULL);
+    ASSERT_NE(buffer, (uint8_t *)NULL);
+    allocator_pool_close(pool);
+    ASSERT_EQ(test.frees, 2);
+    allocator_pool_free(buffer, pool);
+    ASSERT_EQ(test.frees, 3);
+
+    // Verify all our allocations were released
+    ASSERT_EQ(allocator_test_for_leaks(), 0);
+}
+
+TEST(allocator_ut, allocator_ring)
+{
+    const size_t slot_size = 4096;
+    const uint32_t slot_count = 3;
+    std::vector<uint8_t> memory(slot_size * slot_count + K4A_IMAGE_BUFFER_ALIGNMENT);
+    uint8_t *base = (uint8_t *)(((uintptr_t)memory.data() + K4A_IMAGE_BUFFER_ALIGNMENT - 1) &
+                                ~(uintptr_t)(K4A_IMAGE_BUFFER_ALIGNMENT - 1));
+
+    k4a_buffer_ring_t ring = NULL;
+    ASSERT_EQ(allocator_ring_create(base, K4A_BUFFER_RING_SLOT_OVERHEAD, slot_count, &ring), K4A_RESULT_FAILED);
+    ASSERT_EQ(allocator_ring_create(base, slot_size, 0, &ring), K4A_RESULT_FAILED);
+    ASSERT_EQ(allocator_ring_create(base, slot_size, slot_count, &ring), K4A_RESULT_SUCCEEDED);
+
+    // Only the source with a ring allocates from it, the images are at the same offset in every slot
+    allocator_hook_t hook = {};
+    hook.rings[ALLOCATION_SOURCE_DEPTH] = ring;
+    size_t image_size = slot_size - K4A_BUFFER_RING_SLOT_OVERHEAD;
+    ASSERT_TRUE(allocator_hook_is_set(&hook, ALLOCATION_SOURCE_DEPTH));
+    ASSERT_FALSE(allocator_hook_is_set(&hook, ALLOCATION_SOURCE_COLOR));
+    uint8_t *first = allocator_alloc_hooked(&hook, ALLOCATION_SOURCE_DEPTH, image_size, ALLOCATOR_DEFAULT_ALIGNMENT);
+    uint8_t *second = allocator_alloc_hooked(&hook, ALLOCATION_SOURCE_DEPTH, image_size, ALLOCATOR_DEFAULT_ALIGNMENT);
+    ASSERT_NE(first, (uint8_t *)NULL);
+    ASSERT_NE(second, (uint8_t *)NULL);
+    ASSERT_EQ(first - base, second - base - (ptrdiff_t)slot_size);
+    ASSERT_EQ((uintptr_t)first % K4A_IMAGE_BUFFER_ALIGNMENT, 0u);
+    ASSERT_EQ(allocator_alloc_hooked(&hook, ALLOCATION_SOURCE_DEPTH, slot_size, ALLOCATOR_DEFAULT_ALIGNMENT),
+              (uint8_t *)NULL);
+    uint8_t *color = allocator_alloc_hooked(&hook, ALLOCATION_SOURCE_COLOR, 100, ALLOCATOR_DEFAULT_ALIGNMENT);
+    ASSERT_NE(color, (uint8_t *)NULL);
+    ASSERT_EQ(allocator_ring_get_slot(ring, color, NULL, NULL), K4A_RESULT_FAILED);
+    allocator_free(color);
+
+    uint32_t slot_index = 0;
+    size_t buffer_offset = 0;
+    ASSERT_EQ(allocator_ring_get_slot(ring, second, &slot_index, &buffer_offset), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(slot_index, 1u);
+    ASSERT_EQ(buffer_offset, (size_t)(second - base));
+
+    // Images created in the ring take the last slot and return it on release, a full ring fails
+    k4a_image_t image = NULL;
+    ASSERT_EQ(allocator_ring_create_image(ring, K4A_IMAGE_FORMAT_DEPTH16, 32, 32, 64, &image), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(image_get_buffer(image), base + 2 * slot_size);
+    k4a_image_t full_image = NULL;
+    ASSERT_EQ(allocator_ring_create_image(ring, K4A_IMAGE_FORMAT_DEPTH16, 32, 32, 64, &full_image), K4A_RESULT_FAILED);
+    ASSERT_EQ(allocator_alloc_hooked(&hook, ALLOCATION_SOURCE_DEPTH, 100, ALLOCATOR_DEFAULT_ALIGNMENT),
+              (uint8_t *)NULL);
+
+    // Returned slots are reused in the order they were returned
+    allocator_free(second);
+    image_dec_ref(image);
+    uint8_t *reused = allocator_alloc_hooked(&hook, ALLOCATION_SOURCE_DEPTH, 100, ALLOCATOR_DEFAULT_ALIGNMENT);
+    ASSERT_EQ(allocator_ring_get_slot(ring, reused, &slot_index, NULL), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(slot_index, 1u);
+
+    // Slots in use keep the ring alive after its owner releases it
+    allocator_ring_release(ring);
+    allocator_free(reused);
+    allocator_free(first);
+
+    // Verify all our allocations were released
+    ASSERT_EQ(allocator_test_for_leaks(), 0);
+}
+
 static int allocator_thread_adjust_ref(void *param)
 {
     allocator_thread_adjust_ref_data_t *data = (allocator_thread_adjust_ref_data_t *)param;
@@ -681,3 +1399,111 @@ TEST(allocator_ut, allocator_threaded)
     ASSERT_EQ(allocator_test_for_leaks(), 0);
     Lock_Deinit(lock);
 }
+
+#define ALLOCATOR_BENCHMARK_MAX_THREADS 8
+#define ALLOCATOR_BENCHMARK_DURATION_MS 1000
+
+typedef struct _allocator_benchmark_data_t
+{
+    LOCK_HANDLE lock;
+    size_t alloc_size;
+    uint64_t operations;
+    uint32_t error;
+} allocator_benchmark_data_t;
+
+static int allocator_thread_benchmark(void *param)
+{
+    allocator_benchmark_data_t *data = (allocator_benchmark_data_t *)param;
+    tickcounter_ms_t now, start_time_ms;
+    TICK_COUNTER_HANDLE tick = tickcounter_create();
+
+    // Wait for all threads to be created
+    Lock(data->lock);
+    Unlock(data->lock);
+
+    if (tick == NULL || 0 != tickcounter_get_current_ms(tick, &start_time_ms))
+    {
+        GTEST_LOG_ERROR << "tickcounter failed in allocator_thread_benchmark\n";
+        data->error = 1;
+        goto exit;
+    }
+
+    do
+    {
+        // Check the clock every 1000 allocations to keep it out of the measurement
+        for (int i = 0; i < 1000; i++)
+        {
+            uint8_t *buffer = allocator_alloc(ALLOCATION_SOURCE_USER, data->alloc_size);
+            if (buffer == NULL)
+            {
+                GTEST_LOG_ERROR << "allocator_alloc failed in allocator_thread_benchmark\n";
+                data->error = 1;
+                goto exit;
+            }
+            buffer[0] = (uint8_t)i;
+            allocator_free(buffer);
+        }
+        data->operations += 1000;
+
+        if (0 != tickcounter_get_current_ms(tick, &now))
+        {
+            GTEST_LOG_ERROR << "tickcounter_get_current_ms failed in allocator_thread_benchmark\n";
+            data->error = 1;
+            goto exit;
+        }
+    } while (now - start_time_ms < ALLOCATOR_BENCHMARK_DURATION_MS);
+
+exit:
+    if (tick)
+    {
+        tickcounter_destroy(tick);
+    }
+    return TEST_RETURN_VALUE;
+}
+
+// Measures alloc/free throughput with several threads contending for the allocator, like the USB, depth engine,
+// color and IMU threads do while streaming
+TEST(allocator_ut, allocator_contended_throughput)
+{
+    allocator_benchmark_data_t data[ALLOCATOR_BENCHMARK_MAX_THREADS];
+    THREAD_HANDLE threads[ALLOCATOR_BENCHMARK_MAX_THREADS];
+    LOCK_HANDLE lock;
+
+    ASSERT_NE((lock = Lock_Init()), (LOCK_HANDLE)NULL);
+
+    for (int thread_count = 4; thread_count <= ALLOCATOR_BENCHMARK_MAX_THREADS; thread_count += 4)
+    {
+        // prevent the threads from running
+        Lock(lock);
+
+        for (int i = 0; i < thread_count; i++)
+        {
+            data[i].lock = lock;
+            data[i].alloc_size = 1024;
+            data[i].operations = 0;
+            data[i].error = 0;
+            ASSERT_EQ(THREADAPI_OK, ThreadAPI_Create(&threads[i], allocator_thread_benchmark, &data[i]));
+        }
+
+        // start the test
+        Unlock(lock);
+
+        uint64_t operations = 0;
+        for (int i = 0; i < thread_count; i++)
+        {
+            int result;
+            ASSERT_EQ(THREADAPI_OK, ThreadAPI_Join(threads[i], &result));
+            ASSERT_EQ(result, TEST_RETURN_VALUE);
+            ASSERT_EQ(data[i].error, (uint32_t)0);
+            operations += data[i].operations;
+        }
+
+        std::cout << "[     INFO ] " << thread_count << " threads: "
+                  << operations * 1000 / ALLOCATOR_BENCHMARK_DURATION_MS << " alloc/free per second\n";
+        ASSERT_GT(operations, (uint64_t)0);
+    }
+
+    // Verify all our allocations were released
+    ASSERT_EQ(allocator_test_for_leaks(), 0);
+    Lock_Deinit(lock);
+}
@@ -0,0 +1,135 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <utcommon.h>
+
+#include <k4ainternal/clockmodel.h>
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+int main(int argc, char **argv)
+{
+    return k4a_test_common_main(argc, argv);
+}
+
+#define FRAME_PERIOD_USEC 33333
+#define SYSTEM_OFFSET_NSEC 5000000000LL
+#define DRIFT_PPM 20.0
+
+// System timestamp of a device timestamp on a host whose clock runs DRIFT_PPM faster than the device's
+static uint64_t expected_system_timestamp_nsec(uint64_t device_timestamp_usec)
+{
+    return SYSTEM_OFFSET_NSEC + (uint64_t)llround(device_timestamp_usec * 1000 * (1 + DRIFT_PPM / 1000000));
+}
+
+// Adds frames with a delay of up to 2ms, where every 8th frame arrives without delay
+static void add_frames(clockmodel_t clockmodel, uint64_t start_usec, uint32_t count)
+{
+    uint32_t seed = 1;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        uint64_t delay_nsec = i % 8 == 0 ? 0 : (seed >> 16) % 2000000;
+        uint64_t device_usec = start_usec + (uint64_t)i * FRAME_PERIOD_USEC;
+        clockmodel_add_sample(clockmodel, device_usec, expected_system_timestamp_nsec(device_usec) + delay_nsec);
+    }
+}
+
+TEST(clockmodel_ut, empty_model)
+{
+    clockmodel_t clockmodel = NULL;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, clockmodel_create(&clockmodel));
+
+    k4a_device_clock_model_t model;
+    uint64_t system_nsec = 0;
+    uint64_t device_usec = 0;
+    ASSERT_EQ(K4A_RESULT_FAILED, clockmodel_get(clockmodel, &model));
+    ASSERT_EQ(K4A_RESULT_FAILED, clockmodel_convert(clockmodel, 1000, &system_nsec));
+    ASSERT_EQ(K4A_RESULT_FAILED, clockmodel_convert_system(clockmodel, 1000000, &device_usec));
+
+    // Images without a system timestamp are not samples
+    clockmodel_add_sample(clockmodel, 1000, 0);
+    ASSERT_EQ(K4A_RESULT_FAILED, clockmodel_get(clockmodel, &model));
+
+    ASSERT_EQ(K4A_RESULT_FAILED, clockmodel_create(NULL));
+    ASSERT_EQ(K4A_RESULT_FAILED, clockmodel_get(clockmodel, NULL));
+    ASSERT_EQ(K4A_RESULT_FAILED, clockmodel_convert(clockmodel, 1000, NULL));
+
+    clockmodel_destroy(clockmodel);
+}
+
+TEST(clockmodel_ut, single_sample)
+{
+    clockmodel_t clockmodel = NULL;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, clockmodel_create(&clockmodel));
+
+    clockmodel_add_sample(clockmodel, 1000000, 7000000000ULL);
+
+    k4a_device_clock_model_t model;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, clockmodel_get(clockmodel, &model));
+    ASSERT_EQ(model.reference_device_timestamp_usec, 1000000u);
+    ASSERT_EQ(model.reference_system_timestamp_nsec, 7000000000ULL);
+    ASSERT_EQ(model.drift_ppm, 0);
+    ASSERT_EQ(model.window_count, 1u);
+    ASSERT_EQ(model.sample_count, 1u);
+
+    // Without drift, the offset carries over
+    uint64_t system_nsec = 0;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, clockmodel_convert(clockmodel, 3000000, &system_nsec));
+    ASSERT_EQ(system_nsec, 9000000000ULL);
+
+    clockmodel_destroy(clockmodel);
+}
+
+TEST(clockmodel_ut, drift_and_jitter)
+{
+    clockmodel_t clockmodel = NULL;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, clockmodel_create(&clockmodel));
+
+    // Two minutes of 30 FPS
+    add_frames(clockmodel, 200000, 30 * 120);
+
+    k4a_device_clock_model_t model;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, clockmodel_get(clockmodel, &model));
+    ASSERT_NEAR(model.drift_ppm, DRIFT_PPM, 0.5);
+    ASSERT_LT(model.residual_usec, 10);
+    ASSERT_GT(model.window_count, 1u);
+    ASSERT_EQ(model.sample_count, 30u * 120);
+
+    // The jitter is filtered out of the conversion, including a little past the last frame
+    uint64_t last_usec = 200000 + (uint64_t)(30 * 120 - 1) * FRAME_PERIOD_USEC;
+    for (uint64_t device_usec = last_usec - 30000000; device_usec < last_usec + 5000000; device_usec += 1000000)
+    {
+        uint64_t system_nsec = 0;
+        ASSERT_EQ(K4A_RESULT_SUCCEEDED, clockmodel_convert(clockmodel, device_usec, &system_nsec));
+        ASSERT_NEAR((double)system_nsec, (double)expected_system_timestamp_nsec(device_usec), 20000);
+
+        // Converting back lands on the same device time
+        uint64_t round_trip_usec = 0;
+        ASSERT_EQ(K4A_RESULT_SUCCEEDED, clockmodel_convert_system(clockmodel, system_nsec, &round_trip_usec));
+        ASSERT_NEAR((double)round_trip_usec, (double)device_usec, 1);
+    }
+
+    clockmodel_destroy(clockmodel);
+}
+
+TEST(clockmodel_ut, restart)
+{
+    clockmodel_t clockmodel = NULL;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, clockmodel_create(&clockmodel));
+
+    add_frames(clockmodel, 60000000, 300);
+
+    // The device timestamps went back, so the samples before are from another model
+    clockmodel_add_sample(clockmodel, 1000, 1000000000ULL);
+    k4a_device_clock_model_t model;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, clockmodel_get(clockmodel, &model));
+    ASSERT_EQ(model.sample_count, 1u);
+    ASSERT_EQ(model.reference_system_timestamp_nsec, 1000000000ULL);
+
+    clockmodel_reset(clockmodel);
+    ASSERT_EQ(K4A_RESULT_FAILED, clockmodel_get(clockmodel, &model));
+
+    clockmodel_destroy(clockmodel);
+}
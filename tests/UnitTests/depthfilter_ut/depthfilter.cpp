@@ -0,0 +1,322 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <utcommon.h>
+
+#include <gtest/gtest.h>
+
+#include <k4ainternal/depth_filter.h>
+
+#include <math.h>
+#include <stdlib.h>
+#include <vector>
+
+int main(int argc, char **argv)
+{
+    return k4a_test_common_main(argc, argv);
+}
+
+typedef std::vector<uint16_t> depth_image_t;
+
+// Straightforward versions of the filters the optimized ones are compared with
+struct reference_filter_t
+{
+    k4a_depth_filter_configuration_t config;
+    uint32_t width;
+    uint32_t height;
+    depth_image_t history;
+    std::vector<uint32_t> hole_age;
+
+    reference_filter_t(const k4a_depth_filter_configuration_t &filter_config, uint32_t w, uint32_t h) :
+        config(filter_config),
+        width(w),
+        height(h),
+        history((size_t)w * h, 0),
+        hole_age((size_t)w * h, 0)
+    {
+    }
+
+    static bool is_far(int depth, int neighbor, int threshold)
+    {
+        return neighbor == 0 || abs(depth - neighbor) > threshold;
+    }
+
+    uint16_t at(const depth_image_t &image, int x, int y) const
+    {
+        return image[(size_t)y * width + (size_t)x];
+    }
+
+    void process(depth_image_t &image)
+    {
+        int w = (int)width;
+        int h = (int)height;
+        if (config.flying_pixel_filter)
+        {
+            depth_image_t out(image.size());
+            int t = config.flying_pixel_threshold_mm;
+            for (int y = 0; y < h; y++)
+            {
+                for (int x = 0; x < w; x++)
+                {
+                    int d = at(image, x, y);
+                    bool flying = (x > 0 && x < w - 1 && is_far(d, at(image, x - 1, y), t) &&
+                                   is_far(d, at(image, x + 1, y), t)) ||
+                                  (y > 0 && y < h - 1 && is_far(d, at(image, x, y - 1), t) &&
+                                   is_far(d, at(image, x, y + 1), t));
+                    out[(size_t)y * width + (size_t)x] = flying ? 0 : (uint16_t)d;
+                }
+            }
+            image = out;
+        }
+
+        if (config.edge_preserving_filter)
+        {
+            depth_image_t out(image.size());
+            int t = config.edge_threshold_mm;
+            for (int y = 0; y < h; y++)
+            {
+                for (int x = 0; x < w; x++)
+                {
+                    int d = at(image, x, y);
+                    uint32_t sum = 0;
+                    uint32_t count = 0;
+                    for (int ny = y - 1; ny <= y + 1; ny++)
+                    {
+                        for (int nx = x - 1; nx <= x + 1; nx++)
+                        {
+                            if (nx >= 0 && nx < w && ny >= 0 && ny < h && !is_far(d, at(image, nx, ny), t))
+                            {
+                                sum += at(image, nx, ny);
+                                count++;
+                            }
+                        }
+                    }
+                    out[(size_t)y * width + (size_t)x] = d == 0 ? 0 : (uint16_t)(sum / count);
+                }
+            }
+            image = out;
+        }
+
+        if (config.temporal_filter)
+        {
+            uint32_t alpha = (uint32_t)(config.temporal_alpha * 256 + 0.5f);
+            for (size_t i = 0; i < image.size(); i++)
+            {
+                if (image[i] != 0)
+                {
+                    if (history[i] != 0 && abs(image[i] - history[i]) <= config.temporal_threshold_mm)
+                    {
+                        image[i] = (uint16_t)((history[i] * (256 - alpha) + image[i] * alpha + 128) / 256);
+                    }
+                    hole_age[i] = 0;
+                }
+                else if (history[i] != 0 && hole_age[i] < config.hole_fill_frames)
+                {
+                    image[i] = history[i];
+                    hole_age[i]++;
+                }
+                else
+                {
+                    hole_age[i] = 0;
+                }
+                history[i] = image[i];
+            }
+        }
+    }
+};
+
+// Two noisy planes split by a vertical edge, with holes and isolated pixels
+static depth_image_t make_scene(uint32_t width, uint32_t height, uint32_t frame)
+{
+    depth_image_t image((size_t)width * height);
+    srand(1234 + frame);
+    for (uint32_t y = 0; y < height; y++)
+    {
+        for (uint32_t x = 0; x < width; x++)
+        {
+            int depth = (x < width / 2 ? 1000 : 2500) + rand() % 21 - 10;
+            int r = rand() % 100;
+            if (r < 5)
+            {
+                depth = 0;
+            }
+            else if (r < 8)
+            {
+                depth = 1500 + rand() % 500;
+            }
+            else if (r < 9)
+            {
+                depth = 65535 - rand() % 3;
+            }
+            image[(size_t)y * width + x] = (uint16_t)depth;
+        }
+    }
+    return image;
+}
+
+TEST(depthfilter_ut, configuration)
+{
+    k4a_depth_filter_configuration_t config = K4A_DEPTH_FILTER_CONFIG_INIT_DISABLE_ALL;
+    ASSERT_TRUE(depth_filter_configuration_is_valid(&config));
+    ASSERT_FALSE(depth_filter_configuration_is_enabled(&config));
+
+    // The alpha is only checked when the temporal filter is enabled
+    config.temporal_alpha = 0.0f;
+    ASSERT_TRUE(depth_filter_configuration_is_valid(&config));
+    config.temporal_filter = true;
+    ASSERT_TRUE(depth_filter_configuration_is_enabled(&config));
+    ASSERT_FALSE(depth_filter_configuration_is_valid(&config));
+    config.temporal_alpha = 1.5f;
+    ASSERT_FALSE(depth_filter_configuration_is_valid(&config));
+    config.temporal_alpha = NAN;
+    ASSERT_FALSE(depth_filter_configuration_is_valid(&config));
+    config.temporal_alpha = 1.0f;
+    ASSERT_TRUE(depth_filter_configuration_is_valid(&config));
+
+    config.temporal_alpha = 0.0f;
+    ASSERT_EQ(depth_filter_create(&config, 64, 64), nullptr);
+    config.temporal_alpha = 0.5f;
+    ASSERT_EQ(depth_filter_create(&config, 0, 64), nullptr);
+    ASSERT_EQ(depth_filter_create(nullptr, 64, 64), nullptr);
+
+    depth_filter_t *filter = depth_filter_create(&config, 64, 64);
+    ASSERT_NE(filter, nullptr);
+    depth_image_t image(64 * 32, 1000);
+    ASSERT_EQ(K4A_RESULT_FAILED, depth_filter_process(filter, image.data(), 64, 32));
+    ASSERT_EQ(K4A_RESULT_FAILED, depth_filter_process(filter, nullptr, 64, 64));
+    depth_filter_destroy(filter);
+}
+
+TEST(depthfilter_ut, flying_pixels)
+{
+    const uint32_t width = 40;
+    const uint32_t height = 8;
+    k4a_depth_filter_configuration_t config = K4A_DEPTH_FILTER_CONFIG_INIT_DISABLE_ALL;
+    config.flying_pixel_filter = true;
+    config.flying_pixel_threshold_mm = 100;
+
+    // A step edge between columns 19 and 21, with a pixel halfway between the surfaces on column 20
+    depth_image_t image((size_t)width * height);
+    for (uint32_t y = 0; y < height; y++)
+    {
+        for (uint32_t x = 0; x < width; x++)
+        {
+            image[y * width + x] = (uint16_t)(x < 20 ? 1000 : (x == 20 ? 1500 : 2000));
+        }
+    }
+    image[3 * width + 10] = 0;    // Hole, stays invalid
+    image[5 * width + 30] = 3000; // Spike, removed
+
+    depth_filter_t *filter = depth_filter_create(&config, width, height);
+    ASSERT_NE(filter, nullptr);
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, depth_filter_process(filter, image.data(), width, height));
+    depth_filter_destroy(filter);
+
+    for (uint32_t y = 0; y < height; y++)
+    {
+        ASSERT_EQ(image[y * width + 19], 1000);
+        ASSERT_EQ(image[y * width + 20], 0) << "row " << y;
+        ASSERT_EQ(image[y * width + 21], 2000);
+        ASSERT_EQ(image[y * width + 0], 1000);
+        ASSERT_EQ(image[y * width + width - 1], 2000);
+    }
+    ASSERT_EQ(image[3 * width + 10], 0);
+    ASSERT_EQ(image[3 * width + 11], 1000);
+    ASSERT_EQ(image[5 * width + 30], 0);
+}
+
+TEST(depthfilter_ut, edge_preserving)
+{
+    const uint32_t width = 37;
+    const uint32_t height = 11;
+    k4a_depth_filter_configuration_t config = K4A_DEPTH_FILTER_CONFIG_INIT_DISABLE_ALL;
+    config.edge_preserving_filter = true;
+    config.edge_threshold_mm = 30;
+
+    depth_image_t image = make_scene(width, height, 0);
+    depth_image_t expected = image;
+    reference_filter_t reference(config, width, height);
+    reference.process(expected);
+
+    depth_filter_t *filter = depth_filter_create(&config, width, height);
+    ASSERT_NE(filter, nullptr);
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, depth_filter_process(filter, image.data(), width, height));
+    depth_filter_destroy(filter);
+    ASSERT_EQ(image, expected);
+
+    // The average never crosses the edge between the planes
+    for (uint32_t y = 0; y < height; y++)
+    {
+        uint16_t left = image[y * width + width / 2 - 1];
+        uint16_t right = image[y * width + width / 2];
+        ASSERT_TRUE(left == 0 || left <= 1010 || left >= 1500);
+        ASSERT_TRUE(right == 0 || right >= 2490 || right < 2000);
+    }
+}
+
+TEST(depthfilter_ut, temporal)
+{
+    const uint32_t width = 3;
+    const uint32_t height = 5;
+    k4a_depth_filter_configuration_t config = K4A_DEPTH_FILTER_CONFIG_INIT_DISABLE_ALL;
+    config.temporal_filter = true;
+    config.temporal_alpha = 0.5f;
+    config.temporal_threshold_mm = 100;
+    config.hole_fill_frames = 2;
+
+    depth_filter_t *filter = depth_filter_create(&config, width, height);
+    ASSERT_NE(filter, nullptr);
+
+    uint16_t sequence[] = { 1000, 1050, 0, 0, 0, 1500, 1400 };
+    uint16_t expected[] = { 1000, 1025, 1025, 1025, 0, 1500, 1450 };
+    for (size_t frame = 0; frame < sizeof(sequence) / sizeof(sequence[0]); frame++)
+    {
+        depth_image_t image((size_t)width * height, sequence[frame]);
+        ASSERT_EQ(K4A_RESULT_SUCCEEDED, depth_filter_process(filter, image.data(), width, height));
+        for (uint16_t depth : image)
+        {
+            ASSERT_EQ(depth, expected[frame]) << "frame " << frame;
+        }
+    }
+
+    // After a reset the history is gone, so a new depth is neither blended nor used to fill holes
+    depth_filter_reset(filter);
+    depth_image_t image((size_t)width * height, 1000);
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, depth_filter_process(filter, image.data(), width, height));
+    ASSERT_EQ(image[0], 1000);
+    depth_filter_reset(filter);
+    image.assign(image.size(), 0);
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, depth_filter_process(filter, image.data(), width, height));
+    ASSERT_EQ(image[0], 0);
+
+    depth_filter_destroy(filter);
+}
+
+TEST(depthfilter_ut, all_filters_match_reference)
+{
+    const uint32_t sizes[][2] = { { 640, 576 }, { 37, 23 }, { 9, 3 }, { 1, 4 }, { 8, 1 } };
+    k4a_depth_filter_configuration_t config = K4A_DEPTH_FILTER_CONFIG_INIT_DISABLE_ALL;
+    config.flying_pixel_filter = true;
+    config.edge_preserving_filter = true;
+    config.temporal_filter = true;
+    config.hole_fill_frames = 3;
+
+    for (const auto &size : sizes)
+    {
+        uint32_t width = size[0];
+        uint32_t height = size[1];
+        reference_filter_t reference(config, width, height);
+        depth_filter_t *filter = depth_filter_create(&config, width, height);
+        ASSERT_NE(filter, nullptr);
+
+        for (uint32_t frame = 0; frame < 6; frame++)
+        {
+            depth_image_t image = make_scene(width, height, frame);
+            depth_image_t expected = image;
+            reference.process(expected);
+            ASSERT_EQ(K4A_RESULT_SUCCEEDED, depth_filter_process(filter, image.data(), width, height));
+            ASSERT_EQ(image, expected) << width << "x" << height << " frame " << frame;
+        }
+        depth_filter_destroy(filter);
+    }
+}
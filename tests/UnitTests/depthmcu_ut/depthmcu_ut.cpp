@@ -69,6 +69,9 @@ public:
     MOCK_CONST_METHOD2(usb_cmd_stream_start, k4a_result_t(usbcmd_t p_command_handle, size_t payload_size));
 
     MOCK_CONST_METHOD1(usb_cmd_stream_stop, k4a_result_t(usbcmd_t p_command_handle));
+
+    MOCK_CONST_METHOD2(usb_cmd_get_stream_pool_stats,
+                       k4a_result_t(usbcmd_t p_command_handle, usb_cmd_stream_pool_stats_t *stats));
 };
 
 extern "C" {
@@ -272,6 +275,35 @@ const guid_t *usb_cmd_get_container_id(usbcmd_t usbcmd_handle)
     return NULL;
 }
 
+k4a_result_t usb_cmd_stream_set_transfer_limits(usbcmd_t usbcmd_handle,
+                                                uint32_t max_transfer_count,
+                                                size_t max_transfer_pool_size)
+{
+    (void)usbcmd_handle;
+    (void)max_transfer_count;
+    (void)max_transfer_pool_size;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t usb_cmd_stream_set_allocator(usbcmd_t usbcmd_handle, const allocator_hook_t *hook)
+{
+    (void)usbcmd_handle;
+    (void)hook;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t usb_cmd_stream_set_prefault(usbcmd_t usbcmd_handle, bool prefault)
+{
+    (void)usbcmd_handle;
+    (void)prefault;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t usb_cmd_get_stream_pool_stats(usbcmd_t usbcmd_handle, usb_cmd_stream_pool_stats_t *stats)
+{
+    return g_MockUsbCmd->usb_cmd_get_stream_pool_stats(usbcmd_handle, stats);
+}
+
 class depthmcu_ut : public ::testing::Test
 {
 protected:
@@ -550,6 +582,41 @@ TEST_F(depthmcu_ut, depthmcu_get_serialnum_extra_long)
     depthmcu_destroy(depthmcu_handle);
 }
 
+TEST_F(depthmcu_ut, depthmcu_depth_get_pool_stats)
+{
+    // Create the depth instance
+    depthmcu_t depthmcu_handle = NULL;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, depthmcu_create(USB_INDEX, &depthmcu_handle));
+    ASSERT_NE(depthmcu_handle, (depthmcu_t)NULL);
+
+    usb_cmd_stream_pool_stats_t stats = {};
+    ASSERT_EQ(K4A_RESULT_FAILED, depthmcu_depth_get_pool_stats(NULL, &stats));
+    ASSERT_EQ(K4A_RESULT_FAILED, depthmcu_depth_get_pool_stats(depthmcu_handle, NULL));
+
+    // Every counter of the USB stream is passed through
+    EXPECT_CALL(m_MockUsb, usb_cmd_get_stream_pool_stats(FAKE_USB, NotNull()))
+        .WillOnce(Invoke([](Unused, usb_cmd_stream_pool_stats_t *usb_stats) {
+            usb_stats->transfer_count = 8;
+            usb_stats->pool_size = 10;
+            usb_stats->recycled_count = 1234;
+            usb_stats->exhausted_count = 3;
+            usb_stats->timeout_count = 2;
+            return K4A_RESULT_SUCCEEDED;
+        }))
+        .WillOnce(Return(K4A_RESULT_FAILED));
+
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, depthmcu_depth_get_pool_stats(depthmcu_handle, &stats));
+    EXPECT_EQ(stats.transfer_count, 8u);
+    EXPECT_EQ(stats.pool_size, 10u);
+    EXPECT_EQ(stats.recycled_count, 1234u);
+    EXPECT_EQ(stats.exhausted_count, 3u);
+    EXPECT_EQ(stats.timeout_count, 2u);
+
+    ASSERT_EQ(K4A_RESULT_FAILED, depthmcu_depth_get_pool_stats(depthmcu_handle, &stats));
+
+    depthmcu_destroy(depthmcu_handle);
+}
+
 int main(int argc, char **argv)
 {
     return k4a_test_common_main(argc, argv);
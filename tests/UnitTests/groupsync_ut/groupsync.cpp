@@ -0,0 +1,189 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <utcommon.h>
+
+#include <k4ainternal/allocator.h>
+#include <k4ainternal/capture.h>
+#include <k4ainternal/groupsync.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+
+int main(int argc, char **argv)
+{
+    return k4a_test_common_main(argc, argv);
+}
+
+#define FRAME_PERIOD_USEC 33333
+#define TOLERANCE_USEC (FRAME_PERIOD_USEC / 2)
+
+// Adds a new capture of device_index, groupsync keeps its own reference
+static k4a_capture_t add_capture(groupsync_t groupsync, uint32_t device_index, int64_t timestamp_usec)
+{
+    k4a_capture_t capture = NULL;
+    EXPECT_EQ(K4A_RESULT_SUCCEEDED, capture_create(&capture));
+    groupsync_add_capture(groupsync, device_index, capture, timestamp_usec);
+    capture_dec_ref(capture);
+    return capture;
+}
+
+static void release_captures(k4a_capture_t *captures, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        capture_dec_ref(captures[i]);
+    }
+}
+
+TEST(groupsync_ut, api_validation)
+{
+    groupsync_t groupsync = NULL;
+    ASSERT_EQ(K4A_RESULT_FAILED, groupsync_create(0, &groupsync));
+    ASSERT_EQ(K4A_RESULT_FAILED, groupsync_create(2, NULL));
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, groupsync_create(2, &groupsync));
+
+    // Not started
+    k4a_capture_t captures[2] = {};
+    ASSERT_EQ(K4A_WAIT_RESULT_FAILED, groupsync_get_captures(groupsync, captures, 0));
+
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, groupsync_start(groupsync, TOLERANCE_USEC));
+    ASSERT_EQ(K4A_WAIT_RESULT_FAILED, groupsync_get_captures(groupsync, NULL, 0));
+    ASSERT_EQ(K4A_WAIT_RESULT_TIMEOUT, groupsync_get_captures(groupsync, captures, 0));
+    ASSERT_EQ(K4A_RESULT_FAILED, groupsync_get_statistics(groupsync, NULL));
+
+    groupsync_stop(groupsync);
+    groupsync_destroy(groupsync);
+    ASSERT_EQ(allocator_test_for_leaks(), 0);
+}
+
+TEST(groupsync_ut, match)
+{
+    groupsync_t groupsync = NULL;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, groupsync_create(3, &groupsync));
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, groupsync_start(groupsync, TOLERANCE_USEC));
+
+    k4a_capture_t expected[3];
+    expected[1] = add_capture(groupsync, 1, 1000200);
+    expected[0] = add_capture(groupsync, 0, 1000000);
+
+    // Two of three devices are not a match
+    k4a_capture_t captures[3] = {};
+    ASSERT_EQ(K4A_WAIT_RESULT_TIMEOUT, groupsync_get_captures(groupsync, captures, 10));
+
+    expected[2] = add_capture(groupsync, 2, 999900);
+    ASSERT_EQ(K4A_WAIT_RESULT_SUCCEEDED, groupsync_get_captures(groupsync, captures, 0));
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        ASSERT_EQ(captures[i], expected[i]);
+    }
+    release_captures(captures, 3);
+
+    k4a_device_group_statistics_t statistics;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, groupsync_get_statistics(groupsync, &statistics));
+    ASSERT_EQ(statistics.group_capture_count, 1u);
+    ASSERT_EQ(statistics.unmatched_drop_count, 0u);
+    ASSERT_EQ(statistics.overflow_drop_count, 0u);
+
+    groupsync_stop(groupsync);
+    groupsync_destroy(groupsync);
+    ASSERT_EQ(allocator_test_for_leaks(), 0);
+}
+
+TEST(groupsync_ut, drop_unmatched)
+{
+    groupsync_t groupsync = NULL;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, groupsync_create(2, &groupsync));
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, groupsync_start(groupsync, TOLERANCE_USEC));
+
+    // Device 1 dropped the first frame, so the first frame of device 0 has no match
+    add_capture(groupsync, 0, 1000000);
+    k4a_capture_t expected0 = add_capture(groupsync, 0, 1000000 + FRAME_PERIOD_USEC);
+    k4a_capture_t expected1 = add_capture(groupsync, 1, 1000100 + FRAME_PERIOD_USEC);
+
+    k4a_capture_t captures[2] = {};
+    ASSERT_EQ(K4A_WAIT_RESULT_SUCCEEDED, groupsync_get_captures(groupsync, captures, 0));
+    ASSERT_EQ(captures[0], expected0);
+    ASSERT_EQ(captures[1], expected1);
+    release_captures(captures, 2);
+
+    // Device 0 dropped the next frame
+    add_capture(groupsync, 1, 1000100 + 2 * FRAME_PERIOD_USEC);
+    expected0 = add_capture(groupsync, 0, 1000000 + 3 * FRAME_PERIOD_USEC);
+    ASSERT_EQ(K4A_WAIT_RESULT_TIMEOUT, groupsync_get_captures(groupsync, captures, 0));
+
+    k4a_device_group_statistics_t statistics;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, groupsync_get_statistics(groupsync, &statistics));
+    ASSERT_EQ(statistics.group_capture_count, 1u);
+    ASSERT_EQ(statistics.unmatched_drop_count, 2u);
+
+    // Stopping releases the capture still waiting
+    groupsync_stop(groupsync);
+    groupsync_destroy(groupsync);
+    ASSERT_EQ(allocator_test_for_leaks(), 0);
+}
+
+TEST(groupsync_ut, drop_overflow)
+{
+    groupsync_t groupsync = NULL;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, groupsync_create(2, &groupsync));
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, groupsync_start(groupsync, TOLERANCE_USEC));
+
+    for (int64_t i = 0; i < GROUPSYNC_MAX_PENDING_CAPTURES + 2; i++)
+    {
+        add_capture(groupsync, 0, i * FRAME_PERIOD_USEC);
+    }
+
+    k4a_device_group_statistics_t statistics;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, groupsync_get_statistics(groupsync, &statistics));
+    ASSERT_EQ(statistics.overflow_drop_count, 2u);
+
+    groupsync_stop(groupsync);
+    groupsync_destroy(groupsync);
+    ASSERT_EQ(allocator_test_for_leaks(), 0);
+}
+
+TEST(groupsync_ut, wait)
+{
+    groupsync_t groupsync = NULL;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, groupsync_create(2, &groupsync));
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, groupsync_start(groupsync, TOLERANCE_USEC));
+
+    // Each device delivers from its own thread
+    std::thread device0([groupsync]() {
+        for (int64_t i = 0; i < 10; i++)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            add_capture(groupsync, 0, i * FRAME_PERIOD_USEC);
+        }
+    });
+    std::thread device1([groupsync]() {
+        for (int64_t i = 0; i < 10; i++)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(3));
+            add_capture(groupsync, 1, i * FRAME_PERIOD_USEC + 100);
+        }
+    });
+
+    for (int i = 0; i < 10; i++)
+    {
+        k4a_capture_t captures[2] = {};
+        ASSERT_EQ(K4A_WAIT_RESULT_SUCCEEDED, groupsync_get_captures(groupsync, captures, K4A_WAIT_INFINITE));
+        release_captures(captures, 2);
+    }
+    device0.join();
+    device1.join();
+
+    // Stopping wakes a waiting thread
+    std::thread stopper([groupsync]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        groupsync_stop(groupsync);
+    });
+    k4a_capture_t captures[2] = {};
+    ASSERT_EQ(K4A_WAIT_RESULT_FAILED, groupsync_get_captures(groupsync, captures, K4A_WAIT_INFINITE));
+    stopper.join();
+
+    groupsync_destroy(groupsync);
+    ASSERT_EQ(allocator_test_for_leaks(), 0);
+}
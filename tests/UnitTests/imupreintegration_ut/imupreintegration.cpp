@@ -0,0 +1,111 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <utcommon.h>
+
+#include <k4ainternal/imu_preintegration.h>
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+int main(int argc, char **argv)
+{
+    return k4a_test_common_main(argc, argv);
+}
+
+#define SAMPLE_PERIOD_USEC 625
+#define HISTORY_DEPTH 3200
+#define RATE_RADIANS 1.0f
+#define ACCEL_MPS2 1.0f
+
+static imu_preintegration_t *create_preintegration()
+{
+    k4a_calibration_extrinsics_t extrinsics = {};
+    extrinsics.rotation[0] = extrinsics.rotation[4] = extrinsics.rotation[8] = 1;
+    return imu_preintegration_create(&extrinsics, &extrinsics, HISTORY_DEPTH);
+}
+
+// Samples rotating about z at RATE_RADIANS while accelerating along x of the IMU at ACCEL_MPS2
+static void add_samples(imu_preintegration_t *preintegration, uint64_t start_usec, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        k4a_imu_sample_t sample = {};
+        sample.acc_timestamp_usec = start_usec + (uint64_t)i * SAMPLE_PERIOD_USEC;
+        sample.gyro_timestamp_usec = sample.acc_timestamp_usec;
+        sample.acc_sample.xyz.x = ACCEL_MPS2;
+        sample.gyro_sample.xyz.z = RATE_RADIANS;
+        imu_preintegration_add_samples(preintegration, &sample, 1);
+    }
+}
+
+TEST(imupreintegration_ut, invalid)
+{
+    k4a_calibration_extrinsics_t extrinsics = {};
+    ASSERT_EQ(NULL, imu_preintegration_create(NULL, &extrinsics, HISTORY_DEPTH));
+    ASSERT_EQ(NULL, imu_preintegration_create(&extrinsics, &extrinsics, 1));
+
+    imu_preintegration_t *preintegration = create_preintegration();
+    ASSERT_NE(nullptr, preintegration);
+
+    k4a_imu_preintegration_t motion;
+    ASSERT_EQ(K4A_WAIT_RESULT_TIMEOUT, imu_preintegration_get(preintegration, 0, 1000, &motion, 0));
+    add_samples(preintegration, 1000000, 100);
+    ASSERT_EQ(K4A_WAIT_RESULT_FAILED, imu_preintegration_get(preintegration, 1000000, 1000000, NULL, 0));
+    ASSERT_EQ(K4A_WAIT_RESULT_FAILED, imu_preintegration_get(preintegration, 1010000, 1000000, &motion, 0));
+
+    // Before the first sample
+    ASSERT_EQ(K4A_WAIT_RESULT_FAILED, imu_preintegration_get(preintegration, 999999, 1010000, &motion, 0));
+
+    // After the last sample
+    ASSERT_EQ(K4A_WAIT_RESULT_TIMEOUT, imu_preintegration_get(preintegration, 1000000, 1100000, &motion, 10));
+
+    imu_preintegration_stop(preintegration);
+    ASSERT_EQ(K4A_WAIT_RESULT_FAILED, imu_preintegration_get(preintegration, 1000000, 1010000, &motion, 0));
+    imu_preintegration_reset(preintegration);
+    ASSERT_EQ(K4A_WAIT_RESULT_TIMEOUT, imu_preintegration_get(preintegration, 1000000, 1010000, &motion, 0));
+
+    imu_preintegration_destroy(preintegration);
+}
+
+TEST(imupreintegration_ut, constant_motion)
+{
+    imu_preintegration_t *preintegration = create_preintegration();
+    ASSERT_NE(nullptr, preintegration);
+    add_samples(preintegration, 1000000, HISTORY_DEPTH);
+
+    // Between timestamps that don't fall on samples
+    uint64_t start_usec = 1100100;
+    uint64_t end_usec = 1600300;
+    k4a_imu_preintegration_t motion;
+    ASSERT_EQ(K4A_WAIT_RESULT_SUCCEEDED, imu_preintegration_get(preintegration, start_usec, end_usec, &motion, 0));
+    ASSERT_EQ(start_usec, motion.start_timestamp_usec);
+    ASSERT_EQ(end_usec, motion.end_timestamp_usec);
+    ASSERT_EQ(800u, motion.sample_count);
+
+    // In the start coordinate system the IMU turns by t about z, v = (sin t, 1 - cos t) and p = (1 - cos t, t - sin t)
+    double t = (end_usec - start_usec) / 1000000.0 * RATE_RADIANS;
+    ASSERT_NEAR(cos(t / 2), motion.delta_rotation[0], 1e-5);
+    ASSERT_NEAR(0, motion.delta_rotation[1], 1e-5);
+    ASSERT_NEAR(0, motion.delta_rotation[2], 1e-5);
+    ASSERT_NEAR(sin(t / 2), motion.delta_rotation[3], 1e-5);
+    ASSERT_NEAR(sin(t) * ACCEL_MPS2, motion.delta_velocity.xyz.x, 1e-4);
+    ASSERT_NEAR((1 - cos(t)) * ACCEL_MPS2, motion.delta_velocity.xyz.y, 1e-4);
+    ASSERT_NEAR(0, motion.delta_velocity.xyz.z, 1e-5);
+    ASSERT_NEAR((1 - cos(t)) * ACCEL_MPS2, motion.delta_position.xyz.x, 1e-4);
+    ASSERT_NEAR((t - sin(t)) * ACCEL_MPS2, motion.delta_position.xyz.y, 1e-4);
+    ASSERT_NEAR(0, motion.delta_position.xyz.z, 1e-5);
+
+    // The oldest samples were dropped for the newest
+    add_samples(preintegration, 1000000 + (uint64_t)HISTORY_DEPTH * SAMPLE_PERIOD_USEC, 10);
+    ASSERT_EQ(K4A_WAIT_RESULT_FAILED, imu_preintegration_get(preintegration, 1000000, end_usec, &motion, 0));
+
+    // Timestamps going back start a new stream
+    add_samples(preintegration, 1000, 10);
+    ASSERT_EQ(K4A_WAIT_RESULT_FAILED, imu_preintegration_get(preintegration, 500, 5000, &motion, 0));
+    ASSERT_EQ(K4A_WAIT_RESULT_SUCCEEDED, imu_preintegration_get(preintegration, 1000, 1000, &motion, 0));
+    ASSERT_EQ(0u, motion.sample_count);
+    ASSERT_NEAR(1, motion.delta_rotation[0], 1e-6);
+
+    imu_preintegration_destroy(preintegration);
+}
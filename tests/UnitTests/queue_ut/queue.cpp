@@ -13,6 +13,12 @@
 #include <azure_c_shared_utility/tickcounter.h>
 #include <azure_c_shared_utility/threadapi.h>
 
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <poll.h>
+#endif
+
 int main(int argc, char **argv)
 {
     return k4a_test_common_main(argc, argv);
@@ -303,13 +309,10 @@ static int thread_pop_empty_queue_writer(void *param)
     return K4A_RESULT_SUCCEEDED;
 }
 
-TEST(queue_ut, queue_pop_on_empty_queue)
+static void pop_on_empty_queue(queue_t queue)
 {
-    queue_t queue;
     k4a_capture_t capture;
-    uint32_t queue_depth = TEST_QUEUE_DEPTH;
 
-    ASSERT_EQ(queue_create(queue_depth, "queue_test", &queue), K4A_RESULT_SUCCEEDED);
     queue_enable(queue);
 
     // Queue pop should timeout on multiple timeouts
@@ -366,6 +369,14 @@ TEST(queue_ut, queue_pop_on_empty_queue)
     ASSERT_EQ(allocator_test_for_leaks(), 0);
 
     Lock_Deinit(data.lock);
+}
+
+TEST(queue_ut, queue_pop_on_empty_queue)
+{
+    queue_t queue;
+
+    ASSERT_EQ(queue_create(TEST_QUEUE_DEPTH, "queue_test", &queue), K4A_RESULT_SUCCEEDED);
+    pop_on_empty_queue(queue);
     queue_destroy(queue);
 }
 
@@ -415,6 +426,145 @@ TEST(queue_ut, test_queue_push_w_dropped)
     ASSERT_EQ(allocator_test_for_leaks(), 0);
 }
 
+static void queue_test_dropped_count(bool lockfree)
+{
+    queue_t queue;
+    k4a_capture_t capture;
+    k4a_capture_t capture_dropped = NULL;
+
+    if (lockfree)
+    {
+        ASSERT_EQ(queue_create_lockfree(2, "queue_test", &queue), K4A_RESULT_SUCCEEDED);
+    }
+    else
+    {
+        ASSERT_EQ(queue_create(2, "queue_test", &queue), K4A_RESULT_SUCCEEDED);
+    }
+    queue_enable(queue);
+    ASSERT_EQ(queue_get_dropped_count(NULL), 0u);
+    ASSERT_EQ(queue_get_dropped_count(queue), 0u);
+
+    // Fill the queue and push 3 more, each dropping the oldest, so captures 3 and 4 are left
+    ASSERT_EQ(fill_queue(queue, 0, 5), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(queue_get_dropped_count(queue), 3u);
+
+    // Popping logs and resets the drops, but not the total
+    ASSERT_EQ(drain_queue(queue, 3, 1), K4A_WAIT_RESULT_SUCCEEDED);
+    ASSERT_EQ(queue_get_dropped_count(queue), 3u);
+    ASSERT_EQ(drain_queue(queue, 4, 1), K4A_WAIT_RESULT_SUCCEEDED);
+    ASSERT_EQ(queue_pop(queue, 0, &capture), K4A_WAIT_RESULT_TIMEOUT);
+
+    // A capture handed back to the caller is not counted
+    for (int i = 0; i < 3; i++)
+    {
+        capture = capture_manufacture(10);
+        queue_push_w_dropped(queue, capture, &capture_dropped);
+        capture_dec_ref(capture);
+        if (capture_dropped)
+        {
+            capture_dec_ref(capture_dropped);
+            capture_dropped = NULL;
+        }
+    }
+    ASSERT_EQ(queue_get_dropped_count(queue), 3u);
+
+    queue_destroy(queue);
+    ASSERT_EQ(allocator_test_for_leaks(), 0);
+}
+
+TEST(queue_ut, queue_dropped_count)
+{
+    queue_test_dropped_count(false);
+    queue_test_dropped_count(true);
+}
+
+typedef struct _blocked_push_data_t
+{
+    queue_t queue;
+    volatile uint32_t done_event;
+} blocked_push_data_t;
+
+static int thread_blocked_push(void *param)
+{
+    blocked_push_data_t *data = (blocked_push_data_t *)param;
+    k4a_result_t result = fill_queue(data->queue, 2, 1);
+    data->done_event = 1;
+    return K4A_SUCCEEDED(result) ? TEST_RETURN_VALUE : 0;
+}
+
+static void queue_test_policy(bool lockfree)
+{
+    queue_t queue;
+    k4a_capture_t capture;
+
+    if (lockfree)
+    {
+        ASSERT_EQ(queue_create_lockfree(TEST_QUEUE_DEPTH, "queue_test", &queue), K4A_RESULT_SUCCEEDED);
+    }
+    else
+    {
+        ASSERT_EQ(queue_create(TEST_QUEUE_DEPTH, "queue_test", &queue), K4A_RESULT_SUCCEEDED);
+    }
+
+    ASSERT_EQ(queue_configure(queue, 0, K4A_QUEUE_POLICY_DROP_NEWEST), K4A_RESULT_FAILED);
+    ASSERT_EQ(queue_configure(queue, 2, (k4a_queue_policy_t)(K4A_QUEUE_POLICY_BLOCK + 1)), K4A_RESULT_FAILED);
+
+    // Drop newest keeps the first captures pushed
+    ASSERT_EQ(queue_configure(queue, 2, K4A_QUEUE_POLICY_DROP_NEWEST), K4A_RESULT_SUCCEEDED);
+    queue_enable(queue);
+    ASSERT_EQ(queue_configure(queue, 2, K4A_QUEUE_POLICY_BLOCK), K4A_RESULT_FAILED);
+    ASSERT_EQ(fill_queue(queue, 0, 5), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(queue_get_dropped_count(queue), 3u);
+    ASSERT_EQ(drain_queue(queue, 0, 2), K4A_WAIT_RESULT_SUCCEEDED);
+    ASSERT_EQ(queue_pop(queue, 0, &capture), K4A_WAIT_RESULT_TIMEOUT);
+    queue_disable(queue);
+
+    // Drop oldest keeps the last captures pushed
+    ASSERT_EQ(queue_configure(queue, 2, K4A_QUEUE_POLICY_DROP_OLDEST), K4A_RESULT_SUCCEEDED);
+    queue_enable(queue);
+    ASSERT_EQ(fill_queue(queue, 10, 5), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(queue_get_dropped_count(queue), 6u);
+    ASSERT_EQ(drain_queue(queue, 13, 2), K4A_WAIT_RESULT_SUCCEEDED);
+    ASSERT_EQ(queue_pop(queue, 0, &capture), K4A_WAIT_RESULT_TIMEOUT);
+    queue_disable(queue);
+
+    // Block holds the push until a pop makes room
+    ASSERT_EQ(queue_configure(queue, 2, K4A_QUEUE_POLICY_BLOCK), K4A_RESULT_SUCCEEDED);
+    queue_enable(queue);
+    ASSERT_EQ(fill_queue(queue, 0, 2), K4A_RESULT_SUCCEEDED);
+
+    THREAD_HANDLE thread;
+    blocked_push_data_t data = { queue, 0 };
+    int thread_result;
+    ASSERT_EQ(THREADAPI_OK, ThreadAPI_Create(&thread, thread_blocked_push, &data));
+    ThreadAPI_Sleep((unsigned int)g_timeout);
+    ASSERT_EQ(data.done_event, 0u);
+
+    ASSERT_EQ(drain_queue(queue, 0, 1), K4A_WAIT_RESULT_SUCCEEDED);
+    ASSERT_EQ(THREADAPI_OK, ThreadAPI_Join(thread, &thread_result));
+    ASSERT_EQ(thread_result, TEST_RETURN_VALUE);
+    ASSERT_EQ(drain_queue(queue, 1, 2), K4A_WAIT_RESULT_SUCCEEDED);
+    ASSERT_EQ(queue_get_dropped_count(queue), 6u);
+
+    // Disabling releases a blocked push
+    ASSERT_EQ(fill_queue(queue, 0, 2), K4A_RESULT_SUCCEEDED);
+    data.done_event = 0;
+    ASSERT_EQ(THREADAPI_OK, ThreadAPI_Create(&thread, thread_blocked_push, &data));
+    ThreadAPI_Sleep((unsigned int)g_timeout);
+    queue_disable(queue);
+    ASSERT_EQ(THREADAPI_OK, ThreadAPI_Join(thread, &thread_result));
+    ASSERT_EQ(data.done_event, 1u);
+
+    queue_destroy(queue);
+    ASSERT_EQ(allocator_test_for_leaks(), 0);
+}
+
+TEST(queue_ut, queue_policy)
+{
+    queue_test_policy(false);
+    queue_test_policy(true);
+}
+
 TEST(queue_ut, queue_multiple_queues)
 {
     queue_t queue1, queue2, queue3;
@@ -873,3 +1023,378 @@ TEST(queue_ut, queue_stop)
     queue_destroy(queue);
     ASSERT_EQ(allocator_test_for_leaks(), 0);
 }
+
+TEST(queue_ut, queue_lockfree_find_depth)
+{
+    queue_t queue;
+    uint32_t depths[] = { 1, 8, 13, 97, 100 };
+
+    for (uint32_t x = 0; x < COUNTOF(depths); x++)
+    {
+        ASSERT_EQ(queue_create_lockfree(depths[x], "queue_test", &queue), K4A_RESULT_SUCCEEDED);
+        ASSERT_EQ(find_queue_depth(queue), depths[x]);
+        queue_destroy(queue);
+    }
+
+    ASSERT_EQ(queue_create_lockfree(0, "queue_test", &queue), K4A_RESULT_FAILED);
+    ASSERT_EQ(queue_create_lockfree(MAX_QUEUE_DEPTH_LENGTH + 1, "queue_test", &queue), K4A_RESULT_FAILED);
+
+    // Verify all our allocations were released
+    ASSERT_EQ(allocator_test_for_leaks(), 0);
+}
+
+TEST(queue_ut, queue_lockfree_push_w_dropped)
+{
+    queue_t queue;
+    k4a_capture_t capture1;
+    k4a_capture_t capture2;
+    k4a_capture_t capture_dropped;
+    k4a_capture_t capture_read;
+
+    ASSERT_EQ(queue_create_lockfree(1, "queue_test", &queue), K4A_RESULT_SUCCEEDED);
+    queue_enable(queue);
+    capture1 = capture_manufacture(10);
+    ASSERT_NE(capture1, (k4a_capture_t)NULL);
+    capture2 = capture_manufacture(10);
+    ASSERT_NE(capture2, (k4a_capture_t)NULL);
+
+    // queue is empty, so capture_dropped should be NULL
+    capture_dropped = NULL;
+    queue_push_w_dropped(queue, capture1, &capture_dropped);
+    ASSERT_EQ(capture_dropped, (k4a_capture_t)NULL);
+
+    // queue is full, so capture_dropped should be capture1
+    queue_push_w_dropped(queue, capture2, &capture_dropped);
+    ASSERT_EQ(capture_dropped, capture1);
+    capture_dec_ref(capture_dropped);
+
+    // queue is full, dropped capture is released by the queue
+    queue_push_w_dropped(queue, capture1, NULL);
+    ASSERT_EQ(queue_pop(queue, 0, &capture_read), K4A_WAIT_RESULT_SUCCEEDED);
+    ASSERT_EQ(capture_read, capture1);
+    capture_dec_ref(capture_read);
+    ASSERT_EQ(queue_pop(queue, 0, &capture_read), K4A_WAIT_RESULT_TIMEOUT);
+
+    capture_dec_ref(capture1);
+    capture_dec_ref(capture2);
+
+    queue_destroy(queue);
+    ASSERT_EQ(allocator_test_for_leaks(), 0);
+}
+
+TEST(queue_ut, queue_lockfree_pop_on_empty_queue)
+{
+    queue_t queue;
+
+    ASSERT_EQ(queue_create_lockfree(TEST_QUEUE_DEPTH, "queue_test", &queue), K4A_RESULT_SUCCEEDED);
+    pop_on_empty_queue(queue);
+    queue_destroy(queue);
+}
+
+TEST(queue_ut, queue_lockfree_threaded)
+{
+    queue_t queue;
+    LOCK_HANDLE lock;
+    threaded_queue_data_t writer, reader;
+    THREAD_HANDLE t1, r1;
+
+    // Single producer and single consumer
+    ASSERT_EQ(queue_create_lockfree(TEST_QUEUE_DEPTH, "queue_test", &queue), K4A_RESULT_SUCCEEDED);
+    queue_enable(queue);
+    ASSERT_NE((lock = Lock_Init()), (LOCK_HANDLE)NULL);
+
+    writer.queue = queue;
+    writer.pattern_start = 1;
+    writer.pattern_offset = 3;
+    writer.done_event = 0;
+    writer.error = 0;
+    writer.lock = lock;
+
+    reader.queue = queue;
+    reader.pattern_offset = 3;
+    reader.done_event = 0;
+    reader.error = 0;
+    reader.dropped = 0;
+    reader.lock = lock;
+
+    // prevent the threads from running
+    Lock(lock);
+
+    ASSERT_EQ(THREADAPI_OK, ThreadAPI_Create(&t1, thread_write_queue, &writer));
+    ASSERT_EQ(THREADAPI_OK, ThreadAPI_Create(&r1, thread_read_queue, &reader));
+
+    Unlock(lock);
+
+    int result1, result2;
+    ASSERT_EQ(THREADAPI_OK, ThreadAPI_Join(t1, &result1));
+    ASSERT_EQ(THREADAPI_OK, ThreadAPI_Join(r1, &result2));
+
+    ASSERT_EQ(result1, TEST_RETURN_VALUE);
+    ASSERT_EQ(result2, TEST_RETURN_VALUE);
+    ASSERT_EQ(writer.error, (uint32_t)0);
+    ASSERT_EQ(reader.error, (uint32_t)0);
+
+    if (reader.dropped != 0)
+    {
+        GTEST_LOG_WARNING << "WARNING: queue dropped " << reader.dropped << " samples \n";
+    }
+
+    queue_destroy(queue);
+
+    // Verify all our allocations were released
+    ASSERT_EQ(allocator_test_for_leaks(), 0);
+
+    Lock_Deinit(lock);
+}
+
+TEST(queue_ut, sample_queue_push_pop)
+{
+    sample_queue_t queue;
+    uint32_t samples[TEST_QUEUE_DEPTH * 2];
+    size_t count;
+
+    ASSERT_EQ(sample_queue_create(0, TEST_QUEUE_DEPTH, "queue_test", &queue), K4A_RESULT_FAILED);
+    ASSERT_EQ(sample_queue_create(sizeof(uint32_t), 0, "queue_test", &queue), K4A_RESULT_FAILED);
+    ASSERT_EQ(sample_queue_create(sizeof(uint32_t), TEST_QUEUE_DEPTH, "queue_test", &queue), K4A_RESULT_SUCCEEDED);
+
+    // disabled
+    uint32_t value = 0;
+    sample_queue_push(queue, &value);
+    ASSERT_EQ(sample_queue_pop(queue, 0, samples, 1, &count), K4A_WAIT_RESULT_FAILED);
+    ASSERT_EQ(count, (size_t)0);
+
+    sample_queue_enable(queue);
+    ASSERT_EQ(sample_queue_pop(queue, 0, samples, 1, &count), K4A_WAIT_RESULT_TIMEOUT);
+    ASSERT_EQ(sample_queue_pop(queue, 100, samples, 1, &count), K4A_WAIT_RESULT_TIMEOUT);
+    ASSERT_EQ(sample_queue_pop(queue, 0, samples, 0, &count), K4A_WAIT_RESULT_FAILED);
+
+    // Overfill the queue, the oldest samples are dropped
+    for (value = 0; value < TEST_QUEUE_DEPTH + 3; value++)
+    {
+        sample_queue_push(queue, &value);
+    }
+
+    // Partial pop
+    ASSERT_EQ(sample_queue_pop(queue, 0, samples, 2, &count), K4A_WAIT_RESULT_SUCCEEDED);
+    ASSERT_EQ(count, (size_t)2);
+    ASSERT_EQ(samples[0], (uint32_t)3);
+    ASSERT_EQ(samples[1], (uint32_t)4);
+    ASSERT_EQ(sample_queue_get_dropped_count(queue), 3u);
+
+    // Push more so the remaining samples wrap around the end of the ring
+    for (; value < TEST_QUEUE_DEPTH + 5; value++)
+    {
+        sample_queue_push(queue, &value);
+    }
+
+    ASSERT_EQ(sample_queue_pop(queue, 0, samples, COUNTOF(samples), &count), K4A_WAIT_RESULT_SUCCEEDED);
+    ASSERT_EQ(count, (size_t)TEST_QUEUE_DEPTH);
+    for (size_t i = 0; i < count; i++)
+    {
+        ASSERT_EQ(samples[i], (uint32_t)(i + 5));
+    }
+    ASSERT_EQ(sample_queue_pop(queue, 0, samples, COUNTOF(samples), &count), K4A_WAIT_RESULT_TIMEOUT);
+
+    // Disable drops what is queued
+    sample_queue_push(queue, &value);
+    sample_queue_disable(queue);
+    sample_queue_enable(queue);
+    ASSERT_EQ(sample_queue_pop(queue, 0, samples, COUNTOF(samples), &count), K4A_WAIT_RESULT_TIMEOUT);
+    ASSERT_EQ(sample_queue_get_dropped_count(queue), 3u);
+
+    sample_queue_destroy(queue);
+    ASSERT_EQ(allocator_test_for_leaks(), 0);
+}
+
+TEST(queue_ut, sample_queue_pop_latest)
+{
+    sample_queue_t queue;
+    uint32_t sample = 0;
+    size_t count;
+
+    ASSERT_EQ(sample_queue_create(sizeof(uint32_t), TEST_QUEUE_DEPTH, "queue_test", &queue), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(sample_queue_pop_latest(queue, 0, &sample), K4A_WAIT_RESULT_FAILED);
+    sample_queue_enable(queue);
+    ASSERT_EQ(sample_queue_pop_latest(queue, 0, NULL), K4A_WAIT_RESULT_FAILED);
+    ASSERT_EQ(sample_queue_pop_latest(queue, 0, &sample), K4A_WAIT_RESULT_TIMEOUT);
+
+    // Wrap the ring, the newest sample is returned and the rest are skipped without counting as dropped
+    for (uint32_t value = 0; value < TEST_QUEUE_DEPTH + 3; value++)
+    {
+        sample_queue_push(queue, &value);
+    }
+    ASSERT_EQ(sample_queue_pop_latest(queue, 0, &sample), K4A_WAIT_RESULT_SUCCEEDED);
+    ASSERT_EQ(sample, (uint32_t)(TEST_QUEUE_DEPTH + 2));
+    ASSERT_EQ(sample_queue_pop(queue, 0, &sample, 1, &count), K4A_WAIT_RESULT_TIMEOUT);
+    ASSERT_EQ(sample_queue_get_dropped_count(queue), 3u);
+
+    // The queue keeps working in order after a latest pop
+    for (uint32_t value = 10; value < 12; value++)
+    {
+        sample_queue_push(queue, &value);
+    }
+    ASSERT_EQ(sample_queue_pop(queue, 0, &sample, 1, &count), K4A_WAIT_RESULT_SUCCEEDED);
+    ASSERT_EQ(sample, 10u);
+    ASSERT_EQ(sample_queue_pop_latest(queue, 0, &sample), K4A_WAIT_RESULT_SUCCEEDED);
+    ASSERT_EQ(sample, 11u);
+
+    sample_queue_destroy(queue);
+    ASSERT_EQ(allocator_test_for_leaks(), 0);
+}
+
+typedef struct _sample_queue_thread_data_t
+{
+    sample_queue_t queue;
+    LOCK_HANDLE lock;
+    int32_t push_delay;
+} sample_queue_thread_data_t;
+
+static int thread_sample_queue_writer(void *param)
+{
+    sample_queue_thread_data_t *data = (sample_queue_thread_data_t *)param;
+
+    Lock(data->lock);
+    Unlock(data->lock);
+
+    ThreadAPI_Sleep((unsigned int)data->push_delay);
+    uint32_t value = 1;
+    sample_queue_push(data->queue, &value);
+    return TEST_RETURN_VALUE;
+}
+
+TEST(queue_ut, sample_queue_blocking_pop)
+{
+    sample_queue_t queue;
+    sample_queue_thread_data_t data;
+    THREAD_HANDLE thread;
+    uint32_t sample = 0;
+    size_t count = 0;
+
+    ASSERT_EQ(sample_queue_create(sizeof(uint32_t), TEST_QUEUE_DEPTH, "queue_test", &queue), K4A_RESULT_SUCCEEDED);
+    sample_queue_enable(queue);
+    ASSERT_NE((data.lock = Lock_Init()), (LOCK_HANDLE)NULL);
+    data.queue = queue;
+    data.push_delay = 100;
+
+    Lock(data.lock);
+    ASSERT_EQ(THREADAPI_OK, ThreadAPI_Create(&thread, thread_sample_queue_writer, &data));
+    Unlock(data.lock);
+
+    ASSERT_EQ(sample_queue_pop(queue, K4A_WAIT_INFINITE, &sample, 1, &count), K4A_WAIT_RESULT_SUCCEEDED);
+    ASSERT_EQ(count, (size_t)1);
+    ASSERT_EQ(sample, (uint32_t)1);
+
+    int result;
+    ASSERT_EQ(THREADAPI_OK, ThreadAPI_Join(thread, &result));
+    ASSERT_EQ(result, TEST_RETURN_VALUE);
+
+    // A stopped queue fails pops, even infinite ones
+    sample_queue_stop(queue);
+    ASSERT_EQ(sample_queue_pop(queue, K4A_WAIT_INFINITE, &sample, 1, &count), K4A_WAIT_RESULT_FAILED);
+
+    sample_queue_destroy(queue);
+    Lock_Deinit(data.lock);
+    ASSERT_EQ(allocator_test_for_leaks(), 0);
+}
+
+static bool wait_handle_signaled(k4a_wait_handle_t wait_handle)
+{
+#ifdef _WIN32
+    return WaitForSingleObject((HANDLE)wait_handle, 0) == WAIT_OBJECT_0;
+#else
+    struct pollfd fd = { wait_handle, POLLIN, 0 };
+    return poll(&fd, 1, 0) == 1 && (fd.revents & POLLIN) != 0;
+#endif
+}
+
+static void wait_handle_follows_queue(queue_t queue)
+{
+    k4a_wait_handle_t wait_handle = K4A_WAIT_HANDLE_INVALID;
+    k4a_wait_handle_t again = K4A_WAIT_HANDLE_INVALID;
+    k4a_capture_t capture;
+
+    ASSERT_EQ(queue_get_wait_handle(queue, NULL), K4A_RESULT_FAILED);
+    ASSERT_EQ(queue_get_wait_handle(queue, &wait_handle), K4A_RESULT_SUCCEEDED);
+    ASSERT_NE(wait_handle, K4A_WAIT_HANDLE_INVALID);
+    ASSERT_EQ(queue_get_wait_handle(queue, &again), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(wait_handle, again);
+
+    // Signaled while disabled, so a waiter finds out from the failing pop
+    ASSERT_TRUE(wait_handle_signaled(wait_handle));
+
+    queue_enable(queue);
+    ASSERT_FALSE(wait_handle_signaled(wait_handle));
+
+    capture = capture_manufacture(10);
+    queue_push(queue, capture);
+    queue_push(queue, capture);
+    capture_dec_ref(capture);
+    ASSERT_TRUE(wait_handle_signaled(wait_handle));
+
+    // Stays signaled until the queue is empty
+    ASSERT_EQ(queue_pop(queue, 0, &capture), K4A_WAIT_RESULT_SUCCEEDED);
+    capture_dec_ref(capture);
+    ASSERT_TRUE(wait_handle_signaled(wait_handle));
+    ASSERT_EQ(queue_pop(queue, 0, &capture), K4A_WAIT_RESULT_SUCCEEDED);
+    capture_dec_ref(capture);
+    ASSERT_FALSE(wait_handle_signaled(wait_handle));
+
+    capture = capture_manufacture(10);
+    queue_push(queue, capture);
+    capture_dec_ref(capture);
+    ASSERT_TRUE(wait_handle_signaled(wait_handle));
+
+    queue_stop(queue);
+    ASSERT_TRUE(wait_handle_signaled(wait_handle));
+    ASSERT_EQ(queue_pop(queue, 0, &capture), K4A_WAIT_RESULT_FAILED);
+}
+
+TEST(queue_ut, queue_wait_handle)
+{
+    queue_t queue;
+
+    ASSERT_EQ(queue_create(TEST_QUEUE_DEPTH, "queue_test", &queue), K4A_RESULT_SUCCEEDED);
+    wait_handle_follows_queue(queue);
+    queue_destroy(queue);
+
+    ASSERT_EQ(queue_create_lockfree(TEST_QUEUE_DEPTH, "queue_test", &queue), K4A_RESULT_SUCCEEDED);
+    wait_handle_follows_queue(queue);
+    queue_destroy(queue);
+    ASSERT_EQ(allocator_test_for_leaks(), 0);
+}
+
+TEST(queue_ut, sample_queue_wait_handle)
+{
+    sample_queue_t queue;
+    k4a_wait_handle_t wait_handle = K4A_WAIT_HANDLE_INVALID;
+    uint32_t samples[TEST_QUEUE_DEPTH];
+    uint32_t value = 1;
+    size_t count;
+
+    ASSERT_EQ(sample_queue_create(sizeof(uint32_t), TEST_QUEUE_DEPTH, "queue_test", &queue), K4A_RESULT_SUCCEEDED);
+    sample_queue_enable(queue);
+
+    // Created after data is queued, so it starts out signaled
+    sample_queue_push(queue, &value);
+    ASSERT_EQ(sample_queue_get_wait_handle(queue, &wait_handle), K4A_RESULT_SUCCEEDED);
+    ASSERT_TRUE(wait_handle_signaled(wait_handle));
+
+    sample_queue_push(queue, &value);
+    ASSERT_EQ(sample_queue_pop(queue, 0, samples, 1, &count), K4A_WAIT_RESULT_SUCCEEDED);
+    ASSERT_TRUE(wait_handle_signaled(wait_handle));
+    ASSERT_EQ(sample_queue_pop(queue, 0, samples, 1, &count), K4A_WAIT_RESULT_SUCCEEDED);
+    ASSERT_FALSE(wait_handle_signaled(wait_handle));
+
+    sample_queue_push(queue, &value);
+    sample_queue_push(queue, &value);
+    ASSERT_TRUE(wait_handle_signaled(wait_handle));
+    ASSERT_EQ(sample_queue_pop_latest(queue, 0, samples), K4A_WAIT_RESULT_SUCCEEDED);
+    ASSERT_FALSE(wait_handle_signaled(wait_handle));
+
+    sample_queue_stop(queue);
+    ASSERT_TRUE(wait_handle_signaled(wait_handle));
+    ASSERT_EQ(sample_queue_pop(queue, 0, samples, 1, &count), K4A_WAIT_RESULT_FAILED);
+
+    sample_queue_destroy(queue);
+    ASSERT_EQ(allocator_test_for_leaks(), 0);
+}
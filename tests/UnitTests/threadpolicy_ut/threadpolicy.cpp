@@ -0,0 +1,74 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <utcommon.h>
+
+#include <k4ainternal/threadpolicy.h>
+#include <gtest/gtest.h>
+
+int main(int argc, char **argv)
+{
+    return k4a_test_common_main(argc, argv);
+}
+
+TEST(threadpolicy_ut, set_get)
+{
+    k4a_thread_policy_t policy = { 0 };
+    k4a_thread_policy_t read = { 0 };
+
+    // Nothing is configured by default
+    for (int i = 0; i < K4A_SDK_THREAD_COUNT; i++)
+    {
+        read.cpu_affinity_mask = 0xff;
+        ASSERT_EQ(K4A_RESULT_SUCCEEDED, threadpolicy_get((k4a_sdk_thread_t)i, &read));
+        ASSERT_EQ(0u, read.cpu_affinity_mask);
+        ASSERT_EQ(K4A_THREAD_PRIORITY_DEFAULT, read.priority);
+    }
+
+    policy.cpu_affinity_mask = 0x3;
+    policy.priority = K4A_THREAD_PRIORITY_HIGHEST;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, threadpolicy_set(K4A_SDK_THREAD_DEPTH_ENGINE, &policy));
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, threadpolicy_get(K4A_SDK_THREAD_DEPTH_ENGINE, &read));
+    ASSERT_EQ(policy.cpu_affinity_mask, read.cpu_affinity_mask);
+    ASSERT_EQ(policy.priority, read.priority);
+
+    // Other threads are not affected
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, threadpolicy_get(K4A_SDK_THREAD_DEPTH_USB, &read));
+    ASSERT_EQ(0u, read.cpu_affinity_mask);
+
+    // A zeroed policy restores the default
+    policy = {};
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, threadpolicy_set(K4A_SDK_THREAD_DEPTH_ENGINE, &policy));
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, threadpolicy_get(K4A_SDK_THREAD_DEPTH_ENGINE, &read));
+    ASSERT_EQ(0u, read.cpu_affinity_mask);
+    ASSERT_EQ(K4A_THREAD_PRIORITY_DEFAULT, read.priority);
+}
+
+TEST(threadpolicy_ut, invalid_arguments)
+{
+    k4a_thread_policy_t policy = { 0 };
+
+    ASSERT_EQ(K4A_RESULT_FAILED, threadpolicy_set(K4A_SDK_THREAD_COUNT, &policy));
+    ASSERT_EQ(K4A_RESULT_FAILED, threadpolicy_set((k4a_sdk_thread_t)-1, &policy));
+    ASSERT_EQ(K4A_RESULT_FAILED, threadpolicy_set(K4A_SDK_THREAD_DEPTH_USB, NULL));
+    ASSERT_EQ(K4A_RESULT_FAILED, threadpolicy_get(K4A_SDK_THREAD_COUNT, &policy));
+    ASSERT_EQ(K4A_RESULT_FAILED, threadpolicy_get(K4A_SDK_THREAD_DEPTH_USB, NULL));
+
+    policy.priority = (k4a_thread_priority_t)(K4A_THREAD_PRIORITY_REALTIME + 1);
+    ASSERT_EQ(K4A_RESULT_FAILED, threadpolicy_set(K4A_SDK_THREAD_DEPTH_USB, &policy));
+}
+
+TEST(threadpolicy_ut, apply_to_current_thread)
+{
+    k4a_thread_policy_t policy = { 0 };
+
+    // The default policy leaves the thread untouched
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, threadpolicy_apply_to_current_thread("test", &policy));
+
+    // Every host has CPU 0
+    policy.cpu_affinity_mask = 0x1;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, threadpolicy_apply_to_current_thread("test", &policy));
+
+    ASSERT_EQ(K4A_RESULT_FAILED, threadpolicy_apply_to_current_thread(NULL, &policy));
+    ASSERT_EQ(K4A_RESULT_FAILED, threadpolicy_apply_to_current_thread("test", NULL));
+}
@@ -0,0 +1,163 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <utcommon.h>
+
+#include <k4ainternal/threadpool.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+int main(int argc, char **argv)
+{
+    return k4a_test_common_main(argc, argv);
+}
+
+class threadpool_ut : public ::testing::Test
+{
+protected:
+    void TearDown() override
+    {
+        k4a_thread_pool_options_t options = {};
+        ASSERT_EQ(K4A_RESULT_SUCCEEDED, threadpool_set_options(&options));
+    }
+};
+
+typedef struct
+{
+    std::vector<std::atomic<uint32_t>> *calls;
+    std::atomic<uint32_t> *nested_calls;
+} for_context_t;
+
+static void count_index(void *context, uint32_t index)
+{
+    for_context_t *for_context = (for_context_t *)context;
+    (*for_context->calls)[index]++;
+}
+
+static void count_nested(void *context, uint32_t index)
+{
+    (void)index;
+    for_context_t *for_context = (for_context_t *)context;
+    (*for_context->nested_calls)++;
+}
+
+static void run_nested(void *context, uint32_t index)
+{
+    count_index(context, index);
+    threadpool_parallel_for(count_nested, context, 16);
+}
+
+TEST_F(threadpool_ut, parallel_for)
+{
+    std::vector<std::atomic<uint32_t>> calls(1000);
+    std::atomic<uint32_t> nested_calls(0);
+    for_context_t context = { &calls, &nested_calls };
+
+    for (uint32_t thread_count : { 0u, 1u, 4u })
+    {
+        k4a_thread_pool_options_t options = {};
+        options.thread_count = thread_count;
+        ASSERT_EQ(K4A_RESULT_SUCCEEDED, threadpool_set_options(&options));
+
+        for (auto &call : calls)
+        {
+            call = 0;
+        }
+        threadpool_parallel_for(count_index, &context, (uint32_t)calls.size());
+        for (auto &call : calls)
+        {
+            ASSERT_EQ(1u, call.load());
+        }
+    }
+
+    // Nothing is called for an empty range
+    threadpool_parallel_for(count_index, &context, 0);
+}
+
+TEST_F(threadpool_ut, nested_parallel_for)
+{
+    std::vector<std::atomic<uint32_t>> calls(64);
+    std::atomic<uint32_t> nested_calls(0);
+    for_context_t context = { &calls, &nested_calls };
+
+    k4a_thread_pool_options_t options = {};
+    options.thread_count = 2;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, threadpool_set_options(&options));
+
+    // Pool threads waiting on their own nested loops keep running queued tasks instead of blocking the pool
+    threadpool_parallel_for(run_nested, &context, (uint32_t)calls.size());
+    for (auto &call : calls)
+    {
+        ASSERT_EQ(1u, call.load());
+    }
+    ASSERT_EQ(calls.size() * 16, nested_calls.load());
+}
+
+static void increment(void *task_context)
+{
+    (*(std::atomic<uint32_t> *)task_context)++;
+}
+
+TEST_F(threadpool_ut, submit)
+{
+    std::atomic<uint32_t> count(0);
+
+    k4a_thread_pool_options_t options = {};
+    options.thread_count = 3;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, threadpool_set_options(&options));
+
+    // More tasks than the queues hold, the overflow runs on this thread
+    for (int i = 0; i < 10000; i++)
+    {
+        threadpool_submit(increment, &count);
+    }
+
+    // Changing the options waits for the queued tasks
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, threadpool_set_options(&options));
+    ASSERT_EQ(10000u, count.load());
+}
+
+static void run_on_new_thread(k4a_thread_pool_task_t *task, void *task_context, void *executor_context)
+{
+    (*(std::atomic<uint32_t> *)executor_context)++;
+    std::thread(task, task_context).detach();
+}
+
+TEST_F(threadpool_ut, executor)
+{
+    std::vector<std::atomic<uint32_t>> calls(100);
+    std::atomic<uint32_t> nested_calls(0);
+    std::atomic<uint32_t> executed(0);
+    for_context_t context = { &calls, &nested_calls };
+
+    k4a_thread_pool_options_t options = {};
+    options.executor = run_on_new_thread;
+    options.executor_context = &executed;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, threadpool_set_options(&options));
+
+    k4a_thread_pool_options_t read = {};
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, threadpool_get_options(&read));
+    ASSERT_EQ(options.executor, read.executor);
+    ASSERT_EQ(options.executor_context, read.executor_context);
+
+    threadpool_parallel_for(count_index, &context, (uint32_t)calls.size());
+    for (auto &call : calls)
+    {
+        ASSERT_EQ(1u, call.load());
+    }
+    ASSERT_LT(0u, executed.load());
+}
+
+TEST_F(threadpool_ut, invalid_arguments)
+{
+    k4a_thread_pool_options_t options = {};
+
+    ASSERT_EQ(K4A_RESULT_FAILED, threadpool_set_options(NULL));
+    ASSERT_EQ(K4A_RESULT_FAILED, threadpool_get_options(NULL));
+
+    options.thread_count = THREADPOOL_MAX_THREAD_COUNT + 1;
+    ASSERT_EQ(K4A_RESULT_FAILED, threadpool_set_options(&options));
+}
@@ -0,0 +1,97 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <utcommon.h>
+
+#include <k4ainternal/tracing.h>
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#define TRACE_FILE "tracing_ut_trace.json"
+
+int main(int argc, char **argv)
+{
+    return k4a_test_common_main(argc, argv);
+}
+
+static std::string read_trace()
+{
+    std::ifstream file(TRACE_FILE);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+}
+
+static size_t count_occurrences(const std::string &text, const std::string &pattern)
+{
+    size_t count = 0;
+    size_t position = text.find(pattern);
+    while (position != std::string::npos)
+    {
+        count++;
+        position = text.find(pattern, position + 1);
+    }
+    return count;
+}
+
+TEST(tracing_ut, record_and_export)
+{
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, tracing_start());
+    ASSERT_TRUE(tracing_is_enabled());
+
+    TRACE_SPAN_BEGIN("tracing_ut span", 1234);
+    std::thread worker([]() {
+        for (int i = 0; i < 10; i++)
+        {
+            TRACE_INSTANT("tracing_ut worker", i + 1);
+        }
+    });
+    worker.join();
+    TRACE_SPAN_END("tracing_ut span", 1234);
+
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, tracing_stop(TRACE_FILE));
+    ASSERT_FALSE(tracing_is_enabled());
+
+    std::string trace = read_trace();
+    ASSERT_NE(std::string::npos, trace.find("\"traceEvents\":["));
+    ASSERT_NE(std::string::npos, trace.find("\"dropped_events\":0"));
+    ASSERT_EQ(1u, count_occurrences(trace, "\"name\":\"tracing_ut span\",\"cat\":\"k4a\",\"ph\":\"B\""));
+    ASSERT_EQ(1u, count_occurrences(trace, "\"name\":\"tracing_ut span\",\"cat\":\"k4a\",\"ph\":\"E\""));
+    ASSERT_EQ(10u, count_occurrences(trace, "\"name\":\"tracing_ut worker\",\"cat\":\"k4a\",\"ph\":\"i\""));
+    ASSERT_EQ(2u, count_occurrences(trace, "\"frame\":1234"));
+    ASSERT_EQ(1u, count_occurrences(trace, "\"frame\":10}"));
+
+    remove(TRACE_FILE);
+}
+
+TEST(tracing_ut, disabled_records_nothing)
+{
+    // Events of a trace that is discarded don't show up in the next one
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, tracing_start());
+    TRACE_INSTANT("tracing_ut discarded", 1);
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, tracing_stop(NULL));
+
+    TRACE_INSTANT("tracing_ut disabled", 2);
+
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, tracing_start());
+    TRACE_INSTANT("tracing_ut enabled", 3);
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, tracing_stop(TRACE_FILE));
+
+    std::string trace = read_trace();
+    ASSERT_EQ(std::string::npos, trace.find("tracing_ut discarded"));
+    ASSERT_EQ(std::string::npos, trace.find("tracing_ut disabled"));
+    ASSERT_EQ(1u, count_occurrences(trace, "tracing_ut enabled"));
+
+    remove(TRACE_FILE);
+}
+
+TEST(tracing_ut, invalid_path)
+{
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, tracing_start());
+    TRACE_INSTANT("tracing_ut invalid path", 1);
+    ASSERT_EQ(K4A_RESULT_FAILED, tracing_stop("this_directory_does_not_exist/trace.json"));
+}
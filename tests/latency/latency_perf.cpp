@@ -18,6 +18,7 @@
 #include <k4a/k4a.h>
 #include <azure_c_shared_utility/threadapi.h>
 #include <azure_c_shared_utility/envvariable.h>
+#include <algorithm>
 #include <deque>
 #include <mutex>
 
@@ -67,6 +68,15 @@ struct latency_parameters
     }
 };
 
+// Time each image spent reaching the SDK stages after USB arrival, taken from the stage timestamps on the image.
+// to_stage[x] is the time from the previous stage the image passed through to stage x, color images skip the depth
+// engine so their sync time is measured from USB arrival.
+struct stage_latency
+{
+    std::deque<uint64_t> to_stage[K4A_IMAGE_STAGE_USER_POP + 1];
+    std::deque<uint64_t> total;
+};
+
 struct thread_data
 {
     volatile bool save_samples;
@@ -106,7 +116,8 @@ public:
                        std::deque<uint64_t> *system_latency,
                        std::deque<uint64_t> *system_latency_from_pts,
                        uint64_t *system_ts_last,
-                       uint64_t *system_ts_from_pts_last);
+                       uint64_t *system_ts_from_pts_last,
+                       stage_latency *stages);
 
     k4a_device_t m_device = nullptr;
     FILE *m_file_handle;
@@ -243,6 +254,66 @@ static bool get_system_time(uint64_t *time_nsec)
     return true;
 }
 
+static void record_stage_latency(k4a_image_t image, stage_latency *stages)
+{
+    uint64_t usb_arrival = k4a_image_get_stage_timestamp_nsec(image, K4A_IMAGE_STAGE_USB_ARRIVAL);
+    uint64_t previous = usb_arrival;
+    for (int stage = K4A_IMAGE_STAGE_DEPTH_ENGINE_DONE; stage <= K4A_IMAGE_STAGE_USER_POP; stage++)
+    {
+        uint64_t ts = k4a_image_get_stage_timestamp_nsec(image, (k4a_image_stage_t)stage);
+        if (ts == 0 || previous == 0 || ts < previous)
+        {
+            // Stage not passed through, or the clock read failed
+            continue;
+        }
+        stages->to_stage[stage].push_back(ts - previous);
+        previous = ts;
+    }
+
+    uint64_t user_pop = k4a_image_get_stage_timestamp_nsec(image, K4A_IMAGE_STAGE_USER_POP);
+    if (usb_arrival != 0 && user_pop >= usb_arrival)
+    {
+        stages->total.push_back(user_pop - usb_arrival);
+    }
+}
+
+static uint64_t get_percentile(std::deque<uint64_t> samples, double percentile)
+{
+    if (samples.empty())
+    {
+        return 0;
+    }
+    std::sort(samples.begin(), samples.end());
+    size_t index = std::min(samples.size() - 1, (size_t)(percentile * (double)samples.size()));
+    return samples[index];
+}
+
+static void print_and_log_stage(FILE *file, const char *stream, const char *stage, const std::deque<uint64_t> &samples)
+{
+    if (samples.empty())
+    {
+        return;
+    }
+
+    int64_t p50 = LLD(get_percentile(samples, 0.50) / 1000);
+    int64_t p99 = LLD(get_percentile(samples, 0.99) / 1000);
+    int64_t p999 = LLD(get_percentile(samples, 0.999) / 1000);
+    printf("    %20s %24s (usec): p50=%" PRId64 " p99=%" PRId64 " p999=%" PRId64 "\n", stream, stage, p50, p99, p999);
+
+    if (file)
+    {
+        fprintf(file, "%s %s (usec p50 p99 p999),%" PRId64 ",%" PRId64 ",%" PRId64 ",", stream, stage, p50, p99, p999);
+    }
+}
+
+static void print_and_log_stage_latency(FILE *file, const char *stream, const stage_latency &stages)
+{
+    print_and_log_stage(file, stream, "to depth engine done", stages.to_stage[K4A_IMAGE_STAGE_DEPTH_ENGINE_DONE]);
+    print_and_log_stage(file, stream, "to sync done", stages.to_stage[K4A_IMAGE_STAGE_SYNC_DONE]);
+    print_and_log_stage(file, stream, "to user pop", stages.to_stage[K4A_IMAGE_STAGE_USER_POP]);
+    print_and_log_stage(file, stream, "USB arrival to user pop", stages.total);
+}
+
 static int _latency_imu_thread(void *param)
 {
     struct thread_data *data = (struct thread_data *)param;
@@ -427,7 +498,8 @@ void latency_perf::process_image(k4a_capture_t capture,
                                  std::deque<uint64_t> *system_latency,
                                  std::deque<uint64_t> *system_latency_from_pts,
                                  uint64_t *system_ts_last,
-                                 uint64_t *system_ts_from_pts_last)
+                                 uint64_t *system_ts_from_pts_last,
+                                 stage_latency *stages)
 {
     k4a_image_t image;
     if (process_color)
@@ -471,6 +543,7 @@ void latency_perf::process_image(k4a_capture_t capture,
             {
                 system_latency->push_back(current_system_ts - system_ts);
                 system_latency_from_pts->push_back(system_ts_latency_from_pts);
+                record_stage_latency(image, stages);
 
                 printf("| %9" PRId64 " [%5" PRId64 "] [%5" PRId64 "] ",
                        STS_TO_MS(system_ts),
@@ -508,6 +581,8 @@ TEST_P(latency_perf, testTest)
     std::deque<uint64_t> color_system_latency_from_pts;
     std::deque<uint64_t> ir_system_latency;
     std::deque<uint64_t> ir_system_latency_from_pts;
+    stage_latency color_stages;
+    stage_latency ir_stages;
     uint64_t current_system_ts = 0;
     uint64_t color_system_ts_last = 0, color_system_ts_from_pts_last = 0;
     uint64_t ir_system_ts_last = 0, ir_system_ts_from_pts_last = 0;
@@ -685,7 +760,8 @@ TEST_P(latency_perf, testTest)
                       &color_system_latency,
                       &color_system_latency_from_pts,
                       &color_system_ts_last,
-                      &color_system_ts_from_pts_last);
+                      &color_system_ts_from_pts_last,
+                      &color_stages);
         process_image(capture,
                       current_system_ts,
                       false, // IR Image
@@ -693,7 +769,8 @@ TEST_P(latency_perf, testTest)
                       &ir_system_latency,
                       &ir_system_latency_from_pts,
                       &ir_system_ts_last,
-                      &ir_system_ts_from_pts_last);
+                      &ir_system_ts_from_pts_last,
+                      &ir_stages);
 
         printf("|\n"); // End of line
     }                  // End capture loop
@@ -833,6 +910,10 @@ TEST_P(latency_perf, testTest)
                       STS_TO_MS(max));
     }
 
+    printf("\nStage Latency Results:\n");
+    print_and_log_stage_latency(m_file_handle, "Color", color_stages);
+    print_and_log_stage_latency(m_file_handle, "IR", ir_stages);
+
     printf("\n");
     if (m_file_handle != 0)
     {
@@ -891,6 +972,155 @@ static struct latency_parameters tests_15fps[] = {
 INSTANTIATE_TEST_CASE_P(15FPS_TESTS, latency_perf, ValuesIn(tests_15fps));
 // clang-format on
 
+static k4a_result_t open_master_and_subordinate(k4a_device_t *master, k4a_device_t *subordinate)
+{
+    *master = NULL;
+    *subordinate = NULL;
+
+    uint32_t devices_present = k4a_device_get_installed_count();
+    for (uint32_t x = 0; x < devices_present; x++)
+    {
+        k4a_device_t device;
+        if (K4A_FAILED(k4a_device_open(x, &device)))
+        {
+            continue;
+        }
+
+        bool sync_in_cable_present = false;
+        bool sync_out_cable_present = false;
+        if (K4A_SUCCEEDED(k4a_device_get_sync_jack(device, &sync_in_cable_present, &sync_out_cable_present)))
+        {
+            if (*master == NULL && sync_out_cable_present)
+            {
+                *master = device;
+                device = NULL;
+            }
+            else if (*subordinate == NULL && sync_in_cable_present)
+            {
+                *subordinate = device;
+                device = NULL;
+            }
+        }
+
+        if (device)
+        {
+            k4a_device_close(device);
+        }
+    }
+
+    return K4A_RESULT_FROM_BOOL(*master != NULL && *subordinate != NULL);
+}
+
+// Stage latencies of a wired master and subordinate pair streaming synchronized captures. Both devices are read from
+// the same thread, so the user pop stage includes the time a capture waits while the other device is read.
+TEST(latency_stage_perf, master_subordinate)
+{
+    const int32_t TIMEOUT_IN_MS = 1000;
+    k4a_device_t master = NULL;
+    k4a_device_t subordinate = NULL;
+    if (K4A_FAILED(open_master_and_subordinate(&master, &subordinate)))
+    {
+        printf("A master and subordinate pair connected with a sync cable was not found, skipping the test\n");
+        if (master)
+        {
+            k4a_device_close(master);
+        }
+        if (subordinate)
+        {
+            k4a_device_close(subordinate);
+        }
+        return;
+    }
+
+    k4a_device_configuration_t config = K4A_DEVICE_CONFIG_INIT_DISABLE_ALL;
+    config.color_format = K4A_IMAGE_FORMAT_COLOR_YUY2;
+    config.color_resolution = K4A_COLOR_RESOLUTION_720P;
+    config.depth_mode = K4A_DEPTH_MODE_NFOV_2X2BINNED;
+    config.camera_fps = K4A_FRAMES_PER_SECOND_30;
+    config.synchronized_images_only = true;
+    config.depth_delay_off_color_usec = g_depth_delay_off_color_usec;
+
+    // The subordinate has to be running before the master starts sending sync pulses
+    k4a_device_configuration_t s_config = config;
+    s_config.wired_sync_mode = K4A_WIRED_SYNC_MODE_SUBORDINATE;
+    s_config.subordinate_delay_off_master_usec = g_subordinate_delay_off_master_usec;
+    k4a_device_configuration_t m_config = config;
+    m_config.wired_sync_mode = K4A_WIRED_SYNC_MODE_MASTER;
+
+    bool failed = false;
+    bool started = K4A_SUCCEEDED(k4a_device_start_cameras(subordinate, &s_config));
+    if (started && K4A_FAILED(k4a_device_start_cameras(master, &m_config)))
+    {
+        k4a_device_stop_cameras(subordinate);
+        started = false;
+    }
+    EXPECT_TRUE(started);
+
+    k4a_device_t devices[2] = { master, subordinate };
+    const char *color_names[2] = { "Master Color", "Subordinate Color" };
+    const char *ir_names[2] = { "Master IR", "Subordinate IR" };
+    stage_latency color_stages[2];
+    stage_latency ir_stages[2];
+
+    for (int count = 0; started && count < g_capture_count; count++)
+    {
+        for (int d = 0; d < 2; d++)
+        {
+            k4a_capture_t capture = NULL;
+            if (k4a_device_get_capture(devices[d], &capture, TIMEOUT_IN_MS) != K4A_WAIT_RESULT_SUCCEEDED)
+            {
+                printf("Failed to read a capture from the %s\n", d == 0 ? "master" : "subordinate");
+                failed = true;
+                continue;
+            }
+
+            k4a_image_t image = k4a_capture_get_color_image(capture);
+            if (image)
+            {
+                record_stage_latency(image, &color_stages[d]);
+                k4a_image_release(image);
+            }
+            image = k4a_capture_get_ir_image(capture);
+            if (image)
+            {
+                record_stage_latency(image, &ir_stages[d]);
+                k4a_image_release(image);
+            }
+            k4a_capture_release(capture);
+        }
+    }
+
+    if (started)
+    {
+        k4a_device_stop_cameras(master);
+        k4a_device_stop_cameras(subordinate);
+    }
+    k4a_device_close(master);
+    k4a_device_close(subordinate);
+
+    FILE *file_handle = fopen("latency_testResults.csv", "a");
+    if (file_handle)
+    {
+        fprintf(file_handle, "master_subordinate, captures, %d,", g_capture_count);
+    }
+
+    printf("\nMaster and Subordinate Stage Latency Results:\n");
+    for (int d = 0; d < 2; d++)
+    {
+        print_and_log_stage_latency(file_handle, color_names[d], color_stages[d]);
+        print_and_log_stage_latency(file_handle, ir_names[d], ir_stages[d]);
+    }
+    printf("\n");
+
+    if (file_handle)
+    {
+        fputs("\n", file_handle);
+        fclose(file_handle);
+    }
+
+    ASSERT_EQ(failed, false);
+}
+
 int main(int argc, char **argv)
 {
     bool error = false;
@@ -1064,6 +1294,8 @@ int main(int argc, char **argv)
         printf("      <default> Sets the power line compensation frequency to 60Hz\n");
         printf("  --50hz\n");
         printf("      Sets the power line compensation frequency to 50Hz\n");
+        printf("\nlatency_stage_perf.master_subordinate needs two devices connected with a sync cable and\n");
+        printf("is skipped without them.\n");
 
         return 1; // Indicates an error or warning
     }
@@ -152,6 +152,35 @@ TEST_F(cpp_projection_ft, test_depth)
     test_camera(&m_device, camera_type::depth);
 }
 
+TEST(cpp_image_pool, recycle)
+{
+    k4a::image_pool pool(1);
+
+    k4a::image first = pool.acquire(K4A_IMAGE_FORMAT_DEPTH16, 320, 288, 320 * 2);
+    ASSERT_TRUE(first);
+    k4a_image_t first_handle = first.handle();
+
+    // A recycled image is handed out again for the same format and size
+    pool.recycle(std::move(first));
+    ASSERT_EQ(pool.size(), 1u);
+    k4a::image second = pool.acquire(K4A_IMAGE_FORMAT_DEPTH16, 320, 288, 320 * 2);
+    ASSERT_EQ(second.handle(), first_handle);
+    ASSERT_EQ(pool.size(), 0u);
+
+    // A different size gets a new image and leaves the recycled one in the pool
+    pool.recycle(std::move(second));
+    k4a::image other = pool.acquire(K4A_IMAGE_FORMAT_DEPTH16, 640, 576, 640 * 2);
+    ASSERT_NE(other.handle(), first_handle);
+    ASSERT_EQ(pool.size(), 1u);
+
+    // The pool holds at most one image, so the oldest is released
+    pool.recycle(std::move(other));
+    ASSERT_EQ(pool.size(), 1u);
+    k4a::image third = pool.acquire(K4A_IMAGE_FORMAT_DEPTH16, 320, 288, 320 * 2);
+    ASSERT_EQ(third.get_width_pixels(), 320);
+    ASSERT_EQ(pool.size(), 1u);
+}
+
 int main(int argc, char **argv)
 {
     return k4a_test_common_main(argc, argv);
@@ -0,0 +1,522 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// Counts the allocations the streaming pipeline makes per frame once it has warmed up, so a change that adds an
+// allocation to the steady state path fails CI instead of quietly undoing the buffer pooling.
+//
+// Payloads are pushed through the real depth, dewrapper, capturesync and IMU modules using the fakes in
+// replay_fakes.cpp, one frame at a time, and each capture or IMU sample is read back before the next frame is pushed.
+// Two counts are kept while the measured frames run:
+//  - SDK buffer allocations, counted by an allocator installed with allocator_set_allocator(), the function behind
+//    k4a_set_allocator(). These are the buffers none of the SDK's pools recycled.
+//  - Heap allocations, counted by replacing malloc, calloc and realloc. These also cover handles, contexts and the C++
+//    runtime. Replacing malloc needs glibc, elsewhere only buffer allocations are checked.
+//
+// The limits in the test tables are what the pipeline allocates today. A change that allocates more per frame fails
+// the test, a change that allocates less should lower the limits to keep the gain.
+
+//************************ Includes *****************************
+#include <k4ainternal/allocator.h>
+#include <k4ainternal/calibration.h>
+#include <k4ainternal/capture.h>
+#include <k4ainternal/capturesync.h>
+#include <k4ainternal/common.h>
+#include <k4ainternal/depth.h>
+#include <k4ainternal/image.h>
+#include <k4ainternal/imu.h>
+#include <gtest/gtest.h>
+#include <utcommon.h>
+
+#include <azure_c_shared_utility/tickcounter.h>
+
+#include "depthcommands.h"
+#include "replay_fakes.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+
+#define REPLAY_COLOR_PAYLOAD_SIZE (256 * 1024) // Roughly a 1080P MJPEG frame
+#define REPLAY_POOL_BUFFERS 8
+#define REPLAY_READ_TIMEOUT_MS 2000
+#define REPLAY_IMU_SAMPLES_PER_PAYLOAD 8
+
+static int g_warmup_frame_count = 30;
+static int g_frame_count = 100;
+
+using ::testing::ValuesIn;
+
+//************************ Allocation counting *****************************
+
+static std::atomic<bool> g_counting(false);
+static std::atomic<uint64_t> g_heap_allocation_count(0);
+static std::atomic<uint64_t> g_buffer_allocation_count(0);
+
+#if defined(__GLIBC__)
+#define REPLAY_COUNT_HEAP_ALLOCATIONS 1
+
+extern "C" {
+
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *buffer, size_t size);
+void __libc_free(void *buffer);
+
+// Replaces the C library's allocator for the whole process, including operator new and the SDK's own modules
+void *malloc(size_t size)
+{
+    if (g_counting.load(std::memory_order_relaxed))
+    {
+        g_heap_allocation_count.fetch_add(1, std::memory_order_relaxed);
+    }
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size)
+{
+    if (g_counting.load(std::memory_order_relaxed))
+    {
+        g_heap_allocation_count.fetch_add(1, std::memory_order_relaxed);
+    }
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *buffer, size_t size)
+{
+    if (g_counting.load(std::memory_order_relaxed))
+    {
+        g_heap_allocation_count.fetch_add(1, std::memory_order_relaxed);
+    }
+    return __libc_realloc(buffer, size);
+}
+
+void free(void *buffer)
+{
+    __libc_free(buffer);
+}
+
+} // extern "C"
+
+// SDK buffers are counted by the allocator below, it bypasses the heap count so they are not counted twice
+#define REPLAY_UNCOUNTED_MALLOC __libc_malloc
+#define REPLAY_UNCOUNTED_FREE __libc_free
+#else
+#define REPLAY_COUNT_HEAP_ALLOCATIONS 0
+#define REPLAY_UNCOUNTED_MALLOC malloc
+#define REPLAY_UNCOUNTED_FREE free
+#endif
+
+static uint8_t *counting_alloc(int size, void **context)
+{
+    *context = NULL;
+    if (g_counting.load(std::memory_order_relaxed))
+    {
+        g_buffer_allocation_count.fetch_add(1, std::memory_order_relaxed);
+    }
+    return (uint8_t *)REPLAY_UNCOUNTED_MALLOC((size_t)size);
+}
+
+static void counting_free(void *buffer, void *context)
+{
+    (void)context;
+    REPLAY_UNCOUNTED_FREE(buffer);
+}
+
+//************************ Streams *****************************
+
+struct allocation_parameters
+{
+    int test_number;
+    const char *test_name;
+    k4a_depth_mode_t depth_mode;
+    bool color;
+    bool imu;
+
+    // Most allocations allowed per measured frame
+    double buffer_allocations_per_frame;
+    double heap_allocations_per_frame;
+
+    friend std::ostream &operator<<(std::ostream &os, const allocation_parameters &obj)
+    {
+        return os << "test index: (" << obj.test_name << ") " << (int)obj.test_number;
+    }
+};
+
+// Pipeline under test, created for each test and torn down again so every test starts cold
+typedef struct _replay_pipeline_t
+{
+    calibration_t calibration;
+    capturesync_t capturesync;
+    depth_t depth;
+    imu_t imu;
+    TICK_COUNTER_HANDLE tick;
+
+    // Stand in for the USB and UVC buffer pools, which recycle payload buffers on a device
+    allocator_pool_t *depth_pool;
+    allocator_pool_t *color_pool;
+    allocator_pool_t *imu_pool;
+    size_t depth_payload_size;
+    uint64_t imu_pts;
+} replay_pipeline_t;
+
+static void replay_depth_capture_ready(k4a_result_t result, k4a_capture_t capture_handle, void *callback_context)
+{
+    replay_pipeline_t *pipeline = (replay_pipeline_t *)callback_context;
+    capturesync_add_capture(pipeline->capturesync, result, capture_handle, false);
+}
+
+static k4a_result_t replay_create_payload(allocator_pool_t *pool, size_t size, k4a_image_t *image)
+{
+    uint8_t *buffer = allocator_pool_alloc(pool, NULL);
+    if (buffer == NULL)
+    {
+        return K4A_RESULT_FAILED;
+    }
+    k4a_result_t result = image_create_empty_from_buffer_internal(buffer, size, allocator_pool_free, pool, image);
+    if (K4A_FAILED(result))
+    {
+        allocator_pool_free(buffer, pool);
+    }
+    return result;
+}
+
+static k4a_result_t replay_depth_frame(replay_pipeline_t *pipeline)
+{
+    k4a_image_t image = NULL;
+    k4a_result_t result = replay_create_payload(pipeline->depth_pool, pipeline->depth_payload_size, &image);
+    if (K4A_SUCCEEDED(result))
+    {
+        result = image_apply_system_timestamp(image);
+    }
+    if (K4A_SUCCEEDED(result))
+    {
+        result = K4A_RESULT_FROM_BOOL(replay_depth_payload_ready(image));
+    }
+    if (image)
+    {
+        image_dec_ref(image);
+    }
+    return result;
+}
+
+static k4a_result_t replay_color_frame(replay_pipeline_t *pipeline, int frame_index)
+{
+    k4a_capture_t capture = NULL;
+    k4a_image_t image = NULL;
+    k4a_result_t result = capture_create(&capture);
+    if (K4A_SUCCEEDED(result))
+    {
+        result = replay_create_payload(pipeline->color_pool, REPLAY_COLOR_PAYLOAD_SIZE, &image);
+    }
+    if (K4A_SUCCEEDED(result))
+    {
+        // Matches the device timestamp the fake depth engine gives the depth frame of the same index
+        image_set_device_timestamp_usec(image,
+                                        K4A_90K_HZ_TICK_TO_USEC((uint64_t)(frame_index + 1) * REPLAY_TICKS_PER_FRAME));
+        result = image_apply_system_timestamp(image);
+    }
+    if (K4A_SUCCEEDED(result))
+    {
+        capture_set_color_image(capture, image);
+        capturesync_add_capture(pipeline->capturesync, K4A_RESULT_SUCCEEDED, capture, true);
+    }
+    if (image)
+    {
+        image_dec_ref(image);
+    }
+    if (capture)
+    {
+        capture_dec_ref(capture);
+    }
+    return result;
+}
+
+static k4a_result_t replay_imu_payload(replay_pipeline_t *pipeline)
+{
+    k4a_image_t image = NULL;
+    k4a_result_t result = replay_create_payload(pipeline->imu_pool, IMU_MAX_PAYLOAD_SIZE, &image);
+    if (K4A_SUCCEEDED(result))
+    {
+        uint8_t *packet = image_get_buffer(image);
+        memset(packet, 0, IMU_MAX_PAYLOAD_SIZE);
+
+        imu_payload_metadata_t *metadata = (imu_payload_metadata_t *)packet;
+        metadata->gyro.sample_count = REPLAY_IMU_SAMPLES_PER_PAYLOAD;
+        metadata->accel.sample_count = REPLAY_IMU_SAMPLES_PER_PAYLOAD;
+
+        xyz_vector_t *gyro = (xyz_vector_t *)(packet + sizeof(imu_payload_metadata_t));
+        xyz_vector_t *accel = gyro + REPLAY_IMU_SAMPLES_PER_PAYLOAD;
+        for (int i = 0; i < REPLAY_IMU_SAMPLES_PER_PAYLOAD; i++)
+        {
+            // 1.6kHz samples on the 90kHz device clock
+            pipeline->imu_pts += 90000 / 1600;
+            gyro[i].pts = pipeline->imu_pts;
+            accel[i].pts = pipeline->imu_pts;
+        }
+        result = K4A_RESULT_FROM_BOOL(replay_imu_payload_ready(image));
+    }
+    if (image)
+    {
+        image_dec_ref(image);
+    }
+    return result;
+}
+
+//************************ Test *****************************
+
+class replay_allocations : public ::testing::Test, public ::testing::WithParamInterface<allocation_parameters>
+{
+public:
+    virtual void SetUp()
+    {
+        ASSERT_EQ(K4A_RESULT_SUCCEEDED, allocator_set_allocator(counting_alloc, counting_free));
+    }
+
+    virtual void TearDown()
+    {
+        g_counting = false;
+        destroy_pipeline();
+        allocator_set_allocator(NULL, NULL);
+        EXPECT_EQ(0, allocator_test_for_leaks());
+    }
+
+    void create_pipeline(const allocation_parameters &as);
+    void destroy_pipeline();
+    void replay_frame(const allocation_parameters &as, int frame_index);
+
+    replay_pipeline_t m_pipeline = {};
+};
+
+void replay_allocations::create_pipeline(const allocation_parameters &as)
+{
+    k4a_device_configuration_t config = K4A_DEVICE_CONFIG_INIT_DISABLE_ALL;
+    config.depth_mode = as.depth_mode;
+    config.camera_fps = K4A_FRAMES_PER_SECOND_30;
+    if (as.color)
+    {
+        config.color_format = K4A_IMAGE_FORMAT_COLOR_MJPG;
+        config.color_resolution = K4A_COLOR_RESOLUTION_1080P;
+        config.synchronized_images_only = as.depth_mode != K4A_DEPTH_MODE_OFF;
+    }
+
+    m_pipeline.depth_payload_size = as.depth_mode == K4A_DEPTH_MODE_WFOV_2X2BINNED ?
+                                        SENSOR_MODE_QUARTER_MEGA_PIXEL_PAYLOAD_SIZE :
+                                        SENSOR_MODE_LONG_THROW_NATIVE_PAYLOAD_SIZE;
+
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, calibration_create(FAKE_MCU, &m_pipeline.calibration));
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, capturesync_create(&m_pipeline.capturesync));
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, capturesync_start(m_pipeline.capturesync, &config, &K4A_DEVICE_START_OPTIONS_INIT));
+
+    if (as.depth_mode != K4A_DEPTH_MODE_OFF)
+    {
+        m_pipeline.depth_pool = allocator_pool_create(NULL,
+                                                      ALLOCATION_SOURCE_USB_DEPTH,
+                                                      m_pipeline.depth_payload_size,
+                                                      REPLAY_POOL_BUFFERS);
+        ASSERT_NE(m_pipeline.depth_pool, (allocator_pool_t *)NULL);
+        ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+                  depth_create(FAKE_MCU,
+                               m_pipeline.calibration,
+                               replay_depth_capture_ready,
+                               &m_pipeline,
+                               &m_pipeline.depth));
+        ASSERT_EQ(K4A_RESULT_SUCCEEDED, depth_start(m_pipeline.depth, &config, &K4A_DEVICE_START_OPTIONS_INIT));
+    }
+
+    if (as.color)
+    {
+        m_pipeline.color_pool = allocator_pool_create(NULL,
+                                                      ALLOCATION_SOURCE_COLOR,
+                                                      REPLAY_COLOR_PAYLOAD_SIZE,
+                                                      REPLAY_POOL_BUFFERS);
+        ASSERT_NE(m_pipeline.color_pool, (allocator_pool_t *)NULL);
+    }
+
+    if (as.imu)
+    {
+        m_pipeline.imu_pool = allocator_pool_create(NULL,
+                                                    ALLOCATION_SOURCE_USB_IMU,
+                                                    IMU_MAX_PAYLOAD_SIZE,
+                                                    REPLAY_POOL_BUFFERS);
+        ASSERT_NE(m_pipeline.imu_pool, (allocator_pool_t *)NULL);
+        m_pipeline.tick = tickcounter_create();
+        ASSERT_NE(m_pipeline.tick, (TICK_COUNTER_HANDLE)NULL);
+        ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+                  imu_create(m_pipeline.tick, FAKE_COLOR_MCU, m_pipeline.calibration, &m_pipeline.imu));
+        ASSERT_EQ(K4A_RESULT_SUCCEEDED, imu_start(m_pipeline.imu, 0));
+    }
+}
+
+void replay_allocations::destroy_pipeline()
+{
+    if (m_pipeline.imu)
+    {
+        imu_stop(m_pipeline.imu);
+        imu_destroy(m_pipeline.imu);
+    }
+    if (m_pipeline.tick)
+    {
+        tickcounter_destroy(m_pipeline.tick);
+    }
+    if (m_pipeline.depth)
+    {
+        depth_stop(m_pipeline.depth);
+    }
+    if (m_pipeline.capturesync)
+    {
+        capturesync_stop(m_pipeline.capturesync);
+    }
+    if (m_pipeline.depth)
+    {
+        depth_destroy(m_pipeline.depth);
+    }
+    if (m_pipeline.capturesync)
+    {
+        capturesync_destroy(m_pipeline.capturesync);
+    }
+    if (m_pipeline.calibration)
+    {
+        calibration_destroy(m_pipeline.calibration);
+    }
+    if (m_pipeline.depth_pool)
+    {
+        allocator_pool_close(m_pipeline.depth_pool);
+    }
+    if (m_pipeline.color_pool)
+    {
+        allocator_pool_close(m_pipeline.color_pool);
+    }
+    if (m_pipeline.imu_pool)
+    {
+        allocator_pool_close(m_pipeline.imu_pool);
+    }
+    m_pipeline = {};
+}
+
+// Pushes one frame through the pipeline and reads back everything it produced
+void replay_allocations::replay_frame(const allocation_parameters &as, int frame_index)
+{
+    if (as.depth_mode != K4A_DEPTH_MODE_OFF)
+    {
+        ASSERT_EQ(K4A_RESULT_SUCCEEDED, replay_depth_frame(&m_pipeline));
+    }
+    if (as.color)
+    {
+        ASSERT_EQ(K4A_RESULT_SUCCEEDED, replay_color_frame(&m_pipeline, frame_index));
+    }
+    if (as.depth_mode != K4A_DEPTH_MODE_OFF || as.color)
+    {
+        k4a_capture_t capture = NULL;
+        ASSERT_EQ(K4A_WAIT_RESULT_SUCCEEDED,
+                  capturesync_get_capture(m_pipeline.capturesync, &capture, REPLAY_READ_TIMEOUT_MS))
+            << "Frame " << frame_index;
+        capture_dec_ref(capture);
+    }
+    if (as.imu)
+    {
+        ASSERT_EQ(K4A_RESULT_SUCCEEDED, replay_imu_payload(&m_pipeline));
+        for (int i = 0; i < REPLAY_IMU_SAMPLES_PER_PAYLOAD; i++)
+        {
+            k4a_imu_sample_t sample;
+            ASSERT_EQ(K4A_WAIT_RESULT_SUCCEEDED, imu_get_sample(m_pipeline.imu, &sample, REPLAY_READ_TIMEOUT_MS));
+        }
+    }
+}
+
+TEST_P(replay_allocations, steady_state)
+{
+    auto as = GetParam();
+    ASSERT_NO_FATAL_FAILURE(create_pipeline(as));
+
+    for (int i = 0; i < g_warmup_frame_count; i++)
+    {
+        ASSERT_NO_FATAL_FAILURE(replay_frame(as, i));
+    }
+
+    g_heap_allocation_count = 0;
+    g_buffer_allocation_count = 0;
+    g_counting = true;
+    for (int i = g_warmup_frame_count; i < g_warmup_frame_count + g_frame_count; i++)
+    {
+        ASSERT_NO_FATAL_FAILURE(replay_frame(as, i));
+    }
+    g_counting = false;
+
+    double buffer_allocations_per_frame = (double)g_buffer_allocation_count / g_frame_count;
+    double heap_allocations_per_frame = (double)g_heap_allocation_count / g_frame_count;
+    printf("%s: %d frames after %d warm up frames\n", as.test_name, g_frame_count, g_warmup_frame_count);
+    printf("  buffer allocations per frame %.2f, limit %.2f\n",
+           buffer_allocations_per_frame,
+           as.buffer_allocations_per_frame);
+#if REPLAY_COUNT_HEAP_ALLOCATIONS
+    printf("  heap allocations per frame   %.2f, limit %.2f\n",
+           heap_allocations_per_frame,
+           as.heap_allocations_per_frame);
+#else
+    (void)heap_allocations_per_frame;
+    printf("  heap allocations are only counted with glibc\n");
+#endif
+
+    EXPECT_LE(buffer_allocations_per_frame, as.buffer_allocations_per_frame)
+        << "The streaming path allocates more SDK buffers per frame than it did";
+#if REPLAY_COUNT_HEAP_ALLOCATIONS
+    EXPECT_LE(heap_allocations_per_frame, as.heap_allocations_per_frame)
+        << "The streaming path makes more heap allocations per frame than it did";
+#endif
+}
+
+// clang-format off
+// Each payload image costs one heap allocation for its handle, depth frames add the depth and IR image handles and the
+// context that shares the depth engine output between them
+static struct allocation_parameters tests_streams[] = {
+    { 0, "DEPTH_NFOV_UNBINNED",         K4A_DEPTH_MODE_NFOV_UNBINNED,  false, false, 0.0, 4.0 },
+    { 1, "DEPTH_WFOV_2X2BINNED",        K4A_DEPTH_MODE_WFOV_2X2BINNED, false, false, 0.0, 4.0 },
+    { 2, "COLOR_MJPG_1080P",            K4A_DEPTH_MODE_OFF,            true,  false, 0.0, 1.0 },
+    { 3, "SYNCED_NFOV_UNBINNED_1080P",  K4A_DEPTH_MODE_NFOV_UNBINNED,  true,  false, 0.0, 5.0 },
+    { 4, "IMU",                         K4A_DEPTH_MODE_OFF,            false, true,  0.0, 1.0 },
+};
+// clang-format on
+
+INSTANTIATE_TEST_CASE_P(STREAMING, replay_allocations, ValuesIn(tests_streams));
+
+int main(int argc, char **argv)
+{
+    bool error = false;
+    k4a_unittest_init();
+
+    ::testing::InitGoogleTest(&argc, argv);
+
+    for (int i = 1; i < argc; ++i)
+    {
+        char *argument = argv[i];
+        if (strcmp(argument, "--frame_count") == 0 && i + 1 < argc)
+        {
+            g_frame_count = (int)strtol(argv[++i], NULL, 10);
+            error = error || g_frame_count <= 0;
+        }
+        else if (strcmp(argument, "--warmup_frame_count") == 0 && i + 1 < argc)
+        {
+            g_warmup_frame_count = (int)strtol(argv[++i], NULL, 10);
+            error = error || g_warmup_frame_count < 0;
+        }
+        else
+        {
+            error = true;
+        }
+    }
+
+    if (error)
+    {
+        printf("\n\nOptional Custom Test Settings:\n");
+        printf("  --frame_count <count>\n");
+        printf("      Number of frames allocations are counted over; default is 100\n");
+        printf("  --warmup_frame_count <count>\n");
+        printf("      Number of frames replayed before counting starts; default is 30\n");
+        return 1; // Indicates an error or warning
+    }
+
+    int results = RUN_ALL_TESTS();
+    k4a_unittest_deinit();
+    return results;
+}
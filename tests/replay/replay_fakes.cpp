@@ -0,0 +1,353 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+//************************ Includes *****************************
+#include "replay_fakes.h"
+
+#include <k4ainternal/deloader.h>
+#include <utcommon.h>
+#include <ut_calibration_data.h>
+
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+
+uint32_t g_depth_engine_usec = 0;
+
+//************************ Fake depth MCU *****************************
+
+static depthmcu_stream_cb_t *g_stream_callback = NULL;
+static void *g_stream_callback_context = NULL;
+
+extern "C" {
+
+k4a_buffer_result_t depthmcu_get_serialnum(depthmcu_t depthmcu_handle, char *serial_number, size_t *serial_number_size)
+{
+    (void)depthmcu_handle;
+    const char serial_num[] = "000000000000";
+    if (serial_number == NULL || *serial_number_size < sizeof(serial_num))
+    {
+        *serial_number_size = sizeof(serial_num);
+        return K4A_BUFFER_RESULT_TOO_SMALL;
+    }
+    memcpy(serial_number, serial_num, sizeof(serial_num));
+    *serial_number_size = sizeof(serial_num);
+    return K4A_BUFFER_RESULT_SUCCEEDED;
+}
+
+k4a_result_t depthmcu_get_version(depthmcu_t depthmcu_handle, depthmcu_firmware_versions_t *version)
+{
+    (void)depthmcu_handle;
+    memset(version, 0xFF, sizeof(depthmcu_firmware_versions_t));
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t depthmcu_depth_set_capture_mode(depthmcu_t depthmcu_handle, k4a_depth_mode_t capture_mode)
+{
+    (void)depthmcu_handle;
+    (void)capture_mode;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t depthmcu_depth_set_fps(depthmcu_t depthmcu_handle, k4a_fps_t capture_fps)
+{
+    (void)depthmcu_handle;
+    (void)capture_fps;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t depthmcu_depth_start_streaming(depthmcu_t depthmcu_handle,
+                                            depthmcu_stream_cb_t *callback,
+                                            void *callback_context)
+{
+    (void)depthmcu_handle;
+    g_stream_callback = callback;
+    g_stream_callback_context = callback_context;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+void depthmcu_depth_stop_streaming(depthmcu_t depthmcu_handle, bool quiet)
+{
+    (void)depthmcu_handle;
+    (void)quiet;
+    g_stream_callback = NULL;
+    g_stream_callback_context = NULL;
+}
+
+k4a_result_t depthmcu_depth_set_allocator(depthmcu_t depthmcu_handle, const allocator_hook_t *hook)
+{
+    (void)depthmcu_handle;
+    (void)hook;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t depthmcu_depth_set_prefault(depthmcu_t depthmcu_handle, bool prefault)
+{
+    (void)depthmcu_handle;
+    (void)prefault;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t depthmcu_depth_get_frame_size(depthmcu_t depthmcu_handle, size_t *frame_size)
+{
+    (void)depthmcu_handle;
+    *frame_size = 0; // No depth engine warm up, the replayed frames are not a mode's size
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t depthmcu_depth_get_pool_stats(depthmcu_t depthmcu_handle, usb_cmd_stream_pool_stats_t *stats)
+{
+    (void)depthmcu_handle;
+    memset(stats, 0, sizeof(*stats));
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t depthmcu_get_cal(depthmcu_t depthmcu_handle, uint8_t *calibration, size_t cal_size, size_t *bytes_read)
+{
+    (void)depthmcu_handle;
+    if (cal_size < REPLAY_CALIBRATION_SIZE)
+    {
+        return K4A_RESULT_FAILED;
+    }
+    memset(calibration, 0, REPLAY_CALIBRATION_SIZE);
+    *bytes_read = REPLAY_CALIBRATION_SIZE;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t
+depthmcu_get_extrinsic_calibration(depthmcu_t depthmcu_handle, char *json, size_t json_size, size_t *bytes_read)
+{
+    (void)depthmcu_handle;
+    if (json_size < sizeof(g_test_json))
+    {
+        return K4A_RESULT_FAILED;
+    }
+    memcpy(json, g_test_json, sizeof(g_test_json));
+    *bytes_read = sizeof(g_test_json);
+    return K4A_RESULT_SUCCEEDED;
+}
+
+bool depthmcu_wait_is_ready(depthmcu_t depthmcu_handle)
+{
+    (void)depthmcu_handle;
+    return true;
+}
+
+} // extern "C"
+
+bool replay_depth_payload_ready(k4a_image_t image)
+{
+    if (g_stream_callback == NULL)
+    {
+        return false;
+    }
+    g_stream_callback(K4A_RESULT_SUCCEEDED, image, g_stream_callback_context);
+    return true;
+}
+
+//************************ Fake color MCU *****************************
+
+static usb_cmd_stream_cb_t *g_imu_callback = NULL;
+static void *g_imu_callback_context = NULL;
+static bool g_imu_streaming = false;
+
+extern "C" {
+
+k4a_result_t colormcu_imu_register_stream_cb(colormcu_t colormcu_handle,
+                                             usb_cmd_stream_cb_t *capture_ready_cb,
+                                             void *context)
+{
+    (void)colormcu_handle;
+    g_imu_callback = capture_ready_cb;
+    g_imu_callback_context = context;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t colormcu_imu_start_streaming(colormcu_t colormcu_handle)
+{
+    (void)colormcu_handle;
+    g_imu_streaming = true;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+void colormcu_imu_stop_streaming(colormcu_t colormcu_handle)
+{
+    (void)colormcu_handle;
+    g_imu_streaming = false;
+}
+
+} // extern "C"
+
+bool replay_imu_payload_ready(k4a_image_t image)
+{
+    if (g_imu_callback == NULL || !g_imu_streaming)
+    {
+        return false;
+    }
+    g_imu_callback(K4A_RESULT_SUCCEEDED, image, g_imu_callback_context);
+    return true;
+}
+
+//************************ Fake depth engine *****************************
+
+struct k4a_depth_engine_context_t
+{
+    uint16_t width;
+    uint16_t height;
+    uint64_t frame_count;
+};
+
+extern "C" {
+
+k4a_depth_engine_result_code_t deloader_depth_engine_create_and_initialize(k4a_depth_engine_context_t **context,
+                                                                           size_t cal_block_size_in_bytes,
+                                                                           void *cal_block,
+                                                                           k4a_depth_engine_mode_t mode,
+                                                                           k4a_depth_engine_input_type_t input_format,
+                                                                           void *camera_calibration,
+                                                                           k4a_processing_complete_cb_t *callback,
+                                                                           void *callback_context)
+{
+    (void)cal_block_size_in_bytes;
+    (void)cal_block;
+    (void)input_format;
+    (void)camera_calibration;
+    (void)callback;
+    (void)callback_context;
+
+    k4a_depth_engine_context_t *engine = new k4a_depth_engine_context_t();
+    switch (mode)
+    {
+    case K4A_DEPTH_ENGINE_MODE_LT_SW_BINNING:
+        engine->width = 320;
+        engine->height = 288;
+        break;
+    case K4A_DEPTH_ENGINE_MODE_LT_NATIVE:
+        engine->width = 640;
+        engine->height = 576;
+        break;
+    case K4A_DEPTH_ENGINE_MODE_QUARTER_MEGA_PIXEL:
+        engine->width = 512;
+        engine->height = 512;
+        break;
+    default:
+        engine->width = 1024;
+        engine->height = 1024;
+        break;
+    }
+    *context = engine;
+    return K4A_DEPTH_ENGINE_RESULT_SUCCEEDED;
+}
+
+k4a_depth_engine_result_code_t
+deloader_depth_engine_create_and_initialize_on_gpu(k4a_depth_engine_context_t **context,
+                                                   size_t cal_block_size_in_bytes,
+                                                   void *cal_block,
+                                                   k4a_depth_engine_mode_t mode,
+                                                   k4a_depth_engine_input_type_t input_format,
+                                                   void *camera_calibration,
+                                                   k4a_processing_complete_cb_t *callback,
+                                                   void *callback_context,
+                                                   uint32_t gpu_index)
+{
+    (void)gpu_index;
+    return deloader_depth_engine_create_and_initialize(context,
+                                                       cal_block_size_in_bytes,
+                                                       cal_block,
+                                                       mode,
+                                                       input_format,
+                                                       camera_calibration,
+                                                       callback,
+                                                       callback_context);
+}
+
+uint32_t deloader_depth_engine_get_gpu_count(void)
+{
+    return 0;
+}
+
+k4a_depth_engine_result_code_t
+deloader_depth_engine_process_frame(k4a_depth_engine_context_t *context,
+                                    void *input_frame,
+                                    size_t input_frame_size,
+                                    k4a_depth_engine_output_type_t output_type,
+                                    void *output_frame,
+                                    size_t output_frame_size,
+                                    k4a_depth_engine_output_frame_info_t *output_frame_info,
+                                    k4a_depth_engine_input_frame_info_t *input_frame_info)
+{
+    (void)output_type;
+    (void)input_frame_info;
+
+    // Touch the input and output like the real depth engine's upload and download would
+    memcpy(output_frame, input_frame, std::min(input_frame_size, output_frame_size));
+    if (g_depth_engine_usec != 0)
+    {
+        auto end = std::chrono::steady_clock::now() + std::chrono::microseconds(g_depth_engine_usec);
+        while (std::chrono::steady_clock::now() < end)
+        {
+        }
+    }
+
+    memset(output_frame_info, 0, sizeof(*output_frame_info));
+    output_frame_info->output_width = context->width;
+    output_frame_info->output_height = context->height;
+    output_frame_info->center_of_exposure_in_ticks = ++context->frame_count * REPLAY_TICKS_PER_FRAME;
+    return K4A_DEPTH_ENGINE_RESULT_SUCCEEDED;
+}
+
+size_t deloader_depth_engine_get_output_frame_size(k4a_depth_engine_context_t *context)
+{
+    // Depth and IR images
+    return (size_t)context->width * context->height * sizeof(uint16_t) * 2;
+}
+
+size_t deloader_depth_engine_get_output_frame_size_for_type(k4a_depth_engine_context_t *context,
+                                                            k4a_depth_engine_output_type_t output_type)
+{
+    (void)context;
+    (void)output_type;
+    return 0;
+}
+
+bool deloader_depth_engine_supports_submit(void)
+{
+    return false;
+}
+
+k4a_depth_engine_result_code_t deloader_depth_engine_submit_frame(k4a_depth_engine_context_t *context,
+                                                                  void *input_frame,
+                                                                  size_t input_frame_size,
+                                                                  k4a_depth_engine_output_type_t output_type,
+                                                                  void *output_frame,
+                                                                  size_t output_frame_size,
+                                                                  void *frame_context)
+{
+    (void)context;
+    (void)input_frame;
+    (void)input_frame_size;
+    (void)output_type;
+    (void)output_frame;
+    (void)output_frame_size;
+    (void)frame_context;
+    return K4A_DEPTH_ENGINE_RESULT_FATAL_ERROR_ENGINE_NOT_LOADED;
+}
+
+k4a_depth_engine_result_code_t
+deloader_depth_engine_complete_frame(k4a_depth_engine_context_t *context,
+                                     void **frame_context,
+                                     k4a_depth_engine_output_frame_info_t *output_frame_info)
+{
+    (void)context;
+    (void)frame_context;
+    (void)output_frame_info;
+    return K4A_DEPTH_ENGINE_RESULT_FATAL_ERROR_ENGINE_NOT_LOADED;
+}
+
+void deloader_depth_engine_destroy(k4a_depth_engine_context_t **context)
+{
+    delete *context;
+    *context = NULL;
+}
+
+} // extern "C"
@@ -0,0 +1,32 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef REPLAY_FAKES_H
+#define REPLAY_FAKES_H
+
+// Fakes of the device layers below the SDK's streaming pipeline, shared by the replay tests. Linking replay_fakes.cpp
+// replaces the depth MCU, the IMU functions of the color MCU and the depth engine loader, so payloads can be pushed
+// through the real depth, dewrapper, capturesync and IMU modules without a device.
+
+#include <k4ainternal/color_mcu.h>
+#include <k4ainternal/depth_mcu.h>
+
+#define FAKE_MCU ((depthmcu_t)0xface000)
+#define FAKE_COLOR_MCU ((colormcu_t)0xface100)
+#define REPLAY_CALIBRATION_SIZE 1024
+
+// Ticks of the 90kHz device clock between frames at 30 FPS
+#define REPLAY_TICKS_PER_FRAME (90000 / 30)
+
+// Time the fake depth engine spends on each frame
+extern uint32_t g_depth_engine_usec;
+
+// Hands a USB depth payload to the depth module, as the depth MCU does when a transfer completes. Returns false when
+// the depth stream is not running.
+bool replay_depth_payload_ready(k4a_image_t image);
+
+// Hands a USB IMU payload to the IMU module, as the color MCU does when a transfer completes. Returns false when no IMU
+// stream callback is registered or the IMU stream is not running.
+bool replay_imu_payload_ready(k4a_image_t image);
+
+#endif /* REPLAY_FAKES_H */
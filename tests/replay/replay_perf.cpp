@@ -0,0 +1,417 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// Replays depth and color payloads through the SDK's streaming pipeline without a device, so pipeline performance can
+// be measured in CI and on machines without an Azure Kinect.
+//
+// Depth payloads enter where the USB layer hands them to the depth module, depth_capture_available(), and flow through
+// the dewrapper and capturesync. The depth MCU and the depth engine plugin are replaced by the fakes in
+// replay_fakes.cpp: the fake depth engine copies the payload into its output and stamps a device timestamp, so what is
+// measured is the SDK's own overhead rather than the GPU. Color payloads enter at capturesync, since the color camera
+// is read through UVC or Media Foundation rather than the USB command layer.
+
+//************************ Includes *****************************
+#include <k4ainternal/allocator.h>
+#include <k4ainternal/calibration.h>
+#include <k4ainternal/capture.h>
+#include <k4ainternal/capturesync.h>
+#include <k4ainternal/common.h>
+#include <k4ainternal/depth.h>
+#include <k4ainternal/image.h>
+#include <k4ainternal/logging.h>
+#include <gtest/gtest.h>
+#include <utcommon.h>
+
+#include "depthcommands.h"
+#include "replay_fakes.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#define REPLAY_COLOR_PAYLOAD_SIZE (256 * 1024) // Roughly a 1080P MJPEG frame
+#define REPLAY_CAPTURE_TIMEOUT_MS 2000
+
+static int g_frame_count = 300;
+static std::string g_depth_payload_path;
+static std::string g_color_payload_path;
+
+typedef std::vector<std::vector<uint8_t>> payload_list_t;
+
+//************************ Measurements *****************************
+
+// Same clock as image_apply_system_timestamp()
+static uint64_t replay_get_system_time_nsec()
+{
+#ifdef _WIN32
+    LARGE_INTEGER qpc = { 0 }, freq = { 0 };
+    QueryPerformanceCounter(&qpc);
+    QueryPerformanceFrequency(&freq);
+    return (uint64_t)(qpc.QuadPart / freq.QuadPart * 1000000000 +
+                      qpc.QuadPart % freq.QuadPart * 1000000000 / freq.QuadPart);
+#else
+    struct timespec ts_time;
+    clock_gettime(CLOCK_MONOTONIC, &ts_time);
+    return (uint64_t)ts_time.tv_sec * 1000000000 + (uint64_t)ts_time.tv_nsec;
+#endif
+}
+
+// Latencies of the frames that reached one stage of the pipeline, from the time their payload was replayed
+class stage_latency
+{
+public:
+    explicit stage_latency(const char *name) : m_name(name) {}
+
+    void add_image(k4a_image_t image)
+    {
+        uint64_t now_nsec = replay_get_system_time_nsec();
+        uint64_t system_nsec = image_get_system_timestamp_nsec(image);
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_latency_usec.push_back(now_nsec > system_nsec ? (now_nsec - system_nsec) / 1000 : 0);
+    }
+
+    void report(double elapsed_seconds)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        std::sort(m_latency_usec.begin(), m_latency_usec.end());
+        size_t count = m_latency_usec.size();
+        printf("  %-22s %8zu %10.1f %10llu %10llu %10llu %10llu\n",
+               m_name,
+               count,
+               elapsed_seconds > 0 ? (double)count / elapsed_seconds : 0.0,
+               (unsigned long long)percentile(50),
+               (unsigned long long)percentile(90),
+               (unsigned long long)percentile(99),
+               (unsigned long long)(count == 0 ? 0 : m_latency_usec.back()));
+    }
+
+    size_t count()
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return m_latency_usec.size();
+    }
+
+private:
+    uint64_t percentile(size_t percent)
+    {
+        if (m_latency_usec.empty())
+        {
+            return 0;
+        }
+        return m_latency_usec[std::min(m_latency_usec.size() - 1, m_latency_usec.size() * percent / 100)];
+    }
+
+    const char *m_name;
+    std::mutex m_lock;
+    std::vector<uint64_t> m_latency_usec;
+};
+
+typedef struct _replay_context_t
+{
+    capturesync_t capturesync;
+    stage_latency *depth_engine_latency;
+} replay_context_t;
+
+static void replay_depth_capture_ready(k4a_result_t result, k4a_capture_t capture_handle, void *callback_context)
+{
+    replay_context_t *replay = (replay_context_t *)callback_context;
+    if (K4A_SUCCEEDED(result) && capture_handle != NULL)
+    {
+        k4a_image_t image = capture_get_depth_image(capture_handle);
+        if (image != NULL)
+        {
+            replay->depth_engine_latency->add_image(image);
+            image_dec_ref(image);
+        }
+    }
+    capturesync_add_capture(replay->capturesync, result, capture_handle, false);
+}
+
+//************************ Replay *****************************
+
+// Payload files hold records of a little endian uint32_t byte count followed by that many bytes of payload
+static bool load_payloads(const std::string &path, payload_list_t &payloads)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        printf("Failed to open %s\n", path.c_str());
+        return false;
+    }
+
+    uint8_t size_bytes[4];
+    while (file.read((char *)size_bytes, sizeof(size_bytes)))
+    {
+        uint32_t size = (uint32_t)size_bytes[0] | (uint32_t)size_bytes[1] << 8 | (uint32_t)size_bytes[2] << 16 |
+                        (uint32_t)size_bytes[3] << 24;
+        std::vector<uint8_t> payload(size);
+        if (size == 0 || !file.read((char *)payload.data(), size))
+        {
+            printf("%s is truncated or holds an empty payload\n", path.c_str());
+            return false;
+        }
+        payloads.push_back(std::move(payload));
+    }
+    return !payloads.empty();
+}
+
+// A payload of the right size is enough for the fake depth engine when no recording is given
+static bool get_payloads(const std::string &path, size_t synthetic_size, payload_list_t &payloads)
+{
+    if (!path.empty())
+    {
+        return load_payloads(path, payloads);
+    }
+
+    std::vector<uint8_t> payload(synthetic_size);
+    for (size_t i = 0; i < payload.size(); i++)
+    {
+        payload[i] = (uint8_t)(i * 7);
+    }
+    payloads.push_back(std::move(payload));
+    return true;
+}
+
+// Waits until frame_index is due, or returns straight away when not pacing
+static void replay_wait(bool paced, std::chrono::steady_clock::time_point start, int frame_index)
+{
+    if (paced)
+    {
+        std::this_thread::sleep_until(start + std::chrono::microseconds((int64_t)frame_index * 1000000 / 30));
+    }
+}
+
+static void replay_depth(const payload_list_t &payloads, bool paced, std::chrono::steady_clock::time_point start)
+{
+    for (int i = 0; i < g_frame_count; i++)
+    {
+        replay_wait(paced, start, i);
+
+        const std::vector<uint8_t> &payload = payloads[(size_t)i % payloads.size()];
+        k4a_image_t image = NULL;
+        ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+                  image_create_empty_internal(ALLOCATION_SOURCE_USB_DEPTH, payload.size(), &image));
+        memcpy(image_get_buffer(image), payload.data(), payload.size());
+        ASSERT_EQ(K4A_RESULT_SUCCEEDED, image_apply_system_timestamp(image));
+
+        ASSERT_TRUE(replay_depth_payload_ready(image));
+        image_dec_ref(image);
+    }
+}
+
+static void replay_color(capturesync_t capturesync,
+                         const payload_list_t &payloads,
+                         bool paced,
+                         std::chrono::steady_clock::time_point start)
+{
+    for (int i = 0; i < g_frame_count; i++)
+    {
+        replay_wait(paced, start, i);
+
+        const std::vector<uint8_t> &payload = payloads[(size_t)i % payloads.size()];
+        k4a_capture_t capture = NULL;
+        k4a_image_t image = NULL;
+        ASSERT_EQ(K4A_RESULT_SUCCEEDED, capture_create(&capture));
+        ASSERT_EQ(K4A_RESULT_SUCCEEDED, image_create_empty_internal(ALLOCATION_SOURCE_COLOR, payload.size(), &image));
+        memcpy(image_get_buffer(image), payload.data(), payload.size());
+
+        // Matches the device timestamp the fake depth engine gives depth frame i
+        image_set_device_timestamp_usec(image, K4A_90K_HZ_TICK_TO_USEC((uint64_t)(i + 1) * REPLAY_TICKS_PER_FRAME));
+        ASSERT_EQ(K4A_RESULT_SUCCEEDED, image_apply_system_timestamp(image));
+        capture_set_color_image(capture, image);
+        image_dec_ref(image);
+
+        capturesync_add_capture(capturesync, K4A_RESULT_SUCCEEDED, capture, true);
+        capture_dec_ref(capture);
+    }
+}
+
+static void read_captures(capturesync_t capturesync, size_t expected_count, stage_latency *capture_latency)
+{
+    while (capture_latency->count() < expected_count)
+    {
+        k4a_capture_t capture = NULL;
+        if (capturesync_get_capture(capturesync, &capture, REPLAY_CAPTURE_TIMEOUT_MS) != K4A_WAIT_RESULT_SUCCEEDED)
+        {
+            // Captures the pipeline dropped never arrive
+            return;
+        }
+
+        k4a_image_t image = capture_get_depth_image(capture);
+        if (image == NULL)
+        {
+            image = capture_get_color_image(capture);
+        }
+        if (image != NULL)
+        {
+            capture_latency->add_image(image);
+            image_dec_ref(image);
+        }
+        capture_dec_ref(capture);
+    }
+}
+
+static void replay_run(const char *test_name, k4a_depth_mode_t depth_mode, bool color, bool paced)
+{
+    size_t depth_payload_size = depth_mode == K4A_DEPTH_MODE_WFOV_2X2BINNED ?
+                                    SENSOR_MODE_QUARTER_MEGA_PIXEL_PAYLOAD_SIZE :
+                                    SENSOR_MODE_LONG_THROW_NATIVE_PAYLOAD_SIZE;
+    payload_list_t depth_payloads;
+    payload_list_t color_payloads;
+    ASSERT_TRUE(get_payloads(g_depth_payload_path, depth_payload_size, depth_payloads));
+    ASSERT_TRUE(get_payloads(g_color_payload_path, REPLAY_COLOR_PAYLOAD_SIZE, color_payloads));
+
+    k4a_device_configuration_t config = K4A_DEVICE_CONFIG_INIT_DISABLE_ALL;
+    config.depth_mode = depth_mode;
+    config.camera_fps = K4A_FRAMES_PER_SECOND_30;
+    if (color)
+    {
+        config.color_format = K4A_IMAGE_FORMAT_COLOR_MJPG;
+        config.color_resolution = K4A_COLOR_RESOLUTION_1080P;
+        config.synchronized_images_only = true;
+    }
+
+    stage_latency depth_engine_latency("depth engine output");
+    stage_latency capture_latency("capture delivered");
+    replay_context_t replay = { NULL, &depth_engine_latency };
+    calibration_t calibration = NULL;
+    depth_t depth = NULL;
+
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, calibration_create(FAKE_MCU, &calibration));
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, capturesync_create(&replay.capturesync));
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, depth_create(FAKE_MCU, calibration, replay_depth_capture_ready, &replay, &depth));
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, capturesync_start(replay.capturesync, &config, &K4A_DEVICE_START_OPTIONS_INIT));
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, depth_start(depth, &config, &K4A_DEVICE_START_OPTIONS_INIT));
+
+    k4a_allocator_stats_t depth_allocations_before = { 0 };
+    k4a_allocator_stats_t depth_allocations_after = { 0 };
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, allocator_get_stats(ALLOCATION_SOURCE_DEPTH, &depth_allocations_before));
+
+    auto start = std::chrono::steady_clock::now();
+    std::thread reader(read_captures, replay.capturesync, (size_t)g_frame_count, &capture_latency);
+    std::thread color_thread;
+    if (color)
+    {
+        color_thread = std::thread(replay_color, replay.capturesync, std::cref(color_payloads), paced, start);
+    }
+    replay_depth(depth_payloads, paced, start);
+    if (color_thread.joinable())
+    {
+        color_thread.join();
+    }
+    reader.join();
+    double elapsed_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, allocator_get_stats(ALLOCATION_SOURCE_DEPTH, &depth_allocations_after));
+
+    k4a_device_statistics_t statistics = { 0 };
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, depth_get_statistics(depth, &statistics));
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, capturesync_get_statistics(replay.capturesync, &statistics));
+
+    depth_stop(depth);
+    capturesync_stop(replay.capturesync);
+    depth_destroy(depth);
+    capturesync_destroy(replay.capturesync);
+    calibration_destroy(calibration);
+
+    printf("\n%s: %d frames, %s, %zu byte depth payloads\n",
+           test_name,
+           g_frame_count,
+           paced ? "paced at 30 FPS" : "unpaced",
+           depth_payloads[0].size());
+    printf("  %-22s %8s %10s %10s %10s %10s %10s\n", "stage", "frames", "fps", "p50 us", "p90 us", "p99 us", "max us");
+    depth_engine_latency.report(elapsed_seconds);
+    capture_latency.report(elapsed_seconds);
+    printf("  depth engine dropped %u, capturesync dropped %u, capture queue dropped %u\n",
+           statistics.depth_engine_dropped_count,
+           statistics.capturesync_dropped_count,
+           statistics.capture_queue_dropped_count);
+    printf("  depth allocations per frame %.2f\n",
+           (double)(depth_allocations_after.total_allocation_count - depth_allocations_before.total_allocation_count) /
+               g_frame_count);
+
+    ASSERT_GT(capture_latency.count(), 0u);
+    ASSERT_EQ(0, allocator_test_for_leaks());
+}
+
+TEST(replay_perf, depth_and_color_paced)
+{
+    replay_run("depth_and_color_paced", K4A_DEPTH_MODE_NFOV_UNBINNED, true, true);
+}
+
+TEST(replay_perf, depth_unpaced)
+{
+    replay_run("depth_unpaced", K4A_DEPTH_MODE_NFOV_UNBINNED, false, false);
+}
+
+TEST(replay_perf, depth_wfov_binned_unpaced)
+{
+    replay_run("depth_wfov_binned_unpaced", K4A_DEPTH_MODE_WFOV_2X2BINNED, false, false);
+}
+
+int main(int argc, char **argv)
+{
+    bool error = false;
+    k4a_unittest_init();
+
+    ::testing::InitGoogleTest(&argc, argv);
+
+    for (int i = 1; i < argc; ++i)
+    {
+        char *argument = argv[i];
+        if (strcmp(argument, "--frame_count") == 0 && i + 1 < argc)
+        {
+            g_frame_count = (int)strtol(argv[++i], NULL, 10);
+            error = error || g_frame_count <= 0;
+        }
+        else if (strcmp(argument, "--depth_engine_usec") == 0 && i + 1 < argc)
+        {
+            g_depth_engine_usec = (uint32_t)strtoul(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argument, "--depth_payload") == 0 && i + 1 < argc)
+        {
+            g_depth_payload_path = argv[++i];
+        }
+        else if (strcmp(argument, "--color_payload") == 0 && i + 1 < argc)
+        {
+            g_color_payload_path = argv[++i];
+        }
+        else
+        {
+            error = true;
+        }
+    }
+
+    if (error)
+    {
+        printf("\n\nOptional Custom Test Settings:\n");
+        printf("  --frame_count <count>\n");
+        printf("      Number of depth (and color) payloads each test replays; default is 300\n");
+        printf("  --depth_engine_usec <microseconds>\n");
+        printf("      Time the fake depth engine spends on each frame; default is 0\n");
+        printf("  --depth_payload <file>\n");
+        printf("      Raw depth USB payloads to replay, each a little endian uint32_t byte count\n");
+        printf("      followed by the payload. A synthetic payload is used by default.\n");
+        printf("  --color_payload <file>\n");
+        printf("      MJPEG color payloads to replay, in the same format as --depth_payload\n");
+        return 1; // Indicates an error or warning
+    }
+
+    int results = RUN_ALL_TESTS();
+    k4a_unittest_deinit();
+    return results;
+}
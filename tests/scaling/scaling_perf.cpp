@@ -0,0 +1,460 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// Measures how streaming scales with the number of devices on one host. Each test streams one depth and color mode
+// combination from 1, 2, ... N devices at once, optionally recording every device to its own file, and reports the
+// host CPU time and SDK memory per device along with each device's depth engine compute time, USB timeouts, drops and
+// the share of the expected frames that were delivered.
+//
+// The devices run standalone and the color camera streams MJPEG, the format recordings store without conversion.
+// Without a color and depth image in every capture, the yield counts depth or color captures instead of synchronized
+// ones.
+
+//************************ Includes *****************************
+#include <k4a/k4a.h>
+#include <k4arecord/record.h>
+#include <gtest/gtest.h>
+#include <utcommon.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#define SCALING_CAPTURE_TIMEOUT_MS 1000
+#define SCALING_MEMORY_SAMPLE_MS 100
+
+static uint32_t g_max_device_count = 0;
+static int g_warmup_seconds = 2;
+static int g_seconds = 5;
+static std::string g_record_directory = ".";
+static bool g_no_record = false;
+
+using ::testing::ValuesIn;
+
+struct scaling_parameters
+{
+    k4a_depth_mode_t depth_mode;
+    k4a_color_resolution_t color_resolution;
+    k4a_fps_t fps;
+    bool record;
+
+    friend std::ostream &operator<<(std::ostream &os, const scaling_parameters &obj)
+    {
+        return os << "depth mode " << (int)obj.depth_mode << ", color resolution " << (int)obj.color_resolution
+                  << (obj.record ? ", recording" : "");
+    }
+};
+
+//************************ Measurements *****************************
+
+// CPU time of the whole process, user and kernel
+static double scaling_get_process_cpu_seconds()
+{
+#ifdef _WIN32
+    FILETIME creation_time, exit_time, kernel_time, user_time;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation_time, &exit_time, &kernel_time, &user_time))
+    {
+        return 0;
+    }
+    ULARGE_INTEGER kernel = { { kernel_time.dwLowDateTime, kernel_time.dwHighDateTime } };
+    ULARGE_INTEGER user = { { user_time.dwLowDateTime, user_time.dwHighDateTime } };
+    return (double)(kernel.QuadPart + user.QuadPart) / 10000000.0; // 100 nanosecond units
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return 0;
+    }
+    return (double)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+           (double)(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000000.0;
+#endif
+}
+
+// Bytes of image, sample and USB transfer buffers the SDK currently holds across all allocation sources
+static uint64_t scaling_get_allocated_bytes()
+{
+    uint64_t allocated_bytes = 0;
+    for (int source = 0; source < K4A_ALLOCATION_SOURCE_COUNT; source++)
+    {
+        k4a_allocator_stats_t stats = { 0 };
+        if (K4A_SUCCEEDED(k4a_get_allocator_stats((k4a_allocation_source_t)source, &stats)))
+        {
+            allocated_bytes += stats.allocated_bytes;
+        }
+    }
+    return allocated_bytes;
+}
+
+static int scaling_get_fps(k4a_fps_t fps)
+{
+    switch (fps)
+    {
+    case K4A_FRAMES_PER_SECOND_5:
+        return 5;
+    case K4A_FRAMES_PER_SECOND_15:
+        return 15;
+    default:
+        return 30;
+    }
+}
+
+//************************ Streaming *****************************
+
+struct scaling_device
+{
+    k4a_device_t device = nullptr;
+    k4a_record_t recording = nullptr;
+    std::string recording_path;
+    std::thread reader;
+    uint64_t captures_read = 0;
+    uint32_t record_failures = 0;
+    k4a_device_statistics_t statistics_before = {};
+    k4a_device_statistics_t statistics_after = {};
+    k4a_depth_engine_gpu_statistics_t gpu_statistics = {};
+};
+
+// Reads captures as fast as the device produces them, so drops are the SDK's and not the reader's
+static void scaling_read_captures(scaling_device *device, const std::atomic<bool> *exit)
+{
+    while (!*exit)
+    {
+        k4a_capture_t capture = NULL;
+        if (k4a_device_get_capture(device->device, &capture, SCALING_CAPTURE_TIMEOUT_MS) != K4A_WAIT_RESULT_SUCCEEDED)
+        {
+            continue;
+        }
+
+        if (device->recording != nullptr && K4A_FAILED(k4a_record_write_capture(device->recording, capture)))
+        {
+            device->record_failures++;
+        }
+        device->captures_read++;
+        k4a_capture_release(capture);
+    }
+}
+
+// Synchronized captures when both cameras run, otherwise captures of the camera that runs
+static uint64_t scaling_get_yield_count(const k4a_device_configuration_t &config, const k4a_device_statistics_t &stats)
+{
+    if (config.depth_mode == K4A_DEPTH_MODE_OFF)
+    {
+        return stats.color_capture_count;
+    }
+    if (config.color_resolution == K4A_COLOR_RESOLUTION_OFF)
+    {
+        return stats.depth_capture_count;
+    }
+    return stats.synchronized_capture_count;
+}
+
+class scaling_perf : public ::testing::Test, public ::testing::WithParamInterface<scaling_parameters>
+{
+public:
+    virtual void SetUp()
+    {
+        m_installed_count = k4a_device_get_installed_count();
+        ASSERT_GT(m_installed_count, 0u) << "No devices installed\n";
+        if (g_max_device_count != 0)
+        {
+            m_installed_count = std::min(m_installed_count, g_max_device_count);
+        }
+    }
+
+    virtual void TearDown()
+    {
+        close_devices();
+    }
+
+    void close_devices()
+    {
+        for (scaling_device &device : m_devices)
+        {
+            if (device.device != nullptr)
+            {
+                k4a_device_stop_cameras(device.device);
+            }
+            if (device.recording != nullptr)
+            {
+                k4a_record_close(device.recording);
+                device.recording = nullptr;
+                remove(device.recording_path.c_str());
+                remove((device.recording_path + ".k4aidx").c_str());
+            }
+            if (device.device != nullptr)
+            {
+                k4a_device_close(device.device);
+                device.device = nullptr;
+            }
+        }
+        m_devices.clear();
+    }
+
+    void run(uint32_t device_count, const k4a_device_configuration_t &config, bool record);
+
+    uint32_t m_installed_count = 0;
+    std::vector<scaling_device> m_devices;
+};
+
+void scaling_perf::run(uint32_t device_count, const k4a_device_configuration_t &config, bool record)
+{
+    m_devices = std::vector<scaling_device>(device_count);
+    for (uint32_t i = 0; i < device_count; i++)
+    {
+        scaling_device &device = m_devices[i];
+        ASSERT_EQ(K4A_RESULT_SUCCEEDED, k4a_device_open(i, &device.device)) << "Couldn't open device " << i << "\n";
+        if (record)
+        {
+            device.recording_path = g_record_directory + "/scaling_perf_" + std::to_string(i) + ".mkv";
+            ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+                      k4a_record_create(device.recording_path.c_str(), device.device, config, &device.recording));
+            ASSERT_EQ(K4A_RESULT_SUCCEEDED, k4a_record_write_header(device.recording));
+        }
+    }
+
+    // Start every device before reading any, as an application streaming all of them would
+    for (scaling_device &device : m_devices)
+    {
+        ASSERT_EQ(K4A_RESULT_SUCCEEDED, k4a_device_start_cameras(device.device, &config));
+    }
+
+    std::atomic<bool> exit(false);
+    for (scaling_device &device : m_devices)
+    {
+        device.reader = std::thread(scaling_read_captures, &device, &exit);
+    }
+
+    std::this_thread::sleep_for(std::chrono::seconds(g_warmup_seconds));
+
+    for (scaling_device &device : m_devices)
+    {
+        k4a_device_get_statistics(device.device, &device.statistics_before);
+    }
+    double cpu_seconds_before = scaling_get_process_cpu_seconds();
+    auto start = std::chrono::steady_clock::now();
+    auto end = start + std::chrono::seconds(g_seconds);
+
+    uint64_t peak_allocated_bytes = 0;
+    uint64_t allocated_bytes_sum = 0;
+    uint64_t allocated_bytes_samples = 0;
+    while (std::chrono::steady_clock::now() < end)
+    {
+        uint64_t allocated_bytes = scaling_get_allocated_bytes();
+        peak_allocated_bytes = std::max(peak_allocated_bytes, allocated_bytes);
+        allocated_bytes_sum += allocated_bytes;
+        allocated_bytes_samples++;
+        std::this_thread::sleep_for(std::chrono::milliseconds(SCALING_MEMORY_SAMPLE_MS));
+    }
+
+    double elapsed_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double cpu_seconds = scaling_get_process_cpu_seconds() - cpu_seconds_before;
+    for (scaling_device &device : m_devices)
+    {
+        k4a_device_get_statistics(device.device, &device.statistics_after);
+        k4a_device_get_depth_engine_gpu_statistics(device.device, &device.gpu_statistics);
+    }
+
+    exit = true;
+    for (scaling_device &device : m_devices)
+    {
+        device.reader.join();
+    }
+
+    // Host wide measurements are shared evenly, the SDK runs the same threads and pools for every device
+    double expected_frames = elapsed_seconds * scaling_get_fps(config.camera_fps);
+    printf("  %7u %9.1f %9.1f %9.1f",
+           device_count,
+           100.0 * cpu_seconds / elapsed_seconds / device_count,
+           (double)allocated_bytes_sum / (allocated_bytes_samples == 0 ? 1 : allocated_bytes_samples) / device_count /
+               (1024 * 1024),
+           (double)peak_allocated_bytes / device_count / (1024 * 1024));
+
+    for (uint32_t i = 0; i < device_count; i++)
+    {
+        scaling_device &device = m_devices[i];
+        const k4a_device_statistics_t &before = device.statistics_before;
+        const k4a_device_statistics_t &after = device.statistics_after;
+        uint64_t yield_count = scaling_get_yield_count(config, after) - scaling_get_yield_count(config, before);
+        uint32_t dropped = (after.depth_engine_dropped_count - before.depth_engine_dropped_count) +
+                           (after.capturesync_dropped_count - before.capturesync_dropped_count) +
+                           (after.capture_queue_dropped_count - before.capture_queue_dropped_count);
+
+        // The compute times cover every frame since the device was opened
+        if (i > 0)
+        {
+            printf("%39s", ""); // Under the host wide columns
+        }
+        printf(" %6u %8u %8u %8d %8u %8u %8u %8u %7.1f\n",
+               i,
+               after.depth_engine_average_compute_time_ms,
+               after.depth_engine_p99_compute_time_ms,
+               device.gpu_statistics.gpu_index,
+               device.gpu_statistics.average_compute_time_ms,
+               after.usb_timeout_count - before.usb_timeout_count,
+               dropped,
+               device.record_failures,
+               expected_frames > 0 ? 100.0 * yield_count / expected_frames : 0.0);
+
+        EXPECT_GT(device.captures_read, 0u) << "Device " << i << " delivered no captures\n";
+        EXPECT_EQ(0u, device.record_failures) << "Device " << i << " failed to record captures\n";
+    }
+
+    close_devices();
+}
+
+TEST_P(scaling_perf, streaming)
+{
+    scaling_parameters parameters = GetParam();
+    if (parameters.record && g_no_record)
+    {
+        printf("Recording disabled by --no_record\n");
+        return;
+    }
+
+    k4a_device_configuration_t config = K4A_DEVICE_CONFIG_INIT_DISABLE_ALL;
+    config.depth_mode = parameters.depth_mode;
+    config.color_resolution = parameters.color_resolution;
+    config.color_format = K4A_IMAGE_FORMAT_COLOR_MJPG;
+    config.camera_fps = parameters.fps;
+
+    printf("\nDepth mode %d, color resolution %d, %d FPS%s, %d seconds\n",
+           (int)parameters.depth_mode,
+           (int)parameters.color_resolution,
+           scaling_get_fps(parameters.fps),
+           parameters.record ? ", recording" : "",
+           g_seconds);
+    printf("  %7s %9s %9s %9s %6s %8s %8s %8s %8s %8s %8s %8s %7s\n",
+           "devices",
+           "cpu %/dev",
+           "MB/dev",
+           "peak MB",
+           "device",
+           "de avg",
+           "de p99",
+           "gpu",
+           "gpu avg",
+           "usb t/o",
+           "dropped",
+           "rec err",
+           "yield %");
+
+    for (uint32_t device_count = 1; device_count <= m_installed_count; device_count++)
+    {
+        run(device_count, config, parameters.record);
+        if (HasFatalFailure())
+        {
+            return;
+        }
+    }
+}
+
+// Every combination of the depth modes and color resolutions, at the highest frame rate both support
+static std::vector<scaling_parameters> get_mode_combinations()
+{
+    const k4a_depth_mode_t depth_modes[] = { K4A_DEPTH_MODE_OFF,           K4A_DEPTH_MODE_NFOV_2X2BINNED,
+                                             K4A_DEPTH_MODE_NFOV_UNBINNED, K4A_DEPTH_MODE_WFOV_2X2BINNED,
+                                             K4A_DEPTH_MODE_WFOV_UNBINNED, K4A_DEPTH_MODE_PASSIVE_IR };
+    const k4a_color_resolution_t color_resolutions[] = { K4A_COLOR_RESOLUTION_OFF,   K4A_COLOR_RESOLUTION_720P,
+                                                         K4A_COLOR_RESOLUTION_1080P, K4A_COLOR_RESOLUTION_1440P,
+                                                         K4A_COLOR_RESOLUTION_1536P, K4A_COLOR_RESOLUTION_2160P,
+                                                         K4A_COLOR_RESOLUTION_3072P };
+
+    std::vector<scaling_parameters> combinations;
+    for (bool record : { false, true })
+    {
+        for (k4a_depth_mode_t depth_mode : depth_modes)
+        {
+            for (k4a_color_resolution_t color_resolution : color_resolutions)
+            {
+                if (depth_mode == K4A_DEPTH_MODE_OFF && color_resolution == K4A_COLOR_RESOLUTION_OFF)
+                {
+                    continue;
+                }
+                bool limited_to_15fps = depth_mode == K4A_DEPTH_MODE_WFOV_UNBINNED ||
+                                        color_resolution == K4A_COLOR_RESOLUTION_3072P;
+                combinations.push_back({ depth_mode,
+                                         color_resolution,
+                                         limited_to_15fps ? K4A_FRAMES_PER_SECOND_15 : K4A_FRAMES_PER_SECOND_30,
+                                         record });
+            }
+        }
+    }
+    return combinations;
+}
+
+INSTANTIATE_TEST_CASE_P(MODES, scaling_perf, ValuesIn(get_mode_combinations()));
+
+int main(int argc, char **argv)
+{
+    bool error = false;
+    k4a_unittest_init();
+
+    ::testing::InitGoogleTest(&argc, argv);
+
+    for (int i = 1; i < argc; ++i)
+    {
+        char *argument = argv[i];
+        if (strcmp(argument, "--device_count") == 0 && i + 1 < argc)
+        {
+            g_max_device_count = (uint32_t)strtoul(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argument, "--seconds") == 0 && i + 1 < argc)
+        {
+            g_seconds = (int)strtol(argv[++i], NULL, 10);
+            error = error || g_seconds <= 0;
+        }
+        else if (strcmp(argument, "--warmup_seconds") == 0 && i + 1 < argc)
+        {
+            g_warmup_seconds = (int)strtol(argv[++i], NULL, 10);
+            error = error || g_warmup_seconds < 0;
+        }
+        else if (strcmp(argument, "--record_directory") == 0 && i + 1 < argc)
+        {
+            g_record_directory = argv[++i];
+        }
+        else if (strcmp(argument, "--no_record") == 0)
+        {
+            g_no_record = true;
+        }
+        else
+        {
+            error = true;
+        }
+    }
+
+    if (error)
+    {
+        printf("\n\nOptional Custom Test Settings:\n");
+        printf("  --device_count <count>\n");
+        printf("      Largest number of devices to stream at once; default is every installed device\n");
+        printf("  --seconds <seconds>\n");
+        printf("      Time each device count is measured for; default is 5\n");
+        printf("  --warmup_seconds <seconds>\n");
+        printf("      Time the devices stream before measuring; default is 2\n");
+        printf("  --record_directory <directory>\n");
+        printf("      Where the recordings are written, they are deleted after each run; default is the\n");
+        printf("      current directory\n");
+        printf("  --no_record\n");
+        printf("      Only run the combinations that do not record\n");
+        printf("\nColumns: the CPU time and the average and peak SDK buffer memory of the process, divided\n");
+        printf("by the number of devices, then for each device its depth engine average and p99 compute time\n");
+        printf("in milliseconds, the GPU of its depth engine and that GPU's average compute time, USB timeouts,\n");
+        printf("dropped captures, failed recording writes and the percentage of the expected frames delivered.\n");
+        return 1; // Indicates an error or warning
+    }
+
+    int results = RUN_ALL_TESTS();
+    k4a_unittest_deinit();
+    return results;
+}
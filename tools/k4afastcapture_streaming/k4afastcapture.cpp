@@ -7,6 +7,9 @@
 
 using namespace k4afastcapture;
 
+#define WRITER_QUEUE_SIZE 8     // Captures waiting for the writer thread before live frames are dropped
+#define FRAME_RING_SLOT_COUNT 3 // Captures kept in the shared memory ring
+
 #ifdef _WIN32
 void VERIFY_HR(HRESULT hr)
 {
@@ -28,7 +31,9 @@ K4AFastCapture::K4AFastCapture() :
     m_streaming(true),
     m_device(NULL),
     m_capture(NULL),
-    m_deviceConfig(K4A_DEVICE_CONFIG_INIT_DISABLE_ALL)
+    m_deviceConfig(K4A_DEVICE_CONFIG_INIT_DISABLE_ALL),
+    m_writerStopping(false),
+    m_publishing(false)
 {
 
 #ifdef _WIN32
@@ -57,6 +62,7 @@ K4AFastCapture::K4AFastCapture() :
 
 K4AFastCapture::~K4AFastCapture()
 {
+    StopWriter();
 
     if (m_device != NULL)
     {
@@ -183,14 +189,28 @@ bool K4AFastCapture::Configure(const char *fileDirectory, int32_t exposureValue,
     return true;
 }
 
-void K4AFastCapture::Run(int streamingLength)
+#ifndef _WIN32
+bool K4AFastCapture::EnableSharedMemory(const char *name)
 {
-    std::string colorFileName;
-    std::string depthFileName;
-    k4a_image_t ir_image = NULL;
-    k4a_image_t depth_image = NULL;
-    k4a_image_t color_image = NULL;
+    k4a_calibration_t calibration;
+    if (K4A_RESULT_SUCCEEDED !=
+        k4a_device_get_calibration(m_device, m_deviceConfig.depth_mode, m_deviceConfig.color_resolution, &calibration))
+    {
+        std::cout << "[Streaming Service] Failed to get the calibration" << std::endl;
+        return false;
+    }
+    if (!m_frameRing.create(name, FRAME_RING_SLOT_COUNT, calibration))
+    {
+        return false;
+    }
+    m_publishing = true;
+    std::cout << "[Streaming Service] Publishing the captures to shared memory " << name << std::endl;
+    return true;
+}
+#endif
 
+void K4AFastCapture::Run(int streamingLength)
+{
     uint32_t camera_fps = k4a_convert_fps_to_uint(m_deviceConfig.camera_fps);
     uint32_t remainingFrames = UINT32_MAX;
     if (streamingLength >= 0)
@@ -205,18 +225,12 @@ void K4AFastCapture::Run(int streamingLength)
         return;
     }
     k4a_capture_release(m_capture);
+    m_writerThread = std::thread(&K4AFastCapture::RunWriter, this);
 
     int32_t timeout_ms = HZ_TO_PERIOD_MS(camera_fps);
     std::cout << "[Streaming Service] Streaming from sensors..." << std::endl;
     while (remainingFrames-- > 0 && m_streaming)
     {
-        depthFileName = m_depthFileDirectory;
-        depthFileName += std::to_string(m_frameRequestedNum);
-
-        colorFileName = m_colorFileDirectory;
-        colorFileName += std::to_string(m_frameRequestedNum);
-        colorFileName += ".jpg";
-
         // Get the capture
         switch (k4a_device_get_capture(m_device, &m_capture, timeout_ms))
         {
@@ -227,93 +241,194 @@ void K4AFastCapture::Run(int streamingLength)
             continue;
         case K4A_WAIT_RESULT_FAILED:
             std::cout << "[Streaming Service] Failed to get the capture" << std::endl;
+            StopWriter();
             return;
         }
 
-        // check the capture request signal from fastcapture_trigger app. Store the current capture to disk once the
-        // signal is received.
+        // check the capture request signal from fastcapture_trigger app. The current capture is stored to disk by the
+        // writer thread once the signal is received, so the loop keeps up with the sensors meanwhile.
 #ifdef _WIN32
         auto result = WaitForSingleObject(m_captureRequestedEvent.Get(), 0);
-        if (WAIT_OBJECT_0 == result)
+        bool store = WAIT_OBJECT_0 == result;
 #else
         auto result = sem_trywait(m_captureRequestedSem);
-        if (0 == result)
+        bool store = 0 == result;
 #endif
+        if (store || m_publishing)
         {
-            if (m_deviceConfig.depth_mode == K4A_DEPTH_MODE_PASSIVE_IR)
-            {
-                // for the passive IR mode, there is no depth image. Only IR image is available in the capture.
-                ir_image = k4a_capture_get_ir_image(m_capture);
-                assert(ir_image != NULL); // Because m_deviceConfig.synchronized_images_only == true
+            // The writer thread takes over the capture reference
+            QueueCapture(m_capture, store);
+        }
+        else
+        {
+            // release frame
+            k4a_capture_release(m_capture);
+        }
+        m_capture = NULL;
 
-                // Do work with the frames
-                // write captures to disk
+        // check if exit command is received from fastcapture_trigger app
 #ifdef _WIN32
-                depthFileName += ".png";
-                // On Windows, write the IR image to .png file.
-                // SavePcmToImage function encodes the pcm frame into lossless PNG format, which depends on Windows
-                // Imaging Component and it's only available on Windows.
-                SavePcmToImage(depthFileName.c_str(),
-                               m_pcmOutputHeight,
-                               m_pcmOutputWidth,
-                               k4a_image_get_buffer(ir_image),
-                               k4a_image_get_size(ir_image));
+        result = WaitForSingleObject(m_captureExitEvent.Get(), 0);
+        if (WAIT_OBJECT_0 == result)
 #else
-                // For other platforms, write IR image to .bin file.
-                depthFileName += ".bin";
-                WriteToFile(depthFileName.c_str(), k4a_image_get_buffer(ir_image), k4a_image_get_size(ir_image));
+        result = sem_trywait(m_captureExitSem);
+        if (0 == result)
 #endif
-            }
-            else
-            {
-                depth_image = k4a_capture_get_depth_image(m_capture);
-                assert(depth_image != NULL); // Because m_deviceConfig.synchronized_images_only == true
-
-                // write depth frame to .bin
-                depthFileName += ".bin";
-                WriteToFile(depthFileName.c_str(), k4a_image_get_buffer(depth_image), k4a_image_get_size(depth_image));
-            }
+        {
+            break;
+        }
+    }
+    StopWriter();
+    std::cout << "[Streaming Service] Exiting as requested..." << std::endl;
+    return;
+}
 
-            color_image = k4a_capture_get_color_image(m_capture);
-            assert(color_image != NULL); // Because m_deviceConfig.synchronized_images_only == true
+void K4AFastCapture::QueueCapture(k4a_capture_t capture, bool store)
+{
+    std::lock_guard<std::mutex> lock(m_writerLock);
+    if (!store && m_pendingCaptures.size() >= WRITER_QUEUE_SIZE)
+    {
+        // Live frames the writer can't keep up with are dropped, the requested ones never are
+        k4a_capture_release(capture);
+        return;
+    }
 
-            WriteToFile(colorFileName.c_str(), k4a_image_get_buffer(color_image), k4a_image_get_size(color_image));
+    PendingCapture pending = { capture, store, m_frameRequestedNum };
+    if (store)
+    {
+        m_frameRequestedNum++;
+    }
+    m_pendingCaptures.push_back(pending);
+    m_writerCondition.notify_one();
+}
 
-            m_frameRequestedNum++;
+// Handles what is still queued, then exits the writer thread
+void K4AFastCapture::StopWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_writerLock);
+        m_writerStopping = true;
+        m_writerCondition.notify_one();
+    }
+    if (m_writerThread.joinable())
+    {
+        m_writerThread.join();
+    }
+}
 
-#ifdef _WIN32
-            SetEvent(m_captureDoneEvent.Get());
-            ResetEvent(m_captureRequestedEvent.Get());
-#else
-            sem_post(m_captureDoneSem);
-#endif
+void K4AFastCapture::RunWriter()
+{
+    while (true)
+    {
+        PendingCapture pending;
+        {
+            std::unique_lock<std::mutex> lock(m_writerLock);
+            m_writerCondition.wait(lock, [this]() { return m_writerStopping || !m_pendingCaptures.empty(); });
+            if (m_pendingCaptures.empty())
+            {
+                return;
+            }
+            pending = m_pendingCaptures.front();
+            m_pendingCaptures.pop_front();
+        }
 
-            if (depth_image)
+#ifndef _WIN32
+        if (m_publishing)
+        {
+            // for the passive IR mode, the IR image takes the place of the depth image
+            k4a_image_t color_image = k4a_capture_get_color_image(pending.capture);
+            k4a_image_t depth_image = m_deviceConfig.depth_mode == K4A_DEPTH_MODE_PASSIVE_IR ?
+                                          k4a_capture_get_ir_image(pending.capture) :
+                                          k4a_capture_get_depth_image(pending.capture);
+            if (color_image != NULL && depth_image != NULL)
             {
-                k4a_image_release(depth_image);
+                m_frameRing.publish(color_image,
+                                    depth_image,
+                                    k4a_image_get_system_timestamp_nsec(depth_image) / 1000);
             }
-            if (color_image)
+            if (color_image != NULL)
             {
                 k4a_image_release(color_image);
             }
+            if (depth_image != NULL)
+            {
+                k4a_image_release(depth_image);
+            }
         }
-        // release frame
-        k4a_capture_release(m_capture);
+#endif
+        if (pending.store)
+        {
+            StoreCapture(pending.capture, pending.frameNumber);
+        }
+        k4a_capture_release(pending.capture);
+    }
+}
 
-        // check if exit command is received from fastcapture_trigger app
+// Writes a capture requested by fastcapture_trigger app to disk, then signals it is done
+void K4AFastCapture::StoreCapture(k4a_capture_t capture, int frameNumber)
+{
+    std::string depthFileName = m_depthFileDirectory;
+    depthFileName += std::to_string(frameNumber);
+
+    std::string colorFileName = m_colorFileDirectory;
+    colorFileName += std::to_string(frameNumber);
+    colorFileName += ".jpg";
+
+    k4a_image_t depth_image = NULL;
+    if (m_deviceConfig.depth_mode == K4A_DEPTH_MODE_PASSIVE_IR)
+    {
+        // for the passive IR mode, there is no depth image. Only IR image is available in the capture.
+        depth_image = k4a_capture_get_ir_image(capture);
+        assert(depth_image != NULL); // Because m_deviceConfig.synchronized_images_only == true
+
+        // Do work with the frames
+        // write captures to disk
 #ifdef _WIN32
-        result = WaitForSingleObject(m_captureExitEvent.Get(), 0);
-        if (WAIT_OBJECT_0 == result)
+        depthFileName += ".png";
+        // On Windows, write the IR image to .png file.
+        // SavePcmToImage function encodes the pcm frame into lossless PNG format, which depends on Windows
+        // Imaging Component and it's only available on Windows.
+        SavePcmToImage(depthFileName.c_str(),
+                       m_pcmOutputHeight,
+                       m_pcmOutputWidth,
+                       k4a_image_get_buffer(depth_image),
+                       k4a_image_get_size(depth_image));
 #else
-        result = sem_trywait(m_captureExitSem);
-        if (0 == result)
+        // For other platforms, write IR image to .bin file.
+        depthFileName += ".bin";
+        WriteToFile(depthFileName.c_str(), k4a_image_get_buffer(depth_image), k4a_image_get_size(depth_image));
 #endif
-        {
-            break;
-        }
     }
-    std::cout << "[Streaming Service] Exiting as requested..." << std::endl;
-    return;
+    else
+    {
+        depth_image = k4a_capture_get_depth_image(capture);
+        assert(depth_image != NULL); // Because m_deviceConfig.synchronized_images_only == true
+
+        // write depth frame to .bin
+        depthFileName += ".bin";
+        WriteToFile(depthFileName.c_str(), k4a_image_get_buffer(depth_image), k4a_image_get_size(depth_image));
+    }
+
+    k4a_image_t color_image = k4a_capture_get_color_image(capture);
+    assert(color_image != NULL); // Because m_deviceConfig.synchronized_images_only == true
+
+    WriteToFile(colorFileName.c_str(), k4a_image_get_buffer(color_image), k4a_image_get_size(color_image));
+
+#ifdef _WIN32
+    SetEvent(m_captureDoneEvent.Get());
+    ResetEvent(m_captureRequestedEvent.Get());
+#else
+    sem_post(m_captureDoneSem);
+#endif
+
+    if (depth_image)
+    {
+        k4a_image_release(depth_image);
+    }
+    if (color_image)
+    {
+        k4a_image_release(color_image);
+    }
 }
 
 void K4AFastCapture::Stop()
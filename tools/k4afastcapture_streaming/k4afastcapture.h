@@ -12,6 +12,10 @@
 
 #include <iostream>
 #include <fstream>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 
 #ifdef _WIN32
 #include <wincodec.h>
@@ -21,6 +25,7 @@
 #include <sys/stat.h>
 #include <semaphore.h>
 #include <unistd.h>
+#include "frame_ring.h"
 #endif
 
 namespace k4afastcapture
@@ -31,10 +36,26 @@ public:
     K4AFastCapture();
     ~K4AFastCapture();
     bool Configure(const char *filePathPrefix, int32_t exposureValue, int pcmShiftValue);
+#ifndef _WIN32
+    // Publishes every capture to the shared memory ring of the given name, in the layout of mrob_recorder's ring
+    bool EnableSharedMemory(const char *name);
+#endif
     void Run(int streamingLength);
     void Stop();
 
 private:
+    // A capture handed from the streaming loop to the writer thread, which owns the reference
+    struct PendingCapture
+    {
+        k4a_capture_t capture;
+        bool store; // Requested by fastcapture_trigger, written to disk
+        int frameNumber;
+    };
+
+    void QueueCapture(k4a_capture_t capture, bool store);
+    void StopWriter();
+    void RunWriter();
+    void StoreCapture(k4a_capture_t capture, int frameNumber);
     long WriteToFile(const char *fileName, void *buffer, size_t bufferSize);
 
     // SavePcmToImage function encodes the pcm frame into lossless PNG format, which depends on Windows Imaging
@@ -56,6 +77,16 @@ private:
     k4a_device_configuration_t m_deviceConfig;
     std::vector<char> m_pcmImg;
 
+    std::thread m_writerThread;
+    std::mutex m_writerLock;
+    std::condition_variable m_writerCondition;
+    std::deque<PendingCapture> m_pendingCaptures;
+    bool m_writerStopping;
+    bool m_publishing;
+#ifndef _WIN32
+    frame_ring_publisher m_frameRing;
+#endif
+
 #ifdef _WIN32
     Microsoft::WRL::Wrappers::Event m_captureRequestedEvent;
     Microsoft::WRL::Wrappers::Event m_captureDoneEvent;
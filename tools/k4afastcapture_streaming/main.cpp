@@ -58,6 +58,9 @@ void PrintBasicUsage()
                  "             [DirectoryPath_Options] [PcmShift_Options (default: 4)]\n"
                  "             [StreamingLength_Options (Limit the streaming to N seconds, default: 60)] \n"
                  "             [ExposureValue_Options (default: auto exposure)] \n"
+#ifndef _WIN32
+                 "             [SharedMemory_Options (publish every capture to the named shared memory ring)] \n"
+#endif
               << std::endl;
 
     std::cout << "Examples:" << std::endl;
@@ -66,6 +69,9 @@ void PrintBasicUsage()
                  "-ExposureValue -3 \n"
               << std::endl;
     std::cout << "       3 - fastcapture_streaming.exe -d C:\\data\\ -s 4 -l 60 -e -2 \n" << std::endl;
+#ifndef _WIN32
+    std::cout << "       4 - fastcapture_streaming.exe -d /data -SharedMemory /fastcapture_frames \n" << std::endl;
+#endif
     return;
 }
 int main(int argc, char *argv[])
@@ -76,6 +82,7 @@ int main(int argc, char *argv[])
     int streamingLength = 60; // the length of time for streaming from the sensors until automatically exit.
     int shiftValue = 4;
     int absoluteExposureValue = 0;
+    const char *sharedMemoryName = NULL;
 
     if (argc == 1)
     {
@@ -160,6 +167,18 @@ int main(int argc, char *argv[])
                            << std::endl;
             }
         }
+#ifndef _WIN32
+        else if ((0 == string_compare("-SharedMemory", argv[i])) || (0 == string_compare("-m", argv[i])))
+        {
+            i++;
+            if (i >= argc || argv[i][0] != '/')
+            {
+                std::cout << "The shared memory name should start with '/'" << std::endl;
+                return EINVAL;
+            }
+            sharedMemoryName = argv[i];
+        }
+#endif
     }
 
     // Handle the CTRL-C signal.
@@ -181,6 +200,13 @@ int main(int argc, char *argv[])
 
     if (Capturer.Configure(fileDirectory, absoluteExposureValue, shiftValue))
     {
+#ifndef _WIN32
+        if (sharedMemoryName != NULL && !Capturer.EnableSharedMemory(sharedMemoryName))
+        {
+            std::cout << "Configuration Failed." << std::endl;
+            return 1;
+        }
+#endif
         Capturer.Run(streamingLength);
     }
     else
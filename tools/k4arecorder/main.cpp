@@ -119,16 +119,20 @@ int main(int argc, char **argv)
     k4a_fps_t recording_rate = K4A_FRAMES_PER_SECOND_30;
     bool recording_rate_set = false;
     bool recording_imu_enabled = true;
+    bool recording_imu_full_rate = false;
     k4a_wired_sync_mode_t wired_sync_mode = K4A_WIRED_SYNC_MODE_STANDALONE;
     int32_t depth_delay_off_color_usec = 0;
+    bool recording_raw_depth = false;
     uint32_t subordinate_delay_off_master_usec = 0;
     int absoluteExposureValue = defaultExposureAuto;
     int gain = defaultGainAuto;
-    char *recording_filename;
+    char *recording_filename = NULL;
+    int stream_port = -1;
 
     CmdParser::OptionParser cmd_parser;
     cmd_parser.RegisterOption("-h|--help", "Prints this help", [&]() {
-        std::cout << "k4arecorder [options] output.mkv" << std::endl << std::endl;
+        std::cout << "k4arecorder [options] output.mkv" << std::endl;
+        std::cout << "k4arecorder [options] --stream PORT" << std::endl << std::endl;
         cmd_parser.PrintOptions();
         exit(0);
     });
@@ -141,6 +145,15 @@ int main(int argc, char **argv)
                                   if (device_index < 0 || device_index > 255)
                                       throw std::runtime_error("Device index must 0-255");
                               });
+    cmd_parser.RegisterOption("--stream",
+                              "Stream the recording over TCP to a client connecting on PORT instead of\n"
+                              "writing a file. Depth is sent RVL compressed and uncompressed color as MJPG.",
+                              1,
+                              [&](const std::vector<char *> &args) {
+                                  stream_port = std::stoi(args[0]);
+                                  if (stream_port < 1 || stream_port > 65535)
+                                      throw std::runtime_error("Stream port must be 1-65535");
+                              });
     cmd_parser.RegisterOption("-l|--record-length",
                               "Limit the recording to N seconds (default: infinite)",
                               1,
@@ -245,6 +258,10 @@ int main(int argc, char **argv)
                               [&](const std::vector<char *> &args) {
                                   depth_delay_off_color_usec = std::stoi(args[0]);
                               });
+    cmd_parser.RegisterOption("--raw-depth",
+                              "Record the raw depth payloads of the sensor instead of depth and IR images.\n"
+                              "The depth engine runs when the recording is played back.",
+                              [&]() { recording_raw_depth = true; });
     cmd_parser.RegisterOption("-r|--rate",
                               "Set the camera frame rate in Frames per Second\n"
                               "Default is the maximum rate supported by the camera modes.\n"
@@ -272,13 +289,19 @@ int main(int argc, char **argv)
                                   }
                               });
     cmd_parser.RegisterOption("--imu",
-                              "Set the IMU recording mode (ON, OFF, default: ON)",
+                              "Set the IMU recording mode (ON, FULL, OFF, default: ON)\n"
+                              "FULL also records the IMU while the cameras stall.",
                               1,
                               [&](const std::vector<char *> &args) {
                                   if (string_compare(args[0], "on") == 0)
                                   {
                                       recording_imu_enabled = true;
                                   }
+                                  else if (string_compare(args[0], "full") == 0)
+                                  {
+                                      recording_imu_enabled = true;
+                                      recording_imu_full_rate = true;
+                                  }
                                   else if (string_compare(args[0], "off") == 0)
                                   {
                                       recording_imu_enabled = false;
@@ -368,13 +391,14 @@ int main(int argc, char **argv)
         std::cerr << e.option() << ": " << e.what() << std::endl;
         return 1;
     }
-    if (args_left == 1)
+    if (args_left == 1 && stream_port < 0)
     {
         recording_filename = argv[argc - 1];
     }
-    else
+    else if (args_left != 0 || stream_port < 0)
     {
-        std::cout << "k4arecorder [options] output.mkv" << std::endl << std::endl;
+        std::cout << "k4arecorder [options] output.mkv" << std::endl;
+        std::cout << "k4arecorder [options] --stream PORT" << std::endl << std::endl;
         cmd_parser.PrintOptions();
         return 0;
     }
@@ -427,11 +451,17 @@ int main(int argc, char **argv)
     device_config.depth_delay_off_color_usec = depth_delay_off_color_usec;
     device_config.subordinate_delay_off_master_usec = subordinate_delay_off_master_usec;
 
+    k4a_device_start_options_t start_options = K4A_DEVICE_START_OPTIONS_INIT;
+    start_options.raw_depth_payload = recording_raw_depth;
+
     return do_recording((uint8_t)device_index,
                         recording_filename,
+                        stream_port,
                         recording_length,
                         &device_config,
+                        &start_options,
                         recording_imu_enabled,
+                        recording_imu_full_rate,
                         absoluteExposureValue,
                         gain);
 }
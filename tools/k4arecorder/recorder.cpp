@@ -7,10 +7,19 @@
 #include <atomic>
 #include <iostream>
 #include <algorithm>
+#include <thread>
 
 #include <k4a/k4a.h>
 #include <k4arecord/record.h>
 
+#define IMU_WAIT_TIMEOUT_MS 100
+
+// Write options of streamed recordings, see set_stream_options()
+#define STREAM_COLOR_QUALITY 90
+#define STREAM_CLUSTER_LENGTH_USEC 16000
+#define STREAM_WRITE_DELAY_USEC 100000
+#define STREAM_MAX_PENDING_BYTES (256 * 1024 * 1024)
+
 using namespace std::chrono;
 
 inline static uint32_t k4a_convert_fps_to_uint(k4a_fps_t fps)
@@ -48,11 +57,43 @@ inline static uint32_t k4a_convert_fps_to_uint(k4a_fps_t fps)
 
 std::atomic_bool exiting(false);
 
+// Compresses a streamed recording, and keeps its write queue short so the client sees the captures with little delay.
+// A client that can't keep up drops whole captures instead of holding back the device.
+static k4a_result_t set_stream_options(k4a_record_t recording, const k4a_device_configuration_t *device_config)
+{
+    if (device_config->depth_mode != K4A_DEPTH_MODE_OFF && device_config->depth_mode != K4A_DEPTH_MODE_PASSIVE_IR)
+    {
+        if (K4A_FAILED(k4a_record_set_depth_codec(recording, K4A_RECORD_DEPTH_CODEC_RVL)))
+        {
+            return K4A_RESULT_FAILED;
+        }
+    }
+
+    if (device_config->color_resolution != K4A_COLOR_RESOLUTION_OFF &&
+        device_config->color_format != K4A_IMAGE_FORMAT_COLOR_MJPG)
+    {
+        if (K4A_FAILED(k4a_record_set_color_codec(recording, K4A_RECORD_COLOR_CODEC_MJPG, STREAM_COLOR_QUALITY)))
+        {
+            return K4A_RESULT_FAILED;
+        }
+    }
+
+    k4a_record_write_options_t options = K4A_RECORD_WRITE_OPTIONS_INIT_DEFAULT;
+    options.cluster_length_usec = STREAM_CLUSTER_LENGTH_USEC;
+    options.write_delay_usec = STREAM_WRITE_DELAY_USEC;
+    options.max_pending_bytes = STREAM_MAX_PENDING_BYTES;
+    options.overflow_policy = K4A_RECORD_OVERFLOW_DROP_CAPTURE;
+    return k4a_record_set_write_options(recording, &options);
+}
+
 int do_recording(uint8_t device_index,
                  char *recording_filename,
+                 int stream_port,
                  int recording_length,
                  k4a_device_configuration_t *device_config,
+                 const k4a_device_start_options_t *start_options,
                  bool record_imu,
+                 bool record_imu_full_rate,
                  int32_t absoluteExposureValue,
                  int32_t gain)
 {
@@ -126,6 +167,23 @@ int do_recording(uint8_t device_index,
         }
     }
 
+    // The start options are set before the recording is created, it records raw depth payloads from them
+    CHECK(k4a_device_set_start_options(device, start_options), device);
+
+    k4a_record_t recording = NULL;
+    if (stream_port > 0)
+    {
+        // Wait for the client before starting the cameras, so the stream starts with fresh captures
+        std::cout << "Waiting for a client on port " << stream_port << std::endl;
+        if (K4A_FAILED(k4a_record_create_network((uint16_t)stream_port, device, *device_config, &recording)))
+        {
+            std::cerr << "Unable to stream the recording on port " << stream_port << std::endl;
+            k4a_device_close(device);
+            return 1;
+        }
+        CHECK(set_stream_options(recording, device_config), device);
+    }
+
     CHECK(k4a_device_start_cameras(device, device_config), device);
     if (record_imu)
     {
@@ -134,8 +192,7 @@ int do_recording(uint8_t device_index,
 
     std::cout << "Device started" << std::endl;
 
-    k4a_record_t recording;
-    if (K4A_FAILED(k4a_record_create(recording_filename, device, *device_config, &recording)))
+    if (recording == NULL && K4A_FAILED(k4a_record_create(recording_filename, device, *device_config, &recording)))
     {
         std::cerr << "Unable to create recording file: " << recording_filename << std::endl;
         return 1;
@@ -192,6 +249,49 @@ int do_recording(uint8_t device_index,
 
     steady_clock::time_point recording_start = steady_clock::now();
     int32_t timeout_ms = 1000 / camera_fps;
+
+    // IMU samples are written from a thread of their own, so they don't wait on the camera rate or on writing captures.
+    // The recording serializes the writes of both threads.
+    std::atomic_bool capture_loop_done(false);
+    std::atomic_bool imu_failed(false);
+    std::atomic<steady_clock::rep> last_capture_time(recording_start.time_since_epoch().count());
+    std::thread imu_thread;
+    if (record_imu)
+    {
+        imu_thread = std::thread([&]() {
+            while (!capture_loop_done)
+            {
+                k4a_imu_sample_t sample;
+                k4a_wait_result_t imu_result = k4a_device_get_imu_sample(device, &sample, IMU_WAIT_TIMEOUT_MS);
+                if (imu_result == K4A_WAIT_RESULT_TIMEOUT)
+                {
+                    continue;
+                }
+                else if (imu_result != K4A_WAIT_RESULT_SUCCEEDED)
+                {
+                    std::cerr << "Runtime error: k4a_imu_get_sample() returned " << imu_result << std::endl;
+                    imu_failed = true;
+                    break;
+                }
+
+                // Samples are expected within a second of the most recent capture, so unless the IMU is recorded at
+                // full rate, the samples read while the cameras stall are dropped.
+                steady_clock::time_point last_capture{ steady_clock::duration(last_capture_time.load()) };
+                if (!record_imu_full_rate && steady_clock::now() - last_capture > seconds(1))
+                {
+                    continue;
+                }
+
+                k4a_result_t write_result = k4a_record_write_imu_sample(recording, sample);
+                if (K4A_FAILED(write_result))
+                {
+                    std::cerr << "Runtime error: k4a_record_write_imu_sample() returned " << write_result << std::endl;
+                }
+            }
+        });
+    }
+
+    bool write_failed = false;
     do
     {
         result = k4a_device_get_capture(device, &capture, timeout_ms);
@@ -204,36 +304,24 @@ int do_recording(uint8_t device_index,
             std::cerr << "Runtime error: k4a_device_get_capture() returned " << result << std::endl;
             break;
         }
-        CHECK(k4a_record_write_capture(recording, capture), device);
+        last_capture_time = steady_clock::now().time_since_epoch().count();
+        k4a_result_t write_result = k4a_record_write_capture(recording, capture);
         k4a_capture_release(capture);
-
-        if (record_imu)
+        if (K4A_FAILED(write_result))
         {
-            do
-            {
-                k4a_imu_sample_t sample;
-                result = k4a_device_get_imu_sample(device, &sample, 0);
-                if (result == K4A_WAIT_RESULT_TIMEOUT)
-                {
-                    break;
-                }
-                else if (result != K4A_WAIT_RESULT_SUCCEEDED)
-                {
-                    std::cerr << "Runtime error: k4a_imu_get_sample() returned " << result << std::endl;
-                    break;
-                }
-                k4a_result_t write_result = k4a_record_write_imu_sample(recording, sample);
-                if (K4A_FAILED(write_result))
-                {
-                    std::cerr << "Runtime error: k4a_record_write_imu_sample() returned " << write_result << std::endl;
-                    break;
-                }
-            } while (!exiting && result != K4A_WAIT_RESULT_FAILED &&
-                     (recording_length < 0 || (steady_clock::now() - recording_start < recording_length_seconds)));
+            std::cerr << "Runtime error: k4a_record_write_capture() returned " << write_result << std::endl;
+            write_failed = true;
+            break;
         }
-    } while (!exiting && result != K4A_WAIT_RESULT_FAILED &&
+    } while (!exiting && !imu_failed && result != K4A_WAIT_RESULT_FAILED &&
              (recording_length < 0 || (steady_clock::now() - recording_start < recording_length_seconds)));
 
+    capture_loop_done = true;
+    if (imu_thread.joinable())
+    {
+        imu_thread.join();
+    }
+
     if (!exiting)
     {
         exiting = true;
@@ -254,5 +342,5 @@ int do_recording(uint8_t device_index,
 
     k4a_device_close(device);
 
-    return 0;
+    return write_failed ? 1 : 0;
 }
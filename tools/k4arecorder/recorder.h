@@ -14,9 +14,12 @@ static const int32_t defaultGainAuto = -1;
 
 int do_recording(uint8_t device_index,
                  char *recording_filename,
+                 int stream_port,
                  int recording_length,
                  k4a_device_configuration_t *device_config,
+                 const k4a_device_start_options_t *start_options,
                  bool record_imu,
+                 bool record_imu_full_rate,
                  int32_t absoluteExposureValue,
                  int32_t gain);
 
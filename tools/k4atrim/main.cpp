@@ -0,0 +1,77 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <k4a/k4a.h>
+#include <k4arecord/playback.h>
+
+// Parses a number of seconds into microseconds, returns false if str isn't a positive number of seconds
+static bool parse_seconds(const char *str, uint64_t *usec)
+{
+    char *end = NULL;
+    double seconds = strtod(str, &end);
+    if (end == str || *end != '\0' || !(seconds >= 0) || seconds > (double)(UINT64_MAX / 1000000))
+    {
+        return false;
+    }
+    *usec = (uint64_t)(seconds * 1000000);
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 4 || argc > 5)
+    {
+        printf("Usage: k4atrim input.mkv output.mkv start_seconds [end_seconds]\n");
+        printf("Writes the part of the recording between start_seconds and end_seconds, from the start of the\n");
+        printf("recording, to output.mkv. The recording is copied without decoding it. Without end_seconds, the\n");
+        printf("recording is copied to its end.\n");
+        return 1;
+    }
+
+    uint64_t start_usec = 0;
+    uint64_t end_usec = UINT64_MAX;
+    if (!parse_seconds(argv[3], &start_usec) || (argc == 5 && !parse_seconds(argv[4], &end_usec)))
+    {
+        printf("Invalid timestamp, expected a number of seconds.\n");
+        return 1;
+    }
+    if (start_usec >= end_usec)
+    {
+        printf("The end of the range must be after its start.\n");
+        return 1;
+    }
+
+    char *filename = argv[1];
+    k4a_playback_t handle = NULL;
+    if (k4a_playback_open(filename, &handle) != K4A_RESULT_SUCCEEDED)
+    {
+        printf("Failed to open file: %s\n", filename);
+        return 1;
+    }
+
+    k4a_record_configuration_t record_config;
+    if (k4a_playback_get_record_configuration(handle, &record_config) != K4A_RESULT_SUCCEEDED)
+    {
+        printf("Failed to read the recording configuration: %s\n", filename);
+        k4a_playback_close(handle);
+        return 1;
+    }
+
+    // k4a_playback_trim() takes device timestamps
+    uint64_t start_offset_usec = record_config.start_timestamp_offset_usec;
+    start_usec += start_offset_usec;
+    end_usec = end_usec > UINT64_MAX - start_offset_usec ? UINT64_MAX : end_usec + start_offset_usec;
+
+    int exit_code = 0;
+    if (k4a_playback_trim(handle, argv[2], start_usec, end_usec) != K4A_RESULT_SUCCEEDED)
+    {
+        printf("Failed to trim %s to %s\n", filename, argv[2]);
+        exit_code = 1;
+    }
+
+    k4a_playback_close(handle);
+    return exit_code;
+}
@@ -30,14 +30,19 @@ layout(location=0, rgba32f) writeonly uniform image2D destTex;
 layout(location=1, r16ui) readonly uniform uimage2D depthImage;
 layout(location=2, rg32f) readonly uniform image2D xyTable;
 
+// Only every decimation'th pixel of every decimation'th row is converted
+//
+uniform int decimation;
+
 layout(local_size_x = 1, local_size_y = 1) in;
 
 void main()
 {
     ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 sourcePixel = pixel * decimation;
 
-    float vertexValue = float(imageLoad(depthImage, pixel));
-    vec2 xyValue = imageLoad(xyTable, pixel).xy;
+    float vertexValue = float(imageLoad(depthImage, sourcePixel));
+    vec2 xyValue = imageLoad(xyTable, sourcePixel).xy;
 
     float alpha = 1.0f;
     vec3 vertexPosition = vec3(vertexValue * xyValue.x, vertexValue * xyValue.y, vertexValue);
@@ -86,14 +91,21 @@ GpuDepthToPointCloudConverter::GpuDepthToPointCloudConverter()
     m_destTexId = glGetUniformLocation(m_shaderProgram.Id(), "destTex");
     m_xyTableId = glGetUniformLocation(m_shaderProgram.Id(), "xyTable");
     m_depthImageId = glGetUniformLocation(m_shaderProgram.Id(), "depthImage");
+    m_decimationId = glGetUniformLocation(m_shaderProgram.Id(), "decimation");
 }
 
-GLenum GpuDepthToPointCloudConverter::Convert(const k4a::image &depth, OpenGL::Texture *outputTexture)
+GLenum GpuDepthToPointCloudConverter::Convert(const k4a::image &depth,
+                                              OpenGL::Texture *outputTexture,
+                                              const int decimation)
 {
     if (!m_xyTableTexture)
     {
         throw std::logic_error("You must call SetActiveXyTable at least once before calling Convert!");
     }
+    if (decimation < 1)
+    {
+        throw std::logic_error("Point cloud decimation must be at least 1!");
+    }
 
     // Create output texture if it doesn't already exist
     //
@@ -105,12 +117,14 @@ GLenum GpuDepthToPointCloudConverter::Convert(const k4a::image &depth, OpenGL::T
     const int height = depth.get_height_pixels();
     if (!*outputTexture)
     {
+        const ImageDimensions outputDimensions = GetPointCloudDimensions(width, height, decimation);
+
         outputTexture->Init();
 
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, outputTexture->Id());
 
-        glTexStorage2D(GL_TEXTURE_2D, 1, PointCloudTextureFormat, width, height);
+        glTexStorage2D(GL_TEXTURE_2D, 1, PointCloudTextureFormat, outputDimensions.Width, outputDimensions.Height);
 
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -118,13 +132,11 @@ GLenum GpuDepthToPointCloudConverter::Convert(const k4a::image &depth, OpenGL::T
 
     // Upload data to our uniform texture
     //
-    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_depthImagePixelBuffer.Id());
     glBindTexture(GL_TEXTURE_2D, m_depthImageTexture.Id());
 
     const GLuint numBytes = static_cast<GLuint>(width * height) * sizeof(uint16_t);
 
-    GLubyte *textureMappedBuffer = reinterpret_cast<GLubyte *>(
-        glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, numBytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+    GLubyte *textureMappedBuffer = m_depthImagePixelBuffer.BeginWrite();
 
     if (!textureMappedBuffer)
     {
@@ -133,11 +145,14 @@ GLenum GpuDepthToPointCloudConverter::Convert(const k4a::image &depth, OpenGL::T
 
     const GLubyte *depthSrc = reinterpret_cast<const GLubyte *>(depth.get_buffer());
     std::copy(depthSrc, depthSrc + numBytes, textureMappedBuffer);
-    if (!glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER))
+    if (!m_depthImagePixelBuffer.EndWrite())
     {
         return glGetError();
     }
 
+    // The pixels are read from the pixel buffer, starting at the region we just wrote
+    //
+    const void *pixelData = reinterpret_cast<const void *>(m_depthImagePixelBuffer.CurrentOffset());
     glTexSubImage2D(GL_TEXTURE_2D,        // target
                     0,                    // level
                     0,                    // xoffset
@@ -146,7 +161,8 @@ GLenum GpuDepthToPointCloudConverter::Convert(const k4a::image &depth, OpenGL::T
                     height,               // height
                     depthImageDataFormat, // format
                     depthImageDataType,   // type
-                    nullptr);             // data
+                    pixelData);           // data
+    m_depthImagePixelBuffer.FenceCurrentRegion();
     glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
 
     glUseProgram(m_shaderProgram.Id());
@@ -167,9 +183,12 @@ GLenum GpuDepthToPointCloudConverter::Convert(const k4a::image &depth, OpenGL::T
     glBindImageTexture(2, m_xyTableTexture.Id(), 0, GL_FALSE, 0, GL_READ_ONLY, xyTableInternalFormat);
     glUniform1i(m_xyTableId, 2);
 
+    glUniform1i(m_decimationId, decimation);
+
     // Render point cloud
     //
-    glDispatchCompute(static_cast<GLuint>(depth.get_width_pixels()), static_cast<GLuint>(depth.get_height_pixels()), 1);
+    const ImageDimensions outputDimensions = GetPointCloudDimensions(width, height, decimation);
+    glDispatchCompute(static_cast<GLuint>(outputDimensions.Width), static_cast<GLuint>(outputDimensions.Height), 1);
 
     // Wait for the rendering to finish before allowing reads to the texture we just wrote
     //
@@ -207,12 +226,9 @@ GLenum GpuDepthToPointCloudConverter::SetActiveXyTable(const k4a::image &xyTable
     // reallocate on every frame
     //
     m_depthImageTexture.Init();
-    m_depthImagePixelBuffer.Init();
 
     const GLuint depthImageSizeBytes = static_cast<GLuint>(width * height) * sizeof(uint16_t);
-    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_depthImagePixelBuffer.Id());
-    glBufferData(GL_PIXEL_UNPACK_BUFFER, depthImageSizeBytes, nullptr, GL_STREAM_DRAW);
-    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    m_depthImagePixelBuffer.Init(GL_PIXEL_UNPACK_BUFFER, depthImageSizeBytes);
 
     glBindTexture(GL_TEXTURE_2D, m_depthImageTexture.Id());
 
@@ -225,6 +241,13 @@ GLenum GpuDepthToPointCloudConverter::SetActiveXyTable(const k4a::image &xyTable
     return status;
 }
 
+ImageDimensions GpuDepthToPointCloudConverter::GetPointCloudDimensions(const int width,
+                                                                      const int height,
+                                                                      const int decimation)
+{
+    return ImageDimensions((width + decimation - 1) / decimation, (height + decimation - 1) / decimation);
+}
+
 k4a::image GpuDepthToPointCloudConverter::GenerateXyTable(const k4a::calibration &calibration,
                                                           k4a_calibration_type_t calibrationType)
 {
@@ -14,7 +14,9 @@
 
 // Project headers
 //
+#include "k4aviewerimage.h"
 #include "openglhelpers.h"
+#include "openglstreamingbuffer.h"
 
 namespace k4aviewer
 {
@@ -54,10 +56,18 @@ public:
     // by other OpenGL shaders as an image2d uniform.
     //
     // To avoid excess image allocations, you can reuse a texture that was previously output
-    // by this function, provided the depth image and XY table previously used was for the same
-    // sized texture.
+    // by this function, provided the depth image, XY table and decimation previously used were
+    // for the same sized texture.
     //
-    GLenum Convert(const k4a::image &depth, OpenGL::Texture *texture);
+    // If decimation is greater than 1, only every decimation'th pixel of every decimation'th row
+    // is converted, and the output texture has the dimensions returned by GetPointCloudDimensions().
+    //
+    GLenum Convert(const k4a::image &depth, OpenGL::Texture *texture, int decimation = 1);
+
+    // Gets the dimensions of the point cloud texture Convert() outputs for a depth image of the
+    // given dimensions.
+    //
+    static ImageDimensions GetPointCloudDimensions(int width, int height, int decimation);
 
     // The format that the point cloud texture uses internally to store points.
     // If you want to use the texture that this outputs from your shader, you
@@ -75,11 +85,12 @@ private:
     GLint m_destTexId;
     GLint m_xyTableId;
     GLint m_depthImageId;
+    GLint m_decimationId;
 
     OpenGL::Texture m_depthImageTexture;
     OpenGL::Texture m_xyTableTexture;
 
-    OpenGL::Buffer m_depthImagePixelBuffer;
+    OpenGL::StreamingBuffer m_depthImagePixelBuffer;
 };
 } // namespace k4aviewer
 #endif
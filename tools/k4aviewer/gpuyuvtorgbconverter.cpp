@@ -0,0 +1,227 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// Associated header
+//
+#include "gpuyuvtorgbconverter.h"
+
+// System headers
+//
+#include <algorithm>
+
+// Library headers
+//
+
+// Project headers
+//
+#include "k4aviewerutil.h"
+
+using namespace k4aviewer;
+
+namespace
+{
+
+// Draws a single triangle that covers the whole framebuffer, without any vertex data
+//
+constexpr char const VertexShader[] =
+    R"(
+#version 330 core
+
+void main()
+{
+    vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+// Row 0 of the framebuffer is row 0 of the output texture, so source pixels map 1:1 to fragments.
+// Chroma is upsampled by taking the nearest sample, like libyuv and turbojpeg's fast upsampling do.
+//
+constexpr char const FragmentShader[] =
+    R"(
+#version 330 core
+
+out vec4 fragmentColor;
+
+uniform int sourceLayout;
+uniform bool fullRange;
+uniform ivec2 chromaSubsampling;
+uniform sampler2D plane0;
+uniform sampler2D plane1;
+uniform sampler2D plane2;
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+
+    float y;
+    vec2 uv;
+    if (sourceLayout == 0)
+    {
+        // NV12
+        y = texelFetch(plane0, pixel, 0).r;
+        uv = texelFetch(plane1, pixel / 2, 0).rg;
+    }
+    else if (sourceLayout == 1)
+    {
+        // YUY2, each texel is a Y0 U Y1 V chunk
+        vec4 chunk = texelFetch(plane0, ivec2(pixel.x / 2, pixel.y), 0);
+        y = (pixel.x % 2 == 0) ? chunk.r : chunk.b;
+        uv = chunk.ga;
+    }
+    else
+    {
+        // Planar
+        ivec2 chromaPixel = pixel / chromaSubsampling;
+        y = texelFetch(plane0, pixel, 0).r;
+        uv = vec2(texelFetch(plane1, chromaPixel, 0).r, texelFetch(plane2, chromaPixel, 0).r);
+    }
+
+    uv -= vec2(128.0 / 255.0);
+    vec3 rgb;
+    if (fullRange)
+    {
+        rgb = vec3(y + 1.402 * uv.y, y - 0.344136 * uv.x - 0.714136 * uv.y, y + 1.772 * uv.x);
+    }
+    else
+    {
+        y = 1.164 * (y - 16.0 / 255.0);
+        rgb = vec3(y + 1.596 * uv.y, y - 0.391 * uv.x - 0.813 * uv.y, y + 2.018 * uv.x);
+    }
+
+    fragmentColor = vec4(clamp(rgb, 0.0, 1.0), 1.0);
+}
+)";
+
+} // namespace
+
+GpuYuvToRgbConverter::GpuYuvToRgbConverter()
+{
+    OpenGL::Shader vertexShader(GL_VERTEX_SHADER, VertexShader);
+    OpenGL::Shader fragmentShader(GL_FRAGMENT_SHADER, FragmentShader);
+
+    m_shaderProgram.AttachShader(std::move(vertexShader));
+    m_shaderProgram.AttachShader(std::move(fragmentShader));
+    m_shaderProgram.Link();
+
+    m_sourceLayoutIndex = m_shaderProgram.GetUniformLocation("sourceLayout");
+    m_fullRangeIndex = m_shaderProgram.GetUniformLocation("fullRange");
+    m_chromaSubsamplingIndex = m_shaderProgram.GetUniformLocation("chromaSubsampling");
+    m_planeIndices[0] = m_shaderProgram.GetUniformLocation("plane0");
+    m_planeIndices[1] = m_shaderProgram.GetUniformLocation("plane1");
+    m_planeIndices[2] = m_shaderProgram.GetUniformLocation("plane2");
+}
+
+GLenum GpuYuvToRgbConverter::ConvertNV12(const uint8_t *data, ImageDimensions dimensions, K4AViewerImage *texture)
+{
+    const ImageDimensions chromaDimensions(dimensions.Width / 2, dimensions.Height / 2);
+    UploadPlane(0, data, dimensions, GL_R8, GL_RED);
+    UploadPlane(1, data + dimensions.Width * dimensions.Height, chromaDimensions, GL_RG8, GL_RG);
+    return Render(SourceLayout::NV12, false, ImageDimensions(2, 2), texture);
+}
+
+GLenum GpuYuvToRgbConverter::ConvertYUY2(const uint8_t *data, ImageDimensions dimensions, K4AViewerImage *texture)
+{
+    UploadPlane(0, data, ImageDimensions(dimensions.Width / 2, dimensions.Height), GL_RGBA8, GL_RGBA);
+    return Render(SourceLayout::YUY2, false, ImageDimensions(2, 1), texture);
+}
+
+GLenum GpuYuvToRgbConverter::ConvertPlanar(const std::array<const uint8_t *, 3> &planes,
+                                           ImageDimensions dimensions,
+                                           ImageDimensions chromaDimensions,
+                                           K4AViewerImage *texture)
+{
+    if (chromaDimensions.Width <= 0 || chromaDimensions.Height <= 0)
+    {
+        return GL_INVALID_VALUE;
+    }
+
+    UploadPlane(0, planes[0], dimensions, GL_R8, GL_RED);
+    UploadPlane(1, planes[1], chromaDimensions, GL_R8, GL_RED);
+    UploadPlane(2, planes[2], chromaDimensions, GL_R8, GL_RED);
+
+    // Plane sizes are rounded up, so the subsampling factor is the rounded-down ratio
+    //
+    const ImageDimensions chromaSubsampling(std::max(1, dimensions.Width / chromaDimensions.Width),
+                                            std::max(1, dimensions.Height / chromaDimensions.Height));
+    return Render(SourceLayout::Planar, true, chromaSubsampling, texture);
+}
+
+void GpuYuvToRgbConverter::UploadPlane(const size_t index,
+                                       const uint8_t *data,
+                                       const ImageDimensions dimensions,
+                                       const GLenum internalFormat,
+                                       const GLenum format)
+{
+    PlaneTexture &plane = m_planes[index];
+    if (!plane.Texture || plane.Dimensions.Width != dimensions.Width ||
+        plane.Dimensions.Height != dimensions.Height || plane.InternalFormat != internalFormat)
+    {
+        // Texture storage is immutable, so a plane of a different size needs a new texture
+        //
+        plane.Texture.Init();
+        plane.Dimensions = dimensions;
+        plane.InternalFormat = internalFormat;
+
+        glBindTexture(GL_TEXTURE_2D, plane.Texture.Id());
+        glTexStorage2D(GL_TEXTURE_2D, 1, internalFormat, dimensions.Width, dimensions.Height);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    }
+
+    glBindTexture(GL_TEXTURE_2D, plane.Texture.Id());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D,     // target
+                    0,                 // level
+                    0,                 // xoffset
+                    0,                 // yoffset
+                    dimensions.Width,  // width
+                    dimensions.Height, // height
+                    format,            // format
+                    GL_UNSIGNED_BYTE,  // type
+                    data);             // data
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+GLenum GpuYuvToRgbConverter::Render(const SourceLayout layout,
+                                    const bool fullRange,
+                                    const ImageDimensions chromaSubsampling,
+                                    K4AViewerImage *texture)
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, m_frameBuffer.Id());
+    CleanupGuard frameBufferBindingGuard([]() { glBindFramebuffer(GL_FRAMEBUFFER, 0); });
+
+    glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, static_cast<GLuint>(*texture), 0);
+    const GLenum drawBuffers = GL_COLOR_ATTACHMENT0;
+    glDrawBuffers(1, &drawBuffers);
+
+    const GLenum frameBufferStatus = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if (frameBufferStatus != GL_FRAMEBUFFER_COMPLETE)
+    {
+        return frameBufferStatus;
+    }
+
+    const ImageDimensions dimensions = texture->GetDimensions();
+    glViewport(0, 0, dimensions.Width, dimensions.Height);
+    glDisable(GL_BLEND);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_SCISSOR_TEST);
+
+    glUseProgram(m_shaderProgram.Id());
+    glUniform1i(m_sourceLayoutIndex, static_cast<GLint>(layout));
+    glUniform1i(m_fullRangeIndex, fullRange ? 1 : 0);
+    glUniform2i(m_chromaSubsamplingIndex, chromaSubsampling.Width, chromaSubsampling.Height);
+    for (size_t i = 0; i < m_planes.size(); ++i)
+    {
+        glActiveTexture(static_cast<GLenum>(GL_TEXTURE0 + i));
+        glBindTexture(GL_TEXTURE_2D, m_planes[i].Texture.Id());
+        glUniform1i(m_planeIndices[i], static_cast<GLint>(i));
+    }
+    glActiveTexture(GL_TEXTURE0);
+
+    glBindVertexArray(m_vertexArrayObject.Id());
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+
+    return glGetError();
+}
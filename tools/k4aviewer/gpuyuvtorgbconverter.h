@@ -0,0 +1,90 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef GPUYUVTORGBCONVERTER_H
+#define GPUYUVTORGBCONVERTER_H
+
+// System headers
+//
+#include <array>
+
+// Library headers
+//
+#include "k4aimgui_all.h"
+
+// Project headers
+//
+#include "k4aviewerimage.h"
+#include "openglhelpers.h"
+
+namespace k4aviewer
+{
+
+// Converts YUV color images to RGB on the GPU.  The planes of the source image are uploaded as-is
+// and a fragment shader renders the converted image straight into the texture of a K4AViewerImage,
+// so the CPU only copies the (much smaller) YUV data instead of converting every pixel.
+//
+// Must be created and used on the thread that owns the OpenGL context.  Throws std::logic_error if
+// the shaders can't be built, in which case callers should fall back to converting on the CPU.
+//
+class GpuYuvToRgbConverter
+{
+public:
+    GpuYuvToRgbConverter();
+    ~GpuYuvToRgbConverter() = default;
+
+    // NV12: a full-resolution Y plane followed by a half-resolution plane of interleaved U/V pairs.
+    // Uses the limited-range BT.601 coefficients, like libyuv.
+    //
+    GLenum ConvertNV12(const uint8_t *data, ImageDimensions dimensions, K4AViewerImage *texture);
+
+    // YUY2: packed Y0 U Y1 V chunks, each covering 2 pixels.
+    // Uses the limited-range BT.601 coefficients, like libyuv.
+    //
+    GLenum ConvertYUY2(const uint8_t *data, ImageDimensions dimensions, K4AViewerImage *texture);
+
+    // Three separate Y, U and V planes, as decoded from a JPEG by turbojpeg.  The U and V planes
+    // have chromaDimensions each.  JPEGs use the full-range BT.601 coefficients.
+    //
+    GLenum ConvertPlanar(const std::array<const uint8_t *, 3> &planes,
+                         ImageDimensions dimensions,
+                         ImageDimensions chromaDimensions,
+                         K4AViewerImage *texture);
+
+    GpuYuvToRgbConverter(GpuYuvToRgbConverter &) = delete;
+    GpuYuvToRgbConverter(GpuYuvToRgbConverter &&) = delete;
+    GpuYuvToRgbConverter &operator=(GpuYuvToRgbConverter &) = delete;
+    GpuYuvToRgbConverter &operator=(GpuYuvToRgbConverter &&) = delete;
+
+private:
+    enum class SourceLayout
+    {
+        NV12 = 0,
+        YUY2 = 1,
+        Planar = 2
+    };
+
+    struct PlaneTexture
+    {
+        OpenGL::Texture Texture;
+        ImageDimensions Dimensions = ImageDimensions(0, 0);
+        GLenum InternalFormat = GL_NONE;
+    };
+
+    void UploadPlane(size_t index, const uint8_t *data, ImageDimensions dimensions, GLenum internalFormat, GLenum format);
+    GLenum Render(SourceLayout layout, bool fullRange, ImageDimensions chromaSubsampling, K4AViewerImage *texture);
+
+    OpenGL::Program m_shaderProgram;
+    GLint m_sourceLayoutIndex;
+    GLint m_fullRangeIndex;
+    GLint m_chromaSubsamplingIndex;
+    std::array<GLint, 3> m_planeIndices;
+
+    OpenGL::VertexArray m_vertexArrayObject = OpenGL::VertexArray(true);
+    OpenGL::Framebuffer m_frameBuffer = OpenGL::Framebuffer(true);
+    std::array<PlaneTexture, 3> m_planes;
+};
+
+} // namespace k4aviewer
+
+#endif
@@ -46,6 +46,16 @@ public:
     //
     virtual ImageConversionResult ConvertImage(const k4a::image &srcImage, k4a::image *bgraImage) = 0;
 
+    // Updates texture with an image that ConvertImage() produced from srcImage.  Runs on the thread
+    // that owns the OpenGL context.  Converters that finish the conversion on the GPU override this,
+    // in which case bgraImage holds whatever intermediate data their ConvertImage() left in it.
+    //
+    virtual GLenum UpdateTexture(const k4a::image &srcImage, const k4a::image &bgraImage, K4AViewerImage *texture)
+    {
+        (void)srcImage;
+        return texture->UpdateTexture(bgraImage.get_buffer());
+    }
+
     virtual ~IK4AImageConverter() = default;
 
     IK4AImageConverter() = default;
@@ -0,0 +1,164 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// Associated header
+//
+#include "k4acolorcontrolqueue.h"
+
+// System headers
+//
+
+// Library headers
+//
+
+// Project headers
+//
+#include "k4aviewererrormanager.h"
+
+using namespace k4aviewer;
+
+K4AColorControlQueue::K4AColorControlQueue(k4a::device *device) : m_device(device)
+{
+    m_workerThread = std::thread(&K4AColorControlQueue::WorkerThread, this);
+}
+
+K4AColorControlQueue::~K4AColorControlQueue()
+{
+    // Let any queued writes finish so settings the user changed right before closing the device stick
+    //
+    Flush();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_shouldExit = true;
+    }
+    m_commandQueued.notify_one();
+    m_workerThread.join();
+}
+
+void K4AColorControlQueue::QueueWrite(const k4a_color_control_command_t command, const Setting setting)
+{
+    PendingCommand pendingCommand;
+    pendingCommand.Write = true;
+    pendingCommand.WriteSetting = setting;
+    QueueCommand(command, pendingCommand);
+}
+
+void K4AColorControlQueue::QueueRead(const k4a_color_control_command_t command)
+{
+    QueueCommand(command, PendingCommand());
+}
+
+void K4AColorControlQueue::QueueCommand(const k4a_color_control_command_t command,
+                                        const PendingCommand &pendingCommand)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        auto existingCommand = m_pendingCommands.find(command);
+        if (existingCommand == m_pendingCommands.end())
+        {
+            existingCommand = m_pendingCommands.emplace(command, PendingCommand()).first;
+            m_queueOrder.push_back(command);
+        }
+
+        // A read doesn't cancel a write that hasn't happened yet - the write reads the control back anyway
+        //
+        if (pendingCommand.Write)
+        {
+            existingCommand->second = pendingCommand;
+            existingCommand->second.WriteGeneration = ++m_writeGenerations[command];
+        }
+        else if (!existingCommand->second.Write)
+        {
+            existingCommand->second.WriteGeneration = m_writeGenerations[command];
+        }
+    }
+    m_commandQueued.notify_one();
+}
+
+void K4AColorControlQueue::Flush()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_commandsFinished.wait(lock, [this]() { return m_queueOrder.empty() && !m_commandInProgress; });
+}
+
+void K4AColorControlQueue::ProcessResults(const ResultFn &resultFn)
+{
+    std::map<k4a_color_control_command_t, Result> results;
+    std::vector<std::string> errors;
+    std::map<k4a_color_control_command_t, uint64_t> writeGenerations;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        results.swap(m_results);
+        errors.swap(m_errors);
+        writeGenerations = m_writeGenerations;
+    }
+
+    for (const auto &result : results)
+    {
+        if (result.second.WriteGeneration == writeGenerations[result.first])
+        {
+            resultFn(result.first, result.second.ReadSetting);
+        }
+    }
+
+    for (const std::string &error : errors)
+    {
+        K4AViewerErrorManager::Instance().SetErrorStatus(error);
+    }
+}
+
+void K4AColorControlQueue::WorkerThread()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+        m_commandQueued.wait(lock, [this]() { return m_shouldExit || !m_queueOrder.empty(); });
+        if (m_queueOrder.empty())
+        {
+            return;
+        }
+
+        const k4a_color_control_command_t command = m_queueOrder.front();
+        m_queueOrder.pop_front();
+        const PendingCommand pendingCommand = m_pendingCommands[command];
+        m_pendingCommands.erase(command);
+        m_commandInProgress = true;
+        lock.unlock();
+
+        Result result;
+        result.WriteGeneration = pendingCommand.WriteGeneration;
+        std::string error;
+        try
+        {
+            if (pendingCommand.Write)
+            {
+                m_device->set_color_control(command,
+                                            pendingCommand.WriteSetting.Mode,
+                                            pendingCommand.WriteSetting.Value);
+            }
+            m_device->get_color_control(command, &result.ReadSetting.Mode, &result.ReadSetting.Value);
+        }
+        catch (const k4a::error &e)
+        {
+            error = e.what();
+        }
+
+        lock.lock();
+        if (error.empty())
+        {
+            m_results[command] = result;
+        }
+        else
+        {
+            m_errors.emplace_back(std::move(error));
+        }
+
+        m_commandInProgress = false;
+        if (m_queueOrder.empty())
+        {
+            m_commandsFinished.notify_all();
+        }
+    }
+}
@@ -0,0 +1,117 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef K4ACOLORCONTROLQUEUE_H
+#define K4ACOLORCONTROLQUEUE_H
+
+// System headers
+//
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Library headers
+//
+#include <k4a/k4a.hpp>
+
+// Project headers
+//
+
+namespace k4aviewer
+{
+
+// Reads and writes a device's color controls on a background thread.  Each control call is a round
+// trip to the color camera's MCU that can take tens of milliseconds, which would otherwise stall
+// rendering for every stream in the viewer.
+//
+// Writes to a control that haven't been sent yet are coalesced, so dragging a slider sends the latest
+// value as soon as the previous write finishes rather than every value the slider passed through.
+//
+class K4AColorControlQueue
+{
+public:
+    struct Setting
+    {
+        k4a_color_control_mode_t Mode;
+        int32_t Value;
+    };
+
+    using ResultFn = std::function<void(k4a_color_control_command_t, const Setting &)>;
+
+    // The device must outlive the queue
+    //
+    explicit K4AColorControlQueue(k4a::device *device);
+    ~K4AColorControlQueue();
+
+    // The camera can decide to use a different value than the one we give it, so every write is followed
+    // by a read of the value the camera actually used.
+    //
+    void QueueWrite(k4a_color_control_command_t command, Setting setting);
+    void QueueRead(k4a_color_control_command_t command);
+
+    // Waits for all queued reads and writes to finish.
+    //
+    void Flush();
+
+    // Calls resultFn, on the calling thread, for each control read since the last call.  Skips results
+    // that have been made stale by a write queued after them, so a slider that's being dragged doesn't
+    // jump back to an older value.
+    //
+    // Also reports any failed calls through K4AViewerErrorManager.
+    //
+    void ProcessResults(const ResultFn &resultFn);
+
+    K4AColorControlQueue(const K4AColorControlQueue &) = delete;
+    K4AColorControlQueue(const K4AColorControlQueue &&) = delete;
+    K4AColorControlQueue &operator=(const K4AColorControlQueue &) = delete;
+    K4AColorControlQueue &operator=(const K4AColorControlQueue &&) = delete;
+
+private:
+    struct PendingCommand
+    {
+        bool Write = false;
+        Setting WriteSetting;
+        uint64_t WriteGeneration = 0;
+    };
+
+    struct Result
+    {
+        Setting ReadSetting;
+        uint64_t WriteGeneration;
+    };
+
+    void QueueCommand(k4a_color_control_command_t command, const PendingCommand &pendingCommand);
+    void WorkerThread();
+
+    k4a::device *m_device;
+
+    std::mutex m_mutex;
+    std::condition_variable m_commandQueued;
+    std::condition_variable m_commandsFinished;
+
+    // Controls are called in the order they were first queued in
+    //
+    std::deque<k4a_color_control_command_t> m_queueOrder;
+    std::map<k4a_color_control_command_t, PendingCommand> m_pendingCommands;
+    bool m_commandInProgress = false;
+
+    // How many writes have been queued for each control, so we can tell which results are stale
+    //
+    std::map<k4a_color_control_command_t, uint64_t> m_writeGenerations;
+
+    std::map<k4a_color_control_command_t, Result> m_results;
+    std::vector<std::string> m_errors;
+
+    bool m_shouldExit = false;
+    std::thread m_workerThread;
+};
+
+} // namespace k4aviewer
+
+#endif
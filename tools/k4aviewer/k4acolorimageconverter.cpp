@@ -8,6 +8,8 @@
 // System headers
 //
 #include <algorithm>
+#include <array>
+#include <cstring>
 #include <string>
 
 // Library headers
@@ -32,8 +34,11 @@
 
 // Project headers
 //
+#include "gpuyuvtorgbconverter.h"
 #include "k4astaticimageproperties.h"
 #include "k4aviewererrormanager.h"
+#include "k4aviewerlogmanager.h"
+#include "k4aviewersettingsmanager.h"
 #include "perfcounter.h"
 
 using namespace k4aviewer;
@@ -80,6 +85,29 @@ protected:
         return true;
     }
 
+    // Returns nullptr if converting on the GPU is turned off or not supported by the OpenGL driver,
+    // the image is then converted on the CPU.  Converters are created on the thread that owns the
+    // OpenGL context.
+    //
+    static std::unique_ptr<GpuYuvToRgbConverter> CreateGpuConverter()
+    {
+        if (!K4AViewerSettingsManager::Instance().GetViewerOption(ViewerOption::UseGpuColorConversion))
+        {
+            return nullptr;
+        }
+
+        try
+        {
+            return std14::make_unique<GpuYuvToRgbConverter>();
+        }
+        catch (const std::logic_error &e)
+        {
+            std::string message = std::string("Converting color images on the CPU: ") + e.what();
+            K4AViewerLogManager::Instance().Log(K4A_LOG_LEVEL_WARNING, __FILE__, __LINE__, message.c_str());
+            return nullptr;
+        }
+    }
+
     size_t m_expectedBufferSize;
     ImageDimensions m_dimensions;
 };
@@ -99,6 +127,13 @@ public:
             return ImageConversionResult::InvalidBufferSizeError;
         }
 
+        if (m_gpuConverter)
+        {
+            // UpdateTexture() uploads the source image as-is
+            //
+            return ImageConversionResult::Success;
+        }
+
         static PerfCounter decode("YUY2 decode");
         PerfSample decodeSample(&decode);
         int result = libyuv::YUY2ToARGB(srcImage.get_buffer(),                                    // src_yuy2,
@@ -118,7 +153,26 @@ public:
         return ImageConversionResult::Success;
     }
 
-    K4AYUY2ImageConverter(k4a_color_resolution_t resolution) : K4AColorImageConverterBase(resolution) {}
+    GLenum UpdateTexture(const k4a::image &srcImage, const k4a::image &bgraImage, K4AViewerImage *texture) override
+    {
+        if (!m_gpuConverter)
+        {
+            return K4AColorImageConverterBase::UpdateTexture(srcImage, bgraImage, texture);
+        }
+
+        static PerfCounter gpuConvert("YUY2 GPU conversion");
+        PerfSample gpuConvertSample(&gpuConvert);
+        return m_gpuConverter->ConvertYUY2(srcImage.get_buffer(), m_dimensions, texture);
+    }
+
+    K4AYUY2ImageConverter(k4a_color_resolution_t resolution) :
+        K4AColorImageConverterBase(resolution),
+        m_gpuConverter(CreateGpuConverter())
+    {
+    }
+
+private:
+    std::unique_ptr<GpuYuvToRgbConverter> m_gpuConverter;
 };
 
 class K4ANV12ImageConverter : public K4AColorImageConverterBase<K4A_IMAGE_FORMAT_COLOR_NV12>
@@ -139,6 +193,13 @@ public:
             return ImageConversionResult::InvalidBufferSizeError;
         }
 
+        if (m_gpuConverter)
+        {
+            // UpdateTexture() uploads the source image as-is
+            //
+            return ImageConversionResult::Success;
+        }
+
         // libyuv refers to pixel order in system-endian order but OpenGL refers to
         // pixel order in big-endian order, which is why we create the OpenGL texture
         // as "RGBA" but then use the "ABGR" libyuv function here.
@@ -165,7 +226,26 @@ public:
         return ImageConversionResult::Success;
     }
 
-    K4ANV12ImageConverter(k4a_color_resolution_t resolution) : K4AColorImageConverterBase(resolution) {}
+    GLenum UpdateTexture(const k4a::image &srcImage, const k4a::image &bgraImage, K4AViewerImage *texture) override
+    {
+        if (!m_gpuConverter)
+        {
+            return K4AColorImageConverterBase::UpdateTexture(srcImage, bgraImage, texture);
+        }
+
+        static PerfCounter gpuConvert("NV12 GPU conversion");
+        PerfSample gpuConvertSample(&gpuConvert);
+        return m_gpuConverter->ConvertNV12(srcImage.get_buffer(), m_dimensions, texture);
+    }
+
+    K4ANV12ImageConverter(k4a_color_resolution_t resolution) :
+        K4AColorImageConverterBase(resolution),
+        m_gpuConverter(CreateGpuConverter())
+    {
+    }
+
+private:
+    std::unique_ptr<GpuYuvToRgbConverter> m_gpuConverter;
 };
 
 class K4ABGRA32ImageConverter : public K4AColorImageConverterBase<K4A_IMAGE_FORMAT_COLOR_BGRA32>
@@ -202,6 +282,11 @@ public:
         static PerfCounter mjpgDecode("MJPG decode");
         PerfSample decodeSample(&mjpgDecode);
 
+        if (m_gpuConverter)
+        {
+            return DecodeToPlanes(srcImage, bgraImage);
+        }
+
         const int decompressStatus = tjDecompress2(m_decompressor,
                                                    srcImage.get_buffer(),
                                                    static_cast<unsigned long>(srcImage.get_size()),
@@ -220,9 +305,26 @@ public:
         return ImageConversionResult::Success;
     }
 
+    GLenum UpdateTexture(const k4a::image &srcImage, const k4a::image &bgraImage, K4AViewerImage *texture) override
+    {
+        if (!m_gpuConverter)
+        {
+            return K4AColorImageConverterBase::UpdateTexture(srcImage, bgraImage, texture);
+        }
+
+        std::array<const uint8_t *, 3> planes;
+        ImageDimensions chromaDimensions;
+        GetPlanes(bgraImage, &planes, &chromaDimensions);
+
+        static PerfCounter gpuConvert("MJPG GPU conversion");
+        PerfSample gpuConvertSample(&gpuConvert);
+        return m_gpuConverter->ConvertPlanar(planes, m_dimensions, chromaDimensions, texture);
+    }
+
     K4AMJPGImageConverter(k4a_color_resolution_t resolution) :
         K4AColorImageConverterBase(resolution),
-        m_decompressor(tjInitDecompress())
+        m_decompressor(tjInitDecompress()),
+        m_gpuConverter(CreateGpuConverter())
     {
     }
 
@@ -232,7 +334,85 @@ public:
     }
 
 private:
+    // On the GPU path, turbojpeg only decodes the JPEG into its Y, U and V planes, which are laid out
+    // one after the other in the BGRA image - they take at most 3 of its 4 bytes per pixel.  The
+    // dimensions of the chroma planes are stored in the last bytes of the BGRA image, so they travel
+    // with the frame to UpdateTexture().
+    //
+    ImageConversionResult DecodeToPlanes(const k4a::image &srcImage, k4a::image *bgraImage)
+    {
+        int width = 0;
+        int height = 0;
+        int subsampling = 0;
+        int colorspace = 0;
+        if (tjDecompressHeader3(m_decompressor,
+                                srcImage.get_buffer(),
+                                static_cast<unsigned long>(srcImage.get_size()),
+                                &width,
+                                &height,
+                                &subsampling,
+                                &colorspace) != 0 ||
+            width != m_dimensions.Width || height != m_dimensions.Height)
+        {
+            return ImageConversionResult::InvalidImageDataError;
+        }
+
+        const bool grayscale = subsampling == TJSAMP_GRAY;
+        int32_t chromaSize[2] = { 1, 1 };
+        if (!grayscale)
+        {
+            chromaSize[0] = tjPlaneWidth(1, width, subsampling);
+            chromaSize[1] = tjPlaneHeight(1, height, subsampling);
+            if (chromaSize[0] <= 0 || chromaSize[1] <= 0)
+            {
+                return ImageConversionResult::InvalidImageDataError;
+            }
+        }
+
+        uint8_t *buffer = bgraImage->get_buffer();
+        const size_t lumaBytes = static_cast<size_t>(width * height);
+        const size_t chromaBytes = static_cast<size_t>(chromaSize[0] * chromaSize[1]);
+        unsigned char *planes[3] = { buffer, buffer + lumaBytes, buffer + lumaBytes + chromaBytes };
+        if (tjDecompressToYUVPlanes(m_decompressor,
+                                    srcImage.get_buffer(),
+                                    static_cast<unsigned long>(srcImage.get_size()),
+                                    planes,
+                                    width,
+                                    nullptr, // strides
+                                    height,
+                                    TJFLAG_FASTDCT | TJFLAG_FASTUPSAMPLE) != 0)
+        {
+            return ImageConversionResult::InvalidImageDataError;
+        }
+
+        if (grayscale)
+        {
+            // A single neutral chroma sample for the whole image
+            //
+            *planes[1] = 128;
+            *planes[2] = 128;
+        }
+
+        std::memcpy(buffer + bgraImage->get_size() - sizeof(chromaSize), chromaSize, sizeof(chromaSize));
+        return ImageConversionResult::Success;
+    }
+
+    void GetPlanes(const k4a::image &bgraImage,
+                   std::array<const uint8_t *, 3> *planes,
+                   ImageDimensions *chromaDimensions) const
+    {
+        const uint8_t *buffer = bgraImage.get_buffer();
+        int32_t chromaSize[2];
+        std::memcpy(chromaSize, buffer + bgraImage.get_size() - sizeof(chromaSize), sizeof(chromaSize));
+
+        const size_t lumaBytes = static_cast<size_t>(m_dimensions.Width * m_dimensions.Height);
+        const size_t chromaBytes = static_cast<size_t>(chromaSize[0] * chromaSize[1]);
+        *planes = { { buffer, buffer + lumaBytes, buffer + lumaBytes + chromaBytes } };
+        *chromaDimensions = ImageDimensions(chromaSize[0], chromaSize[1]);
+    }
+
     tjhandle m_decompressor;
+    std::unique_ptr<GpuYuvToRgbConverter> m_gpuConverter;
 };
 
 template<>
@@ -8,9 +8,9 @@
 //
 #include <array>
 #include <chrono>
+#include <condition_variable>
 #include <memory>
 #include <mutex>
-#include <thread>
 
 // Library headers
 //
@@ -20,6 +20,7 @@
 //
 #include "ik4aobserver.h"
 #include "ik4aimageconverter.h"
+#include "k4adecodeworkerpool.h"
 #include "k4aimageextractor.h"
 #include "k4aframeratetracker.h"
 #include "k4aringbuffer.h"
@@ -41,7 +42,9 @@ public:
             return ImageConversionResult::NoDataError;
         }
 
-        GLenum result = textureToUpdate->UpdateTexture(m_textureBuffers.CurrentItem()->Bgra.get_buffer());
+        GLenum result = m_imageConverter->UpdateTexture(m_textureBuffers.CurrentItem()->Source,
+                                                        m_textureBuffers.CurrentItem()->Bgra,
+                                                        textureToUpdate);
         *sourceImage = m_textureBuffers.CurrentItem()->Source;
 
         m_textureBuffers.AdvanceRead();
@@ -75,7 +78,8 @@ public:
 
     void NotifyTermination() override
     {
-        m_workerThreadShouldExit = true;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_shouldExit = true;
         m_failed = true;
     }
 
@@ -89,15 +93,16 @@ public:
 
     ~K4AConvertingImageSourceImpl() override
     {
-        m_workerThreadShouldExit = true;
-        if (m_workerThread.joinable())
-        {
-            m_workerThread.join();
-        }
+        // The worker pool's job points at us, so we have to wait for it to finish
+        //
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_shouldExit = true;
+        m_conversionFinished.wait(lock, [this]() { return !m_conversionQueued; });
     };
 
     K4AConvertingImageSourceImpl(std::unique_ptr<IK4AImageConverter<ImageFormat>> &&imageConverter) :
-        m_imageConverter(std::move(imageConverter))
+        m_imageConverter(std::move(imageConverter)),
+        m_workerPool(K4ADecodeWorkerPool::Get())
     {
         ImageDimensions dimensions = m_imageConverter->GetImageDimensions();
         m_textureBuffers.Initialize([dimensions](ConvertedImagePair *bufferItem) {
@@ -106,8 +111,6 @@ public:
                                                   dimensions.Height,
                                                   dimensions.Width * static_cast<int>(sizeof(BgraPixel)));
         });
-
-        m_workerThread = std::thread(&K4AConvertingImageSourceImpl::WorkerThread, this);
     }
 
     K4AConvertingImageSourceImpl(K4AConvertingImageSourceImpl &) = delete;
@@ -125,64 +128,95 @@ protected:
         k4a::image image = K4AImageExtractor::GetImageFromCapture<ImageFormat>(data);
         if (image != nullptr)
         {
-            // Hand the image off to our worker thread.
+            // Hand the image off to the worker pool.
             //
             std::lock_guard<std::mutex> lock(m_mutex);
 
             if (!m_inputImageBuffer.BeginInsert())
             {
-                // Worker thread is backed up. drop the image
+                // Worker pool is backed up. drop the image
                 //
                 return;
             }
 
             *m_inputImageBuffer.InsertionItem() = std::move(image);
             m_inputImageBuffer.EndInsert();
+
+            QueueConversion();
         }
     }
 
 private:
-    static void WorkerThread(K4AConvertingImageSourceImpl *fs)
+    // Must be called with m_mutex held
+    //
+    void QueueConversion()
     {
-        while (!fs->m_workerThreadShouldExit)
+        if (!m_conversionQueued && !m_shouldExit)
         {
-            std::unique_lock<std::mutex> lock(fs->m_mutex);
-            if (!fs->m_inputImageBuffer.Empty())
-            {
-                // Take the image from the image source
-                //
-                k4a::image imageToConvert = std::move(*fs->m_inputImageBuffer.CurrentItem());
-                fs->m_inputImageBuffer.AdvanceRead();
-                lock.unlock();
-
-                if (!fs->m_textureBuffers.BeginInsert())
-                {
-                    // Our buffer has overflowed.  Drop the image.
-                    //
-                    continue;
-                }
-
-                ImageConversionResult result =
-                    fs->m_imageConverter->ConvertImage(imageToConvert, &fs->m_textureBuffers.InsertionItem()->Bgra);
-
-                if (result != ImageConversionResult::Success)
-                {
-                    // We treat visualization failures as fatal.  Stop the thread.
-                    //
-                    fs->m_failureCode = result;
-                    fs->NotifyTermination();
-                    fs->m_textureBuffers.AbortInsert();
-                    return;
-                }
-
-                // Save off the source image so the viewer can show things like pixel values
-                //
-                fs->m_textureBuffers.InsertionItem()->Source = std::move(imageToConvert);
+            m_conversionQueued = true;
+            m_workerPool->QueueJob([this]() { ConvertNextImage(); });
+        }
+    }
 
-                fs->m_textureBuffers.EndInsert();
-                fs->m_framerateTracker.NotifyFrame();
-            }
+    // Runs on the worker pool.  Only one job per source is queued at a time, so the converter is never
+    // used by more than one thread at once, even though it may be a different thread every time.
+    //
+    void ConvertNextImage()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (!m_shouldExit && !m_inputImageBuffer.Empty())
+        {
+            // Take the image from the image source
+            //
+            k4a::image imageToConvert = std::move(*m_inputImageBuffer.CurrentItem());
+            m_inputImageBuffer.AdvanceRead();
+            lock.unlock();
+
+            ConvertImage(std::move(imageToConvert));
+
+            lock.lock();
+        }
+
+        // If more images came in while we were converting, go to the back of the queue rather than
+        // converting them now so other sources get a turn
+        //
+        m_conversionQueued = false;
+        if (!m_inputImageBuffer.Empty())
+        {
+            QueueConversion();
         }
+
+        m_conversionFinished.notify_all();
+    }
+
+    void ConvertImage(k4a::image &&imageToConvert)
+    {
+        if (!m_textureBuffers.BeginInsert())
+        {
+            // Our buffer has overflowed.  Drop the image.
+            //
+            return;
+        }
+
+        ImageConversionResult result = m_imageConverter->ConvertImage(imageToConvert,
+                                                                      &m_textureBuffers.InsertionItem()->Bgra);
+
+        if (result != ImageConversionResult::Success)
+        {
+            // We treat visualization failures as fatal.  Stop converting.
+            //
+            m_failureCode = result;
+            NotifyTermination();
+            m_textureBuffers.AbortInsert();
+            return;
+        }
+
+        // Save off the source image so the viewer can show things like pixel values
+        //
+        m_textureBuffers.InsertionItem()->Source = std::move(imageToConvert);
+
+        m_textureBuffers.EndInsert();
+        m_framerateTracker.NotifyFrame();
     }
 
     ImageConversionResult m_failureCode = ImageConversionResult::Success;
@@ -203,10 +237,12 @@ private:
 
     K4AFramerateTracker m_framerateTracker;
 
-    std::mutex m_mutex;
+    std::shared_ptr<K4ADecodeWorkerPool> m_workerPool;
 
-    std::thread m_workerThread;
-    bool m_workerThreadShouldExit = false;
+    std::mutex m_mutex;
+    std::condition_variable m_conversionFinished;
+    bool m_conversionQueued = false;
+    bool m_shouldExit = false;
 };
 
 template<k4a_image_format_t ImageFormat>
@@ -0,0 +1,101 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// Associated header
+//
+#include "k4adecodeworkerpool.h"
+
+// System headers
+//
+#include <algorithm>
+
+// Library headers
+//
+
+// Project headers
+//
+
+using namespace k4aviewer;
+
+namespace
+{
+// Enough to keep up with MJPG decoding on a handful of devices at once without crowding out the
+// render thread or the SDK's own threads
+//
+constexpr unsigned int MaxWorkerCount = 4;
+} // namespace
+
+std::shared_ptr<K4ADecodeWorkerPool> K4ADecodeWorkerPool::Get()
+{
+    static std::mutex instanceMutex;
+    static std::weak_ptr<K4ADecodeWorkerPool> instance;
+
+    std::lock_guard<std::mutex> lock(instanceMutex);
+    std::shared_ptr<K4ADecodeWorkerPool> pool = instance.lock();
+    if (!pool)
+    {
+        pool = std::shared_ptr<K4ADecodeWorkerPool>(new K4ADecodeWorkerPool());
+        instance = pool;
+    }
+    return pool;
+}
+
+K4ADecodeWorkerPool::K4ADecodeWorkerPool()
+{
+    // Leave a core for the render thread
+    //
+    const unsigned int hardwareThreads = std::thread::hardware_concurrency();
+    const unsigned int workerCount = std::min(MaxWorkerCount, hardwareThreads > 1 ? hardwareThreads - 1 : 1);
+
+    for (unsigned int i = 0; i < workerCount; ++i)
+    {
+        m_workers.emplace_back(&K4ADecodeWorkerPool::WorkerThread, this);
+    }
+}
+
+K4ADecodeWorkerPool::~K4ADecodeWorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_shouldExit = true;
+    }
+    m_jobAvailable.notify_all();
+
+    for (std::thread &worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+void K4ADecodeWorkerPool::QueueJob(std::function<void()> &&job)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.emplace_back(std::move(job));
+    }
+    m_jobAvailable.notify_one();
+}
+
+void K4ADecodeWorkerPool::WorkerThread()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+        m_jobAvailable.wait(lock, [this]() { return m_shouldExit || !m_jobs.empty(); });
+
+        // Image sources wait for their queued jobs before they're destroyed, so by the time the pool is
+        // destroyed there's nothing left to run
+        //
+        if (m_jobs.empty())
+        {
+            return;
+        }
+
+        std::function<void()> job = std::move(m_jobs.front());
+        m_jobs.pop_front();
+
+        lock.unlock();
+        job();
+        lock.lock();
+    }
+}
@@ -0,0 +1,70 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef K4ADECODEWORKERPOOL_H
+#define K4ADECODEWORKERPOOL_H
+
+// System headers
+//
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Library headers
+//
+
+// Project headers
+//
+
+namespace k4aviewer
+{
+
+// A bounded set of threads that decodes and converts images for every image source in the viewer, so
+// viewing several devices at once doesn't start a conversion thread per window.
+//
+// Image sources queue at most one job at a time and requeue themselves after each image (see
+// K4AConvertingImageSourceImpl), so the queue never holds more jobs than there are sources, and a
+// source with a backlog takes turns with the others instead of starving them.
+//
+class K4ADecodeWorkerPool
+{
+public:
+    // The pool is created with the first image source and its threads exit once the last reference
+    // to it is released.
+    //
+    static std::shared_ptr<K4ADecodeWorkerPool> Get();
+
+    ~K4ADecodeWorkerPool();
+
+    void QueueJob(std::function<void()> &&job);
+
+    size_t GetWorkerCount() const
+    {
+        return m_workers.size();
+    }
+
+    K4ADecodeWorkerPool(const K4ADecodeWorkerPool &) = delete;
+    K4ADecodeWorkerPool(const K4ADecodeWorkerPool &&) = delete;
+    K4ADecodeWorkerPool &operator=(const K4ADecodeWorkerPool &) = delete;
+    K4ADecodeWorkerPool &operator=(const K4ADecodeWorkerPool &&) = delete;
+
+private:
+    K4ADecodeWorkerPool();
+
+    void WorkerThread();
+
+    std::mutex m_mutex;
+    std::condition_variable m_jobAvailable;
+    std::deque<std::function<void()>> m_jobs;
+    bool m_shouldExit = false;
+
+    std::vector<std::thread> m_workers;
+};
+
+} // namespace k4aviewer
+
+#endif
@@ -15,14 +15,14 @@
 // Project headers
 //
 #include "ik4aimageconverter.h"
-#include "k4adepthpixelcolorizer.h"
+#include "k4apixel.h"
 #include "k4astaticimageproperties.h"
 #include "k4aviewerutil.h"
 #include "perfcounter.h"
 
 namespace k4aviewer
 {
-template<k4a_image_format_t ImageFormat, DepthPixelVisualizationFunction VisualizationFunction>
+template<k4a_image_format_t ImageFormat, k4a_colormap_t Colormap>
 class K4ADepthImageConverterBase : public IK4AImageConverter<ImageFormat>
 {
 public:
@@ -49,13 +49,9 @@ public:
             return ImageConversionResult::InvalidBufferSizeError;
         }
 
-        const uint8_t *src = srcImage.get_buffer();
-
         static PerfCounter render(std::string("Depth sensor<T") + std::to_string(int(ImageFormat)) + "> render");
         PerfSample renderSample(&render);
-        RenderImage(src,
-                    static_cast<size_t>(m_dimensions.Width * m_dimensions.Height) * sizeof(DepthPixel),
-                    bgraImage->get_buffer());
+        srcImage.colorize(m_expectedValueRange.first, m_expectedValueRange.second, Colormap, *bgraImage);
         renderSample.End();
 
         return ImageConversionResult::Success;
@@ -74,22 +70,6 @@ public:
     K4ADepthImageConverterBase &operator=(const K4ADepthImageConverterBase &&) = delete;
 
 private:
-    void RenderImage(const uint8_t *src, const size_t srcSize, uint8_t *dst)
-    {
-        const uint8_t *currentSrc = src;
-        const uint8_t *srcEnd = src + srcSize;
-        while (currentSrc < srcEnd)
-        {
-            const DepthPixel pixelValue = *reinterpret_cast<const DepthPixel *>(currentSrc);
-
-            BgraPixel *outputPixel = reinterpret_cast<BgraPixel *>(dst);
-            *outputPixel = VisualizationFunction(pixelValue, m_expectedValueRange.first, m_expectedValueRange.second);
-
-            dst += sizeof(BgraPixel);
-            currentSrc += sizeof(DepthPixel);
-        }
-    }
-
     const ImageDimensions m_dimensions;
     const std::pair<DepthPixel, DepthPixel> m_expectedValueRange;
     const size_t m_expectedBufferSize;
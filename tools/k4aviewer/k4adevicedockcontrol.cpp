@@ -7,6 +7,8 @@
 
 // System headers
 //
+#include <algorithm>
+#include <map>
 #include <memory>
 #include <ratio>
 #include <sstream>
@@ -23,6 +25,7 @@
 #include "k4aviewererrormanager.h"
 #include "k4aviewerutil.h"
 #include "k4awindowmanager.h"
+#include "perfcounter.h"
 
 using namespace k4aviewer;
 
@@ -35,6 +38,51 @@ constexpr std::chrono::minutes SubordinateModeStartupTimeout(5);
 
 constexpr std::chrono::milliseconds PollingThreadCleanShutdownTimeout = std::chrono::milliseconds(1000 / 5);
 
+constexpr std::chrono::milliseconds SdkStatisticsInterval(1000);
+
+// Perf counters fed from the SDK's statistics rather than timed in the viewer, so operators can tell
+// whether a low frame rate comes from the sensor/USB link, the depth engine or the host.
+//
+// Perf counters must last forever, so there's one set per serial number, which gets reused if the
+// device is reopened.
+//
+struct SdkPerfCounters
+{
+    explicit SdkPerfCounters(const std::string &serialNumber) :
+        UsbTransfers("SDK " + serialNumber + ": outstanding depth USB transfers", "transfers"),
+        UsbTimeouts("SDK " + serialNumber + ": depth USB timeouts", "/s"),
+        DepthEngineCompute("SDK " + serialNumber + ": depth engine compute"),
+        DepthEngineP99Compute("SDK " + serialNumber + ": depth engine compute p99"),
+        DepthEngineOverruns("SDK " + serialNumber + ": depth engine overruns", "/s"),
+        DepthEngineFramesInFlight("SDK " + serialNumber + ": depth engine GPU frames in flight", "frames"),
+        DepthEngineDrops("SDK " + serialNumber + ": depth engine input drops", "/s"),
+        CaptureSyncDrops("SDK " + serialNumber + ": capturesync drops", "/s"),
+        CaptureQueueDrops("SDK " + serialNumber + ": capture queue drops", "/s")
+    {
+    }
+
+    PerfCounter UsbTransfers;
+    PerfCounter UsbTimeouts;
+    PerfCounter DepthEngineCompute;
+    PerfCounter DepthEngineP99Compute;
+    PerfCounter DepthEngineOverruns;
+    PerfCounter DepthEngineFramesInFlight;
+    PerfCounter DepthEngineDrops;
+    PerfCounter CaptureSyncDrops;
+    PerfCounter CaptureQueueDrops;
+};
+
+SdkPerfCounters &GetSdkPerfCounters(const std::string &serialNumber)
+{
+    static std::map<std::string, std::unique_ptr<SdkPerfCounters>> counters;
+    std::unique_ptr<SdkPerfCounters> &deviceCounters = counters[serialNumber];
+    if (!deviceCounters)
+    {
+        deviceCounters = std14::make_unique<SdkPerfCounters>(serialNumber);
+    }
+    return *deviceCounters;
+}
+
 template<typename T>
 void StopSensor(k4a::device *device,
                 std::function<void(k4a::device *)> stopFn,
@@ -176,19 +224,10 @@ void K4ADeviceDockControl::ShowColorControlAutoButton(k4a_color_control_mode_t c
 
 void K4ADeviceDockControl::ApplyColorSetting(k4a_color_control_command_t command, ColorSetting *cacheEntry)
 {
-    try
-    {
-        m_device.set_color_control(command, cacheEntry->Mode, cacheEntry->Value);
-
-        // The camera can decide to set a different value than the one we give it, so rather than just saving off
-        // the mode we set, we read it back from the camera and cache that instead.
-        //
-        ReadColorSetting(command, cacheEntry);
-    }
-    catch (const k4a::error &e)
-    {
-        K4AViewerErrorManager::Instance().SetErrorStatus(e.what());
-    }
+    // The camera can decide to set a different value than the one we give it, so the queue reads back
+    // the value it actually used, which ProcessColorControlResults() puts in the cache.
+    //
+    m_colorControlQueue.QueueWrite(command, { cacheEntry->Mode, cacheEntry->Value });
 }
 
 void K4ADeviceDockControl::ApplyDefaultColorSettings()
@@ -226,16 +265,9 @@ void K4ADeviceDockControl::ApplyDefaultColorSettings()
     ApplyColorSetting(K4A_COLOR_CONTROL_POWERLINE_FREQUENCY, &m_colorSettingsCache.PowerlineFrequency);
 }
 
-void K4ADeviceDockControl::ReadColorSetting(k4a_color_control_command_t command, ColorSetting *cacheEntry)
+void K4ADeviceDockControl::ReadColorSetting(k4a_color_control_command_t command)
 {
-    try
-    {
-        m_device.get_color_control(command, &cacheEntry->Mode, &cacheEntry->Value);
-    }
-    catch (const k4a::error &e)
-    {
-        K4AViewerErrorManager::Instance().SetErrorStatus(e.what());
-    }
+    m_colorControlQueue.QueueRead(command);
 }
 
 void K4ADeviceDockControl::LoadColorSettingsCache()
@@ -245,15 +277,140 @@ void K4ADeviceDockControl::LoadColorSettingsCache()
     static_assert(sizeof(m_colorSettingsCache) == sizeof(ColorSetting) * 9,
                   "Missing color setting in LoadColorSettingsCache()");
 
-    ReadColorSetting(K4A_COLOR_CONTROL_EXPOSURE_TIME_ABSOLUTE, &m_colorSettingsCache.ExposureTimeUs);
-    ReadColorSetting(K4A_COLOR_CONTROL_WHITEBALANCE, &m_colorSettingsCache.WhiteBalance);
-    ReadColorSetting(K4A_COLOR_CONTROL_BRIGHTNESS, &m_colorSettingsCache.Brightness);
-    ReadColorSetting(K4A_COLOR_CONTROL_CONTRAST, &m_colorSettingsCache.Contrast);
-    ReadColorSetting(K4A_COLOR_CONTROL_SATURATION, &m_colorSettingsCache.Saturation);
-    ReadColorSetting(K4A_COLOR_CONTROL_SHARPNESS, &m_colorSettingsCache.Sharpness);
-    ReadColorSetting(K4A_COLOR_CONTROL_BACKLIGHT_COMPENSATION, &m_colorSettingsCache.BacklightCompensation);
-    ReadColorSetting(K4A_COLOR_CONTROL_GAIN, &m_colorSettingsCache.Gain);
-    ReadColorSetting(K4A_COLOR_CONTROL_POWERLINE_FREQUENCY, &m_colorSettingsCache.PowerlineFrequency);
+    ReadColorSetting(K4A_COLOR_CONTROL_EXPOSURE_TIME_ABSOLUTE);
+    ReadColorSetting(K4A_COLOR_CONTROL_WHITEBALANCE);
+    ReadColorSetting(K4A_COLOR_CONTROL_BRIGHTNESS);
+    ReadColorSetting(K4A_COLOR_CONTROL_CONTRAST);
+    ReadColorSetting(K4A_COLOR_CONTROL_SATURATION);
+    ReadColorSetting(K4A_COLOR_CONTROL_SHARPNESS);
+    ReadColorSetting(K4A_COLOR_CONTROL_BACKLIGHT_COMPENSATION);
+    ReadColorSetting(K4A_COLOR_CONTROL_GAIN);
+    ReadColorSetting(K4A_COLOR_CONTROL_POWERLINE_FREQUENCY);
+}
+
+K4ADeviceDockControl::ColorSetting *K4ADeviceDockControl::GetColorSettingsCacheEntry(
+    const k4a_color_control_command_t command)
+{
+    switch (command)
+    {
+    case K4A_COLOR_CONTROL_EXPOSURE_TIME_ABSOLUTE:
+        return &m_colorSettingsCache.ExposureTimeUs;
+    case K4A_COLOR_CONTROL_WHITEBALANCE:
+        return &m_colorSettingsCache.WhiteBalance;
+    case K4A_COLOR_CONTROL_BRIGHTNESS:
+        return &m_colorSettingsCache.Brightness;
+    case K4A_COLOR_CONTROL_CONTRAST:
+        return &m_colorSettingsCache.Contrast;
+    case K4A_COLOR_CONTROL_SATURATION:
+        return &m_colorSettingsCache.Saturation;
+    case K4A_COLOR_CONTROL_SHARPNESS:
+        return &m_colorSettingsCache.Sharpness;
+    case K4A_COLOR_CONTROL_BACKLIGHT_COMPENSATION:
+        return &m_colorSettingsCache.BacklightCompensation;
+    case K4A_COLOR_CONTROL_GAIN:
+        return &m_colorSettingsCache.Gain;
+    case K4A_COLOR_CONTROL_POWERLINE_FREQUENCY:
+        return &m_colorSettingsCache.PowerlineFrequency;
+    default:
+        return nullptr;
+    }
+}
+
+void K4ADeviceDockControl::ProcessColorControlResults()
+{
+    m_colorControlQueue.ProcessResults(
+        [this](const k4a_color_control_command_t command, const K4AColorControlQueue::Setting &setting) {
+            ColorSetting *cacheEntry = GetColorSettingsCacheEntry(command);
+            if (cacheEntry)
+            {
+                cacheEntry->Mode = setting.Mode;
+                cacheEntry->Value = setting.Value;
+            }
+        });
+}
+
+void K4ADeviceDockControl::UpdateSdkPerfCounters()
+{
+    const auto now = std::chrono::steady_clock::now();
+    if (now - m_lastStatisticsTime < SdkStatisticsInterval)
+    {
+        return;
+    }
+
+    k4a_device_statistics_t statistics;
+    k4a_depth_engine_gpu_statistics_t gpuStatistics;
+    try
+    {
+        statistics = m_device.get_statistics();
+        gpuStatistics = m_device.get_depth_engine_gpu_statistics();
+    }
+    catch (const k4a::error &)
+    {
+        m_lastStatisticsTime = now;
+        m_haveLastStatistics = false;
+        return;
+    }
+
+    // There's no depth USB stream to report on if the depth camera is off
+    //
+    bool haveUsbTransferCount = false;
+    uint32_t usbTransferCount = 0;
+    if (m_config.EnableDepthCamera)
+    {
+        try
+        {
+            usbTransferCount = m_device.get_usb_streaming_transfer_count();
+            haveUsbTransferCount = true;
+        }
+        catch (const k4a::error &)
+        {
+            // Leave the transfer count out of this sample
+            //
+        }
+    }
+
+    if (m_haveLastStatistics)
+    {
+        SdkPerfCounters &counters = GetSdkPerfCounters(m_deviceSerialNumber);
+        const float elapsedSeconds = std::chrono::duration<float>(now - m_lastStatisticsTime).count();
+        const auto perSecond = [elapsedSeconds](uint32_t current, uint32_t last) {
+            return static_cast<float>(current - last) / elapsedSeconds;
+        };
+
+        // The SDK's average covers everything since the device was opened; recover the average over
+        // just this interval from the running totals
+        //
+        const uint64_t frameCount = statistics.depth_engine_frame_count - m_lastStatistics.depth_engine_frame_count;
+        if (frameCount > 0)
+        {
+            const double totalTime = static_cast<double>(statistics.depth_engine_average_compute_time_ms) *
+                                     static_cast<double>(statistics.depth_engine_frame_count);
+            const double lastTotalTime = static_cast<double>(m_lastStatistics.depth_engine_average_compute_time_ms) *
+                                         static_cast<double>(m_lastStatistics.depth_engine_frame_count);
+            counters.DepthEngineCompute.AddSample(
+                static_cast<float>(std::max(0.0, (totalTime - lastTotalTime) / static_cast<double>(frameCount))));
+        }
+
+        if (haveUsbTransferCount)
+        {
+            counters.UsbTransfers.AddSample(static_cast<float>(usbTransferCount));
+        }
+        counters.UsbTimeouts.AddSample(perSecond(statistics.usb_timeout_count, m_lastStatistics.usb_timeout_count));
+        counters.DepthEngineP99Compute.AddSample(static_cast<float>(statistics.depth_engine_p99_compute_time_ms));
+        counters.DepthEngineOverruns.AddSample(
+            perSecond(statistics.depth_engine_overrun_count, m_lastStatistics.depth_engine_overrun_count));
+        counters.DepthEngineFramesInFlight.AddSample(static_cast<float>(gpuStatistics.frames_in_flight));
+        counters.DepthEngineDrops.AddSample(
+            perSecond(statistics.depth_engine_dropped_count, m_lastStatistics.depth_engine_dropped_count));
+        counters.CaptureSyncDrops.AddSample(
+            perSecond(statistics.capturesync_dropped_count, m_lastStatistics.capturesync_dropped_count));
+        counters.CaptureQueueDrops.AddSample(
+            perSecond(statistics.capture_queue_dropped_count, m_lastStatistics.capture_queue_dropped_count));
+    }
+
+    m_lastStatistics = statistics;
+    m_lastStatisticsTime = now;
+    m_haveLastStatistics = true;
 }
 
 void K4ADeviceDockControl::RefreshSyncCableStatus()
@@ -274,7 +431,9 @@ bool K4ADeviceDockControl::DeviceIsStarted() const
     return m_camerasStarted || m_imuStarted || (m_microphone && m_microphone->IsStarted());
 }
 
-K4ADeviceDockControl::K4ADeviceDockControl(k4a::device &&device) : m_device(std::move(device))
+K4ADeviceDockControl::K4ADeviceDockControl(k4a::device &&device) :
+    m_device(std::move(device)),
+    m_colorControlQueue(&m_device)
 {
     ApplyDefaultConfiguration();
 
@@ -283,7 +442,13 @@ K4ADeviceDockControl::K4ADeviceDockControl(k4a::device &&device) : m_device(std:
 
     m_microphone = K4AAudioManager::Instance().GetMicrophoneForDevice(m_deviceSerialNumber);
 
+    // The controls need the camera's settings before we can show them, and nothing is streaming from
+    // this device yet, so it's OK to wait here
+    //
     LoadColorSettingsCache();
+    m_colorControlQueue.Flush();
+    ProcessColorControlResults();
+
     RefreshSyncCableStatus();
 }
 
@@ -321,6 +486,13 @@ K4ADockControlStatus K4ADeviceDockControl::Show()
         m_microphone->ClearStatusCode();
     }
 
+    if (m_camerasStarted)
+    {
+        UpdateSdkPerfCounters();
+    }
+
+    ProcessColorControlResults();
+
     // Draw controls
     //
     // InputScalars are a bit wider than we want them by default.
@@ -849,6 +1021,11 @@ K4ADockControlStatus K4ADeviceDockControl::Show()
                 m_paused = true;
             }
         }
+
+        if (m_camerasStarted)
+        {
+            ImGui::Text("Capture rate: %.2f fps", GetCaptureFramerate());
+        }
     }
 
     m_firstRun = false;
@@ -877,7 +1054,7 @@ void K4ADeviceDockControl::Start()
 
 void K4ADeviceDockControl::Stop()
 {
-    K4AWindowManager::Instance().ClearWindows();
+    K4AWindowManager::Instance().ClearWindows(m_deviceSerialNumber);
 
     StopCameras();
     StopImu();
@@ -905,16 +1082,25 @@ bool K4ADeviceDockControl::StartCameras()
     }
 
     m_camerasStarted = true;
+    m_haveLastStatistics = false;
+    m_lastStatisticsTime = std::chrono::steady_clock::time_point();
 
     k4a::device *pDevice = &m_device;
     K4ADataSource<k4a::capture> *pCameraDataSource = &m_cameraDataSource;
+    K4AFramerateTracker *pCaptureFramerateTracker = &m_captureFramerateTracker;
     bool *pPaused = &m_paused;
     bool *pCamerasStarted = &m_camerasStarted;
     bool *pAbortInProgress = &m_camerasAbortInProgress;
     bool isSubordinate = m_config.WiredSyncMode == K4A_WIRED_SYNC_MODE_SUBORDINATE;
 
     m_cameraPollingThread = std14::make_unique<K4APollingThread>(
-        [pDevice, pCameraDataSource, pPaused, pCamerasStarted, pAbortInProgress, isSubordinate](bool firstRun) {
+        [pDevice,
+         pCameraDataSource,
+         pCaptureFramerateTracker,
+         pPaused,
+         pCamerasStarted,
+         pAbortInProgress,
+         isSubordinate](bool firstRun) {
             std::chrono::milliseconds pollingTimeout = CameraPollingTimeout;
             if (firstRun && isSubordinate)
             {
@@ -929,10 +1115,15 @@ bool K4ADeviceDockControl::StartCameras()
                                             pPaused,
                                             pCamerasStarted,
                                             pAbortInProgress,
-                                            [](k4a::device *device,
-                                               k4a::capture *capture,
-                                               std::chrono::milliseconds timeout) {
-                                                return device->get_capture(capture, timeout);
+                                            [pCaptureFramerateTracker](k4a::device *device,
+                                                                       k4a::capture *capture,
+                                                                       std::chrono::milliseconds timeout) {
+                                                const bool succeeded = device->get_capture(capture, timeout);
+                                                if (succeeded)
+                                                {
+                                                    pCaptureFramerateTracker->NotifyFrame();
+                                                }
+                                                return succeeded;
                                             },
                                             [](k4a::device *device) { device->stop_cameras(); },
                                             pollingTimeout);
@@ -1052,7 +1243,7 @@ void K4ADeviceDockControl::StopImu()
 
 void K4ADeviceDockControl::SetViewType(K4AWindowSet::ViewType viewType)
 {
-    K4AWindowManager::Instance().ClearWindows();
+    K4AWindowManager::Instance().ClearWindows(m_deviceSerialNumber);
 
     std::shared_ptr<K4AMicrophoneListener> micListener = nullptr;
     if (m_config.EnableMicrophone)
@@ -6,6 +6,7 @@
 
 // System headers
 //
+#include <chrono>
 #include <memory>
 
 // Library headers
@@ -15,7 +16,9 @@
 // Project headers
 //
 #include "ik4adockcontrol.h"
+#include "k4acolorcontrolqueue.h"
 #include "k4adatasource.h"
+#include "k4aframeratetracker.h"
 #include "k4amicrophone.h"
 #include "k4apollingthread.h"
 #include "k4aviewersettingsmanager.h"
@@ -36,6 +39,34 @@ public:
 
     K4ADockControlStatus Show() override;
 
+    // Starts/stops the sensors enabled in the device's configuration
+    //
+    void Start();
+    void Stop();
+    bool DeviceIsStarted() const;
+
+    const std::string &GetSerialNumber() const
+    {
+        return m_deviceSerialNumber;
+    }
+
+    // The rate at which the device is producing captures, whether or not they're being shown
+    //
+    double GetCaptureFramerate() const
+    {
+        return m_captureFramerateTracker.GetFramerate();
+    }
+
+    bool CamerasStarted() const
+    {
+        return m_camerasStarted;
+    }
+
+    k4a_wired_sync_mode_t GetWiredSyncMode() const
+    {
+        return m_config.WiredSyncMode;
+    }
+
 private:
     struct ColorSetting
     {
@@ -74,12 +105,10 @@ private:
     void ApplyColorSetting(k4a_color_control_command_t command, ColorSetting *cacheEntry);
     void ApplyDefaultColorSettings();
 
-    void ReadColorSetting(k4a_color_control_command_t command, ColorSetting *cacheEntry);
+    void ReadColorSetting(k4a_color_control_command_t command);
     void LoadColorSettingsCache();
-
-    void Start();
-    void Stop();
-    bool DeviceIsStarted() const;
+    ColorSetting *GetColorSettingsCacheEntry(k4a_color_control_command_t command);
+    void ProcessColorControlResults();
 
     bool StartCameras();
     void StopCameras();
@@ -96,6 +125,10 @@ private:
 
     void RefreshSyncCableStatus();
 
+    // Plots the SDK's own pipeline statistics in the performance counters window
+    //
+    void UpdateSdkPerfCounters();
+
     K4AWindowSet::ViewType m_currentViewType = K4AWindowSet::ViewType::Normal;
 
     void SetViewType(K4AWindowSet::ViewType viewType);
@@ -103,6 +136,7 @@ private:
     K4ADeviceConfiguration m_config;
 
     k4a::device m_device;
+    K4AColorControlQueue m_colorControlQueue;
     bool m_camerasStarted = false;
     bool m_imuStarted = false;
 
@@ -113,6 +147,7 @@ private:
     std::shared_ptr<K4AMicrophone> m_microphone;
 
     K4ADataSource<k4a::capture> m_cameraDataSource;
+    K4AFramerateTracker m_captureFramerateTracker;
     K4ADataSource<k4a_imu_sample_t> m_imuDataSource;
 
     bool m_firstRun = true;
@@ -126,6 +161,10 @@ private:
 
     std::unique_ptr<K4APollingThread> m_cameraPollingThread;
     std::unique_ptr<K4APollingThread> m_imuPollingThread;
+
+    bool m_haveLastStatistics = false;
+    k4a_device_statistics_t m_lastStatistics;
+    std::chrono::steady_clock::time_point m_lastStatisticsTime;
 };
 } // namespace k4aviewer
 
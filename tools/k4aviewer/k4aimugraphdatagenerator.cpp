@@ -18,8 +18,57 @@ using namespace k4aviewer;
 
 void K4AImuGraphDataGenerator::NotifyData(const k4a_imu_sample_t &sample)
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    QueueSample(PendingSample{ false, sample });
+}
+
+void K4AImuGraphDataGenerator::NotifyTermination()
+{
+    m_failed = true;
+}
+
+void K4AImuGraphDataGenerator::ClearData()
+{
+    QueueSample(PendingSample{ true, k4a_imu_sample_t() });
+}
+
+K4AImuGraphDataGenerator::GraphReader K4AImuGraphDataGenerator::GetGraphData()
+{
+    while (!m_pendingSamples.Empty())
+    {
+        const PendingSample *pendingSample = m_pendingSamples.CurrentItem();
+        if (pendingSample->ClearsGraph)
+        {
+            ResetGraph();
+        }
+        else
+        {
+            AddSample(pendingSample->Sample);
+        }
+        m_pendingSamples.AdvanceRead();
+    }
+
+    return GraphReader{ &m_graphData };
+}
+
+K4AImuGraphDataGenerator::K4AImuGraphDataGenerator()
+{
+    ResetGraph();
+}
 
+void K4AImuGraphDataGenerator::QueueSample(const PendingSample &pendingSample)
+{
+    // If the render thread has fallen far enough behind that the queue is full, the sample is dropped;
+    // the graph is an approximation anyway.
+    //
+    if (m_pendingSamples.BeginInsert())
+    {
+        *m_pendingSamples.InsertionItem() = pendingSample;
+        m_pendingSamples.EndInsert();
+    }
+}
+
+void K4AImuGraphDataGenerator::AddSample(const k4a_imu_sample_t &sample)
+{
     for (int i = 0; i < 3; ++i)
     {
         m_accAccumulator.v[i] += sample.acc_sample.v[i];
@@ -49,15 +98,8 @@ void K4AImuGraphDataGenerator::NotifyData(const k4a_imu_sample_t &sample)
     }
 }
 
-void K4AImuGraphDataGenerator::NotifyTermination()
+void K4AImuGraphDataGenerator::ResetGraph()
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_failed = true;
-}
-
-void K4AImuGraphDataGenerator::ClearData()
-{
-    std::lock_guard<std::mutex> lock(m_mutex);
     ResetAccumulators();
     std::fill(m_graphData.AccData.begin(), m_graphData.AccData.end(), k4a_float3_t{ { 0.f, 0.f, 0.f } });
     std::fill(m_graphData.GyroData.begin(), m_graphData.GyroData.end(), k4a_float3_t{ { 0.f, 0.f, 0.f } });
@@ -69,12 +111,6 @@ void K4AImuGraphDataGenerator::ClearData()
     m_graphData.LastTemperature = std::numeric_limits<float>::quiet_NaN();
 }
 
-K4AImuGraphDataGenerator::K4AImuGraphDataGenerator()
-{
-    ClearData();
-    ResetAccumulators();
-}
-
 void K4AImuGraphDataGenerator::ResetAccumulators()
 {
     m_gyroAccumulator = { { 0.f, 0.f, 0.f } };
@@ -6,7 +6,7 @@
 
 // System headers
 //
-#include <mutex>
+#include <atomic>
 
 // Library headers
 //
@@ -47,18 +47,16 @@ public:
 
     struct GraphReader
     {
-        std::unique_lock<std::mutex> Lock;
         const K4AImuGraphData *Data;
     };
 
-    // Returns a pointer-to-graph-data and a lock that guarantees
-    // that the graph data won't be modified.  You must release the lock
-    // in a timely fashion or the graph generator will hang.
+    // Folds the samples received since the last call into the graph and returns a pointer-to-graph-data.
     //
-    GraphReader GetGraphData() const
-    {
-        return GraphReader{ std::unique_lock<std::mutex>(m_mutex), &m_graphData };
-    }
+    // Samples are handed over from the thread that calls NotifyData() through a lock-free queue, so
+    // the graph data is only ever touched by the thread that calls GetGraphData() (i.e. the render
+    // thread), and the data will not be modified until the next call to GetGraphData().
+    //
+    GraphReader GetGraphData();
 
     bool IsFailed() const
     {
@@ -72,17 +70,34 @@ public:
     static constexpr int SamplesPerGraph = SamplesPerAggregateSample * K4AImuGraphData::GraphSampleCount;
 
 private:
+    // An entry in the queue between NotifyData() and GetGraphData().  ClearData() queues an entry
+    // that clears the graph so it's ordered with respect to the samples around it.
+    //
+    struct PendingSample
+    {
+        bool ClearsGraph;
+        k4a_imu_sample_t Sample;
+    };
+
+    // Big enough to hold the samples that are posted all at once to refill the graph after
+    // seeking in a recording
+    //
+    static constexpr size_t PendingSampleCount = 2 * SamplesPerGraph;
+
+    void QueueSample(const PendingSample &pendingSample);
+    void AddSample(const k4a_imu_sample_t &sample);
+    void ResetGraph();
     void ResetAccumulators();
 
+    K4ALockFreeRingBuffer<PendingSample, PendingSampleCount> m_pendingSamples;
+
     K4AImuGraphData m_graphData;
 
-    bool m_failed = false;
+    std::atomic<bool> m_failed{ false };
 
     k4a_float3_t m_gyroAccumulator;
     k4a_float3_t m_accAccumulator;
     int m_accumulatorCount = 0;
-
-    mutable std::mutex m_mutex;
 };
 } // namespace k4aviewer
 
@@ -6,6 +6,7 @@
 
 // System headers
 //
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <vector>
@@ -74,8 +75,11 @@ private:
 
     SoundIoInStreamUniquePtr m_inStream = nullptr;
     std::shared_ptr<SoundIoDevice> m_device = nullptr;
-    bool m_started = false;
-    int m_statusCode = SoundIoErrorNone;
+
+    // Set from the libsoundio callback thread when the stream fails
+    //
+    std::atomic<bool> m_started{ false };
+    std::atomic<int> m_statusCode{ SoundIoErrorNone };
 };
 } // namespace k4aviewer
 
@@ -6,6 +6,7 @@
 
 // System headers
 //
+#include <atomic>
 #include <functional>
 #include <memory>
 
@@ -67,7 +68,10 @@ private:
     SoundIoRingBufferUniquePtr m_buffer;
     std::shared_ptr<K4AMicrophone> m_backingDevice;
     int m_statusCode = SoundIoErrorNone;
-    bool m_overflowed = false;
+
+    // Set from the libsoundio callback thread, which is the producer side of m_buffer
+    //
+    std::atomic<bool> m_overflowed{ false };
 };
 } // namespace k4aviewer
 
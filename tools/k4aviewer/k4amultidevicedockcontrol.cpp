@@ -0,0 +1,144 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// Associated header
+//
+#include "k4amultidevicedockcontrol.h"
+
+// System headers
+//
+#include <algorithm>
+
+// Library headers
+//
+#include "k4aimgui_all.h"
+
+// Project headers
+//
+#include "k4aimguiextensions.h"
+#include "k4aviewerutil.h"
+
+using namespace k4aviewer;
+
+K4AMultiDeviceDockControl::K4AMultiDeviceDockControl(std::vector<k4a::device> &&devices)
+{
+    for (k4a::device &device : devices)
+    {
+        m_deviceControls.emplace_back(std14::make_unique<K4ADeviceDockControl>(std::move(device)));
+    }
+}
+
+K4ADockControlStatus K4AMultiDeviceDockControl::Show()
+{
+    ImGui::Text("%d devices", static_cast<int>(m_deviceControls.size()));
+    ImGui::SameLine();
+    {
+        ImGuiExtensions::ButtonColorChanger cc(ImGuiExtensions::ButtonColor::Red);
+        if (ImGui::SmallButton("Close all devices"))
+        {
+            return K4ADockControlStatus::ShouldClose;
+        }
+    }
+
+    ImGui::Separator();
+
+    const bool anyStarted = std::any_of(m_deviceControls.begin(),
+                                        m_deviceControls.end(),
+                                        [](const std::unique_ptr<K4ADeviceDockControl> &control) {
+                                            return control->DeviceIsStarted();
+                                        });
+    const bool allStarted = std::all_of(m_deviceControls.begin(),
+                                        m_deviceControls.end(),
+                                        [](const std::unique_ptr<K4ADeviceDockControl> &control) {
+                                            return control->DeviceIsStarted();
+                                        });
+
+    const ImVec2 buttonSize{ 135, 0 };
+    {
+        ImGuiExtensions::ButtonColorChanger cc(ImGuiExtensions::ButtonColor::Green);
+        if (ImGuiExtensions::K4AButton("Start all", buttonSize, !allStarted))
+        {
+            StartAll();
+        }
+    }
+    ImGui::SameLine();
+    {
+        ImGuiExtensions::ButtonColorChanger cc(ImGuiExtensions::ButtonColor::Red);
+        if (ImGuiExtensions::K4AButton("Stop all", buttonSize, anyStarted))
+        {
+            StopAll();
+        }
+    }
+
+    for (const auto &control : m_deviceControls)
+    {
+        if (control->CamerasStarted())
+        {
+            ImGui::Text("%s: %.2f fps", control->GetSerialNumber().c_str(), control->GetCaptureFramerate());
+        }
+        else
+        {
+            ImGui::Text("%s: %s",
+                        control->GetSerialNumber().c_str(),
+                        control->DeviceIsStarted() ? "started" : "stopped");
+        }
+    }
+
+    ImGui::Separator();
+
+    for (auto control = m_deviceControls.begin(); control != m_deviceControls.end();)
+    {
+        // Every device shows the same controls, so they need unique IDs
+        //
+        ImGui::PushID((*control)->GetSerialNumber().c_str());
+
+        K4ADockControlStatus status = K4ADockControlStatus::Ok;
+        ImGui::SetNextTreeNodeOpen(true, ImGuiCond_FirstUseEver);
+        if (ImGui::TreeNode((*control)->GetSerialNumber().c_str()))
+        {
+            status = (*control)->Show();
+            ImGui::TreePop();
+        }
+
+        ImGui::PopID();
+
+        if (status == K4ADockControlStatus::ShouldClose)
+        {
+            control = m_deviceControls.erase(control);
+        }
+        else
+        {
+            ++control;
+        }
+    }
+
+    return m_deviceControls.empty() ? K4ADockControlStatus::ShouldClose : K4ADockControlStatus::Ok;
+}
+
+void K4AMultiDeviceDockControl::StartAll()
+{
+    // Subordinate devices have to be listening for the master's sync signal before the master starts
+    //
+    for (const bool startSubordinates : { true, false })
+    {
+        for (const auto &control : m_deviceControls)
+        {
+            const bool isSubordinate = control->GetWiredSyncMode() == K4A_WIRED_SYNC_MODE_SUBORDINATE;
+            if (isSubordinate == startSubordinates && !control->DeviceIsStarted())
+            {
+                control->Start();
+            }
+        }
+    }
+}
+
+void K4AMultiDeviceDockControl::StopAll()
+{
+    for (const auto &control : m_deviceControls)
+    {
+        if (control->DeviceIsStarted())
+        {
+            control->Stop();
+        }
+    }
+}
@@ -0,0 +1,51 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef K4AMULTIDEVICEDOCKCONTROL_H
+#define K4AMULTIDEVICEDOCKCONTROL_H
+
+// System headers
+//
+#include <memory>
+#include <vector>
+
+// Library headers
+//
+#include <k4a/k4a.hpp>
+
+// Project headers
+//
+#include "ik4adockcontrol.h"
+#include "k4adevicedockcontrol.h"
+
+namespace k4aviewer
+{
+
+// Shows several devices at once.  Each device keeps its own configuration controls, and the window
+// manager tiles each device's windows next to the others'.  All devices share the viewer's OpenGL
+// context and render thread (which does all texture uploads) and the image conversion threads in
+// K4ADecodeWorkerPool, so adding a device only adds its polling threads.
+//
+class K4AMultiDeviceDockControl : public IK4ADockControl
+{
+public:
+    explicit K4AMultiDeviceDockControl(std::vector<k4a::device> &&devices);
+    ~K4AMultiDeviceDockControl() override = default;
+
+    K4ADockControlStatus Show() override;
+
+    K4AMultiDeviceDockControl(const K4AMultiDeviceDockControl &) = delete;
+    K4AMultiDeviceDockControl(const K4AMultiDeviceDockControl &&) = delete;
+    K4AMultiDeviceDockControl &operator=(const K4AMultiDeviceDockControl &) = delete;
+    K4AMultiDeviceDockControl &operator=(const K4AMultiDeviceDockControl &&) = delete;
+
+private:
+    void StartAll();
+    void StopAll();
+
+    std::vector<std::unique_ptr<K4ADeviceDockControl>> m_deviceControls;
+};
+
+} // namespace k4aviewer
+
+#endif
@@ -43,6 +43,9 @@ PointCloudRenderer::PointCloudRenderer()
     m_viewIndex = glGetUniformLocation(m_shaderProgram.Id(), "view");
     m_projectionIndex = glGetUniformLocation(m_shaderProgram.Id(), "projection");
     m_enableShadingIndex = glGetUniformLocation(m_shaderProgram.Id(), "enableShading");
+    m_pointSizeIndex = glGetUniformLocation(m_shaderProgram.Id(), "pointSize");
+    m_enableLevelOfDetailIndex = glGetUniformLocation(m_shaderProgram.Id(), "enableLevelOfDetail");
+    m_viewportSizeIndex = glGetUniformLocation(m_shaderProgram.Id(), "viewportSize");
     m_pointCloudTextureIndex = glGetUniformLocation(m_shaderProgram.Id(), "pointCloudTexture");
 }
 
@@ -52,24 +55,28 @@ void PointCloudRenderer::UpdateViewProjection(mat4x4 view, mat4x4 projection)
     mat4x4_dup(m_projection, projection);
 }
 
-GLenum PointCloudRenderer::UpdatePointClouds(const k4a::image &color, const OpenGL::Texture &pointCloudTexture)
+GLenum PointCloudRenderer::UpdatePointClouds(const k4a::image &color,
+                                             const OpenGL::Texture &pointCloudTexture,
+                                             const int decimation)
 {
     glBindVertexArray(m_vertexArrayObject.Id());
 
     // Vertex Colors
     //
-    glBindBuffer(GL_ARRAY_BUFFER, m_vertexColorBufferObject.Id());
-
-    const int colorImageSizeBytes = static_cast<int>(color.get_size());
-
-    if (m_vertexArraySizeBytes != colorImageSizeBytes)
+    const int colorWidth = color.get_width_pixels();
+    const int colorHeight = color.get_height_pixels();
+    const ImageDimensions pointCloudDimensions =
+        GpuDepthToPointCloudConverter::GetPointCloudDimensions(colorWidth, colorHeight, decimation);
+    const int colorImageSizeBytes = pointCloudDimensions.Width * pointCloudDimensions.Height *
+                                    static_cast<int>(sizeof(BgraPixel));
+
+    if (m_vertexArraySizeBytes != colorImageSizeBytes || !m_vertexColorBufferObject)
     {
         m_vertexArraySizeBytes = colorImageSizeBytes;
-        glBufferData(GL_ARRAY_BUFFER, m_vertexArraySizeBytes, nullptr, GL_STREAM_DRAW);
+        m_vertexColorBufferObject.Init(GL_ARRAY_BUFFER, m_vertexArraySizeBytes);
     }
 
-    GLubyte *vertexMappedBuffer = reinterpret_cast<GLubyte *>(
-        glMapBufferRange(GL_ARRAY_BUFFER, 0, colorImageSizeBytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+    GLubyte *vertexMappedBuffer = m_vertexColorBufferObject.BeginWrite();
 
     if (!vertexMappedBuffer)
     {
@@ -77,14 +84,35 @@ GLenum PointCloudRenderer::UpdatePointClouds(const k4a::image &color, const Open
     }
 
     const GLubyte *colorSrc = reinterpret_cast<const GLubyte *>(color.get_buffer());
-    std::copy(colorSrc, colorSrc + colorImageSizeBytes, vertexMappedBuffer);
-    if (!glUnmapBuffer(GL_ARRAY_BUFFER))
+    if (decimation == 1)
+    {
+        std::copy(colorSrc, colorSrc + colorImageSizeBytes, vertexMappedBuffer);
+    }
+    else
+    {
+        const size_t colorStride = color.get_stride_bytes();
+        BgraPixel *dstPixel = reinterpret_cast<BgraPixel *>(vertexMappedBuffer);
+        for (int y = 0; y < colorHeight; y += decimation)
+        {
+            const BgraPixel *srcRow = reinterpret_cast<const BgraPixel *>(colorSrc + y * colorStride);
+            for (int x = 0; x < colorWidth; x += decimation)
+            {
+                *dstPixel++ = srcRow[x];
+            }
+        }
+    }
+    if (!m_vertexColorBufferObject.EndWrite())
     {
         return glGetError();
     }
 
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, GL_BGRA, GL_UNSIGNED_BYTE, GL_TRUE, 0, 0);
+    glVertexAttribPointer(0,
+                          GL_BGRA,
+                          GL_UNSIGNED_BYTE,
+                          GL_TRUE,
+                          0,
+                          reinterpret_cast<const void *>(m_vertexColorBufferObject.CurrentOffset()));
 
     glUseProgram(m_shaderProgram.Id());
 
@@ -125,11 +153,21 @@ GLenum PointCloudRenderer::Render()
     // Update render settings in shader
     //
     glUniform1i(m_enableShadingIndex, static_cast<GLint>(m_enableShading));
+    glUniform1f(m_pointSizeIndex, static_cast<GLfloat>(m_pointSize));
+    glUniform1i(m_enableLevelOfDetailIndex, static_cast<GLint>(m_enableLevelOfDetail));
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    glUniform2f(m_viewportSizeIndex, static_cast<GLfloat>(viewport[2]), static_cast<GLfloat>(viewport[3]));
 
     // Render point cloud
     //
     glBindVertexArray(m_vertexArrayObject.Id());
     glDrawArrays(GL_POINTS, 0, m_vertexArraySizeBytes / static_cast<GLsizei>(sizeof(BgraPixel)));
+    if (m_vertexColorBufferObject)
+    {
+        m_vertexColorBufferObject.FenceCurrentRegion();
+    }
 
     glBindVertexArray(0);
 
@@ -155,3 +193,8 @@ bool PointCloudRenderer::ShadingIsEnabled() const
 {
     return m_enableShading;
 }
+
+void PointCloudRenderer::EnableLevelOfDetail(bool enableLevelOfDetail)
+{
+    m_enableLevelOfDetail = enableLevelOfDetail;
+}
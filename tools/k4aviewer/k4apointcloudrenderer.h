@@ -16,6 +16,7 @@
 // Project headers
 //
 #include "openglhelpers.h"
+#include "openglstreamingbuffer.h"
 
 namespace k4aviewer
 {
@@ -27,7 +28,10 @@ public:
 
     void UpdateViewProjection(linmath::mat4x4 view, linmath::mat4x4 projection);
 
-    GLenum UpdatePointClouds(const k4a::image &color, const OpenGL::Texture &pointCloudTexture);
+    // pointCloudTexture must have been output by GpuDepthToPointCloudConverter::Convert() with the same
+    // decimation; only the colors of the pixels that were converted to points are uploaded.
+    //
+    GLenum UpdatePointClouds(const k4a::image &color, const OpenGL::Texture &pointCloudTexture, int decimation = 1);
 
     GLenum Render();
 
@@ -35,6 +39,7 @@ public:
     int GetPointSize() const;
     void EnableShading(bool enableShading);
     bool ShadingIsEnabled() const;
+    void EnableLevelOfDetail(bool enableLevelOfDetail);
 
     PointCloudRenderer(PointCloudRenderer &) = delete;
     PointCloudRenderer(PointCloudRenderer &&) = delete;
@@ -48,6 +53,7 @@ private:
     // Render settings
     int m_pointSize = 2;
     bool m_enableShading = true;
+    bool m_enableLevelOfDetail = false;
 
     // Point Array Size
     GLsizei m_vertexArraySizeBytes = 0;
@@ -57,10 +63,13 @@ private:
     GLint m_viewIndex;
     GLint m_projectionIndex;
     GLint m_enableShadingIndex;
+    GLint m_pointSizeIndex;
+    GLint m_enableLevelOfDetailIndex;
+    GLint m_viewportSizeIndex;
     GLint m_pointCloudTextureIndex;
 
     OpenGL::VertexArray m_vertexArrayObject = OpenGL::VertexArray(true);
-    OpenGL::Buffer m_vertexColorBufferObject = OpenGL::Buffer(true);
+    OpenGL::StreamingBuffer m_vertexColorBufferObject;
 };
 } // namespace k4aviewer
 #endif
@@ -37,11 +37,19 @@ uniform mat4 view;
 uniform mat4 projection;
 layout(rgba32f) readonly uniform image2D pointCloudTexture;
 uniform bool enableShading;
+uniform float pointSize;
+
+// In level of detail mode, points grow to cover the gap to their neighbor on screen, so a subsampled
+// point cloud still looks solid
+//
+uniform bool enableLevelOfDetail;
+uniform vec2 viewportSize;
+const float MaxLevelOfDetailPointSize = 16.0f;
 
 bool GetPoint3d(in vec2 pointCloudSize, in ivec2 point2d, out vec3 point3d)
 {
     if (point2d.x < 0 || point2d.x >= pointCloudSize.x ||
-        point2d.y < 0 || point3d.y >= pointCloudSize.y)
+        point2d.y < 0 || point2d.y >= pointCloudSize.y)
     {
         return false;
     }
@@ -63,6 +71,16 @@ void main()
 
     gl_Position = projection * view * vec4(vertexPosition, 1);
 
+    gl_PointSize = pointSize;
+    vec3 neighbor;
+    if (enableLevelOfDetail && GetPoint3d(pointCloudSize, currentDepthPixelCoordinates + ivec2(1, 0), neighbor))
+    {
+        vec4 neighborPosition = projection * view * vec4(neighbor, 1);
+        vec2 screenDistance = (gl_Position.xy / gl_Position.w - neighborPosition.xy / neighborPosition.w) *
+                              0.5f * viewportSize;
+        gl_PointSize = clamp(length(screenDistance), pointSize, max(pointSize, MaxLevelOfDetailPointSize));
+    }
+
     vertexColor = inColor;
 
     // Pass along the 'invalid pixel' flag as the alpha channel
@@ -7,6 +7,8 @@
 
 // System headers
 //
+#include <algorithm>
+#include <limits>
 
 // Library headers
 //
@@ -15,7 +17,6 @@
 // Project headers
 //
 #include "k4acolorimageconverter.h"
-#include "k4adepthpixelcolorizer.h"
 #include "k4astaticimageproperties.h"
 #include "k4aviewerutil.h"
 #include "perfcounter.h"
@@ -42,6 +43,13 @@ GLenum K4APointCloudVisualizer::InitializeTexture(std::shared_ptr<K4AViewerImage
 PointCloudVisualizationResult K4APointCloudVisualizer::UpdateTexture(std::shared_ptr<K4AViewerImage> *texture,
                                                                      const k4a::capture &capture)
 {
+    // Level of detail mode picks the decimation from the view, so update the view first
+    //
+    const linmath::vec2 displayDimensions{ static_cast<float>(m_dimensions.Width),
+                                           static_cast<float>(m_dimensions.Height) };
+    m_viewControl.GetPerspectiveMatrix(m_projection, displayDimensions);
+    m_viewControl.GetViewMatrix(m_view);
+
     // Update the point cloud renderer with the latest point data
     //
     PointCloudVisualizationResult result = UpdatePointClouds(capture);
@@ -76,11 +84,6 @@ PointCloudVisualizationResult K4APointCloudVisualizer::UpdateTexture(std::shared
 
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    const linmath::vec2 displayDimensions{ static_cast<float>(m_dimensions.Width),
-                                           static_cast<float>(m_dimensions.Height) };
-    m_viewControl.GetPerspectiveMatrix(m_projection, displayDimensions);
-    m_viewControl.GetViewMatrix(m_view);
-
     m_pointCloudRenderer.UpdateViewProjection(m_view, m_projection);
 
     GLenum renderStatus = m_pointCloudRenderer.Render();
@@ -171,6 +174,49 @@ void K4APointCloudVisualizer::SetPointSize(int size)
     m_pointCloudRenderer.SetPointSize(size);
 }
 
+void K4APointCloudVisualizer::SetDecimation(const int decimation)
+{
+    if (decimation != 1 && decimation != 2 && decimation != 4 && decimation != MaxDecimation)
+    {
+        throw std::logic_error("Invalid point cloud decimation!");
+    }
+    m_decimation = decimation;
+}
+
+void K4APointCloudVisualizer::EnableLevelOfDetail(const bool enableLevelOfDetail)
+{
+    m_enableLevelOfDetail = enableLevelOfDetail;
+    m_pointCloudRenderer.EnableLevelOfDetail(enableLevelOfDetail);
+}
+
+int K4APointCloudVisualizer::GetEffectiveDecimation() const
+{
+    int decimation = m_decimation;
+    if (m_enableLevelOfDetail)
+    {
+        // Halve the point density every time the distance to the point cloud doubles
+        //
+        const float distanceRatio = GetViewDistance() / m_levelOfDetailReferenceDistance;
+        for (float ratio = distanceRatio; ratio >= 2.0f && decimation < MaxDecimation; ratio /= 2.0f)
+        {
+            decimation *= 2;
+        }
+    }
+    return decimation;
+}
+
+float K4APointCloudVisualizer::GetViewDistance() const
+{
+    // Points are in meters, with Z pointing away from the sensor
+    //
+    const float middleDepthMeters = (m_expectedValueRange.first + m_expectedValueRange.second) / 2.0f / 1000.0f;
+    linmath::vec4 middlePoint{ 0.f, 0.f, middleDepthMeters, 1.f };
+
+    linmath::vec4 viewPoint;
+    linmath::mat4x4_mul_vec4(viewPoint, const_cast<linmath::vec4 *>(m_view), middlePoint);
+    return std::max(linmath::vec3_len(viewPoint), std::numeric_limits<float>::epsilon());
+}
+
 K4APointCloudVisualizer::K4APointCloudVisualizer(const bool enableColorPointCloud,
                                                  const k4a::calibration &calibrationData) :
     m_dimensions(PointCloudVisualizerTextureDimensions),
@@ -187,6 +233,8 @@ K4APointCloudVisualizer::K4APointCloudVisualizer(const bool enableColorPointClou
     linmath::mat4x4_identity(m_projection);
 
     m_viewControl.ResetPosition();
+    m_viewControl.GetViewMatrix(m_view);
+    m_levelOfDetailReferenceDistance = GetViewDistance();
 
     if (enableColorPointCloud)
     {
@@ -233,7 +281,16 @@ PointCloudVisualizationResult K4APointCloudVisualizer::UpdatePointClouds(const k
         }
     }
 
-    GLenum glResult = m_pointCloudConverter.Convert(depthImage, &m_xyzTexture);
+    // The XYZ texture gets smaller as the decimation goes up, so it needs to be reallocated if it changes
+    //
+    const int decimation = GetEffectiveDecimation();
+    if (decimation != m_xyzTextureDecimation)
+    {
+        m_xyzTexture.Reset();
+        m_xyzTextureDecimation = decimation;
+    }
+
+    GLenum glResult = m_pointCloudConverter.Convert(depthImage, &m_xyzTexture, decimation);
     if (glResult != GL_NO_ERROR)
     {
         return PointCloudVisualizationResult::DepthToXyzTransformationFailed;
@@ -247,22 +304,15 @@ PointCloudVisualizationResult K4APointCloudVisualizer::UpdatePointClouds(const k
     }
     else
     {
-        DepthPixel *srcPixel = reinterpret_cast<DepthPixel *>(depthImage.get_buffer());
-        BgraPixel *dstPixel = reinterpret_cast<BgraPixel *>(m_pointCloudColorization.get_buffer());
-        const BgraPixel *endPixel = dstPixel + (depthImage.get_size() / sizeof(DepthPixel));
-
-        while (dstPixel != endPixel)
-        {
-            *dstPixel = K4ADepthPixelColorizer::ColorizeBlueToRed(*srcPixel,
-                                                                  m_expectedValueRange.first,
-                                                                  m_expectedValueRange.second);
-
-            ++dstPixel;
-            ++srcPixel;
-        }
+        depthImage.colorize(m_expectedValueRange.first,
+                            m_expectedValueRange.second,
+                            K4A_COLORMAP_BLUE_TO_RED,
+                            m_pointCloudColorization);
     }
 
-    GLenum updatePointCloudResult = m_pointCloudRenderer.UpdatePointClouds(m_pointCloudColorization, m_xyzTexture);
+    GLenum updatePointCloudResult = m_pointCloudRenderer.UpdatePointClouds(m_pointCloudColorization,
+                                                                           m_xyzTexture,
+                                                                           decimation);
     if (updatePointCloudResult != GL_NO_ERROR)
     {
         return PointCloudVisualizationResult::OpenGlError;
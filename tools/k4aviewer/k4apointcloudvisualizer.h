@@ -57,6 +57,18 @@ public:
     PointCloudVisualizationResult SetColorizationStrategy(ColorizationStrategy strategy);
     void SetPointSize(int size);
 
+    // Only renders every decimation'th depth pixel of every decimation'th row.
+    // Must be 1, 2, 4 or 8.
+    //
+    void SetDecimation(int decimation);
+
+    // In level of detail mode, the point cloud is decimated further as the camera moves away from it
+    // (up to MaxDecimation), and points are sized to cover the gaps between them on screen.
+    //
+    void EnableLevelOfDetail(bool enableLevelOfDetail);
+
+    static constexpr int MaxDecimation = 8;
+
     K4APointCloudVisualizer(bool enableColorPointCloud, const k4a::calibration &calibrationData);
     ~K4APointCloudVisualizer() = default;
 
@@ -67,6 +79,8 @@ public:
 
 private:
     PointCloudVisualizationResult UpdatePointClouds(const k4a::capture &capture);
+    int GetEffectiveDecimation() const;
+    float GetViewDistance() const;
 
     std::pair<DepthPixel, DepthPixel> m_expectedValueRange;
     ImageDimensions m_dimensions;
@@ -77,6 +91,18 @@ private:
     bool m_enableColorPointCloud = false;
     ColorizationStrategy m_colorizationStrategy;
 
+    int m_decimation = 1;
+    bool m_enableLevelOfDetail = false;
+
+    // The decimation m_xyzTexture was created for
+    //
+    int m_xyzTextureDecimation = 1;
+
+    // Distance from the camera to the middle of the depth range in the default view, which level of
+    // detail mode renders at the configured decimation
+    //
+    float m_levelOfDetailReferenceDistance = 1.0f;
+
     linmath::mat4x4 m_projection{};
     linmath::mat4x4 m_view{};
 
@@ -26,6 +26,10 @@ using namespace k4aviewer;
 namespace
 {
 constexpr int DefaultPointSize = 2;
+
+// Decimation is 1 << the index of the label; it applies to both rows and columns
+//
+const char *const DecimationLabels[] = { "Every pixel", "Every 2nd", "Every 4th", "Every 8th" };
 }
 
 void K4APointCloudWindow::Show(K4AWindowPlacementInfo placementInfo)
@@ -60,6 +64,7 @@ void K4APointCloudWindow::Show(K4AWindowPlacementInfo placementInfo)
     ImVec2 availableSize = placementInfo.Size;
     availableSize.y -= GetDefaultButtonHeight(); // Mode radio buttons
     availableSize.y -= GetDefaultButtonHeight(); // Reset button
+    availableSize.y -= GetDefaultButtonHeight(); // Decimation controls
 
     const ImVec2 sourceImageSize = ImVec2(static_cast<float>(m_texture->GetDimensions().Width),
                                           static_cast<float>(m_texture->GetDimensions().Height));
@@ -121,6 +126,21 @@ void K4APointCloudWindow::Show(K4AWindowPlacementInfo placementInfo)
         m_pointCloudVisualizer.SetPointSize(m_pointSize);
     }
 
+    // Rendering fewer points keeps large point clouds (e.g. WFOV unbinned) at sensor rate on slower GPUs
+    //
+    ImGui::PushItemWidth(ImGui::CalcItemWidth() * 0.5f);
+    if (ImGui::Combo("Decimation", &m_decimationIndex, DecimationLabels, IM_ARRAYSIZE(DecimationLabels)))
+    {
+        m_pointCloudVisualizer.SetDecimation(1 << m_decimationIndex);
+    }
+    ImGui::PopItemWidth();
+    ImGui::SameLine();
+    if (ImGui::Checkbox("Level of detail", &m_enableLevelOfDetail))
+    {
+        m_pointCloudVisualizer.EnableLevelOfDetail(m_enableLevelOfDetail);
+    }
+    ImGuiExtensions::K4AShowTooltip("Render fewer, larger points as the camera moves away from the point cloud");
+
     ProcessInput(imageStartPos, textureSize);
 }
 
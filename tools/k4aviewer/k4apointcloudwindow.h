@@ -50,6 +50,8 @@ private:
     K4APointCloudVisualizer::ColorizationStrategy m_colorizationStrategy =
         K4APointCloudVisualizer::ColorizationStrategy::Shaded;
     int m_pointSize;
+    int m_decimationIndex = 0;
+    bool m_enableLevelOfDetail = false;
 
     bool m_enableColorPointCloud = false;
 
@@ -48,6 +48,17 @@ K4ARecordingDockControl::K4ARecordingDockControl(std::string &&path, k4a::playba
     // Recording config
     //
     m_recordConfiguration = recording.get_record_configuration();
+
+    // Has to happen before we switch the recording's color format to BGRA below, since the thumbnails
+    // are read from the original color images
+    //
+    if (m_recordConfiguration.color_track_enabled)
+    {
+        m_thumbnails = std14::make_unique<K4ARecordingThumbnails>(m_filenameLabel,
+                                                                  m_recordConfiguration,
+                                                                  recording.get_recording_length());
+    }
+
     std::stringstream fpsSS;
     fpsSS << m_recordConfiguration.camera_fps;
     m_fpsLabel = fpsSS.str();
@@ -138,7 +149,7 @@ K4ADockControlStatus K4ARecordingDockControl::Show()
     ImGuiExtensions::ButtonColorChanger cc(ImGuiExtensions::ButtonColor::Red);
     if (ImGui::SmallButton("Close"))
     {
-        K4AWindowManager::Instance().ClearWindows();
+        K4AWindowManager::Instance().ClearWindows(m_filenameLabel);
         return K4ADockControlStatus::ShouldClose;
     }
     cc.Clear();
@@ -191,10 +202,36 @@ K4ADockControlStatus K4ARecordingDockControl::Show()
         paused = m_playbackThreadState.Paused;
     }
 
-    if (ImGui::SliderScalar("##seek", ImGuiDataType_U64, &currentTimestampUs, &seekMin, &seekMax, ""))
+    uint64_t seekTimestampUs = m_scrubbing ? m_scrubTimestampUs : currentTimestampUs;
+    const bool seekChanged =
+        ImGui::SliderScalar("##seek", ImGuiDataType_U64, &seekTimestampUs, &seekMin, &seekMax, "");
+    const bool seekActive = ImGui::IsItemActive();
+    if (m_thumbnails && (seekActive || m_scrubbing))
+    {
+        if (seekActive)
+        {
+            if (!m_scrubbing)
+            {
+                std::lock_guard<std::mutex> lock(m_playbackThreadState.Mutex);
+                m_playbackThreadState.Paused = true;
+            }
+            m_scrubbing = true;
+            m_scrubTimestampUs = seekTimestampUs;
+        }
+        else
+        {
+            // The user let go of the seek bar, so now we do the real seek
+            //
+            m_scrubbing = false;
+            std::lock_guard<std::mutex> lock(m_playbackThreadState.Mutex);
+            m_playbackThreadState.SeekTimestamp = std::chrono::microseconds(m_scrubTimestampUs);
+            m_playbackThreadState.Paused = true;
+        }
+    }
+    else if (seekChanged)
     {
         std::lock_guard<std::mutex> lock(m_playbackThreadState.Mutex);
-        m_playbackThreadState.SeekTimestamp = std::chrono::microseconds(currentTimestampUs);
+        m_playbackThreadState.SeekTimestamp = std::chrono::microseconds(seekTimestampUs);
         m_playbackThreadState.Paused = true;
     }
     ImGui::SameLine();
@@ -232,9 +269,63 @@ K4ADockControlStatus K4ARecordingDockControl::Show()
         return this->SetViewType(t);
     });
 
+    if (m_thumbnails)
+    {
+        const float thumbnailProgress = m_thumbnails->GetProgress();
+        if (thumbnailProgress < 1.f)
+        {
+            ImGui::Text("Generating seek thumbnails: %d%%", static_cast<int>(thumbnailProgress * 100));
+        }
+
+        if (m_scrubbing)
+        {
+            ShowSeekThumbnail(std::chrono::microseconds(m_scrubTimestampUs));
+        }
+    }
+
     return K4ADockControlStatus::Ok;
 }
 
+void K4ARecordingDockControl::ShowSeekThumbnail(const std::chrono::microseconds timestamp)
+{
+    size_t index;
+    if (!m_thumbnails->FindThumbnail(timestamp, &index))
+    {
+        return;
+    }
+
+    if (!m_thumbnailTexture || index != m_thumbnailTextureIndex)
+    {
+        if (!m_thumbnails->DecodeThumbnail(index, &m_thumbnailBuffer))
+        {
+            return;
+        }
+
+        GLenum result;
+        if (m_thumbnailTexture)
+        {
+            result = m_thumbnailTexture->UpdateTexture(m_thumbnailBuffer.data());
+        }
+        else
+        {
+            result = K4AViewerImage::Create(&m_thumbnailTexture,
+                                            m_thumbnailBuffer.data(),
+                                            m_thumbnails->GetDimensions());
+        }
+
+        if (result != GL_NO_ERROR)
+        {
+            m_thumbnailTexture.reset();
+            return;
+        }
+        m_thumbnailTextureIndex = index;
+    }
+
+    const ImageDimensions dimensions = m_thumbnailTexture->GetDimensions();
+    ImGui::Image(static_cast<ImTextureID>(*m_thumbnailTexture),
+                 ImVec2(static_cast<float>(dimensions.Width), static_cast<float>(dimensions.Height)));
+}
+
 bool K4ARecordingDockControl::PlaybackThreadFn(PlaybackThreadState *state)
 {
     try
@@ -449,7 +540,7 @@ std::chrono::microseconds K4ARecordingDockControl::GetCaptureTimestamp(const k4a
 
 void K4ARecordingDockControl::SetViewType(K4AWindowSet::ViewType viewType)
 {
-    K4AWindowManager::Instance().ClearWindows();
+    K4AWindowManager::Instance().ClearWindows(m_filenameLabel);
 
     std::lock_guard<std::mutex> lock(m_playbackThreadState.Mutex);
 
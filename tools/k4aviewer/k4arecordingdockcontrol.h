@@ -19,6 +19,8 @@
 #include "k4adatasource.h"
 #include "k4aimugraphdatagenerator.h"
 #include "k4apollingthread.h"
+#include "k4arecordingthumbnails.h"
+#include "k4aviewerimage.h"
 #include "k4awindowset.h"
 
 namespace k4aviewer
@@ -70,6 +72,8 @@ private:
 
     void SetViewType(K4AWindowSet::ViewType viewType);
 
+    void ShowSeekThumbnail(std::chrono::microseconds timestamp);
+
     // Labels / static UI state
     //
     k4a_record_configuration_t m_recordConfiguration;
@@ -97,6 +101,16 @@ private:
     K4AWindowSet::ViewType m_viewType = K4AWindowSet::ViewType::Normal;
 
     std::unique_ptr<K4APollingThread> m_playbackThread;
+
+    // While the user drags the seek bar, we show thumbnails instead of seeking and only seek when they
+    // let go, since seeking decodes a full color image.
+    //
+    std::unique_ptr<K4ARecordingThumbnails> m_thumbnails;
+    bool m_scrubbing = false;
+    uint64_t m_scrubTimestampUs = 0;
+    std::shared_ptr<K4AViewerImage> m_thumbnailTexture;
+    size_t m_thumbnailTextureIndex = 0;
+    std::vector<uint8_t> m_thumbnailBuffer;
 };
 
 } // namespace k4aviewer
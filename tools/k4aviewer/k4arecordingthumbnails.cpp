@@ -0,0 +1,440 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// Associated header
+//
+#include "k4arecordingthumbnails.h"
+
+// System headers
+//
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <memory>
+
+// Library headers
+//
+#include "libyuv.h"
+
+// Clang parses doxygen-style comments in your source and checks for doxygen syntax errors.
+// Unfortunately, some of our external dependencies have doxygen syntax errors in them, so
+// we need to shut off that warning.
+//
+#ifdef __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdocumentation"
+#pragma clang diagnostic ignored "-Wdocumentation-unknown-command"
+#endif
+
+#include "turbojpeg.h"
+
+#ifdef __clang__
+#pragma clang diagnostic pop
+#endif
+
+// Project headers
+//
+#include "k4apixel.h"
+#include "k4astaticimageproperties.h"
+#include "k4aviewerlogmanager.h"
+
+using namespace k4aviewer;
+
+namespace
+{
+constexpr int ThumbnailWidth = 256;
+constexpr int ThumbnailJpegQuality = 75;
+
+// One thumbnail per second is plenty to find your place in a recording; longer recordings get fewer
+// per second so the cache stays at a few megabytes
+//
+constexpr std::chrono::microseconds MinThumbnailInterval = std::chrono::seconds(1);
+constexpr std::chrono::microseconds::rep MaxThumbnailCount = 1000;
+
+constexpr char CacheMagic[8] = { 'K', '4', 'A', 'T', 'H', 'M', 'B', '\0' };
+constexpr uint32_t CacheVersion = 1;
+
+struct TjHandleDeleter
+{
+    void operator()(void *handle) const
+    {
+        tjDestroy(handle);
+    }
+};
+using TjHandleUniquePtr = std::unique_ptr<void, TjHandleDeleter>;
+
+template<typename T> void WriteValue(std::ofstream &file, const T &value)
+{
+    file.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template<typename T> bool ReadValue(std::ifstream &file, T *value)
+{
+    file.read(reinterpret_cast<char *>(value), sizeof(T));
+    return file.good();
+}
+
+uint64_t GetFileSize(const std::string &path)
+{
+    std::ifstream file(path.c_str(), std::ios::binary | std::ios::ate);
+    if (!file.good())
+    {
+        return 0;
+    }
+    return static_cast<uint64_t>(file.tellg());
+}
+
+void LogWarning(const std::string &message)
+{
+    K4AViewerLogManager::Instance().Log(K4A_LOG_LEVEL_WARNING, __FILE__, __LINE__, message.c_str());
+}
+} // namespace
+
+K4ARecordingThumbnails::K4ARecordingThumbnails(const std::string &recordingPath,
+                                               const k4a_record_configuration_t &recordConfiguration,
+                                               const std::chrono::microseconds recordingLength) :
+    m_recordingPath(recordingPath),
+    m_cachePath(recordingPath + ".thumbnails"),
+    m_recordingFileSize(GetFileSize(recordingPath)),
+    m_recordingLength(recordingLength),
+    m_colorFormat(recordConfiguration.color_format),
+    m_colorDimensions(GetColorDimensions(recordConfiguration.color_resolution)),
+    m_progress(0.f),
+    m_shouldExit(false)
+{
+    if (m_colorDimensions.Width > 0)
+    {
+        const int thumbnailHeight = ThumbnailWidth * m_colorDimensions.Height / m_colorDimensions.Width;
+        m_dimensions = ImageDimensions(ThumbnailWidth, std::max(1, thumbnailHeight));
+    }
+
+    if (!recordConfiguration.color_track_enabled || m_dimensions.Width == 0)
+    {
+        m_progress = 1.f;
+        return;
+    }
+
+    if (LoadCache())
+    {
+        m_progress = 1.f;
+        return;
+    }
+
+    m_generatorThread = std::thread(&K4ARecordingThumbnails::GenerateThumbnails, this);
+}
+
+K4ARecordingThumbnails::~K4ARecordingThumbnails()
+{
+    m_shouldExit = true;
+    if (m_generatorThread.joinable())
+    {
+        m_generatorThread.join();
+    }
+}
+
+bool K4ARecordingThumbnails::FindThumbnail(const std::chrono::microseconds timestamp, size_t *index) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_thumbnails.empty())
+    {
+        return false;
+    }
+
+    // Thumbnails are generated in timestamp order
+    //
+    auto next = std::lower_bound(m_thumbnails.begin(),
+                                 m_thumbnails.end(),
+                                 timestamp,
+                                 [](const Thumbnail &thumbnail, std::chrono::microseconds t) {
+                                     return thumbnail.Timestamp < t;
+                                 });
+    if (next == m_thumbnails.end() ||
+        (next != m_thumbnails.begin() && timestamp - (next - 1)->Timestamp < next->Timestamp - timestamp))
+    {
+        --next;
+    }
+
+    *index = static_cast<size_t>(next - m_thumbnails.begin());
+    return true;
+}
+
+bool K4ARecordingThumbnails::DecodeThumbnail(const size_t index, std::vector<uint8_t> *bgra) const
+{
+    TjHandleUniquePtr decompressor(tjInitDecompress());
+    if (!decompressor)
+    {
+        return false;
+    }
+
+    bgra->resize(static_cast<size_t>(m_dimensions.Width * m_dimensions.Height) * sizeof(BgraPixel));
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (index >= m_thumbnails.size())
+    {
+        return false;
+    }
+
+    const std::vector<uint8_t> &jpeg = m_thumbnails[index].Jpeg;
+    return tjDecompress2(decompressor.get(),
+                         jpeg.data(),
+                         static_cast<unsigned long>(jpeg.size()),
+                         bgra->data(),
+                         m_dimensions.Width,
+                         0, // pitch
+                         m_dimensions.Height,
+                         TJPF_BGRA,
+                         TJFLAG_FASTDCT | TJFLAG_FASTUPSAMPLE) == 0;
+}
+
+void K4ARecordingThumbnails::GenerateThumbnails()
+{
+    try
+    {
+        // We can't share the dock's handle because it's busy playing back, and this one mustn't convert
+        // color images to BGRA because we want to decode MJPG at reduced size
+        //
+        k4a::playback recording = k4a::playback::open(m_recordingPath.c_str());
+
+        const std::chrono::microseconds interval = std::max(MinThumbnailInterval,
+                                                            m_recordingLength / MaxThumbnailCount);
+
+        for (std::chrono::microseconds timestamp(0); timestamp <= m_recordingLength && !m_shouldExit;
+             timestamp += interval)
+        {
+            recording.seek_timestamp(timestamp, K4A_PLAYBACK_SEEK_BEGIN);
+
+            k4a::capture capture;
+            if (!recording.get_next_capture(&capture))
+            {
+                break;
+            }
+
+            // Captures near the start of a recording may not have a color image yet
+            //
+            const k4a::image colorImage = capture.get_color_image();
+            Thumbnail thumbnail;
+            thumbnail.Timestamp = timestamp;
+            if (colorImage && MakeThumbnail(colorImage, &thumbnail))
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_thumbnails.emplace_back(std::move(thumbnail));
+            }
+
+            const float recordingLength = std::max(1.f, static_cast<float>(m_recordingLength.count()));
+            m_progress = std::min(1.f, static_cast<float>(timestamp.count()) / recordingLength);
+        }
+    }
+    catch (const k4a::error &e)
+    {
+        LogWarning(std::string("Failed to generate recording thumbnails: ") + e.what());
+        m_progress = 1.f;
+        return;
+    }
+
+    if (!m_shouldExit)
+    {
+        m_progress = 1.f;
+        SaveCache();
+    }
+}
+
+bool K4ARecordingThumbnails::MakeThumbnail(const k4a::image &colorImage, Thumbnail *thumbnail)
+{
+    const uint8_t *buffer = colorImage.get_buffer();
+    const int width = colorImage.get_width_pixels();
+    const int height = colorImage.get_height_pixels();
+    if (width != m_colorDimensions.Width || height != m_colorDimensions.Height)
+    {
+        return false;
+    }
+
+    // Get the color image to BGRA, as small as we can before the final scale
+    //
+    ImageDimensions bgraDimensions = m_colorDimensions;
+    const int stride = width * static_cast<int>(sizeof(BgraPixel));
+
+    int result = -1;
+    switch (m_colorFormat)
+    {
+    case K4A_IMAGE_FORMAT_COLOR_MJPG:
+    {
+        TjHandleUniquePtr decompressor(tjInitDecompress());
+        if (!decompressor)
+        {
+            return false;
+        }
+
+        // turbojpeg can skip most of the work of decoding by scaling by 1/8, which is still at least
+        // as big as a thumbnail for every color resolution
+        //
+        bgraDimensions = ImageDimensions((width + 7) / 8, (height + 7) / 8);
+        m_decodeBuffer.resize(static_cast<size_t>(bgraDimensions.Width * bgraDimensions.Height) * sizeof(BgraPixel));
+        result = tjDecompress2(decompressor.get(),
+                               buffer,
+                               static_cast<unsigned long>(colorImage.get_size()),
+                               m_decodeBuffer.data(),
+                               bgraDimensions.Width,
+                               0, // pitch
+                               bgraDimensions.Height,
+                               TJPF_BGRA,
+                               TJFLAG_FASTDCT | TJFLAG_FASTUPSAMPLE);
+        break;
+    }
+
+    case K4A_IMAGE_FORMAT_COLOR_NV12:
+        m_decodeBuffer.resize(static_cast<size_t>(stride * height));
+        result = libyuv::NV12ToARGB(buffer,
+                                    width,
+                                    buffer + width * height,
+                                    width,
+                                    m_decodeBuffer.data(),
+                                    stride,
+                                    width,
+                                    height);
+        break;
+
+    case K4A_IMAGE_FORMAT_COLOR_YUY2:
+        m_decodeBuffer.resize(static_cast<size_t>(stride * height));
+        result = libyuv::YUY2ToARGB(buffer, width * 2, m_decodeBuffer.data(), stride, width, height);
+        break;
+
+    case K4A_IMAGE_FORMAT_COLOR_BGRA32:
+        result = 0;
+        break;
+
+    default:
+        return false;
+    }
+
+    if (result != 0)
+    {
+        return false;
+    }
+
+    const uint8_t *bgra = m_colorFormat == K4A_IMAGE_FORMAT_COLOR_BGRA32 ? buffer : m_decodeBuffer.data();
+
+    const int thumbnailStride = m_dimensions.Width * static_cast<int>(sizeof(BgraPixel));
+    m_scaleBuffer.resize(static_cast<size_t>(thumbnailStride * m_dimensions.Height));
+    if (libyuv::ARGBScale(bgra,
+                          bgraDimensions.Width * static_cast<int>(sizeof(BgraPixel)),
+                          bgraDimensions.Width,
+                          bgraDimensions.Height,
+                          m_scaleBuffer.data(),
+                          thumbnailStride,
+                          m_dimensions.Width,
+                          m_dimensions.Height,
+                          libyuv::kFilterBox) != 0)
+    {
+        return false;
+    }
+
+    TjHandleUniquePtr compressor(tjInitCompress());
+    if (!compressor)
+    {
+        return false;
+    }
+
+    unsigned char *jpeg = nullptr;
+    unsigned long jpegSize = 0;
+    const int compressResult = tjCompress2(compressor.get(),
+                                           m_scaleBuffer.data(),
+                                           m_dimensions.Width,
+                                           thumbnailStride,
+                                           m_dimensions.Height,
+                                           TJPF_BGRA,
+                                           &jpeg,
+                                           &jpegSize,
+                                           TJSAMP_420,
+                                           ThumbnailJpegQuality,
+                                           TJFLAG_FASTDCT);
+    if (compressResult == 0)
+    {
+        thumbnail->Jpeg.assign(jpeg, jpeg + jpegSize);
+    }
+    tjFree(jpeg);
+
+    return compressResult == 0;
+}
+
+bool K4ARecordingThumbnails::LoadCache()
+{
+    std::ifstream file(m_cachePath.c_str(), std::ios::binary);
+    if (!file.good())
+    {
+        return false;
+    }
+
+    // The cache is only good for the recording it was made from
+    //
+    char magic[sizeof(CacheMagic)];
+    uint32_t version;
+    uint64_t recordingFileSize;
+    int64_t recordingLength;
+    int32_t width;
+    int32_t height;
+    uint32_t count;
+    if (!ReadValue(file, &magic) || std::memcmp(magic, CacheMagic, sizeof(CacheMagic)) != 0 ||
+        !ReadValue(file, &version) || version != CacheVersion || !ReadValue(file, &recordingFileSize) ||
+        recordingFileSize != m_recordingFileSize || !ReadValue(file, &recordingLength) ||
+        recordingLength != m_recordingLength.count() || !ReadValue(file, &width) || width != m_dimensions.Width ||
+        !ReadValue(file, &height) || height != m_dimensions.Height || !ReadValue(file, &count))
+    {
+        return false;
+    }
+
+    std::vector<Thumbnail> thumbnails(count);
+    for (Thumbnail &thumbnail : thumbnails)
+    {
+        int64_t timestamp;
+        uint32_t jpegSize;
+        if (!ReadValue(file, &timestamp) || !ReadValue(file, &jpegSize))
+        {
+            return false;
+        }
+
+        thumbnail.Timestamp = std::chrono::microseconds(timestamp);
+        thumbnail.Jpeg.resize(jpegSize);
+        file.read(reinterpret_cast<char *>(thumbnail.Jpeg.data()), static_cast<std::streamsize>(jpegSize));
+        if (!file.good())
+        {
+            return false;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_thumbnails = std::move(thumbnails);
+    return true;
+}
+
+void K4ARecordingThumbnails::SaveCache() const
+{
+    std::ofstream file(m_cachePath.c_str(), std::ios::binary | std::ios::trunc);
+    if (!file.good())
+    {
+        // Probably a read-only directory.  We still have the thumbnails for this session.
+        //
+        LogWarning("Failed to save recording thumbnails to " + m_cachePath);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    file.write(CacheMagic, sizeof(CacheMagic));
+    WriteValue(file, CacheVersion);
+    WriteValue(file, m_recordingFileSize);
+    WriteValue(file, static_cast<int64_t>(m_recordingLength.count()));
+    WriteValue(file, static_cast<int32_t>(m_dimensions.Width));
+    WriteValue(file, static_cast<int32_t>(m_dimensions.Height));
+    WriteValue(file, static_cast<uint32_t>(m_thumbnails.size()));
+    for (const Thumbnail &thumbnail : m_thumbnails)
+    {
+        WriteValue(file, static_cast<int64_t>(thumbnail.Timestamp.count()));
+        WriteValue(file, static_cast<uint32_t>(thumbnail.Jpeg.size()));
+        file.write(reinterpret_cast<const char *>(thumbnail.Jpeg.data()),
+                   static_cast<std::streamsize>(thumbnail.Jpeg.size()));
+    }
+
+    if (!file.good())
+    {
+        LogWarning("Failed to save recording thumbnails to " + m_cachePath);
+    }
+}
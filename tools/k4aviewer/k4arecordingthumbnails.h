@@ -0,0 +1,109 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef K4ARECORDINGTHUMBNAILS_H
+#define K4ARECORDINGTHUMBNAILS_H
+
+// System headers
+//
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Library headers
+//
+#include <k4arecord/playback.hpp>
+
+// Project headers
+//
+#include "k4aviewerimage.h"
+
+namespace k4aviewer
+{
+
+// Low-resolution thumbnails of a recording's color track, so the recording dock can show roughly where
+// the user is seeking to while they drag the seek bar without seeking and decoding a full color image
+// on every mouse move.
+//
+// The thumbnails are generated on a background thread, from a separate handle to the recording, the
+// first time a recording is opened.  They're stored as small JPEGs and cached next to the recording
+// (as <recording>.thumbnails) so opening the recording again doesn't have to regenerate them.
+//
+class K4ARecordingThumbnails
+{
+public:
+    K4ARecordingThumbnails(const std::string &recordingPath,
+                           const k4a_record_configuration_t &recordConfiguration,
+                           std::chrono::microseconds recordingLength);
+    ~K4ARecordingThumbnails();
+
+    // All thumbnails have the same dimensions, which are set before any thumbnails become available
+    //
+    ImageDimensions GetDimensions() const
+    {
+        return m_dimensions;
+    }
+
+    // Fraction of the recording for which thumbnails have been generated, from 0 to 1
+    //
+    float GetProgress() const
+    {
+        return m_progress;
+    }
+
+    // Finds the available thumbnail closest to timestamp, which is relative to the start of the recording
+    // (like k4a_playback_seek_timestamp's offset with K4A_PLAYBACK_SEEK_BEGIN).
+    // Returns false if there aren't any thumbnails yet.
+    //
+    bool FindThumbnail(std::chrono::microseconds timestamp, size_t *index) const;
+
+    // Decodes a thumbnail found with FindThumbnail() to BGRA; bgra is resized to fit.
+    //
+    bool DecodeThumbnail(size_t index, std::vector<uint8_t> *bgra) const;
+
+    K4ARecordingThumbnails(const K4ARecordingThumbnails &) = delete;
+    K4ARecordingThumbnails(const K4ARecordingThumbnails &&) = delete;
+    K4ARecordingThumbnails &operator=(const K4ARecordingThumbnails &) = delete;
+    K4ARecordingThumbnails &operator=(const K4ARecordingThumbnails &&) = delete;
+
+private:
+    struct Thumbnail
+    {
+        std::chrono::microseconds Timestamp;
+        std::vector<uint8_t> Jpeg;
+    };
+
+    void GenerateThumbnails();
+    bool MakeThumbnail(const k4a::image &colorImage, Thumbnail *thumbnail);
+    bool LoadCache();
+    void SaveCache() const;
+
+    std::string m_recordingPath;
+    std::string m_cachePath;
+    uint64_t m_recordingFileSize = 0;
+    std::chrono::microseconds m_recordingLength;
+    k4a_image_format_t m_colorFormat;
+    ImageDimensions m_colorDimensions;
+
+    // Scratch buffers for the generator thread
+    //
+    std::vector<uint8_t> m_decodeBuffer;
+    std::vector<uint8_t> m_scaleBuffer;
+
+    ImageDimensions m_dimensions = ImageDimensions(0, 0);
+
+    mutable std::mutex m_mutex;
+    std::vector<Thumbnail> m_thumbnails;
+
+    std::atomic<float> m_progress;
+    std::atomic<bool> m_shouldExit;
+    std::thread m_generatorThread;
+};
+
+} // namespace k4aviewer
+
+#endif
@@ -7,6 +7,7 @@
 // System headers
 //
 #include <array>
+#include <atomic>
 #include <functional>
 #include <mutex>
 
@@ -144,6 +145,140 @@ private:
 
     std::mutex m_mutex;
 };
+
+// Lock-free ring buffer for exactly one producer thread and one consumer thread.
+//
+// Has the same interface as K4ARingBuffer, but the thread that calls BeginInsert(), InsertionItem(),
+// EndInsert() and AbortInsert() must be the only producer and the thread that calls CurrentItem(),
+// AdvanceRead() and Clear() must be the only consumer.  Use this instead of K4ARingBuffer on paths
+// where the producer runs at a high rate and shouldn't stall on a lock held by the render thread.
+//
+template<typename T, size_t size> class K4ALockFreeRingBuffer
+{
+public:
+    static_assert(size >= 2, "Ring buffer must be size 2 or greater");
+
+    // Initializes all the elements in the ring buffer by calling initFn on them.
+    // This function is not thread-safe and should be called before making any
+    // other calls
+    //
+    void Initialize(const std::function<void(T *)> &initFn)
+    {
+        for (T &element : m_buffer)
+        {
+            initFn(&element);
+        }
+    }
+
+    bool Empty() const
+    {
+        return m_writeCount.load(std::memory_order_acquire) == m_readCount.load(std::memory_order_acquire);
+    }
+
+    // Drops all the items in the buffer.  Must only be called from the consumer thread.
+    //
+    void Clear()
+    {
+        const size_t writeCount = m_writeCount.load(std::memory_order_acquire);
+        for (size_t readCount = m_readCount.load(std::memory_order_relaxed); readCount != writeCount; ++readCount)
+        {
+            m_buffer[readCount % size] = T();
+        }
+        m_readCount.store(writeCount, std::memory_order_release);
+    }
+
+    bool Full() const
+    {
+        return m_writeCount.load(std::memory_order_acquire) - m_readCount.load(std::memory_order_acquire) == size;
+    }
+
+    // Returns a pointer to the first item in the buffer.
+    // If the buffer is empty, behavior is undefined.
+    // Using the result of CurrentItem() after calling AdvanceRead() is undefined.
+    //
+    T *CurrentItem()
+    {
+        return &m_buffer[m_readCount.load(std::memory_order_relaxed) % size];
+    }
+
+    // Attempt to advance the item referenced by CurrentItem().
+    // Returns true if successful, false if the buffer was empty.
+    //
+    bool AdvanceRead()
+    {
+        const size_t readCount = m_readCount.load(std::memory_order_relaxed);
+        if (readCount == m_writeCount.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        m_readCount.store(readCount + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Attempts to start an insert operation.
+    // Returns true on success, false on failure.
+    // When done, call EndInsert() to complete the insert operation
+    // (or AbortInsert() to cancel the insert operation)
+    //
+    bool BeginInsert()
+    {
+        if (m_inserting)
+        {
+            return false;
+        }
+        if (Full())
+        {
+            return false;
+        }
+
+        m_inserting = true;
+        return true;
+    }
+
+    // Returns a pointer to the item the insert is to update.
+    // The behavior of calling InsertionItem when you have not
+    //      A) previously made a successful call to BeginInsert(), and
+    //      B) not yet made a corresponding call to EndInsert() or AbortInsert()
+    // is undefined.
+    //
+    T *InsertionItem()
+    {
+        return &m_buffer[m_writeCount.load(std::memory_order_relaxed) % size];
+    }
+
+    // Ends the insertion operation and commits the write operation.
+    //
+    void EndInsert()
+    {
+        m_writeCount.store(m_writeCount.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        m_inserting = false;
+    }
+
+    // Ends the insertion operation and aborts the write operation (i.e. does not advance the write pointer).
+    //
+    void AbortInsert()
+    {
+        m_inserting = false;
+    }
+
+private:
+    // The counts only ever go up; the index of an item is its count modulo size.
+    // They're padded apart so the producer and the consumer don't contend on the same cache line.
+    //
+    static constexpr size_t CacheLineSize = 64;
+
+    std::atomic<size_t> m_readCount{ 0 };
+    char m_readCountPadding[CacheLineSize - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> m_writeCount{ 0 };
+    char m_writeCountPadding[CacheLineSize - sizeof(std::atomic<size_t>)];
+
+    // Only touched by the producer
+    //
+    bool m_inserting = false;
+
+    std::array<T, size> m_buffer;
+};
 } // namespace k4aviewer
 
 #endif
@@ -20,6 +20,7 @@
 #include "filesystem17.h"
 #include "k4aaudiomanager.h"
 #include "k4aimguiextensions.h"
+#include "k4amultidevicedockcontrol.h"
 #include "k4aviewererrormanager.h"
 #include "k4arecordingdockcontrol.h"
 #include "k4aviewerutil.h"
@@ -59,6 +60,17 @@ K4ADockControlStatus K4ASourceSelectionDockControl::Show()
             }
         }
 
+        // Opening every device at once shows them side by side
+        //
+        const bool openAllAvailable = m_connectedDevices.size() > 1;
+        {
+            ImGuiExtensions::ButtonColorChanger colorChanger(ImGuiExtensions::ButtonColor::Green, openAllAvailable);
+            if (ImGuiExtensions::K4AButton("Open All Devices", openAllAvailable))
+            {
+                OpenAllDevices();
+            }
+        }
+
         ImGui::TreePop();
     }
 
@@ -138,6 +150,37 @@ void K4ASourceSelectionDockControl::OpenDevice()
     }
 }
 
+void K4ASourceSelectionDockControl::OpenAllDevices()
+{
+    std::vector<k4a::device> devices;
+    for (const auto &connectedDevice : m_connectedDevices)
+    {
+        try
+        {
+            devices.emplace_back(k4a::device::open(static_cast<uint32_t>(connectedDevice.first)));
+        }
+        catch (const k4a::error &e)
+        {
+            K4AViewerErrorManager::Instance().SetErrorStatus(e.what());
+        }
+    }
+
+    if (devices.empty())
+    {
+        return;
+    }
+
+    try
+    {
+        K4AWindowManager::Instance().PushLeftDockControl(
+            std14::make_unique<K4AMultiDeviceDockControl>(std::move(devices)));
+    }
+    catch (const k4a::error &e)
+    {
+        K4AViewerErrorManager::Instance().SetErrorStatus(e.what());
+    }
+}
+
 void K4ASourceSelectionDockControl::OpenRecording(const std17::filesystem::path &path)
 {
     try
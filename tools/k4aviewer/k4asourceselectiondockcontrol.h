@@ -39,6 +39,7 @@ private:
     void RefreshDevices();
 
     void OpenDevice();
+    void OpenAllDevices();
     void OpenRecording(const std17::filesystem::path &path);
 
     int m_selectedDevice = -1;
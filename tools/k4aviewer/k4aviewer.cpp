@@ -240,6 +240,7 @@ void K4AViewer::ShowMainMenuBar()
             }
 
             ShowViewerOptionMenuItem("Show developer options", ViewerOption::ShowDeveloperOptions);
+            ShowViewerOptionMenuItem("Convert color images on the GPU", ViewerOption::UseGpuColorConversion);
 
             ImGui::Separator();
 
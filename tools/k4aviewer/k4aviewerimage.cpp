@@ -49,22 +49,16 @@ K4AViewerImage::K4AViewerImage(const ImageDimensions dimensions, const GLenum fo
     m_textureBufferSize = static_cast<GLuint>(dimensions.Width * dimensions.Height) *
                           GetFormatPixelElementCount(format);
 
-    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_textureBuffer.Id());
-    glBufferData(GL_PIXEL_UNPACK_BUFFER, m_textureBufferSize, nullptr, GL_STREAM_DRAW);
-    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    m_textureBuffer.Init(GL_PIXEL_UNPACK_BUFFER, m_textureBufferSize);
 }
 
 GLenum K4AViewerImage::UpdateTexture(const uint8_t *data)
 {
-    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_textureBuffer.Id());
     glBindTexture(GL_TEXTURE_2D, m_texture.Id());
 
     CleanupGuard bufferCleanupGuard([]() { glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0); });
 
-    uint8_t *buffer = reinterpret_cast<uint8_t *>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER,
-                                                                   0,
-                                                                   m_textureBufferSize,
-                                                                   GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+    uint8_t *buffer = m_textureBuffer.BeginWrite();
 
     if (!buffer)
     {
@@ -80,11 +74,14 @@ GLenum K4AViewerImage::UpdateTexture(const uint8_t *data)
         std::fill(buffer, buffer + m_textureBufferSize, static_cast<uint8_t>(0));
     }
 
-    if (!glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER))
+    if (!m_textureBuffer.EndWrite())
     {
         return glGetError();
     }
 
+    // The pixels are read from the pixel buffer, starting at the region we just wrote
+    //
+    const void *pixelData = reinterpret_cast<const void *>(m_textureBuffer.CurrentOffset());
     glTexSubImage2D(GL_TEXTURE_2D,       // target
                     0,                   // level
                     0,                   // xoffset
@@ -93,7 +90,8 @@ GLenum K4AViewerImage::UpdateTexture(const uint8_t *data)
                     m_dimensions.Height, // height
                     m_format,            // format
                     GL_UNSIGNED_BYTE,    // type
-                    nullptr);            // data
+                    pixelData);          // data
+    m_textureBuffer.FenceCurrentRegion();
 
     return glGetError();
 }
@@ -17,6 +17,7 @@
 //
 #include "k4apixel.h"
 #include "openglhelpers.h"
+#include "openglstreamingbuffer.h"
 
 namespace k4aviewer
 {
@@ -66,7 +67,7 @@ private:
     GLenum m_format;
 
     OpenGL::Texture m_texture = OpenGL::Texture(true);
-    OpenGL::Buffer m_textureBuffer = OpenGL::Buffer(true);
+    OpenGL::StreamingBuffer m_textureBuffer;
 
     GLuint m_textureBufferSize;
 };
@@ -211,10 +211,11 @@ constexpr char ShowFrameRateInfoTag[] = "ShowFrameRateInfo";
 constexpr char ShowInfoPaneTag[] = "ShowInfoPane";
 constexpr char ShowLogDockTag[] = "ShowLogDock";
 constexpr char ShowDeveloperOptionsTag[] = "ShowDeveloperOptions";
+constexpr char UseGpuColorConversionTag[] = "UseGpuColorConversion";
 
 std::istream &operator>>(std::istream &s, ViewerOption &val)
 {
-    static_assert(static_cast<size_t>(ViewerOption::MAX) == 4, "Need to add a new viewer option conversion");
+    static_assert(static_cast<size_t>(ViewerOption::MAX) == 5, "Need to add a new viewer option conversion");
     std::string tag;
     s >> tag;
 
@@ -234,6 +235,10 @@ std::istream &operator>>(std::istream &s, ViewerOption &val)
     {
         val = ViewerOption::ShowDeveloperOptions;
     }
+    else if (tag == UseGpuColorConversionTag)
+    {
+        val = ViewerOption::UseGpuColorConversion;
+    }
     else
     {
         s.setstate(std::ios::failbit);
@@ -244,7 +249,7 @@ std::istream &operator>>(std::istream &s, ViewerOption &val)
 
 std::ostream &operator<<(std::ostream &s, const ViewerOption &val)
 {
-    static_assert(static_cast<size_t>(ViewerOption::MAX) == 4, "Need to add a new viewer option conversion");
+    static_assert(static_cast<size_t>(ViewerOption::MAX) == 5, "Need to add a new viewer option conversion");
 
     switch (val)
     {
@@ -264,6 +269,10 @@ std::ostream &operator<<(std::ostream &s, const ViewerOption &val)
         s << ShowDeveloperOptionsTag;
         break;
 
+    case ViewerOption::UseGpuColorConversion:
+        s << UseGpuColorConversionTag;
+        break;
+
     default:
         s.setstate(std::ios::failbit);
         break;
@@ -278,7 +287,9 @@ std::ostream &operator<<(std::ostream &s, const ViewerOption &val)
 //
 k4a_device_configuration_t K4ADeviceConfiguration::ToK4ADeviceConfiguration() const
 {
-    k4a_device_configuration_t deviceConfig;
+    // The viewer doesn't expose the streaming queue settings, so those keep their defaults
+    //
+    k4a_device_configuration_t deviceConfig = K4A_DEVICE_CONFIG_INIT_DISABLE_ALL;
 
     deviceConfig.color_format = ColorFormat;
     deviceConfig.color_resolution = EnableColorCamera ? ColorResolution : K4A_COLOR_RESOLUTION_OFF;
@@ -297,12 +308,13 @@ k4a_device_configuration_t K4ADeviceConfiguration::ToK4ADeviceConfiguration() co
 
 K4AViewerOptions::K4AViewerOptions()
 {
-    static_assert(static_cast<size_t>(ViewerOption::MAX) == 4, "Need to add a new viewer option default");
+    static_assert(static_cast<size_t>(ViewerOption::MAX) == 5, "Need to add a new viewer option default");
 
     Options[static_cast<size_t>(ViewerOption::ShowFrameRateInfo)] = false;
     Options[static_cast<size_t>(ViewerOption::ShowInfoPane)] = true;
     Options[static_cast<size_t>(ViewerOption::ShowLogDock)] = false;
     Options[static_cast<size_t>(ViewerOption::ShowDeveloperOptions)] = false;
+    Options[static_cast<size_t>(ViewerOption::UseGpuColorConversion)] = true;
 }
 
 K4AViewerSettingsManager::K4AViewerSettingsManager()
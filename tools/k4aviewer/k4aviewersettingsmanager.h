@@ -56,6 +56,7 @@ enum class ViewerOption
     ShowInfoPane,
     ShowLogDock,
     ShowDeveloperOptions,
+    UseGpuColorConversion,
 
     // Insert new settings here
 
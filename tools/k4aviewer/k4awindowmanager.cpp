@@ -38,14 +38,16 @@ void K4AWindowManager::SetMenuBarHeight(float menuBarHeight)
     m_menuBarHeight = menuBarHeight;
 }
 
-void K4AWindowManager::AddWindow(std::unique_ptr<IK4AVisualizationWindow> &&window)
+void K4AWindowManager::AddWindow(const std::string &sourceIdentifier,
+                                 std::unique_ptr<IK4AVisualizationWindow> &&window)
 {
-    m_windows.WindowGroup.emplace_back(WindowListEntry(std::move(window)));
+    GetSourceWindowGroup(sourceIdentifier).WindowGroup.emplace_back(WindowListEntry(std::move(window)));
 }
 
-void K4AWindowManager::AddWindowGroup(std::vector<std::unique_ptr<IK4AVisualizationWindow>> &&windowGroup)
+void K4AWindowManager::AddWindowGroup(const std::string &sourceIdentifier,
+                                      std::vector<std::unique_ptr<IK4AVisualizationWindow>> &&windowGroup)
 {
-    m_windows.WindowGroup.emplace_back(std::move(windowGroup));
+    GetSourceWindowGroup(sourceIdentifier).WindowGroup.emplace_back(std::move(windowGroup));
 }
 
 void K4AWindowManager::ClearFullscreenWindow()
@@ -53,6 +55,21 @@ void K4AWindowManager::ClearFullscreenWindow()
     m_maximizedWindow = nullptr;
 }
 
+void K4AWindowManager::ClearWindows(const std::string &sourceIdentifier)
+{
+    assert(m_windows.IsWindowGroup);
+    m_windows.WindowGroup.erase(std::remove_if(m_windows.WindowGroup.begin(),
+                                               m_windows.WindowGroup.end(),
+                                               [&sourceIdentifier](const WindowListEntry &entry) {
+                                                   return entry.SourceIdentifier == sourceIdentifier;
+                                               }),
+                                m_windows.WindowGroup.end());
+
+    // The maximized window may have been one of the ones we just deleted
+    //
+    ClearFullscreenWindow();
+}
+
 void K4AWindowManager::ClearWindows()
 {
     assert(m_windows.IsWindowGroup);
@@ -60,6 +77,37 @@ void K4AWindowManager::ClearWindows()
     ClearFullscreenWindow();
 }
 
+K4AWindowManager::WindowListEntry &K4AWindowManager::GetSourceWindowGroup(const std::string &sourceIdentifier)
+{
+    assert(m_windows.IsWindowGroup);
+    for (auto &entry : m_windows.WindowGroup)
+    {
+        if (entry.SourceIdentifier == sourceIdentifier)
+        {
+            return entry;
+        }
+    }
+
+    m_windows.WindowGroup.emplace_back();
+    m_windows.WindowGroup.back().SourceIdentifier = sourceIdentifier;
+    return m_windows.WindowGroup.back();
+}
+
+size_t K4AWindowManager::CountWindows(const WindowListEntry &windowList)
+{
+    if (!windowList.IsWindowGroup)
+    {
+        return 1;
+    }
+
+    size_t count = 0;
+    for (const auto &entry : windowList.WindowGroup)
+    {
+        count += CountWindows(entry);
+    }
+    return count;
+}
+
 void K4AWindowManager::PushLeftDockControl(std::unique_ptr<IK4ADockControl> &&dockControl)
 {
     m_leftDock.PushDockControl(std::move(dockControl));
@@ -89,6 +137,7 @@ void K4AWindowManager::ShowAll()
         windowAreaSize.y -= m_bottomDock.GetSize().y;
     }
 
+    m_windowCount = CountWindows(m_windows);
     if (m_maximizedWindow != nullptr)
     {
         ShowWindow(windowAreaPosition, windowAreaSize, m_maximizedWindow, true);
@@ -182,7 +231,7 @@ void K4AWindowManager::ShowWindow(const ImVec2 windowAreaPosition,
 
         // Draw minimize/maximize button
         //
-        if (m_windows.WindowGroup.size() != 1)
+        if (m_windowCount != 1)
         {
             if (ShowMinMaxButton("-", "+", isMaximized))
             {
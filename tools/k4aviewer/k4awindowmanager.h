@@ -10,6 +10,7 @@
 // System headers
 //
 #include <memory>
+#include <string>
 #include <vector>
 
 // Library headers
@@ -33,9 +34,14 @@ public:
     void SetGLWindowSize(ImVec2 glWindowSize);
     void SetMenuBarHeight(float menuBarHeight);
 
-    void AddWindow(std::unique_ptr<IK4AVisualizationWindow> &&window);
-    void AddWindowGroup(std::vector<std::unique_ptr<IK4AVisualizationWindow>> &&windowGroup);
+    // Windows are grouped by the source (device or recording) they show data from.  Each source's
+    // windows are tiled together, so several devices can be viewed side by side.
+    //
+    void AddWindow(const std::string &sourceIdentifier, std::unique_ptr<IK4AVisualizationWindow> &&window);
+    void AddWindowGroup(const std::string &sourceIdentifier,
+                        std::vector<std::unique_ptr<IK4AVisualizationWindow>> &&windowGroup);
     void ClearFullscreenWindow();
+    void ClearWindows(const std::string &sourceIdentifier);
     void ClearWindows();
 
     void PushLeftDockControl(std::unique_ptr<IK4ADockControl> &&dockControl);
@@ -71,8 +77,15 @@ private:
         bool IsWindowGroup;
         std::unique_ptr<IK4AVisualizationWindow> Window;
         std::vector<WindowListEntry> WindowGroup;
+
+        // Only set on the top-level group for each source
+        //
+        std::string SourceIdentifier;
     };
 
+    WindowListEntry &GetSourceWindowGroup(const std::string &sourceIdentifier);
+    static size_t CountWindows(const WindowListEntry &windowList);
+
     void ShowWindowArea(ImVec2 windowAreaPosition, ImVec2 windowAreaSize, WindowListEntry *windowList);
     void
     ShowWindow(ImVec2 windowAreaPosition, ImVec2 windowAreaSize, IK4AVisualizationWindow *window, bool isMaximized);
@@ -88,6 +101,7 @@ private:
     IK4AVisualizationWindow *m_maximizedWindow = nullptr;
 
     WindowListEntry m_windows;
+    size_t m_windowCount = 0;
 };
 } // namespace k4aviewer
 
@@ -41,7 +41,7 @@ void CreateVideoWindow(const char *sourceIdentifier,
     std::unique_ptr<IK4AVisualizationWindow> window(
         std14::make_unique<K4AVideoWindow<ImageFormat>>(std::move(title), imageSource));
 
-    K4AWindowManager::Instance().AddWindow(std::move(window));
+    K4AWindowManager::Instance().AddWindow(sourceIdentifier, std::move(window));
 }
 
 } // namespace
@@ -175,7 +175,7 @@ void K4AWindowSet::StartNormalWindows(const char *sourceIdentifier,
 
     if (!graphWindows.empty())
     {
-        K4AWindowManager::Instance().AddWindowGroup(std::move(graphWindows));
+        K4AWindowManager::Instance().AddWindowGroup(sourceIdentifier, std::move(graphWindows));
     }
 }
 
@@ -189,7 +189,8 @@ void K4AWindowSet::StartPointCloudWindow(const char *sourceIdentifier,
     cameraDataSource->RegisterObserver(captureSource);
 
     auto &wm = K4AWindowManager::Instance();
-    wm.AddWindow(std14::make_unique<K4APointCloudWindow>(std::move(pointCloudTitle),
+    wm.AddWindow(sourceIdentifier,
+                 std14::make_unique<K4APointCloudWindow>(std::move(pointCloudTitle),
                                                          enableColorPointCloud,
                                                          std::move(captureSource),
                                                          calibrationData));
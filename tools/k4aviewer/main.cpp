@@ -7,6 +7,8 @@
 #include <string>
 #include <cctype>
 
+#include <k4a/k4a.h>
+
 K4AViewerArgs ProcessArgs(int argc, char **argv);
 
 K4AViewerArgs ProcessArgs(int argc, char **argv)
@@ -39,6 +41,10 @@ K4AViewerArgs ProcessArgs(int argc, char **argv)
 
 int main(int argc, char **argv)
 {
+    // Load the depth engine while the window is created rather than when the first device is opened
+    //
+    (void)k4a_preload_depth_engine();
+
     k4aviewer::K4AViewer viewer(ProcessArgs(argc, argv));
     viewer.Run();
     return 0;
@@ -0,0 +1,178 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// Associated header
+//
+#include "openglstreamingbuffer.h"
+
+// System headers
+//
+#include <cstring>
+
+// Library headers
+//
+
+// Project headers
+//
+
+using namespace k4aviewer::OpenGL;
+
+namespace
+{
+
+// Region offsets are used as pixel buffer and vertex attribute offsets, which must be aligned to
+// the size of a pixel or vertex component
+//
+constexpr GLsizeiptr RegionAlignment = 256;
+
+constexpr GLbitfield PersistentMappingFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+// How long to wait on a fence before checking it again
+//
+constexpr GLuint64 FenceWaitTimeoutNs = 100 * 1000 * 1000;
+
+bool SupportsPersistentMapping()
+{
+    static const bool supported = []() {
+        if (gl3wIsSupported(4, 4))
+        {
+            return true;
+        }
+
+        GLint extensionCount = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+        for (GLint i = 0; i < extensionCount; ++i)
+        {
+            const char *extension = reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+            if (extension && std::strcmp(extension, "GL_ARB_buffer_storage") == 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }();
+
+    return supported;
+}
+
+} // namespace
+
+StreamingBuffer::~StreamingBuffer()
+{
+    Reset();
+}
+
+void StreamingBuffer::Init(const GLenum target, const GLsizeiptr size)
+{
+    Reset();
+
+    m_target = target;
+    m_size = size;
+    m_buffer.Init();
+    glBindBuffer(m_target, m_buffer.Id());
+
+    if (SupportsPersistentMapping())
+    {
+        m_regionSize = (size + RegionAlignment - 1) / RegionAlignment * RegionAlignment;
+        const GLsizeiptr bufferSize = m_regionSize * static_cast<GLsizeiptr>(RegionCount);
+        glBufferStorage(m_target, bufferSize, nullptr, PersistentMappingFlags);
+        m_persistentMapping = reinterpret_cast<GLubyte *>(
+            glMapBufferRange(m_target, 0, bufferSize, PersistentMappingFlags));
+    }
+
+    if (!m_persistentMapping)
+    {
+        // Either the driver doesn't support persistent mapping or mapping failed anyway; if the latter,
+        // the buffer's storage is immutable, so we need a new one
+        //
+        if (m_regionSize != 0)
+        {
+            m_buffer.Init();
+            glBindBuffer(m_target, m_buffer.Id());
+        }
+
+        m_regionSize = 0;
+        glBufferData(m_target, m_size, nullptr, GL_STREAM_DRAW);
+    }
+
+    glBindBuffer(m_target, 0);
+}
+
+GLubyte *StreamingBuffer::BeginWrite()
+{
+    glBindBuffer(m_target, m_buffer.Id());
+
+    if (!m_persistentMapping)
+    {
+        return reinterpret_cast<GLubyte *>(
+            glMapBufferRange(m_target, 0, m_size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+    }
+
+    m_currentRegion = (m_currentRegion + 1) % RegionCount;
+
+    GLsync &fence = m_regionFences[m_currentRegion];
+    if (fence)
+    {
+        GLenum waitStatus;
+        do
+        {
+            waitStatus = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FenceWaitTimeoutNs);
+        } while (waitStatus == GL_TIMEOUT_EXPIRED);
+
+        glDeleteSync(fence);
+        fence = nullptr;
+
+        if (waitStatus == GL_WAIT_FAILED)
+        {
+            return nullptr;
+        }
+    }
+
+    return m_persistentMapping + CurrentOffset();
+}
+
+bool StreamingBuffer::EndWrite()
+{
+    if (!m_persistentMapping)
+    {
+        return glUnmapBuffer(m_target) == GL_TRUE;
+    }
+
+    // The mapping is coherent, so the writes are visible to the GPU without an explicit flush
+    //
+    return true;
+}
+
+void StreamingBuffer::FenceCurrentRegion()
+{
+    if (!m_persistentMapping)
+    {
+        return;
+    }
+
+    GLsync &fence = m_regionFences[m_currentRegion];
+    if (fence)
+    {
+        glDeleteSync(fence);
+    }
+    fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void StreamingBuffer::Reset()
+{
+    for (GLsync &fence : m_regionFences)
+    {
+        if (fence)
+        {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+
+    // Deleting the buffer also unmaps it
+    //
+    m_buffer.Reset();
+    m_persistentMapping = nullptr;
+    m_regionSize = 0;
+    m_currentRegion = 0;
+}
@@ -0,0 +1,103 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef OPENGLSTREAMINGBUFFER_H
+#define OPENGLSTREAMINGBUFFER_H
+
+// System headers
+//
+#include <array>
+
+// Library headers
+//
+#include "k4aimgui_all.h"
+
+// Project headers
+//
+#include "openglhelpers.h"
+
+namespace k4aviewer
+{
+namespace OpenGL
+{
+
+// A buffer for data that's rewritten every frame, e.g. a pixel buffer for texture uploads or a vertex buffer.
+//
+// If the driver supports ARB_buffer_storage, the buffer holds RegionCount copies of the data and stays
+// persistently mapped.  Each write goes to the next region, and a fence guards each region until the GPU
+// has finished reading it, so writing a frame never waits on the driver unless the GPU is more than
+// RegionCount frames behind.  Otherwise, each write maps the buffer with GL_MAP_INVALIDATE_BUFFER_BIT,
+// which lets the driver orphan the previous contents.
+//
+// Usage, on the thread that owns the OpenGL context:
+//   1. BeginWrite() - binds the buffer to its target and returns where to write the data
+//   2. EndWrite()
+//   3. Issue the commands that read from the buffer, at offset CurrentOffset()
+//   4. FenceCurrentRegion()
+//
+class StreamingBuffer
+{
+public:
+    static constexpr size_t RegionCount = 3;
+
+    StreamingBuffer() = default;
+    ~StreamingBuffer();
+
+    // (Re)allocates the buffer, discarding any previous contents.  Leaves no buffer bound to target.
+    //
+    void Init(GLenum target, GLsizeiptr size);
+
+    // Returns nullptr on failure, in which case glGetError() has the reason.
+    //
+    GLubyte *BeginWrite();
+
+    // Returns false on failure, in which case glGetError() has the reason.
+    //
+    bool EndWrite();
+
+    // Marks the point in the command stream after which the GPU has finished reading the current region.
+    //
+    void FenceCurrentRegion();
+
+    // The offset of the region written by the last BeginWrite() into the buffer.
+    //
+    GLintptr CurrentOffset() const
+    {
+        return m_regionSize * static_cast<GLintptr>(m_currentRegion);
+    }
+
+    GLuint Id() const
+    {
+        return m_buffer.Id();
+    }
+
+    operator bool() const
+    {
+        return static_cast<bool>(m_buffer);
+    }
+
+    StreamingBuffer(const StreamingBuffer &) = delete;
+    StreamingBuffer(const StreamingBuffer &&) = delete;
+    StreamingBuffer &operator=(const StreamingBuffer &) = delete;
+    StreamingBuffer &operator=(const StreamingBuffer &&) = delete;
+
+private:
+    void Reset();
+
+    Buffer m_buffer;
+    GLenum m_target = GL_NONE;
+    GLsizeiptr m_size = 0;
+    GLsizeiptr m_regionSize = 0;
+
+    // Only set if the buffer is persistently mapped
+    //
+    GLubyte *m_persistentMapping = nullptr;
+
+    size_t m_currentRegion = 0;
+    std::array<GLsync, RegionCount> m_regionFences = {};
+};
+
+} // namespace OpenGL
+} // namespace k4aviewer
+
+#endif
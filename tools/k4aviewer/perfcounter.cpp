@@ -26,13 +26,13 @@ void PerfCounterManager::ShowPerfWindow(bool *windowOpen)
 {
     std::lock_guard<std::mutex> lockGuard(Instance().m_mutex);
 
-    if (ImGui::Begin("Performance Counters (in ms)", windowOpen, ImGuiWindowFlags_AlwaysAutoResize))
+    if (ImGui::Begin("Performance Counters", windowOpen, ImGuiWindowFlags_AlwaysAutoResize))
     {
         for (auto &counter : Instance().m_perfCounters)
         {
             ImGui::Text("%s", counter.first.c_str());
-            ImGui::Text("avg: %f", double(counter.second->GetAverage()));
-            ImGui::Text("max: %f", double(counter.second->GetMax()));
+            ImGui::Text("avg: %f %s", double(counter.second->GetAverage()), counter.second->GetUnit());
+            ImGui::Text("max: %f %s", double(counter.second->GetMax()), counter.second->GetUnit());
 
             const PerfCounter::SampleData &data = counter.second->GetSampleData();
             ImGui::PlotLines("",
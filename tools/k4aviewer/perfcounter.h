@@ -13,6 +13,7 @@
 #include <mutex>
 #include <numeric>
 #include <ratio>
+#include <string>
 
 // Library headers
 //
@@ -70,12 +71,19 @@ class PerfCounter
 public:
     using SampleData = std::array<float, 100>;
 
-    PerfCounter(const char *name)
+    // unit is what the samples are measured in; PerfSample measures milliseconds
+    //
+    PerfCounter(const char *name, const char *unit = "ms") : m_unit(unit)
     {
         PerfCounterManager::RegisterPerfCounter(name, this);
     }
 
-    PerfCounter(const std::string &name) : PerfCounter(name.c_str()) {}
+    PerfCounter(const std::string &name, const char *unit = "ms") : PerfCounter(name.c_str(), unit) {}
+
+    inline const char *GetUnit() const
+    {
+        return m_unit;
+    }
 
     inline float GetMax() const
     {
@@ -104,10 +112,17 @@ public:
 
         const float durationMs = durationNs * 1.0f * std::milli::den / std::milli::num * std::nano::num /
                                  std::nano::den;
-        m_max = std::max(m_max, durationMs);
+        AddSample(durationMs);
+    }
+
+    // Records a value that was measured elsewhere, e.g. a statistic reported by the SDK
+    //
+    inline void AddSample(float value)
+    {
+        m_max = std::max(m_max, value);
 
         m_currentSample = (m_currentSample + 1) % m_samples.size();
-        m_samples[m_currentSample] = durationMs;
+        m_samples[m_currentSample] = value;
     }
 
     inline void Reset()
@@ -117,6 +132,7 @@ public:
     }
 
 private:
+    const char *m_unit;
     float m_max = 0;
     size_t m_currentSample = 0;
     SampleData m_samples;
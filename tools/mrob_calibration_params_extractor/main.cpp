@@ -98,7 +98,7 @@ int main(int argc, char **argv)
     }
 
     k4a_playback_t playback_handle = NULL;
-    if (k4a_playback_open(argv[1], &playback_handle) != K4A_RESULT_SUCCEEDED)
+    if (k4a_playback_open_ex(argv[1], K4A_PLAYBACK_OPEN_HEADER_ONLY, &playback_handle) != K4A_RESULT_SUCCEEDED)
     {
         printf("Calib params extractor. Failed to open recording\n");
         return 1;
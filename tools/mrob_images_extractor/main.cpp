@@ -11,78 +11,149 @@
 #include "opencv2/imgcodecs.hpp"
 #include "opencv2/imgproc.hpp"
 #include "opencv2/calib3d/calib3d.hpp"
+#include "opencv2/opencv_modules.hpp"
+#ifdef HAVE_OPENCV_CUDAWARPING
+#include "opencv2/core/cuda.hpp"
+#include "opencv2/cudawarping.hpp"
+#endif
 
 #include <chrono>
+#include <cstring>
 
-#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <thread>
-#include <functional>
 #include <vector>
 
 #include "cmdparser.h"
 
 #define MAX_NUMBER_OF_CAPTURES 259200
-#define CAPTURES_IN_BATCH 256
-
-//From https://stackoverflow.com/questions/36246300/parallel-loops-in-c
-/// @param[in] nb_elements : size of your for loop
-/// @param[in] functor(start, end) :
-/// your function processing a sub chunk of the for loop.
-/// "start" is the first index to process (included) until the index "end"
-/// (excluded)
-/// @code
-///     for(int i = start; i < end; ++i)
-///         computation(i);
-/// @endcode
-/// @param use_threads : enable / disable threads.
-///
-///
-static
-void parallel_for(unsigned nb_elements,
-                  std::function<void (int start, int end)> functor,
-                  bool use_threads = true)
-{
-    // -------
-    unsigned nb_threads_hint = std::thread::hardware_concurrency();
-    unsigned nb_threads = nb_threads_hint == 0 ? 8 : (nb_threads_hint);
+#define CAPTURES_PER_WORKER 4
+#define CAPTURES_PER_REPORT 256
+#define CAPTURES_PER_GPU_BATCH 4
 
-    unsigned batch_size = nb_elements / nb_threads;
-    unsigned batch_remainder = nb_elements % nb_threads;
+// Captures read from the recording waiting to be extracted. The reader blocks while the queue is full, so only a few
+// captures are held in memory at a time.
+class capture_queue_t
+{
+public:
+    explicit capture_queue_t(size_t capacity) : m_capacity(capacity) {}
 
-    std::vector< std::thread > my_threads(nb_threads);
+    ~capture_queue_t()
+    {
+        for (k4a_capture_t capture : m_captures)
+        {
+            k4a_capture_release(capture);
+        }
+    }
 
-    if( use_threads )
+    // Takes ownership of the capture. Returns false if the queue was closed, in which case the capture is released.
+    bool push(k4a_capture_t capture)
     {
-        // Multithread execution
-        for(unsigned i = 0; i < nb_threads; ++i)
+        std::unique_lock<std::mutex> lock(m_lock);
+        m_not_full.wait(lock, [this]() { return m_closed || m_captures.size() < m_capacity; });
+        if (m_closed)
         {
-            int start = i * batch_size;
-            my_threads[i] = std::thread(functor, start, start+batch_size);
+            lock.unlock();
+            k4a_capture_release(capture);
+            return false;
         }
+        m_captures.push_back(capture);
+        m_not_empty.notify_one();
+        return true;
     }
-    else
+
+    // Blocks until a capture is available. Returns false once the queue is closed and every capture was taken.
+    bool pop(k4a_capture_t *capture)
     {
-        // Single thread execution (for easy debugging)
-        for(unsigned i = 0; i < nb_threads; ++i){
-            int start = i * batch_size;
-            functor( start, start+batch_size );
+        std::unique_lock<std::mutex> lock(m_lock);
+        m_not_empty.wait(lock, [this]() { return m_closed || !m_captures.empty(); });
+        if (m_captures.empty())
+        {
+            return false;
         }
+        *capture = m_captures.front();
+        m_captures.pop_front();
+        m_not_full.notify_one();
+        return true;
     }
 
-    // Deform the elements left
-    int start = nb_threads * batch_size;
-    functor( start, start+batch_remainder);
+    void close()
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_closed = true;
+        m_not_empty.notify_all();
+        m_not_full.notify_all();
+    }
 
-    // Wait for the other thread to finish their task
-    if( use_threads )
-        std::for_each(my_threads.begin(), my_threads.end(), std::mem_fn(&std::thread::join));
+private:
+    std::mutex m_lock;
+    std::condition_variable m_not_empty;
+    std::condition_variable m_not_full;
+    std::deque<k4a_capture_t> m_captures;
+    size_t m_capacity;
+    bool m_closed = false;
+};
+
+// How the extracted images are encoded
+struct output_settings_t
+{
+    // cv::imencode() parameters of the undistorted color images
+    std::vector<int> color_params;
+    // JPEG quality of the undistorted color images encoded on the GPU path
+    int color_quality = 96;
+    // cv::imencode() parameters of the depth and infrared images
+    std::vector<int> depth_params;
+    // ".png" or ".tiff" to encode the depth and infrared images, or ".raw" to write their 16-bit little-endian pixels
+    std::string depth_extension = ".png";
+};
+
+static bool write_file(const char *filename, const uint8_t *data, size_t size, uint64_t *bytes_written)
+{
+    FILE *file = fopen(filename, "wb");
+    if (file == NULL)
+    {
+        printf("Failed to open %s\n", filename);
+        return false;
+    }
+    bool written = fwrite(data, 1, size, file) == size;
+    written = fclose(file) == 0 && written;
+    if (!written)
+    {
+        printf("Failed to write %s\n", filename);
+        return false;
+    }
+    *bytes_written += size;
+    return true;
+}
+
+// Encodes in memory so the size written is known, the files are written with one call
+static bool write_image(const char *filename, const char *extension, const cv::Mat &image,
+    const std::vector<int> &params, uint64_t *bytes_written)
+{
+    if (strcmp(extension, ".raw") == 0)
+    {
+        cv::Mat pixels = image.isContinuous() ? image : image.clone();
+        return write_file(filename, pixels.data, pixels.total() * pixels.elemSize(), bytes_written);
+    }
+
+    std::vector<uint8_t> encoded;
+    if (!cv::imencode(extension, image, encoded, params))
+    {
+        printf("Failed to encode %s\n", filename);
+        return false;
+    }
+    return write_file(filename, encoded.data(), encoded.size(), bytes_written);
 }
 
-//extract(playback, &capture, output_path, transformation, transformed_depth_image, color_image_width_pixels, color_image_height_pixels, distortion, matrix, compression_params);
 
 bool extract(k4a_capture_t capture, const char * output_path, k4a_transformation_t transformation, k4a_image_t transformed_depth_image,
     int color_image_width_pixels, int color_image_height_pixels, int depth_image_width_pixels, int depth_image_height_pixels, 
-    cv::Mat distortion, cv::Matx33d matrix, std::vector<int> compression_params, bool undist_project, bool extract_ir_images)
+    const cv::Mat &undistort_map1, const cv::Mat &undistort_map2, cv::Mat &undistorted_color, cv::Mat &undistorted_depth,
+    const output_settings_t &settings, bool undist_project, bool extract_ir_images, uint64_t *bytes_written)
 {
     k4a_image_t depth_image = NULL;
     k4a_image_t color_image = NULL;
@@ -98,7 +169,8 @@ bool extract(k4a_capture_t capture, const char * output_path, k4a_transformation
     uint32_t size;
 
     cv::Mat img_array;
-    cv::Mat img_array_undistorted;
+    bool written = true;
+    const char *depth_extension = settings.depth_extension.c_str();
 
     // Fetch color and depth frames
     color_image = k4a_capture_get_color_image(capture);
@@ -128,35 +200,27 @@ bool extract(k4a_capture_t capture, const char * output_path, k4a_transformation
     color_timestamp = k4a_image_get_device_timestamp_usec(color_image);
     sprintf (color_filename, "%s/color/%012ld.jpg", output_path, color_timestamp);
     depth_timestamp = k4a_image_get_device_timestamp_usec(depth_image);
-    sprintf (depth_filename, "%s/depth/%012ld.png", output_path, depth_timestamp);
+    sprintf (depth_filename, "%s/depth/%012ld%s", output_path, depth_timestamp, depth_extension);
     if (extract_ir_images) {
-        sprintf (ir_filename, "%s/ir/%012ld.png", output_path, depth_timestamp);
+        sprintf (ir_filename, "%s/ir/%012ld%s", output_path, depth_timestamp, depth_extension);
     }
 
     if (!undist_project) {
-        FILE * pFile;
-
         buffer = k4a_image_get_buffer(color_image);
         size = k4a_image_get_size(color_image);
 
-        pFile = fopen (color_filename, "w");
-
-        if (pFile!=NULL)
-        {
-            fwrite(buffer, 1, size, pFile);
-            fclose (pFile);
-        }
+        written = write_file(color_filename, buffer, size, bytes_written) && written;
 
         buffer = k4a_image_get_buffer(depth_image);
 
         img_array = cv::Mat(depth_image_height_pixels, depth_image_width_pixels, CV_16UC1, buffer);
-        cv::imwrite(depth_filename,  img_array);
+        written = write_image(depth_filename, depth_extension, img_array, settings.depth_params, bytes_written) && written;
 
         if (extract_ir_images) {
             buffer = k4a_image_get_buffer(ir_image);
 
             img_array = cv::Mat(depth_image_height_pixels, depth_image_width_pixels, CV_16UC1, buffer);
-            cv::imwrite(ir_filename,  img_array);
+            written = write_image(ir_filename, depth_extension, img_array, settings.depth_params, bytes_written) && written;
         }
 
     }
@@ -165,6 +229,13 @@ bool extract(k4a_capture_t capture, const char * output_path, k4a_transformation
             k4a_transformation_depth_image_to_color_camera(transformation, depth_image, transformed_depth_image))
         {
             printf("Failed to compute transformed depth image\n");
+            if (ir_image != NULL)
+            {
+                k4a_image_release(ir_image);
+            }
+            k4a_image_release(depth_image);
+            k4a_image_release(color_image);
+            k4a_capture_release(capture);
             return false;
         }
         try {
@@ -172,18 +243,20 @@ bool extract(k4a_capture_t capture, const char * output_path, k4a_transformation
         size = k4a_image_get_size(color_image);
 
         img_array = cv::imdecode(cv::Mat(1, size, CV_8UC1, buffer), cv::IMREAD_UNCHANGED);
-        cv::undistort(img_array, img_array_undistorted, matrix, distortion);
-        cv::imwrite(color_filename, img_array_undistorted, compression_params);
+        cv::remap(img_array, undistorted_color, undistort_map1, undistort_map2, cv::INTER_LINEAR);
+        written = write_image(color_filename, ".jpg", undistorted_color, settings.color_params, bytes_written) && written;
 
         buffer = k4a_image_get_buffer(transformed_depth_image);
         size = k4a_image_get_size(transformed_depth_image);
 
         img_array = cv::Mat(color_image_height_pixels, color_image_width_pixels, CV_16UC1, buffer);
-        cv::undistort(img_array, img_array_undistorted, matrix, distortion);
-        cv::imwrite(depth_filename,  img_array_undistorted);
+        cv::remap(img_array, undistorted_depth, undistort_map1, undistort_map2, cv::INTER_LINEAR);
+        written = write_image(depth_filename, depth_extension, undistorted_depth, settings.depth_params, bytes_written) &&
+                  written;
         }
         catch (...) {
             printf("Problem catched!\n");
+            written = false;
         }
     }
 
@@ -206,25 +279,282 @@ bool extract(k4a_capture_t capture, const char * output_path, k4a_transformation
         k4a_capture_release(capture);
     }
 
-    return true;
+    return written;
 }
 
 
-static int playback(char *input_path, const char * output_path, bool undist_project, bool extract_ir_images)
+#ifdef HAVE_OPENCV_CUDAWARPING
+// Undistorts the color and transformed depth images of a batch of captures on the GPU. The color images are decoded by
+// libjpeg-turbo straight from the buffers of the playback into pinned memory, and the uploads, remaps and downloads of
+// the batch are queued on one stream while the next captures of the batch are decoded and transformed on the CPU.
+class gpu_batch_t
+{
+public:
+    gpu_batch_t(const cv::Mat &map_x, const cv::Mat &map_y, const k4a_calibration_t &calibration, int width,
+        int height, bool require_ir_image)
+        : m_width(width), m_height(height), m_require_ir_image(require_ir_image)
+    {
+        m_decompressor = tjInitDecompress();
+        m_compressor = tjInitCompress();
+        m_transformation = k4a_transformation_create(&calibration);
+        m_map_x.upload(map_x);
+        m_map_y.upload(map_y);
+        for (slot_t &slot : m_slots)
+        {
+            slot.color = cv::cuda::HostMem(height, width, CV_8UC3, cv::cuda::HostMem::PAGE_LOCKED);
+            slot.depth = cv::cuda::HostMem(height, width, CV_16UC1, cv::cuda::HostMem::PAGE_LOCKED);
+            slot.undistorted_color = cv::cuda::HostMem(height, width, CV_8UC3, cv::cuda::HostMem::PAGE_LOCKED);
+            slot.undistorted_depth = cv::cuda::HostMem(height, width, CV_16UC1, cv::cuda::HostMem::PAGE_LOCKED);
+            // The depth engine writes the transformed depth image into the pinned memory that is uploaded
+            if (K4A_RESULT_SUCCEEDED != k4a_image_create_from_buffer(K4A_IMAGE_FORMAT_DEPTH16,
+                                                                     width,
+                                                                     height,
+                                                                     (int)slot.depth.step,
+                                                                     slot.depth.data,
+                                                                     slot.depth.step * (size_t)height,
+                                                                     NULL,
+                                                                     NULL,
+                                                                     &slot.transformed_depth_image))
+            {
+                slot.transformed_depth_image = NULL;
+            }
+        }
+    }
+
+    ~gpu_batch_t()
+    {
+        for (slot_t &slot : m_slots)
+        {
+            release(slot);
+            if (slot.transformed_depth_image != NULL)
+            {
+                k4a_image_release(slot.transformed_depth_image);
+            }
+        }
+        if (m_transformation != NULL)
+        {
+            k4a_transformation_destroy(m_transformation);
+        }
+        if (m_compressor != NULL)
+        {
+            tjDestroy(m_compressor);
+        }
+        if (m_decompressor != NULL)
+        {
+            tjDestroy(m_decompressor);
+        }
+    }
+
+    bool valid() const
+    {
+        if (m_decompressor == NULL || m_compressor == NULL || m_transformation == NULL)
+        {
+            return false;
+        }
+        for (const slot_t &slot : m_slots)
+        {
+            if (slot.transformed_depth_image == NULL)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Takes ownership of the captures, up to CAPTURES_PER_GPU_BATCH of them. Returns false if one of them failed.
+    bool extract(k4a_capture_t *captures, size_t count, const char *output_path, const output_settings_t &settings,
+        uint64_t *bytes_written)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            m_slots[i].queued = queue(m_slots[i], captures[i]);
+        }
+        m_stream.waitForCompletion();
+
+        bool written = true;
+        for (size_t i = 0; i < count; i++)
+        {
+            slot_t &slot = m_slots[i];
+            if (slot.queued)
+            {
+                written = write(slot, output_path, settings, bytes_written) && written;
+            }
+            else if (slot.failed)
+            {
+                written = false;
+            }
+            release(slot);
+        }
+        return written;
+    }
+
+private:
+    struct slot_t
+    {
+        k4a_capture_t capture = NULL;
+        k4a_image_t color_image = NULL;
+        k4a_image_t depth_image = NULL;
+        k4a_image_t transformed_depth_image = NULL;
+        cv::cuda::HostMem color;
+        cv::cuda::HostMem depth;
+        cv::cuda::HostMem undistorted_color;
+        cv::cuda::HostMem undistorted_depth;
+        cv::cuda::GpuMat gpu_color;
+        cv::cuda::GpuMat gpu_depth;
+        cv::cuda::GpuMat gpu_undistorted_color;
+        cv::cuda::GpuMat gpu_undistorted_depth;
+        bool queued = false;
+        bool failed = false;
+    };
+
+    // Decodes and transforms the images of the capture, then queues their undistortion. Returns false if the capture
+    // has nothing to extract or failed, see slot_t::failed.
+    bool queue(slot_t &slot, k4a_capture_t capture)
+    {
+        release(slot);
+        slot.capture = capture;
+        slot.failed = false;
+        slot.color_image = k4a_capture_get_color_image(capture);
+        slot.depth_image = k4a_capture_get_depth_image(capture);
+        if (slot.color_image == NULL || slot.depth_image == NULL)
+        {
+            return false;
+        }
+        // Like extract(), captures without an infrared image are skipped when they are extracted
+        if (m_require_ir_image)
+        {
+            k4a_image_t ir_image = k4a_capture_get_ir_image(capture);
+            if (ir_image == NULL)
+            {
+                return false;
+            }
+            k4a_image_release(ir_image);
+        }
+
+        int width = 0;
+        int height = 0;
+        int subsampling = 0;
+        int colorspace = 0;
+        uint8_t *buffer = k4a_image_get_buffer(slot.color_image);
+        unsigned long size = (unsigned long)k4a_image_get_size(slot.color_image);
+        slot.failed = true;
+        if (tjDecompressHeader3(m_decompressor, buffer, size, &width, &height, &subsampling, &colorspace) != 0 ||
+            width != m_width || height != m_height ||
+            tjDecompress2(m_decompressor, buffer, size, slot.color.data, width, (int)slot.color.step, height,
+                          TJPF_BGR, 0) != 0)
+        {
+            printf("Failed to decode color image\n");
+            return false;
+        }
+        if (K4A_RESULT_SUCCEEDED !=
+            k4a_transformation_depth_image_to_color_camera(m_transformation, slot.depth_image,
+                                                           slot.transformed_depth_image))
+        {
+            printf("Failed to compute transformed depth image\n");
+            return false;
+        }
+        slot.failed = false;
+
+        slot.gpu_color.upload(slot.color, m_stream);
+        cv::cuda::remap(slot.gpu_color, slot.gpu_undistorted_color, m_map_x, m_map_y, cv::INTER_LINEAR,
+                        cv::BORDER_CONSTANT, cv::Scalar(), m_stream);
+        slot.gpu_undistorted_color.download(slot.undistorted_color, m_stream);
+
+        slot.gpu_depth.upload(slot.depth, m_stream);
+        cv::cuda::remap(slot.gpu_depth, slot.gpu_undistorted_depth, m_map_x, m_map_y, cv::INTER_LINEAR,
+                        cv::BORDER_CONSTANT, cv::Scalar(), m_stream);
+        slot.gpu_undistorted_depth.download(slot.undistorted_depth, m_stream);
+        return true;
+    }
+
+    bool write(slot_t &slot, const char *output_path, const output_settings_t &settings, uint64_t *bytes_written)
+    {
+        char color_filename[1024];
+        char depth_filename[1024];
+        const char *depth_extension = settings.depth_extension.c_str();
+        sprintf(color_filename, "%s/color/%012ld.jpg", output_path,
+                k4a_image_get_device_timestamp_usec(slot.color_image));
+        sprintf(depth_filename, "%s/depth/%012ld%s", output_path,
+                k4a_image_get_device_timestamp_usec(slot.depth_image), depth_extension);
+
+        unsigned char *jpeg = NULL;
+        unsigned long jpeg_size = 0;
+        bool written = tjCompress2(m_compressor, slot.undistorted_color.data, m_width, (int)slot.undistorted_color.step,
+                                   m_height, TJPF_BGR, &jpeg, &jpeg_size, TJSAMP_420, settings.color_quality, 0) == 0;
+        if (!written)
+        {
+            printf("Failed to encode %s\n", color_filename);
+        }
+        else
+        {
+            written = write_file(color_filename, jpeg, jpeg_size, bytes_written);
+        }
+        tjFree(jpeg);
+
+        written = write_image(depth_filename, depth_extension, slot.undistorted_depth.createMatHeader(),
+                              settings.depth_params, bytes_written) && written;
+        return written;
+    }
+
+    static void release(slot_t &slot)
+    {
+        if (slot.depth_image != NULL)
+        {
+            k4a_image_release(slot.depth_image);
+            slot.depth_image = NULL;
+        }
+        if (slot.color_image != NULL)
+        {
+            k4a_image_release(slot.color_image);
+            slot.color_image = NULL;
+        }
+        if (slot.capture != NULL)
+        {
+            k4a_capture_release(slot.capture);
+            slot.capture = NULL;
+        }
+        slot.queued = false;
+    }
+
+    int m_width;
+    int m_height;
+    bool m_require_ir_image;
+    tjhandle m_decompressor = NULL;
+    tjhandle m_compressor = NULL;
+    k4a_transformation_t m_transformation = NULL;
+    cv::cuda::Stream m_stream;
+    cv::cuda::GpuMat m_map_x;
+    cv::cuda::GpuMat m_map_y;
+    slot_t m_slots[CAPTURES_PER_GPU_BATCH];
+};
+#endif
+
+
+static void print_throughput(const char *label, uint32_t number_of_captures, uint64_t bytes_written,
+    std::chrono::steady_clock::time_point begin)
+{
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    float seconds = static_cast< float >(std::chrono::duration_cast<std::chrono::microseconds>(now - begin).count()) /
+                    1000000.0f;
+    if (seconds <= 0.0f)
+    {
+        seconds = 1e-6f;
+    }
+    printf("%u %s, %f fps, %f MB/s.\n", number_of_captures, label, static_cast< float >(number_of_captures) / seconds,
+        static_cast< float >(bytes_written) / (1024.0f * 1024.0f) / seconds);
+}
+
+static int playback(char *input_path, const char * output_path, bool undist_project, bool extract_ir_images,
+    bool use_gpu, const output_settings_t &settings)
 {
     k4a_playback_t playback = NULL;
 
     k4a_calibration_t calibration;
-    k4a_transformation_t transformation = NULL;
     k4a_calibration_camera_t calib_color;
     k4a_calibration_camera_t calib_depth;
     struct k4a_calibration_intrinsic_parameters_t::_param param;
 
-    k4a_capture_t array_of_captures[CAPTURES_IN_BATCH];
-    k4a_image_t array_of_transformed_depth_images[CAPTURES_IN_BATCH];
-
     k4a_result_t result;
-    k4a_stream_result_t stream_result;
 
     int color_image_width_pixels;
     int color_image_height_pixels;
@@ -234,17 +564,8 @@ static int playback(char *input_path, const char * output_path, bool undist_proj
 
     cv::Mat distortion;
     cv::Matx33d matrix;
-    cv::Mat img_array;
-    cv::Mat img_array_undistorted;
-    std::vector<int> compression_params;
-
-    compression_params.push_back(cv::IMWRITE_JPEG_QUALITY);
-    compression_params.push_back(96);
-
-    uint32_t i;
-    uint32_t number_of_captures = 0;
-    bool flag_to_finish = false;
-    bool array_of_extraction_results[CAPTURES_IN_BATCH];
+    cv::Mat undistort_map1;
+    cv::Mat undistort_map2;
 
     // Open recording
     result = k4a_playback_open(input_path, &playback);
@@ -257,11 +578,10 @@ static int playback(char *input_path, const char * output_path, bool undist_proj
     if (K4A_RESULT_SUCCEEDED != k4a_playback_get_calibration(playback, &calibration))
     {
         printf("Failed to get calibration\n");
+        k4a_playback_close(playback);
         return 1;
     }
 
-    transformation = k4a_transformation_create(&calibration);
-    
     calib_color = calibration.color_camera_calibration;
     color_image_width_pixels = calib_color.resolution_width;
     color_image_height_pixels = calib_color.resolution_height;
@@ -271,93 +591,199 @@ static int playback(char *input_path, const char * output_path, bool undist_proj
     param = calib_color.intrinsics.parameters.param;
     distortion = (cv::Mat_<double>(8,1) << param.k1, param.k2, param.p1, param.p2, param.k3, param.k4, param.k5, param.k6);
     matrix = cv::Matx33d(param.fx, 0.0, param.cx, 0.0, param.fy, param.cy, 0.0, 0.0, 1.0);
-    
-    // Init depth frame buffer
-    for (i = 0; i < CAPTURES_IN_BATCH; i++) {
-        array_of_captures[i] = NULL;
-        if (K4A_RESULT_SUCCEEDED != k4a_image_create(K4A_IMAGE_FORMAT_DEPTH16,
-                                                     color_image_width_pixels,
-                                                     color_image_height_pixels,
-                                                     color_image_width_pixels * (int)sizeof(uint16_t),
-                                                     &array_of_transformed_depth_images[i]))
-        {
-            printf("Failed to create transformed depth image\n");
-            return 1;
-        }
+
+    // The color and the transformed depth images share the color camera geometry, so one map undistorts both. It is
+    // the map cv::undistort() would build for every image.
+    // cv::cuda::remap() only takes separate x and y maps of floats.
+    if (undist_project)
+    {
+        cv::initUndistortRectifyMap(matrix, distortion, cv::Mat(), matrix,
+                                    cv::Size(color_image_width_pixels, color_image_height_pixels),
+                                    use_gpu ? CV_32FC1 : CV_16SC2, undistort_map1, undistort_map2);
     }
 
-    for (uint32_t batch = 0; batch < MAX_NUMBER_OF_CAPTURES / CAPTURES_IN_BATCH; batch++) {
-        if (flag_to_finish == true) {
-            break;
+    unsigned number_of_workers = std::thread::hardware_concurrency();
+    if (number_of_workers == 0)
+    {
+        number_of_workers = 8;
+    }
+    capture_queue_t queue(number_of_workers * CAPTURES_PER_WORKER);
+    std::atomic<uint32_t> number_of_extracted_captures(0);
+    std::atomic<uint64_t> total_bytes_written(0);
+    std::atomic<bool> failed(false);
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+    auto report = [&](uint32_t count, uint64_t bytes_written) {
+        total_bytes_written += bytes_written;
+        uint32_t extracted = number_of_extracted_captures += count;
+        if (extracted % CAPTURES_PER_REPORT < count)
+        {
+            print_throughput("captures", extracted, total_bytes_written, begin);
+        }
+    };
+
+#ifdef HAVE_OPENCV_CUDAWARPING
+    // Each GPU worker takes a batch of captures from the queue, its remaps run while the next batch is decoded by the
+    // other workers
+    auto gpu_worker = [&]() {
+        std::unique_ptr<gpu_batch_t> batch;
+        try
+        {
+            batch.reset(new gpu_batch_t(undistort_map1, undistort_map2, calibration, color_image_width_pixels,
+                                        color_image_height_pixels, extract_ir_images));
+        }
+        catch (const cv::Exception &e)
+        {
+            printf("Failed to allocate the GPU buffers: %s\n", e.what());
+        }
+        if (batch == nullptr || !batch->valid())
+        {
+            printf("Failed to create the GPU extraction buffers\n");
+            failed = true;
+            queue.close();
+            return;
         }
-        printf("Batch #%d, ", batch + 1);
 
-        number_of_captures = 0;
-        for (i = 0; i < CAPTURES_IN_BATCH; i++) {
-            stream_result = k4a_playback_get_next_capture(playback, &array_of_captures[i]);
-            if (stream_result != K4A_STREAM_RESULT_SUCCEEDED || array_of_captures[i] == NULL)
+        k4a_capture_t captures[CAPTURES_PER_GPU_BATCH];
+        while (!failed)
+        {
+            size_t count = 0;
+            while (count < CAPTURES_PER_GPU_BATCH && queue.pop(&captures[count]))
+            {
+                count++;
+            }
+            if (count == 0)
             {
-                if (stream_result == K4A_STREAM_RESULT_EOF) {
-                    flag_to_finish = true;
-                }
-                else {
-                    printf("Failed to fetch frame\n");
-                    return 1;
-                }
                 break;
             }
-        }
-        number_of_captures = i;
-        printf("%d captures, ", number_of_captures);
-
-        //std::this_thread::sleep_for(std::chrono::seconds(10));
-        
-        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
-
-        // The core loop
-        parallel_for(number_of_captures, [&](int start, int end){ 
-            for(int i = start; i < end; ++i) {
-                array_of_extraction_results[i] = extract(array_of_captures[i], 
-                    output_path, transformation, array_of_transformed_depth_images[i], 
-                    color_image_width_pixels, color_image_height_pixels, 
-                    depth_image_width_pixels, depth_image_height_pixels, 
-                    distortion, matrix, compression_params, undist_project, extract_ir_images);
-                if (array_of_extraction_results[i] == false) {
+
+            uint64_t bytes_written = 0;
+            try
+            {
+                if (!batch->extract(captures, count, output_path, settings, &bytes_written))
+                {
                     printf("Extraction failed\n");
-                    // should be proper handling
                 }
             }
+            catch (const cv::Exception &e)
+            {
+                printf("Problem catched: %s\n", e.what());
+            }
+            report((uint32_t)count, bytes_written);
+        }
+    };
+#endif
+
+    // Each worker extracts captures from the queue with its own transformation and output images, so reading,
+    // decoding and writing overlap across all cores
+    auto worker = [&]() {
+        k4a_transformation_t transformation = NULL;
+        k4a_image_t transformed_depth_image = NULL;
+        cv::Mat undistorted_color;
+        cv::Mat undistorted_depth;
+        if (undist_project)
+        {
+            transformation = k4a_transformation_create(&calibration);
+            if (transformation == NULL ||
+                K4A_RESULT_SUCCEEDED != k4a_image_create(K4A_IMAGE_FORMAT_DEPTH16,
+                                                         color_image_width_pixels,
+                                                         color_image_height_pixels,
+                                                         color_image_width_pixels * (int)sizeof(uint16_t),
+                                                         &transformed_depth_image))
+            {
+                printf("Failed to create transformed depth image\n");
+                failed = true;
+                queue.close();
+            }
+        }
 
-        });
+        k4a_capture_t capture = NULL;
+        while (!failed && queue.pop(&capture))
+        {
+            uint64_t bytes_written = 0;
+            if (!extract(capture, output_path, transformation, transformed_depth_image,
+                    color_image_width_pixels, color_image_height_pixels,
+                    depth_image_width_pixels, depth_image_height_pixels,
+                    undistort_map1, undistort_map2, undistorted_color, undistorted_depth,
+                    settings, undist_project, extract_ir_images, &bytes_written))
+            {
+                printf("Extraction failed\n");
+                // should be proper handling
+            }
 
-        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
-        float res = static_cast< float >(number_of_captures) * 1000000.0 / static_cast< float >(std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count());
-        printf("%f fps.\n", res);
-    }
+            report(1, bytes_written);
+        }
 
-    // Release
-    for (i = 0; i < CAPTURES_IN_BATCH; i++) {
-      if (array_of_transformed_depth_images[i] != NULL)
-      {
-          k4a_image_release(array_of_transformed_depth_images[i]);
-      }   
-    }
-    if (playback != NULL)
+        if (transformed_depth_image != NULL)
+        {
+            k4a_image_release(transformed_depth_image);
+        }
+        if (transformation != NULL)
+        {
+            k4a_transformation_destroy(transformation);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < number_of_workers; i++)
     {
-        k4a_playback_close(playback);
+#ifdef HAVE_OPENCV_CUDAWARPING
+        if (use_gpu)
+        {
+            workers.emplace_back(gpu_worker);
+            continue;
+        }
+#endif
+        workers.emplace_back(worker);
     }
-    if (transformation != NULL)
+
+    // The playback is only read from this thread, the workers take its captures from the queue
+    std::thread reader([&]() {
+        for (uint32_t i = 0; i < MAX_NUMBER_OF_CAPTURES; i++)
+        {
+            k4a_capture_t capture = NULL;
+            k4a_stream_result_t stream_result = k4a_playback_get_next_capture(playback, &capture);
+            if (stream_result == K4A_STREAM_RESULT_EOF)
+            {
+                break;
+            }
+            else if (stream_result != K4A_STREAM_RESULT_SUCCEEDED || capture == NULL)
+            {
+                printf("Failed to fetch frame\n");
+                failed = true;
+                break;
+            }
+
+            if (!queue.push(capture))
+            {
+                break;
+            }
+        }
+        queue.close();
+    });
+
+    reader.join();
+    for (std::thread &thread : workers)
     {
-        k4a_transformation_destroy(transformation);
+        thread.join();
     }
-    return 0;
+
+    print_throughput("captures extracted", number_of_extracted_captures, total_bytes_written, begin);
+
+    // Release
+    k4a_playback_close(playback);
+    return failed ? 1 : 0;
 }
 
 int main(int argc, char **argv)
 {
     int extraction_mode = 0;
     int extract_ir_images = 0;
+    int use_gpu = 0;
+    int png_compression = -1;
+    int png_strategy = -1;
     int return_code = 0;
+    output_settings_t settings;
 
     CmdParser::OptionParser cmd_parser;
     cmd_parser.RegisterOption("-h|--help", "Prints this help", [&]() {
@@ -400,6 +826,70 @@ int main(int argc, char **argv)
                                   }
                               });
 
+    cmd_parser.RegisterOption("--gpu",
+                              "Either undistort on the GPU or not when \"--mode\" equals 1 (default: 0).\n"
+                              "Requires OpenCV built with its CUDA modules.\n"
+                              "0 - undistort on the CPU.\n"
+                              "1 - undistort batches of captures on the GPU.",
+                              1,
+                              [&](const std::vector<char *> &args) {
+                              use_gpu = std::stoi(args[0]);
+                              if (use_gpu != 0 && use_gpu != 1) {
+                                  std::ostringstream str;
+                                  str << "GPU mode " << use_gpu <<" is unknown. Must be either 0 or 1";
+                                  throw std::runtime_error(str.str());
+                                  }
+                              });
+    cmd_parser.RegisterOption("--depth-format",
+                              "Specify the format of depth and infrared images (default: png).\n"
+                              "png - 16-bit PNG images.\n"
+                              "tiff - 16-bit TIFF images, faster to encode than PNG.\n"
+                              "raw - 16-bit little-endian pixels without a header, the fastest to write.",
+                              1,
+                              [&](const std::vector<char *> &args) {
+                              std::string format = args[0];
+                              if (format != "png" && format != "tiff" && format != "raw") {
+                                  std::ostringstream str;
+                                  str << "Depth format " << format << " is unknown. Must be png, tiff or raw";
+                                  throw std::runtime_error(str.str());
+                                  }
+                              settings.depth_extension = "." + format;
+                              });
+    cmd_parser.RegisterOption("--png-compression",
+                              "Specify the zlib compression level of PNG images, from 0 (fastest, largest) to 9 "
+                              "(slowest, smallest) (default: OpenCV's default).",
+                              1,
+                              [&](const std::vector<char *> &args) {
+                              png_compression = std::stoi(args[0]);
+                              if (png_compression < 0 || png_compression > 9) {
+                                  std::ostringstream str;
+                                  str << "PNG compression level " << png_compression << " is unknown. Must lie in [0,9]";
+                                  throw std::runtime_error(str.str());
+                                  }
+                              });
+    cmd_parser.RegisterOption("--png-strategy",
+                              "Specify the zlib strategy of PNG images (default: OpenCV's default).\n"
+                              "default, filtered, huffman, rle or fixed. rle and huffman are the fastest.",
+                              1,
+                              [&](const std::vector<char *> &args) {
+                              std::string strategy = args[0];
+                              if (strategy == "default") {
+                                  png_strategy = cv::IMWRITE_PNG_STRATEGY_DEFAULT;
+                              } else if (strategy == "filtered") {
+                                  png_strategy = cv::IMWRITE_PNG_STRATEGY_FILTERED;
+                              } else if (strategy == "huffman") {
+                                  png_strategy = cv::IMWRITE_PNG_STRATEGY_HUFFMAN_ONLY;
+                              } else if (strategy == "rle") {
+                                  png_strategy = cv::IMWRITE_PNG_STRATEGY_RLE;
+                              } else if (strategy == "fixed") {
+                                  png_strategy = cv::IMWRITE_PNG_STRATEGY_FIXED;
+                              } else {
+                                  std::ostringstream str;
+                                  str << "PNG strategy " << strategy << " is unknown. Must be default, filtered, huffman, rle or fixed";
+                                  throw std::runtime_error(str.str());
+                                  }
+                              });
+
     int args_left = 0;
     try
     {
@@ -410,9 +900,40 @@ int main(int argc, char **argv)
         std::cerr << e.option() << ": " << e.what() << std::endl;
         return 1;
     }
+    if (use_gpu && extraction_mode != 1)
+    {
+        std::cerr << "--gpu: The GPU only undistorts images, it requires \"--mode\" equal to 1" << std::endl;
+        return 1;
+    }
+#ifdef HAVE_OPENCV_CUDAWARPING
+    if (use_gpu && cv::cuda::getCudaEnabledDeviceCount() == 0)
+    {
+        std::cerr << "--gpu: No CUDA device is available" << std::endl;
+        return 1;
+    }
+#else
+    if (use_gpu)
+    {
+        std::cerr << "--gpu: This build of OpenCV doesn't have the CUDA modules" << std::endl;
+        return 1;
+    }
+#endif
     if (args_left == 2)
     {
-        return_code = playback(argv[argc - 2], argv[argc -1], extraction_mode, extract_ir_images);
+        settings.color_params.push_back(cv::IMWRITE_JPEG_QUALITY);
+        settings.color_params.push_back(settings.color_quality);
+        if (settings.depth_extension == ".png" && png_compression >= 0)
+        {
+            settings.depth_params.push_back(cv::IMWRITE_PNG_COMPRESSION);
+            settings.depth_params.push_back(png_compression);
+        }
+        if (settings.depth_extension == ".png" && png_strategy >= 0)
+        {
+            settings.depth_params.push_back(cv::IMWRITE_PNG_STRATEGY);
+            settings.depth_params.push_back(png_strategy);
+        }
+        return_code = playback(argv[argc - 2], argv[argc -1], extraction_mode, extract_ir_images, use_gpu,
+            settings);
     }
     else
     {
@@ -2,32 +2,177 @@
 // Licensed under the MIT License.
 
 #include <stdio.h>
-#include <malloc.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <inttypes.h>
 #include <k4a/k4a.h>
 #include <k4arecord/playback.h>
 
-#define min(a,b) \
-   ({ __typeof__ (a) _a = (a); \
-       __typeof__ (b) _b = (b); \
-     _a < _b ? _a : _b; })
+#define IMU_SAMPLE_CHUNK_SIZE 4096      // Samples read from the recording at a time
+#define OUTPUT_BUFFER_SIZE (1024 * 1024) // Bytes of output written to the file at a time
+#define MAX_RECORD_SIZE 512             // Upper bound of the size of one sample in any output format
 
-#define max(a,b) \
-   ({ __typeof__ (a) _a = (a); \
-       __typeof__ (b) _b = (b); \
-     _a > _b ? _a : _b; })
+// The NPY header is written with a fixed size so the sample count can be filled in once all samples are written
+#define NPY_HEADER_SIZE 256
+#define NPY_RECORD_SIZE 40
 
-#define MAX_IMU_SAMPLE_NUMBER (1600 * 3600 * 2) // ( frame rate * seconds in an hour * hours)
+typedef enum
+{
+    OUTPUT_FORMAT_CSV = 0,
+    OUTPUT_FORMAT_NPY
+} output_format_t;
 
-int main(int argc, char **argv)
+typedef struct
+{
+    FILE *file;
+    char *buffer;
+    size_t size;
+    int failed;
+} output_t;
+
+static void flush_output(output_t *output)
+{
+    if (output->size > 0 && fwrite(output->buffer, 1, output->size, output->file) != output->size)
+    {
+        output->failed = 1;
+    }
+    output->size = 0;
+}
+
+static char *format_uint64(char *out, uint64_t value)
 {
-    //printf("%d", argc);
-    //printf(argv[1]);
+    char digits[20];
+    int count = 0;
+    do
+    {
+        digits[count++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (count > 0)
+    {
+        *out++ = digits[--count];
+    }
+    return out;
+}
+
+// Formats a float the way printf("%f") does. A float times 10^6 is exact in a double, so rounding it to the nearest
+// integer, ties to even, gives the same 6 decimals.
+static char *format_float(char *out, float value)
+{
+    int negative = signbit(value) ? 1 : 0;
+    double scaled = (double)value * 1000000.0;
+    if (negative)
+    {
+        scaled = -scaled;
+    }
+    if (!(scaled < 9e15))
+    {
+        // NaN, infinity and values too large for the integer path
+        return out + sprintf(out, "%f", (double)value);
+    }
+
+    uint64_t magnitude = (uint64_t)scaled;
+    double remainder = scaled - (double)magnitude;
+    if (remainder > 0.5 || (remainder == 0.5 && (magnitude & 1)))
+    {
+        magnitude++;
+    }
+
+    if (negative)
+    {
+        *out++ = '-';
+    }
+    out = format_uint64(out, magnitude / 1000000);
+    *out++ = '.';
+    uint32_t fraction = (uint32_t)(magnitude % 1000000);
+    for (int i = 5; i >= 0; i--)
+    {
+        out[i] = (char)('0' + fraction % 10);
+        fraction /= 10;
+    }
+    return out + 6;
+}
+
+static void write_csv_sample(output_t *output, const k4a_imu_sample_t *imu_sample)
+{
+    char *out = output->buffer + output->size;
+    out = format_uint64(out, imu_sample->gyro_timestamp_usec);
+    for (int i = 0; i < 3; i++)
+    {
+        *out++ = ',';
+        out = format_float(out, imu_sample->gyro_sample.v[i]);
+    }
+    *out++ = ',';
+    out = format_uint64(out, imu_sample->acc_timestamp_usec);
+    for (int i = 0; i < 3; i++)
+    {
+        *out++ = ',';
+        out = format_float(out, imu_sample->acc_sample.v[i]);
+    }
+    *out++ = '\n';
+    output->size = (size_t)(out - output->buffer);
+}
 
-    if (argc < 3) {
-        printf("Usage: mrob_imu_data_extractor input.mkv output.csv\n");
+// Records are packed little-endian, in the same field order as the CSV columns
+static void write_npy_sample(output_t *output, const k4a_imu_sample_t *imu_sample)
+{
+    char *out = output->buffer + output->size;
+    memcpy(out, &imu_sample->gyro_timestamp_usec, sizeof(uint64_t));
+    memcpy(out + 8, imu_sample->gyro_sample.v, 3 * sizeof(float));
+    memcpy(out + 20, &imu_sample->acc_timestamp_usec, sizeof(uint64_t));
+    memcpy(out + 28, imu_sample->acc_sample.v, 3 * sizeof(float));
+    output->size += NPY_RECORD_SIZE;
+}
+
+// Writes the header of a version 1.0 NPY file holding a 1-D array of structured records, padded with spaces to
+// NPY_HEADER_SIZE bytes
+static int write_npy_header(FILE *file, uint64_t sample_count)
+{
+    char header[NPY_HEADER_SIZE];
+    memset(header, ' ', sizeof(header));
+    memcpy(header, "\x93NUMPY\x01\x00", 8);
+    header[8] = (char)((NPY_HEADER_SIZE - 10) & 0xff);
+    header[9] = (char)((NPY_HEADER_SIZE - 10) >> 8);
+    int length = snprintf(header + 10,
+                          NPY_HEADER_SIZE - 10,
+                          "{'descr': [('ot', '<u8'), ('ox', '<f4'), ('oy', '<f4'), ('oz', '<f4'), ('at', '<u8'), "
+                          "('ax', '<f4'), ('ay', '<f4'), ('az', '<f4')], 'fortran_order': False, 'shape': (%" PRIu64
+                          ",), }",
+                          sample_count);
+    if (length < 0 || length >= NPY_HEADER_SIZE - 11)
+    {
+        return 0;
+    }
+    header[10 + length] = ' ';
+    header[NPY_HEADER_SIZE - 1] = '\n';
+    return fseek(file, 0, SEEK_SET) == 0 && fwrite(header, 1, sizeof(header), file) == sizeof(header);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 3 && !(argc == 5 && strcmp(argv[3], "--format") == 0))
+    {
+        printf("Usage: mrob_imu_data_extractor input.mkv output [--format csv|npy]\n");
+        printf("  csv writes the columns ot,ox,oy,oz,at,ax,ay,az (default), npy writes the same fields as a NumPy\n");
+        printf("  structured array.\n");
         return 1;
     }
 
+    output_format_t format = OUTPUT_FORMAT_CSV;
+    if (argc == 5)
+    {
+        if (strcmp(argv[4], "npy") == 0)
+        {
+            format = OUTPUT_FORMAT_NPY;
+        }
+        else if (strcmp(argv[4], "csv") != 0)
+        {
+            printf("Unknown output format: %s\n", argv[4]);
+            return 1;
+        }
+    }
+
     k4a_playback_t playback_handle = NULL;
     if (k4a_playback_open(argv[1], &playback_handle) != K4A_RESULT_SUCCEEDED)
     {
@@ -35,29 +180,87 @@ int main(int argc, char **argv)
         return 1;
     }
 
+    output_t output = { 0 };
+    output.file = fopen(argv[2], "wb");
+    k4a_imu_sample_t *imu_samples = (k4a_imu_sample_t *)malloc(sizeof(k4a_imu_sample_t) * IMU_SAMPLE_CHUNK_SIZE);
+    output.buffer = (char *)malloc(OUTPUT_BUFFER_SIZE);
+    if (output.file == NULL || imu_samples == NULL || output.buffer == NULL)
+    {
+        printf("Failed to open output file: %s\n", argv[2]);
+        if (output.file != NULL)
+        {
+            fclose(output.file);
+        }
+        free(imu_samples);
+        free(output.buffer);
+        k4a_playback_close(playback_handle);
+        return 1;
+    }
+
+    if (format == OUTPUT_FORMAT_CSV)
+    {
+        const char *columns = "ot,ox,oy,oz,at,ax,ay,az\n";
+        memcpy(output.buffer, columns, strlen(columns));
+        output.size = strlen(columns);
+    }
+    else
+    {
+        output.failed = !write_npy_header(output.file, 0);
+    }
 
-    k4a_imu_sample_t imu_sample = { 0 };
-    FILE *fpt;
-    fpt = fopen(argv[2], "w+");
-    uint64_t last_imu_timestamp = 0;
-
-    //long long int recording_length = k4a_playback_get_last_timestamp_usec(playback_handle);
-    //printf("Recording is %lld useconds long\n", recording_length);
-    k4a_playback_seek_timestamp(playback_handle, 0, K4A_PLAYBACK_SEEK_END);
-    k4a_playback_get_previous_imu_sample(playback_handle, &imu_sample);
-    last_imu_timestamp = min(imu_sample.gyro_timestamp_usec, imu_sample.acc_timestamp_usec);
-    k4a_playback_seek_timestamp(playback_handle, 0, K4A_PLAYBACK_SEEK_BEGIN);
-    
-    fprintf(fpt, "ot,ox,oy,oz,at,ax,ay,az\n");
-    for (uint32_t i = 0; i < MAX_IMU_SAMPLE_NUMBER; i++) {
-        k4a_playback_get_next_imu_sample(playback_handle, &imu_sample);
-        fprintf(fpt, "%ld,%f,%f,%f,%ld,%f,%f,%f\n", \
-            imu_sample.gyro_timestamp_usec, imu_sample.gyro_sample.v[0], imu_sample.gyro_sample.v[1], imu_sample.gyro_sample.v[2], \
-            imu_sample.acc_timestamp_usec, imu_sample.acc_sample.v[0], imu_sample.acc_sample.v[1], imu_sample.acc_sample.v[2]);
-        if (max(imu_sample.gyro_timestamp_usec, imu_sample.acc_timestamp_usec) >= last_imu_timestamp) {
+    int result = 0;
+    uint64_t start_timestamp = 0;
+    uint64_t total_sample_count = 0;
+    size_t sample_count = 0;
+    do
+    {
+        if (k4a_playback_get_imu_samples(playback_handle,
+                                         start_timestamp,
+                                         UINT64_MAX,
+                                         imu_samples,
+                                         IMU_SAMPLE_CHUNK_SIZE,
+                                         &sample_count) != K4A_RESULT_SUCCEEDED)
+        {
+            printf("Failed to read IMU samples\n");
+            result = 1;
             break;
         }
-    }    
-    
+        for (size_t i = 0; i < sample_count; i++)
+        {
+            if (output.size + MAX_RECORD_SIZE > OUTPUT_BUFFER_SIZE)
+            {
+                flush_output(&output);
+            }
+            if (format == OUTPUT_FORMAT_CSV)
+            {
+                write_csv_sample(&output, &imu_samples[i]);
+            }
+            else
+            {
+                write_npy_sample(&output, &imu_samples[i]);
+            }
+        }
+        total_sample_count += sample_count;
+        // Continue after the last sample read
+        if (sample_count > 0)
+        {
+            start_timestamp = imu_samples[sample_count - 1].acc_timestamp_usec + 1;
+        }
+    } while (sample_count == IMU_SAMPLE_CHUNK_SIZE && !output.failed);
+
+    flush_output(&output);
+    if (format == OUTPUT_FORMAT_NPY && !output.failed)
+    {
+        output.failed = !write_npy_header(output.file, total_sample_count);
+    }
+    if (fclose(output.file) != 0 || output.failed)
+    {
+        printf("Failed to write output file: %s\n", argv[2]);
+        result = 1;
+    }
+
+    free(output.buffer);
+    free(imu_samples);
     k4a_playback_close(playback_handle);
+    return result;
 }
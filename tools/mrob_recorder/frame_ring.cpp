@@ -0,0 +1,215 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "frame_ring.h"
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define FRAME_RING_ALIGNMENT 64
+#define FRAME_RING_READ_ATTEMPTS 16
+
+static uint64_t align_size(uint64_t size)
+{
+    return (size + FRAME_RING_ALIGNMENT - 1) / FRAME_RING_ALIGNMENT * FRAME_RING_ALIGNMENT;
+}
+
+static uint8_t *get_slot(uint8_t *mapping, uint32_t index)
+{
+    const mrob_frame_ring_header_t *header = reinterpret_cast<const mrob_frame_ring_header_t *>(mapping);
+    return mapping + header->header_size + header->slot_size * index;
+}
+
+frame_ring_publisher::~frame_ring_publisher()
+{
+    if (m_mapping != NULL)
+    {
+        munmap(m_mapping, m_mapping_size);
+        shm_unlink(m_name.data());
+    }
+}
+
+bool frame_ring_publisher::create(const char *name, uint32_t slot_count, const k4a_calibration_t &calibration)
+{
+    uint64_t color_capacity = (uint64_t)calibration.color_camera_calibration.resolution_width *
+                              (uint64_t)calibration.color_camera_calibration.resolution_height * 4;
+    uint64_t depth_capacity = (uint64_t)calibration.depth_camera_calibration.resolution_width *
+                              (uint64_t)calibration.depth_camera_calibration.resolution_height * sizeof(uint16_t);
+    uint64_t header_size = align_size(sizeof(mrob_frame_ring_header_t));
+    uint64_t slot_size = align_size(sizeof(mrob_frame_slot_header_t) + color_capacity + depth_capacity);
+    size_t mapping_size = (size_t)(header_size + slot_size * slot_count);
+
+    // A ring left behind by a recorder that didn't exit cleanly is replaced
+    shm_unlink(name);
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0)
+    {
+        std::cerr << "Unable to create shared memory " << name << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    if (ftruncate(fd, (off_t)mapping_size) != 0)
+    {
+        std::cerr << "Unable to size shared memory " << name << ": " << strerror(errno) << std::endl;
+        close(fd);
+        shm_unlink(name);
+        return false;
+    }
+    void *mapping = mmap(NULL, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        std::cerr << "Unable to map shared memory " << name << ": " << strerror(errno) << std::endl;
+        shm_unlink(name);
+        return false;
+    }
+
+    m_name.assign(name, name + strlen(name) + 1);
+    m_mapping = static_cast<uint8_t *>(mapping);
+    m_mapping_size = mapping_size;
+
+    // The object is zero-filled, so every slot starts with an even sequence and no capture is published
+    mrob_frame_ring_header_t *header = reinterpret_cast<mrob_frame_ring_header_t *>(m_mapping);
+    header->version = MROB_FRAME_RING_VERSION;
+    header->slot_count = slot_count;
+    header->header_size = (uint32_t)header_size;
+    header->slot_size = slot_size;
+    header->color_capacity = color_capacity;
+    header->depth_capacity = depth_capacity;
+    header->calibration = calibration;
+    // Readers check the magic last written, once the rest of the header is complete
+    __atomic_store_n(&header->magic, (uint32_t)MROB_FRAME_RING_MAGIC, __ATOMIC_RELEASE);
+    return true;
+}
+
+void frame_ring_publisher::publish(k4a_image_t color_image, k4a_image_t depth_image, uint64_t global_timestamp_usec)
+{
+    if (m_mapping == NULL)
+    {
+        return;
+    }
+
+    mrob_frame_ring_header_t *header = reinterpret_cast<mrob_frame_ring_header_t *>(m_mapping);
+    uint64_t published_count = __atomic_load_n(&header->published_count, __ATOMIC_RELAXED);
+    uint8_t *slot_data = get_slot(m_mapping, (uint32_t)(published_count % header->slot_count));
+    mrob_frame_slot_header_t *slot = reinterpret_cast<mrob_frame_slot_header_t *>(slot_data);
+
+    uint64_t sequence = __atomic_load_n(&slot->sequence, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    size_t color_size = k4a_image_get_size(color_image);
+    size_t depth_size = k4a_image_get_size(depth_image);
+    color_size = color_size <= header->color_capacity ? color_size : 0;
+    depth_size = depth_size <= header->depth_capacity ? depth_size : 0;
+
+    slot->color_timestamp_usec = k4a_image_get_device_timestamp_usec(color_image);
+    slot->depth_timestamp_usec = k4a_image_get_device_timestamp_usec(depth_image);
+    slot->global_timestamp_usec = global_timestamp_usec;
+    slot->color_format = (uint32_t)k4a_image_get_format(color_image);
+    slot->color_width = (uint32_t)k4a_image_get_width_pixels(color_image);
+    slot->color_height = (uint32_t)k4a_image_get_height_pixels(color_image);
+    slot->color_stride = (uint32_t)k4a_image_get_stride_bytes(color_image);
+    slot->color_size = (uint32_t)color_size;
+    slot->depth_width = (uint32_t)k4a_image_get_width_pixels(depth_image);
+    slot->depth_height = (uint32_t)k4a_image_get_height_pixels(depth_image);
+    slot->depth_stride = (uint32_t)k4a_image_get_stride_bytes(depth_image);
+    slot->depth_size = (uint32_t)depth_size;
+    uint8_t *color_data = slot_data + sizeof(mrob_frame_slot_header_t);
+    memcpy(color_data, k4a_image_get_buffer(color_image), color_size);
+    memcpy(color_data + header->color_capacity, k4a_image_get_buffer(depth_image), depth_size);
+
+    __atomic_store_n(&slot->sequence, sequence + 2, __ATOMIC_RELEASE);
+    __atomic_store_n(&header->published_count, published_count + 1, __ATOMIC_RELEASE);
+}
+
+frame_ring_reader::~frame_ring_reader()
+{
+    if (m_mapping != NULL)
+    {
+        munmap(const_cast<uint8_t *>(m_mapping), m_mapping_size);
+    }
+}
+
+bool frame_ring_reader::open(const char *name)
+{
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat status;
+    if (fstat(fd, &status) != 0 || (size_t)status.st_size < sizeof(mrob_frame_ring_header_t))
+    {
+        ::close(fd);
+        return false;
+    }
+    size_t mapping_size = (size_t)status.st_size;
+    void *mapping = mmap(NULL, mapping_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        return false;
+    }
+
+    const mrob_frame_ring_header_t *ring = static_cast<const mrob_frame_ring_header_t *>(mapping);
+    if (__atomic_load_n(&ring->magic, __ATOMIC_ACQUIRE) != MROB_FRAME_RING_MAGIC ||
+        ring->version != MROB_FRAME_RING_VERSION || ring->slot_count == 0 ||
+        ring->header_size + ring->slot_size * ring->slot_count > mapping_size)
+    {
+        munmap(mapping, mapping_size);
+        return false;
+    }
+
+    m_mapping = static_cast<const uint8_t *>(mapping);
+    m_mapping_size = mapping_size;
+    return true;
+}
+
+bool frame_ring_reader::read_latest(mrob_frame_slot_header_t *slot,
+                                    std::vector<uint8_t> *color,
+                                    std::vector<uint8_t> *depth) const
+{
+    if (m_mapping == NULL)
+    {
+        return false;
+    }
+
+    const mrob_frame_ring_header_t *ring = header();
+    for (int attempt = 0; attempt < FRAME_RING_READ_ATTEMPTS; attempt++)
+    {
+        uint64_t published_count = __atomic_load_n(&ring->published_count, __ATOMIC_ACQUIRE);
+        if (published_count == 0)
+        {
+            return false;
+        }
+        const uint8_t *slot_data = get_slot(const_cast<uint8_t *>(m_mapping),
+                                            (uint32_t)((published_count - 1) % ring->slot_count));
+        const mrob_frame_slot_header_t *published = reinterpret_cast<const mrob_frame_slot_header_t *>(slot_data);
+
+        uint64_t sequence = __atomic_load_n(&published->sequence, __ATOMIC_ACQUIRE);
+        if (sequence & 1)
+        {
+            continue;
+        }
+
+        *slot = *published;
+        uint64_t color_size = slot->color_size <= ring->color_capacity ? slot->color_size : 0;
+        uint64_t depth_size = slot->depth_size <= ring->depth_capacity ? slot->depth_size : 0;
+        const uint8_t *color_data = slot_data + sizeof(mrob_frame_slot_header_t);
+        color->assign(color_data, color_data + color_size);
+        depth->assign(color_data + ring->color_capacity, color_data + ring->color_capacity + depth_size);
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&published->sequence, __ATOMIC_RELAXED) == sequence)
+        {
+            return true;
+        }
+    }
+    return false;
+}
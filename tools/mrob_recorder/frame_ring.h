@@ -0,0 +1,101 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef FRAME_RING_H
+#define FRAME_RING_H
+
+#include <k4a/k4a.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+// The recorder publishes the latest captures of a device into a POSIX shared memory object named
+// "/mrob_frames_<serial number>" that other processes map read-only. The object starts with a
+// mrob_frame_ring_header_t, followed at header_size by slot_count slots of slot_size bytes. Each slot starts with a
+// mrob_frame_slot_header_t, followed by color_capacity bytes of color image and depth_capacity bytes of depth image.
+//
+// Slots are written in turn. The sequence of a slot is odd while it is written, a reader copies a slot and accepts the
+// copy if the sequence was the same even value before and after. published_count is the number of captures published,
+// the latest one is in slot (published_count - 1) % slot_count. The sequence and published_count fields are accessed
+// atomically.
+#define MROB_FRAME_RING_MAGIC 0x46524d4d // "MMRF"
+#define MROB_FRAME_RING_VERSION 1
+#define MROB_FRAME_RING_NAME_PREFIX "/mrob_frames_"
+
+typedef struct
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t header_size;
+    uint64_t slot_size;
+    uint64_t color_capacity;
+    uint64_t depth_capacity;
+    uint64_t published_count;
+    k4a_calibration_t calibration;
+} mrob_frame_ring_header_t;
+
+typedef struct
+{
+    uint64_t sequence;
+    uint64_t color_timestamp_usec;
+    uint64_t depth_timestamp_usec;
+    uint64_t global_timestamp_usec;
+    uint32_t color_format;
+    uint32_t color_width;
+    uint32_t color_height;
+    uint32_t color_stride;
+    uint32_t color_size;
+    uint32_t depth_width;
+    uint32_t depth_height;
+    uint32_t depth_stride;
+    uint32_t depth_size;
+    uint32_t reserved;
+} mrob_frame_slot_header_t;
+
+// Creates the shared memory object and publishes captures into it. Only one thread publishes.
+class frame_ring_publisher
+{
+public:
+    frame_ring_publisher() = default;
+    ~frame_ring_publisher();
+    frame_ring_publisher(const frame_ring_publisher &) = delete;
+    frame_ring_publisher &operator=(const frame_ring_publisher &) = delete;
+
+    // The capacity of the slots is the size of an uncompressed image of each camera of calibration
+    bool create(const char *name, uint32_t slot_count, const k4a_calibration_t &calibration);
+
+    // Images larger than the capacity of a slot are published with a size of 0
+    void publish(k4a_image_t color_image, k4a_image_t depth_image, uint64_t global_timestamp_usec);
+
+private:
+    std::vector<char> m_name;
+    uint8_t *m_mapping = NULL;
+    size_t m_mapping_size = 0;
+};
+
+// Maps a published ring read-only, for processes consuming the captures of a recorder
+class frame_ring_reader
+{
+public:
+    frame_ring_reader() = default;
+    ~frame_ring_reader();
+    frame_ring_reader(const frame_ring_reader &) = delete;
+    frame_ring_reader &operator=(const frame_ring_reader &) = delete;
+
+    bool open(const char *name);
+
+    const mrob_frame_ring_header_t *header() const
+    {
+        return reinterpret_cast<const mrob_frame_ring_header_t *>(m_mapping);
+    }
+
+    // Copies the latest capture. Returns false if none was published yet or the recorder kept overwriting it.
+    bool read_latest(mrob_frame_slot_header_t *slot, std::vector<uint8_t> *color, std::vector<uint8_t> *depth) const;
+
+private:
+    const uint8_t *m_mapping = NULL;
+    size_t m_mapping_size = 0;
+};
+
+#endif /* FRAME_RING_H */
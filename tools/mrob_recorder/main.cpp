@@ -16,6 +16,8 @@
 #include <ctime>
 #include <chrono>
 #include <csignal>
+#include <sstream>
+#include <string>
 #include <math.h>
 
 using namespace std::chrono;
@@ -112,6 +114,7 @@ static int string_compare(const char *s1, const char *s2)
 int main(int argc, char **argv)
 {
     int device_index = 0;
+    std::vector<uint8_t> device_indices;
     int recording_length = -1;
     k4a_image_format_t recording_color_format = K4A_IMAGE_FORMAT_COLOR_MJPG;
     k4a_color_resolution_t recording_color_resolution = K4A_COLOR_RESOLUTION_1080P;
@@ -119,6 +122,7 @@ int main(int argc, char **argv)
     k4a_fps_t recording_rate = K4A_FRAMES_PER_SECOND_30;
     bool recording_rate_set = false;
     bool recording_imu_enabled = true;
+    bool recording_imu_full_rate = false;
     k4a_wired_sync_mode_t wired_sync_mode = K4A_WIRED_SYNC_MODE_STANDALONE;
     int32_t depth_delay_off_color_usec = 0;
     uint32_t subordinate_delay_off_master_usec = 0;
@@ -143,6 +147,36 @@ int main(int argc, char **argv)
                                   if (device_index < 0 || device_index > 255)
                                       throw std::runtime_error("Device index must 0-255");
                               });
+    cmd_parser.RegisterOption("--devices",
+                              "Record several devices from one process, ALL or a comma separated list of device "
+                              "indices.\n"
+                              "Each device is recorded to files named after its serial number. The wired sync modes "
+                              "are set from the sync cables, --external-sync is ignored.",
+                              1,
+                              [&](const std::vector<char *> &args) {
+                                  device_indices.clear();
+                                  if (string_compare(args[0], "all") == 0)
+                                  {
+                                      uint32_t device_count = k4a_device_get_installed_count();
+                                      for (uint32_t i = 0; i < device_count && i <= UINT8_MAX; i++)
+                                      {
+                                          device_indices.push_back((uint8_t)i);
+                                      }
+                                      return;
+                                  }
+
+                                  std::istringstream list(args[0]);
+                                  std::string index;
+                                  while (std::getline(list, index, ','))
+                                  {
+                                      int value = std::stoi(index);
+                                      if (value < 0 || value > UINT8_MAX)
+                                      {
+                                          throw std::runtime_error("Device index must be 0-255");
+                                      }
+                                      device_indices.push_back((uint8_t)value);
+                                  }
+                              });
     cmd_parser.RegisterOption("-l|--record-length",
                               "Limit the recording to N seconds (default: infinite)",
                               1,
@@ -274,13 +308,19 @@ int main(int argc, char **argv)
                                   }
                               });
     cmd_parser.RegisterOption("--imu",
-                              "Set the IMU recording mode (ON, OFF, default: ON)",
+                              "Set the IMU recording mode (ON, FULL, OFF, default: ON)\n"
+                              "FULL also records the IMU while the cameras stall.",
                               1,
                               [&](const std::vector<char *> &args) {
                                   if (string_compare(args[0], "on") == 0)
                                   {
                                       recording_imu_enabled = true;
                                   }
+                                  else if (string_compare(args[0], "full") == 0)
+                                  {
+                                      recording_imu_enabled = true;
+                                      recording_imu_full_rate = true;
+                                  }
                                   else if (string_compare(args[0], "off") == 0)
                                   {
                                       recording_imu_enabled = false;
@@ -415,7 +455,9 @@ int main(int argc, char **argv)
             return 1;
         }
     }
-    if (subordinate_delay_off_master_usec > 0 && wired_sync_mode != K4A_WIRED_SYNC_MODE_SUBORDINATE)
+    // With several devices, the delay applies to the devices found to be subordinates
+    if (subordinate_delay_off_master_usec > 0 && wired_sync_mode != K4A_WIRED_SYNC_MODE_SUBORDINATE &&
+        device_indices.empty())
     {
         std::cerr << "--sync-delay is only valid if --external-sync is set to Subordinate." << std::endl;
         return 1;
@@ -449,11 +491,26 @@ int main(int argc, char **argv)
     device_config.depth_delay_off_color_usec = depth_delay_off_color_usec;
     device_config.subordinate_delay_off_master_usec = subordinate_delay_off_master_usec;
 
+    if (!device_indices.empty())
+    {
+        return do_multi_device_recording(device_indices,
+                                         recording_filename,
+                                         recording_length,
+                                         &device_config,
+                                         recording_imu_enabled,
+                                         recording_imu_full_rate,
+                                         absoluteExposureValue,
+                                         gain,
+                                         timestamps_table_filename,
+                                         save_all_captures);
+    }
+
     return do_recording((uint8_t)device_index,
                         recording_filename,
                         recording_length,
                         &device_config,
                         recording_imu_enabled,
+                        recording_imu_full_rate,
                         absoluteExposureValue,
                         gain,
                         timestamps_table_filename,
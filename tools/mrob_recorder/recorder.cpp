@@ -2,23 +2,30 @@
 // Licensed under the MIT License.
 
 #include "recorder.h"
+#include "frame_ring.h"
 #include <ctime>
 #include <chrono>
 #include <atomic>
 #include <iostream>
 #include <algorithm>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include <k4a/k4a.h>
 #include <k4arecord/record.h>
 
 #include <stdio.h>
 
-#include <boost/filesystem.hpp>
-
-#define TEMP_IMAGES_PATHNAME "/mnt/mrob_tmpfs/images/"
-
-#define NUM_OF_TEMPORAL_IMAGES 3
+#define NUM_OF_TEMPORAL_IMAGES 3 // Slots of the shared memory ring of the latest captures
 #define NUM_OF_CAPTURES_TO_SAVE 30
+#define IMU_SAMPLE_BATCH_SIZE 64 // Enough for one depth frame of IMU data at 1.6KHz
+#define IMU_WAIT_TIMEOUT_MS 100
+#define SIDE_OUTPUT_QUEUE_SIZE 32 // About a second of captures at 30 FPS
+#define SKEW_REPORT_PERIOD_MS 1000
 
 
 using namespace std::chrono;
@@ -44,52 +51,190 @@ inline static uint32_t k4a_convert_fps_to_uint(k4a_fps_t fps)
     return fps_int;
 }
 
-// call k4a_device_close on every failed CHECK
-#define CHECK(x, device)                                                                                               \
+// return false on every failed CHECK, the caller releases what was set up so far
+#define CHECK(x)                                                                                                       \
     {                                                                                                                  \
         auto retval = (x);                                                                                             \
         if (retval)                                                                                                    \
         {                                                                                                              \
             std::cerr << "Runtime error: " << #x << " returned " << retval << std::endl;                               \
-            k4a_device_close(device);                                                                                  \
-            return 1;                                                                                                  \
+            return false;                                                                                              \
         }                                                                                                              \
     }
 
 std::atomic_bool exiting(false);
 
-int do_recording(uint8_t device_index,
-                 char *recording_filename,
-                 int recording_length,
-                 k4a_device_configuration_t *device_config,
-                 bool record_imu,
-                 int32_t absoluteExposureValue,
-                 int32_t gain,
-                 char *timestamps_table_filename,
-                 bool save_all_captures)
+// Writes the timestamps table and publishes the images of each capture to the shared memory ring on a background
+// thread, so the capture thread doesn't wait on them between captures. The queue is a preallocated ring of slots holding
+// references to the images, not copies.
+class side_output_writer
 {
-    seconds recording_length_seconds(recording_length);
-    const uint32_t installed_devices = k4a_device_get_installed_count();
-    if (device_index >= installed_devices)
+public:
+    side_output_writer(FILE *timestamps_file, frame_ring_publisher *frame_ring) :
+        m_timestamps_file(timestamps_file),
+        m_frame_ring(frame_ring),
+        m_slots(SIDE_OUTPUT_QUEUE_SIZE)
     {
-        std::cerr << "Device not found." << std::endl;
-        return 1;
+        m_thread = std::thread(&side_output_writer::run, this);
+    }
+
+    ~side_output_writer()
+    {
+        stop();
+    }
+
+    // Takes ownership of the image references. Only waits if the writer is a whole queue behind.
+    void push(k4a_image_t color_image, k4a_image_t depth_image, uint64_t global_timestamp)
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+        if (m_count == m_slots.size())
+        {
+            if (!m_full_reported)
+            {
+                std::cerr << "Warning: images and timestamps are written slower than they are captured" << std::endl;
+                m_full_reported = true;
+            }
+            m_not_full.wait(lock, [this]() { return m_count < m_slots.size(); });
+        }
+        slot_t &slot = m_slots[(m_first + m_count) % m_slots.size()];
+        slot.color_image = color_image;
+        slot.depth_image = depth_image;
+        slot.global_timestamp = global_timestamp;
+        m_count++;
+        m_not_empty.notify_one();
+    }
+
+    // Writes what is still queued, then closes the timestamps table
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_stopping = true;
+            m_not_empty.notify_one();
+        }
+        if (m_thread.joinable())
+        {
+            m_thread.join();
+        }
+        if (m_timestamps_file != NULL)
+        {
+            fclose(m_timestamps_file);
+            m_timestamps_file = NULL;
+        }
+    }
+
+private:
+    struct slot_t
+    {
+        k4a_image_t color_image;
+        k4a_image_t depth_image;
+        uint64_t global_timestamp;
+    };
+
+    void run()
+    {
+        while (true)
+        {
+            slot_t slot;
+            {
+                std::unique_lock<std::mutex> lock(m_lock);
+                m_not_empty.wait(lock, [this]() { return m_stopping || m_count > 0; });
+                if (m_count == 0)
+                {
+                    return;
+                }
+                slot = m_slots[m_first];
+                m_first = (m_first + 1) % m_slots.size();
+                m_count--;
+                m_not_full.notify_one();
+            }
+
+            uint64_t color_image_timestamp = k4a_image_get_device_timestamp_usec(slot.color_image);
+            uint64_t depth_image_timestamp = k4a_image_get_device_timestamp_usec(slot.depth_image);
+            fprintf(m_timestamps_file,
+                    "%ld,%ld,%ld\n",
+                    color_image_timestamp,
+                    depth_image_timestamp,
+                    slot.global_timestamp);
+
+            m_frame_ring->publish(slot.color_image, slot.depth_image, slot.global_timestamp);
+            k4a_image_release(slot.color_image);
+            k4a_image_release(slot.depth_image);
+        }
     }
 
+    FILE *m_timestamps_file;
+    frame_ring_publisher *m_frame_ring;
+    std::thread m_thread;
+
+    std::mutex m_lock;
+    std::condition_variable m_not_empty;
+    std::condition_variable m_not_full;
+    std::vector<slot_t> m_slots;
+    size_t m_first = 0;
+    size_t m_count = 0;
+    bool m_stopping = false;
+    bool m_full_reported = false;
+};
+
+struct recording_settings_t
+{
+    int recording_length;
+    bool record_imu;
+    bool record_imu_full_rate;
+    int32_t absoluteExposureValue;
+    int32_t gain;
+    bool save_all_captures;
+};
+
+// A device being recorded, with its recording and side outputs
+struct device_recording_t
+{
+    k4a_device_t device = NULL;
+    std::string serial_number;
+    k4a_device_configuration_t config;
+    k4a_record_t recording = NULL;
+    frame_ring_publisher frame_ring;
+    std::unique_ptr<side_output_writer> side_output;
+    bool cameras_started = false;
+    bool imu_started = false;
+    bool write_failed = false;
+    // Host system timestamp of the latest capture, to report the skew between devices
+    std::atomic<uint64_t> latest_system_timestamp_nsec{ 0 };
+};
+
+// Inserts -<serial number> before the extension of a file name, to name the files of each device
+static std::string device_filename(const char *filename, const std::string &serial_number)
+{
+    std::string name(filename);
+    size_t extension = name.find_last_of('.');
+    size_t directory = name.find_last_of("/\\");
+    if (extension == std::string::npos || (directory != std::string::npos && extension < directory))
+    {
+        return name + "-" + serial_number;
+    }
+    return name.substr(0, extension) + "-" + serial_number + name.substr(extension);
+}
+
+static bool open_device(uint8_t device_index, device_recording_t *device_recording)
+{
     k4a_device_t device;
     if (K4A_FAILED(k4a_device_open(device_index, &device)))
     {
         std::cerr << "Runtime error: k4a_device_open() failed " << std::endl;
+        return false;
     }
+    device_recording->device = device;
 
     char serial_number_buffer[256];
     size_t serial_number_buffer_size = sizeof(serial_number_buffer);
-    CHECK(k4a_device_get_serialnum(device, serial_number_buffer, &serial_number_buffer_size), device);
+    CHECK(k4a_device_get_serialnum(device, serial_number_buffer, &serial_number_buffer_size));
+    device_recording->serial_number = serial_number_buffer;
 
     std::cout << "Device serial number: " << serial_number_buffer << std::endl;
 
     k4a_hardware_version_t version_info;
-    CHECK(k4a_device_get_version(device, &version_info), device);
+    CHECK(k4a_device_get_version(device, &version_info));
 
     std::cout << "Device version: " << (version_info.firmware_build == K4A_FIRMWARE_BUILD_RELEASE ? "Rel" : "Dbg")
               << "; C: " << version_info.rgb.major << "." << version_info.rgb.minor << "." << version_info.rgb.iteration
@@ -98,22 +243,17 @@ int do_recording(uint8_t device_index,
               << version_info.depth_sensor.minor << "]"
               << "; A: " << version_info.audio.major << "." << version_info.audio.minor << "."
               << version_info.audio.iteration << std::endl;
+    return true;
+}
 
-    uint32_t camera_fps = k4a_convert_fps_to_uint(device_config->camera_fps);
-
-    if (camera_fps <= 0 || (device_config->color_resolution == K4A_COLOR_RESOLUTION_OFF &&
-                            device_config->depth_mode == K4A_DEPTH_MODE_OFF))
-    {
-        std::cerr << "Either the color or depth modes must be enabled to record." << std::endl;
-        return 1;
-    }
-
-    if (absoluteExposureValue != defaultExposureAuto)
+static void set_color_controls(k4a_device_t device, const recording_settings_t &settings)
+{
+    if (settings.absoluteExposureValue != defaultExposureAuto)
     {
         if (K4A_FAILED(k4a_device_set_color_control(device,
                                                     K4A_COLOR_CONTROL_EXPOSURE_TIME_ABSOLUTE,
                                                     K4A_COLOR_CONTROL_MODE_MANUAL,
-                                                    absoluteExposureValue)))
+                                                    settings.absoluteExposureValue)))
         {
             std::cerr << "Runtime error: k4a_device_set_color_control() for manual exposure failed " << std::endl;
         }
@@ -129,10 +269,10 @@ int do_recording(uint8_t device_index,
         }
     }
 
-    if (gain != defaultGainAuto)
+    if (settings.gain != defaultGainAuto)
     {
-        if (K4A_FAILED(
-                k4a_device_set_color_control(device, K4A_COLOR_CONTROL_GAIN, K4A_COLOR_CONTROL_MODE_MANUAL, gain)))
+        if (K4A_FAILED(k4a_device_set_color_control(
+                device, K4A_COLOR_CONTROL_GAIN, K4A_COLOR_CONTROL_MODE_MANUAL, settings.gain)))
         {
             std::cerr << "Runtime error: k4a_device_set_color_control() for manual gain failed " << std::endl;
         }
@@ -141,41 +281,83 @@ int do_recording(uint8_t device_index,
     if (K4A_FAILED(k4a_device_set_color_control(device, K4A_COLOR_CONTROL_POWERLINE_FREQUENCY, K4A_COLOR_CONTROL_MODE_MANUAL, 1))) {
         std::cerr << "Runtime error: k4a_device_set_color_control() for manual exposure failed " << std::endl;
     }
+}
 
-    CHECK(k4a_device_start_cameras(device, device_config), device);
-    if (record_imu)
+// Creates the recording of a device, its timestamps table and its shared memory ring of the latest captures. The
+// recording is written by the threads of group if it isn't NULL.
+static bool create_recording(device_recording_t *device_recording,
+                             const char *recording_filename,
+                             const char *timestamps_table_filename,
+                             const recording_settings_t &settings,
+                             k4a_record_group_t group)
+{
+    if (K4A_FAILED(k4a_record_create(recording_filename,
+                                     device_recording->device,
+                                     device_recording->config,
+                                     &device_recording->recording)))
     {
-        CHECK(k4a_device_start_imu(device), device);
+        std::cerr << "Unable to create recording file: " << recording_filename << std::endl;
+        return false;
     }
 
-    std::cout << "Device started" << std::endl;
+    if (group != NULL)
+    {
+        CHECK(k4a_record_group_add_recording(group, device_recording->recording));
+    }
+    if (settings.record_imu)
+    {
+        CHECK(k4a_record_add_imu_track(device_recording->recording));
+    }
+    CHECK(k4a_record_write_header(device_recording->recording));
 
-    k4a_record_t recording;
-    if (K4A_FAILED(k4a_record_create(recording_filename, device, *device_config, &recording)))
+    ////////////////////////////////////
+    FILE *fpt;
+    fpt = fopen(timestamps_table_filename, "w+");
+    if (fpt == NULL)
     {
-        std::cerr << "Unable to create recording file: " << recording_filename << std::endl;
-        return 1;
+        std::cerr << "Unable to create timestamps table: " << timestamps_table_filename << std::endl;
+        return false;
     }
+    fprintf(fpt, "color_ts_us,depth_ts_us,global_ts_us\n");
 
-    if (record_imu)
+    // Live consumers map the latest captures from shared memory, see frame_ring.h
+    k4a_calibration_t calibration;
+    k4a_result_t calibration_result = k4a_device_get_calibration(device_recording->device,
+                                                                 device_recording->config.depth_mode,
+                                                                 device_recording->config.color_resolution,
+                                                                 &calibration);
+    std::string frame_ring_name = std::string(MROB_FRAME_RING_NAME_PREFIX) + device_recording->serial_number;
+    if (K4A_FAILED(calibration_result) ||
+        !device_recording->frame_ring.create(frame_ring_name.c_str(), NUM_OF_TEMPORAL_IMAGES, calibration))
     {
-        CHECK(k4a_record_add_imu_track(recording), device);
+        std::cerr << "Live captures won't be published" << std::endl;
     }
-    CHECK(k4a_record_write_header(recording), device);
 
-    // Wait for the first capture before starting recording.
-    k4a_capture_t capture;
-    seconds timeout_sec_for_first_capture(60);
-    if (device_config->wired_sync_mode == K4A_WIRED_SYNC_MODE_SUBORDINATE)
+    device_recording->side_output.reset(new side_output_writer(fpt, &device_recording->frame_ring));
+    ////////////////////////////////////
+    return true;
+}
+
+static bool start_device(device_recording_t *device_recording, const recording_settings_t &settings)
+{
+    CHECK(k4a_device_start_cameras(device_recording->device, &device_recording->config));
+    device_recording->cameras_started = true;
+    if (settings.record_imu)
     {
-        timeout_sec_for_first_capture = seconds(360);
-        std::cout << "[subordinate mode] Waiting for signal from master" << std::endl;
+        CHECK(k4a_device_start_imu(device_recording->device));
+        device_recording->imu_started = true;
     }
+    return true;
+}
+
+// Waits for the first capture in a loop so Ctrl-C will still exit
+static k4a_wait_result_t wait_for_first_capture(k4a_device_t device, seconds timeout)
+{
     steady_clock::time_point first_capture_start = steady_clock::now();
     k4a_wait_result_t result = K4A_WAIT_RESULT_TIMEOUT;
-    // Wait for the first capture in a loop so Ctrl-C will still exit.
-    while (!exiting && (steady_clock::now() - first_capture_start) < timeout_sec_for_first_capture)
+    while (!exiting && (steady_clock::now() - first_capture_start) < timeout)
     {
+        k4a_capture_t capture;
         result = k4a_device_get_capture(device, &capture, 100);
         if (result == K4A_WAIT_RESULT_SUCCEEDED)
         {
@@ -185,55 +367,76 @@ int do_recording(uint8_t device_index,
         else if (result == K4A_WAIT_RESULT_FAILED)
         {
             std::cerr << "Runtime error: k4a_device_get_capture() returned error: " << result << std::endl;
-            return 1;
+            break;
         }
     }
+    return result;
+}
 
-    if (exiting)
-    {
-        k4a_device_close(device);
-        return 0;
-    }
-    else if (result == K4A_WAIT_RESULT_TIMEOUT)
-    {
-        std::cerr << "Timed out waiting for first capture." << std::endl;
-        return 1;
-    }
-
-    std::cout << "Started recording" << std::endl;
-    if (recording_length <= 0)
-    {
-        std::cout << "Press Ctrl-C to stop recording." << std::endl;
-    }
-
-    steady_clock::time_point recording_start = steady_clock::now();
-    int32_t timeout_ms = 1000 / camera_fps;
-
-    ////////////////////////////////////
-    FILE *fpt;
-    //fpt = fopen(argv[2], "w+");
-    fpt = fopen(timestamps_table_filename, "w+");
-    fprintf(fpt, "color_ts_us,depth_ts_us,global_ts_us\n");
-
-    uint8_t current_capture_specifier = 0;
+// Records the captures and IMU samples of a started device until exiting is set, the recording length is reached or
+// the device fails
+static void record_device(device_recording_t *device_recording,
+                          const recording_settings_t &settings,
+                          steady_clock::time_point recording_start)
+{
+    k4a_device_t device = device_recording->device;
+    k4a_record_t recording = device_recording->recording;
+    side_output_writer &side_output = *device_recording->side_output;
+    seconds recording_length_seconds(settings.recording_length);
+    int32_t timeout_ms = 1000 / k4a_convert_fps_to_uint(device_recording->config.camera_fps);
     uint32_t capture_number = 0;
+    k4a_wait_result_t result = K4A_WAIT_RESULT_SUCCEEDED;
+
+    // IMU samples are written from a thread of their own, so they don't wait on the camera rate or on writing captures.
+    // The recording serializes the writes of both threads.
+    std::atomic_bool capture_loop_done(false);
+    std::atomic_bool imu_failed(false);
+    std::atomic<steady_clock::rep> last_capture_time(recording_start.time_since_epoch().count());
+    std::thread imu_thread;
+    if (settings.record_imu)
+    {
+        imu_thread = std::thread([&]() {
+            while (!capture_loop_done)
+            {
+                k4a_imu_sample_t samples[IMU_SAMPLE_BATCH_SIZE];
+                size_t sample_count = 0;
+                k4a_wait_result_t imu_result =
+                    k4a_device_get_imu_samples(device, samples, IMU_SAMPLE_BATCH_SIZE, &sample_count, IMU_WAIT_TIMEOUT_MS);
+                if (imu_result == K4A_WAIT_RESULT_TIMEOUT)
+                {
+                    continue;
+                }
+                else if (imu_result != K4A_WAIT_RESULT_SUCCEEDED)
+                {
+                    std::cerr << "Runtime error: k4a_device_get_imu_samples() returned " << imu_result << std::endl;
+                    imu_failed = true;
+                    break;
+                }
 
+                // Samples are expected within a second of the most recent capture, so unless the IMU is recorded at
+                // full rate, the samples read while the cameras stall are dropped.
+                steady_clock::time_point last_capture{ steady_clock::duration(last_capture_time.load()) };
+                if (!settings.record_imu_full_rate && steady_clock::now() - last_capture > seconds(1))
+                {
+                    continue;
+                }
 
-    char device_pathname_buffer[100];
-    sprintf (device_pathname_buffer, "%s%s/", TEMP_IMAGES_PATHNAME, serial_number_buffer);
-    boost::filesystem::remove_all(device_pathname_buffer);
-
-    char color_images_pathname_buffer[100];
-    sprintf (color_images_pathname_buffer, "%scolor/", device_pathname_buffer);
-    boost::filesystem::create_directories(color_images_pathname_buffer);
-
-    char depth_images_pathname_buffer[100];
-    sprintf (depth_images_pathname_buffer, "%sdepth/", device_pathname_buffer);
-    boost::filesystem::create_directory(depth_images_pathname_buffer);
-    ////////////////////////////////////
+                k4a_result_t write_result = K4A_RESULT_SUCCEEDED;
+                for (size_t i = 0; i < sample_count && K4A_SUCCEEDED(write_result); i++)
+                {
+                    write_result = k4a_record_write_imu_sample(recording, samples[i]);
+                }
+                if (K4A_FAILED(write_result))
+                {
+                    std::cerr << "Runtime error: k4a_record_write_imu_sample() returned " << write_result << std::endl;
+                }
+            }
+        });
+    }
 
     do
     {
+        k4a_capture_t capture;
         result = k4a_device_get_capture(device, &capture, timeout_ms);
         if (result == K4A_WAIT_RESULT_TIMEOUT)
         {
@@ -244,14 +447,17 @@ int do_recording(uint8_t device_index,
             std::cerr << "Runtime error: k4a_device_get_capture() returned " << result << std::endl;
             break;
         }
+        last_capture_time = steady_clock::now().time_since_epoch().count();
 
-        if(save_all_captures) {
-            CHECK(k4a_record_write_capture(recording, capture), device);
-        }
-        else {
-            capture_number++;
-            if (capture_number < NUM_OF_CAPTURES_TO_SAVE) {
-                CHECK(k4a_record_write_capture(recording, capture), device);
+        capture_number++;
+        if (settings.save_all_captures || capture_number < NUM_OF_CAPTURES_TO_SAVE) {
+            k4a_result_t write_result = k4a_record_write_capture(recording, capture);
+            if (K4A_FAILED(write_result))
+            {
+                std::cerr << "Runtime error: k4a_record_write_capture() returned " << write_result << std::endl;
+                k4a_capture_release(capture);
+                device_recording->write_failed = true;
+                break;
             }
         }
 
@@ -261,102 +467,400 @@ int do_recording(uint8_t device_index,
         k4a_image_t color_image = k4a_capture_get_color_image(capture);
         k4a_image_t depth_image = k4a_capture_get_depth_image(capture);
 
+        k4a_image_t timed_image = depth_image ? depth_image : color_image;
+        if (timed_image) {
+            device_recording->latest_system_timestamp_nsec = k4a_image_get_system_timestamp_nsec(timed_image);
+        }
 
         if (color_image && depth_image) {
-            
-            current_capture_specifier++;
-            if (current_capture_specifier == NUM_OF_TEMPORAL_IMAGES) {
-                current_capture_specifier = 0;
+            side_output.push(color_image, depth_image, global_timestamp);
+        }
+        else {
+            if (color_image) {
+                k4a_image_release(color_image);
             }
+            if (depth_image) {
+                k4a_image_release(depth_image);
+            }
+        }
+        /////////////////////
 
-            uint64_t color_image_timestamp = k4a_image_get_device_timestamp_usec(color_image);
-            uint64_t depth_image_timestamp = k4a_image_get_device_timestamp_usec(depth_image);
+        k4a_capture_release(capture);
+    } while (!exiting && !imu_failed && result != K4A_WAIT_RESULT_FAILED &&
+             (settings.recording_length < 0 || (steady_clock::now() - recording_start < recording_length_seconds)));
 
-            fprintf(fpt, "%ld,%ld,%ld\n", color_image_timestamp, depth_image_timestamp, global_timestamp);
+    capture_loop_done = true;
+    if (imu_thread.joinable())
+    {
+        imu_thread.join();
+    }
+}
 
-            uint8_t * buffer = k4a_image_get_buffer(color_image);
-            uint32_t size = k4a_image_get_size(color_image);
+// Stops the device and finishes its recording, returns false if the recording failed
+static bool close_device_recording(device_recording_t *device_recording)
+{
+    bool succeeded = !device_recording->write_failed;
+    if (device_recording->imu_started)
+    {
+        k4a_device_stop_imu(device_recording->device);
+    }
+    if (device_recording->cameras_started)
+    {
+        k4a_device_stop_cameras(device_recording->device);
+    }
+    if (device_recording->side_output)
+    {
+        device_recording->side_output->stop();
+    }
+    if (device_recording->recording != NULL)
+    {
+        if (K4A_FAILED(k4a_record_flush(device_recording->recording)))
+        {
+            std::cerr << "Runtime error: k4a_record_flush() failed for device " << device_recording->serial_number
+                      << std::endl;
+            succeeded = false;
+        }
+        k4a_record_close(device_recording->recording);
+        device_recording->recording = NULL;
+    }
+    if (device_recording->device != NULL)
+    {
+        k4a_device_close(device_recording->device);
+        device_recording->device = NULL;
+    }
+    return succeeded;
+}
 
-            FILE * pFile;
-            char filename_buffer[100];
+static bool check_device_config(const k4a_device_configuration_t *device_config)
+{
+    uint32_t camera_fps = k4a_convert_fps_to_uint(device_config->camera_fps);
 
-            sprintf (filename_buffer, "%s%d.jpg", color_images_pathname_buffer, current_capture_specifier);
-            pFile = fopen (filename_buffer, "w");
+    if (camera_fps <= 0 || (device_config->color_resolution == K4A_COLOR_RESOLUTION_OFF &&
+                            device_config->depth_mode == K4A_DEPTH_MODE_OFF))
+    {
+        std::cerr << "Either the color or depth modes must be enabled to record." << std::endl;
+        return false;
+    }
+    return true;
+}
 
-            if (pFile!=NULL)
-            {
-                fwrite(buffer, 1, size, pFile);
-                fclose (pFile);
-            }
+int do_recording(uint8_t device_index,
+                 char *recording_filename,
+                 int recording_length,
+                 k4a_device_configuration_t *device_config,
+                 bool record_imu,
+                 bool record_imu_full_rate,
+                 int32_t absoluteExposureValue,
+                 int32_t gain,
+                 char *timestamps_table_filename,
+                 bool save_all_captures)
+{
+    const recording_settings_t settings = {
+        recording_length, record_imu, record_imu_full_rate, absoluteExposureValue, gain, save_all_captures
+    };
+    const uint32_t installed_devices = k4a_device_get_installed_count();
+    if (device_index >= installed_devices)
+    {
+        std::cerr << "Device not found." << std::endl;
+        return 1;
+    }
+    if (!check_device_config(device_config))
+    {
+        return 1;
+    }
 
-            buffer = k4a_image_get_buffer(depth_image);
-            size = k4a_image_get_size(depth_image);
+    device_recording_t device_recording;
+    device_recording.config = *device_config;
+    if (!open_device(device_index, &device_recording))
+    {
+        close_device_recording(&device_recording);
+        return 1;
+    }
+    set_color_controls(device_recording.device, settings);
 
-            sprintf (filename_buffer, "%s%d.bin", depth_images_pathname_buffer, current_capture_specifier);
-            pFile = fopen (filename_buffer, "w");
+    if (!create_recording(&device_recording, recording_filename, timestamps_table_filename, settings, NULL) ||
+        !start_device(&device_recording, settings))
+    {
+        close_device_recording(&device_recording);
+        return 1;
+    }
 
-            if (pFile!=NULL)
-            {
-                fwrite(buffer, 1, size, pFile);
-                fclose (pFile);
-            }
+    std::cout << "Device started" << std::endl;
+
+    // Wait for the first capture before starting recording.
+    seconds timeout_sec_for_first_capture(60);
+    if (device_config->wired_sync_mode == K4A_WIRED_SYNC_MODE_SUBORDINATE)
+    {
+        timeout_sec_for_first_capture = seconds(360);
+        std::cout << "[subordinate mode] Waiting for signal from master" << std::endl;
+    }
+    k4a_wait_result_t result = wait_for_first_capture(device_recording.device, timeout_sec_for_first_capture);
+    if (exiting)
+    {
+        close_device_recording(&device_recording);
+        return 0;
+    }
+    else if (result != K4A_WAIT_RESULT_SUCCEEDED)
+    {
+        if (result == K4A_WAIT_RESULT_TIMEOUT)
+        {
+            std::cerr << "Timed out waiting for first capture." << std::endl;
+        }
+        close_device_recording(&device_recording);
+        return 1;
+    }
+
+    std::cout << "Started recording" << std::endl;
+    if (recording_length <= 0)
+    {
+        std::cout << "Press Ctrl-C to stop recording." << std::endl;
+    }
+
+    record_device(&device_recording, settings, steady_clock::now());
+
+    if (!exiting)
+    {
+        exiting = true;
+        std::cout << "Stopping recording..." << std::endl;
+    }
+
+    std::cout << "Saving recording..." << std::endl;
+    bool succeeded = close_device_recording(&device_recording);
+
+    std::cout << "Done" << std::endl;
+
+    return succeeded ? 0 : 1;
+}
+
+// Prints the offset of the latest capture of each device from the latest capture of the first device, folded into half
+// a frame period either way, since the latest captures of two devices may be of consecutive frames
+static void report_skew(const std::vector<std::unique_ptr<device_recording_t>> &device_recordings, int64_t period_nsec)
+{
+    int64_t reference = (int64_t)device_recordings[0]->latest_system_timestamp_nsec.load();
+    if (reference == 0)
+    {
+        return;
+    }
+
+    std::cout << "Skew from " << device_recordings[0]->serial_number << ":";
+    for (size_t i = 1; i < device_recordings.size(); i++)
+    {
+        int64_t timestamp = (int64_t)device_recordings[i]->latest_system_timestamp_nsec.load();
+        if (timestamp == 0)
+        {
+            std::cout << " " << device_recordings[i]->serial_number << " no captures";
+            continue;
         }
-        if (color_image) {
-            k4a_image_release(color_image);
+        int64_t offset = (timestamp - reference) % period_nsec;
+        if (offset > period_nsec / 2)
+        {
+            offset -= period_nsec;
         }
-        if (depth_image) {
-            k4a_image_release(depth_image);
+        else if (offset < -period_nsec / 2)
+        {
+            offset += period_nsec;
         }
-        /////////////////////
+        std::cout << " " << device_recordings[i]->serial_number << " " << offset / 1000 << " us";
+    }
+    std::cout << std::endl;
+}
 
-        k4a_capture_release(capture);
+int do_multi_device_recording(const std::vector<uint8_t> &device_indices,
+                              char *recording_filename,
+                              int recording_length,
+                              k4a_device_configuration_t *device_config,
+                              bool record_imu,
+                              bool record_imu_full_rate,
+                              int32_t absoluteExposureValue,
+                              int32_t gain,
+                              char *timestamps_table_filename,
+                              bool save_all_captures)
+{
+    const recording_settings_t settings = {
+        recording_length, record_imu, record_imu_full_rate, absoluteExposureValue, gain, save_all_captures
+    };
+    const uint32_t installed_devices = k4a_device_get_installed_count();
+    for (uint8_t device_index : device_indices)
+    {
+        if (device_index >= installed_devices)
+        {
+            std::cerr << "Device " << (int)device_index << " not found." << std::endl;
+            return 1;
+        }
+    }
+    if (device_indices.empty() || !check_device_config(device_config))
+    {
+        return 1;
+    }
+
+    std::vector<std::unique_ptr<device_recording_t>> device_recordings;
+    auto close_all = [&]() {
+        bool succeeded = true;
+        for (auto &device_recording : device_recordings)
+        {
+            succeeded = close_device_recording(device_recording.get()) && succeeded;
+        }
+        return succeeded;
+    };
+
+    // The sync jacks tell the master, which has only its sync out connected, from the subordinates
+    size_t master_count = 0;
+    size_t subordinate_count = 0;
+    for (uint8_t device_index : device_indices)
+    {
+        device_recordings.emplace_back(new device_recording_t());
+        device_recording_t *device_recording = device_recordings.back().get();
+        device_recording->config = *device_config;
+        if (!open_device(device_index, device_recording))
+        {
+            close_all();
+            return 1;
+        }
+
+        bool sync_in_connected = false;
+        bool sync_out_connected = false;
+        if (K4A_FAILED(k4a_device_get_sync_jack(device_recording->device, &sync_in_connected, &sync_out_connected)))
+        {
+            std::cerr << "Runtime error: k4a_device_get_sync_jack() failed " << std::endl;
+            close_all();
+            return 1;
+        }
+        if (sync_in_connected)
+        {
+            device_recording->config.wired_sync_mode = K4A_WIRED_SYNC_MODE_SUBORDINATE;
+            subordinate_count++;
+        }
+        else if (sync_out_connected)
+        {
+            device_recording->config.wired_sync_mode = K4A_WIRED_SYNC_MODE_MASTER;
+            device_recording->config.subordinate_delay_off_master_usec = 0;
+            master_count++;
+        }
+        else
+        {
+            device_recording->config.wired_sync_mode = K4A_WIRED_SYNC_MODE_STANDALONE;
+            device_recording->config.subordinate_delay_off_master_usec = 0;
+        }
+        set_color_controls(device_recording->device, settings);
+    }
 
-        if (record_imu)
+    if (master_count > 1 || (subordinate_count > 0 && master_count == 0))
+    {
+        std::cerr << "Wired sync needs exactly one master device, with only its sync out cable connected." << std::endl;
+        close_all();
+        return 1;
+    }
+    else if (master_count + subordinate_count < device_recordings.size())
+    {
+        std::cout << "Warning: devices without sync cables are recorded standalone, without wired sync." << std::endl;
+    }
+
+    // The recordings share a pool of writer threads
+    k4a_record_group_t group = NULL;
+    uint32_t writer_thread_count = (uint32_t)std::min<size_t>((device_recordings.size() + 1) / 2, 64);
+    if (K4A_FAILED(k4a_record_group_create(writer_thread_count, &group)))
+    {
+        std::cerr << "Runtime error: k4a_record_group_create() failed " << std::endl;
+        close_all();
+        return 1;
+    }
+    for (auto &device_recording : device_recordings)
+    {
+        std::string device_recording_filename = device_filename(recording_filename, device_recording->serial_number);
+        std::string device_timestamps_filename = device_filename(timestamps_table_filename,
+                                                                 device_recording->serial_number);
+        if (!create_recording(device_recording.get(),
+                              device_recording_filename.c_str(),
+                              device_timestamps_filename.c_str(),
+                              settings,
+                              group))
         {
-            do
+            k4a_record_group_destroy(group);
+            close_all();
+            return 1;
+        }
+        std::cout << "Recording device " << device_recording->serial_number << " to " << device_recording_filename
+                  << std::endl;
+    }
+    k4a_record_group_destroy(group);
+
+    // Subordinates wait for the master's sync pulses, so they start first and the master last
+    std::stable_sort(device_recordings.begin(),
+                     device_recordings.end(),
+                     [](const std::unique_ptr<device_recording_t> &a, const std::unique_ptr<device_recording_t> &b) {
+                         return a->config.wired_sync_mode == K4A_WIRED_SYNC_MODE_SUBORDINATE &&
+                                b->config.wired_sync_mode != K4A_WIRED_SYNC_MODE_SUBORDINATE;
+                     });
+    for (auto &device_recording : device_recordings)
+    {
+        if (!start_device(device_recording.get(), settings))
+        {
+            close_all();
+            return 1;
+        }
+    }
+    std::cout << "Devices started" << std::endl;
+
+    // The master started last, so its first capture means every device is running
+    for (auto it = device_recordings.rbegin(); it != device_recordings.rend(); it++)
+    {
+        k4a_wait_result_t result = wait_for_first_capture((*it)->device, seconds(60));
+        if (exiting)
+        {
+            close_all();
+            return 0;
+        }
+        else if (result != K4A_WAIT_RESULT_SUCCEEDED)
+        {
+            if (result == K4A_WAIT_RESULT_TIMEOUT)
             {
-                k4a_imu_sample_t sample;
-                result = k4a_device_get_imu_sample(device, &sample, 0);
-                if (result == K4A_WAIT_RESULT_TIMEOUT)
-                {
-                    break;
-                }
-                else if (result != K4A_WAIT_RESULT_SUCCEEDED)
-                {
-                    std::cerr << "Runtime error: k4a_imu_get_sample() returned " << result << std::endl;
-                    break;
-                }
-                k4a_result_t write_result = k4a_record_write_imu_sample(recording, sample);
-                if (K4A_FAILED(write_result))
-                {
-                    std::cerr << "Runtime error: k4a_record_write_imu_sample() returned " << write_result << std::endl;
-                    break;
-                }
-            } while (!exiting && result != K4A_WAIT_RESULT_FAILED &&
-                     (recording_length < 0 || (steady_clock::now() - recording_start < recording_length_seconds)));
+                std::cerr << "Timed out waiting for first capture of device " << (*it)->serial_number << std::endl;
+            }
+            close_all();
+            return 1;
         }
-    } while (!exiting && result != K4A_WAIT_RESULT_FAILED &&
-             (recording_length < 0 || (steady_clock::now() - recording_start < recording_length_seconds)));
+    }
 
-    if (!exiting)
+    std::cout << "Started recording" << std::endl;
+    if (recording_length <= 0)
     {
-        exiting = true;
-        std::cout << "Stopping recording..." << std::endl;
+        std::cout << "Press Ctrl-C to stop recording." << std::endl;
     }
 
-    if (record_imu)
+    // A device that stops recording, such as after a failure, stops the others
+    steady_clock::time_point recording_start = steady_clock::now();
+    std::atomic<size_t> running_count(device_recordings.size());
+    std::vector<std::thread> threads;
+    for (auto &device_recording : device_recordings)
     {
-        k4a_device_stop_imu(device);
+        device_recording_t *recording = device_recording.get();
+        threads.emplace_back([&, recording]() {
+            record_device(recording, settings, recording_start);
+            running_count--;
+            exiting = true;
+        });
     }
-    k4a_device_stop_cameras(device);
 
-    std::cout << "Saving recording..." << std::endl;
-    CHECK(k4a_record_flush(recording), device);
-    k4a_record_close(recording);
+    int64_t period_nsec = 1000000000LL / k4a_convert_fps_to_uint(device_config->camera_fps);
+    steady_clock::time_point next_report = steady_clock::now() + milliseconds(SKEW_REPORT_PERIOD_MS);
+    while (running_count == device_recordings.size())
+    {
+        std::this_thread::sleep_for(milliseconds(10));
+        if (steady_clock::now() >= next_report && device_recordings.size() > 1)
+        {
+            report_skew(device_recordings, period_nsec);
+            next_report += milliseconds(SKEW_REPORT_PERIOD_MS);
+        }
+    }
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
 
-    std::cout << "Done" << std::endl;
+    std::cout << "Saving recordings..." << std::endl;
+    bool succeeded = close_all();
 
-    k4a_device_close(device);
+    std::cout << "Done" << std::endl;
 
-    return 0;
+    return succeeded ? 0 : 1;
 }
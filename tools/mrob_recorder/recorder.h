@@ -5,6 +5,7 @@
 #define RECORDER_H
 
 #include <atomic>
+#include <vector>
 #include <k4a/k4a.h>
 
 extern std::atomic_bool exiting;
@@ -17,9 +18,23 @@ int do_recording(uint8_t device_index,
                  int recording_length,
                  k4a_device_configuration_t *device_config,
                  bool record_imu,
+                 bool record_imu_full_rate,
                  int32_t absoluteExposureValue,
                  int32_t gain,
                  char *timestamps_table_filename,
                  bool save_all_captures);
 
+// Records several devices from one process, each to its own files named after its serial number. Devices with a sync
+// in cable are subordinates and the device with only a sync out cable is their master.
+int do_multi_device_recording(const std::vector<uint8_t> &device_indices,
+                              char *recording_filename,
+                              int recording_length,
+                              k4a_device_configuration_t *device_config,
+                              bool record_imu,
+                              bool record_imu_full_rate,
+                              int32_t absoluteExposureValue,
+                              int32_t gain,
+                              char *timestamps_table_filename,
+                              bool save_all_captures);
+
 #endif /* RECORDER_H */
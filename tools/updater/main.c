@@ -8,7 +8,6 @@
 #include <k4ainternal/firmware.h>
 #include <k4ainternal/logging.h>
 
-#include <azure_c_shared_utility/tickcounter.h>
 #include <azure_c_shared_utility/threadapi.h>
 #include <stdio.h>
 #include <errno.h>
@@ -28,8 +27,6 @@
 #include <stdlib.h>
 #include <stdio.h>
 
-#define UPDATE_TIMEOUT_MS 10 * 60 * 1000 // 10 Minutes should be way more than enough.
-
 // Exit Codes
 #define EXIT_OK 0      // successful termination
 #define EXIT_FAILED -1 // general failure
@@ -79,17 +76,19 @@ static void print_supprted_commands()
     printf("    Query Device: -Query, -q\n");
     printf("        Arguments: [Optional Serial Number for single device query]\n");
     printf("    Update Device: -Update, -u\n");
-    printf("        Arguments: <Firmware Package Path and FileName> [Option Serial Number for single device update]\n");
+    printf("        Arguments: <Firmware Package Path and FileName> [Optional Serial Numbers of devices to update]\n");
     printf("    Reset Device: -Reset, -r\n");
     printf("        Arguments: [Optional Serial Number for single device reset]\n");
     printf("    Inspect Firmware: -Inspect, -i\n");
     printf("        Arguments: <Firmware Package Path and FileName>\n");
     printf("\n");
-    printf("    If no Serial Number is provided, the tool will just connect to the first device.\n");
+    printf("    If no Serial Number is provided, the tool will connect to all devices. Devices are updated "
+           "concurrently.\n");
     printf("\n");
     printf("Examples:\n");
     printf("    %s -List\n", EXECUTABLE_NAME);
     printf("    %s -Update c:\\data\\firmware.bin 0123456\n", EXECUTABLE_NAME);
+    printf("    %s -Update c:\\data\\firmware.bin 0123456 0234567\n", EXECUTABLE_NAME);
 }
 
 static k4a_result_t ensure_firmware_open(updater_command_info_t *command_info, bool resetting_device, uint32_t device);
@@ -129,17 +128,23 @@ static int try_parse_device(int argc, char **argv, int current, updater_command_
     depthmcu_t depth = NULL;
     colormcu_t color = NULL;
     uint32_t device_count;
-    char *device_serial_number = NULL;
+    char **device_serial_numbers = argv + current + 1;
+    int serial_number_count = 0;
     int next = current + 1;
 
-    if (next < argc)
+    // If the user is passing in serial numbers, then we only use those devices. We will later check for them
+    while (current + 1 + serial_number_count < argc)
     {
-        char firstCharacter = argv[next][0];
-        if (firstCharacter != '-' && firstCharacter != '/')
+        char firstCharacter = device_serial_numbers[serial_number_count][0];
+        if (firstCharacter == '-' || firstCharacter == '/')
         {
-            // If the user is passing in a serial number, then we use it and exit. We will later check for it
-            device_serial_number = argv[next];
+            break;
         }
+        serial_number_count++;
+    }
+    if (serial_number_count > 0)
+    {
+        next = current + serial_number_count;
     }
     usb_cmd_get_device_count(&device_count);
 
@@ -169,24 +174,24 @@ static int try_parse_device(int argc, char **argv, int current, updater_command_
 
             if (K4A_SUCCEEDED(result))
             {
-                // Are we looking for a particular serial number?
-                if (device_serial_number)
+                // Are we looking for particular serial numbers?
+                if (serial_number_count > 0)
                 {
-                    if (strcmp(device_serial_number, serial_number) == 0)
+                    for (int i = 0; i < serial_number_count; i++)
                     {
-                        if (K4A_SUCCEEDED(add_device(command_info, serial_number)))
-                        {
-                            // Add_device took ownership of serial_number
-                            serial_number = NULL;
-                        }
-                        else
+                        if (strcmp(device_serial_numbers[i], serial_number) == 0)
                         {
-                            printf("ERROR: Unable to store device & serial number: %s\n", device_serial_number);
+                            if (K4A_SUCCEEDED(add_device(command_info, serial_number)))
+                            {
+                                // Add_device took ownership of serial_number
+                                serial_number = NULL;
+                            }
+                            break;
                         }
-
-                        // Success or failure, the serial number being searched for was found.
-                        device_found = true;
                     }
+
+                    // Stop once every serial number being searched for was found.
+                    device_found = command_info->device_count == (uint32_t)serial_number_count;
                 }
                 // We are saving all unique devices found to the list
                 else if (K4A_SUCCEEDED(add_device(command_info, serial_number)))
@@ -214,9 +219,31 @@ static int try_parse_device(int argc, char **argv, int current, updater_command_
         }
     }
 
-    if (device_serial_number && command_info->device_count == 0)
+    bool missing = false;
+    for (int i = 0; i < serial_number_count; i++)
+    {
+        bool found = false;
+        for (uint32_t index = 0; index < command_info->device_count && !found; index++)
+        {
+            found = strcmp(device_serial_numbers[i], command_info->device_serial_number[index]) == 0;
+        }
+
+        if (!found)
+        {
+            printf("ERROR: Unable to find a device with serial number: %s\n", device_serial_numbers[i]);
+            missing = true;
+        }
+    }
+
+    if (missing)
     {
-        printf("ERROR: Unable to find a device with serial number: %s\n", device_serial_number);
+        // Only act on the requested devices when all of them are present
+        for (uint32_t index = 0; index < command_info->device_count; index++)
+        {
+            firmware_free_serial_number(command_info->device_serial_number[index]);
+            command_info->device_serial_number[index] = NULL;
+        }
+        command_info->device_count = 0;
     }
 
     if (command_info->device_count == 0)
@@ -480,28 +507,6 @@ static k4a_result_t print_firmware_package_info(firmware_package_info_t *firmwar
     return K4A_RESULT_SUCCEEDED;
 }
 
-static firmware_operation_status_t calculate_overall_component_status(const firmware_component_status_t status)
-{
-    if (status.overall == FIRMWARE_OPERATION_SUCCEEDED)
-    {
-        return FIRMWARE_OPERATION_SUCCEEDED;
-    }
-
-    if (status.overall == FIRMWARE_OPERATION_INPROGRESS)
-    {
-        return FIRMWARE_OPERATION_INPROGRESS;
-    }
-
-    // If the version check failed, this component's update was skipped. This could because the new version is
-    // an unsafe downgrade or the versions are the same and no update is required.
-    if (status.version_check == FIRMWARE_OPERATION_FAILED)
-    {
-        return FIRMWARE_OPERATION_SUCCEEDED;
-    }
-
-    return FIRMWARE_OPERATION_FAILED;
-}
-
 static char *component_status_to_string(const firmware_component_status_t status, bool same_version)
 {
     if (status.overall == FIRMWARE_OPERATION_SUCCEEDED)
@@ -572,7 +577,7 @@ static bool compare_version(k4a_version_t left_version, k4a_version_t right_vers
            left_version.iteration == right_version.iteration;
 }
 
-static bool compare_version_list(k4a_version_t device_version, uint8_t count, k4a_version_t versions[5])
+static bool compare_version_list(k4a_version_t device_version, uint8_t count, const k4a_version_t versions[5])
 {
     for (int i = 0; i < count; ++i)
     {
@@ -585,68 +590,6 @@ static bool compare_version_list(k4a_version_t device_version, uint8_t count, k4
     return false;
 }
 
-static k4a_result_t wait_update_operation_complete(firmware_t firmware_handle, firmware_status_summary_t *finalStatus)
-{
-    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, finalStatus == NULL);
-    LOG_INFO("Waiting for the update operation to complete...", 0);
-
-    bool allComplete = false;
-    k4a_result_t result = K4A_RESULT_FAILED;
-
-    tickcounter_ms_t start_time_ms, now;
-
-    TICK_COUNTER_HANDLE tick = tickcounter_create();
-    if (tick == NULL)
-    {
-        printf("ERROR: Failed to create a counter.\n");
-        return K4A_RESULT_FAILED;
-    }
-
-    if (0 != tickcounter_get_current_ms(tick, &start_time_ms))
-    {
-        printf("ERROR: Failed to get the current time.\n");
-        return K4A_RESULT_FAILED;
-    }
-
-    do
-    {
-        result = firmware_get_download_status(firmware_handle, finalStatus);
-        if (result == K4A_RESULT_SUCCEEDED)
-        {
-            allComplete = ((finalStatus->audio.overall > FIRMWARE_OPERATION_INPROGRESS) &&
-                           (finalStatus->depth_config.overall > FIRMWARE_OPERATION_INPROGRESS) &&
-                           (finalStatus->depth.overall > FIRMWARE_OPERATION_INPROGRESS) &&
-                           (finalStatus->rgb.overall > FIRMWARE_OPERATION_INPROGRESS));
-        }
-        else
-        {
-            printf("ERROR: Failed to get the firmware update status.\n");
-            return K4A_RESULT_FAILED;
-        }
-
-        if (0 != tickcounter_get_current_ms(tick, &now))
-        {
-            printf("ERROR: Failed to get the current time.\n");
-            return K4A_RESULT_FAILED;
-        }
-
-        if (!allComplete && (now - start_time_ms > UPDATE_TIMEOUT_MS))
-        {
-            printf("ERROR: Timeout waiting for the update to complete.\n");
-            return K4A_RESULT_FAILED;
-        }
-
-        if (!allComplete)
-        {
-            ThreadAPI_Sleep(500);
-        }
-    } while (!allComplete);
-
-    LOG_INFO("Firmware update operation has completed.", 0);
-
-    return K4A_RESULT_SUCCEEDED;
-}
-
 static k4a_result_t ensure_firmware_open(updater_command_info_t *command_info,
                                          bool resetting_device,
                                          uint32_t device_index)
@@ -790,167 +733,184 @@ static k4a_result_t command_load_and_inspect_firmware(char *firmware_path, firmw
     return result;
 }
 
-static k4a_result_t command_update_device(updater_command_info_t *command_info)
+static const char *update_stage_to_string(firmware_update_stage_t stage)
 {
-    firmware_status_summary_t finalFwCommandStatus;
-    k4a_result_t finalCmdStatus = K4A_RESULT_SUCCEEDED;
+    switch (stage)
+    {
+    case FIRMWARE_UPDATE_STAGE_CONNECTING:
+        return "Connecting";
+    case FIRMWARE_UPDATE_STAGE_DOWNLOADING:
+        return "Downloading";
+    case FIRMWARE_UPDATE_STAGE_UPDATING:
+        return "Updating";
+    case FIRMWARE_UPDATE_STAGE_RESETTING:
+        return "Resetting";
+    case FIRMWARE_UPDATE_STAGE_COMPLETE:
+        return "Complete";
+    }
 
-    // Load and parse the firmware file information...
-    firmware_package_info_t firmware_info;
-    k4a_result_t result = command_load_and_inspect_firmware(command_info->firmware_path, &firmware_info);
-    if (!K4A_SUCCEEDED(result))
+    return "Unknown";
+}
+
+static void update_progress(const firmware_update_device_t *device, void *context)
+{
+    (void)context;
+
+    if (device->stage == FIRMWARE_UPDATE_STAGE_UPDATING)
     {
-        return result;
+        printf("S/N %s: RGB %s, Depth %s, Depth config %s, Audio %s\n",
+               device->serial_number,
+               component_status_to_string(device->status.rgb, false),
+               component_status_to_string(device->status.depth, false),
+               component_status_to_string(device->status.depth_config, false),
+               component_status_to_string(device->status.audio, false));
+    }
+    else
+    {
+        printf("S/N %s: %s\n", device->serial_number, update_stage_to_string(device->stage));
     }
+}
 
-    for (uint32_t device_index = 0; device_index < command_info->device_count; device_index++)
+static k4a_result_t print_update_result(const firmware_package_info_t *firmware_info,
+                                        const firmware_update_device_t *device)
+{
+    printf("\nDevice Serial Number: %s\n", device->serial_number);
+
+    if (!device->current_version_valid)
     {
-        result = ensure_firmware_open(command_info, FW_OPEN_FULL_FEATURE, device_index);
-        if (!K4A_SUCCEEDED(result))
-        {
-            return result;
-        }
+        printf("ERROR: Failed to get current versions\n\n");
+        return K4A_RESULT_FAILED;
+    }
 
-        // Make a copy of the command so that only 1 device is updated at a time.
-        updater_command_info_t sub_command_info = { 0 };
-        sub_command_info.device_count = 1;
-        sub_command_info.device_serial_number[0] = command_info->device_serial_number[device_index];
-        sub_command_info.firmware_handle = command_info->firmware_handle;
-        sub_command_info.firmware_serial_number = command_info->firmware_serial_number;
+    bool audio_current_version_same = compare_version(device->current_version.audio, firmware_info->audio);
+    bool depth_config_current_version_same = compare_version_list(device->current_version.depth_sensor,
+                                                                  firmware_info->depth_config_number_versions,
+                                                                  firmware_info->depth_config_versions);
+    bool depth_current_version_same = compare_version(device->current_version.depth, firmware_info->depth);
+    bool rgb_current_version_same = compare_version(device->current_version.rgb, firmware_info->rgb);
 
-        // Passed the ownership of the handle to sub_command_info
-        command_info->firmware_handle = NULL;
-        command_info->firmware_serial_number = NULL;
+    if (!device->status_valid)
+    {
+        printf("ERROR: Downloading the firmware failed!\n");
+        return K4A_RESULT_FAILED;
+    }
 
-        // Query the current device information...
-        result = command_query_device(&sub_command_info);
-        if (!K4A_SUCCEEDED(result))
+    if (K4A_FAILED(device->result))
+    {
+        printf("ERROR: The update process failed. One or more stages failed, or the device did not reset.\n");
+        printf("  Audio's last known state:        %s\n",
+               component_status_to_string(device->status.audio, audio_current_version_same));
+        printf("  Depth config's last known state: %s\n",
+               component_status_to_string(device->status.depth_config, depth_config_current_version_same));
+        printf("  Depth's last known state:        %s\n",
+               component_status_to_string(device->status.depth, depth_current_version_same));
+        printf("  RGB's last known state:          %s\n",
+               component_status_to_string(device->status.rgb, rgb_current_version_same));
+        if (!device->updated_version_valid)
         {
-            return result;
+            printf("  Please manually power cycle the device.\n");
         }
 
-        bool audio_current_version_same = compare_version(sub_command_info.current_version.audio, firmware_info.audio);
-        bool depth_config_current_version_same = compare_version_list(sub_command_info.current_version.depth_sensor,
-                                                                      firmware_info.depth_config_number_versions,
-                                                                      firmware_info.depth_config_versions);
-        bool depth_current_version_same = compare_version(sub_command_info.current_version.depth, firmware_info.depth);
-        bool rgb_current_version_same = compare_version(sub_command_info.current_version.rgb, firmware_info.rgb);
+        return K4A_RESULT_FAILED;
+    }
 
-        printf("Please wait, updating device firmware. Don't unplug the device. This operation can take a few "
-               "minutes...\n");
+    // The updated version numbers
+    if (!device->updated_version_valid)
+    {
+        printf("ERROR: Failed to get updated versions\n\n");
+        return K4A_RESULT_FAILED;
+    }
 
-        // Write the loaded firmware to the device...
-        result = firmware_download(sub_command_info.firmware_handle, firmware_info.buffer, firmware_info.size);
-        if (!K4A_SUCCEEDED(result))
-        {
-            printf("ERROR: Downloading the firmware failed! %d\n", result);
-            return result;
-        }
+    bool audio_updated_version_same = compare_version(device->updated_version.audio, firmware_info->audio);
+    bool depth_config_updated_version_same = compare_version_list(device->updated_version.depth_sensor,
+                                                                  firmware_info->depth_config_number_versions,
+                                                                  firmware_info->depth_config_versions);
+    bool depth_updated_version_same = compare_version(device->updated_version.depth, firmware_info->depth);
+    bool rgb_updated_version_same = compare_version(device->updated_version.rgb, firmware_info->rgb);
 
-        // Wait until the update operation is complete and query the device to get status...
-        bool update_failed = K4A_FAILED(
-            wait_update_operation_complete(sub_command_info.firmware_handle, &finalFwCommandStatus));
+    if (audio_current_version_same && audio_updated_version_same && depth_config_current_version_same &&
+        depth_config_updated_version_same && depth_current_version_same && depth_updated_version_same &&
+        rgb_current_version_same && rgb_updated_version_same)
+    {
+        printf("SUCCESS: The firmware was already up-to-date.\n");
+    }
+    else if (audio_updated_version_same && depth_config_updated_version_same && depth_updated_version_same &&
+             rgb_updated_version_same)
+    {
+        printf("SUCCESS: The firmware has been successfully updated.\n");
+    }
+    else
+    {
+        printf("The firmware has been updated to the following firmware Versions:\n");
+        printf("  RGB camera firmware:    %d.%d.%d => %d.%d.%d\n",
+               device->current_version.rgb.major,
+               device->current_version.rgb.minor,
+               device->current_version.rgb.iteration,
+               device->updated_version.rgb.major,
+               device->updated_version.rgb.minor,
+               device->updated_version.rgb.iteration);
+        printf("  Depth camera firmware:  %d.%d.%d => %d.%d.%d\n",
+               device->current_version.depth.major,
+               device->current_version.depth.minor,
+               device->current_version.depth.iteration,
+               device->updated_version.depth.major,
+               device->updated_version.depth.minor,
+               device->updated_version.depth.iteration);
+        printf("  Depth config file:      %d.%d => %d.%d\n",
+               device->current_version.depth_sensor.major,
+               device->current_version.depth_sensor.minor,
+               device->updated_version.depth_sensor.major,
+               device->updated_version.depth_sensor.minor);
+        printf("  Audio firmware:         %d.%d.%d => %d.%d.%d\n",
+               device->current_version.audio.major,
+               device->current_version.audio.minor,
+               device->current_version.audio.iteration,
+               device->updated_version.audio.major,
+               device->updated_version.audio.minor,
+               device->updated_version.audio.iteration);
+    }
 
-        // Always reset the device.
-        result = command_reset_device(&sub_command_info);
-        if (K4A_FAILED(result))
-        {
-            printf("ERROR: The device failed to reset after an update. Please manually power cycle the device.\n");
-        }
+    return K4A_RESULT_SUCCEEDED;
+}
 
-        bool allSuccess =
-            ((calculate_overall_component_status(finalFwCommandStatus.audio) == FIRMWARE_OPERATION_SUCCEEDED) &&
-             (calculate_overall_component_status(finalFwCommandStatus.depth_config) == FIRMWARE_OPERATION_SUCCEEDED) &&
-             (calculate_overall_component_status(finalFwCommandStatus.depth) == FIRMWARE_OPERATION_SUCCEEDED) &&
-             (calculate_overall_component_status(finalFwCommandStatus.rgb) == FIRMWARE_OPERATION_SUCCEEDED));
+static k4a_result_t command_update_device(updater_command_info_t *command_info)
+{
+    k4a_result_t finalCmdStatus = K4A_RESULT_SUCCEEDED;
+    firmware_update_device_t devices[COUNTOF(command_info->device_serial_number)] = { 0 };
 
-        if (update_failed || !allSuccess)
-        {
-            printf("\nERROR: The update process failed. One or more stages failed.\n");
-            printf("  Audio's last known state:        %s\n",
-                   component_status_to_string(finalFwCommandStatus.audio, audio_current_version_same));
-            printf("  Depth config's last known state: %s\n",
-                   component_status_to_string(finalFwCommandStatus.depth_config, depth_config_current_version_same));
-            printf("  Depth's last known state:        %s\n",
-                   component_status_to_string(finalFwCommandStatus.depth, depth_current_version_same));
-            printf("  RGB's last known state:          %s\n",
-                   component_status_to_string(finalFwCommandStatus.rgb, rgb_current_version_same));
+    // Load and parse the firmware file information...
+    firmware_package_info_t firmware_info = { 0 };
+    k4a_result_t result = command_load_and_inspect_firmware(command_info->firmware_path, &firmware_info);
+    if (!K4A_SUCCEEDED(result))
+    {
+        close_all_handles(NULL, &firmware_info);
+        return result;
+    }
 
-            return K4A_RESULT_FAILED;
-        }
+    // The update opens the devices itself
+    close_all_handles(command_info, NULL);
 
-        // Pull the updated version number:
-        result = firmware_get_device_version(sub_command_info.firmware_handle, &sub_command_info.updated_version);
-        if (K4A_SUCCEEDED(result))
-        {
-            bool audio_updated_version_same = compare_version(sub_command_info.updated_version.audio,
-                                                              firmware_info.audio);
-            bool depth_config_updated_version_same = compare_version_list(sub_command_info.updated_version.depth_sensor,
-                                                                          firmware_info.depth_config_number_versions,
-                                                                          firmware_info.depth_config_versions);
-            bool depth_updated_version_same = compare_version(sub_command_info.updated_version.depth,
-                                                              firmware_info.depth);
-            bool rgb_updated_version_same = compare_version(sub_command_info.updated_version.rgb, firmware_info.rgb);
-
-            if (audio_current_version_same && audio_updated_version_same && depth_config_current_version_same &&
-                depth_config_updated_version_same && depth_current_version_same && depth_updated_version_same &&
-                rgb_current_version_same && rgb_updated_version_same)
-            {
-                printf("SUCCESS: The firmware was already up-to-date.\n");
-            }
-            else if (audio_updated_version_same && depth_config_updated_version_same && depth_updated_version_same &&
-                     rgb_updated_version_same)
-            {
-                printf("SUCCESS: The firmware has been successfully updated.\n");
-            }
-            else
-            {
-                printf("The firmware has been updated to the following firmware Versions:\n");
-                printf("  RGB camera firmware:    %d.%d.%d => %d.%d.%d\n",
-                       sub_command_info.current_version.rgb.major,
-                       sub_command_info.current_version.rgb.minor,
-                       sub_command_info.current_version.rgb.iteration,
-                       sub_command_info.updated_version.rgb.major,
-                       sub_command_info.updated_version.rgb.minor,
-                       sub_command_info.updated_version.rgb.iteration);
-                printf("  Depth camera firmware:  %d.%d.%d => %d.%d.%d\n",
-                       sub_command_info.current_version.depth.major,
-                       sub_command_info.current_version.depth.minor,
-                       sub_command_info.current_version.depth.iteration,
-                       sub_command_info.updated_version.depth.major,
-                       sub_command_info.updated_version.depth.minor,
-                       sub_command_info.updated_version.depth.iteration);
-                printf("  Depth config file:      %d.%d => %d.%d\n",
-                       sub_command_info.current_version.depth_sensor.major,
-                       sub_command_info.current_version.depth_sensor.minor,
-                       sub_command_info.updated_version.depth_sensor.major,
-                       sub_command_info.updated_version.depth_sensor.minor);
-                printf("  Audio firmware:         %d.%d.%d => %d.%d.%d\n",
-                       sub_command_info.current_version.audio.major,
-                       sub_command_info.current_version.audio.minor,
-                       sub_command_info.current_version.audio.iteration,
-                       sub_command_info.updated_version.audio.major,
-                       sub_command_info.updated_version.audio.minor,
-                       sub_command_info.updated_version.audio.iteration);
-            }
-        }
-        else
-        {
-            printf("ERROR: Failed to get updated versions\n\n");
-        }
+    for (uint32_t device_index = 0; device_index < command_info->device_count; device_index++)
+    {
+        devices[device_index].serial_number = command_info->device_serial_number[device_index];
+    }
 
-        // Ensure the final handle state is copied back.
-        command_info->firmware_handle = sub_command_info.firmware_handle;
-        command_info->firmware_serial_number = sub_command_info.firmware_serial_number;
+    printf("Please wait, updating the firmware of %u device(s). Don't unplug the devices. This operation can take a "
+           "few minutes...\n",
+           command_info->device_count);
 
-        printf("\n\n");
+    // Every device shares the loaded package and is updated concurrently.
+    (void)firmware_update_devices(&firmware_info, devices, command_info->device_count, update_progress, NULL);
 
-        if (K4A_FAILED(result))
+    for (uint32_t device_index = 0; device_index < command_info->device_count; device_index++)
+    {
+        if (K4A_FAILED(print_update_result(&firmware_info, &devices[device_index])))
         {
             // keep track of overal status
             finalCmdStatus = K4A_RESULT_FAILED;
         }
     }
+    printf("\n\n");
 
     close_all_handles(command_info, &firmware_info);
 